@@ -59,15 +59,58 @@ module "buyer" {
     BUYER_KV_SERVER_ADDR                          = "" # Example: "https://googleads.g.doubleclick.net/td/bts"
     GENERATE_BID_TIMEOUT_MS                       = "" # Example: "60000"
     BIDDING_SIGNALS_LOAD_TIMEOUT_MS               = "" # Example: "60000"
+    GENERATE_BIDS_PARTITION_THRESHOLD             = "" # Example: "0"
+    GENERATE_BIDS_MAX_PARTITIONS                  = "" # Example: "4"
     ENABLE_BUYER_FRONTEND_BENCHMARKING            = "" # Example: "false"
     CREATE_NEW_EVENT_ENGINE                       = "" # Example: "false"
+    ENABLE_CURL_EVENT_LOOP                        = "" # Example: "false"
+    ENABLE_KV_HTTP2_MULTIPLEXING                  = "" # Example: "false"
+    ENABLE_KV_REQUEST_COALESCING                  = "" # Example: "false"
+    ENABLE_KV_POST_REQUESTS                       = "" # Example: "false"
+    ENABLE_KV_REQUEST_COMPRESSION                 = "" # Example: "false"
+    KV_MAX_KEYS_PER_REQUEST                       = "" # Example: "0"
+    KV_BATCH_MAX_KEYS                             = "" # Example: "0"
+    KV_BATCH_MAX_DELAY_US                         = "" # Example: "500"
+    ENABLE_KV_TABLE_RESPONSES                     = "" # Example: "false"
+    ENABLE_BIDDING_SIGNALS_PROJECTION             = "" # Example: "false"
+    KV_NUM_SHARDS                                 = "" # Example: "1"
+    ENABLE_KV_REQUEST_HEDGING                     = "" # Example: "false"
+    KV_HEDGING_LATENCY_PERCENTILE                 = "" # Example: "95"
+    KV_HEDGING_BUDGET_PERCENT                     = "" # Example: "5"
+    BUYER_KV_CACHE_TTL_MS                         = "" # Example: "0"
+    BUYER_KV_CACHE_MAX_BYTES                      = "" # Example: "67108864"
+    BUYER_KV_CACHE_MISS_TTL_MS                    = "" # Example: "0"
     ENABLE_BIDDING_COMPRESSION                    = "" # Example: "true"
+    GRPC_COMPRESSION_ALGORITHM                    = "" # Example: "gzip"
+    GRPC_COMPRESSION_MIN_MESSAGE_BYTES            = "" # Example: "1024"
+    BIDDING_CHANNEL_POOL_SIZE                     = "" # Example: "1"
+    BIDDING_FLOW_CONTROL_WINDOW_BYTES             = "" # Example: "0"
+    BIDDING_LEAST_LOADED_ROUTING                  = "" # Example: "false"
+    SHADOW_BIDDING_SERVER_ADDR                    = "" # Example: "dns:///canary-bidding:443"
+    SHADOW_TRAFFIC_PERCENT                        = "" # Example: "0"
+    BIDDING_SIGNALS_SNAPSHOT_BUCKET               = "" # Example: "bidding-signals"
+    BIDDING_SIGNALS_SNAPSHOT_BLOB                 = "" # Example: "snapshot.kvt"
+    BIDDING_SIGNALS_SNAPSHOT_FETCH_PERIOD_MS      = "" # Example: "60000"
+    ENABLE_CHANNEL_PRE_WARMING                    = "" # Example: "false"
+    CHANNEL_PRE_WARMING_TIMEOUT_MS                = "" # Example: "10000"
     ENABLE_ENCRYPTION                             = "" # Example: "true"
     PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS = "" # Example: "60000"
     TELEMETRY_CONFIG                              = "" # Example: "mode: EXPERIMENT"
     TEST_MODE                                     = "" # Example: "false"
     BUYER_CODE_FETCH_CONFIG                       = "" # Example:
     ENABLE_PROTECTED_APP_SIGNALS                  = "" # Example: "false"
+    ENABLE_BORINGSSL_CRYPTO                       = "" # Example: "false"
+    MALLOC_ARENA_MAX                              = "" # Example: "0"
+    HEAP_RELEASE_INTERVAL_MS                      = "" # Example: "60000"
+    GRPC_SERVER_MAX_THREADS                       = "" # Example: "0"
+    GRPC_SERVER_MEMORY_QUOTA_MB                   = "" # Example: "0"
+    GRPC_SERVER_NUM_CQS                           = "" # Example: "0"
+    GRPC_MAX_CONCURRENT_STREAMS                   = "" # Example: "0"
+    ENABLE_CONCURRENCY_LIMITER                    = "" # Example: "false"
+    CONCURRENCY_LIMIT_MAX                         = "" # Example: "1000"
+    MEMORY_PRESSURE_WATERMARKS                    = "" # Example: "80,88,95"
+    REQUEST_MEMORY_BUDGET_MB                      = "" # Example: "64"
+    PROFILING_PORT                                = "" # Example: "50060"
     # "{
     #    "biddingJsPath": "",
     #    "biddingJsUrl": "https://example.com/generateBid.js",
@@ -78,9 +121,19 @@ module "buyer" {
     #    "enableBuyerDebugUrlGeneration": false,
     #    "enableAdtechCodeLogging": false,
     #  }"
-    JS_NUM_WORKERS      = "" # Example: "48" Must be <=vCPUs in bidding_enclave_cpu_count.
-    JS_WORKER_QUEUE_LEN = "" # Example: "100".
-    ROMA_TIMEOUT_MS     = "" # Example: "10000"
+    JS_NUM_WORKERS                   = "" # Example: "48" Must be <=vCPUs in bidding_enclave_cpu_count.
+    JS_WORKER_QUEUE_LEN              = "" # Example: "100".
+    JS_WORKER_CPUS                   = "" # Example: "0-23,48-71"
+    JS_WORKER_NUMA_NODE              = "" # Example: "-1"
+    SERVER_CPUS                      = "" # Example: "24-47,72-95"
+    JS_INITIAL_HEAP_SIZE_MB          = "" # Example: "0"
+    JS_MAX_HEAP_SIZE_MB              = "" # Example: "0"
+    JS_WORKER_MAX_MEMORY_MB          = "" # Example: "0"
+    LARGE_BUFFER_HUGE_PAGES          = "" # Example: "transparent"
+    CRYPTO_WORKER_POOL_SIZE          = "" # Example: "0"
+    CRYPTO_OFFLOAD_THRESHOLD_BYTES   = "" # Example: "262144"
+    ROMA_TIMEOUT_MS                  = "" # Example: "10000"
+    RUNTIME_CONFIG_REFRESH_PERIOD_MS = "" # Example: "60000"
     # This flag should only be set if console.logs from the AdTech code(Ex:generateBid()) execution need to be exported as VLOG.
     # Note: turning on this flag will lead to higher memory consumption for AdTech code execution
     # and additional latency for parsing the logs.
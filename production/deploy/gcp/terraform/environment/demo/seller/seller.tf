@@ -62,8 +62,53 @@ module "seller" {
     ENABLE_SELLER_FRONTEND_BENCHMARKING    = "" # Example: "false"
     ENABLE_AUCTION_COMPRESSION             = "" # Example: "false"
     ENABLE_BUYER_COMPRESSION               = "" # Example: "false"
+    GRPC_COMPRESSION_ALGORITHM             = "" # Example: "gzip"
+    GRPC_COMPRESSION_MIN_MESSAGE_BYTES     = "" # Example: "1024"
+    AUCTION_CHANNEL_POOL_SIZE              = "" # Example: "1"
+    AUCTION_FLOW_CONTROL_WINDOW_BYTES      = "" # Example: "0"
+    AUCTION_LEAST_LOADED_ROUTING           = "" # Example: "false"
+    SHADOW_AUCTION_SERVER_HOST             = "" # Example: "dns:///canary-auction:443"
+    SHADOW_TRAFFIC_PERCENT                 = "" # Example: "0"
+    BUYER_CHANNEL_POOL_SIZE                = "" # Example: "1"
+    BUYER_FLOW_CONTROL_WINDOW_BYTES        = "" # Example: "0"
     ENABLE_PROTECTED_APP_SIGNALS           = "" # Example: "false"
+    ENABLE_BORINGSSL_CRYPTO                = "" # Example: "false"
+    MALLOC_ARENA_MAX                       = "" # Example: "0"
+    HEAP_RELEASE_INTERVAL_MS               = "" # Example: "60000"
+    GRPC_SERVER_MAX_THREADS                = "" # Example: "0"
+    GRPC_SERVER_MEMORY_QUOTA_MB            = "" # Example: "0"
+    GRPC_SERVER_NUM_CQS                    = "" # Example: "0"
+    GRPC_MAX_CONCURRENT_STREAMS            = "" # Example: "0"
+    ENABLE_CONCURRENCY_LIMITER             = "" # Example: "false"
+    CONCURRENCY_LIMIT_MAX                  = "" # Example: "1000"
+    MEMORY_PRESSURE_WATERMARKS             = "" # Example: "80,88,95"
+    REQUEST_MEMORY_BUDGET_MB               = "" # Example: "64"
+    PROFILING_PORT                         = "" # Example: "50060"
     CREATE_NEW_EVENT_ENGINE                = "" # Example: "false"
+    ENABLE_CURL_EVENT_LOOP                 = "" # Example: "false"
+    ENABLE_KV_HTTP2_MULTIPLEXING           = "" # Example: "false"
+    ENABLE_KV_REQUEST_COALESCING           = "" # Example: "false"
+    ENABLE_KV_POST_REQUESTS                = "" # Example: "false"
+    ENABLE_KV_REQUEST_COMPRESSION          = "" # Example: "false"
+    KV_MAX_KEYS_PER_REQUEST                = "" # Example: "0"
+    KV_BATCH_MAX_KEYS                      = "" # Example: "0"
+    KV_BATCH_MAX_DELAY_US                  = "" # Example: "500"
+    ENABLE_KV_TABLE_RESPONSES              = "" # Example: "false"
+    ENABLE_KV_REQUEST_HEDGING              = "" # Example: "false"
+    KV_HEDGING_LATENCY_PERCENTILE          = "" # Example: "95"
+    KV_HEDGING_BUDGET_PERCENT              = "" # Example: "5"
+    SCORING_SIGNALS_CACHE_TTL_MS           = "" # Example: "0"
+    SCORING_SIGNALS_CACHE_MAX_BYTES        = "" # Example: "67108864"
+    SCORING_SIGNALS_CACHE_MISS_TTL_MS      = "" # Example: "0"
+    ENABLE_STREAMING_SCORING               = "" # Example: "false"
+    ENABLE_STREAMED_GET_BIDS               = "" # Example: "false"
+    SPECULATIVE_SCORING_BUYER_PERCENT      = "" # Example: "0"
+    ENABLE_BUYER_LATENCY_BUDGET            = "" # Example: "false"
+    BUYER_LATENCY_BUDGET_PERCENTILE        = "" # Example: "99"
+    BUYER_LATENCY_BUDGET_SCORING_RESERVE_MS = "" # Example: "50"
+    ENABLE_BUYER_CIRCUIT_BREAKER           = "" # Example: "false"
+    BUYER_CIRCUIT_BREAKER_FAILURE_PERCENT  = "" # Example: "50"
+    BUYER_CIRCUIT_BREAKER_OPEN_MS          = "" # Example: "5000"
     SELLER_CODE_FETCH_CONFIG               = "" # Example:
     # "{
     #     "auctionJsPath": "",
@@ -79,13 +124,34 @@ module "seller" {
     #                              "https://buyerC_origin.com":"https://buyerC.com/generateBid.js"},
     #     "protectedAppSignalsBuyerReportWinJsUrls": {"https://buyerA_origin.com":"https://buyerA.com/generateBid.js"}
     #  }"
-    JS_NUM_WORKERS            = "" # Example: "64" Must be <=vCPUs in auction_machine_type.
-    JS_WORKER_QUEUE_LEN       = "" # Example: "200".
-    ROMA_TIMEOUT_MS           = "" # Example: "10000"
-    TELEMETRY_CONFIG          = "" # Example: "mode: EXPERIMENT"
-    COLLECTOR_ENDPOINT        = "" # Example: "collector-seller-1-${local.environment}.sfe-gcp.com:4317"
-    ENABLE_OTEL_BASED_LOGGING = "" # Example: "false"
-    CONSENTED_DEBUG_TOKEN     = "" # Example: "<unique_id>"
+    JS_NUM_WORKERS                   = "" # Example: "64" Must be <=vCPUs in auction_machine_type.
+    JS_WORKER_QUEUE_LEN              = "" # Example: "200".
+    JS_WORKER_CPUS                   = "" # Example: "0-23,48-71"
+    JS_WORKER_NUMA_NODE              = "" # Example: "-1"
+    SERVER_CPUS                      = "" # Example: "24-47,72-95"
+    JS_INITIAL_HEAP_SIZE_MB          = "" # Example: "0"
+    JS_MAX_HEAP_SIZE_MB              = "" # Example: "0"
+    JS_WORKER_MAX_MEMORY_MB          = "" # Example: "0"
+    LARGE_BUFFER_HUGE_PAGES          = "" # Example: "transparent"
+    CRYPTO_WORKER_POOL_SIZE          = "" # Example: "0"
+    CRYPTO_OFFLOAD_THRESHOLD_BYTES   = "" # Example: "262144"
+    REPORTING_THREADS                = "" # Example: "4"
+    REPORTING_MAX_IN_FLIGHT          = "" # Example: "256"
+    CPU_EXECUTOR_THREADS             = "" # Example: "0"
+    DEBUG_LOSS_REPORTS_PER_REQUEST   = "" # Example: "0"
+    DEBUG_LOSS_REPORTS_PER_SECOND    = "" # Example: "0"
+    DEBUG_LOSS_REPORT_PERCENT        = "" # Example: "100"
+    REQUEST_SHAPE_CAPTURE_PATH       = "" # Example: "/tmp/request_shapes.jsonl"
+    BUYER_INPUT_ZSTD_DICTIONARY_PATHS = "" # Example: "/dictionaries/buyer_input_1.zdict"
+    ENABLE_CHANNEL_PRE_WARMING       = "" # Example: "false"
+    CHANNEL_PRE_WARMING_TIMEOUT_MS   = "" # Example: "10000"
+    FORWARD_COMPRESSED_BUYER_INPUTS  = "" # Example: "false"
+    ROMA_TIMEOUT_MS                  = "" # Example: "10000"
+    RUNTIME_CONFIG_REFRESH_PERIOD_MS = "" # Example: "60000"
+    TELEMETRY_CONFIG                 = "" # Example: "mode: EXPERIMENT"
+    COLLECTOR_ENDPOINT               = "" # Example: "collector-seller-1-${local.environment}.sfe-gcp.com:4317"
+    ENABLE_OTEL_BASED_LOGGING        = "" # Example: "false"
+    CONSENTED_DEBUG_TOKEN            = "" # Example: "<unique_id>"
 
     # Reach out to the Privacy Sandbox B&A team to enroll with Coordinators and update the following flag values.
     # More information on enrollment can be found here: https://github.com/privacysandbox/fledge-docs/blob/main/bidding_auction_services_api.md#enroll-with-coordinators
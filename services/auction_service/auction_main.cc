@@ -12,7 +12,9 @@
 //  See the License for the specific language governing permissions and
 //  limitations under the License.
 
+#include <algorithm>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -21,17 +23,20 @@
 #include <aws/core/Aws.h>
 #include <google/protobuf/util/json_util.h>
 
+#include "absl/debugging/symbolize.h"
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "glog/logging.h"
 #include "grpcpp/ext/proto_server_reflection_plugin.h"
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/health_check_service_interface.h"
 #include "opentelemetry/metrics/provider.h"
+#include "public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
 #include "public/cpio/interface/cpio.h"
 #include "services/auction_service/auction_code_fetch_config.pb.h"
 #include "services/auction_service/auction_service.h"
@@ -40,16 +45,38 @@
 #include "services/auction_service/code_wrapper/seller_code_wrapper.h"
 #include "services/auction_service/data/runtime_config.h"
 #include "services/auction_service/runtime_flags.h"
+#include "services/auction_service/score_ad_result_cache.h"
+#include "services/auction_service/score_ads_reactor.h"
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+#include "services/common/clients/config/runtime_config_refresher.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/code_fetch/periodic_bucket_fetcher.h"
 #include "services/common/code_fetch/periodic_code_fetcher.h"
 #include "services/common/encryption/crypto_client_factory.h"
+#include "services/common/encryption/crypto_worker_pool.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/reporters/async_reporter.h"
+#include "services/common/reporters/debug_report_limiter.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/profiling_service.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/cpu_placement.h"
+#include "services/common/util/grpc_server_options.h"
+#include "services/common/util/heap_stats.h"
+#include "services/common/util/huge_pages.h"
+#include "services/common/util/json_on_demand.h"
+#include "services/common/util/memory_governor.h"
+#include "services/common/util/request_memory_budget.h"
+#include "services/common/util/request_timeline.h"
+#include "services/common/util/server_readiness.h"
+#include "services/common/util/signal_blob_cache.h"
 #include "services/common/util/signal_handler.h"
 #include "services/common/util/status_macros.h"
+#include "services/common/util/thread_pool_executor.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/cpp/concurrent/event_engine_executor.h"
 #include "src/cpp/encryption/key_fetcher/src/key_fetcher_manager.h"
@@ -70,15 +97,71 @@ ABSL_FLAG(
     "The number of workers/threads for executing AdTech code in parallel.");
 ABSL_FLAG(std::optional<std::int64_t>, js_worker_queue_len, std::nullopt,
           "The length of queue size for a single JS execution worker.");
+ABSL_FLAG(std::optional<int>, crypto_worker_pool_size, 0,
+          "The number of threads the large requests are decrypted and the "
+          "large responses encrypted on. 0 keeps them on the gRPC threads.");
+ABSL_FLAG(std::optional<int>, crypto_offload_threshold_bytes, 262144,
+          "The size of the payloads from which they are decrypted and "
+          "encrypted on the crypto worker pool.");
+ABSL_FLAG(std::optional<std::string>, js_worker_cpus, "",
+          "The CPUs the Roma workers are pinned to, in the format of the "
+          "kernel, such as \"0-15,32-47\". Empty for any CPU, or the CPUs of "
+          "js_worker_numa_node if set. Sizes the workers when js_num_workers "
+          "is not set.");
+ABSL_FLAG(std::optional<int>, js_worker_numa_node, -1,
+          "The NUMA node the memory of the Roma workers, and the memory "
+          "they share with the server, comes from. -1 for any node.");
+ABSL_FLAG(std::optional<std::string>, server_cpus, "",
+          "The CPUs the gRPC and executor threads are pinned to, in the "
+          "format of the kernel. Empty for the CPUs of the process.");
+ABSL_FLAG(std::optional<int>, js_initial_heap_size_mb, 0,
+          "The initial V8 heap size of each Roma worker, so that the heap "
+          "does not grow through repeated collections under load. 0 for the "
+          "V8 default.");
+ABSL_FLAG(std::optional<int>, js_max_heap_size_mb, 0,
+          "The maximum V8 heap size of each Roma worker. 0 for the V8 "
+          "default.");
+ABSL_FLAG(std::optional<int>, js_worker_max_memory_mb, 0,
+          "The virtual memory limit of each Roma worker, past which the "
+          "worker is restarted. 0 for no limit.");
+ABSL_FLAG(std::optional<std::string>, large_buffer_huge_pages, "",
+          "Pages backing the reusable buffers of the largest requests: "
+          "\"none\", \"transparent\" or \"explicit\" huge pages, falling "
+          "back to what the host has. Empty to allocate the buffers of each "
+          "request with malloc.");
+ABSL_FLAG(std::optional<int>, reporting_threads, 0,
+          "The number of low priority threads the debug and win reports run "
+          "on, with a fetcher of their own. 0 keeps them on the threads and "
+          "the fetcher of the other HTTP fetches.");
+ABSL_FLAG(std::optional<int>, reporting_max_in_flight, 0,
+          "Max debug and win reports in flight. 0 for no limit.");
+ABSL_FLAG(std::optional<int>, debug_loss_reports_per_request, 0,
+          "Max debug loss reports sent for a request. 0 for no limit.");
+ABSL_FLAG(std::optional<int>, debug_loss_reports_per_second, 0,
+          "Max debug loss reports sent by the server in a second. 0 for no "
+          "limit.");
+ABSL_FLAG(std::optional<int>, debug_loss_report_percent, 100,
+          "Percentage of the debug loss reports sent, picked at random.");
+ABSL_FLAG(std::optional<int>, runtime_config_refresh_period_ms, 0,
+          "The period of the refreshes of the flags that can change while "
+          "the server runs, from the cloud metadata store. 0 for no "
+          "refreshes.");
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+using ::google::scp::cpio::BlobStorageClientFactory;
 using ::google::scp::cpio::Cpio;
 using ::google::scp::cpio::CpioOptions;
 using ::google::scp::cpio::LogOption;
 using ::grpc::Server;
 using ::grpc::ServerBuilder;
 
+// Maximum time spent warming up Roma after loading code from a local file.
+constexpr absl::Duration kCodeWarmUpTimeout = absl::Seconds(10);
+
+// Bound on the bytes of the cached scoreAd() outputs when not configured.
+constexpr int64_t kDefaultScoreAdResultCacheMaxBytes = 64 << 20;
+
 absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
     std::string config_param_prefix) {
   TrustedServersConfigClient config_client(GetServiceFlags());
@@ -119,11 +202,52 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         SELLER_CODE_FETCH_CONFIG);
   config_client.SetFlag(FLAGS_js_num_workers, JS_NUM_WORKERS);
   config_client.SetFlag(FLAGS_js_worker_queue_len, JS_WORKER_QUEUE_LEN);
+  config_client.SetFlag(FLAGS_crypto_worker_pool_size, CRYPTO_WORKER_POOL_SIZE);
+  config_client.SetFlag(FLAGS_crypto_offload_threshold_bytes,
+                        CRYPTO_OFFLOAD_THRESHOLD_BYTES);
+  config_client.SetFlag(FLAGS_js_worker_cpus, JS_WORKER_CPUS);
+  config_client.SetFlag(FLAGS_js_worker_numa_node, JS_WORKER_NUMA_NODE);
+  config_client.SetFlag(FLAGS_server_cpus, SERVER_CPUS);
+  config_client.SetFlag(FLAGS_js_initial_heap_size_mb, JS_INITIAL_HEAP_SIZE_MB);
+  config_client.SetFlag(FLAGS_js_max_heap_size_mb, JS_MAX_HEAP_SIZE_MB);
+  config_client.SetFlag(FLAGS_js_worker_max_memory_mb, JS_WORKER_MAX_MEMORY_MB);
+  config_client.SetFlag(FLAGS_large_buffer_huge_pages, LARGE_BUFFER_HUGE_PAGES);
+  config_client.SetFlag(FLAGS_reporting_threads, REPORTING_THREADS);
+  config_client.SetFlag(FLAGS_reporting_max_in_flight,
+                        REPORTING_MAX_IN_FLIGHT);
+  config_client.SetFlag(FLAGS_debug_loss_reports_per_request,
+                        DEBUG_LOSS_REPORTS_PER_REQUEST);
+  config_client.SetFlag(FLAGS_debug_loss_reports_per_second,
+                        DEBUG_LOSS_REPORTS_PER_SECOND);
+  config_client.SetFlag(FLAGS_debug_loss_report_percent,
+                        DEBUG_LOSS_REPORT_PERCENT);
+  config_client.SetFlag(FLAGS_runtime_config_refresh_period_ms,
+                        RUNTIME_CONFIG_REFRESH_PERIOD_MS);
   config_client.SetFlag(FLAGS_consented_debug_token, CONSENTED_DEBUG_TOKEN);
   config_client.SetFlag(FLAGS_enable_otel_based_logging,
                         ENABLE_OTEL_BASED_LOGGING);
   config_client.SetFlag(FLAGS_enable_protected_app_signals,
                         ENABLE_PROTECTED_APP_SIGNALS);
+  config_client.SetFlag(FLAGS_enable_boringssl_crypto,
+                        ENABLE_BORINGSSL_CRYPTO);
+  config_client.SetFlag(FLAGS_malloc_arena_max, MALLOC_ARENA_MAX);
+  config_client.SetFlag(FLAGS_heap_release_interval_ms,
+                        HEAP_RELEASE_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads,
+                        GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_grpc_server_memory_quota_mb,
+                        GRPC_SERVER_MEMORY_QUOTA_MB);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_max_concurrent_streams,
+                        GRPC_MAX_CONCURRENT_STREAMS);
+  config_client.SetFlag(FLAGS_enable_concurrency_limiter,
+                        ENABLE_CONCURRENCY_LIMITER);
+  config_client.SetFlag(FLAGS_concurrency_limit_max, CONCURRENCY_LIMIT_MAX);
+  config_client.SetFlag(FLAGS_memory_pressure_watermarks,
+                        MEMORY_PRESSURE_WATERMARKS);
+  config_client.SetFlag(FLAGS_request_memory_budget_mb,
+                        REQUEST_MEMORY_BUDGET_MB);
+  config_client.SetFlag(FLAGS_profiling_port, PROFILING_PORT);
 
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
@@ -141,6 +265,17 @@ absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_RETURN_IF_ERROR(
+      SetMallocArenaMax(config_client.GetIntParameter(MALLOC_ARENA_MAX)));
+  HeapReleaser heap_releaser(absl::Milliseconds(
+      config_client.GetIntParameter(HEAP_RELEASE_INTERVAL_MS)));
+  PS_ASSIGN_OR_RETURN(
+      const std::optional<MemoryWatermarks> memory_watermarks,
+      ParseMemoryWatermarks(
+          config_client.GetStringParameter(MEMORY_PRESSURE_WATERMARKS)));
+  PS_RETURN_IF_ERROR(InitLargeBufferPool(
+      config_client.GetStringParameter(LARGE_BUFFER_HUGE_PAGES),
+      kLargeBufferBytes));
 
   std::string_view port = config_client.GetStringParameter(PORT);
   std::string server_address = absl::StrCat("0.0.0.0:", port);
@@ -148,15 +283,60 @@ absl::Status RunServer() {
   CHECK(!config_client.GetStringParameter(SELLER_CODE_FETCH_CONFIG).empty())
       << "SELLER_CODE_FETCH_CONFIG is a mandatory flag.";
 
-  V8Dispatcher dispatcher;
-  CodeDispatchClient client(dispatcher);
+  // Convert Json string into a AuctionCodeBlobFetcherConfig proto
+  auction_service::SellerCodeFetchConfig code_fetch_proto;
+  absl::Status result = google::protobuf::util::JsonStringToMessage(
+      config_client.GetStringParameter(SELLER_CODE_FETCH_CONFIG).data(),
+      &code_fetch_proto);
+  CHECK(result.ok()) << "Could not parse SELLER_CODE_FETCH_CONFIG JsonString "
+                        "to a proto message: "
+                     << result;
+
+  V8Dispatcher dispatcher(
+      code_fetch_proto.dispatch_max_requests_per_invocation());
   DispatchConfig config;
   config.worker_queue_max_items =
       config_client.GetIntParameter(JS_WORKER_QUEUE_LEN);
   config.number_of_workers = config_client.GetIntParameter(JS_NUM_WORKERS);
-
-  PS_RETURN_IF_ERROR(dispatcher.Init(config))
+  const int initial_heap_size_mb =
+      config_client.GetIntParameter(JS_INITIAL_HEAP_SIZE_MB);
+  const int max_heap_size_mb =
+      config_client.GetIntParameter(JS_MAX_HEAP_SIZE_MB);
+  if (initial_heap_size_mb > max_heap_size_mb) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(JS_INITIAL_HEAP_SIZE_MB, " must not exceed ",
+                     JS_MAX_HEAP_SIZE_MB, ", which must be set with it."));
+  }
+  if (max_heap_size_mb > 0) {
+    config.ConfigureJsEngineResourceConstraints(initial_heap_size_mb,
+                                                max_heap_size_mb);
+  }
+  config.max_worker_virtual_memory_mb =
+      config_client.GetIntParameter(JS_WORKER_MAX_MEMORY_MB);
+  // The dispatcher routes to the current code version and the version of
+  // each code experiment. It reuses the version numbers within the cache, so
+  // that Roma never evicts a routed version, with 2 spare ones so that a
+  // version number is reused only after its code went unrouted for a load.
+  config.code_version_cache_size = std::max<size_t>(
+      config.code_version_cache_size,
+      code_fetch_proto.score_ad_experiment_versions_size() + 3);
+  dispatcher.SetMaxCodeVersions(config.code_version_cache_size);
+
+  PS_ASSIGN_OR_RETURN(
+      DispatchPlacement placement,
+      GetDispatchPlacement(config_client.GetStringParameter(JS_WORKER_CPUS),
+                           config_client.GetIntParameter(JS_WORKER_NUMA_NODE),
+                           config_client.GetStringParameter(SERVER_CPUS)));
+  if (config.number_of_workers == 0) {
+    config.number_of_workers = placement.worker_cpus.size();
+  }
+  // The threads of the server are started after the workers, so that they
+  // run on the server CPUs.
+  PS_RETURN_IF_ERROR(RunWithDispatchPlacement(
+      placement, [&dispatcher, &config]() { return dispatcher.Init(config); }))
       << "Could not start code dispatcher.";
+  DispatchStats::Get().SetNumWorkers(config.number_of_workers);
+  DispatchStats::Get().SetWorkerQueueLength(config.worker_queue_max_items);
 
   server_common::GrpcInit gprc_init;
   std::unique_ptr<server_common::Executor> executor =
@@ -164,17 +344,31 @@ absl::Status RunServer() {
           grpc_event_engine::experimental::CreateEventEngine());
   std::unique_ptr<HttpFetcherAsync> http_fetcher =
       std::make_unique<MultiCurlHttpFetcherAsync>(executor.get());
+  // The keys are fetched while the code loads and the telemetry starts up.
+  std::future<std::unique_ptr<server_common::KeyFetcherManagerInterface>>
+      pending_key_fetcher_manager =
+          std::async(std::launch::async, [&config_client]() {
+            return CreateKeyFetcherManager(config_client);
+          });
 
   std::unique_ptr<CodeFetcherInterface> code_fetcher;
-
-  // Convert Json string into a AuctionCodeBlobFetcherConfig proto
-  auction_service::SellerCodeFetchConfig code_fetch_proto;
-  absl::Status result = google::protobuf::util::JsonStringToMessage(
-      config_client.GetStringParameter(SELLER_CODE_FETCH_CONFIG).data(),
-      &code_fetch_proto);
-  CHECK(result.ok()) << "Could not parse SELLER_CODE_FETCH_CONFIG JsonString "
-                        "to a proto message: "
-                     << result;
+  CodeDispatchClient client(
+      dispatcher,
+      DispatchCoalescingConfig{
+          .window = absl::Microseconds(
+              code_fetch_proto.dispatch_coalescing_window_us()),
+          .max_batch_size =
+              code_fetch_proto.dispatch_coalescing_max_batch_size()},
+      DispatchSchedulingConfig{
+          .max_in_flight = code_fetch_proto.dispatch_max_in_flight(),
+          .max_in_flight_per_call =
+              code_fetch_proto.dispatch_max_in_flight_per_request()});
+  // Roma spreads a batch over its workers, so the warm up batch holds
+  // code_warm_up_requests for each of them. Only one worker's share runs when
+  // Roma picks the number of workers.
+  std::vector<DispatchRequest> warm_up_requests = MakeScoreAdWarmUpRequests(
+      code_fetch_proto.code_warm_up_requests() *
+      std::max(1, config.number_of_workers));
 
   bool enable_seller_debug_url_generation =
       code_fetch_proto.enable_seller_debug_url_generation();
@@ -184,6 +378,8 @@ absl::Status RunServer() {
       code_fetch_proto.enable_report_result_url_generation();
   bool enable_report_win_url_generation =
       code_fetch_proto.enable_report_win_url_generation();
+  bool enable_score_ads_batch_entry_function =
+      code_fetch_proto.score_ads_batch_size() > 1;
   std::string js_url = code_fetch_proto.auction_js_url();
   auto buyer_report_win_js_urls = code_fetch_proto.buyer_report_win_js_urls();
   std::vector<std::string> endpoints = {js_url};
@@ -192,16 +388,25 @@ absl::Status RunServer() {
     endpoints.push_back(key_value.second);
     buyer_origins.push_back(key_value.first);
   }
+  // The wasm helper is fetched after the reportWin code of the buyers.
+  const bool has_wasm_helper =
+      !code_fetch_proto.auction_wasm_helper_url().empty();
+  if (has_wasm_helper) {
+    endpoints.push_back(code_fetch_proto.auction_wasm_helper_url());
+  }
 
+  std::future<absl::Status> code_loaded;
   // Starts periodic code blob fetching from an arbitrary url only if js_url is
   // specified
   if (!js_url.empty()) {
     auto wrap_code =
         [enable_seller_debug_url_generation,
          enable_report_result_url_generation, enable_report_win_url_generation,
-         buyer_origins](const std::vector<std::string>& adtech_code_blobs) {
+         enable_score_ads_batch_entry_function, buyer_origins,
+         has_wasm_helper](const std::vector<std::string>& adtech_code_blobs) {
           absl::flat_hash_map<std::string, std::string> buyer_origin_code_map;
-          CHECK(buyer_origins.size() == adtech_code_blobs.size() - 1)
+          CHECK(buyer_origins.size() + (has_wasm_helper ? 1 : 0) ==
+                adtech_code_blobs.size() - 1)
               << "Error fetching code blobs from buyer. Buyer size:"
               << buyer_origins.size()
               << " and blobs count:" << adtech_code_blobs.size();
@@ -211,13 +416,16 @@ absl::Status RunServer() {
           }
           return GetSellerWrappedCode(
               adtech_code_blobs.at(0), enable_report_result_url_generation,
-              enable_report_win_url_generation, buyer_origin_code_map);
+              enable_report_win_url_generation, buyer_origin_code_map,
+              enable_score_ads_batch_entry_function,
+              has_wasm_helper ? adtech_code_blobs.back() : "");
         };
 
     code_fetcher = std::make_unique<PeriodicCodeFetcher>(
         endpoints, absl::Milliseconds(code_fetch_proto.url_fetch_period_ms()),
         std::move(http_fetcher), dispatcher, executor.get(),
-        absl::Milliseconds(code_fetch_proto.url_fetch_timeout_ms()), wrap_code);
+        absl::Milliseconds(code_fetch_proto.url_fetch_timeout_ms()), wrap_code,
+        warm_up_requests);
 
     code_fetcher->Start();
   } else if (!code_fetch_proto.auction_js_path().empty()) {
@@ -226,15 +434,46 @@ absl::Status RunServer() {
                                  (std::istreambuf_iterator<char>()));
 
     adtech_code_blob = GetSellerWrappedCode(
-        adtech_code_blob, enable_report_result_url_generation, false, {});
-
-    PS_RETURN_IF_ERROR(dispatcher.LoadSync(1, adtech_code_blob))
-        << "Could not load Adtech untrusted code for scoring.";
+        adtech_code_blob, enable_report_result_url_generation, false, {},
+        enable_score_ads_batch_entry_function);
+
+    // Loaded while the server starts up, which reports NOT_SERVING until the
+    // code is loaded and warmed up.
+    code_loaded = std::async(
+        std::launch::async,
+        [&dispatcher, adtech_code_blob = std::move(adtech_code_blob),
+         warm_up_requests]() {
+          return dispatcher.LoadNextVersionSync(
+              adtech_code_blob, warm_up_requests, kCodeWarmUpTimeout);
+        });
   } else {
     return absl::UnavailableError(
         "Code fetching config requires either a path or url.");
   }
 
+  // Fetches the experimental versions of scoreAd from the bucket, each
+  // loaded alongside the default version for the requests that ask for it.
+  std::vector<std::unique_ptr<CodeFetcherInterface>> experiment_code_fetchers;
+  for (const std::string& score_ad_version :
+       code_fetch_proto.score_ad_experiment_versions()) {
+    auto wrap_code = [enable_report_result_url_generation,
+                      enable_score_ads_batch_entry_function](
+                         const std::vector<std::string>& adtech_code_blobs) {
+      return GetSellerWrappedCode(
+          adtech_code_blobs.at(0), enable_report_result_url_generation,
+          /*enable_report_win_url_generation=*/false, {},
+          enable_score_ads_batch_entry_function);
+    };
+    auto experiment_code_fetcher = std::make_unique<PeriodicBucketFetcher>(
+        code_fetch_proto.score_ad_experiment_bucket(),
+        std::vector<std::string>{score_ad_version},
+        absl::Milliseconds(code_fetch_proto.url_fetch_period_ms()), dispatcher,
+        executor.get(), BlobStorageClientFactory::Create(), warm_up_requests,
+        kCodeWarmUpTimeout, wrap_code, score_ad_version);
+    experiment_code_fetcher->Start();
+    experiment_code_fetchers.push_back(std::move(experiment_code_fetcher));
+  }
+
   bool enable_auction_service_benchmark =
       config_client.GetBooleanParameter(ENABLE_AUCTION_SERVICE_BENCHMARK);
 
@@ -242,6 +481,7 @@ absl::Status RunServer() {
       config_client
           .GetCustomParameter<server_common::TelemetryFlag>(TELEMETRY_CONFIG)
           .server_config);
+  const bool profiling_allowed = telemetry_config.ProfilingAllowed();
   std::string collector_endpoint =
       config_client.GetStringParameter(COLLECTOR_ENDPOINT).data();
   server_common::InitTelemetry(
@@ -253,17 +493,60 @@ absl::Status RunServer() {
                                  collector_endpoint);
   server_common::ConfigureLogger(CreateSharedAttributes(&config_util),
                                  collector_endpoint);
-  AddSystemMetric(metric::AuctionContextMap(
+  auto* context_map = metric::AuctionContextMap(
       std::move(telemetry_config),
       server_common::ConfigurePrivateMetrics(
           CreateSharedAttributes(&config_util),
           CreateMetricsOptions(telemetry_config.metric_export_interval_ms()),
           collector_endpoint),
-      config_util.GetService(), kOpenTelemetryVersion.data()));
+      config_util.GetService(), kOpenTelemetryVersion.data());
+  AddSystemMetric(context_map);
+  AddGrpcServerMetric(context_map);
+  AddConcurrencyLimiterMetric(context_map);
+  AddMemoryGovernorMetric(context_map);
+  AddSlowRequestMetric(context_map);
+  AddRequestMemoryBudgetMetric(context_map);
+  AddDispatchMetric(context_map);
+  AddCryptoWorkerPoolMetric(context_map);
+  AddAsyncReporterMetric(context_map);
+  AddDebugReportLimiterMetric(context_map);
+  AddSignalBlobCacheMetric(context_map);
+  // Of the scoreAd result cache.
+  AddKeyValueCacheMetric(context_map);
   auto executer = std::make_unique<server_common::EventEngineExecutor>(
       grpc_event_engine::experimental::CreateEventEngine());
+  // Runs the reports on low priority threads of their own, if set, so that
+  // bursts of reports do not delay the code fetches.
+  std::unique_ptr<ThreadPoolExecutor> reporting_executor;
+  if (int reporting_threads = config_client.GetIntParameter(REPORTING_THREADS);
+      reporting_threads > 0) {
+    reporting_executor = std::make_unique<ThreadPoolExecutor>(
+        reporting_threads, executer.get(), kReportingThreadNice);
+  }
+  AsyncReporterOptions reporting_options = kServerReportingOptions;
+  reporting_options.max_in_flight =
+      config_client.GetIntParameter(REPORTING_MAX_IN_FLIGHT);
+  server_common::Executor* reporting_executer =
+      reporting_executor ? reporting_executor.get() : executer.get();
+  // Shared by all the requests, so that reports to a host reuse its
+  // connections and a request finishing does not cancel its reports.
+  // A dedicated fetcher polls on its own thread rather than holding a thread
+  // of the pool.
+  auto async_reporter = std::make_shared<AsyncReporter>(
+      std::make_unique<MultiCurlHttpFetcherAsync>(
+          reporting_executer, /*keepalive_interval_sec=*/2,
+          /*keepalive_idle_sec=*/2,
+          /*use_event_loop=*/reporting_executor != nullptr,
+          /*enable_http2_multiplexing=*/true),
+      reporting_options, reporting_executer);
+  std::unique_ptr<AdMetadataJsonCache> ad_metadata_json_cache;
+  if (code_fetch_proto.ad_metadata_json_cache_capacity() > 0) {
+    ad_metadata_json_cache = std::make_unique<AdMetadataJsonCache>(
+        code_fetch_proto.ad_metadata_json_cache_capacity());
+  }
   auto score_ads_reactor_factory =
-      [&client, &executer, enable_auction_service_benchmark](
+      [&client, &async_reporter, &ad_metadata_json_cache,
+       enable_auction_service_benchmark](
           const ScoreAdsRequest* request, ScoreAdsResponse* response,
           server_common::KeyFetcherManagerInterface* key_fetcher_manager,
           CryptoClientWrapperInterface* crypto_client,
@@ -275,15 +558,95 @@ absl::Status RunServer() {
         } else {
           benchmarkingLogger = std::make_unique<ScoreAdsNoOpLogger>();
         }
-        std::unique_ptr<AsyncReporter> async_reporter =
-            std::make_unique<AsyncReporter>(
-                std::make_unique<MultiCurlHttpFetcherAsync>(executer.get()));
         return std::make_unique<ScoreAdsReactor>(
             client, request, response, std::move(benchmarkingLogger),
-            key_fetcher_manager, crypto_client, std::move(async_reporter),
-            runtime_config);
+            key_fetcher_manager, crypto_client, async_reporter,
+            runtime_config, ad_metadata_json_cache.get());
       };
 
+  std::unique_ptr<CryptoWorkerPool> crypto_worker_pool;
+  if (int crypto_worker_pool_size =
+          config_client.GetIntParameter(CRYPTO_WORKER_POOL_SIZE);
+      crypto_worker_pool_size > 0) {
+    crypto_worker_pool = std::make_unique<CryptoWorkerPool>(
+        crypto_worker_pool_size,
+        config_client.GetIntParameter(CRYPTO_OFFLOAD_THRESHOLD_BYTES));
+  }
+
+  const DebugReportLimits debug_report_limits = {
+      .max_loss_reports_per_request =
+          config_client.GetIntParameter(DEBUG_LOSS_REPORTS_PER_REQUEST),
+      .max_loss_reports_per_second =
+          config_client.GetIntParameter(DEBUG_LOSS_REPORTS_PER_SECOND),
+      .loss_report_sample_percent =
+          config_client.GetIntParameter(DEBUG_LOSS_REPORT_PERCENT),
+  };
+  DebugReportLimiter debug_report_limiter(debug_report_limits);
+
+  std::unique_ptr<ConcurrencyLimiter> concurrency_limiter;
+  if (config_client.GetBooleanParameter(ENABLE_CONCURRENCY_LIMITER)) {
+    concurrency_limiter =
+        std::make_unique<ConcurrencyLimiter>(ConcurrencyLimiterOptions{
+            .max_limit = config_client.GetIntParameter(CONCURRENCY_LIMIT_MAX)});
+  } else if (memory_watermarks.has_value()) {
+    // Only sheds requests under memory pressure.
+    concurrency_limiter = std::make_unique<ConcurrencyLimiter>(
+        FixedConcurrencyLimit(
+            config_client.GetIntParameter(CONCURRENCY_LIMIT_MAX)));
+  }
+  const bool use_on_demand_json_parser =
+      code_fetch_proto.use_on_demand_json_parser() &&
+      IsOnDemandJsonParserBuiltIn();
+  if (code_fetch_proto.use_on_demand_json_parser() &&
+      !use_on_demand_json_parser) {
+    LOG(WARNING) << "Not built with the on-demand JSON parser, using "
+                    "rapidjson instead";
+  }
+
+  std::unique_ptr<SignalBlobCache> signal_blob_cache;
+  if (code_fetch_proto.signal_blob_cache_capacity() > 0) {
+    signal_blob_cache = std::make_unique<SignalBlobCache>(
+        code_fetch_proto.signal_blob_cache_capacity());
+  }
+
+  std::unique_ptr<ScoreAdResultCache> score_ad_result_cache;
+  if (code_fetch_proto.score_ad_result_cache_ttl_ms() > 0) {
+    score_ad_result_cache = std::make_unique<ScoreAdResultCache>(
+        absl::Milliseconds(code_fetch_proto.score_ad_result_cache_ttl_ms()),
+        code_fetch_proto.score_ad_result_cache_max_bytes() > 0
+            ? code_fetch_proto.score_ad_result_cache_max_bytes()
+            : kDefaultScoreAdResultCacheMaxBytes);
+  }
+
+  std::unique_ptr<MemoryGovernor> memory_governor;
+  if (memory_watermarks.has_value()) {
+    std::vector<MemoryGovernor::Listener> listeners;
+    listeners.push_back([concurrency_limiter = concurrency_limiter.get()](
+                            MemoryPressure pressure) {
+      concurrency_limiter->SetLimitScale(ConcurrencyScaleOf(pressure));
+    });
+    if (ad_metadata_json_cache != nullptr) {
+      listeners.push_back(
+          [cache = ad_metadata_json_cache.get()](MemoryPressure pressure) {
+            cache->SetCapacityScale(CacheScaleOf(pressure));
+          });
+    }
+    if (score_ad_result_cache != nullptr) {
+      listeners.push_back(
+          [cache = score_ad_result_cache.get()](MemoryPressure pressure) {
+            cache->SetCapacityScale(CacheScaleOf(pressure));
+          });
+    }
+    if (signal_blob_cache != nullptr) {
+      listeners.push_back(
+          [cache = signal_blob_cache.get()](MemoryPressure pressure) {
+            cache->SetCapacityScale(CacheScaleOf(pressure));
+          });
+    }
+    memory_governor = std::make_unique<MemoryGovernor>(
+        *memory_watermarks, kMemoryGovernorPeriod, std::move(listeners));
+  }
+
   AuctionServiceRuntimeConfig runtime_config = {
       .encryption_enabled =
           config_client.GetBooleanParameter(ENABLE_ENCRYPTION),
@@ -293,20 +656,101 @@ absl::Status RunServer() {
           enable_report_result_url_generation,
       .enable_report_win_url_generation = enable_report_win_url_generation,
       .roma_timeout_ms =
-          config_client.GetStringParameter(ROMA_TIMEOUT_MS).data()};
-  AuctionService auction_service(std::move(score_ads_reactor_factory),
-                                 CreateKeyFetcherManager(config_client),
-                                 CreateCryptoClient(),
-                                 std::move(runtime_config));
+          config_client.GetStringParameter(ROMA_TIMEOUT_MS).data(),
+      .enable_zero_copy_scoring_signals =
+          code_fetch_proto.enable_zero_copy_scoring_signals(),
+      .highest_scoring_other_bids_top_k =
+          code_fetch_proto.highest_scoring_other_bids_top_k(),
+      .score_ads_batch_size = code_fetch_proto.score_ads_batch_size(),
+      .enable_seller_pre_scoring_filter =
+          code_fetch_proto.enable_seller_pre_scoring_filter(),
+      .use_on_demand_json_parser = use_on_demand_json_parser,
+      .request_memory_budget_bytes =
+          int64_t{config_client.GetIntParameter(REQUEST_MEMORY_BUDGET_MB)}
+          << 20,
+      .crypto_worker_pool = crypto_worker_pool.get(),
+      .debug_report_limiter = &debug_report_limiter,
+      .concurrency_limiter = concurrency_limiter.get(),
+      .signal_blob_cache = signal_blob_cache.get(),
+      .score_ad_result_cache = score_ad_result_cache.get(),
+      .consented_debug_token = std::string(
+          config_client.GetStringParameter(CONSENTED_DEBUG_TOKEN))};
+  AuctionService auction_service(
+      std::move(score_ads_reactor_factory),
+      pending_key_fetcher_manager.get(),
+      CreateCryptoClient(
+          config_client.GetBooleanParameter(ENABLE_BORINGSSL_CRYPTO)),
+      std::move(runtime_config));
+
+  std::unique_ptr<RuntimeConfigRefresher> runtime_config_refresher;
+  if (int refresh_period_ms =
+          config_client.GetIntParameter(RUNTIME_CONFIG_REFRESH_PERIOD_MS);
+      refresh_period_ms > 0 && absl::GetFlag(FLAGS_init_config_client)) {
+    runtime_config_refresher = CreateRuntimeConfigRefresher(
+        config_client, kRefreshableFlags,
+        [&auction_service, &debug_report_limiter,
+         concurrency_limiter = concurrency_limiter.get(),
+         limits = debug_report_limits](const ParameterValues& changed) mutable {
+          if (auto it = changed.find(ROMA_TIMEOUT_MS); it != changed.end()) {
+            auction_service.runtime_config().Update(
+                [&roma_timeout_ms = it->second](
+                    AuctionServiceRuntimeConfig& config) {
+                  config.roma_timeout_ms = roma_timeout_ms;
+                });
+          }
+          // Leaves the values that are not numbers unchanged.
+          auto update_int = [&changed](absl::string_view name, int& value) {
+            auto it = changed.find(name);
+            int parsed;
+            if (it == changed.end() || !absl::SimpleAtoi(it->second, &parsed)) {
+              return false;
+            }
+            value = parsed;
+            return true;
+          };
+          if (int max_limit; concurrency_limiter != nullptr &&
+                             update_int(CONCURRENCY_LIMIT_MAX, max_limit)) {
+            concurrency_limiter->SetMaxLimit(max_limit);
+          }
+          bool limits_changed = update_int(DEBUG_LOSS_REPORTS_PER_REQUEST,
+                                           limits.max_loss_reports_per_request);
+          limits_changed |= update_int(DEBUG_LOSS_REPORTS_PER_SECOND,
+                                       limits.max_loss_reports_per_second);
+          limits_changed |= update_int(DEBUG_LOSS_REPORT_PERCENT,
+                                       limits.loss_report_sample_percent);
+          if (limits_changed) {
+            debug_report_limiter.SetLimits(limits);
+          }
+        },
+        absl::Milliseconds(refresh_period_ms), executor.get());
+    runtime_config_refresher->Start();
+  }
 
   grpc::EnableDefaultHealthCheckService(true);
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
   ServerBuilder builder;
+  ApplyGrpcServerOptions(
+      {.max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS),
+       .memory_quota_mb =
+           config_client.GetIntParameter(GRPC_SERVER_MEMORY_QUOTA_MB),
+       .num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_concurrent_streams =
+           config_client.GetIntParameter(GRPC_MAX_CONCURRENT_STREAMS)},
+      builder);
   // Listen on the given address without any authentication mechanism.
   // This server is expected to accept insecure connections as it will be
   // deployed behind an HTTPS load balancer that terminates TLS.
   builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
   builder.RegisterService(&auction_service);
+  // Served on its own port, only if allowed by the telemetry config.
+  ProfilingService profiling_service;
+  std::unique_ptr<Server> profiling_server;
+  if (profiling_allowed) {
+    PS_ASSIGN_OR_RETURN(
+        profiling_server,
+        StartProfilingServer(profiling_service,
+                             config_client.GetIntParameter(PROFILING_PORT)));
+  }
 
   std::unique_ptr<Server> server(builder.BuildAndStart());
   if (server == nullptr) {
@@ -315,20 +759,45 @@ absl::Status RunServer() {
   // Wait for the server to shutdown. Note that some other thread must be
   // responsible for shutting down the server for this call to ever return.
   VLOG(1) << "Server listening on " << server_address;
+  // Both the periodic fetch and the load from a path make the code current
+  // only once it is warmed up.
+  ServerReadiness readiness(server->GetHealthCheckService(), [&dispatcher]() {
+    return dispatcher.CurrentVersion() > 0;
+  });
+  // A failed load shuts the server down through the usual teardown below.
+  absl::Status code_status = absl::OkStatus();
+  if (code_loaded.valid()) {
+    code_status = code_loaded.get();
+    if (!code_status.ok()) {
+      LOG(ERROR) << "Could not load Adtech untrusted code for scoring: "
+                 << code_status;
+      server->Shutdown();
+    }
+  }
   server->Wait();
+  if (profiling_server) {
+    profiling_server->Shutdown();
+  }
+  if (runtime_config_refresher) {
+    runtime_config_refresher->End();
+  }
   // Ends periodic code blob fetching from an arbitrary url.
   if (code_fetcher) {
     code_fetcher->End();
   }
+  for (auto& experiment_code_fetcher : experiment_code_fetchers) {
+    experiment_code_fetcher->End();
+  }
   PS_RETURN_IF_ERROR(dispatcher.Stop())
       << "Error shutting down code dispatcher.";
-  return absl::OkStatus();
+  return code_status;
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 int main(int argc, char** argv) {
   signal(SIGSEGV, privacy_sandbox::bidding_auction_servers::SignalHandler);
   absl::ParseCommandLine(argc, argv);
+  absl::InitializeSymbolizer(argv[0]);
   google::InitGoogleLogging(argv[0]);
 
   google::scp::cpio::CpioOptions cpio_options;
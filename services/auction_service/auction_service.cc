@@ -14,12 +14,20 @@
 
 #include "services/auction_service/auction_service.h"
 
+#include <memory>
+#include <utility>
+
 #include <grpcpp/grpcpp.h>
 
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
+#include "services/common/clients/async_grpc/backend_load.h"
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
 #include "services/common/metric/server_definition.h"
-#include "src/cpp/telemetry/telemetry.h"
+#include "services/common/telemetry/request_tracer.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/request_class.h"
+#include "services/common/util/request_deadline.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -51,8 +59,20 @@ void LogMetrics(const ScoreAdsRequest* request, ScoreAdsResponse* response) {
 grpc::ServerUnaryReactor* AuctionService::ScoreAds(
     grpc::CallbackServerContext* context, const ScoreAdsRequest* request,
     ScoreAdsResponse* response) {
-  auto scope = opentelemetry::trace::Scope(
-      server_common::GetTracer()->StartSpan("ScoreAds"));
+  std::shared_ptr<const AuctionServiceRuntimeConfig> runtime_config =
+      runtime_config_.Get();
+  // Lets the clients that balance their calls by load steer away from this
+  // server while a backlog builds up on Roma, shed requests included.
+  AddBackendLoadHint(*context, DispatchStats::Get().PendingRequests());
+  const RequestClass request_class =
+      GetRequestClass(context->client_metadata());
+  ConcurrencyLimiter::Permit permit;
+  if (runtime_config->concurrency_limiter != nullptr) {
+    permit = runtime_config->concurrency_limiter->TryAcquire(request_class);
+    if (!permit) {
+      return FinishShedRequest(context);
+    }
+  }
   LogMetrics(request, response);
 
   VLOG(2) << "\nScoreAdsRequest:\n" << request->DebugString();
@@ -60,8 +80,13 @@ grpc::ServerUnaryReactor* AuctionService::ScoreAds(
   // Heap allocate the reactor. Deleted in reactor's OnDone call.
   auto reactor =
       score_ads_reactor_factory_(request, response, key_fetcher_manager_.get(),
-                                 crypto_client_.get(), runtime_config_);
-  reactor->Execute();
+                                 crypto_client_.get(), *runtime_config);
+  reactor->SetConcurrencyPermit(std::move(permit));
+  reactor->SetRequestClass(request_class);
+  reactor->SetMemoryBudget(runtime_config->request_memory_budget_bytes);
+  reactor->SetDeadline(GetRequestDeadline(*context));
+  reactor->StartTrace("ScoreAds", GetTraceParent(context->client_metadata()));
+  reactor->Start();
   return reactor.release();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -25,6 +25,7 @@
 #include "cc/public/cpio/interface/crypto_client/crypto_client_interface.h"
 #include "services/auction_service/data/runtime_config.h"
 #include "services/auction_service/score_ads_reactor.h"
+#include "services/common/util/versioned_config.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -69,12 +70,18 @@ class AuctionService final : public Auction::CallbackService {
                                      const ScoreAdsRequest* request,
                                      ScoreAdsResponse* response) override;
 
+  // Config of the requests, which can be updated while the service runs.
+  // Each request reads the snapshot current when it starts.
+  VersionedConfig<AuctionServiceRuntimeConfig>& runtime_config() {
+    return runtime_config_;
+  }
+
  private:
   ScoreAdsReactorFactory score_ads_reactor_factory_;
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
   std::unique_ptr<CryptoClientWrapperInterface> crypto_client_;
-  AuctionServiceRuntimeConfig runtime_config_;
+  VersionedConfig<AuctionServiceRuntimeConfig> runtime_config_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -18,8 +18,10 @@
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/strings/escaping.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "services/common/util/wasm_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -38,16 +40,19 @@ void AppendFeatureFlagValue(std::string& feature_flags,
 
 // Returns the reportWin wrapper function that should be called from
 // reportingEntryFunction. The function name is
-// <sanitized_buyer_origin>_reportWinWrapper buyer_origin is sanitized by
-// removing the special characters Example: if buyer_origin is http://buyer.com,
-// the function returns httpbuyercom_reportWinWrapper.
-// This will ensure that each of the buyer's reportWin() function code has a
-// different wrapper.
-std::string GetReportWinFunctionName(absl::string_view buyer_origin) {
+// reportWinWrapper<sanitized_buyer_origin>_<index>. buyer_origin is sanitized
+// by removing the special characters. Example: if buyer_origin is
+// http://buyer.com and index is 0, the function returns
+// reportWinWrapperhttpbuyercom_0.
+// The index of the buyer ensures that each of the buyer's reportWin()
+// function code has a different wrapper, even for origins differing only in
+// their special characters, such as https://a.b.com and https://ab.com.
+std::string GetReportWinFunctionName(absl::string_view buyer_origin,
+                                     int index) {
   std::string buyer_prefix{buyer_origin};
   std::regex re("[^a-zA-Z0-9]");
   return absl::StrCat(kReportWinWrapperFunctionName,
-                      std::regex_replace(buyer_prefix, re, ""));
+                      std::regex_replace(buyer_prefix, re, ""), "_", index);
 }
 
 void ReplacePlaceholders(std::string& report_win_wrapper_template,
@@ -64,20 +69,37 @@ void ReplacePlaceholders(std::string& report_win_wrapper_template,
 std::string GetSellerWrappedCode(
     absl::string_view seller_js_code, bool enable_report_result_url_generation,
     bool enable_report_win_url_generation,
-    const absl::flat_hash_map<std::string, std::string>&
-        buyer_origin_code_map) {
-  std::string wrap_code{absl::StrCat(kEntryFunction, seller_js_code)};
+    const absl::flat_hash_map<std::string, std::string>& buyer_origin_code_map,
+    bool enable_score_ads_batch_entry_function, absl::string_view seller_wasm) {
+  std::string wrap_code{absl::StrCat(GetWasmHelperJavascript(seller_wasm),
+                                     kEntryFunction, seller_js_code)};
+  if (enable_score_ads_batch_entry_function) {
+    wrap_code.append(kScoreAdsBatchEntryFunction);
+  }
   if (enable_report_result_url_generation) {
     wrap_code.append(kReportingEntryFunction);
   }
+  // The wrappers by buyer origin, which reportingEntryFunction calls through.
+  // The table has no prototype, so that an origin such as "__proto__" or
+  // "constructor" does not resolve to an inherited property.
+  std::string report_win_wrappers =
+      "\n    var ps_report_win_wrappers = Object.create(null);\n";
   if (enable_report_win_url_generation) {
+    int index = 0;
     for (const auto& [buyer_origin, buyer_code] : buyer_origin_code_map) {
+      const std::string wrapper_name =
+          GetReportWinFunctionName(buyer_origin, index++);
       std::string reporting_code{kReportingWinWrapperTemplate};
-      ReplacePlaceholders(reporting_code,
-                          GetReportWinFunctionName(buyer_origin), buyer_code);
+      ReplacePlaceholders(reporting_code, wrapper_name, buyer_code);
       wrap_code.append(reporting_code);
+      absl::StrAppend(&report_win_wrappers, "    ps_report_win_wrappers[\"",
+                      absl::CHexEscape(buyer_origin), "\"] = ", wrapper_name,
+                      ";\n");
     }
   }
+  if (enable_report_result_url_generation) {
+    wrap_code.append(report_win_wrappers);
+  }
   return wrap_code;
 }
 
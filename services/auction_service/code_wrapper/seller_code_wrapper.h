@@ -38,6 +38,8 @@ inline constexpr char kReportWinWrapperFunctionName[] = "reportWinWrapper";
 // The dispatch function name will be scoreAdEntryFunction.
 // This wrapper supports the features below:
 //- Exporting logs to Auction Service using console.log
+//- Hooks in wasm module
+//- Timing the scoreAd() call, as kExecutionTimeMsPropertyForScoreAd
 constexpr absl::string_view kEntryFunction = R"JS_CODE(
     const forDebuggingOnly = {}
     forDebuggingOnly.auction_win_url = undefined;
@@ -53,6 +55,7 @@ constexpr absl::string_view kEntryFunction = R"JS_CODE(
 
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
+      browserSignals.wasmHelper = globalWasmHelper;
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -69,6 +72,7 @@ constexpr absl::string_view kEntryFunction = R"JS_CODE(
       }
 
       var scoreAdResponse = {};
+      const ps_start = Date.now();
       try {
         scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
               trustedScoringSignals, browserSignals, directFromSellerSignals);
@@ -88,11 +92,31 @@ constexpr absl::string_view kEntryFunction = R"JS_CODE(
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        executionTimeMs: Date.now() - ps_start
       }
     }
 )JS_CODE";
 
+// The function that will be called by Roma to score a chunk of ads in one
+// invocation. The dispatch function name will be scoreAdsBatchEntryFunction.
+// ads is an array of objects holding the per ad arguments of
+// scoreAdEntryFunction (adMetadata, bid, trustedScoringSignals and
+// browserSignals). The remaining arguments are shared by every ad. Returns an
+// array holding the scoreAdEntryFunction output for each ad, in order.
+inline constexpr absl::string_view kScoreAdsBatchEntryFunction = R"JS_CODE(
+    function scoreAdsBatchEntryFunction(ads, auctionConfig, directFromSellerSignals,
+                                      featureFlags){
+      return ads.map((ad) => {
+        forDebuggingOnly.auction_win_url = undefined;
+        forDebuggingOnly.auction_loss_url = undefined;
+        return scoreAdEntryFunction(ad.adMetadata, ad.bid, auctionConfig,
+              ad.trustedScoringSignals, ad.browserSignals,
+              directFromSellerSignals, featureFlags);
+      });
+    }
+)JS_CODE";
+
 // The function that will be called by Roma to generate reporting urls.
 // The dispatch function name will be reportingEntryFunction.
 // This wrapper supports the features below:
@@ -145,7 +169,6 @@ inline constexpr absl::string_view kReportingEntryFunction =
       try{
       if(buyerReportingMetadata.enableReportWinUrlGeneration){
         var buyerOrigin = buyerReportingMetadata.buyerOrigin
-        var buyerPrefix = buyerOrigin.replace(/[^a-zA-Z0-9 ]/g, "")
         var auctionSignals = auctionConfig.auctionSignals
         var buyerReportingSignals = sellerReportingSignals
         buyerReportingSignals.interestGroupName = buyerReportingMetadata.interestGroupName
@@ -154,9 +177,14 @@ inline constexpr absl::string_view kReportingEntryFunction =
         buyerReportingSignals.recency = buyerReportingMetadata.recency
         buyerReportingSignals.modelingSignals = buyerReportingMetadata.modelingSignals
         perBuyerSignals = buyerReportingMetadata.perBuyerSignals
-        var reportWinFunction = "reportWinWrapper"+buyerPrefix+"(auctionSignals, perBuyerSignals, ps_signalsForWinner, buyerReportingSignals,"+
-                              "directFromSellerSignals, enable_logging)"
-        var reportWinResponse = eval(reportWinFunction)
+        // Called through the table built at load, so that no code is compiled
+        // and no name is built per call.
+        var reportWinWrapper = ps_report_win_wrappers[buyerOrigin]
+        if(reportWinWrapper === undefined){
+          throw new Error("No reportWin code for buyer " + buyerOrigin);
+        }
+        var reportWinResponse = reportWinWrapper(auctionSignals, perBuyerSignals, ps_signalsForWinner,
+                              buyerReportingSignals, directFromSellerSignals, enable_logging)
         return {
           reportResultResponse: ps_report_result_response,
           sellerLogs: ps_logs,
@@ -230,10 +258,15 @@ ps_report_win_code = $reportWinCode
 // - Generation of event level reporting urls for all the Buyers
 // - Generation of event level debug reporting
 // - Exporting console.logs from the AdTech execution.
+// - Scoring a chunk of ads per Roma invocation, when
+//   enable_score_ads_batch_entry_function is set.
+// - wasmHelper added to browserSignals, compiled from seller_wasm.
 std::string GetSellerWrappedCode(
     absl::string_view seller_js_code, bool enable_report_result_url_generation,
     bool enable_report_win_url_generation,
-    const absl::flat_hash_map<std::string, std::string>& buyer_origin_code_map);
+    const absl::flat_hash_map<std::string, std::string>& buyer_origin_code_map,
+    bool enable_score_ads_batch_entry_function = false,
+    absl::string_view seller_wasm = "");
 
 // Returns a JSON string for feature flags to be used by the wrapper script.
 std::string GetFeatureFlagJson(bool enable_logging,
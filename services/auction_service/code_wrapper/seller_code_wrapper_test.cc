@@ -14,8 +14,12 @@
 #include "services/auction_service/code_wrapper/seller_code_wrapper.h"
 
 #include <future>
+#include <string>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
 #include "gtest/gtest.h"
 #include "rapidjson/document.h"
 #include "services/auction_service/code_wrapper/seller_code_wrapper_test_constants.h"
@@ -35,6 +39,38 @@ TEST(GetSellerWrappedCode, GeneratesCompleteFinalCode) {
       kExpectedFinalCode);
 }
 
+TEST(GetSellerWrappedCode, NamesWrappersOfSimilarOriginsApart) {
+  absl::flat_hash_map<std::string, std::string> buyer_code_map;
+  buyer_code_map.try_emplace("https://a.b.com", kBuyerBaseCode);
+  buyer_code_map.try_emplace("https://ab.com", kBuyerBaseCode);
+  const std::string code =
+      GetSellerWrappedCode(kSellerBaseCode,
+                           /*enable_report_result_url_generation=*/true,
+                           /*enable_report_win_url_generation=*/true,
+                           buyer_code_map);
+
+  // Returns the wrapper the table maps the origin to.
+  auto wrapper_of = [&code](absl::string_view origin) -> std::string {
+    const std::string entry =
+        absl::StrCat("ps_report_win_wrappers[\"", origin, "\"] = ");
+    const size_t start = code.find(entry);
+    if (start == std::string::npos) {
+      return "";
+    }
+    const size_t name_start = start + entry.size();
+    return code.substr(name_start, code.find(';', name_start) - name_start);
+  };
+  const std::string wrapper_a = wrapper_of("https://a.b.com");
+  const std::string wrapper_b = wrapper_of("https://ab.com");
+  ASSERT_FALSE(wrapper_a.empty());
+  ASSERT_FALSE(wrapper_b.empty());
+  EXPECT_NE(wrapper_a, wrapper_b);
+  EXPECT_NE(code.find(absl::StrCat("function ", wrapper_a, "(")),
+            std::string::npos);
+  EXPECT_NE(code.find(absl::StrCat("function ", wrapper_b, "(")),
+            std::string::npos);
+}
+
 TEST(GetSellerWrappedCode, CodeWithReportWinDisabled) {
   bool enable_report_result_url_generation = true;
   bool enable_report_win_url_generation = false;
@@ -53,6 +89,32 @@ TEST(GetSellerWrappedCode, CodeWithReportResultDisabled) {
       kExpectedCodeWithReportingDisabled);
 }
 
+TEST(GetSellerWrappedCode, AppendsBatchEntryFunctionWhenEnabled) {
+  bool enable_report_result_url_generation = false;
+  bool enable_report_win_url_generation = false;
+  bool enable_score_ads_batch_entry_function = true;
+  EXPECT_EQ(
+      GetSellerWrappedCode(kSellerBaseCode, enable_report_result_url_generation,
+                           enable_report_win_url_generation, {},
+                           enable_score_ads_batch_entry_function),
+      absl::StrCat(kExpectedCodeWithReportingDisabled,
+                   kScoreAdsBatchEntryFunction));
+}
+
+TEST(GetSellerWrappedCode, CompilesSellerWasmIntoWasmHelper) {
+  bool enable_report_result_url_generation = false;
+  bool enable_report_win_url_generation = false;
+  bool enable_score_ads_batch_entry_function = false;
+  EXPECT_EQ(
+      GetSellerWrappedCode(kSellerBaseCode, enable_report_result_url_generation,
+                           enable_report_win_url_generation, {},
+                           enable_score_ads_batch_entry_function,
+                           absl::string_view("\0asm", 4)),
+      absl::StrReplaceAll(kExpectedCodeWithReportingDisabled,
+                          {{R"(const globalWasmBytes = "";)",
+                            R"(const globalWasmBytes = "\x00asm";)"}}));
+}
+
 void GenerateFeatureFlagsTestHelper(bool is_logging_enabled,
                                     bool is_debug_url_generation_enabled) {
   std::string actual_json =
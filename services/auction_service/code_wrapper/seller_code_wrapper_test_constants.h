@@ -58,6 +58,9 @@ constexpr absl::string_view kSellerBaseCode = R"JS_CODE(
 )JS_CODE";
 
 constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
+  const globalWasmBytes = "";
+  const globalWasmHelper = globalWasmBytes.length ? new WebAssembly.Module(Uint8Array.from(globalWasmBytes, (c) => c.charCodeAt(0))) : null;
+
     const forDebuggingOnly = {}
     forDebuggingOnly.auction_win_url = undefined;
     forDebuggingOnly.auction_loss_url = undefined;
@@ -72,6 +75,7 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
 
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
+      browserSignals.wasmHelper = globalWasmHelper;
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -88,6 +92,7 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
       }
 
       var scoreAdResponse = {};
+      const ps_start = Date.now();
       try {
         scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
               trustedScoringSignals, browserSignals, directFromSellerSignals);
@@ -107,7 +112,8 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        executionTimeMs: Date.now() - ps_start
       }
     }
 
@@ -174,7 +180,6 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
       try{
       if(buyerReportingMetadata.enableReportWinUrlGeneration){
         var buyerOrigin = buyerReportingMetadata.buyerOrigin
-        var buyerPrefix = buyerOrigin.replace(/[^a-zA-Z0-9 ]/g, "")
         var auctionSignals = auctionConfig.auctionSignals
         var buyerReportingSignals = sellerReportingSignals
         buyerReportingSignals.interestGroupName = buyerReportingMetadata.interestGroupName
@@ -183,9 +188,14 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
         buyerReportingSignals.recency = buyerReportingMetadata.recency
         buyerReportingSignals.modelingSignals = buyerReportingMetadata.modelingSignals
         perBuyerSignals = buyerReportingMetadata.perBuyerSignals
-        var reportWinFunction = "reportWinWrapper"+buyerPrefix+"(auctionSignals, perBuyerSignals, ps_signalsForWinner, buyerReportingSignals,"+
-                              "directFromSellerSignals, enable_logging)"
-        var reportWinResponse = eval(reportWinFunction)
+        // Called through the table built at load, so that no code is compiled
+        // and no name is built per call.
+        var reportWinWrapper = ps_report_win_wrappers[buyerOrigin]
+        if(reportWinWrapper === undefined){
+          throw new Error("No reportWin code for buyer " + buyerOrigin);
+        }
+        var reportWinResponse = reportWinWrapper(auctionSignals, perBuyerSignals, ps_signalsForWinner,
+                              buyerReportingSignals, directFromSellerSignals, enable_logging)
         return {
           reportResultResponse: ps_report_result_response,
           sellerLogs: ps_logs,
@@ -208,7 +218,7 @@ constexpr absl::string_view kExpectedFinalCode = R"JS_CODE(
 
     // Handler method to call adTech provided reportWin method and wrap the
     // response with reportWin url and interaction reporting urls.
-    function reportWinWrapperhttpbuyer1com(auctionSignals, perBuyerSignals, signalsForWinner, buyerReportingSignals,
+    function reportWinWrapperhttpbuyer1com_0(auctionSignals, perBuyerSignals, signalsForWinner, buyerReportingSignals,
                               directFromSellerSignals, enable_logging) {
       var ps_report_win_response = {
         reportWinUrl : "",
@@ -256,9 +266,15 @@ ps_report_win_code = reportWin = function(auctionSignals, perBuyerSignals, signa
         logs: ps_logs,
       }
     }
+
+    var ps_report_win_wrappers = Object.create(null);
+    ps_report_win_wrappers["http://buyer1.com"] = reportWinWrapperhttpbuyer1com_0;
 )JS_CODE";
 
 constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
+  const globalWasmBytes = "";
+  const globalWasmHelper = globalWasmBytes.length ? new WebAssembly.Module(Uint8Array.from(globalWasmBytes, (c) => c.charCodeAt(0))) : null;
+
     const forDebuggingOnly = {}
     forDebuggingOnly.auction_win_url = undefined;
     forDebuggingOnly.auction_loss_url = undefined;
@@ -273,6 +289,7 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
 
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
+      browserSignals.wasmHelper = globalWasmHelper;
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -289,6 +306,7 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
       }
 
       var scoreAdResponse = {};
+      const ps_start = Date.now();
       try {
         scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
               trustedScoringSignals, browserSignals, directFromSellerSignals);
@@ -308,7 +326,8 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        executionTimeMs: Date.now() - ps_start
       }
     }
 
@@ -375,7 +394,6 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
       try{
       if(buyerReportingMetadata.enableReportWinUrlGeneration){
         var buyerOrigin = buyerReportingMetadata.buyerOrigin
-        var buyerPrefix = buyerOrigin.replace(/[^a-zA-Z0-9 ]/g, "")
         var auctionSignals = auctionConfig.auctionSignals
         var buyerReportingSignals = sellerReportingSignals
         buyerReportingSignals.interestGroupName = buyerReportingMetadata.interestGroupName
@@ -384,9 +402,14 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
         buyerReportingSignals.recency = buyerReportingMetadata.recency
         buyerReportingSignals.modelingSignals = buyerReportingMetadata.modelingSignals
         perBuyerSignals = buyerReportingMetadata.perBuyerSignals
-        var reportWinFunction = "reportWinWrapper"+buyerPrefix+"(auctionSignals, perBuyerSignals, ps_signalsForWinner, buyerReportingSignals,"+
-                              "directFromSellerSignals, enable_logging)"
-        var reportWinResponse = eval(reportWinFunction)
+        // Called through the table built at load, so that no code is compiled
+        // and no name is built per call.
+        var reportWinWrapper = ps_report_win_wrappers[buyerOrigin]
+        if(reportWinWrapper === undefined){
+          throw new Error("No reportWin code for buyer " + buyerOrigin);
+        }
+        var reportWinResponse = reportWinWrapper(auctionSignals, perBuyerSignals, ps_signalsForWinner,
+                              buyerReportingSignals, directFromSellerSignals, enable_logging)
         return {
           reportResultResponse: ps_report_result_response,
           sellerLogs: ps_logs,
@@ -406,9 +429,14 @@ constexpr absl::string_view kExpectedCodeWithReportWinDisabled = R"JS_CODE(
         sellerWarnings: ps_warns,
       }
     }
+
+    var ps_report_win_wrappers = Object.create(null);
 )JS_CODE";
 
 constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
+  const globalWasmBytes = "";
+  const globalWasmHelper = globalWasmBytes.length ? new WebAssembly.Module(Uint8Array.from(globalWasmBytes, (c) => c.charCodeAt(0))) : null;
+
     const forDebuggingOnly = {}
     forDebuggingOnly.auction_win_url = undefined;
     forDebuggingOnly.auction_loss_url = undefined;
@@ -423,6 +451,7 @@ constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
 
     function scoreAdEntryFunction(adMetadata, bid, auctionConfig, trustedScoringSignals,
                                 browserSignals, directFromSellerSignals, featureFlags){
+      browserSignals.wasmHelper = globalWasmHelper;
       var ps_logs = [];
       var ps_errors = [];
       var ps_warns = [];
@@ -439,6 +468,7 @@ constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
       }
 
       var scoreAdResponse = {};
+      const ps_start = Date.now();
       try {
         scoreAdResponse = scoreAd(adMetadata, bid, auctionConfig,
               trustedScoringSignals, browserSignals, directFromSellerSignals);
@@ -458,7 +488,8 @@ constexpr absl::string_view kExpectedCodeWithReportingDisabled = R"JS_CODE(
         response: scoreAdResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        executionTimeMs: Date.now() - ps_start
       }
     }
 
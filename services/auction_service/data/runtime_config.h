@@ -19,6 +19,12 @@
 
 #include <string>
 
+#include "services/auction_service/score_ad_result_cache.h"
+#include "services/common/encryption/crypto_worker_pool.h"
+#include "services/common/reporters/debug_report_limiter.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/signal_blob_cache.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
 
 struct AuctionServiceRuntimeConfig {
@@ -41,6 +47,46 @@ struct AuctionServiceRuntimeConfig {
   bool enable_report_win_url_generation = false;
   // Seller's domain required as input for reporting url generation.
   std::string seller_origin = "";
+  // Builds each ad's trusted scoring signals by splicing byte ranges of the raw
+  // KV response recorded in a single parsing pass, instead of building and
+  // serializing intermediate JSON documents per render URL.
+  bool enable_zero_copy_scoring_signals = false;
+  // Number of highest distinct scores for which the bids other than the
+  // winning one are reported as highest scoring other bids. Non-positive
+  // values fall back to the default of 2.
+  int highest_scoring_other_bids_top_k = 2;
+  // Number of ads scored per Roma invocation through the seller wrapper's
+  // scoreAdsBatchEntryFunction. Values of at most 1 dispatch each ad on its
+  // own. The Roma timeout applies to each batch.
+  int score_ads_batch_size = 0;
+  // Rejects ads before dispatching them to scoreAd if their bid is below the
+  // "minBid" or their interest group owner is listed in the
+  // "blockedInterestGroupOwners" of the request's seller signals.
+  bool enable_seller_pre_scoring_filter = false;
+  // Parses the scoreAd() responses with the on-demand JSON parser, if built
+  // in.
+  bool use_on_demand_json_parser = false;
+  // Most bytes a request may take for its decrypted payload and the
+  // arguments dispatched for it, the ones past the budget being dropped. No
+  // budget when 0.
+  int64_t request_memory_budget_bytes = 0;
+  // Pool the large requests are decrypted and the large responses encrypted
+  // on, if any. Not owned.
+  CryptoWorkerPool* crypto_worker_pool = nullptr;
+  // Limits the debug loss reports sent, if any. Not owned.
+  DebugReportLimiter* debug_report_limiter = nullptr;
+  // Sheds the requests past the concurrency limit of the server, if any. Not
+  // owned.
+  ConcurrencyLimiter* concurrency_limiter = nullptr;
+  // Shares the auction config of the requests with byte-identical signals,
+  // if any. Not owned.
+  SignalBlobCache* signal_blob_cache = nullptr;
+  // Reuses the scoreAd() outputs of byte-identical arguments, if any. Not
+  // owned.
+  ScoreAdResultCache* score_ad_result_cache = nullptr;
+  // Debug token of the server, which the requests consented for debugging
+  // must carry to have their failures logged in full. None when empty.
+  std::string consented_debug_token;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
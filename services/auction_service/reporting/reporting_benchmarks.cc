@@ -0,0 +1,360 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Microbenchmarks of the reporting pipeline of the auction service, from the
+// reporting input of the winner to the reports sent.
+//
+// BM_GetReportingDispatchRequest builds the reportingEntryFunction request of
+// a winner. BM_ReportingDispatch runs it in Roma, with reportResult and
+// reportWin each registering "interaction_urls" beacons, through the parsing
+// of the response as the reactor does. BM_ParseAndGetReportingResponse parses
+// a canned response of as many beacons. BM_AsyncReporterFanOut sends
+// "debug_urls" debug reports of an auction through an AsyncReporter to a
+// local HTTP sink, and waits for all of them; items_per_second is the number
+// of reports sent per second.
+//
+// Run with:
+//   bazel run -c opt //services/auction_service/reporting:reporting_benchmarks
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "benchmark/benchmark.h"
+#include "services/auction_service/code_wrapper/seller_code_wrapper.h"
+#include "services/auction_service/reporting/reporting_helper.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/reporters/async_reporter.h"
+#include "services/common/util/reporting_util.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
+#include "src/cpp/concurrent/event_engine_executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kBuyerOrigin[] = "https://buyer.com";
+constexpr char kPublisherHostname[] = "publisher.com";
+constexpr char kAuctionConfig[] =
+    R"({"auctionSignals":{"currency":"USD"},"sellerSignals":{}})";
+
+// $0 is the number of beacons registered by reportResult.
+constexpr absl::string_view kSellerCode = R"JS_CODE(
+    function scoreAd(adMetadata, bid, auctionConfig, trustedScoringSignals,
+                     browserSignals, directFromSellerSignals) {
+      return {desirability: bid, allowComponentAuction: false};
+    }
+    function reportResult(auctionConfig, sellerReportingSignals,
+                          directFromSellerSignals) {
+      const beacons = {};
+      for (let i = 0; i < $0; i++) {
+        beacons["event" + i] = "https://seller.com/beacon?event=" + i;
+      }
+      sendReportTo("https://seller.com/result?bid=" +
+                   sellerReportingSignals.bid);
+      registerAdBeacon(beacons);
+      return {bid: sellerReportingSignals.bid};
+    }
+)JS_CODE";
+
+// $0 is the number of beacons registered by reportWin.
+constexpr absl::string_view kBuyerCode = R"JS_CODE(
+    reportWin = function(auctionSignals, perBuyerSignals, signalsForWinner,
+                         buyerReportingSignals, directFromSellerSignals) {
+      const beacons = {};
+      for (let i = 0; i < $0; i++) {
+        beacons["event" + i] = "https://buyer.com/beacon?event=" + i;
+      }
+      sendReportTo("https://buyer.com/win?bid=" + signalsForWinner.bid);
+      registerAdBeacon(beacons);
+    }
+)JS_CODE";
+
+ScoreAdsResponse::AdScore MakeWinningAdScore() {
+  ScoreAdsResponse::AdScore ad_score;
+  ad_score.set_render("https://buyer.com/ad?id=1");
+  ad_score.set_interest_group_name("interest_group");
+  ad_score.set_interest_group_owner(kBuyerOrigin);
+  ad_score.set_buyer_bid(2.5);
+  ad_score.set_desirability(3.5);
+  return ad_score;
+}
+
+BuyerReportingMetadata MakeBuyerReportingMetadata() {
+  return {.enable_report_win_url_generation = true,
+          .interest_group_name = "interest_group",
+          .buyer_signals = R"({"campaign":"1"})",
+          .join_count = 2,
+          .recency = 3,
+          .modeling_signals = 4};
+}
+
+// Returns the JSON of beacons of a canned reportingEntryFunction response.
+std::string MakeBeaconsJson(absl::string_view origin, int num_beacons) {
+  std::string beacons;
+  for (int i = 0; i < num_beacons; i++) {
+    absl::StrAppend(&beacons, i == 0 ? "" : ",", "\"event", i, "\":\"", origin,
+                    "/beacon?event=", i, "\"");
+  }
+  return absl::StrCat("{", beacons, "}");
+}
+
+// Accepts HTTP/1.1 connections on a local port and answers every request
+// with an empty 200, so that the fan-out to it measures the reporter and
+// libcurl rather than a remote server.
+class LocalHttpSink {
+ public:
+  LocalHttpSink() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_GE(listen_fd_, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQ(bind(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+                  sizeof(address)),
+             0);
+    CHECK_EQ(listen(listen_fd_, SOMAXCONN), 0);
+    socklen_t length = sizeof(address);
+    CHECK_EQ(getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+                         &length),
+             0);
+    port_ = ntohs(address.sin_port);
+    accept_thread_ = std::thread([this]() { AcceptLoop(); });
+  }
+
+  ~LocalHttpSink() {
+    shutdown(listen_fd_, SHUT_RDWR);
+    accept_thread_.join();
+    absl::MutexLock lock(&mu_);
+    for (int fd : connection_fds_) {
+      shutdown(fd, SHUT_RDWR);
+    }
+    for (std::thread& thread : connection_threads_) {
+      thread.join();
+    }
+    for (int fd : connection_fds_) {
+      close(fd);
+    }
+    close(listen_fd_);
+  }
+
+  // Returns the URL of `path` on the sink.
+  std::string Url(absl::string_view path) const {
+    return absl::StrCat("http://127.0.0.1:", port_, path);
+  }
+
+ private:
+  void AcceptLoop() {
+    while (true) {
+      const int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      absl::MutexLock lock(&mu_);
+      connection_fds_.push_back(fd);
+      connection_threads_.emplace_back([fd]() { Serve(fd); });
+    }
+  }
+
+  // Answers each request of the connection, as its headers end with an
+  // empty line and reports have no body.
+  static void Serve(int fd) {
+    constexpr absl::string_view kResponse =
+        "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n";
+    constexpr absl::string_view kEndOfHeaders = "\r\n\r\n";
+    std::string pending;
+    char buffer[4096];
+    while (true) {
+      const ssize_t read = recv(fd, buffer, sizeof(buffer), 0);
+      if (read <= 0) {
+        return;
+      }
+      pending.append(buffer, read);
+      size_t end;
+      while ((end = pending.find(kEndOfHeaders)) != std::string::npos) {
+        pending.erase(0, end + kEndOfHeaders.size());
+        if (send(fd, kResponse.data(), kResponse.size(), MSG_NOSIGNAL) < 0) {
+          return;
+        }
+      }
+    }
+  }
+
+  int listen_fd_;
+  int port_;
+  std::thread accept_thread_;
+  absl::Mutex mu_;
+  std::vector<int> connection_fds_ ABSL_GUARDED_BY(mu_);
+  std::vector<std::thread> connection_threads_ ABSL_GUARDED_BY(mu_);
+};
+
+void BM_GetReportingDispatchRequest(benchmark::State& state) {
+  const ScoreAdsResponse::AdScore winning_ad_score = MakeWinningAdScore();
+  const BuyerReportingMetadata buyer_reporting_metadata =
+      MakeBuyerReportingMetadata();
+  auto auction_config = std::make_shared<std::string>(kAuctionConfig);
+  ContextLogger logger;
+  for (auto _ : state) {
+    DispatchRequest request = GetReportingDispatchRequest(
+        winning_ad_score, kPublisherHostname,
+        /*enable_adtech_code_logging=*/false, auction_config, logger,
+        buyer_reporting_metadata);
+    benchmark::DoNotOptimize(request);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ReportingDispatch(benchmark::State& state) {
+  const int num_beacons = state.range(0);
+  V8Dispatcher dispatcher;
+  DispatchConfig config;
+  CHECK(dispatcher.Init(config).ok());
+  CHECK(dispatcher
+            .LoadSync(kDispatchRequestVersionNumber,
+                      GetSellerWrappedCode(
+                          absl::Substitute(kSellerCode, num_beacons),
+                          /*enable_report_result_url_generation=*/true,
+                          /*enable_report_win_url_generation=*/true,
+                          {{kBuyerOrigin,
+                            absl::Substitute(kBuyerCode, num_beacons)}}))
+            .ok());
+  CodeDispatchClient client(dispatcher);
+
+  const ScoreAdsResponse::AdScore winning_ad_score = MakeWinningAdScore();
+  const BuyerReportingMetadata buyer_reporting_metadata =
+      MakeBuyerReportingMetadata();
+  auto auction_config = std::make_shared<std::string>(kAuctionConfig);
+  ContextLogger logger;
+  for (auto _ : state) {
+    std::vector<DispatchRequest> batch;
+    batch.push_back(GetReportingDispatchRequest(
+        winning_ad_score, kPublisherHostname,
+        /*enable_adtech_code_logging=*/false, auction_config, logger,
+        buyer_reporting_metadata));
+    absl::Notification done;
+    CHECK(client
+              .BatchExecute(
+                  batch,
+                  [&done, num_beacons](
+                      const std::vector<absl::StatusOr<DispatchResponse>>&
+                          responses) {
+                    CHECK(responses[0].ok()) << responses[0].status();
+                    absl::StatusOr<ReportingResponse> response =
+                        ParseAndGetReportingResponse(
+                            /*enable_adtech_code_logging=*/false,
+                            responses[0]->resp);
+                    CHECK(response.ok()) << response.status();
+                    CHECK_EQ(response->report_win_response
+                                 .interaction_reporting_urls.size(),
+                             num_beacons);
+                    done.Notify();
+                  })
+              .ok());
+    done.WaitForNotification();
+  }
+  state.SetItemsProcessed(state.iterations());
+  CHECK(dispatcher.Stop().ok());
+}
+
+void BM_ParseAndGetReportingResponse(benchmark::State& state) {
+  const int num_beacons = state.range(0);
+  const std::string response = absl::Substitute(
+      R"({"reportResultResponse":{"reportResultUrl":"https://seller.com/result","interactionReportingUrls":$0,"sendReportToInvoked":true,"registerAdBeaconInvoked":true},"sellerLogs":[],"reportWinResponse":{"reportWinUrl":"https://buyer.com/win","interactionReportingUrls":$1,"sendReportToInvoked":true,"registerAdBeaconInvoked":true},"buyerLogs":[]})",
+      MakeBeaconsJson("https://seller.com", num_beacons),
+      MakeBeaconsJson(kBuyerOrigin, num_beacons));
+  for (auto _ : state) {
+    absl::StatusOr<ReportingResponse> reporting_response =
+        ParseAndGetReportingResponse(/*enable_adtech_code_logging=*/false,
+                                     response);
+    benchmark::DoNotOptimize(reporting_response);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_AsyncReporterFanOut(benchmark::State& state) {
+  const int num_reports = state.range(0);
+  LocalHttpSink sink;
+  server_common::EventEngineExecutor executor(
+      grpc_event_engine::experimental::CreateEventEngine());
+  // As the reporter of the server, but with the single attempt of a local
+  // sink that never fails.
+  AsyncReporter reporter(
+      std::make_unique<MultiCurlHttpFetcherAsync>(&executor),
+      {.max_queued_reports = kServerReportingOptions.max_queued_reports,
+       .max_in_flight_per_host =
+           kServerReportingOptions.max_in_flight_per_host},
+      &executor);
+  const std::string debug_url = sink.Url(
+      absl::StrCat("/debugLoss?bid=", kWinningBidPlaceholder,
+                   "&other=", kHighestScoringOtherBidPlaceholder,
+                   "&reason=", kRejectReasonPlaceholder));
+  PostAuctionSignals post_auction_signals =
+      GeneratePostAuctionSignals(MakeWinningAdScore());
+  for (auto _ : state) {
+    absl::BlockingCounter done(num_reports);
+    for (int i = 0; i < num_reports; i++) {
+      reporter.DoReport(
+          CreateDebugReportingHttpRequest(
+              debug_url, GetPlaceholderDataForInterestGroup(
+                             kBuyerOrigin, absl::StrCat("interest_group_", i),
+                             post_auction_signals)),
+          [&done](absl::StatusOr<absl::string_view> result) {
+            CHECK(result.ok()) << result.status();
+            done.DecrementCount();
+          });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_reports);
+}
+
+BENCHMARK(BM_GetReportingDispatchRequest);
+BENCHMARK(BM_ReportingDispatch)
+    ->ArgName("interaction_urls")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(100)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+BENCHMARK(BM_ParseAndGetReportingResponse)
+    ->ArgName("interaction_urls")
+    ->Arg(0)
+    ->Arg(10)
+    ->Arg(100);
+BENCHMARK(BM_AsyncReporterFanOut)
+    ->ArgName("debug_urls")
+    ->Arg(1)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Unit(benchmark::kMicrosecond)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -29,10 +29,41 @@ inline constexpr char ENABLE_AUCTION_SERVICE_BENCHMARK[] =
 inline constexpr char SELLER_CODE_FETCH_CONFIG[] = "SELLER_CODE_FETCH_CONFIG";
 inline constexpr char JS_NUM_WORKERS[] = "JS_NUM_WORKERS";
 inline constexpr char JS_WORKER_QUEUE_LEN[] = "JS_WORKER_QUEUE_LEN";
+inline constexpr char CRYPTO_WORKER_POOL_SIZE[] = "CRYPTO_WORKER_POOL_SIZE";
+inline constexpr char CRYPTO_OFFLOAD_THRESHOLD_BYTES[] =
+    "CRYPTO_OFFLOAD_THRESHOLD_BYTES";
+inline constexpr char JS_WORKER_CPUS[] = "JS_WORKER_CPUS";
+inline constexpr char JS_WORKER_NUMA_NODE[] = "JS_WORKER_NUMA_NODE";
+inline constexpr char SERVER_CPUS[] = "SERVER_CPUS";
+inline constexpr char JS_INITIAL_HEAP_SIZE_MB[] = "JS_INITIAL_HEAP_SIZE_MB";
+inline constexpr char JS_MAX_HEAP_SIZE_MB[] = "JS_MAX_HEAP_SIZE_MB";
+inline constexpr char JS_WORKER_MAX_MEMORY_MB[] = "JS_WORKER_MAX_MEMORY_MB";
+inline constexpr char LARGE_BUFFER_HUGE_PAGES[] = "LARGE_BUFFER_HUGE_PAGES";
+inline constexpr char REPORTING_THREADS[] = "REPORTING_THREADS";
+inline constexpr char REPORTING_MAX_IN_FLIGHT[] = "REPORTING_MAX_IN_FLIGHT";
+inline constexpr char DEBUG_LOSS_REPORTS_PER_REQUEST[] =
+    "DEBUG_LOSS_REPORTS_PER_REQUEST";
+inline constexpr char DEBUG_LOSS_REPORTS_PER_SECOND[] =
+    "DEBUG_LOSS_REPORTS_PER_SECOND";
+inline constexpr char DEBUG_LOSS_REPORT_PERCENT[] = "DEBUG_LOSS_REPORT_PERCENT";
+inline constexpr char RUNTIME_CONFIG_REFRESH_PERIOD_MS[] =
+    "RUNTIME_CONFIG_REFRESH_PERIOD_MS";
 
 inline constexpr absl::string_view kFlags[] = {
     PORT, ENABLE_AUCTION_SERVICE_BENCHMARK, SELLER_CODE_FETCH_CONFIG,
-    JS_NUM_WORKERS, JS_WORKER_QUEUE_LEN};
+    JS_NUM_WORKERS, JS_WORKER_QUEUE_LEN, CRYPTO_WORKER_POOL_SIZE,
+    CRYPTO_OFFLOAD_THRESHOLD_BYTES, JS_WORKER_CPUS, JS_WORKER_NUMA_NODE,
+    SERVER_CPUS, JS_INITIAL_HEAP_SIZE_MB, JS_MAX_HEAP_SIZE_MB,
+    JS_WORKER_MAX_MEMORY_MB, LARGE_BUFFER_HUGE_PAGES, REPORTING_THREADS,
+    REPORTING_MAX_IN_FLIGHT,
+    DEBUG_LOSS_REPORTS_PER_REQUEST, DEBUG_LOSS_REPORTS_PER_SECOND,
+    DEBUG_LOSS_REPORT_PERCENT, RUNTIME_CONFIG_REFRESH_PERIOD_MS};
+
+// Flags that can change while the server runs, refreshed every
+// RUNTIME_CONFIG_REFRESH_PERIOD_MS.
+inline constexpr absl::string_view kRefreshableFlags[] = {
+    ROMA_TIMEOUT_MS, CONCURRENCY_LIMIT_MAX, DEBUG_LOSS_REPORTS_PER_REQUEST,
+    DEBUG_LOSS_REPORTS_PER_SECOND, DEBUG_LOSS_REPORT_PERCENT};
 
 inline std::vector<absl::string_view> GetServiceFlags() {
   int size = sizeof(kFlags) / sizeof(kFlags[0]);
@@ -0,0 +1,223 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/auction_service/score_ad_output.h"
+
+#include <utility>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "services/common/util/status_macros.h"
+
+#ifdef BIDDING_AUCTION_SIMDJSON
+#include "simdjson.h"
+#endif
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+#ifdef BIDDING_AUCTION_SIMDJSON
+
+namespace {
+
+absl::Status ToStatus(simdjson::error_code error) {
+  return absl::InvalidArgumentError(
+      absl::StrCat("JSON Parse Error: ", simdjson::error_message(error)));
+}
+
+// Parsers keep their buffers across the strings they parse, so each thread
+// reuses its own.
+simdjson::ondemand::parser& ThreadParser() {
+  thread_local simdjson::ondemand::parser parser;
+  return parser;
+}
+
+// Calls on_member with the key and value of each member of object. Values of
+// unexpected types are left for on_member to skip.
+template <typename OnMember>
+absl::Status ForEachMember(simdjson::ondemand::object& object,
+                           OnMember on_member) {
+  for (auto member : object) {
+    simdjson::ondemand::field field;
+    std::string_view key;
+    if (auto error = std::move(member).get(field); error) {
+      return ToStatus(error);
+    }
+    if (auto error = field.unescaped_key().get(key); error) {
+      return ToStatus(error);
+    }
+    PS_RETURN_IF_ERROR(on_member(key, field.value()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status ReadDebugReportUrls(simdjson::ondemand::value& value,
+                                 DebugReportUrls& debug_report_urls) {
+  simdjson::ondemand::object object;
+  if (value.get_object().get(object)) {
+    return absl::OkStatus();
+  }
+  return ForEachMember(object, [&debug_report_urls](
+                                   std::string_view key,
+                                   simdjson::ondemand::value& url_value) {
+    std::string_view url;
+    if (url_value.get_string().get(url)) {
+      return absl::OkStatus();
+    }
+    if (key == kAuctionDebugWinUrlPropertyForScoreAd) {
+      debug_report_urls.set_auction_debug_win_url(std::string(url));
+    } else if (key == kAuctionDebugLossUrlPropertyForScoreAd) {
+      debug_report_urls.set_auction_debug_loss_url(std::string(url));
+    }
+    return absl::OkStatus();
+  });
+}
+
+// Reads the "response" object of a scoreAdEntryFunction() output. Fields of
+// unexpected types keep their defaults, as with rapidjson.
+absl::Status ReadScoreAdResponse(simdjson::ondemand::value& value,
+                                 ScoreAdOutput& output) {
+  simdjson::ondemand::object object;
+  if (value.get_object().get(object)) {
+    return absl::OkStatus();
+  }
+  return ForEachMember(object, [&output](std::string_view key,
+                                         simdjson::ondemand::value& field) {
+    if (key == kDesirabilityPropertyForScoreAd) {
+      if (double desirability; !field.get_double().get(desirability)) {
+        output.score.set_desirability(desirability);
+      }
+    } else if (key == kAllowComponentAuctionPropertyForScoreAd) {
+      if (bool allow; !field.get_bool().get(allow)) {
+        output.score.set_allow_component_auction(allow);
+      }
+    } else if (key == kRejectReasonPropertyForScoreAd) {
+      if (std::string_view reason; !field.get_string().get(reason)) {
+        output.reject_reason = std::string(reason);
+      }
+    } else if (key == kDebugReportUrlsPropertyForScoreAd) {
+      return ReadDebugReportUrls(field,
+                                 *output.score.mutable_debug_report_urls());
+    }
+    return absl::OkStatus();
+  });
+}
+
+absl::Status LogAdTechLogs(simdjson::ondemand::value& value,
+                           absl::string_view prefix,
+                           const ContextLogger& logger) {
+  simdjson::ondemand::array logs;
+  if (value.get_array().get(logs)) {
+    return absl::OkStatus();
+  }
+  for (auto log_value : logs) {
+    std::string_view log;
+    if (auto error = log_value.get_string().get(log); error) {
+      return ToStatus(error);
+    }
+    logger.vlog(1, prefix, absl::string_view(log.data(), log.size()));
+  }
+  return absl::OkStatus();
+}
+
+// Reads one scoreAdEntryFunction() output, with the "response" of scoreAd()
+// and the AdTech logs of the call.
+absl::Status ReadScoreAdEntryOutput(simdjson::ondemand::object& object,
+                                    bool enable_adtech_code_logging,
+                                    const ContextLogger& logger,
+                                    ScoreAdOutput& output) {
+  return ForEachMember(object, [&](std::string_view key,
+                                   simdjson::ondemand::value& value) {
+    if (key == "response") {
+      return ReadScoreAdResponse(value, output);
+    }
+    if (key == kExecutionTimeMsPropertyForScoreAd) {
+      if (double execution_time_ms;
+          !value.get_double().get(execution_time_ms)) {
+        output.execution_time = absl::Milliseconds(execution_time_ms);
+      }
+      return absl::OkStatus();
+    }
+    if (!enable_adtech_code_logging) {
+      return absl::OkStatus();
+    }
+    if (key == "logs") {
+      return LogAdTechLogs(value, "Logs: ", logger);
+    } else if (key == "warnings") {
+      return LogAdTechLogs(value, "Warnings: ", logger);
+    } else if (key == "errors") {
+      return LogAdTechLogs(value, "Errors: ", logger);
+    }
+    return absl::OkStatus();
+  });
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<ScoreAdOutput>> ParseScoreAdOutputsOnDemand(
+    absl::string_view response, int batch_size,
+    bool enable_adtech_code_logging, const ContextLogger& logger) {
+  // simdjson reads up to SIMDJSON_PADDING bytes past the end of its input.
+  const simdjson::padded_string padded(response.data(), response.size());
+  simdjson::ondemand::document document;
+  if (auto error = ThreadParser().iterate(padded).get(document); error) {
+    return ToStatus(error);
+  }
+  std::vector<ScoreAdOutput> outputs;
+  if (batch_size <= 0) {
+    simdjson::ondemand::object object;
+    if (auto error = document.get_object().get(object); error) {
+      return ToStatus(error);
+    }
+    PS_RETURN_IF_ERROR(ReadScoreAdEntryOutput(
+        object, enable_adtech_code_logging, logger, outputs.emplace_back()));
+    return outputs;
+  }
+  const auto batch_size_error = [batch_size]() {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected an array of ", batch_size, " scoreAd outputs in batch"));
+  };
+  simdjson::ondemand::array array;
+  if (document.get_array().get(array)) {
+    return batch_size_error();
+  }
+  outputs.reserve(batch_size);
+  for (auto element : array) {
+    if (outputs.size() == static_cast<size_t>(batch_size)) {
+      return batch_size_error();
+    }
+    simdjson::ondemand::object object;
+    if (element.get_object().get(object)) {
+      return absl::InvalidArgumentError("Malformed scoreAd output in batch");
+    }
+    PS_RETURN_IF_ERROR(ReadScoreAdEntryOutput(
+        object, enable_adtech_code_logging, logger, outputs.emplace_back()));
+  }
+  if (outputs.size() != static_cast<size_t>(batch_size)) {
+    return batch_size_error();
+  }
+  return outputs;
+}
+
+#else
+
+absl::StatusOr<std::vector<ScoreAdOutput>> ParseScoreAdOutputsOnDemand(
+    absl::string_view response, int batch_size,
+    bool enable_adtech_code_logging, const ContextLogger& logger) {
+  return absl::UnimplementedError(
+      "Not built with the on-demand JSON parser (--//:json_parser=simdjson)");
+}
+
+#endif  // BIDDING_AUCTION_SIMDJSON
+
+}  // namespace privacy_sandbox::bidding_auction_servers
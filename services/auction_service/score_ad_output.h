@@ -0,0 +1,66 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_AUCTION_SERVICE_SCORE_AD_OUTPUT_H_
+#define SERVICES_AUCTION_SERVICE_SCORE_AD_OUTPUT_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "services/common/util/context_logger.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// The following fields are expected to returned by ScoreAd response
+inline constexpr char kDesirabilityPropertyForScoreAd[] = "desirability";
+inline constexpr char kAllowComponentAuctionPropertyForScoreAd[] =
+    "allowComponentAuction";
+inline constexpr char kRejectReasonPropertyForScoreAd[] = "rejectReason";
+inline constexpr char kDebugReportUrlsPropertyForScoreAd[] = "debugReportUrls";
+inline constexpr char kAuctionDebugLossUrlPropertyForScoreAd[] =
+    "auctionDebugLossUrl";
+inline constexpr char kAuctionDebugWinUrlPropertyForScoreAd[] =
+    "auctionDebugWinUrl";
+// Property of the scoreAdEntryFunction() output, next to the response,
+// holding the milliseconds the scoreAd() call took.
+inline constexpr char kExecutionTimeMsPropertyForScoreAd[] = "executionTimeMs";
+
+// The fields of the scoreAd() response of an ad that the auction reads.
+struct ScoreAdOutput {
+  // Desirability, allow_component_auction and debug_report_urls of the ad.
+  ScoreAdsResponse::AdScore score;
+  // Reason the seller rejected the ad for, if any.
+  std::string reject_reason;
+  // Time the scoreAd() call of the ad took, if the output has it.
+  std::optional<absl::Duration> execution_time;
+};
+
+// Parses the scoreAdEntryFunction() output, or when batch_size is above 0 the
+// scoreAdsBatchEntryFunction() output of batch_size ads, with the on-demand
+// JSON parser (see json_on_demand.h), logging the AdTech logs it holds if
+// enable_adtech_code_logging is set. Only the fields above are read, without
+// building a document. Returns an Unimplemented error if the parser is not
+// built in.
+absl::StatusOr<std::vector<ScoreAdOutput>> ParseScoreAdOutputsOnDemand(
+    absl::string_view response, int batch_size,
+    bool enable_adtech_code_logging, const ContextLogger& logger);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_AUCTION_SERVICE_SCORE_AD_OUTPUT_H_
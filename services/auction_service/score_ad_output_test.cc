@@ -0,0 +1,113 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/auction_service/score_ad_output.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "services/common/util/json_on_demand.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kScoreAdEntryOutput[] =
+    R"JSON({"response":{"desirability":2.5,"allowComponentAuction":true,)JSON"
+    R"JSON("rejectReason":"invalid-bid","ad":{"nested":[1,{"x":"y"}]},)JSON"
+    R"JSON("debugReportUrls":{"auctionDebugLossUrl":"https:\/\/loss.com",)JSON"
+    R"JSON("auctionDebugWinUrl":"https://win.com"}},"logs":["log"],)JSON"
+    R"JSON("warnings":[],"errors":[]})JSON";
+
+class ScoreAdOutputTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!IsOnDemandJsonParserBuiltIn()) {
+      GTEST_SKIP() << "Not built with the on-demand JSON parser";
+    }
+  }
+
+  ContextLogger logger_;
+};
+
+TEST_F(ScoreAdOutputTest, ReadsTheFieldsOfTheScoreAdResponse) {
+  absl::StatusOr<std::vector<ScoreAdOutput>> outputs =
+      ParseScoreAdOutputsOnDemand(kScoreAdEntryOutput, /*batch_size=*/0,
+                                  /*enable_adtech_code_logging=*/true,
+                                  logger_);
+  ASSERT_TRUE(outputs.ok()) << outputs.status();
+  ASSERT_EQ(outputs->size(), 1);
+  const ScoreAdOutput& output = outputs->front();
+  EXPECT_EQ(output.score.desirability(), 2.5);
+  EXPECT_TRUE(output.score.allow_component_auction());
+  EXPECT_EQ(output.reject_reason, "invalid-bid");
+  EXPECT_EQ(output.score.debug_report_urls().auction_debug_win_url(),
+            "https://win.com");
+  EXPECT_EQ(output.score.debug_report_urls().auction_debug_loss_url(),
+            "https://loss.com");
+}
+
+TEST_F(ScoreAdOutputTest, KeepsTheDefaultsOfFieldsOfOtherTypes) {
+  absl::StatusOr<std::vector<ScoreAdOutput>> outputs =
+      ParseScoreAdOutputsOnDemand(
+          R"JSON({"response":{"desirability":"2",)JSON"
+          R"JSON("allowComponentAuction":1,"rejectReason":null}})JSON",
+          /*batch_size=*/0, /*enable_adtech_code_logging=*/false, logger_);
+  ASSERT_TRUE(outputs.ok()) << outputs.status();
+  ASSERT_EQ(outputs->size(), 1);
+  EXPECT_EQ(outputs->front().score.desirability(), 0);
+  EXPECT_FALSE(outputs->front().score.allow_component_auction());
+  EXPECT_FALSE(outputs->front().score.has_debug_report_urls());
+  EXPECT_EQ(outputs->front().reject_reason, "");
+}
+
+TEST_F(ScoreAdOutputTest, ReadsTheExecutionTimeOfTheScoreAdCall) {
+  absl::StatusOr<std::vector<ScoreAdOutput>> outputs =
+      ParseScoreAdOutputsOnDemand(
+          R"JSON([{"response":{},"executionTimeMs":12},)JSON"
+          R"JSON({"response":{}}])JSON",
+          /*batch_size=*/2, /*enable_adtech_code_logging=*/false, logger_);
+  ASSERT_TRUE(outputs.ok()) << outputs.status();
+  ASSERT_EQ(outputs->size(), 2);
+  EXPECT_EQ((*outputs)[0].execution_time, absl::Milliseconds(12));
+  EXPECT_EQ((*outputs)[1].execution_time, std::nullopt);
+}
+
+TEST_F(ScoreAdOutputTest, ReadsEachAdOfABatch) {
+  absl::StatusOr<std::vector<ScoreAdOutput>> outputs =
+      ParseScoreAdOutputsOnDemand(
+          R"JSON([{"response":{"desirability":1}},)JSON"
+          R"JSON({"response":{"desirability":2}}])JSON",
+          /*batch_size=*/2, /*enable_adtech_code_logging=*/false, logger_);
+  ASSERT_TRUE(outputs.ok()) << outputs.status();
+  ASSERT_EQ(outputs->size(), 2);
+  EXPECT_EQ((*outputs)[0].score.desirability(), 1);
+  EXPECT_EQ((*outputs)[1].score.desirability(), 2);
+
+  EXPECT_FALSE(ParseScoreAdOutputsOnDemand(
+                   R"JSON([{"response":{"desirability":1}}])JSON",
+                   /*batch_size=*/2, /*enable_adtech_code_logging=*/false,
+                   logger_)
+                   .ok());
+  EXPECT_FALSE(ParseScoreAdOutputsOnDemand(
+                   R"JSON([{"response":{}},1])JSON", /*batch_size=*/2,
+                   /*enable_adtech_code_logging=*/false, logger_)
+                   .ok());
+  EXPECT_FALSE(ParseScoreAdOutputsOnDemand(
+                   R"JSON({"response":{}})JSON", /*batch_size=*/2,
+                   /*enable_adtech_code_logging=*/false, logger_)
+                   .ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,88 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/auction_service/score_ad_result_cache.h"
+
+#include <functional>
+#include <string_view>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Separates the length of the reject reason from the rest of a cached output.
+constexpr absl::string_view kRejectReasonSeparator = ":";
+
+}  // namespace
+
+ScoreAdResultCache::ScoreAdResultCache(absl::Duration ttl, size_t max_bytes)
+    : cache_(ttl, max_bytes) {}
+
+std::string ScoreAdResultCache::Key(
+    int code_version, const std::vector<std::shared_ptr<std::string>>& input) {
+  // Two independent 64 bit hashes, both covering the argument lengths so that
+  // moving bytes from one argument to the next changes the key.
+  size_t first = absl::HashOf(input.size());
+  size_t second = std::hash<size_t>{}(input.size());
+  for (const std::shared_ptr<std::string>& argument : input) {
+    const absl::string_view value =
+        argument == nullptr ? absl::string_view() : *argument;
+    first = absl::HashOf(first, value);
+    second ^= std::hash<std::string_view>{}(
+                  std::string_view(value.data(), value.size())) +
+              value.size() + 0x9e3779b97f4a7c15 + (second << 6) +
+              (second >> 2);
+  }
+  return absl::StrCat(code_version, "/", absl::Hex(first, absl::kZeroPad16),
+                      absl::Hex(second, absl::kZeroPad16));
+}
+
+std::optional<ScoreAdOutput> ScoreAdResultCache::LookUp(absl::string_view key) {
+  std::shared_ptr<const std::string> cached = cache_.LookUp(key);
+  if (cached == nullptr) {
+    return std::nullopt;
+  }
+  // The reject reason, prefixed with its length, then the serialized score.
+  const absl::string_view value = *cached;
+  const size_t separator = value.find(kRejectReasonSeparator);
+  size_t reject_reason_size;
+  if (separator == absl::string_view::npos ||
+      !absl::SimpleAtoi(value.substr(0, separator), &reject_reason_size) ||
+      reject_reason_size > value.size() - separator - 1) {
+    return std::nullopt;
+  }
+  const absl::string_view rest = value.substr(separator + 1);
+  ScoreAdOutput output;
+  output.reject_reason = std::string(rest.substr(0, reject_reason_size));
+  if (!output.score.ParseFromArray(rest.data() + reject_reason_size,
+                                   rest.size() - reject_reason_size)) {
+    return std::nullopt;
+  }
+  return output;
+}
+
+void ScoreAdResultCache::Insert(absl::string_view key,
+                                const ScoreAdOutput& output) {
+  cache_.Insert(key,
+                absl::StrCat(output.reject_reason.size(),
+                             kRejectReasonSeparator, output.reject_reason,
+                             output.score.SerializeAsString()),
+                cache_.ttl());
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
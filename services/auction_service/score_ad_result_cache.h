@@ -0,0 +1,67 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_AUCTION_SERVICE_SCORE_AD_RESULT_CACHE_H_
+#define SERVICES_AUCTION_SERVICE_SCORE_AD_RESULT_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "services/auction_service/score_ad_output.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Process wide, thread-safe cache of the scoreAd() outputs of ads, for sellers
+// whose scoreAd is a deterministic function of its arguments. Ads scored with
+// byte-identical arguments by the same code, such as the same bid retried or
+// repeated within the TTL, then skip the dispatch to Roma.
+// Outputs are keyed by the version of the code that produced them and a 128
+// bit hash of the arguments, so that every code load leaves the previous
+// outputs unused until they expire or are evicted.
+class ScoreAdResultCache {
+ public:
+  // ttl: the longest time an output is cached.
+  // max_bytes: bound on the bytes of the keys and outputs held.
+  ScoreAdResultCache(absl::Duration ttl, size_t max_bytes);
+
+  // Returns the key of the output of scoreAd for the arguments, as run by the
+  // code of code_version (see CodeDispatchClient::CodeVersion).
+  static std::string Key(
+      int code_version, const std::vector<std::shared_ptr<std::string>>& input);
+
+  // Returns the output cached under key, if any.
+  std::optional<ScoreAdOutput> LookUp(absl::string_view key);
+
+  // Caches the output under key for the ttl of the cache.
+  void Insert(absl::string_view key, const ScoreAdOutput& output);
+
+  // Bytes of the keys and outputs currently cached.
+  size_t bytes() const { return cache_.bytes(); }
+
+  // See KeyValueCache::SetCapacityScale.
+  void SetCapacityScale(double scale) { cache_.SetCapacityScale(scale); }
+
+ private:
+  KeyValueCache cache_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_AUCTION_SERVICE_SCORE_AD_RESULT_CACHE_H_
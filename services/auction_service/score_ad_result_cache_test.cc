@@ -0,0 +1,78 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/auction_service/score_ad_result_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::vector<std::shared_ptr<std::string>> Input(
+    const std::vector<std::string>& arguments) {
+  std::vector<std::shared_ptr<std::string>> input;
+  for (const std::string& argument : arguments) {
+    input.push_back(std::make_shared<std::string>(argument));
+  }
+  return input;
+}
+
+TEST(ScoreAdResultCacheTest, KeysTheExactArgumentsAndCodeVersion) {
+  const std::string key = ScoreAdResultCache::Key(1, Input({"ab", "c"}));
+  EXPECT_EQ(ScoreAdResultCache::Key(1, Input({"ab", "c"})), key);
+  EXPECT_NE(ScoreAdResultCache::Key(2, Input({"ab", "c"})), key);
+  EXPECT_NE(ScoreAdResultCache::Key(1, Input({"a", "bc"})), key);
+  EXPECT_NE(ScoreAdResultCache::Key(1, Input({"ab", "c", ""})), key);
+  EXPECT_NE(ScoreAdResultCache::Key(1, Input({"ab", "d"})), key);
+}
+
+TEST(ScoreAdResultCacheTest, ReturnsTheCachedOutput) {
+  ScoreAdResultCache cache(absl::Minutes(1), 1 << 20);
+  const std::string key = ScoreAdResultCache::Key(1, Input({"ad", "bid"}));
+  EXPECT_FALSE(cache.LookUp(key).has_value());
+
+  ScoreAdOutput output;
+  output.score.set_desirability(2.5);
+  output.score.set_allow_component_auction(true);
+  output.reject_reason = "invalid-bid";
+  cache.Insert(key, output);
+  std::optional<ScoreAdOutput> cached = cache.LookUp(key);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->score.desirability(), 2.5);
+  EXPECT_TRUE(cached->score.allow_component_auction());
+  EXPECT_EQ(cached->reject_reason, "invalid-bid");
+  EXPECT_GT(cache.bytes(), 0);
+
+  cache.Insert(key, ScoreAdOutput());
+  cached = cache.LookUp(key);
+  ASSERT_TRUE(cached.has_value());
+  EXPECT_EQ(cached->score.desirability(), 0);
+  EXPECT_TRUE(cached->reject_reason.empty());
+}
+
+TEST(ScoreAdResultCacheTest, ExpiresTheOutputs) {
+  ScoreAdResultCache cache(absl::Milliseconds(10), 1 << 20);
+  const std::string key = ScoreAdResultCache::Key(1, Input({"ad"}));
+  cache.Insert(key, ScoreAdOutput());
+  absl::SleepFor(absl::Milliseconds(20));
+  EXPECT_FALSE(cache.LookUp(key).has_value());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
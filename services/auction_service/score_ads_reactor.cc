@@ -15,83 +15,129 @@
 #include "score_ads_reactor.h"
 
 #include <algorithm>
+#include <deque>
 #include <limits>
-#include <list>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include <google/protobuf/text_format.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
 #include <google/protobuf/util/json_util.h>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_replace.h"
+#include "absl/strings/string_view.h"
 #include "glog/log_severity.h"
 #include "glog/logging.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "rapidjson/pointer.h"
+#include "rapidjson/reader.h"
 #include "rapidjson/stringbuffer.h"
 #include "rapidjson/writer.h"
 #include "services/auction_service/code_wrapper/seller_code_wrapper.h"
 #include "services/auction_service/reporting/reporting_helper.h"
 #include "services/auction_service/reporting/reporting_response.h"
+#include "services/common/encryption/crypto_metrics.h"
+#include "services/common/util/feature_set.h"
 #include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
 #include "services/common/util/reporting_util.h"
+#include "services/common/util/request_deadline.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/common/util/request_summary.h"
 #include "services/common/util/status_macros.h"
 #include "services/common/util/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
-using ::google::protobuf::TextFormat;
 using AdWithBidMetadata =
     ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata;
+// Render URL to the serialized trustedScoringSignals argument for that ad.
+using AdScoringSignalsMap =
+    absl::flat_hash_map<std::string, std::shared_ptr<std::string>>;
 
 constexpr char DispatchHandlerFunctionWithSellerWrapper[] =
     "scoreAdEntryFunction";
+constexpr char kScoreAdsBatchHandlerFunction[] = "scoreAdsBatchEntryFunction";
+constexpr char kScoreAdsBatchIdPrefix[] = "scoreAdsBatch:";
 constexpr char kAdComponentRenderUrlsProperty[] = "adComponentRenderUrls";
 constexpr char kRenderUrlsPropertyForKVResponse[] = "renderUrls";
 constexpr char kRenderUrlsPropertyForScoreAd[] = "renderUrl";
 constexpr char kRomaTimeoutMs[] = "TimeoutMs";
+constexpr absl::string_view kAdComponentSignalsPrefix =
+    R"({"adComponentRenderUrls":{)";
+constexpr absl::string_view kRenderUrlSignalsInfix = R"(},"renderUrl":{)";
+constexpr absl::string_view kCombinedSignalsSuffix = "}}";
 constexpr int kArgSizeDefault = 6;
 constexpr int kArgSizeWithWrapper = 7;
 
-// The following fields are expected to returned by ScoreAd response
-constexpr char kDesirabilityPropertyForScoreAd[] = "desirability";
-constexpr char kAllowComponentAuctionPropertyForScoreAd[] =
-    "allowComponentAuction";
-constexpr char kRejectReasonPropertyForScoreAd[] = "rejectReason";
-constexpr char kDebugReportUrlsPropertyForScoreAd[] = "debugReportUrls";
-constexpr char kAuctionDebugLossUrlPropertyForScoreAd[] = "auctionDebugLossUrl";
-constexpr char kAuctionDebugWinUrlPropertyForScoreAd[] = "auctionDebugWinUrl";
+// Per request invariant arguments of scoreAd, built once and shared by the
+// dispatch requests of every ad in the request.
+struct ScoreAdSharedInputs {
+  std::shared_ptr<std::string> auction_config;
+  std::shared_ptr<std::string> direct_from_seller_signals;
+  std::shared_ptr<std::string> feature_flags;
+  // The publisher hostname of the request, which outlives the shared inputs.
+  absl::string_view top_window_hostname;
+};
+
+// This is only added to prevent errors in the score ad script, and will
+// always be an empty object. Shared by all requests.
+std::shared_ptr<std::string> GetDirectFromSellerSignals() {
+  static const auto* const kDirectFromSellerSignals =
+      new std::shared_ptr<std::string>(std::make_shared<std::string>("{}"));
+  return *kDirectFromSellerSignals;
+}
+
+// Returns the feature flags JSON for the given flag combination. There are
+// only four combinations, so each one is built once per process.
+std::shared_ptr<std::string> GetSharedFeatureFlagJson(
+    bool enable_adtech_code_logging, bool enable_debug_reporting) {
+  static const auto* const kFeatureFlags = []() {
+    auto* feature_flags = new std::shared_ptr<std::string>[4];
+    for (int i = 0; i < 4; ++i) {
+      feature_flags[i] = std::make_shared<std::string>(GetFeatureFlagJson(
+          /*enable_logging=*/i & 1, /*enable_debug_url_generation=*/i & 2));
+    }
+    return feature_flags;
+  }();
+  return kFeatureFlags[(enable_adtech_code_logging ? 1 : 0) |
+                       (enable_debug_reporting ? 2 : 0)];
+}
 
 // TODO(b/259610873): Revert hardcoded device signals.
 std::string MakeDeviceSignals(
-    absl::string_view publisher_hostname,
-    absl::string_view interest_group_owner, absl::string_view render_url,
+    absl::string_view interest_group_owner,
+    absl::string_view top_window_hostname, absl::string_view render_url,
     const google::protobuf::RepeatedPtrField<std::string>&
         ad_component_render_urls) {
-  std::string device_signals =
-      absl::StrCat("{", R"("interestGroupOwner":")", interest_group_owner, "\"",
-                   R"(,"topWindowHostname":")", publisher_hostname, "\"");
-
+  // Room for the keys, quotes and separators.
+  size_t size_hint = interest_group_owner.size() +
+                     top_window_hostname.size() + render_url.size() + 80;
+  for (const auto& ad_component_render_url : ad_component_render_urls) {
+    size_hint += ad_component_render_url.size() + 3;
+  }
+  std::string device_signals;
+  JsonWriter writer(&device_signals, size_hint);
+  writer.StartObject()
+      .Key("interestGroupOwner")
+      .String(interest_group_owner)
+      .Key("topWindowHostname")
+      .String(top_window_hostname);
   if (!ad_component_render_urls.empty()) {
-    absl::StrAppend(&device_signals, R"(,"adComponents":[)");
-    for (int i = 0; i < ad_component_render_urls.size(); i++) {
-      absl::StrAppend(&device_signals, "\"", ad_component_render_urls.at(i),
-                      "\"");
-      if (i != ad_component_render_urls.size() - 1) {
-        absl::StrAppend(&device_signals, ",");
-      }
-    }
-    absl::StrAppend(&device_signals, R"(])");
+    writer.Key("adComponents").StringArray(ad_component_render_urls);
   }
-  absl::StrAppend(&device_signals, ",\"", kRenderUrlsPropertyForScoreAd,
-                  "\":\"", render_url, "\"}");
+  writer.Key("renderUrl").String(render_url).EndObject();
   return device_signals;
 }
 
@@ -121,45 +167,35 @@ constexpr int ScoreArgIndex(ScoreAdArgs arg) {
  * NOTE: All inputs MUST be valid JSON, not just something Javascript would
  * accept. Property names need to be in quotes! Additionally: See issues with
  * input formatting in b/258697130.
+ *
+ * The arguments are logged if kLogInputs.
  */
+template <bool kLogInputs>
 std::vector<std::shared_ptr<std::string>> ScoreAdInput(
-    const AdWithBidMetadata& ad, std::shared_ptr<std::string> auction_config,
-    const absl::string_view publisher_hostname,
-    const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-        scoring_signals,
-    const ContextLogger& logger, bool enable_adtech_code_logging,
-    bool enable_debug_reporting) {
+    const AdWithBidMetadata& ad, std::shared_ptr<std::string> ad_metadata_json,
+    const ScoreAdSharedInputs& shared_inputs,
+    const AdScoringSignalsMap& scoring_signals, const ContextLogger& logger) {
   std::vector<std::shared_ptr<std::string>> input(
       kArgSizeWithWrapper);  // ScoreAdArgs size
 
-  // TODO: b/260265272
-  std::string adMetadataAsJson;
-  const auto& it = ad.ad().struct_value().fields().find("metadata");
-  if (it != ad.ad().struct_value().fields().end()) {
-    google::protobuf::util::MessageToJsonString(it->second, &adMetadataAsJson);
-  }
-  input[ScoreArgIndex(ScoreAdArgs::kAdMetadata)] =
-      std::make_shared<std::string>(adMetadataAsJson);
+  input[ScoreArgIndex(ScoreAdArgs::kAdMetadata)] = std::move(ad_metadata_json);
   input[ScoreArgIndex(ScoreAdArgs::kBid)] =
       std::make_shared<std::string>(std::to_string(ad.bid()));
-  input[ScoreArgIndex(ScoreAdArgs::kAuctionConfig)] = auction_config;
+  input[ScoreArgIndex(ScoreAdArgs::kAuctionConfig)] =
+      shared_inputs.auction_config;
   // TODO(b/258697130): Roma client string support bug
   input[ScoreArgIndex(ScoreAdArgs::kScoringSignals)] =
-      std::make_shared<std::string>(
-          scoring_signals.at(ad.render()).GetString());
+      scoring_signals.at(ad.render());
   input[ScoreArgIndex(ScoreAdArgs::kDeviceSignals)] =
-      std::make_shared<std::string>(
-          MakeDeviceSignals(publisher_hostname, ad.interest_group_owner(),
-                            ad.render(), ad.ad_components()));
-  // This is only added to prevent errors in the score ad script, and
-  // will always be an empty object.
+      std::make_shared<std::string>(MakeDeviceSignals(
+          ad.interest_group_owner(), shared_inputs.top_window_hostname,
+          ad.render(), ad.ad_components()));
   input[ScoreArgIndex(ScoreAdArgs::kDirectFromSellerSignals)] =
-      std::make_shared<std::string>("{}");
+      shared_inputs.direct_from_seller_signals;
   input[ScoreArgIndex(ScoreAdArgs::kFeatureFlags)] =
-      std::make_shared<std::string>(GetFeatureFlagJson(
-          enable_adtech_code_logging, enable_debug_reporting));
+      shared_inputs.feature_flags;
 
-  if (VLOG_IS_ON(2)) {
+  if constexpr (kLogInputs) {
     logger.vlog(2, "\n\nScore Ad Input Args:", "\nAdMetadata:\n",
                 *(input[ScoreArgIndex(ScoreAdArgs::kAdMetadata)]), "\nBid:\n",
                 *(input[ScoreArgIndex(ScoreAdArgs::kBid)]),
@@ -175,27 +211,126 @@ std::vector<std::shared_ptr<std::string>> ScoreAdInput(
   return input;
 }
 
+template <bool kLogInputs>
 DispatchRequest BuildScoreAdRequest(
-    const AdWithBidMetadata& ad, std::shared_ptr<std::string> auction_config,
-    const absl::string_view publisher_hostname,
-    const absl::flat_hash_map<std::string, rapidjson::StringBuffer>&
-        scoring_signals,
-    const bool enable_debug_reporting, const ContextLogger& logger,
-    const bool enable_adtech_code_logging) {
+    const AdWithBidMetadata& ad, std::shared_ptr<std::string> ad_metadata_json,
+    const ScoreAdSharedInputs& shared_inputs,
+    const AdScoringSignalsMap& scoring_signals, const ContextLogger& logger) {
   // Construct the wrapper struct for our V8 Dispatch Request.
   DispatchRequest score_ad_request;
   // TODO(b/250893468) Revisit dispatch id.
   score_ad_request.id = ad.render();
-  // TODO(b/258790164) Update after code is fetched periodically.
+  // CodeDispatchClient replaces this with the current code version.
   score_ad_request.version_num = 1;
   score_ad_request.handler_name = DispatchHandlerFunctionWithSellerWrapper;
 
   score_ad_request.input =
-      ScoreAdInput(ad, auction_config, publisher_hostname, scoring_signals,
-                   logger, enable_adtech_code_logging, enable_debug_reporting);
+      ScoreAdInput<kLogInputs>(ad, std::move(ad_metadata_json), shared_inputs,
+                               scoring_signals, logger);
   return score_ad_request;
 }
 
+// Returns the bytes of the arguments made for the ad alone, the others being
+// shared by the ads or held by the request.
+int64_t AdInputBytes(const DispatchRequest& request) {
+  int64_t bytes = 0;
+  for (ScoreAdArgs arg : {ScoreAdArgs::kAdMetadata, ScoreAdArgs::kBid,
+                          ScoreAdArgs::kDeviceSignals}) {
+    if (const auto& input = request.input[ScoreArgIndex(arg)];
+        input != nullptr) {
+      bytes += input->size();
+    }
+  }
+  return bytes;
+}
+
+// Features of a request tested for each of its ads, see WithFeatureSet.
+enum ScoreAdFeature : int {
+  // VLOG_IS_ON(2).
+  kLogScoreAdInputs = 1 << 0,
+  kPreScoringFilter = 1 << 1,
+  kScoreAdResultCache = 1 << 2,
+  kChargeMemoryBudget = 1 << 3,
+};
+constexpr int kNumScoreAdFeatures = 4;
+
+// See scoreAdsBatchEntryFunction in seller_code_wrapper.h.
+enum class ScoreAdsBatchArgs : int {
+  kAds = 0,
+  kAuctionConfig,
+  kDirectFromSellerSignals,
+  kFeatureFlags,
+};
+
+constexpr int ScoreAdsBatchArgIndex(ScoreAdsBatchArgs arg) {
+  return static_cast<std::underlying_type_t<ScoreAdsBatchArgs>>(arg);
+}
+
+// Groups per ad dispatch requests into requests for scoreAdsBatchEntryFunction
+// holding up to batch_size ads each. The per ad arguments are spliced into the
+// ads array argument as they are, so each ad is serialized only once. The ids
+// of the ads in each batch are recorded in batched_ad_ids, keyed by the id of
+// the batch dispatch request, in the order the batch returns their scores.
+std::vector<DispatchRequest> BuildScoreAdsBatchRequests(
+    std::vector<DispatchRequest> per_ad_requests, int batch_size,
+    const ScoreAdSharedInputs& shared_inputs,
+    absl::flat_hash_map<std::string, std::vector<std::string>>&
+        batched_ad_ids) {
+  std::vector<DispatchRequest> batch_requests;
+  batch_requests.reserve((per_ad_requests.size() + batch_size - 1) /
+                         batch_size);
+  for (int begin = 0; begin < per_ad_requests.size(); begin += batch_size) {
+    const int end = std::min<int>(begin + batch_size, per_ad_requests.size());
+    DispatchRequest batch_request;
+    batch_request.id = absl::StrCat(kScoreAdsBatchIdPrefix, begin / batch_size);
+    batch_request.version_num = per_ad_requests[begin].version_num;
+    batch_request.handler_name = kScoreAdsBatchHandlerFunction;
+    batch_request.tags = per_ad_requests[begin].tags;
+    std::vector<std::string>& ad_ids = batched_ad_ids[batch_request.id];
+    ad_ids.reserve(end - begin);
+
+    auto ads = std::make_shared<std::string>();
+    JsonWriter writer(ads.get());
+    writer.StartArray();
+    for (int i = begin; i < end; i++) {
+      const auto& input = per_ad_requests[i].input;
+      const std::string& ad_metadata =
+          *input[ScoreArgIndex(ScoreAdArgs::kAdMetadata)];
+      writer.StartObject().Key("adMetadata");
+      if (ad_metadata.empty()) {
+        writer.Null();
+      } else {
+        writer.RawValue(ad_metadata);
+      }
+      writer.Key("bid")
+          .RawValue(*input[ScoreArgIndex(ScoreAdArgs::kBid)])
+          .Key("trustedScoringSignals")
+          .RawValue(*input[ScoreArgIndex(ScoreAdArgs::kScoringSignals)])
+          .Key("browserSignals")
+          .RawValue(*input[ScoreArgIndex(ScoreAdArgs::kDeviceSignals)])
+          .EndObject();
+      ad_ids.push_back(std::move(per_ad_requests[i].id));
+    }
+    writer.EndArray();
+
+    batch_request.input.resize(
+        ScoreAdsBatchArgIndex(ScoreAdsBatchArgs::kFeatureFlags) + 1);
+    batch_request.input[ScoreAdsBatchArgIndex(ScoreAdsBatchArgs::kAds)] =
+        std::move(ads);
+    batch_request
+        .input[ScoreAdsBatchArgIndex(ScoreAdsBatchArgs::kAuctionConfig)] =
+        shared_inputs.auction_config;
+    batch_request.input[ScoreAdsBatchArgIndex(
+        ScoreAdsBatchArgs::kDirectFromSellerSignals)] =
+        shared_inputs.direct_from_seller_signals;
+    batch_request
+        .input[ScoreAdsBatchArgIndex(ScoreAdsBatchArgs::kFeatureFlags)] =
+        shared_inputs.feature_flags;
+    batch_requests.push_back(std::move(batch_request));
+  }
+  return batch_requests;
+}
+
 // Builds a map of render urls to JSON objects holding the scoring signals.
 // An entry looks like: url_to_signals["fooAds.com/123"] = {"fooAds.com/123":
 // {"some", "scoring", "signals"}}. Notice the render URL is present in the map
@@ -203,7 +338,8 @@ DispatchRequest BuildScoreAdRequest(
 // intentional, as it allows moving the key to the new signals objects being
 // built for each AdWithBid.
 absl::flat_hash_map<std::string, rapidjson::Document> BuildAdScoringSignalsMap(
-    rapidjson::Value& trusted_scoring_signals_value) {
+    rapidjson::Value& trusted_scoring_signals_value,
+    rapidjson::Document::AllocatorType& allocator) {
   absl::flat_hash_map<std::string, rapidjson::Document> url_to_signals;
   for (rapidjson::Value::MemberIterator itr =
            trusted_scoring_signals_value.MemberBegin();
@@ -211,8 +347,8 @@ absl::flat_hash_map<std::string, rapidjson::Document> BuildAdScoringSignalsMap(
     // Moving the name will render it inaccessible unless a copy is made first.
     std::string ad_url = itr->name.GetString();
     // A Document rather than a Value is created, as a Document has an
-    // Allocator.
-    rapidjson::Document ad_details;
+    // Allocator. All of them share the request's arena.
+    rapidjson::Document ad_details(&allocator);
     ad_details.SetObject();
     // AddMember moves itr's Values, do not reference them anymore.
     ad_details.AddMember(itr->name, itr->value, ad_details.GetAllocator());
@@ -228,18 +364,15 @@ absl::flat_hash_map<std::string, rapidjson::Document> BuildAdScoringSignalsMap(
 // scoring signals need to be copied rather than moved. Otherwise, for an ad
 // component used n times, moving its signals would fail on all times except the
 // first. O(n) operation, where n is the number of ad component render urls.
-absl::flat_hash_set<std::string> FindSharedComponentUrls(
-    const google::protobuf::RepeatedPtrField<AdWithBidMetadata>&
-        ads_with_bids) {
-  absl::flat_hash_map<std::string, int> url_occurrences;
-  absl::flat_hash_set<std::string> multiple_occurrence_component_urls;
-  for (const auto& ad_with_bid : ads_with_bids) {
+// The returned views point into raw_request.
+absl::flat_hash_set<absl::string_view> FindSharedComponentUrls(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request) {
+  absl::flat_hash_set<absl::string_view> multiple_occurrence_component_urls;
+  absl::flat_hash_map<absl::string_view, int> url_occurrences;
+  for (const auto& ad_with_bid : raw_request.ad_bids()) {
     for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
-      ++url_occurrences[ad_component_render_url];
-      if (url_occurrences[ad_component_render_url] > 1) {
-        std::string copy_of_ad_component_render_url = ad_component_render_url;
-        multiple_occurrence_component_urls.emplace(
-            std::move(copy_of_ad_component_render_url));
+      if (++url_occurrences[ad_component_render_url] == 2) {
+        multiple_occurrence_component_urls.insert(ad_component_render_url);
       }
     }
   }
@@ -258,13 +391,15 @@ absl::flat_hash_set<std::string> FindSharedComponentUrls(
 // component render URLs in this ad_with_bid.
 absl::StatusOr<rapidjson::Document> AddComponentSignals(
     const AdWithBidMetadata& ad_with_bid,
-    const absl::flat_hash_set<std::string>& multiple_occurrence_component_urls,
-    absl::flat_hash_map<std::string, rapidjson::Document>& component_signals) {
+    const absl::flat_hash_set<absl::string_view>&
+        multiple_occurrence_component_urls,
+    absl::flat_hash_map<std::string, rapidjson::Document>& component_signals,
+    rapidjson::Document::AllocatorType& allocator) {
   // Create overall signals object.
-  rapidjson::Document combined_signals_for_this_bid;
+  rapidjson::Document combined_signals_for_this_bid(&allocator);
   combined_signals_for_this_bid.SetObject();
   // Create empty expandable object to add ad component signals to.
-  rapidjson::Document empty_object;
+  rapidjson::Document empty_object(&allocator);
   empty_object.SetObject();
   // Add the expandable object to the combined signals object.
   auto combined_signals_itr =
@@ -281,7 +416,7 @@ absl::StatusOr<rapidjson::Document> AddComponentSignals(
       continue;
     }
     // Copy only if necessary.
-    rapidjson::Document to_add;
+    rapidjson::Document to_add(&allocator);
     if (multiple_occurrence_component_urls.contains(ad_component_render_url)) {
       // Use the allocator of the object to which these signals are
       // ultimately going.
@@ -312,11 +447,11 @@ absl::StatusOr<rapidjson::Document> AddComponentSignals(
   return combined_signals_for_this_bid;
 }
 
-absl::StatusOr<absl::flat_hash_map<std::string, rapidjson::StringBuffer>>
-BuildTrustedScoringSignals(
+absl::StatusOr<AdScoringSignalsMap> BuildTrustedScoringSignals(
     const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
-    const ContextLogger& logger) {
-  rapidjson::Document trusted_scoring_signals_value;
+    const ContextLogger& logger,
+    rapidjson::Document::AllocatorType& allocator) {
+  rapidjson::Document trusted_scoring_signals_value(&allocator);
   // TODO (b/285214424): De-nest, use a guard.
   if (!raw_request.scoring_signals().empty()) {
     // Attempt to parse into an object.
@@ -340,7 +475,7 @@ BuildTrustedScoringSignals(
           "Trusted scoring signals include no render urls.");
     }
     absl::flat_hash_map<std::string, rapidjson::Document> render_url_signals =
-        BuildAdScoringSignalsMap(render_urls_itr->value);
+        BuildAdScoringSignalsMap(render_urls_itr->value, allocator);
     // No scoring signals for ad component render urls are required,
     // however if present we build a map to their scoring signals in the same
     // way.
@@ -348,13 +483,14 @@ BuildTrustedScoringSignals(
     auto component_urls_itr = trusted_scoring_signals_value.FindMember(
         kAdComponentRenderUrlsProperty);
     if (component_urls_itr != trusted_scoring_signals_value.MemberEnd()) {
-      component_signals = BuildAdScoringSignalsMap(component_urls_itr->value);
+      component_signals =
+          BuildAdScoringSignalsMap(component_urls_itr->value, allocator);
     }
 
     // Find the ad component render urls used more than once so we know which
     // signals we must copy rather than move.
-    absl::flat_hash_set<std::string> multiple_occurrence_component_urls =
-        FindSharedComponentUrls(raw_request.ad_bids());
+    absl::flat_hash_set<absl::string_view> multiple_occurrence_component_urls =
+        FindSharedComponentUrls(raw_request);
     // Each AdWithBid needs signals for both its render URL and its ad component
     // render urls.
     absl::flat_hash_map<std::string, rapidjson::Document> combined_signals;
@@ -372,7 +508,7 @@ BuildTrustedScoringSignals(
       PS_ASSIGN_OR_RETURN(
           combined_signals_for_this_bid,
           AddComponentSignals(ad_with_bid, multiple_occurrence_component_urls,
-                              component_signals));
+                              component_signals, allocator));
       // Do not reference values after move.
       combined_signals_for_this_bid.value().AddMember(
           kRenderUrlsPropertyForScoreAd, render_url_signals_itr->second,
@@ -382,44 +518,432 @@ BuildTrustedScoringSignals(
           std::move(combined_signals_for_this_bid.value()));
     }
 
-    // Now turn the editable JSON documents into string buffers before
-    // returning.
-    absl::flat_hash_map<std::string, rapidjson::StringBuffer>
-        combined_formatted_ad_signals;
+    // Now serialize the editable JSON documents straight into the strings
+    // handed to Roma before returning.
+    AdScoringSignalsMap combined_formatted_ad_signals;
     for (const auto& [render_url, scoring_signals_json_obj] :
          combined_signals) {
-      rapidjson::StringBuffer buffer;
-      rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
-      scoring_signals_json_obj.Accept(writer);
-      combined_formatted_ad_signals.try_emplace(render_url, std::move(buffer));
+      PS_ASSIGN_OR_RETURN(std::shared_ptr<std::string> serialized_signals,
+                          SerializeJsonDoc(scoring_signals_json_obj,
+                                           /*reserve_string_len=*/0));
+      combined_formatted_ad_signals.try_emplace(render_url,
+                                                std::move(serialized_signals));
     }
 
-    logger.vlog(2, "\nTrusted Scoring Signals Deserialize Time: ",
-                ToInt64Microseconds((absl::Now() - start_parse_time)),
-                " microseconds for ", combined_formatted_ad_signals.size(),
-                " signals.");
+    PS_CONTEXT_VLOG(logger, 2, "\nTrusted Scoring Signals Deserialize Time: ",
+                    ToInt64Microseconds((absl::Now() - start_parse_time)),
+                    " microseconds for ", combined_formatted_ad_signals.size(),
+                    " signals.");
     return combined_formatted_ad_signals;
   } else {
     return absl::InvalidArgumentError(kNoTrustedScoringSignals);
   }
 }
 
-std::shared_ptr<std::string> BuildAuctionConfig(
-    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request) {
-  return std::make_shared<std::string>(absl::StrCat(
-      "{\"auctionSignals\": ",
-      ((raw_request.auction_signals().empty()) ? "\"\""
-                                               : raw_request.auction_signals()),
-      ", ", "\"sellerSignals\": ",
-      ((raw_request.seller_signals().empty()) ? "\"\""
-                                              : raw_request.seller_signals()),
-      "}"));
+// Location of one render URL's (or ad component render URL's) entry inside the
+// raw trusted scoring signals string. `key` still carries its quotes and any
+// escape sequences exactly as sent by the KV server, so both views can be
+// spliced back into valid JSON verbatim.
+struct ScoringSignalsRange {
+  absl::string_view key;
+  absl::string_view value;
+};
+
+// Keyed on the unescaped URL so that it can be looked up by render URL.
+using ScoringSignalsRangeMap =
+    absl::flat_hash_map<absl::string_view, ScoringSignalsRange>;
+
+// SAX handler that walks the trusted scoring signals exactly once and records
+// where each entry under `renderUrls` and `adComponentRenderUrls` lives in the
+// raw string. No DOM is built and no value is copied.
+class ScoringSignalsRangeHandler
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>,
+                                          ScoringSignalsRangeHandler> {
+ public:
+  ScoringSignalsRangeHandler(absl::string_view raw_signals,
+                             const rapidjson::StringStream& stream)
+      : raw_signals_(raw_signals), stream_(stream) {}
+
+  // Called for every scalar value.
+  bool Default() {
+    OnValueEnd();
+    return true;
+  }
+
+  bool StartObject() {
+    OnContainerStart();
+    return true;
+  }
+
+  bool EndObject(rapidjson::SizeType member_count) {
+    --depth_;
+    OnValueEnd();
+    return true;
+  }
+
+  bool StartArray() {
+    OnContainerStart();
+    return true;
+  }
+
+  bool EndArray(rapidjson::SizeType element_count) {
+    --depth_;
+    OnValueEnd();
+    return true;
+  }
+
+  bool Key(const char* str, rapidjson::SizeType length, bool copy) {
+    const size_t key_end = stream_.Tell();
+    if (depth_ == kSectionDepth) {
+      absl::string_view section(str, length);
+      if (section == kRenderUrlsPropertyForKVResponse) {
+        has_render_urls_ = true;
+        current_section_ = &render_urls_;
+      } else if (section == kAdComponentRenderUrlsProperty) {
+        current_section_ = &component_render_urls_;
+      } else {
+        current_section_ = nullptr;
+      }
+    } else if (depth_ == kEntryDepth && current_section_ != nullptr) {
+      const size_t key_begin = SkipSeparators(last_position_, ',');
+      pending_key_ = raw_signals_.substr(key_begin, key_end - key_begin);
+      pending_value_begin_ = SkipSeparators(key_end, ':');
+      // Keys without escape sequences can be looked up through the raw bytes
+      // directly, only escaped ones need an owned, unescaped copy.
+      absl::string_view unescaped_key(str, length);
+      if (pending_key_.size() == length + 2) {
+        pending_lookup_key_ = pending_key_.substr(1, length);
+      } else {
+        pending_lookup_key_ = unescaped_keys_.emplace_back(unescaped_key);
+      }
+      has_pending_entry_ = true;
+    }
+    last_position_ = key_end;
+    return true;
+  }
+
+  bool has_render_urls() const { return has_render_urls_; }
+  const ScoringSignalsRangeMap& render_urls() const { return render_urls_; }
+  const ScoringSignalsRangeMap& component_render_urls() const {
+    return component_render_urls_;
+  }
+
+ private:
+  // Depth of the keys naming the `renderUrls` and `adComponentRenderUrls`
+  // sections, and of the keys naming individual URLs inside those sections.
+  static constexpr int kSectionDepth = 1;
+  static constexpr int kEntryDepth = 2;
+
+  void OnContainerStart() {
+    ++depth_;
+    last_position_ = stream_.Tell();
+  }
+
+  // Completes the pending entry once its value (scalar or container) has been
+  // fully consumed.
+  void OnValueEnd() {
+    const size_t value_end = stream_.Tell();
+    if (has_pending_entry_ && depth_ == kEntryDepth) {
+      current_section_->try_emplace(
+          pending_lookup_key_,
+          ScoringSignalsRange{
+              .key = pending_key_,
+              .value = raw_signals_.substr(pending_value_begin_,
+                                           value_end - pending_value_begin_)});
+      has_pending_entry_ = false;
+    }
+    last_position_ = value_end;
+  }
+
+  // Returns the first position at or after `position` that is neither JSON
+  // whitespace nor `separator`.
+  size_t SkipSeparators(size_t position, char separator) const {
+    while (position < raw_signals_.size()) {
+      const char c = raw_signals_[position];
+      if (c != ' ' && c != '\n' && c != '\r' && c != '\t' && c != separator) {
+        break;
+      }
+      ++position;
+    }
+    return position;
+  }
+
+  absl::string_view raw_signals_;
+  const rapidjson::StringStream& stream_;
+  int depth_ = 0;
+  size_t last_position_ = 0;
+  ScoringSignalsRangeMap* current_section_ = nullptr;
+  bool has_render_urls_ = false;
+  bool has_pending_entry_ = false;
+  absl::string_view pending_key_;
+  absl::string_view pending_lookup_key_;
+  size_t pending_value_begin_ = 0;
+  ScoringSignalsRangeMap render_urls_;
+  ScoringSignalsRangeMap component_render_urls_;
+  // Deque keeps the views into its elements valid as it grows.
+  std::deque<std::string> unescaped_keys_;
+};
+
+// Builds the trustedScoringSignals argument of a single ad by splicing the raw
+// byte ranges of its render URL and ad component render URLs into one
+// allocation of exactly the right size. Produces the same JSON object as
+// BuildTrustedScoringSignals does, with the values' original formatting.
+std::shared_ptr<std::string> SpliceScoringSignalsForAd(
+    const AdWithBidMetadata& ad_with_bid,
+    const ScoringSignalsRange& render_url_range,
+    const ScoringSignalsRangeMap& component_ranges) {
+  absl::InlinedVector<const ScoringSignalsRange*, 4> ad_component_ranges;
+  // The render URL key, ':' and value.
+  size_t signals_size = kAdComponentSignalsPrefix.size() +
+                        kRenderUrlSignalsInfix.size() +
+                        kCombinedSignalsSuffix.size() +
+                        render_url_range.key.size() +
+                        render_url_range.value.size() + 1;
+  for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
+    auto component_itr = component_ranges.find(ad_component_render_url);
+    if (component_itr == component_ranges.end()) {
+      continue;
+    }
+    ad_component_ranges.push_back(&component_itr->second);
+    // Key, ':' and value.
+    signals_size += component_itr->second.key.size() +
+                    component_itr->second.value.size() + 1;
+  }
+  // The ',' between the ad components.
+  if (!ad_component_ranges.empty()) {
+    signals_size += ad_component_ranges.size() - 1;
+  }
+
+  auto signals = std::make_shared<std::string>();
+  signals->reserve(signals_size);
+  signals->append(kAdComponentSignalsPrefix.data(),
+                  kAdComponentSignalsPrefix.size());
+  for (size_t i = 0; i < ad_component_ranges.size(); i++) {
+    if (i != 0) {
+      signals->push_back(',');
+    }
+    absl::StrAppend(signals.get(), ad_component_ranges[i]->key, ":",
+                    ad_component_ranges[i]->value);
+  }
+  absl::StrAppend(signals.get(), kRenderUrlSignalsInfix, render_url_range.key,
+                  ":", render_url_range.value, kCombinedSignalsSuffix);
+  return signals;
 }
 
-absl::StatusOr<rapidjson::Document> ParseAndGetScoreAdResponseJson(
-    bool enable_adtech_code_logging, const std::string& response,
+// Alternative to BuildTrustedScoringSignals that makes a single SAX pass over
+// the raw trusted scoring signals, recording byte ranges instead of building
+// per-URL documents, and then splices each ad's argument together from those
+// ranges.
+absl::StatusOr<AdScoringSignalsMap> BuildTrustedScoringSignalsFromRanges(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
     const ContextLogger& logger) {
-  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
+  if (raw_request.scoring_signals().empty()) {
+    return absl::InvalidArgumentError(kNoTrustedScoringSignals);
+  }
+  auto start_parse_time = absl::Now();
+  rapidjson::StringStream stream(raw_request.scoring_signals().data());
+  ScoringSignalsRangeHandler handler(raw_request.scoring_signals(), stream);
+  rapidjson::Reader reader;
+  rapidjson::ParseResult parse_result =
+      reader.Parse<rapidjson::kParseNumbersAsStringsFlag>(stream, handler);
+  if (parse_result.IsError()) {
+    logger.vlog(2, "Trusted scoring signals JSON parse error: ",
+                rapidjson::GetParseError_En(parse_result.Code()),
+                " at offset: ", parse_result.Offset());
+    return absl::InvalidArgumentError("Malformed trusted scoring signals");
+  }
+  if (!handler.has_render_urls()) {
+    // If there are no scoring signals for any render urls, none can be
+    // scored. Abort now.
+    return absl::InvalidArgumentError(
+        "Trusted scoring signals include no render urls.");
+  }
+
+  AdScoringSignalsMap combined_formatted_ad_signals;
+  for (const auto& ad_with_bid : raw_request.ad_bids()) {
+    // Skip ads with no render URL signals, they will not be scored anyways.
+    auto render_url_itr = handler.render_urls().find(ad_with_bid.render());
+    if (render_url_itr == handler.render_urls().end() ||
+        combined_formatted_ad_signals.contains(ad_with_bid.render())) {
+      continue;
+    }
+    combined_formatted_ad_signals.try_emplace(
+        ad_with_bid.render(),
+        SpliceScoringSignalsForAd(ad_with_bid, render_url_itr->second,
+                                  handler.component_render_urls()));
+  }
+
+  PS_CONTEXT_VLOG(logger, 2, "\nTrusted Scoring Signals Deserialize Time: ",
+                  ToInt64Microseconds((absl::Now() - start_parse_time)),
+                  " microseconds for ", combined_formatted_ad_signals.size(),
+                  " signals.");
+  return combined_formatted_ad_signals;
+}
+
+// Returns the URL as a JSON string, to be spliced in as a key.
+std::string QuoteUrl(absl::string_view url) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.String(url.data(), url.size());
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+// Alternative to BuildTrustedScoringSignalsFromRanges for trusted scoring
+// signals sent as a key-value table, whose values are sliced out of it
+// without parsing any JSON. Only the URLs of the ads are quoted to be spliced
+// in with them.
+absl::StatusOr<AdScoringSignalsMap> BuildTrustedScoringSignalsFromTable(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
+    const ContextLogger& logger) {
+  auto start_parse_time = absl::Now();
+  absl::StatusOr<KeyValueTable> table =
+      ParseKeyValueTable(raw_request.scoring_signals());
+  if (!table.ok()) {
+    logger.vlog(2, "Trusted scoring signals table parse error: ",
+                table.status().message());
+    return absl::InvalidArgumentError("Malformed trusted scoring signals");
+  }
+  auto render_urls_itr = table->find(kRenderUrlsPropertyForKVResponse);
+  if (render_urls_itr == table->end()) {
+    // If there are no scoring signals for any render urls, none can be
+    // scored. Abort now.
+    return absl::InvalidArgumentError(
+        "Trusted scoring signals include no render urls.");
+  }
+  const KeyValueTableNamespace& render_url_signals = render_urls_itr->second;
+  const KeyValueTableNamespace no_signals;
+  auto component_urls_itr = table->find(kAdComponentRenderUrlsProperty);
+  const KeyValueTableNamespace& component_signals =
+      component_urls_itr == table->end() ? no_signals
+                                         : component_urls_itr->second;
+
+  // Deque keeps the views of the ranges into its elements valid as it grows.
+  std::deque<std::string> quoted_urls;
+  ScoringSignalsRangeMap component_ranges;
+  AdScoringSignalsMap combined_formatted_ad_signals;
+  for (const auto& ad_with_bid : raw_request.ad_bids()) {
+    // Skip ads with no render URL signals, they will not be scored anyways.
+    auto render_url_itr = render_url_signals.find(ad_with_bid.render());
+    if (render_url_itr == render_url_signals.end() ||
+        combined_formatted_ad_signals.contains(ad_with_bid.render())) {
+      continue;
+    }
+    for (const auto& ad_component_render_url : ad_with_bid.ad_components()) {
+      auto component_itr = component_signals.find(ad_component_render_url);
+      if (component_itr == component_signals.end() ||
+          component_ranges.contains(ad_component_render_url)) {
+        continue;
+      }
+      component_ranges.try_emplace(
+          component_itr->first,
+          ScoringSignalsRange{
+              .key = quoted_urls.emplace_back(QuoteUrl(component_itr->first)),
+              .value = component_itr->second});
+    }
+    const ScoringSignalsRange render_url_range = {
+        .key = quoted_urls.emplace_back(QuoteUrl(render_url_itr->first)),
+        .value = render_url_itr->second};
+    combined_formatted_ad_signals.try_emplace(
+        ad_with_bid.render(),
+        SpliceScoringSignalsForAd(ad_with_bid, render_url_range,
+                                  component_ranges));
+  }
+
+  PS_CONTEXT_VLOG(logger, 2, "\nTrusted Scoring Signals Deserialize Time: ",
+                  ToInt64Microseconds((absl::Now() - start_parse_time)),
+                  " microseconds for ", combined_formatted_ad_signals.size(),
+                  " signals.");
+  return combined_formatted_ad_signals;
+}
+
+// Seller provided criteria that reject ads without running scoreAd.
+struct PreScoringFilter {
+  std::optional<double> min_bid;
+  absl::flat_hash_set<std::string> blocked_interest_group_owners;
+};
+
+// Reads the pre-scoring filter from the seller signals. Malformed or missing
+// properties are ignored, leaving the ads to be rejected by scoreAd instead.
+PreScoringFilter BuildPreScoringFilter(absl::string_view seller_signals,
+                                       const ContextLogger& logger) {
+  PreScoringFilter filter;
+  if (seller_signals.empty()) {
+    return filter;
+  }
+  absl::StatusOr<rapidjson::Document> document =
+      ParseJsonString(seller_signals);
+  if (!document.ok() || !document->IsObject()) {
+    logger.vlog(2, "Seller signals are not a JSON object, no ads filtered");
+    return filter;
+  }
+  auto min_bid_itr = document->FindMember(kMinBidPropertyForPreScoringFilter);
+  if (min_bid_itr != document->MemberEnd() && min_bid_itr->value.IsNumber()) {
+    filter.min_bid = min_bid_itr->value.GetDouble();
+  }
+  auto blocked_itr = document->FindMember(
+      kBlockedInterestGroupOwnersPropertyForPreScoringFilter);
+  if (blocked_itr != document->MemberEnd() && blocked_itr->value.IsArray()) {
+    for (const auto& owner : blocked_itr->value.GetArray()) {
+      if (owner.IsString()) {
+        filter.blocked_interest_group_owners.emplace(owner.GetString(),
+                                                     owner.GetStringLength());
+      }
+    }
+  }
+  return filter;
+}
+
+// Returns the reason the filter rejects the ad for, if it does.
+std::optional<SellerRejectionReason> GetPreScoringRejectionReason(
+    const PreScoringFilter& filter, const AdWithBidMetadata& ad) {
+  if (filter.blocked_interest_group_owners.contains(
+          ad.interest_group_owner())) {
+    return SellerRejectionReason::BLOCKED_BY_PUBLISHER;
+  }
+  if (filter.min_bid.has_value() && ad.bid() < *filter.min_bid) {
+    return SellerRejectionReason::BID_BELOW_AUCTION_FLOOR;
+  }
+  return std::nullopt;
+}
+
+// Shares the auction config of requests with the same signals through
+// signal_blob_cache, if set.
+std::shared_ptr<std::string> BuildAuctionConfig(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request,
+    SignalBlobCache* signal_blob_cache) {
+  const auto assemble = [&raw_request]() {
+    return absl::StrCat(
+        "{\"auctionSignals\": ",
+        ((raw_request.auction_signals().empty())
+             ? "\"\""
+             : raw_request.auction_signals()),
+        ", ", "\"sellerSignals\": ",
+        ((raw_request.seller_signals().empty()) ? "\"\""
+                                                : raw_request.seller_signals()),
+        "}");
+  };
+  if (signal_blob_cache == nullptr) {
+    return std::make_shared<std::string>(assemble());
+  }
+  return signal_blob_cache->GetOrAssemble(
+      {raw_request.auction_signals(), raw_request.seller_signals()}, assemble);
+}
+
+// Moves the "response" object out of one scoreAdEntryFunction output, after
+// logging the AdTech logs it holds and reading the time the scoreAd() call
+// took into execution_time. Both must be allocated from `allocator`, the
+// request's arena, which outlives every document built from it, so no deep
+// copy is needed.
+rapidjson::Document ExtractScoreAdResponseJson(
+    bool enable_adtech_code_logging, rapidjson::Value& document,
+    const ContextLogger& logger, rapidjson::Document::AllocatorType& allocator,
+    std::optional<absl::Duration>& execution_time) {
+  if (auto execution_time_itr =
+          document.FindMember(kExecutionTimeMsPropertyForScoreAd);
+      execution_time_itr != document.MemberEnd() &&
+      execution_time_itr->value.IsNumber()) {
+    execution_time = absl::Milliseconds(execution_time_itr->value.GetDouble());
+  }
   if (enable_adtech_code_logging) {
     const rapidjson::Value& logs = document["logs"];
     for (const auto& log : logs.GetArray()) {
@@ -434,29 +958,120 @@ absl::StatusOr<rapidjson::Document> ParseAndGetScoreAdResponseJson(
       logger.vlog(1, "Errors: ", error.GetString());
     }
   }
-  rapidjson::Document response_obj;
+  rapidjson::Document response_obj(&allocator);
   auto iterator = document.FindMember("response");
   if (iterator != document.MemberEnd() && iterator->value.IsObject()) {
-    response_obj.CopyFrom(iterator->value, response_obj.GetAllocator());
+    rapidjson::Value& response_value = response_obj;
+    response_value.Swap(iterator->value);
   }
   return response_obj;
 }
 
+// Parses the scoreAd() response with all values allocated from `allocator`.
+absl::StatusOr<rapidjson::Document> ParseAndGetScoreAdResponseJson(
+    bool enable_adtech_code_logging, const std::string& response,
+    const ContextLogger& logger, rapidjson::Document::AllocatorType& allocator,
+    std::optional<absl::Duration>& execution_time) {
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document,
+                      ParseJsonString(response, allocator));
+  return ExtractScoreAdResponseJson(enable_adtech_code_logging, document,
+                                    logger, allocator, execution_time);
+}
+
+// Parses the scoreAdsBatchEntryFunction() response into the scoreAd()
+// response of each of the `batch_size` ads in the batch, in order, and the
+// time each scoreAd() call took into execution_times.
+absl::StatusOr<std::vector<rapidjson::Document>>
+ParseAndGetScoreAdsBatchResponseJson(
+    bool enable_adtech_code_logging, const std::string& response,
+    size_t batch_size, const ContextLogger& logger,
+    rapidjson::Document::AllocatorType& allocator,
+    std::vector<std::optional<absl::Duration>>& execution_times) {
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document,
+                      ParseJsonString(response, allocator));
+  if (!document.IsArray() || document.Size() != batch_size) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected an array of ", batch_size, " scoreAd outputs in batch"));
+  }
+  std::vector<rapidjson::Document> ad_responses;
+  ad_responses.reserve(batch_size);
+  execution_times.assign(batch_size, std::nullopt);
+  for (auto& ad_output : document.GetArray()) {
+    if (!ad_output.IsObject()) {
+      return absl::InvalidArgumentError("Malformed scoreAd output in batch");
+    }
+    ad_responses.push_back(ExtractScoreAdResponseJson(
+        enable_adtech_code_logging, ad_output, logger, allocator,
+        execution_times[ad_responses.size()]));
+  }
+  return ad_responses;
+}
+
 }  // namespace
 
+std::vector<DispatchRequest> MakeScoreAdWarmUpRequests(int num_requests) {
+  DispatchRequest warm_up_request;
+  warm_up_request.version_num = 1;
+  warm_up_request.handler_name = DispatchHandlerFunctionWithSellerWrapper;
+  warm_up_request.input = std::vector<std::shared_ptr<std::string>>(
+      kArgSizeWithWrapper, std::make_shared<std::string>("{}"));
+  warm_up_request.input[ScoreArgIndex(ScoreAdArgs::kAdMetadata)] =
+      std::make_shared<std::string>(R"JSON({"renderUrl":"warm_up"})JSON");
+  warm_up_request.input[ScoreArgIndex(ScoreAdArgs::kBid)] =
+      std::make_shared<std::string>("1");
+  warm_up_request.input[ScoreArgIndex(ScoreAdArgs::kDeviceSignals)] =
+      std::make_shared<std::string>(
+          R"JSON({"interestGroupOwner":"warm_up","topWindowHostname":"warm_up","renderUrl":"warm_up"})JSON");
+  warm_up_request.input[ScoreArgIndex(ScoreAdArgs::kFeatureFlags)] =
+      std::make_shared<std::string>(
+          GetFeatureFlagJson(/*enable_logging=*/false,
+                             /*enable_debug_url_generation=*/false));
+  std::vector<DispatchRequest> warm_up_requests;
+  warm_up_requests.reserve(num_requests);
+  for (int i = 0; i < num_requests; i++) {
+    warm_up_request.id = absl::StrCat("warm_up_", i);
+    warm_up_requests.push_back(warm_up_request);
+  }
+  return warm_up_requests;
+}
+
+ObjectPool<ScoreAdsReactor::ScoringState>&
+ScoreAdsReactor::ScoringStatePool() {
+  static auto* pool = new ObjectPool<ScoringState>(
+      kReactorStatePoolMaxIdle, [](ScoringState& state) {
+        if (state.ad_data.bucket_count() > kMaxPooledContainerSize ||
+            state.ad_scores.capacity() > kMaxPooledContainerSize ||
+            state.batched_ad_ids.bucket_count() > kMaxPooledContainerSize ||
+            state.pre_scoring_rejection_reasons.capacity() >
+                kMaxPooledContainerSize) {
+          state = ScoringState();
+          return;
+        }
+        // Erasing keeps the capacity of the maps, which clear() frees when
+        // they are large.
+        state.ad_data.erase(state.ad_data.begin(), state.ad_data.end());
+        state.ad_scores.clear();
+        state.batched_ad_ids.erase(state.batched_ad_ids.begin(),
+                                   state.batched_ad_ids.end());
+        state.pre_scoring_rejection_reasons.clear();
+      });
+  return *pool;
+}
+
 ScoreAdsReactor::ScoreAdsReactor(
     const CodeDispatchClient& dispatcher, const ScoreAdsRequest* request,
     ScoreAdsResponse* response,
     std::unique_ptr<ScoreAdsBenchmarkingLogger> benchmarking_logger,
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
-    std::unique_ptr<AsyncReporter> async_reporter,
-    const AuctionServiceRuntimeConfig& runtime_config)
+    std::shared_ptr<AsyncReporter> async_reporter,
+    const AuctionServiceRuntimeConfig& runtime_config,
+    AdMetadataJsonCache* ad_metadata_json_cache)
     : CodeDispatchReactor<ScoreAdsRequest, ScoreAdsRequest::ScoreAdsRawRequest,
                           ScoreAdsResponse,
                           ScoreAdsResponse::ScoreAdsRawResponse>(
           dispatcher, request, response, key_fetcher_manager, crypto_client,
-          runtime_config.encryption_enabled),
+          runtime_config.encryption_enabled, runtime_config.crypto_worker_pool),
       benchmarking_logger_(std::move(benchmarking_logger)),
       async_reporter_(std::move(async_reporter)),
       enable_seller_debug_url_generation_(
@@ -466,7 +1081,23 @@ ScoreAdsReactor::ScoreAdsReactor(
           runtime_config.enable_report_result_url_generation),
       enable_report_win_url_generation_(
           runtime_config.enable_report_win_url_generation),
-      roma_timeout_ms_(runtime_config.roma_timeout_ms) {
+      roma_timeout_ms_(runtime_config.roma_timeout_ms),
+      consented_debug_token_(runtime_config.consented_debug_token),
+      enable_zero_copy_scoring_signals_(
+          runtime_config.enable_zero_copy_scoring_signals),
+      highest_scoring_other_bids_top_k_(
+          runtime_config.highest_scoring_other_bids_top_k > 0
+              ? runtime_config.highest_scoring_other_bids_top_k
+              : kDefaultHighestScoringOtherBidsTopK),
+      score_ads_batch_size_(runtime_config.score_ads_batch_size),
+      enable_seller_pre_scoring_filter_(
+          runtime_config.enable_seller_pre_scoring_filter),
+      use_on_demand_json_parser_(runtime_config.use_on_demand_json_parser),
+      debug_report_limiter_(runtime_config.debug_report_limiter),
+      json_arena_(kJsonArenaChunkCapacity),
+      ad_metadata_json_cache_(ad_metadata_json_cache),
+      signal_blob_cache_(runtime_config.signal_blob_cache),
+      score_ad_result_cache_(runtime_config.score_ad_result_cache) {
   CHECK_OK([this]() {
     PS_ASSIGN_OR_RETURN(metric_context_,
                         metric::AuctionContextMap()->Remove(request_));
@@ -474,6 +1105,80 @@ ScoreAdsReactor::ScoreAdsReactor(
   }()) << "AuctionContextMap()->Get(request) should have been called";
 }
 
+std::shared_ptr<std::string> ScoreAdsReactor::GetAdMetadataJson(
+    const AdWithBidMetadata& ad) {
+  if (!ad.ad_metadata_json().empty()) {
+    return GetAdMetadataJsonFromAdJson(ad);
+  }
+  // TODO: b/260265272
+  const auto& it = ad.ad().struct_value().fields().find("metadata");
+  if (it == ad.ad().struct_value().fields().end()) {
+    return std::make_shared<std::string>();
+  }
+  if (ad_metadata_json_cache_ == nullptr) {
+    auto ad_metadata_json = std::make_shared<std::string>();
+    google::protobuf::util::MessageToJsonString(it->second,
+                                                ad_metadata_json.get());
+    return ad_metadata_json;
+  }
+
+  // Struct fields are a proto map, so only the deterministic encoding gives
+  // equal metadata equal bytes.
+  std::string metadata_bytes;
+  {
+    google::protobuf::io::StringOutputStream stream(&metadata_bytes);
+    google::protobuf::io::CodedOutputStream coded_stream(&stream);
+    coded_stream.SetSerializationDeterministic(true);
+    it->second.SerializeToCodedStream(&coded_stream);
+  }
+  AdMetadataJsonCacheKey key(ad.render(),
+                             absl::Hash<std::string>{}(metadata_bytes));
+  if (std::shared_ptr<std::string> cached =
+          ad_metadata_json_cache_->LookUp(key)) {
+    ++ad_metadata_cache_hits_;
+    return cached;
+  }
+  ++ad_metadata_cache_misses_;
+  auto ad_metadata_json = std::make_shared<std::string>();
+  google::protobuf::util::MessageToJsonString(it->second,
+                                              ad_metadata_json.get());
+  ad_metadata_json_cache_->Insert(std::move(key), ad_metadata_json);
+  return ad_metadata_json;
+}
+
+std::shared_ptr<std::string> ScoreAdsReactor::GetAdMetadataJsonFromAdJson(
+    const AdWithBidMetadata& ad) {
+  std::optional<AdMetadataJsonCacheKey> key;
+  if (ad_metadata_json_cache_ != nullptr) {
+    key.emplace(ad.render(),
+                absl::Hash<absl::string_view>{}(ad.ad_metadata_json()));
+    if (std::shared_ptr<std::string> cached =
+            ad_metadata_json_cache_->LookUp(*key)) {
+      ++ad_metadata_cache_hits_;
+      return cached;
+    }
+    ++ad_metadata_cache_misses_;
+  }
+  auto ad_metadata_json = std::make_shared<std::string>();
+  absl::StatusOr<rapidjson::Document> ad_json =
+      ParseJsonString(ad.ad_metadata_json());
+  if (ad_json.ok() && ad_json->IsObject()) {
+    if (auto it = ad_json->FindMember("metadata");
+        it != ad_json->MemberEnd()) {
+      absl::StatusOr<std::string> metadata = SerializeJsonDoc(it->value);
+      if (metadata.ok()) {
+        *ad_metadata_json = *std::move(metadata);
+      }
+    }
+  } else {
+    logger_.vlog(2, "Invalid ad_metadata_json for ", ad.render());
+  }
+  if (key.has_value()) {
+    ad_metadata_json_cache_->Insert(*std::move(key), ad_metadata_json);
+  }
+  return ad_metadata_json;
+}
+
 ContextLogger::ContextMap ScoreAdsReactor::GetLoggingContext(
     const ScoreAdsRequest::ScoreAdsRawRequest& score_ads_request) {
   const auto& log_context = score_ads_request.log_context();
@@ -483,7 +1188,13 @@ ContextLogger::ContextMap ScoreAdsReactor::GetLoggingContext(
   };
 }
 
+void ScoreAdsReactor::SetDeadline(absl::Time deadline) {
+  deadline_ = deadline;
+}
+
 void ScoreAdsReactor::Execute() {
+  absl::Time start_build_input_time = absl::Now();
+  const absl::Duration start_build_input_cpu = ThreadCpuTime();
   benchmarking_logger_->BuildInputBegin();
   logger_ = ContextLogger(GetLoggingContext(raw_request_));
   auto ads = raw_request_.ad_bids();
@@ -492,54 +1203,211 @@ void ScoreAdsReactor::Execute() {
     return;
   }
 
-  absl::StatusOr<absl::flat_hash_map<std::string, rapidjson::StringBuffer>>
-      scoring_signals = BuildTrustedScoringSignals(raw_request_, logger_);
+  absl::StatusOr<AdScoringSignalsMap> scoring_signals;
+  if (IsKeyValueTable(raw_request_.scoring_signals())) {
+    scoring_signals =
+        BuildTrustedScoringSignalsFromTable(raw_request_, logger_);
+  } else if (enable_zero_copy_scoring_signals_) {
+    scoring_signals =
+        BuildTrustedScoringSignalsFromRanges(raw_request_, logger_);
+  } else {
+    scoring_signals =
+        BuildTrustedScoringSignals(raw_request_, logger_, json_arena_);
+  }
 
   if (!scoring_signals.ok()) {
     Finish(FromAbslStatus(scoring_signals.status()));
     return;
   }
 
-  std::shared_ptr<std::string> auction_config =
-      BuildAuctionConfig(raw_request_);
   bool enable_debug_reporting = enable_seller_debug_url_generation_ &&
                                 raw_request_.enable_debug_reporting();
+  auction_config_ = BuildAuctionConfig(raw_request_, signal_blob_cache_);
+  const ScoreAdSharedInputs shared_inputs = {
+      .auction_config = auction_config_,
+      .direct_from_seller_signals = GetDirectFromSellerSignals(),
+      .feature_flags = GetSharedFeatureFlagJson(enable_adtech_code_logging_,
+                                                enable_debug_reporting),
+      .top_window_hostname = raw_request_.publisher_hostname()};
+  const PreScoringFilter pre_scoring_filter =
+      enable_seller_pre_scoring_filter_
+          ? BuildPreScoringFilter(raw_request_.seller_signals(), logger_)
+          : PreScoringFilter();
+  // Outputs are only reused for the code version the request runs on.
+  const int code_version =
+      score_ad_result_cache_ != nullptr
+          ? dispatcher_.CodeVersion(raw_request_.score_ad_version())
+          : 0;
   benchmarking_logger_->BuildInputEnd();
-  while (!ads.empty()) {
-    std::unique_ptr<AdWithBidMetadata> ad(ads.ReleaseLast());
-    if (scoring_signals->contains(ad->render())) {
-      DispatchRequest dispatch_request;
-      dispatch_request = BuildScoreAdRequest(
-          *ad, auction_config, raw_request_.publisher_hostname(),
-          scoring_signals.value(), enable_debug_reporting, logger_,
-          enable_adtech_code_logging_);
+  int ads_over_memory_budget = 0;
+  const int features =
+      FeatureIf(VLOG_IS_ON(2), kLogScoreAdInputs) |
+      FeatureIf(enable_seller_pre_scoring_filter_, kPreScoringFilter) |
+      FeatureIf(score_ad_result_cache_ != nullptr, kScoreAdResultCache) |
+      FeatureIf(memory_budget_.enabled(), kChargeMemoryBudget);
+  const bool has_code_experiment = !raw_request_.score_ad_version().empty();
+  WithFeatureSet<kNumScoreAdFeatures>(features, [&](auto feature_set) {
+    constexpr int kFeatures = decltype(feature_set)::value;
+    while (!ads.empty()) {
+      std::unique_ptr<AdWithBidMetadata> ad(ads.ReleaseLast());
+      if (!scoring_signals->contains(ad->render())) {
+        continue;
+      }
+      if constexpr ((kFeatures & kPreScoringFilter) != 0) {
+        if (std::optional<SellerRejectionReason> rejection_reason =
+                GetPreScoringRejectionReason(pre_scoring_filter, *ad);
+            rejection_reason.has_value()) {
+          ScoreAdsResponse::AdScore::AdRejectionReason ad_rejection_reason;
+          ad_rejection_reason.set_interest_group_owner(
+              ad->interest_group_owner());
+          ad_rejection_reason.set_interest_group_name(
+              ad->interest_group_name());
+          ad_rejection_reason.set_rejection_reason(*rejection_reason);
+          pre_scoring_rejection_reasons_.push_back(
+              std::move(ad_rejection_reason));
+          LogIfError(metric_context_->AccumulateMetric<
+                     metric::kAuctionBidRejectedCount>(
+              1, ToSellerRejectionReasonString(*rejection_reason)));
+          continue;
+        }
+      }
+      DispatchRequest dispatch_request =
+          BuildScoreAdRequest<(kFeatures & kLogScoreAdInputs) != 0>(
+              *ad, GetAdMetadataJson(*ad), shared_inputs,
+              scoring_signals.value(), logger_);
+      if constexpr ((kFeatures & kChargeMemoryBudget) != 0) {
+        if (!memory_budget_.TryCharge(AdInputBytes(dispatch_request))) {
+          ++ads_over_memory_budget;
+          continue;
+        }
+      }
       ad_data_.emplace(dispatch_request.id, std::move(ad));
-      dispatch_request.tags[kRomaTimeoutMs] = roma_timeout_ms_;
+      if constexpr ((kFeatures & kScoreAdResultCache) != 0) {
+        std::string key =
+            ScoreAdResultCache::Key(code_version, dispatch_request.input);
+        if (std::optional<ScoreAdOutput> cached =
+                score_ad_result_cache_->LookUp(key);
+            cached.has_value()) {
+          cached_score_ad_outputs_.emplace_back(
+              std::move(dispatch_request.id), *std::move(cached));
+          continue;
+        }
+        score_ad_result_keys_.emplace(dispatch_request.id, std::move(key));
+      }
+      if (has_code_experiment) {
+        dispatch_request.tags[kCodeExperimentTag] =
+            raw_request_.score_ad_version();
+      }
       dispatch_requests_.push_back(std::move(dispatch_request));
     }
+  });
+
+  if (ads_over_memory_budget > 0) {
+    logger_.vlog(1, "scoreAd arguments over the memory budget of the request, ",
+                 "skipping ", ads_over_memory_budget, " ads");
+    RecordMemoryBudgetExceeded(MemoryBudgetAction::kTrimmed);
+  }
+  if (ad_metadata_json_cache_ != nullptr) {
+    LogIfError(
+        metric_context_->LogUpDownCounter<
+            metric::kAuctionAdMetadataCacheHitCount>(ad_metadata_cache_hits_));
+    LogIfError(metric_context_->LogUpDownCounter<
+               metric::kAuctionAdMetadataCacheMissCount>(
+        ad_metadata_cache_misses_));
+    if (int looked_up = ad_metadata_cache_hits_ + ad_metadata_cache_misses_;
+        looked_up > 0) {
+      LogIfError(metric_context_->LogHistogram<
+                 metric::kAuctionAdMetadataCacheHitPercent>(
+          static_cast<double>(ad_metadata_cache_hits_) / looked_up));
+    }
+  }
+  if (score_ad_result_cache_ != nullptr) {
+    LogIfError(metric_context_->LogUpDownCounter<
+               metric::kAuctionScoreAdResultCacheHitCount>(
+        cached_score_ad_outputs_.size()));
+    LogIfError(metric_context_->LogUpDownCounter<
+               metric::kAuctionScoreAdResultCacheMissCount>(
+        score_ad_result_keys_.size()));
   }
 
+  if (dispatch_requests_.empty() && !cached_score_ad_outputs_.empty()) {
+    // Every ad was served from the score ad result cache, so there is nothing
+    // to dispatch.
+    ScoreAdsCallback({});
+    return;
+  }
   if (dispatch_requests_.empty()) {
+    if (ads_over_memory_budget > 0) {
+      Finish(::grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                            kRequestMemoryBudgetExceeded));
+      return;
+    }
+    if (!pre_scoring_rejection_reasons_.empty()) {
+      Finish(::grpc::Status(grpc::StatusCode::NOT_FOUND,
+                            kAllAdsRejectedBeforeScoring));
+      return;
+    }
     Finish(::grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
                           kNoAdsWithValidScoringSignals));
     return;
   }
+  // Every request is dispatched at once, so they all get the same timeout,
+  // which the batch requests copy.
+  std::string roma_timeout_ms = roma_timeout_ms_;
+  if (int64_t static_timeout_ms;
+      deadline_ != absl::InfiniteFuture() &&
+      absl::SimpleAtoi(roma_timeout_ms_, &static_timeout_ms)) {
+    const absl::Duration roma_timeout = TimeoutWithinDeadline(
+        absl::Milliseconds(static_timeout_ms), deadline_);
+    if (roma_timeout <= absl::ZeroDuration()) {
+      logger_.vlog(1, "Request deadline reached before dispatching ads");
+      Finish(::grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED,
+                            kDeadlineExceededBeforeScoring));
+      return;
+    }
+    roma_timeout_ms = absl::StrCat(
+        std::max<int64_t>(1, absl::ToInt64Milliseconds(roma_timeout)));
+  }
+  for (auto& dispatch_request : dispatch_requests_) {
+    dispatch_request.tags[kRomaTimeoutMs] = roma_timeout_ms;
+    AddRequestClassTag(dispatch_request);
+  }
+  // A single ad is dispatched on its own, as a batch would only wrap it.
+  if (score_ads_batch_size_ > 1 && dispatch_requests_.size() > 1) {
+    dispatch_requests_ = BuildScoreAdsBatchRequests(
+        std::move(dispatch_requests_), score_ads_batch_size_, shared_inputs,
+        batched_ad_ids_);
+  }
   absl::Time start_js_execution_time = absl::Now();
+  LogIfError(metric_context_->LogHistogram<metric::kAuctionBuildInputDuration>(
+      (start_js_execution_time - start_build_input_time) /
+      absl::Microseconds(1)));
+  cpu_time_.AddSince(CpuStage::kPrepare, start_build_input_cpu);
   auto status = dispatcher_.BatchExecute(
       dispatch_requests_,
       [this, start_js_execution_time](
           const std::vector<absl::StatusOr<DispatchResponse>>& result) {
-        int js_execution_time_ms =
-            (absl::Now() - start_js_execution_time) / absl::Milliseconds(1);
+        absl::Duration js_execution_time =
+            absl::Now() - start_js_execution_time;
+        tracer_.AddSpan("DispatchToRoma", start_js_execution_time,
+                        absl::Now());
+        timeline_.Record(RequestStage::kDispatch, start_js_execution_time,
+                         start_js_execution_time + js_execution_time);
         LogIfError(metric_context_->LogHistogram<metric::kJSExecutionDuration>(
-            js_execution_time_ms));
+            js_execution_time / absl::Milliseconds(1)));
+        LogIfError(
+            metric_context_->LogHistogram<metric::kAuctionDispatchDuration>(
+                js_execution_time / absl::Microseconds(1)));
+        cpu_time_.AddDispatchWallTime(js_execution_time);
         ScoreAdsCallback(result);
       });
 
   if (!status.ok()) {
-    std::string original_request;
-    TextFormat::PrintToString(raw_request_, &original_request);
-    logger_.vlog(1, "Execution request failed for batch: ", original_request,
+    logger_.vlog(1, "Execution request failed for batch: ",
+                 LazyFormat([this]() {
+                   return DescribeRequestForErrorLog(raw_request_,
+                                                     consented_debug_token_);
+                 }),
                  status.ToString(absl::StatusToStringMode::kWithEverything));
     LogIfError(
         metric_context_->LogUpDownCounter<metric::kJSExecutionErrorCount>(1));
@@ -596,21 +1464,28 @@ ScoreAdsResponse::AdScore ParseScoreAdResponse(
   return score_ads_response;
 }
 
+// Reads the fields of a scoreAd() response that the auction reads.
+ScoreAdOutput ToScoreAdOutput(const rapidjson::Document& score_ad_resp) {
+  ScoreAdOutput output = {.score = ParseScoreAdResponse(score_ad_resp)};
+  auto reject_reason_itr =
+      score_ad_resp.FindMember(kRejectReasonPropertyForScoreAd);
+  if (reject_reason_itr != score_ad_resp.MemberEnd() &&
+      reject_reason_itr->value.IsString()) {
+    output.reject_reason = reject_reason_itr->value.GetString();
+  }
+  return output;
+}
+
 std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
-ParseAdRejectionReason(const rapidjson::Document& score_ad_resp,
+ParseAdRejectionReason(absl::string_view rejection_reason_str,
                        absl::string_view interest_group_owner,
                        absl::string_view interest_group_name,
                        const ContextLogger& logger) {
   std::optional<ScoreAdsResponse::AdScore::AdRejectionReason>
       ad_rejection_reason;
-  auto reject_reason_itr =
-      score_ad_resp.FindMember(kRejectReasonPropertyForScoreAd);
-  if (reject_reason_itr == score_ad_resp.MemberEnd() ||
-      !reject_reason_itr->value.IsString()) {
+  if (rejection_reason_str.empty()) {
     return ad_rejection_reason;
   }
-  std::string rejection_reason_str =
-      score_ad_resp[kRejectReasonPropertyForScoreAd].GetString();
   SellerRejectionReason rejection_reason =
       ToSellerRejectionReason(rejection_reason_str);
 
@@ -627,39 +1502,77 @@ ParseAdRejectionReason(const rapidjson::Document& score_ad_resp,
   return ad_rejection_reason;
 }
 
+absl::StatusOr<std::vector<ScoreAdOutput>>
+ScoreAdsReactor::ParseScoreAdOutputs(const std::string& response,
+                                     int batch_size) {
+  if (use_on_demand_json_parser_) {
+    return ParseScoreAdOutputsOnDemand(response, batch_size,
+                                       enable_adtech_code_logging_, logger_);
+  }
+  std::vector<ScoreAdOutput> outputs;
+  if (batch_size <= 0) {
+    std::optional<absl::Duration> execution_time;
+    PS_ASSIGN_OR_RETURN(
+        rapidjson::Document document,
+        ParseAndGetScoreAdResponseJson(enable_adtech_code_logging_, response,
+                                       logger_, json_arena_, execution_time));
+    outputs.push_back(ToScoreAdOutput(document));
+    outputs.back().execution_time = execution_time;
+    return outputs;
+  }
+  std::vector<std::optional<absl::Duration>> execution_times;
+  PS_ASSIGN_OR_RETURN(
+      std::vector<rapidjson::Document> documents,
+      ParseAndGetScoreAdsBatchResponseJson(enable_adtech_code_logging_,
+                                           response, batch_size, logger_,
+                                           json_arena_, execution_times));
+  outputs.reserve(documents.size());
+  for (int i = 0; i < documents.size(); i++) {
+    outputs.push_back(ToScoreAdOutput(documents[i]));
+    outputs.back().execution_time = execution_times[i];
+  }
+  return outputs;
+}
+
 void ScoreAdsReactor::PerformReporting(
     const ScoreAdsResponse::AdScore& winning_ad_score) {
   std::vector<DispatchRequest> dispatch_requests;
-  std::shared_ptr<std::string> auction_config =
-      BuildAuctionConfig(raw_request_);
   DispatchRequest dispatch_request;
+  const AdWithBidMetadata& winning_ad = *ad_data_.at(winning_ad_score.render());
   BuyerReportingMetadata buyer_reporting_metadata = {
       .enable_report_win_url_generation = enable_report_win_url_generation_,
       .buyer_signals = raw_request_.per_buyer_signals().at(
           winning_ad_score.interest_group_owner()),
-      .join_count = ad_data_.at(winning_ad_score.render()).get()->join_count(),
-      .recency = ad_data_.at(winning_ad_score.render()).get()->recency(),
-      .modeling_signals =
-          ad_data_.at(winning_ad_score.render()).get()->modeling_signals()};
+      .join_count = winning_ad.join_count(),
+      .recency = winning_ad.recency(),
+      .modeling_signals = winning_ad.modeling_signals()};
   dispatch_request = GetReportingDispatchRequest(
       winning_ad_score, raw_request_.publisher_hostname(),
-      enable_adtech_code_logging_, auction_config, logger_,
+      enable_adtech_code_logging_, auction_config_, logger_,
       buyer_reporting_metadata);
   dispatch_request.tags[kRomaTimeoutMs] = roma_timeout_ms_;
+  AddRequestClassTag(dispatch_request);
   dispatch_requests.push_back(std::move(dispatch_request));
   auto status = dispatcher_.BatchExecute(
       dispatch_requests,
-      [this](const std::vector<absl::StatusOr<DispatchResponse>>& result) {
+      [this, start_js_execution_time = absl::Now()](
+          const std::vector<absl::StatusOr<DispatchResponse>>& result) {
+        const absl::Time end_js_execution_time = absl::Now();
+        cpu_time_.AddDispatchWallTime(end_js_execution_time -
+                                      start_js_execution_time);
+        timeline_.Record(RequestStage::kDispatch, start_js_execution_time,
+                         end_js_execution_time);
         ReportingCallback(result);
       });
 
   if (!status.ok()) {
-    std::string original_request;
-    TextFormat::PrintToString(raw_request_, &original_request);
-    logger_.vlog(
-        1, "Reporting execution request failed for batch: ", original_request,
-        status.ToString(absl::StatusToStringMode::kWithEverything));
-    FinishWithOkStatus();
+    logger_.vlog(1, "Reporting execution request failed for batch: ",
+                 LazyFormat([this]() {
+                   return DescribeRequestForErrorLog(raw_request_,
+                                                     consented_debug_token_);
+                 }),
+                 status.ToString(absl::StatusToStringMode::kWithEverything));
+    EncryptAndFinish();
   }
 }
 
@@ -677,142 +1590,166 @@ void ScoreAdsReactor::ScoreAdsCallback(
       }
     }
   }
+  start_handle_response_time_ = absl::Now();
+  const absl::Duration start_handle_response_cpu = ThreadCpuTime();
   benchmarking_logger_->HandleResponseBegin();
 
-  // Saving the index of the most desirable ad allows us to only perform the
-  // work of setting the overall response object once.
+  // The parsed scoreAd() response of each ad, paired with the id of the ad.
+  // Batch dispatch responses are expanded into one entry per ad.
+  std::vector<std::pair<absl::string_view, absl::StatusOr<ScoreAdOutput>>>
+      ad_responses;
+  ad_responses.reserve(ad_data_.size());
+  for (const auto& response : responses) {
+    if (!response.ok()) {
+      logger_.warn("Invalid execution (possibly invalid input): ",
+                   response.status().ToString(
+                       absl::StatusToStringMode::kWithEverything));
+      continue;
+    }
+    auto batch_itr = batched_ad_ids_.find(response->id);
+    if (batch_itr == batched_ad_ids_.end()) {
+      absl::StatusOr<std::vector<ScoreAdOutput>> output =
+          ParseScoreAdOutputs(response->resp, /*batch_size=*/0);
+      if (output.ok()) {
+        ad_responses.emplace_back(response->id, std::move(output->front()));
+      } else {
+        ad_responses.emplace_back(response->id, output.status());
+      }
+      continue;
+    }
+    absl::StatusOr<std::vector<ScoreAdOutput>> batch_responses =
+        ParseScoreAdOutputs(response->resp, batch_itr->second.size());
+    if (!batch_responses.ok()) {
+      logger_.warn("Invalid json output from code execution for batch ",
+                   response->id, ": ", batch_responses.status().message());
+      continue;
+    }
+    for (int i = 0; i < batch_responses->size(); i++) {
+      ad_responses.emplace_back(batch_itr->second[i],
+                                std::move((*batch_responses)[i]));
+    }
+  }
+  // Only the ads scored by this request, before the cached scores are added.
+  std::optional<absl::Duration> max_execution_time;
+  for (const auto& [id, output] : ad_responses) {
+    if (output.ok() && output->execution_time.has_value()) {
+      max_execution_time =
+          std::max(max_execution_time.value_or(absl::ZeroDuration()),
+                   *output->execution_time);
+    }
+  }
+  if (max_execution_time.has_value()) {
+    LogIfError(
+        metric_context_->LogHistogram<metric::kAuctionScoreAdMaxDuration>(
+            *max_execution_time / absl::Milliseconds(1)));
+  }
+  if (score_ad_result_cache_ != nullptr) {
+    for (const auto& [id, output] : ad_responses) {
+      if (auto it = score_ad_result_keys_.find(id);
+          output.ok() && it != score_ad_result_keys_.end()) {
+        score_ad_result_cache_->Insert(it->second, *output);
+      }
+    }
+    for (auto& [id, output] : cached_score_ad_outputs_) {
+      ad_responses.emplace_back(id, std::move(output));
+    }
+  }
+
+  // Index in ad_responses of the most desirable ad.
   int index_of_most_desirable_ad = 0;
-  // List of all the scores and Ad's index in the response.
-  absl::flat_hash_map<float, std::list<int>> score_ad_map;
-  // Saving the desirability allows us to compare desirability between ads
-  // without re-parsing the current most-desirable ad every time.
-  float desirability_of_most_desirable_ad = std::numeric_limits<float>::min();
+  // Winner, highest scoring other bids, rejection reasons and ads to debug
+  // report, kept up to date as each score is parsed.
+  ScoringAccumulator accumulator(highest_scoring_other_bids_top_k_);
   // List of rejection reasons provided by seller.
   std::vector<ScoreAdsResponse::AdScore::AdRejectionReason>
-      ad_rejection_reasons;
+      ad_rejection_reasons = std::move(pre_scoring_rejection_reasons_);
+  for (const auto& ad_rejection_reason : ad_rejection_reasons) {
+    accumulator.AddRejectionReason(ad_rejection_reason);
+  }
 
-  std::optional<ScoreAdsResponse::AdScore> winning_ad;
-  int total_bid_count = static_cast<int>(responses.size());
-  int seller_rejected_bid_count = 0;
+  int total_bid_count = static_cast<int>(ad_data_.size()) +
+                        static_cast<int>(ad_rejection_reasons.size());
   LogIfError(metric_context_->AccumulateMetric<metric::kAuctionTotalBidsCount>(
       total_bid_count));
-  for (int index = 0; index < responses.size(); index++) {
-    if (responses[index].ok()) {
-      absl::StatusOr<rapidjson::Document> response_json =
-          ParseAndGetScoreAdResponseJson(enable_adtech_code_logging_,
-                                         responses[index].value().resp,
-                                         logger_);
-      if (!response_json.ok()) {
-        logger_.vlog(0, "Failed to parse response from Roma ",
-                     response_json.status().ToString(
-                         absl::StatusToStringMode::kWithEverything));
+  // Reserved so that the scores the accumulator points to never move.
+  ad_scores_.reserve(ad_responses.size());
+  for (int index = 0; index < ad_responses.size(); index++) {
+    absl::StatusOr<ScoreAdOutput>& response_json = ad_responses[index].second;
+    if (!response_json.ok()) {
+      logger_.vlog(0, "Failed to parse response from Roma ",
+                   response_json.status().ToString(
+                       absl::StatusToStringMode::kWithEverything));
+    }
+    const AdWithBidMetadata* ad = ad_data_.at(ad_responses[index].first).get();
+
+    if (response_json.ok()) {
+      ScoreAdsResponse::AdScore& score_ads_response =
+          ad_scores_.emplace_back(std::move(response_json->score));
+      score_ads_response.set_interest_group_name(ad->interest_group_name());
+      score_ads_response.set_interest_group_owner(ad->interest_group_owner());
+      score_ads_response.set_buyer_bid(ad->bid());
+      score_ads_response.set_ad_type(AdType::AD_TYPE_PROTECTED_AUDIENCE_AD);
+      if (accumulator.AddScore(ad_scores_.size() - 1, score_ads_response)) {
+        index_of_most_desirable_ad = index;
       }
-      const AdWithBidMetadata* ad =
-          ad_data_.at(responses[index].value().id).get();
-
-      if (response_json.ok()) {
-        ScoreAdsResponse::AdScore score_ads_response =
-            ParseScoreAdResponse(*response_json);
-        score_ads_response.set_interest_group_name(ad->interest_group_name());
-        score_ads_response.set_interest_group_owner(ad->interest_group_owner());
-        score_ads_response.set_buyer_bid(ad->bid());
-        score_ads_response.set_ad_type(AdType::AD_TYPE_PROTECTED_AUDIENCE_AD);
-        // >= ensures that in the edge case where the most desirable ad's
-        // desirability is float.min_val, it is still selected.
-        if (score_ads_response.desirability() >=
-            desirability_of_most_desirable_ad) {
-          winning_ad = std::make_optional(score_ads_response);
-          index_of_most_desirable_ad = index;
-          desirability_of_most_desirable_ad = score_ads_response.desirability();
-        }
-        score_ad_map[score_ads_response.desirability()].push_back(index);
-        ad_scores_.push_back(
-            std::make_unique<ScoreAdsResponse::AdScore>(score_ads_response));
-        // Parse Ad rejection reason and store only if it has value.
-        const auto& ad_rejection_reason =
-            ParseAdRejectionReason(*response_json, ad->interest_group_owner(),
-                                   ad->interest_group_name(), logger_);
-        if (ad_rejection_reason.has_value()) {
-          ad_rejection_reasons.push_back(ad_rejection_reason.value());
-          seller_rejected_bid_count += 1;
-          LogIfError(
-              metric_context_
-                  ->AccumulateMetric<metric::kAuctionBidRejectedCount>(
-                      1, ToSellerRejectionReasonString(
-                             ad_rejection_reason.value().rejection_reason())));
-        }
-      } else {
-        logger_.warn(
-            "Invalid json output from code execution for interest group ",
-            ad->interest_group_name(), ": ", responses[index].value().resp);
+      // Parse Ad rejection reason and store only if it has value.
+      const auto& ad_rejection_reason =
+          ParseAdRejectionReason(response_json->reject_reason,
+                                 ad->interest_group_owner(),
+                                 ad->interest_group_name(), logger_);
+      if (ad_rejection_reason.has_value()) {
+        ad_rejection_reasons.push_back(ad_rejection_reason.value());
+        accumulator.AddRejectionReason(ad_rejection_reason.value());
+        LogIfError(
+            metric_context_->AccumulateMetric<metric::kAuctionBidRejectedCount>(
+                1, ToSellerRejectionReasonString(
+                       ad_rejection_reason.value().rejection_reason())));
       }
     } else {
-      logger_.warn("Invalid execution (possibly invalid input): ",
-                   responses[index].status().ToString(
-                       absl::StatusToStringMode::kWithEverything));
+      logger_.warn(
+          "Invalid json output from code execution for interest group ",
+          ad->interest_group_name(), ": ", response_json.status().message());
     }
   }
   LogIfError(metric_context_->LogHistogram<metric::kAuctionBidRejectedPercent>(
-      (static_cast<double>(seller_rejected_bid_count)) / total_bid_count));
+      (static_cast<double>(accumulator.rejected_count())) / total_bid_count));
   // An Ad won.
-  if (winning_ad.has_value()) {
+  if (accumulator.winner_index().has_value()) {
+    // The only copy of a score, as the response is on the request arena.
+    ScoreAdsResponse::AdScore* winning_ad = raw_response_.mutable_ad_score();
+    *winning_ad = std::move(ad_scores_[*accumulator.winner_index()]);
     // Set the overall response for the winning winning_ad_with_bid.
     AdWithBidMetadata* winning_ad_with_bid =
-        ad_data_.at(responses[index_of_most_desirable_ad].value().id).get();
+        ad_data_.at(ad_responses[index_of_most_desirable_ad].first).get();
     // Add the relevant fields.
     winning_ad->set_render(winning_ad_with_bid->render());
     winning_ad->mutable_component_renders()->Swap(
         winning_ad_with_bid->mutable_ad_components());
-    std::vector<float> scores_list;
-    // Logic to calculate the list of highest scoring other bids and
-    // corresponding IG owners.
-    for (const auto& entry : score_ad_map) {
-      scores_list.push_back(entry.first);
-    }
-    // Sort the scores in descending order
-    std::sort(scores_list.begin(), scores_list.end(),
-              [](int a, int b) { return a > b; });
-    // Add all the bids with the top 2 scores(excluding the winner and bids
-    // with 0 score) and corresponding interest group owners to
-    // ig_owner_highest_scoring_other_bids_map.
-    for (int i = 0; i < 2 && i < scores_list.size(); i++) {
-      if (scores_list.at(i) == 0) {
-        break;
-      }
-      for (int current_index : score_ad_map.at(scores_list.at(i))) {
-        if (index_of_most_desirable_ad != current_index) {
-          const AdWithBidMetadata* ad =
-              ad_data_.at(responses[current_index].value().id).get();
-          winning_ad->mutable_ig_owner_highest_scoring_other_bids_map()
-              ->try_emplace(ad->interest_group_owner(),
-                            google::protobuf::ListValue());
-          winning_ad->mutable_ig_owner_highest_scoring_other_bids_map()
-              ->at(ad->interest_group_owner())
-              .add_values()
-              ->set_number_value(ad->bid());
-        }
-      }
+    // Add all the bids with the top K scores (excluding the winner and bids
+    // with non-positive scores) and corresponding interest group owners to
+    // ig_owner_highest_scoring_other_bids_map. A single scored ad has no
+    // other bids.
+    if (ad_responses.size() > 1) {
+      accumulator.AddHighestScoringOtherBids(*winning_ad);
     }
 
     winning_ad->mutable_ad_rejection_reasons()->Assign(
         ad_rejection_reasons.begin(), ad_rejection_reasons.end());
 
-    PerformDebugReporting(winning_ad);
-    *raw_response_.mutable_ad_score() = winning_ad.value();
-
-    logger_.vlog(2, "ScoreAdsResponse:\n", response_->DebugString());
+    logger_.vlog(2, "ScoreAdsResponse:\n", DebugStringOf(*response_));
+    PerformDebugReporting(accumulator, winning_ad);
+    cpu_time_.AddSince(CpuStage::kHandleResponse, start_handle_response_cpu);
     if (!enable_report_result_url_generation_) {
-      DCHECK(encryption_enabled_);
-      EncryptResponse();
-      benchmarking_logger_->HandleResponseEnd();
-      FinishWithOkStatus();
+      EncryptAndFinish();
       return;
     }
-    PerformReporting(winning_ad.value());
+    PerformReporting(*winning_ad);
   } else {
     LOG(WARNING) << "No ad was selected as most desirable";
-    PerformDebugReporting(winning_ad);
+    PerformDebugReporting(accumulator, /*winning_ad_score=*/nullptr);
     benchmarking_logger_->HandleResponseEnd();
+    LogHandleResponseDuration();
+    cpu_time_.AddSince(CpuStage::kHandleResponse, start_handle_response_cpu);
     Finish(grpc::Status(grpc::StatusCode::NOT_FOUND,
                         "No ad was selected as most desirable"));
   }
@@ -820,6 +1757,7 @@ void ScoreAdsReactor::ScoreAdsCallback(
 
 void ScoreAdsReactor::ReportingCallback(
     const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
+  const absl::Duration start_cpu = ThreadCpuTime();
   if (VLOG_IS_ON(2)) {
     for (const auto& dispatch_response : responses) {
       logger_.vlog(2, "Reporting V8 Response: ", dispatch_response.status());
@@ -875,50 +1813,95 @@ void ScoreAdsReactor::ReportingCallback(
     }
   }
 
-  logger_.vlog(2, "ReportingResponse:\n", response_->DebugString());
-  DCHECK(encryption_enabled_);
-  EncryptResponse();
-  benchmarking_logger_->HandleResponseEnd();
-  FinishWithOkStatus();
+  logger_.vlog(2, "ReportingResponse:\n", DebugStringOf(*response_));
+  cpu_time_.AddSince(CpuStage::kHandleResponse, start_cpu);
+  EncryptAndFinish();
+}
+
+void ScoreAdsReactor::LogHandleResponseDuration() {
+  LogIfError(
+      metric_context_->LogHistogram<metric::kAuctionHandleResponseDuration>(
+          (absl::Now() - start_handle_response_time_) /
+          absl::Microseconds(1)));
+  timeline_.Record(RequestStage::kParse, start_handle_response_time_,
+                   absl::Now());
 }
 
 void ScoreAdsReactor::PerformDebugReporting(
-    const std::optional<ScoreAdsResponse::AdScore>& winning_ad_score) {
+    ScoringAccumulator& accumulator,
+    const ScoreAdsResponse::AdScore* winning_ad_score) {
   PostAuctionSignals post_auction_signals =
-      GeneratePostAuctionSignals(winning_ad_score);
-  for (const auto& ad_score : ad_scores_) {
-    if (ad_score->has_debug_report_urls()) {
-      std::string debug_url;
-      std::string ig_owner = ad_score->interest_group_owner();
-      std::string ig_name = ad_score->interest_group_name();
-      auto done_cb = [ig_owner,
-                      ig_name](absl::StatusOr<absl::string_view> result) {
-        if (result.ok()) {
-          VLOG(2) << "Performed debug reporting for:" << ig_owner
-                  << ", interest_group: " << ig_name;
-        } else {
-          VLOG(1) << "Error while performing debug reporting for:" << ig_owner
-                  << ", interest_group: " << ig_name
-                  << " ,status:" << result.status();
-        }
-      };
-      if (ig_owner == post_auction_signals.winning_ig_owner &&
-          ig_name == post_auction_signals.winning_ig_name) {
-        debug_url = ad_score->debug_report_urls().auction_debug_win_url();
+      accumulator.TakePostAuctionSignals(winning_ad_score);
+  auto ad_score_at = [&](int index) {
+    return index == accumulator.winner_index() ? winning_ad_score
+                                               : &ad_scores_[index];
+  };
+  auto is_winner_at = [&](int index) {
+    const ScoreAdsResponse::AdScore* ad_score = ad_score_at(index);
+    return ad_score->interest_group_owner() ==
+               post_auction_signals.winning_ig_owner &&
+           ad_score->interest_group_name() ==
+               post_auction_signals.winning_ig_name;
+  };
+  const std::vector<int>& debug_report_indices =
+      accumulator.debug_report_indices();
+  const int num_loss_reports =
+      std::count_if(debug_report_indices.begin(), debug_report_indices.end(),
+                    [&](int index) { return !is_winner_at(index); });
+  const std::vector<bool> send_loss_reports =
+      debug_report_limiter_ != nullptr
+          ? debug_report_limiter_->PickLossReports(num_loss_reports)
+          : std::vector<bool>(num_loss_reports, true);
+  int loss_report = 0;
+  for (int index : debug_report_indices) {
+    const ScoreAdsResponse::AdScore* ad_score = ad_score_at(index);
+    const bool is_winner = is_winner_at(index);
+    if (!is_winner && !send_loss_reports[loss_report++]) {
+      continue;
+    }
+    std::string ig_owner = ad_score->interest_group_owner();
+    std::string ig_name = ad_score->interest_group_name();
+    auto done_cb = [ig_owner,
+                    ig_name](absl::StatusOr<absl::string_view> result) {
+      if (result.ok()) {
+        VLOG(2) << "Performed debug reporting for:" << ig_owner
+                << ", interest_group: " << ig_name;
       } else {
-        debug_url = ad_score->debug_report_urls().auction_debug_loss_url();
+        VLOG(1) << "Error while performing debug reporting for:" << ig_owner
+                << ", interest_group: " << ig_name
+                << " ,status:" << result.status();
       }
-      HTTPRequest http_request = CreateDebugReportingHttpRequest(
-          debug_url, GetPlaceholderDataForInterestGroup(ig_owner, ig_name,
-                                                        post_auction_signals));
-      async_reporter_->DoReport(http_request, done_cb);
-    }
+    };
+    const std::string& debug_url =
+        is_winner ? ad_score->debug_report_urls().auction_debug_win_url()
+                  : ad_score->debug_report_urls().auction_debug_loss_url();
+    HTTPRequest http_request = CreateDebugReportingHttpRequest(
+        debug_url, GetPlaceholderDataForInterestGroup(ig_owner, ig_name,
+                                                      post_auction_signals));
+    async_reporter_->DoReport(http_request, done_cb);
   }
 }
 
+void ScoreAdsReactor::EncryptAndFinish() {
+  DCHECK(encryption_enabled_);
+  RunEncryption([this]() {
+    EncryptResponse();
+    benchmarking_logger_->HandleResponseEnd();
+    LogHandleResponseDuration();
+    FinishWithOkStatus();
+  });
+}
+
 void ScoreAdsReactor::FinishWithOkStatus() {
   metric_context_->SetRequestSuccessful();
   Finish(grpc::Status::OK);
 }
 
+void ScoreAdsReactor::OnDone() {
+  LogServerCryptoMetrics(crypto_metrics_, *metric_context_);
+  LogRequestCpuTime(cpu_time_, *metric_context_);
+  ReportTimeline(raw_request_.ad_bids_size());
+  delete this;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -24,16 +24,24 @@
 #include <grpcpp/grpcpp.h>
 
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
+#include "rapidjson/allocators.h"
 #include "services/auction_service/benchmarking/score_ads_benchmarking_logger.h"
 #include "services/auction_service/data/runtime_config.h"
 #include "services/auction_service/reporting/reporting_response.h"
+#include "services/auction_service/score_ad_output.h"
+#include "services/auction_service/score_ad_result_cache.h"
+#include "services/auction_service/scoring_accumulator.h"
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
 #include "services/common/code_dispatch/code_dispatch_reactor.h"
+#include "services/common/concurrent/ttl_lru_cache.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/reporters/async_reporter.h"
 #include "services/common/util/context_logger.h"
+#include "services/common/util/object_pool.h"
+#include "services/common/util/signal_blob_cache.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -43,6 +51,36 @@ inline constexpr char kNoAdsWithValidScoringSignals[] =
     "No ads with valid scoring signals.";
 inline constexpr char kNoTrustedScoringSignals[] =
     "Empty trusted scoring signals";
+inline constexpr char kAllAdsRejectedBeforeScoring[] =
+    "All ads were rejected before scoring.";
+inline constexpr int kDefaultHighestScoringOtherBidsTopK = 2;
+// Properties of seller_signals read by the pre-scoring filter.
+inline constexpr char kMinBidPropertyForPreScoringFilter[] = "minBid";
+inline constexpr char kBlockedInterestGroupOwnersPropertyForPreScoringFilter[] =
+    "blockedInterestGroupOwners";
+// Size of each block the per-request JSON arena requests from the heap.
+inline constexpr size_t kJsonArenaChunkCapacity = 64 * 1024;
+
+inline constexpr char kDeadlineExceededBeforeScoring[] =
+    "Request deadline reached before scoring ads.";
+
+// Returns num_requests scoreAdEntryFunction calls with synthetic inputs,
+// executed after a code load to warm up the Roma workers.
+std::vector<DispatchRequest> MakeScoreAdWarmUpRequests(int num_requests);
+
+// Identifies the serialized metadata of one creative: the ad render URL and a
+// hash of the deterministic proto encoding of the ad's metadata, or of the
+// ad_metadata_json of the ad when set.
+using AdMetadataJsonCacheKey = std::pair<std::string, size_t>;
+// Process wide cache of the JSON passed to scoreAd as each ad's metadata,
+// bounded by its number of creatives. Entries never expire, as the key
+// changes with the metadata.
+class AdMetadataJsonCache
+    : public TtlLruCache<AdMetadataJsonCacheKey, std::string> {
+ public:
+  explicit AdMetadataJsonCache(size_t capacity)
+      : TtlLruCache({.max_entries = capacity}) {}
+};
 
 // This is a gRPC reactor that serves a single ScoreAdsRequest.
 // It stores state relevant to the request and after the
@@ -59,13 +97,22 @@ class ScoreAdsReactor
       std::unique_ptr<ScoreAdsBenchmarkingLogger> benchmarking_logger,
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      std::unique_ptr<AsyncReporter> async_reporter,
-      const AuctionServiceRuntimeConfig& runtime_config);
+      std::shared_ptr<AsyncReporter> async_reporter,
+      const AuctionServiceRuntimeConfig& runtime_config,
+      AdMetadataJsonCache* ad_metadata_json_cache = nullptr);
 
   // Initiates the asynchronous execution of the ScoreAdsRequest.
   virtual void Execute();
 
+  // Sets the deadline of the ScoreAds RPC. The Roma timeout of the dispatch
+  // requests is shortened so that ads are scored before it, and no request is
+  // dispatched once it is too close. Must be called before Execute.
+  void SetDeadline(absl::Time deadline);
+
  private:
+  // Logs the crypto metrics of the request, and deletes the reactor.
+  void OnDone() override;
+
   // Asynchronous callback used by the v8 code executor to return a result. This
   // will be called in a different thread owned by the code dispatch library.
   //
@@ -78,34 +125,86 @@ class ScoreAdsReactor
   ContextLogger::ContextMap GetLoggingContext(
       const ScoreAdsRequest::ScoreAdsRawRequest& score_ads_request);
 
-  // Performs debug reporting for all scored ads by the seller.
-  void PerformDebugReporting(
-      const std::optional<ScoreAdsResponse::AdScore>& winning_ad_score);
+  // Performs debug reporting for all scored ads by the seller, with the
+  // post auction signals taken from `accumulator`. winning_ad_score is null if
+  // no ad won, and replaces the score of the winner in ad_scores_, which it
+  // was moved out of.
+  void PerformDebugReporting(ScoringAccumulator& accumulator,
+                             const ScoreAdsResponse::AdScore* winning_ad_score);
 
   void PerformReporting(const ScoreAdsResponse::AdScore& winning_ad_score);
+  // Returns the metadata JSON argument for the ad, served from
+  // ad_metadata_json_cache_ when it is set.
+  std::shared_ptr<std::string> GetAdMetadataJson(
+      const ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata& ad);
+  // Same as above for an ad whose ad_metadata_json is set, whose "metadata"
+  // is copied out of the JSON rather than converted from a proto.
+  std::shared_ptr<std::string> GetAdMetadataJsonFromAdJson(
+      const ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata& ad);
+
+  // Parses a scoreAdEntryFunction() response, or the
+  // scoreAdsBatchEntryFunction() response of batch_size ads when batch_size
+  // is above 0, into the scoreAd() output of each ad.
+  absl::StatusOr<std::vector<ScoreAdOutput>> ParseScoreAdOutputs(
+      const std::string& response, int batch_size);
+
+  // Records the time elapsed since the dispatch responses started being
+  // handled.
+  void LogHandleResponseDuration();
+
+  // Encrypts the response, then finishes the RPC call with an OK status.
+  void EncryptAndFinish();
+
   // Finishes the RPC call with an OK status.
   void FinishWithOkStatus();
   void ReportingCallback(
       const std::vector<absl::StatusOr<DispatchResponse>>& responses);
 
+  // Containers of the state of a request, taken from ScoringStatePool so that
+  // they keep their capacity across requests.
+  struct ScoringState {
+    absl::flat_hash_map<
+        std::string,
+        std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata>>
+        ad_data;
+    std::vector<ScoreAdsResponse::AdScore> ad_scores;
+    absl::flat_hash_map<std::string, std::vector<std::string>> batched_ad_ids;
+    std::vector<ScoreAdsResponse::AdScore::AdRejectionReason>
+        pre_scoring_rejection_reasons;
+  };
+
+  // Returns the pool of the scoring states of the reactors of the process.
+  static ObjectPool<ScoringState>& ScoringStatePool();
+
+  ObjectPool<ScoringState>::Ptr state_ = ScoringStatePool().Acquire();
+
   // The key is the id of the DispatchRequest, and the value is the ad
   // used to create the dispatch request. This map is used to amend each ad's
   // DispatchResponse with more data which is then passed into the final
   // ScoreAdsResponse.
   absl::flat_hash_map<
       std::string,
-      std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata>>
-      ad_data_;
+      std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata>>&
+      ad_data_ = state_->ad_data;
   std::unique_ptr<ScoreAdsBenchmarkingLogger> benchmarking_logger_;
-  std::unique_ptr<AsyncReporter> async_reporter_;
+  std::shared_ptr<AsyncReporter> async_reporter_;
   bool enable_seller_debug_url_generation_;
   std::string roma_timeout_ms_;
+  std::string consented_debug_token_;
+  absl::Time deadline_ = absl::InfiniteFuture();
   ContextLogger logger_;
 
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::AuctionContext> metric_context_;
+  absl::Time start_handle_response_time_;
 
-  std::vector<std::unique_ptr<ScoreAdsResponse::AdScore>> ad_scores_;
+  // The scores of the ads, in the order they were parsed. The winner's is
+  // moved into the response.
+  std::vector<ScoreAdsResponse::AdScore>& ad_scores_ = state_->ad_scores;
+
+  // The auctionConfig argument, serialized once for scoreAd and reused by
+  // the reporting dispatch.
+  std::shared_ptr<std::string> auction_config_;
 
   // Flags needed to be passed as input to the code which wraps AdTech provided
   // code.
@@ -114,6 +213,62 @@ class ScoreAdsReactor
   bool enable_report_result_url_generation_;
   bool enable_report_win_url_generation_;
   std::string seller_origin_;
+
+  // Builds per-ad scoring signals from byte ranges of the raw KV response
+  // instead of per-URL rapidjson documents.
+  bool enable_zero_copy_scoring_signals_;
+
+  // Number of highest distinct scores whose bids (other than the winner) are
+  // reported in ig_owner_highest_scoring_other_bids_map.
+  int highest_scoring_other_bids_top_k_;
+
+  // Maximum number of ads scored per scoreAdsBatchEntryFunction dispatch. Ads
+  // are dispatched one by one when this is at most 1.
+  int score_ads_batch_size_;
+
+  // Ids of the ads scored by each batch dispatch request, keyed by the id of
+  // the batch request and in the order the batch returns their scores.
+  absl::flat_hash_map<std::string, std::vector<std::string>>& batched_ad_ids_ =
+      state_->batched_ad_ids;
+
+  // Drops ads failing the minimum bid or blocked interest group owners taken
+  // from seller_signals before they are dispatched to scoreAd.
+  bool enable_seller_pre_scoring_filter_;
+
+  // Parses the scoreAd() responses with the on-demand JSON parser instead of
+  // rapidjson.
+  bool use_on_demand_json_parser_;
+
+  // Rejection reasons of the ads dropped by the pre-scoring filter.
+  std::vector<ScoreAdsResponse::AdScore::AdRejectionReason>&
+      pre_scoring_rejection_reasons_ = state_->pre_scoring_rejection_reasons;
+
+  // Not owned. Limits the debug loss reports, unlimited if null.
+  DebugReportLimiter* debug_report_limiter_;
+
+  // Request scoped arena backing every rapidjson document built while serving
+  // this request. rapidjson never frees from a memory pool, so all of it is
+  // released at once when the reactor is deleted in OnDone. Execute and the
+  // dispatch callbacks run one after another, never concurrently, so no
+  // locking is needed.
+  rapidjson::MemoryPoolAllocator<> json_arena_;
+
+  // Not owned. Shared by all reactors, null when the cache is disabled.
+  AdMetadataJsonCache* ad_metadata_json_cache_;
+  int ad_metadata_cache_hits_ = 0;
+  int ad_metadata_cache_misses_ = 0;
+
+  // Not owned. Shared by all reactors, null when the cache is disabled.
+  SignalBlobCache* signal_blob_cache_;
+
+  // Not owned. Shared by all reactors, null when the cache is disabled.
+  ScoreAdResultCache* score_ad_result_cache_;
+  // Keys the outputs of the dispatched ads are cached under, by the id of
+  // their dispatch request.
+  absl::flat_hash_map<std::string, std::string> score_ad_result_keys_;
+  // Outputs of the ads served from the cache instead of being dispatched,
+  // paired with the id of the ad.
+  std::vector<std::pair<std::string, ScoreAdOutput>> cached_score_ad_outputs_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 #endif  // SERVICES_AUCTION_SERVICE_SCORE_ADS_REACTOR_H_
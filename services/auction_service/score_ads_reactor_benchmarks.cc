@@ -0,0 +1,277 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Microbenchmarks for ScoreAdsReactor.
+//
+// Each benchmark runs a ScoreAdsRawRequest of configurable size (ads, ad
+// components per ad and bytes of trusted scoring signals per URL) through the
+// reactor. The phase boundaries reported to the reactor's benchmarking logger
+// are exported as per-iteration counters:
+// - build_input_us: trusted scoring signals and auction config building.
+// - dispatch_us: per ad scoreAd input building plus the dispatch itself.
+// - handle_response_us: scoreAd response parsing and winner selection.
+//
+// BM_ScoreAdsWithFakeDispatcher answers every dispatch synchronously with a
+// canned scoreAd response, isolating the reactor's own work.
+// BM_ScoreAdsWithRomaDispatcher runs the scoreAd script of one of the
+// workloads of services/common/test/utils/js_workloads.h in Roma, selected by
+// the "workload" argument, on signals generated for it. The workload and the
+// version of the corpus are reported as the label.
+//
+// Run with:
+//   bazel run -c opt //services/auction_service:score_ads_reactor_benchmarks
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "services/auction_service/benchmarking/score_ads_benchmarking_logger.h"
+#include "services/auction_service/score_ads_reactor.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/config/trusted_server_config_client.h"
+#include "services/common/constants/common_service_flags.h"
+#include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/encryption/pass_through_crypto_client.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/reporters/async_reporter.h"
+#include "services/common/test/mocks.h"
+#include "services/common/test/random.h"
+#include "services/common/test/utils/js_workloads.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using RawRequest = ScoreAdsRequest::ScoreAdsRawRequest;
+
+constexpr char kKeyId[] = "key_id";
+
+// Accumulates the time spent in each phase reported by the reactor.
+struct PhaseDurations {
+  absl::Duration build_input;
+  absl::Duration dispatch;
+  absl::Duration handle_response;
+};
+
+class PhaseTimingLogger : public ScoreAdsBenchmarkingLogger {
+ public:
+  explicit PhaseTimingLogger(PhaseDurations& durations)
+      : durations_(durations) {}
+
+  void Begin() override {}
+  void End() override {}
+
+  void BuildInputBegin() override { phase_start_ = absl::Now(); }
+  void BuildInputEnd() override { durations_.build_input += EndPhase(); }
+  void HandleResponseBegin() override { durations_.dispatch += EndPhase(); }
+  void HandleResponseEnd() override {
+    durations_.handle_response += EndPhase();
+  }
+
+ private:
+  // Returns the time since the previous phase boundary and starts the next
+  // phase.
+  absl::Duration EndPhase() {
+    const absl::Time now = absl::Now();
+    const absl::Duration elapsed = now - phase_start_;
+    phase_start_ = now;
+    return elapsed;
+  }
+
+  PhaseDurations& durations_;
+  absl::Time phase_start_;
+};
+
+// Answers dispatches synchronously with a canned scoreAd output, or forwards
+// them to Roma and blocks until the reactor's callback has returned.
+class BenchmarkDispatchClient : public CodeDispatchClient {
+ public:
+  // Dispatches to Roma only if `use_roma` is set.
+  BenchmarkDispatchClient(const V8Dispatcher& dispatcher, bool use_roma)
+      : CodeDispatchClient(dispatcher), use_roma_(use_roma) {}
+
+  absl::Status BatchExecute(
+      std::vector<DispatchRequest>& batch,
+      BatchDispatchDoneCallback batch_callback) const override {
+    if (!use_roma_) {
+      std::vector<absl::StatusOr<DispatchResponse>> responses;
+      responses.reserve(batch.size());
+      for (int i = 0; i < batch.size(); i++) {
+        DispatchResponse response;
+        response.id = batch[i].id;
+        response.resp = absl::Substitute(
+            R"({"response":{"desirability":$0,"allowComponentAuction":false},"logs":[],"errors":[],"warnings":[]})",
+            i + 1);
+        responses.push_back(std::move(response));
+      }
+      batch_callback(responses);
+      return absl::OkStatus();
+    }
+
+    absl::Notification done;
+    absl::Status status = CodeDispatchClient::BatchExecute(
+        batch,
+        [&batch_callback, &done](
+            const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
+          batch_callback(responses);
+          done.Notify();
+        });
+    if (status.ok()) {
+      done.WaitForNotification();
+    }
+    return status;
+  }
+
+ private:
+  const bool use_roma_;
+};
+
+// Builds a request with `num_ads` ads of `num_ad_components` components each
+// and `signal_bytes` bytes of trusted scoring signals for every render and
+// component URL, shaped for the workload.
+RawRequest MakeScoreAdsRawRequest(int num_ads, int num_ad_components,
+                                  int signal_bytes, JsWorkload workload) {
+  RawRequest raw_request;
+  raw_request.set_auction_signals(*MakeARandomStructJsonString(5));
+  raw_request.set_seller_signals(*MakeARandomStructJsonString(5));
+  raw_request.set_publisher_hostname(MakeARandomString());
+  const std::string signal =
+      MakeJsWorkloadTrustedSignal(workload, signal_bytes);
+  std::string render_url_signals;
+  for (int i = 0; i < num_ads; i++) {
+    auto* ad = raw_request.add_ad_bids();
+    *ad = MakeARandomAdWithBidMetadata(/*min_bid=*/1, /*max_bid=*/10,
+                                       num_ad_components);
+    ad->set_render(absl::StrCat("https://render.com/ad?id=", i));
+    (*raw_request.mutable_per_buyer_signals())[ad->interest_group_owner()] =
+        "{}";
+    absl::StrAppend(&render_url_signals, i == 0 ? "" : ",", "\"",
+                    ad->render(), "\":", signal);
+  }
+  std::string component_signals;
+  for (int i = 0; i < num_ad_components; i++) {
+    absl::StrAppend(&component_signals, i == 0 ? "" : ",",
+                    "\"adComponent.com/id=", i, "\":", signal);
+  }
+  raw_request.set_scoring_signals(
+      absl::StrCat(R"({"renderUrls":{)", render_url_signals,
+                   R"(},"adComponentRenderUrls":{)", component_signals, "}}"));
+  return raw_request;
+}
+
+void RunScoreAds(benchmark::State& state, const CodeDispatchClient& client,
+                 JsWorkload workload) {
+  server_common::TelemetryConfig config_proto;
+  config_proto.set_mode(server_common::TelemetryConfig::PROD);
+  metric::AuctionContextMap(server_common::BuildDependentConfig(config_proto));
+  TrustedServersConfigClient config_client({});
+  config_client.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
+  config_client.SetFlagForTest(kTrue, TEST_MODE);
+  auto key_fetcher_manager = CreateKeyFetcherManager(config_client);
+  PassThroughCryptoClient crypto_client;
+  AuctionServiceRuntimeConfig runtime_config = {.encryption_enabled = true};
+
+  ScoreAdsRequest request;
+  request.set_key_id(kKeyId);
+  *request.mutable_request_ciphertext() =
+      MakeScoreAdsRawRequest(state.range(0), state.range(1), state.range(2),
+                             workload)
+          .SerializeAsString();
+  PhaseDurations durations;
+  for (auto _ : state) {
+    metric::AuctionContextMap()->Get(&request);
+    ScoreAdsResponse response;
+    ScoreAdsReactor reactor(
+        client, &request, &response,
+        std::make_unique<PhaseTimingLogger>(durations),
+        key_fetcher_manager.get(), &crypto_client,
+        std::make_unique<MockAsyncReporter>(
+            std::make_unique<MockHttpFetcherAsync>()),
+        runtime_config);
+    reactor.Execute();
+    benchmark::DoNotOptimize(response);
+  }
+
+  const auto per_iteration_us = [&state](absl::Duration duration) {
+    return benchmark::Counter(absl::ToDoubleMicroseconds(duration),
+                              benchmark::Counter::kAvgIterations);
+  };
+  state.counters["build_input_us"] = per_iteration_us(durations.build_input);
+  state.counters["dispatch_us"] = per_iteration_us(durations.dispatch);
+  state.counters["handle_response_us"] =
+      per_iteration_us(durations.handle_response);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_ScoreAdsWithFakeDispatcher(benchmark::State& state) {
+  V8Dispatcher dispatcher;
+  BenchmarkDispatchClient client(dispatcher, /*use_roma=*/false);
+  RunScoreAds(state, client, JsWorkload::kLight);
+}
+
+void BM_ScoreAdsWithRomaDispatcher(benchmark::State& state) {
+  V8Dispatcher dispatcher;
+  DispatchConfig config;
+  CHECK(dispatcher.Init(config).ok());
+  const JsWorkload workload = kJsWorkloads[state.range(3)];
+  CHECK(dispatcher.LoadSync(1, GetJsWorkloadSellerWrappedCode(workload)).ok());
+  state.SetLabel(
+      absl::StrCat(JsWorkloadName(workload), "/v", kJsWorkloadsVersion));
+  BenchmarkDispatchClient client(dispatcher, /*use_roma=*/true);
+  RunScoreAds(state, client, workload);
+  CHECK(dispatcher.Stop().ok());
+}
+
+// Args: number of ads, ad components per ad, scoring signal bytes per URL.
+void ScoreAdsArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"ads", "components", "signal_bytes"});
+  for (int ads : {10, 100, 500}) {
+    for (int components : {0, 5}) {
+      for (int signal_bytes : {64, 1024}) {
+        benchmark->Args({ads, components, signal_bytes});
+      }
+    }
+  }
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+// Same as ScoreAdsArguments, followed by the index of the workload in
+// kJsWorkloads.
+void ScoreAdsWithWorkloadArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"ads", "components", "signal_bytes", "workload"});
+  for (int ads : {10, 100, 500}) {
+    for (int components : {0, 5}) {
+      for (int workload = 0; workload < std::size(kJsWorkloads); workload++) {
+        benchmark->Args({ads, components, /*signal_bytes=*/256, workload});
+      }
+    }
+  }
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK(BM_ScoreAdsWithFakeDispatcher)->Apply(ScoreAdsArguments);
+BENCHMARK(BM_ScoreAdsWithRomaDispatcher)->Apply(ScoreAdsWithWorkloadArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
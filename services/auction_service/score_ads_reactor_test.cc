@@ -22,15 +22,19 @@
 
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
 #include "gmock/gmock.h"
 #include "google/protobuf/text_format.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
+#include "rapidjson/document.h"
 #include "services/auction_service/benchmarking/score_ads_benchmarking_logger.h"
 #include "services/auction_service/benchmarking/score_ads_no_op_logger.h"
 #include "services/auction_service/reporting/reporting_helper.h"
 #include "services/auction_service/reporting/reporting_helper_test_constants.h"
+#include "services/auction_service/score_ad_result_cache.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/encryption/key_fetcher_factory.h"
@@ -38,6 +42,8 @@
 #include "services/common/metric/server_definition.h"
 #include "services/common/test/mocks.h"
 #include "services/common/test/random.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
 #include "src/cpp/encryption/key_fetcher/mock/mock_key_fetcher_manager.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -346,7 +352,8 @@ class ScoreAdsReactorTest : public ::testing::Test {
   ScoreAdsResponse ExecuteScoreAds(
       RawRequest& raw_request, const MockCodeDispatchClient& dispatcher,
       AuctionServiceRuntimeConfig runtime_config,
-      bool enable_report_result_url_generation = false) {
+      bool enable_report_result_url_generation = false,
+      AdMetadataJsonCache* ad_metadata_json_cache = nullptr) {
     ScoreAdsResponse response;
     *request_.mutable_request_ciphertext() = raw_request.SerializeAsString();
     std::unique_ptr<ScoreAdsBenchmarkingLogger> benchmarkingLogger =
@@ -369,12 +376,15 @@ class ScoreAdsReactorTest : public ::testing::Test {
     ScoreAdsReactor reactor(dispatcher, &request_, &response,
                             std::move(benchmarkingLogger),
                             key_fetcher_manager.get(), &crypto_client,
-                            std::move(async_reporter), runtime_config);
+                            std::move(async_reporter), runtime_config,
+                            ad_metadata_json_cache);
+    reactor.SetDeadline(deadline_);
     reactor.Execute();
     return response;
   }
 
   ScoreAdsRequest request_;
+  absl::Time deadline_ = absl::InfiniteFuture();
 };
 
 TEST_F(
@@ -587,6 +597,451 @@ TEST_F(ScoreAdsReactorTest, CreatesScoringSignalInputPerAdWithSignal) {
   ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig());
 }
 
+TEST_F(ScoreAdsReactorTest,
+       ZeroCopyScoringSignalsMatchDocumentBasedScoringSignals) {
+  MockCodeDispatchClient dispatcher;
+  std::vector<std::string> expected_signals;
+  std::vector<std::string> zero_copy_signals;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .Times(2)
+      .WillOnce([&expected_signals](std::vector<DispatchRequest>& batch,
+                                    BatchDispatchDoneCallback done_callback) {
+        for (const auto& request : batch) {
+          expected_signals.push_back(*request.input[3]);
+        }
+        return absl::OkStatus();
+      })
+      .WillOnce([&zero_copy_signals](std::vector<DispatchRequest>& batch,
+                                     BatchDispatchDoneCallback done_callback) {
+        for (const auto& request : batch) {
+          zero_copy_signals.push_back(*request.input[3]);
+        }
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata foo, bar, has_foo_components;
+  GetTestAdWithBidFoo(foo);
+  GetTestAdWithBidBar(bar);
+  GetTestAdWithBidSameComponentAsFoo(has_foo_components);
+  BuildRawRequest({foo, bar, has_foo_components}, testSellerSignals,
+                  testAuctionSignals, testScoringSignals, testPublisherHostname,
+                  raw_request);
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig());
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.enable_zero_copy_scoring_signals = true;
+  // The first reactor released the metric context of the request.
+  metric::AuctionContextMap()->Get(&request_);
+  ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ASSERT_EQ(expected_signals.size(), 3);
+  ASSERT_EQ(zero_copy_signals.size(), expected_signals.size());
+  for (int i = 0; i < expected_signals.size(); i++) {
+    // The raw byte ranges keep the whitespace of the KV response, so compare
+    // the parsed objects rather than the strings.
+    absl::StatusOr<rapidjson::Document> expected =
+        ParseJsonString(expected_signals[i]);
+    absl::StatusOr<rapidjson::Document> actual =
+        ParseJsonString(zero_copy_signals[i]);
+    ASSERT_TRUE(expected.ok()) << expected.status();
+    ASSERT_TRUE(actual.ok()) << actual.status();
+    EXPECT_TRUE(*expected == *actual)
+        << "Expected: " << expected_signals[i]
+        << "\nActual: " << zero_copy_signals[i];
+  }
+}
+
+TEST_F(ScoreAdsReactorTest, ReusesCachedAdMetadataJsonAcrossRequests) {
+  MockCodeDispatchClient dispatcher;
+  std::vector<std::shared_ptr<std::string>> metadata_inputs;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .Times(3)
+      .WillRepeatedly([&metadata_inputs](
+                          std::vector<DispatchRequest>& batch,
+                          BatchDispatchDoneCallback done_callback) {
+        for (const auto& request : batch) {
+          metadata_inputs.push_back(request.input[0]);
+        }
+        return absl::OkStatus();
+      });
+  AdMetadataJsonCache cache(/*capacity=*/4);
+  RawRequest raw_request;
+  AdWithBidMetadata bar;
+  GetTestAdWithBidBar(bar);
+  BuildRawRequest({bar}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig(),
+                  /*enable_report_result_url_generation=*/false, &cache);
+  // The first reactor released the metric context of the request.
+  metric::AuctionContextMap()->Get(&request_);
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig(),
+                  /*enable_report_result_url_generation=*/false, &cache);
+  // The same creative with different metadata must not reuse the entry.
+  (*raw_request.mutable_ad_bids(0)
+        ->mutable_ad()
+        ->mutable_struct_value()
+        ->mutable_fields())["metadata"] = MakeAStringValue("updated");
+  metric::AuctionContextMap()->Get(&request_);
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig(),
+                  /*enable_report_result_url_generation=*/false, &cache);
+
+  ASSERT_EQ(metadata_inputs.size(), 3);
+  EXPECT_EQ(*metadata_inputs[0],
+            R"JSON(["140583167746","627640802621",null,"18281019067"])JSON");
+  EXPECT_EQ(metadata_inputs[0], metadata_inputs[1]);
+  EXPECT_EQ(*metadata_inputs[2], R"JSON("updated")JSON");
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST_F(ScoreAdsReactorTest, PassesMetadataOfAdMetadataJson) {
+  MockCodeDispatchClient dispatcher;
+  std::vector<std::string> metadata_inputs;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&metadata_inputs](std::vector<DispatchRequest>& batch,
+                                   BatchDispatchDoneCallback done_callback) {
+        for (const auto& request : batch) {
+          metadata_inputs.push_back(*request.input[0]);
+        }
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata bar;
+  GetTestAdWithBidBar(bar);
+  bar.clear_ad();
+  bar.set_ad_metadata_json(R"JSON({"metadata":{"arr":[1,"a"]},"x":2})JSON");
+  BuildRawRequest({bar}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig());
+
+  ASSERT_EQ(metadata_inputs.size(), 1);
+  EXPECT_EQ(metadata_inputs[0], R"JSON({"arr":[1,"a"]})JSON");
+}
+
+TEST_F(ScoreAdsReactorTest, ScoresAdsInBatchesWhenBatchSizeIsSet) {
+  MockCodeDispatchClient dispatcher;
+  const absl::flat_hash_map<std::string, int> score_for_render_url = {
+      {"barStandardAds.com/render_ad?id=bar", 3},
+      {"fooMeOnceAds.com/render_ad?id=hasFooComp", 2},
+      {"https://googleads.g.doubleclick.net/td/adfetch/"
+       "gda?adg_id=142601302539&cr_id=628073386727&cv_id=0",
+       1}};
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&score_for_render_url](
+                    std::vector<DispatchRequest>& batch,
+                    BatchDispatchDoneCallback done_callback) {
+        // Three ads in chunks of at most two.
+        EXPECT_EQ(batch.size(), 2);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const auto& request : batch) {
+          EXPECT_EQ(request.handler_name, "scoreAdsBatchEntryFunction");
+          EXPECT_EQ(request.input.size(), 4);
+          absl::StatusOr<rapidjson::Document> ads =
+              ParseJsonString(*request.input[0]);
+          EXPECT_TRUE(ads.ok()) << ads.status();
+          EXPECT_TRUE(ads->IsArray());
+          std::vector<std::string> outputs;
+          for (const auto& ad : ads->GetArray()) {
+            EXPECT_TRUE(ad.HasMember("adMetadata"));
+            EXPECT_TRUE(ad.HasMember("bid"));
+            EXPECT_TRUE(ad["trustedScoringSignals"].IsObject());
+            const std::string render_url =
+                ad["browserSignals"]["renderUrl"].GetString();
+            outputs.push_back(absl::Substitute(
+                R"({"response":{"desirability":$0},"logs":[]})",
+                score_for_render_url.at(render_url)));
+          }
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp =
+              absl::StrCat("[", absl::StrJoin(outputs, ","), "]");
+          responses.emplace_back(dispatch_response);
+        }
+        done_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata foo, bar, has_foo_components;
+  GetTestAdWithBidFoo(foo);
+  GetTestAdWithBidBar(bar);
+  GetTestAdWithBidSameComponentAsFoo(has_foo_components);
+  BuildRawRequest({foo, bar, has_foo_components}, testSellerSignals,
+                  testAuctionSignals, testScoringSignals, testPublisherHostname,
+                  raw_request);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.score_ads_batch_size = 2;
+  auto response = ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  EXPECT_EQ(raw_response.ad_score().render(),
+            "barStandardAds.com/render_ad?id=bar");
+  EXPECT_FLOAT_EQ(raw_response.ad_score().desirability(), 3);
+  EXPECT_EQ(raw_response.ad_score().interest_group_owner(),
+            kInterestGroupOwnerOfBarBidder);
+}
+
+TEST_F(ScoreAdsReactorTest, DispatchesASingleAdWithoutBatching) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const auto& request : batch) {
+          EXPECT_NE(request.handler_name, "scoreAdsBatchEntryFunction");
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp =
+              R"({"response":{"desirability":3},"logs":[]})";
+          responses.emplace_back(dispatch_response);
+        }
+        done_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata bar;
+  GetTestAdWithBidBar(bar);
+  BuildRawRequest({bar}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.score_ads_batch_size = 2;
+  auto response = ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  EXPECT_EQ(raw_response.ad_score().render(),
+            "barStandardAds.com/render_ad?id=bar");
+  EXPECT_FLOAT_EQ(raw_response.ad_score().desirability(), 3);
+  EXPECT_TRUE(raw_response.ad_score()
+                  .ig_owner_highest_scoring_other_bids_map()
+                  .empty());
+}
+
+TEST_F(ScoreAdsReactorTest, ReusesCachedScoreAdOutputsOfTheSameCodeVersion) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, CodeVersion)
+      .WillOnce(testing::Return(1))
+      .WillOnce(testing::Return(1))
+      .WillOnce(testing::Return(2));
+  // Only the first request and the one on the new code version dispatch.
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .Times(2)
+      .WillRepeatedly([](std::vector<DispatchRequest>& batch,
+                         BatchDispatchDoneCallback done_callback) {
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const auto& request : batch) {
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp =
+              R"({"response":{"desirability":4},"logs":[]})";
+          responses.emplace_back(dispatch_response);
+        }
+        done_callback(responses);
+        return absl::OkStatus();
+      });
+  ScoreAdResultCache cache(absl::Minutes(1), /*max_bytes=*/1 << 20);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.score_ad_result_cache = &cache;
+  RawRequest raw_request;
+  AdWithBidMetadata bar;
+  GetTestAdWithBidBar(bar);
+  BuildRawRequest({bar}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  for (int i = 0; i < 3; ++i) {
+    // The previous reactor released the metric context of the request.
+    metric::AuctionContextMap()->Get(&request_);
+    ScoreAdsResponse response =
+        ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+    ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+    raw_response.ParseFromString(response.response_ciphertext());
+    EXPECT_EQ(raw_response.ad_score().render(),
+              "barStandardAds.com/render_ad?id=bar");
+    EXPECT_FLOAT_EQ(raw_response.ad_score().desirability(), 4);
+    EXPECT_EQ(raw_response.ad_score().interest_group_owner(),
+              kInterestGroupOwnerOfBarBidder);
+  }
+}
+
+TEST_F(ScoreAdsReactorTest, TagsDispatchRequestsWithScoreAdVersion) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        for (const auto& request : batch) {
+          EXPECT_EQ(request.tags.at(kCodeExperimentTag), "experiment_1");
+        }
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata foo;
+  GetTestAdWithBidFoo(foo);
+  BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  raw_request.set_score_ad_version("experiment_1");
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig());
+}
+
+TEST_F(ScoreAdsReactorTest, ZeroCopyScoringSignalsSpliceRawKvBytes) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        for (const auto& request : batch) {
+          EXPECT_EQ(
+              *request.input[3],
+              R"JSON({"adComponentRenderUrls":{"comp.com/1":{"a": 1.50}},"renderUrl":{"fooAds.com/ad?id=1":[1, "two"]}})JSON");
+        }
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata ad = MakeARandomAdWithBidMetadata(1, 2);
+  ad.set_render("fooAds.com/ad?id=1");
+  ad.clear_ad_components();
+  ad.add_ad_components("comp.com/1");
+  ad.add_ad_components("comp.com/no_signals");
+  BuildRawRequest(
+      {ad}, testSellerSignals, testAuctionSignals,
+      R"JSON({"renderUrls": {"other.com": null, "fooAds.com/ad?id=1" : [1, "two"]},
+              "adComponentRenderUrls": {"comp.com/1": {"a": 1.50}}})JSON",
+      testPublisherHostname, raw_request);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.enable_zero_copy_scoring_signals = true;
+  ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+}
+
+TEST_F(ScoreAdsReactorTest, ZeroCopyScoringSignalsRejectsMalformedSignals) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.enable_zero_copy_scoring_signals = true;
+  for (absl::string_view scoring_signals :
+       {R"JSON({"renderUrls": {"a": [1})JSON",
+        R"JSON({"adComponentRenderUrls": {}})JSON"}) {
+    metric::AuctionContextMap()->Get(&request_);
+    RawRequest raw_request;
+    AdWithBidMetadata foo;
+    GetTestAdWithBidFoo(foo);
+    BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                    std::string(scoring_signals), testPublisherHostname,
+                    raw_request);
+    ScoreAdsResponse response =
+        ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+    ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+    raw_response.ParseFromString(response.response_ciphertext());
+    EXPECT_FALSE(raw_response.has_ad_score());
+  }
+}
+
+TEST_F(ScoreAdsReactorTest, SlicesScoringSignalsFromKeyValueTable) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        for (const auto& request : batch) {
+          EXPECT_EQ(
+              *request.input[3],
+              R"JSON({"adComponentRenderUrls":{"comp.com/\"1\"":{"a": 1.50}},"renderUrl":{"fooAds.com/ad?id=1":[1, "two"]}})JSON");
+        }
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata ad = MakeARandomAdWithBidMetadata(1, 2);
+  ad.set_render("fooAds.com/ad?id=1");
+  ad.clear_ad_components();
+  ad.add_ad_components(R"(comp.com/"1")");
+  ad.add_ad_components("comp.com/no_signals");
+  std::string scoring_signals;
+  AppendKeyValueTableSection("renderUrls", 2, &scoring_signals);
+  AppendKeyValueTableEntry("other.com", "null", &scoring_signals);
+  AppendKeyValueTableEntry("fooAds.com/ad?id=1", R"([1, "two"])",
+                           &scoring_signals);
+  AppendKeyValueTableSection("adComponentRenderUrls", 1, &scoring_signals);
+  AppendKeyValueTableEntry(R"(comp.com/"1")", R"({"a": 1.50})",
+                           &scoring_signals);
+  BuildRawRequest({ad}, testSellerSignals, testAuctionSignals,
+                  scoring_signals, testPublisherHostname, raw_request);
+  ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig());
+}
+
+TEST_F(ScoreAdsReactorTest, RejectsMalformedKeyValueTables) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  for (absl::string_view scoring_signals :
+       {"KVT110:renderUrls1:1:a9:[1", "KVT121:adComponentRenderUrls0:"}) {
+    metric::AuctionContextMap()->Get(&request_);
+    RawRequest raw_request;
+    AdWithBidMetadata foo;
+    GetTestAdWithBidFoo(foo);
+    BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                    std::string(scoring_signals), testPublisherHostname,
+                    raw_request);
+    ScoreAdsResponse response = ExecuteScoreAds(raw_request, dispatcher,
+                                                AuctionServiceRuntimeConfig());
+    ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+    raw_response.ParseFromString(response.response_ciphertext());
+    EXPECT_FALSE(raw_response.has_ad_score());
+  }
+}
+
+TEST_F(ScoreAdsReactorTest, PreScoringFilterRejectsAdsWithoutDispatching) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        return FakeExecute(batch, std::move(done_callback),
+                           {R"({"response":{"desirability":1},"logs":[]})"});
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata foo, bar, has_foo_components;
+  GetTestAdWithBidFoo(foo);
+  GetTestAdWithBidBar(bar);
+  GetTestAdWithBidSameComponentAsFoo(has_foo_components);
+  has_foo_components.set_interest_group_owner("https://otherAds.com");
+  BuildRawRequest(
+      {foo, bar, has_foo_components},
+      R"json({"minBid": 2.05, "blockedInterestGroupOwners": ["https://fooAds.com"]})json",
+      testAuctionSignals, testScoringSignals, testPublisherHostname,
+      raw_request);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.enable_seller_pre_scoring_filter = true;
+  auto response = ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  const auto& scored_ad = raw_response.ad_score();
+  EXPECT_EQ(scored_ad.render(), has_foo_components.render());
+  ASSERT_EQ(scored_ad.ad_rejection_reasons_size(), 2);
+  absl::flat_hash_map<std::string, SellerRejectionReason> rejection_reasons;
+  for (const auto& ad_rejection_reason : scored_ad.ad_rejection_reasons()) {
+    rejection_reasons[ad_rejection_reason.interest_group_owner()] =
+        ad_rejection_reason.rejection_reason();
+  }
+  EXPECT_EQ(rejection_reasons.at(foo.interest_group_owner()),
+            SellerRejectionReason::BLOCKED_BY_PUBLISHER);
+  EXPECT_EQ(rejection_reasons.at(bar.interest_group_owner()),
+            SellerRejectionReason::BID_BELOW_AUCTION_FLOOR);
+}
+
+TEST_F(ScoreAdsReactorTest, PreScoringFilterSkipsDispatchWhenAllAdsRejected) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  RawRequest raw_request;
+  AdWithBidMetadata bar;
+  GetTestAdWithBidBar(bar);
+  BuildRawRequest({bar}, R"json({"minBid": 100})json", testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.enable_seller_pre_scoring_filter = true;
+  auto response = ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  EXPECT_FALSE(raw_response.has_ad_score());
+}
+
 TEST_F(ScoreAdsReactorTest, EmptySignalsResultsInNoResponse) {
   MockCodeDispatchClient dispatcher;
   RawRequest raw_request;
@@ -763,6 +1218,73 @@ TEST_F(ScoreAdsReactorTest,
             2);
 }
 
+TEST_F(ScoreAdsReactorTest,
+       HighestScoringOtherBidsUseTopKFractionalScoresAndTies) {
+  MockCodeDispatchClient dispatcher;
+  RawRequest raw_request;
+  AdWithBidMetadata foo, foo_comp, bar, barbecue;
+  GetTestAdWithBidFoo(foo);
+  GetTestAdWithBidSameComponentAsFoo(foo_comp);
+  GetTestAdWithBidBar(bar);
+  GetTestAdWithBidBarbecue(barbecue);
+  BuildRawRequest({foo, foo_comp, bar, barbecue}, testSellerSignals,
+                  testAuctionSignals, testScoringSignals,
+                  testPublisherHostname, raw_request);
+  const absl::flat_hash_map<std::string, float> score_for_render_url = {
+      {foo.render(), 3.5},
+      {foo_comp.render(), 2.25},
+      {bar.render(), 2.5},
+      {barbecue.render(), 2.5}};
+
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillRepeatedly([&score_for_render_url](
+                          std::vector<DispatchRequest>& batch,
+                          BatchDispatchDoneCallback done_callback) {
+        std::vector<std::string> score_logic;
+        for (const auto& request : batch) {
+          score_logic.push_back(
+              absl::Substitute(R"({"response":{"desirability":$0}})",
+                               score_for_render_url.at(request.id)));
+        }
+        return FakeExecute(batch, std::move(done_callback),
+                           std::move(score_logic));
+      });
+
+  // With the default K of 2, only the bids tied at the runner-up score are
+  // reported, the 2.25 score must not be confused with 2.5.
+  auto response =
+      ExecuteScoreAds(raw_request, dispatcher, AuctionServiceRuntimeConfig());
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  const auto& scored_ad = raw_response.ad_score();
+  EXPECT_EQ(scored_ad.render(), foo.render());
+  ASSERT_EQ(scored_ad.ig_owner_highest_scoring_other_bids_map().size(), 1);
+  const auto& bar_owner_bids =
+      scored_ad.ig_owner_highest_scoring_other_bids_map().at(
+          kInterestGroupOwnerOfBarBidder);
+  ASSERT_EQ(bar_owner_bids.values_size(), 2);
+  EXPECT_THAT(
+      (std::vector<double>{bar_owner_bids.values(0).number_value(),
+                           bar_owner_bids.values(1).number_value()}),
+      testing::UnorderedElementsAre(testing::DoubleEq(bar.bid()),
+                                    testing::DoubleEq(barbecue.bid())));
+
+  // A larger K also reports the third highest score.
+  metric::AuctionContextMap()->Get(&request_);
+  AuctionServiceRuntimeConfig runtime_config;
+  runtime_config.highest_scoring_other_bids_top_k = 3;
+  response = ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+  raw_response.ParseFromString(response.response_ciphertext());
+  const auto& other_bids =
+      raw_response.ad_score().ig_owner_highest_scoring_other_bids_map();
+  EXPECT_EQ(other_bids.size(), 2);
+  ASSERT_TRUE(other_bids.contains(foo_comp.interest_group_owner()));
+  ASSERT_EQ(other_bids.at(foo_comp.interest_group_owner()).values_size(), 1);
+  EXPECT_DOUBLE_EQ(
+      other_bids.at(foo_comp.interest_group_owner()).values(0).number_value(),
+      foo_comp.bid());
+}
+
 TEST_F(ScoreAdsReactorTest,
        CreatesScoresForAllAdsRequestedWithComponentAuction) {
   MockCodeDispatchClient dispatcher;
@@ -1031,6 +1553,69 @@ TEST_F(ScoreAdsReactorTest, SuccessfullyExecutesReportResult) {
             kTestInteractionUrl);
 }
 
+TEST_F(ScoreAdsReactorTest, ReturnsScoredAdWhenReportingFailsToDispatch) {
+  MockCodeDispatchClient dispatcher;
+  bool enable_debug_reporting = false;
+  RawRequest raw_request;
+  AdWithBidMetadata foo;
+  GetTestAdWithBidFoo(foo);
+  BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request,
+                  enable_debug_reporting);
+
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillRepeatedly([](std::vector<DispatchRequest>& batch,
+                         BatchDispatchDoneCallback done_callback) {
+        if (batch[0].handler_name == kReportingDispatchHandlerFunctionName) {
+          return absl::InternalError("Reporting not scheduled");
+        }
+        return FakeExecute(batch, std::move(done_callback),
+                           {R"({"response":{"desirability":1},"logs":[]})"});
+      });
+  AuctionServiceRuntimeConfig runtime_config = {
+      .enable_report_result_url_generation = true};
+  const auto& response =
+      ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ScoreAdsResponse::ScoreAdsRawResponse raw_response;
+  ASSERT_TRUE(raw_response.ParseFromString(response.response_ciphertext()));
+  EXPECT_EQ(raw_response.ad_score().render(), foo.render());
+  EXPECT_FALSE(raw_response.ad_score().has_win_reporting_urls());
+}
+
+TEST_F(ScoreAdsReactorTest, ReportingReusesTheAuctionConfigOfScoring) {
+  MockCodeDispatchClient dispatcher;
+  RawRequest raw_request;
+  AdWithBidMetadata foo;
+  GetTestAdWithBidFoo(foo);
+  BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request,
+                  /*enable_debug_reporting=*/false);
+
+  std::shared_ptr<std::string> scoring_auction_config;
+  std::shared_ptr<std::string> reporting_auction_config;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillRepeatedly([&](std::vector<DispatchRequest>& batch,
+                          BatchDispatchDoneCallback done_callback) {
+        if (batch[0].handler_name == kReportingDispatchHandlerFunctionName) {
+          reporting_auction_config = batch[0].input[ReportingArgIndex(
+              ReportingArgs::kAuctionConfig)];
+          return FakeExecute(batch, std::move(done_callback),
+                             {kTestReportingResponseJson});
+        }
+        // auctionConfig is the third argument of scoreAd.
+        scoring_auction_config = batch[0].input[2];
+        return FakeExecute(batch, std::move(done_callback),
+                           {R"({"response":{"desirability":1},"logs":[]})"});
+      });
+  AuctionServiceRuntimeConfig runtime_config = {
+      .enable_report_result_url_generation = true};
+  ExecuteScoreAds(raw_request, dispatcher, runtime_config);
+
+  ASSERT_NE(reporting_auction_config, nullptr);
+  EXPECT_EQ(reporting_auction_config, scoring_auction_config);
+}
+
 TEST_F(ScoreAdsReactorTest, SuccessfullyExecutesReportResultAndReportWin) {
   MockCodeDispatchClient dispatcher;
   int current_score = 0;
@@ -1396,5 +1981,41 @@ TEST_F(ScoreAdsReactorTest, CaptureRejectionReasonsForRejectedAds) {
             SellerRejectionReason::INVALID_BID);
 }
 
+TEST_F(ScoreAdsReactorTest, CutsRomaTimeoutToRequestDeadline) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback done_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        int64_t roma_timeout_ms = 0;
+        EXPECT_TRUE(absl::SimpleAtoi(batch.at(0).tags.at("TimeoutMs"),
+                                     &roma_timeout_ms));
+        EXPECT_GT(roma_timeout_ms, 0);
+        EXPECT_LE(roma_timeout_ms, 60'000);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  AdWithBidMetadata foo;
+  GetTestAdWithBidFoo(foo);
+  BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  deadline_ = absl::Now() + absl::Seconds(60);
+  ExecuteScoreAds(raw_request, dispatcher, {.roma_timeout_ms = "600000"});
+}
+
+TEST_F(ScoreAdsReactorTest, DoesNotDispatchPastRequestDeadline) {
+  MockCodeDispatchClient dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  RawRequest raw_request;
+  AdWithBidMetadata foo;
+  GetTestAdWithBidFoo(foo);
+  BuildRawRequest({foo}, testSellerSignals, testAuctionSignals,
+                  testScoringSignals, testPublisherHostname, raw_request);
+  deadline_ = absl::Now() + absl::Milliseconds(1);
+  auto response =
+      ExecuteScoreAds(raw_request, dispatcher, {.roma_timeout_ms = "10000"});
+  EXPECT_TRUE(response.response_ciphertext().empty());
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,98 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/auction_service/scoring_accumulator.h"
+
+#include <limits>
+#include <string>
+#include <utility>
+
+#include "services/common/util/reporting_util.h"
+#include "services/common/util/string_interner.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+ScoringAccumulator::ScoringAccumulator(int highest_scoring_other_bids_top_k)
+    : top_scores_(highest_scoring_other_bids_top_k),
+      winner_desirability_(std::numeric_limits<float>::min()) {}
+
+bool ScoringAccumulator::AddScore(int index,
+                                  const ScoreAdsResponse::AdScore& ad_score) {
+  if (ad_score.has_debug_report_urls()) {
+    debug_report_indices_.push_back(index);
+  }
+  const float desirability = ad_score.desirability();
+  if (desirability > 0) {
+    top_scores_.Add(desirability);
+    if (top_scores_.Contains(desirability)) {
+      other_bid_candidates_.push_back({index, &ad_score});
+    }
+  }
+  // >= ensures that in the edge case where the most desirable ad's
+  // desirability is float.min_val, it is still selected.
+  if (desirability >= winner_desirability_) {
+    winner_index_ = index;
+    winner_desirability_ = desirability;
+    return true;
+  }
+  return false;
+}
+
+void ScoringAccumulator::AddRejectionReason(
+    const ScoreAdsResponse::AdScore::AdRejectionReason& rejection_reason) {
+  ++rejected_count_;
+  rejection_reason_map_[rejection_reason.interest_group_owner()].try_emplace(
+      rejection_reason.interest_group_name(),
+      rejection_reason.rejection_reason());
+}
+
+void ScoringAccumulator::AddHighestScoringOtherBids(
+    ScoreAdsResponse::AdScore& winning_ad_score) const {
+  // Bids are grouped by interned owner first, so that each owner is hashed
+  // into the proto map once rather than once per bid.
+  StringInterner owners;
+  std::vector<std::vector<float>> bids_by_owner;
+  for (const Candidate& candidate : other_bid_candidates_) {
+    if (candidate.index == winner_index_ ||
+        !top_scores_.Contains(candidate.ad_score->desirability())) {
+      continue;
+    }
+    const StringInterner::Id owner =
+        owners.Intern(candidate.ad_score->interest_group_owner());
+    if (owner == bids_by_owner.size()) {
+      bids_by_owner.emplace_back();
+    }
+    bids_by_owner[owner].push_back(candidate.ad_score->buyer_bid());
+  }
+  if (owners.size() == 0) {
+    return;
+  }
+  auto& other_bids_map =
+      *winning_ad_score.mutable_ig_owner_highest_scoring_other_bids_map();
+  for (StringInterner::Id owner = 0; owner < owners.size(); ++owner) {
+    google::protobuf::ListValue& bids =
+        other_bids_map[std::string(owners.Get(owner))];
+    for (float bid : bids_by_owner[owner]) {
+      bids.add_values()->set_number_value(bid);
+    }
+  }
+}
+
+PostAuctionSignals ScoringAccumulator::TakePostAuctionSignals(
+    const ScoreAdsResponse::AdScore* winning_ad_score) {
+  return GeneratePostAuctionSignals(winning_ad_score,
+                                    std::move(rejection_reason_map_));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
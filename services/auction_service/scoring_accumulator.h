@@ -0,0 +1,90 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_AUCTION_SERVICE_SCORING_ACCUMULATOR_H_
+#define SERVICES_AUCTION_SERVICE_SCORING_ACCUMULATOR_H_
+
+#include <optional>
+#include <vector>
+
+#include "api/bidding_auction_servers.pb.h"
+#include "services/common/util/post_auction_signals.h"
+#include "services/common/util/top_k_scores.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Aggregates of the scores of an auction, kept up to date as each score is
+// parsed, so that the winner, the highest scoring other bids, the rejection
+// reasons and the ads to debug report are known without walking all the
+// scores again once they are parsed.
+class ScoringAccumulator {
+ public:
+  // highest_scoring_other_bids_top_k: number of highest distinct scores
+  // whose bids, other than the winner's, are the highest scoring other bids.
+  explicit ScoringAccumulator(int highest_scoring_other_bids_top_k);
+
+  // Offers the score of the ad at `index` of the scores of the auction.
+  // `ad_score` must outlive the accumulator. Returns whether it is the most
+  // desirable so far; the last of equally desirable scores wins.
+  bool AddScore(int index, const ScoreAdsResponse::AdScore& ad_score);
+
+  // Groups a rejection reason, from the pre-scoring filter or from scoring.
+  void AddRejectionReason(
+      const ScoreAdsResponse::AdScore::AdRejectionReason& rejection_reason);
+
+  // Index of the most desirable score, if any.
+  std::optional<int> winner_index() const { return winner_index_; }
+
+  // Number of rejection reasons added.
+  int rejected_count() const { return rejected_count_; }
+
+  // Indices of the scores with debug report URLs, in the order added.
+  const std::vector<int>& debug_report_indices() const {
+    return debug_report_indices_;
+  }
+
+  // Adds the bids of the top K scores, other than the winner's and those not
+  // positive, by interest group owner to `winning_ad_score`, in the order
+  // their scores were added. The score of the winner is not read, so it may
+  // have been moved into `winning_ad_score`.
+  void AddHighestScoringOtherBids(
+      ScoreAdsResponse::AdScore& winning_ad_score) const;
+
+  // Returns the post auction signals of `winning_ad_score`, null if no ad
+  // won, with the rejection reasons added. Leaves the rejection reasons
+  // empty.
+  PostAuctionSignals TakePostAuctionSignals(
+      const ScoreAdsResponse::AdScore* winning_ad_score);
+
+ private:
+  struct Candidate {
+    int index;
+    const ScoreAdsResponse::AdScore* ad_score;
+  };
+
+  TopKScores top_scores_;
+  // Scores that were in the top K when added. Those evicted since are
+  // skipped when the bids are added. For scores in random order, there are
+  // about K * ln(number of scores) of them.
+  std::vector<Candidate> other_bid_candidates_;
+  std::optional<int> winner_index_;
+  float winner_desirability_;
+  int rejected_count_ = 0;
+  RejectionReasonMap rejection_reason_map_;
+  std::vector<int> debug_report_indices_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_AUCTION_SERVICE_SCORING_ACCUMULATOR_H_
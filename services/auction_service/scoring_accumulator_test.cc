@@ -0,0 +1,130 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/auction_service/scoring_accumulator.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Optional;
+
+ScoreAdsResponse::AdScore MakeAdScore(std::string owner, float desirability,
+                                      float bid) {
+  ScoreAdsResponse::AdScore ad_score;
+  ad_score.set_interest_group_owner(std::move(owner));
+  ad_score.set_interest_group_name("ig");
+  ad_score.set_desirability(desirability);
+  ad_score.set_buyer_bid(bid);
+  return ad_score;
+}
+
+std::vector<float> OtherBidsOf(const ScoreAdsResponse::AdScore& winner,
+                               const std::string& owner) {
+  std::vector<float> bids;
+  for (const auto& value :
+       winner.ig_owner_highest_scoring_other_bids_map().at(owner).values()) {
+    bids.push_back(value.number_value());
+  }
+  return bids;
+}
+
+TEST(ScoringAccumulatorTest, TracksMostDesirableScore) {
+  std::vector<ScoreAdsResponse::AdScore> ad_scores = {
+      MakeAdScore("a", 1, 10), MakeAdScore("b", 3, 20),
+      MakeAdScore("c", 3, 30), MakeAdScore("d", 2, 40)};
+  ScoringAccumulator accumulator(2);
+  std::vector<bool> most_desirable;
+  for (int i = 0; i < ad_scores.size(); i++) {
+    most_desirable.push_back(accumulator.AddScore(i, ad_scores[i]));
+  }
+  EXPECT_THAT(most_desirable, ElementsAre(true, true, true, false));
+  // The last of equally desirable scores wins.
+  EXPECT_THAT(accumulator.winner_index(), Optional(2));
+}
+
+TEST(ScoringAccumulatorTest, AddsBidsOfTopScoresOtherThanWinner) {
+  std::vector<ScoreAdsResponse::AdScore> ad_scores = {
+      MakeAdScore("a", 1, 10), MakeAdScore("b", 4, 20),
+      MakeAdScore("a", 2, 30), MakeAdScore("b", 5, 40),
+      MakeAdScore("a", 4, 50), MakeAdScore("c", -1, 60)};
+  ScoringAccumulator accumulator(2);
+  for (int i = 0; i < ad_scores.size(); i++) {
+    accumulator.AddScore(i, ad_scores[i]);
+  }
+  ScoreAdsResponse::AdScore winner = ad_scores[*accumulator.winner_index()];
+  accumulator.AddHighestScoringOtherBids(winner);
+
+  // The scores 1 and 2 were in the top 2 when added, and evicted since.
+  EXPECT_EQ(winner.ig_owner_highest_scoring_other_bids_map().size(), 2);
+  EXPECT_THAT(OtherBidsOf(winner, "a"), ElementsAre(50));
+  EXPECT_THAT(OtherBidsOf(winner, "b"), ElementsAre(20));
+}
+
+TEST(ScoringAccumulatorTest, AddsNoOtherBidsForSingleScore) {
+  ScoreAdsResponse::AdScore ad_score = MakeAdScore("a", 1, 10);
+  ScoringAccumulator accumulator(2);
+  accumulator.AddScore(0, ad_score);
+  ScoreAdsResponse::AdScore winner = ad_score;
+  accumulator.AddHighestScoringOtherBids(winner);
+  EXPECT_THAT(winner.ig_owner_highest_scoring_other_bids_map(), IsEmpty());
+}
+
+TEST(ScoringAccumulatorTest, GroupsRejectionReasonsIntoPostAuctionSignals) {
+  ScoreAdsResponse::AdScore::AdRejectionReason invalid_bid;
+  invalid_bid.set_interest_group_owner("a");
+  invalid_bid.set_interest_group_name("ig1");
+  invalid_bid.set_rejection_reason(SellerRejectionReason::INVALID_BID);
+  ScoreAdsResponse::AdScore::AdRejectionReason below_floor = invalid_bid;
+  below_floor.set_interest_group_name("ig2");
+  below_floor.set_rejection_reason(
+      SellerRejectionReason::BID_BELOW_AUCTION_FLOOR);
+  ScoringAccumulator accumulator(2);
+  accumulator.AddRejectionReason(invalid_bid);
+  accumulator.AddRejectionReason(below_floor);
+  EXPECT_EQ(accumulator.rejected_count(), 2);
+
+  const ScoreAdsResponse::AdScore winner = MakeAdScore("b", 1, 10);
+  PostAuctionSignals signals = accumulator.TakePostAuctionSignals(&winner);
+  EXPECT_EQ(signals.winning_ig_owner, "b");
+  EXPECT_FALSE(signals.has_highest_scoring_other_bid);
+  EXPECT_EQ(signals.rejection_reason_map.at("a").at("ig1"),
+            SellerRejectionReason::INVALID_BID);
+  EXPECT_EQ(signals.rejection_reason_map.at("a").at("ig2"),
+            SellerRejectionReason::BID_BELOW_AUCTION_FLOOR);
+}
+
+TEST(ScoringAccumulatorTest, ListsScoresWithDebugReportUrls) {
+  std::vector<ScoreAdsResponse::AdScore> ad_scores = {
+      MakeAdScore("a", 1, 10), MakeAdScore("b", 2, 20),
+      MakeAdScore("c", 3, 30)};
+  ad_scores[0].mutable_debug_report_urls()->set_auction_debug_loss_url("l");
+  ad_scores[2].mutable_debug_report_urls()->set_auction_debug_win_url("w");
+  ScoringAccumulator accumulator(2);
+  for (int i = 0; i < ad_scores.size(); i++) {
+    accumulator.AddScore(i, ad_scores[i]);
+  }
+  EXPECT_THAT(accumulator.debug_report_indices(), ElementsAre(0, 2));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -38,6 +38,10 @@ class BiddingBenchmarkingLogger
   BiddingBenchmarkingLogger(const BiddingBenchmarkingLogger&) = delete;
   BiddingBenchmarkingLogger& operator=(const BiddingBenchmarkingLogger&) =
       delete;
+
+  // Marks the end of the parsing of the trusted bidding signals, the first
+  // step of input building, for benchmarks breaking it down.
+  virtual void ParseSignalsEnd() {}
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,13 +14,22 @@
 
 #include "services/bidding_service/bidding_service.h"
 
+#include <chrono>
+#include <memory>
+#include <utility>
+
 #include <grpcpp/grpcpp.h>
 
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
 #include "services/bidding_service/generate_bids_reactor.h"
+#include "services/common/clients/async_grpc/backend_load.h"
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
 #include "services/common/metric/server_definition.h"
-#include "src/cpp/telemetry/telemetry.h"
+#include "services/common/telemetry/request_tracer.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/request_class.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
@@ -54,16 +63,36 @@ void LogMetrics(const GenerateBidsRequest* request,
 grpc::ServerUnaryReactor* BiddingService::GenerateBids(
     grpc::CallbackServerContext* context, const GenerateBidsRequest* request,
     GenerateBidsResponse* response) {
-  auto scope = opentelemetry::trace::Scope(
-      server_common::GetTracer()->StartSpan(kGenerateBids));
+  std::shared_ptr<const BiddingServiceRuntimeConfig> runtime_config =
+      runtime_config_.Get();
+  // Lets the clients that balance their calls by load steer away from this
+  // server while a backlog builds up on Roma, shed requests included.
+  AddBackendLoadHint(*context, DispatchStats::Get().PendingRequests());
+  const RequestClass request_class =
+      GetRequestClass(context->client_metadata());
+  ConcurrencyLimiter::Permit permit;
+  if (runtime_config->concurrency_limiter != nullptr) {
+    permit = runtime_config->concurrency_limiter->TryAcquire(request_class);
+    if (!permit) {
+      return FinishShedRequest(context);
+    }
+  }
   LogMetrics(request, response);
   VLOG(2) << "\nGenerateBidsRequest:\n" << request->DebugString();
 
   // Heap allocate the reactor. Deleted in reactor's OnDone call.
   auto reactor = generate_bids_reactor_factory_(
       request, response, key_fetcher_manager_.get(), crypto_client_.get(),
-      runtime_config_);
-  reactor->Execute();
+      *runtime_config);
+  reactor->SetConcurrencyPermit(std::move(permit));
+  reactor->SetRequestClass(request_class);
+  reactor->SetMemoryBudget(runtime_config->request_memory_budget_bytes);
+  if (context->deadline() != std::chrono::system_clock::time_point::max()) {
+    reactor->SetDeadline(absl::FromChrono(context->deadline()));
+  }
+  reactor->StartTrace(kGenerateBids,
+                      GetTraceParent(context->client_metadata()));
+  reactor->Start();
   return reactor;
 }
 
@@ -22,6 +22,7 @@
 
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "services/bidding_service/generate_bids_reactor.h"
+#include "services/common/util/versioned_config.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -69,12 +70,18 @@ class BiddingService final : public Bidding::CallbackService {
       grpc::CallbackServerContext* context, const GenerateBidsRequest* request,
       GenerateBidsResponse* response) override;
 
+  // Config of the requests, which can be updated while the service runs.
+  // Each request reads the snapshot current when it starts.
+  VersionedConfig<BiddingServiceRuntimeConfig>& runtime_config() {
+    return runtime_config_;
+  }
+
  private:
   GenerateBidsReactorFactory generate_bids_reactor_factory_;
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
   std::unique_ptr<CryptoClientWrapperInterface> crypto_client_;
-  BiddingServiceRuntimeConfig runtime_config_;
+  VersionedConfig<BiddingServiceRuntimeConfig> runtime_config_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
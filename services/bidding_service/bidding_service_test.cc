@@ -28,12 +28,14 @@
 #include "services/common/encryption/mock_crypto_client_wrapper.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/test/mocks.h"
+#include "services/common/test/random.h"
 #include "services/common/test/utils/service_utils.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
 using ::testing::NiceMock;
 
 TEST(BiddingServiceTest, InstantiatesGenerateBidsReactor) {
@@ -125,5 +127,55 @@ TEST_F(BiddingServer, EncryptsResponseEvenOnException) {
   EXPECT_EQ(status.error_code(), grpc::StatusCode::INVALID_ARGUMENT);
 }
 
+TEST_F(BiddingServer, FailsWhenTheDeadlineCutsTheInterestGroupsShort) {
+  MockCodeDispatchClient client;
+  EXPECT_CALL(client, BatchExecute).Times(0);
+  EXPECT_CALL(*crypto_client_, HpkeDecrypt)
+      .WillRepeatedly([](const server_common::PrivateKey& private_key,
+                         const std::string& ciphertext) {
+        HpkeDecryptResponse response;
+        response.set_payload(ciphertext);
+        response.set_secret("secret");
+        return response;
+      });
+  EXPECT_CALL(*crypto_client_, AeadEncrypt).WillRepeatedly([]() {
+    return AeadEncryptResponse{};
+  });
+  // The margin left for the response is past the deadline of the call, so
+  // that no interest group has time to bid.
+  runtime_config_.roma_timeout_ms = "10000";
+  runtime_config_.roma_timeout_response_margin_ms = 60000;
+  BiddingService bidding_service(
+      [&client, this](
+          const GenerateBidsRequest* request, GenerateBidsResponse* response,
+          server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+          CryptoClientWrapperInterface* crypto_client,
+          const BiddingServiceRuntimeConfig& runtime_config) {
+        return std::make_unique<GenerateBidsReactor>(
+                   client, request, response, std::move(benchmarking_logger_),
+                   key_fetcher_manager, crypto_client, runtime_config)
+            .release();
+      },
+      CreateKeyFetcherManager(config_), std::move(crypto_client_),
+      runtime_config_);
+  LocalServiceStartResult start_service_result =
+      StartLocalService(&bidding_service);
+  std::unique_ptr<Bidding::StubInterface> stub =
+      CreateServiceStub<Bidding>(start_service_result.port);
+  grpc::ClientContext context;
+  context.set_deadline(std::chrono::system_clock::now() +
+                       std::chrono::seconds(30));
+  GenerateBidsRequest::GenerateBidsRawRequest raw_request =
+      MakeARandomGenerateBidsRawRequestForAndroid();
+  raw_request.set_bidding_signals(R"json({"keys":{}})json");
+  GenerateBidsRequest request;
+  request.set_key_id("key_id");
+  request.set_request_ciphertext(raw_request.SerializeAsString());
+  GenerateBidsResponse response;
+  grpc::Status status = stub->GenerateBids(&context, request, &response);
+  EXPECT_EQ(status.error_code(), grpc::StatusCode::DEADLINE_EXCEEDED);
+  EXPECT_EQ(status.error_message(), kDeadlineExceededBeforeDispatch);
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
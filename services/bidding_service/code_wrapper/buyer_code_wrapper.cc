@@ -15,11 +15,10 @@
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
 
 #include <string>
-#include <vector>
 
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "services/common/util/wasm_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
@@ -33,25 +32,17 @@ void AppendFeatureFlagValue(std::string& feature_flags,
   feature_flags.append(
       absl::StrCat("\"", feature_name, "\": ", enable_feature));
 }
-
-std::string WasmBytesToJavascript(absl::string_view wasm_bytes) {
-  std::string hex_array = "";
-
-  for (const uint8_t& byte :
-       std::vector<uint8_t>(wasm_bytes.begin(), wasm_bytes.end())) {
-    absl::StrAppend(&hex_array, absl::StrFormat("%#x,", byte));
-  }
-  // In javascript, it is ok to leave a comma after the last element in the
-  // array.
-
-  return absl::StrFormat(kWasmModuleTemplate, hex_array);
-}
 }  // namespace
 
-std::string GetBuyerWrappedCode(absl::string_view adtech_js,
-                                absl::string_view adtech_wasm = "") {
-  return absl::StrCat(WasmBytesToJavascript(adtech_wasm), kEntryFunction,
-                      adtech_js);
+std::string GetBuyerWrappedCode(
+    absl::string_view adtech_js, absl::string_view adtech_wasm = "",
+    bool enable_generate_bids_batch_entry_function) {
+  std::string wrapped_code = absl::StrCat(GetWasmHelperJavascript(adtech_wasm),
+                                          kEntryFunction, adtech_js);
+  if (enable_generate_bids_batch_entry_function) {
+    wrapped_code.append(kGenerateBidsBatchEntryFunction);
+  }
+  return wrapped_code;
 }
 
 std::string GetFeatureFlagJson(bool enable_logging,
@@ -28,14 +28,21 @@ constexpr char kFeatureDebugUrlGeneration[] = "enable_debug_url_generation";
 constexpr char kFeatureDisabled[] = "false";
 constexpr char kFeatureEnabled[] = "true";
 
+// Property of the generateBidEntryFunction output holding the milliseconds
+// the generateBid() call took.
+inline constexpr char kGenerateBidExecutionTimeMs[] = "executionTimeMs";
+
 // Returns the complete wrapped code for Buyer.
 // The function adds wrappers to the Buyer provided generateBid function.
 // This enables:
 // - Generation of event level debug reporting
 // - Exporting console.logs from the AdTech execution.
 // - wasmHelper added to device_signals
-std::string GetBuyerWrappedCode(absl::string_view adtech_js,
-                                absl::string_view adtech_wasm);
+// - Generating bids for a chunk of interest groups per Roma invocation, when
+//   enable_generate_bids_batch_entry_function is set.
+std::string GetBuyerWrappedCode(
+    absl::string_view adtech_js, absl::string_view adtech_wasm,
+    bool enable_generate_bids_batch_entry_function = false);
 
 // Returns a JSON string for feature flags to be used by the wrapper script.
 std::string GetFeatureFlagJson(bool enable_logging,
@@ -45,6 +52,7 @@ std::string GetFeatureFlagJson(bool enable_logging,
 // This wrapper supports the features below:
 //- Exporting logs to Bidding Service using console.log
 //- Hooks in wasm module
+//- Timing the generateBid() call, as kGenerateBidExecutionTimeMs
 inline constexpr absl::string_view kEntryFunction = R"JS_CODE(
     const forDebuggingOnly = {}
     forDebuggingOnly.auction_win_url = undefined;
@@ -80,6 +88,7 @@ inline constexpr absl::string_view kEntryFunction = R"JS_CODE(
         }
       }
       var generateBidResponse = {};
+      const ps_start = Date.now();
       try {
         generateBidResponse = generateBid(interest_group, auction_signals,
           buyer_signals, trusted_bidding_signals, device_signals);
@@ -99,16 +108,46 @@ inline constexpr absl::string_view kEntryFunction = R"JS_CODE(
         response: generateBidResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        executionTimeMs: Date.now() - ps_start
       }
     }
 )JS_CODE";
 
-// This is used to create a javascript array that contains a hex representation
-// of the raw wasm bytecode.
-inline constexpr absl::string_view kWasmModuleTemplate = R"JS_CODE(
-  const globalWasmHex = [%s];
-  const globalWasmHelper = globalWasmHex.length ? new WebAssembly.Module(Uint8Array.from(globalWasmHex)) : null;
+// The function that will be called by Roma to generate the bids of a chunk of
+// interest groups in one invocation. The dispatch function name will be
+// generateBidsBatchEntryFunction. interest_groups is an array of objects
+// holding the per interest group arguments of generateBidEntryFunction
+// (interestGroup, trustedBiddingSignals and deviceSignals), so that the
+// auction and buyer signals shared by all of them are only parsed once.
+// When trusted_bidding_signals is passed, the interest groups hold no
+// trustedBiddingSignals. Each picks those of its trustedBiddingSignalsKeys
+// from trusted_bidding_signals instead, which holds the signals of all the
+// interest groups of the batch, parsed once.
+// Returns an array holding the generateBidEntryFunction output for each
+// interest group, in order.
+inline constexpr absl::string_view kGenerateBidsBatchEntryFunction = R"JS_CODE(
+    function generateBidsBatchEntryFunction(interest_groups,
+                                auction_signals,
+                                buyer_signals,
+                                featureFlags,
+                                trusted_bidding_signals){
+      return interest_groups.map((ig) => {
+        forDebuggingOnly.auction_win_url = undefined;
+        forDebuggingOnly.auction_loss_url = undefined;
+        let ig_trusted_bidding_signals = ig.trustedBiddingSignals;
+        if (trusted_bidding_signals !== undefined) {
+          ig_trusted_bidding_signals = {};
+          for (const key of
+              ig.interestGroup.trustedBiddingSignalsKeys || []) {
+            ig_trusted_bidding_signals[key] = trusted_bidding_signals[key];
+          }
+        }
+        return generateBidEntryFunction(ig.interestGroup, auction_signals,
+          buyer_signals, ig_trusted_bidding_signals, ig.deviceSignals,
+          featureFlags);
+      });
+    }
 )JS_CODE";
 
 }  // namespace privacy_sandbox::bidding_auction_servers
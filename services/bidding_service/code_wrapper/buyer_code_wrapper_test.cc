@@ -41,9 +41,22 @@ TEST(GetBuyerWrappedCode, GeneratesCompleteFinalJavascript) {
 TEST(GetBuyerWrappedCode, GeneratesCompleteFinalJavascriptWithWasm) {
   std::string expected =
       absl::StrReplaceAll(kExpectedGenerateBidCode_template,
-                          {{"const globalWasmHex = [];",
-                            "const globalWasmHex = [0x74,0x65,0x73,0x74,];"}});
-  EXPECT_EQ(GetBuyerWrappedCode(kBuyerBaseCode_template, "test"), expected);
+                          {{R"(const globalWasmBytes = "";)",
+                            R"(const globalWasmBytes = "\x00asm";)"}});
+  EXPECT_EQ(GetBuyerWrappedCode(kBuyerBaseCode_template,
+                                absl::string_view("\0asm", 4)),
+            expected);
+}
+
+TEST(GetBuyerWrappedCode, AppendsBatchEntryFunctionWhenEnabled) {
+  bool enable_generate_bids_batch_entry_function = true;
+  EXPECT_EQ(
+      GetBuyerWrappedCode(absl::StrFormat(kBuyerBaseCode_template,
+                                          kAdRenderUrlPrefixForCodeWrapperTest),
+                          "", enable_generate_bids_batch_entry_function),
+      absl::StrCat(absl::StrFormat(kExpectedGenerateBidCode_template,
+                                   kAdRenderUrlPrefixForCodeWrapperTest),
+                   kGenerateBidsBatchEntryFunction));
 }
 
 void GenerateFeatureFlagsTestHelper(bool is_logging_enabled,
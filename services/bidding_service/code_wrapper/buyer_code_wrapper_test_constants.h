@@ -41,8 +41,8 @@ constexpr absl::string_view kBuyerBaseCode_template = R"JS_CODE(
     }
 )JS_CODE";
 constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
-  const globalWasmHex = [];
-  const globalWasmHelper = globalWasmHex.length ? new WebAssembly.Module(Uint8Array.from(globalWasmHex)) : null;
+  const globalWasmBytes = "";
+  const globalWasmHelper = globalWasmBytes.length ? new WebAssembly.Module(Uint8Array.from(globalWasmBytes, (c) => c.charCodeAt(0))) : null;
 
     const forDebuggingOnly = {}
     forDebuggingOnly.auction_win_url = undefined;
@@ -78,6 +78,7 @@ constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
         }
       }
       var generateBidResponse = {};
+      const ps_start = Date.now();
       try {
         generateBidResponse = generateBid(interest_group, auction_signals,
           buyer_signals, trusted_bidding_signals, device_signals);
@@ -97,7 +98,8 @@ constexpr absl::string_view kExpectedGenerateBidCode_template = R"JS_CODE(
         response: generateBidResponse,
         logs: ps_logs,
         errors: ps_errors,
-        warnings: ps_warns
+        warnings: ps_warns,
+        executionTimeMs: Date.now() - ps_start
       }
     }
 
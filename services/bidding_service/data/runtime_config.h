@@ -17,8 +17,15 @@
 #ifndef SERVICES_BIDDING_SERVICE_DATA_RUNTIME_CONFIG_H_
 #define SERVICES_BIDDING_SERVICE_DATA_RUNTIME_CONFIG_H_
 
+#include <cstdint>
 #include <string>
 
+#include "services/bidding_service/interest_group_cost_estimator.h"
+#include "services/common/encryption/crypto_worker_pool.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/signal_blob_cache.h"
+#include "src/cpp/concurrent/executor.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
 
 struct BiddingServiceRuntimeConfig {
@@ -35,6 +42,60 @@ struct BiddingServiceRuntimeConfig {
   bool enable_buyer_code_wrapper = false;
   // Enables exporting console.logs from Roma to Bidding Service
   bool enable_adtech_code_logging = false;
+  // Maximum number of interest groups whose bids are generated in one Roma
+  // invocation. Interest groups are dispatched one by one when at most 1.
+  int generate_bids_batch_size = 0;
+  // Passes the trusted bidding signals of the interest groups of a batch once
+  // per batch rather than once per interest group, so that the signals they
+  // share are only parsed once. Only used when the batch size is above 1.
+  bool share_batch_trusted_bidding_signals = false;
+  // Indexes the trusted bidding signals with the on-demand JSON parser, if
+  // built in.
+  bool use_on_demand_json_parser = false;
+  // Returns the ad of each bid as JSON in AdWithBid.ad_metadata_json.
+  bool emit_ad_metadata_json = false;
+  // Time kept between the end of the Roma timeout of the dispatch requests and
+  // the deadline of the request, to build and send the response.
+  int roma_timeout_response_margin_ms = 0;
+  // Minimum number of dispatch responses of a request that are parsed on
+  // several threads, those of the callback and of response_parsing_executor.
+  // Parsing stays on the callback thread when 0 or without the executor.
+  int parallel_response_parsing_threshold = 0;
+  // Number of requests the code dispatcher queue holds. When set, interest
+  // groups that do not fit in the free space of the queue are shed, lowest
+  // priority first.
+  int64_t dispatch_queue_capacity = 0;
+  // Most ads and ad components of an interest group passed to generateBid(),
+  // the ones past the limit being dropped. No limit when 0.
+  int max_ads_per_interest_group = 0;
+  int max_ad_components_per_interest_group = 0;
+  // Most bytes of generateBid() arguments dispatched for a request. The
+  // interest groups whose arguments do not fit are not dispatched. No limit
+  // when 0.
+  int64_t max_generate_bid_input_bytes = 0;
+  // Most bytes a request may take for its decrypted payload and the
+  // arguments dispatched for it, the ones past the budget being dropped. No
+  // budget when 0.
+  int64_t request_memory_budget_bytes = 0;
+  // Pool the large requests are decrypted and the large responses encrypted
+  // on, if any. Not owned.
+  CryptoWorkerPool* crypto_worker_pool = nullptr;
+  // Sheds the requests past the concurrency limit of the server, if any. Not
+  // owned.
+  ConcurrencyLimiter* concurrency_limiter = nullptr;
+  // Shares the auction and buyer signals arguments of the requests with
+  // byte-identical signals, if any. Not owned.
+  SignalBlobCache* signal_blob_cache = nullptr;
+  // Learns the generateBid() execution time of the interest groups, so that
+  // the pathological ones are shed and left out of the input bytes limit
+  // first, if any. Not owned.
+  InterestGroupCostEstimator* interest_group_cost_estimator = nullptr;
+  // Shared by the requests to parse their dispatch responses, so that parsing
+  // never takes more threads than the executor has, if any. Not owned.
+  server_common::Executor* response_parsing_executor = nullptr;
+  // Debug token of the server, which the requests consented for debugging
+  // must carry to have their failures logged in full. None when empty.
+  std::string consented_debug_token;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,135 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/generate_bid_input_json.h"
+
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kName[] = "name";
+constexpr char kTrustedBiddingSignalsKeys[] = "trustedBiddingSignalsKeys";
+constexpr char kAdRenderIds[] = "adRenderIds";
+constexpr char kAdComponentRenderIds[] = "adComponentRenderIds";
+constexpr char kUserBiddingSignals[] = "userBiddingSignals";
+
+constexpr char kTopWindowHostname[] = "topWindowHostname";
+constexpr char kSeller[] = "seller";
+constexpr char kTopLevelSeller[] = "topLevelSeller";
+constexpr char kJoinCount[] = "joinCount";
+constexpr char kBidCount[] = "bidCount";
+constexpr char kRecency[] = "recency";
+constexpr char kPrevWins[] = "prevWins";
+
+// Estimates the serialized size of the strings, so that the output buffer is
+// usually allocated once.
+template <typename Strings>
+size_t EstimateJsonStringArraySize(const Strings& values) {
+  size_t size = 2;
+  for (const auto& value : values) {
+    size += value.size() + 3;
+  }
+  return size;
+}
+
+}  // namespace
+
+void AppendInterestGroupJson(
+    const GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding&
+        interest_group,
+    const absl::flat_hash_set<std::string>& trusted_bidding_signals_keys,
+    std::string* out) {
+  JsonWriter writer(
+      out, interest_group.name().size() +
+               EstimateJsonStringArraySize(trusted_bidding_signals_keys) +
+               EstimateJsonStringArraySize(interest_group.ad_render_ids()) +
+               EstimateJsonStringArraySize(
+                   interest_group.ad_component_render_ids()) +
+               interest_group.user_bidding_signals().size() + 128);
+  writer.StartObject().Key(kName).String(interest_group.name());
+  if (!trusted_bidding_signals_keys.empty()) {
+    writer.Key(kTrustedBiddingSignalsKeys)
+        .StringArray(trusted_bidding_signals_keys);
+  }
+  if (!interest_group.ad_render_ids().empty()) {
+    writer.Key(kAdRenderIds).StringArray(interest_group.ad_render_ids());
+  }
+  if (!interest_group.ad_component_render_ids().empty()) {
+    writer.Key(kAdComponentRenderIds)
+        .StringArray(interest_group.ad_component_render_ids());
+  }
+  // User bidding signals are already JSON and are passed through as is.
+  if (!interest_group.user_bidding_signals().empty()) {
+    writer.Key(kUserBiddingSignals)
+        .RawValue(interest_group.user_bidding_signals());
+  }
+  writer.EndObject();
+}
+
+std::string MakeBrowserSignalsJsonPrefix(absl::string_view top_window_hostname,
+                                         absl::string_view seller) {
+  std::string prefix;
+  JsonWriter(&prefix, top_window_hostname.size() + 2 * seller.size() + 64)
+      .StartObject()
+      .Key(kTopWindowHostname)
+      .String(top_window_hostname)
+      .Key(kSeller)
+      .String(seller)
+      .Key(kTopLevelSeller)
+      .String(seller)
+      .Key(kJoinCount);
+  return prefix;
+}
+
+void AppendBrowserSignalsJson(absl::string_view prefix,
+                              const BrowserSignals& browser_signals,
+                              std::string* out) {
+  // Room for the three integers and their keys.
+  out->reserve(out->size() + prefix.size() +
+               browser_signals.prev_wins().size() + 96);
+  out->append(prefix);
+  // The prefix ends with the "joinCount" key, whose value comes next.
+  JsonWriter writer(out);
+  writer.Int(browser_signals.join_count())
+      .Key(kBidCount)
+      .Int(browser_signals.bid_count())
+      .Key(kRecency)
+      .Int(browser_signals.recency());
+  // Previous wins are already JSON and are passed through as is.
+  writer.Key(kPrevWins);
+  if (browser_signals.prev_wins().empty()) {
+    writer.String("");
+  } else {
+    writer.RawValue(browser_signals.prev_wins());
+  }
+  writer.EndObject();
+}
+
+void AppendBrowserSignalsJson(absl::string_view top_window_hostname,
+                              absl::string_view seller,
+                              const BrowserSignals& browser_signals,
+                              std::string* out) {
+  AppendBrowserSignalsJson(
+      MakeBrowserSignalsJsonPrefix(top_window_hostname, seller),
+      browser_signals, out);
+}
+
+bool HasNonDefaultBrowserSignals(const BrowserSignals& browser_signals) {
+  return browser_signals.join_count() != 0 ||
+         browser_signals.bid_count() != 0 || browser_signals.recency() != 0 ||
+         !browser_signals.prev_wins().empty();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,65 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BIDDING_SERVICE_GENERATE_BID_INPUT_JSON_H_
+#define SERVICES_BIDDING_SERVICE_GENERATE_BID_INPUT_JSON_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Writers of the JSON arguments passed to generateBid(). They append directly
+// to the output string with a JsonWriter, without going through proto
+// reflection or an intermediate JSON document.
+
+// Appends the interest group argument of generateBid() to out. Empty fields
+// are left out, and device signals are not serialized since they are passed to
+// generateBid() in a different parameter. trusted_bidding_signals_keys are
+// written in place of the keys of the interest group, so that only the keys
+// found in the trusted bidding signals are passed to generateBid().
+void AppendInterestGroupJson(
+    const GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding&
+        interest_group,
+    const absl::flat_hash_set<std::string>& trusted_bidding_signals_keys,
+    std::string* out);
+
+// Returns the part of the browser signals JSON that is the same for every
+// interest group of a request, up to and including the "joinCount" key.
+std::string MakeBrowserSignalsJsonPrefix(absl::string_view top_window_hostname,
+                                         absl::string_view seller);
+
+// Appends the browser signals passed to generateBid() as device signals to
+// out, starting with a prefix made by MakeBrowserSignalsJsonPrefix. Only the
+// per interest group fields are written.
+void AppendBrowserSignalsJson(absl::string_view prefix,
+                              const BrowserSignals& browser_signals,
+                              std::string* out);
+
+// Same as above, building the prefix from top_window_hostname and seller.
+void AppendBrowserSignalsJson(absl::string_view top_window_hostname,
+                              absl::string_view seller,
+                              const BrowserSignals& browser_signals,
+                              std::string* out);
+
+// Returns true if any field of browser_signals is set. Equivalent to comparing
+// browser_signals with its default instance, without proto reflection.
+bool HasNonDefaultBrowserSignals(const BrowserSignals& browser_signals);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_GENERATE_BID_INPUT_JSON_H_
@@ -0,0 +1,239 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/generate_bid_input_json.h"
+
+#include <cstdint>
+#include <limits>
+#include <string>
+
+#include <google/protobuf/util/message_differencer.h>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "gtest/gtest.h"
+#include "rapidjson/document.h"
+#include "services/common/test/random.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Reference serializers: the rapidjson and StrFormat based implementation the
+// direct writers replaced. The writers must produce the same bytes.
+std::string SerializeRepeatedStringFieldWithRapidJson(
+    const google::protobuf::RepeatedPtrField<std::string>& values) {
+  rapidjson::Document json_array;
+  json_array.SetArray();
+  for (const auto& item : values) {
+    json_array.PushBack(
+        rapidjson::Value(item.c_str(), json_array.GetAllocator()).Move(),
+        json_array.GetAllocator());
+  }
+  return SerializeJsonDoc(json_array).value();
+}
+
+std::string ReferenceSerializeIG(InterestGroupForBidding ig,
+                                 const absl::flat_hash_set<std::string>& keys) {
+  ig.clear_trusted_bidding_signals_keys();
+  ig.mutable_trusted_bidding_signals_keys()->Add(keys.begin(), keys.end());
+  std::string serialized_ig =
+      absl::StrFormat(R"JSON({"%s":"%s")JSON", "name", ig.name());
+  if (!ig.trusted_bidding_signals_keys().empty()) {
+    absl::StrAppend(&serialized_ig,
+                    absl::StrFormat(R"JSON(,"%s":%s)JSON",
+                                    "trustedBiddingSignalsKeys",
+                                    SerializeRepeatedStringFieldWithRapidJson(
+                                        ig.trusted_bidding_signals_keys())));
+  }
+  if (!ig.ad_render_ids().empty()) {
+    absl::StrAppend(
+        &serialized_ig,
+        absl::StrFormat(
+            R"JSON(,"%s":%s)JSON", "adRenderIds",
+            SerializeRepeatedStringFieldWithRapidJson(ig.ad_render_ids())));
+  }
+  if (!ig.ad_component_render_ids().empty()) {
+    absl::StrAppend(&serialized_ig,
+                    absl::StrFormat(R"JSON(,"%s":%s)JSON",
+                                    "adComponentRenderIds",
+                                    SerializeRepeatedStringFieldWithRapidJson(
+                                        ig.ad_component_render_ids())));
+  }
+  if (!ig.user_bidding_signals().empty()) {
+    absl::StrAppend(&serialized_ig,
+                    absl::StrFormat(R"JSON(,"%s":%s)JSON",
+                                    "userBiddingSignals",
+                                    ig.user_bidding_signals()));
+  }
+  absl::StrAppend(&serialized_ig, "}");
+  return serialized_ig;
+}
+
+std::string ReferenceBrowserSignals(absl::string_view publisher_name,
+                                    absl::string_view seller,
+                                    const BrowserSignals& browser_signals) {
+  return absl::StrCat(
+      R"JSON({"topWindowHostname":")JSON", publisher_name,
+      R"JSON(","seller":")JSON", seller, R"JSON(","topLevelSeller":")JSON",
+      seller, R"JSON(","joinCount":)JSON", browser_signals.join_count(),
+      R"JSON(,"bidCount":)JSON", browser_signals.bid_count(),
+      R"JSON(,"recency":)JSON", browser_signals.recency(),
+      R"JSON(,"prevWins":)JSON",
+      browser_signals.prev_wins().empty() ? R"JSON("")JSON"
+                                          : browser_signals.prev_wins(),
+      "}");
+}
+
+TEST(GenerateBidInputJsonTest, InterestGroupMatchesReferenceSerializer) {
+  for (int i = 0; i < 50; ++i) {
+    InterestGroupForBidding ig = MakeARandomInterestGroupForBidding(
+        /*build_android_signals=*/i % 2 == 0);
+    ig.add_trusted_bidding_signals_keys(MakeARandomString());
+    for (int j = 0; j < i % 3; ++j) {
+      ig.add_ad_component_render_ids(absl::StrCat("component_", j));
+    }
+    absl::flat_hash_set<std::string> keys(
+        ig.trusted_bidding_signals_keys().begin(),
+        ig.trusted_bidding_signals_keys().end());
+
+    std::string serialized;
+    AppendInterestGroupJson(ig, keys, &serialized);
+
+    EXPECT_EQ(serialized, ReferenceSerializeIG(ig, keys));
+  }
+}
+
+TEST(GenerateBidInputJsonTest, InterestGroupLeavesOutEmptyFields) {
+  InterestGroupForBidding ig;
+  ig.set_name("ig_name");
+  ig.add_ad_render_ids("ad_1");
+
+  std::string serialized;
+  AppendInterestGroupJson(ig, /*trusted_bidding_signals_keys=*/{},
+                          &serialized);
+
+  EXPECT_EQ(serialized, R"JSON({"name":"ig_name","adRenderIds":["ad_1"]})JSON");
+  EXPECT_EQ(serialized, ReferenceSerializeIG(ig, {}));
+}
+
+TEST(GenerateBidInputJsonTest, EscapesStringsLikeRapidJson) {
+  InterestGroupForBidding ig;
+  ig.set_name("ig");
+  ig.add_ad_render_ids("quote\" backslash\\ slash/");
+  ig.add_ad_render_ids("controls\b\f\n\r\t\x01\x1f");
+  ig.add_ad_render_ids("utf8 \xc3\xa9 del \x7f");
+
+  std::string serialized;
+  AppendInterestGroupJson(ig, {}, &serialized);
+
+  EXPECT_EQ(serialized, ReferenceSerializeIG(ig, {}));
+  rapidjson::Document parsed;
+  parsed.Parse(serialized.c_str());
+  ASSERT_FALSE(parsed.HasParseError());
+  EXPECT_EQ(std::string(parsed["adRenderIds"][1].GetString()),
+            ig.ad_render_ids(1));
+}
+
+TEST(GenerateBidInputJsonTest, EscapesInterestGroupName) {
+  InterestGroupForBidding ig;
+  ig.set_name("ig \"name\"");
+
+  std::string serialized;
+  AppendInterestGroupJson(ig, {}, &serialized);
+
+  EXPECT_EQ(serialized, R"JSON({"name":"ig \"name\""})JSON");
+}
+
+TEST(GenerateBidInputJsonTest, BrowserSignalsMatchReferenceSerializer) {
+  for (int i = 0; i < 50; ++i) {
+    InterestGroupForBidding ig =
+        MakeARandomInterestGroupForBiddingFromBrowser();
+    std::string publisher_name = MakeARandomString();
+    std::string seller = MakeARandomUrl();
+
+    std::string serialized;
+    AppendBrowserSignalsJson(publisher_name, seller, ig.browser_signals(),
+                             &serialized);
+
+    EXPECT_EQ(serialized, ReferenceBrowserSignals(publisher_name, seller,
+                                                  ig.browser_signals()));
+  }
+}
+
+TEST(GenerateBidInputJsonTest, BrowserSignalsWithoutPreviousWins) {
+  BrowserSignals browser_signals;
+  browser_signals.set_join_count(1);
+
+  std::string serialized;
+  AppendBrowserSignalsJson("publisher", "seller", browser_signals, &serialized);
+
+  EXPECT_EQ(serialized, ReferenceBrowserSignals("publisher", "seller",
+                                                browser_signals));
+}
+
+TEST(GenerateBidInputJsonTest, BrowserSignalsFromSharedPrefix) {
+  const std::string prefix =
+      MakeBrowserSignalsJsonPrefix("publisher", "https://seller.com");
+  for (int i = 0; i < 10; ++i) {
+    InterestGroupForBidding ig =
+        MakeARandomInterestGroupForBiddingFromBrowser();
+
+    std::string serialized;
+    AppendBrowserSignalsJson(prefix, ig.browser_signals(), &serialized);
+
+    EXPECT_EQ(serialized,
+              ReferenceBrowserSignals("publisher", "https://seller.com",
+                                      ig.browser_signals()));
+  }
+}
+
+TEST(GenerateBidInputJsonTest, BrowserSignalsWithExtremeIntegers) {
+  BrowserSignals browser_signals;
+  browser_signals.set_join_count(std::numeric_limits<int64_t>::min());
+  browser_signals.set_bid_count(std::numeric_limits<int64_t>::max());
+  browser_signals.set_recency(-1);
+
+  std::string serialized;
+  AppendBrowserSignalsJson("publisher", "seller", browser_signals, &serialized);
+
+  EXPECT_EQ(serialized, ReferenceBrowserSignals("publisher", "seller",
+                                                browser_signals));
+}
+
+TEST(GenerateBidInputJsonTest, DetectsEveryNonDefaultBrowserSignalsField) {
+  google::protobuf::util::MessageDifferencer differencer;
+  EXPECT_FALSE(HasNonDefaultBrowserSignals(BrowserSignals()));
+
+  // Fails when a field is added to BrowserSignals without updating
+  // HasNonDefaultBrowserSignals.
+  EXPECT_EQ(BrowserSignals::descriptor()->field_count(), 4);
+  BrowserSignals join_count;
+  join_count.set_join_count(1);
+  BrowserSignals bid_count;
+  bid_count.set_bid_count(1);
+  BrowserSignals recency;
+  recency.set_recency(1);
+  BrowserSignals prev_wins;
+  prev_wins.set_prev_wins("[]");
+  for (const auto& browser_signals :
+       {join_count, bid_count, recency, prev_wins}) {
+    EXPECT_TRUE(HasNonDefaultBrowserSignals(browser_signals));
+    EXPECT_FALSE(differencer.Equals(BrowserSignals::default_instance(),
+                                    browser_signals));
+  }
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,216 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Heap usage of a GenerateBids request, by phase of GenerateBidsReactor.
+//
+// BM_GenerateBidsMemory runs a GenerateBidsRawRequest of `igs` interest groups
+// of 10 ads each, with `signal_bytes` bytes of trusted bidding signals per
+// interest group, through the reactor. Every dispatch is answered at once
+// with a canned generateBid response. Allocations are counted by
+// services/common/test/utils/heap_counter.h. The following are exported as
+// counters, in bytes per request:
+// - <phase>_bytes: the bytes allocated by the phase, whether freed or not.
+// - <phase>_peak_bytes: the peak of the bytes live during the phase, over
+//   those live when it started.
+// where the phases are decrypt (decryption and parsing of the request, when
+// the reactor is constructed), signal_parse (parsing and split of the trusted
+// bidding signals), dispatch_inputs (generateBid inputs of every interest
+// group), dispatch (the canned responses) and handle_response.
+// - request_bytes and request_peak_bytes: the same for the whole request.
+// - in_flight_bytes: the bytes live when the request is dispatched, as held
+//   by each request waiting for Roma.
+// - allocations: the allocations per request.
+//
+// Run with:
+//   bazel run -c opt //services/bidding_service:generate_bids_memory_benchmarks
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
+#include "benchmark/benchmark.h"
+#include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
+#include "services/bidding_service/generate_bids_reactor.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/encryption/pass_through_crypto_client.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/test/utils/benchmark_requests.h"
+#include "services/common/test/utils/heap_counter.h"
+#include "services/common/test/utils/js_workloads.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kKeyId[] = "key_id";
+constexpr int kAdsPerInterestGroup = 10;
+
+// Answers every dispatch at once with a canned generateBid output.
+class CannedDispatchClient : public CodeDispatchClient {
+ public:
+  explicit CannedDispatchClient(const V8Dispatcher& dispatcher)
+      : CodeDispatchClient(dispatcher) {}
+
+  absl::Status BatchExecute(
+      std::vector<DispatchRequest>& batch,
+      BatchDispatchDoneCallback batch_callback) const override {
+    std::vector<absl::StatusOr<DispatchResponse>> responses;
+    responses.reserve(batch.size());
+    for (int i = 0; i < batch.size(); i++) {
+      DispatchResponse response;
+      response.id = batch[i].id;
+      response.resp = absl::Substitute(
+          R"({"response":{"render":"https://ads.com/render?id=$0","bid":$1},"logs":[],"errors":[],"warnings":[]})",
+          i, i + 1);
+      responses.push_back(std::move(response));
+    }
+    batch_callback(responses);
+    return absl::OkStatus();
+  }
+};
+
+struct GenerateBidsPhases {
+  HeapPhase decrypt;
+  HeapPhase signal_parse;
+  HeapPhase dispatch_inputs;
+  HeapPhase dispatch;
+  HeapPhase handle_response;
+  // Highest request_peak_bytes and in_flight_bytes of a request.
+  int64_t request_peak_bytes = 0;
+  int64_t in_flight_bytes = 0;
+
+  // Ends `phase`, and accounts for its peak in that of the request.
+  void End(HeapPhase& phase) {
+    request_peak_bytes =
+        std::max(request_peak_bytes, phase.End().peak_live_bytes);
+  }
+};
+
+// Moves from phase to phase as the reactor reports them.
+class HeapPhaseLogger : public BiddingBenchmarkingLogger {
+ public:
+  explicit HeapPhaseLogger(GenerateBidsPhases& phases) : phases_(phases) {}
+
+  void Begin() override {}
+  void End() override {}
+
+  void BuildInputBegin() override { phases_.signal_parse.Begin(); }
+  void ParseSignalsEnd() override {
+    phases_.End(phases_.signal_parse);
+    phases_.dispatch_inputs.Begin();
+  }
+  void BuildInputEnd() override {
+    phases_.End(phases_.dispatch_inputs);
+    phases_.in_flight_bytes =
+        std::max(phases_.in_flight_bytes, HeapCounter::Get().live_bytes);
+    phases_.dispatch.Begin();
+  }
+  void HandleResponseBegin() override {
+    phases_.End(phases_.dispatch);
+    phases_.handle_response.Begin();
+  }
+  void HandleResponseEnd() override { phases_.End(phases_.handle_response); }
+
+ private:
+  GenerateBidsPhases& phases_;
+};
+
+void BM_GenerateBidsMemory(benchmark::State& state) {
+  server_common::TelemetryConfig config_proto;
+  config_proto.set_mode(server_common::TelemetryConfig::PROD);
+  metric::BiddingContextMap(server_common::BuildDependentConfig(config_proto));
+  auto key_fetcher_manager = CreateTestKeyFetcherManager();
+  PassThroughCryptoClient crypto_client;
+  BiddingServiceRuntimeConfig runtime_config = {.encryption_enabled = true};
+  V8Dispatcher dispatcher;
+  CannedDispatchClient client(dispatcher);
+
+  GenerateBidsRequest request;
+  request.set_key_id(kKeyId);
+  *request.mutable_request_ciphertext() =
+      MakeBenchmarkGenerateBidsRawRequest(
+          {.num_igs = static_cast<int>(state.range(0)),
+           .num_ads = kAdsPerInterestGroup,
+           .user_bidding_signals_workload = JsWorkload::kJsonHeavy},
+          state.range(1), JsWorkload::kJsonHeavy)
+          .SerializeAsString();
+  GenerateBidsPhases phases;
+  int64_t request_bytes = 0;
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    metric::BiddingContextMap()->Get(&request);
+    GenerateBidsResponse response;
+    HeapCounter::Reset();
+    phases.decrypt.Begin();
+    GenerateBidsReactor reactor(client, &request, &response,
+                                std::make_unique<HeapPhaseLogger>(phases),
+                                key_fetcher_manager.get(), &crypto_client,
+                                runtime_config);
+    phases.End(phases.decrypt);
+    reactor.Execute();
+    const HeapUsage usage = HeapCounter::Get();
+    request_bytes += usage.allocated_bytes;
+    allocations += usage.allocations;
+    phases.request_peak_bytes =
+        std::max(phases.request_peak_bytes, usage.peak_live_bytes);
+    benchmark::DoNotOptimize(response);
+  }
+
+  const auto per_request = [](int64_t value) {
+    return benchmark::Counter(value, benchmark::Counter::kAvgIterations,
+                              benchmark::Counter::kIs1024);
+  };
+  const auto bytes = [](int64_t value) {
+    return benchmark::Counter(value, benchmark::Counter::kDefaults,
+                              benchmark::Counter::kIs1024);
+  };
+  const auto export_phase = [&](absl::string_view name,
+                                 const HeapPhase& phase) {
+    state.counters[absl::StrCat(name, "_bytes")] =
+        per_request(phase.allocated_bytes());
+    state.counters[absl::StrCat(name, "_peak_bytes")] =
+        bytes(phase.peak_live_bytes());
+  };
+  export_phase("decrypt", phases.decrypt);
+  export_phase("signal_parse", phases.signal_parse);
+  export_phase("dispatch_inputs", phases.dispatch_inputs);
+  export_phase("dispatch", phases.dispatch);
+  export_phase("handle_response", phases.handle_response);
+  state.counters["request_bytes"] = per_request(request_bytes);
+  state.counters["request_peak_bytes"] = bytes(phases.request_peak_bytes);
+  state.counters["in_flight_bytes"] = bytes(phases.in_flight_bytes);
+  state.counters["allocations"] = per_request(allocations);
+}
+
+// Args: number of interest groups, bidding signal bytes per interest group.
+void GenerateBidsMemoryArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"igs", "signal_bytes"});
+  for (int igs : {10, 100, 1000}) {
+    for (int signal_bytes : {64, 1024, 16384}) {
+      benchmark->Args({igs, signal_bytes});
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_GenerateBidsMemory)->Apply(GenerateBidsMemoryArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
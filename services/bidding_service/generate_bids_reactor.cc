@@ -14,27 +14,41 @@
 
 #include "services/bidding_service/generate_bids_reactor.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
-#include <google/protobuf/text_format.h>
 #include <google/protobuf/util/json_util.h>
 #include <google/protobuf/util/message_differencer.h>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
-#include "absl/strings/str_format.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/notification.h"
 #include "glog/logging.h"
 #include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
+#include "services/bidding_service/generate_bid_input_json.h"
+#include "services/common/encryption/crypto_metrics.h"
+#include "services/common/util/feature_set.h"
+#include "services/common/util/json_on_demand.h"
 #include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/common/util/request_summary.h"
 #include "services/common/util/status_macros.h"
 #include "services/common/util/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
-using ::google::protobuf::TextFormat;
 
 using RawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
 using IGForBidding =
@@ -52,7 +66,13 @@ constexpr char kDispatchHandlerFunctionName[] = "generateBid";
 constexpr char kDispatchHandlerWrapperFunctionName[] = "generateBidWrapper";
 constexpr char kDispatchHandlerFunctionNameWithCodeWrapper[] =
     "generateBidEntryFunction";
+constexpr char kGenerateBidsBatchHandlerFunction[] =
+    "generateBidsBatchEntryFunction";
+constexpr char kGenerateBidsBatchIdPrefix[] = "generateBidsBatch:";
 constexpr char kRomaTimeoutMs[] = "TimeoutMs";
+// Number of threads parsing the dispatch responses of a request, the callback
+// thread included, when parsing runs in parallel.
+constexpr int kResponseParsingWorkers = 4;
 
 constexpr int kArgsSizeDefault = 5;
 constexpr int kArgsSizeWithWrapper = 6;
@@ -66,189 +86,178 @@ std::string ProtoToJson(const google::protobuf::Message& proto) {
   return json;
 }
 
-// Creates a json of trusted bidding signals for a single IG. Queries the
-// bidding signals for -
-// 1. IG Name and moves the bidding signal values to the new json document.
-// 2. Bidding signal keys in the IG and copies them to the new json document.
-absl::StatusOr<ParsedTrustedBiddingSignals> GetSignalsForIG(
+// Serialized value of each trusted bidding signal, keyed by the signal key.
+// The keys view into document, and the values into serialized_values, or both
+// into the trusted bidding signals when they are a key-value table, or both
+// into serialized_values when they are indexed with the on-demand parser.
+struct TrustedBiddingSignalsIndex {
+  absl::flat_hash_map<absl::string_view, absl::string_view> signals;
+  // Deque keeps the views into its elements valid as it grows.
+  std::deque<std::string> serialized_values;
+  // Parsed trusted bidding signals, unless they are a key-value table.
+  rapidjson::Document document;
+};
+
+// Serializes each member of the trusted bidding signals object once, so that
+// signals shared by many IGs are not copied and serialized again for each IG.
+absl::StatusOr<TrustedBiddingSignalsIndex> IndexTrustedBiddingSignals(
+    const rapidjson::Value& bidding_signals_obj) {
+  if (!bidding_signals_obj.IsObject()) {
+    return absl::InvalidArgumentError(
+        "Malformatted trusted bidding signals (Property \"keys\" is not an "
+        "object)");
+  }
+  TrustedBiddingSignalsIndex index;
+  index.signals.reserve(bidding_signals_obj.MemberCount());
+  for (const auto& member : bidding_signals_obj.GetObject()) {
+    absl::string_view key(member.name.GetString(),
+                          member.name.GetStringLength());
+    if (index.signals.contains(key)) {
+      // Keep the first value of duplicate keys, like FindMember does.
+      continue;
+    }
+    PS_ASSIGN_OR_RETURN(std::string value, SerializeJsonDoc(member.value));
+    index.signals.emplace(
+        key, index.serialized_values.emplace_back(std::move(value)));
+  }
+  return index;
+}
+
+// Indexes the trusted bidding signals of a key-value table, whose values are
+// already serialized, without parsing any JSON.
+absl::StatusOr<TrustedBiddingSignalsIndex> IndexTrustedBiddingSignalsTable(
+    absl::string_view bidding_signals_table) {
+  PS_ASSIGN_OR_RETURN(KeyValueTable table,
+                      ParseKeyValueTable(bidding_signals_table));
+  auto keys_itr = table.find("keys");
+  if (keys_itr == table.end()) {
+    return absl::InvalidArgumentError(
+        "Malformatted trusted bidding signals (Missing property \"keys\")");
+  }
+  TrustedBiddingSignalsIndex index;
+  index.signals = std::move(keys_itr->second);
+  return index;
+}
+
+// Creates a json of trusted bidding signals for a single IG from the
+// pre-serialized signals of -
+// 1. IG Name.
+// 2. Bidding signal keys in the IG.
+// Only the keys of the signals are collected when keys_only is set, for IGs
+// whose signals are passed once per batch instead.
+ParsedTrustedBiddingSignals GetSignalsForIG(
     const GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding&
         ig,
-    rapidjson::Value* bidding_signals_obj, long avg_signal_str_size) {
-  // Insert bidding signal values for this Interest Group.
+    const TrustedBiddingSignalsIndex& bidding_signals_index,
+    long avg_signal_str_size, bool keys_only) {
   ParsedTrustedBiddingSignals parsed_trusted_bidding_signals;
-  rapidjson::Document ig_signals;
-  ig_signals.SetObject();
-  // If no bidding signals passed, return empty document.
-  if (bidding_signals_obj == nullptr) {
-    return parsed_trusted_bidding_signals;
-  }
-  // Move bidding signals with key name = IG name.
-  rapidjson::Value::MemberIterator ig_name_itr =
-      bidding_signals_obj->FindMember(ig.name().c_str());
-
-  if (ig_name_itr != bidding_signals_obj->MemberEnd()) {
-    rapidjson::Value json_key;
-    // Keep string reference. Assumes safe lifecycle.
-    json_key.SetString(rapidjson::StringRef(ig.name().c_str()));
-    // AddMember moves Values, do not reference them anymore.
-    ig_signals.AddMember(json_key, ig_name_itr->value,
-                         ig_signals.GetAllocator());
-    parsed_trusted_bidding_signals.keys.emplace(ig.name());
-  }
-
-  // Copy bidding signals with key name in bidding signal keys.
-  for (const auto& key : ig.trusted_bidding_signals_keys()) {
-    if (parsed_trusted_bidding_signals.keys.contains(key)) {
-      // Do not process duplicate keys.
-      continue;
+  std::string& ig_signals = *parsed_trusted_bidding_signals.json;
+  JsonWriter writer(&ig_signals);
+  auto add_signal = [&](const std::string& key) {
+    auto signal_itr = bidding_signals_index.signals.find(key);
+    if (signal_itr == bidding_signals_index.signals.end()) {
+      return;
     }
-    rapidjson::Value::ConstMemberIterator key_itr =
-        bidding_signals_obj->FindMember(key.c_str());
-    if (key_itr != bidding_signals_obj->MemberEnd()) {
-      rapidjson::Value json_key;
-      // Keep string reference. Assumes safe lifecycle.
-      json_key.SetString(rapidjson::StringRef(key.c_str()));
-      rapidjson::Value json_value;
-      // Copy instead of move, could be referenced by multiple IGs.
-      json_value.CopyFrom(key_itr->value, ig_signals.GetAllocator());
-      // AddMember moves Values, do not reference them anymore.
-      ig_signals.AddMember(json_key, json_value, ig_signals.GetAllocator());
-      parsed_trusted_bidding_signals.keys.emplace(key);
+    parsed_trusted_bidding_signals.keys.emplace(key);
+    if (keys_only) {
+      return;
+    }
+    if (ig_signals.empty()) {
+      ig_signals.reserve(avg_signal_str_size);
+      writer.StartObject();
+    }
+    writer.Key(key).RawValue(signal_itr->second);
+  };
+  add_signal(ig.name());
+  for (const auto& key : ig.trusted_bidding_signals_keys()) {
+    // Do not process duplicate keys.
+    if (!parsed_trusted_bidding_signals.keys.contains(key)) {
+      add_signal(key);
     }
   }
-  if (ig_signals.MemberCount() > 0) {
-    absl::StatusOr<std::shared_ptr<std::string>> ig_signals_str =
-        SerializeJsonDoc(ig_signals, avg_signal_str_size);
-    PS_ASSIGN_OR_RETURN(parsed_trusted_bidding_signals.json, ig_signals_str);
+  if (!ig_signals.empty()) {
+    writer.EndObject();
   }
   return parsed_trusted_bidding_signals;
 }
 
-constexpr char kTopWindowHostname[] = "topWindowHostname";
-constexpr char kSeller[] = "seller";
-constexpr char kTopLevelSeller[] = "topLevelSeller";
-constexpr char kJoinCount[] = "joinCount";
-constexpr char kBidCount[] = "bidCount";
-constexpr char kRecency[] = "recency";
-constexpr char kPrevWins[] = "prevWins";
-
-std::string MakeBrowserSignalsForScript(absl::string_view publisher_name,
-                                        absl::string_view seller,
-                                        BrowserSignals browser_signals) {
-  return absl::StrCat(
-      R"JSON({")JSON", kTopWindowHostname, R"JSON(":")JSON", publisher_name,
-      R"JSON(",")JSON", kSeller, R"JSON(":")JSON", seller, R"JSON(",")JSON",
-      kTopLevelSeller, R"JSON(":")JSON", seller, R"JSON(",")JSON", kJoinCount,
-      R"JSON(":)JSON", browser_signals.join_count(), R"JSON(,")JSON", kBidCount,
-      R"JSON(":)JSON", browser_signals.bid_count(), R"JSON(,")JSON", kRecency,
-      R"JSON(":)JSON", browser_signals.recency(), R"JSON(,")JSON", kPrevWins,
-      R"JSON(":)JSON",
-      browser_signals.prev_wins().empty() ? R"JSON("")JSON"
-                                          : browser_signals.prev_wins(),
-      "}");
-}
-
-absl::StatusOr<std::string> SerializeRepeatedStringField(
-    google::protobuf::RepeatedPtrField<std::string> repeated_string_field) {
-  rapidjson::Document json_array;
-  json_array.SetArray();
-  for (const auto& item : repeated_string_field) {
-    json_array.PushBack(
-        rapidjson::Value(item.c_str(), json_array.GetAllocator()).Move(),
-        json_array.GetAllocator());
-  }
-  return SerializeJsonDoc(json_array);
-}
-
-constexpr char kName[] = "name";
-constexpr char kTrustedBiddingSignalsKeys[] = "trustedBiddingSignalsKeys";
-constexpr char kAdRenderIds[] = "adRenderIds";
-constexpr char kAdComponentRenderIds[] = "adComponentRenderIds";
-constexpr char kUserBiddingSignals[] = "userBiddingSignals";
-
-// Manual/Custom serializer for Interest Group.
-// Empty fields will not be included at all in the serialized JSON.
-// No default, null, or dummy values are filled in.
-// Device signals are not serialized since they are passed to generateBid()
-// in a different parameter.
-absl::StatusOr<std::string> SerializeIG(IGForBidding ig) {
-  // Insert the name in quotes.
-  std::string serialized_ig =
-      absl::StrFormat(R"JSON({"%s":"%s")JSON", kName, ig.name());
-  // Bidding signals keys.
-  if (!ig.trusted_bidding_signals_keys().empty()) {
-    absl::StatusOr<std::string> bidding_signals_keys_json_arr =
-        SerializeRepeatedStringField(ig.trusted_bidding_signals_keys());
-    if (!bidding_signals_keys_json_arr.ok()) {
-      return bidding_signals_keys_json_arr.status();
-    }
-    absl::StrAppend(
-        &serialized_ig,
-        absl::StrFormat(R"JSON(,"%s":%s)JSON", kTrustedBiddingSignalsKeys,
-                        bidding_signals_keys_json_arr.value()));
-  }
-  // Ad render IDs.
-  if (!ig.ad_render_ids().empty()) {
-    PS_ASSIGN_OR_RETURN(std::string ad_render_ids_json_arr,
-                        SerializeRepeatedStringField(ig.ad_render_ids()));
-    absl::StrAppend(&serialized_ig,
-                    absl::StrFormat(R"JSON(,"%s":%s)JSON", kAdRenderIds,
-                                    ad_render_ids_json_arr));
-  }
-  // Ad component render IDs.
-  if (!ig.ad_component_render_ids().empty()) {
-    PS_ASSIGN_OR_RETURN(
-        absl::StatusOr<std::string> ad_component_render_ids_json_arr,
-        SerializeRepeatedStringField(ig.ad_component_render_ids()));
-    absl::StrAppend(
-        &serialized_ig,
-        absl::StrFormat(R"JSON(,"%s":%s)JSON", kAdComponentRenderIds,
-                        ad_component_render_ids_json_arr.value()));
-  }
-  // User Bidding Signals gets no quotes as it needs no transformation.
-  if (!ig.user_bidding_signals().empty()) {
-    absl::StrAppend(&serialized_ig,
-                    absl::StrFormat(R"JSON(,"%s":%s)JSON", kUserBiddingSignals,
-                                    ig.user_bidding_signals()));
-  }
-  // Device signals do not have to be serialized.
-  absl::StrAppend(&serialized_ig, "}");
-  return serialized_ig;
+// Indexes the members of the "keys" object of the trusted bidding signals
+// with the on-demand JSON parser, which copies their serialized values as
+// they are in the signals instead of building and serializing a document.
+absl::StatusOr<TrustedBiddingSignalsIndex> IndexTrustedBiddingSignalsOnDemand(
+    absl::string_view bidding_signals) {
+  TrustedBiddingSignalsIndex index;
+  PS_RETURN_IF_ERROR(ForEachJsonObjectMember(
+      bidding_signals, "keys",
+      [&index](absl::string_view key, absl::string_view value) {
+        if (index.signals.contains(key)) {
+          // Keep the first value of duplicate keys, like FindMember does.
+          return;
+        }
+        absl::string_view stored_key =
+            index.serialized_values.emplace_back(key);
+        index.signals.emplace(stored_key,
+                              index.serialized_values.emplace_back(value));
+      }));
+  return index;
 }
 
-// Creates a map of Interest Group names -> trusted bidding signals json
-// strings. Parses the trusted bidding signals string and calls GetSignalsForIG
-// in a loop for all Interest Groups.
-absl::StatusOr<TrustedBiddingSignalsByIg> SerializeTrustedBiddingSignalsPerIG(
+// Parses the trusted bidding signals string, or slices it if it is a
+// key-value table, into an index of their serialized values.
+absl::StatusOr<TrustedBiddingSignalsIndex> IndexRequestTrustedBiddingSignals(
     const GenerateBidsRequest::GenerateBidsRawRequest& raw_request,
-    const ContextLogger& logger) {
-  // Parse into JSON.
+    bool use_on_demand_json_parser, const ContextLogger& logger) {
   auto start_parse_time = absl::Now();
-  PS_ASSIGN_OR_RETURN((rapidjson::Document parsed_signals),
-                      ParseJsonString(raw_request.bidding_signals()));
-  logger.vlog(2, "\nTrusted Bidding Signals Deserialize Time: ",
-              ToInt64Microseconds((absl::Now() - start_parse_time)),
-              " microseconds for ", raw_request.bidding_signals().size(),
-              " bytes.");
-
-  // Select root key.
-  if (!parsed_signals.HasMember("keys")) {
-    logger.vlog(2,
-                "Trusted bidding signals JSON validate error (Missing property "
-                "\"keys\")");
-    return absl::InvalidArgumentError(
-        "Malformatted trusted bidding signals (Missing property \"keys\")");
+  TrustedBiddingSignalsIndex bidding_signals_index;
+  if (IsKeyValueTable(raw_request.bidding_signals())) {
+    PS_ASSIGN_OR_RETURN(
+        bidding_signals_index,
+        IndexTrustedBiddingSignalsTable(raw_request.bidding_signals()));
+  } else if (use_on_demand_json_parser) {
+    PS_ASSIGN_OR_RETURN(
+        bidding_signals_index,
+        IndexTrustedBiddingSignalsOnDemand(raw_request.bidding_signals()));
+  } else {
+    // Parse into JSON.
+    rapidjson::Document parsed_signals;
+    PS_ASSIGN_OR_RETURN(parsed_signals,
+                        ParseJsonString(raw_request.bidding_signals()));
+
+    // Select root key.
+    if (!parsed_signals.HasMember("keys")) {
+      logger.vlog(2,
+                  "Trusted bidding signals JSON validate error (Missing "
+                  "property \"keys\")");
+      return absl::InvalidArgumentError(
+          "Malformatted trusted bidding signals (Missing property \"keys\")");
+    }
+    PS_ASSIGN_OR_RETURN(bidding_signals_index,
+                        IndexTrustedBiddingSignals(parsed_signals["keys"]));
+    // Moving the document keeps the members its keys view into in place.
+    bidding_signals_index.document = std::move(parsed_signals);
   }
-  rapidjson::Value& bidding_signals_obj = parsed_signals["keys"];
+  PS_CONTEXT_VLOG(logger, 2, "\nTrusted Bidding Signals Deserialize Time: ",
+                  ToInt64Microseconds((absl::Now() - start_parse_time)),
+                  " microseconds for ", raw_request.bidding_signals().size(),
+                  " bytes.");
+  return bidding_signals_index;
+}
 
+// Creates a map of Interest Group names -> trusted bidding signals json
+// strings, calling GetSignalsForIG in a loop for all Interest Groups.
+TrustedBiddingSignalsByIg SerializeTrustedBiddingSignalsPerIG(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request,
+    const TrustedBiddingSignalsIndex& bidding_signals_index, bool keys_only) {
   // Create IG -> TrustedBiddingSignals Map.
   TrustedBiddingSignalsByIg per_ig_signals_map;
+  per_ig_signals_map.reserve(raw_request.interest_group_for_bidding_size());
   long avg_signal_size_per_ig = raw_request.bidding_signals().size() /
                                 raw_request.interest_group_for_bidding_size();
   for (const auto& ig : raw_request.interest_group_for_bidding()) {
     per_ig_signals_map.try_emplace(
         ig.name(),
-        GetSignalsForIG(ig, &bidding_signals_obj, avg_signal_size_per_ig));
+        GetSignalsForIG(ig, bidding_signals_index, avg_signal_size_per_ig,
+                        keys_only));
   }
   return per_ig_signals_map;
 }
@@ -276,33 +285,57 @@ constexpr int BidArgIndex(GenerateBidArgs arg) {
 // shared by all dispatch requests are left empty, to be  filled in with values
 // specific to the request.
 std::vector<std::shared_ptr<std::string>> BuildBaseInput(
-    const RawRequest& raw_request) {
+    const RawRequest& raw_request, const bool enable_buyer_debug_url_generation,
+    const bool enable_adtech_code_logging, SignalBlobCache* signal_blob_cache) {
   int args_size = kArgsSizeWithWrapper;
 
+  // Signals are shared with the requests with the same signals through
+  // signal_blob_cache, if set.
+  const auto build_signals = [signal_blob_cache](absl::string_view signals) {
+    const auto assemble = [signals]() {
+      return signals.empty() ? std::string("\"\"") : std::string(signals);
+    };
+    if (signal_blob_cache == nullptr) {
+      return std::make_shared<std::string>(assemble());
+    }
+    return signal_blob_cache->GetOrAssemble({signals}, assemble);
+  };
   std::vector<std::shared_ptr<std::string>> input(
       args_size, std::make_shared<std::string>());  // GenerateBidArgs size.
   input[BidArgIndex(GenerateBidArgs::kAuctionSignals)] =
-      std::make_shared<std::string>((raw_request.auction_signals().empty())
-                                        ? "\"\""
-                                        : raw_request.auction_signals());
+      build_signals(raw_request.auction_signals());
   input[BidArgIndex(GenerateBidArgs::kBuyerSignals)] =
-      std::make_shared<std::string>((raw_request.buyer_signals().empty())
-                                        ? "\"\""
-                                        : raw_request.buyer_signals());
+      build_signals(raw_request.buyer_signals());
+  input[BidArgIndex(GenerateBidArgs::kFeatureFlags)] =
+      std::make_shared<std::string>(
+          GetFeatureFlagJson(enable_adtech_code_logging,
+                             enable_buyer_debug_url_generation &&
+                                 raw_request.enable_debug_reporting()));
   return input;
 }
 
+// Features of a request tested for each of its interest groups, see
+// WithFeatureSet.
+enum GenerateBidFeature : int {
+  // VLOG_IS_ON(2).
+  kLogGenerateBidInputs = 1 << 0,
+  kLimitGenerateBidInputBytes = 1 << 1,
+  kChargeMemoryBudget = 1 << 2,
+};
+constexpr int kNumGenerateBidFeatures = 3;
+
 // Builds a Dispatch Request for the ROMA Engine for a single Interest Group.
+// The arguments are logged and their serialization timed if kLogInputs.
+template <bool kLogInputs>
 absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
-    IGForBidding& interest_group, const RawRequest& raw_request,
+    const IGForBidding& interest_group,
     const std::vector<std::shared_ptr<std::string>>& base_input,
     const TrustedBiddingSignalsByIg& ig_trusted_signals_map,
-    const bool enable_buyer_debug_url_generation, const ContextLogger& logger,
-    const bool enable_adtech_code_logging) {
+    absl::string_view browser_signals_prefix, const ContextLogger& logger) {
   // Construct the wrapper struct for our V8 Dispatch Request.
   DispatchRequest generate_bid_request;
   generate_bid_request.id = interest_group.name();
-  // TODO(b/258790164) Update after code is fetched periodically.
+  // CodeDispatchClient replaces this with the current code version.
   generate_bid_request.version_num = 1;
   // Copy base input and amend with custom interest_group
   generate_bid_request.input = base_input;
@@ -320,30 +353,31 @@ absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
     return trusted_bidding_signals_itr->second.status();
   }
 
-  if (trusted_bidding_signals_itr->second.value().json->empty()) {
+  if (trusted_bidding_signals_itr->second.value().keys.empty()) {
     return absl::InvalidArgumentError(
         "Interest Group must contain non-empty trusted bidding "
         "signals to generate bids.");
   }
 
+  // Left empty when the signals are passed once per batch.
   generate_bid_request
       .input[BidArgIndex(GenerateBidArgs::kTrustedBiddingSignals)] =
       trusted_bidding_signals_itr->second.value().json;
 
   // IG must have device signals to participate in Bidding.
-  google::protobuf::util::MessageDifferencer differencer;
   if (interest_group.has_browser_signals() &&
-      interest_group.browser_signals().IsInitialized() &&
-      !differencer.Equals(BrowserSignals::default_instance(),
-                          interest_group.browser_signals())) {
+      HasNonDefaultBrowserSignals(interest_group.browser_signals())) {
+    auto browser_signals = std::make_shared<std::string>();
+    AppendBrowserSignalsJson(browser_signals_prefix,
+                             interest_group.browser_signals(),
+                             browser_signals.get());
     generate_bid_request.input[BidArgIndex(GenerateBidArgs::kDeviceSignals)] =
-        std::make_shared<std::string>(MakeBrowserSignalsForScript(
-            raw_request.publisher_name(), raw_request.seller(),
-            interest_group.browser_signals()));
+        std::move(browser_signals);
   } else if (interest_group.has_android_signals() &&
              interest_group.android_signals().IsInitialized() &&
-             !differencer.Equals(AndroidSignals::default_instance(),
-                                 interest_group.browser_signals())) {
+             !google::protobuf::util::MessageDifferencer().Equals(
+                 AndroidSignals::default_instance(),
+                 interest_group.browser_signals())) {
     std::string serialized_android_signals =
         ProtoToJson(interest_group.android_signals());
     generate_bid_request.input[BidArgIndex(GenerateBidArgs::kDeviceSignals)] =
@@ -354,34 +388,28 @@ absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
     generate_bid_request.input[BidArgIndex(GenerateBidArgs::kDeviceSignals)] =
         std::make_shared<std::string>(R"JSON("")JSON");
   }
-  generate_bid_request.input[BidArgIndex(GenerateBidArgs::kFeatureFlags)] =
-      std::make_shared<std::string>(
-          GetFeatureFlagJson(enable_adtech_code_logging,
-                             enable_buyer_debug_url_generation &&
-                                 raw_request.enable_debug_reporting()));
   generate_bid_request.handler_name =
       kDispatchHandlerFunctionNameWithCodeWrapper;
 
-  // Only add parsed keys.
-  interest_group.clear_trusted_bidding_signals_keys();
-  interest_group.mutable_trusted_bidding_signals_keys()->Add(
-      trusted_bidding_signals_itr->second.value().keys.begin(),
-      trusted_bidding_signals_itr->second.value().keys.end());
-  auto start_parse_time = absl::Now();
-  auto serialized_ig = SerializeIG(interest_group);
-  if (!serialized_ig.ok()) {
-    return serialized_ig.status();
+  absl::Time start_parse_time;
+  if constexpr (kLogInputs) {
+    start_parse_time = absl::Now();
   }
+  auto serialized_ig = std::make_shared<std::string>();
+  // Only add parsed keys.
+  AppendInterestGroupJson(interest_group,
+                          trusted_bidding_signals_itr->second.value().keys,
+                          serialized_ig.get());
   generate_bid_request.input[BidArgIndex(GenerateBidArgs::kInterestGroup)] =
-      std::make_shared<std::string>(std::move(serialized_ig.value()));
-  logger.vlog(
-      3, "\nInterest Group Serialize Time: ",
-      ToInt64Microseconds((absl::Now() - start_parse_time)),
-      " microseconds for ",
-      generate_bid_request.input[BidArgIndex(GenerateBidArgs::kInterestGroup)]
-          ->size(),
-      " bytes.");
-  if (VLOG_IS_ON(2)) {
+      std::move(serialized_ig);
+  if constexpr (kLogInputs) {
+    PS_CONTEXT_VLOG(
+        logger, 3, "\nInterest Group Serialize Time: ",
+        ToInt64Microseconds((absl::Now() - start_parse_time)),
+        " microseconds for ",
+        generate_bid_request.input[BidArgIndex(GenerateBidArgs::kInterestGroup)]
+            ->size(),
+        " bytes.");
     logger.vlog(2, "\n\nGenerateBid Input Args:");
     for (const auto& it : generate_bid_request.input) {
       logger.vlog(2, it->c_str(), "\n");
@@ -390,13 +418,150 @@ absl::StatusOr<DispatchRequest> BuildGenerateBidRequest(
   return generate_bid_request;
 }
 
-absl::StatusOr<std::string> ParseAndGetGenerateBidResponseJson(
-    bool enable_adtech_code_logging, const std::string& response,
+// Returns the bytes of the arguments of a dispatch request, which Roma parses
+// for each generateBid() call.
+int64_t InputBytes(const DispatchRequest& request) {
+  int64_t bytes = 0;
+  for (const auto& arg : request.input) {
+    if (arg != nullptr) {
+      bytes += arg->size();
+    }
+  }
+  return bytes;
+}
+
+// Returns the bytes of the arguments made for the dispatch request alone, not
+// counting those it shares with the other requests through `shared`.
+int64_t OwnInputBytes(const DispatchRequest& request,
+                      const std::vector<std::shared_ptr<std::string>>& shared) {
+  int64_t bytes = 0;
+  for (const auto& arg : request.input) {
+    if (arg != nullptr &&
+        std::find(shared.begin(), shared.end(), arg) == shared.end()) {
+      bytes += arg->size();
+    }
+  }
+  return bytes;
+}
+
+// See generateBidsBatchEntryFunction in buyer_code_wrapper.h.
+enum class GenerateBidsBatchArgs : int {
+  kInterestGroups = 0,
+  kAuctionSignals,
+  kBuyerSignals,
+  kFeatureFlags,
+  kTrustedBiddingSignals,
+};
+
+constexpr int BatchArgIndex(GenerateBidsBatchArgs arg) {
+  return static_cast<std::underlying_type_t<GenerateBidsBatchArgs>>(arg);
+}
+
+// Groups per IG dispatch requests into requests for
+// generateBidsBatchEntryFunction holding up to batch_size IGs each. The per IG
+// arguments are spliced into the interest groups array argument as they are,
+// and the auction and buyer signals are passed once per batch. The names of
+// the IGs in each batch are recorded in batched_ig_names, keyed by the id of
+// the batch dispatch request, in the order the batch returns their bids.
+// When shared_signals is set, the per IG requests hold no trusted bidding
+// signals. Each batch is instead passed one object holding the signals of all
+// of its IGs, so that signals shared by several IGs are only parsed once, and
+// each IG picks its own by the trustedBiddingSignalsKeys of its interest
+// group.
+std::vector<DispatchRequest> BuildGenerateBidsBatchRequests(
+    std::vector<DispatchRequest> per_ig_requests, int batch_size,
+    const TrustedBiddingSignalsIndex* shared_signals,
+    const TrustedBiddingSignalsByIg& ig_trusted_signals_map,
+    absl::flat_hash_map<std::string, std::vector<std::string>>&
+        batched_ig_names) {
+  std::vector<DispatchRequest> batch_requests;
+  batch_requests.reserve((per_ig_requests.size() + batch_size - 1) /
+                         batch_size);
+  for (int begin = 0; begin < per_ig_requests.size(); begin += batch_size) {
+    const int end = std::min<int>(begin + batch_size, per_ig_requests.size());
+    const DispatchRequest& first_request = per_ig_requests[begin];
+    DispatchRequest batch_request;
+    batch_request.id =
+        absl::StrCat(kGenerateBidsBatchIdPrefix, begin / batch_size);
+    batch_request.version_num = first_request.version_num;
+    batch_request.handler_name = kGenerateBidsBatchHandlerFunction;
+    batch_request.tags = first_request.tags;
+    batch_request.input.resize(
+        BatchArgIndex(shared_signals != nullptr
+                          ? GenerateBidsBatchArgs::kTrustedBiddingSignals
+                          : GenerateBidsBatchArgs::kFeatureFlags) +
+        1);
+    batch_request
+        .input[BatchArgIndex(GenerateBidsBatchArgs::kAuctionSignals)] =
+        first_request.input[BidArgIndex(GenerateBidArgs::kAuctionSignals)];
+    batch_request.input[BatchArgIndex(GenerateBidsBatchArgs::kBuyerSignals)] =
+        first_request.input[BidArgIndex(GenerateBidArgs::kBuyerSignals)];
+    batch_request.input[BatchArgIndex(GenerateBidsBatchArgs::kFeatureFlags)] =
+        first_request.input[BidArgIndex(GenerateBidArgs::kFeatureFlags)];
+    std::vector<std::string>& ig_names = batched_ig_names[batch_request.id];
+    ig_names.reserve(end - begin);
+
+    auto interest_groups = std::make_shared<std::string>();
+    JsonWriter interest_groups_writer(interest_groups.get());
+    interest_groups_writer.StartArray();
+    auto trusted_bidding_signals = std::make_shared<std::string>();
+    JsonWriter trusted_bidding_signals_writer(trusted_bidding_signals.get());
+    trusted_bidding_signals_writer.StartObject();
+    absl::flat_hash_set<absl::string_view> batch_signal_keys;
+    for (int i = begin; i < end; i++) {
+      const auto& input = per_ig_requests[i].input;
+      interest_groups_writer.StartObject()
+          .Key("interestGroup")
+          .RawValue(*input[BidArgIndex(GenerateBidArgs::kInterestGroup)]);
+      if (shared_signals == nullptr) {
+        interest_groups_writer.Key("trustedBiddingSignals")
+            .RawValue(
+                *input[BidArgIndex(GenerateBidArgs::kTrustedBiddingSignals)]);
+      } else {
+        // Requests are only built for IGs with signals.
+        for (const std::string& key :
+             ig_trusted_signals_map.at(per_ig_requests[i].id)->keys) {
+          if (!batch_signal_keys.insert(key).second) {
+            continue;
+          }
+          trusted_bidding_signals_writer.Key(key).RawValue(
+              shared_signals->signals.at(key));
+        }
+      }
+      interest_groups_writer.Key("deviceSignals")
+          .RawValue(*input[BidArgIndex(GenerateBidArgs::kDeviceSignals)])
+          .EndObject();
+      ig_names.push_back(std::move(per_ig_requests[i].id));
+    }
+    interest_groups_writer.EndArray();
+    if (shared_signals != nullptr) {
+      trusted_bidding_signals_writer.EndObject();
+      batch_request
+          .input[BatchArgIndex(GenerateBidsBatchArgs::kTrustedBiddingSignals)] =
+          std::move(trusted_bidding_signals);
+    }
+    batch_request
+        .input[BatchArgIndex(GenerateBidsBatchArgs::kInterestGroups)] =
+        std::move(interest_groups);
+    batch_requests.push_back(std::move(batch_request));
+  }
+  return batch_requests;
+}
+
+// Returns the "response" object of one generateBidEntryFunction output, after
+// logging the AdTech logs it holds. The object stays in the output, so that
+// the bid is parsed from it rather than from a copy serialized and parsed
+// again.
+absl::StatusOr<rapidjson::Value*> ExtractGenerateBidResponse(
+    bool enable_adtech_code_logging, rapidjson::Value& document,
     const ContextLogger& logger) {
-  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(response));
-  rapidjson::Value& response_obj = document["response"];
-  std::string response_json;
-  PS_ASSIGN_OR_RETURN(response_json, SerializeJsonDoc(response_obj));
+  if (!document.IsObject()) {
+    return absl::InvalidArgumentError("generateBid output is not an object");
+  }
+  auto response_itr = document.FindMember("response");
+  if (response_itr == document.MemberEnd()) {
+    return absl::InvalidArgumentError("generateBid output has no response");
+  }
   if (enable_adtech_code_logging) {
     const rapidjson::Value& logs = document["logs"];
     for (const auto& log : logs.GetArray()) {
@@ -411,11 +576,382 @@ absl::StatusOr<std::string> ParseAndGetGenerateBidResponseJson(
       logger.vlog(1, "Errors: ", error.GetString());
     }
   }
-  return response_json;
+  return &response_itr->value;
+}
+
+// Returns the generateBid() response of each of the `batch_size` IGs in the
+// generateBidsBatchEntryFunction() output, in order.
+absl::StatusOr<std::vector<absl::StatusOr<rapidjson::Value*>>>
+ExtractGenerateBidsBatchResponses(bool enable_adtech_code_logging,
+                                  rapidjson::Value& document,
+                                  size_t batch_size,
+                                  const ContextLogger& logger) {
+  if (!document.IsArray() || document.Size() != batch_size) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Expected an array of ", batch_size, " generateBid outputs in batch"));
+  }
+  std::vector<absl::StatusOr<rapidjson::Value*>> ig_responses;
+  ig_responses.reserve(batch_size);
+  for (auto& ig_output : document.GetArray()) {
+    if (!ig_output.IsObject() || !ig_output.HasMember("response")) {
+      ig_responses.push_back(
+          absl::InvalidArgumentError("Malformed generateBid output in batch"));
+      continue;
+    }
+    ig_responses.push_back(ExtractGenerateBidResponse(
+        enable_adtech_code_logging, ig_output, logger));
+  }
+  return ig_responses;
+}
+
+// The bid of one IG parsed from a dispatch response.
+struct ParsedBid {
+  // Empty when the dispatch request failed.
+  absl::string_view interest_group_name;
+  // Unset for zero and invalid bids.
+  std::optional<AdWithBid> bid;
+  // Time the generateBid() call of the IG took, if the output has it.
+  std::optional<absl::Duration> execution_time;
+};
+
+// Returns the time the code wrapper measured for the generateBid() call of
+// one generateBidEntryFunction output, if any.
+std::optional<absl::Duration> ExecutionTimeOf(const rapidjson::Value& output) {
+  if (!output.IsObject()) {
+    return std::nullopt;
+  }
+  auto itr = output.FindMember(kGenerateBidExecutionTimeMs);
+  if (itr == output.MemberEnd() || !itr->value.IsNumber()) {
+    return std::nullopt;
+  }
+  return absl::Milliseconds(itr->value.GetDouble());
+}
+
+// Converts a JSON value into a google.protobuf.Value.
+void ToProtoValue(const rapidjson::Value& json,
+                  google::protobuf::Value& value) {
+  switch (json.GetType()) {
+    case rapidjson::kNullType:
+      value.set_null_value(google::protobuf::NULL_VALUE);
+      break;
+    case rapidjson::kFalseType:
+    case rapidjson::kTrueType:
+      value.set_bool_value(json.GetBool());
+      break;
+    case rapidjson::kNumberType:
+      value.set_number_value(json.GetDouble());
+      break;
+    case rapidjson::kStringType:
+      value.set_string_value(json.GetString(), json.GetStringLength());
+      break;
+    case rapidjson::kArrayType: {
+      google::protobuf::ListValue& list = *value.mutable_list_value();
+      for (const rapidjson::Value& element : json.GetArray()) {
+        ToProtoValue(element, *list.add_values());
+      }
+      break;
+    }
+    case rapidjson::kObjectType: {
+      auto& fields = *value.mutable_struct_value()->mutable_fields();
+      for (const auto& member : json.GetObject()) {
+        ToProtoValue(member.value,
+                     fields[std::string(member.name.GetString(),
+                                        member.name.GetStringLength())]);
+      }
+      break;
+    }
+  }
+}
+
+// Whether name is the JSON name of a field, or its original name.
+bool IsField(absl::string_view name, absl::string_view json_name,
+             absl::string_view field_name) {
+  return name == json_name || name == field_name;
+}
+
+// Sets the fields of bid from the members of the generateBid() response,
+// without serializing it into a JSON string parsed again by
+// JsonStringToMessage. Returns false if a member is not a field of AdWithBid
+// or does not have the type of its field, for JsonStringToMessage to handle
+// the response as it always did.
+bool SetBidFields(const rapidjson::Value& response, AdWithBid& bid) {
+  for (const auto& member : response.GetObject()) {
+    const absl::string_view name(member.name.GetString(),
+                                 member.name.GetStringLength());
+    const rapidjson::Value& value = member.value;
+    if (name == "ad") {
+      ToProtoValue(value, *bid.mutable_ad());
+    } else if (name == "bid") {
+      if (!value.IsNumber() ||
+          std::abs(value.GetDouble()) > std::numeric_limits<float>::max()) {
+        return false;
+      }
+      bid.set_bid(static_cast<float>(value.GetDouble()));
+    } else if (name == "render") {
+      if (!value.IsString()) {
+        return false;
+      }
+      bid.set_render(value.GetString(), value.GetStringLength());
+    } else if (IsField(name, "adComponents", "ad_components")) {
+      if (!value.IsArray()) {
+        return false;
+      }
+      for (const rapidjson::Value& component : value.GetArray()) {
+        if (!component.IsString()) {
+          return false;
+        }
+        bid.add_ad_components(component.GetString(),
+                              component.GetStringLength());
+      }
+    } else if (IsField(name, "allowComponentAuction",
+                       "allow_component_auction")) {
+      if (!value.IsBool()) {
+        return false;
+      }
+      bid.set_allow_component_auction(value.GetBool());
+    } else if (IsField(name, "interestGroupName", "interest_group_name")) {
+      if (!value.IsString()) {
+        return false;
+      }
+      bid.set_interest_group_name(value.GetString(), value.GetStringLength());
+    } else if (IsField(name, "adCost", "ad_cost")) {
+      if (!value.IsNumber()) {
+        return false;
+      }
+      bid.set_ad_cost(value.GetDouble());
+    } else if (IsField(name, "modelingSignals", "modeling_signals")) {
+      if (!value.IsInt()) {
+        return false;
+      }
+      bid.set_modeling_signals(value.GetInt());
+    } else if (IsField(name, "bidCurrency", "bid_currency")) {
+      if (!value.IsString()) {
+        return false;
+      }
+      bid.set_bid_currency(value.GetString(), value.GetStringLength());
+    } else if (IsField(name, "adMetadataJson", "ad_metadata_json")) {
+      if (!value.IsString()) {
+        return false;
+      }
+      bid.set_ad_metadata_json(value.GetString(), value.GetStringLength());
+    } else if (IsField(name, "debugReportUrls", "debug_report_urls")) {
+      if (!value.IsObject()) {
+        return false;
+      }
+      DebugReportUrls& urls = *bid.mutable_debug_report_urls();
+      for (const auto& url : value.GetObject()) {
+        const absl::string_view url_name(url.name.GetString(),
+                                         url.name.GetStringLength());
+        if (!url.value.IsString()) {
+          return false;
+        }
+        if (IsField(url_name, "auctionDebugWinUrl", "auction_debug_win_url")) {
+          urls.set_auction_debug_win_url(url.value.GetString(),
+                                         url.value.GetStringLength());
+        } else if (IsField(url_name, "auctionDebugLossUrl",
+                           "auction_debug_loss_url")) {
+          urls.set_auction_debug_loss_url(url.value.GetString(),
+                                          url.value.GetStringLength());
+        } else {
+          return false;
+        }
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Parses the generateBid() response into bid. If emit_ad_metadata_json is
+// set, the ad is serialized into ad_metadata_json instead of being converted
+// into a google.protobuf.Value, and removed from the response.
+absl::Status ParseGenerateBidResponse(rapidjson::Value& response,
+                                      bool emit_ad_metadata_json,
+                                      AdWithBid& bid) {
+  if (!response.IsObject()) {
+    return absl::InvalidArgumentError("generateBid output is not an object");
+  }
+  std::string ad_metadata_json;
+  if (emit_ad_metadata_json) {
+    if (auto ad_itr = response.FindMember("ad");
+        ad_itr != response.MemberEnd()) {
+      PS_ASSIGN_OR_RETURN(ad_metadata_json, SerializeJsonDoc(ad_itr->value));
+      response.RemoveMember(ad_itr);
+    }
+  }
+  if (!SetBidFields(response, bid)) {
+    bid.Clear();
+    PS_ASSIGN_OR_RETURN(std::string bid_json, SerializeJsonDoc(response));
+    PS_RETURN_IF_ERROR(
+        google::protobuf::util::JsonStringToMessage(bid_json, &bid));
+  }
+  if (emit_ad_metadata_json && !ad_metadata_json.empty()) {
+    bid.set_ad_metadata_json(std::move(ad_metadata_json));
+  }
+  return absl::OkStatus();
+}
+
+// Parses the generateBid() response of an IG into a bid with a positive bid
+// price or debug report URLs.
+std::optional<AdWithBid> ParseBid(
+    absl::string_view interest_group_name,
+    const absl::StatusOr<rapidjson::Value*>& generate_bid_response,
+    bool emit_ad_metadata_json, const ContextLogger& logger) {
+  AdWithBid bid;
+  if (!generate_bid_response.ok()) {
+    logger.vlog(0, "Failed to parse response from Roma ",
+                generate_bid_response.status().ToString(
+                    absl::StatusToStringMode::kWithEverything));
+    return std::nullopt;
+  }
+  rapidjson::Value& response = **generate_bid_response;
+  if (absl::Status valid =
+          ParseGenerateBidResponse(response, emit_ad_metadata_json, bid);
+      !valid.ok()) {
+    logger.vlog(1,
+                "Invalid json output from code execution for interest_group ",
+                interest_group_name, ": ",
+                SerializeJsonDoc(response).value_or(""));
+    return std::nullopt;
+  }
+  if (bid.bid() == 0.0f && !bid.has_debug_report_urls()) {
+    logger.vlog(2, "Skipping 0 bid for ", interest_group_name, ": ",
+                DebugStringOf(bid));
+    return std::nullopt;
+  }
+  bid.set_interest_group_name(interest_group_name);
+  return bid;
+}
+
+// Parses one dispatch response into the bid of each IG it holds. Batch
+// dispatch responses hold the bids of all the IGs in batched_ig_names, and a
+// failed execution is returned as one bid without a name.
+std::vector<ParsedBid> ParseDispatchResponse(
+    const absl::StatusOr<DispatchResponse>& result,
+    const absl::flat_hash_map<std::string, std::vector<std::string>>&
+        batched_ig_names,
+    bool enable_adtech_code_logging, bool emit_ad_metadata_json,
+    const ContextLogger& logger) {
+  if (!result.ok()) {
+    logger.vlog(
+        1, "Invalid execution (possibly invalid input): ",
+        result.status().ToString(absl::StatusToStringMode::kWithEverything));
+    return {ParsedBid{}};
+  }
+  // The bids are parsed from the values of this document.
+  absl::StatusOr<rapidjson::Document> document = ParseJsonString(result->resp);
+  auto batch_itr = batched_ig_names.find(result->id);
+  if (batch_itr == batched_ig_names.end()) {
+    absl::StatusOr<rapidjson::Value*> response =
+        document.ok() ? ExtractGenerateBidResponse(enable_adtech_code_logging,
+                                                   *document, logger)
+                      : document.status();
+    return {ParsedBid{
+        .interest_group_name = result->id,
+        .bid = ParseBid(result->id, response, emit_ad_metadata_json, logger),
+        .execution_time = document.ok() ? ExecutionTimeOf(*document)
+                                        : std::nullopt}};
+  }
+  absl::StatusOr<std::vector<absl::StatusOr<rapidjson::Value*>>>
+      batch_responses =
+          document.ok() ? ExtractGenerateBidsBatchResponses(
+                              enable_adtech_code_logging, *document,
+                              batch_itr->second.size(), logger)
+                        : document.status();
+  std::vector<ParsedBid> parsed_bids;
+  parsed_bids.reserve(batch_itr->second.size());
+  for (int i = 0; i < batch_itr->second.size(); i++) {
+    absl::string_view interest_group_name = batch_itr->second[i];
+    parsed_bids.push_back(
+        {.interest_group_name = interest_group_name,
+         .bid = batch_responses.ok()
+                    ? ParseBid(interest_group_name, (*batch_responses)[i],
+                               emit_ad_metadata_json, logger)
+                    : ParseBid(interest_group_name, batch_responses.status(),
+                               emit_ad_metadata_json, logger),
+         .execution_time = batch_responses.ok()
+                               ? ExecutionTimeOf((*document)[i])
+                               : std::nullopt});
+  }
+  return parsed_bids;
+}
+
+// Runs fn(i) for every i in [0, size) on the calling thread and on up to
+// num_workers - 1 closures run by executor. Indices are handed out one at a
+// time, so that a slow response does not hold up a whole chunk. The calling
+// thread takes the indices the closures have not started on, so it only waits
+// for the ones running, never for a busy executor to get to the closures.
+template <typename Fn>
+void ParallelFor(int size, int num_workers, server_common::Executor& executor,
+                 const Fn& fn) {
+  if (size <= 0) {
+    return;
+  }
+  // Shared with the closures, which may start after the call returns, once
+  // every index is taken.
+  struct State {
+    std::atomic<int> next_index = 0;
+    std::atomic<int> done = 0;
+    absl::Notification all_done;
+  };
+  auto state = std::make_shared<State>();
+  auto worker = [state, size, &fn]() {
+    for (int i = state->next_index++; i < size; i = state->next_index++) {
+      fn(i);
+      if (++state->done == size) {
+        state->all_done.Notify();
+      }
+    }
+  };
+  for (int i = 1; i < std::min(num_workers, size); i++) {
+    executor.Run(worker);
+  }
+  worker();
+  state->all_done.WaitForNotification();
 }
 
 }  // namespace
 
+std::vector<DispatchRequest> MakeGenerateBidWarmUpRequests(int num_requests) {
+  DispatchRequest warm_up_request;
+  warm_up_request.version_num = 1;
+  warm_up_request.handler_name = kDispatchHandlerFunctionNameWithCodeWrapper;
+  warm_up_request.input = {
+      std::make_shared<std::string>(
+          R"JSON({"name":"warm_up","adRenderIds":["warm_up"]})JSON"),
+      std::make_shared<std::string>("{}"), std::make_shared<std::string>("{}"),
+      std::make_shared<std::string>("{}"),
+      std::make_shared<std::string>(
+          R"JSON({"joinCount":0,"bidCount":0,"recency":0,"prevWins":[]})JSON"),
+      std::make_shared<std::string>(
+          GetFeatureFlagJson(/*enable_logging=*/false,
+                             /*enable_debug_url_generation=*/false))};
+  std::vector<DispatchRequest> warm_up_requests;
+  warm_up_requests.reserve(num_requests);
+  for (int i = 0; i < num_requests; i++) {
+    warm_up_request.id = absl::StrCat("warm_up_", i);
+    warm_up_requests.push_back(warm_up_request);
+  }
+  return warm_up_requests;
+}
+
+ObjectPool<GenerateBidsReactor::BatchedIgNames>&
+GenerateBidsReactor::BatchedIgNamesPool() {
+  static auto* pool = new ObjectPool<BatchedIgNames>(
+      kReactorStatePoolMaxIdle, [](BatchedIgNames& batched_ig_names) {
+        if (batched_ig_names.bucket_count() > kMaxPooledContainerSize) {
+          batched_ig_names = BatchedIgNames();
+          return;
+        }
+        // Erasing keeps the capacity of the map, which clear() frees when it
+        // is large.
+        batched_ig_names.erase(batched_ig_names.begin(),
+                               batched_ig_names.end());
+      });
+  return *pool;
+}
+
 GenerateBidsReactor::GenerateBidsReactor(
     const CodeDispatchClient& dispatcher, const GenerateBidsRequest* request,
     GenerateBidsResponse* response,
@@ -427,12 +963,35 @@ GenerateBidsReactor::GenerateBidsReactor(
           GenerateBidsRequest, GenerateBidsRequest::GenerateBidsRawRequest,
           GenerateBidsResponse, GenerateBidsResponse::GenerateBidsRawResponse>(
           dispatcher, request, response, key_fetcher_manager, crypto_client,
-          runtime_config.encryption_enabled),
+          runtime_config.encryption_enabled, runtime_config.crypto_worker_pool),
       benchmarking_logger_(std::move(benchmarking_logger)),
       enable_buyer_debug_url_generation_(
           runtime_config.enable_buyer_debug_url_generation),
       enable_adtech_code_logging_(runtime_config.enable_adtech_code_logging),
-      roma_timeout_ms_(runtime_config.roma_timeout_ms) {
+      roma_timeout_ms_(runtime_config.roma_timeout_ms),
+      consented_debug_token_(runtime_config.consented_debug_token),
+      generate_bids_batch_size_(runtime_config.generate_bids_batch_size),
+      share_batch_trusted_bidding_signals_(
+          runtime_config.share_batch_trusted_bidding_signals),
+      use_on_demand_json_parser_(runtime_config.use_on_demand_json_parser),
+      emit_ad_metadata_json_(runtime_config.emit_ad_metadata_json),
+      parallel_response_parsing_threshold_(
+          runtime_config.parallel_response_parsing_threshold),
+      response_parsing_executor_(runtime_config.response_parsing_executor),
+      dispatch_queue_capacity_(runtime_config.dispatch_queue_capacity),
+      max_ads_per_interest_group_(runtime_config.max_ads_per_interest_group),
+      max_ad_components_per_interest_group_(
+          runtime_config.max_ad_components_per_interest_group),
+      max_generate_bid_input_bytes_(
+          runtime_config.max_generate_bid_input_bytes),
+      roma_timeout_response_margin_(absl::Milliseconds(
+          runtime_config.roma_timeout_response_margin_ms)),
+      signal_blob_cache_(runtime_config.signal_blob_cache),
+      cost_estimator_(runtime_config.interest_group_cost_estimator) {
+  if (int64_t roma_timeout_ms;
+      absl::SimpleAtoi(roma_timeout_ms_, &roma_timeout_ms)) {
+    static_roma_timeout_ = absl::Milliseconds(roma_timeout_ms);
+  }
   CHECK_OK([this]() {
     PS_ASSIGN_OR_RETURN(metric_context_,
                         metric::BiddingContextMap()->Remove(request_));
@@ -440,67 +999,301 @@ GenerateBidsReactor::GenerateBidsReactor(
   }()) << "BiddingContextMap()->Get(request) should have been called";
 }
 
+void GenerateBidsReactor::SetDeadline(absl::Time deadline) {
+  deadline_ = deadline;
+}
+
+absl::Duration GenerateBidsReactor::GetRomaTimeout() const {
+  if (deadline_ == absl::InfiniteFuture()) {
+    return static_roma_timeout_;
+  }
+  return std::min(static_roma_timeout_, deadline_ - absl::Now() -
+                                            roma_timeout_response_margin_);
+}
+
+void GenerateBidsReactor::ShedDispatchRequestsOverCapacity() {
+  const int64_t igs_per_request = std::max(1, generate_bids_batch_size_);
+  // At least one request is dispatched, so that some bids are still generated
+  // while the queue drains.
+  const int64_t free_requests = std::max<int64_t>(
+      1, dispatch_queue_capacity_ - dispatcher_.PendingRequests());
+  const int64_t admitted_igs = free_requests * igs_per_request;
+  if (dispatch_requests_.size() <= admitted_igs) {
+    return;
+  }
+  // IGs that bid the most often are kept, and pathological ones shed first.
+  absl::flat_hash_map<absl::string_view, int64_t> bid_counts;
+  for (const auto& interest_group : raw_request_.interest_group_for_bidding()) {
+    bid_counts.try_emplace(interest_group.name(),
+                           interest_group.browser_signals().bid_count());
+  }
+  absl::flat_hash_set<absl::string_view> pathological;
+  if (cost_estimator_ != nullptr) {
+    std::vector<absl::string_view> ig_names;
+    ig_names.reserve(dispatch_requests_.size());
+    for (const DispatchRequest& dispatch_request : dispatch_requests_) {
+      ig_names.push_back(dispatch_request.id);
+    }
+    pathological = cost_estimator_->Pathological(ig_names);
+  }
+  std::stable_sort(
+      dispatch_requests_.begin(), dispatch_requests_.end(),
+      [&bid_counts, &pathological](const DispatchRequest& lhs,
+                                   const DispatchRequest& rhs) {
+        const bool lhs_pathological = pathological.contains(lhs.id);
+        if (lhs_pathological != pathological.contains(rhs.id)) {
+          return !lhs_pathological;
+        }
+        return bid_counts[lhs.id] > bid_counts[rhs.id];
+      });
+  const int64_t shed_igs = dispatch_requests_.size() - admitted_igs;
+  dispatch_requests_.resize(admitted_igs);
+  logger_.vlog(1, "Dispatcher queue is full, shedding ", shed_igs,
+               " interest groups");
+  LogIfError(
+      metric_context_->AccumulateMetric<metric::kBiddingShedInterestGroupCount>(
+          shed_igs));
+}
+
+void GenerateBidsReactor::TruncateInterestGroupAds() {
+  // Truncates ids to the first limit ones, returning how many were dropped.
+  auto truncate = [](int limit,
+                     google::protobuf::RepeatedPtrField<std::string>* ids) {
+    if (limit <= 0 || ids->size() <= limit) {
+      return 0;
+    }
+    const int dropped = ids->size() - limit;
+    ids->DeleteSubrange(limit, dropped);
+    return dropped;
+  };
+  int dropped_ads = 0;
+  int dropped_ad_components = 0;
+  for (auto& interest_group :
+       *raw_request_.mutable_interest_group_for_bidding()) {
+    dropped_ads += truncate(max_ads_per_interest_group_,
+                            interest_group.mutable_ad_render_ids());
+    dropped_ad_components +=
+        truncate(max_ad_components_per_interest_group_,
+                 interest_group.mutable_ad_component_render_ids());
+  }
+  if (dropped_ads > 0) {
+    logger_.vlog(1, "Dropped ", dropped_ads,
+                 " ads past the limit of the interest groups");
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kBiddingTruncatedCount>(
+            dropped_ads, "ads"));
+  }
+  if (dropped_ad_components > 0) {
+    logger_.vlog(1, "Dropped ", dropped_ad_components,
+                 " ad components past the limit of the interest groups");
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kBiddingTruncatedCount>(
+            dropped_ad_components, "ad_components"));
+  }
+}
+
 void GenerateBidsReactor::Execute() {
+  absl::Time start_build_input_time = absl::Now();
+  const absl::Duration start_build_input_cpu = ThreadCpuTime();
   benchmarking_logger_->BuildInputBegin();
   logger_ = ContextLogger(GetLoggingContext(raw_request_));
-  auto interest_groups = raw_request_.interest_group_for_bidding();
+  if (max_ads_per_interest_group_ > 0 ||
+      max_ad_components_per_interest_group_ > 0) {
+    TruncateInterestGroupAds();
+  }
+  const auto& interest_groups = raw_request_.interest_group_for_bidding();
 
   // Parse trusted bidding signals
-  absl::StatusOr<TrustedBiddingSignalsByIg> ig_trusted_signals_map =
-      SerializeTrustedBiddingSignalsPerIG(raw_request_, logger_);
-  if (!ig_trusted_signals_map.ok()) {
+  absl::StatusOr<TrustedBiddingSignalsIndex> bidding_signals_index =
+      IndexRequestTrustedBiddingSignals(raw_request_,
+                                        use_on_demand_json_parser_, logger_);
+  if (!bidding_signals_index.ok()) {
     logger_.vlog(0, "Request failed while parsing bidding signals: ",
-                 ig_trusted_signals_map.status().ToString(
+                 bidding_signals_index.status().ToString(
                      absl::StatusToStringMode::kWithEverything));
-    EncryptResponseAndFinish(FromAbslStatus(ig_trusted_signals_map.status()));
+    EncryptResponseAndFinish(FromAbslStatus(bidding_signals_index.status()));
     return;
   }
+  const bool share_batch_trusted_bidding_signals =
+      generate_bids_batch_size_ > 1 && share_batch_trusted_bidding_signals_;
+  const TrustedBiddingSignalsByIg ig_trusted_signals_map =
+      SerializeTrustedBiddingSignalsPerIG(
+          raw_request_, *bidding_signals_index,
+          /*keys_only=*/share_batch_trusted_bidding_signals);
+  benchmarking_logger_->ParseSignalsEnd();
 
   // Build base input.
   std::vector<std::shared_ptr<std::string>> base_input =
-      BuildBaseInput(raw_request_);
-  for (int i = 0; i < interest_groups.size(); i++) {
-    absl::StatusOr<DispatchRequest> generate_bid_request =
-        BuildGenerateBidRequest(interest_groups.at(i), raw_request_, base_input,
-                                ig_trusted_signals_map.value(),
-                                enable_buyer_debug_url_generation_, logger_,
-                                enable_adtech_code_logging_);
-    if (!generate_bid_request.ok()) {
-      if (VLOG_IS_ON(3)) {
-        logger_.vlog(3, "Unable to build GenerateBidRequest: ",
-                     generate_bid_request.status().ToString(
-                         absl::StatusToStringMode::kWithEverything));
+      BuildBaseInput(raw_request_, enable_buyer_debug_url_generation_,
+                     enable_adtech_code_logging_, signal_blob_cache_);
+  const std::string browser_signals_prefix = MakeBrowserSignalsJsonPrefix(
+      raw_request_.publisher_name(), raw_request_.seller());
+  // Under the input bytes limit, the IGs the cost estimator finds
+  // pathological come last, so that they are the ones left out.
+  std::vector<int> ig_order(interest_groups.size());
+  std::iota(ig_order.begin(), ig_order.end(), 0);
+  if (cost_estimator_ != nullptr && max_generate_bid_input_bytes_ > 0) {
+    std::vector<absl::string_view> ig_names;
+    ig_names.reserve(interest_groups.size());
+    for (const auto& interest_group : interest_groups) {
+      ig_names.push_back(interest_group.name());
+    }
+    const absl::flat_hash_set<absl::string_view> pathological =
+        cost_estimator_->Pathological(ig_names);
+    std::stable_partition(ig_order.begin(), ig_order.end(),
+                          [&interest_groups, &pathological](int i) {
+                            return !pathological.contains(
+                                interest_groups.at(i).name());
+                          });
+  }
+  int64_t input_bytes = 0;
+  bool deadline_reached = false;
+  int igs_over_input_limit = 0;
+  int igs_over_memory_budget = 0;
+  const int features =
+      FeatureIf(VLOG_IS_ON(2), kLogGenerateBidInputs) |
+      FeatureIf(max_generate_bid_input_bytes_ > 0,
+                kLimitGenerateBidInputBytes) |
+      FeatureIf(memory_budget_.enabled(), kChargeMemoryBudget);
+  WithFeatureSet<kNumGenerateBidFeatures>(features, [&](auto feature_set) {
+    constexpr int kFeatures = decltype(feature_set)::value;
+    for (int i = 0; i < interest_groups.size(); i++) {
+      if (GetRomaTimeout() <= absl::ZeroDuration()) {
+        logger_.vlog(1, "Request deadline reached, skipping the remaining ",
+                     interest_groups.size() - i, " interest groups");
+        deadline_reached = true;
+        break;
       }
-    } else {
-      auto dispatch_request = generate_bid_request.value();
-      dispatch_request.tags[kRomaTimeoutMs] = roma_timeout_ms_;
-      dispatch_requests_.push_back(dispatch_request);
+      absl::StatusOr<DispatchRequest> generate_bid_request =
+          BuildGenerateBidRequest<(kFeatures & kLogGenerateBidInputs) != 0>(
+              interest_groups.at(ig_order[i]), base_input,
+              ig_trusted_signals_map, browser_signals_prefix, logger_);
+      if (!generate_bid_request.ok()) {
+        if (VLOG_IS_ON(3)) {
+          logger_.vlog(3, "Unable to build GenerateBidRequest: ",
+                       generate_bid_request.status().ToString(
+                           absl::StatusToStringMode::kWithEverything));
+        }
+        continue;
+      }
+      if constexpr ((kFeatures & kLimitGenerateBidInputBytes) != 0) {
+        const int64_t request_bytes = InputBytes(*generate_bid_request);
+        if (input_bytes + request_bytes > max_generate_bid_input_bytes_) {
+          ++igs_over_input_limit;
+          continue;
+        }
+        input_bytes += request_bytes;
+      }
+      if constexpr ((kFeatures & kChargeMemoryBudget) != 0) {
+        if (!memory_budget_.TryCharge(
+                OwnInputBytes(*generate_bid_request, base_input))) {
+          ++igs_over_memory_budget;
+          continue;
+        }
+      }
+      dispatch_requests_.push_back(*std::move(generate_bid_request));
     }
+  });
+  if (igs_over_memory_budget > 0) {
+    logger_.vlog(1, "generateBid arguments over the memory budget of the ",
+                 "request, skipping ", igs_over_memory_budget,
+                 " interest groups");
+    RecordMemoryBudgetExceeded(MemoryBudgetAction::kTrimmed);
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kBiddingTruncatedCount>(
+            igs_over_memory_budget, "interest_groups"));
+  }
+  if (igs_over_input_limit > 0) {
+    logger_.vlog(1, "generateBid arguments over ",
+                 max_generate_bid_input_bytes_, " bytes, skipping ",
+                 igs_over_input_limit, " interest groups");
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kBiddingTruncatedCount>(
+            igs_over_input_limit, "interest_groups"));
   }
 
+  // A request whose interest groups the deadline cut short fails, rather
+  // than returning the bids of the ones it got to as if they were all.
+  absl::Duration roma_timeout = GetRomaTimeout();
+  if (deadline_reached || (!dispatch_requests_.empty() &&
+                           roma_timeout <= absl::ZeroDuration())) {
+    logger_.vlog(1, "Request deadline reached before dispatching bids");
+    EncryptResponseAndFinish(grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED,
+                                          kDeadlineExceededBeforeDispatch));
+    return;
+  }
   if (dispatch_requests_.empty()) {
     EncryptResponseAndFinish(grpc::Status::OK);
     return;
   }
+  // Every request is dispatched at once, so they all get the same timeout.
+  const std::string roma_timeout_ms =
+      roma_timeout == absl::InfiniteDuration()
+          ? roma_timeout_ms_
+          : absl::StrCat(std::max<int64_t>(
+                1, absl::ToInt64Milliseconds(roma_timeout)));
+  for (auto& dispatch_request : dispatch_requests_) {
+    dispatch_request.tags[kRomaTimeoutMs] = roma_timeout_ms;
+    AddRequestClassTag(dispatch_request);
+  }
+  if (dispatch_queue_capacity_ > 0) {
+    ShedDispatchRequestsOverCapacity();
+  }
+  if (generate_bids_batch_size_ > 1) {
+    dispatch_requests_ = BuildGenerateBidsBatchRequests(
+        std::move(dispatch_requests_), generate_bids_batch_size_,
+        share_batch_trusted_bidding_signals ? &*bidding_signals_index
+                                            : nullptr,
+        ig_trusted_signals_map, batched_ig_names_);
+  }
 
   benchmarking_logger_->BuildInputEnd();
   absl::Time start_js_execution_time = absl::Now();
-  auto status = dispatcher_.BatchExecute(
-      dispatch_requests_,
+  LogIfError(metric_context_->LogHistogram<metric::kBiddingBuildInputDuration>(
+      (start_js_execution_time - start_build_input_time) /
+      absl::Microseconds(1)));
+  cpu_time_.AddSince(CpuStage::kPrepare, start_build_input_cpu);
+  // Bids that cannot start before the Roma timeout are not dispatched at all.
+  auto status = dispatcher_.TryBatchExecute(
+      dispatch_requests_, roma_timeout,
       [this, start_js_execution_time](
           const std::vector<absl::StatusOr<DispatchResponse>>& result) {
-        int js_execution_time_ms =
-            (absl::Now() - start_js_execution_time) / absl::Milliseconds(1);
+        absl::Duration js_execution_time =
+            absl::Now() - start_js_execution_time;
+        tracer_.AddSpan("DispatchToRoma", start_js_execution_time,
+                        absl::Now());
+        timeline_.Record(RequestStage::kDispatch, start_js_execution_time,
+                         start_js_execution_time + js_execution_time);
         LogIfError(metric_context_->LogHistogram<metric::kJSExecutionDuration>(
-            js_execution_time_ms));
+            js_execution_time / absl::Milliseconds(1)));
+        LogIfError(
+            metric_context_->LogHistogram<metric::kBiddingDispatchDuration>(
+                js_execution_time / absl::Microseconds(1)));
+        cpu_time_.AddDispatchWallTime(js_execution_time);
         GenerateBidsCallback(result);
         EncryptResponseAndFinish(grpc::Status::OK);
-      });
+      },
+      &cancellation_);
 
+  if (absl::IsResourceExhausted(status)) {
+    logger_.vlog(1, "Dispatcher is overloaded, rejecting ",
+                 dispatch_requests_.size(), " requests");
+    EncryptResponseAndFinish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                          std::string(status.message())));
+    return;
+  }
+  if (absl::IsCancelled(status)) {
+    logger_.vlog(1, "Request cancelled before dispatch");
+    Finish(grpc::Status(grpc::StatusCode::CANCELLED,
+                        std::string(status.message())));
+    return;
+  }
   if (!status.ok()) {
-    std::string original_request;
-    TextFormat::PrintToString(raw_request_, &original_request);
-    logger_.vlog(1, "Execution request failed for batch: ", original_request,
+    logger_.vlog(1, "Execution request failed for batch: ",
+                 LazyFormat([this]() {
+                   return DescribeRequestForErrorLog(raw_request_,
+                                                     consented_debug_token_);
+                 }),
                  status.ToString(absl::StatusToStringMode::kWithEverything));
     LogIfError(
         metric_context_->LogUpDownCounter<metric::kJSExecutionErrorCount>(1));
@@ -524,72 +1317,90 @@ void GenerateBidsReactor::GenerateBidsCallback(
       }
     }
   }
+  absl::Time start_handle_response_time = absl::Now();
+  const absl::Duration start_handle_response_cpu = ThreadCpuTime();
   benchmarking_logger_->HandleResponseBegin();
-  int total_bid_count = static_cast<int>(output.size());
-  int zero_bid_count = 0;
-  LogIfError(metric_context_->AccumulateMetric<metric::kBiddingTotalBidsCount>(
-      total_bid_count));
+  // Responses are parsed into per response slots, and merged in order below.
+  std::vector<std::vector<ParsedBid>> parsed_responses(output.size());
+  auto parse_response = [this, &output, &parsed_responses](int i) {
+    parsed_responses[i] =
+        ParseDispatchResponse(output[i], batched_ig_names_,
+                              enable_adtech_code_logging_,
+                              emit_ad_metadata_json_, logger_);
+  };
+  if (response_parsing_executor_ != nullptr &&
+      parallel_response_parsing_threshold_ > 0 &&
+      output.size() >= parallel_response_parsing_threshold_) {
+    ParallelFor(output.size(), kResponseParsingWorkers,
+                *response_parsing_executor_, parse_response);
+  } else {
+    for (int i = 0; i < output.size(); i++) {
+      parse_response(i);
+    }
+  }
+
   int failed_requests = 0;
-  for (int i = 0; i < output.size(); i++) {
-    auto& result = output.at(i);
-    bool is_bid_zero = true;
-    if (result.ok()) {
-      AdWithBid bid;
-      absl::StatusOr<std::string> generate_bid_response =
-          ParseAndGetGenerateBidResponseJson(enable_adtech_code_logging_,
-                                             result->resp, logger_);
-      if (!generate_bid_response.ok()) {
-        logger_.vlog(0, "Failed to parse response from Roma ",
-                     generate_bid_response.status().ToString(
-                         absl::StatusToStringMode::kWithEverything));
+  int total_bid_count = 0;
+  int zero_bid_count = 0;
+  std::optional<absl::Duration> max_execution_time;
+  for (auto& parsed_bids : parsed_responses) {
+    total_bid_count += parsed_bids.size();
+    for (auto& parsed_bid : parsed_bids) {
+      if (parsed_bid.interest_group_name.empty()) {
+        failed_requests += 1;
       }
-      auto valid = google::protobuf::util::JsonStringToMessage(
-          generate_bid_response.value(), &bid);
-      const std::string interest_group_name = result->id;
-      if (valid.ok()) {
-        if (bid.bid() == 0.0f && !bid.has_debug_report_urls()) {
-          logger_.vlog(2, "Skipping 0 bid for ", interest_group_name, ": ",
-                       bid.DebugString());
-        } else {
-          bid.set_interest_group_name(interest_group_name);
-          *raw_response_.add_bids() = bid;
-          is_bid_zero = false;
+      if (parsed_bid.execution_time.has_value()) {
+        max_execution_time =
+            std::max(max_execution_time.value_or(absl::ZeroDuration()),
+                     *parsed_bid.execution_time);
+        if (cost_estimator_ != nullptr) {
+          cost_estimator_->Record(parsed_bid.interest_group_name,
+                                  *parsed_bid.execution_time);
         }
+      }
+      if (parsed_bid.bid.has_value()) {
+        *raw_response_.add_bids() = *std::move(parsed_bid.bid);
       } else {
-        logger_.vlog(
-            1, "Invalid json output from code execution for interest_group ",
-            interest_group_name, ": ", result->resp);
+        zero_bid_count += 1;
       }
-    } else {
-      failed_requests = failed_requests + 1;
-      logger_.vlog(
-          1, "Invalid execution (possibly invalid input): ",
-          result.status().ToString(absl::StatusToStringMode::kWithEverything));
-    }
-    if (is_bid_zero) {
-      zero_bid_count += 1;
-      LogIfError(
-          metric_context_->AccumulateMetric<metric::kBiddingZeroBidCount>(1));
     }
   }
+  LogIfError(metric_context_->AccumulateMetric<metric::kBiddingTotalBidsCount>(
+      total_bid_count));
+  LogIfError(metric_context_->AccumulateMetric<metric::kBiddingZeroBidCount>(
+      zero_bid_count));
   LogIfError(metric_context_->LogHistogram<metric::kBiddingZeroBidPercent>(
       (static_cast<double>(zero_bid_count)) / total_bid_count));
+  if (max_execution_time.has_value()) {
+    LogIfError(
+        metric_context_->LogHistogram<metric::kBiddingGenerateBidMaxDuration>(
+            *max_execution_time / absl::Milliseconds(1)));
+  }
 
   logger_.vlog(1, "\n\nFailed of total: ", failed_requests, "/", output.size());
   benchmarking_logger_->HandleResponseEnd();
-  logger_.vlog(2, "GenerateBidsResponse:\n", raw_response_.DebugString());
+  LogIfError(
+      metric_context_->LogHistogram<metric::kBiddingHandleResponseDuration>(
+          (absl::Now() - start_handle_response_time) /
+          absl::Microseconds(1)));
+  timeline_.Record(RequestStage::kParse, start_handle_response_time,
+                   absl::Now());
+  cpu_time_.AddSince(CpuStage::kHandleResponse, start_handle_response_cpu);
+  logger_.vlog(2, "GenerateBidsResponse:\n", DebugStringOf(raw_response_));
 }
 
 void GenerateBidsReactor::EncryptResponseAndFinish(grpc::Status status) {
   DCHECK(encryption_enabled_);
-  if (!EncryptResponse()) {
-    logger_.vlog(1, "Failed to encrypt the generate bids response.");
-    status = grpc::Status(grpc::INTERNAL, kInternalServerError);
-  }
-  if (status.error_code() == grpc::StatusCode::OK) {
-    metric_context_->SetRequestSuccessful();
-  }
-  Finish(status);
+  RunEncryption([this, status = std::move(status)]() mutable {
+    if (!EncryptResponse()) {
+      logger_.vlog(1, "Failed to encrypt the generate bids response.");
+      status = grpc::Status(grpc::INTERNAL, kInternalServerError);
+    }
+    if (status.error_code() == grpc::StatusCode::OK) {
+      metric_context_->SetRequestSuccessful();
+    }
+    Finish(status);
+  });
 }
 
 ContextLogger::ContextMap GenerateBidsReactor::GetLoggingContext(
@@ -599,6 +1410,11 @@ ContextLogger::ContextMap GenerateBidsReactor::GetLoggingContext(
           {kAdtechDebugId, logging_context.adtech_debug_id()}};
 }
 
-void GenerateBidsReactor::OnDone() { delete this; }
+void GenerateBidsReactor::OnDone() {
+  LogServerCryptoMetrics(crypto_metrics_, *metric_context_);
+  LogRequestCpuTime(cpu_time_, *metric_context_);
+  ReportTimeline(raw_request_.interest_group_for_bidding_size());
+  delete this;
+}
 
 }  // namespace privacy_sandbox::bidding_auction_servers
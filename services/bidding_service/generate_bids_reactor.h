@@ -22,7 +22,9 @@
 
 #include <grpcpp/grpcpp.h>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
 #include "services/bidding_service/data/runtime_config.h"
@@ -30,9 +32,18 @@
 #include "services/common/code_dispatch/code_dispatch_reactor.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/util/context_logger.h"
+#include "services/common/util/object_pool.h"
+#include "services/common/util/signal_blob_cache.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+inline constexpr char kDeadlineExceededBeforeDispatch[] =
+    "Request deadline reached before generating bids.";
+
+// Returns num_requests generateBidEntryFunction calls with synthetic inputs,
+// executed after a code load to warm up the Roma workers.
+std::vector<DispatchRequest> MakeGenerateBidWarmUpRequests(int num_requests);
+
 //  This is a gRPC reactor that serves a single GenerateBidsRequest.
 //  It stores state relevant to the request and after the
 //  response is finished being served, GenerateBidsReactor cleans up all
@@ -53,6 +64,12 @@ class GenerateBidsReactor
   // Initiate the asynchronous execution of the GenerateBidsRequest.
   void Execute() override;
 
+  // Sets the deadline of the GenerateBids RPC. The Roma timeout of the
+  // dispatch requests is shortened so that bids are generated before it, and
+  // no request is dispatched once it is too close. Must be called before
+  // Execute.
+  void SetDeadline(absl::Time deadline);
+
  private:
   // Cleans up and deletes the GenerateBidsReactor. Called by the grpc library
   // after the response has finished.
@@ -77,14 +94,84 @@ class GenerateBidsReactor
   // status.
   void EncryptResponseAndFinish(grpc::Status status);
 
+  // Returns the Roma timeout of the dispatch requests: the configured timeout,
+  // shortened to the time left before the deadline minus the response margin.
+  // No time is left to dispatch when it is not positive.
+  absl::Duration GetRomaTimeout() const;
+
+  // Drops the lowest priority IGs from dispatch_requests_ when they do not
+  // fit in the free space of the dispatcher queue, instead of letting the
+  // whole batch be rejected. IGs are prioritized by their bid count, after
+  // the IGs the cost estimator finds pathological, if any.
+  void ShedDispatchRequestsOverCapacity();
+
+  // Drops the ads and ad components of the IGs of raw_request_ past the
+  // configured limits.
+  void TruncateInterestGroupAds();
+
   std::unique_ptr<BiddingBenchmarkingLogger> benchmarking_logger_;
   bool enable_buyer_debug_url_generation_;
   std::string roma_timeout_ms_;
+  std::string consented_debug_token_;
   ContextLogger logger_;
   bool enable_adtech_code_logging_;
 
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::BiddingContext> metric_context_;
+
+  // Maximum number of IGs whose bids are generated per
+  // generateBidsBatchEntryFunction dispatch. IGs are dispatched one by one
+  // when this is at most 1.
+  int generate_bids_batch_size_;
+  // Whether the trusted bidding signals of the IGs of a batch are passed once
+  // per batch dispatch.
+  bool share_batch_trusted_bidding_signals_;
+  // Whether the trusted bidding signals are indexed with the on-demand JSON
+  // parser.
+  bool use_on_demand_json_parser_;
+  // Whether the ads of the bids are returned as JSON in ad_metadata_json.
+  bool emit_ad_metadata_json_;
+
+  // Minimum number of dispatch responses parsed on several threads. Responses
+  // are always parsed on the callback thread when this is 0.
+  int parallel_response_parsing_threshold_;
+  // Runs the parsing of the responses beside the callback thread, if any.
+  server_common::Executor* response_parsing_executor_;
+
+  // Number of requests the dispatcher queue holds. IGs are dispatched without
+  // admission control when this is 0.
+  int64_t dispatch_queue_capacity_;
+
+  // Most ads and ad components per IG, and most bytes of generateBid()
+  // arguments per request. No limit when 0.
+  int max_ads_per_interest_group_;
+  int max_ad_components_per_interest_group_;
+  int64_t max_generate_bid_input_bytes_;
+
+  // Names of the IGs of each batch dispatch request, keyed by the id of the
+  // batch request and in the order the batch returns their bids.
+  using BatchedIgNames =
+      absl::flat_hash_map<std::string, std::vector<std::string>>;
+
+  // Returns the pool of the batched IG names of the reactors of the process,
+  // which keep their capacity across requests.
+  static ObjectPool<BatchedIgNames>& BatchedIgNamesPool();
+
+  ObjectPool<BatchedIgNames>::Ptr pooled_batched_ig_names_ =
+      BatchedIgNamesPool().Acquire();
+  BatchedIgNames& batched_ig_names_ = *pooled_batched_ig_names_;
+
+  // Deadline of the RPC, infinite when the client did not set one.
+  absl::Time deadline_ = absl::InfiniteFuture();
+  // roma_timeout_ms_ parsed, infinite when it is not a number.
+  absl::Duration static_roma_timeout_ = absl::InfiniteDuration();
+  // Time kept before the deadline to send the response back.
+  absl::Duration roma_timeout_response_margin_;
+
+  // Not owned. Shared by all reactors, null when the cache is disabled.
+  SignalBlobCache* signal_blob_cache_;
+  // Not owned. Shared by all reactors, null when no IG costs are estimated.
+  InterestGroupCostEstimator* cost_estimator_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,252 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Microbenchmarks for GenerateBidsReactor.
+//
+// Each benchmark runs a GenerateBidsRawRequest of configurable size (interest
+// groups, ads per interest group and bytes of trusted bidding signals per key)
+// through the reactor. Besides the iteration time, the following are exported
+// as counters:
+// - build_input_us: trusted bidding signals parsing and per IG input building.
+// - dispatch_us: the dispatch itself, up to the start of response handling.
+// - handle_response_us: generateBid response parsing.
+// - p50_us and p99_us: percentiles of the end to end request latency.
+// - items_per_second: interest groups processed per second.
+//
+// BM_GenerateBidsWithFakeDispatcher answers every dispatch synchronously with
+// a canned generateBid response, isolating the reactor's own work.
+// BM_GenerateBidsWithRomaDispatcher runs the generateBid script of one of the
+// workloads of services/common/test/utils/js_workloads.h in Roma, selected by
+// the "workload" argument, on signals generated for it. The workload and the
+// version of the corpus are reported as the label.
+//
+// Run with:
+//   bazel run -c opt //services/bidding_service:generate_bids_reactor_benchmarks
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/substitute.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
+#include "services/bidding_service/generate_bids_reactor.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/encryption/pass_through_crypto_client.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/test/utils/benchmark_requests.h"
+#include "services/common/test/utils/js_workloads.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kKeyId[] = "key_id";
+
+// Accumulates the time spent in each phase reported by the reactor.
+struct PhaseDurations {
+  absl::Duration build_input;
+  absl::Duration dispatch;
+  absl::Duration handle_response;
+};
+
+class PhaseTimingLogger : public BiddingBenchmarkingLogger {
+ public:
+  explicit PhaseTimingLogger(PhaseDurations& durations)
+      : durations_(durations) {}
+
+  void Begin() override {}
+  void End() override {}
+
+  void BuildInputBegin() override { phase_start_ = absl::Now(); }
+  void BuildInputEnd() override { durations_.build_input += EndPhase(); }
+  void HandleResponseBegin() override { durations_.dispatch += EndPhase(); }
+  void HandleResponseEnd() override {
+    durations_.handle_response += EndPhase();
+  }
+
+ private:
+  // Returns the time since the previous phase boundary and starts the next
+  // phase.
+  absl::Duration EndPhase() {
+    const absl::Time now = absl::Now();
+    const absl::Duration elapsed = now - phase_start_;
+    phase_start_ = now;
+    return elapsed;
+  }
+
+  PhaseDurations& durations_;
+  absl::Time phase_start_;
+};
+
+// Answers dispatches synchronously with a canned generateBid output, or
+// forwards them to Roma and blocks until the reactor's callback has returned.
+class BenchmarkDispatchClient : public CodeDispatchClient {
+ public:
+  // Dispatches to Roma only if `use_roma` is set.
+  BenchmarkDispatchClient(const V8Dispatcher& dispatcher, bool use_roma)
+      : CodeDispatchClient(dispatcher), use_roma_(use_roma) {}
+
+  absl::Status BatchExecute(
+      std::vector<DispatchRequest>& batch,
+      BatchDispatchDoneCallback batch_callback) const override {
+    if (!use_roma_) {
+      std::vector<absl::StatusOr<DispatchResponse>> responses;
+      responses.reserve(batch.size());
+      for (int i = 0; i < batch.size(); i++) {
+        DispatchResponse response;
+        response.id = batch[i].id;
+        response.resp = absl::Substitute(
+            R"({"response":{"render":"https://ads.com/render?id=$0","bid":$1},"logs":[],"errors":[],"warnings":[]})",
+            i, i + 1);
+        responses.push_back(std::move(response));
+      }
+      batch_callback(responses);
+      return absl::OkStatus();
+    }
+
+    absl::Notification done;
+    absl::Status status = CodeDispatchClient::BatchExecute(
+        batch,
+        [&batch_callback, &done](
+            const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
+          batch_callback(responses);
+          done.Notify();
+        });
+    if (status.ok()) {
+      done.WaitForNotification();
+    }
+    return status;
+  }
+
+ private:
+  const bool use_roma_;
+};
+
+void RunGenerateBids(benchmark::State& state, const CodeDispatchClient& client,
+                     JsWorkload workload) {
+  server_common::TelemetryConfig config_proto;
+  config_proto.set_mode(server_common::TelemetryConfig::PROD);
+  metric::BiddingContextMap(server_common::BuildDependentConfig(config_proto));
+  auto key_fetcher_manager = CreateTestKeyFetcherManager();
+  PassThroughCryptoClient crypto_client;
+  BiddingServiceRuntimeConfig runtime_config = {.encryption_enabled = true};
+
+  GenerateBidsRequest request;
+  request.set_key_id(kKeyId);
+  *request.mutable_request_ciphertext() =
+      MakeBenchmarkGenerateBidsRawRequest(
+          {.num_igs = static_cast<int>(state.range(0)),
+           .num_ads = static_cast<int>(state.range(1)),
+           .user_bidding_signals_workload = workload},
+          state.range(2), workload)
+          .SerializeAsString();
+  PhaseDurations durations;
+  std::vector<absl::Duration> latencies;
+  for (auto _ : state) {
+    const absl::Time start = absl::Now();
+    metric::BiddingContextMap()->Get(&request);
+    GenerateBidsResponse response;
+    GenerateBidsReactor reactor(client, &request, &response,
+                                std::make_unique<PhaseTimingLogger>(durations),
+                                key_fetcher_manager.get(), &crypto_client,
+                                runtime_config);
+    reactor.Execute();
+    benchmark::DoNotOptimize(response);
+    latencies.push_back(absl::Now() - start);
+  }
+
+  const auto per_iteration_us = [&state](absl::Duration duration) {
+    return benchmark::Counter(absl::ToDoubleMicroseconds(duration),
+                              benchmark::Counter::kAvgIterations);
+  };
+  state.counters["build_input_us"] = per_iteration_us(durations.build_input);
+  state.counters["dispatch_us"] = per_iteration_us(durations.dispatch);
+  state.counters["handle_response_us"] =
+      per_iteration_us(durations.handle_response);
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile_us = [&latencies](int percentile) {
+      return absl::ToDoubleMicroseconds(
+          latencies[(latencies.size() - 1) * percentile / 100]);
+    };
+    state.counters["p50_us"] = percentile_us(50);
+    state.counters["p99_us"] = percentile_us(99);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_GenerateBidsWithFakeDispatcher(benchmark::State& state) {
+  V8Dispatcher dispatcher;
+  BenchmarkDispatchClient client(dispatcher, /*use_roma=*/false);
+  RunGenerateBids(state, client, JsWorkload::kLight);
+}
+
+void BM_GenerateBidsWithRomaDispatcher(benchmark::State& state) {
+  V8Dispatcher dispatcher;
+  DispatchConfig config;
+  CHECK(dispatcher.Init(config).ok());
+  const JsWorkload workload = kJsWorkloads[state.range(3)];
+  CHECK(dispatcher.LoadSync(1, GetJsWorkloadBuyerWrappedCode(workload)).ok());
+  state.SetLabel(
+      absl::StrCat(JsWorkloadName(workload), "/v", kJsWorkloadsVersion));
+  BenchmarkDispatchClient client(dispatcher, /*use_roma=*/true);
+  RunGenerateBids(state, client, workload);
+  CHECK(dispatcher.Stop().ok());
+}
+
+// Args: number of interest groups, ads per interest group, bidding signal
+// bytes per key.
+void GenerateBidsArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"igs", "ads", "signal_bytes"});
+  for (int igs : {10, 100, 500}) {
+    for (int ads : {1, 10}) {
+      for (int signal_bytes : {64, 1024}) {
+        benchmark->Args({igs, ads, signal_bytes});
+      }
+    }
+  }
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+// Same as GenerateBidsArguments, followed by the index of the workload in
+// kJsWorkloads.
+void GenerateBidsWithWorkloadArguments(
+    benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"igs", "ads", "signal_bytes", "workload"});
+  for (int igs : {10, 100, 500}) {
+    for (int ads : {1, 10}) {
+      for (int workload = 0; workload < std::size(kJsWorkloads); workload++) {
+        benchmark->Args({igs, ads, /*signal_bytes=*/256, workload});
+      }
+    }
+  }
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK(BM_GenerateBidsWithFakeDispatcher)->Apply(GenerateBidsArguments);
+BENCHMARK(BM_GenerateBidsWithRomaDispatcher)
+    ->Apply(GenerateBidsWithWorkloadArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
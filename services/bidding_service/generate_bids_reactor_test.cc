@@ -20,9 +20,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
 #include "glog/logging.h"
 #include "gmock/gmock.h"
 #include "google/protobuf/text_format.h"
@@ -30,12 +35,17 @@
 #include "gtest/gtest.h"
 #include "services/bidding_service/benchmarking/bidding_benchmarking_logger.h"
 #include "services/bidding_service/benchmarking/bidding_no_op_logger.h"
+#include "services/bidding_service/interest_group_cost_estimator.h"
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/encryption/mock_crypto_client_wrapper.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/test/mocks.h"
 #include "services/common/test/random.h"
+#include "services/common/util/json_on_demand.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
+#include "services/common/util/thread_pool_executor.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -157,14 +167,27 @@ class GenerateBidsReactorTest : public testing::Test {
   void CheckGenerateBids(const RawRequest& raw_request,
                          Response expected_response,
                          bool enable_buyer_debug_url_generation = false,
-                         bool enable_adtech_code_logging = false) {
+                         bool enable_adtech_code_logging = false,
+                         int generate_bids_batch_size = 0,
+                         int parallel_response_parsing_threshold = 0,
+                         bool share_batch_trusted_bidding_signals = false,
+                         bool use_on_demand_json_parser = false,
+                         bool emit_ad_metadata_json = false) {
     Response response;
     std::unique_ptr<BiddingBenchmarkingLogger> benchmarkingLogger =
         std::make_unique<BiddingNoOpLogger>();
     BiddingServiceRuntimeConfig runtime_config = {
         .encryption_enabled = true,
         .enable_buyer_debug_url_generation = enable_buyer_debug_url_generation,
-        .enable_adtech_code_logging = enable_adtech_code_logging};
+        .enable_adtech_code_logging = enable_adtech_code_logging,
+        .generate_bids_batch_size = generate_bids_batch_size,
+        .share_batch_trusted_bidding_signals =
+            share_batch_trusted_bidding_signals,
+        .use_on_demand_json_parser = use_on_demand_json_parser,
+        .emit_ad_metadata_json = emit_ad_metadata_json,
+        .parallel_response_parsing_threshold =
+            parallel_response_parsing_threshold,
+        .response_parsing_executor = response_parsing_executor_};
     request_.set_request_ciphertext(raw_request.SerializeAsString());
     GenerateBidsReactor reactor(
         dispatcher_, &request_, &response, std::move(benchmarkingLogger),
@@ -189,6 +212,8 @@ class GenerateBidsReactorTest : public testing::Test {
       std::make_unique<MockCryptoClientWrapper>();
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
+  // Parses the responses beside the callback thread, if set.
+  server_common::Executor* response_parsing_executor_ = nullptr;
 };
 
 constexpr char kUserBiddingSignals[] =
@@ -396,6 +421,39 @@ TEST_F(GenerateBidsReactorTest, GeneratesBidForSingleIGForBidding) {
   CheckGenerateBids(raw_request, ads);
 }
 
+TEST_F(GenerateBidsReactorTest, ReturnsAdAsJsonWhenEmitAdMetadataJsonIsSet) {
+  const std::string json = absl::Substitute(
+      R"JSON({"response":{"render":"$0","bid":1,)JSON"
+      R"JSON("ad":{"metadata":{"arr":[1,"a"]}}},"logs":[]})JSON",
+      kTestRenderUrl);
+  AdWithBid bid;
+  bid.set_render(kTestRenderUrl);
+  bid.set_bid(1);
+  bid.set_interest_group_name("Foo");
+  bid.set_ad_metadata_json(R"JSON({"metadata":{"arr":[1,"a"]}})JSON");
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  *raw_response.add_bids() = bid;
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  RawRequest raw_request;
+  BuildRawRequest({GetIGForBiddingFoo()}, testAuctionSignals,
+                  testBuyerSignals, testBiddingSignals, raw_request);
+  CheckGenerateBids(raw_request, ads,
+                    /*enable_buyer_debug_url_generation=*/false,
+                    /*enable_adtech_code_logging=*/false,
+                    /*generate_bids_batch_size=*/0,
+                    /*parallel_response_parsing_threshold=*/0,
+                    /*share_batch_trusted_bidding_signals=*/false,
+                    /*use_on_demand_json_parser=*/false,
+                    /*emit_ad_metadata_json=*/true);
+}
+
 TEST_F(GenerateBidsReactorTest, IGSerializationLatencyBenchmark) {
   std::string generate_bids_response_for_mock =
       GetTestResponse(kTestRenderUrl, 1);
@@ -645,6 +703,551 @@ TEST_F(GenerateBidsReactorTest, HandlesDuplicateKeysInBiddingSignalsKeys) {
   CheckGenerateBids(rawRequest, ads, false);
 }
 
+TEST_F(GenerateBidsReactorTest, SharesTrustedBiddingSignalsAcrossIGs) {
+  auto in_signals =
+      R"JSON({"keys": {"Foo":[1, 2], "bidding_signal":{"a": 1.5}, "Bar":"x"}})JSON";
+  absl::flat_hash_map<std::string, std::string> expected_signals = {
+      {"Foo", R"JSON({"Foo":[1,2],"bidding_signal":{"a":1.5}})JSON"},
+      {"Bar", R"JSON({"Bar":"x","bidding_signal":{"a":1.5}})JSON"}};
+
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (const auto& ig_name : {"Foo", "Bar"}) {
+    AdWithBid bid;
+    bid.set_render(kTestRenderUrl);
+    bid.set_bid(1);
+    bid.set_interest_group_name(ig_name);
+    *raw_response.add_bids() = std::move(bid);
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+  std::vector<IGForBidding> igs = {GetIGForBiddingFoo(), GetIGForBiddingBar()};
+
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce(
+          [json, expected_signals](std::vector<DispatchRequest>& batch,
+                                   BatchDispatchDoneCallback batch_callback) {
+            EXPECT_EQ(batch.size(), 2);
+            for (const auto& request : batch) {
+              EXPECT_EQ(*request.input[3], expected_signals.at(request.id));
+            }
+            return FakeExecute(batch, std::move(batch_callback), json);
+          });
+  RawRequest rawRequest;
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, in_signals,
+                  rawRequest);
+  CheckGenerateBids(rawRequest, ads, false);
+}
+
+TEST_F(GenerateBidsReactorTest, SlicesTrustedBiddingSignalsFromKeyValueTable) {
+  std::string in_signals;
+  AppendKeyValueTableSection("keys", 3, &in_signals);
+  AppendKeyValueTableEntry("Foo", "[1, 2]", &in_signals);
+  AppendKeyValueTableEntry("bidding_signal", R"JSON({"a": 1.5})JSON",
+                           &in_signals);
+  AppendKeyValueTableEntry("Bar", R"JSON("x")JSON", &in_signals);
+  absl::flat_hash_map<std::string, std::string> expected_signals = {
+      {"Foo", R"JSON({"Foo":[1, 2],"bidding_signal":{"a": 1.5}})JSON"},
+      {"Bar", R"JSON({"Bar":"x","bidding_signal":{"a": 1.5}})JSON"}};
+
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (const auto& ig_name : {"Foo", "Bar"}) {
+    AdWithBid bid;
+    bid.set_render(kTestRenderUrl);
+    bid.set_bid(1);
+    bid.set_interest_group_name(ig_name);
+    *raw_response.add_bids() = std::move(bid);
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+  std::vector<IGForBidding> igs = {GetIGForBiddingFoo(), GetIGForBiddingBar()};
+
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce(
+          [json, expected_signals](std::vector<DispatchRequest>& batch,
+                                   BatchDispatchDoneCallback batch_callback) {
+            EXPECT_EQ(batch.size(), 2);
+            for (const auto& request : batch) {
+              EXPECT_EQ(*request.input[3], expected_signals.at(request.id));
+            }
+            return FakeExecute(batch, std::move(batch_callback), json);
+          });
+  RawRequest rawRequest;
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, in_signals,
+                  rawRequest);
+  CheckGenerateBids(rawRequest, ads, false);
+}
+
+TEST_F(GenerateBidsReactorTest, CopiesTrustedBiddingSignalsWithOnDemandParser) {
+  if (!IsOnDemandJsonParserBuiltIn()) {
+    GTEST_SKIP() << "Not built with the on-demand JSON parser";
+  }
+  auto in_signals =
+      R"JSON({"keys": {"Foo":[1, 2], "bidding_signal":{"a": 1.5}, "Bar":"x"}})JSON";
+  absl::flat_hash_map<std::string, std::string> expected_signals = {
+      {"Foo", R"JSON({"Foo":[1, 2],"bidding_signal":{"a": 1.5}})JSON"},
+      {"Bar", R"JSON({"Bar":"x","bidding_signal":{"a": 1.5}})JSON"}};
+
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  for (const auto& ig_name : {"Foo", "Bar"}) {
+    AdWithBid bid;
+    bid.set_render(kTestRenderUrl);
+    bid.set_bid(1);
+    bid.set_interest_group_name(ig_name);
+    *raw_response.add_bids() = std::move(bid);
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+  std::vector<IGForBidding> igs = {GetIGForBiddingFoo(), GetIGForBiddingBar()};
+
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce(
+          [json, expected_signals](std::vector<DispatchRequest>& batch,
+                                   BatchDispatchDoneCallback batch_callback) {
+            EXPECT_EQ(batch.size(), 2);
+            for (const auto& request : batch) {
+              EXPECT_EQ(*request.input[3], expected_signals.at(request.id));
+            }
+            return FakeExecute(batch, std::move(batch_callback), json);
+          });
+  RawRequest rawRequest;
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, in_signals,
+                  rawRequest);
+  CheckGenerateBids(rawRequest, ads,
+                    /*enable_buyer_debug_url_generation=*/false,
+                    /*enable_adtech_code_logging=*/false,
+                    /*generate_bids_batch_size=*/0,
+                    /*parallel_response_parsing_threshold=*/0,
+                    /*share_batch_trusted_bidding_signals=*/false,
+                    /*use_on_demand_json_parser=*/true);
+}
+
+TEST_F(GenerateBidsReactorTest, GeneratesBidsInBatchesWhenBatchSizeIsSet) {
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  std::vector<IGForBidding> igs;
+  for (const auto& ig_name : {"Foo", "Bar", "Baz"}) {
+    IGForBidding ig = GetIGForBiddingFoo();
+    ig.set_name(ig_name);
+    igs.push_back(std::move(ig));
+    AdWithBid bid;
+    bid.set_render(kTestRenderUrl);
+    bid.set_bid(1);
+    bid.set_interest_group_name(ig_name);
+    *raw_response.add_bids() = std::move(bid);
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  std::string ig_output = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([&ig_output](std::vector<DispatchRequest>& batch,
+                             BatchDispatchDoneCallback batch_callback) {
+        // Three IGs in batches of two.
+        EXPECT_EQ(batch.size(), 2);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (const auto& request : batch) {
+          EXPECT_EQ(request.handler_name, "generateBidsBatchEntryFunction");
+          EXPECT_EQ(request.input.size(), 4);
+          EXPECT_EQ(*request.input[1], testAuctionSignals);
+          EXPECT_EQ(*request.input[2], testBuyerSignals);
+          absl::StatusOr<rapidjson::Document> interest_groups =
+              ParseJsonString(*request.input[0]);
+          EXPECT_TRUE(interest_groups.ok());
+          EXPECT_TRUE(interest_groups->IsArray());
+          std::vector<std::string> ig_outputs(interest_groups->Size(),
+                                              ig_output);
+          for (const auto& ig : interest_groups->GetArray()) {
+            EXPECT_TRUE(ig["interestGroup"].IsObject());
+            EXPECT_TRUE(ig["trustedBiddingSignals"].IsObject());
+            EXPECT_TRUE(ig["deviceSignals"].IsObject());
+          }
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp =
+              absl::StrCat("[", absl::StrJoin(ig_outputs, ","), "]");
+          responses.emplace_back(std::move(dispatch_response));
+        }
+        batch_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  CheckGenerateBids(raw_request, ads,
+                    /*enable_buyer_debug_url_generation=*/false,
+                    /*enable_adtech_code_logging=*/false,
+                    /*generate_bids_batch_size=*/2);
+}
+
+TEST_F(GenerateBidsReactorTest, SharesTrustedBiddingSignalsPerBatchWhenSet) {
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  std::vector<IGForBidding> igs;
+  for (const auto& ig_name : {"Foo", "Bar", "Baz"}) {
+    IGForBidding ig = GetIGForBiddingFoo();
+    ig.set_name(ig_name);
+    igs.push_back(std::move(ig));
+    AdWithBid bid;
+    bid.set_render(kTestRenderUrl);
+    bid.set_bid(1);
+    bid.set_interest_group_name(ig_name);
+    *raw_response.add_bids() = std::move(bid);
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  std::string ig_output = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([&ig_output](std::vector<DispatchRequest>& batch,
+                             BatchDispatchDoneCallback batch_callback) {
+        // Three IGs in batches of two, of which only Foo has a signal of its
+        // name.
+        EXPECT_EQ(batch.size(), 2);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (int i = 0; i < batch.size(); i++) {
+          const DispatchRequest& request = batch[i];
+          EXPECT_EQ(request.handler_name, "generateBidsBatchEntryFunction");
+          ASSERT_EQ(request.input.size(), 5);
+          absl::StatusOr<rapidjson::Document> trusted_bidding_signals =
+              ParseJsonString(*request.input[4]);
+          ASSERT_TRUE(trusted_bidding_signals.ok());
+          EXPECT_EQ(trusted_bidding_signals->MemberCount(), i == 0 ? 2 : 1);
+          EXPECT_TRUE((*trusted_bidding_signals)["bidding_signal"].IsString());
+          EXPECT_EQ(trusted_bidding_signals->HasMember("Foo"), i == 0);
+          absl::StatusOr<rapidjson::Document> interest_groups =
+              ParseJsonString(*request.input[0]);
+          ASSERT_TRUE(interest_groups.ok());
+          std::vector<std::string> ig_outputs(interest_groups->Size(),
+                                              ig_output);
+          for (const auto& ig : interest_groups->GetArray()) {
+            EXPECT_TRUE(ig["interestGroup"]["trustedBiddingSignalsKeys"]
+                            .IsArray());
+            EXPECT_FALSE(ig.HasMember("trustedBiddingSignals"));
+            EXPECT_TRUE(ig["deviceSignals"].IsObject());
+          }
+          DispatchResponse dispatch_response;
+          dispatch_response.id = request.id;
+          dispatch_response.resp =
+              absl::StrCat("[", absl::StrJoin(ig_outputs, ","), "]");
+          responses.emplace_back(std::move(dispatch_response));
+        }
+        batch_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals,
+                  R"json({"keys":{"bidding_signal":"test 3","Foo":[1]}})json",
+                  raw_request);
+  CheckGenerateBids(raw_request, ads,
+                    /*enable_buyer_debug_url_generation=*/false,
+                    /*enable_adtech_code_logging=*/false,
+                    /*generate_bids_batch_size=*/2,
+                    /*parallel_response_parsing_threshold=*/0,
+                    /*share_batch_trusted_bidding_signals=*/true);
+}
+
+TEST_F(GenerateBidsReactorTest, ParsesResponsesInParallelAboveThreshold) {
+  const int num_igs = 20;
+  Response ads;
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  std::vector<IGForBidding> igs;
+  for (int i = 0; i < num_igs; i++) {
+    IGForBidding ig = GetIGForBiddingFoo();
+    ig.set_name(absl::StrCat("ig_", i));
+    igs.push_back(std::move(ig));
+    // IGs with an odd index bid 0 and are filtered out.
+    if (i % 2 == 0) {
+      AdWithBid bid;
+      bid.set_render(kTestRenderUrl);
+      bid.set_bid(i + 1);
+      bid.set_interest_group_name(absl::StrCat("ig_", i));
+      *raw_response.add_bids() = std::move(bid);
+    }
+  }
+  *ads.mutable_response_ciphertext() = raw_response.SerializeAsString();
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([num_igs](std::vector<DispatchRequest>& batch,
+                          BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), num_igs);
+        std::vector<absl::StatusOr<DispatchResponse>> responses;
+        for (int i = 0; i < batch.size(); i++) {
+          DispatchResponse dispatch_response;
+          dispatch_response.id = batch[i].id;
+          dispatch_response.resp =
+              GetTestResponse(kTestRenderUrl, i % 2 == 0 ? i + 1 : 0);
+          responses.emplace_back(std::move(dispatch_response));
+        }
+        batch_callback(responses);
+        return absl::OkStatus();
+      });
+  RawRequest raw_request;
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  MockExecutor timer_executor;
+  ThreadPoolExecutor response_parsing_executor(/*num_threads=*/3,
+                                               &timer_executor);
+  response_parsing_executor_ = &response_parsing_executor;
+  CheckGenerateBids(raw_request, ads,
+                    /*enable_buyer_debug_url_generation=*/false,
+                    /*enable_adtech_code_logging=*/false,
+                    /*generate_bids_batch_size=*/0,
+                    /*parallel_response_parsing_threshold=*/4);
+}
+
+// Reports a fixed number of requests already waiting in the dispatcher queue.
+class QueuedCodeDispatchClient : public MockCodeDispatchClient {
+ public:
+  explicit QueuedCodeDispatchClient(int64_t pending_requests)
+      : pending_requests_(pending_requests) {}
+
+  int64_t PendingRequests() const override { return pending_requests_; }
+
+ private:
+  const int64_t pending_requests_;
+};
+
+TEST_F(GenerateBidsReactorTest, ShedsLowestPriorityIGsWhenQueueIsFull) {
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs;
+  for (const auto& [ig_name, bid_count] :
+       {std::pair{"Low", 1}, std::pair{"High", 5}, std::pair{"Medium", 3}}) {
+    IGForBidding ig = GetIGForBiddingFoo();
+    ig.set_name(ig_name);
+    ig.mutable_browser_signals()->set_bid_count(bid_count);
+    igs.push_back(std::move(ig));
+  }
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  // Two of the ten queue slots are free.
+  QueuedCodeDispatchClient dispatcher(/*pending_requests=*/8);
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        std::vector<std::string> ids;
+        for (const auto& request : batch) {
+          ids.push_back(request.id);
+        }
+        EXPECT_THAT(ids, testing::UnorderedElementsAre("High", "Medium"));
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  Response response;
+  GenerateBidsReactor reactor(dispatcher, &request_, &response,
+                              std::make_unique<BiddingNoOpLogger>(),
+                              key_fetcher_manager_.get(), crypto_client_.get(),
+                              {.encryption_enabled = true,
+                               .dispatch_queue_capacity = 10});
+  reactor.Execute();
+  GenerateBidsResponse::GenerateBidsRawResponse raw_response;
+  raw_response.ParseFromString(response.response_ciphertext());
+  EXPECT_EQ(raw_response.bids_size(), 2);
+}
+
+TEST_F(GenerateBidsReactorTest, TruncatesAdsPastTheLimitOfTheInterestGroup) {
+  IGForBidding ig = GetIGForBiddingFoo();
+  ig.mutable_ad_component_render_ids()->Add("c1");
+  ig.mutable_ad_component_render_ids()->Add("c2");
+  RawRequest raw_request;
+  BuildRawRequest({ig}, testAuctionSignals, testBuyerSignals,
+                  testBiddingSignals, raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        const std::string& serialized_ig = *batch.at(0).input.at(0);
+        EXPECT_THAT(serialized_ig, testing::HasSubstr(R"(["1689"])"));
+        EXPECT_THAT(serialized_ig, testing::HasSubstr(R"(["c1"])"));
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  Response response;
+  GenerateBidsReactor reactor(dispatcher_, &request_, &response,
+                              std::make_unique<BiddingNoOpLogger>(),
+                              key_fetcher_manager_.get(), crypto_client_.get(),
+                              {.encryption_enabled = true,
+                               .max_ads_per_interest_group = 1,
+                               .max_ad_components_per_interest_group = 1});
+  reactor.Execute();
+}
+
+TEST_F(GenerateBidsReactorTest, SkipsInterestGroupsPastTheInputBytesLimit) {
+  IGForBidding large_ig = GetIGForBiddingBar();
+  large_ig.set_user_bidding_signals(
+      absl::StrCat(R"({"padding":")", std::string(1000, 'a'), R"("})"));
+  RawRequest raw_request;
+  BuildRawRequest({large_ig, GetIGForBiddingFoo()}, testAuctionSignals,
+                  testBuyerSignals, testBiddingSignals, raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 1);
+        EXPECT_EQ(batch.at(0).id, "Foo");
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  Response response;
+  GenerateBidsReactor reactor(dispatcher_, &request_, &response,
+                              std::make_unique<BiddingNoOpLogger>(),
+                              key_fetcher_manager_.get(), crypto_client_.get(),
+                              {.encryption_enabled = true,
+                               .max_generate_bid_input_bytes = 1000});
+  reactor.Execute();
+}
+
+TEST_F(GenerateBidsReactorTest, ShedsPathologicalIGsFirst) {
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs;
+  for (const auto& [ig_name, bid_count] :
+       {std::pair{"Low", 1}, std::pair{"High", 5}, std::pair{"Medium", 3}}) {
+    IGForBidding ig = GetIGForBiddingFoo();
+    ig.set_name(ig_name);
+    ig.mutable_browser_signals()->set_bid_count(bid_count);
+    igs.push_back(std::move(ig));
+  }
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+  InterestGroupCostEstimator cost_estimator(absl::Milliseconds(50), 10);
+  cost_estimator.Record("High", absl::Milliseconds(200));
+
+  // Two of the ten queue slots are free.
+  QueuedCodeDispatchClient dispatcher(/*pending_requests=*/8);
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        std::vector<std::string> ids;
+        for (const auto& request : batch) {
+          ids.push_back(request.id);
+        }
+        EXPECT_THAT(ids, testing::UnorderedElementsAre("Low", "Medium"));
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  Response response;
+  GenerateBidsReactor reactor(
+      dispatcher, &request_, &response, std::make_unique<BiddingNoOpLogger>(),
+      key_fetcher_manager_.get(), crypto_client_.get(),
+      {.encryption_enabled = true,
+       .dispatch_queue_capacity = 10,
+       .interest_group_cost_estimator = &cost_estimator});
+  reactor.Execute();
+}
+
+TEST_F(GenerateBidsReactorTest, RecordsTheExecutionTimesOfTheIGs) {
+  RawRequest raw_request;
+  BuildRawRequest({GetIGForBiddingFoo()}, testAuctionSignals, testBuyerSignals,
+                  testBiddingSignals, raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+  InterestGroupCostEstimator cost_estimator(absl::Milliseconds(50), 10);
+
+  const std::string json = absl::Substitute(
+      R"JSON({"response":{"render":"$0","bid":1},"logs":[],"errors":[],)JSON"
+      R"JSON("warnings":[],"executionTimeMs":7})JSON",
+      kTestRenderUrl);
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  Response response;
+  GenerateBidsReactor reactor(
+      dispatcher_, &request_, &response, std::make_unique<BiddingNoOpLogger>(),
+      key_fetcher_manager_.get(), crypto_client_.get(),
+      {.encryption_enabled = true,
+       .interest_group_cost_estimator = &cost_estimator});
+  reactor.Execute();
+  EXPECT_EQ(cost_estimator.Estimate("Foo"), absl::Milliseconds(7));
+}
+
+TEST_F(GenerateBidsReactorTest, DoesNotDispatchWhenDeadlineHasPassed) {
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs;
+  igs.push_back(GetIGForBiddingFoo());
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  EXPECT_CALL(dispatcher_, BatchExecute).Times(0);
+  Response response;
+  GenerateBidsReactor reactor(dispatcher_, &request_, &response,
+                              std::make_unique<BiddingNoOpLogger>(),
+                              key_fetcher_manager_.get(), crypto_client_.get(),
+                              {.encryption_enabled = true,
+                               .roma_timeout_ms = "10000",
+                               .roma_timeout_response_margin_ms = 50});
+  reactor.SetDeadline(absl::Now() + absl::Milliseconds(10));
+  reactor.Execute();
+  EXPECT_TRUE(response.response_ciphertext().empty());
+}
+
+TEST_F(GenerateBidsReactorTest, RejectsBidsProjectedToWaitPastRomaTimeout) {
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs;
+  igs.push_back(GetIGForBiddingFoo());
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  // The only worker is busy with a request that takes a second.
+  DispatchStats stats;
+  stats.SetNumWorkers(1);
+  stats.OnBatchScheduled(1);
+  stats.OnBatchDone(1, 0, absl::Seconds(1));
+  stats.OnBatchScheduled(1);
+  MockCodeDispatchClient dispatcher(&stats);
+  EXPECT_CALL(dispatcher, BatchExecute).Times(0);
+  Response response;
+  GenerateBidsReactor reactor(dispatcher, &request_, &response,
+                              std::make_unique<BiddingNoOpLogger>(),
+                              key_fetcher_manager_.get(), crypto_client_.get(),
+                              {.encryption_enabled = true,
+                               .roma_timeout_ms = "100"});
+  reactor.Execute();
+  EXPECT_TRUE(response.response_ciphertext().empty());
+}
+
+TEST_F(GenerateBidsReactorTest, ShortensRomaTimeoutToDeadline) {
+  std::string json = GetTestResponse(kTestRenderUrl, 1);
+  RawRequest raw_request;
+  std::vector<IGForBidding> igs;
+  igs.push_back(GetIGForBiddingFoo());
+  igs.push_back(GetIGForBiddingBar());
+  BuildRawRequest(igs, testAuctionSignals, testBuyerSignals, testBiddingSignals,
+                  raw_request);
+  request_.set_request_ciphertext(raw_request.SerializeAsString());
+
+  EXPECT_CALL(dispatcher_, BatchExecute)
+      .WillOnce([json](std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 2);
+        for (const auto& request : batch) {
+          int64_t roma_timeout_ms;
+          EXPECT_TRUE(absl::SimpleAtoi(request.tags.at("TimeoutMs"),
+                                       &roma_timeout_ms));
+          EXPECT_GT(roma_timeout_ms, 0);
+          EXPECT_LE(roma_timeout_ms, 60'000 - 1'000);
+        }
+        return FakeExecute(batch, std::move(batch_callback), json);
+      });
+  Response response;
+  GenerateBidsReactor reactor(dispatcher_, &request_, &response,
+                              std::make_unique<BiddingNoOpLogger>(),
+                              key_fetcher_manager_.get(), crypto_client_.get(),
+                              {.encryption_enabled = true,
+                               .roma_timeout_ms = "100000",
+                               .roma_timeout_response_margin_ms = 1'000});
+  reactor.SetDeadline(absl::Now() + absl::Seconds(60));
+  reactor.Execute();
+}
+
 TEST_F(GenerateBidsReactorTest, GenerateBidResponseWithDebugUrls) {
   bool enable_debug_reporting = true;
   bool enable_buyer_debug_url_generation = true;
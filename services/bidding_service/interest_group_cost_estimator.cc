@@ -0,0 +1,67 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/interest_group_cost_estimator.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+InterestGroupCostEstimator::InterestGroupCostEstimator(
+    absl::Duration pathological_time, size_t max_interest_groups)
+    : pathological_time_(pathological_time),
+      max_interest_groups_(std::max<size_t>(max_interest_groups, 1)) {}
+
+void InterestGroupCostEstimator::Record(absl::string_view interest_group_name,
+                                        absl::Duration execution_time) {
+  absl::MutexLock lock(&mu_);
+  if (auto it = index_.find(interest_group_name); it != index_.end()) {
+    Entry& entry = *it->second;
+    entry.estimate += kSmoothing * (execution_time - entry.estimate);
+    entries_.splice(entries_.end(), entries_, it->second);
+    return;
+  }
+  if (entries_.size() == max_interest_groups_) {
+    index_.erase(entries_.front().interest_group_name);
+    entries_.pop_front();
+  }
+  entries_.push_back({.interest_group_name = std::string(interest_group_name),
+                      .estimate = execution_time});
+  index_.emplace(entries_.back().interest_group_name,
+                 std::prev(entries_.end()));
+}
+
+std::optional<absl::Duration> InterestGroupCostEstimator::Estimate(
+    absl::string_view interest_group_name) const {
+  absl::MutexLock lock(&mu_);
+  auto it = index_.find(interest_group_name);
+  if (it == index_.end()) {
+    return std::nullopt;
+  }
+  return it->second->estimate;
+}
+
+size_t InterestGroupCostEstimator::size() const {
+  absl::MutexLock lock(&mu_);
+  return entries_.size();
+}
+
+bool InterestGroupCostEstimator::IsPathologicalLocked(
+    absl::string_view interest_group_name) const {
+  auto it = index_.find(interest_group_name);
+  return it != index_.end() && it->second->estimate >= pathological_time_;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,101 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_BIDDING_SERVICE_INTEREST_GROUP_COST_ESTIMATOR_H_
+#define SERVICES_BIDDING_SERVICE_INTEREST_GROUP_COST_ESTIMATOR_H_
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Thread-safe estimates of the generateBid() execution time of the interest
+// groups of the buyer, by interest group name, from the times the code
+// wrapper measured for their past executions. The names of the interest
+// groups of a buyer are shared by many users, so that an interest group
+// found expensive for one request is known to be for the next, and the
+// admission control and input limits of the bidding service drop the
+// pathological interest groups first. Only the max_interest_groups most
+// recently executed are tracked.
+class InterestGroupCostEstimator {
+ public:
+  // Weight of each new execution time in the estimate of an interest group.
+  static constexpr double kSmoothing = 0.25;
+
+  // Interest groups estimated to take pathological_time or longer are
+  // pathological.
+  InterestGroupCostEstimator(absl::Duration pathological_time,
+                             size_t max_interest_groups);
+
+  // InterestGroupCostEstimator is neither copyable nor movable.
+  InterestGroupCostEstimator(const InterestGroupCostEstimator&) = delete;
+  InterestGroupCostEstimator& operator=(const InterestGroupCostEstimator&) =
+      delete;
+
+  // Updates the estimate of the interest group with one execution time.
+  void Record(absl::string_view interest_group_name,
+              absl::Duration execution_time) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the estimated execution time of the interest group, or nullopt
+  // if none of its executions were recorded.
+  std::optional<absl::Duration> Estimate(
+      absl::string_view interest_group_name) const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns which of the interest groups are pathological, under one lock.
+  template <typename Names>
+  absl::flat_hash_set<absl::string_view> Pathological(
+      const Names& interest_group_names) const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::flat_hash_set<absl::string_view> pathological;
+    absl::MutexLock lock(&mu_);
+    for (absl::string_view name : interest_group_names) {
+      if (IsPathologicalLocked(name)) {
+        pathological.insert(name);
+      }
+    }
+    return pathological;
+  }
+
+  // Number of interest groups tracked.
+  size_t size() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::string interest_group_name;
+    absl::Duration estimate;
+  };
+
+  bool IsPathologicalLocked(absl::string_view interest_group_name) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Duration pathological_time_;
+  const size_t max_interest_groups_;
+  mutable absl::Mutex mu_;
+  // Least recently executed first.
+  std::list<Entry> entries_ ABSL_GUARDED_BY(mu_);
+  absl::flat_hash_map<absl::string_view, std::list<Entry>::iterator> index_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BIDDING_SERVICE_INTEREST_GROUP_COST_ESTIMATOR_H_
@@ -0,0 +1,65 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/bidding_service/interest_group_cost_estimator.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::UnorderedElementsAre;
+
+TEST(InterestGroupCostEstimatorTest, SmoothsTheExecutionTimes) {
+  InterestGroupCostEstimator estimator(absl::Milliseconds(50), 10);
+  EXPECT_EQ(estimator.Estimate("ig"), std::nullopt);
+
+  estimator.Record("ig", absl::Milliseconds(10));
+  EXPECT_EQ(estimator.Estimate("ig"), absl::Milliseconds(10));
+  estimator.Record("ig", absl::Milliseconds(50));
+  EXPECT_EQ(estimator.Estimate("ig"), absl::Milliseconds(20));
+}
+
+TEST(InterestGroupCostEstimatorTest, FindsThePathologicalInterestGroups) {
+  InterestGroupCostEstimator estimator(absl::Milliseconds(50), 10);
+  estimator.Record("cheap", absl::Milliseconds(1));
+  estimator.Record("slow", absl::Milliseconds(80));
+  estimator.Record("slowest", absl::Milliseconds(500));
+
+  const std::vector<std::string> names = {"cheap", "slow", "slowest",
+                                          "unknown"};
+  EXPECT_THAT(estimator.Pathological(names),
+              UnorderedElementsAre("slow", "slowest"));
+}
+
+TEST(InterestGroupCostEstimatorTest, ForgetsTheLeastRecentlyExecuted) {
+  InterestGroupCostEstimator estimator(absl::Milliseconds(50), 2);
+  estimator.Record("first", absl::Milliseconds(1));
+  estimator.Record("second", absl::Milliseconds(1));
+  estimator.Record("first", absl::Milliseconds(1));
+  estimator.Record("third", absl::Milliseconds(1));
+
+  EXPECT_EQ(estimator.size(), 2);
+  EXPECT_NE(estimator.Estimate("first"), std::nullopt);
+  EXPECT_EQ(estimator.Estimate("second"), std::nullopt);
+  EXPECT_NE(estimator.Estimate("third"), std::nullopt);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
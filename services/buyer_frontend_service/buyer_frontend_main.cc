@@ -13,10 +13,12 @@
 //  limitations under the License.
 
 #include <memory>
+#include <optional>
 #include <string>
 
 #include <aws/core/Aws.h>
 
+#include "absl/debugging/symbolize.h"
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/log/check.h"
@@ -28,20 +30,40 @@
 #include "grpcpp/grpcpp.h"
 #include "grpcpp/health_check_service_interface.h"
 #include "opentelemetry/metrics/provider.h"
+#include "public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
 #include "public/cpio/interface/cpio.h"
 #include "services/buyer_frontend_service/buyer_frontend_service.h"
 #include "services/buyer_frontend_service/providers/http_bidding_signals_async_provider.h"
+#include "services/buyer_frontend_service/providers/snapshot_bidding_signals_async_provider.h"
 #include "services/buyer_frontend_service/runtime_flags.h"
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
+#include "services/common/clients/async_grpc/channel_warmer.h"
+#include "services/common/clients/async_grpc/message_compression.h"
 #include "services/common/clients/bidding_server/bidding_async_client.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/hedging_http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+#include "services/common/clients/http_kv_server/util/single_flight_http_fetcher_async.h"
+#include "services/common/clients/mirroring_async_client.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/metric/server_definition.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/profiling_service.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/grpc_server_options.h"
+#include "services/common/util/heap_stats.h"
+#include "services/common/util/memory_governor.h"
+#include "services/common/util/request_memory_budget.h"
+#include "services/common/util/request_timeline.h"
+#include "services/common/util/server_readiness.h"
 #include "services/common/util/signal_handler.h"
 #include "services/common/util/status_macros.h"
+#include "services/common/util/worker_processes.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/cpp/concurrent/event_engine_executor.h"
 #include "src/cpp/encryption/key_fetcher/src/key_fetcher_manager.h"
@@ -61,13 +83,80 @@ ABSL_FLAG(std::optional<int>, protected_app_signals_generate_bid_timeout_ms,
           "finish.");
 ABSL_FLAG(std::optional<int>, bidding_signals_load_timeout_ms, std::nullopt,
           "Max time to wait for fetching bidding signals to finish.");
+ABSL_FLAG(std::optional<int>, generate_bids_partition_threshold, 0,
+          "Split the generate bid requests of more interest groups than this "
+          "into concurrent requests of about as many interest groups each. "
+          "Requests are not split when 0.");
+ABSL_FLAG(std::optional<int>, generate_bids_max_partitions, 4,
+          "Max number of concurrent generate bid requests a request is split "
+          "into.");
 ABSL_FLAG(std::optional<bool>, enable_buyer_frontend_benchmarking, std::nullopt,
           "Enable benchmarking the BuyerFrontEnd Server.");
 ABSL_FLAG(
     std::optional<bool>, create_new_event_engine, std::nullopt,
     "Share the event engine with gprc when false , otherwise create new one");
+ABSL_FLAG(std::optional<bool>, enable_curl_event_loop, false,
+          "Drive HTTP fetches with an epoll based curl event loop on a "
+          "dedicated thread instead of polling curl on the executor.");
+ABSL_FLAG(std::optional<bool>, enable_kv_http2_multiplexing, false,
+          "Multiplex the Key-Value server fetches over HTTP/2 connections "
+          "instead of opening a connection per concurrent fetch.");
+ABSL_FLAG(std::optional<bool>, enable_kv_request_coalescing, false,
+          "Share a single Key-Value server fetch between the concurrent "
+          "requests for the same keys.");
+ABSL_FLAG(std::optional<bool>, enable_kv_post_requests, false,
+          "Send the Key-Value server lookups as JSON in the body of POST "
+          "requests instead of in the query string of GET requests.");
+ABSL_FLAG(std::optional<bool>, enable_kv_request_compression, false,
+          "Gzip the body of the Key-Value server POST requests.");
+ABSL_FLAG(std::optional<int>, kv_max_keys_per_request, 0,
+          "Split Key-Value server lookups of more keys into parallel requests "
+          "of at most this many keys. Lookups are not split when 0.");
+ABSL_FLAG(std::optional<int>, kv_batch_max_keys, 0,
+          "Merge the Key-Value server lookups of concurrent requests with the "
+          "same headers into a single lookup of up to this many keys. "
+          "Lookups are not batched when 0.");
+ABSL_FLAG(std::optional<int>, kv_batch_max_delay_us, 500,
+          "Time in microseconds a batch of Key-Value server lookups waits for "
+          "other lookups before it is sent.");
+ABSL_FLAG(std::optional<bool>, enable_kv_table_responses, false,
+          "Ask the Key-Value server for key-value tables instead of JSON, so "
+          "that the bidding and auction services slice the values of each "
+          "key without parsing JSON.");
+ABSL_FLAG(std::optional<bool>, enable_bidding_signals_projection, false,
+          "Drop the trusted bidding signals of the keys that no interest "
+          "group of a request asks for before sending them to the bidding "
+          "service.");
+ABSL_FLAG(std::optional<int>, kv_num_shards, 1,
+          "Split the keys of the bidding signals lookups by hash into this "
+          "many parallel Key-Value server lookups. The signals are merged "
+          "from the lookups that succeed.");
+ABSL_FLAG(std::optional<bool>, enable_kv_request_hedging, false,
+          "Send a Key-Value server fetch again over a new connection when it "
+          "takes longer than a percentile of the recent fetch latencies.");
+ABSL_FLAG(std::optional<int>, kv_hedging_latency_percentile, 95,
+          "Percentile of the recent Key-Value server fetch latencies after "
+          "which a fetch is hedged.");
+ABSL_FLAG(std::optional<int>, kv_hedging_budget_percent, 5,
+          "Max hedged Key-Value server fetches, as a percentage of the "
+          "fetches.");
+ABSL_FLAG(std::optional<int>, buyer_kv_cache_ttl_ms, 0,
+          "Max time to cache the values of the buyer Key-Value server keys. "
+          "The cache is disabled when 0.");
+ABSL_FLAG(std::optional<int>, buyer_kv_cache_max_bytes, 64 * 1024 * 1024,
+          "Max bytes of the keys and values held by the buyer Key-Value "
+          "cache.");
+ABSL_FLAG(std::optional<int>, buyer_kv_cache_miss_ttl_ms, 0,
+          "Max time to cache the buyer Key-Value server keys without a value, "
+          "so that they are not looked up again. Not cached when 0.");
 ABSL_FLAG(std::optional<bool>, enable_bidding_compression, true,
           "Flag to enable bidding client compression. True by default.");
+ABSL_FLAG(std::optional<std::string>, grpc_compression_algorithm, "gzip",
+          "Algorithm of the requests compressed to the Bidding server: gzip or "
+          "deflate.");
+ABSL_FLAG(std::optional<int>, grpc_compression_min_message_bytes, 1024,
+          "Requests to the Bidding server smaller than this are sent "
+          "uncompressed.");
 ABSL_FLAG(std::optional<bool>, bfe_ingress_tls, std::nullopt,
           "If true, frontend gRPC service terminates TLS");
 ABSL_FLAG(std::optional<std::string>, bfe_tls_key, std::nullopt,
@@ -76,10 +165,49 @@ ABSL_FLAG(std::optional<std::string>, bfe_tls_cert, std::nullopt,
           "TLS cert string. Required if bfe_ingress_tls=true.");
 ABSL_FLAG(std::optional<bool>, bidding_egress_tls, std::nullopt,
           "If true, bidding service gRPC client uses TLS.");
+ABSL_FLAG(std::optional<int>, bidding_channel_pool_size, 1,
+          "Number of gRPC channels, each with a connection of its own, the "
+          "calls to the bidding service are spread across.");
+ABSL_FLAG(std::optional<int>, bidding_flow_control_window_bytes, 0,
+          "Initial HTTP/2 flow-control window of the bidding service gRPC "
+          "client, or 0 for the gRPC default.");
+ABSL_FLAG(std::optional<bool>, bidding_least_loaded_routing, false,
+          "If true, each call to the bidding service goes to the less loaded "
+          "of two channels of the pool drawn at random, by the calls "
+          "outstanding on them and the load the servers report, rather than "
+          "round robin.");
+ABSL_FLAG(std::optional<std::string>, shadow_bidding_server_addr, "",
+          "Bidding service, such as a canary of a new build or Roma config, "
+          "that a sample of the decrypted GenerateBids calls is mirrored to. "
+          "Its responses are discarded, and only its latency is exported next "
+          "to the primary's. Disabled if empty.");
+ABSL_FLAG(std::optional<int>, shadow_traffic_percent, 0,
+          "Percentage of the GenerateBids calls mirrored to the shadow bidding "
+          "service, picked at random.");
+ABSL_FLAG(std::optional<std::string>, bidding_signals_snapshot_bucket, "",
+          "Bucket of a key-value table snapshot of the hot bidding signals, "
+          "served without looking them up on the Key-Value server. The keys it "
+          "does not have still are. Disabled if empty.");
+ABSL_FLAG(std::optional<std::string>, bidding_signals_snapshot_blob, "",
+          "Blob of the bidding signals snapshot in its bucket.");
+ABSL_FLAG(std::optional<int>, bidding_signals_snapshot_fetch_period_ms, 60000,
+          "Period at which the bidding signals snapshot is refetched.");
+ABSL_FLAG(std::optional<bool>, enable_channel_pre_warming, false,
+          "Connect the channels to the bidding service at startup and keep "
+          "them connected, reporting the server ready only once they "
+          "answered a health check or the pre-warming timeout passed.");
+ABSL_FLAG(std::optional<int>, channel_pre_warming_timeout_ms, 10000,
+          "Time after which the server is reported ready even if some "
+          "channels are not warm yet.");
 ABSL_FLAG(
     bool, init_config_client, false,
     "Initialize config client to fetch any runtime flags not supplied from"
     " command line from cloud metadata store. False by default.");
+ABSL_FLAG(int, worker_processes, 1,
+          "Number of processes the server is sharded across, each with an "
+          "executor and HTTP fetchers of its own, listening on the same port "
+          "with SO_REUSEPORT. Only read from the command line, since the "
+          "workers are forked before the config client starts any thread.");
 namespace privacy_sandbox::bidding_auction_servers {
 
 using ::google::scp::cpio::Cpio;
@@ -99,15 +227,70 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS);
   config_client.SetFlag(FLAGS_bidding_signals_load_timeout_ms,
                         BIDDING_SIGNALS_LOAD_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_generate_bids_partition_threshold,
+                        GENERATE_BIDS_PARTITION_THRESHOLD);
+  config_client.SetFlag(FLAGS_generate_bids_max_partitions,
+                        GENERATE_BIDS_MAX_PARTITIONS);
   config_client.SetFlag(FLAGS_enable_buyer_frontend_benchmarking,
                         ENABLE_BUYER_FRONTEND_BENCHMARKING);
   config_client.SetFlag(FLAGS_create_new_event_engine, CREATE_NEW_EVENT_ENGINE);
+  config_client.SetFlag(FLAGS_enable_curl_event_loop, ENABLE_CURL_EVENT_LOOP);
+  config_client.SetFlag(FLAGS_enable_kv_http2_multiplexing,
+                        ENABLE_KV_HTTP2_MULTIPLEXING);
+  config_client.SetFlag(FLAGS_enable_kv_request_coalescing,
+                        ENABLE_KV_REQUEST_COALESCING);
+  config_client.SetFlag(FLAGS_enable_kv_post_requests, ENABLE_KV_POST_REQUESTS);
+  config_client.SetFlag(FLAGS_enable_kv_request_compression,
+                        ENABLE_KV_REQUEST_COMPRESSION);
+  config_client.SetFlag(FLAGS_kv_max_keys_per_request,
+                        KV_MAX_KEYS_PER_REQUEST);
+  config_client.SetFlag(FLAGS_kv_batch_max_keys, KV_BATCH_MAX_KEYS);
+  config_client.SetFlag(FLAGS_kv_batch_max_delay_us, KV_BATCH_MAX_DELAY_US);
+  config_client.SetFlag(FLAGS_enable_kv_table_responses,
+                        ENABLE_KV_TABLE_RESPONSES);
+  config_client.SetFlag(FLAGS_enable_bidding_signals_projection,
+                        ENABLE_BIDDING_SIGNALS_PROJECTION);
+  config_client.SetFlag(FLAGS_kv_num_shards, KV_NUM_SHARDS);
+  config_client.SetFlag(FLAGS_enable_kv_request_hedging,
+                        ENABLE_KV_REQUEST_HEDGING);
+  config_client.SetFlag(FLAGS_kv_hedging_latency_percentile,
+                        KV_HEDGING_LATENCY_PERCENTILE);
+  config_client.SetFlag(FLAGS_kv_hedging_budget_percent,
+                        KV_HEDGING_BUDGET_PERCENT);
+  config_client.SetFlag(FLAGS_buyer_kv_cache_ttl_ms, BUYER_KV_CACHE_TTL_MS);
+  config_client.SetFlag(FLAGS_buyer_kv_cache_max_bytes,
+                        BUYER_KV_CACHE_MAX_BYTES);
+  config_client.SetFlag(FLAGS_buyer_kv_cache_miss_ttl_ms,
+                        BUYER_KV_CACHE_MISS_TTL_MS);
   config_client.SetFlag(FLAGS_enable_bidding_compression,
                         ENABLE_BIDDING_COMPRESSION);
+  config_client.SetFlag(FLAGS_grpc_compression_algorithm,
+                        GRPC_COMPRESSION_ALGORITHM);
+  config_client.SetFlag(FLAGS_grpc_compression_min_message_bytes,
+                        GRPC_COMPRESSION_MIN_MESSAGE_BYTES);
   config_client.SetFlag(FLAGS_bfe_ingress_tls, BFE_INGRESS_TLS);
   config_client.SetFlag(FLAGS_bfe_tls_key, BFE_TLS_KEY);
   config_client.SetFlag(FLAGS_bfe_tls_cert, BFE_TLS_CERT);
   config_client.SetFlag(FLAGS_bidding_egress_tls, BIDDING_EGRESS_TLS);
+  config_client.SetFlag(FLAGS_bidding_channel_pool_size,
+                        BIDDING_CHANNEL_POOL_SIZE);
+  config_client.SetFlag(FLAGS_bidding_flow_control_window_bytes,
+                        BIDDING_FLOW_CONTROL_WINDOW_BYTES);
+  config_client.SetFlag(FLAGS_bidding_least_loaded_routing,
+                        BIDDING_LEAST_LOADED_ROUTING);
+  config_client.SetFlag(FLAGS_shadow_bidding_server_addr,
+                        SHADOW_BIDDING_SERVER_ADDR);
+  config_client.SetFlag(FLAGS_shadow_traffic_percent, SHADOW_TRAFFIC_PERCENT);
+  config_client.SetFlag(FLAGS_bidding_signals_snapshot_bucket,
+                        BIDDING_SIGNALS_SNAPSHOT_BUCKET);
+  config_client.SetFlag(FLAGS_bidding_signals_snapshot_blob,
+                        BIDDING_SIGNALS_SNAPSHOT_BLOB);
+  config_client.SetFlag(FLAGS_bidding_signals_snapshot_fetch_period_ms,
+                        BIDDING_SIGNALS_SNAPSHOT_FETCH_PERIOD_MS);
+  config_client.SetFlag(FLAGS_enable_channel_pre_warming,
+                        ENABLE_CHANNEL_PRE_WARMING);
+  config_client.SetFlag(FLAGS_channel_pre_warming_timeout_ms,
+                        CHANNEL_PRE_WARMING_TIMEOUT_MS);
   config_client.SetFlag(FLAGS_enable_encryption, ENABLE_ENCRYPTION);
   config_client.SetFlag(FLAGS_test_mode, TEST_MODE);
   config_client.SetFlag(FLAGS_public_key_endpoint, PUBLIC_KEY_ENDPOINT);
@@ -141,6 +324,26 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         ENABLE_OTEL_BASED_LOGGING);
   config_client.SetFlag(FLAGS_enable_protected_app_signals,
                         ENABLE_PROTECTED_APP_SIGNALS);
+  config_client.SetFlag(FLAGS_enable_boringssl_crypto,
+                        ENABLE_BORINGSSL_CRYPTO);
+  config_client.SetFlag(FLAGS_malloc_arena_max, MALLOC_ARENA_MAX);
+  config_client.SetFlag(FLAGS_heap_release_interval_ms,
+                        HEAP_RELEASE_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads,
+                        GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_grpc_server_memory_quota_mb,
+                        GRPC_SERVER_MEMORY_QUOTA_MB);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_max_concurrent_streams,
+                        GRPC_MAX_CONCURRENT_STREAMS);
+  config_client.SetFlag(FLAGS_enable_concurrency_limiter,
+                        ENABLE_CONCURRENCY_LIMITER);
+  config_client.SetFlag(FLAGS_concurrency_limit_max, CONCURRENCY_LIMIT_MAX);
+  config_client.SetFlag(FLAGS_memory_pressure_watermarks,
+                        MEMORY_PRESSURE_WATERMARKS);
+  config_client.SetFlag(FLAGS_request_memory_budget_mb,
+                        REQUEST_MEMORY_BUDGET_MB);
+  config_client.SetFlag(FLAGS_profiling_port, PROFILING_PORT);
 
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
@@ -158,6 +361,14 @@ absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_RETURN_IF_ERROR(
+      SetMallocArenaMax(config_client.GetIntParameter(MALLOC_ARENA_MAX)));
+  HeapReleaser heap_releaser(absl::Milliseconds(
+      config_client.GetIntParameter(HEAP_RELEASE_INTERVAL_MS)));
+  PS_ASSIGN_OR_RETURN(
+      const std::optional<MemoryWatermarks> memory_watermarks,
+      ParseMemoryWatermarks(
+          config_client.GetStringParameter(MEMORY_PRESSURE_WATERMARKS)));
 
   int port = config_client.GetIntParameter(PORT);
   std::string bidding_server_addr =
@@ -168,6 +379,10 @@ absl::Status RunServer() {
       config_client.GetBooleanParameter(ENABLE_BUYER_FRONTEND_BENCHMARKING);
   bool enable_bidding_compression =
       config_client.GetBooleanParameter(ENABLE_BIDDING_COMPRESSION);
+  PS_ASSIGN_OR_RETURN(
+      const grpc_compression_algorithm compression_algorithm,
+      ParseCompressionAlgorithm(
+          config_client.GetStringParameter(GRPC_COMPRESSION_ALGORITHM)));
 
   if (bidding_server_addr.empty()) {
     return absl::InvalidArgumentError("Missing: Bidding server address");
@@ -181,15 +396,58 @@ absl::Status RunServer() {
       config_client.GetBooleanParameter(CREATE_NEW_EVENT_ENGINE)
           ? grpc_event_engine::experimental::CreateEventEngine()
           : grpc_event_engine::experimental::GetDefaultEventEngine());
+  std::shared_ptr<KeyValueCache> buyer_kv_cache;
+  if (int ttl_ms = config_client.GetIntParameter(BUYER_KV_CACHE_TTL_MS);
+      ttl_ms > 0) {
+    buyer_kv_cache = std::make_shared<KeyValueCache>(
+        absl::Milliseconds(ttl_ms),
+        config_client.GetIntParameter(BUYER_KV_CACHE_MAX_BYTES),
+        /*num_shards=*/16,
+        absl::Milliseconds(
+            config_client.GetIntParameter(BUYER_KV_CACHE_MISS_TTL_MS)));
+  }
+  std::unique_ptr<HttpFetcherAsync> buyer_kv_fetcher =
+      std::make_unique<MultiCurlHttpFetcherAsync>(
+          executor.get(), /*keepalive_interval_sec=*/2,
+          /*keepalive_idle_sec=*/2,
+          config_client.GetBooleanParameter(ENABLE_CURL_EVENT_LOOP),
+          config_client.GetBooleanParameter(ENABLE_KV_HTTP2_MULTIPLEXING));
+  if (config_client.GetBooleanParameter(ENABLE_KV_REQUEST_HEDGING)) {
+    buyer_kv_fetcher = std::make_unique<HedgingHttpFetcherAsync>(
+        std::move(buyer_kv_fetcher), executor.get(),
+        HedgingOptions{
+            .latency_percentile =
+                config_client.GetIntParameter(KV_HEDGING_LATENCY_PERCENTILE),
+            .budget_percent =
+                config_client.GetIntParameter(KV_HEDGING_BUDGET_PERCENT)});
+  }
+  if (config_client.GetBooleanParameter(ENABLE_KV_REQUEST_COALESCING)) {
+    buyer_kv_fetcher = std::make_unique<SingleFlightHttpFetcherAsync>(
+        std::move(buyer_kv_fetcher));
+  }
   std::unique_ptr<BuyerKeyValueAsyncHttpClient> buyer_kv_async_http_client;
   buyer_kv_async_http_client = std::make_unique<BuyerKeyValueAsyncHttpClient>(
-      buyer_kv_server_addr,
-      std::make_unique<MultiCurlHttpFetcherAsync>(executor.get()), true);
+      buyer_kv_server_addr, std::move(buyer_kv_fetcher), true,
+      std::move(buyer_kv_cache),
+      KeyValueRequestOptions{
+          .use_post =
+              config_client.GetBooleanParameter(ENABLE_KV_POST_REQUESTS),
+          .compress_body =
+              config_client.GetBooleanParameter(ENABLE_KV_REQUEST_COMPRESSION),
+          .max_keys_per_request =
+              config_client.GetIntParameter(KV_MAX_KEYS_PER_REQUEST),
+          .accept_table =
+              config_client.GetBooleanParameter(ENABLE_KV_TABLE_RESPONSES),
+          .batch_max_keys = config_client.GetIntParameter(KV_BATCH_MAX_KEYS),
+          .batch_max_delay = absl::Microseconds(
+              config_client.GetIntParameter(KV_BATCH_MAX_DELAY_US)),
+          .batch_executor = executor.get()});
 
   server_common::BuildDependentConfig telemetry_config(
       config_client
           .GetCustomParameter<server_common::TelemetryFlag>(TELEMETRY_CONFIG)
           .server_config);
+  const bool profiling_allowed = telemetry_config.ProfilingAllowed();
   std::string collector_endpoint =
       config_client.GetStringParameter(COLLECTOR_ENDPOINT).data();
   server_common::InitTelemetry(
@@ -201,25 +459,113 @@ absl::Status RunServer() {
                                  collector_endpoint);
   server_common::ConfigureLogger(CreateSharedAttributes(&config_util),
                                  collector_endpoint);
-  AddSystemMetric(metric::BfeContextMap(
+  auto* context_map = metric::BfeContextMap(
       std::move(telemetry_config),
       server_common::ConfigurePrivateMetrics(
           CreateSharedAttributes(&config_util),
           CreateMetricsOptions(telemetry_config.metric_export_interval_ms()),
           collector_endpoint),
-      config_util.GetService(), kOpenTelemetryVersion.data()));
+      config_util.GetService(), kOpenTelemetryVersion.data());
+  AddSystemMetric(context_map);
+  AddGrpcServerMetric(context_map);
+  AddConcurrencyLimiterMetric(context_map);
+  AddMemoryGovernorMetric(context_map);
+  AddSlowRequestMetric(context_map);
+  AddRequestMemoryBudgetMetric(context_map);
+  AddHttpConnectionMetric(context_map);
+  AddKeyValueCacheMetric(context_map);
+  AddHedgingMetric(context_map);
+  AddKeyValueShardMetric(context_map);
+  AddMessageCompressionMetric(context_map);
+  AddCancelledWorkMetric(context_map);
+  AddShadowTrafficMetric(context_map);
 
-  BuyerFrontEndService buyer_frontend_service(
+  std::unique_ptr<ConcurrencyLimiter> concurrency_limiter;
+  if (config_client.GetBooleanParameter(ENABLE_CONCURRENCY_LIMITER)) {
+    concurrency_limiter =
+        std::make_unique<ConcurrencyLimiter>(ConcurrencyLimiterOptions{
+            .max_limit = config_client.GetIntParameter(CONCURRENCY_LIMIT_MAX)});
+  } else if (memory_watermarks.has_value()) {
+    // Only sheds requests under memory pressure.
+    concurrency_limiter = std::make_unique<ConcurrencyLimiter>(
+        FixedConcurrencyLimit(
+            config_client.GetIntParameter(CONCURRENCY_LIMIT_MAX)));
+  }
+  std::unique_ptr<MemoryGovernor> memory_governor;
+  if (memory_watermarks.has_value()) {
+    std::vector<MemoryGovernor::Listener> listeners;
+    listeners.push_back([concurrency_limiter = concurrency_limiter.get()](
+                            MemoryPressure pressure) {
+      concurrency_limiter->SetLimitScale(ConcurrencyScaleOf(pressure));
+    });
+    if (buyer_kv_cache != nullptr) {
+      listeners.push_back([buyer_kv_cache](MemoryPressure pressure) {
+        buyer_kv_cache->SetCapacityScale(CacheScaleOf(pressure));
+      });
+    }
+    memory_governor = std::make_unique<MemoryGovernor>(
+        *memory_watermarks, kMemoryGovernorPeriod, std::move(listeners));
+  }
+  // Shapes the responses to the chaff requests after the real ones.
+  ChaffResponseShaper chaff_response_shaper;
+
+  std::unique_ptr<BiddingSignalsAsyncProvider> bidding_signals_provider =
       std::make_unique<HttpBiddingSignalsAsyncProvider>(
-          std::move(buyer_kv_async_http_client)),
+          std::move(buyer_kv_async_http_client),
+          config_client.GetIntParameter(KV_NUM_SHARDS));
+  std::unique_ptr<BiddingSignalsSnapshotFetcher> snapshot_fetcher;
+  if (std::string bucket = std::string(
+          config_client.GetStringParameter(BIDDING_SIGNALS_SNAPSHOT_BUCKET));
+      !bucket.empty()) {
+    auto snapshot_provider =
+        std::make_unique<SnapshotBiddingSignalsAsyncProvider>(
+            std::move(bidding_signals_provider),
+            config_client.GetBooleanParameter(ENABLE_KV_TABLE_RESPONSES));
+    snapshot_fetcher = std::make_unique<BiddingSignalsSnapshotFetcher>(
+        std::move(bucket),
+        std::string(
+            config_client.GetStringParameter(BIDDING_SIGNALS_SNAPSHOT_BLOB)),
+        absl::Milliseconds(config_client.GetIntParameter(
+            BIDDING_SIGNALS_SNAPSHOT_FETCH_PERIOD_MS)),
+        executor.get(), google::scp::cpio::BlobStorageClientFactory::Create(),
+        snapshot_provider.get());
+    snapshot_fetcher->Start();
+    bidding_signals_provider = std::move(snapshot_provider);
+  }
+
+  // Connects the channels to the bidding service ahead of the first requests,
+  // the server being reported ready once they are warm, if enabled.
+  std::unique_ptr<ChannelWarmer> channel_warmer;
+  if (config_client.GetBooleanParameter(ENABLE_CHANNEL_PRE_WARMING)) {
+    channel_warmer = std::make_unique<ChannelWarmer>(absl::Milliseconds(
+        config_client.GetIntParameter(CHANNEL_PRE_WARMING_TIMEOUT_MS)));
+  }
+  BuyerFrontEndService buyer_frontend_service(
+      std::move(bidding_signals_provider),
       BiddingServiceClientConfig{
           .server_addr = bidding_server_addr,
           .compression = enable_bidding_compression,
           .secure_client =
               config_client.GetBooleanParameter(BIDDING_EGRESS_TLS),
           .encryption_enabled =
-              config_client.GetBooleanParameter(ENABLE_ENCRYPTION)},
-      CreateKeyFetcherManager(config_client), CreateCryptoClient(),
+              config_client.GetBooleanParameter(ENABLE_ENCRYPTION),
+          .num_channels =
+              config_client.GetIntParameter(BIDDING_CHANNEL_POOL_SIZE),
+          .flow_control_window_bytes = config_client.GetIntParameter(
+              BIDDING_FLOW_CONTROL_WINDOW_BYTES),
+          .compression_algorithm = compression_algorithm,
+          .compression_min_message_bytes = config_client.GetIntParameter(
+              GRPC_COMPRESSION_MIN_MESSAGE_BYTES),
+          .channel_warmer = channel_warmer.get(),
+          .least_loaded_routing =
+              config_client.GetBooleanParameter(BIDDING_LEAST_LOADED_ROUTING),
+          .shadow_server_addr = std::string(
+              config_client.GetStringParameter(SHADOW_BIDDING_SERVER_ADDR)),
+          .shadow_traffic_percent =
+              config_client.GetIntParameter(SHADOW_TRAFFIC_PERCENT)},
+      CreateKeyFetcherManager(config_client),
+      CreateCryptoClient(
+          config_client.GetBooleanParameter(ENABLE_BORINGSSL_CRYPTO)),
       GetBidsConfig{
           config_client.GetIntParameter(GENERATE_BID_TIMEOUT_MS),
           config_client.GetIntParameter(BIDDING_SIGNALS_LOAD_TIMEOUT_MS),
@@ -229,12 +575,32 @@ absl::Status RunServer() {
           config_client.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS),
           config_client.GetBooleanParameter(ENABLE_OTEL_BASED_LOGGING),
           std::string(config_client.GetStringParameter(CONSENTED_DEBUG_TOKEN)),
+          config_client.GetIntParameter(GENERATE_BIDS_PARTITION_THRESHOLD),
+          config_client.GetIntParameter(GENERATE_BIDS_MAX_PARTITIONS),
+          concurrency_limiter.get(),
+          config_client.GetBooleanParameter(ENABLE_BIDDING_SIGNALS_PROJECTION),
+          int64_t{config_client.GetIntParameter(REQUEST_MEMORY_BUDGET_MB)}
+              << 20,
+          &chaff_response_shaper,
+          executor.get(),
       },
       enable_buyer_frontend_benchmarking);
 
   grpc::EnableDefaultHealthCheckService(true);
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
   ServerBuilder builder;
+  ApplyGrpcServerOptions(
+      {.max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS),
+       .memory_quota_mb =
+           config_client.GetIntParameter(GRPC_SERVER_MEMORY_QUOTA_MB),
+       .num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_concurrent_streams =
+           config_client.GetIntParameter(GRPC_MAX_CONCURRENT_STREAMS)},
+      builder);
+  if (WorkerProcessCount() > 1) {
+    // The workers all listen on the port.
+    builder.AddChannelArgument(GRPC_ARG_ALLOW_REUSEPORT, 1);
+  }
   std::string server_address = absl::StrCat("0.0.0.0:", port);
   if (config_client.GetBooleanParameter(BFE_INGRESS_TLS)) {
     std::vector<grpc::experimental::IdentityKeyCertPair> key_cert_pairs{{
@@ -259,16 +625,38 @@ absl::Status RunServer() {
     builder.AddListeningPort(server_address, grpc::InsecureServerCredentials());
   }
   builder.RegisterService(&buyer_frontend_service);
+  // Served on its own port, only if allowed by the telemetry config.
+  ProfilingService profiling_service;
+  std::unique_ptr<Server> profiling_server;
+  if (profiling_allowed) {
+    PS_ASSIGN_OR_RETURN(
+        profiling_server,
+        StartProfilingServer(profiling_service,
+                             config_client.GetIntParameter(PROFILING_PORT)));
+  }
 
   std::unique_ptr<Server> server(builder.BuildAndStart());
   if (server == nullptr) {
     return absl::UnavailableError("Error starting Server.");
   }
-  VLOG(1) << "Server listening on " << server_address;
+  std::optional<ServerReadiness> readiness;
+  if (channel_warmer != nullptr) {
+    readiness.emplace(server->GetHealthCheckService(), [&channel_warmer]() {
+      return channel_warmer->IsWarm();
+    });
+  }
+  VLOG(1) << "Server listening on " << server_address
+          << " in worker process " << WorkerProcessIndex();
 
   // Wait for the server to shut down. Note that some other thread must be
   // responsible for shutting down the server for this call to ever return.
   server->Wait();
+  if (profiling_server) {
+    profiling_server->Shutdown();
+  }
+  if (snapshot_fetcher != nullptr) {
+    snapshot_fetcher->End();
+  }
   return absl::OkStatus();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -276,7 +664,11 @@ absl::Status RunServer() {
 int main(int argc, char** argv) {
   signal(SIGSEGV, privacy_sandbox::bidding_auction_servers::SignalHandler);
   absl::ParseCommandLine(argc, argv);
+  absl::InitializeSymbolizer(argv[0]);
   google::InitGoogleLogging(argv[0]);
+  // Forked before the CPIO library and the config client start threads.
+  privacy_sandbox::bidding_auction_servers::RunWorkerProcesses(
+      absl::GetFlag(FLAGS_worker_processes));
 
   google::scp::cpio::CpioOptions cpio_options;
 
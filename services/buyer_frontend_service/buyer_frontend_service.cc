@@ -22,12 +22,15 @@
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
 #include "services/buyer_frontend_service/get_bids_unary_reactor.h"
+#include "services/common/clients/mirroring_async_client.h"
 #include "services/common/metric/server_definition.h"
-#include "src/cpp/telemetry/telemetry.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/request_class.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 namespace {
+// response: null for GetBidsStream, whose size is not recorded.
 void LogMetrics(const GetBidsRequest* request, GetBidsResponse* response) {
   auto& metric_context = metric::BfeContextMap()->Get(request);
   LogIfError(
@@ -42,9 +45,11 @@ void LogMetrics(const GetBidsRequest* request, GetBidsResponse* response) {
   LogIfError(metric_context.LogHistogram<server_common::metric::kRequestByte>(
       (int)request->ByteSizeLong()));
 
-  LogIfError(
-      metric_context.LogHistogramDeferred<server_common::metric::kResponseByte>(
-          [response]() -> int { return response->ByteSizeLong(); }));
+  if (response != nullptr) {
+    LogIfError(metric_context.LogHistogramDeferred<
+               server_common::metric::kResponseByte>(
+        [response]() -> int { return response->ByteSizeLong(); }));
+  }
   LogIfError(metric_context.LogUpDownCounterDeferred<
              server_common::metric::kTotalRequestFailedCount>(
       [&metric_context]() -> int {
@@ -66,25 +71,54 @@ BuyerFrontEndService::BuyerFrontEndService(
       enable_benchmarking_(enable_benchmarking),
       key_fetcher_manager_(std::move(key_fetcher_manager)),
       crypto_client_(std::move(crypto_client)),
-      stub_(Bidding::NewStub(CreateChannel(client_config.server_addr,
-                                           client_config.compression,
-                                           client_config.secure_client))),
+      stubs_(CreateStubs<Bidding>(CreateChannels(
+                 client_config.server_addr, client_config.compression,
+                 client_config.secure_client, client_config.num_channels,
+                 client_config.flow_control_window_bytes,
+                 client_config.compression_algorithm,
+                 client_config.channel_warmer)),
+             client_config.least_loaded_routing),
       bidding_async_client_(std::make_unique<BiddingAsyncGrpcClient>(
           key_fetcher_manager_.get(), crypto_client_.get(), client_config,
-          stub_.get())) {
+          &stubs_)) {
+  if (!client_config.shadow_server_addr.empty()) {
+    shadow_stubs_ = std::make_unique<StubPool<Bidding::Stub>>(
+        CreateStubs<Bidding>(CreateChannels(
+            client_config.shadow_server_addr, client_config.compression,
+            client_config.secure_client, client_config.num_channels,
+            client_config.flow_control_window_bytes,
+            client_config.compression_algorithm,
+            client_config.channel_warmer)),
+        client_config.least_loaded_routing);
+    bidding_async_client_ = std::make_unique<MirroringAsyncClient<
+        GenerateBidsRequest, GenerateBidsResponse,
+        GenerateBidsRequest::GenerateBidsRawRequest,
+        GenerateBidsResponse::GenerateBidsRawResponse>>(
+        std::move(bidding_async_client_),
+        std::make_shared<BiddingAsyncGrpcClient>(
+            key_fetcher_manager_.get(), crypto_client_.get(), client_config,
+            shadow_stubs_.get()),
+        client_config.shadow_traffic_percent);
+  }
   if (config_.is_protected_app_signals_enabled) {
     protected_app_signals_bidding_async_client_ =
         std::make_unique<ProtectedAppSignalsBiddingAsyncGrpcClient>(
             key_fetcher_manager_.get(), crypto_client_.get(), client_config,
-            stub_.get());
+            &stubs_);
   }
 }
 
 grpc::ServerUnaryReactor* BuyerFrontEndService::GetBids(
     grpc::CallbackServerContext* context, const GetBidsRequest* request,
     GetBidsResponse* response) {
-  auto scope = opentelemetry::trace::Scope(
-      server_common::GetTracer()->StartSpan("GetBids"));
+  ConcurrencyLimiter::Permit permit;
+  if (config_.concurrency_limiter != nullptr) {
+    permit = config_.concurrency_limiter->TryAcquire(
+        GetRequestClass(context->client_metadata()));
+    if (!permit) {
+      return FinishShedRequest(context);
+    }
+  }
   LogMetrics(request, response);
 
   VLOG(2) << "\nGetBidsRequest:\n" << request->DebugString();
@@ -99,7 +133,33 @@ grpc::ServerUnaryReactor* BuyerFrontEndService::GetBids(
   auto reactor = std::make_unique<GetBidsUnaryReactor>(
       *context, *request, *response, *bidding_signals_async_provider_,
       *bidding_async_client_, config_, key_fetcher_manager_.get(),
-      crypto_client_.get(), enable_benchmarking_);
+      crypto_client_.get(), enable_benchmarking_,
+      protected_app_signals_bidding_async_client_.get());
+  reactor->SetConcurrencyPermit(std::move(permit));
+  reactor->Execute();
+  return reactor.release();
+}
+
+grpc::ServerWriteReactor<GetBidsResponse>* BuyerFrontEndService::GetBidsStream(
+    grpc::CallbackServerContext* context, const GetBidsRequest* request) {
+  ConcurrencyLimiter::Permit permit;
+  if (config_.concurrency_limiter != nullptr) {
+    permit = config_.concurrency_limiter->TryAcquire(
+        GetRequestClass(context->client_metadata()));
+    if (!permit) {
+      return FinishShedStream<GetBidsResponse>();
+    }
+  }
+  LogMetrics(request, /*response=*/nullptr);
+  VLOG(2) << "\nGetBidsStream request:\n" << request->DebugString();
+
+  // Will be deleted in onDone
+  auto reactor = std::make_unique<GetBidsStreamReactor>(
+      *context, *request, /*get_bids_response=*/nullptr,
+      *bidding_signals_async_provider_, *bidding_async_client_, config_,
+      key_fetcher_manager_.get(), crypto_client_.get(), enable_benchmarking_,
+      protected_app_signals_bidding_async_client_.get());
+  reactor->SetConcurrencyPermit(std::move(permit));
   reactor->Execute();
   return reactor.release();
 }
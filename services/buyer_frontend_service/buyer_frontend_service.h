@@ -58,6 +58,13 @@ class BuyerFrontEndService final : public BuyerFrontEnd::CallbackService {
                                     const GetBidsRequest* request,
                                     GetBidsResponse* response) override;
 
+  // Same as GetBids, but streams the bids of each partition of the request
+  // sent to the Bidding service, encrypted on their own, as soon as they are
+  // generated.
+  grpc::ServerWriteReactor<GetBidsResponse>* GetBidsStream(
+      grpc::CallbackServerContext* context,
+      const GetBidsRequest* request) override;
+
  private:
   // The Bidding signals provider is used to fetch signals required for bidding
   // from external sources, such as a KeyValue server or an HTTP server.
@@ -68,8 +75,10 @@ class BuyerFrontEndService final : public BuyerFrontEnd::CallbackService {
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
   std::unique_ptr<CryptoClientWrapperInterface> crypto_client_;
-  // Stub to make GRPC calls to the bidding service.
-  std::unique_ptr<Bidding::Stub> stub_;
+  // Stubs to make GRPC calls to the bidding service, one per channel.
+  StubPool<Bidding::Stub> stubs_;
+  // Stubs of the shadow bidding service, if any.
+  std::unique_ptr<StubPool<Bidding::Stub>> shadow_stubs_;
   // The BiddingAsyncClient is used to call Bidding Service to execute
   // AdTech's code in a secure privacy sandbox and generate the bids.
   // The bids received in response from the BiddingAsyncClient are returned
@@ -15,8 +15,13 @@
 #ifndef SERVICES_BUYER_FRONTEND_SERVICE_DATA_GET_BIDS_CONFIG_H_
 #define SERVICES_BUYER_FRONTEND_SERVICE_DATA_GET_BIDS_CONFIG_H_
 
+#include <cstdint>
 #include <string>
 
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "src/cpp/concurrent/executor.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
 
 struct GetBidsConfig {
@@ -36,6 +41,27 @@ struct GetBidsConfig {
   bool enable_otel_based_logging;
   // The secret token for AdTech consented debugging.
   std::string consented_debug_token;
+  // Requests with more interest groups than this are split into concurrent
+  // generate bid requests of about as many interest groups each. Requests
+  // are not split if 0.
+  int generate_bids_partition_threshold = 0;
+  // The max number of generate bid requests a request is split into.
+  int generate_bids_max_partitions = 1;
+  // Sheds the requests past the concurrency limit of the server, if any. Not
+  // owned.
+  ConcurrencyLimiter* concurrency_limiter = nullptr;
+  // Drops the trusted bidding signals of the keys that no interest group of
+  // the request asks for before sending them to the bidding service.
+  bool project_bidding_signals = false;
+  // Most bytes a request may take for its decrypted payload and the bidding
+  // signals fetched for it, the requests over the budget failing with
+  // RESOURCE_EXHAUSTED. No budget when 0.
+  int64_t request_memory_budget_bytes = 0;
+  // Shapes the responses to the chaff requests after the real ones, and runs
+  // the timers delaying them. Chaff requests are answered right away with an
+  // unpadded empty response if either is null. Not owned.
+  ChaffResponseShaper* chaff_response_shaper = nullptr;
+  server_common::Executor* executor = nullptr;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
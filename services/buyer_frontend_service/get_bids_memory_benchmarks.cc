@@ -0,0 +1,199 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Heap usage of a GetBids request, by phase of the work GetBidsUnaryReactor
+// does on it, up to the GenerateBids request sent to the bidding service.
+//
+// BM_GetBidsMemory runs a GetBidsRawRequest of `igs` interest groups of 10
+// ads each through the phases below, with `signal_bytes` bytes of trusted
+// bidding signals per interest group, looked up from 2 Key-Value server
+// shards. It calls the functions the reactor calls rather than the reactor,
+// which needs the clients of a server. Allocations are counted by
+// services/common/test/utils/heap_counter.h. The following are exported as
+// counters, in bytes per request:
+// - <phase>_bytes: the bytes allocated by the phase, whether freed or not.
+// - <phase>_peak_bytes: the peak of the bytes live during the phase, over
+//   those live when it started.
+// where the phases are decrypt (the decrypted payload, as HPKE is not
+// measured, and its parsing), proto_build (the GenerateBids request built
+// from the interest groups), signal_parse (the merge of the responses of the
+// shards, and their addition to the request) and bidding_request (its
+// serialization, as sent to the bidding service).
+// - request_bytes and request_peak_bytes: the same for the whole request.
+// - in_flight_bytes: the bytes live once the bidding request is sent, as held
+//   by each request waiting for bids.
+// - allocations: the allocations per request.
+//
+// Run with:
+//   bazel run -c opt //services/buyer_frontend_service:get_bids_memory_benchmarks
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "services/buyer_frontend_service/data/bidding_signals.h"
+#include "services/buyer_frontend_service/util/proto_factory.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+#include "services/common/test/utils/benchmark_requests.h"
+#include "services/common/test/utils/heap_counter.h"
+#include "services/common/test/utils/js_workloads.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kAdsPerInterestGroup = 10;
+constexpr int kKeyValueShards = 2;
+
+// Returns the responses of the Key-Value server shards to the lookup of the
+// keys of `num_igs` interest groups, each holding `signal_bytes` bytes of
+// nested signals.
+std::vector<std::string> MakeKeyValueResponses(int num_igs, int signal_bytes) {
+  const std::string signal =
+      MakeJsWorkloadTrustedSignal(JsWorkload::kJsonHeavy, signal_bytes);
+  std::vector<std::string> keys(kKeyValueShards);
+  for (int i = 0; i < num_igs; i++) {
+    std::string& shard_keys = keys[i % kKeyValueShards];
+    absl::StrAppend(&shard_keys, shard_keys.empty() ? "" : ",", "\"key_", i,
+                    "\":", signal);
+  }
+  std::vector<std::string> responses;
+  for (const std::string& shard_keys : keys) {
+    responses.push_back(absl::StrCat(R"({"keys":{)", shard_keys, "}}"));
+  }
+  return responses;
+}
+
+struct GetBidsPhases {
+  HeapPhase decrypt;
+  HeapPhase proto_build;
+  HeapPhase signal_parse;
+  HeapPhase bidding_request;
+  // Highest request_peak_bytes of a request.
+  int64_t request_peak_bytes = 0;
+
+  // Ends `phase`, and accounts for its peak in that of the request.
+  void End(HeapPhase& phase) {
+    request_peak_bytes =
+        std::max(request_peak_bytes, phase.End().peak_live_bytes);
+  }
+};
+
+void BM_GetBidsMemory(benchmark::State& state) {
+  const int num_igs = state.range(0);
+  const std::string ciphertext =
+      MakeBenchmarkGetBidsRawRequest(
+          {.num_igs = num_igs,
+           .num_ads = kAdsPerInterestGroup,
+           .user_bidding_signals_workload = JsWorkload::kJsonHeavy})
+          .SerializeAsString();
+  const std::vector<std::string> key_value_responses =
+      MakeKeyValueResponses(num_igs, state.range(1));
+  GetBidsPhases phases;
+  int64_t request_bytes = 0;
+  int64_t in_flight_bytes = 0;
+  int64_t allocations = 0;
+  for (auto _ : state) {
+    std::vector<absl::StatusOr<HTTPResponse>> shard_responses;
+    for (const std::string& body : key_value_responses) {
+      shard_responses.push_back(HTTPResponse{.body = body, .status_code = 200});
+    }
+    HeapCounter::Reset();
+
+    phases.decrypt.Begin();
+    const std::string payload = ciphertext;
+    GetBidsRequest::GetBidsRawRequest raw_request;
+    CHECK(raw_request.ParseFromString(payload));
+    phases.End(phases.decrypt);
+
+    phases.proto_build.Begin();
+    std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+        bidding_request = ProtoFactory::CreateGenerateBidsRawRequest(
+            &raw_request, raw_request.mutable_buyer_input(),
+            raw_request.log_context());
+    phases.End(phases.proto_build);
+
+    phases.signal_parse.Begin();
+    absl::StatusOr<HTTPResponse> merged =
+        MergeKeyValueResponses(std::move(shard_responses));
+    CHECK(merged.ok()) << merged.status();
+    auto bidding_signals = std::make_unique<BiddingSignals>();
+    bidding_signals->trusted_signals =
+        std::make_unique<std::string>(std::move(merged->body));
+    ProtoFactory::AddBiddingSignals(raw_request.buyer_input(),
+                                    std::move(bidding_signals),
+                                    *bidding_request);
+    phases.End(phases.signal_parse);
+
+    phases.bidding_request.Begin();
+    const std::string serialized = bidding_request->SerializeAsString();
+    phases.End(phases.bidding_request);
+    benchmark::DoNotOptimize(serialized);
+
+    const HeapUsage usage = HeapCounter::Get();
+    request_bytes += usage.allocated_bytes;
+    allocations += usage.allocations;
+    in_flight_bytes = std::max(in_flight_bytes, usage.live_bytes);
+    phases.request_peak_bytes =
+        std::max(phases.request_peak_bytes, usage.peak_live_bytes);
+  }
+
+  const auto per_request = [](int64_t value) {
+    return benchmark::Counter(value, benchmark::Counter::kAvgIterations,
+                              benchmark::Counter::kIs1024);
+  };
+  const auto bytes = [](int64_t value) {
+    return benchmark::Counter(value, benchmark::Counter::kDefaults,
+                              benchmark::Counter::kIs1024);
+  };
+  const auto export_phase = [&](absl::string_view name,
+                                 const HeapPhase& phase) {
+    state.counters[absl::StrCat(name, "_bytes")] =
+        per_request(phase.allocated_bytes());
+    state.counters[absl::StrCat(name, "_peak_bytes")] =
+        bytes(phase.peak_live_bytes());
+  };
+  export_phase("decrypt", phases.decrypt);
+  export_phase("proto_build", phases.proto_build);
+  export_phase("signal_parse", phases.signal_parse);
+  export_phase("bidding_request", phases.bidding_request);
+  state.counters["request_bytes"] = per_request(request_bytes);
+  state.counters["request_peak_bytes"] = bytes(phases.request_peak_bytes);
+  state.counters["in_flight_bytes"] = bytes(in_flight_bytes);
+  state.counters["allocations"] = per_request(allocations);
+}
+
+// Args: number of interest groups, bidding signal bytes per interest group.
+void GetBidsMemoryArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"igs", "signal_bytes"});
+  for (int igs : {10, 100, 1000}) {
+    for (int signal_bytes : {64, 1024, 16384}) {
+      benchmark->Args({igs, signal_bytes});
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+}
+
+BENCHMARK(BM_GetBidsMemory)->Apply(GetBidsMemoryArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -14,33 +14,64 @@
 
 #include "services/buyer_frontend_service/get_bids_unary_reactor.h"
 
+#include <algorithm>
+
 #include "absl/container/flat_hash_set.h"
 #include "absl/strings/str_format.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "glog/logging.h"
+#include "services/buyer_frontend_service/util/bidding_signals_projection.h"
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
 #include "services/buyer_frontend_service/util/proto_factory.h"
 #include "services/common/constants/user_error_strings.h"
 #include "services/common/loggers/build_input_process_response_benchmarking_logger.h"
 #include "services/common/loggers/no_ops_logger.h"
 #include "services/common/util/consented_debugging_logger.h"
+#include "services/common/util/error_accumulator.h"
+#include "services/common/util/request_deadline.h"
 #include "services/common/util/request_metadata.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/seller_frontend_service/util/web_utils.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
+using GenerateProtectedAppSignalsBidsRawRequest =
+    GenerateProtectedAppSignalsBidsRequest::
+        GenerateProtectedAppSignalsBidsRawRequest;
+using GenerateProtectedAppSignalsBidsRawResponse =
+    GenerateProtectedAppSignalsBidsResponse::
+        GenerateProtectedAppSignalsBidsRawResponse;
+using GenerateBidsRawResponseOr = absl::StatusOr<
+    std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>;
+
+namespace {
+
+// Stages joined by GetBidsReactor::bidding_inputs_.
+enum BiddingInput { kBiddingSignals, kBiddingRequest, kNumBiddingInputs };
+
+// Stages joined by GetBidsReactor::pipelines_.
+enum Pipeline {
+  kProtectedAudiencePipeline,
+  kProtectedAppSignalsPipeline,
+  kNumPipelines
+};
 
-bool GetBidsUnaryReactor::DecryptRequest() {
+}  // namespace
+
+template <typename ServerReactor>
+bool GetBidsReactor<ServerReactor>::DecryptRequest() {
   if (request_->key_id().empty()) {
     VLOG(1) << kEmptyKeyIdError;
-    Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, kEmptyKeyIdError));
+    FinishRpc(
+        grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, kEmptyKeyIdError));
     return false;
   }
 
   if (request_->request_ciphertext().empty()) {
     VLOG(1) << kEmptyCiphertextError;
-    Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
-                        kEmptyCiphertextError));
+    FinishRpc(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                           kEmptyCiphertextError));
     return false;
   }
 
@@ -48,33 +79,71 @@ bool GetBidsUnaryReactor::DecryptRequest() {
       key_fetcher_manager_->GetPrivateKey(request_->key_id());
   if (!private_key.has_value()) {
     VLOG(1) << kInvalidKeyIdError;
-    Finish(
+    FinishRpc(
         grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, kInvalidKeyIdError));
     return false;
   }
 
+  const absl::Time decrypt_start = absl::Now();
+  const absl::Duration decrypt_cpu_start = ThreadCpuTime();
   absl::StatusOr<HpkeDecryptResponse> decrypt_response =
       crypto_client_->HpkeDecrypt(*private_key, request_->request_ciphertext());
   if (!decrypt_response.ok()) {
     VLOG(1) << kMalformedCiphertext;
-    Finish(
+    FinishRpc(
         grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, kMalformedCiphertext));
     return false;
   }
+  const absl::Time decrypt_end = absl::Now();
+  crypto_metrics_.Add(CryptoOperation::kHpkeDecrypt,
+                      decrypt_end - decrypt_start,
+                      request_->request_ciphertext().size());
+  tracer_.AddSpan("DecryptRequest", decrypt_start, decrypt_end);
+  timeline_.Record(RequestStage::kDecrypt, decrypt_start, decrypt_end);
 
   hpke_secret_ = std::move(decrypt_response->secret());
+  if (!memory_budget_.Charge(decrypt_response->payload().size())) {
+    VLOG(1) << kRequestMemoryBudgetExceeded;
+    RecordMemoryBudgetExceeded(MemoryBudgetAction::kRejected);
+    FinishRpc(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                           kRequestMemoryBudgetExceeded));
+    return false;
+  }
   if (!raw_request_.ParseFromString(decrypt_response->payload())) {
     VLOG(1) << "Unable to parse proto from the decrypted request: "
             << kMalformedCiphertext;
-    Finish(
+    FinishRpc(
         grpc::Status(grpc::StatusCode::INVALID_ARGUMENT, kMalformedCiphertext));
     return false;
   }
-
+  if (!raw_request_.compressed_buyer_input().empty()) {
+    // Forwarded as the client sent it by the SFE, which only summarized it.
+    ErrorAccumulator error_accumulator;
+    *raw_request_.mutable_buyer_input() =
+        DecodeBuyerInput(/*owner=*/"", raw_request_.compressed_buyer_input(),
+                         error_accumulator);
+    raw_request_.clear_compressed_buyer_input();
+    if (error_accumulator.HasErrors()) {
+      VLOG(1) << "Unable to decode the compressed buyer input";
+      FinishRpc(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+                             kMalformedCompressedBuyerInput));
+      return false;
+    }
+    if (memory_budget_.enabled() &&
+        !memory_budget_.Charge(raw_request_.buyer_input().ByteSizeLong())) {
+      VLOG(1) << kRequestMemoryBudgetExceeded;
+      RecordMemoryBudgetExceeded(MemoryBudgetAction::kRejected);
+      FinishRpc(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                             kRequestMemoryBudgetExceeded));
+      return false;
+    }
+  }
+  cpu_time_.AddSince(CpuStage::kDecrypt, decrypt_cpu_start);
   return true;
 }
 
-void GetBidsUnaryReactor::Execute() {
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::Execute() {
   benchmarking_logger_->Begin();
   DCHECK(config_.encryption_enabled);
   if (!DecryptRequest()) {
@@ -82,11 +151,12 @@ void GetBidsUnaryReactor::Execute() {
     return;
   }
   VLOG(5) << "Successfully decrypted the request";
+  if (raw_request_.is_chaff()) {
+    HandleChaffRequest();
+    return;
+  }
+  const absl::Duration prepare_cpu_start = ThreadCpuTime();
 
-  GetProtectedAudienceBids();
-}
-
-void GetBidsUnaryReactor::GetProtectedAudienceBids() {
   // Logger for consented debugging.
   // TODO(b/279955398): Refactor ConsentedDebuggingLogger to create right next
   // to ContextLogger, and use a common helper function.
@@ -94,120 +164,517 @@ void GetBidsUnaryReactor::GetProtectedAudienceBids() {
     if (absl::string_view token = config_.consented_debug_token;
         !token.empty()) {
       ConsentedDebuggingLogger debug_logger(GetLoggingContext(), token);
-      debug_logger.vlog(
-          0, absl::StrCat("GetBidsRawRequest: ", raw_request_.DebugString()));
+      debug_logger.LogMessage(0, "GetBidsRawRequest: ", raw_request_);
     }
   }
 
-  BiddingSignalsRequest bidding_signals_request(raw_request_, kv_metadata_);
+  // The Protected Audience and Protected App Signals bids are generated by
+  // independent pipelines, joined by pipelines_. A request with app signals
+  // but no interest groups skips the Protected Audience pipeline.
+  const bool run_protected_app_signals =
+      config_.is_protected_app_signals_enabled &&
+      protected_app_signals_bidding_async_client_ != nullptr &&
+      raw_request_.has_protected_app_signals_buyer_input();
+  const bool run_protected_audience =
+      !run_protected_app_signals ||
+      raw_request_.buyer_input().interest_groups_size() > 0;
+  cpu_time_.AddSince(CpuStage::kPrepare, prepare_cpu_start);
+  start_time_ = absl::Now();
+  // A pipeline that is not run has neither bids nor an error.
+  if (!run_protected_app_signals) {
+    pipelines_.Set(kProtectedAppSignalsPipeline, absl::OkStatus());
+  }
+  if (!run_protected_audience) {
+    pipelines_.Set(kProtectedAudiencePipeline, absl::OkStatus());
+  }
+  if (run_protected_app_signals) {
+    // Sent first, since the Protected Audience pipeline moves the signals
+    // out of the request.
+    GetProtectedAppSignalsBids(
+        ProtoFactory::CreateGenerateProtectedAppSignalsBidsRawRequest(
+            raw_request_));
+  }
+  if (run_protected_audience) {
+    GetProtectedAudienceBids();
+  }
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::HandleChaffRequest() {
+  // Only counted: neither the request nor its response is logged.
+  LogIfError(
+      metric_context_->LogUpDownCounter<metric::kBfeChaffRequestCount>(1));
+  start_time_ = absl::Now();
+  if (config_.chaff_response_shaper == nullptr || config_.executor == nullptr) {
+    chaff_shape_ = {{absl::ZeroDuration(), 0}};
+    SendChaffChunk(0);
+    return;
+  }
+  chaff_shape_ = config_.chaff_response_shaper->Sample(kStreamed);
+  ScheduleChaffChunk(0);
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::ScheduleChaffChunk(size_t i) {
+  // The reactor is deleted only once finished, after the last timer fired.
+  config_.executor->RunAfter(
+      std::max(absl::ZeroDuration(),
+               start_time_ + chaff_shape_[i].latency - absl::Now()),
+      [this, i]() { SendChaffChunk(i); });
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::SendChaffChunk(size_t i) {
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  raw_response.mutable_bids();
+  // Zeros, as the padding is encrypted with the response.
+  raw_response.mutable_padding()->assign(
+      ChaffPaddingBytes(chaff_shape_[i].raw_response_bytes,
+                        raw_response.ByteSizeLong()),
+      '\0');
+  absl::Status status;
+  if constexpr (kStreamed) {
+    status = StreamBids(raw_response);
+  } else {
+    status = EncryptResponse(raw_response, *get_bids_response_);
+  }
+  if (!status.ok()) {
+    FinishRpc(grpc::Status(grpc::StatusCode::INTERNAL, status.ToString()));
+    return;
+  }
+  // GetBids answers with a single response.
+  if (kStreamed && i + 1 < chaff_shape_.size()) {
+    ScheduleChaffChunk(i + 1);
+    return;
+  }
+  benchmarking_logger_->End();
+  FinishWithOkStatus();
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::GetProtectedAudienceBids() {
+  const absl::Duration prepare_cpu_start = ThreadCpuTime();
+  BiddingSignalsRequest bidding_signals_request(raw_request_, kv_metadata_,
+                                                &cancellation_);
   auto kv_request =
       metric::MakeInitiatedRequest(metric::kKv, metric_context_.get(), 0);
   // Get Bidding Signals.
   bidding_signals_async_provider_->Get(
       bidding_signals_request,
-      [this, kv_request = std::move(kv_request)](
+      [this, kv_request = std::move(kv_request),
+       span = tracer_.StartSpan("FetchBiddingSignals"),
+       kv_start = absl::Now()](
           absl::StatusOr<std::unique_ptr<BiddingSignals>> response) mutable {
         {  // destruct kv_request, destructor measures request time
           auto not_used = std::move(kv_request);
         }
+        RequestTracer::EndSpan(span);
+        timeline_.Record(RequestStage::kKeyValue, kv_start, absl::Now());
         if (!response.ok()) {
           LogIfError(metric_context_->AccumulateMetric<
                      server_common::metric::kInitiatedRequestErrorCount>(1));
-          // Return error to client.
           logger_.vlog(1, "GetBiddingSignals request failed with status:",
                        response.status());
-          Finish(grpc::Status(
-              static_cast<grpc::StatusCode>(response.status().code()),
-              std::string(response.status().message())));
+          bidding_inputs_.Set(kBiddingSignals, response.status());
+          return;
+        }
+        if (const auto& signals = (*response)->trusted_signals;
+            signals != nullptr && !memory_budget_.Charge(signals->size())) {
+          logger_.vlog(1, "Bidding signals over the memory budget of the "
+                          "request");
+          RecordMemoryBudgetExceeded(MemoryBudgetAction::kRejected);
+          bidding_inputs_.Set(
+              kBiddingSignals,
+              absl::ResourceExhaustedError(kRequestMemoryBudgetExceeded));
           return;
         }
-        // Final callback needs to check status of others and send bidding
-        // request.
-        PrepareAndGenerateProtectedAudienceBid(std::move(response.value()));
+        bidding_signals_ = *std::move(response);
+        bidding_inputs_.Set(kBiddingSignals, absl::OkStatus());
       },
       absl::Milliseconds(config_.bidding_signals_load_timeout_ms));
+
+  // Build the bidding request from the interest groups while the bidding
+  // signals are fetched. The provider is done with the request once Get
+  // returns, so the interest groups are moved rather than copied; only their
+  // names are left for AddBiddingSignals.
+  raw_bidding_input_ = ProtoFactory::CreateGenerateBidsRawRequest(
+      &raw_request_, raw_request_.mutable_buyer_input(),
+      raw_request_.log_context());
+  // The bidding request may be sent as soon as it is set.
+  cpu_time_.AddSince(CpuStage::kPrepare, prepare_cpu_start);
+  bidding_inputs_.Set(kBiddingRequest, absl::OkStatus());
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::OnBiddingInputsReady(
+    std::vector<absl::Status> statuses) {
+  if (!statuses[kBiddingSignals].ok()) {
+    OnProtectedAudienceBidsDone(std::move(statuses[kBiddingSignals]));
+    return;
+  }
+  // Final callback needs to check status of others and send bidding
+  // request.
+  PrepareAndGenerateProtectedAudienceBid(std::move(bidding_signals_));
 }
 
 // Process Outputs from Actions to prepare bidding request.
 // All Preload actions must have completed before this is invoked.
-void GetBidsUnaryReactor::PrepareAndGenerateProtectedAudienceBid(
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::PrepareAndGenerateProtectedAudienceBid(
     std::unique_ptr<BiddingSignals> bidding_signals) {
-  const auto& log_context = raw_request_.log_context();
+  const absl::Duration prepare_cpu_start = ThreadCpuTime();
   std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
-      raw_bidding_input = ProtoFactory::CreateGenerateBidsRawRequest(
-          raw_request_, raw_request_.buyer_input(), std::move(bidding_signals),
-          log_context);
+      raw_bidding_input = std::move(raw_bidding_input_);
+  if (config_.project_bidding_signals &&
+      bidding_signals->trusted_signals != nullptr) {
+    // Only the signals of the keys the interest groups ask for are of use to
+    // the bidding service.
+    absl::flat_hash_set<absl::string_view> keys;
+    for (const auto& interest_group :
+         raw_bidding_input->interest_group_for_bidding()) {
+      keys.insert(interest_group.name());
+      keys.insert(interest_group.trusted_bidding_signals_keys().begin(),
+                  interest_group.trusted_bidding_signals_keys().end());
+    }
+    *bidding_signals->trusted_signals = ProjectBiddingSignals(
+        std::move(*bidding_signals->trusted_signals), keys);
+  }
+  ProtoFactory::AddBiddingSignals(raw_request_.buyer_input(),
+                                  std::move(bidding_signals),
+                                  *raw_bidding_input);
 
-  logger_.vlog(2, "GenerateBidsRequest:\n", raw_bidding_input->DebugString());
+  logger_.vlog(2, "GenerateBidsRequest:\n", DebugStringOf(*raw_bidding_input));
+  cpu_time_.AddSince(CpuStage::kPrepare, prepare_cpu_start);
+  // The bids are of no use once the seller stopped waiting for them.
+  const absl::Duration timeout =
+      TimeoutWithinDeadline(absl::Milliseconds(config_.generate_bid_timeout_ms),
+                            GetRequestDeadline(*context_));
+  if (timeout <= absl::ZeroDuration()) {
+    OnProtectedAudienceBidsDone(
+        absl::DeadlineExceededError(kDeadlineExceededBeforeCall));
+    return;
+  }
+  const int num_interest_groups =
+      raw_bidding_input->interest_group_for_bidding_size();
+  std::vector<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+      partitions = ProtoFactory::PartitionGenerateBidsRawRequest(
+          std::move(raw_bidding_input),
+          GetNumBiddingPartitions(num_interest_groups));
+  const int num_partitions = partitions.size();
+  // Owned by the callbacks of the requests until they are all done.
+  auto bidding_responses = FanIn<GenerateBidsRawResponseOr>::Create(
+      num_partitions,
+      [this](std::vector<GenerateBidsRawResponseOr> raw_responses) {
+        OnBiddingResponses(std::move(raw_responses));
+      });
+  // The reactor may finish as soon as the last request is sent, so it is not
+  // used after that unless the request could not be sent.
+  for (int i = 0; i < num_partitions; ++i) {
+    auto bidding_request = metric::MakeInitiatedRequest(
+        metric::kBs, metric_context_.get(), partitions[i]->ByteSizeLong());
+    RequestTracer::SpanPtr span = tracer_.StartSpan("GenerateBids");
+    RequestMetadata metadata;
+    tracer_.AddTraceParent(span, metadata);
+    AddRequestClass(request_class_, metadata);
+    absl::Status execute_result = bidding_async_client_->ExecuteInternal(
+        std::move(partitions[i]), metadata,
+        [this, bidding_responses, i,
+         bidding_request = std::move(bidding_request), span = std::move(span),
+         bidding_start = absl::Now()](
+            absl::StatusOr<
+                std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+                raw_response) mutable {
+          {  // destruct bidding_request, destructor measures request time
+            auto not_used = std::move(bidding_request);
+          }
+          RequestTracer::EndSpan(span);
+          timeline_.Record(RequestStage::kFanOut, bidding_start, absl::Now());
+          if (!raw_response.ok()) {
+            LogIfError(metric_context_->AccumulateMetric<
+                       server_common::metric::kInitiatedRequestErrorCount>(1));
+            std::string err_msg = absl::StrCat(
+                "Execution of GenerateBids request failed with status: ",
+                raw_response.status().message());
+            logger_.vlog(1, err_msg);
+            raw_response =
+                absl::Status(raw_response.status().code(), std::move(err_msg));
+          } else {
+            logger_.vlog(2, "Raw response received by bidding async client:\n",
+                         DebugStringOf(**raw_response));
+            if constexpr (kStreamed) {
+              // The bids of the partition are streamed right away, and only
+              // its status is left for OnBiddingResponses.
+              if (absl::Status status =
+                      StreamBids(*ProtoFactory::CreateGetBidsRawResponse(
+                          *std::move(raw_response)));
+                  !status.ok()) {
+                raw_response = absl::InternalError(kInternalServerError);
+              } else {
+                raw_response = std::unique_ptr<
+                    GenerateBidsResponse::GenerateBidsRawResponse>();
+              }
+            }
+          }
+          bidding_responses->Set(i, std::move(raw_response));
+        },
+        timeout, &bidding_crypto_metrics_, &cancellation_);
+    if (!execute_result.ok()) {
+      logger_.error(
+          absl::StrFormat("Failed to make async GenerateBids call: (error: %s)",
+                          execute_result.ToString()));
+      bidding_responses->Set(i, absl::InternalError(kInternalServerError));
+    }
+  }
+}
+
+template <typename ServerReactor>
+int GetBidsReactor<ServerReactor>::GetNumBiddingPartitions(
+    int num_interest_groups) const {
+  const int threshold = config_.generate_bids_partition_threshold;
+  if (threshold <= 0 || num_interest_groups <= threshold) {
+    return 1;
+  }
+  return std::min(config_.generate_bids_max_partitions,
+                  (num_interest_groups + threshold - 1) / threshold);
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::OnBiddingResponses(
+    std::vector<GenerateBidsRawResponseOr> raw_responses) {
+  const absl::Time handle_response_start = absl::Now();
+  const absl::Duration handle_response_cpu_start = ThreadCpuTime();
+  // The bids of the partitions that succeeded are returned, so that a
+  // request fails only if all of its partitions fail.
+  std::vector<std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+      successful_responses;
+  absl::Status first_error;
+  for (auto& response : raw_responses) {
+    if (response.ok()) {
+      successful_responses.push_back(*std::move(response));
+    } else if (first_error.ok()) {
+      first_error = response.status();
+    }
+  }
+  if (successful_responses.empty()) {
+    OnProtectedAudienceBidsDone(first_error);
+    return;
+  }
+  if constexpr (kStreamed) {
+    protected_audience_bids_streamed_ = true;
+    OnProtectedAudienceBidsDone(absl::OkStatus());
+    return;
+  }
+
+  // Parse and convert response.
+  get_bids_raw_response_ =
+      successful_responses.size() == 1
+          ? ProtoFactory::CreateGetBidsRawResponse(
+                std::move(successful_responses[0]))
+          : ProtoFactory::CreateGetBidsRawResponse(
+                std::move(successful_responses));
+  timeline_.Record(RequestStage::kParse, handle_response_start, absl::Now());
+  cpu_time_.AddSince(CpuStage::kHandleResponse, handle_response_cpu_start);
+  OnProtectedAudienceBidsDone(absl::OkStatus());
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::GetProtectedAppSignalsBids(
+    std::unique_ptr<GenerateProtectedAppSignalsBidsRawRequest>
+        raw_bidding_input) {
+  logger_.vlog(2, "GenerateProtectedAppSignalsBidsRequest:\n",
+               DebugStringOf(*raw_bidding_input));
+  const absl::Duration timeout = TimeoutWithinDeadline(
+      absl::Milliseconds(config_.protected_app_signals_generate_bid_timeout_ms),
+      GetRequestDeadline(*context_));
+  if (timeout <= absl::ZeroDuration()) {
+    OnProtectedAppSignalsBidsDone(
+        absl::DeadlineExceededError(kDeadlineExceededBeforeCall));
+    return;
+  }
   auto bidding_request = metric::MakeInitiatedRequest(
       metric::kBs, metric_context_.get(), raw_bidding_input->ByteSizeLong());
-  absl::Status execute_result = bidding_async_client_->ExecuteInternal(
-      std::move(raw_bidding_input), {},
-      [this, bidding_request = std::move(bidding_request)](
-          absl::StatusOr<
-              std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
-              raw_response) mutable {
-        {  // destruct bidding_request, destructor measures request time
-          auto not_used = std::move(bidding_request);
-        }
-        if (!raw_response.ok()) {
-          LogIfError(metric_context_->AccumulateMetric<
-                     server_common::metric::kInitiatedRequestErrorCount>(1));
-          const std::string err_msg = absl::StrCat(
-              "Execution of GenerateBids request failed with status: ",
-              raw_response.status().message());
-          // Return error to client.
-          logger_.vlog(1, err_msg);
-          benchmarking_logger_->End();
-          Finish(grpc::Status(
-              static_cast<grpc::StatusCode>(raw_response.status().code()),
-              std::move(err_msg)));
-          return;
-        }
-        logger_.vlog(2, "Raw response received by bidding async client:\n",
-                     (*raw_response)->DebugString());
+  RequestTracer::SpanPtr span =
+      tracer_.StartSpan("GenerateProtectedAppSignalsBids");
+  RequestMetadata metadata;
+  tracer_.AddTraceParent(span, metadata);
+  AddRequestClass(request_class_, metadata);
+  absl::Status execute_result =
+      protected_app_signals_bidding_async_client_->ExecuteInternal(
+          std::move(raw_bidding_input), metadata,
+          [this, bidding_request = std::move(bidding_request),
+           span = std::move(span)](
+              absl::StatusOr<
+                  std::unique_ptr<GenerateProtectedAppSignalsBidsRawResponse>>
+                  raw_response) mutable {
+            {  // destruct bidding_request, destructor measures request time
+              auto not_used = std::move(bidding_request);
+            }
+            RequestTracer::EndSpan(span);
+            if (!raw_response.ok()) {
+              LogIfError(
+                  metric_context_->AccumulateMetric<
+                      server_common::metric::kInitiatedRequestErrorCount>(1));
+              std::string err_msg = absl::StrCat(
+                  "Execution of GenerateProtectedAppSignalsBids request "
+                  "failed with status: ",
+                  raw_response.status().message());
+              logger_.vlog(1, err_msg);
+              OnProtectedAppSignalsBidsDone(absl::Status(
+                  raw_response.status().code(), std::move(err_msg)));
+              return;
+            }
+            logger_.vlog(
+                2, "Raw response received by protected app signals bidding "
+                   "async client:\n",
+                DebugStringOf(**raw_response));
+            protected_app_signals_raw_response_ = *std::move(raw_response);
+            OnProtectedAppSignalsBidsDone(absl::OkStatus());
+          },
+          timeout, &bidding_crypto_metrics_, &cancellation_);
+  if (!execute_result.ok()) {
+    logger_.error(absl::StrFormat(
+        "Failed to make async GenerateProtectedAppSignalsBids call: (error: "
+        "%s)",
+        execute_result.ToString()));
+    OnProtectedAppSignalsBidsDone(absl::InternalError(kInternalServerError));
+  }
+}
 
-        // Parse and convert response.
-        get_bids_raw_response_ =
-            ProtoFactory::CreateGetBidsRawResponse(*std::move(raw_response));
-        logger_.vlog(2, "GetBidsRawResponse:\n",
-                     get_bids_raw_response_->DebugString());
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::OnProtectedAudienceBidsDone(
+    absl::Status status) {
+  LogIfError(
+      metric_context_->LogHistogram<metric::kBfeProtectedAudienceDuration>(
+          (absl::Now() - start_time_) / absl::Milliseconds(1)));
+  pipelines_.Set(kProtectedAudiencePipeline, std::move(status));
+}
 
-        if (!EncryptResponse()) {
-          return;
-        }
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::OnProtectedAppSignalsBidsDone(
+    absl::Status status) {
+  LogIfError(
+      metric_context_->LogHistogram<metric::kBfeProtectedAppSignalsDuration>(
+          (absl::Now() - start_time_) / absl::Milliseconds(1)));
+  pipelines_.Set(kProtectedAppSignalsPipeline, std::move(status));
+}
 
-        logger_.vlog(3, "GetBidsResponse:\n",
-                     get_bids_response_->DebugString());
-        benchmarking_logger_->End();
-        FinishWithOkStatus();
-      },
-      absl::Milliseconds(config_.generate_bid_timeout_ms));
-  if (!execute_result.ok()) {
-    logger_.error(
-        absl::StrFormat("Failed to make async GenerateBids call: (error: %s)",
-                        execute_result.ToString()));
-    Finish(grpc::Status(grpc::INTERNAL, kInternalServerError));
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::OnPipelinesDone(
+    std::vector<absl::Status> statuses) {
+  const absl::Duration handle_response_cpu_start = ThreadCpuTime();
+  // The bids of the pipelines that succeeded are returned, so that a request
+  // fails only if all of its pipelines fail.
+  if (get_bids_raw_response_ == nullptr &&
+      !protected_audience_bids_streamed_ &&
+      protected_app_signals_raw_response_ == nullptr) {
+    const absl::Status& status = !statuses[kProtectedAudiencePipeline].ok()
+                                     ? statuses[kProtectedAudiencePipeline]
+                                     : statuses[kProtectedAppSignalsPipeline];
+    // Return error to client.
+    benchmarking_logger_->End();
+    FinishRpc(grpc::Status(static_cast<grpc::StatusCode>(status.code()),
+                           std::string(status.message())));
+    return;
   }
+  if constexpr (kStreamed) {
+    // The Protected Audience bids were streamed by partition.
+    if (protected_app_signals_raw_response_ != nullptr) {
+      GetBidsResponse::GetBidsRawResponse raw_response;
+      raw_response.mutable_protected_app_signals_bids()->Swap(
+          protected_app_signals_raw_response_->mutable_bids());
+      cpu_time_.AddSince(CpuStage::kHandleResponse, handle_response_cpu_start);
+      if (absl::Status status = StreamBids(raw_response); !status.ok()) {
+        FinishRpc(grpc::Status(grpc::StatusCode::INTERNAL, status.ToString()));
+        return;
+      }
+    }
+    if (config_.chaff_response_shaper != nullptr) {
+      absl::MutexLock lock(&streamed_chunks_mu_);
+      config_.chaff_response_shaper->Record(/*streamed=*/true,
+                                            std::move(streamed_chunks_));
+    }
+    benchmarking_logger_->End();
+    FinishWithOkStatus();
+    return;
+  }
+  if (get_bids_raw_response_ == nullptr) {
+    get_bids_raw_response_ =
+        std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+    // Initialize empty list.
+    get_bids_raw_response_->mutable_bids();
+  }
+  if (protected_app_signals_raw_response_ != nullptr) {
+    get_bids_raw_response_->mutable_protected_app_signals_bids()->Swap(
+        protected_app_signals_raw_response_->mutable_bids());
+  }
+  logger_.vlog(2, "GetBidsRawResponse:\n",
+               DebugStringOf(*get_bids_raw_response_));
+  cpu_time_.AddSince(CpuStage::kHandleResponse, handle_response_cpu_start);
+
+  if (absl::Status status =
+          EncryptResponse(*get_bids_raw_response_, *get_bids_response_);
+      !status.ok()) {
+    FinishRpc(grpc::Status(grpc::StatusCode::INTERNAL, status.ToString()));
+    return;
+  }
+
+  if (config_.chaff_response_shaper != nullptr) {
+    config_.chaff_response_shaper->Record(
+        /*streamed=*/false, {{absl::Now() - start_time_,
+                              get_bids_raw_response_->ByteSizeLong()}});
+  }
+  logger_.vlog(3, "GetBidsResponse:\n", DebugStringOf(*get_bids_response_));
+  benchmarking_logger_->End();
+  FinishWithOkStatus();
 }
 
-bool GetBidsUnaryReactor::EncryptResponse() {
-  std::string payload = get_bids_raw_response_->SerializeAsString();
-  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
-      aead_encrypt = crypto_client_->AeadEncrypt(payload, hpke_secret_);
-  if (!aead_encrypt.ok()) {
+template <typename ServerReactor>
+absl::Status GetBidsReactor<ServerReactor>::EncryptResponse(
+    const GetBidsResponse::GetBidsRawResponse& raw_response,
+    GetBidsResponse& response) {
+  const absl::Time encrypt_start = absl::Now();
+  const absl::Duration encrypt_cpu_start = ThreadCpuTime();
+  // The raw response is serialized straight into the ciphertext field.
+  std::string& ciphertext = *response.mutable_response_ciphertext();
+  if (absl::Status status = crypto_client_->AeadEncryptMessage(
+          raw_response, hpke_secret_, ciphertext);
+      !status.ok()) {
     logger_.vlog(1, "Failed to encrypt response");
-    Finish(grpc::Status(grpc::StatusCode::INTERNAL,
-                        aead_encrypt.status().ToString()));
-    return false;
+    return status;
   }
+  const absl::Time encrypt_end = absl::Now();
+  crypto_metrics_.Add(CryptoOperation::kAeadEncrypt,
+                      encrypt_end - encrypt_start, ciphertext.size());
+  tracer_.AddSpan("EncryptResponse", encrypt_start, encrypt_end);
+  timeline_.Record(RequestStage::kEncrypt, encrypt_start, encrypt_end);
+  cpu_time_.AddSince(CpuStage::kEncrypt, encrypt_cpu_start);
+  return absl::OkStatus();
+}
 
-  get_bids_response_->set_response_ciphertext(
-      aead_encrypt->encrypted_data().ciphertext());
-  return true;
+template <typename ServerReactor>
+absl::Status GetBidsReactor<ServerReactor>::StreamBids(
+    const GetBidsResponse::GetBidsRawResponse& raw_response) {
+  logger_.vlog(2, "Streamed GetBidsRawResponse:\n",
+               DebugStringOf(raw_response));
+  GetBidsResponse chunk;
+  if (absl::Status status = EncryptResponse(raw_response, chunk);
+      !status.ok()) {
+    return status;
+  }
+  // Only called with GetBidsStream.
+  if constexpr (kStreamed) {
+    if (config_.chaff_response_shaper != nullptr && !raw_request_.is_chaff()) {
+      absl::MutexLock lock(&streamed_chunks_mu_);
+      streamed_chunks_.push_back(
+          {absl::Now() - start_time_, raw_response.ByteSizeLong()});
+    }
+    this->WriteChunk(std::move(chunk));
+  }
+  return absl::OkStatus();
 }
 
-ContextLogger::ContextMap GetBidsUnaryReactor::GetLoggingContext() {
+template <typename ServerReactor>
+ContextLogger::ContextMap GetBidsReactor<ServerReactor>::GetLoggingContext() {
   const auto& log_context = raw_request_.log_context();
   ContextLogger::ContextMap context_map = {
       {kGenerationId, log_context.generation_id()},
@@ -219,25 +686,42 @@ ContextLogger::ContextMap GetBidsUnaryReactor::GetLoggingContext() {
   return context_map;
 }
 
-GetBidsUnaryReactor::GetBidsUnaryReactor(
+template <typename ServerReactor>
+GetBidsReactor<ServerReactor>::GetBidsReactor(
     grpc::CallbackServerContext& context,
-    const GetBidsRequest& get_bids_request, GetBidsResponse& get_bids_response,
+    const GetBidsRequest& get_bids_request, GetBidsResponse* get_bids_response,
     const BiddingSignalsAsyncProvider& bidding_signals_async_provider,
     const BiddingAsyncClient& bidding_async_client, const GetBidsConfig& config,
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
-    CryptoClientWrapperInterface* crypto_client, bool enable_benchmarking)
+    CryptoClientWrapperInterface* crypto_client, bool enable_benchmarking,
+    const ProtectedAppSignalsBiddingAsyncClient*
+        protected_app_signals_bidding_async_client)
     : context_(&context),
       request_(&get_bids_request),
-      get_bids_response_(&get_bids_response),
+      get_bids_response_(get_bids_response),
       // TODO(b/278039901): Add integration test for metadata forwarding.
       kv_metadata_(GrpcMetadataToRequestMetadata(context.client_metadata(),
                                                  kBuyerKVMetadata)),
+      request_class_(GetRequestClass(context.client_metadata())),
       bidding_signals_async_provider_(&bidding_signals_async_provider),
       bidding_async_client_(&bidding_async_client),
+      protected_app_signals_bidding_async_client_(
+          protected_app_signals_bidding_async_client),
       config_(config),
       key_fetcher_manager_(key_fetcher_manager),
       crypto_client_(crypto_client),
-      logger_(GetLoggingContext()) {
+      logger_(GetLoggingContext()),
+      tracer_(RequestTracer::FromTraceParent(
+          kStreamed ? "GetBidsStream" : "GetBids",
+          GetTraceParent(context.client_metadata()))),
+      bidding_inputs_(kNumBiddingInputs,
+                      [this](std::vector<absl::Status> statuses) {
+                        OnBiddingInputsReady(std::move(statuses));
+                      }),
+      pipelines_(kNumPipelines, [this](std::vector<absl::Status> statuses) {
+        OnPipelinesDone(std::move(statuses));
+      }) {
+  memory_budget_.SetBudget(config_.request_memory_budget_bytes);
   if (enable_benchmarking) {
     std::string request_id = FormatTime(absl::Now());
     benchmarking_logger_ =
@@ -253,12 +737,93 @@ GetBidsUnaryReactor::GetBidsUnaryReactor(
   }()) << "BfeContextMap()->Get(request) should have been called";
 }
 
-void GetBidsUnaryReactor::FinishWithOkStatus() {
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::FinishWithOkStatus() {
   metric_context_->SetRequestSuccessful();
-  Finish(grpc::Status::OK);
+  FinishRpc(grpc::Status::OK);
+}
+
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::FinishRpc(grpc::Status status) {
+  if constexpr (kStreamed) {
+    this->FinishAfterWrites(std::move(status));
+  } else {
+    this->Finish(std::move(status));
+  }
 }
 
 // Deletes all data related to this object.
-void GetBidsUnaryReactor::OnDone() { delete this; }
+template <typename ServerReactor>
+void GetBidsReactor<ServerReactor>::OnDone() {
+  LogServerCryptoMetrics(crypto_metrics_, *metric_context_);
+  LogRequestCpuTime(cpu_time_, *metric_context_);
+  ReportRequestTimeline(
+      timeline_,
+      {.request_bytes = request_->request_ciphertext().size(),
+       .response_bytes = get_bids_response_ != nullptr
+                             ? get_bids_response_->response_ciphertext().size()
+                             : 0,
+       .num_items = raw_request_.buyer_input().interest_groups_size()});
+  LogInitiatedRequestCryptoMetrics<
+      metric::kInitiatedRequestBiddingHpkeEncryptDuration,
+      metric::kInitiatedRequestBiddingHpkeEncryptSize,
+      metric::kInitiatedRequestBiddingAeadDecryptDuration,
+      metric::kInitiatedRequestBiddingAeadDecryptSize>(bidding_crypto_metrics_,
+                                                       *metric_context_);
+  delete this;
+}
+
+void GetBidsChunkWriter::WriteChunk(GetBidsResponse chunk) {
+  absl::MutexLock lock(&mu_);
+  if (finish_status_.has_value() || write_failed_) {
+    return;
+  }
+  chunks_.push_back(std::move(chunk));
+  if (!writing_) {
+    writing_ = true;
+    StartWrite(&chunks_.front());
+  }
+}
+
+void GetBidsChunkWriter::FinishAfterWrites(grpc::Status status) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (finish_status_.has_value()) {
+      return;
+    }
+    finish_status_ = status;
+    if (writing_) {
+      return;
+    }
+  }
+  // Called without the lock, as the call may be done and the reactor deleted
+  // right away.
+  Finish(std::move(status));
+}
+
+void GetBidsChunkWriter::OnWriteDone(bool ok) {
+  std::optional<grpc::Status> status;
+  {
+    absl::MutexLock lock(&mu_);
+    chunks_.pop_front();
+    if (!ok) {
+      // The call is broken, and the chunks left would not be read.
+      write_failed_ = true;
+      chunks_.clear();
+    }
+    if (!chunks_.empty()) {
+      StartWrite(&chunks_.front());
+      return;
+    }
+    writing_ = false;
+    status = finish_status_;
+  }
+  if (status.has_value()) {
+    Finish(*std::move(status));
+  }
+}
+
+template class GetBidsReactor<grpc::ServerUnaryReactor>;
+template class GetBidsReactor<GetBidsChunkWriter>;
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -16,9 +16,12 @@
 #define SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_UNARY_REACTOR_H_
 
 #include <array>
+#include <deque>
 #include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -26,16 +29,29 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "services/buyer_frontend_service/data/get_bids_config.h"
 #include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
 #include "services/common/clients/bidding_server/bidding_async_client.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "services/common/encryption/crypto_metrics.h"
 #include "services/common/loggers/benchmarking_logger.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/telemetry/request_tracer.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/concurrency_limiter.h"
 #include "services/common/util/context_logger.h"
+#include "services/common/util/fan_in.h"
+#include "services/common/util/request_class.h"
+#include "services/common/util/request_cpu_time.h"
+#include "services/common/util/request_memory_budget.h"
+#include "services/common/util/request_timeline.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -45,13 +61,55 @@ inline constexpr std::array<std::pair<std::string_view, std::string_view>, 3>
                          {"x-user-agent", "User-Agent"},
                          {"x-bna-client-ip", "X-BnA-Client-IP"}}};
 
+// Writes the responses of a GetBidsStream call one at a time, as gRPC allows
+// a single write in flight, and finishes the call once they are written.
+class GetBidsChunkWriter : public grpc::ServerWriteReactor<GetBidsResponse> {
+ public:
+  // Writes the chunk after the ones before it. Does nothing once the call is
+  // finishing or a write failed. Thread safe.
+  void WriteChunk(GetBidsResponse chunk) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Finishes the call with the status once the chunks are written. Only the
+  // first call does anything. Thread safe.
+  void FinishAfterWrites(grpc::Status status) ABSL_LOCKS_EXCLUDED(mu_);
+
+  void OnWriteDone(bool ok) override ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  absl::Mutex mu_;
+  // The chunk being written, if any, followed by the ones waiting for it.
+  std::deque<GetBidsResponse> chunks_ ABSL_GUARDED_BY(mu_);
+  bool writing_ ABSL_GUARDED_BY(mu_) = false;
+  bool write_failed_ ABSL_GUARDED_BY(mu_) = false;
+  std::optional<grpc::Status> finish_status_ ABSL_GUARDED_BY(mu_);
+};
+
 // This is a gRPC server reactor that serves a single GetBidsRequest.
 // It stores state relevant to the request and after the
 // response is finished being served, it cleans up all
 // necessary state and grpc releases the reactor from memory.
-class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
+// ServerReactor is grpc::ServerUnaryReactor for GetBids, or
+// GetBidsChunkWriter for GetBidsStream, which streams the bids of each
+// partition of the bidding request as soon as it is done rather than joining
+// them in a single response.
+template <typename ServerReactor>
+class GetBidsReactor : public ServerReactor {
  public:
-  explicit GetBidsUnaryReactor(
+  // get_bids_response: the response of GetBids, null for GetBidsStream.
+  explicit GetBidsReactor(
+      grpc::CallbackServerContext& context,
+      const GetBidsRequest& get_bids_request,
+      GetBidsResponse* get_bids_response,
+      const BiddingSignalsAsyncProvider& bidding_signals_async_provider,
+      const BiddingAsyncClient& bidding_async_client,
+      const GetBidsConfig& config,
+      server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+      CryptoClientWrapperInterface* crypto_client,
+      bool enable_benchmarking = false,
+      const ProtectedAppSignalsBiddingAsyncClient*
+          protected_app_signals_bidding_async_client = nullptr);
+
+  explicit GetBidsReactor(
       grpc::CallbackServerContext& context,
       const GetBidsRequest& get_bids_request,
       GetBidsResponse& get_bids_response,
@@ -60,34 +118,83 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
       const GetBidsConfig& config,
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      bool enable_benchmarking = false);
+      bool enable_benchmarking = false,
+      const ProtectedAppSignalsBiddingAsyncClient*
+          protected_app_signals_bidding_async_client = nullptr)
+      : GetBidsReactor(context, get_bids_request, &get_bids_response,
+                       bidding_signals_async_provider, bidding_async_client,
+                       config, key_fetcher_manager, crypto_client,
+                       enable_benchmarking,
+                       protected_app_signals_bidding_async_client) {}
 
-  // GetBidsUnaryReactor is neither copyable nor movable.
-  GetBidsUnaryReactor(const GetBidsUnaryReactor&) = delete;
-  GetBidsUnaryReactor& operator=(const GetBidsUnaryReactor&) = delete;
+  // GetBidsReactor is neither copyable nor movable.
+  GetBidsReactor(const GetBidsReactor&) = delete;
+  GetBidsReactor& operator=(const GetBidsReactor&) = delete;
 
   // Starts the execution the request.
   void Execute();
+  // Keeps the request counted in flight by the concurrency limiter of the
+  // server until the reactor is done.
+  void SetConcurrencyPermit(ConcurrencyLimiter::Permit permit) {
+    concurrency_permit_ = std::move(permit);
+  }
   // Runs once the request has finished execution and deletes current instance.
   void OnDone() override;
   // Runs if the request is cancelled in the middle of execution.
-  void OnCancel() override {
-    // TODO(b/249183477): Figure out how to cancel request
-  }
+  // Aborts the bidding signals fetches and the bidding RPCs in flight.
+  void OnCancel() override { cancellation_.Cancel(); }
 
  private:
+  // Whether the bids are streamed, by GetBidsStream.
+  static constexpr bool kStreamed =
+      std::is_base_of_v<GetBidsChunkWriter, ServerReactor>;
+
   // Process Outputs from Actions to prepare bidding request.
   // All Preload actions must have completed before this is invoked.
   void PrepareAndGenerateProtectedAudienceBid(
       std::unique_ptr<BiddingSignals> bidding_signals);
 
+  // Called once the bidding request is built without the bidding signals and
+  // the bidding signals are fetched, with the status of each. Generates the
+  // bids, or finishes the pipeline if the signals could not be fetched.
+  void OnBiddingInputsReady(std::vector<absl::Status> statuses);
+
+  // Returns the number of generate bid requests to split a request of the
+  // given number of interest groups into, as configured.
+  int GetNumBiddingPartitions(int num_interest_groups) const;
+
+  // Called with the responses to the generate bid requests of all the
+  // partitions. Finishes the pipeline with the bids of all the partitions.
+  void OnBiddingResponses(
+      std::vector<absl::StatusOr<
+          std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>>
+          raw_responses);
+
+  // Answers a chaff request with empty responses, as many, padded and
+  // delayed as the ChaffResponseShaper of the config says, without fetching
+  // bidding signals or generating bids.
+  void HandleChaffRequest();
+
+  // Sends chunk i of chaff_shape_ once its latency is past.
+  void ScheduleChaffChunk(size_t i);
+
+  // Sends chunk i of chaff_shape_ as an empty response padded to its size,
+  // and finishes the RPC after the last chunk.
+  void SendChaffChunk(size_t i);
+
   // Decrypts the request ciphertext in and returns whether decryption was
   // successful. If successful, the result is written into 'raw_request_'.
   bool DecryptRequest();
 
-  // Encrypts `raw_response` and sets the result on the 'response_ciphertext'
-  // field in the response. Returns whether encryption was successful.
-  bool EncryptResponse();
+  // Encrypts raw_response into the 'response_ciphertext' field of response.
+  absl::Status EncryptResponse(
+      const GetBidsResponse::GetBidsRawResponse& raw_response,
+      GetBidsResponse& response);
+
+  // With GetBidsStream, encrypts raw_response and writes it as a chunk of the
+  // response.
+  absl::Status StreamBids(
+      const GetBidsResponse::GetBidsRawResponse& raw_response);
 
   // Gets logging context (as a key/val pair) that can help debug/trace a
   // request through the BA services.
@@ -96,6 +203,26 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   // Finishes the RPC call with an OK status.
   void FinishWithOkStatus();
 
+  // Finishes the RPC call with the status, once the chunks streamed so far
+  // are written with GetBidsStream.
+  void FinishRpc(grpc::Status status);
+
+  // Generates the Protected App Signals bids for the request.
+  void GetProtectedAppSignalsBids(
+      std::unique_ptr<GenerateProtectedAppSignalsBidsRequest::
+                          GenerateProtectedAppSignalsBidsRawRequest>
+          raw_bidding_input);
+
+  // Called once each pipeline is done, with its status. The bids of a
+  // successful pipeline are set beforehand.
+  void OnProtectedAudienceBidsDone(absl::Status status);
+  void OnProtectedAppSignalsBidsDone(absl::Status status);
+
+  // Called once all the pipelines are done, with their statuses. Finishes the
+  // RPC with the bids of all the pipelines that succeeded, or with the error
+  // of the pipelines if none did.
+  void OnPipelinesDone(std::vector<absl::Status> statuses);
+
   // References for state, request, response and context from gRPC.
   // Should be released by gRPC
   // https://github.com/grpc/grpc/blob/dbc45208e2bfe14f01b1cbb06d0cd7c01077debb/include/grpcpp/server_context.h#L604
@@ -103,32 +230,85 @@ class GetBidsUnaryReactor : public grpc::ServerUnaryReactor {
   const GetBidsRequest* request_;
   GetBidsRequest::GetBidsRawRequest raw_request_;
 
-  // Should be released by gRPC after call is finished
+  // Should be released by gRPC after call is finished. Null with
+  // GetBidsStream.
   GetBidsResponse* get_bids_response_;
   std::unique_ptr<GetBidsResponse::GetBidsRawResponse> get_bids_raw_response_ =
       nullptr;
 
   // Metadata to be sent to buyer KV server.
   RequestMetadata kv_metadata_;
+  // Class the seller frontend sent with the request, passed on to bidding.
+  const RequestClass request_class_;
 
   // Helper classes for performing preload actions.
   // These are not owned by this class.
   const BiddingSignalsAsyncProvider* bidding_signals_async_provider_;
   const BiddingAsyncClient* bidding_async_client_;
+  // Null if Protected App Signals are not enabled.
+  const ProtectedAppSignalsBiddingAsyncClient*
+      protected_app_signals_bidding_async_client_;
   const GetBidsConfig& config_;
   server_common::KeyFetcherManagerInterface* key_fetcher_manager_;
   CryptoClientWrapperInterface* crypto_client_;
   std::unique_ptr<BenchmarkingLogger> benchmarking_logger_;
   std::string hpke_secret_;
   ContextLogger logger_;
+  // Traces the request if the SFE did.
+  RequestTracer tracer_;
+  // Cancelled once the SFE gives up on the request.
+  CancellationToken cancellation_;
 
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::BfeContext> metric_context_;
+  // Crypto operations of the GetBids request, and of the requests to the
+  // Bidding server, logged in OnDone.
+  CryptoMetrics crypto_metrics_;
+  CryptoMetrics bidding_crypto_metrics_;
+  // CPU time of the request by stage, logged in OnDone.
+  RequestCpuTime cpu_time_;
+  // Stages of the request, traced or not, reported in OnDone.
+  RequestTimeline timeline_;
+  // Bytes of the decrypted request and of its bidding signals.
+  RequestMemoryBudget memory_budget_;
+
+  // Bidding request built while the bidding signals are fetched, and the
+  // fetched signals, joined by bidding_inputs_ into OnBiddingInputsReady.
+  std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+      raw_bidding_input_;
+  std::unique_ptr<BiddingSignals> bidding_signals_;
+  FanIn<absl::Status> bidding_inputs_;
+
+  // Bids of the Protected Audience and Protected App Signals pipelines,
+  // joined by pipelines_ into OnPipelinesDone. The Protected Audience bids
+  // are set in get_bids_raw_response_, or were already streamed if
+  // protected_audience_bids_streamed_ is set.
+  absl::Time start_time_;
+  bool protected_audience_bids_streamed_ = false;
+  std::unique_ptr<GenerateProtectedAppSignalsBidsResponse::
+                      GenerateProtectedAppSignalsBidsRawResponse>
+      protected_app_signals_raw_response_;
+  FanIn<absl::Status> pipelines_;
 
   // Gets Protected Audience Bids.
   void GetProtectedAudienceBids();
+
+  ConcurrencyLimiter::Permit concurrency_permit_;
+
+  // Shape of the response of a chaff request.
+  ChaffResponseShaper::Shape chaff_shape_;
+  // Chunks streamed for a real request, recorded with the shaper once done.
+  absl::Mutex streamed_chunks_mu_;
+  ChaffResponseShaper::Shape streamed_chunks_
+      ABSL_GUARDED_BY(streamed_chunks_mu_);
 };
 
+using GetBidsUnaryReactor = GetBidsReactor<grpc::ServerUnaryReactor>;
+using GetBidsStreamReactor = GetBidsReactor<GetBidsChunkWriter>;
+
+extern template class GetBidsReactor<grpc::ServerUnaryReactor>;
+extern template class GetBidsReactor<GetBidsChunkWriter>;
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_BUYER_FRONTEND_SERVICE_GET_BIDS_UNARY_REACTOR_H_
@@ -0,0 +1,339 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Microbenchmarks for GetBidsUnaryReactor, the baseline of the changes to the
+// work the BFE does on a request.
+//
+// Both benchmarks run a GetBidsRawRequest of `igs` interest groups of 10 ads
+// each. Ciphertexts are treated as plaintexts, so HPKE is not measured.
+//
+// BM_GetBidsPhases times the functions the reactor calls for each phase of a
+// request, exported as counters per request:
+// - decrypt_us: the decryption of the request and the parsing of its payload.
+// - proto_build_us: CreateGenerateBidsRawRequest.
+// - encrypt_us: the encryption of a response of one bid per interest group.
+//
+// BM_GetBids runs `concurrency` requests at a time through the reactor,
+// against a bidding signals provider and a bidding client answering each
+// call after `latency_us`, from the timers of an executor, or right away if
+// 0. The following are exported as counters:
+// - p50_us and p99_us: percentiles of the end to end request latency.
+// - overhead_us: the mean end to end latency, less the latency of the fakes,
+//   i.e. the time the reactor adds to each request.
+// - allocations: the heap allocations per request, of every thread.
+// - items_per_second: requests per second.
+//
+// Run with:
+//   bazel run -c opt //services/buyer_frontend_service:get_bids_unary_reactor_benchmarks
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/check.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "services/buyer_frontend_service/get_bids_unary_reactor.h"
+#include "services/buyer_frontend_service/util/proto_factory.h"
+#include "services/common/encryption/pass_through_crypto_client.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/test/utils/benchmark_requests.h"
+#include "services/common/test/utils/heap_counter.h"
+#include "src/cpp/concurrent/event_engine_executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
+using GenerateBidsRawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+using GenerateBidsRawResponse = GenerateBidsResponse::GenerateBidsRawResponse;
+
+constexpr int kAdsPerInterestGroup = 10;
+constexpr char kKeyId[] = "key_id";
+
+// Runs on_done after latency from the timers of executor, or right away if
+// latency is 0.
+void RunAfterLatency(server_common::Executor& executor, absl::Duration latency,
+                     absl::AnyInvocable<void()> on_done) {
+  if (latency == absl::ZeroDuration()) {
+    on_done();
+    return;
+  }
+  executor.RunAfter(latency, std::move(on_done));
+}
+
+// Answers every lookup with empty trusted bidding signals.
+class FakeBiddingSignalsProvider : public BiddingSignalsAsyncProvider {
+ public:
+  FakeBiddingSignalsProvider(server_common::Executor& executor,
+                             absl::Duration latency)
+      : executor_(executor), latency_(latency) {}
+
+  void Get(const BiddingSignalsRequest& request,
+           absl::AnyInvocable<
+               void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+               on_done,
+           absl::Duration timeout) const override {
+    RunAfterLatency(executor_, latency_,
+                    [on_done = std::move(on_done)]() mutable {
+                      auto signals = std::make_unique<BiddingSignals>();
+                      signals->trusted_signals =
+                          std::make_unique<std::string>(R"({"keys":{}})");
+                      std::move(on_done)(std::move(signals));
+                    });
+  }
+
+ private:
+  server_common::Executor& executor_;
+  const absl::Duration latency_;
+};
+
+// Answers every bidding request with a bid per interest group, and records
+// when each request of the benchmark, identified by the generation id of its
+// log context, is done.
+class FakeBiddingClient : public BiddingAsyncClient {
+ public:
+  FakeBiddingClient(server_common::Executor& executor, absl::Duration latency)
+      : executor_(executor), latency_(latency) {}
+
+  // Expects num_requests requests, numbered from 0.
+  void Expect(int num_requests) {
+    absl::MutexLock lock(&mu_);
+    done_times_.assign(num_requests, absl::InfinitePast());
+    pending_ = std::make_unique<absl::BlockingCounter>(num_requests);
+  }
+
+  // Waits for the requests expected, and returns when each was done.
+  std::vector<absl::Time> Wait() {
+    pending_->Wait();
+    absl::MutexLock lock(&mu_);
+    return done_times_;
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<GenerateBidsRawRequest> request,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<GenerateBidsRawResponse>>) &&>
+          on_done,
+      absl::Duration timeout) const override {
+    RunAfterLatency(
+        executor_, latency_,
+        [this, request = std::move(request),
+         on_done = std::move(on_done)]() mutable {
+          auto response = std::make_unique<GenerateBidsRawResponse>();
+          for (const auto& ig : request->interest_group_for_bidding()) {
+            AdWithBid* bid = response->add_bids();
+            bid->set_bid(1);
+            bid->set_render(ig.ad_render_ids(0));
+            bid->set_interest_group_name(ig.name());
+          }
+          int index;
+          CHECK(absl::SimpleAtoi(request->log_context().generation_id(),
+                                 &index));
+          // The reactor finishes the request before on_done returns.
+          std::move(on_done)(std::move(response));
+          {
+            absl::MutexLock lock(&mu_);
+            done_times_[index] = absl::Now();
+          }
+          pending_->DecrementCount();
+        });
+    return absl::OkStatus();
+  }
+
+ private:
+  server_common::Executor& executor_;
+  const absl::Duration latency_;
+  mutable absl::Mutex mu_;
+  mutable std::vector<absl::Time> done_times_ ABSL_GUARDED_BY(mu_);
+  std::unique_ptr<absl::BlockingCounter> pending_;
+};
+
+GetBidsRequest MakeGetBidsRequest(int num_igs, int index) {
+  GetBidsRequest request;
+  request.set_key_id(kKeyId);
+  *request.mutable_request_ciphertext() =
+      MakeBenchmarkGetBidsRawRequest({.num_igs = num_igs,
+                                      .num_ads = kAdsPerInterestGroup,
+                                      .generation_id = absl::StrCat(index)})
+          .SerializeAsString();
+  return request;
+}
+
+void BM_GetBidsPhases(benchmark::State& state) {
+  const int num_igs = state.range(0);
+  const GetBidsRequest request = MakeGetBidsRequest(num_igs, 0);
+  auto key_fetcher_manager = CreateTestKeyFetcherManager();
+  const std::optional<server_common::PrivateKey> private_key =
+      key_fetcher_manager->GetPrivateKey(kKeyId);
+  CHECK(private_key.has_value());
+  PassThroughCryptoClient crypto_client;
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  for (int i = 0; i < num_igs; i++) {
+    AdWithBid* bid = raw_response.add_bids();
+    bid->set_bid(1);
+    bid->set_render(absl::StrCat("ad_", i, "_0"));
+    bid->set_interest_group_name(absl::StrCat("ig_", i));
+  }
+
+  absl::Duration decrypt;
+  absl::Duration proto_build;
+  absl::Duration encrypt;
+  for (auto _ : state) {
+    absl::Time start = absl::Now();
+    absl::StatusOr<HpkeDecryptResponse> decrypted =
+        crypto_client.HpkeDecrypt(*private_key, request.request_ciphertext());
+    CHECK(decrypted.ok());
+    GetBidsRequest::GetBidsRawRequest raw_request;
+    CHECK(raw_request.ParseFromString(decrypted->payload()));
+    absl::Time end = absl::Now();
+    decrypt += end - start;
+
+    start = end;
+    std::unique_ptr<GenerateBidsRawRequest> bidding_request =
+        ProtoFactory::CreateGenerateBidsRawRequest(
+            &raw_request, raw_request.mutable_buyer_input(),
+            raw_request.log_context());
+    end = absl::Now();
+    proto_build += end - start;
+    benchmark::DoNotOptimize(bidding_request);
+
+    start = end;
+    GetBidsResponse response;
+    CHECK(crypto_client
+              .AeadEncryptMessage(raw_response, decrypted->secret(),
+                                  *response.mutable_response_ciphertext())
+              .ok());
+    encrypt += absl::Now() - start;
+    benchmark::DoNotOptimize(response);
+  }
+
+  const auto per_iteration_us = [](absl::Duration duration) {
+    return benchmark::Counter(absl::ToDoubleMicroseconds(duration),
+                              benchmark::Counter::kAvgIterations);
+  };
+  state.counters["decrypt_us"] = per_iteration_us(decrypt);
+  state.counters["proto_build_us"] = per_iteration_us(proto_build);
+  state.counters["encrypt_us"] = per_iteration_us(encrypt);
+}
+
+void BM_GetBids(benchmark::State& state) {
+  const int num_igs = state.range(0);
+  const absl::Duration latency = absl::Microseconds(state.range(1));
+  const int concurrency = state.range(2);
+  server_common::TelemetryConfig config_proto;
+  config_proto.set_mode(server_common::TelemetryConfig::PROD);
+  metric::BfeContextMap(server_common::BuildDependentConfig(config_proto));
+  auto key_fetcher_manager = CreateTestKeyFetcherManager();
+  PassThroughCryptoClient crypto_client;
+  server_common::EventEngineExecutor executor(
+      grpc_event_engine::experimental::CreateEventEngine());
+  FakeBiddingSignalsProvider bidding_signals_provider(executor, latency);
+  FakeBiddingClient bidding_client(executor, latency);
+  GetBidsConfig config = {
+      .generate_bid_timeout_ms = 10000,
+      .bidding_signals_load_timeout_ms = 10000,
+      .encryption_enabled = true,
+  };
+  std::vector<GetBidsRequest> requests;
+  for (int i = 0; i < concurrency; i++) {
+    requests.push_back(MakeGetBidsRequest(num_igs, i));
+  }
+
+  std::vector<absl::Duration> latencies;
+  absl::Duration total_latency;
+  HeapCounter::Reset();
+  for (auto _ : state) {
+    bidding_client.Expect(concurrency);
+    std::vector<grpc::CallbackServerContext> contexts(concurrency);
+    std::vector<GetBidsResponse> responses(concurrency);
+    std::vector<std::unique_ptr<GetBidsUnaryReactor>> reactors;
+    std::vector<absl::Time> start_times;
+    for (int i = 0; i < concurrency; i++) {
+      metric::BfeContextMap()->Get(&requests[i]);
+      reactors.push_back(std::make_unique<GetBidsUnaryReactor>(
+          contexts[i], requests[i], responses[i], bidding_signals_provider,
+          bidding_client, config, key_fetcher_manager.get(), &crypto_client));
+      start_times.push_back(absl::Now());
+      reactors.back()->Execute();
+    }
+    const std::vector<absl::Time> done_times = bidding_client.Wait();
+    for (int i = 0; i < concurrency; i++) {
+      latencies.push_back(done_times[i] - start_times[i]);
+      total_latency += latencies.back();
+    }
+    benchmark::DoNotOptimize(responses);
+  }
+  const int64_t allocations = HeapCounter::Get().allocations;
+
+  const int64_t num_requests = state.iterations() * concurrency;
+  if (num_requests > 0) {
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile_us = [&latencies](int percentile) {
+      return absl::ToDoubleMicroseconds(
+          latencies[(latencies.size() - 1) * percentile / 100]);
+    };
+    state.counters["p50_us"] = percentile_us(50);
+    state.counters["p99_us"] = percentile_us(99);
+    // The bidding signals and the bids are waited for one after the other.
+    state.counters["overhead_us"] = absl::ToDoubleMicroseconds(
+        total_latency / num_requests - 2 * latency);
+    state.counters["allocations"] =
+        static_cast<double>(allocations) / num_requests;
+  }
+  state.SetItemsProcessed(num_requests);
+}
+
+// Args: number of interest groups.
+void GetBidsPhasesArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"igs"});
+  for (int igs : {10, 100, 1000}) {
+    benchmark->Args({igs});
+  }
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+// Args: number of interest groups, latency of the fakes in microseconds,
+// concurrent requests.
+void GetBidsArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"igs", "latency_us", "concurrency"});
+  for (int igs : {10, 100, 1000}) {
+    for (int latency_us : {0, 5000}) {
+      for (int concurrency : {1, 16, 64}) {
+        benchmark->Args({igs, latency_us, concurrency});
+      }
+    }
+  }
+  benchmark->Unit(benchmark::kMillisecond);
+  benchmark->UseRealTime();
+}
+
+BENCHMARK(BM_GetBidsPhases)->Apply(GetBidsPhasesArguments);
+BENCHMARK(BM_GetBids)->Apply(GetBidsArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
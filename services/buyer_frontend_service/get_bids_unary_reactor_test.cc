@@ -18,9 +18,12 @@
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/notification.h"
 #include "google/protobuf/util/message_differencer.h"
 #include "gtest/gtest.h"
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
 #include "services/common/clients/bidding_server/bidding_async_client.h"
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/encryption/key_fetcher_factory.h"
@@ -40,11 +43,19 @@ using ::testing::_;
 using ::testing::AllOf;
 using ::testing::An;
 using ::testing::AnyNumber;
+using ::testing::ElementsAre;
 using ::testing::Eq;
+using ::testing::Gt;
+using ::testing::Le;
 using ::testing::Pointee;
 using ::testing::Property;
 using ::testing::Return;
 
+using ProtectedAppSignalsRawRequest = GenerateProtectedAppSignalsBidsRequest::
+    GenerateProtectedAppSignalsBidsRawRequest;
+using ProtectedAppSignalsRawResponse = GenerateProtectedAppSignalsBidsResponse::
+    GenerateProtectedAppSignalsBidsRawResponse;
+
 constexpr char kKeyId[] = "key_id";
 constexpr char kSecret[] = "secret";
 
@@ -262,5 +273,284 @@ TEST_F(GetBidUnaryReactorTest, VerifyLogContextPropagates) {
   get_bids_unary_reactor.Execute();
 }
 
+TEST_F(GetBidUnaryReactorTest, SplitsInterestGroupsAcrossBiddingRequests) {
+  get_bids_config_.generate_bids_partition_threshold = 2;
+  get_bids_config_.generate_bids_max_partitions = 2;
+  auto* interest_groups =
+      raw_request_.mutable_buyer_input()->mutable_interest_groups();
+  interest_groups->Clear();
+  for (int i = 0; i < 4; ++i) {
+    interest_groups->Add()->set_name(absl::StrCat("ig", i));
+  }
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+
+  EXPECT_CALL(
+      bidding_signals_provider_,
+      Get(An<const BiddingSignalsRequest&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](const BiddingSignalsRequest& bidding_signals_request,
+                   auto on_done, absl::Duration timeout) {
+        std::move(on_done)(std::make_unique<BiddingSignals>());
+      });
+
+  std::vector<std::string> bid_igs;
+  absl::BlockingCounter bidding_calls(2);
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(2)
+      .WillRepeatedly(
+          [&bid_igs, &bidding_calls](
+              std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+                  raw_request,
+              const RequestMetadata& metadata, auto on_done,
+              absl::Duration timeout) {
+            EXPECT_EQ(raw_request->interest_group_for_bidding_size(), 2);
+            auto raw_response = std::make_unique<
+                GenerateBidsResponse::GenerateBidsRawResponse>();
+            for (const auto& ig : raw_request->interest_group_for_bidding()) {
+              bid_igs.push_back(ig.name());
+              raw_response->add_bids()->set_interest_group_name(ig.name());
+            }
+            std::move(on_done)(std::move(raw_response));
+            bidding_calls.DecrementCount();
+            return absl::OkStatus();
+          });
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+  bidding_calls.Wait();
+
+  EXPECT_THAT(bid_igs, ElementsAre("ig0", "ig1", "ig2", "ig3"));
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  ASSERT_TRUE(raw_response.ParseFromString(response_.response_ciphertext()));
+  EXPECT_EQ(raw_response.bids_size(), 4);
+}
+
+TEST_F(GetBidUnaryReactorTest, JoinsProtectedAppSignalsAndAudienceBids) {
+  get_bids_config_.is_protected_app_signals_enabled = true;
+  raw_request_.mutable_buyer_input()->add_interest_groups()->set_name("ig");
+  raw_request_.mutable_protected_app_signals_buyer_input()
+      ->mutable_protected_app_signals();
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+
+  EXPECT_CALL(
+      bidding_signals_provider_,
+      Get(An<const BiddingSignalsRequest&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](const BiddingSignalsRequest& bidding_signals_request,
+                   auto on_done, absl::Duration timeout) {
+        std::move(on_done)(std::make_unique<BiddingSignals>());
+      });
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+                       raw_request,
+                   const RequestMetadata& metadata, auto on_done,
+                   absl::Duration timeout) {
+        auto raw_response =
+            std::make_unique<GenerateBidsResponse::GenerateBidsRawResponse>();
+        raw_response->add_bids();
+        std::move(on_done)(std::move(raw_response));
+        return absl::OkStatus();
+      });
+
+  ProtectedAppSignalsBiddingAsyncClientMock
+      protected_app_signals_bidding_client_mock;
+  EXPECT_CALL(
+      protected_app_signals_bidding_client_mock,
+      ExecuteInternal(
+          An<std::unique_ptr<ProtectedAppSignalsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<
+                   std::unique_ptr<ProtectedAppSignalsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<ProtectedAppSignalsRawRequest> raw_request,
+                   const RequestMetadata& metadata, auto on_done,
+                   absl::Duration timeout) {
+        auto raw_response = std::make_unique<ProtectedAppSignalsRawResponse>();
+        raw_response->add_bids();
+        std::move(on_done)(std::move(raw_response));
+        return absl::OkStatus();
+      });
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get(), /*enable_benchmarking=*/false,
+      &protected_app_signals_bidding_client_mock);
+  class_under_test.Execute();
+
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  ASSERT_TRUE(raw_response.ParseFromString(response_.response_ciphertext()));
+  EXPECT_EQ(raw_response.bids_size(), 1);
+  EXPECT_EQ(raw_response.protected_app_signals_bids_size(), 1);
+}
+
+TEST_F(GetBidUnaryReactorTest, DecodesForwardedCompressedBuyerInput) {
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  BuyerInput& buyer_input = buyer_inputs["buyer"];
+  buyer_input.add_interest_groups()->set_name("ig0");
+  buyer_input.add_interest_groups()->set_name("ig1");
+  absl::StatusOr<google::protobuf::Map<std::string, std::string>>
+      encoded_buyer_inputs = GetEncodedBuyerInputMap(buyer_inputs);
+  ASSERT_TRUE(encoded_buyer_inputs.ok()) << encoded_buyer_inputs.status();
+  raw_request_.clear_buyer_input();
+  raw_request_.set_compressed_buyer_input(encoded_buyer_inputs->at("buyer"));
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+
+  EXPECT_CALL(
+      bidding_signals_provider_,
+      Get(An<const BiddingSignalsRequest&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([](const BiddingSignalsRequest& bidding_signals_request,
+                   auto on_done, absl::Duration timeout) {
+        std::move(on_done)(std::make_unique<BiddingSignals>());
+      });
+  std::vector<std::string> bid_igs;
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .WillOnce([&bid_igs](
+                    std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+                        raw_request,
+                    const RequestMetadata& metadata, auto on_done,
+                    absl::Duration timeout) {
+        for (const auto& ig : raw_request->interest_group_for_bidding()) {
+          bid_igs.push_back(ig.name());
+        }
+        std::move(on_done)(
+            std::make_unique<GenerateBidsResponse::GenerateBidsRawResponse>());
+        return absl::OkStatus();
+      });
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+
+  EXPECT_THAT(bid_igs, ElementsAre("ig0", "ig1"));
+}
+
+TEST_F(GetBidUnaryReactorTest, RejectsMalformedCompressedBuyerInput) {
+  raw_request_.set_compressed_buyer_input("not gzip");
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+  EXPECT_CALL(bidding_signals_provider_, Get).Times(0);
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(0);
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+
+  EXPECT_TRUE(response_.response_ciphertext().empty());
+}
+
+TEST_F(GetBidUnaryReactorTest, AnswersChaffRequestsWithoutBidding) {
+  raw_request_.set_is_chaff(true);
+  *request_.mutable_request_ciphertext() = raw_request_.SerializeAsString();
+  EXPECT_CALL(bidding_signals_provider_, Get).Times(0);
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(0);
+
+  // Shaped after the only real response.
+  ChaffResponseShaper chaff_response_shaper;
+  chaff_response_shaper.Record(/*streamed=*/false,
+                               {{absl::Milliseconds(40), 500}});
+  MockExecutor executor;
+  // Within the latency of the real response, as of decryption.
+  EXPECT_CALL(executor, RunAfter(AllOf(Gt(absl::ZeroDuration()),
+                                       Le(absl::Milliseconds(40))),
+                                 _))
+      .WillOnce([](absl::Duration delay, absl::AnyInvocable<void()> closure) {
+        closure();
+        return server_common::TaskId();
+      });
+  get_bids_config_.chaff_response_shaper = &chaff_response_shaper;
+  get_bids_config_.executor = &executor;
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+
+  GetBidsResponse::GetBidsRawResponse raw_response;
+  ASSERT_TRUE(raw_response.ParseFromString(response_.response_ciphertext()));
+  EXPECT_EQ(raw_response.bids_size(), 0);
+  EXPECT_EQ(raw_response.ByteSizeLong(), 500u);
+}
+
+TEST_F(GetBidUnaryReactorTest, RejectsRequestsOverTheMemoryBudget) {
+  EXPECT_CALL(bidding_signals_provider_, Get).Times(0);
+  EXPECT_CALL(
+      bidding_client_mock_,
+      ExecuteInternal(
+          An<std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>(),
+          An<const RequestMetadata&>(),
+          An<absl::AnyInvocable<
+              void(absl::StatusOr<std::unique_ptr<
+                       GenerateBidsResponse::GenerateBidsRawResponse>>) &&>>(),
+          An<absl::Duration>()))
+      .Times(0);
+  get_bids_config_.request_memory_budget_bytes = 1;
+
+  GetBidsUnaryReactor class_under_test(
+      context_, request_, response_, bidding_signals_provider_,
+      bidding_client_mock_, get_bids_config_, key_fetcher_manager_.get(),
+      crypto_client_.get());
+  class_under_test.Execute();
+
+  EXPECT_TRUE(response_.response_ciphertext().empty());
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
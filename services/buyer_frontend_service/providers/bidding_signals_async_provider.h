@@ -19,6 +19,7 @@
 
 #include "services/buyer_frontend_service/data/bidding_signals.h"
 #include "services/common/providers/async_provider.h"
+#include "services/common/util/cancellation_token.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -26,9 +27,11 @@ namespace privacy_sandbox::bidding_auction_servers {
 struct BiddingSignalsRequest {
   explicit BiddingSignalsRequest(
       const GetBidsRequest::GetBidsRawRequest& get_bids_raw_request,
-      const absl::flat_hash_map<std::string, std::string>& filtering_metadata)
+      const absl::flat_hash_map<std::string, std::string>& filtering_metadata,
+      CancellationToken* cancellation = nullptr)
       : get_bids_raw_request_(get_bids_raw_request),
-        filtering_metadata_(filtering_metadata) {}
+        filtering_metadata_(filtering_metadata),
+        cancellation_(cancellation) {}
 
   // The objects here should be owned by the caller of the provider class
   // using this struct as a parameter. They're only required in the context of
@@ -36,6 +39,8 @@ struct BiddingSignalsRequest {
   // method.
   const GetBidsRequest::GetBidsRawRequest& get_bids_raw_request_;
   const absl::flat_hash_map<std::string, std::string>& filtering_metadata_;
+  // Cancels the lookups of the signals, if set.
+  CancellationToken* cancellation_;
 };
 
 // The classes implementing this interface provide the external signals
@@ -14,14 +14,99 @@
 
 #include "services/buyer_frontend_service/providers/http_bidding_signals_async_provider.h"
 
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex shard_errors_mu(absl::kConstInit);
+absl::flat_hash_map<std::string, double>& ShardErrorCounts()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard_errors_mu) {
+  static auto* counts = new absl::flat_hash_map<std::string, double>();
+  return *counts;
+}
+
+void RecordShardError(int shard) {
+  absl::MutexLock lock(&shard_errors_mu);
+  ++ShardErrorCounts()[std::to_string(shard)];
+}
+
+// The outputs of the lookups of a sharded Get, merged once all of them are
+// done.
+struct ShardedLookup {
+  explicit ShardedLookup(
+      int num_lookups,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+          on_done)
+      : outputs(num_lookups),
+        pending(num_lookups),
+        on_done(std::move(on_done)) {}
+
+  // Records the output of the lookup of the given index, for the keys of the
+  // given shard, and calls on_done with the merged outputs if it is the last
+  // one.
+  void Done(int lookup, int shard, absl::StatusOr<std::string> output) {
+    if (!output.ok()) {
+      RecordShardError(shard);
+    }
+    // Each lookup has its own output, read by the last lookup only.
+    outputs[lookup] = std::move(output);
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+      return;
+    }
+    std::move(on_done)(Merge());
+  }
+
+  // Returns the signals merged from the successful lookups, or the first
+  // error if none succeeded.
+  absl::StatusOr<std::unique_ptr<BiddingSignals>> Merge() {
+    std::vector<absl::StatusOr<HTTPResponse>> responses;
+    absl::Status first_error;
+    for (absl::StatusOr<std::string>& output : outputs) {
+      if (output.ok()) {
+        responses.push_back(
+            HTTPResponse{.body = *std::move(output), .status_code = 200});
+      } else if (first_error.ok()) {
+        first_error = std::move(output).status();
+      }
+    }
+    if (responses.empty()) {
+      return first_error;
+    }
+    absl::StatusOr<HTTPResponse> merged =
+        MergeKeyValueResponses(std::move(responses));
+    if (!merged.ok()) {
+      return merged.status();
+    }
+    auto signals = std::make_unique<BiddingSignals>();
+    signals->trusted_signals =
+        std::make_unique<std::string>(std::move(merged->body));
+    return signals;
+  }
+
+  std::vector<absl::StatusOr<std::string>> outputs;
+  std::atomic<int> pending;
+  absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+      on_done;
+};
+
+}  // namespace
 
 HttpBiddingSignalsAsyncProvider::HttpBiddingSignalsAsyncProvider(
     std::unique_ptr<
         AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput,
                     GetBuyerValuesRawInput, GetBuyerValuesRawOutput>>
-        http_buyer_kv_async_client)
-    : http_buyer_kv_async_client_(std::move(http_buyer_kv_async_client)) {}
+        http_buyer_kv_async_client,
+    int num_shards)
+    : http_buyer_kv_async_client_(std::move(http_buyer_kv_async_client)),
+      num_shards_(std::max(num_shards, 1)) {}
 
 void HttpBiddingSignalsAsyncProvider::Get(
     const BiddingSignalsRequest& bidding_signals_request,
@@ -31,6 +116,7 @@ void HttpBiddingSignalsAsyncProvider::Get(
   auto request = std::make_unique<GetBuyerValuesInput>();
   request->hostname =
       bidding_signals_request.get_bids_raw_request_.publisher_name();
+  request->cancellation = bidding_signals_request.cancellation_;
 
   absl::StatusOr<std::unique_ptr<BiddingSignals>> output =
       std::make_unique<BiddingSignals>();
@@ -43,6 +129,12 @@ void HttpBiddingSignalsAsyncProvider::Get(
                          ca.bidding_signals_keys().end());
   }
 
+  if (num_shards_ > 1 && request->keys.size() > 1) {
+    GetSharded(std::move(request), bidding_signals_request.filtering_metadata_,
+               std::move(on_done), timeout);
+    return;
+  }
+
   http_buyer_kv_async_client_->Execute(
       std::move(request), bidding_signals_request.filtering_metadata_,
       [res = std::move(output), on_done = std::move(on_done)](
@@ -59,4 +151,56 @@ void HttpBiddingSignalsAsyncProvider::Get(
       },
       timeout);
 }
+
+void HttpBiddingSignalsAsyncProvider::GetSharded(
+    std::unique_ptr<GetBuyerValuesInput> request,
+    const RequestMetadata& metadata,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+        on_done,
+    absl::Duration timeout) const {
+  // The keys are split by hash rather than by position, so that a key is
+  // always looked up by the same shard.
+  std::vector<std::vector<std::string>> shard_keys(num_shards_);
+  for (std::string& key : request->keys) {
+    shard_keys[absl::Hash<std::string>()(key) % num_shards_].push_back(
+        std::move(key));
+  }
+  const int num_lookups = std::count_if(
+      shard_keys.begin(), shard_keys.end(),
+      [](const std::vector<std::string>& keys) { return !keys.empty(); });
+
+  auto lookups =
+      std::make_shared<ShardedLookup>(num_lookups, std::move(on_done));
+  int lookup = 0;
+  for (int shard = 0; shard < num_shards_; ++shard) {
+    if (shard_keys[shard].empty()) {
+      continue;
+    }
+    auto shard_request = std::make_unique<GetBuyerValuesInput>(
+        GetBuyerValuesInput{std::move(shard_keys[shard]), request->hostname,
+                            request->cancellation});
+    absl::Status status = http_buyer_kv_async_client_->Execute(
+        std::move(shard_request), metadata,
+        [lookups, lookup, shard](
+            absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>
+                buyer_kv_output) {
+          if (!buyer_kv_output.ok()) {
+            lookups->Done(lookup, shard, buyer_kv_output.status());
+            return;
+          }
+          lookups->Done(lookup, shard, std::move((*buyer_kv_output)->result));
+        },
+        timeout);
+    if (!status.ok()) {
+      lookups->Done(lookup, shard, std::move(status));
+    }
+    ++lookup;
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetKeyValueShardErrorCounts() {
+  absl::MutexLock lock(&shard_errors_mu);
+  return std::exchange(ShardErrorCounts(), {});
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
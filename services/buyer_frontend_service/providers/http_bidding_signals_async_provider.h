@@ -22,20 +22,27 @@
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
 #include "services/common/clients/http_kv_server/buyer/buyer_key_value_async_http_client.h"
+#include "services/common/metric/server_definition.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 class HttpBiddingSignalsAsyncProvider final
     : public BiddingSignalsAsyncProvider {
  public:
+  // If num_shards is more than 1, the keys are split by hash into as many
+  // parallel lookups, so that a slow lookup of a large key set no longer
+  // holds back all the keys. The signals are merged from the lookups that
+  // succeed, and fail only if all of them fail.
   explicit HttpBiddingSignalsAsyncProvider(
       std::unique_ptr<
           AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput,
                       GetBuyerValuesRawInput, GetBuyerValuesRawOutput>>
-          http_buyer_kv_async_client);
+          http_buyer_kv_async_client,
+      int num_shards = 1);
 
   // HttpBiddingSignalsAsyncProvider is neither copyable nor movable.
   HttpBiddingSignalsAsyncProvider(const HttpBiddingSignalsAsyncProvider&) =
@@ -54,11 +61,31 @@ class HttpBiddingSignalsAsyncProvider final
            absl::Duration timeout) const override;
 
  private:
+  // Looks up the keys split by hash into num_shards_ lookups.
+  void GetSharded(
+      std::unique_ptr<GetBuyerValuesInput> request,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+          on_done,
+      absl::Duration timeout) const;
+
   std::unique_ptr<AsyncClient<GetBuyerValuesInput, GetBuyerValuesOutput,
                               GetBuyerValuesRawInput, GetBuyerValuesRawOutput>>
       http_buyer_kv_async_client_;
+  const int num_shards_;
 };
 
+// Returns the number of failed lookups of each shard index of all the
+// HttpBiddingSignalsAsyncProvider instances since the previous call.
+absl::flat_hash_map<std::string, double> GetKeyValueShardErrorCounts();
+
+template <typename T>
+inline void AddKeyValueShardMetric(T* context_map) {
+  context_map->AddObserverable(metric::kKVShardErrorCount,
+                               GetKeyValueShardErrorCounts);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_BFE_SERVICE_PROVIDERS_HTTP_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
@@ -14,7 +14,12 @@
 
 #include "services/buyer_frontend_service/providers/http_bidding_signals_async_provider.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/notification.h"
 #include "gtest/gtest.h"
 #include "services/buyer_frontend_service/data/bidding_signals.h"
@@ -26,6 +31,24 @@ namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 using ::testing::An;
+using ::testing::Pair;
+using ::testing::SizeIs;
+using ::testing::UnorderedElementsAre;
+
+constexpr int kNumShards = 2;
+
+// Returns a request of one interest group with enough keys for all the
+// shards to get some.
+GetBidsRequest::GetBidsRawRequest GetRequestForShards() {
+  GetBidsRequest::GetBidsRawRequest request;
+  auto* interest_group =
+      request.mutable_buyer_input()->mutable_interest_groups()->Add();
+  interest_group->set_name("ig");
+  for (int i = 0; i < 32; ++i) {
+    interest_group->add_bidding_signals_keys(absl::StrCat("key", i));
+  }
+  return request;
+}
 
 GetBidsRequest::GetBidsRawRequest GetRequest() {
   GetBidsRequest::GetBidsRawRequest request;
@@ -179,5 +202,156 @@ TEST(HttpBiddingSignalsAsyncProviderTest,
       absl::Milliseconds(100));
   notification.WaitForNotification();
 }
+
+TEST(HttpBiddingSignalsAsyncProviderTest, SplitsKeysIntoShards) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetBuyerValuesInput, GetBuyerValuesOutput,
+                      GetBuyerValuesRawInput, GetBuyerValuesRawOutput>>();
+  auto request = GetRequestForShards();
+  std::vector<std::string> received_keys;
+
+  EXPECT_CALL(
+      *mock_client,
+      Execute(An<std::unique_ptr<GetBuyerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetBuyerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .Times(kNumShards)
+      .WillRepeatedly(
+          [&received_keys](
+              std::unique_ptr<GetBuyerValuesInput> input,
+              const RequestMetadata& metadata,
+              absl::AnyInvocable<
+                  void(
+                      absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
+                  callback,
+              absl::Duration timeout) {
+            received_keys.insert(received_keys.end(), input->keys.begin(),
+                                 input->keys.end());
+            auto output = std::make_unique<GetBuyerValuesOutput>();
+            output->result = R"({"keys":{}})";
+            (std::move(callback))(std::move(output));
+            return absl::OkStatus();
+          });
+
+  HttpBiddingSignalsAsyncProvider class_under_test(std::move(mock_client),
+                                                   kNumShards);
+
+  BiddingSignalsRequest bidding_signals_request(request, {});
+  absl::Notification notification;
+  class_under_test.Get(
+      bidding_signals_request,
+      [&notification](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals) {
+        EXPECT_TRUE(signals.ok()) << signals.status();
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+
+  // Each key is looked up by a single shard.
+  std::vector<std::string> expected_keys = {"ig"};
+  for (const auto& key :
+       request.buyer_input().interest_groups(0).bidding_signals_keys()) {
+    expected_keys.push_back(key);
+  }
+  std::sort(received_keys.begin(), received_keys.end());
+  std::sort(expected_keys.begin(), expected_keys.end());
+  EXPECT_EQ(received_keys, expected_keys);
+}
+
+TEST(HttpBiddingSignalsAsyncProviderTest, MergesSignalsOfSucceededShards) {
+  GetKeyValueShardErrorCounts();
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetBuyerValuesInput, GetBuyerValuesOutput,
+                      GetBuyerValuesRawInput, GetBuyerValuesRawOutput>>();
+  auto request = GetRequestForShards();
+  int calls = 0;
+
+  EXPECT_CALL(
+      *mock_client,
+      Execute(An<std::unique_ptr<GetBuyerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetBuyerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .Times(kNumShards)
+      .WillRepeatedly(
+          [&calls](std::unique_ptr<GetBuyerValuesInput> input,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<
+                       void(absl::StatusOr<
+                            std::unique_ptr<GetBuyerValuesOutput>>) &&>
+                       callback,
+                   absl::Duration timeout) {
+            if (calls++ == 0) {
+              (std::move(callback))(absl::UnavailableError("shard down"));
+              return absl::OkStatus();
+            }
+            auto output = std::make_unique<GetBuyerValuesOutput>();
+            output->result = R"({"keys":{"key":"value"}})";
+            (std::move(callback))(std::move(output));
+            return absl::OkStatus();
+          });
+
+  HttpBiddingSignalsAsyncProvider class_under_test(std::move(mock_client),
+                                                   kNumShards);
+
+  BiddingSignalsRequest bidding_signals_request(request, {});
+  absl::Notification notification;
+  class_under_test.Get(
+      bidding_signals_request,
+      [&notification](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        EXPECT_EQ(*signals.value()->trusted_signals,
+                  R"({"keys":{"key":"value"}})");
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+  EXPECT_THAT(GetKeyValueShardErrorCounts(),
+              UnorderedElementsAre(Pair(::testing::_, 1)));
+}
+
+TEST(HttpBiddingSignalsAsyncProviderTest, FailsIfAllShardsFail) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetBuyerValuesInput, GetBuyerValuesOutput,
+                      GetBuyerValuesRawInput, GetBuyerValuesRawOutput>>();
+  auto request = GetRequestForShards();
+
+  EXPECT_CALL(
+      *mock_client,
+      Execute(An<std::unique_ptr<GetBuyerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetBuyerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .Times(kNumShards)
+      .WillRepeatedly(
+          [](std::unique_ptr<GetBuyerValuesInput> input,
+             const RequestMetadata& metadata,
+             absl::AnyInvocable<
+                 void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
+                 callback,
+             absl::Duration timeout) {
+            (std::move(callback))(absl::UnavailableError("shard down"));
+            return absl::OkStatus();
+          });
+
+  HttpBiddingSignalsAsyncProvider class_under_test(std::move(mock_client),
+                                                   kNumShards);
+
+  BiddingSignalsRequest bidding_signals_request(request, {});
+  absl::Notification notification;
+  class_under_test.Get(
+      bidding_signals_request,
+      [&notification](absl::StatusOr<std::unique_ptr<BiddingSignals>> signals) {
+        EXPECT_EQ(signals.status().code(), absl::StatusCode::kUnavailable);
+        notification.Notify();
+      },
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+  EXPECT_THAT(GetKeyValueShardErrorCounts(), SizeIs(kNumShards));
+}
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,287 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/buyer_frontend_service/providers/snapshot_bidding_signals_async_provider.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/hash/hash.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "cc/core/interface/async_context.h"
+#include "cc/core/interface/errors.h"
+#include "cc/public/cpio/proto/blob_storage_service/v1/blob_storage_service.pb.h"
+#include "glog/logging.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::blob_storage_service::v1::GetBlobRequest;
+using ::google::cmrt::sdk::blob_storage_service::v1::GetBlobResponse;
+using ::google::scp::core::AsyncContext;
+using ::google::scp::core::errors::GetErrorMessage;
+
+constexpr char kKeysNamespace[] = "keys";
+
+// Values found in a snapshot, by key. The values point into the snapshot.
+using SnapshotValues = std::vector<std::pair<std::string, absl::string_view>>;
+
+void AppendToTable(const SnapshotValues& values, std::string* table) {
+  AppendKeyValueTableSection(kKeysNamespace, values.size(), table);
+  for (const auto& [key, value] : values) {
+    AppendKeyValueTableEntry(key, value, table);
+  }
+}
+
+// Returns a Key-Value server response with the values under "keys" along
+// with the values of response, if set.
+std::string MergeIntoJson(const SnapshotValues& values,
+                          const rapidjson::Value* response) {
+  std::vector<CachedNamespace> cached = {{kKeysNamespace}};
+  cached[0].values.reserve(values.size());
+  for (const auto& [key, value] : values) {
+    cached[0].values.emplace_back(key, std::make_shared<std::string>(value));
+  }
+  return MergeCachedValues(response, cached);
+}
+
+// Returns the signals of the values found in the snapshot merged with the
+// ones looked up with the fallback, if any. Fails only if the fallback did
+// and the snapshot had none of the keys.
+absl::StatusOr<std::unique_ptr<BiddingSignals>> MergeSignals(
+    const SnapshotValues& values, bool emit_table,
+    absl::StatusOr<std::unique_ptr<BiddingSignals>> fallback_signals) {
+  if (!fallback_signals.ok() && values.empty()) {
+    return fallback_signals;
+  }
+  auto signals = std::make_unique<BiddingSignals>();
+  if (!fallback_signals.ok() || *fallback_signals == nullptr ||
+      (*fallback_signals)->trusted_signals == nullptr) {
+    if (!fallback_signals.ok()) {
+      VLOG(2) << "Serving the snapshot signals only: "
+              << fallback_signals.status();
+    }
+    signals->trusted_signals = std::make_unique<std::string>();
+    if (emit_table) {
+      AppendToTable(values, signals->trusted_signals.get());
+    } else {
+      *signals->trusted_signals = MergeIntoJson(values, nullptr);
+    }
+    return signals;
+  }
+  signals = *std::move(fallback_signals);
+  std::string& trusted_signals = *signals->trusted_signals;
+  if (values.empty()) {
+    return signals;
+  }
+  if (IsKeyValueTable(trusted_signals)) {
+    AppendToTable(values, &trusted_signals);
+    return signals;
+  }
+  absl::StatusOr<rapidjson::Document> document =
+      ParseJsonString(trusted_signals);
+  if (!document.ok() || !document->IsObject()) {
+    // Left as is, as the bidding service would fail on it anyway.
+    return signals;
+  }
+  trusted_signals = MergeIntoJson(values, &*document);
+  return signals;
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<const BiddingSignalsSnapshot>>
+BiddingSignalsSnapshot::Create(std::string table) {
+  // Not made with std::make_shared, as the constructor is private.
+  std::shared_ptr<BiddingSignalsSnapshot> snapshot(
+      new BiddingSignalsSnapshot(std::move(table)));
+  PS_ASSIGN_OR_RETURN(KeyValueTable namespaces,
+                      ParseKeyValueTable(snapshot->table_));
+  if (auto it = namespaces.find(kKeysNamespace); it != namespaces.end()) {
+    snapshot->keys_ = std::move(it->second);
+  }
+  return snapshot;
+}
+
+const absl::string_view* BiddingSignalsSnapshot::Find(
+    absl::string_view key) const {
+  auto it = keys_.find(key);
+  return it == keys_.end() ? nullptr : &it->second;
+}
+
+SnapshotBiddingSignalsAsyncProvider::SnapshotBiddingSignalsAsyncProvider(
+    std::unique_ptr<BiddingSignalsAsyncProvider> fallback, bool emit_table)
+    : fallback_(std::move(fallback)), emit_table_(emit_table) {}
+
+void SnapshotBiddingSignalsAsyncProvider::SetSnapshot(
+    std::shared_ptr<const BiddingSignalsSnapshot> snapshot) {
+  std::atomic_store(&snapshot_, std::move(snapshot));
+}
+
+void SnapshotBiddingSignalsAsyncProvider::Get(
+    const BiddingSignalsRequest& bidding_signals_request,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+        on_done,
+    absl::Duration timeout) const {
+  std::shared_ptr<const BiddingSignalsSnapshot> snapshot =
+      std::atomic_load(&snapshot_);
+  const GetBidsRequest::GetBidsRawRequest& raw_request =
+      bidding_signals_request.get_bids_raw_request_;
+  // The interest groups with the keys the snapshot does not have, as the
+  // fallback looks them up.
+  GetBidsRequest::GetBidsRawRequest missing_request;
+  SnapshotValues values;
+  absl::flat_hash_set<absl::string_view> found_keys;
+  auto look_up = [&snapshot, &values, &found_keys](absl::string_view key) {
+    if (snapshot == nullptr) {
+      return false;
+    }
+    if (found_keys.contains(key)) {
+      return true;
+    }
+    const absl::string_view* value = snapshot->Find(key);
+    if (value == nullptr) {
+      return false;
+    }
+    found_keys.insert(key);
+    values.emplace_back(std::string(key), *value);
+    return true;
+  };
+  for (const auto& interest_group :
+       raw_request.buyer_input().interest_groups()) {
+    BuyerInput::InterestGroup* missing_group = nullptr;
+    auto add_missing_group = [&missing_request, &missing_group,
+                              &interest_group]() {
+      if (missing_group == nullptr) {
+        missing_group =
+            missing_request.mutable_buyer_input()->add_interest_groups();
+        missing_group->set_name(interest_group.name());
+      }
+      return missing_group;
+    };
+    if (!look_up(interest_group.name())) {
+      add_missing_group();
+    }
+    for (const std::string& key : interest_group.bidding_signals_keys()) {
+      if (!look_up(key)) {
+        add_missing_group()->add_bidding_signals_keys(key);
+      }
+    }
+  }
+
+  if (fallback_ == nullptr ||
+      missing_request.buyer_input().interest_groups().empty()) {
+    std::move(on_done)(
+        MergeSignals(values, emit_table_, std::unique_ptr<BiddingSignals>()));
+    return;
+  }
+  missing_request.set_publisher_name(raw_request.publisher_name());
+  // The values point into the snapshot, which is kept until the fallback is
+  // done. The fallback is done with the request once Get returns.
+  fallback_->Get(
+      BiddingSignalsRequest(missing_request,
+                            bidding_signals_request.filtering_metadata_,
+                            bidding_signals_request.cancellation_),
+      [snapshot = std::move(snapshot), values = std::move(values),
+       emit_table = emit_table_, on_done = std::move(on_done)](
+          absl::StatusOr<std::unique_ptr<BiddingSignals>>
+              fallback_signals) mutable {
+        std::move(on_done)(
+            MergeSignals(values, emit_table, std::move(fallback_signals)));
+      },
+      timeout);
+}
+
+BiddingSignalsSnapshotFetcher::BiddingSignalsSnapshotFetcher(
+    std::string bucket_name, std::string blob_name,
+    absl::Duration fetch_period, server_common::Executor* executor,
+    std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
+        blob_storage_client,
+    SnapshotBiddingSignalsAsyncProvider* provider)
+    : bucket_name_(std::move(bucket_name)),
+      blob_name_(std::move(blob_name)),
+      fetch_period_(fetch_period),
+      executor_(executor),
+      blob_storage_client_(std::move(blob_storage_client)),
+      provider_(provider) {}
+
+void BiddingSignalsSnapshotFetcher::Start() {
+  auto result = blob_storage_client_->Init();
+  CHECK(result.Successful())
+      << absl::StrFormat("Failed to init BlobStorageClient (status_code: %s)\n",
+                         GetErrorMessage(result.status_code));
+  result = blob_storage_client_->Run();
+  CHECK(result.Successful())
+      << absl::StrFormat("Failed to run BlobStorageClient (status_code: %s)\n",
+                         GetErrorMessage(result.status_code));
+  executor_->Run([this]() { Fetch(); });
+}
+
+void BiddingSignalsSnapshotFetcher::End() {
+  if (task_id_.keys != nullptr) {
+    executor_->Cancel(std::move(task_id_));
+  }
+}
+
+void BiddingSignalsSnapshotFetcher::Fetch() {
+  auto get_blob_request = std::make_shared<GetBlobRequest>();
+  get_blob_request->mutable_blob_metadata()->set_bucket_name(bucket_name_);
+  get_blob_request->mutable_blob_metadata()->set_blob_name(blob_name_);
+  AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
+      std::move(get_blob_request), [this](auto& context) {
+        if (!context.result.Successful()) {
+          OnFetched(absl::UnavailableError(
+              absl::StrCat("Failed to fetch the bidding signals snapshot: ",
+                           GetErrorMessage(context.result.status_code))));
+          return;
+        }
+        OnFetched(std::move(*context.response->mutable_blob()->mutable_data()));
+      });
+  if (auto result = blob_storage_client_->GetBlob(get_blob_context);
+      !result.Successful()) {
+    OnFetched(absl::UnavailableError(
+        absl::StrCat("Failed to fetch the bidding signals snapshot: ",
+                     GetErrorMessage(result.status_code))));
+  }
+}
+
+void BiddingSignalsSnapshotFetcher::OnFetched(
+    absl::StatusOr<std::string> blob) {
+  if (!blob.ok()) {
+    LOG(ERROR) << blob.status();
+  } else if (const size_t content_hash = absl::Hash<std::string>{}(*blob);
+             content_hash != content_hash_) {
+    absl::StatusOr<std::shared_ptr<const BiddingSignalsSnapshot>> snapshot =
+        BiddingSignalsSnapshot::Create(*std::move(blob));
+    if (snapshot.ok()) {
+      VLOG(1) << "Loaded a bidding signals snapshot of " << (*snapshot)->size()
+              << " keys";
+      provider_->SetSnapshot(*std::move(snapshot));
+      content_hash_ = content_hash;
+    } else {
+      LOG(ERROR) << "Malformed bidding signals snapshot: "
+                 << snapshot.status();
+    }
+  }
+  task_id_ = executor_->RunAfter(fetch_period_, [this]() { Fetch(); });
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_BFE_SERVICE_PROVIDERS_SNAPSHOT_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
+#define SERVICES_BFE_SERVICE_PROVIDERS_SNAPSHOT_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "cc/public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
+#include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
+#include "services/common/util/key_value_table.h"
+#include "src/cpp/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Immutable snapshot of the bidding signals of a buyer: a key-value table (see
+// services/common/util/key_value_table.h) whose "keys" namespace holds the
+// serialized JSON value of each key, indexed once when the snapshot is made.
+class BiddingSignalsSnapshot {
+ public:
+  // Returns an error if the table is malformed.
+  static absl::StatusOr<std::shared_ptr<const BiddingSignalsSnapshot>> Create(
+      std::string table);
+
+  // Not copyable or movable, as the index points into the table.
+  BiddingSignalsSnapshot(const BiddingSignalsSnapshot&) = delete;
+  BiddingSignalsSnapshot& operator=(const BiddingSignalsSnapshot&) = delete;
+
+  // Returns the value of the key, or nullptr if the snapshot does not have it.
+  const absl::string_view* Find(absl::string_view key) const;
+
+  size_t size() const { return keys_.size(); }
+
+ private:
+  explicit BiddingSignalsSnapshot(std::string table)
+      : table_(std::move(table)) {}
+
+  const std::string table_;
+  KeyValueTableNamespace keys_;
+};
+
+// Serves the bidding signals from a snapshot refreshed in the background,
+// for hot and slowly changing signals, saving the round trip to the Key-Value
+// server of each GetBids. The keys the snapshot does not have are looked up
+// with the fallback, and the values of both are merged.
+class SnapshotBiddingSignalsAsyncProvider final
+    : public BiddingSignalsAsyncProvider {
+ public:
+  // fallback: looks up the keys missing from the snapshot. If not set, they
+  // are left out of the signals.
+  // emit_table: whether the signals served without the fallback are a
+  // key-value table, which the fallback should then return too, rather than
+  // JSON.
+  explicit SnapshotBiddingSignalsAsyncProvider(
+      std::unique_ptr<BiddingSignalsAsyncProvider> fallback,
+      bool emit_table = false);
+
+  // Not copyable or movable.
+  SnapshotBiddingSignalsAsyncProvider(
+      const SnapshotBiddingSignalsAsyncProvider&) = delete;
+  SnapshotBiddingSignalsAsyncProvider& operator=(
+      const SnapshotBiddingSignalsAsyncProvider&) = delete;
+
+  // Replaces the snapshot the lookups are served from. Lookups in flight keep
+  // the one they started with. Thread safe.
+  void SetSnapshot(std::shared_ptr<const BiddingSignalsSnapshot> snapshot);
+
+  // Looks up the names and keys of the interest groups of the request in the
+  // snapshot, and the ones it does not have with the fallback. on_done is
+  // called right away if the snapshot has all of them.
+  void Get(const BiddingSignalsRequest& bidding_signals_request,
+           absl::AnyInvocable<
+               void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+               on_done,
+           absl::Duration timeout) const override;
+
+ private:
+  std::unique_ptr<BiddingSignalsAsyncProvider> fallback_;
+  const bool emit_table_;
+  // Swapped and read atomically, so that lookups never wait for a refresh.
+  std::shared_ptr<const BiddingSignalsSnapshot> snapshot_;
+};
+
+// Fetches the snapshot of a SnapshotBiddingSignalsAsyncProvider from a blob
+// of a bucket every fetch period, as PeriodicBucketFetcher does code, and
+// sets it on the provider whenever it changes.
+class BiddingSignalsSnapshotFetcher {
+ public:
+  BiddingSignalsSnapshotFetcher(
+      std::string bucket_name, std::string blob_name,
+      absl::Duration fetch_period, server_common::Executor* executor,
+      std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
+          blob_storage_client,
+      SnapshotBiddingSignalsAsyncProvider* provider);
+
+  // Not copyable or movable.
+  BiddingSignalsSnapshotFetcher(const BiddingSignalsSnapshotFetcher&) = delete;
+  BiddingSignalsSnapshotFetcher& operator=(
+      const BiddingSignalsSnapshotFetcher&) = delete;
+
+  // Starts fetching the snapshot, the first time right away.
+  void Start();
+
+  // Cancels the next fetch.
+  void End();
+
+ private:
+  void Fetch();
+  // Sets the fetched snapshot on the provider if it changed, and schedules
+  // the next fetch.
+  void OnFetched(absl::StatusOr<std::string> blob);
+
+  const std::string bucket_name_;
+  const std::string blob_name_;
+  const absl::Duration fetch_period_;
+  server_common::Executor* executor_;
+  std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
+      blob_storage_client_;
+  SnapshotBiddingSignalsAsyncProvider* provider_;
+  // Hash of the blob last set on the provider, as the blob can be large.
+  size_t content_hash_ = 0;
+  server_common::TaskId task_id_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BFE_SERVICE_PROVIDERS_SNAPSHOT_BIDDING_SIGNALS_ASYNC_PROVIDER_H_
@@ -0,0 +1,166 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/buyer_frontend_service/providers/snapshot_bidding_signals_async_provider.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "gtest/gtest.h"
+#include "services/buyer_frontend_service/data/bidding_signals.h"
+#include "services/common/test/mocks.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::_;
+using MockBiddingSignalsProvider =
+    MockAsyncProvider<BiddingSignalsRequest, BiddingSignals>;
+
+// Returns a snapshot of the hot keys of the tests.
+std::shared_ptr<const BiddingSignalsSnapshot> MakeSnapshot() {
+  std::string table;
+  AppendKeyValueTableSection("keys", 3, &table);
+  AppendKeyValueTableEntry("ig", R"({"ads":1})", &table);
+  AppendKeyValueTableEntry("hot1", "1", &table);
+  AppendKeyValueTableEntry("hot2", R"("two")", &table);
+  absl::StatusOr<std::shared_ptr<const BiddingSignalsSnapshot>> snapshot =
+      BiddingSignalsSnapshot::Create(std::move(table));
+  CHECK_OK(snapshot);
+  return *std::move(snapshot);
+}
+
+GetBidsRequest::GetBidsRawRequest MakeRequest(
+    std::initializer_list<const char*> keys) {
+  GetBidsRequest::GetBidsRawRequest request;
+  request.set_publisher_name("publisher.com");
+  auto* interest_group =
+      request.mutable_buyer_input()->mutable_interest_groups()->Add();
+  interest_group->set_name("ig");
+  for (const char* key : keys) {
+    interest_group->add_bidding_signals_keys(key);
+  }
+  return request;
+}
+
+// Returns the trusted signals served by the provider for the request.
+std::string GetSignals(const SnapshotBiddingSignalsAsyncProvider& provider,
+                       const GetBidsRequest::GetBidsRawRequest& request) {
+  absl::flat_hash_map<std::string, std::string> filtering_metadata;
+  std::string trusted_signals;
+  provider.Get(
+      BiddingSignalsRequest(request, filtering_metadata),
+      [&trusted_signals](
+          absl::StatusOr<std::unique_ptr<BiddingSignals>> signals) {
+        ASSERT_TRUE(signals.ok()) << signals.status();
+        trusted_signals = *(*signals)->trusted_signals;
+      },
+      absl::Milliseconds(100));
+  return trusted_signals;
+}
+
+TEST(BiddingSignalsSnapshotTest, IndexesTheKeysOfTheTable) {
+  std::shared_ptr<const BiddingSignalsSnapshot> snapshot = MakeSnapshot();
+  EXPECT_EQ(snapshot->size(), 3);
+  ASSERT_NE(snapshot->Find("hot2"), nullptr);
+  EXPECT_EQ(*snapshot->Find("hot2"), R"("two")");
+  EXPECT_EQ(snapshot->Find("cold"), nullptr);
+}
+
+TEST(BiddingSignalsSnapshotTest, RejectsMalformedTables) {
+  EXPECT_FALSE(BiddingSignalsSnapshot::Create("{}").ok());
+  std::string table;
+  AppendKeyValueTableSection("keys", 2, &table);
+  AppendKeyValueTableEntry("hot1", "1", &table);
+  EXPECT_FALSE(BiddingSignalsSnapshot::Create(std::move(table)).ok());
+}
+
+TEST(SnapshotBiddingSignalsAsyncProviderTest,
+     ServesTheKeysOfTheSnapshotWithoutTheFallback) {
+  auto fallback = std::make_unique<MockBiddingSignalsProvider>();
+  EXPECT_CALL(*fallback, Get).Times(0);
+  SnapshotBiddingSignalsAsyncProvider provider(std::move(fallback));
+  provider.SetSnapshot(MakeSnapshot());
+
+  absl::StatusOr<rapidjson::Document> signals =
+      ParseJsonString(GetSignals(provider, MakeRequest({"hot1", "hot2"})));
+  ASSERT_TRUE(signals.ok()) << signals.status();
+  const rapidjson::Value& keys = (*signals)["keys"];
+  EXPECT_EQ(keys["ig"]["ads"].GetInt(), 1);
+  EXPECT_EQ(keys["hot1"].GetInt(), 1);
+  EXPECT_STREQ(keys["hot2"].GetString(), "two");
+}
+
+TEST(SnapshotBiddingSignalsAsyncProviderTest,
+     LooksUpTheMissingKeysWithTheFallback) {
+  auto fallback = std::make_unique<MockBiddingSignalsProvider>();
+  EXPECT_CALL(*fallback, Get(_, _, _))
+      .WillOnce([](const BiddingSignalsRequest& request, auto on_done,
+                   absl::Duration timeout) {
+        const GetBidsRequest::GetBidsRawRequest& raw_request =
+            request.get_bids_raw_request_;
+        EXPECT_EQ(raw_request.publisher_name(), "publisher.com");
+        ASSERT_EQ(raw_request.buyer_input().interest_groups_size(), 1);
+        const auto& interest_group =
+            raw_request.buyer_input().interest_groups(0);
+        EXPECT_EQ(interest_group.name(), "ig");
+        ASSERT_EQ(interest_group.bidding_signals_keys_size(), 1);
+        EXPECT_EQ(interest_group.bidding_signals_keys(0), "cold");
+        auto signals = std::make_unique<BiddingSignals>();
+        signals->trusted_signals =
+            std::make_unique<std::string>(R"({"keys":{"cold":[3]}})");
+        std::move(on_done)(std::move(signals));
+      });
+  SnapshotBiddingSignalsAsyncProvider provider(std::move(fallback));
+  provider.SetSnapshot(MakeSnapshot());
+
+  absl::StatusOr<rapidjson::Document> signals =
+      ParseJsonString(GetSignals(provider, MakeRequest({"hot1", "cold"})));
+  ASSERT_TRUE(signals.ok()) << signals.status();
+  const rapidjson::Value& keys = (*signals)["keys"];
+  EXPECT_EQ(keys["hot1"].GetInt(), 1);
+  EXPECT_EQ(keys["cold"][0].GetInt(), 3);
+}
+
+TEST(SnapshotBiddingSignalsAsyncProviderTest,
+     AppendsTheSnapshotValuesToTableResponses) {
+  auto fallback = std::make_unique<MockBiddingSignalsProvider>();
+  EXPECT_CALL(*fallback, Get(_, _, _))
+      .WillOnce([](const BiddingSignalsRequest& request, auto on_done,
+                   absl::Duration timeout) {
+        std::string table;
+        AppendKeyValueTableSection("keys", 1, &table);
+        AppendKeyValueTableEntry("cold", "3", &table);
+        auto signals = std::make_unique<BiddingSignals>();
+        signals->trusted_signals = std::make_unique<std::string>(table);
+        std::move(on_done)(std::move(signals));
+      });
+  SnapshotBiddingSignalsAsyncProvider provider(std::move(fallback),
+                                               /*emit_table=*/true);
+  provider.SetSnapshot(MakeSnapshot());
+
+  absl::StatusOr<KeyValueTable> table =
+      ParseKeyValueTable(GetSignals(provider, MakeRequest({"hot1", "cold"})));
+  ASSERT_TRUE(table.ok()) << table.status();
+  KeyValueTableNamespace& keys = (*table)["keys"];
+  EXPECT_EQ(keys["cold"], "3");
+  EXPECT_EQ(keys["hot1"], "1");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -31,15 +31,64 @@ inline constexpr char PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS[] =
     "PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS";
 inline constexpr char BIDDING_SIGNALS_LOAD_TIMEOUT_MS[] =
     "BIDDING_SIGNALS_LOAD_TIMEOUT_MS";
+inline constexpr char GENERATE_BIDS_PARTITION_THRESHOLD[] =
+    "GENERATE_BIDS_PARTITION_THRESHOLD";
+inline constexpr char GENERATE_BIDS_MAX_PARTITIONS[] =
+    "GENERATE_BIDS_MAX_PARTITIONS";
 inline constexpr char ENABLE_BUYER_FRONTEND_BENCHMARKING[] =
     "ENABLE_BUYER_FRONTEND_BENCHMARKING";
 inline constexpr char CREATE_NEW_EVENT_ENGINE[] = "CREATE_NEW_EVENT_ENGINE";
+inline constexpr char ENABLE_CURL_EVENT_LOOP[] = "ENABLE_CURL_EVENT_LOOP";
+inline constexpr char ENABLE_KV_HTTP2_MULTIPLEXING[] =
+    "ENABLE_KV_HTTP2_MULTIPLEXING";
+inline constexpr char ENABLE_KV_REQUEST_COALESCING[] =
+    "ENABLE_KV_REQUEST_COALESCING";
+inline constexpr char ENABLE_KV_POST_REQUESTS[] = "ENABLE_KV_POST_REQUESTS";
+inline constexpr char ENABLE_KV_REQUEST_COMPRESSION[] =
+    "ENABLE_KV_REQUEST_COMPRESSION";
+inline constexpr char KV_MAX_KEYS_PER_REQUEST[] = "KV_MAX_KEYS_PER_REQUEST";
+inline constexpr char KV_BATCH_MAX_KEYS[] = "KV_BATCH_MAX_KEYS";
+inline constexpr char KV_BATCH_MAX_DELAY_US[] = "KV_BATCH_MAX_DELAY_US";
+inline constexpr char ENABLE_KV_TABLE_RESPONSES[] = "ENABLE_KV_TABLE_RESPONSES";
+inline constexpr char ENABLE_BIDDING_SIGNALS_PROJECTION[] =
+    "ENABLE_BIDDING_SIGNALS_PROJECTION";
+inline constexpr char KV_NUM_SHARDS[] = "KV_NUM_SHARDS";
+inline constexpr char ENABLE_KV_REQUEST_HEDGING[] = "ENABLE_KV_REQUEST_HEDGING";
+inline constexpr char KV_HEDGING_LATENCY_PERCENTILE[] =
+    "KV_HEDGING_LATENCY_PERCENTILE";
+inline constexpr char KV_HEDGING_BUDGET_PERCENT[] = "KV_HEDGING_BUDGET_PERCENT";
+inline constexpr char BUYER_KV_CACHE_TTL_MS[] = "BUYER_KV_CACHE_TTL_MS";
+inline constexpr char BUYER_KV_CACHE_MAX_BYTES[] = "BUYER_KV_CACHE_MAX_BYTES";
+inline constexpr char BUYER_KV_CACHE_MISS_TTL_MS[] =
+    "BUYER_KV_CACHE_MISS_TTL_MS";
 inline constexpr char ENABLE_BIDDING_COMPRESSION[] =
     "ENABLE_BIDDING_COMPRESSION";
+inline constexpr char GRPC_COMPRESSION_ALGORITHM[] =
+    "GRPC_COMPRESSION_ALGORITHM";
+inline constexpr char GRPC_COMPRESSION_MIN_MESSAGE_BYTES[] =
+    "GRPC_COMPRESSION_MIN_MESSAGE_BYTES";
 inline constexpr char BFE_INGRESS_TLS[] = "BFE_INGRESS_TLS";
 inline constexpr char BFE_TLS_KEY[] = "BFE_TLS_KEY";
 inline constexpr char BFE_TLS_CERT[] = "BFE_TLS_CERT";
 inline constexpr char BIDDING_EGRESS_TLS[] = "BIDDING_EGRESS_TLS";
+inline constexpr char BIDDING_CHANNEL_POOL_SIZE[] = "BIDDING_CHANNEL_POOL_SIZE";
+inline constexpr char BIDDING_FLOW_CONTROL_WINDOW_BYTES[] =
+    "BIDDING_FLOW_CONTROL_WINDOW_BYTES";
+inline constexpr char BIDDING_LEAST_LOADED_ROUTING[] =
+    "BIDDING_LEAST_LOADED_ROUTING";
+inline constexpr char SHADOW_BIDDING_SERVER_ADDR[] =
+    "SHADOW_BIDDING_SERVER_ADDR";
+inline constexpr char SHADOW_TRAFFIC_PERCENT[] = "SHADOW_TRAFFIC_PERCENT";
+inline constexpr char BIDDING_SIGNALS_SNAPSHOT_BUCKET[] =
+    "BIDDING_SIGNALS_SNAPSHOT_BUCKET";
+inline constexpr char BIDDING_SIGNALS_SNAPSHOT_BLOB[] =
+    "BIDDING_SIGNALS_SNAPSHOT_BLOB";
+inline constexpr char BIDDING_SIGNALS_SNAPSHOT_FETCH_PERIOD_MS[] =
+    "BIDDING_SIGNALS_SNAPSHOT_FETCH_PERIOD_MS";
+inline constexpr char ENABLE_CHANNEL_PRE_WARMING[] =
+    "ENABLE_CHANNEL_PRE_WARMING";
+inline constexpr char CHANNEL_PRE_WARMING_TIMEOUT_MS[] =
+    "CHANNEL_PRE_WARMING_TIMEOUT_MS";
 
 inline constexpr absl::string_view kFlags[] = {
     PORT,
@@ -48,13 +97,44 @@ inline constexpr absl::string_view kFlags[] = {
     GENERATE_BID_TIMEOUT_MS,
     PROTECTED_APP_SIGNALS_GENERATE_BID_TIMEOUT_MS,
     BIDDING_SIGNALS_LOAD_TIMEOUT_MS,
+    GENERATE_BIDS_PARTITION_THRESHOLD,
+    GENERATE_BIDS_MAX_PARTITIONS,
     ENABLE_BUYER_FRONTEND_BENCHMARKING,
     CREATE_NEW_EVENT_ENGINE,
+    ENABLE_CURL_EVENT_LOOP,
+    ENABLE_KV_HTTP2_MULTIPLEXING,
+    ENABLE_KV_REQUEST_COALESCING,
+    ENABLE_KV_POST_REQUESTS,
+    ENABLE_KV_REQUEST_COMPRESSION,
+    KV_MAX_KEYS_PER_REQUEST,
+    KV_BATCH_MAX_KEYS,
+    KV_BATCH_MAX_DELAY_US,
+    ENABLE_KV_TABLE_RESPONSES,
+    ENABLE_BIDDING_SIGNALS_PROJECTION,
+    KV_NUM_SHARDS,
+    ENABLE_KV_REQUEST_HEDGING,
+    KV_HEDGING_LATENCY_PERCENTILE,
+    KV_HEDGING_BUDGET_PERCENT,
+    BUYER_KV_CACHE_TTL_MS,
+    BUYER_KV_CACHE_MAX_BYTES,
+    BUYER_KV_CACHE_MISS_TTL_MS,
     ENABLE_BIDDING_COMPRESSION,
+    GRPC_COMPRESSION_ALGORITHM,
+    GRPC_COMPRESSION_MIN_MESSAGE_BYTES,
     BFE_INGRESS_TLS,
     BFE_TLS_KEY,
     BFE_TLS_CERT,
     BIDDING_EGRESS_TLS,
+    BIDDING_CHANNEL_POOL_SIZE,
+    BIDDING_FLOW_CONTROL_WINDOW_BYTES,
+    BIDDING_LEAST_LOADED_ROUTING,
+    SHADOW_BIDDING_SERVER_ADDR,
+    SHADOW_TRAFFIC_PERCENT,
+    BIDDING_SIGNALS_SNAPSHOT_BUCKET,
+    BIDDING_SIGNALS_SNAPSHOT_BLOB,
+    BIDDING_SIGNALS_SNAPSHOT_FETCH_PERIOD_MS,
+    ENABLE_CHANNEL_PRE_WARMING,
+    CHANNEL_PRE_WARMING_TIMEOUT_MS,
 };
 
 inline std::vector<absl::string_view> GetServiceFlags() {
@@ -0,0 +1,160 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/buyer_frontend_service/util/bidding_signals_projection.h"
+
+#include <utility>
+
+#include "absl/status/statusor.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kKeys[] = "keys";
+
+std::string ProjectTable(const KeyValueTable& namespaces, size_t table_size,
+                         const absl::flat_hash_set<absl::string_view>& keys) {
+  std::string projected;
+  projected.reserve(table_size);
+  for (const auto& [name, values] : namespaces) {
+    if (name != kKeys) {
+      AppendKeyValueTableSection(name, static_cast<int>(values.size()),
+                                 &projected);
+      for (const auto& [key, value] : values) {
+        AppendKeyValueTableEntry(key, value, &projected);
+      }
+      continue;
+    }
+    int count = 0;
+    for (const auto& [key, value] : values) {
+      count += keys.contains(key);
+    }
+    AppendKeyValueTableSection(name, count, &projected);
+    for (const auto& [key, value] : values) {
+      if (keys.contains(key)) {
+        AppendKeyValueTableEntry(key, value, &projected);
+      }
+    }
+  }
+  return projected;
+}
+
+std::string ProjectTable(std::string table,
+                         const absl::flat_hash_set<absl::string_view>& keys) {
+  absl::StatusOr<KeyValueTable> namespaces = ParseKeyValueTable(table);
+  if (!namespaces.ok()) {
+    return table;
+  }
+  return ProjectTable(*namespaces, table.size(), keys);
+}
+
+// Writes document with only the members of its "keys" object found in keys,
+// without modifying it, so that it can be projected again.
+std::string WriteProjectedJson(
+    const rapidjson::Document& document,
+    const absl::flat_hash_set<absl::string_view>& keys) {
+  rapidjson::StringBuffer string_buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
+  writer.StartObject();
+  for (const auto& member : document.GetObject()) {
+    member.name.Accept(writer);
+    if (member.name != kKeys || !member.value.IsObject()) {
+      member.value.Accept(writer);
+      continue;
+    }
+    writer.StartObject();
+    for (const auto& key : member.value.GetObject()) {
+      if (keys.contains(absl::string_view(key.name.GetString(),
+                                          key.name.GetStringLength()))) {
+        key.name.Accept(writer);
+        key.value.Accept(writer);
+      }
+    }
+    writer.EndObject();
+  }
+  writer.EndObject();
+  return std::string(string_buffer.GetString(), string_buffer.GetSize());
+}
+
+std::string ProjectJson(std::string json,
+                        const absl::flat_hash_set<absl::string_view>& keys) {
+  absl::StatusOr<rapidjson::Document> document = ParseJsonString(json);
+  if (!document.ok() || !document->IsObject()) {
+    return json;
+  }
+  auto keys_itr = document->FindMember(kKeys);
+  if (keys_itr == document->MemberEnd() || !keys_itr->value.IsObject()) {
+    return json;
+  }
+  // The members are moved rather than erased one by one, which would shift
+  // the following ones each time.
+  rapidjson::Value projected(rapidjson::kObjectType);
+  auto& allocator = document->GetAllocator();
+  for (auto& member : keys_itr->value.GetObject()) {
+    if (keys.contains(absl::string_view(member.name.GetString(),
+                                        member.name.GetStringLength()))) {
+      projected.AddMember(member.name, member.value, allocator);
+    }
+  }
+  keys_itr->value.Swap(projected);
+  absl::StatusOr<std::string> serialized = SerializeJsonDoc(*document);
+  if (!serialized.ok()) {
+    return json;
+  }
+  return *std::move(serialized);
+}
+
+}  // namespace
+
+std::string ProjectBiddingSignals(
+    std::string signals, const absl::flat_hash_set<absl::string_view>& keys) {
+  if (IsKeyValueTable(signals)) {
+    return ProjectTable(std::move(signals), keys);
+  }
+  return ProjectJson(std::move(signals), keys);
+}
+
+std::vector<std::string> ProjectBiddingSignals(
+    absl::string_view signals,
+    absl::Span<const absl::flat_hash_set<absl::string_view>> key_sets) {
+  std::vector<std::string> projected;
+  projected.reserve(key_sets.size());
+  if (IsKeyValueTable(signals)) {
+    if (absl::StatusOr<KeyValueTable> namespaces = ParseKeyValueTable(signals);
+        namespaces.ok()) {
+      for (const auto& keys : key_sets) {
+        projected.push_back(ProjectTable(*namespaces, signals.size(), keys));
+      }
+      return projected;
+    }
+  } else if (absl::StatusOr<rapidjson::Document> document =
+                 ParseJsonString(signals);
+             document.ok() && document->IsObject()) {
+    if (auto keys_itr = document->FindMember(kKeys);
+        keys_itr != document->MemberEnd() && keys_itr->value.IsObject()) {
+      for (const auto& keys : key_sets) {
+        projected.push_back(WriteProjectedJson(*document, keys));
+      }
+      return projected;
+    }
+  }
+  projected.assign(key_sets.size(), std::string(signals));
+  return projected;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,45 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERVICES_BUYER_FRONTEND_SERVICE_UTIL_BIDDING_SIGNALS_PROJECTION_H_
+#define SERVICES_BUYER_FRONTEND_SERVICE_UTIL_BIDDING_SIGNALS_PROJECTION_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Returns the trusted bidding signals of a Key-Value server response with
+// only the members of its "keys" namespace found in keys, e.g. the names and
+// trusted bidding signals keys of the interest groups of a bidding request.
+// The other namespaces are kept as they are. Key-value tables are projected
+// from their slices without parsing any JSON. Signals that are neither
+// key-value tables nor JSON objects are returned as they are, for the bidding
+// service to report.
+std::string ProjectBiddingSignals(
+    std::string signals, const absl::flat_hash_set<absl::string_view>& keys);
+
+// Same as ProjectBiddingSignals for each of key_sets, e.g. the keys of the
+// partitions of a bidding request, but parses the signals only once.
+std::vector<std::string> ProjectBiddingSignals(
+    absl::string_view signals,
+    absl::Span<const absl::flat_hash_set<absl::string_view>> key_sets);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BUYER_FRONTEND_SERVICE_UTIL_BIDDING_SIGNALS_PROJECTION_H_
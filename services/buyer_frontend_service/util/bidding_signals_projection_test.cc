@@ -0,0 +1,99 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/buyer_frontend_service/util/bidding_signals_projection.h"
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(ProjectBiddingSignalsTest, KeepsOnlyRequestedJsonKeys) {
+  const std::string signals =
+      R"JSON({"keys":{"ig":[1],"unused":{"a":2},"key":"v"},)JSON"
+      R"JSON("perInterestGroupData":{"ig":{}}})JSON";
+
+  EXPECT_EQ(ProjectBiddingSignals(signals, {"ig", "key", "missing"}),
+            R"JSON({"keys":{"ig":[1],"key":"v"},)JSON"
+            R"JSON("perInterestGroupData":{"ig":{}}})JSON");
+}
+
+TEST(ProjectBiddingSignalsTest, KeepsOnlyRequestedTableKeys) {
+  std::string signals;
+  AppendKeyValueTableSection("keys", 3, &signals);
+  AppendKeyValueTableEntry("ig", "[1]", &signals);
+  AppendKeyValueTableEntry("unused", R"({"a":2})", &signals);
+  AppendKeyValueTableEntry("key", R"("v")", &signals);
+
+  const std::string projected = ProjectBiddingSignals(signals, {"ig", "key"});
+  absl::StatusOr<KeyValueTable> table = ParseKeyValueTable(projected);
+  ASSERT_TRUE(table.ok()) << table.status();
+  EXPECT_THAT((*table)["keys"],
+              UnorderedElementsAre(Pair("ig", "[1]"), Pair("key", R"("v")")));
+}
+
+TEST(ProjectBiddingSignalsTest, ReturnsUnexpectedSignalsAsIs) {
+  EXPECT_EQ(ProjectBiddingSignals("not json", {"ig"}), "not json");
+  EXPECT_EQ(ProjectBiddingSignals(R"JSON([1])JSON", {"ig"}), "[1]");
+  EXPECT_EQ(ProjectBiddingSignals(R"JSON({"other":1})JSON", {"ig"}),
+            R"JSON({"other":1})JSON");
+  EXPECT_EQ(ProjectBiddingSignals("KVT14:keys", {"ig"}), "KVT14:keys");
+}
+
+TEST(ProjectBiddingSignalsTest, ProjectsJsonForEachKeySet) {
+  const std::string signals =
+      R"JSON({"keys":{"ig1":[1],"shared":2,"ig2":3},"other":{}})JSON";
+
+  EXPECT_THAT(ProjectBiddingSignals(absl::string_view(signals),
+                                    {{"ig1", "shared"}, {"ig2", "shared"}}),
+              ElementsAre(R"JSON({"keys":{"ig1":[1],"shared":2},)JSON"
+                          R"JSON("other":{}})JSON",
+                          R"JSON({"keys":{"shared":2,"ig2":3},)JSON"
+                          R"JSON("other":{}})JSON"));
+}
+
+TEST(ProjectBiddingSignalsTest, ProjectsTableForEachKeySet) {
+  std::string signals;
+  AppendKeyValueTableSection("keys", 2, &signals);
+  AppendKeyValueTableEntry("ig1", "[1]", &signals);
+  AppendKeyValueTableEntry("ig2", "3", &signals);
+
+  const std::vector<std::string> projected = ProjectBiddingSignals(
+      absl::string_view(signals), {{"ig1"}, {"ig2"}});
+  ASSERT_EQ(projected.size(), 2);
+  absl::StatusOr<KeyValueTable> first = ParseKeyValueTable(projected[0]);
+  ASSERT_TRUE(first.ok()) << first.status();
+  EXPECT_THAT((*first)["keys"], ElementsAre(Pair("ig1", "[1]")));
+  absl::StatusOr<KeyValueTable> second = ParseKeyValueTable(projected[1]);
+  ASSERT_TRUE(second.ok()) << second.status();
+  EXPECT_THAT((*second)["keys"], ElementsAre(Pair("ig2", "3")));
+}
+
+TEST(ProjectBiddingSignalsTest, CopiesUnexpectedSignalsForEachKeySet) {
+  EXPECT_THAT(
+      ProjectBiddingSignals(absl::string_view("not json"), {{"ig1"}, {"ig2"}}),
+      ElementsAre("not json", "not json"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,58 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
+
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+void ChaffResponseShaper::Record(bool streamed, Shape shape) {
+  if (shape.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  Ring& ring = streamed ? streamed_ : unary_;
+  if (ring.samples.size() < kMaxSamples) {
+    ring.samples.push_back(std::move(shape));
+    return;
+  }
+  ring.samples[ring.next] = std::move(shape);
+  ring.next = (ring.next + 1) % kMaxSamples;
+}
+
+ChaffResponseShaper::Shape ChaffResponseShaper::Sample(bool streamed) {
+  absl::MutexLock lock(&mu_);
+  const Ring& ring = streamed ? streamed_ : unary_;
+  if (ring.samples.empty()) {
+    return {{kFloorLatency, kFloorRawResponseBytes}};
+  }
+  return ring.samples[absl::Uniform<size_t>(bit_gen_, 0, ring.samples.size())];
+}
+
+size_t ChaffPaddingBytes(size_t target_bytes, size_t unpadded_bytes) {
+  // An empty padding field takes a byte of tag and a byte of length.
+  if (target_bytes <= unpadded_bytes + 2) {
+    return 0;
+  }
+  const size_t field_bytes = target_bytes - unpadded_bytes - 1;
+  // The length of the padding is a varint, of 7 bits per byte.
+  size_t length_bytes = 1;
+  while (field_bytes - length_bytes >= size_t{1} << (7 * length_bytes)) {
+    ++length_bytes;
+  }
+  return field_bytes - length_bytes;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,83 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERVICES_BUYER_FRONTEND_SERVICE_UTIL_CHAFF_RESPONSE_SHAPER_H_
+#define SERVICES_BUYER_FRONTEND_SERVICE_UTIL_CHAFF_RESPONSE_SHAPER_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/random/random.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Shapes the responses to the chaff GetBids requests, which the SFE sends to
+// buyers that are not in the auction, after the responses to the recent real
+// requests: a chaff response is sent in as many chunks, as late and as large
+// as a real response of the same RPC picked at random among its last
+// kMaxSamples, so that neither its latency, its size on the wire nor, with
+// GetBidsStream, its number of chunks tells it apart. Thread safe.
+class ChaffResponseShaper {
+ public:
+  // Real responses of each RPC a chaff response is shaped after.
+  static constexpr int kMaxSamples = 256;
+  // Chunk a chaff response is shaped as until a real response of its RPC is
+  // recorded, so that the first chaff responses are not sent right away and
+  // empty.
+  static constexpr absl::Duration kFloorLatency = absl::Milliseconds(50);
+  static constexpr size_t kFloorRawResponseBytes = 1024;
+
+  struct Chunk {
+    // Time from the decryption of the request until the chunk is sent.
+    absl::Duration latency;
+    // Size of the serialized raw response of the chunk.
+    size_t raw_response_bytes = 0;
+  };
+
+  // Chunks of a response in the order they are sent: the single response of
+  // GetBids, or each chunk written by GetBidsStream.
+  using Shape = std::vector<Chunk>;
+
+  // Records the shape of the response to a real request, of GetBidsStream if
+  // streamed or else of GetBids.
+  void Record(bool streamed, Shape shape) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the shape of one of the recent real responses of the RPC, picked
+  // at random, or the floor chunk if none was recorded yet.
+  Shape Sample(bool streamed) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // The last kMaxSamples shapes of an RPC, next being the oldest once full.
+  struct Ring {
+    std::vector<Shape> samples;
+    size_t next = 0;
+  };
+
+  absl::Mutex mu_;
+  Ring unary_ ABSL_GUARDED_BY(mu_);
+  Ring streamed_ ABSL_GUARDED_BY(mu_);
+  absl::BitGen bit_gen_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the length of the padding field to add to a raw response of
+// unpadded_bytes for it to serialize to target_bytes, counting the tag and
+// length of the field, or 0 if it is already about as large.
+size_t ChaffPaddingBytes(size_t target_bytes, size_t unpadded_bytes);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_BUYER_FRONTEND_SERVICE_UTIL_CHAFF_RESPONSE_SHAPER_H_
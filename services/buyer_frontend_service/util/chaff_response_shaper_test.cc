@@ -0,0 +1,74 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/buyer_frontend_service/util/chaff_response_shaper.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ChaffResponseShaperTest, SamplesTheFloorUntilARealShapeIsRecorded) {
+  ChaffResponseShaper shaper;
+  ChaffResponseShaper::Shape shape = shaper.Sample(/*streamed=*/false);
+  ASSERT_EQ(shape.size(), 1u);
+  EXPECT_EQ(shape[0].latency, ChaffResponseShaper::kFloorLatency);
+  EXPECT_EQ(shape[0].raw_response_bytes,
+            ChaffResponseShaper::kFloorRawResponseBytes);
+
+  shaper.Record(/*streamed=*/false, {{absl::Milliseconds(40), 1000}});
+  shape = shaper.Sample(/*streamed=*/false);
+  ASSERT_EQ(shape.size(), 1u);
+  EXPECT_EQ(shape[0].latency, absl::Milliseconds(40));
+  EXPECT_EQ(shape[0].raw_response_bytes, 1000u);
+}
+
+TEST(ChaffResponseShaperTest, KeepsTheShapesOfEachRpcApart) {
+  ChaffResponseShaper shaper;
+  shaper.Record(/*streamed=*/true, {{absl::Milliseconds(10), 100},
+                                    {absl::Milliseconds(30), 200}});
+  ChaffResponseShaper::Shape shape = shaper.Sample(/*streamed=*/true);
+  ASSERT_EQ(shape.size(), 2u);
+  EXPECT_EQ(shape[1].latency, absl::Milliseconds(30));
+  EXPECT_EQ(shape[1].raw_response_bytes, 200u);
+  EXPECT_EQ(shaper.Sample(/*streamed=*/false)[0].latency,
+            ChaffResponseShaper::kFloorLatency);
+}
+
+TEST(ChaffResponseShaperTest, SamplesOnlyTheRecentShapes) {
+  ChaffResponseShaper shaper;
+  shaper.Record(/*streamed=*/false, {{absl::Seconds(10), 1}});
+  for (int i = 0; i < ChaffResponseShaper::kMaxSamples; ++i) {
+    shaper.Record(/*streamed=*/false, {{absl::Milliseconds(i), 2}});
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(shaper.Sample(/*streamed=*/false)[0].raw_response_bytes, 2u);
+  }
+}
+
+TEST(ChaffPaddingBytesTest, CountsTheTagAndLengthOfThePadding) {
+  EXPECT_EQ(ChaffPaddingBytes(10, 0), 8u);
+  // Lengths past 127 take two bytes.
+  EXPECT_EQ(ChaffPaddingBytes(200, 0), 197u);
+  EXPECT_EQ(ChaffPaddingBytes(1000, 100), 897u);
+}
+
+TEST(ChaffPaddingBytesTest, DoesNotPadResponsesAsLargeAsTheTarget) {
+  EXPECT_EQ(ChaffPaddingBytes(0, 0), 0u);
+  EXPECT_EQ(ChaffPaddingBytes(12, 10), 0u);
+  EXPECT_EQ(ChaffPaddingBytes(10, 100), 0u);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,10 +14,21 @@
 
 #include "services/buyer_frontend_service/util/proto_factory.h"
 
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "services/buyer_frontend_service/util/bidding_signals_projection.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
 using GetBidsRawRequest = GetBidsRequest::GetBidsRawRequest;
 using GetBidsRawResponse = GetBidsResponse::GetBidsRawResponse;
 using GenerateBidsRawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+using GenerateProtectedAppSignalsBidsRawRequest =
+    GenerateProtectedAppSignalsBidsRequest::
+        GenerateProtectedAppSignalsBidsRawRequest;
 
 std::unique_ptr<GetBidsRawResponse> ProtoFactory::CreateGetBidsRawResponse(
     std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>
@@ -34,6 +45,23 @@ std::unique_ptr<GetBidsRawResponse> ProtoFactory::CreateGetBidsRawResponse(
   return get_bids_raw_response;
 }
 
+std::unique_ptr<GetBidsRawResponse> ProtoFactory::CreateGetBidsRawResponse(
+    std::vector<std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+        raw_responses) {
+  auto get_bids_raw_response = std::make_unique<GetBidsRawResponse>();
+  // Initialize empty list.
+  auto* bids = get_bids_raw_response->mutable_bids();
+  for (auto& raw_response : raw_responses) {
+    if (!raw_response->IsInitialized()) {
+      continue;
+    }
+    for (auto& bid : *raw_response->mutable_bids()) {
+      bids->Add()->Swap(&bid);
+    }
+  }
+  return get_bids_raw_response;
+}
+
 // Copy properties from IG from device to IG for Bidding.
 void CopyIGFromDeviceToIGForBidding(
     const BuyerInput::InterestGroup& ig_from_device,
@@ -71,12 +99,83 @@ void CopyIGFromDeviceToIGForBidding(
   }
 }
 
+// Move properties from IG from device to IG for Bidding. The name is copied,
+// since the IG from device is still looked up by name.
+void MoveIGFromDeviceToIGForBidding(
+    BuyerInput::InterestGroup* ig_from_device,
+    GenerateBidsRequest::GenerateBidsRawRequest::InterestGroupForBidding*
+        mutable_ig_for_bidding) {
+  mutable_ig_for_bidding->set_name(ig_from_device->name());
+
+  if (!ig_from_device->user_bidding_signals().empty()) {
+    mutable_ig_for_bidding->set_user_bidding_signals(
+        std::move(*ig_from_device->mutable_user_bidding_signals()));
+  }
+
+  mutable_ig_for_bidding->mutable_ad_render_ids()->Swap(
+      ig_from_device->mutable_ad_render_ids());
+  mutable_ig_for_bidding->mutable_ad_component_render_ids()->Swap(
+      ig_from_device->mutable_component_ads());
+  mutable_ig_for_bidding->mutable_trusted_bidding_signals_keys()->Swap(
+      ig_from_device->mutable_bidding_signals_keys());
+
+  // Set Device Signals.
+  if (ig_from_device->has_browser_signals() &&
+      ig_from_device->browser_signals().IsInitialized()) {
+    mutable_ig_for_bidding->mutable_browser_signals()->Swap(
+        ig_from_device->mutable_browser_signals());
+  } else if (ig_from_device->has_android_signals()) {
+    mutable_ig_for_bidding->mutable_android_signals()->Swap(
+        ig_from_device->mutable_android_signals());
+  }
+}
+
+// Sets the fields of the Bidding Request that are copied either way.
+void SetRequestMetadata(const GetBidsRawRequest& get_bids_raw_request,
+                        const LogContext& log_context,
+                        GenerateBidsRawRequest* generate_bids_raw_request) {
+  // 5. Set Debug Reporting Flag
+  generate_bids_raw_request->set_enable_debug_reporting(
+      get_bids_raw_request.enable_debug_reporting());
+
+  generate_bids_raw_request->set_publisher_name(
+      get_bids_raw_request.publisher_name());
+  generate_bids_raw_request->set_seller(get_bids_raw_request.seller());
+
+  // 6. Set logging context.
+  if (!log_context.adtech_debug_id().empty()) {
+    generate_bids_raw_request->mutable_log_context()->set_adtech_debug_id(
+        log_context.adtech_debug_id());
+  }
+  if (!log_context.generation_id().empty()) {
+    generate_bids_raw_request->mutable_log_context()->set_generation_id(
+        log_context.generation_id());
+  }
+
+  // 7. Set consented debug config.
+  if (get_bids_raw_request.has_consented_debug_config()) {
+    *generate_bids_raw_request->mutable_consented_debug_config() =
+        get_bids_raw_request.consented_debug_config();
+  }
+}
+
 std::unique_ptr<GenerateBidsRawRequest>
 ProtoFactory::CreateGenerateBidsRawRequest(
     const GetBidsRawRequest& get_bids_raw_request,
     const BuyerInput& buyer_input,
     std::unique_ptr<BiddingSignals> bidding_signals,
     const LogContext& log_context) {
+  auto generate_bids_raw_request = CreateGenerateBidsRawRequest(
+      get_bids_raw_request, buyer_input, log_context);
+  AddBiddingSignals(buyer_input, std::move(bidding_signals),
+                    *generate_bids_raw_request);
+  return generate_bids_raw_request;
+}
+
+std::unique_ptr<GenerateBidsRawRequest>
+ProtoFactory::CreateGenerateBidsRawRequest(
+    const GetBidsRawRequest& get_bids_raw_request,
+    const BuyerInput& buyer_input, const LogContext& log_context) {
   auto generate_bids_raw_request = std::make_unique<GenerateBidsRawRequest>();
 
   // 1. Set Interest Group for bidding
@@ -93,13 +192,6 @@ ProtoFactory::CreateGenerateBidsRawRequest(
     // Copy from IG from device.
     CopyIGFromDeviceToIGForBidding(interest_group_from_device,
                                    mutable_interest_group_for_bidding);
-
-    // Copy User Bidding signals from Side Load or KV Server.
-    if (auto it = bidding_signals->ca_user_signals_map.find(
-            &interest_group_from_device);
-        it != bidding_signals->ca_user_signals_map.end()) {
-      mutable_interest_group_for_bidding->set_user_bidding_signals(it->second);
-    }
   }
 
   // 2. Set Auction Signals.
@@ -114,34 +206,159 @@ ProtoFactory::CreateGenerateBidsRawRequest(
     generate_bids_raw_request->set_buyer_signals("");
   }
 
-  // 4. Set Bidding Signals
-  generate_bids_raw_request->set_allocated_bidding_signals(
-      bidding_signals->trusted_signals.release());
+  // 4. Bidding Signals are set by AddBiddingSignals.
 
-  // 5. Set Debug Reporting Flag
-  generate_bids_raw_request->set_enable_debug_reporting(
-      get_bids_raw_request.enable_debug_reporting());
+  SetRequestMetadata(get_bids_raw_request, log_context,
+                     generate_bids_raw_request.get());
+  return generate_bids_raw_request;
+}
 
-  generate_bids_raw_request->set_publisher_name(
-      get_bids_raw_request.publisher_name());
-  generate_bids_raw_request->set_seller(get_bids_raw_request.seller());
+std::unique_ptr<GenerateBidsRawRequest>
+ProtoFactory::CreateGenerateBidsRawRequest(
+    GetBidsRawRequest* get_bids_raw_request, BuyerInput* buyer_input,
+    const LogContext& log_context) {
+  auto generate_bids_raw_request = std::make_unique<GenerateBidsRawRequest>();
 
-  // 6. Set logging context.
-  if (!log_context.adtech_debug_id().empty()) {
-    generate_bids_raw_request->mutable_log_context()->set_adtech_debug_id(
-        log_context.adtech_debug_id());
+  // 1. Move Interest Group for bidding
+  generate_bids_raw_request->mutable_interest_group_for_bidding()->Reserve(
+      buyer_input->interest_groups_size());
+  for (auto& interest_group_from_device :
+       *buyer_input->mutable_interest_groups()) {
+    // IG must have a name.
+    if (interest_group_from_device.name().empty()) {
+      continue;
+    }
+    MoveIGFromDeviceToIGForBidding(
+        &interest_group_from_device,
+        generate_bids_raw_request->mutable_interest_group_for_bidding()->Add());
   }
-  if (!log_context.generation_id().empty()) {
-    generate_bids_raw_request->mutable_log_context()->set_generation_id(
-        log_context.generation_id());
+
+  // 2. Move Auction Signals.
+  generate_bids_raw_request->set_auction_signals(
+      std::move(*get_bids_raw_request->mutable_auction_signals()));
+
+  // 3. Move Buyer Signals.
+  generate_bids_raw_request->set_buyer_signals(
+      std::move(*get_bids_raw_request->mutable_buyer_signals()));
+
+  // 4. Bidding Signals are set by AddBiddingSignals.
+
+  SetRequestMetadata(*get_bids_raw_request, log_context,
+                     generate_bids_raw_request.get());
+  return generate_bids_raw_request;
+}
+
+void ProtoFactory::AddBiddingSignals(
+    const BuyerInput& buyer_input,
+    std::unique_ptr<BiddingSignals> bidding_signals,
+    GenerateBidsRawRequest& generate_bids_raw_request) {
+  // Copy User Bidding signals from Side Load or KV Server. The Interest Groups
+  // for bidding are those of the device with a name, in the same order.
+  int ig_for_bidding_index = 0;
+  for (const auto& interest_group_from_device :
+       buyer_input.interest_groups()) {
+    if (interest_group_from_device.name().empty()) {
+      continue;
+    }
+    if (auto it = bidding_signals->ca_user_signals_map.find(
+            &interest_group_from_device);
+        it != bidding_signals->ca_user_signals_map.end()) {
+      generate_bids_raw_request
+          .mutable_interest_group_for_bidding(ig_for_bidding_index)
+          ->set_user_bidding_signals(it->second);
+    }
+    ++ig_for_bidding_index;
   }
 
-  // 7. Set consented debug config.
+  // Set Bidding Signals
+  generate_bids_raw_request.set_allocated_bidding_signals(
+      bidding_signals->trusted_signals.release());
+}
+
+std::unique_ptr<GenerateProtectedAppSignalsBidsRawRequest>
+ProtoFactory::CreateGenerateProtectedAppSignalsBidsRawRequest(
+    const GetBidsRawRequest& get_bids_raw_request) {
+  auto raw_request =
+      std::make_unique<GenerateProtectedAppSignalsBidsRawRequest>();
+  raw_request->set_auction_signals(get_bids_raw_request.auction_signals());
+  raw_request->set_buyer_signals(get_bids_raw_request.buyer_signals());
+  *raw_request->mutable_protected_app_signals() =
+      get_bids_raw_request.protected_app_signals_buyer_input()
+          .protected_app_signals();
+  raw_request->set_seller(get_bids_raw_request.seller());
+  raw_request->set_publisher_name(get_bids_raw_request.publisher_name());
+  if (get_bids_raw_request.has_log_context()) {
+    *raw_request->mutable_log_context() = get_bids_raw_request.log_context();
+  }
   if (get_bids_raw_request.has_consented_debug_config()) {
-    *generate_bids_raw_request->mutable_consented_debug_config() =
+    *raw_request->mutable_consented_debug_config() =
         get_bids_raw_request.consented_debug_config();
   }
-  return generate_bids_raw_request;
+  raw_request->set_enable_debug_reporting(
+      get_bids_raw_request.enable_debug_reporting());
+  return raw_request;
+}
+
+std::vector<std::unique_ptr<GenerateBidsRawRequest>>
+ProtoFactory::PartitionGenerateBidsRawRequest(
+    std::unique_ptr<GenerateBidsRawRequest> generate_bids_raw_request,
+    int num_partitions) {
+  const int num_igs =
+      generate_bids_raw_request->interest_group_for_bidding_size();
+  num_partitions = std::clamp(num_partitions, 1, std::max(num_igs, 1));
+  std::vector<std::unique_ptr<GenerateBidsRawRequest>> partitions;
+  partitions.reserve(num_partitions);
+  if (num_partitions == 1) {
+    partitions.push_back(std::move(generate_bids_raw_request));
+    return partitions;
+  }
+
+  // Take the Interest Groups and the bidding signals out, so that the other
+  // fields are copied to each partition without them.
+  google::protobuf::RepeatedPtrField<
+      GenerateBidsRawRequest::InterestGroupForBidding>
+      interest_groups;
+  interest_groups.Swap(
+      generate_bids_raw_request->mutable_interest_group_for_bidding());
+  std::string bidding_signals =
+      std::move(*generate_bids_raw_request->mutable_bidding_signals());
+  generate_bids_raw_request->clear_bidding_signals();
+  for (int i = 1; i < num_partitions; ++i) {
+    partitions.push_back(
+        std::make_unique<GenerateBidsRawRequest>(*generate_bids_raw_request));
+  }
+  partitions.insert(partitions.begin(), std::move(generate_bids_raw_request));
+
+  for (int i = 0; i < num_partitions; ++i) {
+    auto* partition_igs = partitions[i]->mutable_interest_group_for_bidding();
+    const int begin = num_igs * i / num_partitions;
+    const int end = num_igs * (i + 1) / num_partitions;
+    partition_igs->Reserve(end - begin);
+    for (int j = begin; j < end; ++j) {
+      partition_igs->Add()->Swap(interest_groups.Mutable(j));
+    }
+  }
+
+  // Each partition only gets the signals of the keys its Interest Groups ask
+  // for, which are all the bidding service reads.
+  if (bidding_signals.empty()) {
+    return partitions;
+  }
+  std::vector<absl::flat_hash_set<absl::string_view>> key_sets(num_partitions);
+  for (int i = 0; i < num_partitions; ++i) {
+    for (const auto& interest_group :
+         partitions[i]->interest_group_for_bidding()) {
+      key_sets[i].insert(interest_group.name());
+      key_sets[i].insert(interest_group.trusted_bidding_signals_keys().begin(),
+                         interest_group.trusted_bidding_signals_keys().end());
+    }
+  }
+  std::vector<std::string> projected_signals =
+      ProjectBiddingSignals(bidding_signals, key_sets);
+  for (int i = 0; i < num_partitions; ++i) {
+    partitions[i]->set_bidding_signals(std::move(projected_signals[i]));
+  }
+  return partitions;
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -35,6 +35,14 @@ class ProtoFactory {
       std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>
           raw_response);
 
+  // Creates GetBids Response with the bids of all the Bidding Responses, as
+  // for the partitions of a Bidding Request.
+  static std::unique_ptr<GetBidsResponse::GetBidsRawResponse>
+  CreateGetBidsRawResponse(
+      std::vector<
+          std::unique_ptr<GenerateBidsResponse::GenerateBidsRawResponse>>
+          raw_responses);
+
   // Creates Bidding Request from GetBidsRawRequest, Bidding Signals.
   // TODO(b/239242947): Set key id and cipher text instead of raw request.
   static std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
@@ -43,6 +51,47 @@ class ProtoFactory {
       const BuyerInput& buyer_input,
       std::unique_ptr<BiddingSignals> bidding_signals,
       const LogContext& log_context);
+
+  // Creates Bidding Request from GetBidsRawRequest without the Bidding
+  // Signals, so that it can be built while the signals are fetched.
+  static std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+  CreateGenerateBidsRawRequest(
+      const GetBidsRequest::GetBidsRawRequest& get_bid_raw_request,
+      const BuyerInput& buyer_input, const LogContext& log_context);
+
+  // Same as above, but moves the signals, ads and bidding signals keys out of
+  // the request and the buyer input rather than copying them. The names of
+  // the Interest Groups, the log context and the consented debug config are
+  // left in place, so that the buyer input can still be passed to
+  // AddBiddingSignals.
+  static std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+  CreateGenerateBidsRawRequest(
+      GetBidsRequest::GetBidsRawRequest* get_bid_raw_request,
+      BuyerInput* buyer_input, const LogContext& log_context);
+
+  // Adds the Bidding Signals to a Bidding Request created from the same
+  // buyer input without them.
+  static void AddBiddingSignals(
+      const BuyerInput& buyer_input,
+      std::unique_ptr<BiddingSignals> bidding_signals,
+      GenerateBidsRequest::GenerateBidsRawRequest& generate_bids_raw_request);
+
+  // Creates Protected App Signals Bidding Request from GetBidsRawRequest.
+  static std::unique_ptr<GenerateProtectedAppSignalsBidsRequest::
+                             GenerateProtectedAppSignalsBidsRawRequest>
+  CreateGenerateProtectedAppSignalsBidsRawRequest(
+      const GetBidsRequest::GetBidsRawRequest& get_bids_raw_request);
+
+  // Splits a Bidding Request into at most num_partitions requests, each with
+  // a consecutive range of about as many of the Interest Groups for bidding,
+  // the bidding signals of their keys, and a copy of the other fields. The
+  // first partition is the request itself.
+  static std::vector<
+      std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>>
+  PartitionGenerateBidsRawRequest(
+      std::unique_ptr<GenerateBidsRequest::GenerateBidsRawRequest>
+          generate_bids_raw_request,
+      int num_partitions);
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
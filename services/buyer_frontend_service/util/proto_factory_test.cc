@@ -14,6 +14,10 @@
 
 #include "services/buyer_frontend_service/util/proto_factory.h"
 
+#include <memory>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
 #include "google/protobuf/util/message_differencer.h"
@@ -432,5 +436,135 @@ TEST(CreateGenerateBidsRequestTest, SetsConsentedDebugConfig) {
   EXPECT_EQ(raw_output->consented_debug_config().token(), kConsentedDebugToken);
 }
 
+TEST(CreateGenerateBidsRequestTest, AddsBiddingSignalsToRequestBuiltWithout) {
+  GetBidsRequest::GetBidsRawRequest input;
+  auto* interest_groups =
+      input.mutable_buyer_input()->mutable_interest_groups();
+  // The unnamed IG is skipped, so that the user signals of the second IG of
+  // the device go to the first IG for bidding.
+  interest_groups->Add();
+  auto* named_ig = interest_groups->Add();
+  named_ig->set_name("ig");
+  named_ig->set_user_bidding_signals("device signals");
+  auto bidding_signals = std::make_unique<BiddingSignals>();
+  bidding_signals->trusted_signals = std::make_unique<std::string>("signals");
+  bidding_signals->ca_user_signals_map[named_ig] = "kv signals";
+
+  auto raw_output = ProtoFactory::CreateGenerateBidsRawRequest(
+      input, input.buyer_input(), LogContext{});
+  ASSERT_EQ(raw_output->interest_group_for_bidding_size(), 1);
+  EXPECT_EQ(raw_output->interest_group_for_bidding(0).user_bidding_signals(),
+            "device signals");
+  EXPECT_TRUE(raw_output->bidding_signals().empty());
+
+  ProtoFactory::AddBiddingSignals(input.buyer_input(),
+                                  std::move(bidding_signals), *raw_output);
+  EXPECT_EQ(raw_output->interest_group_for_bidding(0).user_bidding_signals(),
+            "kv signals");
+  EXPECT_EQ(raw_output->bidding_signals(), "signals");
+}
+
+TEST(CreateGenerateBidsRequestTest, MovesSameFieldsAsItCopies) {
+  GetBidsRequest::GetBidsRawRequest input;
+  input.set_auction_signals("auction signals");
+  input.set_buyer_signals("buyer signals");
+  input.set_seller("seller");
+  input.set_publisher_name("publisher");
+  input.set_enable_debug_reporting(true);
+  auto* interest_groups =
+      input.mutable_buyer_input()->mutable_interest_groups();
+  interest_groups->Add();
+  auto* browser_ig = interest_groups->Add();
+  browser_ig->set_name("browser ig");
+  browser_ig->set_user_bidding_signals("user signals");
+  browser_ig->add_ad_render_ids("ad");
+  browser_ig->add_component_ads("component ad");
+  browser_ig->add_bidding_signals_keys("key");
+  browser_ig->mutable_browser_signals()->set_join_count(1);
+  auto* android_ig = interest_groups->Add();
+  android_ig->set_name("android ig");
+  android_ig->mutable_android_signals();
+  LogContext log_context;
+  log_context.set_generation_id(kSampleGenerationId);
+
+  auto copied_output = ProtoFactory::CreateGenerateBidsRawRequest(
+      input, input.buyer_input(), log_context);
+  auto moved_output = ProtoFactory::CreateGenerateBidsRawRequest(
+      &input, input.mutable_buyer_input(), log_context);
+
+  std::string difference;
+  MessageDifferencer differencer;
+  differencer.ReportDifferencesToString(&difference);
+  EXPECT_TRUE(differencer.Compare(*copied_output, *moved_output))
+      << difference;
+  // The names are left for AddBiddingSignals.
+  ASSERT_EQ(input.buyer_input().interest_groups_size(), 3);
+  EXPECT_EQ(input.buyer_input().interest_groups(1).name(), "browser ig");
+  EXPECT_EQ(input.buyer_input().interest_groups(2).name(), "android ig");
+  EXPECT_TRUE(input.buyer_input().interest_groups(1).ad_render_ids().empty());
+  EXPECT_TRUE(input.auction_signals().empty());
+}
+
+TEST(PartitionGenerateBidsRequestTest, SplitsInterestGroupsEvenly) {
+  auto raw_request = std::make_unique<GenBidsRawReq>();
+  for (int i = 0; i < 5; ++i) {
+    raw_request->add_interest_group_for_bidding()->set_name(
+        absl::StrCat("ig", i));
+  }
+  raw_request->set_bidding_signals("signals");
+
+  auto partitions =
+      ProtoFactory::PartitionGenerateBidsRawRequest(std::move(raw_request), 2);
+  ASSERT_EQ(partitions.size(), 2);
+  ASSERT_EQ(partitions[0]->interest_group_for_bidding_size(), 2);
+  ASSERT_EQ(partitions[1]->interest_group_for_bidding_size(), 3);
+  EXPECT_EQ(partitions[0]->interest_group_for_bidding(0).name(), "ig0");
+  EXPECT_EQ(partitions[1]->interest_group_for_bidding(0).name(), "ig2");
+  EXPECT_EQ(partitions[0]->bidding_signals(), "signals");
+  EXPECT_EQ(partitions[1]->bidding_signals(), "signals");
+}
+
+TEST(PartitionGenerateBidsRequestTest, ProjectsBiddingSignalsPerPartition) {
+  auto raw_request = std::make_unique<GenBidsRawReq>();
+  raw_request->add_interest_group_for_bidding()->set_name("ig0");
+  auto* ig1 = raw_request->add_interest_group_for_bidding();
+  ig1->set_name("ig1");
+  ig1->add_trusted_bidding_signals_keys("key");
+  raw_request->set_bidding_signals(
+      R"JSON({"keys":{"ig0":0,"ig1":1,"key":2}})JSON");
+
+  auto partitions =
+      ProtoFactory::PartitionGenerateBidsRawRequest(std::move(raw_request), 2);
+  ASSERT_EQ(partitions.size(), 2);
+  EXPECT_EQ(partitions[0]->bidding_signals(), R"JSON({"keys":{"ig0":0}})JSON");
+  EXPECT_EQ(partitions[1]->bidding_signals(),
+            R"JSON({"keys":{"ig1":1,"key":2}})JSON");
+}
+
+TEST(PartitionGenerateBidsRequestTest, SplitsIntoNoMorePartitionsThanIGs) {
+  auto raw_request = std::make_unique<GenBidsRawReq>();
+  raw_request->add_interest_group_for_bidding()->set_name("ig");
+
+  auto partitions =
+      ProtoFactory::PartitionGenerateBidsRawRequest(std::move(raw_request), 4);
+  ASSERT_EQ(partitions.size(), 1);
+  EXPECT_EQ(partitions[0]->interest_group_for_bidding_size(), 1);
+}
+
+TEST(CreateGetBidsRawResponseTest, SetsBidsOfAllGenerateBidsResponses) {
+  std::vector<std::unique_ptr<GenBidsRawResp>> raw_responses;
+  for (int i = 0; i < 2; ++i) {
+    auto raw_response = std::make_unique<GenBidsRawResp>();
+    raw_response->add_bids()->set_interest_group_name(absl::StrCat("ig", i));
+    raw_responses.push_back(std::move(raw_response));
+  }
+
+  auto get_bids_raw_response =
+      ProtoFactory::CreateGetBidsRawResponse(std::move(raw_responses));
+  ASSERT_EQ(get_bids_raw_response->bids_size(), 2);
+  EXPECT_EQ(get_bids_raw_response->bids(0).interest_group_name(), "ig0");
+  EXPECT_EQ(get_bids_raw_response->bids(1).interest_group_name(), "ig1");
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -17,6 +17,7 @@
 
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/functional/any_invocable.h"
@@ -25,6 +26,9 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+class CancellationToken;
+class CryptoMetrics;
+
 // This provides access to the Metadata Object type
 using RequestMetadata = absl::flat_hash_map<std::string, std::string>;
 
@@ -59,6 +63,54 @@ class AsyncClient {
       absl::Duration timeout) const {
     return absl::NotFoundError("Method not implemented.");
   }
+
+  // Same as the above, but adds the encryption of the request and the
+  // decryption of the response to crypto_metrics, if not null, which must
+  // outlive the call.
+  virtual absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics) const {
+    return ExecuteInternal(std::move(request), metadata, std::move(on_done),
+                           timeout);
+  }
+
+  // Same as the above, but cancels the call when cancellation, if not null,
+  // is. It must outlive the call.
+  virtual absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const {
+    return ExecuteInternal(std::move(request), metadata, std::move(on_done),
+                           timeout, crypto_metrics);
+  }
+
+  // Same as the above, but calls the server-streaming variant of the RPC,
+  // calling on_chunk with each part of the response as it arrives, one at a
+  // time, and then on_done with the status of the call. Clients of RPCs
+  // without such a variant call on_chunk once with the whole response.
+  virtual absl::Status ExecuteStreamingInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(std::unique_ptr<RawResponse>)> on_chunk,
+      absl::AnyInvocable<void(absl::Status) &&> on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const {
+    return ExecuteInternal(
+        std::move(request), metadata,
+        [on_chunk = std::move(on_chunk), on_done = std::move(on_done)](
+            absl::StatusOr<std::unique_ptr<RawResponse>> response) mutable {
+          if (!response.ok()) {
+            std::move(on_done)(std::move(response).status());
+            return;
+          }
+          on_chunk(*std::move(response));
+          std::move(on_done)(absl::OkStatus());
+        },
+        timeout, crypto_metrics, cancellation);
+  }
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
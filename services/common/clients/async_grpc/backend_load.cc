@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/clients/async_grpc/backend_load.h"
+
+#include <string>
+
+#include "absl/random/random.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/string_view.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+void AddBackendLoadHint(grpc::ServerContextBase& context, int64_t load) {
+  context.AddInitialMetadata(kBackendLoadMetadataKey, std::to_string(load));
+}
+
+std::optional<int64_t> ParseBackendLoadHint(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& metadata) {
+  auto it = metadata.find(kBackendLoadMetadataKey);
+  if (it == metadata.end()) {
+    return std::nullopt;
+  }
+  int64_t load;
+  if (!absl::SimpleAtoi(absl::string_view(it->second.data(), it->second.size()),
+                        &load) ||
+      load < 0) {
+    return std::nullopt;
+  }
+  return load;
+}
+
+LeastLoadedPicker::LeastLoadedPicker(int num_backends)
+    : num_backends_(num_backends),
+      backends_(std::make_unique<Backend[]>(num_backends)) {
+  DCHECK_GT(num_backends_, 0);
+}
+
+int LeastLoadedPicker::StartCall(absl::Time now) {
+  int picked = 0;
+  if (num_backends_ > 1) {
+    thread_local absl::BitGen bitgen;
+    // Draws two distinct backends.
+    int first = absl::Uniform(bitgen, 0, num_backends_);
+    int second = absl::Uniform(bitgen, 0, num_backends_ - 1);
+    if (second >= first) {
+      ++second;
+    }
+    picked = Load(second, now) < Load(first, now) ? second : first;
+  }
+  backends_[picked].outstanding_calls.fetch_add(1, std::memory_order_relaxed);
+  return picked;
+}
+
+void LeastLoadedPicker::EndCall(int backend, std::optional<int64_t> load_hint,
+                                absl::Time now) {
+  Backend& ended = backends_[backend];
+  ended.outstanding_calls.fetch_sub(1, std::memory_order_relaxed);
+  if (load_hint.has_value()) {
+    ended.load_hint.store(*load_hint, std::memory_order_relaxed);
+    ended.load_hint_time_us.store(absl::ToUnixMicros(now),
+                                  std::memory_order_relaxed);
+  }
+}
+
+double LeastLoadedPicker::Load(int backend, absl::Time now) const {
+  const Backend& loaded = backends_[backend];
+  int64_t load_hint = 0;
+  if (now - absl::FromUnixMicros(loaded.load_hint_time_us.load(
+                std::memory_order_relaxed)) <=
+      kLoadHintTtl) {
+    load_hint = loaded.load_hint.load(std::memory_order_relaxed);
+  }
+  return static_cast<double>(
+             1 + loaded.outstanding_calls.load(std::memory_order_relaxed)) *
+         (1 + load_hint);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_ASYNC_GRPC_BACKEND_LOAD_H_
+#define SERVICES_COMMON_CLIENTS_ASYNC_GRPC_BACKEND_LOAD_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/grpcpp.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Key of the response metadata in which a server reports its load to the
+// client, as the number of its requests waiting for or running on Roma.
+inline constexpr char kBackendLoadMetadataKey[] = "x-bna-backend-load";
+
+// Adds the load of the server to the initial metadata of the response of
+// `context`.
+void AddBackendLoadHint(grpc::ServerContextBase& context, int64_t load);
+
+// Returns the load reported in the initial metadata of a response, if any.
+std::optional<int64_t> ParseBackendLoadHint(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& metadata);
+
+// Picks the backend to send a call to as the less loaded of two drawn at
+// random, which spreads the calls about as well as picking the least loaded
+// of all of them without every client herding onto the same one. The load of
+// a backend is the calls this client has outstanding on it, weighted by the
+// load it last reported.
+// Thread safe.
+class LeastLoadedPicker {
+ public:
+  // Load hints older than this are ignored, so that a backend which reported
+  // a high load is tried again even if no call went to it since.
+  static constexpr absl::Duration kLoadHintTtl = absl::Seconds(1);
+
+  // num_backends must be positive.
+  explicit LeastLoadedPicker(int num_backends);
+
+  // Not copyable or movable.
+  LeastLoadedPicker(const LeastLoadedPicker&) = delete;
+  LeastLoadedPicker& operator=(const LeastLoadedPicker&) = delete;
+
+  // Returns the backend to send the next call to and counts the call as
+  // outstanding on it until EndCall.
+  int StartCall(absl::Time now = absl::Now());
+
+  // Records that a call started on backend ended, with the load the backend
+  // reported in its response, if any.
+  void EndCall(int backend, std::optional<int64_t> load_hint,
+               absl::Time now = absl::Now());
+
+  // Returns the load of backend that calls are balanced by.
+  double Load(int backend, absl::Time now = absl::Now()) const;
+
+ private:
+  struct Backend {
+    std::atomic<int64_t> outstanding_calls = 0;
+    std::atomic<int64_t> load_hint = 0;
+    // Time of the last load hint, in microseconds since the Unix epoch.
+    std::atomic<int64_t> load_hint_time_us = 0;
+  };
+
+  const int num_backends_;
+  std::unique_ptr<Backend[]> backends_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_ASYNC_GRPC_BACKEND_LOAD_H_
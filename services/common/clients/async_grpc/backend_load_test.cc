@@ -0,0 +1,72 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/async_grpc/backend_load.h"
+
+#include <map>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ParseBackendLoadHintTest, ParsesReportedLoad) {
+  std::multimap<grpc::string_ref, grpc::string_ref> metadata;
+  EXPECT_EQ(ParseBackendLoadHint(metadata), std::nullopt);
+  metadata.emplace(kBackendLoadMetadataKey, "12");
+  EXPECT_EQ(ParseBackendLoadHint(metadata), 12);
+}
+
+TEST(ParseBackendLoadHintTest, IgnoresMalformedLoad) {
+  std::multimap<grpc::string_ref, grpc::string_ref> metadata;
+  metadata.emplace(kBackendLoadMetadataKey, "busy");
+  EXPECT_EQ(ParseBackendLoadHint(metadata), std::nullopt);
+}
+
+TEST(LeastLoadedPickerTest, PicksBackendWithFewerOutstandingCalls) {
+  LeastLoadedPicker picker(2);
+  absl::Time now = absl::Now();
+  int first = picker.StartCall(now);
+  EXPECT_EQ(picker.StartCall(now), 1 - first);
+  picker.EndCall(first, std::nullopt, now);
+  EXPECT_EQ(picker.StartCall(now), first);
+}
+
+TEST(LeastLoadedPickerTest, WeightsCallsByReportedLoad) {
+  LeastLoadedPicker picker(2);
+  absl::Time now = absl::Now();
+  // The second call goes to the backend the first did not.
+  picker.StartCall(now);
+  picker.StartCall(now);
+  picker.EndCall(0, /*load_hint=*/20, now);
+  picker.EndCall(1, /*load_hint=*/2, now);
+  EXPECT_DOUBLE_EQ(picker.Load(0, now), 21);
+  EXPECT_DOUBLE_EQ(picker.Load(1, now), 3);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(picker.StartCall(now), 1);
+  }
+}
+
+TEST(LeastLoadedPickerTest, IgnoresStaleLoadHints) {
+  LeastLoadedPicker picker(2);
+  absl::Time now = absl::Now();
+  picker.StartCall(now);
+  picker.StartCall(now);
+  picker.EndCall(0, /*load_hint=*/20, now);
+  EXPECT_DOUBLE_EQ(picker.Load(0, now + LeastLoadedPicker::kLoadHintTtl * 2),
+                   1);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
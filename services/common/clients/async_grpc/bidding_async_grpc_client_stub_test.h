@@ -151,11 +151,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, CallsServerWithRequest) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   absl::Notification notification;
 
   class_under_test.ExecuteInternal(
@@ -207,11 +208,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, CallsServerWithMetadata) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   absl::Notification notification;
   class_under_test.ExecuteInternal(
       std::make_unique<RawRequest>(), sent_metadata,
@@ -258,11 +260,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, PassesStatusToCallback) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   absl::Notification notification;
 
   class_under_test.ExecuteInternal(
@@ -318,11 +321,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, CallsServerWithTimeout) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   class_under_test.ExecuteInternal(
       std::move(input_request_ptr), {},
       [&notification](
@@ -366,11 +370,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, PassesResponseToCallback) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   absl::Notification notification;
   std::unique_ptr<Response> output;
 
@@ -415,11 +420,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, DoesNotExecuteCallbackOnSyncError) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientError(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   absl::Notification notification;
   std::unique_ptr<Response> output;
 
@@ -465,11 +471,12 @@ TYPED_TEST_P(AsyncGrpcClientStubTest, ExecutesCallbackOnTimeout) {
   MockCryptoClientWrapper crypto_client;
   SetupMockCryptoClientWrapper(raw_request, crypto_client);
   auto key_fetcher_manager = CreateKeyFetcherManager(this->config_client_);
-  auto stub = ServiceType::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
+  StubPool<typename ServiceType::Stub> stubs(
+      ServiceType::NewStub(CreateChannel(client_config.server_addr,
+                                         client_config.compression,
+                                         client_config.secure_client)));
   TestClient class_under_test(key_fetcher_manager.get(), &crypto_client,
-                              client_config, stub.get());
+                              client_config, &stubs);
   absl::Notification notification;
   std::unique_ptr<Response> output;
 
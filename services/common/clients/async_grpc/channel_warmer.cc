@@ -0,0 +1,151 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/clients/async_grpc/channel_warmer.h"
+
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kHealthCheckMethod[] = "/grpc.health.v1.Health/Check";
+// Deadline of the state watches, after which the state is checked again, so
+// that channels backing off after a failure retry at least this often.
+constexpr absl::Duration kWatchInterval = absl::Seconds(1);
+constexpr absl::Duration kHealthCheckTimeout = absl::Seconds(1);
+
+}  // namespace
+
+ChannelWarmer::ChannelWarmer(absl::Duration max_warm_up_time)
+    : warm_up_deadline_(absl::Now() + max_warm_up_time) {
+  thread_ = std::thread([this]() { Run(); });
+}
+
+ChannelWarmer::~ChannelWarmer() {
+  {
+    absl::MutexLock lock(&mu_);
+    shutting_down_ = true;
+    for (auto& watched : channels_) {
+      if (watched->check_context != nullptr) {
+        watched->check_context->TryCancel();
+      }
+    }
+    // No watch or check starts once shutting down, so the queue drains.
+    cq_.Shutdown();
+  }
+  thread_.join();
+}
+
+void ChannelWarmer::Add(std::shared_ptr<grpc::Channel> channel) {
+  absl::MutexLock lock(&mu_);
+  if (shutting_down_) {
+    return;
+  }
+  auto& watched =
+      *channels_.emplace_back(std::make_unique<WatchedChannel>(channel));
+  watched.state = watched.channel->GetState(/*try_to_connect=*/true);
+  if (watched.state == GRPC_CHANNEL_READY) {
+    StartHealthCheck(watched);
+  }
+  WatchState(watched);
+}
+
+bool ChannelWarmer::IsWarm() const {
+  if (absl::Now() >= warm_up_deadline_) {
+    return true;
+  }
+  absl::MutexLock lock(&mu_);
+  return num_warm_ == static_cast<int>(channels_.size());
+}
+
+void ChannelWarmer::Run() {
+  void* tag;
+  bool ok;
+  while (cq_.Next(&tag, &ok)) {
+    const Event& event = *static_cast<Event*>(tag);
+    absl::MutexLock lock(&mu_);
+    if (event.kind == Event::kStateChange) {
+      OnStateChange(*event.channel);
+    } else {
+      OnHealthChecked(*event.channel);
+    }
+  }
+}
+
+void ChannelWarmer::OnStateChange(WatchedChannel& watched) {
+  if (shutting_down_) {
+    return;
+  }
+  const grpc_connectivity_state state =
+      watched.channel->GetState(/*try_to_connect=*/false);
+  if (state != watched.state) {
+    VLOG(2) << "Channel state changed from " << watched.state << " to "
+            << state;
+  }
+  watched.state = state;
+  if (state == GRPC_CHANNEL_IDLE || state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    // Reconnects, such as after a GOAWAY, before the next call needs to.
+    watched.channel->GetState(/*try_to_connect=*/true);
+  } else if (state == GRPC_CHANNEL_READY && !watched.warm &&
+             watched.check_call == nullptr) {
+    StartHealthCheck(watched);
+  }
+  WatchState(watched);
+}
+
+void ChannelWarmer::OnHealthChecked(WatchedChannel& watched) {
+  const grpc::StatusCode code = watched.check_status.error_code();
+  // Any answer of the server, even that it has no health service, shows the
+  // connection carries calls.
+  if (code != grpc::StatusCode::UNAVAILABLE &&
+      code != grpc::StatusCode::DEADLINE_EXCEEDED &&
+      code != grpc::StatusCode::CANCELLED && !watched.warm) {
+    watched.warm = true;
+    ++num_warm_;
+  } else if (!watched.warm) {
+    VLOG(2) << "Health check of the channel failed: "
+            << watched.check_status.error_message();
+  }
+  // Retried on the next state change or watch deadline if it failed.
+  watched.check_call.reset();
+  watched.check_context.reset();
+  watched.check_response.Clear();
+}
+
+void ChannelWarmer::WatchState(WatchedChannel& watched) {
+  watched.channel->NotifyOnStateChange(
+      watched.state, absl::ToChronoTime(absl::Now() + kWatchInterval), &cq_,
+      &watched.state_event);
+}
+
+void ChannelWarmer::StartHealthCheck(WatchedChannel& watched) {
+  watched.check_context = std::make_unique<grpc::ClientContext>();
+  watched.check_context->set_deadline(
+      absl::ToChronoTime(absl::Now() + kHealthCheckTimeout));
+  // An empty HealthCheckRequest asks for the health of the whole server.
+  grpc::Slice empty_request;
+  grpc::ByteBuffer request(&empty_request, /*nslices=*/1);
+  watched.check_call = watched.stub.PrepareUnaryCall(
+      watched.check_context.get(), kHealthCheckMethod, request, &cq_);
+  watched.check_call->StartCall();
+  watched.check_call->Finish(&watched.check_response, &watched.check_status,
+                             &watched.check_event);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
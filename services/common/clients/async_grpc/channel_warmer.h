@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_ASYNC_GRPC_CHANNEL_WARMER_H_
+#define SERVICES_COMMON_CLIENTS_ASYNC_GRPC_CHANNEL_WARMER_H_
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "grpcpp/generic/generic_stub.h"
+#include "grpcpp/grpcpp.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Connects the channels to the downstream servers ahead of their first calls
+// and keeps them connected, so that no request pays for the name resolution,
+// the TCP and TLS handshakes and the HTTP/2 settings exchange. Once a channel
+// is connected, a call to the standard health service of its server
+// (/grpc.health.v1.Health/Check) checks that the connection carries calls.
+// Channels that go idle, such as after their server sent a GOAWAY, or whose
+// connection failed are asked to reconnect right away rather than on their
+// next call. Thread safe.
+class ChannelWarmer {
+ public:
+  // max_warm_up_time: time after which IsWarm returns true even if some
+  // channels are not warm yet, so that a backend down does not keep the
+  // server from serving.
+  explicit ChannelWarmer(absl::Duration max_warm_up_time);
+
+  // Not copyable or movable, as the watches in flight point to it.
+  ChannelWarmer(const ChannelWarmer&) = delete;
+  ChannelWarmer& operator=(const ChannelWarmer&) = delete;
+
+  // Cancels the health checks in flight and waits for the state watches to
+  // end, up to a second.
+  ~ChannelWarmer();
+
+  // Starts connecting the channel and watching its state.
+  void Add(std::shared_ptr<grpc::Channel> channel) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns whether every channel added passed its health check, or the
+  // max warm-up time passed since the warmer was made. Meant to gate the
+  // readiness of the server.
+  bool IsWarm() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct WatchedChannel;
+
+  // Completion queue tag of an event of a channel.
+  struct Event {
+    enum Kind { kStateChange, kHealthChecked };
+    WatchedChannel* channel;
+    Kind kind;
+  };
+
+  struct WatchedChannel {
+    explicit WatchedChannel(std::shared_ptr<grpc::Channel> channel)
+        : channel(channel), stub(std::move(channel)) {}
+
+    std::shared_ptr<grpc::Channel> channel;
+    grpc::GenericStub stub;
+    grpc_connectivity_state state = GRPC_CHANNEL_IDLE;
+    bool warm = false;
+    // Health check in flight, if any.
+    std::unique_ptr<grpc::ClientContext> check_context;
+    std::unique_ptr<grpc::GenericClientAsyncResponseReader> check_call;
+    grpc::ByteBuffer check_response;
+    grpc::Status check_status;
+    Event state_event{this, Event::kStateChange};
+    Event check_event{this, Event::kHealthChecked};
+  };
+
+  // Handles the events of the completion queue until it is shut down.
+  void Run();
+  void OnStateChange(WatchedChannel& watched)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void OnHealthChecked(WatchedChannel& watched)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void WatchState(WatchedChannel& watched) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void StartHealthCheck(WatchedChannel& watched)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const absl::Time warm_up_deadline_;
+  grpc::CompletionQueue cq_;
+  mutable absl::Mutex mu_;
+  std::vector<std::unique_ptr<WatchedChannel>> channels_ ABSL_GUARDED_BY(mu_);
+  bool shutting_down_ ABSL_GUARDED_BY(mu_) = false;
+  int num_warm_ ABSL_GUARDED_BY(mu_) = 0;
+  std::thread thread_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_ASYNC_GRPC_CHANNEL_WARMER_H_
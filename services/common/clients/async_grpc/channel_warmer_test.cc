@@ -0,0 +1,95 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/clients/async_grpc/channel_warmer.h"
+
+#include <memory>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "grpcpp/generic/async_generic_service.h"
+#include "grpcpp/health_check_service_interface.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Waits up to timeout for the warmer to be warm.
+bool WaitUntilWarm(const ChannelWarmer& warmer, absl::Duration timeout) {
+  const absl::Time deadline = absl::Now() + timeout;
+  while (!warmer.IsWarm()) {
+    if (absl::Now() >= deadline) {
+      return false;
+    }
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  return true;
+}
+
+// Starts a server with the default health service and no other, on a port
+// of its own. service must outlive the server.
+std::unique_ptr<grpc::Server> StartLocalServer(
+    grpc::CallbackGenericService* service, int* port) {
+  grpc::EnableDefaultHealthCheckService(true);
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort("127.0.0.1:0", grpc::InsecureServerCredentials(),
+                           port);
+  // Answers the health checks, as the server has no service of its own.
+  builder.RegisterCallbackGenericService(service);
+  return builder.BuildAndStart();
+}
+
+std::shared_ptr<grpc::Channel> CreateLocalChannel(int port) {
+  return grpc::CreateChannel(absl::StrCat("127.0.0.1:", port),
+                             grpc::InsecureChannelCredentials());
+}
+
+TEST(ChannelWarmerTest, IsWarmOnceTheChannelsPassedTheirHealthCheck) {
+  grpc::CallbackGenericService service;
+  int port = 0;
+  std::unique_ptr<grpc::Server> server = StartLocalServer(&service, &port);
+  ASSERT_NE(server, nullptr);
+
+  ChannelWarmer warmer(absl::Minutes(1));
+  std::shared_ptr<grpc::Channel> channel = CreateLocalChannel(port);
+  warmer.Add(channel);
+  EXPECT_TRUE(WaitUntilWarm(warmer, absl::Seconds(10)));
+  EXPECT_EQ(channel->GetState(/*try_to_connect=*/false), GRPC_CHANNEL_READY);
+  server->Shutdown();
+}
+
+TEST(ChannelWarmerTest, IsWarmOnceTheMaxWarmUpTimePassed) {
+  // Nothing listens on the port of a server shut down.
+  grpc::CallbackGenericService service;
+  int port = 0;
+  std::unique_ptr<grpc::Server> server = StartLocalServer(&service, &port);
+  ASSERT_NE(server, nullptr);
+  server->Shutdown();
+  server.reset();
+
+  ChannelWarmer warmer(absl::Milliseconds(200));
+  warmer.Add(CreateLocalChannel(port));
+  EXPECT_FALSE(warmer.IsWarm());
+  EXPECT_TRUE(WaitUntilWarm(warmer, absl::Seconds(10)));
+}
+
+TEST(ChannelWarmerTest, IsWarmWithoutChannels) {
+  ChannelWarmer warmer(absl::Minutes(1));
+  EXPECT_TRUE(warmer.IsWarm());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
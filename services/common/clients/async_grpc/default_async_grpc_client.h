@@ -16,15 +16,22 @@
 #define SERVICES_COMMON_CLIENTS_ASYNC_GRPC_DEFAULT_ASYNC_GRPC_CLIENT_H_
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "glog/logging.h"
 #include "services/common/clients/async_client.h"
+#include "services/common/clients/async_grpc/backend_load.h"
+#include "services/common/clients/async_grpc/channel_warmer.h"
 #include "services/common/clients/async_grpc/grpc_client_utils.h"
+#include "services/common/clients/async_grpc/message_compression.h"
 #include "services/common/clients/client_params.h"
+#include "services/common/encryption/crypto_metrics.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "services/common/util/cancellation_token.h"
 #include "services/common/util/error_categories.h"
 #include "services/common/util/status_macros.h"
 #include "src/cpp/encryption/key_fetcher/src/key_fetcher_manager.h"
@@ -42,13 +49,21 @@ template <typename Request, typename Response, typename RawRequest,
 class DefaultAsyncGrpcClient
     : public AsyncClient<Request, Response, RawRequest, RawResponse> {
  public:
+  // message_compression: how the requests are compressed, which the
+  // channels of the client must announce.
+  // hop: the server called, which the compression of the requests is
+  // recorded under.
   DefaultAsyncGrpcClient(
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
-      CryptoClientWrapperInterface* crypto_client, bool encryption_enabled)
+      CryptoClientWrapperInterface* crypto_client, bool encryption_enabled,
+      MessageCompressionConfig message_compression = {},
+      absl::string_view hop = "")
       : AsyncClient<Request, Response, RawRequest, RawResponse>(),
         key_fetcher_manager_(key_fetcher_manager),
         crypto_client_(crypto_client),
-        encryption_enabled_(encryption_enabled) {}
+        encryption_enabled_(encryption_enabled),
+        message_compression_(message_compression),
+        hop_(hop) {}
 
   DefaultAsyncGrpcClient(const DefaultAsyncGrpcClient&) = delete;
   DefaultAsyncGrpcClient& operator=(const DefaultAsyncGrpcClient&) = delete;
@@ -58,24 +73,46 @@ class DefaultAsyncGrpcClient
       absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
           on_done,
       absl::Duration timeout = max_timeout) const override {
+    return ExecuteInternal(std::move(raw_request), metadata, std::move(on_done),
+                           timeout, /*crypto_metrics=*/nullptr);
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> raw_request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics) const override {
+    return ExecuteInternal(std::move(raw_request), metadata, std::move(on_done),
+                           timeout, crypto_metrics, /*cancellation=*/nullptr);
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> raw_request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const override {
     DCHECK(encryption_enabled_);
-    if (VLOG_IS_ON(6)) {
-      VLOG(6) << "Raw request:\n" << raw_request->DebugString();
+    if (cancellation != nullptr && cancellation->IsCancelled()) {
+      RecordCancelledWork(CancelledWork::kRpc);
+      return absl::CancelledError("The request was cancelled");
     }
-    VLOG(5) << "Encrypting request ...";
-    auto secret_request = EncryptRequestWithHpke<RawRequest, Request>(
-        std::move(raw_request), *crypto_client_, *key_fetcher_manager_);
-    if (!secret_request.ok()) {
-      VLOG(1) << "Failed to encrypt the request: " << secret_request.status();
-      auto error_status = absl::InternalError(kEncryptionFailed);
-      return error_status;
-    }
-    auto& [hpke_secret, request] = *secret_request;
-    VLOG(5) << "Encryption completed ...";
+    grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_NONE;
+    PS_ASSIGN_OR_RETURN(
+        SecretRequest secret_request,
+        EncryptRequest(std::move(raw_request), crypto_metrics,
+                       compression_algorithm));
+    auto& [hpke_secret, request] = secret_request;
 
     auto params =
         std::make_unique<RawClientParams<Request, Response, RawResponse>>(
             std::move(request), std::move(on_done), metadata);
+    if (message_compression_.algorithm != GRPC_COMPRESS_NONE) {
+      // Overrides the default algorithm of the channel for this request.
+      params->ContextRef()->set_compression_algorithm(compression_algorithm);
+    }
+    params->SetCryptoMetrics(crypto_metrics);
+    params->SetCancellation(cancellation);
     params->SetDeadline(std::min(max_timeout, timeout));
     VLOG(5) << "Sending RPC ...";
     SendRpc(hpke_secret, params.release());
@@ -85,6 +122,40 @@ class DefaultAsyncGrpcClient
  protected:
   using SecretRequest = std::pair<std::string, std::unique_ptr<Request>>;
 
+  // Encrypts the raw request, adding the encryption to crypto_metrics if not
+  // null, and sets compression_algorithm to the one the encrypted request is
+  // to be sent with when compression is enabled. Returns the HPKE secret the
+  // response is decrypted with along with the encrypted request.
+  absl::StatusOr<SecretRequest> EncryptRequest(
+      std::unique_ptr<RawRequest> raw_request, CryptoMetrics* crypto_metrics,
+      grpc_compression_algorithm& compression_algorithm) const {
+    if (VLOG_IS_ON(6)) {
+      VLOG(6) << "Raw request:\n" << raw_request->DebugString();
+    }
+    VLOG(5) << "Encrypting request ...";
+    const absl::Time encrypt_start = absl::Now();
+    auto secret_request = EncryptRequestWithHpke<RawRequest, Request>(
+        std::move(raw_request), *crypto_client_, *key_fetcher_manager_);
+    if (!secret_request.ok()) {
+      VLOG(1) << "Failed to encrypt the request: " << secret_request.status();
+      auto error_status = absl::InternalError(kEncryptionFailed);
+      return error_status;
+    }
+    const std::unique_ptr<Request>& request = secret_request->second;
+    if (crypto_metrics != nullptr) {
+      crypto_metrics->Add(CryptoOperation::kHpkeEncrypt,
+                          absl::Now() - encrypt_start,
+                          request->request_ciphertext().size());
+    }
+    VLOG(5) << "Encryption completed ...";
+    if (message_compression_.algorithm != GRPC_COMPRESS_NONE) {
+      compression_algorithm = ChooseMessageCompression(
+          message_compression_, request->ByteSizeLong());
+      RecordMessageCompression(hop_, *request, compression_algorithm);
+    }
+    return secret_request;
+  }
+
   // Sends an asynchronous request via grpc. This method must be implemented
   // by classes implementing this interface.
   //
@@ -98,21 +169,30 @@ class DefaultAsyncGrpcClient
     VLOG(5) << "Stub SendRpc invoked ...";
   }
 
+  // crypto_metrics: the metrics the decryption is added to, if not null.
   absl::StatusOr<std::unique_ptr<RawResponse>> DecryptResponse(
-      const std::string& hpke_secret, Response* response) const {
+      const std::string& hpke_secret, Response* response,
+      CryptoMetrics* crypto_metrics) const {
     VLOG(6) << "Decrypting the response ...";
-    absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse>
-        decrypt_response = crypto_client_->AeadDecrypt(
-            response->response_ciphertext(), hpke_secret);
-    if (!decrypt_response.ok()) {
-      const std::string error = absl::StrCat(
-          "Could not decrypt response: ", decrypt_response.status().message());
+    const absl::Time decrypt_start = absl::Now();
+    const int64_t ciphertext_size = response->response_ciphertext().size();
+    // The response is parsed straight from the decrypted ciphertext field.
+    absl::StatusOr<absl::string_view> payload =
+        crypto_client_->AeadDecryptInPlace(
+            *response->mutable_response_ciphertext(), hpke_secret);
+    if (!payload.ok()) {
+      const std::string error = absl::StrCat("Could not decrypt response: ",
+                                             payload.status().message());
       LOG(ERROR) << error;
       return absl::InternalError(error);
     }
+    if (crypto_metrics != nullptr) {
+      crypto_metrics->Add(CryptoOperation::kAeadDecrypt,
+                          absl::Now() - decrypt_start, ciphertext_size);
+    }
 
     std::unique_ptr<RawResponse> raw_response = std::make_unique<RawResponse>();
-    if (!raw_response->ParseFromString(decrypt_response->payload())) {
+    if (!raw_response->ParseFromArray(payload->data(), payload->size())) {
       const std::string error_msg =
           "Failed to parse proto from decrypted response";
       return absl::InvalidArgumentError(error_msg);
@@ -130,6 +210,9 @@ class DefaultAsyncGrpcClient
 
   // Whether HPKE encryption is enabled for intra-server communication.
   bool encryption_enabled_;
+
+  const MessageCompressionConfig message_compression_;
+  const std::string hop_;
 };
 
 // Creates a shared grpc channel from a given server URL. This channel
@@ -138,25 +221,130 @@ class DefaultAsyncGrpcClient
 // server_addr: the URL or IP for the server DNS
 // compression: flag to enable gRPC level compression for the client.
 // Disabled by default.
+// compression_algorithm: the default algorithm of the messages of the
+// channel when compression is enabled, which the calls may override.
+// flow_control_window_bytes: the initial HTTP/2 flow-control window of the
+// streams, which the connection window is sized from, or 0 for the gRPC
+// default.
+// own_connection: whether the channel connects on its own rather than
+// sharing the connections of the other channels to the same server.
 inline std::shared_ptr<grpc::Channel> CreateChannel(
     // Const string reference to prevent copies. string_view cannot be casted
     // to argument for grpc::CreateChannel.
     absl::string_view server_addr, bool compression = false,
-    bool secure = true) {
-  std::shared_ptr<grpc::Channel> channel;
+    bool secure = true, int flow_control_window_bytes = 0,
+    bool own_connection = false,
+    grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_GZIP) {
   std::shared_ptr<grpc::ChannelCredentials> creds =
       secure ? grpc::SslCredentials(grpc::SslCredentialsOptions())
              : grpc::InsecureChannelCredentials();
+  grpc::ChannelArguments args;
   if (compression) {
-    grpc::ChannelArguments args;
     // Set the default compression algorithm for the channel.
-    args.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
-    channel =
-        grpc::CreateCustomChannel(server_addr.data(), std::move(creds), args);
-  } else {
-    channel = grpc::CreateChannel(server_addr.data(), std::move(creds));
+    args.SetCompressionAlgorithm(compression_algorithm);
+  }
+  if (flow_control_window_bytes > 0) {
+    args.SetInt(GRPC_ARG_HTTP2_STREAM_LOOKAHEAD_BYTES,
+                flow_control_window_bytes);
+  }
+  if (own_connection) {
+    args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  }
+  return grpc::CreateCustomChannel(server_addr.data(), std::move(creds), args);
+}
+
+// Creates num_channels channels to the server, at least one, each with a
+// connection of its own so that the calls spread across the connections
+// handed out by a StubPool rather than being bound by the stream limit and
+// framing of a single one. If warmer is set, the channels connect right away
+// and are kept connected by it.
+inline std::vector<std::shared_ptr<grpc::Channel>> CreateChannels(
+    absl::string_view server_addr, bool compression, bool secure,
+    int num_channels, int flow_control_window_bytes = 0,
+    grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_GZIP,
+    ChannelWarmer* warmer = nullptr) {
+  num_channels = std::max(num_channels, 1);
+  std::vector<std::shared_ptr<grpc::Channel>> channels;
+  channels.reserve(num_channels);
+  for (int i = 0; i < num_channels; ++i) {
+    channels.push_back(CreateChannel(server_addr, compression, secure,
+                                     flow_control_window_bytes,
+                                     /*own_connection=*/num_channels > 1,
+                                     compression_algorithm));
+    if (warmer != nullptr) {
+      warmer->Add(channels.back());
+    }
+  }
+  return channels;
+}
+
+// Owns the stubs of a service, one per channel of a pool, and hands them out
+// in turn, or to the least loaded backend when least_loaded is set.
+template <typename Stub>
+class StubPool {
+ public:
+  // stubs must not be empty. As each channel has a connection of its own,
+  // least_loaded balances the calls across the backends the connections
+  // landed on.
+  explicit StubPool(std::vector<std::unique_ptr<Stub>> stubs,
+                    bool least_loaded = false)
+      : stubs_(std::move(stubs)) {
+    DCHECK(!stubs_.empty());
+    if (least_loaded && stubs_.size() > 1) {
+      picker_ = std::make_unique<LeastLoadedPicker>(stubs_.size());
+    }
+  }
+
+  explicit StubPool(std::unique_ptr<Stub> stub) {
+    stubs_.push_back(std::move(stub));
+  }
+
+  // Returns the stub to make the next call on, round robin.
+  Stub* Next() const {
+    return stubs_[next_.fetch_add(1, std::memory_order_relaxed) %
+                  stubs_.size()]
+        .get();
+  }
+
+  // Returns the index of the stub to make the next call on. Calls started
+  // this way must be ended with EndCall.
+  int StartCall() const {
+    if (picker_ == nullptr) {
+      return next_.fetch_add(1, std::memory_order_relaxed) % stubs_.size();
+    }
+    return picker_->StartCall();
+  }
+
+  Stub* Get(int index) const { return stubs_[index].get(); }
+
+  // Records that a call started on the stub at index is done, along with the
+  // load the backend reported in the response metadata of `context`.
+  void EndCall(int index, const grpc::ClientContext& context) const {
+    if (picker_ != nullptr) {
+      picker_->EndCall(
+          index, ParseBackendLoadHint(context.GetServerInitialMetadata()));
+    }
+  }
+
+  int size() const { return stubs_.size(); }
+
+ private:
+  std::vector<std::unique_ptr<Stub>> stubs_;
+  mutable std::atomic<size_t> next_ = 0;
+  // Set when the calls go to the least loaded backend.
+  std::unique_ptr<LeastLoadedPicker> picker_;
+};
+
+// Creates a stub of the service on each of the channels.
+template <typename Service, typename Stub = typename Service::Stub>
+std::vector<std::unique_ptr<Stub>> CreateStubs(
+    const std::vector<std::shared_ptr<grpc::Channel>>& channels) {
+  std::vector<std::unique_ptr<Stub>> stubs;
+  stubs.reserve(channels.size());
+  for (const auto& channel : channels) {
+    stubs.push_back(Service::NewStub(channel));
   }
-  return channel;
+  return stubs;
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
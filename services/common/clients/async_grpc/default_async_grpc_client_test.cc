@@ -14,10 +14,15 @@
 
 #include "services/common/clients/async_grpc/default_async_grpc_client.h"
 
+#include <string>
+#include <vector>
+
 #include "absl/synchronization/notification.h"
+#include "api/bidding_auction_servers.pb.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/common/constants/common_service_flags.h"
+#include "services/common/encryption/crypto_metrics.h"
 #include "services/common/encryption/key_fetcher_factory.h"
 #include "services/common/encryption/mock_crypto_client_wrapper.h"
 #include "services/common/test/random.h"
@@ -72,40 +77,11 @@ void SetupMockCryptoClientWrapper(MockCryptoClientWrapper& crypto_client) {
           });
 }
 
-// The structs below have some definitions to mimic protos.
-// default_async_grpc_client expects these fields to exist on the template types
-// provided during instantiation.
-struct MockRawRequest {
-  std::string value;
-  std::string SerializeAsString() { return value; }
-  std::string DebugString() { return value; }
-};
-
-struct MockRequest {
-  std::string request_ciphertext() const { return request_ciphertext_; }
-  void set_request_ciphertext(absl::string_view cipher) {
-    request_ciphertext_ = cipher;
-  }
-  void set_key_id(absl::string_view key_id) {}
-
- private:
-  std::string request_ciphertext_;
-};
-
-struct MockRawResponse {
-  void ParseFromString(absl::string_view) {}
-};
-
-class MockResponse {
- public:
-  int value;
-  MockRawResponse raw_response;
-  std::string ciphertext;
-
-  MockRawResponse* mutable_raw_response() { return &raw_response; }
-  void clear_response_ciphertext() {}
-  std::string& response_ciphertext() { return ciphertext; }
-};
+// The client is instantiated with the messages of the GenerateBids hop.
+using MockRequest = GenerateBidsRequest;
+using MockResponse = GenerateBidsResponse;
+using MockRawRequest = GenerateBidsRequest::GenerateBidsRawRequest;
+using MockRawResponse = GenerateBidsResponse::GenerateBidsRawResponse;
 
 class TestDefaultAsyncGrpcClient
     : public DefaultAsyncGrpcClient<MockRequest, MockResponse, MockRawRequest,
@@ -150,7 +126,7 @@ TEST(TestDefaultAsyncGrpcClient, SendsMessageWithCorrectParams) {
   MockRequest req;
   RequestMetadata metadata = MakeARandomMap();
   MockRawRequest raw_request;
-  raw_request.value = "test";
+  raw_request.set_seller("test");
   req.set_request_ciphertext(raw_request.SerializeAsString());
 
   absl::Duration timeout_ms = absl::Milliseconds(100);
@@ -170,5 +146,135 @@ TEST(TestDefaultAsyncGrpcClient, SendsMessageWithCorrectParams) {
       timeout_ms);
   notification.WaitForNotification();
 }
+
+TEST(TestDefaultAsyncGrpcClient, AddsTheEncryptionToTheCryptoMetrics) {
+  absl::Notification notification;
+  MockRequest req;
+  MockRawRequest raw_request;
+  raw_request.set_seller("test");
+  req.set_request_ciphertext(raw_request.SerializeAsString());
+
+  absl::Duration timeout_ms = absl::Milliseconds(100);
+  auto crypto_client = std::make_unique<MockCryptoClientWrapper>();
+  SetupMockCryptoClientWrapper(*crypto_client);
+  TrustedServersConfigClient config_client({});
+  config_client.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
+  config_client.SetFlagForTest(kTrue, TEST_MODE);
+  auto key_fetcher_manager = CreateKeyFetcherManager(config_client);
+  TestDefaultAsyncGrpcClient client(key_fetcher_manager.get(),
+                                    crypto_client.get(), true, notification,
+                                    req, timeout_ms);
+
+  CryptoMetrics crypto_metrics;
+  ASSERT_TRUE(client
+                  .ExecuteInternal(
+                      std::make_unique<MockRawRequest>(raw_request), {},
+                      [](absl::StatusOr<std::unique_ptr<MockRawResponse>>
+                             result) {},
+                      timeout_ms, &crypto_metrics)
+                  .ok());
+  notification.WaitForNotification();
+
+  CryptoMetrics::Totals encrypt =
+      crypto_metrics.Get(CryptoOperation::kHpkeEncrypt);
+  EXPECT_EQ(encrypt.count, 1);
+  EXPECT_EQ(encrypt.size_bytes, req.request_ciphertext().size());
+}
+
+// Records the compression algorithm of the requests it sends.
+class CompressionRecordingClient
+    : public DefaultAsyncGrpcClient<MockRequest, MockResponse, MockRawRequest,
+                                    MockRawResponse> {
+ public:
+  CompressionRecordingClient(
+      server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+      CryptoClientWrapperInterface* crypto_client,
+      MessageCompressionConfig message_compression)
+      : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client,
+                               /*encryption_enabled=*/true, message_compression,
+                               "test") {}
+
+  void SendRpc(const std::string& hpke_secret,
+               RawClientParams<MockRequest, MockResponse, MockRawResponse>*
+                   params) const override {
+    algorithms_.push_back(params->ContextRef()->compression_algorithm());
+    params->OnDone(grpc::Status::OK);
+  }
+
+  mutable std::vector<grpc_compression_algorithm> algorithms_;
+};
+
+TEST(TestDefaultAsyncGrpcClient, CompressesOnlyLargeRequests) {
+  auto crypto_client = std::make_unique<MockCryptoClientWrapper>();
+  EXPECT_CALL(*crypto_client, HpkeEncrypt)
+      .WillRepeatedly(
+          [](const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+             const std::string& plaintext_payload) {
+            google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse
+                hpke_encrypt_response;
+            hpke_encrypt_response.set_secret(kSecret);
+            hpke_encrypt_response.mutable_encrypted_data()->set_key_id(kKeyId);
+            hpke_encrypt_response.mutable_encrypted_data()->set_ciphertext(
+                plaintext_payload);
+            return hpke_encrypt_response;
+          });
+  TrustedServersConfigClient config_client({});
+  config_client.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
+  config_client.SetFlagForTest(kTrue, TEST_MODE);
+  auto key_fetcher_manager = CreateKeyFetcherManager(config_client);
+  CompressionRecordingClient client(
+      key_fetcher_manager.get(), crypto_client.get(),
+      {.algorithm = GRPC_COMPRESS_GZIP, .min_message_bytes = 1024});
+
+  MockRawRequest small_request;
+  small_request.set_seller("test");
+  MockRawRequest large_request;
+  large_request.set_seller(std::string(2048, 'a'));
+  for (const MockRawRequest& raw_request : {small_request, large_request}) {
+    ASSERT_TRUE(
+        client
+            .ExecuteInternal(
+                std::make_unique<MockRawRequest>(raw_request), {},
+                [](absl::StatusOr<std::unique_ptr<MockRawResponse>> result) {},
+                absl::Milliseconds(100))
+            .ok());
+  }
+  EXPECT_THAT(client.algorithms_,
+              testing::ElementsAre(GRPC_COMPRESS_NONE, GRPC_COMPRESS_GZIP));
+}
+
+TEST(CreateChannelsTest, CreatesAChannelPerConnection) {
+  std::vector<std::shared_ptr<grpc::Channel>> channels =
+      CreateChannels("localhost:0", /*compression=*/true, /*secure=*/false,
+                     /*num_channels=*/3, /*flow_control_window_bytes=*/1 << 20);
+  ASSERT_EQ(channels.size(), 3);
+  EXPECT_NE(channels[0], channels[1]);
+  EXPECT_NE(channels[1], channels[2]);
+  EXPECT_EQ(CreateChannels("localhost:0", false, false, 0).size(), 1);
+}
+
+TEST(StubPoolTest, HandsOutStubsInTurn) {
+  std::vector<std::unique_ptr<int>> stubs;
+  for (int i = 0; i < 3; ++i) {
+    stubs.push_back(std::make_unique<int>(i));
+  }
+  StubPool<int> pool(std::move(stubs));
+  ASSERT_EQ(pool.size(), 3);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_EQ(*pool.Next(), i % 3);
+  }
+}
+
+TEST(StubPoolTest, StartsCallsOnLeastLoadedStub) {
+  std::vector<std::unique_ptr<int>> stubs;
+  for (int i = 0; i < 2; ++i) {
+    stubs.push_back(std::make_unique<int>(i));
+  }
+  StubPool<int> pool(std::move(stubs), /*least_loaded=*/true);
+  int first = pool.StartCall();
+  int second = pool.StartCall();
+  EXPECT_NE(first, second);
+  EXPECT_EQ(*pool.Get(second), second);
+}
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -43,21 +43,20 @@ EncryptRequestWithHpke(
     return absl::InternalError(error);
   }
 
-  auto encrypt_response =
-      crypto_client.HpkeEncrypt(key.value(), raw_request->SerializeAsString());
+  // The raw request is serialized straight into the ciphertext field.
+  std::unique_ptr<Request> request = std::make_unique<Request>();
+  absl::StatusOr<std::string> secret = crypto_client.HpkeEncryptMessage(
+      key.value(), *raw_request, *request->mutable_request_ciphertext());
 
-  if (!encrypt_response.ok()) {
+  if (!secret.ok()) {
     const std::string error = absl::StrCat("Failed encrypting request: ",
-                                           encrypt_response.status().message());
+                                           secret.status().message());
     LOG(ERROR) << error;
     return absl::InternalError(error);
   }
 
-  std::unique_ptr<Request> request = std::make_unique<Request>();
   request->set_key_id(key->key_id());
-  request->set_request_ciphertext(
-      std::move(encrypt_response->encrypted_data().ciphertext()));
-  return std::pair{std::move(encrypt_response->secret()), std::move(request)};
+  return std::pair{*std::move(secret), std::move(request)};
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,137 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/clients/async_grpc/message_compression.h"
+
+#include <utility>
+
+#include "absl/base/const_init.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "services/common/compression/gzip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+struct HopCompressionStats {
+  int64_t compressed = 0;
+  int64_t uncompressed = 0;
+  // Time before which no compressed message is sampled.
+  absl::Time next_sample = absl::InfinitePast();
+  int64_t samples = 0;
+  int64_t sampled_bytes = 0;
+  int64_t sampled_compressed_bytes = 0;
+  absl::Duration sampled_duration;
+};
+
+ABSL_CONST_INIT absl::Mutex stats_mu(absl::kConstInit);
+
+absl::flat_hash_map<std::string, HopCompressionStats>& StatsByHop()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(stats_mu) {
+  static auto* stats_by_hop =
+      new absl::flat_hash_map<std::string, HopCompressionStats>();
+  return *stats_by_hop;
+}
+
+}  // namespace
+
+absl::StatusOr<grpc_compression_algorithm> ParseCompressionAlgorithm(
+    absl::string_view name) {
+  if (name == "identity") {
+    return GRPC_COMPRESS_NONE;
+  }
+  if (name == "deflate") {
+    return GRPC_COMPRESS_DEFLATE;
+  }
+  if (name == "gzip") {
+    return GRPC_COMPRESS_GZIP;
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown gRPC compression algorithm: ", name));
+}
+
+grpc_compression_algorithm ChooseMessageCompression(
+    const MessageCompressionConfig& config, int64_t message_bytes) {
+  if (message_bytes < config.min_message_bytes) {
+    return GRPC_COMPRESS_NONE;
+  }
+  return config.algorithm;
+}
+
+void RecordMessageCompression(absl::string_view hop,
+                              const google::protobuf::MessageLite& message,
+                              grpc_compression_algorithm algorithm) {
+  bool sampled = false;
+  const absl::Time now = absl::Now();
+  {
+    absl::MutexLock lock(&stats_mu);
+    HopCompressionStats& stats = StatsByHop()[hop];
+    if (algorithm == GRPC_COMPRESS_NONE) {
+      ++stats.uncompressed;
+      return;
+    }
+    ++stats.compressed;
+    if (now >= stats.next_sample) {
+      stats.next_sample = now + kMessageCompressionSampleInterval;
+      sampled = true;
+    }
+  }
+  if (!sampled) {
+    return;
+  }
+  // gRPC deflates and gzips with zlib alike, so gzip measures either.
+  const std::string serialized = message.SerializeAsString();
+  const absl::Time start = absl::Now();
+  absl::StatusOr<std::string> compressed = GzipCompress(serialized);
+  const absl::Duration duration = absl::Now() - start;
+  if (!compressed.ok()) {
+    return;
+  }
+  absl::MutexLock lock(&stats_mu);
+  HopCompressionStats& stats = StatsByHop()[hop];
+  ++stats.samples;
+  stats.sampled_bytes += serialized.size();
+  stats.sampled_compressed_bytes += compressed->size();
+  stats.sampled_duration += duration;
+}
+
+absl::flat_hash_map<std::string, double> GetMessageCompressionStats() {
+  absl::flat_hash_map<std::string, double> values;
+  absl::MutexLock lock(&stats_mu);
+  for (auto& [hop, stats] : StatsByHop()) {
+    values[absl::StrCat(hop, " compressed")] =
+        std::exchange(stats.compressed, 0);
+    values[absl::StrCat(hop, " uncompressed")] =
+        std::exchange(stats.uncompressed, 0);
+    if (stats.samples > 0 && stats.sampled_bytes > 0) {
+      values[absl::StrCat(hop, " ratio")] =
+          static_cast<double>(stats.sampled_compressed_bytes) /
+          stats.sampled_bytes;
+      values[absl::StrCat(hop, " compress_us")] =
+          absl::ToDoubleMicroseconds(stats.sampled_duration) / stats.samples;
+    }
+    stats.samples = 0;
+    stats.sampled_bytes = 0;
+    stats.sampled_compressed_bytes = 0;
+    stats.sampled_duration = absl::ZeroDuration();
+  }
+  return values;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_ASYNC_GRPC_MESSAGE_COMPRESSION_H_
+#define SERVICES_COMMON_CLIENTS_ASYNC_GRPC_MESSAGE_COMPRESSION_H_
+
+#include <cstdint>
+#include <string>
+
+#include <grpc/compression.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "google/protobuf/message_lite.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// At most one message compressed on a hop per this interval is also
+// compressed apart, to measure the compression ratio and CPU time of the hop.
+// Sampling by time rather than by count bounds the extra compression on the
+// send path however many requests a hop sends.
+inline constexpr absl::Duration kMessageCompressionSampleInterval =
+    absl::Seconds(10);
+
+// How the requests of a client are compressed, decided per request.
+struct MessageCompressionConfig {
+  // Algorithm the channels of the client announce and compress requests
+  // with, or GRPC_COMPRESS_NONE to send every request uncompressed.
+  grpc_compression_algorithm algorithm = GRPC_COMPRESS_NONE;
+  // Requests serialized to fewer bytes are sent uncompressed, since
+  // compressing them costs more CPU than the bytes saved are worth.
+  int64_t min_message_bytes = 0;
+};
+
+// Returns the compression of the requests of a client by its config, which
+// has the compression, compression_algorithm and
+// compression_min_message_bytes fields.
+template <typename ClientConfig>
+MessageCompressionConfig GetMessageCompressionConfig(
+    const ClientConfig& client_config) {
+  return {.algorithm = client_config.compression
+                           ? client_config.compression_algorithm
+                           : GRPC_COMPRESS_NONE,
+          .min_message_bytes = client_config.compression_min_message_bytes};
+}
+
+// Parses a gRPC message compression algorithm name: "identity", "deflate"
+// or "gzip".
+absl::StatusOr<grpc_compression_algorithm> ParseCompressionAlgorithm(
+    absl::string_view name);
+
+// Returns the algorithm to send a message of the given size with.
+grpc_compression_algorithm ChooseMessageCompression(
+    const MessageCompressionConfig& config, int64_t message_bytes);
+
+// Counts a message sent on a hop with the given algorithm. A compressed
+// message is also compressed apart to measure the compression ratio and CPU
+// time if none was in the last kMessageCompressionSampleInterval. Thread
+// safe.
+void RecordMessageCompression(absl::string_view hop,
+                              const google::protobuf::MessageLite& message,
+                              grpc_compression_algorithm algorithm);
+
+// Returns, by hop, the messages sent compressed and uncompressed, and the
+// compression ratio and mean CPU time of the messages sampled, since the
+// previous call.
+absl::flat_hash_map<std::string, double> GetMessageCompressionStats();
+
+template <typename T>
+inline void AddMessageCompressionMetric(T* context_map) {
+  context_map->AddObserverable(metric::kGrpcMessageCompression,
+                               GetMessageCompressionStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_ASYNC_GRPC_MESSAGE_COMPRESSION_H_
@@ -0,0 +1,98 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/async_grpc/message_compression.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "google/protobuf/wrappers.pb.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Key;
+using ::testing::Lt;
+using ::testing::Not;
+using ::testing::Pair;
+
+TEST(MessageCompressionTest, ParsesAlgorithmNames) {
+  EXPECT_EQ(*ParseCompressionAlgorithm("identity"), GRPC_COMPRESS_NONE);
+  EXPECT_EQ(*ParseCompressionAlgorithm("deflate"), GRPC_COMPRESS_DEFLATE);
+  EXPECT_EQ(*ParseCompressionAlgorithm("gzip"), GRPC_COMPRESS_GZIP);
+  EXPECT_FALSE(ParseCompressionAlgorithm("brotli").ok());
+}
+
+TEST(MessageCompressionTest, SendsSmallMessagesUncompressed) {
+  const MessageCompressionConfig config = {.algorithm = GRPC_COMPRESS_GZIP,
+                                           .min_message_bytes = 1024};
+  EXPECT_EQ(ChooseMessageCompression(config, 1023), GRPC_COMPRESS_NONE);
+  EXPECT_EQ(ChooseMessageCompression(config, 1024), GRPC_COMPRESS_GZIP);
+  EXPECT_EQ(ChooseMessageCompression({}, 1 << 20), GRPC_COMPRESS_NONE);
+}
+
+TEST(MessageCompressionTest, GetsConfigOfClient) {
+  struct {
+    bool compression = false;
+    grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_DEFLATE;
+    int64_t compression_min_message_bytes = 512;
+  } client_config;
+  EXPECT_EQ(GetMessageCompressionConfig(client_config).algorithm,
+            GRPC_COMPRESS_NONE);
+  client_config.compression = true;
+  const MessageCompressionConfig config =
+      GetMessageCompressionConfig(client_config);
+  EXPECT_EQ(config.algorithm, GRPC_COMPRESS_DEFLATE);
+  EXPECT_EQ(config.min_message_bytes, 512);
+}
+
+TEST(MessageCompressionTest, RecordsMessagesAndSampledRatio) {
+  google::protobuf::StringValue request;
+  request.set_value(std::string(4096, 'a'));
+  RecordMessageCompression("test_hop", request, GRPC_COMPRESS_GZIP);
+  RecordMessageCompression("test_hop", request, GRPC_COMPRESS_GZIP);
+  RecordMessageCompression("test_hop", request, GRPC_COMPRESS_NONE);
+
+  absl::flat_hash_map<std::string, double> stats =
+      GetMessageCompressionStats();
+  EXPECT_THAT(stats, Contains(Pair("test_hop compressed", 2)));
+  EXPECT_THAT(stats, Contains(Pair("test_hop uncompressed", 1)));
+  // The first message compressed is sampled.
+  EXPECT_THAT(stats, Contains(Pair("test_hop ratio", Lt(0.1))));
+  EXPECT_THAT(stats, Contains(Key("test_hop compress_us")));
+
+  stats = GetMessageCompressionStats();
+  EXPECT_THAT(stats, Contains(Pair("test_hop compressed", 0)));
+  EXPECT_THAT(stats, Not(Contains(Key("test_hop ratio"))));
+}
+
+TEST(MessageCompressionTest, SamplesAHopOncePerInterval) {
+  google::protobuf::StringValue request;
+  request.set_value(std::string(4096, 'a'));
+  RecordMessageCompression("interval_hop", request, GRPC_COMPRESS_GZIP);
+  EXPECT_THAT(GetMessageCompressionStats(),
+              Contains(Key("interval_hop ratio")));
+
+  // Within kMessageCompressionSampleInterval of the sample above.
+  RecordMessageCompression("interval_hop", request, GRPC_COMPRESS_GZIP);
+  absl::flat_hash_map<std::string, double> stats =
+      GetMessageCompressionStats();
+  EXPECT_THAT(stats, Contains(Pair("interval_hop compressed", 1)));
+  EXPECT_THAT(stats, Not(Contains(Key("interval_hop ratio"))));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -17,31 +17,45 @@
 #include "absl/status/statusor.h"
 #include "cc/public/cpio/interface/crypto_client/crypto_client_interface.h"
 #include "glog/logging.h"
+#include "services/common/clients/async_grpc/message_compression.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
 
+namespace {
+
+constexpr char kAuctionHop[] = "auction";
+
+}  // namespace
+
 ScoringAsyncGrpcClient::ScoringAsyncGrpcClient(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
     AuctionServiceClientConfig client_config)
     : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client,
-                             client_config.encryption_enabled) {
-  stub_ = Auction::NewStub(CreateChannel(client_config.server_addr,
-                                         client_config.compression,
-                                         client_config.secure_client));
-}
+                             client_config.encryption_enabled,
+                             GetMessageCompressionConfig(client_config),
+                             kAuctionHop),
+      stubs_(CreateStubs<Auction>(CreateChannels(
+                 client_config.server_addr, client_config.compression,
+                 client_config.secure_client, client_config.num_channels,
+                 client_config.flow_control_window_bytes,
+                 client_config.compression_algorithm,
+                 client_config.channel_warmer)),
+             client_config.least_loaded_routing) {}
 
 void ScoringAsyncGrpcClient::SendRpc(
     const std::string& hpke_secret,
     RawClientParams<ScoreAdsRequest, ScoreAdsResponse,
                     ScoreAdsResponse::ScoreAdsRawResponse>* params) const {
   VLOG(5) << "ScoringAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->ScoreAds(
+  const int stub_index = stubs_.StartCall();
+  stubs_.Get(stub_index)->async()->ScoreAds(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](grpc::Status status) {
+      [this, params, hpke_secret, stub_index](grpc::Status status) {
         DCHECK(encryption_enabled_);
+        stubs_.EndCall(stub_index, *params->ContextRef());
         if (!status.ok()) {
           VLOG(1) << "SendRPC completion status not ok: "
                   << ToAbslStatus(status);
@@ -51,7 +65,8 @@ void ScoringAsyncGrpcClient::SendRpc(
 
         VLOG(6) << "SendRPC completion status ok";
         auto decrypted_response =
-            DecryptResponse(hpke_secret, params->ResponseRef());
+            DecryptResponse(hpke_secret, params->ResponseRef(),
+                            params->crypto_metrics());
         if (!decrypted_response.ok()) {
           VLOG(1) << "ScoringAsyncGrpcClient Failed to decrypt response";
           params->OnDone(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
@@ -38,6 +38,21 @@ struct AuctionServiceClientConfig {
   bool compression = false;
   bool secure_client = true;
   bool encryption_enabled = false;
+  // Channels, each with a connection of its own, to spread the calls across.
+  int num_channels = 1;
+  // Initial HTTP/2 flow-control window in bytes, or 0 for the gRPC default.
+  int flow_control_window_bytes = 0;
+  // Algorithm of the requests compressed when compression is enabled.
+  grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_GZIP;
+  // Requests smaller than this are sent uncompressed even when compression
+  // is enabled.
+  int64_t compression_min_message_bytes = 0;
+  // Connects the channels ahead of their first calls, if set. Must outlive
+  // the client.
+  ChannelWarmer* channel_warmer = nullptr;
+  // Whether the calls go to the less loaded of two of the channels drawn at
+  // random rather than round robin.
+  bool least_loaded_routing = false;
 };
 
 // This class is an async grpc client for the Fledge Auction (Scoring) Service.
@@ -61,7 +76,7 @@ class ScoringAsyncGrpcClient
                                ScoreAdsResponse::ScoreAdsRawResponse>* params)
       const override;
 
-  std::unique_ptr<Auction::Stub> stub_;
+  StubPool<Auction::Stub> stubs_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
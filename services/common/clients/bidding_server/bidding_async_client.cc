@@ -16,6 +16,7 @@
 
 #include "cc/public/cpio/interface/crypto_client/crypto_client_interface.h"
 #include "glog/logging.h"
+#include "services/common/clients/async_grpc/message_compression.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -26,6 +27,8 @@ using GenerateProtectedAppSignalsBidsRawResponse =
 
 namespace {
 
+constexpr char kBiddingHop[] = "bidding";
+
 template <typename Request, typename Response, typename RawResponse>
 void OnRpcDone(
     const grpc::Status& status,
@@ -56,10 +59,13 @@ void OnRpcDone(
 BiddingAsyncGrpcClient::BiddingAsyncGrpcClient(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
-    const BiddingServiceClientConfig& client_config, Bidding::Stub* stub)
+    const BiddingServiceClientConfig& client_config,
+    const StubPool<Bidding::Stub>* stubs)
     : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client,
-                             client_config.encryption_enabled),
-      stub_(stub) {}
+                             client_config.encryption_enabled,
+                             GetMessageCompressionConfig(client_config),
+                             kBiddingHop),
+      stubs_(stubs) {}
 
 void BiddingAsyncGrpcClient::SendRpc(
     const std::string& hpke_secret,
@@ -67,15 +73,18 @@ void BiddingAsyncGrpcClient::SendRpc(
                     GenerateBidsResponse::GenerateBidsRawResponse>* params)
     const {
   VLOG(5) << "BiddingAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->GenerateBids(
+  const int stub_index = stubs_->StartCall();
+  stubs_->Get(stub_index)->async()->GenerateBids(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](grpc::Status status) {
+      [this, params, hpke_secret, stub_index](grpc::Status status) {
         DCHECK(encryption_enabled_);
+        stubs_->EndCall(stub_index, *params->ContextRef());
         OnRpcDone<GenerateBidsRequest, GenerateBidsResponse,
                   GenerateBidsResponse::GenerateBidsRawResponse>(
             status, params,
-            [this, &hpke_secret](GenerateBidsResponse* response) {
-              return DecryptResponse(hpke_secret, response);
+            [this, params, &hpke_secret](GenerateBidsResponse* response) {
+              return DecryptResponse(hpke_secret, response,
+                                     params->crypto_metrics());
             });
       });
 }
@@ -84,10 +93,13 @@ ProtectedAppSignalsBiddingAsyncGrpcClient::
     ProtectedAppSignalsBiddingAsyncGrpcClient(
         server_common::KeyFetcherManagerInterface* key_fetcher_manager,
         CryptoClientWrapperInterface* crypto_client,
-        const BiddingServiceClientConfig& client_config, Bidding::Stub* stub)
+        const BiddingServiceClientConfig& client_config,
+        const StubPool<Bidding::Stub>* stubs)
     : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client,
-                             client_config.encryption_enabled),
-      stub_(stub) {}
+                             client_config.encryption_enabled,
+                             GetMessageCompressionConfig(client_config),
+                             kBiddingHop),
+      stubs_(stubs) {}
 
 void ProtectedAppSignalsBiddingAsyncGrpcClient::SendRpc(
     const std::string& hpke_secret,
@@ -95,17 +107,20 @@ void ProtectedAppSignalsBiddingAsyncGrpcClient::SendRpc(
                     GenerateProtectedAppSignalsBidsResponse,
                     GenerateProtectedAppSignalsBidsRawResponse>* params) const {
   VLOG(5) << "ProtectedAppSignalsBiddingAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->GenerateProtectedAppSignalsBids(
+  const int stub_index = stubs_->StartCall();
+  stubs_->Get(stub_index)->async()->GenerateProtectedAppSignalsBids(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
-      [this, params, hpke_secret](grpc::Status status) {
+      [this, params, hpke_secret, stub_index](grpc::Status status) {
         DCHECK(encryption_enabled_);
+        stubs_->EndCall(stub_index, *params->ContextRef());
         OnRpcDone<GenerateProtectedAppSignalsBidsRequest,
                   GenerateProtectedAppSignalsBidsResponse,
                   GenerateProtectedAppSignalsBidsRawResponse>(
             status, params,
-            [this,
+            [this, params,
              &hpke_secret](GenerateProtectedAppSignalsBidsResponse* response) {
-              return DecryptResponse(hpke_secret, response);
+              return DecryptResponse(hpke_secret, response,
+                                     params->crypto_metrics());
             });
       });
 }
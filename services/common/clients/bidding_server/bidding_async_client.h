@@ -46,6 +46,25 @@ struct BiddingServiceClientConfig {
   bool compression = false;
   bool secure_client = true;
   bool encryption_enabled = false;
+  // Channels, each with a connection of its own, to spread the calls across.
+  int num_channels = 1;
+  // Initial HTTP/2 flow-control window in bytes, or 0 for the gRPC default.
+  int flow_control_window_bytes = 0;
+  // Algorithm of the requests compressed when compression is enabled.
+  grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_GZIP;
+  // Requests smaller than this are sent uncompressed even when compression
+  // is enabled.
+  int64_t compression_min_message_bytes = 0;
+  // Connects the channels ahead of their first calls, if set. Must outlive
+  // the client.
+  ChannelWarmer* channel_warmer = nullptr;
+  // Whether the calls go to the less loaded of two of the channels drawn at
+  // random rather than round robin.
+  bool least_loaded_routing = false;
+  // Bidding service, such as a canary, that shadow_traffic_percent of the
+  // GenerateBids calls are mirrored to. Disabled if empty.
+  std::string shadow_server_addr;
+  int shadow_traffic_percent = 0;
 };
 
 // This class is an async grpc client for the Fledge Bidding Service.
@@ -58,7 +77,8 @@ class BiddingAsyncGrpcClient
   BiddingAsyncGrpcClient(
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      const BiddingServiceClientConfig& client_config, Bidding::Stub* stub);
+      const BiddingServiceClientConfig& client_config,
+      const StubPool<Bidding::Stub>* stubs);
 
  protected:
   // Sends an asynchronous request via grpc to the Bidding Service.
@@ -70,7 +90,7 @@ class BiddingAsyncGrpcClient
                                GenerateBidsResponse::GenerateBidsRawResponse>*
                    params) const override;
 
-  Bidding::Stub* stub_;
+  const StubPool<Bidding::Stub>* stubs_;
 };
 
 class ProtectedAppSignalsBiddingAsyncGrpcClient
@@ -85,7 +105,8 @@ class ProtectedAppSignalsBiddingAsyncGrpcClient
   ProtectedAppSignalsBiddingAsyncGrpcClient(
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      const BiddingServiceClientConfig& client_config, Bidding::Stub* stub);
+      const BiddingServiceClientConfig& client_config,
+      const StubPool<Bidding::Stub>* stubs);
 
  protected:
   // Sends an asynchronous request via grpc to the Bidding Service.
@@ -99,7 +120,7 @@ class ProtectedAppSignalsBiddingAsyncGrpcClient
                                    GenerateProtectedAppSignalsBidsRawResponse>*
                    params) const override;
 
-  Bidding::Stub* stub_;
+  const StubPool<Bidding::Stub>* stubs_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,34 +14,147 @@
 
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
 
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "cc/public/cpio/interface/crypto_client/crypto_client_interface.h"
 #include "glog/logging.h"
+#include "services/common/clients/async_grpc/message_compression.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/status_util.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
 
+namespace {
+
+constexpr char kBfeHop[] = "bfe";
+
+std::vector<std::unique_ptr<BuyerFrontEnd::StubInterface>> CreateBuyerStubs(
+    const BuyerServiceClientConfig& client_config,
+    std::unique_ptr<BuyerFrontEnd::StubInterface> stub) {
+  if (stub) {
+    std::vector<std::unique_ptr<BuyerFrontEnd::StubInterface>> stubs;
+    stubs.push_back(std::move(stub));
+    return stubs;
+  }
+  return CreateStubs<BuyerFrontEnd, BuyerFrontEnd::StubInterface>(
+      CreateChannels(client_config.server_addr, client_config.compression,
+                     client_config.secure_client, client_config.num_channels,
+                     client_config.flow_control_window_bytes,
+                     client_config.compression_algorithm,
+                     client_config.channel_warmer));
+}
+
+using GetBidsRawResponse = GetBidsResponse::GetBidsRawResponse;
+
+// Reads the responses of a GetBidsStream call, handing the bids of each to
+// on_chunk once decrypted. Deletes itself once the call is done.
+class GetBidsStreamCall final
+    : public grpc::ClientReadReactor<GetBidsResponse> {
+ public:
+  using Decrypt =
+      absl::AnyInvocable<absl::StatusOr<std::unique_ptr<GetBidsRawResponse>>(
+          GetBidsResponse&)>;
+
+  GetBidsStreamCall(
+      std::unique_ptr<GetBidsRequest> request, const RequestMetadata& metadata,
+      Decrypt decrypt,
+      absl::AnyInvocable<void(std::unique_ptr<GetBidsRawResponse>)> on_chunk,
+      absl::AnyInvocable<void(absl::Status) &&> on_done)
+      : request_(std::move(request)),
+        decrypt_(std::move(decrypt)),
+        on_chunk_(std::move(on_chunk)),
+        on_done_(std::move(on_done)) {
+    for (const auto& [key, value] : metadata) {
+      context_.AddMetadata(key, value);
+    }
+  }
+
+  grpc::ClientContext* context() { return &context_; }
+  const GetBidsRequest* request() const { return request_.get(); }
+
+  // Cancels the call when cancellation is, if not null, which must outlive
+  // the call.
+  void SetCancellation(CancellationToken* cancellation) {
+    if (cancellation == nullptr) {
+      return;
+    }
+    cancellation_ = cancellation;
+    cancellation_id_ = cancellation->Register([this]() {
+      RecordCancelledWork(CancelledWork::kRpc);
+      context_.TryCancel();
+    });
+  }
+
+  // Starts the call, once bound to the stub.
+  void Start() {
+    StartRead(&response_);
+    StartCall();
+  }
+
+  void OnReadDone(bool ok) override {
+    if (!ok) {
+      // The stream is over, and OnDone follows.
+      return;
+    }
+    absl::StatusOr<std::unique_ptr<GetBidsRawResponse>> raw_response =
+        decrypt_(response_);
+    if (!raw_response.ok()) {
+      // The bids of the call can no longer be trusted to be complete.
+      error_ = std::move(raw_response).status();
+      context_.TryCancel();
+      return;
+    }
+    on_chunk_(*std::move(raw_response));
+    response_.Clear();
+    StartRead(&response_);
+  }
+
+  void OnDone(const grpc::Status& status) override {
+    if (cancellation_ != nullptr) {
+      cancellation_->Deregister(cancellation_id_);
+    }
+    std::move(on_done_)(error_.ok() ? ToAbslStatus(status) : error_);
+    delete this;
+  }
+
+ private:
+  grpc::ClientContext context_;
+  std::unique_ptr<GetBidsRequest> request_;
+  GetBidsResponse response_;
+  Decrypt decrypt_;
+  absl::AnyInvocable<void(std::unique_ptr<GetBidsRawResponse>)> on_chunk_;
+  absl::AnyInvocable<void(absl::Status) &&> on_done_;
+  // The error of a response that could not be decrypted, if any.
+  absl::Status error_;
+  CancellationToken* cancellation_ = nullptr;
+  CancellationToken::CallbackId cancellation_id_ = 0;
+};
+
+}  // namespace
+
 BuyerFrontEndAsyncGrpcClient::BuyerFrontEndAsyncGrpcClient(
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
     BuyerServiceClientConfig client_config,
     std::unique_ptr<BuyerFrontEnd::StubInterface> stub)
     : DefaultAsyncGrpcClient(key_fetcher_manager, crypto_client,
-                             client_config.encryption_enabled),
-      stub_(std::move(stub)) {
-  if (!stub_) {
-    stub_ = BuyerFrontEnd::NewStub(CreateChannel(client_config.server_addr,
-                                                 client_config.compression,
-                                                 client_config.secure_client));
-  }
-}
+                             client_config.encryption_enabled,
+                             GetMessageCompressionConfig(client_config),
+                             kBfeHop),
+      stubs_(CreateBuyerStubs(client_config, std::move(stub))) {}
 
 void BuyerFrontEndAsyncGrpcClient::SendRpc(
     const std::string& hpke_secret,
     RawClientParams<GetBidsRequest, GetBidsResponse,
                     GetBidsResponse::GetBidsRawResponse>* params) const {
   VLOG(5) << "BuyerFrontEndAsyncGrpcClient SendRpc invoked ...";
-  stub_->async()->GetBids(
+  stubs_.Next()->async()->GetBids(
       params->ContextRef(), params->RequestRef(), params->ResponseRef(),
       [this, params, hpke_secret](grpc::Status status) {
         DCHECK(encryption_enabled_);
@@ -54,7 +167,8 @@ void BuyerFrontEndAsyncGrpcClient::SendRpc(
 
         VLOG(6) << "SendRPC completion status ok";
         auto decrypted_response =
-            DecryptResponse(hpke_secret, params->ResponseRef());
+            DecryptResponse(hpke_secret, params->ResponseRef(),
+                            params->crypto_metrics());
         if (!decrypted_response.ok()) {
           VLOG(1) << "BuyerFrontEndAsyncGrpcClient Failed to decrypt response";
           params->OnDone(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
@@ -68,4 +182,43 @@ void BuyerFrontEndAsyncGrpcClient::SendRpc(
       });
 }
 
+absl::Status BuyerFrontEndAsyncGrpcClient::ExecuteStreamingInternal(
+    std::unique_ptr<GetBidsRequest::GetBidsRawRequest> raw_request,
+    const RequestMetadata& metadata,
+    absl::AnyInvocable<void(std::unique_ptr<GetBidsRawResponse>)> on_chunk,
+    absl::AnyInvocable<void(absl::Status) &&> on_done, absl::Duration timeout,
+    CryptoMetrics* crypto_metrics, CancellationToken* cancellation) const {
+  DCHECK(encryption_enabled_);
+  if (cancellation != nullptr && cancellation->IsCancelled()) {
+    RecordCancelledWork(CancelledWork::kRpc);
+    return absl::CancelledError("The request was cancelled");
+  }
+  grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_NONE;
+  PS_ASSIGN_OR_RETURN(SecretRequest secret_request,
+                      EncryptRequest(std::move(raw_request), crypto_metrics,
+                                     compression_algorithm));
+  auto& [hpke_secret, request] = secret_request;
+  auto call = std::make_unique<GetBidsStreamCall>(
+      std::move(request), metadata,
+      [this, hpke_secret = std::move(hpke_secret),
+       crypto_metrics](GetBidsResponse& response) {
+        return DecryptResponse(hpke_secret, &response, crypto_metrics);
+      },
+      std::move(on_chunk), std::move(on_done));
+  if (message_compression_.algorithm != GRPC_COMPRESS_NONE) {
+    call->context()->set_compression_algorithm(compression_algorithm);
+  }
+  call->context()->set_deadline(
+      std::chrono::system_clock::now() +
+      std::chrono::milliseconds(
+          ToInt64Milliseconds(std::min(max_timeout, timeout))));
+  call->SetCancellation(cancellation);
+  VLOG(5) << "BuyerFrontEndAsyncGrpcClient GetBidsStream invoked ...";
+  stubs_.Next()->async()->GetBidsStream(call->context(), call->request(),
+                                        call.get());
+  // Deleted once the call is done.
+  call.release()->Start();
+  return absl::OkStatus();
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
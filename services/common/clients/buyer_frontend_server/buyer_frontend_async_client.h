@@ -38,6 +38,18 @@ struct BuyerServiceClientConfig {
   bool compression = false;
   bool secure_client = true;
   bool encryption_enabled = false;
+  // Channels, each with a connection of its own, to spread the calls across.
+  int num_channels = 1;
+  // Initial HTTP/2 flow-control window in bytes, or 0 for the gRPC default.
+  int flow_control_window_bytes = 0;
+  // Algorithm of the requests compressed when compression is enabled.
+  grpc_compression_algorithm compression_algorithm = GRPC_COMPRESS_GZIP;
+  // Requests smaller than this are sent uncompressed even when compression
+  // is enabled.
+  int64_t compression_min_message_bytes = 0;
+  // Connects the channels ahead of their first calls, if set. Must outlive
+  // the client.
+  ChannelWarmer* channel_warmer = nullptr;
 };
 
 // This class is an async grpc client for Fledge Buyer FrontEnd Service.
@@ -53,6 +65,18 @@ class BuyerFrontEndAsyncGrpcClient
       BuyerServiceClientConfig client_config,
       std::unique_ptr<BuyerFrontEnd::StubInterface> stub = nullptr);
 
+  // Calls GetBidsStream, handing the bids of each response to on_chunk once
+  // decrypted.
+  absl::Status ExecuteStreamingInternal(
+      std::unique_ptr<GetBidsRequest::GetBidsRawRequest> raw_request,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(std::unique_ptr<GetBidsResponse::GetBidsRawResponse>)>
+          on_chunk,
+      absl::AnyInvocable<void(absl::Status) &&> on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const override;
+
  protected:
   // Sends an asynchronous request via grpc to the Buyer FrontEnd Service.
   //
@@ -63,7 +87,7 @@ class BuyerFrontEndAsyncGrpcClient
                                GetBidsResponse::GetBidsRawResponse>* params)
       const override;
 
-  std::unique_ptr<BuyerFrontEnd::StubInterface> stub_;
+  StubPool<BuyerFrontEnd::StubInterface> stubs_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
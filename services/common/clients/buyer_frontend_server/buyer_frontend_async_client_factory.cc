@@ -30,7 +30,8 @@ BuyerFrontEndAsyncClientFactory::BuyerFrontEndAsyncClientFactory(
         buyer_ig_owner_to_bfe_addr_map,
     server_common::KeyFetcherManagerInterface* key_fetcher_manager,
     CryptoClientWrapperInterface* crypto_client,
-    const BuyerServiceClientConfig& client_config) {
+    const BuyerServiceClientConfig& client_config,
+    std::optional<CircuitBreakerOptions> circuit_breaker_options) {
   absl::flat_hash_map<std::string,
                       std::shared_ptr<const BuyerFrontEndAsyncClient>>
       bfe_addr_client_map;
@@ -42,19 +43,26 @@ BuyerFrontEndAsyncClientFactory::BuyerFrontEndAsyncClientFactory(
       continue;
     }
 
+    std::shared_ptr<const BuyerFrontEndAsyncClient> bfe_client_ptr;
     if (auto it = bfe_addr_client_map.find(bfe_host_addr);
         it != bfe_addr_client_map.end()) {
-      static_client_map->try_emplace(ig_owner, it->second);
+      bfe_client_ptr = it->second;
     } else {
       BuyerServiceClientConfig client_config_copy = client_config;
       client_config_copy.server_addr = bfe_host_addr;
-      auto bfe_client_ptr =
-          std::make_shared<const BuyerFrontEndAsyncGrpcClient>(
-              key_fetcher_manager, crypto_client,
-              std::move(client_config_copy));
+      bfe_client_ptr = std::make_shared<const BuyerFrontEndAsyncGrpcClient>(
+          key_fetcher_manager, crypto_client, std::move(client_config_copy));
       bfe_addr_client_map.insert({bfe_host_addr, bfe_client_ptr});
-      static_client_map->try_emplace(ig_owner, bfe_client_ptr);
     }
+    // The circuits are per buyer, even for the buyers sharing a BFE.
+    if (circuit_breaker_options.has_value()) {
+      bfe_client_ptr = std::make_shared<const CircuitBreakingAsyncClient<
+          GetBidsRequest, GetBidsResponse, GetBidsRequest::GetBidsRawRequest,
+          GetBidsResponse::GetBidsRawResponse>>(
+          std::move(bfe_client_ptr),
+          std::make_shared<CircuitBreaker>(ig_owner, *circuit_breaker_options));
+    }
+    static_client_map->try_emplace(ig_owner, std::move(bfe_client_ptr));
   }
   client_cache_ = std::make_unique<
       StaticLocalCache<std::string, const BuyerFrontEndAsyncClient>>(
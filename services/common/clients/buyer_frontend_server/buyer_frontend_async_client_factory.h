@@ -16,11 +16,13 @@
 #define SERVICES_COMMON_CLIENTS_BUYER_FRONTEND_SERVER_BUYER_FRONTEND_ASYNC_CLIENT_FACTORY_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
+#include "services/common/clients/circuit_breaker.h"
 #include "services/common/clients/client_factory.h"
 #include "services/common/concurrent/local_cache.h"
 #include "src/cpp/encryption/key_fetcher/src/key_fetcher_manager.h"
@@ -36,13 +38,16 @@ class BuyerFrontEndAsyncClientFactory
   // Map is keyed on IG Owner (Buyer domain) and value corresponds to BFE host
   // domain. If compression is enabled, uses the GZIP algorithm to compress
   // requests to BuyerFrontEnd Server. Compression is disabled by default.
-  // TLS is enabled by default.
+  // TLS is enabled by default. If circuit_breaker_options is set, the calls
+  // to each buyer go through a circuit breaker of the buyer.
   explicit BuyerFrontEndAsyncClientFactory(
       const absl::flat_hash_map<std::string, std::string>&
           buyer_ig_owner_to_bfe_addr_map,
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
       CryptoClientWrapperInterface* crypto_client,
-      const BuyerServiceClientConfig& client_config);
+      const BuyerServiceClientConfig& client_config,
+      std::optional<CircuitBreakerOptions> circuit_breaker_options =
+          std::nullopt);
 
   // BuyerFrontEndAsyncClientFactory is neither copyable nor movable.
   BuyerFrontEndAsyncClientFactory(const BuyerFrontEndAsyncClientFactory&) =
@@ -23,6 +23,8 @@
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
+using ::testing::Contains;
+using ::testing::Pair;
 using ::testing::Return;
 
 TEST(BuyerFrontEndAsyncClientFactoryTest, GetCachesClientObjects) {
@@ -71,5 +73,26 @@ TEST(BuyerFrontEndAsyncClientFactoryTest,
   EXPECT_EQ(output_1, output_2);
 }
 
+TEST(BuyerFrontEndAsyncClientFactoryTest,
+     CreatesCircuitBreakingClientsPerBuyer) {
+  std::string ig_owner_1 = MakeARandomString();
+  std::string ig_owner_2 = MakeARandomString();
+  std::string bfe_lb_url = MakeARandomString();
+
+  absl::flat_hash_map<std::string, std::string> host_addr_map;
+  host_addr_map.emplace(ig_owner_1, bfe_lb_url);
+  host_addr_map.emplace(ig_owner_2, bfe_lb_url);
+  BuyerFrontEndAsyncClientFactory class_under_test(
+      host_addr_map, nullptr, nullptr, BuyerServiceClientConfig(),
+      CircuitBreakerOptions());
+
+  std::shared_ptr<const BuyerFrontEndAsyncClient> output_1 =
+      class_under_test.Get(ig_owner_1);
+  ASSERT_NE(output_1, nullptr);
+  EXPECT_EQ(output_1, class_under_test.Get(ig_owner_1));
+  EXPECT_NE(output_1, class_under_test.Get(ig_owner_2));
+  EXPECT_THAT(GetCircuitBreakerStates(), Contains(Pair(ig_owner_1, 0)));
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
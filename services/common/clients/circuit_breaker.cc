@@ -0,0 +1,134 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/circuit_breaker.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Calls after which the recent calls are halved, so that the failure rate
+// follows the recent calls.
+constexpr int64_t kDecayWindow = 200;
+
+ABSL_CONST_INIT absl::Mutex stats_mu(absl::kConstInit);
+
+absl::flat_hash_map<std::string, double>& States()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(stats_mu) {
+  static auto* states = new absl::flat_hash_map<std::string, double>();
+  return *states;
+}
+
+absl::flat_hash_map<std::string, double>& RejectedCounts()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(stats_mu) {
+  static auto* counts = new absl::flat_hash_map<std::string, double>();
+  return *counts;
+}
+
+}  // namespace
+
+CircuitBreaker::CircuitBreaker(std::string name, CircuitBreakerOptions options)
+    : name_(std::move(name)), options_(options) {
+  absl::MutexLock lock(&stats_mu);
+  States()[name_] = static_cast<double>(State::kClosed);
+}
+
+CircuitBreaker::~CircuitBreaker() {
+  absl::MutexLock lock(&stats_mu);
+  States().erase(name_);
+}
+
+std::optional<int64_t> CircuitBreaker::AllowCall() {
+  {
+    absl::MutexLock lock(&mu_);
+    if (state_ == State::kClosed) {
+      return generation_;
+    }
+    if (state_ == State::kOpen &&
+        absl::Now() - opened_at_ >= options_.open_duration) {
+      SetState(State::kHalfOpen);
+    }
+    if (state_ == State::kHalfOpen && !probe_in_flight_) {
+      probe_in_flight_ = true;
+      return generation_;
+    }
+  }
+  absl::MutexLock lock(&stats_mu);
+  RejectedCounts()[name_] += 1;
+  return std::nullopt;
+}
+
+void CircuitBreaker::RecordResult(int64_t generation, bool success) {
+  absl::MutexLock lock(&mu_);
+  if (generation != generation_) {
+    // A call allowed before the last change of state.
+    return;
+  }
+  switch (state_) {
+    case State::kClosed:
+      ++calls_;
+      failures_ += success ? 0 : 1;
+      if (calls_ >= kMinCalls &&
+          failures_ * 100 >= calls_ * options_.failure_percent) {
+        SetState(State::kOpen);
+      } else if (calls_ >= kDecayWindow) {
+        calls_ /= 2;
+        failures_ /= 2;
+      }
+      break;
+    case State::kOpen:
+      // No call is allowed while open.
+      break;
+    case State::kHalfOpen:
+      SetState(success ? State::kClosed : State::kOpen);
+      break;
+  }
+}
+
+void CircuitBreaker::ReleaseCall(int64_t generation) {
+  absl::MutexLock lock(&mu_);
+  if (generation == generation_ && state_ == State::kHalfOpen) {
+    // Let another probe through.
+    probe_in_flight_ = false;
+  }
+}
+
+CircuitBreaker::State CircuitBreaker::state() const {
+  absl::MutexLock lock(&mu_);
+  return state_;
+}
+
+void CircuitBreaker::SetState(State state) {
+  state_ = state;
+  ++generation_;
+  probe_in_flight_ = false;
+  calls_ = 0;
+  failures_ = 0;
+  if (state == State::kOpen) {
+    opened_at_ = absl::Now();
+  }
+  absl::MutexLock lock(&stats_mu);
+  States()[name_] = static_cast<double>(state);
+}
+
+absl::flat_hash_map<std::string, double> GetCircuitBreakerStates() {
+  absl::MutexLock lock(&stats_mu);
+  return States();
+}
+
+absl::flat_hash_map<std::string, double> GetCircuitBreakerRejectedCounts() {
+  absl::MutexLock lock(&stats_mu);
+  return std::exchange(RejectedCounts(), {});
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
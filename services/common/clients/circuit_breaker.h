@@ -0,0 +1,264 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CIRCUIT_BREAKER_H_
+#define SERVICES_COMMON_CLIENTS_CIRCUIT_BREAKER_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/clients/async_client.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct CircuitBreakerOptions {
+  // Percentage of failed recent calls that opens the circuit.
+  int failure_percent = 50;
+  // Time the circuit stays open before a probe call is let through.
+  absl::Duration open_duration = absl::Seconds(5);
+};
+
+// Stops the calls to a failing backend. The circuit opens when too many of
+// the recent calls failed, and then rejects the calls for a while. After
+// that, it lets a single probe call through, which closes the circuit if it
+// succeeds and opens it again if it fails. Each call is tagged with the
+// generation of the state it was allowed in, and only the results of the
+// calls of the current generation count, so that a call made before the
+// circuit opened cannot decide the probe. Thread safe.
+class CircuitBreaker final {
+ public:
+  // Calls made before the failure rate can open the circuit.
+  static constexpr int64_t kMinCalls = 20;
+
+  enum class State { kClosed = 0, kOpen = 1, kHalfOpen = 2 };
+
+  // The name labels the metrics of the circuit.
+  explicit CircuitBreaker(std::string name, CircuitBreakerOptions options = {});
+  ~CircuitBreaker();
+
+  // Not copyable or movable.
+  CircuitBreaker(const CircuitBreaker&) = delete;
+  CircuitBreaker& operator=(const CircuitBreaker&) = delete;
+
+  // Returns the generation of the call if it can be made, or nullopt. A call
+  // that is allowed must have its result recorded or be released, with its
+  // generation.
+  std::optional<int64_t> AllowCall() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records whether an allowed call succeeded.
+  void RecordResult(int64_t generation, bool success) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records that an allowed call ended without telling anything of the
+  // backend, as when its caller cancelled it.
+  void ReleaseCall(int64_t generation) ABSL_LOCKS_EXCLUDED(mu_);
+
+  State state() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  const std::string& name() const { return name_; }
+
+ private:
+  void SetState(State state) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const std::string name_;
+  const CircuitBreakerOptions options_;
+  mutable absl::Mutex mu_;
+  State state_ ABSL_GUARDED_BY(mu_) = State::kClosed;
+  // Incremented by every change of state.
+  int64_t generation_ ABSL_GUARDED_BY(mu_) = 0;
+  // Recent calls and failures while closed, decayed as new calls are made.
+  int64_t calls_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t failures_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::Time opened_at_ ABSL_GUARDED_BY(mu_);
+  bool probe_in_flight_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+// Makes the calls of the client through the circuit breaker. The calls
+// rejected while the circuit is open fail right away with an UNAVAILABLE
+// status, instead of waiting for the timeout of the failing backend.
+template <typename Request, typename Response, typename RawRequest,
+          typename RawResponse>
+class CircuitBreakingAsyncClient
+    : public AsyncClient<Request, Response, RawRequest, RawResponse> {
+ public:
+  using Client = AsyncClient<Request, Response, RawRequest, RawResponse>;
+
+  CircuitBreakingAsyncClient(std::shared_ptr<const Client> client,
+                             std::shared_ptr<CircuitBreaker> circuit_breaker)
+      : client_(std::move(client)),
+        circuit_breaker_(std::move(circuit_breaker)) {}
+
+  absl::Status Execute(
+      std::unique_ptr<Request> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<Response>>) &&>
+          on_done,
+      absl::Duration timeout) const override {
+    std::optional<int64_t> generation = circuit_breaker_->AllowCall();
+    if (!generation.has_value()) {
+      return Rejected();
+    }
+    return Recorded(
+        *generation,
+        client_->Execute(
+            std::move(request), metadata,
+            RecordingResult<Response>(*generation, std::move(on_done)),
+            timeout));
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout) const override {
+    std::optional<int64_t> generation = circuit_breaker_->AllowCall();
+    if (!generation.has_value()) {
+      return Rejected();
+    }
+    return Recorded(
+        *generation,
+        client_->ExecuteInternal(
+            std::move(request), metadata,
+            RecordingResult<RawResponse>(*generation, std::move(on_done)),
+            timeout));
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics) const override {
+    std::optional<int64_t> generation = circuit_breaker_->AllowCall();
+    if (!generation.has_value()) {
+      return Rejected();
+    }
+    return Recorded(
+        *generation,
+        client_->ExecuteInternal(
+            std::move(request), metadata,
+            RecordingResult<RawResponse>(*generation, std::move(on_done)),
+            timeout, crypto_metrics));
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const override {
+    std::optional<int64_t> generation = circuit_breaker_->AllowCall();
+    if (!generation.has_value()) {
+      return Rejected();
+    }
+    return Recorded(
+        *generation,
+        client_->ExecuteInternal(
+            std::move(request), metadata,
+            RecordingResult<RawResponse>(*generation, std::move(on_done)),
+            timeout, crypto_metrics, cancellation));
+  }
+
+  absl::Status ExecuteStreamingInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(std::unique_ptr<RawResponse>)> on_chunk,
+      absl::AnyInvocable<void(absl::Status) &&> on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const override {
+    std::optional<int64_t> generation = circuit_breaker_->AllowCall();
+    if (!generation.has_value()) {
+      return Rejected();
+    }
+    return Recorded(
+        *generation,
+        client_->ExecuteStreamingInternal(
+            std::move(request), metadata, std::move(on_chunk),
+            [circuit_breaker = circuit_breaker_, generation = *generation,
+             on_done = std::move(on_done)](absl::Status status) mutable {
+              Record(*circuit_breaker, generation, status);
+              std::move(on_done)(std::move(status));
+            },
+            timeout, crypto_metrics, cancellation));
+  }
+
+ private:
+  // A call cancelled by its caller says nothing of the backend.
+  static void Record(CircuitBreaker& circuit_breaker, int64_t generation,
+                     const absl::Status& status) {
+    if (absl::IsCancelled(status)) {
+      circuit_breaker.ReleaseCall(generation);
+    } else {
+      circuit_breaker.RecordResult(generation, status.ok());
+    }
+  }
+
+  template <typename T>
+  absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<T>>) &&>
+  RecordingResult(
+      int64_t generation,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<T>>) &&> on_done)
+      const {
+    return [circuit_breaker = circuit_breaker_, generation,
+            on_done = std::move(on_done)](
+               absl::StatusOr<std::unique_ptr<T>> response) mutable {
+      Record(*circuit_breaker, generation, response.status());
+      std::move(on_done)(std::move(response));
+    };
+  }
+
+  // A call that could not be made is a failure, and its callback is not run.
+  absl::Status Recorded(int64_t generation, absl::Status status) const {
+    if (!status.ok()) {
+      Record(*circuit_breaker_, generation, status);
+    }
+    return status;
+  }
+
+  absl::Status Rejected() const {
+    return absl::UnavailableError(
+        absl::StrCat("Circuit open for ", circuit_breaker_->name()));
+  }
+
+  std::shared_ptr<const Client> client_;
+  std::shared_ptr<CircuitBreaker> circuit_breaker_;
+};
+
+// Returns the state of each circuit breaker by name, as the value of its
+// CircuitBreaker::State.
+absl::flat_hash_map<std::string, double> GetCircuitBreakerStates();
+
+// Returns the number of calls rejected by each circuit breaker by name since
+// the previous call.
+absl::flat_hash_map<std::string, double> GetCircuitBreakerRejectedCounts();
+
+template <typename T>
+inline void AddCircuitBreakerMetric(T* context_map) {
+  context_map->AddObserverable(metric::kCircuitBreakerState,
+                               GetCircuitBreakerStates);
+  context_map->AddObserverable(metric::kCircuitBreakerRejectedCount,
+                               GetCircuitBreakerRejectedCounts);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CIRCUIT_BREAKER_H_
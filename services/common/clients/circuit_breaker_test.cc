@@ -0,0 +1,191 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/circuit_breaker.h"
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Pair;
+
+constexpr char kBackend[] = "https://buyer.com";
+
+using IntClient = AsyncClient<int, int, int, int>;
+
+// Fails or succeeds all the calls.
+class FakeClient : public IntClient {
+ public:
+  absl::Status ExecuteInternal(
+      std::unique_ptr<int> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<int>>) &&> on_done,
+      absl::Duration timeout) const override {
+    ++calls;
+    if (cancel) {
+      std::move(on_done)(absl::CancelledError("Cancelled"));
+    } else if (fail) {
+      std::move(on_done)(absl::DeadlineExceededError("Timed out"));
+    } else {
+      std::move(on_done)(std::move(request));
+    }
+    return absl::OkStatus();
+  }
+
+  bool fail = false;
+  bool cancel = false;
+  mutable int calls = 0;
+};
+
+void FailCalls(CircuitBreaker& circuit_breaker, int calls) {
+  for (int i = 0; i < calls; ++i) {
+    std::optional<int64_t> generation = circuit_breaker.AllowCall();
+    ASSERT_TRUE(generation.has_value());
+    circuit_breaker.RecordResult(*generation, /*success=*/false);
+  }
+}
+
+TEST(CircuitBreakerTest, StaysClosedUntilEnoughCalls) {
+  CircuitBreaker circuit_breaker(kBackend);
+  FailCalls(circuit_breaker, CircuitBreaker::kMinCalls - 1);
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kClosed);
+
+  FailCalls(circuit_breaker, 1);
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kOpen);
+  EXPECT_FALSE(circuit_breaker.AllowCall().has_value());
+}
+
+TEST(CircuitBreakerTest, StaysClosedBelowFailurePercent) {
+  CircuitBreaker circuit_breaker(kBackend, {.failure_percent = 50});
+  for (int i = 0; i < 10 * CircuitBreaker::kMinCalls; ++i) {
+    std::optional<int64_t> generation = circuit_breaker.AllowCall();
+    ASSERT_TRUE(generation.has_value());
+    circuit_breaker.RecordResult(*generation, /*success=*/i % 3 != 0);
+  }
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kClosed);
+}
+
+TEST(CircuitBreakerTest, ProbesOnceOpenDurationElapsed) {
+  CircuitBreaker circuit_breaker(kBackend,
+                                 {.open_duration = absl::ZeroDuration()});
+  FailCalls(circuit_breaker, CircuitBreaker::kMinCalls);
+
+  // A single probe is let through.
+  std::optional<int64_t> probe = circuit_breaker.AllowCall();
+  ASSERT_TRUE(probe.has_value());
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kHalfOpen);
+  EXPECT_FALSE(circuit_breaker.AllowCall().has_value());
+
+  // A failed probe opens the circuit again, and a successful one closes it.
+  circuit_breaker.RecordResult(*probe, /*success=*/false);
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kOpen);
+  probe = circuit_breaker.AllowCall();
+  ASSERT_TRUE(probe.has_value());
+  circuit_breaker.RecordResult(*probe, /*success=*/true);
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kClosed);
+  EXPECT_TRUE(circuit_breaker.AllowCall().has_value());
+}
+
+TEST(CircuitBreakerTest, IgnoresResultsOfCallsBeforeTheProbe) {
+  CircuitBreaker circuit_breaker(kBackend,
+                                 {.open_duration = absl::ZeroDuration()});
+  std::optional<int64_t> slow_call = circuit_breaker.AllowCall();
+  ASSERT_TRUE(slow_call.has_value());
+  FailCalls(circuit_breaker, CircuitBreaker::kMinCalls);
+  std::optional<int64_t> probe = circuit_breaker.AllowCall();
+  ASSERT_TRUE(probe.has_value());
+
+  // The call made while closed finishes during the probe.
+  circuit_breaker.RecordResult(*slow_call, /*success=*/true);
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kHalfOpen);
+  circuit_breaker.RecordResult(*probe, /*success=*/false);
+  EXPECT_EQ(circuit_breaker.state(), CircuitBreaker::State::kOpen);
+}
+
+TEST(CircuitBreakerTest, ProbesAgainOnceProbeIsReleased) {
+  CircuitBreaker circuit_breaker(kBackend,
+                                 {.open_duration = absl::ZeroDuration()});
+  FailCalls(circuit_breaker, CircuitBreaker::kMinCalls);
+  std::optional<int64_t> probe = circuit_breaker.AllowCall();
+  ASSERT_TRUE(probe.has_value());
+  EXPECT_FALSE(circuit_breaker.AllowCall().has_value());
+
+  circuit_breaker.ReleaseCall(*probe);
+  EXPECT_TRUE(circuit_breaker.AllowCall().has_value());
+}
+
+TEST(CircuitBreakerTest, ExportsStatesAndRejectedCalls) {
+  GetCircuitBreakerRejectedCounts();
+  CircuitBreaker circuit_breaker(kBackend);
+  EXPECT_THAT(GetCircuitBreakerStates(), Contains(Pair(kBackend, 0)));
+
+  FailCalls(circuit_breaker, CircuitBreaker::kMinCalls);
+  EXPECT_FALSE(circuit_breaker.AllowCall().has_value());
+  EXPECT_FALSE(circuit_breaker.AllowCall().has_value());
+  EXPECT_THAT(GetCircuitBreakerStates(), Contains(Pair(kBackend, 1)));
+  EXPECT_THAT(GetCircuitBreakerRejectedCounts(), Contains(Pair(kBackend, 2)));
+  EXPECT_TRUE(GetCircuitBreakerRejectedCounts().empty());
+}
+
+TEST(CircuitBreakingAsyncClientTest, RejectsCallsWhileOpen) {
+  auto client = std::make_shared<FakeClient>();
+  client->fail = true;
+  CircuitBreakingAsyncClient<int, int, int, int> circuit_breaking_client(
+      client, std::make_shared<CircuitBreaker>(kBackend));
+
+  int failures = 0;
+  for (int i = 0; i < CircuitBreaker::kMinCalls + 5; ++i) {
+    absl::Status status = circuit_breaking_client.ExecuteInternal(
+        std::make_unique<int>(i), {},
+        [&failures](absl::StatusOr<std::unique_ptr<int>> response) {
+          EXPECT_FALSE(response.ok());
+          ++failures;
+        },
+        absl::Seconds(1));
+    if (i < CircuitBreaker::kMinCalls) {
+      EXPECT_TRUE(status.ok());
+    } else {
+      EXPECT_EQ(status.code(), absl::StatusCode::kUnavailable);
+    }
+  }
+  EXPECT_EQ(client->calls, CircuitBreaker::kMinCalls);
+  EXPECT_EQ(failures, CircuitBreaker::kMinCalls);
+}
+
+TEST(CircuitBreakingAsyncClientTest, DoesNotCountCancelledCallsAsFailures) {
+  auto client = std::make_shared<FakeClient>();
+  client->cancel = true;
+  CircuitBreakingAsyncClient<int, int, int, int> circuit_breaking_client(
+      client, std::make_shared<CircuitBreaker>(kBackend));
+
+  for (int i = 0; i < CircuitBreaker::kMinCalls + 5; ++i) {
+    EXPECT_TRUE(circuit_breaking_client
+                    .ExecuteInternal(
+                        std::make_unique<int>(i), {},
+                        [](absl::StatusOr<std::unique_ptr<int>> response) {},
+                        absl::Seconds(1), /*crypto_metrics=*/nullptr,
+                        /*cancellation=*/nullptr)
+                    .ok());
+  }
+  EXPECT_EQ(client->calls, CircuitBreaker::kMinCalls + 5);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
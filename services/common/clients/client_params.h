@@ -25,9 +25,12 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/status/statusor.h"
 #include "absl/time/time.h"
+#include "services/common/util/cancellation_token.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+class CryptoMetrics;
+
 // This class handles the lifecycle of parameters on the heap required for
 // the entire timeline of a single gRPC request.
 // Usage:
@@ -144,6 +147,9 @@ class RawClientParams {
   }
 
   void OnDone(const grpc::Status& status) {
+    if (cancellation_ != nullptr) {
+      cancellation_->Deregister(cancellation_id_);
+    }
     if (status.ok()) {
       std::move(raw_callback_)(std::move(raw_response_));
     } else {
@@ -158,6 +164,25 @@ class RawClientParams {
     raw_response_ = std::move(raw_response);
   }
 
+  // The metrics the decryption of the response is added to, if any.
+  void SetCryptoMetrics(CryptoMetrics* crypto_metrics) {
+    crypto_metrics_ = crypto_metrics;
+  }
+  CryptoMetrics* crypto_metrics() const { return crypto_metrics_; }
+
+  // Cancels the RPC when cancellation is, if not null, which must outlive the
+  // call.
+  void SetCancellation(CancellationToken* cancellation) {
+    if (cancellation == nullptr) {
+      return;
+    }
+    cancellation_ = cancellation;
+    cancellation_id_ = cancellation->Register([this]() {
+      RecordCancelledWork(CancelledWork::kRpc);
+      context_.TryCancel();
+    });
+  }
+
  private:
   // Parameters will be accessed by the gRPC code.
   // Destructed automatically after OnDone
@@ -171,6 +196,12 @@ class RawClientParams {
   // callback will only run once for a single gRPC call
   absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>)&&>
       raw_callback_ = nullptr;
+
+  // Owned by the caller, and outlives the call.
+  CryptoMetrics* crypto_metrics_ = nullptr;
+
+  CancellationToken* cancellation_ = nullptr;
+  CancellationToken::CallbackId cancellation_id_ = 0;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
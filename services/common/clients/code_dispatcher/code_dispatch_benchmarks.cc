@@ -0,0 +1,367 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Throughput and latency benchmarks of Roma, through V8Dispatcher and
+// CodeDispatchClient alone, with no reactor around them.
+//
+// Each benchmark keeps `in_flight` batches of `batch` requests dispatched to a
+// dispatcher of `workers` workers queueing `queue_len` requests each. Every
+// request passes a string of `arg_bytes` bytes to a handler running `cost`
+// iterations of a floating point loop. Every iteration dispatches a batch, so
+// items_per_second is the throughput in requests per second. Besides, the
+// following are exported as counters:
+// - idle_us: the latency of a batch dispatched alone, as its execution time.
+// - p50_us and p99_us: percentiles of the batch latency under load.
+// - queueing_p50_us and queueing_p99_us: the same, less idle_us, as the time
+//   batches waited for a worker.
+// - not_scheduled: batches that Roma failed to schedule, as when its queues
+//   are full, and errors: requests whose execution failed.
+//
+// BM_V8DispatcherBatchExecute and BM_CodeDispatchClientBatchExecute sweep the
+// parameters one at a time around a baseline, the latter also exporting the
+// mean of the queueing time projected by DispatchStats at every dispatch as
+// projected_queueing_us. BM_CodeDispatchClientCoalescing coalesces the
+// batches of `window_us` microseconds.
+//
+// Run with:
+//   bazel run -c opt //services/common/clients/code_dispatcher:code_dispatch_benchmarks
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kVersion = 1;
+constexpr char kHandlerName[] = "Handle";
+// Runs `cost` iterations of a floating point loop over the argument.
+constexpr char kHandlerCode[] = R"JS_CODE(
+    function Handle(arg, cost) {
+      let x = arg.length;
+      for (let i = 0; i < cost; i++) {
+        x = Math.sqrt(x + i);
+      }
+      return {length: arg.length, x: x};
+    }
+)JS_CODE";
+
+// Batches dispatched alone to measure the idle latency, the first of which
+// warm the workers up.
+constexpr int kIdleBatches = 20;
+
+constexpr char kWorkers[] = "workers";
+constexpr char kQueueLength[] = "queue_len";
+constexpr char kBatch[] = "batch";
+constexpr char kArgBytes[] = "arg_bytes";
+constexpr char kCost[] = "cost";
+constexpr char kInFlight[] = "in_flight";
+
+struct DispatchArgs {
+  int workers;
+  int queue_len;
+  int batch;
+  int arg_bytes;
+  int cost;
+  int in_flight;
+};
+
+DispatchArgs GetDispatchArgs(const benchmark::State& state) {
+  return {.workers = static_cast<int>(state.range(0)),
+          .queue_len = static_cast<int>(state.range(1)),
+          .batch = static_cast<int>(state.range(2)),
+          .arg_bytes = static_cast<int>(state.range(3)),
+          .cost = static_cast<int>(state.range(4)),
+          .in_flight = static_cast<int>(state.range(5))};
+}
+
+std::vector<DispatchRequest> MakeBatch(const DispatchArgs& args) {
+  const auto arg = std::make_shared<std::string>(
+      absl::StrCat("\"", std::string(args.arg_bytes, 'a'), "\""));
+  const auto cost = std::make_shared<std::string>(absl::StrCat(args.cost));
+  std::vector<DispatchRequest> batch(args.batch);
+  for (int i = 0; i < args.batch; i++) {
+    batch[i].id = absl::StrCat(i);
+    batch[i].version_num = kVersion;
+    batch[i].handler_name = kHandlerName;
+    batch[i].input = {arg, cost};
+  }
+  return batch;
+}
+
+// Counts the batches in flight, blocking new ones while there are too many,
+// and records the latencies of the batches done. Thread safe.
+class BatchRecorder {
+ public:
+  explicit BatchRecorder(int max_in_flight) : max_in_flight_(max_in_flight) {}
+
+  // Blocks until a batch can be dispatched, and counts it in flight.
+  void Acquire() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &BatchRecorder::CanAcquire));
+    ++in_flight_;
+  }
+
+  // Records that a batch finished `latency` after it was dispatched, with
+  // `errors` failed requests.
+  void Done(absl::Duration latency, int errors) ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    --in_flight_;
+    latencies_.push_back(latency);
+    errors_ += errors;
+  }
+
+  // Records that a batch failed to be scheduled.
+  void NotScheduled() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    --in_flight_;
+    ++not_scheduled_;
+  }
+
+  // Blocks until no batch is in flight.
+  void Drain() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &BatchRecorder::Idle));
+  }
+
+  // Returns the latencies recorded since the previous call, sorted.
+  std::vector<absl::Duration> TakeLatencies() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    std::vector<absl::Duration> latencies = std::move(latencies_);
+    latencies_.clear();
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+  }
+
+  int64_t errors() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return errors_;
+  }
+
+  int64_t not_scheduled() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return not_scheduled_;
+  }
+
+ private:
+  bool CanAcquire() const ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return in_flight_ < max_in_flight_;
+  }
+  bool Idle() const ABSL_SHARED_LOCKS_REQUIRED(mu_) { return in_flight_ == 0; }
+
+  const int max_in_flight_;
+  mutable absl::Mutex mu_;
+  int in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  std::vector<absl::Duration> latencies_ ABSL_GUARDED_BY(mu_);
+  int64_t errors_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t not_scheduled_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+using DispatchFunction = absl::AnyInvocable<absl::Status(
+    std::vector<DispatchRequest>&, BatchDispatchDoneCallback)>;
+
+// Dispatches a batch through dispatch, and records it once done. Does not
+// block on the batch.
+void DispatchBatch(const std::vector<DispatchRequest>& prototype,
+                   DispatchFunction& dispatch, BatchRecorder& recorder) {
+  std::vector<DispatchRequest> batch = prototype;
+  const absl::Time start = absl::Now();
+  absl::Status status = dispatch(
+      batch,
+      [&recorder,
+       start](const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
+        const int errors = std::count_if(
+            responses.begin(), responses.end(),
+            [](const absl::StatusOr<DispatchResponse>& response) {
+              return !response.ok();
+            });
+        recorder.Done(absl::Now() - start, errors);
+      });
+  if (!status.ok()) {
+    recorder.NotScheduled();
+  }
+}
+
+double Percentile(const std::vector<absl::Duration>& sorted, int percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return absl::ToDoubleMicroseconds(
+      sorted[(sorted.size() - 1) * percentile / 100]);
+}
+
+// Measures the idle latency of a batch, then keeps args.in_flight batches
+// dispatched for the iterations of the benchmark.
+void RunDispatchLoad(benchmark::State& state, const DispatchArgs& args,
+                     DispatchFunction dispatch) {
+  const std::vector<DispatchRequest> prototype = MakeBatch(args);
+
+  BatchRecorder idle_recorder(/*max_in_flight=*/1);
+  for (int i = 0; i < kIdleBatches; i++) {
+    idle_recorder.Acquire();
+    DispatchBatch(prototype, dispatch, idle_recorder);
+    idle_recorder.Drain();
+  }
+  const double idle_us = Percentile(idle_recorder.TakeLatencies(), 50);
+
+  BatchRecorder recorder(args.in_flight);
+  for (auto _ : state) {
+    recorder.Acquire();
+    DispatchBatch(prototype, dispatch, recorder);
+  }
+  recorder.Drain();
+
+  const std::vector<absl::Duration> latencies = recorder.TakeLatencies();
+  state.counters["idle_us"] = idle_us;
+  state.counters["p50_us"] = Percentile(latencies, 50);
+  state.counters["p99_us"] = Percentile(latencies, 99);
+  state.counters["queueing_p50_us"] =
+      std::max(Percentile(latencies, 50) - idle_us, 0.0);
+  state.counters["queueing_p99_us"] =
+      std::max(Percentile(latencies, 99) - idle_us, 0.0);
+  state.counters["not_scheduled"] = recorder.not_scheduled();
+  state.counters["errors"] = recorder.errors();
+  state.SetItemsProcessed(state.iterations() * args.batch);
+}
+
+// Starts Roma on the configuration of args, with the handler loaded.
+void StartDispatcher(const V8Dispatcher& dispatcher, const DispatchArgs& args) {
+  DispatchConfig config;
+  config.number_of_workers = args.workers;
+  config.worker_queue_max_items = args.queue_len;
+  CHECK(dispatcher.Init(config).ok());
+  CHECK(dispatcher.LoadSync(kVersion, kHandlerCode).ok());
+}
+
+void BM_V8DispatcherBatchExecute(benchmark::State& state) {
+  const DispatchArgs args = GetDispatchArgs(state);
+  V8Dispatcher dispatcher;
+  StartDispatcher(dispatcher, args);
+  RunDispatchLoad(state, args,
+                  [&dispatcher](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback callback) {
+                    return dispatcher.BatchExecute(batch, std::move(callback));
+                  });
+  CHECK(dispatcher.Stop().ok());
+}
+
+void RunCodeDispatchClientLoad(benchmark::State& state,
+                               const DispatchArgs& args,
+                               DispatchCoalescingConfig coalescing) {
+  V8Dispatcher dispatcher;
+  StartDispatcher(dispatcher, args);
+  // Not the statistics of the process, so that runs do not mix.
+  DispatchStats stats;
+  stats.SetNumWorkers(args.workers);
+  stats.SetWorkerQueueLength(args.queue_len);
+  int64_t dispatches = 0;
+  absl::Duration projected_queueing;
+  {
+    CodeDispatchClient client(dispatcher, coalescing, &stats);
+    RunDispatchLoad(state, args,
+                    [&](std::vector<DispatchRequest>& batch,
+                        BatchDispatchDoneCallback callback) {
+                      ++dispatches;
+                      projected_queueing += stats.ProjectedQueueingTime();
+                      return client.BatchExecute(batch, std::move(callback));
+                    });
+  }
+  state.counters["projected_queueing_us"] =
+      dispatches > 0
+          ? absl::ToDoubleMicroseconds(projected_queueing / dispatches)
+          : 0;
+  CHECK(dispatcher.Stop().ok());
+}
+
+void BM_CodeDispatchClientBatchExecute(benchmark::State& state) {
+  RunCodeDispatchClientLoad(state, GetDispatchArgs(state),
+                            DispatchCoalescingConfig{});
+}
+
+void BM_CodeDispatchClientCoalescing(benchmark::State& state) {
+  const DispatchArgs args = GetDispatchArgs(state);
+  RunCodeDispatchClientLoad(
+      state, args,
+      {.window = absl::Microseconds(state.range(6)),
+       .max_batch_size = std::max(args.batch * args.in_flight / 2, 1)});
+}
+
+// Baseline of the sweeps, in the order of the arguments.
+constexpr int64_t kBaseline[] = {4, 100, 10, 1024, 1000, 8};
+
+// Args: workers, queue length per worker, batch size, argument bytes, handler
+// loop iterations and batches in flight. Each is swept on its own, the others
+// keeping their baseline.
+void DispatchArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames(
+      {kWorkers, kQueueLength, kBatch, kArgBytes, kCost, kInFlight});
+  const std::vector<std::vector<int64_t>> sweeps = {
+      {1, 2, 4, 8, 16},          {10, 100, 1000},   {1, 10, 100},
+      {64, 1024, 16384, 131072}, {0, 1000, 100000}, {1, 8, 32}};
+  const std::vector<int64_t> baseline(std::begin(kBaseline),
+                                      std::end(kBaseline));
+  benchmark->Args(baseline);
+  for (size_t i = 0; i < sweeps.size(); i++) {
+    for (int64_t value : sweeps[i]) {
+      if (value == baseline[i]) {
+        continue;
+      }
+      std::vector<int64_t> args = baseline;
+      args[i] = value;
+      benchmark->Args(args);
+    }
+  }
+  benchmark->UseRealTime();
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+// Same as the baseline of DispatchArguments with many small batches in
+// flight, followed by the coalescing window in microseconds.
+void CoalescingArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({kWorkers, kQueueLength, kBatch, kArgBytes, kCost,
+                       kInFlight, "window_us"});
+  for (int batch : {1, 10}) {
+    for (int window_us : {0, 100, 500, 2000}) {
+      benchmark->Args({kBaseline[0], kBaseline[1], batch, kBaseline[3],
+                       kBaseline[4], /*in_flight=*/32, window_us});
+    }
+  }
+  benchmark->UseRealTime();
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK(BM_V8DispatcherBatchExecute)->Apply(DispatchArguments);
+BENCHMARK(BM_CodeDispatchClientBatchExecute)->Apply(DispatchArguments);
+BENCHMARK(BM_CodeDispatchClientCoalescing)->Apply(CoalescingArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -14,14 +14,393 @@
 
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <utility>
 
 #include "glog/logging.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+CodeDispatchClient::CodeDispatchClient(const V8Dispatcher& dispatcher,
+                                       DispatchCoalescingConfig coalescing,
+                                       DispatchStats* stats)
+    : CodeDispatchClient(dispatcher, coalescing, DispatchSchedulingConfig{},
+                         stats) {}
+
+CodeDispatchClient::CodeDispatchClient(const V8Dispatcher& dispatcher,
+                                       DispatchCoalescingConfig coalescing,
+                                       DispatchSchedulingConfig scheduling,
+                                       DispatchStats* stats)
+    : dispatcher_(dispatcher),
+      stats_(stats),
+      coalescing_(coalescing),
+      scheduling_(scheduling) {
+  if (scheduling_.max_in_flight <= 0 &&
+      coalescing_.window > absl::ZeroDuration() &&
+      coalescing_.max_batch_size > 1) {
+    coalescing_thread_ = std::thread([this]() { CoalescingLoop(); });
+  }
+}
+
+CodeDispatchClient::~CodeDispatchClient() {
+  if (coalescing_thread_.joinable()) {
+    {
+      absl::MutexLock lock(&coalescing_mu_);
+      shutdown_ = true;
+    }
+    coalescing_thread_.join();
+  }
+  absl::MutexLock lock(&scheduling_mu_);
+  auto idle = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(scheduling_mu_) {
+    return scheduled_.empty() && !dispatching_scheduled_;
+  };
+  scheduling_mu_.Await(absl::Condition(&idle));
+}
+
 absl::Status CodeDispatchClient::BatchExecute(
     std::vector<DispatchRequest>& batch,
     BatchDispatchDoneCallback batch_callback) const {
-  return dispatcher_.BatchExecute(batch, std::move(batch_callback));
+  if (scheduling_.max_in_flight > 0) {
+    Schedule(batch, absl::InfiniteFuture(), std::move(batch_callback));
+    return absl::OkStatus();
+  }
+  if (coalescing_thread_.joinable() &&
+      batch.size() < static_cast<size_t>(coalescing_.max_batch_size)) {
+    Coalesce(batch, std::move(batch_callback));
+    return absl::OkStatus();
+  }
+  return Dispatch(batch, std::move(batch_callback));
+}
+
+int CodeDispatchClient::CodeVersion(absl::string_view experiment_id) const {
+  if (!experiment_id.empty()) {
+    if (int version = dispatcher_.ExperimentVersion(experiment_id);
+        version > 0) {
+      return version;
+    }
+  }
+  return dispatcher_.CurrentVersion();
+}
+
+absl::Status CodeDispatchClient::Dispatch(
+    std::vector<DispatchRequest>& batch,
+    BatchDispatchDoneCallback batch_callback) const {
+  // Requests run on the version of their code experiment when it is loaded,
+  // and on the latest version loaded by LoadNextVersionSync otherwise.
+  const int current_version = dispatcher_.CurrentVersion();
+  // Requests of a batch usually share their experiment, which is looked up
+  // once.
+  absl::string_view experiment_id;
+  int experiment_version = 0;
+  for (auto& request : batch) {
+    if (auto it = request.tags.find(kCodeExperimentTag);
+        it != request.tags.end()) {
+      if (it->second != experiment_id) {
+        experiment_id = it->second;
+        experiment_version = dispatcher_.ExperimentVersion(experiment_id);
+      }
+      if (experiment_version > 0) {
+        request.version_num = experiment_version;
+        continue;
+      }
+    }
+    if (current_version > 0) {
+      request.version_num = current_version;
+    }
+  }
+  const int64_t batch_size = batch.size();
+  const int64_t pending_ahead = stats_->OnBatchScheduled(batch_size);
+  absl::Status status = dispatcher_.BatchExecute(
+      batch, [this, batch_size, pending_ahead, start = absl::Now(),
+              batch_callback = std::move(batch_callback)](
+                 const std::vector<absl::StatusOr<DispatchResponse>>& output) {
+        stats_->OnBatchDone(batch_size, pending_ahead, absl::Now() - start);
+        batch_callback(output);
+      });
+  if (!status.ok()) {
+    stats_->OnBatchNotScheduled(batch_size);
+  }
+  return status;
+}
+
+void CodeDispatchClient::Coalesce(const std::vector<DispatchRequest>& batch,
+                                  BatchDispatchDoneCallback batch_callback)
+    const {
+  CoalescedBatch full_batch;
+  {
+    absl::MutexLock lock(&coalescing_mu_);
+    if (coalesced_.requests.empty()) {
+      coalesced_.dispatch_time = absl::Now() + coalescing_.window;
+    }
+    // The requests are copied, since callers may still read their batch.
+    coalesced_.requests.insert(coalesced_.requests.end(), batch.begin(),
+                               batch.end());
+    coalesced_.callbacks.emplace_back(batch.size(), std::move(batch_callback));
+    if (coalesced_.requests.size() <
+        static_cast<size_t>(coalescing_.max_batch_size)) {
+      return;
+    }
+    full_batch = std::exchange(coalesced_, {});
+    ++coalesced_generation_;
+  }
+  DispatchCoalesced(std::move(full_batch));
+}
+
+void CodeDispatchClient::DispatchCoalesced(CoalescedBatch batch) const {
+  VLOG(3) << "Dispatching " << batch.requests.size() << " requests of "
+          << batch.callbacks.size() << " calls together";
+  auto callbacks =
+      std::make_shared<decltype(batch.callbacks)>(std::move(batch.callbacks));
+  absl::Status status = Dispatch(
+      batch.requests,
+      [callbacks](const std::vector<absl::StatusOr<DispatchResponse>>& output) {
+        // Roma returns the responses in the order of the requests.
+        auto begin = output.begin();
+        for (auto& [size, callback] : *callbacks) {
+          const size_t available = std::min<size_t>(size, output.end() - begin);
+          std::vector<absl::StatusOr<DispatchResponse>> responses(
+              begin, begin + available);
+          responses.resize(size, absl::InternalError("Missing response"));
+          begin += available;
+          callback(responses);
+        }
+      });
+  if (!status.ok()) {
+    for (auto& [size, callback] : *callbacks) {
+      callback(std::vector<absl::StatusOr<DispatchResponse>>(size, status));
+    }
+  }
+}
+
+void CodeDispatchClient::CoalescingLoop() {
+  auto has_requests_or_shutdown = [this]()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(coalescing_mu_) {
+        return shutdown_ || !coalesced_.requests.empty();
+      };
+  absl::MutexLock lock(&coalescing_mu_);
+  while (true) {
+    coalescing_mu_.Await(absl::Condition(&has_requests_or_shutdown));
+    if (coalesced_.requests.empty()) {
+      return;
+    }
+    const int64_t generation = coalesced_generation_;
+    auto dispatched_or_shutdown = [this, generation]()
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(coalescing_mu_) {
+          return shutdown_ || coalesced_generation_ != generation;
+        };
+    coalescing_mu_.AwaitWithDeadline(
+        absl::Condition(&dispatched_or_shutdown), coalesced_.dispatch_time);
+    if (coalesced_generation_ != generation) {
+      // A call filled the batch and dispatched it.
+      continue;
+    }
+    CoalescedBatch batch = std::exchange(coalesced_, {});
+    ++coalesced_generation_;
+    coalescing_mu_.Unlock();
+    DispatchCoalesced(std::move(batch));
+    coalescing_mu_.Lock();
+  }
+}
+
+absl::Status CodeDispatchClient::TryBatchExecute(
+    std::vector<DispatchRequest>& batch, absl::Duration budget,
+    BatchDispatchDoneCallback batch_callback,
+    CancellationToken* cancellation) const {
+  if (cancellation != nullptr && cancellation->IsCancelled()) {
+    RecordCancelledWork(CancelledWork::kDispatch, batch.size());
+    return absl::CancelledError("Request cancelled before dispatch");
+  }
+  if (const absl::Duration queueing_time = stats_->ProjectedQueueingTime();
+      queueing_time > budget) {
+    VLOG(2) << "Rejecting batch of " << batch.size()
+            << " requests projected to wait for " << queueing_time;
+    stats_->OnBatchRejected(batch.size());
+    return absl::ResourceExhaustedError(kProjectedQueueingTimeExceedsBudget);
+  }
+  if (scheduling_.max_in_flight > 0) {
+    Schedule(batch, absl::Now() + budget, std::move(batch_callback),
+             cancellation);
+    return absl::OkStatus();
+  }
+  return BatchExecute(batch, std::move(batch_callback));
+}
+
+void CodeDispatchClient::Schedule(const std::vector<DispatchRequest>& batch,
+                                  absl::Time deadline,
+                                  BatchDispatchDoneCallback batch_callback,
+                                  CancellationToken* cancellation) const {
+  if (batch.empty()) {
+    batch_callback({});
+    return;
+  }
+  auto call = std::make_unique<ScheduledCall>();
+  // The requests are copied, since callers may still read their batch.
+  call->requests = batch;
+  call->responses.resize(batch.size(), absl::InternalError("Missing response"));
+  call->callback = std::move(batch_callback);
+  call->cancellation = cancellation;
+  RequestClass request_class = RequestClass::kStandard;
+  if (auto it = batch.front().tags.find(kRequestClassTag);
+      it != batch.front().tags.end()) {
+    request_class = ParseRequestClass(it->second);
+  }
+  {
+    absl::MutexLock lock(&scheduling_mu_);
+    scheduled_waiting_ += batch.size();
+    scheduled_.emplace(
+        ScheduleKey(request_class, deadline, scheduled_sequence_++),
+        std::move(call));
+    if (!StartDispatchingScheduled()) {
+      return;
+    }
+  }
+  DispatchScheduled();
+}
+
+bool CodeDispatchClient::StartDispatchingScheduled() const {
+  if (dispatching_scheduled_ || scheduled_.empty()) {
+    return false;
+  }
+  dispatching_scheduled_ = true;
+  return true;
+}
+
+std::vector<CodeDispatchClient::ScheduledChunk>
+CodeDispatchClient::TakeScheduledChunks(
+    std::vector<std::vector<DispatchRequest>>& requests) const {
+  std::vector<ScheduledChunk> chunks;
+  const absl::Time now = absl::Now();
+  int room = scheduling_.max_in_flight - scheduled_in_flight_;
+  for (auto& [key, call] : scheduled_) {
+    const int left = call->requests.size() - call->next;
+    if (left == 0) {
+      continue;
+    }
+    ScheduledChunk chunk{.key = key, .begin = call->next};
+    chunk.cancelled =
+        call->cancellation != nullptr && call->cancellation->IsCancelled();
+    if (std::get<absl::Time>(key) < now || chunk.cancelled) {
+      // Take no worker, as they fail right away.
+      chunk.size = left;
+      chunk.expired = true;
+    } else {
+      const int call_room = scheduling_.max_in_flight_per_call > 0
+                                ? scheduling_.max_in_flight_per_call -
+                                      call->in_flight
+                                : room;
+      chunk.size = std::min({left, room, call_room});
+      if (chunk.size <= 0) {
+        continue;
+      }
+      call->in_flight += chunk.size;
+      scheduled_in_flight_ += chunk.size;
+      room -= chunk.size;
+    }
+    auto begin = call->requests.begin() + chunk.begin;
+    requests.emplace_back(std::make_move_iterator(begin),
+                          std::make_move_iterator(begin + chunk.size));
+    call->next += chunk.size;
+    scheduled_waiting_ -= chunk.size;
+    chunks.push_back(chunk);
+  }
+  return chunks;
+}
+
+void CodeDispatchClient::DispatchScheduled() const {
+  while (true) {
+    std::vector<std::vector<DispatchRequest>> requests;
+    std::vector<ScheduledChunk> chunks;
+    {
+      absl::MutexLock lock(&scheduling_mu_);
+      chunks = TakeScheduledChunks(requests);
+      if (chunks.empty()) {
+        dispatching_scheduled_ = false;
+        return;
+      }
+    }
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      const ScheduledChunk& chunk = chunks[i];
+      if (chunk.cancelled) {
+        RecordCancelledWork(CancelledWork::kDispatch, chunk.size);
+        OnScheduledChunkDone(
+            chunk, std::vector<absl::StatusOr<DispatchResponse>>(
+                       chunk.size, absl::CancelledError(
+                                       "Request cancelled before a worker "
+                                       "was free")));
+        continue;
+      }
+      if (chunk.expired) {
+        OnScheduledChunkDone(
+            chunk, std::vector<absl::StatusOr<DispatchResponse>>(
+                       chunk.size, absl::DeadlineExceededError(
+                                       "Deadline passed before a worker was "
+                                       "free")));
+        continue;
+      }
+      absl::Status status = Dispatch(
+          requests[i],
+          [this, chunk](
+              const std::vector<absl::StatusOr<DispatchResponse>>& output) {
+            OnScheduledChunkDone(chunk, output);
+          });
+      if (!status.ok()) {
+        OnScheduledChunkDone(
+            chunk,
+            std::vector<absl::StatusOr<DispatchResponse>>(chunk.size, status));
+      }
+    }
+  }
+}
+
+void CodeDispatchClient::OnScheduledChunkDone(
+    const ScheduledChunk& chunk,
+    const std::vector<absl::StatusOr<DispatchResponse>>& output) const {
+  BatchDispatchDoneCallback callback;
+  std::vector<absl::StatusOr<DispatchResponse>> responses;
+  bool dispatch = false;
+  {
+    absl::MutexLock lock(&scheduling_mu_);
+    auto it = scheduled_.find(chunk.key);
+    ScheduledCall& call = *it->second;
+    // Roma returns the responses in the order of the requests.
+    const int available = std::min<int>(chunk.size, output.size());
+    std::copy(output.begin(), output.begin() + available,
+              call.responses.begin() + chunk.begin);
+    if (!chunk.expired) {
+      call.in_flight -= chunk.size;
+      scheduled_in_flight_ -= chunk.size;
+    }
+    call.done += chunk.size;
+    if (call.done == static_cast<int>(call.requests.size())) {
+      callback = std::move(call.callback);
+      responses = std::move(call.responses);
+    }
+    dispatch = StartDispatchingScheduled();
+  }
+  if (dispatch) {
+    DispatchScheduled();
+  }
+  if (!callback) {
+    return;
+  }
+  callback(responses);
+  // Erased only once called back, as the destructor waits for the calls,
+  // whose callbacks count the pending requests of the client.
+  absl::MutexLock lock(&scheduling_mu_);
+  scheduled_.erase(chunk.key);
+}
+
+int64_t CodeDispatchClient::PendingRequests() const {
+  int64_t pending_requests = stats_->PendingRequests();
+  if (coalescing_thread_.joinable()) {
+    absl::MutexLock lock(&coalescing_mu_);
+    pending_requests += coalesced_.requests.size();
+  }
+  if (scheduling_.max_in_flight > 0) {
+    absl::MutexLock lock(&scheduling_mu_);
+    pending_requests += scheduled_waiting_;
+  }
+  return pending_requests;
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -15,22 +15,91 @@
 #ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_CODE_DISPATCH_CLIENT_H_
 #define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_CODE_DISPATCH_CLIENT_H_
 
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <thread>
+#include <tuple>
+#include <utility>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/functional/any_invocable.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "cc/roma/interface/roma.h"
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
 #include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/request_class.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+inline constexpr absl::string_view kProjectedQueueingTimeExceedsBudget =
+    "Projected queueing time of the code dispatcher exceeds the budget";
+
+// Tag of the requests to run on the code version loaded for a code experiment
+// by V8Dispatcher::LoadExperimentVersionSync, whose value is the experiment
+// id. Requests of experiments without a loaded version run on the current
+// version.
+inline constexpr char kCodeExperimentTag[] = "CodeExperiment";
+
+// Options of the coalescing of the batches of concurrent BatchExecute calls
+// into a single Roma batch, which saves the fixed cost of a batch when many
+// requests dispatch a few items each.
+struct DispatchCoalescingConfig {
+  // Longest time a batch waits for the batches of other calls before being
+  // dispatched. Batches are dispatched as they come when zero.
+  absl::Duration window = absl::ZeroDuration();
+  // Coalesced batches are dispatched as soon as they have this many requests.
+  // Batches at least this large are dispatched on their own.
+  int max_batch_size = 0;
+};
+
+// Options of the scheduling of the requests of concurrent BatchExecute calls
+// earliest deadline first, so that a large batch does not hold all the
+// workers while the requests of smaller batches near their deadline. The
+// requests are held by the client and dispatched to Roma as workers free up,
+// rather than queued by Roma in the order they come. The calls of a higher
+// RequestClass, per the kRequestClassTag of their first request, go first.
+struct DispatchSchedulingConfig {
+  // Most requests dispatched to Roma at once, usually a small multiple of the
+  // number of workers. Requests are dispatched as they come when 0.
+  int max_in_flight = 0;
+  // Most requests of a single call dispatched to Roma at once, so that the
+  // calls sharing the workers progress together. No limit when 0.
+  int max_in_flight_per_call = 0;
+};
+
 // This class acts as a client for dispatching javascript + wasm to be
 // executed in a different process sandbox.
 class CodeDispatchClient {
  public:
-  explicit CodeDispatchClient(const V8Dispatcher& dispatcher)
-      : dispatcher_(dispatcher) {}
+  // stats: records the batches dispatched through this client. Defaults to
+  // the statistics of the process, which are exported as metrics.
+  explicit CodeDispatchClient(const V8Dispatcher& dispatcher,
+                              DispatchStats* stats = &DispatchStats::Get())
+      : dispatcher_(dispatcher), stats_(stats) {}
+
+  // Coalesces the batches of concurrent BatchExecute calls as configured by
+  // coalescing.
+  CodeDispatchClient(const V8Dispatcher& dispatcher,
+                     DispatchCoalescingConfig coalescing,
+                     DispatchStats* stats = &DispatchStats::Get());
+
+  // Schedules the requests of concurrent BatchExecute calls as configured by
+  // scheduling, which takes over from coalescing when enabled.
+  CodeDispatchClient(const V8Dispatcher& dispatcher,
+                     DispatchCoalescingConfig coalescing,
+                     DispatchSchedulingConfig scheduling,
+                     DispatchStats* stats = &DispatchStats::Get());
+
+  // Dispatches the batches still being coalesced, and waits for the requests
+  // still being scheduled.
+  virtual ~CodeDispatchClient();
 
   // Execute a batch of requests asynchronously via the code dispatcher library.
   // There are no guarantees on request order processing.
@@ -39,13 +108,142 @@ class CodeDispatchClient {
   // batch_callback: called when all requests in the batch are finished.
   // return: a status indicating if the execution request was properly
   // scheduled. This should not be confused with the output of the execution
-  // itself, which is sent to batch_callback.
+  // itself, which is sent to batch_callback. The version_num of the requests
+  // is replaced with the version of their kCodeExperimentTag, or else the
+  // current version of the dispatcher, if any.
+  // When coalescing is enabled, the batch may be dispatched together with the
+  // batches of other calls, and a failure to schedule the coalesced batch is
+  // reported to batch_callback as an error for each request. The same holds
+  // for the requests of the batch when scheduling is enabled, which are
+  // dispatched after those of calls with a deadline.
   virtual absl::Status BatchExecute(
       std::vector<DispatchRequest>& batch,
       BatchDispatchDoneCallback batch_callback) const;
 
+  // Same as BatchExecute, unless the requests are projected to wait for a
+  // worker for longer than budget. In that case nothing is scheduled and a
+  // RESOURCE_EXHAUSTED status is returned, as when Roma fails to schedule
+  // requests because its queues are full, so that callers can tell overload
+  // apart from other failures by the status code.
+  // When scheduling is enabled, the requests are due by the end of budget,
+  // and the ones still waiting for a worker then fail with DEADLINE_EXCEEDED.
+  // Once cancellation, if set, is cancelled, nothing is scheduled and a
+  // CANCELLED status is returned, and the scheduled requests still waiting
+  // for a worker fail with CANCELLED. It must outlive the call.
+  absl::Status TryBatchExecute(std::vector<DispatchRequest>& batch,
+                               absl::Duration budget,
+                               BatchDispatchDoneCallback batch_callback,
+                               CancellationToken* cancellation = nullptr) const;
+
+  // Returns the number of requests scheduled through BatchExecute whose batch
+  // has not finished yet, as an estimate of the dispatcher queue depth: the
+  // requests pending in Roma, as counted by the DispatchStats of the client,
+  // and the ones the client holds to coalesce or schedule them.
+  virtual int64_t PendingRequests() const;
+
+  // Returns the version of the code the requests of the code experiment run
+  // on, as BatchExecute resolves it, or the current version for an empty
+  // experiment_id. Every load changes it, 0 until the first one.
+  virtual int CodeVersion(absl::string_view experiment_id) const;
+
  private:
+  // Requests of concurrent BatchExecute calls to be dispatched together.
+  struct CoalescedBatch {
+    std::vector<DispatchRequest> requests;
+    // Number of requests and callback of each call, in the order of requests.
+    std::vector<std::pair<size_t, BatchDispatchDoneCallback>> callbacks;
+    absl::Time dispatch_time;
+  };
+
+  // Requests of a BatchExecute call held by the scheduler, keyed by their
+  // request class, their deadline and the order of the calls.
+  struct ScheduledCall {
+    std::vector<DispatchRequest> requests;
+    std::vector<absl::StatusOr<DispatchResponse>> responses;
+    BatchDispatchDoneCallback callback;
+    CancellationToken* cancellation = nullptr;
+    // Index of the first request not dispatched yet.
+    int next = 0;
+    int in_flight = 0;
+    int done = 0;
+  };
+  using ScheduleKey = std::tuple<RequestClass, absl::Time, int64_t>;
+
+  // Consecutive requests of a call dispatched to Roma as one batch, or
+  // failed without being dispatched once their deadline passed or their call
+  // was cancelled.
+  struct ScheduledChunk {
+    ScheduleKey key;
+    int begin = 0;
+    int size = 0;
+    bool expired = false;
+    bool cancelled = false;
+  };
+
+  // Dispatches batch to Roma right away.
+  absl::Status Dispatch(std::vector<DispatchRequest>& batch,
+                        BatchDispatchDoneCallback batch_callback) const;
+
+  // Adds batch to the coalesced batch, dispatching it if it is full.
+  void Coalesce(const std::vector<DispatchRequest>& batch,
+                BatchDispatchDoneCallback batch_callback) const
+      ABSL_LOCKS_EXCLUDED(coalescing_mu_);
+
+  // Dispatches batch and routes the responses back to each call.
+  void DispatchCoalesced(CoalescedBatch batch) const;
+
+  // Dispatches the coalesced batches when their window ends.
+  void CoalescingLoop() ABSL_LOCKS_EXCLUDED(coalescing_mu_);
+
+  // Adds batch to the scheduled calls, due by deadline, and dispatches the
+  // requests the workers have room for.
+  void Schedule(const std::vector<DispatchRequest>& batch, absl::Time deadline,
+                BatchDispatchDoneCallback batch_callback,
+                CancellationToken* cancellation = nullptr) const
+      ABSL_LOCKS_EXCLUDED(scheduling_mu_);
+
+  // Returns whether the calling thread is to dispatch the scheduled
+  // requests, as no other thread is. Only one thread dispatches at a time,
+  // the others leaving their requests to it.
+  bool StartDispatchingScheduled() const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(scheduling_mu_);
+
+  // Takes the requests to dispatch, earliest deadline first, up to the room
+  // of the workers and of each call, moving them to requests.
+  std::vector<ScheduledChunk> TakeScheduledChunks(
+      std::vector<std::vector<DispatchRequest>>& requests) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(scheduling_mu_);
+
+  // Dispatches the requests the workers have room for, until none is left.
+  // Run by the thread StartDispatchingScheduled picked.
+  void DispatchScheduled() const ABSL_LOCKS_EXCLUDED(scheduling_mu_);
+
+  // Records the responses of the chunk, and calls back its call if done.
+  void OnScheduledChunkDone(
+      const ScheduledChunk& chunk,
+      const std::vector<absl::StatusOr<DispatchResponse>>& output) const
+      ABSL_LOCKS_EXCLUDED(scheduling_mu_);
+
   const V8Dispatcher& dispatcher_;
+  DispatchStats* stats_;
+
+  const DispatchCoalescingConfig coalescing_;
+  mutable absl::Mutex coalescing_mu_;
+  mutable CoalescedBatch coalesced_ ABSL_GUARDED_BY(coalescing_mu_);
+  // Incremented every time coalesced_ is dispatched.
+  mutable int64_t coalesced_generation_ ABSL_GUARDED_BY(coalescing_mu_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(coalescing_mu_) = false;
+  std::thread coalescing_thread_;
+
+  const DispatchSchedulingConfig scheduling_;
+  mutable absl::Mutex scheduling_mu_;
+  mutable std::map<ScheduleKey, std::unique_ptr<ScheduledCall>> scheduled_
+      ABSL_GUARDED_BY(scheduling_mu_);
+  mutable int64_t scheduled_sequence_ ABSL_GUARDED_BY(scheduling_mu_) = 0;
+  mutable int scheduled_in_flight_ ABSL_GUARDED_BY(scheduling_mu_) = 0;
+  // Requests held by the scheduler that are not dispatched yet.
+  mutable int64_t scheduled_waiting_ ABSL_GUARDED_BY(scheduling_mu_) = 0;
+  mutable bool dispatching_scheduled_ ABSL_GUARDED_BY(scheduling_mu_) = false;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -14,11 +14,18 @@
 
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
 
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
+#include "services/common/util/cancellation_token.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
@@ -47,5 +54,563 @@ TEST(CodeDispatchClient, DelegatesToCodeDispatchLibrary) {
   done.Wait();
 }
 
+TEST(CodeDispatchClient, CountsPendingRequestsUntilBatchIsDone) {
+  MockV8Dispatcher dispatcher;
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"},
+                                        DispatchRequest{"bar"}};
+  BatchDispatchDoneCallback pending_callback;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&pending_callback](std::vector<DispatchRequest>& batch,
+                                    BatchDispatchDoneCallback batch_callback) {
+        pending_callback = std::move(batch_callback);
+        return absl::OkStatus();
+      })
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        return absl::ResourceExhaustedError("Queue is full");
+      });
+  CodeDispatchClient client(dispatcher);
+
+  EXPECT_TRUE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_EQ(client.PendingRequests(), 2);
+  EXPECT_FALSE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_EQ(client.PendingRequests(), 2);
+  pending_callback({});
+  EXPECT_EQ(client.PendingRequests(), 0);
+}
+
+TEST(CodeDispatchClient, DispatchesToLatestLoadedVersion) {
+  MockV8Dispatcher dispatcher;
+  std::vector<int> loaded_versions;
+  EXPECT_CALL(dispatcher, LoadSync)
+      .Times(2)
+      .WillRepeatedly([&loaded_versions](int version, absl::string_view js) {
+        loaded_versions.push_back(version);
+        return absl::OkStatus();
+      });
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillRepeatedly([](std::vector<DispatchRequest>& batch,
+                         BatchDispatchDoneCallback batch_callback) {
+        for (const auto& request : batch) {
+          EXPECT_EQ(request.version_num, 2);
+        }
+        batch_callback({});
+        return absl::OkStatus();
+      });
+  CodeDispatchClient client(dispatcher);
+  EXPECT_EQ(dispatcher.CurrentVersion(), 0);
+
+  std::vector<DispatchRequest> warm_up_requests{DispatchRequest{"warm_up"}};
+  EXPECT_TRUE(
+      dispatcher.LoadNextVersionSync("v1", {}, absl::Milliseconds(10)).ok());
+  EXPECT_TRUE(dispatcher
+                  .LoadNextVersionSync("v2", warm_up_requests,
+                                       absl::Milliseconds(10))
+                  .ok());
+  EXPECT_EQ(loaded_versions, std::vector<int>({1, 2}));
+  EXPECT_EQ(dispatcher.CurrentVersion(), 2);
+
+  DispatchRequest request{"foo"};
+  request.version_num = 1;
+  std::vector<DispatchRequest> requests{request};
+  EXPECT_TRUE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+}
+
+TEST(CodeDispatchClient, DispatchesToVersionOfCodeExperiment) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, LoadSync)
+      .Times(3)
+      .WillRepeatedly(testing::Return(absl::OkStatus()));
+  absl::flat_hash_map<std::string, int> dispatched_versions;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&dispatched_versions](std::vector<DispatchRequest>& batch,
+                                       BatchDispatchDoneCallback callback) {
+        for (const auto& request : batch) {
+          dispatched_versions[request.id] = request.version_num;
+        }
+        callback({});
+        return absl::OkStatus();
+      });
+  CodeDispatchClient client(dispatcher);
+
+  ASSERT_TRUE(
+      dispatcher.LoadNextVersionSync("default", {}, absl::Milliseconds(10))
+          .ok());
+  ASSERT_TRUE(dispatcher
+                  .LoadExperimentVersionSync("experiment", "v1", {},
+                                             absl::Milliseconds(10))
+                  .ok());
+  ASSERT_TRUE(dispatcher
+                  .LoadExperimentVersionSync("experiment", "v2", {},
+                                             absl::Milliseconds(10))
+                  .ok());
+  EXPECT_EQ(dispatcher.CurrentVersion(), 1);
+  EXPECT_EQ(dispatcher.ExperimentVersion("experiment"), 3);
+  EXPECT_EQ(dispatcher.ExperimentVersion("unknown"), 0);
+
+  DispatchRequest experiment_request{"experiment"};
+  experiment_request.tags[kCodeExperimentTag] = "experiment";
+  DispatchRequest unknown_experiment_request{"unknown"};
+  unknown_experiment_request.tags[kCodeExperimentTag] = "unknown";
+  std::vector<DispatchRequest> requests{DispatchRequest{"default"},
+                                        experiment_request,
+                                        unknown_experiment_request};
+  EXPECT_TRUE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_THAT(dispatched_versions,
+              testing::UnorderedElementsAre(testing::Pair("default", 1),
+                                            testing::Pair("experiment", 3),
+                                            testing::Pair("unknown", 1)));
+}
+
+TEST(CodeDispatchClient, ReusesTheVersionsNoLongerRouted) {
+  MockV8Dispatcher dispatcher;
+  std::vector<int> loaded_versions;
+  EXPECT_CALL(dispatcher, LoadSync)
+      .WillRepeatedly([&loaded_versions](int version, absl::string_view js) {
+        loaded_versions.push_back(version);
+        return absl::OkStatus();
+      });
+  dispatcher.SetMaxCodeVersions(3);
+
+  ASSERT_TRUE(
+      dispatcher.LoadNextVersionSync("default", {}, absl::Milliseconds(10))
+          .ok());
+  ASSERT_TRUE(dispatcher
+                  .LoadExperimentVersionSync("experiment", "v1", {},
+                                             absl::Milliseconds(10))
+                  .ok());
+  ASSERT_TRUE(dispatcher
+                  .LoadExperimentVersionSync("experiment", "v2", {},
+                                             absl::Milliseconds(10))
+                  .ok());
+  ASSERT_TRUE(
+      dispatcher.LoadNextVersionSync("default 2", {}, absl::Milliseconds(10))
+          .ok());
+  ASSERT_TRUE(dispatcher
+                  .LoadExperimentVersionSync("experiment", "v3", {},
+                                             absl::Milliseconds(10))
+                  .ok());
+
+  EXPECT_THAT(loaded_versions, testing::ElementsAre(1, 2, 3, 2, 1));
+  EXPECT_EQ(dispatcher.CurrentVersion(), 2);
+  EXPECT_EQ(dispatcher.ExperimentVersion("experiment"), 1);
+}
+
+TEST(CodeDispatchClient, FailsToLoadWhenEveryVersionIsRouted) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, LoadSync)
+      .Times(2)
+      .WillRepeatedly(testing::Return(absl::OkStatus()));
+  dispatcher.SetMaxCodeVersions(2);
+
+  ASSERT_TRUE(
+      dispatcher.LoadNextVersionSync("default", {}, absl::Milliseconds(10))
+          .ok());
+  ASSERT_TRUE(dispatcher
+                  .LoadExperimentVersionSync("experiment", "v1", {},
+                                             absl::Milliseconds(10))
+                  .ok());
+
+  EXPECT_EQ(dispatcher
+                .LoadExperimentVersionSync("experiment", "v2", {},
+                                           absl::Milliseconds(10))
+                .code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(dispatcher.CurrentVersion(), 1);
+  EXPECT_EQ(dispatcher.ExperimentVersion("experiment"), 2);
+}
+
+TEST(CodeDispatchClient, RecordsBatchesInDispatchStats) {
+  MockV8Dispatcher dispatcher;
+  BatchDispatchDoneCallback pending_callback;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&pending_callback](std::vector<DispatchRequest>& batch,
+                                    BatchDispatchDoneCallback batch_callback) {
+        pending_callback = std::move(batch_callback);
+        return absl::OkStatus();
+      });
+  DispatchStats stats;
+  CodeDispatchClient client(dispatcher, &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+
+  EXPECT_TRUE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_EQ(stats.PendingRequests(), 1);
+  pending_callback({});
+  EXPECT_EQ(stats.PendingRequests(), 0);
+  EXPECT_FALSE(stats.ExecutionLatency().empty());
+}
+
+TEST(CodeDispatchClient, RejectsBatchProjectedToExceedBudget) {
+  MockV8Dispatcher dispatcher;
+  std::vector<BatchDispatchDoneCallback> pending_callbacks;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .Times(2)
+      .WillRepeatedly([&pending_callbacks](
+                          std::vector<DispatchRequest>& batch,
+                          BatchDispatchDoneCallback batch_callback) {
+        pending_callbacks.push_back(std::move(batch_callback));
+        return absl::OkStatus();
+      });
+  DispatchStats stats;
+  stats.SetNumWorkers(1);
+  // Requests take 100ms each.
+  stats.OnBatchScheduled(1);
+  stats.OnBatchDone(1, 0, absl::Milliseconds(100));
+  CodeDispatchClient client(dispatcher, &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+
+  // The only worker is idle.
+  EXPECT_TRUE(client
+                  .TryBatchExecute(requests, absl::Milliseconds(50),
+                                   [](const auto& res) {})
+                  .ok());
+  // The new request would wait for the pending one.
+  absl::Status status = client.TryBatchExecute(
+      requests, absl::Milliseconds(50), [](const auto& res) {});
+  EXPECT_EQ(status.code(), absl::StatusCode::kResourceExhausted);
+  EXPECT_EQ(status.message(), kProjectedQueueingTimeExceedsBudget);
+  EXPECT_EQ(client.PendingRequests(), 1);
+  EXPECT_EQ(stats.RejectedRequests()["over budget"], 1);
+  EXPECT_TRUE(client
+                  .TryBatchExecute(requests, absl::Milliseconds(500),
+                                   [](const auto& res) {})
+                  .ok());
+}
+
+// Responds to each request with its id.
+absl::Status EchoBatch(std::vector<DispatchRequest>& batch,
+                       BatchDispatchDoneCallback batch_callback) {
+  std::vector<absl::StatusOr<DispatchResponse>> responses;
+  for (const auto& request : batch) {
+    DispatchResponse response;
+    response.id = request.id;
+    responses.push_back(response);
+  }
+  batch_callback(responses);
+  return absl::OkStatus();
+}
+
+std::vector<std::string> ResponseIds(
+    const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
+  std::vector<std::string> ids;
+  for (const auto& response : responses) {
+    ids.push_back(response.ok() ? response->id : "error");
+  }
+  return ids;
+}
+
+TEST(CodeDispatchClient, CoalescesBatchesUpToMaxBatchSize) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 3);
+        return EchoBatch(batch, std::move(batch_callback));
+      });
+  DispatchStats stats;
+  CodeDispatchClient client(
+      dispatcher, {.window = absl::Minutes(1), .max_batch_size = 3}, &stats);
+  std::vector<DispatchRequest> foo{DispatchRequest{"foo"}};
+  std::vector<DispatchRequest> bar{DispatchRequest{"bar"},
+                                   DispatchRequest{"baz"}};
+  std::vector<std::string> foo_ids;
+  std::vector<std::string> bar_ids;
+
+  EXPECT_TRUE(client
+                  .BatchExecute(foo,
+                                [&foo_ids](const auto& responses) {
+                                  foo_ids = ResponseIds(responses);
+                                })
+                  .ok());
+  EXPECT_EQ(client.PendingRequests(), 1);
+  EXPECT_TRUE(client
+                  .BatchExecute(bar,
+                                [&bar_ids](const auto& responses) {
+                                  bar_ids = ResponseIds(responses);
+                                })
+                  .ok());
+
+  EXPECT_EQ(foo_ids, std::vector<std::string>({"foo"}));
+  EXPECT_EQ(bar_ids, std::vector<std::string>({"bar", "baz"}));
+  EXPECT_EQ(client.PendingRequests(), 0);
+}
+
+TEST(CodeDispatchClient, DispatchesCoalescedBatchWhenWindowEnds) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute).WillOnce(EchoBatch);
+  DispatchStats stats;
+  CodeDispatchClient client(
+      dispatcher, {.window = absl::Milliseconds(5), .max_batch_size = 100},
+      &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+
+  absl::Notification done;
+  EXPECT_TRUE(client
+                  .BatchExecute(requests,
+                                [&done](const auto& responses) {
+                                  EXPECT_EQ(ResponseIds(responses),
+                                            std::vector<std::string>({"foo"}));
+                                  done.Notify();
+                                })
+                  .ok());
+  EXPECT_TRUE(done.WaitForNotificationWithTimeout(absl::Seconds(10)));
+}
+
+TEST(CodeDispatchClient, DispatchesLargeBatchesWithoutCoalescing) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        return absl::ResourceExhaustedError("Queue is full");
+      });
+  DispatchStats stats;
+  CodeDispatchClient client(
+      dispatcher, {.window = absl::Minutes(1), .max_batch_size = 2}, &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"},
+                                        DispatchRequest{"bar"}};
+
+  EXPECT_FALSE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_EQ(client.PendingRequests(), 0);
+}
+
+TEST(CodeDispatchClient, ReportsCoalescedSchedulingFailureToEveryCall) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        return absl::ResourceExhaustedError("Queue is full");
+      });
+  DispatchStats stats;
+  CodeDispatchClient client(
+      dispatcher, {.window = absl::Minutes(1), .max_batch_size = 2}, &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+  int failed_calls = 0;
+  auto callback = [&failed_calls](const auto& responses) {
+    EXPECT_EQ(ResponseIds(responses), std::vector<std::string>({"error"}));
+    ++failed_calls;
+  };
+
+  EXPECT_TRUE(client.BatchExecute(requests, callback).ok());
+  EXPECT_TRUE(client.BatchExecute(requests, callback).ok());
+  EXPECT_EQ(failed_calls, 2);
+  EXPECT_EQ(stats.PendingRequests(), 0);
+}
+
+TEST(CodeDispatchClient, DispatchesCoalescedBatchOnDestruction) {
+  MockV8Dispatcher dispatcher;
+  EXPECT_CALL(dispatcher, BatchExecute).WillOnce(EchoBatch);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+  bool done = false;
+  {
+    DispatchStats stats;
+    CodeDispatchClient client(
+        dispatcher, {.window = absl::Minutes(1), .max_batch_size = 2}, &stats);
+    EXPECT_TRUE(
+        client.BatchExecute(requests, [&done](const auto& res) { done = true; })
+            .ok());
+    EXPECT_FALSE(done);
+  }
+  EXPECT_TRUE(done);
+}
+
+// Holds the batches dispatched to Roma until the test completes them.
+class HeldBatches {
+ public:
+  explicit HeldBatches(MockV8Dispatcher& dispatcher) {
+    EXPECT_CALL(dispatcher, BatchExecute)
+        .WillRepeatedly([this](std::vector<DispatchRequest>& batch,
+                               BatchDispatchDoneCallback batch_callback) {
+          std::vector<std::string> ids;
+          std::vector<absl::StatusOr<DispatchResponse>> responses;
+          for (const auto& request : batch) {
+            ids.push_back(request.id);
+            DispatchResponse response;
+            response.id = request.id;
+            responses.push_back(response);
+          }
+          batches_.push_back(ids);
+          callbacks_.push_back(
+              [responses = std::move(responses),
+               batch_callback = std::move(batch_callback)]() {
+                batch_callback(responses);
+              });
+          return absl::OkStatus();
+        });
+  }
+
+  const std::vector<std::vector<std::string>>& batches() const {
+    return batches_;
+  }
+
+  // Completes the oldest batch still held.
+  void CompleteOldest() {
+    ASSERT_LT(completed_, callbacks_.size());
+    // Completing a batch may dispatch the next one, growing callbacks_.
+    auto callback = std::move(callbacks_[completed_++]);
+    callback();
+  }
+
+ private:
+  std::vector<std::vector<std::string>> batches_;
+  std::vector<absl::AnyInvocable<void()>> callbacks_;
+  int completed_ = 0;
+};
+
+TEST(CodeDispatchClient, SchedulesRequestsEarliestDeadlineFirst) {
+  MockV8Dispatcher dispatcher;
+  HeldBatches held(dispatcher);
+  DispatchStats stats;
+  CodeDispatchClient client(dispatcher, {}, {.max_in_flight = 1}, &stats);
+  std::vector<DispatchRequest> no_deadline{DispatchRequest{"none"}};
+  std::vector<DispatchRequest> late{DispatchRequest{"late"}};
+  std::vector<DispatchRequest> early{DispatchRequest{"early"}};
+  std::vector<std::string> ids;
+  auto callback = [&ids](const auto& responses) {
+    for (const auto& id : ResponseIds(responses)) {
+      ids.push_back(id);
+    }
+  };
+
+  EXPECT_TRUE(client.BatchExecute(no_deadline, callback).ok());
+  EXPECT_TRUE(client.BatchExecute(no_deadline, callback).ok());
+  EXPECT_TRUE(
+      client.TryBatchExecute(late, absl::Minutes(10), callback).ok());
+  EXPECT_TRUE(
+      client.TryBatchExecute(early, absl::Minutes(5), callback).ok());
+  EXPECT_EQ(client.PendingRequests(), 4);
+  for (int i = 0; i < 4; ++i) {
+    held.CompleteOldest();
+  }
+
+  // The first call took the only worker before the others came.
+  EXPECT_EQ(ids, std::vector<std::string>({"none", "early", "late", "none"}));
+  EXPECT_EQ(held.batches().size(), 4);
+  EXPECT_EQ(client.PendingRequests(), 0);
+}
+
+TEST(CodeDispatchClient, SchedulesTheHigherRequestClassesFirst) {
+  MockV8Dispatcher dispatcher;
+  HeldBatches held(dispatcher);
+  DispatchStats stats;
+  CodeDispatchClient client(dispatcher, {}, {.max_in_flight = 1}, &stats);
+  std::vector<DispatchRequest> first{DispatchRequest{"first"}};
+  std::vector<DispatchRequest> low{DispatchRequest{"low"}};
+  low[0].tags[kRequestClassTag] = "low";
+  std::vector<DispatchRequest> standard{DispatchRequest{"standard"}};
+  std::vector<DispatchRequest> premium{DispatchRequest{"premium"}};
+  premium[0].tags[kRequestClassTag] = "premium";
+  std::vector<std::string> ids;
+  auto callback = [&ids](const auto& responses) {
+    for (const auto& id : ResponseIds(responses)) {
+      ids.push_back(id);
+    }
+  };
+
+  EXPECT_TRUE(client.BatchExecute(first, callback).ok());
+  EXPECT_TRUE(client.TryBatchExecute(low, absl::Minutes(1), callback).ok());
+  EXPECT_TRUE(
+      client.TryBatchExecute(standard, absl::Minutes(5), callback).ok());
+  EXPECT_TRUE(
+      client.TryBatchExecute(premium, absl::Minutes(10), callback).ok());
+  for (int i = 0; i < 4; ++i) {
+    held.CompleteOldest();
+  }
+
+  // Ahead of the earlier deadlines of the classes below.
+  EXPECT_EQ(ids, std::vector<std::string>(
+                     {"first", "premium", "standard", "low"}));
+}
+
+TEST(CodeDispatchClient, CapsTheRequestsOfACallInFlight) {
+  MockV8Dispatcher dispatcher;
+  HeldBatches held(dispatcher);
+  DispatchStats stats;
+  CodeDispatchClient client(
+      dispatcher, {}, {.max_in_flight = 4, .max_in_flight_per_call = 2},
+      &stats);
+  std::vector<DispatchRequest> large{DispatchRequest{"a"}, DispatchRequest{"b"},
+                                     DispatchRequest{"c"}};
+  std::vector<DispatchRequest> small{DispatchRequest{"d"}};
+  std::vector<std::string> large_ids;
+
+  EXPECT_TRUE(client
+                  .BatchExecute(large,
+                                [&large_ids](const auto& responses) {
+                                  large_ids = ResponseIds(responses);
+                                })
+                  .ok());
+  EXPECT_TRUE(client.BatchExecute(small, [](const auto& res) {}).ok());
+  ASSERT_EQ(held.batches().size(), 2);
+  EXPECT_EQ(held.batches()[0], std::vector<std::string>({"a", "b"}));
+  EXPECT_EQ(held.batches()[1], std::vector<std::string>({"d"}));
+
+  held.CompleteOldest();
+  ASSERT_EQ(held.batches().size(), 3);
+  EXPECT_EQ(held.batches()[2], std::vector<std::string>({"c"}));
+  held.CompleteOldest();
+  held.CompleteOldest();
+  // The responses are in the order of the requests of the call.
+  EXPECT_EQ(large_ids, std::vector<std::string>({"a", "b", "c"}));
+}
+
+TEST(CodeDispatchClient, FailsScheduledRequestsPastTheirDeadline) {
+  MockV8Dispatcher dispatcher;
+  HeldBatches held(dispatcher);
+  DispatchStats stats;
+  CodeDispatchClient client(dispatcher, {}, {.max_in_flight = 1}, &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+  std::vector<absl::StatusOr<DispatchResponse>> expired_responses;
+
+  EXPECT_TRUE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_TRUE(client
+                  .TryBatchExecute(requests, absl::Milliseconds(1),
+                                   [&expired_responses](const auto& res) {
+                                     expired_responses = res;
+                                   })
+                  .ok());
+  absl::SleepFor(absl::Milliseconds(5));
+  held.CompleteOldest();
+
+  ASSERT_EQ(expired_responses.size(), 1);
+  EXPECT_EQ(expired_responses[0].status().code(),
+            absl::StatusCode::kDeadlineExceeded);
+  EXPECT_EQ(held.batches().size(), 1);
+  EXPECT_EQ(client.PendingRequests(), 0);
+}
+
+TEST(CodeDispatchClient, DropsTheScheduledRequestsOfCancelledCalls) {
+  MockV8Dispatcher dispatcher;
+  HeldBatches held(dispatcher);
+  DispatchStats stats;
+  CodeDispatchClient client(dispatcher, {}, {.max_in_flight = 1}, &stats);
+  std::vector<DispatchRequest> requests{DispatchRequest{"foo"}};
+  std::vector<absl::StatusOr<DispatchResponse>> cancelled_responses;
+  CancellationToken cancellation;
+
+  EXPECT_TRUE(client.BatchExecute(requests, [](const auto& res) {}).ok());
+  EXPECT_TRUE(client
+                  .TryBatchExecute(
+                      requests, absl::Minutes(1),
+                      [&cancelled_responses](const auto& res) {
+                        cancelled_responses = res;
+                      },
+                      &cancellation)
+                  .ok());
+  cancellation.Cancel();
+  held.CompleteOldest();
+
+  ASSERT_EQ(cancelled_responses.size(), 1);
+  EXPECT_EQ(cancelled_responses[0].status().code(),
+            absl::StatusCode::kCancelled);
+  EXPECT_EQ(held.batches().size(), 1);
+  EXPECT_EQ(client.PendingRequests(), 0);
+  EXPECT_EQ(
+      client
+          .TryBatchExecute(requests, absl::Minutes(1),
+                           [](const auto& res) {}, &cancellation)
+          .code(),
+      absl::StatusCode::kCancelled);
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
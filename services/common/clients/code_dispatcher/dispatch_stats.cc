@@ -0,0 +1,193 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Weight of the latest batch in the moving average of the request execution
+// time.
+constexpr double kExecutionTimeSmoothing = 0.1;
+
+// Returns the number of rounds of num_workers requests needed to execute
+// num_requests.
+int64_t Rounds(int64_t num_requests, int num_workers) {
+  return std::max<int64_t>(1, (num_requests + num_workers - 1) / num_workers);
+}
+
+}  // namespace
+
+DispatchStats& DispatchStats::Get() {
+  static DispatchStats* stats = new DispatchStats();
+  return *stats;
+}
+
+void DispatchStats::SetNumWorkers(int num_workers) {
+  num_workers_ = num_workers;
+}
+
+void DispatchStats::SetWorkerQueueLength(int64_t worker_queue_length) {
+  worker_queue_length_ = worker_queue_length;
+}
+
+int64_t DispatchStats::OnBatchScheduled(int64_t batch_size) {
+  return pending_requests_.fetch_add(batch_size);
+}
+
+void DispatchStats::OnBatchNotScheduled(int64_t batch_size) {
+  pending_requests_ -= batch_size;
+  not_scheduled_requests_ += batch_size;
+}
+
+void DispatchStats::OnBatchRejected(int64_t batch_size) {
+  rejected_requests_ += batch_size;
+}
+
+void DispatchStats::OnBatchDone(int64_t batch_size, int64_t pending_ahead,
+                                absl::Duration latency) {
+  pending_requests_ -= batch_size;
+  const int num_workers = num_workers_;
+  absl::MutexLock lock(&mu_);
+  if (latencies_ms_.size() < kLatencyWindowSize) {
+    latencies_ms_.push_back(absl::ToDoubleMilliseconds(latency));
+  } else {
+    latencies_ms_[next_latency_] = absl::ToDoubleMilliseconds(latency);
+  }
+  next_latency_ = (next_latency_ + 1) % kLatencyWindowSize;
+  if (num_workers <= 0 || batch_size <= 0) {
+    return;
+  }
+  // The batch finished after the workers went through the requests ahead of
+  // it and its own requests, num_workers at a time.
+  const absl::Duration execution_time =
+      latency / Rounds(pending_ahead + batch_size, num_workers);
+  request_execution_time_ =
+      request_execution_time_ == absl::ZeroDuration()
+          ? execution_time
+          : request_execution_time_ * (1 - kExecutionTimeSmoothing) +
+                execution_time * kExecutionTimeSmoothing;
+  busy_time_ += execution_time * batch_size;
+}
+
+int64_t DispatchStats::PendingRequests() const {
+  return pending_requests_.load(std::memory_order_relaxed);
+}
+
+absl::Duration DispatchStats::ProjectedQueueingTime() const {
+  const int num_workers = num_workers_;
+  const int64_t pending_requests = PendingRequests();
+  if (num_workers <= 0 || pending_requests < num_workers) {
+    return absl::ZeroDuration();
+  }
+  // Every worker is busy, so a new request waits for the queued requests and
+  // one more to finish, num_workers at a time.
+  absl::MutexLock lock(&mu_);
+  return request_execution_time_ * (pending_requests - num_workers + 1) /
+         num_workers;
+}
+
+absl::flat_hash_map<std::string, double> DispatchStats::QueueDepth() const {
+  const int64_t pending_requests = PendingRequests();
+  absl::flat_hash_map<std::string, double> depth = {
+      {"pending", static_cast<double>(pending_requests)}};
+  if (const int num_workers = num_workers_; num_workers > 0) {
+    const int64_t in_flight = std::min<int64_t>(pending_requests, num_workers);
+    depth["in flight"] = in_flight;
+    depth["queued"] = pending_requests - in_flight;
+  }
+  return depth;
+}
+
+absl::flat_hash_map<std::string, double> DispatchStats::QueueFill() const {
+  const int num_workers = num_workers_;
+  const int64_t worker_queue_length = worker_queue_length_;
+  if (num_workers <= 0 || worker_queue_length <= 0) {
+    return {};
+  }
+  const int64_t queued = std::max<int64_t>(0, PendingRequests() - num_workers);
+  return {{"fill ratio",
+           static_cast<double>(queued) / (num_workers * worker_queue_length)}};
+}
+
+absl::flat_hash_map<std::string, double> DispatchStats::RejectedRequests() {
+  return {{"over budget", rejected_requests_.exchange(0)},
+          {"not scheduled", not_scheduled_requests_.exchange(0)}};
+}
+
+absl::flat_hash_map<std::string, double> DispatchStats::WorkerUtilization() {
+  const int num_workers = num_workers_;
+  if (num_workers <= 0) {
+    return {};
+  }
+  const absl::Time now = absl::Now();
+  absl::MutexLock lock(&mu_);
+  const absl::Duration elapsed = now - busy_since_;
+  absl::flat_hash_map<std::string, double> utilization;
+  if (elapsed > absl::ZeroDuration()) {
+    utilization["busy ratio"] =
+        std::min(1.0, absl::FDivDuration(busy_time_, elapsed * num_workers));
+    utilization["busy ms per worker"] =
+        absl::ToDoubleMilliseconds(busy_time_) / num_workers;
+  }
+  busy_time_ = absl::ZeroDuration();
+  busy_since_ = now;
+  return utilization;
+}
+
+absl::flat_hash_map<std::string, double> DispatchStats::ExecutionLatency()
+    const {
+  std::vector<double> latencies_ms;
+  {
+    absl::MutexLock lock(&mu_);
+    latencies_ms = latencies_ms_;
+  }
+  if (latencies_ms.empty()) {
+    return {};
+  }
+  absl::flat_hash_map<std::string, double> percentiles;
+  for (const auto& [label, percentile] :
+       {std::pair{"p50", 0.5}, std::pair{"p90", 0.9}, std::pair{"p99", 0.99}}) {
+    auto it = latencies_ms.begin() +
+              static_cast<size_t>(percentile * (latencies_ms.size() - 1));
+    std::nth_element(latencies_ms.begin(), it, latencies_ms.end());
+    percentiles[label] = *it;
+  }
+  return percentiles;
+}
+
+absl::flat_hash_map<std::string, double> GetDispatchQueueDepth() {
+  return DispatchStats::Get().QueueDepth();
+}
+
+absl::flat_hash_map<std::string, double> GetDispatchQueueFill() {
+  return DispatchStats::Get().QueueFill();
+}
+
+absl::flat_hash_map<std::string, double> GetDispatchRejectedRequests() {
+  return DispatchStats::Get().RejectedRequests();
+}
+
+absl::flat_hash_map<std::string, double> GetDispatchWorkerUtilization() {
+  return DispatchStats::Get().WorkerUtilization();
+}
+
+absl::flat_hash_map<std::string, double> GetDispatchExecutionLatency() {
+  return DispatchStats::Get().ExecutionLatency();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
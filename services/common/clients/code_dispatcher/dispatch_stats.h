@@ -0,0 +1,140 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_DISPATCH_STATS_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_DISPATCH_STATS_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Statistics of the batches dispatched to Roma. Roma does not expose its
+// queue or its workers, so queueing and worker busy time are estimated from
+// the time between scheduling a batch and its callback, the number of
+// requests scheduled ahead of it and the number of workers.
+// Thread safe.
+class DispatchStats {
+ public:
+  // Number of recent batch latencies that percentiles are computed over.
+  static constexpr int kLatencyWindowSize = 1024;
+
+  DispatchStats() = default;
+
+  // Not copyable or movable.
+  DispatchStats(const DispatchStats&) = delete;
+  DispatchStats& operator=(const DispatchStats&) = delete;
+
+  // Returns the statistics of all the batches dispatched by this process,
+  // which are exported by the gauges registered with AddDispatchMetric.
+  static DispatchStats& Get();
+
+  // Sets the number of Roma workers. Queueing time and worker utilization are
+  // not estimated until it is set.
+  void SetNumWorkers(int num_workers);
+
+  // Sets the number of requests each Roma worker queues, so that the queue
+  // fill is reported relative to it. Not reported until it is set.
+  void SetWorkerQueueLength(int64_t worker_queue_length);
+
+  // Records that batch_size requests were scheduled and returns the number of
+  // requests that were pending ahead of them.
+  int64_t OnBatchScheduled(int64_t batch_size);
+
+  // Records that a batch recorded by OnBatchScheduled failed to be scheduled.
+  void OnBatchNotScheduled(int64_t batch_size);
+
+  // Records that a batch was rejected before being scheduled, as its requests
+  // were projected to wait for a worker for longer than their budget.
+  void OnBatchRejected(int64_t batch_size);
+
+  // Records that a batch finished, latency after it was scheduled behind
+  // pending_ahead requests.
+  void OnBatchDone(int64_t batch_size, int64_t pending_ahead,
+                   absl::Duration latency) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the number of requests scheduled whose batch has not finished.
+  int64_t PendingRequests() const;
+
+  // Returns how long a request scheduled now is expected to wait for a
+  // worker, or zero if it cannot be estimated yet.
+  absl::Duration ProjectedQueueingTime() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Gauge values, keyed by label.
+  // Pending requests, split into requests waiting for a worker and requests
+  // being executed.
+  absl::flat_hash_map<std::string, double> QueueDepth() const;
+  // Fraction of the capacity of the worker queues taken by queued requests.
+  absl::flat_hash_map<std::string, double> QueueFill() const;
+  // Requests rejected by TryBatchExecute and requests that Roma failed to
+  // schedule, as when its queues are full, since the previous call.
+  absl::flat_hash_map<std::string, double> RejectedRequests();
+  // Fraction of the time the workers were busy, and the busy time per worker
+  // in milliseconds, since the previous call.
+  absl::flat_hash_map<std::string, double> WorkerUtilization()
+      ABSL_LOCKS_EXCLUDED(mu_);
+  // Percentiles of the latencies of recent batches in milliseconds.
+  absl::flat_hash_map<std::string, double> ExecutionLatency() const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  std::atomic<int> num_workers_ = 0;
+  std::atomic<int64_t> worker_queue_length_ = 0;
+  std::atomic<int64_t> pending_requests_ = 0;
+  std::atomic<int64_t> rejected_requests_ = 0;
+  std::atomic<int64_t> not_scheduled_requests_ = 0;
+
+  mutable absl::Mutex mu_;
+  // Moving average of the time a worker spends on a single request.
+  absl::Duration request_execution_time_ ABSL_GUARDED_BY(mu_) =
+      absl::ZeroDuration();
+  absl::Duration busy_time_ ABSL_GUARDED_BY(mu_) = absl::ZeroDuration();
+  absl::Time busy_since_ ABSL_GUARDED_BY(mu_) = absl::Now();
+  // Ring buffer of the latencies of the most recent batches, in milliseconds.
+  std::vector<double> latencies_ms_ ABSL_GUARDED_BY(mu_);
+  int next_latency_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Gauge callbacks reading DispatchStats::Get().
+absl::flat_hash_map<std::string, double> GetDispatchQueueDepth();
+absl::flat_hash_map<std::string, double> GetDispatchQueueFill();
+absl::flat_hash_map<std::string, double> GetDispatchRejectedRequests();
+absl::flat_hash_map<std::string, double> GetDispatchWorkerUtilization();
+absl::flat_hash_map<std::string, double> GetDispatchExecutionLatency();
+
+template <typename T>
+inline void AddDispatchMetric(T* context_map) {
+  context_map->AddObserverable(metric::kJSExecutionQueueDepth,
+                               GetDispatchQueueDepth);
+  context_map->AddObserverable(metric::kJSExecutionQueueFill,
+                               GetDispatchQueueFill);
+  context_map->AddObserverable(metric::kJSExecutionRejectedCount,
+                               GetDispatchRejectedRequests);
+  context_map->AddObserverable(metric::kJSExecutionWorkerUtilization,
+                               GetDispatchWorkerUtilization);
+  context_map->AddObserverable(metric::kJSExecutionRecentDuration,
+                               GetDispatchExecutionLatency);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_DISPATCH_STATS_H_
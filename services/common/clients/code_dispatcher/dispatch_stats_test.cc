@@ -0,0 +1,141 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
+
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(DispatchStatsTest, SplitsPendingRequestsIntoQueuedAndInFlight) {
+  DispatchStats stats;
+  EXPECT_EQ(stats.OnBatchScheduled(3), 0);
+  EXPECT_EQ(stats.OnBatchScheduled(4), 3);
+  EXPECT_THAT(stats.QueueDepth(), UnorderedElementsAre(Pair("pending", 7)));
+
+  stats.SetNumWorkers(2);
+  EXPECT_THAT(stats.QueueDepth(),
+              UnorderedElementsAre(Pair("pending", 7), Pair("in flight", 2),
+                                   Pair("queued", 5)));
+
+  stats.OnBatchNotScheduled(4);
+  stats.OnBatchDone(3, 0, absl::Milliseconds(1));
+  EXPECT_EQ(stats.PendingRequests(), 0);
+}
+
+TEST(DispatchStatsTest, ReportsQueueFillRelativeToWorkerQueueLength) {
+  DispatchStats stats;
+  stats.OnBatchScheduled(7);
+  stats.SetNumWorkers(2);
+  EXPECT_TRUE(stats.QueueFill().empty());
+
+  // 5 requests queued behind 2 in flight, in 2 queues of 5.
+  stats.SetWorkerQueueLength(5);
+  EXPECT_THAT(stats.QueueFill(), UnorderedElementsAre(Pair("fill ratio", 0.5)));
+
+  stats.OnBatchDone(7, 0, absl::Milliseconds(1));
+  EXPECT_THAT(stats.QueueFill(), UnorderedElementsAre(Pair("fill ratio", 0)));
+}
+
+TEST(DispatchStatsTest, ResetsRejectedRequestsOnRead) {
+  DispatchStats stats;
+  stats.OnBatchRejected(3);
+  stats.OnBatchScheduled(2);
+  stats.OnBatchNotScheduled(2);
+
+  EXPECT_THAT(stats.RejectedRequests(),
+              UnorderedElementsAre(Pair("over budget", 3),
+                                   Pair("not scheduled", 2)));
+  EXPECT_THAT(stats.RejectedRequests(),
+              UnorderedElementsAre(Pair("over budget", 0),
+                                   Pair("not scheduled", 0)));
+}
+
+TEST(DispatchStatsTest, DoesNotProjectQueueingWithoutWorkers) {
+  DispatchStats stats;
+  stats.OnBatchScheduled(10);
+  stats.OnBatchDone(10, 0, absl::Milliseconds(10));
+  stats.OnBatchScheduled(10);
+
+  EXPECT_EQ(stats.ProjectedQueueingTime(), absl::ZeroDuration());
+  EXPECT_TRUE(stats.WorkerUtilization().empty());
+}
+
+TEST(DispatchStatsTest, ProjectsQueueingTimeFromExecutionTime) {
+  DispatchStats stats;
+  stats.SetNumWorkers(2);
+  // 4 requests behind 2 other requests take 3 rounds of 10ms.
+  stats.OnBatchScheduled(6);
+  stats.OnBatchDone(4, 2, absl::Milliseconds(30));
+  stats.OnBatchDone(2, 0, absl::Milliseconds(10));
+  EXPECT_EQ(stats.ProjectedQueueingTime(), absl::ZeroDuration());
+
+  // 2 requests in flight and 3 queued: a new request waits for 4 of them to
+  // finish, 2 at a time.
+  stats.OnBatchScheduled(5);
+  EXPECT_EQ(stats.ProjectedQueueingTime(), absl::Milliseconds(20));
+}
+
+TEST(DispatchStatsTest, ReportsLatencyPercentiles) {
+  DispatchStats stats;
+  EXPECT_TRUE(stats.ExecutionLatency().empty());
+
+  for (int i = 1; i <= 100; ++i) {
+    stats.OnBatchScheduled(1);
+    stats.OnBatchDone(1, 0, absl::Milliseconds(i));
+  }
+
+  EXPECT_THAT(stats.ExecutionLatency(),
+              UnorderedElementsAre(Pair("p50", 50), Pair("p90", 90),
+                                   Pair("p99", 99)));
+}
+
+TEST(DispatchStatsTest, KeepsOnlyRecentLatencies) {
+  DispatchStats stats;
+  for (int i = 0; i < DispatchStats::kLatencyWindowSize; ++i) {
+    stats.OnBatchScheduled(1);
+    stats.OnBatchDone(1, 0, absl::Seconds(1));
+  }
+  for (int i = 0; i < DispatchStats::kLatencyWindowSize; ++i) {
+    stats.OnBatchScheduled(1);
+    stats.OnBatchDone(1, 0, absl::Milliseconds(1));
+  }
+
+  EXPECT_THAT(stats.ExecutionLatency(),
+              UnorderedElementsAre(Pair("p50", 1), Pair("p90", 1),
+                                   Pair("p99", 1)));
+}
+
+TEST(DispatchStatsTest, ResetsWorkerBusyTimeOnRead) {
+  DispatchStats stats;
+  stats.SetNumWorkers(2);
+  stats.WorkerUtilization();
+  stats.OnBatchScheduled(2);
+  stats.OnBatchDone(2, 0, absl::Milliseconds(5));
+
+  auto utilization = stats.WorkerUtilization();
+  EXPECT_DOUBLE_EQ(utilization["busy ms per worker"], 5);
+  EXPECT_GT(utilization["busy ratio"], 0);
+  EXPECT_LE(utilization["busy ratio"], 1);
+  EXPECT_DOUBLE_EQ(stats.WorkerUtilization()["busy ms per worker"], 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,240 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/shared_arguments.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::scp::roma::InvocationRequestSharedInput;
+using ::google::scp::roma::ResponseObject;
+
+constexpr char kTimeoutMsTag[] = "TimeoutMs";
+
+bool CanPackTogether(const InvocationRequestSharedInput& first,
+                     const InvocationRequestSharedInput& request) {
+  return request.handler_name == first.handler_name &&
+         request.version_num == first.version_num &&
+         request.tags == first.tags &&
+         request.input.size() == first.input.size();
+}
+
+// Returns the indices of the arguments all the requests share.
+std::vector<int> SharedArgumentsOf(
+    const std::vector<InvocationRequestSharedInput>& batch, int begin,
+    int end) {
+  std::vector<int> shared;
+  const auto& first = batch[begin].input;
+  for (int arg = 0; arg < first.size(); ++arg) {
+    if (first[arg] == nullptr) {
+      continue;
+    }
+    bool all_share = true;
+    for (int i = begin + 1; i < end && all_share; ++i) {
+      all_share = batch[i].input[arg] == first[arg];
+    }
+    if (all_share) {
+      shared.push_back(arg);
+    }
+  }
+  return shared;
+}
+
+InvocationRequestSharedInput PackRequests(
+    const std::vector<InvocationRequestSharedInput>& batch, int begin,
+    int end, const std::vector<int>& shared) {
+  const InvocationRequestSharedInput& first = batch[begin];
+  const int num_arguments = first.input.size();
+  InvocationRequestSharedInput packed;
+  packed.id = first.id;
+  packed.version_num = first.version_num;
+  packed.handler_name = kSharedArgumentsEntryFunctionName;
+  packed.tags = first.tags;
+  if (auto it = packed.tags.find(kTimeoutMsTag); it != packed.tags.end()) {
+    if (int64_t timeout_ms; absl::SimpleAtoi(it->second, &timeout_ms)) {
+      it->second = absl::StrCat(timeout_ms * (end - begin));
+    }
+  }
+  packed.input.reserve(2 + shared.size() +
+                       (end - begin) * (num_arguments - shared.size()));
+  packed.input.push_back(
+      std::make_shared<std::string>(absl::StrCat("\"", first.handler_name,
+                                                 "\"")));
+  packed.input.push_back(std::make_shared<std::string>(absl::StrCat(
+      R"({"numArguments":)", num_arguments, R"(,"shared":[)",
+      absl::StrJoin(shared, ","), R"(],"numItems":)", end - begin, "}")));
+  for (int arg : shared) {
+    packed.input.push_back(first.input[arg]);
+  }
+  for (int i = begin; i < end; ++i) {
+    int shared_index = 0;
+    for (int arg = 0; arg < num_arguments; ++arg) {
+      if (shared_index < shared.size() && shared[shared_index] == arg) {
+        ++shared_index;
+      } else {
+        packed.input.push_back(batch[i].input[arg]);
+      }
+    }
+  }
+  return packed;
+}
+
+}  // namespace
+
+SharedArgumentsBatch PackSharedArguments(
+    const std::vector<InvocationRequestSharedInput>& batch,
+    int max_items_per_request) {
+  SharedArgumentsBatch packed;
+  packed.ids.reserve(batch.size());
+  for (const InvocationRequestSharedInput& request : batch) {
+    packed.ids.push_back(request.id);
+  }
+  int begin = 0;
+  while (begin < batch.size()) {
+    int end = begin + 1;
+    while (end < batch.size() && end - begin < max_items_per_request &&
+           CanPackTogether(batch[begin], batch[end])) {
+      ++end;
+    }
+    std::vector<int> shared;
+    if (end - begin > 1) {
+      shared = SharedArgumentsOf(batch, begin, end);
+    }
+    if (shared.empty()) {
+      // Left as they are, nothing would be transferred once.
+      for (int i = begin; i < end; ++i) {
+        packed.requests.push_back(batch[i]);
+        packed.items.push_back({i});
+      }
+    } else {
+      packed.requests.push_back(PackRequests(batch, begin, end, shared));
+      std::vector<int>& items = packed.items.emplace_back();
+      for (int i = begin; i < end; ++i) {
+        items.push_back(i);
+      }
+    }
+    begin = end;
+  }
+  return packed;
+}
+
+std::vector<absl::StatusOr<ResponseObject>> UnpackSharedArguments(
+    const SharedArgumentsBatch& packed,
+    const std::vector<absl::StatusOr<ResponseObject>>& responses) {
+  std::vector<absl::StatusOr<ResponseObject>> unpacked(
+      packed.ids.size(), absl::InternalError("Missing response."));
+  for (int i = 0; i < packed.items.size() && i < responses.size(); ++i) {
+    const std::vector<int>& items = packed.items[i];
+    if (packed.requests[i].handler_name != kSharedArgumentsEntryFunctionName) {
+      unpacked[items[0]] = responses[i];
+      continue;
+    }
+    if (!responses[i].ok()) {
+      for (int item : items) {
+        unpacked[item] = responses[i].status();
+      }
+      continue;
+    }
+    absl::StatusOr<std::vector<absl::string_view>> outputs =
+        SplitJsonArray(responses[i]->resp);
+    if (outputs.ok() && outputs->size() != items.size()) {
+      outputs = absl::InternalError(
+          absl::StrCat("Expected ", items.size(), " outputs, got ",
+                       outputs->size(), "."));
+    }
+    for (int j = 0; j < items.size(); ++j) {
+      const int item = items[j];
+      if (!outputs.ok()) {
+        unpacked[item] = outputs.status();
+      } else if ((*outputs)[j] == "null") {
+        unpacked[item] =
+            absl::InternalError("Execution of the packed request failed.");
+      } else {
+        ResponseObject response;
+        response.id = packed.ids[item];
+        response.resp = std::string((*outputs)[j]);
+        unpacked[item] = std::move(response);
+      }
+    }
+  }
+  return unpacked;
+}
+
+absl::StatusOr<std::vector<absl::string_view>> SplitJsonArray(
+    absl::string_view json) {
+  json = absl::StripAsciiWhitespace(json);
+  if (json.size() < 2 || json.front() != '[' || json.back() != ']') {
+    return absl::InvalidArgumentError("Not a JSON array.");
+  }
+  std::vector<absl::string_view> elements;
+  const absl::string_view content =
+      absl::StripAsciiWhitespace(json.substr(1, json.size() - 2));
+  if (content.empty()) {
+    return elements;
+  }
+  int depth = 0;
+  bool in_string = false;
+  size_t start = 0;
+  for (size_t i = 0; i < content.size(); ++i) {
+    const char c = content[i];
+    if (in_string) {
+      if (c == '\\') {
+        ++i;
+      } else if (c == '"') {
+        in_string = false;
+      }
+      continue;
+    }
+    switch (c) {
+      case '"':
+        in_string = true;
+        break;
+      case '[':
+      case '{':
+        ++depth;
+        break;
+      case ']':
+      case '}':
+        if (--depth < 0) {
+          return absl::InvalidArgumentError("Unbalanced JSON array.");
+        }
+        break;
+      case ',':
+        if (depth == 0) {
+          elements.push_back(
+              absl::StripAsciiWhitespace(content.substr(start, i - start)));
+          start = i + 1;
+        }
+        break;
+    }
+  }
+  if (depth != 0 || in_string) {
+    return absl::InvalidArgumentError("Unbalanced JSON array.");
+  }
+  elements.push_back(absl::StripAsciiWhitespace(content.substr(start)));
+  return elements;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,96 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_SHARED_ARGUMENTS_H_
+#define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_SHARED_ARGUMENTS_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "cc/roma/interface/roma.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kSharedArgumentsEntryFunctionName[] =
+    "psSharedArgumentsEntryFunction";
+
+// Appended to the code loaded by a V8Dispatcher packing shared arguments.
+// Calls the handler once per item of a packed request, with the shared
+// arguments passed once for all of them, and returns the outputs of the
+// items in order, null for an item whose handler threw. The items see the
+// same objects for the shared arguments, as with the batch entry functions
+// of the code wrappers.
+inline constexpr absl::string_view kSharedArgumentsEntryFunction = R"JS_CODE(
+function psSharedArgumentsEntryFunction(handlerName, layout, ...args) {
+  const handler = globalThis[handlerName];
+  const shared = layout.shared;
+  const outputs = [];
+  let next = shared.length;
+  for (let item = 0; item < layout.numItems; ++item) {
+    const itemArgs = [];
+    let sharedIndex = 0;
+    for (let arg = 0; arg < layout.numArguments; ++arg) {
+      if (shared[sharedIndex] === arg) {
+        itemArgs.push(args[sharedIndex++]);
+      } else {
+        itemArgs.push(args[next++]);
+      }
+    }
+    try {
+      outputs.push(handler(...itemArgs));
+    } catch (e) {
+      outputs.push(null);
+    }
+  }
+  return outputs;
+}
+)JS_CODE";
+
+// Requests of a batch packed by PackSharedArguments, with the indices in the
+// batch of the requests each packed request executes.
+struct SharedArgumentsBatch {
+  std::vector<google::scp::roma::InvocationRequestSharedInput> requests;
+  std::vector<std::vector<int>> items;
+  // Ids of the requests of the batch.
+  std::vector<std::string> ids;
+};
+
+// Packs up to max_items_per_request consecutive requests of the batch that
+// call the same handler of the same version with the same tags into a single
+// request of kSharedArgumentsEntryFunctionName. The arguments the requests
+// share, i.e. whose inputs point to the same string, are serialized once into
+// the packed request rather than once per request, and the others follow in
+// order. The "TimeoutMs" tag, if any, is scaled by the number of requests
+// packed. Requests sharing no argument are left as they are.
+SharedArgumentsBatch PackSharedArguments(
+    const std::vector<google::scp::roma::InvocationRequestSharedInput>& batch,
+    int max_items_per_request);
+
+// Returns the responses of the requests of the batch packed, from the
+// responses of the packed requests, in the order of the batch.
+std::vector<absl::StatusOr<google::scp::roma::ResponseObject>>
+UnpackSharedArguments(
+    const SharedArgumentsBatch& packed,
+    const std::vector<absl::StatusOr<google::scp::roma::ResponseObject>>&
+        responses);
+
+// Returns the serialized elements of the JSON array, without parsing them.
+absl::StatusOr<std::vector<absl::string_view>> SplitJsonArray(
+    absl::string_view json);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_SHARED_ARGUMENTS_H_
@@ -0,0 +1,119 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/code_dispatcher/shared_arguments.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::scp::roma::InvocationRequestSharedInput;
+using ::google::scp::roma::ResponseObject;
+using ::testing::ElementsAre;
+
+InvocationRequestSharedInput MakeRequest(
+    std::string id, std::shared_ptr<std::string> shared,
+    std::string own) {
+  InvocationRequestSharedInput request;
+  request.id = std::move(id);
+  request.version_num = 1;
+  request.handler_name = "scoreAdEntryFunction";
+  request.input = {std::make_shared<std::string>(std::move(own)), shared};
+  request.tags["TimeoutMs"] = "100";
+  return request;
+}
+
+std::vector<std::string> InputsOf(const InvocationRequestSharedInput& request) {
+  std::vector<std::string> inputs;
+  for (const auto& input : request.input) {
+    inputs.push_back(*input);
+  }
+  return inputs;
+}
+
+TEST(SharedArgumentsTest, TransfersTheSharedArgumentsOnce) {
+  auto auction_config = std::make_shared<std::string>(R"({"seller":"s"})");
+  std::vector<InvocationRequestSharedInput> batch = {
+      MakeRequest("a", auction_config, "1"),
+      MakeRequest("b", auction_config, "2"),
+      MakeRequest("c", auction_config, "3")};
+
+  SharedArgumentsBatch packed = PackSharedArguments(batch, 2);
+
+  ASSERT_EQ(packed.requests.size(), 2);
+  EXPECT_THAT(packed.items, ElementsAre(ElementsAre(0, 1), ElementsAre(2)));
+  EXPECT_EQ(packed.requests[0].handler_name,
+            kSharedArgumentsEntryFunctionName);
+  EXPECT_EQ(packed.requests[0].tags["TimeoutMs"], "200");
+  EXPECT_THAT(InputsOf(packed.requests[0]),
+              ElementsAre(R"("scoreAdEntryFunction")",
+                          R"({"numArguments":2,"shared":[1],"numItems":2})",
+                          R"({"seller":"s"})", "1", "2"));
+  EXPECT_EQ(packed.requests[0].input[2], auction_config);
+  // Alone, so left as it is.
+  EXPECT_EQ(packed.requests[1].handler_name, "scoreAdEntryFunction");
+}
+
+TEST(SharedArgumentsTest, LeavesRequestsSharingNothing) {
+  std::vector<InvocationRequestSharedInput> batch = {
+      MakeRequest("a", std::make_shared<std::string>("{}"), "1"),
+      MakeRequest("b", std::make_shared<std::string>("{}"), "2")};
+
+  SharedArgumentsBatch packed = PackSharedArguments(batch, 8);
+
+  ASSERT_EQ(packed.requests.size(), 2);
+  EXPECT_EQ(packed.requests[1].id, "b");
+  EXPECT_THAT(InputsOf(packed.requests[1]), ElementsAre("2", "{}"));
+}
+
+TEST(SharedArgumentsTest, UnpacksTheOutputsOfEachRequest) {
+  auto shared = std::make_shared<std::string>("{}");
+  std::vector<InvocationRequestSharedInput> batch = {
+      MakeRequest("a", shared, "1"), MakeRequest("b", shared, "2"),
+      MakeRequest("c", shared, "3"), MakeRequest("d", shared, "4")};
+  SharedArgumentsBatch packed = PackSharedArguments(batch, 3);
+  ResponseObject packed_response;
+  packed_response.resp = R"([{"bid":[1,"]"]} , null, "x,y"])";
+  std::vector<absl::StatusOr<ResponseObject>> responses = {
+      packed_response, absl::UnavailableError("down")};
+
+  std::vector<absl::StatusOr<ResponseObject>> unpacked =
+      UnpackSharedArguments(packed, responses);
+
+  ASSERT_EQ(unpacked.size(), 4);
+  ASSERT_TRUE(unpacked[0].ok());
+  EXPECT_EQ(unpacked[0]->id, "a");
+  EXPECT_EQ(unpacked[0]->resp, R"({"bid":[1,"]"]})");
+  EXPECT_FALSE(unpacked[1].ok());
+  ASSERT_TRUE(unpacked[2].ok());
+  EXPECT_EQ(unpacked[2]->resp, R"("x,y")");
+  EXPECT_EQ(unpacked[3].status().code(), absl::StatusCode::kUnavailable);
+}
+
+TEST(SharedArgumentsTest, SplitsJsonArrays) {
+  EXPECT_THAT(*SplitJsonArray(" [] "), ElementsAre());
+  EXPECT_THAT(*SplitJsonArray(R"([1, "a\"]", {"b": [2, 3]}])"),
+              ElementsAre("1", R"("a\"]")", R"({"b": [2, 3]})"));
+  EXPECT_FALSE(SplitJsonArray("{}").ok());
+  EXPECT_FALSE(SplitJsonArray("[[1]").ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -20,8 +20,13 @@
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "absl/strings/str_cat.h"
+#include "glog/logging.h"
 #include "cc/roma/interface/roma.h"
+#include "services/common/clients/code_dispatcher/shared_arguments.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -40,7 +45,10 @@ absl::Status V8Dispatcher::Stop() const {
 absl::Status V8Dispatcher::LoadSync(int version, absl::string_view js) const {
   LoadRequest request;
   request.version_num = version;
-  request.js = js;
+  // The packed requests call the entry function of the shared arguments.
+  request.js = max_requests_per_invocation_ > 1
+                   ? absl::StrCat(js, kSharedArgumentsEntryFunction)
+                   : std::string(js);
   absl::BlockingCounter is_loading(1);
 
   absl::Status load_status;
@@ -71,6 +79,126 @@ absl::Status V8Dispatcher::Execute(std::unique_ptr<DispatchRequest> request,
 absl::Status V8Dispatcher::BatchExecute(
     std::vector<DispatchRequest>& batch,
     BatchDispatchDoneCallback batch_callback) const {
+  if (max_requests_per_invocation_ <= 1) {
+    return ScheduleBatch(batch, std::move(batch_callback));
+  }
+  auto packed = std::make_shared<SharedArgumentsBatch>(
+      PackSharedArguments(batch, max_requests_per_invocation_));
+  if (packed->requests.size() == batch.size()) {
+    return ScheduleBatch(batch, std::move(batch_callback));
+  }
+  return ScheduleBatch(
+      packed->requests,
+      [packed, batch_callback = std::move(batch_callback)](
+          const std::vector<absl::StatusOr<DispatchResponse>>& responses) {
+        batch_callback(UnpackSharedArguments(*packed, responses));
+      });
+}
+
+absl::Status V8Dispatcher::ScheduleBatch(
+    std::vector<DispatchRequest>& batch,
+    BatchDispatchDoneCallback batch_callback) const {
   return google::scp::roma::BatchExecute(batch, std::move(batch_callback));
 }
+
+absl::Status V8Dispatcher::WarmUpSync(std::vector<DispatchRequest> batch,
+                                      absl::Duration timeout) const {
+  if (batch.empty()) {
+    return absl::OkStatus();
+  }
+  // Shared with the callback, which may run after a timed out wait returns.
+  auto done = std::make_shared<absl::Notification>();
+  absl::Status try_execute = BatchExecute(
+      batch, [done](const std::vector<absl::StatusOr<DispatchResponse>>&) {
+        done->Notify();
+      });
+  if (!try_execute.ok()) {
+    return try_execute;
+  }
+  if (!done->WaitForNotificationWithTimeout(timeout)) {
+    return absl::DeadlineExceededError("Code warm up did not finish in time.");
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<int> V8Dispatcher::LoadAndWarmUpNextVersion(
+    absl::string_view js, std::vector<DispatchRequest> warm_up_requests,
+    absl::Duration warm_up_timeout) const {
+  const bool reuse = max_versions_ > 0 && last_version_ >= max_versions_;
+  if (reuse && retired_versions_.empty()) {
+    return absl::ResourceExhaustedError(
+        absl::StrCat("All ", max_versions_, " code versions are in use."));
+  }
+  const int version = reuse ? retired_versions_.front() : last_version_ + 1;
+  if (absl::Status load_status = LoadSync(version, js); !load_status.ok()) {
+    return load_status;
+  }
+  if (reuse) {
+    retired_versions_.pop_front();
+  } else {
+    last_version_ = version;
+  }
+  for (auto& request : warm_up_requests) {
+    request.version_num = version;
+  }
+  absl::Status warm_up_status =
+      WarmUpSync(std::move(warm_up_requests), warm_up_timeout);
+  LOG_IF(WARNING, !warm_up_status.ok())
+      << "Could not warm up code version " << version << ": "
+      << warm_up_status;
+  return version;
+}
+
+absl::Status V8Dispatcher::LoadNextVersionSync(
+    absl::string_view js, std::vector<DispatchRequest> warm_up_requests,
+    absl::Duration warm_up_timeout) const {
+  absl::MutexLock lock(&load_mu_);
+  absl::StatusOr<int> version = LoadAndWarmUpNextVersion(
+      js, std::move(warm_up_requests), warm_up_timeout);
+  if (!version.ok()) {
+    return version.status();
+  }
+  RetireVersion(current_version_.exchange(*version));
+  return absl::OkStatus();
+}
+
+absl::Status V8Dispatcher::LoadExperimentVersionSync(
+    absl::string_view experiment_id, absl::string_view js,
+    std::vector<DispatchRequest> warm_up_requests,
+    absl::Duration warm_up_timeout) const {
+  absl::MutexLock lock(&load_mu_);
+  absl::StatusOr<int> version = LoadAndWarmUpNextVersion(
+      js, std::move(warm_up_requests), warm_up_timeout);
+  if (!version.ok()) {
+    return version.status();
+  }
+  int previous_version;
+  {
+    absl::MutexLock experiments_lock(&experiments_mu_);
+    previous_version =
+        std::exchange(experiment_versions_[experiment_id], *version);
+  }
+  RetireVersion(previous_version);
+  return absl::OkStatus();
+}
+
+void V8Dispatcher::SetMaxCodeVersions(int max_versions) {
+  absl::MutexLock lock(&load_mu_);
+  max_versions_ = max_versions;
+}
+
+void V8Dispatcher::RetireVersion(int version) const {
+  // Unbounded versions are never reused.
+  if (max_versions_ > 0 && version > 0) {
+    retired_versions_.push_back(version);
+  }
+}
+
+int V8Dispatcher::CurrentVersion() const { return current_version_.load(); }
+
+int V8Dispatcher::ExperimentVersion(absl::string_view experiment_id) const {
+  absl::ReaderMutexLock lock(&experiments_mu_);
+  auto it = experiment_versions_.find(experiment_id);
+  return it == experiment_versions_.end() ? 0 : it->second;
+}
 }  // namespace privacy_sandbox::bidding_auction_servers
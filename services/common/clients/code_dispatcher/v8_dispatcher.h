@@ -15,11 +15,19 @@
 #ifndef SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_V8_DISPATCHER_H_
 #define SERVICES_COMMON_CLIENTS_CODE_DISPATCHER_V8_DISPATCHER_H_
 
+#include <atomic>
 #include <memory>
+#include <deque>
 #include <string>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "cc/roma/interface/roma.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -41,6 +49,16 @@ using DispatchConfig = google::scp::roma::Config;
 // for multi-process javascript and wasm execution in V8.
 class V8Dispatcher {
  public:
+  V8Dispatcher() = default;
+
+  // Packs up to max_requests_per_invocation requests of each batch executed
+  // into a single Roma invocation when they share arguments, so that the
+  // arguments shared, e.g. the auction config or the buyer signals, are
+  // copied into the shared memory of the worker once per invocation rather
+  // than once per request. See PackSharedArguments. Disabled when at most 1.
+  explicit V8Dispatcher(int max_requests_per_invocation)
+      : max_requests_per_invocation_(max_requests_per_invocation) {}
+
   // Init the dispatcher. Note that this call may bring up multiple processes,
   // which can be slow and should only happen on server startup.
   //
@@ -79,7 +97,8 @@ class V8Dispatcher {
                                DispatchDoneCallback done_callback) const;
 
   // Execute a batch of requests asynchronously. There are no guarantees
-  // on the order of request processing.
+  // on the order of request processing. The requests packed together for
+  // their shared arguments run one after the other on the same worker.
   //
   // batch: a vector of requests, each executed independently and in parallel
   // batch_callback: called when all requests in the batch are finished.
@@ -89,6 +108,89 @@ class V8Dispatcher {
   virtual absl::Status BatchExecute(
       std::vector<DispatchRequest>& batch,
       BatchDispatchDoneCallback batch_callback) const;
+
+  // Executes a batch of requests and waits up to `timeout` for it to finish,
+  // discarding the outputs. Run after a code load, so that the workers have
+  // compiled and warmed up the loaded code before serving traffic.
+  //
+  // batch: synthetic requests calling the entry points of the loaded code.
+  // return: a status indicating whether the batch was scheduled and finished
+  // within the timeout. Failed executions of the loaded code are not errors.
+  absl::Status WarmUpSync(std::vector<DispatchRequest> batch,
+                          absl::Duration timeout) const;
+
+  // Loads js as the version after the current one, warms it up with
+  // warm_up_requests and then makes it the current version, while requests
+  // keep running on the previous version. Roma evicts versions from its code
+  // cache, so the previous version is dropped once newer ones replace it.
+  //
+  // return: a status indicating whether the code load was successful. A
+  // failed warm up is logged and does not prevent the switch.
+  absl::Status LoadNextVersionSync(absl::string_view js,
+                                   std::vector<DispatchRequest> warm_up_requests,
+                                   absl::Duration warm_up_timeout) const;
+
+  // Bounds the versions loaded by LoadNextVersionSync and
+  // LoadExperimentVersionSync to 1..max_versions: once all of them are
+  // taken, a load reuses the version that has gone the longest without
+  // being current or the version of an experiment, and fails if every
+  // version is. Sized to Roma's code version cache, this keeps Roma from
+  // evicting a version still in use. Unbounded if 0. Call before any load.
+  void SetMaxCodeVersions(int max_versions) ABSL_LOCKS_EXCLUDED(load_mu_);
+
+  // Returns the version made current by the last LoadNextVersionSync, or 0
+  // if code was only loaded with LoadSync.
+  int CurrentVersion() const;
+
+  // Loads js as a new version kept resident alongside the current version,
+  // for the requests of the code experiment experiment_id, and warms it up
+  // with warm_up_requests. A later load for the same experiment replaces the
+  // version of the experiment. Roma must be configured to cache a version
+  // per experiment, in addition to the current version and the one loading.
+  //
+  // return: a status indicating whether the code load was successful. A
+  // failed warm up is logged and does not prevent the switch.
+  absl::Status LoadExperimentVersionSync(
+      absl::string_view experiment_id, absl::string_view js,
+      std::vector<DispatchRequest> warm_up_requests,
+      absl::Duration warm_up_timeout) const;
+
+  // Returns the version loaded for experiment_id by the last
+  // LoadExperimentVersionSync for it, or 0 if there is none.
+  int ExperimentVersion(absl::string_view experiment_id) const
+      ABSL_LOCKS_EXCLUDED(experiments_mu_);
+
+ private:
+  // Schedules the batch on Roma as it is.
+  absl::Status ScheduleBatch(std::vector<DispatchRequest>& batch,
+                             BatchDispatchDoneCallback batch_callback) const;
+
+  // Loads js as a new version and warms it up, returning the version.
+  // Reuses the oldest version retired if max_versions_ are taken.
+  absl::StatusOr<int> LoadAndWarmUpNextVersion(
+      absl::string_view js, std::vector<DispatchRequest> warm_up_requests,
+      absl::Duration warm_up_timeout) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(load_mu_);
+
+  // Makes version, no longer current nor the version of an experiment,
+  // available for reuse.
+  void RetireVersion(int version) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(load_mu_);
+
+  const int max_requests_per_invocation_ = 1;
+
+  // Serializes the loads of new versions.
+  mutable absl::Mutex load_mu_;
+  // Last version loaded, current or experimental.
+  mutable int last_version_ ABSL_GUARDED_BY(load_mu_) = 0;
+  int max_versions_ ABSL_GUARDED_BY(load_mu_) = 0;
+  // Versions no longer in use, the longest retired first.
+  mutable std::deque<int> retired_versions_ ABSL_GUARDED_BY(load_mu_);
+  mutable std::atomic<int> current_version_ = 0;
+
+  mutable absl::Mutex experiments_mu_;
+  mutable absl::flat_hash_map<std::string, int> experiment_versions_
+      ABSL_GUARDED_BY(experiments_mu_);
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
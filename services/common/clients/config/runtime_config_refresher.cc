@@ -0,0 +1,120 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/clients/config/runtime_config_refresher.h"
+
+#include <utility>
+#include <vector>
+
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+RuntimeConfigRefresher::RuntimeConfigRefresher(
+    ParameterValues initial_values, FetchParametersFn fetch,
+    ApplyParametersFn apply, absl::Duration refresh_period,
+    server_common::Executor* executor)
+    : values_(std::move(initial_values)),
+      fetch_(std::move(fetch)),
+      apply_(std::move(apply)),
+      refresh_period_(refresh_period),
+      executor_(executor) {}
+
+void RuntimeConfigRefresher::Start() {
+  absl::MutexLock lock(&mu_);
+  scheduled_ = true;
+  task_id_ = executor_->RunAfter(refresh_period_,
+                                 [this]() { RefreshAndReschedule(); });
+}
+
+void RuntimeConfigRefresher::End() {
+  absl::MutexLock lock(&mu_);
+  ended_ = true;
+  if (scheduled_ && executor_->Cancel(std::move(task_id_))) {
+    scheduled_ = false;
+  }
+  // A refresh that could not be cancelled already started, and must not
+  // outlive the refresher.
+  mu_.Await(absl::Condition(
+      +[](RuntimeConfigRefresher* refresher)
+           ABSL_EXCLUSIVE_LOCKS_REQUIRED(refresher->mu_) {
+             return !refresher->scheduled_ && !refresher->refreshing_;
+           },
+      this));
+}
+
+void RuntimeConfigRefresher::Refresh() {
+  absl::StatusOr<ParameterValues> fetched = fetch_();
+  if (!fetched.ok()) {
+    LOG(WARNING) << "Could not refresh the runtime config: "
+                 << fetched.status();
+    return;
+  }
+  ParameterValues changed;
+  for (auto& [name, value] : *fetched) {
+    auto [it, inserted] = values_.try_emplace(name, value);
+    if (inserted || it->second != value) {
+      it->second = value;
+      changed.insert_or_assign(name, std::move(value));
+    }
+  }
+  if (changed.empty()) {
+    return;
+  }
+  for (const auto& [name, value] : changed) {
+    LOG(INFO) << "Applying runtime config " << name << ": " << value;
+  }
+  apply_(changed);
+}
+
+void RuntimeConfigRefresher::RefreshAndReschedule() {
+  {
+    absl::MutexLock lock(&mu_);
+    scheduled_ = false;
+    if (ended_) {
+      return;
+    }
+    refreshing_ = true;
+  }
+  Refresh();
+  absl::MutexLock lock(&mu_);
+  refreshing_ = false;
+  if (!ended_) {
+    scheduled_ = true;
+    task_id_ = executor_->RunAfter(refresh_period_,
+                                   [this]() { RefreshAndReschedule(); });
+  }
+}
+
+std::unique_ptr<RuntimeConfigRefresher> CreateRuntimeConfigRefresher(
+    const TrustedServersConfigClient& config_client,
+    absl::Span<const absl::string_view> names,
+    RuntimeConfigRefresher::ApplyParametersFn apply,
+    absl::Duration refresh_period, server_common::Executor* executor) {
+  ParameterValues initial_values;
+  for (absl::string_view name : names) {
+    initial_values.try_emplace(name, config_client.GetStringParameter(name));
+  }
+  return std::make_unique<RuntimeConfigRefresher>(
+      std::move(initial_values),
+      [&config_client, names = std::vector<absl::string_view>(
+                           names.begin(), names.end())]() {
+        return config_client.FetchParameters(names);
+      },
+      std::move(apply), refresh_period, executor);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CLIENTS_CONFIG_RUNTIME_CONFIG_REFRESHER_H_
+#define SERVICES_COMMON_CLIENTS_CONFIG_RUNTIME_CONFIG_REFRESHER_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "services/common/clients/config/trusted_server_config_client.h"
+#include "src/cpp/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Values of config parameters, by parameter name.
+using ParameterValues = absl::flat_hash_map<std::string, std::string>;
+
+// Periodically fetches the config parameters that are safe to change while a
+// server runs, and applies the ones that changed, so that they can be tuned
+// without restarting the server.
+class RuntimeConfigRefresher {
+ public:
+  using FetchParametersFn =
+      absl::AnyInvocable<absl::StatusOr<ParameterValues>()>;
+  using ApplyParametersFn =
+      absl::AnyInvocable<void(const ParameterValues& changed)>;
+
+  // initial_values: the values the server started with, which are not
+  // applied again.
+  // fetch: fetches the current values of the parameters, leaving out the
+  // ones not found.
+  // apply: called on the executor with the values that changed since the
+  // last refresh, if any did.
+  RuntimeConfigRefresher(ParameterValues initial_values,
+                         FetchParametersFn fetch, ApplyParametersFn apply,
+                         absl::Duration refresh_period,
+                         server_common::Executor* executor);
+
+  // Not copyable or movable.
+  RuntimeConfigRefresher(const RuntimeConfigRefresher&) = delete;
+  RuntimeConfigRefresher& operator=(const RuntimeConfigRefresher&) = delete;
+
+  // Schedules a refresh every refresh_period.
+  void Start() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Cancels the next refresh scheduled, and waits for the refresh running, if
+  // any, to finish.
+  void End() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Fetches the parameters and applies the ones that changed.
+  void Refresh();
+
+ private:
+  void RefreshAndReschedule() ABSL_LOCKS_EXCLUDED(mu_);
+
+  ParameterValues values_;
+  FetchParametersFn fetch_;
+  ApplyParametersFn apply_;
+  const absl::Duration refresh_period_;
+  server_common::Executor* executor_;
+
+  absl::Mutex mu_;
+  bool ended_ ABSL_GUARDED_BY(mu_) = false;
+  // Keeps track of the next refresh scheduled on the executor.
+  server_common::TaskId task_id_ ABSL_GUARDED_BY(mu_);
+  // Whether a refresh is scheduled and not started, or running.
+  bool scheduled_ ABSL_GUARDED_BY(mu_) = false;
+  bool refreshing_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+// Creates a refresher of the `names` parameters of `config_client`, starting
+// from the values it holds. `config_client` must be initialized, and outlive
+// the refresher.
+std::unique_ptr<RuntimeConfigRefresher> CreateRuntimeConfigRefresher(
+    const TrustedServersConfigClient& config_client,
+    absl::Span<const absl::string_view> names,
+    RuntimeConfigRefresher::ApplyParametersFn apply,
+    absl::Duration refresh_period, server_common::Executor* executor);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_CONFIG_RUNTIME_CONFIG_REFRESHER_H_
@@ -0,0 +1,141 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/config/runtime_config_refresher.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::_;
+using ::testing::Eq;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::Return;
+using ::testing::UnorderedElementsAre;
+
+TEST(RuntimeConfigRefresherTest, AppliesOnlyChangedValues) {
+  ParameterValues fetched = {{"ROMA_TIMEOUT_MS", "100"},
+                             {"DEBUG_LOSS_REPORT_PERCENT", "50"}};
+  std::vector<ParameterValues> applied;
+  RuntimeConfigRefresher refresher(
+      {{"ROMA_TIMEOUT_MS", "100"}, {"DEBUG_LOSS_REPORT_PERCENT", "100"}},
+      [&fetched]() { return fetched; },
+      [&applied](const ParameterValues& changed) {
+        applied.push_back(changed);
+      },
+      absl::Seconds(1), /*executor=*/nullptr);
+
+  refresher.Refresh();
+  refresher.Refresh();
+  fetched["ROMA_TIMEOUT_MS"] = "200";
+  refresher.Refresh();
+
+  ASSERT_EQ(applied.size(), 2);
+  EXPECT_THAT(applied[0],
+              UnorderedElementsAre(Pair("DEBUG_LOSS_REPORT_PERCENT", "50")));
+  EXPECT_THAT(applied[1], UnorderedElementsAre(Pair("ROMA_TIMEOUT_MS", "200")));
+}
+
+TEST(RuntimeConfigRefresherTest, KeepsValuesOnFetchFailure) {
+  int applied = 0;
+  RuntimeConfigRefresher refresher(
+      {{"ROMA_TIMEOUT_MS", "100"}},
+      []() -> absl::StatusOr<ParameterValues> {
+        return absl::UnavailableError("Parameter store unavailable");
+      },
+      [&applied](const ParameterValues& changed) { ++applied; },
+      absl::Seconds(1), /*executor=*/nullptr);
+  refresher.Refresh();
+  EXPECT_EQ(applied, 0);
+}
+
+TEST(RuntimeConfigRefresherTest, RefreshesPeriodicallyUntilEnded) {
+  MockExecutor executor;
+  absl::AnyInvocable<void()> scheduled;
+  EXPECT_CALL(executor, RunAfter(Eq(absl::Seconds(30)), _))
+      .Times(2)
+      .WillRepeatedly([&scheduled](absl::Duration duration,
+                                   absl::AnyInvocable<void()> closure) {
+        scheduled = std::move(closure);
+        return server_common::TaskId();
+      });
+  EXPECT_CALL(executor, Cancel).WillOnce(Return(true));
+
+  int fetches = 0;
+  RuntimeConfigRefresher refresher(
+      {},
+      [&fetches]() {
+        ++fetches;
+        return ParameterValues();
+      },
+      [](const ParameterValues& changed) { EXPECT_THAT(changed, IsEmpty()); },
+      absl::Seconds(30), &executor);
+  refresher.Start();
+  absl::AnyInvocable<void()> first_refresh = std::move(scheduled);
+  first_refresh();
+  EXPECT_EQ(fetches, 1);
+
+  refresher.End();
+  EXPECT_EQ(fetches, 1);
+}
+
+TEST(RuntimeConfigRefresherTest, EndWaitsForTheRunningRefresh) {
+  MockExecutor executor;
+  absl::AnyInvocable<void()> scheduled;
+  EXPECT_CALL(executor, RunAfter)
+      .WillOnce([&scheduled](absl::Duration duration,
+                             absl::AnyInvocable<void()> closure) {
+        scheduled = std::move(closure);
+        return server_common::TaskId();
+      });
+  EXPECT_CALL(executor, Cancel).Times(0);
+
+  absl::Notification fetch_started;
+  absl::Notification release_fetch;
+  std::atomic<bool> fetched = false;
+  RuntimeConfigRefresher refresher(
+      {},
+      [&]() {
+        fetch_started.Notify();
+        release_fetch.WaitForNotification();
+        fetched = true;
+        return ParameterValues();
+      },
+      [](const ParameterValues& changed) {}, absl::Seconds(30), &executor);
+  refresher.Start();
+  std::thread refresh_thread(std::move(scheduled));
+  fetch_started.WaitForNotification();
+
+  std::thread end_thread([&]() {
+    refresher.End();
+    EXPECT_TRUE(fetched);
+  });
+  release_fetch.Notify();
+  end_thread.join();
+  refresh_thread.join();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
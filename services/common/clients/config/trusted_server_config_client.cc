@@ -26,6 +26,7 @@
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "cc/core/interface/errors.h"
 #include "cc/public/core/interface/execution_result.h"
 #include "cc/public/cpio/interface/parameter_client/parameter_client_interface.h"
@@ -67,6 +68,7 @@ absl::Status TrustedServersConfigClient::Init(
     std::string_view config_param_prefix) noexcept {
   // Initialize and run the config client to fetch the corresponding values for
   // empty_parameter.
+  config_param_prefix_ = config_param_prefix;
   config_client_ =
       std::move(config_client_provider_fn_)(ParameterClientOptions());
   PS_RETURN_IF_ERROR(InitAndRunConfigClient());
@@ -109,6 +111,44 @@ absl::Status TrustedServersConfigClient::Init(
   return absl::OkStatus();
 }
 
+absl::StatusOr<absl::flat_hash_map<std::string, std::string>>
+TrustedServersConfigClient::FetchParameters(
+    absl::Span<const absl::string_view> names) const noexcept {
+  if (config_client_ == nullptr) {
+    return absl::FailedPreconditionError(
+        "Config client must be initialized to fetch parameters.");
+  }
+  absl::Mutex mu;
+  absl::flat_hash_map<std::string, std::string> values;
+  absl::BlockingCounter counter(names.size());
+  for (absl::string_view name : names) {
+    GetParameterRequest get_parameter_request;
+    get_parameter_request.set_parameter_name(
+        absl::StrCat(config_param_prefix_, name));
+    ExecutionResult result = config_client_->GetParameter(
+        std::move(get_parameter_request),
+        [name, &mu, &values, &counter](const ExecutionResult& result,
+                                       const GetParameterResponse& response) {
+          if (result.Successful()) {
+            absl::MutexLock lock(&mu);
+            values.insert_or_assign(name, response.parameter_value());
+          } else {
+            VLOG(1) << absl::StrFormat(error_message, name,
+                                       GetErrorMessage(result.status_code));
+          }
+          counter.DecrementCount();
+        });
+    // The callback is not called when the request is not sent.
+    if (!result.Successful()) {
+      LOG(WARNING) << absl::StrFormat(error_message, name,
+                                      GetErrorMessage(result.status_code));
+      counter.DecrementCount();
+    }
+  }
+  counter.Wait();
+  return values;
+}
+
 bool TrustedServersConfigClient::HasParameter(
     absl::string_view name) const noexcept {
   return config_entries_map_.contains(name);
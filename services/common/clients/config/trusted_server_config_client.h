@@ -27,6 +27,8 @@
 #include "absl/functional/any_invocable.h"
 #include "absl/log/check.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/types/span.h"
 #include "cc/core/interface/type_def.h"
 #include "services/common/telemetry/telemetry_flag.h"
 
@@ -82,6 +84,14 @@ class TrustedServersConfigClient {
   // Fetches the int value for the specified config parameter.
   int GetIntParameter(absl::string_view name) const noexcept;
 
+  // Fetches the current values of the `names` parameters from the cloud
+  // metadata store again, for the parameters that can change while the
+  // server runs. The values held by the client are left unchanged, so that
+  // the values read at startup stay valid. Parameters not found in the store
+  // are left out of the values returned. Fails if Init was not called.
+  absl::StatusOr<absl::flat_hash_map<std::string, std::string>>
+  FetchParameters(absl::Span<const absl::string_view> names) const noexcept;
+
   // Fetches custom flag value for the specified config parameter.
   template <typename T>
   T GetCustomParameter(absl::string_view name) const noexcept {
@@ -128,6 +138,8 @@ class TrustedServersConfigClient {
  private:
   std::unique_ptr<google::scp::cpio::ParameterClientInterface> config_client_;
   absl::flat_hash_map<std::string, std::string> config_entries_map_;
+  // Prefix of the parameter names in the cloud metadata store, set by Init.
+  std::string config_param_prefix_;
   absl::AnyInvocable<
       std::unique_ptr<google::scp::cpio::ParameterClientInterface>(
           google::scp::cpio::ParameterClientOptions) &&>
@@ -279,5 +279,54 @@ TEST(TrustedServerConfigClientTest, PrependsFlagNamesWithTag) {
             "config_value_1");
 }
 
+TEST(TrustedServerConfigClientTest, FetchesParametersAgainWithoutUpdating) {
+  std::string parameter_value = "10";
+  TrustedServersConfigClient config_client(
+      {"config_param_1", "config_param_4"},
+      [&parameter_value](ParameterClientOptions parameter_client_options)
+          -> std::unique_ptr<ParameterClientInterface> {
+        std::unique_ptr<MockParameterClient> mock_config_client =
+            std::make_unique<MockParameterClient>();
+        EXPECT_CALL(*mock_config_client, Init())
+            .WillOnce(Return(SuccessExecutionResult()));
+        EXPECT_CALL(*mock_config_client, Run())
+            .WillOnce(Return(SuccessExecutionResult()));
+        EXPECT_CALL(*mock_config_client, GetParameter)
+            .WillRepeatedly([&parameter_value](
+                                GetParameterRequest get_param_req,
+                                Callback<GetParameterResponse> callback)
+                                -> ExecutionResult {
+              GetParameterResponse response;
+              if (get_param_req.parameter_name() == "Prefix-config_param_4") {
+                response.set_parameter_value(parameter_value);
+                callback(SuccessExecutionResult(), response);
+              } else {
+                callback(FailureExecutionResult(
+                             google::scp::core::errors::
+                                 SC_CPIO_RESOURCE_NOT_FOUND),
+                         response);
+              }
+              return SuccessExecutionResult();
+            });
+        return std::move(mock_config_client);
+      });
+  config_client.SetFlagForTest("value_1", "config_param_1");
+  ASSERT_TRUE(config_client.Init("Prefix-").ok());
+
+  parameter_value = "20";
+  absl::StatusOr<absl::flat_hash_map<std::string, std::string>> values =
+      config_client.FetchParameters({"config_param_1", "config_param_4"});
+  ASSERT_TRUE(values.ok()) << values.status();
+  EXPECT_EQ(*values, (absl::flat_hash_map<std::string, std::string>{
+                         {"config_param_4", "20"}}));
+  EXPECT_EQ(config_client.GetIntParameter("config_param_4"), 10);
+  EXPECT_EQ(config_client.GetStringParameter("config_param_1"), "value_1");
+}
+
+TEST(TrustedServerConfigClientTest, FailsToFetchParametersBeforeInit) {
+  TrustedServersConfigClient config_client({"config_param_1"});
+  EXPECT_FALSE(config_client.FetchParameters({"config_param_1"}).ok());
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,79 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/clients/http/curl_handle_pool.h"
+
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+CurlHandlePool::CurlHandlePool(size_t max_idle_handles,
+                               absl::AnyInvocable<void(CURL*) const> configure)
+    : max_idle_handles_(max_idle_handles), configure_(std::move(configure)) {}
+
+CurlHandlePool::~CurlHandlePool() {
+  absl::MutexLock lock(&mu_);
+  for (PooledCurlHandle& handle : idle_handles_) {
+    Cleanup(handle);
+  }
+}
+
+PooledCurlHandle CurlHandlePool::Acquire() {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!idle_handles_.empty()) {
+      PooledCurlHandle handle = std::move(idle_handles_.back());
+      idle_handles_.pop_back();
+      return handle;
+    }
+  }
+  PooledCurlHandle handle = {.curl = curl_easy_init()};
+  configure_(handle.curl);
+  return handle;
+}
+
+void CurlHandlePool::Release(PooledCurlHandle handle) {
+  if (handle.curl == nullptr) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&mu_);
+    if (idle_handles_.size() < max_idle_handles_) {
+      idle_handles_.push_back(std::move(handle));
+      return;
+    }
+  }
+  Cleanup(handle);
+}
+
+void CurlHandlePool::SetHeaders(const std::vector<std::string>& headers,
+                                PooledCurlHandle& handle) {
+  if (handle.headers != headers) {
+    curl_slist_free_all(handle.headers_list);
+    handle.headers_list = nullptr;
+    for (const std::string& header : headers) {
+      handle.headers_list =
+          curl_slist_append(handle.headers_list, header.c_str());
+    }
+    handle.headers = headers;
+  }
+  curl_easy_setopt(handle.curl, CURLOPT_HTTPHEADER, handle.headers_list);
+}
+
+void CurlHandlePool::Cleanup(PooledCurlHandle& handle) {
+  curl_slist_free_all(handle.headers_list);
+  curl_easy_cleanup(handle.curl);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,77 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_CURL_HANDLE_POOL_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_CURL_HANDLE_POOL_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "curl/curl.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// A libcurl easy handle, with the list of the request headers it was last set
+// to send.
+struct PooledCurlHandle {
+  CURL* curl = nullptr;
+  std::vector<std::string> headers;
+  struct curl_slist* headers_list = nullptr;
+};
+
+// Keeps the easy handles of finished requests for reuse by the next ones,
+// instead of a curl_easy_init, the setting of the options common to all the
+// requests and a curl_easy_cleanup per request. A reused handle keeps the
+// per-request options of its previous request, so every request must set all
+// of them. Thread safe.
+class CurlHandlePool final {
+ public:
+  // Keeps at most max_idle_handles idle handles. configure sets the options
+  // common to all the requests on each new handle.
+  CurlHandlePool(size_t max_idle_handles,
+                 absl::AnyInvocable<void(CURL*) const> configure);
+  // Cleans up the idle handles.
+  ~CurlHandlePool();
+
+  // Not copyable or movable.
+  CurlHandlePool(const CurlHandlePool&) = delete;
+  CurlHandlePool& operator=(const CurlHandlePool&) = delete;
+
+  // Returns an idle handle, or a new configured one if none is idle.
+  PooledCurlHandle Acquire() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Makes the handle of a finished request idle, or cleans it up if the pool
+  // is full.
+  void Release(PooledCurlHandle handle) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sets the request headers of the handle, rebuilding its header list only
+  // if they differ from the ones of its previous request.
+  static void SetHeaders(const std::vector<std::string>& headers,
+                         PooledCurlHandle& handle);
+
+ private:
+  static void Cleanup(PooledCurlHandle& handle);
+
+  const size_t max_idle_handles_;
+  const absl::AnyInvocable<void(CURL*) const> configure_;
+  absl::Mutex mu_;
+  std::vector<PooledCurlHandle> idle_handles_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_CURL_HANDLE_POOL_H_
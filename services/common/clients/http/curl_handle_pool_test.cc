@@ -0,0 +1,91 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/clients/http/curl_handle_pool.h"
+
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+class CurlHandlePoolTest : public ::testing::Test {
+ protected:
+  CurlHandlePoolTest() { curl_global_init(CURL_GLOBAL_ALL); }
+  ~CurlHandlePoolTest() override { curl_global_cleanup(); }
+};
+
+TEST_F(CurlHandlePoolTest, ConfiguresNewHandles) {
+  int configured = 0;
+  CurlHandlePool pool(/*max_idle_handles=*/1,
+                      [&configured](CURL* curl) { ++configured; });
+  PooledCurlHandle first = pool.Acquire();
+  PooledCurlHandle second = pool.Acquire();
+
+  EXPECT_NE(first.curl, nullptr);
+  EXPECT_NE(first.curl, second.curl);
+  EXPECT_EQ(configured, 2);
+  pool.Release(std::move(first));
+  pool.Release(std::move(second));
+}
+
+TEST_F(CurlHandlePoolTest, ReusesReleasedHandle) {
+  int configured = 0;
+  CurlHandlePool pool(/*max_idle_handles=*/1,
+                      [&configured](CURL* curl) { ++configured; });
+  PooledCurlHandle handle = pool.Acquire();
+  CURL* curl = handle.curl;
+  pool.Release(std::move(handle));
+
+  handle = pool.Acquire();
+  EXPECT_EQ(handle.curl, curl);
+  EXPECT_EQ(configured, 1);
+  pool.Release(std::move(handle));
+}
+
+TEST_F(CurlHandlePoolTest, KeepsAtMostMaxIdleHandles) {
+  int configured = 0;
+  CurlHandlePool pool(/*max_idle_handles=*/1,
+                      [&configured](CURL* curl) { ++configured; });
+  PooledCurlHandle first = pool.Acquire();
+  PooledCurlHandle second = pool.Acquire();
+  pool.Release(std::move(first));
+  pool.Release(std::move(second));
+
+  PooledCurlHandle kept = pool.Acquire();
+  PooledCurlHandle created = pool.Acquire();
+  EXPECT_EQ(configured, 3);
+  pool.Release(std::move(kept));
+  pool.Release(std::move(created));
+}
+
+TEST_F(CurlHandlePoolTest, RebuildsHeaderListOnlyForNewHeaders) {
+  CurlHandlePool pool(/*max_idle_handles=*/1, [](CURL* curl) {});
+  PooledCurlHandle handle = pool.Acquire();
+  CurlHandlePool::SetHeaders({"A: 1", "B: 2"}, handle);
+  struct curl_slist* headers_list = handle.headers_list;
+  ASSERT_NE(headers_list, nullptr);
+  EXPECT_STREQ(headers_list->data, "A: 1");
+
+  CurlHandlePool::SetHeaders({"A: 1", "B: 2"}, handle);
+  EXPECT_EQ(handle.headers_list, headers_list);
+
+  CurlHandlePool::SetHeaders({}, handle);
+  EXPECT_EQ(handle.headers_list, nullptr);
+  pool.Release(std::move(handle));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
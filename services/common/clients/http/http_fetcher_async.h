@@ -16,23 +16,73 @@
 #define SERVICES_COMMON_CLIENTS_HTTP_FETCHER_ASYNC_H_
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+class CancellationToken;
+
 struct HTTPRequest {
   std::string url;
   // Optional
   std::vector<std::string> headers = {};
+  // Optional. If not empty, the request is a POST of the body instead of a GET.
+  std::string body = {};
+  // Optional. Sends the request over a new connection rather than a reused
+  // one, e.g. to reach another backend behind a load balanced address.
+  bool fresh_connection = false;
+  // Optional. Aborts the fetch, which then fails with CANCELLED, once
+  // cancelled. Must outlive the fetch. Fetchers may ignore it.
+  CancellationToken* cancellation = nullptr;
+};
+
+// HTTP status code of a response to a conditional request whose validators
+// still match the resource.
+inline constexpr long kHttpStatusNotModified = 304;
+
+// A response body together with the metadata needed to issue conditional
+// requests (If-None-Match / If-Modified-Since) for the same resource.
+struct HTTPResponse {
+  std::string body;
+  long status_code = 0;
+  // Values of the ETag and Last-Modified response headers, empty if absent.
+  std::string etag;
+  std::string last_modified;
+  // Value of the Cache-Control response header, empty if absent.
+  std::string cache_control;
+};
+
+// Receives the body of a response while it is transferred, e.g. to parse it
+// incrementally, instead of the body being buffered in the HTTPResponse.
+// The methods may run on the I/O thread of the fetcher, and should return
+// promptly.
+class HttpBodyConsumer {
+ public:
+  virtual ~HttpBodyConsumer() = default;
+
+  // Invoked before the first chunk of the body with the length of the body
+  // as transferred, if the server sent it, e.g. to reserve a buffer.
+  virtual void OnContentLength(size_t length) {}
+
+  // Invoked with each chunk of the body, in order. Returns false to abort the
+  // fetch, which then fails.
+  virtual bool OnData(absl::string_view chunk) = 0;
 };
 
 using OnDoneFetchUrl = absl::AnyInvocable<void(absl::StatusOr<std::string>) &&>;
 using OnDoneFetchUrls =
     absl::AnyInvocable<void(std::vector<absl::StatusOr<std::string>>) &&>;
+using OnDoneFetchUrlsWithMetadata =
+    absl::AnyInvocable<void(std::vector<absl::StatusOr<HTTPResponse>>) &&>;
+using OnDoneFetchUrlStreaming =
+    absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&>;
 
 class HttpFetcherAsync {
  public:
@@ -43,7 +93,7 @@ class HttpFetcherAsync {
 
   // Fetches the specified url.
   //
-  // http_request: The URL and headers for the HTTP GET request.
+  // http_request: The URL, headers and optional body of the HTTP request.
   // timeout_ms: The request timeout
   // done_callback: Output param. Invoked either on error or after finished
   // receiving a response. Please note that done_callback will run in a
@@ -65,6 +115,57 @@ class HttpFetcherAsync {
   virtual void FetchUrls(const std::vector<HTTPRequest>& requests,
                          absl::Duration timeout,
                          OnDoneFetchUrls done_callback) = 0;
+
+  // Same as FetchUrls, but also returns the status code and the validators of
+  // each response. A kHttpStatusNotModified response has an empty body.
+  // The default implementation has no access to the response headers and
+  // reports every successful fetch as a 200 without validators.
+  virtual void FetchUrlsWithMetadata(
+      const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+      OnDoneFetchUrlsWithMetadata done_callback) {
+    FetchUrls(requests, timeout,
+              [done_callback = std::move(done_callback)](
+                  std::vector<absl::StatusOr<std::string>> results) mutable {
+                std::vector<absl::StatusOr<HTTPResponse>> responses;
+                responses.reserve(results.size());
+                for (auto& result : results) {
+                  if (!result.ok()) {
+                    responses.push_back(result.status());
+                    continue;
+                  }
+                  responses.push_back(HTTPResponse{.body = *std::move(result),
+                                                   .status_code = 200});
+                }
+                std::move(done_callback)(std::move(responses));
+              });
+  }
+
+  // Same as FetchUrlsWithMetadata for a single request, but hands the body of
+  // the response to body_consumer instead of the HTTPResponse, whose body is
+  // left empty. body_consumer must outlive the call to done_callback.
+  // The default implementation hands the body in a single chunk once the
+  // response is fully received.
+  virtual void FetchUrlStreaming(const HTTPRequest& request,
+                                 absl::Duration timeout,
+                                 HttpBodyConsumer* body_consumer,
+                                 OnDoneFetchUrlStreaming done_callback) {
+    FetchUrlsWithMetadata(
+        {request}, timeout,
+        [body_consumer, done_callback = std::move(done_callback)](
+            std::vector<absl::StatusOr<HTTPResponse>> responses) mutable {
+          absl::StatusOr<HTTPResponse>& response = responses[0];
+          if (response.ok() && !response->body.empty()) {
+            body_consumer->OnContentLength(response->body.size());
+            if (!body_consumer->OnData(response->body)) {
+              std::move(done_callback)(
+                  absl::AbortedError("Response body rejected by the consumer"));
+              return;
+            }
+            response->body.clear();
+          }
+          std::move(done_callback)(std::move(response));
+        });
+  }
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
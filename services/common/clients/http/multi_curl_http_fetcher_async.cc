@@ -14,11 +14,17 @@
 
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <curl/curl.h>
 
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "glog/logging.h"
@@ -27,19 +33,23 @@ namespace privacy_sandbox::bidding_auction_servers {
 using ::grpc_event_engine::experimental::EventEngine;
 
 namespace {
-// Parses curl message to result string or an error message for the callback.
-absl::StatusOr<std::string> GetResultFromMsg(CURLMsg* msg) {
-  std::string* output;
+// Parses curl message to the response or an error message for the callback.
+absl::StatusOr<HTTPResponse> GetResultFromMsg(CURLMsg* msg) {
+  HTTPResponse* response;
   if (msg->msg == CURLMSG_DONE) {
     auto result_msg = curl_easy_strerror(msg->data.result);
     switch (msg->data.result) {
       case CURLE_OK:
-        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &output);
-        return *output;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &response);
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_RESPONSE_CODE,
+                          &response->status_code);
+        return std::move(*response);
       case CURLE_OPERATION_TIMEDOUT:
         return absl::DeadlineExceededError(result_msg);
       case CURLE_URL_MALFORMAT:
         return absl::InvalidArgumentError(result_msg);
+      case CURLE_WRITE_ERROR:
+        return absl::AbortedError(result_msg);
       default:
         return absl::InternalError(result_msg);
     }
@@ -48,6 +58,26 @@ absl::StatusOr<std::string> GetResultFromMsg(CURLMsg* msg) {
   }
 }
 
+// Keeps only the body of the response, for the FetchUrl(s) callers.
+absl::StatusOr<std::string> ToBody(absl::StatusOr<HTTPResponse> result) {
+  if (!result.ok()) {
+    return result.status();
+  }
+  return std::move(result->body);
+}
+
+// Numbers of completed requests sent over a reused or a new connection, read
+// and reset by GetHttpConnectionReuse.
+std::atomic<int64_t> reused_connection_requests = 0;
+std::atomic<int64_t> new_connection_requests = 0;
+
+// Max time the event loop waits for libcurl sockets or timeouts before it
+// checks for shutdown again.
+constexpr absl::Duration kEventLoopMaxWait = absl::Seconds(1);
+
+// Max easy handles kept idle for reuse, about the requests in flight at peak.
+constexpr size_t kMaxIdleCurlHandles = 512;
+
 constexpr int log_level = 2;
 struct CurlTimeStats {
   double time_namelookup = -1;
@@ -116,27 +146,83 @@ void GetTraceFromCurl(CURL* handle) {
 
 MultiCurlHttpFetcherAsync::MultiCurlHttpFetcherAsync(
     server_common::Executor* executor, int64_t keepalive_interval_sec,
-    int64_t keepalive_idle_sec)
+    int64_t keepalive_idle_sec, bool use_event_loop,
+    bool enable_http2_multiplexing, bool http2_prior_knowledge)
     : executor_(executor),
       keepalive_idle_sec_(keepalive_idle_sec),
-      keepalive_interval_sec_(keepalive_interval_sec) {
+      keepalive_interval_sec_(keepalive_interval_sec),
+      use_event_loop_(use_event_loop),
+      enable_http2_multiplexing_(enable_http2_multiplexing),
+      multi_curl_request_manager_(use_event_loop, enable_http2_multiplexing),
+      handle_pool_(std::make_shared<CurlHandlePool>(
+          kMaxIdleCurlHandles,
+          // Sets the options common to all the requests. Captures the values
+          // rather than this, since the pool can outlive the fetcher.
+          [keepalive_idle_sec, keepalive_interval_sec,
+           enable_http2_multiplexing, http2_prior_knowledge](CURL* handle) {
+            curl_easy_setopt(handle, CURLOPT_FOLLOWLOCATION, 1);
+            // Enable TCP keep-alive to keep connection warm.
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE,
+                             static_cast<long>(keepalive_idle_sec));
+            curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL,
+                             static_cast<long>(keepalive_interval_sec));
+            // Allow upto 1200 seconds idle time.
+            curl_easy_setopt(handle, CURLOPT_MAXAGE_CONN, 1200L);
+            // Set CURLOPT_ACCEPT_ENCODING to an empty string to pass all
+            // supported encodings. See
+            // https://curl.se/libcurl/c/CURLOPT_ACCEPT_ENCODING.html.
+            curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+            if (enable_http2_multiplexing) {
+              // Negotiate HTTP/2 with ALPN over TLS, unless the backend is
+              // known to serve it, and wait for a pending connection to the
+              // same host rather than opening another one.
+              curl_easy_setopt(handle, CURLOPT_HTTP_VERSION,
+                               http2_prior_knowledge
+                                   ? CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE
+                                   : CURL_HTTP_VERSION_2TLS);
+              curl_easy_setopt(handle, CURLOPT_PIPEWAIT, 1L);
+            }
+          })) {
   // Start execution loop.
-  executor_->Run([this]() { ExecuteLoop(); });
+  if (use_event_loop_) {
+    event_loop_thread_ = std::thread([this]() { RunEventLoop(); });
+  } else {
+    executor_->Run([this]() { ExecuteLoop(); });
+  }
 }
 
 MultiCurlHttpFetcherAsync::~MultiCurlHttpFetcherAsync()
     ABSL_LOCKS_EXCLUDED(in_loop_mu_, curl_data_map_lock_) {
   // Notify other threads about shutdown.
   shutdown_requested_.Notify();
+  if (use_event_loop_) {
+    multi_curl_request_manager_.Wakeup();
+    event_loop_thread_.join();
+  }
   shutdown_complete_.WaitForNotification();
   // We ensure that no other thread will lock callback_map_lock_ and in_loop_mu_
   // here since no new requests are being accepted, or processed through
   // the execution loop.
   absl::MutexLock l1(&in_loop_mu_);
-  absl::MutexLock l2(&curl_data_map_lock_);
-  // Execute all callbacks and clean up handles
-  for (auto& [handle, handle_data] : curl_data_map_) {
-    multi_curl_request_manager_.Remove(handle);
+  std::vector<std::unique_ptr<CurlRequestData>> pending;
+  {
+    absl::MutexLock l2(&curl_data_map_lock_);
+    for (auto& [handle, handle_data] : curl_data_map_) {
+      multi_curl_request_manager_.Remove(handle);
+      pending.push_back(std::move(handle_data));
+    }
+    curl_data_map_.clear();
+    for (auto& handle_data : cancelled_requests_) {
+      multi_curl_request_manager_.Remove(handle_data->handle.curl);
+      pending.push_back(std::move(handle_data));
+    }
+    cancelled_requests_.clear();
+  }
+  // Execute all callbacks, without curl_data_map_lock_, which the
+  // cancellations being deregistered may wait for.
+  for (auto& handle_data : pending) {
+    handle_data->EndCancellation();
     std::move(handle_data->done_callback)(
         absl::InternalError("Request cancelled due to server shutdown."));
   }
@@ -158,12 +244,57 @@ static size_t WriteCallback(char* data, size_t size, size_t number_elements,
   return size * number_elements;
 }
 
+// Max bytes reserved for a body from its Content-Length, so that a bogus
+// length cannot reserve an unbounded buffer.
+constexpr size_t kMaxBodyReservation = 64 * 1024 * 1024;
+
+// Keeps the validators and the Cache-Control header of the response in the
+// HTTPResponse and, if reserve_body, reserves its body from the
+// Content-Length header. Follows the signature required by libcurl, see
+// https://curl.se/libcurl/c/CURLOPT_HEADERFUNCTION.html. The callback is
+// invoked once per header line, including the status line of every response
+// when redirects are followed.
+template <bool reserve_body>
+static size_t HeaderCallback(char* data, size_t size, size_t number_elements,
+                             HTTPResponse* response) {
+  absl::string_view line(data, size * number_elements);
+  if (absl::StartsWith(line, "HTTP/")) {
+    // Only the headers of the last response in a redirect chain apply.
+    response->etag.clear();
+    response->last_modified.clear();
+    response->cache_control.clear();
+    return line.size();
+  }
+  size_t colon = line.find(':');
+  if (colon == absl::string_view::npos) {
+    return line.size();
+  }
+  absl::string_view name = absl::StripAsciiWhitespace(line.substr(0, colon));
+  absl::string_view value = absl::StripAsciiWhitespace(line.substr(colon + 1));
+  if (size_t length; reserve_body &&
+                     absl::EqualsIgnoreCase(name, "Content-Length") &&
+                     absl::SimpleAtoi(value, &length)) {
+    // Sizes the body once rather than growing it chunk by chunk. The length
+    // is that of the encoded body, so a compressed body may still grow.
+    response->body.reserve(std::min(length, kMaxBodyReservation));
+  } else if (absl::EqualsIgnoreCase(name, "ETag")) {
+    response->etag = std::string(value);
+  } else if (absl::EqualsIgnoreCase(name, "Last-Modified")) {
+    response->last_modified = std::string(value);
+  } else if (absl::EqualsIgnoreCase(name, "Cache-Control")) {
+    response->cache_control = std::string(value);
+  }
+  return line.size();
+}
+
 // FetchUrlsLifetime manages a single FetchUrls request and encapsulates
 // all of the data each individual FetchUrl callback will need.
+template <typename Result>
 struct FetchUrlsLifetime {
-  OnDoneFetchUrls all_done_callback;
+  absl::AnyInvocable<void(std::vector<absl::StatusOr<Result>>) &&>
+      all_done_callback;
   // Results will be passed into all_done_callback.
-  std::vector<absl::StatusOr<std::string>> results;
+  std::vector<absl::StatusOr<Result>> results;
   // This is used to guard pending_results
   // to keep the count accurate when updated by
   // different threads.
@@ -171,65 +302,155 @@ struct FetchUrlsLifetime {
   int pending_results;
 };
 
-void MultiCurlHttpFetcherAsync::FetchUrls(
+template <typename Result, typename ToResult>
+void MultiCurlHttpFetcherAsync::FetchUrlsInParallel(
     const std::vector<HTTPRequest>& requests, absl::Duration timeout,
-    OnDoneFetchUrls done_callback) {
+    absl::AnyInvocable<void(std::vector<absl::StatusOr<Result>>) &&>
+        done_callback,
+    ToResult to_result) {
   // The FetchUrl lambdas are the owners of the underlying FetchUrlsLifetime and
   // this shared_ptr will be destructed once the last FetchUrl lambda finishes.
   // Using a shared_ptr here allows us to avoid making MultiCurlHttpFetcherAsync
   // the owner of the FetchUrlsLifetime, which would complicate cleanup on
   // MultiCurlHttpFetcherAsync destruction during a pending FetchUrls call.
-  std::shared_ptr<FetchUrlsLifetime> shared_lifetime =
-      std::make_shared<FetchUrlsLifetime>();
+  auto shared_lifetime = std::make_shared<FetchUrlsLifetime<Result>>();
   shared_lifetime->pending_results = requests.size();
   shared_lifetime->all_done_callback = std::move(done_callback);
   shared_lifetime->results =
-      std::vector<absl::StatusOr<std::string>>(requests.size());
+      std::vector<absl::StatusOr<Result>>(requests.size());
 
   for (int i = 0; i < requests.size(); i++) {
-    FetchUrl(requests.at(i), absl::ToInt64Milliseconds(timeout),
-             [i, shared_lifetime](absl::StatusOr<std::string> result) {
-               absl::MutexLock lock_results(&shared_lifetime->results_mu);
-               shared_lifetime->results[i] = std::move(result);
-               if (--shared_lifetime->pending_results == 0) {
-                 std::move(shared_lifetime->all_done_callback)(
-                     std::move(shared_lifetime->results));
-               }
-             });
+    FetchUrlWithMetadata(
+        requests.at(i), absl::ToInt64Milliseconds(timeout),
+        [i, shared_lifetime,
+         to_result](absl::StatusOr<HTTPResponse> result) mutable {
+          absl::MutexLock lock_results(&shared_lifetime->results_mu);
+          shared_lifetime->results[i] = to_result(std::move(result));
+          if (--shared_lifetime->pending_results == 0) {
+            std::move(shared_lifetime->all_done_callback)(
+                std::move(shared_lifetime->results));
+          }
+        });
   }
 }
 
+void MultiCurlHttpFetcherAsync::FetchUrls(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrls done_callback) {
+  FetchUrlsInParallel<std::string>(requests, timeout, std::move(done_callback),
+                                   ToBody);
+}
+
+void MultiCurlHttpFetcherAsync::FetchUrlsWithMetadata(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrlsWithMetadata done_callback) {
+  FetchUrlsInParallel<HTTPResponse>(
+      requests, timeout, std::move(done_callback),
+      [](absl::StatusOr<HTTPResponse> result) { return result; });
+}
+
 void MultiCurlHttpFetcherAsync::FetchUrl(const HTTPRequest& request,
                                          int timeout_ms,
-                                         OnDoneFetchUrl done_callback)
+                                         OnDoneFetchUrl done_callback) {
+  FetchUrlWithMetadata(
+      request, timeout_ms,
+      [done_callback = std::move(done_callback)](
+          absl::StatusOr<HTTPResponse> result) mutable {
+        std::move(done_callback)(ToBody(std::move(result)));
+      });
+}
+
+void MultiCurlHttpFetcherAsync::FetchUrlStreaming(
+    const HTTPRequest& request, absl::Duration timeout,
+    HttpBodyConsumer* body_consumer, OnDoneFetchUrlStreaming done_callback) {
+  FetchUrlWithMetadata(request, absl::ToInt64Milliseconds(timeout),
+                       std::move(done_callback), body_consumer);
+}
+
+size_t MultiCurlHttpFetcherAsync::StreamBody(char* data, size_t size,
+                                             size_t number_elements,
+                                             CurlRequestData* request_data) {
+  if (!request_data->content_length_reported) {
+    request_data->content_length_reported = true;
+    curl_off_t length = -1;
+    if (curl_easy_getinfo(request_data->handle.curl,
+                          CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                          &length) == CURLE_OK &&
+        length >= 0) {
+      request_data->body_consumer->OnContentLength(length);
+    }
+  }
+  // Returning less than the chunk size makes libcurl abort the transfer with
+  // CURLE_WRITE_ERROR.
+  return request_data->body_consumer->OnData(
+             absl::string_view(data, size * number_elements))
+             ? size * number_elements
+             : 0;
+}
+
+void MultiCurlHttpFetcherAsync::FetchUrlWithMetadata(
+    const HTTPRequest& request, int timeout_ms,
+    OnDoneFetchUrlWithMetadata done_callback, HttpBodyConsumer* body_consumer)
     ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
+  if (request.cancellation != nullptr && request.cancellation->IsCancelled()) {
+    RecordCancelledWork(CancelledWork::kHttpFetch);
+    std::move(done_callback)(absl::CancelledError("The fetch was cancelled"));
+    return;
+  }
   auto curl_request_data = std::make_unique<CurlRequestData>(
-      request.headers, std::move(done_callback));
-  CURL* req_handle = curl_request_data->req_handle;
-  curl_easy_setopt(req_handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+      handle_pool_, request.headers, std::move(done_callback));
+  // The handle may be reused, so every option set for a previous request is
+  // set again.
+  CURL* req_handle = curl_request_data->handle.curl;
   curl_easy_setopt(req_handle, CURLOPT_URL, request.url.begin());
-  curl_easy_setopt(req_handle, CURLOPT_WRITEDATA,
-                   curl_request_data->output.get());
+  if (body_consumer != nullptr) {
+    curl_request_data->body_consumer = body_consumer;
+    curl_easy_setopt(req_handle, CURLOPT_WRITEFUNCTION, StreamBody);
+    curl_easy_setopt(req_handle, CURLOPT_WRITEDATA, curl_request_data.get());
+    curl_easy_setopt(req_handle, CURLOPT_HEADERFUNCTION,
+                     HeaderCallback</*reserve_body=*/false>);
+  } else {
+    curl_easy_setopt(req_handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+    curl_easy_setopt(req_handle, CURLOPT_WRITEDATA,
+                     &curl_request_data->response->body);
+    curl_easy_setopt(req_handle, CURLOPT_HEADERFUNCTION,
+                     HeaderCallback</*reserve_body=*/true>);
+  }
+  curl_easy_setopt(req_handle, CURLOPT_HEADERDATA,
+                   curl_request_data->response.get());
   curl_easy_setopt(req_handle, CURLOPT_PRIVATE,
-                   curl_request_data->output.get());
-  curl_easy_setopt(req_handle, CURLOPT_FOLLOWLOCATION, 1);
+                   curl_request_data->response.get());
   curl_easy_setopt(req_handle, CURLOPT_TIMEOUT_MS, timeout_ms);
-  // Enable TCP keep-alive to keep connection warm.
-  curl_easy_setopt(req_handle, CURLOPT_TCP_KEEPALIVE, 1L);
-  curl_easy_setopt(req_handle, CURLOPT_TCP_KEEPIDLE,
-                   static_cast<long>(keepalive_idle_sec_));
-  curl_easy_setopt(req_handle, CURLOPT_TCP_KEEPINTVL,
-                   static_cast<long>(keepalive_interval_sec_));
-  // Allow upto 1200 seconds idle time.
-  curl_easy_setopt(req_handle, CURLOPT_MAXAGE_CONN, 1200L);
-  // Set CURLOPT_ACCEPT_ENCODING to an empty string to pass all supported
-  // encodings. See https://curl.se/libcurl/c/CURLOPT_ACCEPT_ENCODING.html.
-  curl_easy_setopt(req_handle, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(req_handle, CURLOPT_FRESH_CONNECT,
+                   request.fresh_connection ? 1L : 0L);
+
+  if (!request.body.empty()) {
+    curl_request_data->body = request.body;
+    curl_easy_setopt(req_handle, CURLOPT_POSTFIELDSIZE_LARGE,
+                     static_cast<curl_off_t>(curl_request_data->body.size()));
+    curl_easy_setopt(req_handle, CURLOPT_POSTFIELDS,
+                     curl_request_data->body.data());
+  } else {
+    // Turns a handle last used for a POST back to GET.
+    curl_easy_setopt(req_handle, CURLOPT_HTTPGET, 1L);
+  }
 
   // Set HTTP headers.
-  if (!request.headers.empty()) {
-    curl_easy_setopt(req_handle, CURLOPT_HTTPHEADER,
-                     curl_request_data->headers_list_ptr);
+  CurlHandlePool::SetHeaders(request.headers, curl_request_data->handle);
+
+  int64_t sequence = 0;
+  if (request.cancellation != nullptr) {
+    sequence = next_request_sequence_.fetch_add(1, std::memory_order_relaxed);
+    curl_request_data->sequence = sequence;
+    curl_request_data->cancellation = request.cancellation;
+    curl_request_data->cancellation_id = request.cancellation->Register(
+        [this, req_handle]() { Cancel(req_handle); });
+  }
+
+  // The request data is tracked before the handle is added, since the loop
+  // can finish the request as soon as it is in the multi session.
+  if (!Add(req_handle, std::move(curl_request_data))) {
+    return;
   }
 
   // Check for errors from multi handle here and execute callback immediately.
@@ -244,34 +465,120 @@ void MultiCurlHttpFetcherAsync::FetchUrl(const HTTPRequest& request,
     case CURLM_BAD_FUNCTION_ARGUMENT:
     case CURLM_ABORTED_BY_CALLBACK:
     case CURLM_UNRECOVERABLE_POLL:
-    case CURLM_UNKNOWN_OPTION:
+    case CURLM_UNKNOWN_OPTION: {
+      {
+        absl::MutexLock l(&curl_data_map_lock_);
+        auto it = curl_data_map_.find(req_handle);
+        if (it == curl_data_map_.end()) {
+          // Cancelled by the destructor.
+          return;
+        }
+        curl_request_data = std::move(it->second);
+        curl_data_map_.erase(it);
+      }
+      curl_request_data->EndCancellation();
       std::move(curl_request_data->done_callback)(absl::InternalError(
           absl::StrCat("Failed to invoke request via curl with error ",
                        curl_multi_strerror(mc))));
       return;
+    }
     case CURLM_CALL_MULTI_PERFORM:
     case CURLM_OK:
     case CURLM_ADDED_ALREADY:
     case CURLM_RECURSIVE_API_CALL:
     case CURLM_LAST:
-      Add(req_handle, std::move(curl_request_data));
       break;
   }
+  if (request.cancellation != nullptr) {
+    OnCancellableAdded(req_handle, sequence);
+  }
 }
 
-void MultiCurlHttpFetcherAsync::Add(
+bool MultiCurlHttpFetcherAsync::Add(
     CURL* handle, std::unique_ptr<CurlRequestData> curl_request_data)
     ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
   // If shutdown has been initiated while we were preparing/adding request.
   if (shutdown_requested_.HasBeenNotified()) {
+    curl_request_data->EndCancellation();
     std::move(curl_request_data->done_callback)(
         absl::InternalError("Client is shutting down."));
-    return;
+    return false;
   }
 
   // Add callback to map.
   absl::MutexLock l(&curl_data_map_lock_);
   curl_data_map_.try_emplace(handle, std::move(curl_request_data));
+  return true;
+}
+
+void MultiCurlHttpFetcherAsync::Cancel(CURL* handle)
+    ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
+  {
+    absl::MutexLock l(&curl_data_map_lock_);
+    auto it = curl_data_map_.find(handle);
+    if (it == curl_data_map_.end()) {
+      // Already done.
+      return;
+    }
+    if (!it->second->added) {
+      it->second->cancel_requested = true;
+      return;
+    }
+    MoveToCancelled(it);
+  }
+  if (use_event_loop_) {
+    multi_curl_request_manager_.Wakeup();
+  }
+}
+
+void MultiCurlHttpFetcherAsync::OnCancellableAdded(CURL* handle,
+                                                   int64_t sequence)
+    ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
+  {
+    absl::MutexLock l(&curl_data_map_lock_);
+    auto it = curl_data_map_.find(handle);
+    if (it == curl_data_map_.end() || it->second->sequence != sequence) {
+      // Already done, and the handle possibly reused.
+      return;
+    }
+    it->second->added = true;
+    if (!it->second->cancel_requested) {
+      return;
+    }
+    MoveToCancelled(it);
+  }
+  if (use_event_loop_) {
+    multi_curl_request_manager_.Wakeup();
+  }
+}
+
+void MultiCurlHttpFetcherAsync::MoveToCancelled(
+    absl::flat_hash_map<CURL*, std::unique_ptr<CurlRequestData>>::iterator it)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(curl_data_map_lock_) {
+  cancelled_requests_.push_back(std::move(it->second));
+  curl_data_map_.erase(it);
+  has_cancelled_requests_ = true;
+}
+
+void MultiCurlHttpFetcherAsync::RemoveCancelled()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(in_loop_mu_)
+        ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
+  std::vector<std::unique_ptr<CurlRequestData>> cancelled;
+  {
+    absl::MutexLock l(&curl_data_map_lock_);
+    cancelled.swap(cancelled_requests_);
+    has_cancelled_requests_ = false;
+  }
+  for (auto& curl_request_data : cancelled) {
+    multi_curl_request_manager_.Remove(curl_request_data->handle.curl);
+    curl_request_data->EndCancellation();
+    RecordCancelledWork(CancelledWork::kHttpFetch);
+    executor_->Run(
+        [curl_request_data = std::move(curl_request_data)]() mutable {
+          std::move(curl_request_data->done_callback)(
+              absl::CancelledError("The fetch was cancelled"));
+        });
+  }
 }
 
 void MultiCurlHttpFetcherAsync::ExecuteLoop() ABSL_LOCKS_EXCLUDED(in_loop_mu_) {
@@ -289,46 +596,95 @@ void MultiCurlHttpFetcherAsync::ExecuteLoop() ABSL_LOCKS_EXCLUDED(in_loop_mu_) {
 void MultiCurlHttpFetcherAsync::PerformCurlUpdate()
     ABSL_EXCLUSIVE_LOCKS_REQUIRED(in_loop_mu_)
         ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
+  if (has_cancelled_requests_.load()) {
+    RemoveCancelled();
+  }
   // Check for updates (provide computation for Libcurl to perform I/O).
   int msgs_left = -1;
   while (CURLMsg* msg = multi_curl_request_manager_.GetUpdate(&msgs_left)) {
-    multi_curl_request_manager_.Remove(msg->easy_handle);
-
-    // Get data for completed message.
-    std::unique_ptr<CurlRequestData> curl_request_data;
-    {
-      absl::MutexLock lock(&curl_data_map_lock_);
-      curl_request_data = std::move(curl_data_map_.at(msg->easy_handle));
-      curl_data_map_.erase(msg->easy_handle);
+    OnRequestDone(msg);
+  }
+}
+
+void MultiCurlHttpFetcherAsync::RunEventLoop()
+    ABSL_LOCKS_EXCLUDED(in_loop_mu_) {
+  absl::MutexLock lock(&in_loop_mu_);
+  while (!shutdown_requested_.HasBeenNotified()) {
+    multi_curl_request_manager_.WaitAndPerform(kEventLoopMaxWait);
+    if (has_cancelled_requests_.load()) {
+      RemoveCancelled();
     }
+    int msgs_left = -1;
+    while (CURLMsg* msg = multi_curl_request_manager_.ReadInfo(&msgs_left)) {
+      OnRequestDone(msg);
+    }
+  }
+  // Shut down has been requested so exit.
+  shutdown_complete_.Notify();
+}
 
-    // Execute callback in another thread.
-    executor_->Run(
-        [req_handle = msg->easy_handle, result = GetResultFromMsg(msg),
-         curl_request_data = std::move(curl_request_data)]() mutable {
-          // invoke callback for handle.
-          std::move(curl_request_data->done_callback)(result);
-          // perform cleanup for handle.
-          GetTraceFromCurl(req_handle);
-        });
+void MultiCurlHttpFetcherAsync::OnRequestDone(CURLMsg* msg)
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(in_loop_mu_)
+        ABSL_LOCKS_EXCLUDED(curl_data_map_lock_) {
+  multi_curl_request_manager_.Remove(msg->easy_handle);
+  if (msg->msg == CURLMSG_DONE && msg->data.result == CURLE_OK) {
+    long new_connections = 0;
+    curl_easy_getinfo(msg->easy_handle, CURLINFO_NUM_CONNECTS,
+                      &new_connections);
+    (new_connections == 0 ? reused_connection_requests
+                          : new_connection_requests)++;
+  }
+
+  // Get data for completed message.
+  std::unique_ptr<CurlRequestData> curl_request_data;
+  {
+    absl::MutexLock lock(&curl_data_map_lock_);
+    auto it = curl_data_map_.find(msg->easy_handle);
+    if (it == curl_data_map_.end()) {
+      // Cancelled, and failed by RemoveCancelled.
+      return;
+    }
+    curl_request_data = std::move(it->second);
+    curl_data_map_.erase(it);
   }
+  curl_request_data->EndCancellation();
+
+  // Execute callback in another thread.
+  executor_->Run(
+      [req_handle = msg->easy_handle, result = GetResultFromMsg(msg),
+       curl_request_data = std::move(curl_request_data)]() mutable {
+        // invoke callback for handle.
+        std::move(curl_request_data->done_callback)(std::move(result));
+        GetTraceFromCurl(req_handle);
+        // The handle goes back to the pool when curl_request_data is
+        // destroyed with this closure.
+      });
 }
 
 MultiCurlHttpFetcherAsync::CurlRequestData::CurlRequestData(
-    const std::vector<std::string>& headers, OnDoneFetchUrl on_done) {
+    std::shared_ptr<CurlHandlePool> pool,
+    const std::vector<std::string>& headers,
+    OnDoneFetchUrlWithMetadata on_done)
+    : handle(pool->Acquire()), handle_pool(std::move(pool)) {
   // Space for the fetch output must be heap allocated.
   // It can (potentially) be multiple megabytes in size, and many simultaneous
   // requests can be in flight due to the async nature of FetchUrl.
-  // See CurlStateCleanup for all cleanup.
-  output = std::make_unique<std::string>();
-  req_handle = curl_easy_init();
+  response = std::make_unique<HTTPResponse>();
   done_callback = std::move(on_done);
-  for (const auto& header : headers) {
-    headers_list_ptr = curl_slist_append(headers_list_ptr, header.c_str());
-  }
 }
 MultiCurlHttpFetcherAsync::CurlRequestData::~CurlRequestData() {
-  curl_slist_free_all(headers_list_ptr);
-  curl_easy_cleanup(req_handle);
+  handle_pool->Release(std::move(handle));
+}
+
+void MultiCurlHttpFetcherAsync::CurlRequestData::EndCancellation() {
+  if (cancellation != nullptr) {
+    cancellation->Deregister(cancellation_id);
+    cancellation = nullptr;
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetHttpConnectionReuse() {
+  return {{"reused", reused_connection_requests.exchange(0)},
+          {"new", new_connection_requests.exchange(0)}};
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
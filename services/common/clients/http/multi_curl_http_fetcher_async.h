@@ -15,8 +15,11 @@
 #ifndef SERVICES_COMMON_CLIENTS_MULTI_CURL_HTTP_FETCHER_ASYNC_H_
 #define SERVICES_COMMON_CLIENTS_MULTI_CURL_HTTP_FETCHER_ASYNC_H_
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -26,8 +29,11 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/notification.h"
+#include "services/common/clients/http/curl_handle_pool.h"
 #include "services/common/clients/http/http_fetcher_async.h"
 #include "services/common/clients/http/multi_curl_request_manager.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/cancellation_token.h"
 #include "src/cpp/concurrent/event_engine_executor.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -35,9 +41,11 @@ namespace privacy_sandbox::bidding_auction_servers {
 // MultiCurlHttpFetcherAsync provides a thread-safe libcurl wrapper to perform
 // asynchronous HTTP invocations with client caching(connection pooling), and
 // TLS session sharing. It uses a single curl multi handle to perform
-// all invoked HTTP actions. It runs a loop in the provided executor
-// to provide computation to Libcurl for I/O, and schedules callbacks
-// on the provided executor with the result from the HTTP invocation.
+// all invoked HTTP actions. It runs a loop in the provided executor, or with
+// use_event_loop an epoll based event loop on a dedicated thread, to provide
+// computation to Libcurl for I/O, and schedules callbacks on the provided
+// executor with the result from the HTTP invocation. DNS lookups and TLS
+// sessions are cached across the requests of an instance.
 // Please note: MultiCurlHttpFetcherAsync makes the best effort to reject any
 // calls after the class has started shutting down but does not guarantee
 // thread safety if any method is invoked after destruction.
@@ -51,9 +59,21 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   // OS sends a keep alive probe.
   // If the other endpoint does not reply, OS sends another keep alive
   // probe after keepalive_interval_sec.
+  // If use_event_loop is true, a dedicated thread waits for the sockets of the
+  // session to be ready and drives libcurl with curl_multi_socket_action,
+  // instead of a loop in the executor polling libcurl with curl_multi_perform.
+  // If enable_http2_multiplexing is true, HTTPS requests negotiate HTTP/2 and
+  // wait for a connection to the host to multiplex them over, instead of
+  // opening and handshaking a new connection for every concurrent request.
+  // If http2_prior_knowledge is also true, requests speak HTTP/2 without
+  // negotiating it, plain HTTP ones included, for backends known to serve
+  // HTTP/2 over cleartext only, such as the local server of the benchmarks.
   explicit MultiCurlHttpFetcherAsync(server_common::Executor* executor,
                                      int64_t keepalive_interval_sec = 2,
-                                     int64_t keepalive_idle_sec = 2);
+                                     int64_t keepalive_idle_sec = 2,
+                                     bool use_event_loop = false,
+                                     bool enable_http2_multiplexing = false,
+                                     bool http2_prior_knowledge = false);
 
   // Cleans up all sessions and errors out any pending open HTTP calls.
   // Please note: Any class using this must ensure that the instance is only
@@ -94,33 +114,120 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
                  absl::Duration timeout, OnDoneFetchUrls done_callback) override
       ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
 
+  // Same as FetchUrls, additionally returning the response code and the ETag
+  // and Last-Modified headers of each response.
+  void FetchUrlsWithMetadata(const std::vector<HTTPRequest>& requests,
+                             absl::Duration timeout,
+                             OnDoneFetchUrlsWithMetadata done_callback) override
+      ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
+  // Same as FetchUrlsWithMetadata for a single request, handing each chunk of
+  // the body to body_consumer from the libcurl write callback as it arrives.
+  void FetchUrlStreaming(const HTTPRequest& request, absl::Duration timeout,
+                         HttpBodyConsumer* body_consumer,
+                         OnDoneFetchUrlStreaming done_callback) override
+      ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
  private:
+  using OnDoneFetchUrlWithMetadata =
+      absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&>;
+
+  // Fetches provided url with libcurl and returns the response with its
+  // metadata. FetchUrl is a wrapper that only keeps the body. If
+  // body_consumer is set, the body is streamed to it instead.
+  void FetchUrlWithMetadata(const HTTPRequest& request, int timeout_ms,
+                            OnDoneFetchUrlWithMetadata done_callback,
+                            HttpBodyConsumer* body_consumer = nullptr)
+      ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
+  // Issues one FetchUrlWithMetadata per request and invokes done_callback with
+  // the results converted by to_result, in the order of the requests.
+  template <typename Result, typename ToResult>
+  void FetchUrlsInParallel(
+      const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+      absl::AnyInvocable<void(std::vector<absl::StatusOr<Result>>) &&>
+          done_callback,
+      ToResult to_result) ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
   // This struct maintains the data related to a Curl request, some of which
   // has to stay valid throughout the life of the request. The code maintains a
   // reference in curl_data_map_ till the request is completed. The destructor
   // is then to free the resources in this class after the request completes.
   struct CurlRequestData {
-    // The easy handle provided by libcurl, registered to
-    // multi_curl_request_manager_.
-    CURL* req_handle;
+    // The easy handle from handle_pool, registered to
+    // multi_curl_request_manager_, with the list of the request HTTP headers.
+    PooledCurlHandle handle;
 
-    // The pointer to the linked list of the request HTTP headers.
-    struct curl_slist* headers_list_ptr = nullptr;
+    // Takes the handle back once the request is done. Shared since the
+    // request data can outlive the fetcher while its callback runs.
+    std::shared_ptr<CurlHandlePool> handle_pool;
 
-    // The callback function for this request from FetchUrl.
-    OnDoneFetchUrl done_callback;
+    // The body of a POST request, read by the handle while it is sent.
+    std::string body;
 
-    // The pointer that is used by the req_handle to write the request output.
-    std::unique_ptr<std::string> output;
+    // The callback function for this request from FetchUrlWithMetadata.
+    OnDoneFetchUrlWithMetadata done_callback;
 
-    CurlRequestData(const std::vector<std::string>& headers,
-                    OnDoneFetchUrl on_done);
+    // The pointer that is used by the handle to write the response body
+    // and the response headers of interest.
+    std::unique_ptr<HTTPResponse> response;
+
+    // Receives the response body instead of response, if set.
+    HttpBodyConsumer* body_consumer = nullptr;
+
+    // Whether body_consumer was told the length of the body.
+    bool content_length_reported = false;
+
+    // The cancellation of the request, if any, and the callback registered
+    // to it, which is deregistered before done_callback is invoked.
+    CancellationToken* cancellation = nullptr;
+    CancellationToken::CallbackId cancellation_id = 0;
+    void EndCancellation();
+    // Tells the request apart from later ones reusing its handle.
+    int64_t sequence = 0;
+    // Whether the handle is in the multi session, before which a
+    // cancellation is only requested, as the handle cannot be removed yet.
+    bool added = false;
+    bool cancel_requested = false;
+
+    CurlRequestData(std::shared_ptr<CurlHandlePool> pool,
+                    const std::vector<std::string>& headers,
+                    OnDoneFetchUrlWithMetadata on_done);
     ~CurlRequestData();
   };
+  // Hands a chunk of the response body to the body_consumer of
+  // request_data. Follows the signature required by libcurl, see
+  // https://curl.se/libcurl/c/CURLOPT_WRITEFUNCTION.html.
+  static size_t StreamBody(char* data, size_t size, size_t number_elements,
+                           CurlRequestData* request_data);
+
   // This method adds the curl handle and callback to the callback_map.
   // Only a single thread can execute this function at a time since it requires
-  // the acquisition of the callback_map_lock_ mutex.
-  void Add(CURL* handle, std::unique_ptr<CurlRequestData> done_callback)
+  // the acquisition of the callback_map_lock_ mutex. Returns false and invokes
+  // the callback if the client is shutting down.
+  bool Add(CURL* handle, std::unique_ptr<CurlRequestData> done_callback)
+      ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
+  // Hands the request of the handle, if still in flight, to the execution
+  // loop, which removes the handle from the multi session and fails the
+  // request. The handle is not reused until then, so that a message libcurl
+  // already queued for it cannot finish another request. Before the handle
+  // is in the multi session, only marks the request for OnCancellableAdded.
+  void Cancel(CURL* handle) ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
+  // Called once the handle of the cancellable request of sequence is in the
+  // multi session, to cancel it if that was requested meanwhile.
+  void OnCancellableAdded(CURL* handle, int64_t sequence)
+      ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
+  // Moves the request of it to cancelled_requests_.
+  void MoveToCancelled(
+      absl::flat_hash_map<CURL*, std::unique_ptr<CurlRequestData>>::iterator
+          it) ABSL_EXCLUSIVE_LOCKS_REQUIRED(curl_data_map_lock_);
+
+  // Removes the handles of the cancelled requests from the multi session and
+  // schedules their callbacks on the executor_.
+  void RemoveCancelled() ABSL_EXCLUSIVE_LOCKS_REQUIRED(in_loop_mu_)
       ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
 
   // This method executes PerformCurlUpdate on a loop in the executor_. It
@@ -137,6 +244,16 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   void PerformCurlUpdate() ABSL_EXCLUSIVE_LOCKS_REQUIRED(in_loop_mu_)
       ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
 
+  // Runs on event_loop_thread_ until shutdown. It waits for libcurl sockets
+  // or timeouts and lets libcurl perform the I/O for them, then schedules the
+  // callbacks of the finished requests on the executor_.
+  void RunEventLoop() ABSL_LOCKS_EXCLUDED(in_loop_mu_);
+
+  // Removes the finished request of msg from the multi session and schedules
+  // its callback on the executor_.
+  void OnRequestDone(CURLMsg* msg) ABSL_EXCLUSIVE_LOCKS_REQUIRED(in_loop_mu_)
+      ABSL_LOCKS_EXCLUDED(curl_data_map_lock_);
+
   // The executor_ will receive tasks from PerformCurlUpdate. The tasks will
   // schedule future ExecuteLoop calls and schedule executions for
   // client callbacks. The executor is not owned by this class instance but is
@@ -149,9 +266,23 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   // Interval time between keep-alive probes in case of no response.
   int64_t keepalive_interval_sec_;
 
+  // Whether event_loop_thread_ drives the multi session.
+  const bool use_event_loop_;
+
+  // Whether requests are multiplexed over HTTP/2 connections.
+  const bool enable_http2_multiplexing_;
+
   // The multi session used for performing HTTP calls.
   MultiCurlRequestManager multi_curl_request_manager_;
 
+  // The easy handles of finished requests, kept configured for the next ones.
+  // Declared after multi_curl_request_manager_ so that the idle handles are
+  // cleaned up before libcurl is.
+  std::shared_ptr<CurlHandlePool> handle_pool_;
+
+  // Runs RunEventLoop if use_event_loop_.
+  std::thread event_loop_thread_;
+
   // Makes sure only one execution loop runs at a time.
   absl::Mutex in_loop_mu_;
 
@@ -163,8 +294,27 @@ class MultiCurlHttpFetcherAsync final : public HttpFetcherAsync {
   absl::Mutex curl_data_map_lock_;
   absl::flat_hash_map<CURL*, std::unique_ptr<CurlRequestData>> curl_data_map_
       ABSL_GUARDED_BY(curl_data_map_lock_);
+
+  // Requests cancelled while in flight, until the loop removes their handles.
+  std::vector<std::unique_ptr<CurlRequestData>> cancelled_requests_
+      ABSL_GUARDED_BY(curl_data_map_lock_);
+  // Whether cancelled_requests_ may not be empty, so that the loop does not
+  // lock curl_data_map_lock_ on every update.
+  std::atomic<bool> has_cancelled_requests_ = false;
+  std::atomic<int64_t> next_request_sequence_ = 1;
 };
 
+// Returns the number of requests completed by all the
+// MultiCurlHttpFetcherAsync instances since the previous call, labeled by
+// whether they were sent over a "reused" or a "new" connection.
+absl::flat_hash_map<std::string, double> GetHttpConnectionReuse();
+
+template <typename T>
+inline void AddHttpConnectionMetric(T* context_map) {
+  context_map->AddObserverable(metric::kInitiatedRequestConnectionCount,
+                               GetHttpConnectionReuse);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_COMMON_CLIENTS_MULTI_CURL_HTTP_FETCHER_ASYNC_H_
@@ -19,17 +19,21 @@
 
 #include "absl/status/status.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "grpc/event_engine/event_engine.h"
 #include "grpc/grpc.h"
 #include "include/gmock/gmock.h"
 #include "include/gtest/gtest.h"
 #include "rapidjson/document.h"
+#include "services/common/util/cancellation_token.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
 
 constexpr absl::string_view kUrlA = "https://example.com";
 constexpr absl::string_view kUrlB = "https://www.iana.org/domains/example";
@@ -115,6 +119,19 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, HandlesTimeoutByReturningError) {
   done.Wait();
 }
 
+TEST_F(MultiCurlHttpFetcherAsyncTest, FailsFetchOfCancelledRequest) {
+  CancellationToken cancellation;
+  cancellation.Cancel();
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    EXPECT_EQ(result.status().code(), absl::StatusCode::kCancelled);
+    done.DecrementCount();
+  };
+  fetcher_->FetchUrl({.url = std::string(kUrlA), .cancellation = &cancellation},
+                     kNormalTimeoutMs, done_cb);
+  done.Wait();
+}
+
 TEST_F(MultiCurlHttpFetcherAsyncTest, HandlesMalformattedUrlByReturningError) {
   std::string msg;
   absl::BlockingCounter done(1);
@@ -151,6 +168,91 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, SetsAcceptEncodingHeaderOnRequest) {
   done.Wait();
 }
 
+TEST_F(MultiCurlHttpFetcherAsyncTest, PostsRequestBody) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+    ASSERT_TRUE(result.ok());
+    // Response has a 'data' field of the body sent in the request.
+    rapidjson::Document document;
+    document.Parse(result.value().c_str());
+    rapidjson::Value& data = document["data"];
+    EXPECT_EQ(std::string(data.GetString()), R"JSON({"keys":["a"]})JSON");
+  };
+  fetcher_->FetchUrl({.url = "httpbin.org/post",
+                      .headers = {"Content-Type: application/json"},
+                      .body = R"JSON({"keys":["a"]})JSON"},
+                     kNormalTimeoutMs, done_cb);
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, GetsAfterPostOnReusedHandle) {
+  for (absl::string_view body : {"posted", ""}) {
+    absl::BlockingCounter done(1);
+    std::string method;
+    fetcher_->FetchUrl({.url = "httpbin.org/anything", .body = body.data()},
+                       kNormalTimeoutMs,
+                       [&done, &method](absl::StatusOr<std::string> result) {
+                         ASSERT_TRUE(result.ok()) << result.status();
+                         rapidjson::Document document;
+                         document.Parse(result->c_str());
+                         method = document["method"].GetString();
+                         done.DecrementCount();
+                       });
+    done.Wait();
+    EXPECT_EQ(method, body.empty() ? "GET" : "POST");
+  }
+}
+
+// Keeps the streamed body, and rejects it if accept is false.
+class TestBodyConsumer : public HttpBodyConsumer {
+ public:
+  explicit TestBodyConsumer(bool accept = true) : accept_(accept) {}
+
+  void OnContentLength(size_t length) override { content_length_ = length; }
+
+  bool OnData(absl::string_view chunk) override {
+    body_.append(chunk.data(), chunk.size());
+    return accept_;
+  }
+
+  const bool accept_;
+  size_t content_length_ = 0;
+  std::string body_;
+};
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, StreamsResponseBodyToConsumer) {
+  TestBodyConsumer consumer;
+  absl::BlockingCounter done(1);
+  fetcher_->FetchUrlStreaming(
+      {.url = "httpbin.org/post", .body = "streamed"},
+      absl::Milliseconds(kNormalTimeoutMs), &consumer,
+      [&done](absl::StatusOr<HTTPResponse> response) {
+        ASSERT_TRUE(response.ok());
+        EXPECT_EQ(response->status_code, 200);
+        EXPECT_TRUE(response->body.empty());
+        done.DecrementCount();
+      });
+  done.Wait();
+
+  EXPECT_GT(consumer.content_length_, 0);
+  rapidjson::Document document;
+  document.Parse(consumer.body_.c_str());
+  EXPECT_EQ(std::string(document["data"].GetString()), "streamed");
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, FailsFetchWhenConsumerRejectsBody) {
+  TestBodyConsumer consumer(/*accept=*/false);
+  absl::BlockingCounter done(1);
+  fetcher_->FetchUrlStreaming(
+      {kUrlA.begin(), {}}, absl::Milliseconds(kNormalTimeoutMs), &consumer,
+      [&done](absl::StatusOr<HTTPResponse> response) {
+        EXPECT_EQ(response.status().code(), absl::StatusCode::kAborted);
+        done.DecrementCount();
+      });
+  done.Wait();
+}
+
 TEST_F(MultiCurlHttpFetcherAsyncTest, CanFetchMultipleUrlsInParallel) {
   absl::BlockingCounter done(1);
   std::vector<HTTPRequest> test_requests = {
@@ -169,5 +271,142 @@ TEST_F(MultiCurlHttpFetcherAsyncTest, CanFetchMultipleUrlsInParallel) {
   done.Wait();
 }
 
+TEST_F(MultiCurlHttpFetcherAsyncTest, ReportsConnectionReuse) {
+  GetHttpConnectionReuse();
+  for (int i = 0; i < 2; ++i) {
+    absl::BlockingCounter done(1);
+    fetcher_->FetchUrl({kUrlA.begin(), {}}, kNormalTimeoutMs,
+                       [&done](absl::StatusOr<std::string> result) {
+                         EXPECT_TRUE(result.ok()) << result.status();
+                         done.DecrementCount();
+                       });
+    done.Wait();
+  }
+
+  EXPECT_THAT(GetHttpConnectionReuse(),
+              UnorderedElementsAre(Pair("reused", 1), Pair("new", 1)));
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncTest, MultiplexesConcurrentRequestsOverHttp2) {
+  fetcher_ = std::make_unique<MultiCurlHttpFetcherAsync>(
+      executor_.get(), /*keepalive_interval_sec=*/2,
+      /*keepalive_idle_sec=*/2, /*use_event_loop=*/false,
+      /*enable_http2_multiplexing=*/true);
+  GetHttpConnectionReuse();
+  absl::BlockingCounter done(1);
+  std::vector<HTTPRequest> test_requests = {
+      {kUrlA.begin(), {}}, {kUrlA.begin(), {}}, {kUrlA.begin(), {}}};
+  fetcher_->FetchUrls(
+      test_requests, absl::Milliseconds(kNormalTimeoutMs),
+      [&done](std::vector<absl::StatusOr<std::string>> results) {
+        for (const auto& result : results) {
+          EXPECT_TRUE(result.ok()) << result.status();
+        }
+        done.DecrementCount();
+      });
+  done.Wait();
+
+  // The requests waiting for the first connection are sent over it.
+  EXPECT_THAT(GetHttpConnectionReuse(),
+              UnorderedElementsAre(Pair("reused", 2), Pair("new", 1)));
+}
+
+class MultiCurlHttpFetcherAsyncEventLoopTest : public ::testing::Test {
+ protected:
+  MultiCurlHttpFetcherAsyncEventLoopTest() {
+    executor_ = std::make_unique<server_common::EventEngineExecutor>(
+        grpc_event_engine::experimental::CreateEventEngine());
+    fetcher_ = std::make_unique<MultiCurlHttpFetcherAsync>(
+        executor_.get(), /*keepalive_interval_sec=*/2,
+        /*keepalive_idle_sec=*/2, /*use_event_loop=*/true);
+  }
+
+  std::unique_ptr<server_common::EventEngineExecutor> executor_;
+  std::unique_ptr<MultiCurlHttpFetcherAsync> fetcher_;
+  server_common::GrpcInit gprc_init;
+};
+
+TEST_F(MultiCurlHttpFetcherAsyncEventLoopTest, FetchesUrlSuccessfully) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+    ASSERT_TRUE(result.ok()) << result.status();
+    EXPECT_GT(result.value().length(), 0);
+  };
+  fetcher_->FetchUrl({kUrlA.begin(), {}}, kNormalTimeoutMs, done_cb);
+
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncEventLoopTest,
+       HandlesTimeoutByReturningError) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(result.status().code(), absl::StatusCode::kDeadlineExceeded);
+  };
+  fetcher_->FetchUrl({kUrlA.begin(), {}}, 1, done_cb);
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncEventLoopTest,
+       HandlesMalformattedUrlByReturningError) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+    ASSERT_FALSE(result.ok());
+    EXPECT_EQ(result.status().code(), absl::StatusCode::kInvalidArgument);
+  };
+  fetcher_->FetchUrl({"", {}}, kNormalTimeoutMs, done_cb);
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncEventLoopTest,
+       CanFetchMultipleUrlsInParallel) {
+  absl::BlockingCounter done(1);
+  std::vector<HTTPRequest> test_requests = {
+      {kUrlA.begin(), {}}, {kUrlB.begin(), {}}, {kUrlC.begin(), {}}};
+  auto done_cb = [&done, &test_requests](
+                     std::vector<absl::StatusOr<std::string>> results) {
+    EXPECT_EQ(results.size(), test_requests.size());
+    for (auto result : results) {
+      ASSERT_TRUE(result.ok()) << result.status();
+    }
+    done.DecrementCount();
+  };
+
+  fetcher_->FetchUrls(test_requests, absl::Milliseconds(kNormalTimeoutMs),
+                      std::move(done_cb));
+  done.Wait();
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncEventLoopTest, AbortsFetchOnceCancelled) {
+  CancellationToken cancellation;
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    EXPECT_EQ(result.status().code(), absl::StatusCode::kCancelled);
+    done.DecrementCount();
+  };
+  const absl::Time start = absl::Now();
+  fetcher_->FetchUrl(
+      {.url = "httpbin.org/delay/10", .cancellation = &cancellation},
+      /*timeout_ms=*/20000, done_cb);
+  cancellation.Cancel();
+  done.Wait();
+  EXPECT_LT(absl::Now() - start, absl::Seconds(5));
+}
+
+TEST_F(MultiCurlHttpFetcherAsyncEventLoopTest,
+       InvokesCallbackOfPendingRequestOnDestruction) {
+  absl::BlockingCounter done(1);
+  auto done_cb = [&done](absl::StatusOr<std::string> result) {
+    done.DecrementCount();
+  };
+  fetcher_->FetchUrl({kUrlA.begin(), {}}, kNormalTimeoutMs, done_cb);
+  fetcher_.reset();
+  done.Wait();
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,623 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Throughput, CPU and latency benchmarks of MultiCurlHttpFetcherAsync against
+// a local server, so that they measure the fetcher and libcurl rather than a
+// remote server or the network.
+//
+// BM_MultiCurlHttpFetcherAsync keeps `concurrency` GETs in flight to a server
+// answering each with a body of `response_bytes` bytes. It speaks HTTP/2 with
+// prior knowledge over cleartext if `http2` is 1, and HTTP/1.1 otherwise,
+// drives libcurl from an epoll event loop if `event_loop` is 1, and reuses
+// connections if `keepalive` is 1, instead of opening one per fetch. Every
+// iteration is a fetch, so items_per_second is the number of fetches per
+// second. Besides, the following are exported as counters:
+// - p50_us and p99_us: percentiles of the fetch latency under load.
+// - client_cpu_us: the CPU time of the process per fetch, less that of the
+//   server, as the cost of the fetcher, its executor and libcurl.
+// - server_cpu_us: the CPU time of the server per fetch.
+// - errors: fetches that failed, or returned a body of the wrong size.
+//
+// The parameters are swept one at a time around a baseline, for each of the
+// protocols and loops.
+//
+// Run with:
+//   bazel run -c opt //services/common/clients/http:multi_curl_http_fetcher_benchmarks
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "benchmark/benchmark.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
+#include "src/cpp/concurrent/event_engine_executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kFetchTimeoutMs = 10000;
+
+constexpr char kHttp2[] = "http2";
+constexpr char kEventLoop[] = "event_loop";
+constexpr char kConcurrency[] = "concurrency";
+constexpr char kResponseBytes[] = "response_bytes";
+constexpr char kKeepalive[] = "keepalive";
+
+// The connection preface of an HTTP/2 client (RFC 9113, section 3.4).
+constexpr absl::string_view kHttp2Preface = "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n";
+constexpr int kFrameHeaderBytes = 9;
+constexpr int kDefaultWindow = 65535;
+constexpr int kDefaultMaxFrameBytes = 16384;
+
+// Frame types and flags of HTTP/2 (RFC 9113, section 6).
+constexpr uint8_t kDataFrame = 0x0;
+constexpr uint8_t kHeadersFrame = 0x1;
+constexpr uint8_t kRstStreamFrame = 0x3;
+constexpr uint8_t kSettingsFrame = 0x4;
+constexpr uint8_t kPingFrame = 0x6;
+constexpr uint8_t kGoawayFrame = 0x7;
+constexpr uint8_t kWindowUpdateFrame = 0x8;
+constexpr uint8_t kContinuationFrame = 0x9;
+constexpr uint8_t kEndStreamFlag = 0x1;
+constexpr uint8_t kAckFlag = 0x1;
+constexpr uint8_t kEndHeadersFlag = 0x4;
+constexpr uint16_t kInitialWindowSizeSetting = 0x4;
+constexpr uint16_t kMaxFrameSizeSetting = 0x5;
+
+absl::Duration ThreadCpuTime() {
+  timespec time;
+  CHECK_EQ(clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time), 0);
+  return absl::DurationFromTimespec(time);
+}
+
+absl::Duration ProcessCpuTime() {
+  rusage usage;
+  CHECK_EQ(getrusage(RUSAGE_SELF, &usage), 0);
+  return absl::DurationFromTimeval(usage.ru_utime) +
+         absl::DurationFromTimeval(usage.ru_stime);
+}
+
+bool SendAll(int fd, absl::string_view data) {
+  while (!data.empty()) {
+    const ssize_t sent = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+    if (sent < 0) {
+      return false;
+    }
+    data.remove_prefix(sent);
+  }
+  return true;
+}
+
+uint32_t ReadUint32(absl::string_view bytes) {
+  return static_cast<uint32_t>(static_cast<uint8_t>(bytes[0])) << 24 |
+         static_cast<uint32_t>(static_cast<uint8_t>(bytes[1])) << 16 |
+         static_cast<uint32_t>(static_cast<uint8_t>(bytes[2])) << 8 |
+         static_cast<uint32_t>(static_cast<uint8_t>(bytes[3]));
+}
+
+void AppendFrame(std::string& output, uint8_t type, uint8_t flags,
+                 uint32_t stream_id, absl::string_view payload) {
+  const uint32_t length = payload.size();
+  const char header[kFrameHeaderBytes] = {
+      static_cast<char>(length >> 16),    static_cast<char>(length >> 8),
+      static_cast<char>(length),          static_cast<char>(type),
+      static_cast<char>(flags),           static_cast<char>(stream_id >> 24),
+      static_cast<char>(stream_id >> 16), static_cast<char>(stream_id >> 8),
+      static_cast<char>(stream_id)};
+  output.append(header, kFrameHeaderBytes);
+  output.append(payload.data(), payload.size());
+}
+
+// The little of HTTP/2 a server needs to answer the GETs of libcurl: it
+// acknowledges the settings and pings of the client and honours its flow
+// control, but never decodes the request headers, since every request gets
+// the same response.
+class Http2Connection {
+ public:
+  Http2Connection(int fd, absl::string_view body) : fd_(fd), body_(body) {
+    // :status 200, as indexed in the static table, and content-length as a
+    // literal without indexing of the name of index 28 (RFC 7541).
+    const std::string length = absl::StrCat(body.size());
+    headers_block_ = absl::StrCat(
+        "\x88\x0f\x0d", std::string(1, static_cast<char>(length.size())),
+        length);
+    // The preface of the server is an empty SETTINGS frame.
+    AppendFrame(output_, kSettingsFrame, 0, 0, "");
+  }
+
+  // Handles the complete frames at the start of input and removes them.
+  // Returns false once the client goes away.
+  bool Consume(std::string& input) {
+    size_t offset = 0;
+    while (input.size() - offset >= kFrameHeaderBytes) {
+      const absl::string_view header(input.data() + offset, kFrameHeaderBytes);
+      const uint32_t length = ReadUint32(header) >> 8;
+      if (input.size() - offset < kFrameHeaderBytes + length) {
+        break;
+      }
+      const uint8_t type = header[3];
+      const uint8_t flags = header[4];
+      const uint32_t stream_id = ReadUint32(header.substr(5)) & 0x7fffffff;
+      const absl::string_view payload(
+          input.data() + offset + kFrameHeaderBytes, length);
+      offset += kFrameHeaderBytes + length;
+      if (!HandleFrame(type, flags, stream_id, payload)) {
+        return false;
+      }
+    }
+    input.erase(0, offset);
+    return true;
+  }
+
+  // Sends the acknowledgements due and as much of the responses as the
+  // windows of the client allow. Returns false once the client goes away.
+  bool Flush() {
+    for (auto it = streams_.begin(); it != streams_.end();) {
+      Stream& stream = *it;
+      if (!stream.headers_sent) {
+        AppendFrame(output_, kHeadersFrame,
+                    kEndHeadersFlag | (body_.empty() ? kEndStreamFlag : 0),
+                    stream.id, headers_block_);
+        stream.headers_sent = true;
+      }
+      while (stream.sent < body_.size()) {
+        const int64_t chunk = std::min<int64_t>(
+            {static_cast<int64_t>(body_.size() - stream.sent),
+             max_frame_bytes_, connection_window_, stream.window});
+        if (chunk <= 0) {
+          break;
+        }
+        const bool last = stream.sent + chunk == body_.size();
+        AppendFrame(output_, kDataFrame, last ? kEndStreamFlag : 0, stream.id,
+                    body_.substr(stream.sent, chunk));
+        stream.sent += chunk;
+        stream.window -= chunk;
+        connection_window_ -= chunk;
+      }
+      if (stream.sent == body_.size()) {
+        it = streams_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    const bool sent = SendAll(fd_, output_);
+    output_.clear();
+    return sent;
+  }
+
+ private:
+  struct Stream {
+    uint32_t id;
+    int64_t window;
+    size_t sent = 0;
+    bool headers_sent = false;
+  };
+
+  bool HandleFrame(uint8_t type, uint8_t flags, uint32_t stream_id,
+                   absl::string_view payload) {
+    switch (type) {
+      case kSettingsFrame:
+        if (!(flags & kAckFlag)) {
+          for (size_t i = 0; i + 6 <= payload.size(); i += 6) {
+            const uint16_t id = ReadUint32(payload.substr(i)) >> 16;
+            const int64_t value = ReadUint32(payload.substr(i + 2));
+            if (id == kInitialWindowSizeSetting) {
+              for (Stream& stream : streams_) {
+                stream.window += value - initial_window_;
+              }
+              initial_window_ = value;
+            } else if (id == kMaxFrameSizeSetting) {
+              max_frame_bytes_ = value;
+            }
+          }
+          AppendFrame(output_, kSettingsFrame, kAckFlag, 0, "");
+        }
+        return true;
+      case kPingFrame:
+        if (!(flags & kAckFlag)) {
+          AppendFrame(output_, kPingFrame, kAckFlag, 0, payload);
+        }
+        return true;
+      case kWindowUpdateFrame: {
+        const int64_t increment = ReadUint32(payload) & 0x7fffffff;
+        if (stream_id == 0) {
+          connection_window_ += increment;
+        }
+        for (Stream& stream : streams_) {
+          if (stream.id == stream_id) {
+            stream.window += increment;
+          }
+        }
+        return true;
+      }
+      case kHeadersFrame:
+        request_ends_with_headers_ = flags & kEndStreamFlag;
+        [[fallthrough]];
+      case kContinuationFrame:
+        if ((flags & kEndHeadersFlag) && request_ends_with_headers_) {
+          streams_.push_back({.id = stream_id, .window = initial_window_});
+        }
+        return true;
+      case kDataFrame:
+        if (flags & kEndStreamFlag) {
+          streams_.push_back({.id = stream_id, .window = initial_window_});
+        }
+        return true;
+      case kRstStreamFrame:
+        streams_.remove_if([stream_id](const Stream& stream) {
+          return stream.id == stream_id;
+        });
+        return true;
+      case kGoawayFrame:
+        return false;
+      default:
+        return true;
+    }
+  }
+
+  const int fd_;
+  const absl::string_view body_;
+  std::string headers_block_;
+  // Frames to send on the next Flush.
+  std::string output_;
+  // Streams whose request is complete, in the order they are answered.
+  std::list<Stream> streams_;
+  int64_t initial_window_ = kDefaultWindow;
+  int64_t connection_window_ = kDefaultWindow;
+  int64_t max_frame_bytes_ = kDefaultMaxFrameBytes;
+  // Whether the request of the last HEADERS frame has no body.
+  bool request_ends_with_headers_ = false;
+};
+
+// Accepts connections on a local port and answers every request with a 200
+// of `response_bytes` bytes, over HTTP/2 if the connection starts with its
+// preface and HTTP/1.1 otherwise. Counts the CPU time of its threads, so that
+// it can be told apart from that of the client.
+class LocalHttpServer {
+ public:
+  explicit LocalHttpServer(int response_bytes)
+      : body_(response_bytes, 'a'),
+        http1_response_(absl::StrCat("HTTP/1.1 200 OK\r\nContent-Length: ",
+                                     response_bytes, "\r\n\r\n", body_)) {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    CHECK_GE(listen_fd_, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    CHECK_EQ(bind(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+                  sizeof(address)),
+             0);
+    CHECK_EQ(listen(listen_fd_, SOMAXCONN), 0);
+    socklen_t length = sizeof(address);
+    CHECK_EQ(getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&address),
+                         &length),
+             0);
+    port_ = ntohs(address.sin_port);
+    accept_thread_ = std::thread([this]() { AcceptLoop(); });
+  }
+
+  ~LocalHttpServer() {
+    shutdown(listen_fd_, SHUT_RDWR);
+    accept_thread_.join();
+    absl::MutexLock lock(&mu_);
+    for (Connection& connection : connections_) {
+      shutdown(connection.fd, SHUT_RDWR);
+    }
+    for (Connection& connection : connections_) {
+      connection.thread.join();
+      close(connection.fd);
+    }
+    close(listen_fd_);
+  }
+
+  std::string Url() const { return absl::StrCat("http://127.0.0.1:", port_); }
+
+  // Returns the CPU time spent serving so far.
+  absl::Duration cpu_time() const {
+    return absl::Nanoseconds(cpu_ns_.load(std::memory_order_relaxed));
+  }
+
+ private:
+  struct Connection {
+    int fd;
+    std::thread thread;
+    bool done = false;
+  };
+
+  void AcceptLoop() {
+    while (true) {
+      const int fd = accept(listen_fd_, nullptr, nullptr);
+      if (fd < 0) {
+        return;
+      }
+      absl::MutexLock lock(&mu_);
+      // Reaps the connections the client closed, as there are many when
+      // every fetch opens its own.
+      connections_.remove_if([](Connection& connection) {
+        if (!connection.done) {
+          return false;
+        }
+        connection.thread.join();
+        close(connection.fd);
+        return true;
+      });
+      Connection& connection = connections_.emplace_back();
+      connection.fd = fd;
+      connection.thread = std::thread([this, &connection]() {
+        Serve(connection.fd);
+        // Lets the client know at once, while the descriptor stays reserved
+        // until reaped.
+        shutdown(connection.fd, SHUT_RDWR);
+        absl::MutexLock lock(&mu_);
+        connection.done = true;
+      });
+    }
+  }
+
+  void Serve(int fd) {
+    std::string input;
+    // Reads until the connection is known to start with the HTTP/2 preface
+    // or not to.
+    while (input.size() < kHttp2Preface.size() &&
+           kHttp2Preface.substr(0, input.size()) == input) {
+      if (!Receive(fd, input)) {
+        return;
+      }
+    }
+    if (absl::string_view(input).substr(0, kHttp2Preface.size()) ==
+        kHttp2Preface) {
+      input.erase(0, kHttp2Preface.size());
+      ServeHttp2(fd, input);
+    } else {
+      ServeHttp1(fd, input);
+    }
+  }
+
+  // Answers each request of the connection, as its headers end with an empty
+  // line and the requests are GETs.
+  void ServeHttp1(int fd, std::string& input) {
+    constexpr absl::string_view kEndOfHeaders = "\r\n\r\n";
+    do {
+      size_t end;
+      while ((end = absl::string_view(input).find(kEndOfHeaders)) !=
+             absl::string_view::npos) {
+        input.erase(0, end + kEndOfHeaders.size());
+        if (!SendAll(fd, http1_response_)) {
+          return;
+        }
+      }
+    } while (Receive(fd, input));
+  }
+
+  void ServeHttp2(int fd, std::string& input) {
+    Http2Connection connection(fd, body_);
+    do {
+      if (!connection.Consume(input) || !connection.Flush()) {
+        return;
+      }
+    } while (Receive(fd, input));
+  }
+
+  // Appends what the client sent next to input, and counts the CPU time of
+  // the thread since its previous call. Returns false once the client goes
+  // away.
+  bool Receive(int fd, std::string& input) {
+    thread_local absl::Duration counted;
+    const absl::Duration now = ThreadCpuTime();
+    cpu_ns_.fetch_add(absl::ToInt64Nanoseconds(now - counted),
+                      std::memory_order_relaxed);
+    counted = now;
+    char buffer[16384];
+    const ssize_t read = recv(fd, buffer, sizeof(buffer), 0);
+    if (read <= 0) {
+      return false;
+    }
+    input.append(buffer, read);
+    return true;
+  }
+
+  const std::string body_;
+  const std::string http1_response_;
+  int listen_fd_;
+  int port_;
+  std::thread accept_thread_;
+  std::atomic<int64_t> cpu_ns_ = 0;
+  absl::Mutex mu_;
+  std::list<Connection> connections_ ABSL_GUARDED_BY(mu_);
+};
+
+// Counts the fetches in flight, blocking new ones while there are too many,
+// and records the latencies of the fetches done. Thread safe.
+class FetchRecorder {
+ public:
+  explicit FetchRecorder(int max_in_flight) : max_in_flight_(max_in_flight) {}
+
+  // Blocks until a fetch can be started, and counts it in flight.
+  void Acquire() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &FetchRecorder::CanAcquire));
+    ++in_flight_;
+  }
+
+  // Records that a fetch finished `latency` after it was started.
+  void Done(absl::Duration latency, bool ok) ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    --in_flight_;
+    latencies_.push_back(latency);
+    errors_ += ok ? 0 : 1;
+  }
+
+  // Blocks until no fetch is in flight.
+  void Drain() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    mu_.Await(absl::Condition(this, &FetchRecorder::Idle));
+  }
+
+  // Returns the latencies recorded since the previous call, sorted.
+  std::vector<absl::Duration> TakeLatencies() ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    std::vector<absl::Duration> latencies = std::move(latencies_);
+    latencies_.clear();
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+  }
+
+  int64_t errors() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return errors_;
+  }
+
+ private:
+  bool CanAcquire() const ABSL_SHARED_LOCKS_REQUIRED(mu_) {
+    return in_flight_ < max_in_flight_;
+  }
+  bool Idle() const ABSL_SHARED_LOCKS_REQUIRED(mu_) { return in_flight_ == 0; }
+
+  const int max_in_flight_;
+  mutable absl::Mutex mu_;
+  int in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  std::vector<absl::Duration> latencies_ ABSL_GUARDED_BY(mu_);
+  int64_t errors_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Starts a fetch of request, and records it once done. Does not block on the
+// fetch.
+void Fetch(MultiCurlHttpFetcherAsync& fetcher, const HTTPRequest& request,
+           size_t response_bytes, FetchRecorder& recorder) {
+  const absl::Time start = absl::Now();
+  fetcher.FetchUrl(
+      request, kFetchTimeoutMs,
+      [&recorder, start, response_bytes](absl::StatusOr<std::string> response) {
+        recorder.Done(absl::Now() - start,
+                      response.ok() && response->size() == response_bytes);
+      });
+}
+
+double Percentile(const std::vector<absl::Duration>& sorted, int percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  return absl::ToDoubleMicroseconds(
+      sorted[(sorted.size() - 1) * percentile / 100]);
+}
+
+void BM_MultiCurlHttpFetcherAsync(benchmark::State& state) {
+  const bool http2 = state.range(0);
+  const bool event_loop = state.range(1);
+  const int concurrency = state.range(2);
+  const int response_bytes = state.range(3);
+  const bool keepalive = state.range(4);
+  LocalHttpServer server(response_bytes);
+  server_common::EventEngineExecutor executor(
+      grpc_event_engine::experimental::CreateEventEngine());
+  FetchRecorder recorder(concurrency);
+  absl::Duration client_cpu_time;
+  absl::Duration server_cpu_time;
+  {
+    MultiCurlHttpFetcherAsync fetcher(
+        &executor, /*keepalive_interval_sec=*/2, /*keepalive_idle_sec=*/2,
+        event_loop, /*enable_http2_multiplexing=*/http2,
+        /*http2_prior_knowledge=*/http2);
+    const HTTPRequest request = {.url = server.Url(),
+                                 .fresh_connection = !keepalive};
+    // Opens the connections before measuring.
+    for (int i = 0; i < concurrency; i++) {
+      recorder.Acquire();
+      Fetch(fetcher, request, response_bytes, recorder);
+    }
+    recorder.Drain();
+    recorder.TakeLatencies();
+
+    const absl::Duration process_start = ProcessCpuTime();
+    const absl::Duration server_start = server.cpu_time();
+    for (auto _ : state) {
+      recorder.Acquire();
+      Fetch(fetcher, request, response_bytes, recorder);
+    }
+    recorder.Drain();
+    server_cpu_time = server.cpu_time() - server_start;
+    client_cpu_time = ProcessCpuTime() - process_start - server_cpu_time;
+  }
+
+  const std::vector<absl::Duration> latencies = recorder.TakeLatencies();
+  const int64_t fetches = std::max<int64_t>(state.iterations(), 1);
+  state.counters["p50_us"] = Percentile(latencies, 50);
+  state.counters["p99_us"] = Percentile(latencies, 99);
+  state.counters["client_cpu_us"] =
+      absl::ToDoubleMicroseconds(client_cpu_time) / fetches;
+  state.counters["server_cpu_us"] =
+      absl::ToDoubleMicroseconds(server_cpu_time) / fetches;
+  state.counters["errors"] = recorder.errors();
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * response_bytes);
+  state.SetLabel(http2 ? "HTTP/2" : "HTTP/1.1");
+}
+
+// Args: HTTP/2 or HTTP/1.1, event loop or polling, fetches in flight,
+// response bytes and connection reuse. For each protocol and loop, the others
+// are swept on their own around a baseline of 8 fetches in flight of 16 KiB
+// over reused connections.
+void FetchArguments(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames(
+      {kHttp2, kEventLoop, kConcurrency, kResponseBytes, kKeepalive});
+  const std::vector<std::vector<int64_t>> sweeps = {
+      {1, 8, 64}, {1 << 10, 16 << 10, 256 << 10, 2 << 20}, {0, 1}};
+  for (int64_t http2 : {0, 1}) {
+    for (int64_t event_loop : {0, 1}) {
+      const std::vector<int64_t> baseline = {http2, event_loop, 8, 16 << 10,
+                                             1};
+      benchmark->Args(baseline);
+      for (int i = 0; i < sweeps.size(); i++) {
+        for (int64_t value : sweeps[i]) {
+          if (value == baseline[i + 2]) {
+            continue;
+          }
+          std::vector<int64_t> args = baseline;
+          args[i + 2] = value;
+          benchmark->Args(args);
+        }
+      }
+    }
+  }
+  benchmark->UseRealTime();
+  benchmark->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK(BM_MultiCurlHttpFetcherAsync)->Apply(FetchArguments);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -14,23 +14,77 @@
 
 #include "services/common/clients/http/multi_curl_request_manager.h"
 
+#include <errno.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+
+#include "glog/logging.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Max number of ready sockets handled per WaitAndPerform.
+constexpr int kMaxEpollEvents = 64;
 
-MultiCurlRequestManager::MultiCurlRequestManager() {
+}  // namespace
+
+MultiCurlRequestManager::MultiCurlRequestManager(bool event_driven,
+                                                 bool multiplex)
+    : event_driven_(event_driven) {
   running_handles_ = 0;
   curl_global_init(CURL_GLOBAL_ALL);
   request_manager_ = curl_multi_init();
+  if (multiplex) {
+    curl_multi_setopt(request_manager_, CURLMOPT_PIPELINING,
+                      CURLPIPE_MULTIPLEX);
+  }
+  share_ = curl_share_init();
+  curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, LockShare);
+  curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, UnlockShare);
+  curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+  if (!event_driven_) {
+    return;
+  }
+  epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+  PCHECK(epoll_fd_ >= 0) << "Failed to create the epoll set for curl";
+  wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  PCHECK(wakeup_fd_ >= 0) << "Failed to create the eventfd for curl";
+  epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = wakeup_fd_;
+  PCHECK(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &event) == 0);
+  curl_multi_setopt(request_manager_, CURLMOPT_SOCKETFUNCTION, OnSocket);
+  curl_multi_setopt(request_manager_, CURLMOPT_SOCKETDATA, this);
+  curl_multi_setopt(request_manager_, CURLMOPT_TIMERFUNCTION, OnTimer);
+  curl_multi_setopt(request_manager_, CURLMOPT_TIMERDATA, this);
 }
 
 MultiCurlRequestManager::~MultiCurlRequestManager() {
-  // Cancel all requests and exit.
+  // Cancel all requests and exit. libcurl removes its sockets from the epoll
+  // set while cleaning up, so the set is closed after.
   curl_multi_cleanup(request_manager_);
+  curl_share_cleanup(share_);
+  if (event_driven_) {
+    close(wakeup_fd_);
+    close(epoll_fd_);
+  }
   curl_global_cleanup();
 }
 
 CURLMcode MultiCurlRequestManager::Add(CURL* curl_handle)
     ABSL_LOCKS_EXCLUDED(request_manager_mu_) {
   absl::MutexLock l(&request_manager_mu_);
+  curl_easy_setopt(curl_handle, CURLOPT_SHARE, share_);
+  if (event_driven_) {
+    // libcurl sets a timeout of 0 through OnTimer to start the request.
+    return curl_multi_add_handle(request_manager_, curl_handle);
+  }
   curl_multi_add_handle(request_manager_, curl_handle);
   CURLMcode mc = curl_multi_perform(request_manager_, &running_handles_);
   return mc;
@@ -43,10 +97,138 @@ CURLMsg* MultiCurlRequestManager::GetUpdate(int* msgs_left)
   CURLMsg* msg = curl_multi_info_read(request_manager_, msgs_left);
   return msg;
 }
+
+void MultiCurlRequestManager::WaitAndPerform(absl::Duration max_wait)
+    ABSL_LOCKS_EXCLUDED(request_manager_mu_) {
+  absl::Duration wait;
+  {
+    absl::MutexLock l(&request_manager_mu_);
+    wait = std::min(max_wait, timeout_ - absl::Now());
+  }
+  int wait_ms = -1;
+  if (wait != absl::InfiniteDuration()) {
+    wait_ms = absl::ToInt64Milliseconds(
+        std::max(absl::ZeroDuration(), absl::Ceil(wait, absl::Milliseconds(1))));
+  }
+  epoll_event events[kMaxEpollEvents];
+  int num_events = epoll_wait(epoll_fd_, events, kMaxEpollEvents, wait_ms);
+  if (num_events < 0 && errno != EINTR) {
+    PLOG(ERROR) << "Failed to wait for the curl sockets";
+  }
+
+  absl::MutexLock l(&request_manager_mu_);
+  for (int i = 0; i < num_events; ++i) {
+    const int fd = events[i].data.fd;
+    if (fd == wakeup_fd_) {
+      uint64_t count;
+      while (read(wakeup_fd_, &count, sizeof(count)) > 0) {
+      }
+      continue;
+    }
+    int ev_bitmask = 0;
+    if (events[i].events & EPOLLIN) {
+      ev_bitmask |= CURL_CSELECT_IN;
+    }
+    if (events[i].events & EPOLLOUT) {
+      ev_bitmask |= CURL_CSELECT_OUT;
+    }
+    if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+      ev_bitmask |= CURL_CSELECT_ERR;
+    }
+    SocketAction(fd, ev_bitmask);
+  }
+  if (absl::Now() >= timeout_) {
+    // The timer does not repeat, OnTimer sets the next timeout if any.
+    timeout_ = absl::InfiniteFuture();
+    SocketAction(CURL_SOCKET_TIMEOUT, 0);
+  }
+}
+
+CURLMsg* MultiCurlRequestManager::ReadInfo(int* msgs_left)
+    ABSL_LOCKS_EXCLUDED(request_manager_mu_) {
+  absl::MutexLock l(&request_manager_mu_);
+  return curl_multi_info_read(request_manager_, msgs_left);
+}
+
+void MultiCurlRequestManager::Wakeup() {
+  uint64_t count = 1;
+  if (write(wakeup_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+    PLOG(ERROR) << "Failed to wake up the curl event loop";
+  }
+}
+
+void MultiCurlRequestManager::SocketAction(curl_socket_t socket,
+                                           int ev_bitmask) {
+  CURLMcode mc = curl_multi_socket_action(request_manager_, socket, ev_bitmask,
+                                          &running_handles_);
+  if (mc != CURLM_OK) {
+    LOG(ERROR) << "curl_multi_socket_action failed: "
+               << curl_multi_strerror(mc);
+  }
+}
+
+int MultiCurlRequestManager::OnSocket(CURL* easy, curl_socket_t socket,
+                                      int what, void* userp, void* socketp) {
+  auto* manager = static_cast<MultiCurlRequestManager*>(userp);
+  if (what == CURL_POLL_REMOVE) {
+    epoll_ctl(manager->epoll_fd_, EPOLL_CTL_DEL, socket, nullptr);
+    return 0;
+  }
+  epoll_event event = {};
+  event.data.fd = socket;
+  if (what & CURL_POLL_IN) {
+    event.events |= EPOLLIN;
+  }
+  if (what & CURL_POLL_OUT) {
+    event.events |= EPOLLOUT;
+  }
+  // libcurl reports the sockets it already watches again when the events of
+  // interest change.
+  if (epoll_ctl(manager->epoll_fd_, EPOLL_CTL_MOD, socket, &event) == 0 ||
+      (errno == ENOENT &&
+       epoll_ctl(manager->epoll_fd_, EPOLL_CTL_ADD, socket, &event) == 0)) {
+    return 0;
+  }
+  PLOG(ERROR) << "Failed to watch curl socket " << socket;
+  return -1;
+}
+
+int MultiCurlRequestManager::OnTimer(CURLM* multi, long timeout_ms,
+                                     void* userp) {
+  auto* manager = static_cast<MultiCurlRequestManager*>(userp);
+  manager->request_manager_mu_.AssertHeld();
+  absl::Time timeout = timeout_ms < 0
+                           ? absl::InfiniteFuture()
+                           : absl::Now() + absl::Milliseconds(timeout_ms);
+  const bool sooner = timeout < manager->timeout_;
+  manager->timeout_ = timeout;
+  if (sooner) {
+    // The event loop may be waiting for the previous timeout.
+    manager->Wakeup();
+  }
+  return 0;
+}
+
+void MultiCurlRequestManager::LockShare(CURL* handle, curl_lock_data data,
+                                        curl_lock_access access, void* userp)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  static_cast<MultiCurlRequestManager*>(userp)->share_mu_[data].Lock();
+}
+
+void MultiCurlRequestManager::UnlockShare(CURL* handle, curl_lock_data data,
+                                          void* userp)
+    ABSL_NO_THREAD_SAFETY_ANALYSIS {
+  static_cast<MultiCurlRequestManager*>(userp)->share_mu_[data].Unlock();
+}
+
 CURLMcode MultiCurlRequestManager::Remove(CURL* curl_handle)
     ABSL_LOCKS_EXCLUDED(request_manager_mu_) {
   absl::MutexLock l(&request_manager_mu_);
-  return curl_multi_remove_handle(request_manager_, curl_handle);
+  CURLMcode mc = curl_multi_remove_handle(request_manager_, curl_handle);
+  // The easy handle may be cleaned up after the share, e.g. by a callback
+  // still running when the manager is destroyed.
+  curl_easy_setopt(curl_handle, CURLOPT_SHARE, nullptr);
+  return mc;
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -15,7 +15,9 @@
 #ifndef SERVICES_COMMON_CLIENTS_HTTP_MULTI_CURL_REQUEST_MANAGER_H_
 #define SERVICES_COMMON_CLIENTS_HTTP_MULTI_CURL_REQUEST_MANAGER_H_
 
+#include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "curl/multi.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -24,10 +26,24 @@ namespace privacy_sandbox::bidding_auction_servers {
 // for sharing HTTP resources (connections and TLS session) across
 // all HTTP invocations for a client.
 // More info: https://curl.se/libcurl/c/threadsafe.html
+//
+// The session either polls, with GetUpdate driving curl_multi_perform, or is
+// event driven, with WaitAndPerform waiting on an epoll set of the sockets
+// and the timeout libcurl asks for and driving curl_multi_socket_action.
+// More info: https://curl.se/libcurl/c/libcurl-multi.html
+//
+// The easy handles added to the session share a DNS cache and a TLS session
+// cache, so that new connections resume TLS sessions instead of performing a
+// full handshake. Connections are pooled by the multi session itself.
+// More info: https://curl.se/libcurl/c/libcurl-share.html
 class MultiCurlRequestManager final {
  public:
-  // Initializes the Curl Multi session.
-  MultiCurlRequestManager();
+  // Initializes the Curl Multi session. If event_driven is true, the sockets
+  // of the session are watched with epoll and only WaitAndPerform and
+  // ReadInfo may be used to make progress. If multiplex is true, requests to
+  // the same host are multiplexed over HTTP/2 connections.
+  explicit MultiCurlRequestManager(bool event_driven = false,
+                                   bool multiplex = false);
   // Cleans up the curl mutli session. Please make sure all easy handles
   // related to this multi session are manually cleaned up before this runs.
   ~MultiCurlRequestManager();
@@ -40,12 +56,27 @@ class MultiCurlRequestManager final {
   // this function was called.
   CURLMsg* GetUpdate(int* msgs_left) ABSL_LOCKS_EXCLUDED(request_manager_mu_);
 
+  // Event driven only. Waits up to max_wait for a socket of the session to be
+  // ready, for the timeout set by libcurl to expire or for Wakeup, and
+  // performs the I/O work for the ready sockets or the expired timeout with
+  // curl_multi_socket_action. Only a single thread may call it at a time.
+  void WaitAndPerform(absl::Duration max_wait)
+      ABSL_LOCKS_EXCLUDED(request_manager_mu_);
+
+  // Returns the next message from the individual transfers, like GetUpdate,
+  // without performing any I/O work.
+  CURLMsg* ReadInfo(int* msgs_left) ABSL_LOCKS_EXCLUDED(request_manager_mu_);
+
+  // Event driven only. Makes a pending or the next WaitAndPerform return.
+  void Wakeup();
+
   // Add a new curl easy handle to the multi session, and starts the request
-  // by calling curl_multi_perform.
+  // by calling curl_multi_perform. If event_driven, the request is started by
+  // the next WaitAndPerform instead.
   CURLMcode Add(CURL* curl_handle) ABSL_LOCKS_EXCLUDED(request_manager_mu_);
 
   // Remove a curl easy handle from the multi session by calling
-  // curl_multi_remove_handle.
+  // curl_multi_remove_handle, and detaches it from the shared caches.
   CURLMcode Remove(CURL* curl_handle) ABSL_LOCKS_EXCLUDED(request_manager_mu_);
 
   // MultiCurlRequestManager is neither copyable nor movable.
@@ -53,6 +84,33 @@ class MultiCurlRequestManager final {
   MultiCurlRequestManager& operator=(const MultiCurlRequestManager&) = delete;
 
  private:
+  // Follow the signatures of CURLMOPT_SOCKETFUNCTION and
+  // CURLMOPT_TIMERFUNCTION, with the manager as the user pointer. They are
+  // invoked by libcurl with request_manager_mu_ held.
+  static int OnSocket(CURL* easy, curl_socket_t socket, int what, void* userp,
+                      void* socketp);
+  static int OnTimer(CURLM* multi, long timeout_ms, void* userp);
+
+  // Follow the signatures of CURLSHOPT_LOCKFUNC and CURLSHOPT_UNLOCKFUNC, with
+  // the manager as the user pointer.
+  static void LockShare(CURL* handle, curl_lock_data data,
+                        curl_lock_access access, void* userp);
+  static void UnlockShare(CURL* handle, curl_lock_data data, void* userp);
+
+  // Runs curl_multi_socket_action for a socket or CURL_SOCKET_TIMEOUT.
+  void SocketAction(curl_socket_t socket, int ev_bitmask)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(request_manager_mu_);
+
+  const bool event_driven_;
+  // The epoll set of the sockets libcurl asked to watch, and the eventfd
+  // signaled by Wakeup and by OnTimer. -1 unless event_driven_.
+  int epoll_fd_ = -1;
+  int wakeup_fd_ = -1;
+  // When curl_multi_socket_action has to be called with CURL_SOCKET_TIMEOUT,
+  // as set by OnTimer.
+  absl::Time timeout_ ABSL_GUARDED_BY(request_manager_mu_) =
+      absl::InfiniteFuture();
+
   // No. of handles still running updated by curl_multi_perform.
   // This can be used to delay destruction till all easy handles related to this
   // multi have completed running.
@@ -61,6 +119,11 @@ class MultiCurlRequestManager final {
   absl::Mutex request_manager_mu_;
   // Actual curl multi session pointer.
   CURLM* request_manager_ ABSL_GUARDED_BY(request_manager_mu_);
+  // The caches shared by the easy handles while they are in the session, and
+  // the mutexes of the caches. Easy handles in the session are only used with
+  // request_manager_mu_ held, but libcurl requires the share to be locked.
+  CURLSH* share_;
+  absl::Mutex share_mu_[CURL_LOCK_DATA_LAST];
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
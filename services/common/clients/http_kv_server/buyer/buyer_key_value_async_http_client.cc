@@ -15,14 +15,27 @@
 
 #include "services/common/clients/http_kv_server/buyer/buyer_key_value_async_http_client.h"
 
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_join.h"
 #include "glog/logging.h"
 #include "services/common/clients/http_kv_server/util/generate_url.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
 #include "services/common/util/request_metadata.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
 constexpr auto kEnableEncodeParams = true;
+constexpr char kKeysField[] = "keys";
+
+// Prefix of the cache keys of the keys looked up for a hostname.
+std::string CacheKeyPrefix(absl::string_view hostname) {
+  return absl::StrCat(hostname, ";");
+}
 
 // Builds Buyer KV Value lookup Request.
 HTTPRequest BuildBuyerKeyValueRequest(
@@ -50,8 +63,30 @@ absl::Status BuyerKeyValueAsyncHttpClient::Execute(
         void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
         on_done,
     absl::Duration timeout) const {
+  if (cache_ != nullptr && !keys->keys.empty()) {
+    return ExecuteWithCache(std::move(keys), metadata, std::move(on_done),
+                            timeout);
+  }
+  if (!options_.IsDefault()) {
+    Fetch(std::move(keys), metadata, timeout,
+          [on_done = std::move(on_done)](
+              absl::StatusOr<HTTPResponse> response) mutable {
+            if (!response.ok()) {
+              VLOG(2) << "BuyerKeyValueAsyncHttpClient Failure Response: "
+                      << response.status();
+              std::move(on_done)(response.status());
+              return;
+            }
+            std::move(on_done)(std::make_unique<GetBuyerValuesOutput>(
+                GetBuyerValuesOutput({std::move(response->body)})));
+          });
+    return absl::OkStatus();
+  }
+  CancellationToken* cancellation = keys->cancellation;
   HTTPRequest request = BuildBuyerKeyValueRequest(kv_server_base_address_,
                                                   metadata, std::move(keys));
+  AddKeyValueRequestHeaders(options_, request);
+  request.cancellation = cancellation;
   VLOG(2) << "BuyerKeyValueAsyncHttpClient Request: " << request.url;
   auto done_callback = [on_done = std::move(on_done)](
                            absl::StatusOr<std::string> resultStr) mutable {
@@ -78,11 +113,164 @@ absl::Status BuyerKeyValueAsyncHttpClient::Execute(
   return absl::OkStatus();
 }
 
+absl::Status BuyerKeyValueAsyncHttpClient::ExecuteWithCache(
+    std::unique_ptr<GetBuyerValuesInput> keys, const RequestMetadata& metadata,
+    absl::AnyInvocable<
+        void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
+        on_done,
+    absl::Duration timeout) const {
+  std::string key_prefix = CacheKeyPrefix(keys->hostname);
+  std::vector<CachedNamespace> cached = {{kKeysField}};
+  std::vector<std::string> missing_keys;
+  for (std::string& key : keys->keys) {
+    if (auto value = cache_->LookUp(absl::StrCat(key_prefix, key))) {
+      // Keys cached as misses are left out rather than looked up again.
+      if (!value->empty()) {
+        cached[0].values.emplace_back(std::move(key), std::move(value));
+      }
+    } else {
+      missing_keys.push_back(std::move(key));
+    }
+  }
+  if (missing_keys.empty()) {
+    std::string result;
+    if (options_.accept_table) {
+      AppendCachedValuesToTable(cached, &result);
+    } else {
+      result = MergeCachedValues(nullptr, cached);
+    }
+    std::move(on_done)(std::make_unique<GetBuyerValuesOutput>(
+        GetBuyerValuesOutput({std::move(result)})));
+    return absl::OkStatus();
+  }
+
+  // The keys the response has no value for are cached as misses.
+  std::vector<std::string> requested;
+  if (cache_->miss_ttl() > absl::ZeroDuration()) {
+    requested = missing_keys;
+  }
+  keys->keys = std::move(missing_keys);
+  auto done_callback = [cache = cache_, key_prefix = std::move(key_prefix),
+                        cached = std::move(cached),
+                        requested = std::move(requested),
+                        on_done = std::move(on_done)](
+                           absl::StatusOr<HTTPResponse> response) mutable {
+    if (!response.ok()) {
+      VLOG(2) << "BuyerKeyValueAsyncHttpClient Failure Response: "
+              << response.status();
+      std::move(on_done)(response.status());
+      return;
+    }
+    VLOG(2) << "\n\nBuyerKeyValueAsyncHttpClient Success Response:\n"
+            << response->body << "\n";
+    if (response->status_code == 200 && IsKeyValueTable(response->body)) {
+      if (absl::StatusOr<KeyValueTable> table =
+              ParseKeyValueTable(response->body);
+          table.ok()) {
+        CacheTableNamespace(
+            *table, kKeysField, key_prefix,
+            CacheableFor(response->cache_control, cache->ttl()), *cache,
+            requested);
+      }
+      AppendCachedValuesToTable(cached, &response->body);
+      std::move(on_done)(std::make_unique<GetBuyerValuesOutput>(
+          GetBuyerValuesOutput({std::move(response->body)})));
+      return;
+    }
+    absl::StatusOr<rapidjson::Document> document;
+    if (response->status_code == 200) {
+      document = ParseJsonString(response->body);
+    }
+    if (!document.ok() || !document->IsObject()) {
+      // Neither cached nor merged with the cached values.
+      std::move(on_done)(std::make_unique<GetBuyerValuesOutput>(
+          GetBuyerValuesOutput({std::move(response->body)})));
+      return;
+    }
+    CacheNamespace(*document, kKeysField, key_prefix,
+                   CacheableFor(response->cache_control, cache->ttl()), *cache,
+                   requested);
+    std::move(on_done)(std::make_unique<GetBuyerValuesOutput>(
+        GetBuyerValuesOutput({cached[0].values.empty()
+                                  ? std::move(response->body)
+                                  : MergeCachedValues(&*document, cached)})));
+  };
+  Fetch(std::move(keys), metadata, timeout, std::move(done_callback));
+  return absl::OkStatus();
+}
+
+void BuyerKeyValueAsyncHttpClient::Fetch(
+    std::unique_ptr<GetBuyerValuesInput> keys, const RequestMetadata& metadata,
+    absl::Duration timeout,
+    absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const {
+  if (batcher_ == nullptr) {
+    FetchKeys(std::move(keys), metadata, timeout, std::move(on_done));
+    return;
+  }
+  std::string batch_key = absl::StrCat(
+      keys->hostname, "\n",
+      absl::StrJoin(RequestMetadataToHttpHeaders(metadata, kMandatoryHeaders),
+                    "\n"));
+  KeyValueLookupKeys lookup_keys;
+  lookup_keys.push_back(std::move(keys->keys));
+  batcher_->LookUp(
+      std::move(batch_key), std::move(lookup_keys), timeout,
+      [this, hostname = std::move(keys->hostname), metadata](
+          KeyValueLookupKeys batch_keys, absl::Duration batch_timeout,
+          KeyValueBatcher::OnDone batch_on_done) mutable {
+        FetchKeys(std::make_unique<GetBuyerValuesInput>(GetBuyerValuesInput{
+                      std::move(batch_keys[0]), std::move(hostname)}),
+                  metadata, batch_timeout, std::move(batch_on_done));
+      },
+      std::move(on_done));
+}
+
+void BuyerKeyValueAsyncHttpClient::FetchKeys(
+    std::unique_ptr<GetBuyerValuesInput> keys, const RequestMetadata& metadata,
+    absl::Duration timeout,
+    absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const {
+  std::vector<std::vector<std::string>> lists;
+  lists.push_back(std::move(keys->keys));
+  std::vector<HTTPRequest> requests;
+  for (auto& chunk :
+       SplitKeys(std::move(lists), options_.max_keys_per_request)) {
+    auto chunk_keys = std::make_unique<GetBuyerValuesInput>(
+        GetBuyerValuesInput{std::move(chunk[0]), keys->hostname});
+    if (options_.use_post) {
+      requests.push_back(BuildKeyValuePostRequest(
+          kv_server_base_address_,
+          RequestMetadataToHttpHeaders(metadata, kMandatoryHeaders),
+          {{"hostname", chunk_keys->hostname}}, {{"keys", &chunk_keys->keys}},
+          options_.compress_body));
+    } else {
+      requests.push_back(BuildBuyerKeyValueRequest(
+          kv_server_base_address_, metadata, std::move(chunk_keys)));
+    }
+    AddKeyValueRequestHeaders(options_, requests.back());
+    requests.back().cancellation = keys->cancellation;
+    VLOG(2) << "BuyerKeyValueAsyncHttpClient Request: " << requests.back().url;
+  }
+  http_fetcher_async_->FetchUrlsWithMetadata(
+      requests, timeout,
+      [on_done = std::move(on_done)](
+          std::vector<absl::StatusOr<HTTPResponse>> responses) mutable {
+        std::move(on_done)(MergeKeyValueResponses(std::move(responses)));
+      });
+}
+
 BuyerKeyValueAsyncHttpClient::BuyerKeyValueAsyncHttpClient(
     absl::string_view kv_server_base_address,
-    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm)
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm,
+    std::shared_ptr<KeyValueCache> cache, KeyValueRequestOptions options)
     : http_fetcher_async_(std::move(http_fetcher_async)),
-      kv_server_base_address_(kv_server_base_address) {
+      kv_server_base_address_(kv_server_base_address),
+      cache_(std::move(cache)),
+      options_(options) {
+  if (options_.IsBatched()) {
+    batcher_ = std::make_shared<KeyValueBatcher>(
+        std::vector<std::string>{kKeysField}, options_.batch_max_keys,
+        options_.batch_max_delay, options_.batch_executor);
+  }
   if (pre_warm) {
     auto request = std::make_unique<GetBuyerValuesInput>();
     Execute(
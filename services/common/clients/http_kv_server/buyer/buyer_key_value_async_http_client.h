@@ -26,6 +26,10 @@
 #include "services/common/clients/async_client.h"
 #include "services/common/clients/client_params.h"
 #include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/key_value_batcher.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+#include "services/common/util/cancellation_token.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -39,6 +43,9 @@ struct GetBuyerValuesInput {
 
   // [DSP] The browser sets the hostname of the publisher page to be the value.
   std::string hostname;
+
+  // Optional. Cancels the fetches of the lookup, which it must outlive.
+  CancellationToken* cancellation = nullptr;
 };
 
 // Response from Buyer Key Value server as JSON string.
@@ -71,10 +78,15 @@ class BuyerKeyValueAsyncHttpClient
   // If pre_warm is true, it will send an empty request to the
   // KV client to establish connection and cache connection data with the
   // underlying HTTP server. It's false by default.
+  // If cache is not null, the values of the keys are cached per hostname, for
+  // as long as both the cache and the Cache-Control of the responses allow,
+  // and only the keys missing from the cache are fetched.
+  // options selects how the keys are sent, a single GET by default.
   explicit BuyerKeyValueAsyncHttpClient(
       absl::string_view kv_server_base_address,
       std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
-      bool pre_warm = false);
+      bool pre_warm = false, std::shared_ptr<KeyValueCache> cache = nullptr,
+      KeyValueRequestOptions options = {});
 
   // Executes the http request to a Key-Value Server asynchronously.
   //
@@ -90,8 +102,39 @@ class BuyerKeyValueAsyncHttpClient
       absl::Duration timeout) const override;
 
  private:
+  // Looks up the keys in cache_ and fetches the missing ones. The output has
+  // the fresh values of the response merged with the cached ones under
+  // "keys".
+  absl::Status ExecuteWithCache(
+      std::unique_ptr<GetBuyerValuesInput> keys,
+      const RequestMetadata& metadata,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>>) &&>
+          on_done,
+      absl::Duration timeout) const;
+
+  // Fetches the values of the keys as options_ selects and calls on_done with
+  // the response, merged from all the requests the keys are split into. The
+  // keys are batched with those of the concurrent lookups of the same
+  // hostname and headers if options_ says so, in which case the lookup is
+  // not cancelled, as the batch serves other requests too.
+  void Fetch(
+      std::unique_ptr<GetBuyerValuesInput> keys,
+      const RequestMetadata& metadata, absl::Duration timeout,
+      absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const;
+
+  // Sends the requests of the keys, without batching.
+  void FetchKeys(
+      std::unique_ptr<GetBuyerValuesInput> keys,
+      const RequestMetadata& metadata, absl::Duration timeout,
+      absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const;
+
   std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
   const std::string kv_server_base_address_;
+  std::shared_ptr<KeyValueCache> cache_;
+  const KeyValueRequestOptions options_;
+  // Set if options_ batches the lookups.
+  std::shared_ptr<KeyValueBatcher> batcher_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -15,6 +15,7 @@
 #include "services/common/clients/http_kv_server/buyer/buyer_key_value_async_http_client.h"
 
 #include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
 #include "services/common/test/random.h"
@@ -427,5 +428,207 @@ TEST_F(KeyValueAsyncHttpClientTest, SpacesInKeysGetEncoded) {
   callback_invoked.WaitForNotification();
 }
 
+TEST_F(KeyValueAsyncHttpClientTest, FetchesOnlyKeysMissingFromCache) {
+  auto cache = std::make_shared<KeyValueCache>(absl::Minutes(1),
+                                               /*max_bytes=*/1024);
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrls)
+      .WillOnce([this](const std::vector<HTTPRequest>& requests,
+                       absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        ASSERT_EQ(requests.size(), 1);
+        EXPECT_EQ(requests[0].url, hostname_ + "?hostname=pub.com&keys=a,b");
+        std::move(done_callback)({R"JSON({"keys":{"a":1,"b":{"x":2}}})JSON"});
+      })
+      .WillOnce([this](const std::vector<HTTPRequest>& requests,
+                       absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        ASSERT_EQ(requests.size(), 1);
+        EXPECT_EQ(requests[0].url, hostname_ + "?hostname=pub.com&keys=c");
+        std::move(done_callback)({R"JSON({"keys":{"c":3}})JSON"});
+      });
+  BuyerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      cache);
+
+  std::vector<std::string> results;
+  for (const std::vector<std::string>& keys :
+       {std::vector<std::string>{"a", "b"}, std::vector<std::string>{"b", "c"},
+        std::vector<std::string>{"a"}}) {
+    EXPECT_TRUE(client
+                    .Execute(std::make_unique<GetBuyerValuesInput>(
+                                 GetBuyerValuesInput{keys, "pub.com"}),
+                             {},
+                             [&results](absl::StatusOr<std::unique_ptr<
+                                            GetBuyerValuesOutput>>
+                                            output) {
+                               ASSERT_TRUE(output.ok());
+                               results.push_back((*output)->result);
+                             },
+                             absl::Milliseconds(5000))
+                    .ok());
+  }
+
+  EXPECT_THAT(results,
+              testing::ElementsAre(R"JSON({"keys":{"a":1,"b":{"x":2}}})JSON",
+                                   R"JSON({"keys":{"c":3,"b":{"x":2}}})JSON",
+                                   R"JSON({"keys":{"a":1}})JSON"));
+}
+
+TEST_F(KeyValueAsyncHttpClientTest, DoesNotFetchKeysCachedAsMisses) {
+  auto cache = std::make_shared<KeyValueCache>(
+      absl::Minutes(1), /*max_bytes=*/1024, /*num_shards=*/16,
+      /*miss_ttl=*/absl::Minutes(1));
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrls)
+      .WillOnce([this](const std::vector<HTTPRequest>& requests,
+                       absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        ASSERT_EQ(requests.size(), 1);
+        EXPECT_EQ(requests[0].url,
+                  hostname_ + "?hostname=pub.com&keys=a,absent,null");
+        std::move(done_callback)({R"JSON({"keys":{"a":1,"null":null}})JSON"});
+      });
+  BuyerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      cache);
+
+  std::vector<std::string> results;
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_TRUE(client
+                    .Execute(std::make_unique<GetBuyerValuesInput>(
+                                 GetBuyerValuesInput{{"a", "absent", "null"},
+                                                     "pub.com"}),
+                             {},
+                             [&results](absl::StatusOr<std::unique_ptr<
+                                            GetBuyerValuesOutput>>
+                                            output) {
+                               ASSERT_TRUE(output.ok());
+                               results.push_back((*output)->result);
+                             },
+                             absl::Milliseconds(5000))
+                    .ok());
+  }
+
+  EXPECT_THAT(results, testing::ElementsAre(
+                           R"JSON({"keys":{"a":1,"null":null}})JSON",
+                           R"JSON({"keys":{"a":1}})JSON"));
+}
+
+TEST_F(KeyValueAsyncHttpClientTest, CachesAndMergesKeyValueTables) {
+  auto cache = std::make_shared<KeyValueCache>(absl::Minutes(1),
+                                               /*max_bytes=*/1024);
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrls)
+      .WillOnce([this](const std::vector<HTTPRequest>& requests,
+                       absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        ASSERT_EQ(requests.size(), 1);
+        EXPECT_EQ(requests[0].url, hostname_ + "?hostname=pub.com&keys=a,b");
+        EXPECT_THAT(requests[0].headers,
+                    testing::Contains(
+                        "Accept: application/vnd.bidding-auction.kv-table"));
+        std::move(done_callback)({R"(KVT14:keys2:1:a1:11:b7:{"x":2})"});
+      })
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        std::move(done_callback)({"KVT14:keys1:1:c1:3"});
+      });
+  BuyerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      cache, {.accept_table = true});
+
+  std::vector<std::string> results;
+  for (const std::vector<std::string>& keys :
+       {std::vector<std::string>{"a", "b"}, std::vector<std::string>{"b", "c"},
+        std::vector<std::string>{"a"}}) {
+    EXPECT_TRUE(client
+                    .Execute(std::make_unique<GetBuyerValuesInput>(
+                                 GetBuyerValuesInput{keys, "pub.com"}),
+                             {},
+                             [&results](absl::StatusOr<std::unique_ptr<
+                                            GetBuyerValuesOutput>>
+                                            output) {
+                               ASSERT_TRUE(output.ok());
+                               results.push_back((*output)->result);
+                             },
+                             absl::Milliseconds(5000))
+                    .ok());
+  }
+
+  EXPECT_THAT(results, testing::ElementsAre(
+                           R"(KVT14:keys2:1:a1:11:b7:{"x":2})",
+                           R"(KVT14:keys1:1:c1:34:keys1:1:b7:{"x":2})",
+                           "KVT14:keys1:1:a1:1"));
+}
+
+TEST_F(KeyValueAsyncHttpClientTest, DoesNotCacheFailedFetches) {
+  auto cache = std::make_shared<KeyValueCache>(absl::Minutes(1),
+                                               /*max_bytes=*/1024);
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrls)
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        std::move(done_callback)({absl::UnavailableError("unavailable")});
+      })
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        std::move(done_callback)({"not json"});
+      })
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        std::move(done_callback)({R"JSON({"keys":{"a":1}})JSON"});
+      });
+  BuyerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      cache);
+
+  std::vector<absl::StatusOr<std::string>> results;
+  for (int i = 0; i < 3; ++i) {
+    client
+        .Execute(
+            std::make_unique<GetBuyerValuesInput>(
+                GetBuyerValuesInput{{"a"}, "pub.com"}),
+            {},
+            [&results](
+                absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) {
+              if (output.ok()) {
+                results.push_back((*output)->result);
+              } else {
+                results.push_back(output.status());
+              }
+            },
+            absl::Milliseconds(5000))
+        .IgnoreError();
+  }
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(results[0].status().code(), absl::StatusCode::kUnavailable);
+  EXPECT_EQ(*results[1], "not json");
+  EXPECT_EQ(*results[2], R"JSON({"keys":{"a":1}})JSON");
+}
+
+TEST_F(KeyValueAsyncHttpClientTest, SplitsKeysIntoParallelRequests) {
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrls)
+      .WillOnce([this](const std::vector<HTTPRequest>& requests,
+                       absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        ASSERT_EQ(requests.size(), 2);
+        EXPECT_EQ(requests[0].url, hostname_ + "?hostname=pub.com&keys=a,b");
+        EXPECT_EQ(requests[1].url, hostname_ + "?hostname=pub.com&keys=c");
+        std::move(done_callback)({R"JSON({"keys":{"a":1,"b":2}})JSON",
+                                  R"JSON({"keys":{"c":3}})JSON"});
+      });
+  BuyerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      /*cache=*/nullptr, {.max_keys_per_request = 2});
+
+  absl::Notification callback_invoked;
+  auto on_done =
+      [&callback_invoked](
+          absl::StatusOr<std::unique_ptr<GetBuyerValuesOutput>> output) {
+        ASSERT_TRUE(output.ok());
+        EXPECT_EQ((*output)->result, R"JSON({"keys":{"a":1,"b":2,"c":3}})JSON");
+        callback_invoked.Notify();
+      };
+  EXPECT_TRUE(client
+                  .Execute(std::make_unique<GetBuyerValuesInput>(
+                               GetBuyerValuesInput{{"a", "b", "c"}, "pub.com"}),
+                           {}, std::move(on_done), absl::Milliseconds(5000))
+                  .ok());
+  callback_invoked.WaitForNotification();
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -15,8 +15,10 @@
 
 #include "services/common/clients/http_kv_server/seller/seller_key_value_async_http_client.h"
 
+#include "absl/strings/str_join.h"
 #include "glog/logging.h"
 #include "services/common/clients/http_kv_server/util/generate_url.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
 #include "services/common/util/request_metadata.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -49,8 +51,24 @@ absl::Status SellerKeyValueAsyncHttpClient::Execute(
         void(absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>) &&>
         on_done,
     absl::Duration timeout) const {
+  if (!options_.IsDefault()) {
+    Fetch(std::move(keys), metadata, timeout,
+          [on_done = std::move(on_done)](
+              absl::StatusOr<HTTPResponse> response) mutable {
+            if (!response.ok()) {
+              VLOG(2) << "SellerKeyValueAsyncHttpClients Response: "
+                      << response.status();
+              std::move(on_done)(response.status());
+              return;
+            }
+            std::move(on_done)(std::make_unique<GetSellerValuesOutput>(
+                GetSellerValuesOutput({std::move(response->body)})));
+          });
+    return absl::OkStatus();
+  }
   HTTPRequest request = BuildSellerKeyValueRequest(kv_server_base_address_,
                                                    metadata, std::move(keys));
+  AddKeyValueRequestHeaders(options_, request);
   VLOG(2) << "SellerKeyValueAsyncHttpClient Request: " << request.url;
   VLOG(2) << "\nSellerKeyValueAsyncHttpClient Headers:\n";
   for (const auto& header : request.headers) {
@@ -77,11 +95,83 @@ absl::Status SellerKeyValueAsyncHttpClient::Execute(
   return absl::OkStatus();
 }
 
+void SellerKeyValueAsyncHttpClient::Fetch(
+    std::unique_ptr<GetSellerValuesInput> keys, const RequestMetadata& metadata,
+    absl::Duration timeout,
+    absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const {
+  if (batcher_ == nullptr) {
+    FetchKeys(std::move(keys), metadata, timeout, std::move(on_done));
+    return;
+  }
+  KeyValueLookupKeys lookup_keys;
+  lookup_keys.push_back(std::move(keys->render_urls));
+  lookup_keys.push_back(std::move(keys->ad_component_render_urls));
+  batcher_->LookUp(
+      absl::StrJoin(RequestMetadataToHttpHeaders(metadata), "\n"),
+      std::move(lookup_keys), timeout,
+      [this, metadata](KeyValueLookupKeys batch_keys,
+                       absl::Duration batch_timeout,
+                       KeyValueBatcher::OnDone batch_on_done) {
+        FetchKeys(std::make_unique<GetSellerValuesInput>(GetSellerValuesInput{
+                      std::move(batch_keys[0]), std::move(batch_keys[1])}),
+                  metadata, batch_timeout, std::move(batch_on_done));
+      },
+      std::move(on_done));
+}
+
+void SellerKeyValueAsyncHttpClient::FetchKeys(
+    std::unique_ptr<GetSellerValuesInput> keys, const RequestMetadata& metadata,
+    absl::Duration timeout,
+    absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const {
+  http_fetcher_async_->FetchUrlsWithMetadata(
+      BuildRequests(std::move(keys), metadata), timeout,
+      [on_done = std::move(on_done)](
+          std::vector<absl::StatusOr<HTTPResponse>> responses) mutable {
+        std::move(on_done)(MergeKeyValueResponses(std::move(responses)));
+      });
+}
+
+std::vector<HTTPRequest> SellerKeyValueAsyncHttpClient::BuildRequests(
+    std::unique_ptr<GetSellerValuesInput> keys,
+    const RequestMetadata& metadata) const {
+  std::vector<std::vector<std::string>> lists;
+  lists.push_back(std::move(keys->render_urls));
+  lists.push_back(std::move(keys->ad_component_render_urls));
+  std::vector<HTTPRequest> requests;
+  for (auto& chunk :
+       SplitKeys(std::move(lists), options_.max_keys_per_request)) {
+    auto chunk_keys = std::make_unique<GetSellerValuesInput>(
+        GetSellerValuesInput{std::move(chunk[0]), std::move(chunk[1])});
+    if (options_.use_post) {
+      requests.push_back(BuildKeyValuePostRequest(
+          kv_server_base_address_, RequestMetadataToHttpHeaders(metadata), {},
+          {{"renderUrls", &chunk_keys->render_urls},
+           {"adComponentRenderUrls", &chunk_keys->ad_component_render_urls}},
+          options_.compress_body));
+    } else {
+      requests.push_back(BuildSellerKeyValueRequest(
+          kv_server_base_address_, metadata, std::move(chunk_keys)));
+    }
+    AddKeyValueRequestHeaders(options_, requests.back());
+    VLOG(2) << "SellerKeyValueAsyncHttpClient Request: "
+            << requests.back().url;
+  }
+  return requests;
+}
+
 SellerKeyValueAsyncHttpClient::SellerKeyValueAsyncHttpClient(
     absl::string_view kv_server_base_address,
-    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm)
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async, bool pre_warm,
+    KeyValueRequestOptions options)
     : http_fetcher_async_(std::move(http_fetcher_async)),
-      kv_server_base_address_(kv_server_base_address) {
+      kv_server_base_address_(kv_server_base_address),
+      options_(options) {
+  if (options_.IsBatched()) {
+    batcher_ = std::make_shared<KeyValueBatcher>(
+        std::vector<std::string>{"renderUrls", "adComponentRenderUrls"},
+        options_.batch_max_keys, options_.batch_max_delay,
+        options_.batch_executor);
+  }
   if (pre_warm) {
     auto request = std::make_unique<GetSellerValuesInput>();
     Execute(
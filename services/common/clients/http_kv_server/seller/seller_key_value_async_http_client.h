@@ -24,6 +24,8 @@
 #include "services/common/clients/async_client.h"
 #include "services/common/clients/client_params.h"
 #include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/key_value_batcher.h"
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -68,10 +70,11 @@ class SellerKeyValueAsyncHttpClient
   // If pre_warm is true, it will send an empty request to the
   // KV client to establish connection and cache connection data with the
   // underlying HTTP server. It's false by default.
+  // options selects how the keys are sent, a single GET by default.
   explicit SellerKeyValueAsyncHttpClient(
       absl::string_view kv_server_base_address,
       std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
-      bool pre_warm = false);
+      bool pre_warm = false, KeyValueRequestOptions options = {});
 
   // Executes the http request to a Key-Value Server asynchronously.
   //
@@ -87,8 +90,31 @@ class SellerKeyValueAsyncHttpClient
       absl::Duration timeout) const override;
 
  private:
+  // Fetches the values of the keys as options_ selects and calls on_done with
+  // the response, merged from all the requests the keys are split into. The
+  // keys are batched with those of the concurrent lookups of the same headers
+  // if options_ says so.
+  void Fetch(
+      std::unique_ptr<GetSellerValuesInput> keys,
+      const RequestMetadata& metadata, absl::Duration timeout,
+      absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const;
+
+  // Sends the requests of the keys, without batching.
+  void FetchKeys(
+      std::unique_ptr<GetSellerValuesInput> keys,
+      const RequestMetadata& metadata, absl::Duration timeout,
+      absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&> on_done) const;
+
+  // Returns the requests of the keys, as options_ selects.
+  std::vector<HTTPRequest> BuildRequests(
+      std::unique_ptr<GetSellerValuesInput> keys,
+      const RequestMetadata& metadata) const;
+
   std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
   const std::string kv_server_base_address_;
+  const KeyValueRequestOptions options_;
+  // Set if options_ batches the lookups.
+  std::shared_ptr<KeyValueBatcher> batcher_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
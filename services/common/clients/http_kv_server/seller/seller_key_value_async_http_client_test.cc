@@ -15,6 +15,7 @@
 #include "services/common/clients/http_kv_server/seller/seller_key_value_async_http_client.h"
 
 #include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
 #include "services/common/test/random.h"
@@ -369,5 +370,48 @@ TEST_F(KeyValueAsyncHttpClientTest, PrewarmsHTTPClient) {
       hostname_, std::move(mock_http_fetcher_async_), true);
   absl::SleepFor(absl::Milliseconds(500));
 }
+
+TEST_F(KeyValueAsyncHttpClientTest, PostsKeysSplitIntoParallelRequests) {
+  EXPECT_CALL(*mock_http_fetcher_async_, FetchUrls)
+      .WillOnce([this](const std::vector<HTTPRequest>& requests,
+                       absl::Duration timeout, OnDoneFetchUrls done_callback) {
+        ASSERT_EQ(requests.size(), 2);
+        for (const HTTPRequest& request : requests) {
+          EXPECT_EQ(request.url, hostname_);
+          EXPECT_THAT(request.headers,
+                      testing::Contains("Content-Type: application/json"));
+        }
+        EXPECT_EQ(requests[0].body,
+                  R"JSON({"renderUrls":["url1","url2"]})JSON");
+        EXPECT_EQ(requests[1].body,
+                  R"JSON({"adComponentRenderUrls":["url3"]})JSON");
+        std::move(done_callback)(
+            {R"JSON({"renderUrls":{"url1":1,"url2":2}})JSON",
+             R"JSON({"adComponentRenderUrls":{"url3":3}})JSON"});
+      });
+  SellerKeyValueAsyncHttpClient client(
+      hostname_, std::move(mock_http_fetcher_async_), /*pre_warm=*/false,
+      {.use_post = true, .max_keys_per_request = 2});
+
+  absl::Notification callback_invoked;
+  EXPECT_TRUE(
+      client
+          .Execute(
+              std::make_unique<GetSellerValuesInput>(
+                  GetSellerValuesInput{{"url1", "url2"}, {"url3"}}),
+              {},
+              [&callback_invoked](
+                  absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>
+                      output) {
+                ASSERT_TRUE(output.ok());
+                EXPECT_EQ((*output)->result,
+                          R"JSON({"renderUrls":{"url1":1,"url2":2},)JSON"
+                          R"JSON("adComponentRenderUrls":{"url3":3}})JSON");
+                callback_invoked.Notify();
+              },
+              absl::Milliseconds(5000))
+          .ok());
+  callback_invoked.WaitForNotification();
+}
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
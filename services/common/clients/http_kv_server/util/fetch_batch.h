@@ -0,0 +1,50 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_FETCH_BATCH_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_FETCH_BATCH_H_
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Results of a batch of fetches completing in any order, handed to
+// done_callback in the order of the batch once the last one is in.
+template <typename T, typename OnDone>
+class FetchBatch {
+ public:
+  FetchBatch(size_t size, OnDone done_callback)
+      : results_(size),
+        remaining_(size),
+        done_callback_(std::move(done_callback)) {}
+
+  // Sets the result of the fetch at index in the batch.
+  void Set(size_t index, T result) {
+    results_[index] = std::move(result);
+    if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      std::move(done_callback_)(std::move(results_));
+    }
+  }
+
+ private:
+  std::vector<T> results_;
+  std::atomic<size_t> remaining_;
+  OnDone done_callback_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_FETCH_BATCH_H_
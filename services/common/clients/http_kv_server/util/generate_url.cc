@@ -16,20 +16,65 @@
 #include "services/common/clients/http_kv_server/util/generate_url.h"
 
 #include <algorithm>
-
-#include <curl/curl.h>
+#include <array>
+#include <cstddef>
 
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_join.h"
 
 namespace {
-std::string EncodeParam(absl::string_view param) {
-  char* encoded_chars = curl_easy_escape(NULL, param.data(), param.length());
-  // Create copy to free up CURL allocated memory.
-  std::string encoded_str(encoded_chars);
-  curl_free(encoded_chars);
-  return encoded_str;
+
+// Whether the URL encoding leaves each byte as is, as it does the unreserved
+// characters of RFC 3986. Every other byte is percent-encoded, like
+// curl_easy_escape does.
+constexpr std::array<bool, 256> MakeUnreservedTable() {
+  std::array<bool, 256> unreserved = {};
+  for (int c = 0; c < 256; ++c) {
+    unreserved[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                    (c >= '0' && c <= '9') || c == '-' || c == '.' ||
+                    c == '_' || c == '~';
+  }
+  return unreserved;
+}
+
+constexpr std::array<bool, 256> kUnreserved = MakeUnreservedTable();
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+bool IsUnreserved(char c) { return kUnreserved[static_cast<unsigned char>(c)]; }
+
+size_t EncodedSize(absl::string_view param) {
+  size_t size = param.size();
+  for (char c : param) {
+    if (!IsUnreserved(c)) {
+      size += 2;
+    }
+  }
+  return size;
+}
+
+// Writes param URL-encoded to out, which must have room for EncodedSize of
+// it, and returns the end of what was written. Each run of unreserved
+// characters, usually most of a URL, is copied at once.
+char* WriteEncoded(absl::string_view param, char* out) {
+  const char* begin = param.data();
+  const char* const end = begin + param.size();
+  while (begin != end) {
+    const char* run_end = begin;
+    while (run_end != end && IsUnreserved(*run_end)) {
+      ++run_end;
+    }
+    out = std::copy(begin, run_end, out);
+    if (run_end == end) {
+      break;
+    }
+    const unsigned char c = *run_end;
+    *out++ = '%';
+    *out++ = kHexDigits[c >> 4];
+    *out++ = kHexDigits[c & 0xF];
+    begin = run_end + 1;
+  }
+  return out;
 }
+
 }  // namespace
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -43,15 +88,29 @@ void AddAmpersandIfNotFirstQueryParam(std::string* url) {
 void AddListItemsAsQueryParamsToUrl(std::string* url, absl::string_view key,
                                     const std::vector<std::string>& values,
                                     bool encode_params) {
+  // The size of the whole query is known up front, so that it is written
+  // with a single allocation.
+  size_t query_size = key.size() + 1;
+  for (const std::string& value : values) {
+    query_size += encode_params ? EncodedSize(value) : value.size();
+  }
+  if (!values.empty()) {
+    // Commas between the values.
+    query_size += values.size() - 1;
+  }
+  url->reserve(url->size() + 1 + query_size);
   AddAmpersandIfNotFirstQueryParam(url);
-  absl::StrAppend(url, key, "=");
-  if (encode_params) {
-    std::vector<std::string> encoded_values(values.size());
-    std::transform(values.cbegin(), values.cend(), encoded_values.begin(),
-                   [](const std::string& str) { return EncodeParam(str); });
-    absl::StrAppend(url, absl::StrJoin(encoded_values, ","));
-  } else {
-    absl::StrAppend(url, absl::StrJoin(values, ","));
+  const size_t query_start = url->size();
+  url->resize(query_start + query_size);
+  char* out = std::copy(key.begin(), key.end(), url->data() + query_start);
+  *out++ = '=';
+  for (size_t i = 0; i < values.size(); ++i) {
+    if (i > 0) {
+      *out++ = ',';
+    }
+    out = encode_params
+              ? WriteEncoded(values[i], out)
+              : std::copy(values[i].begin(), values[i].end(), out);
   }
 }
 
@@ -38,6 +38,7 @@ void AddAmpersandIfNotFirstQueryParam(std::string* url);
  * @param key the name of the query parameter, e.g. "fruits"
  * @param values the values for the query parameter, e.g. ["apple", "orange"]
  * @param encode_params the query parameters will be http encoded (eg. for URLs)
+ * by percent-encoding every byte but the unreserved characters of RFC 3986
  * NOTE: When adding a new query parameter with multiple values, call this
  * method.
  */
@@ -0,0 +1,64 @@
+//   Copyright 2023 Google LLC
+//
+//   Licensed under the Apache License, Version 2.0 (the "License");
+//   you may not use this file except in compliance with the License.
+//   You may obtain a copy of the License at
+//
+//        http://www.apache.org/licenses/LICENSE-2.0
+//
+//   Unless required by applicable law or agreed to in writing, software
+//   distributed under the License is distributed on an "AS IS" BASIS,
+//   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//   See the License for the specific language governing permissions and
+//   limitations under the License.
+//
+
+#include "services/common/clients/http_kv_server/util/generate_url.h"
+
+#include <string>
+#include <vector>
+
+#include <curl/curl.h>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string CurlEscape(const std::string& param) {
+  char* escaped = curl_easy_escape(nullptr, param.data(), param.size());
+  std::string escaped_str(escaped);
+  curl_free(escaped);
+  return escaped_str;
+}
+
+TEST(AddListItemsAsQueryParamsToUrl, JoinsTheValuesWithCommas) {
+  std::string url;
+  ClearAndMakeStartOfUrl("https://kv.com/v1", &url);
+  AddListItemsAsQueryParamsToUrl(&url, "keys", {"a", "b,c"});
+  AddListItemsAsQueryParamsToUrl(&url, "empty", {});
+  AddListItemsAsQueryParamsToUrl(&url, "hostname", {"example.com"});
+  EXPECT_EQ(url, "https://kv.com/v1?keys=a,b,c&empty=&hostname=example.com");
+}
+
+TEST(AddListItemsAsQueryParamsToUrl, EncodesTheValuesLikeCurl) {
+  std::string every_byte;
+  for (int c = 0; c < 256; ++c) {
+    every_byte.push_back(static_cast<char>(c));
+  }
+  const std::vector<std::string> values = {
+      "https://ads.com/ad?id=1&size=300x250#frag", "", every_byte,
+      "unreserved-._~AZaz09", "%%", "\xc3\xa9t\xc3\xa9"};
+  std::string url = "https://kv.com/v1?";
+  AddListItemsAsQueryParamsToUrl(&url, "renderUrls", values,
+                                 /*encode_params=*/true);
+
+  std::string expected = "https://kv.com/v1?renderUrls=";
+  for (size_t i = 0; i < values.size(); ++i) {
+    expected += (i > 0 ? "," : "") + CurlEscape(values[i]);
+  }
+  EXPECT_EQ(url, expected);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,201 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/hedging_http_fetcher_async.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "absl/functional/any_invocable.h"
+#include "services/common/clients/http_kv_server/util/fetch_batch.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Max hedges that can be sent in a burst after a quiet period.
+constexpr double kMaxBudget = 10;
+
+std::atomic<int64_t> hedged_fetches = 0;
+std::atomic<int64_t> won_by_hedge_fetches = 0;
+std::atomic<int64_t> over_budget_fetches = 0;
+
+}  // namespace
+
+class HedgingHttpFetcherAsync::Hedger
+    : public std::enable_shared_from_this<Hedger> {
+ public:
+  using OnResponse =
+      absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&>;
+
+  Hedger(std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+         server_common::Executor* executor, HedgingOptions options)
+      : executor_(executor),
+        options_(options),
+        http_fetcher_async_(std::move(http_fetcher_async)) {}
+
+  // Fetches the request, and fetches it again if it is still in flight after
+  // the hedging delay and the budget allows it.
+  void Fetch(const HTTPRequest& request, absl::Duration timeout,
+             OnResponse on_response) {
+    auto fetch = std::make_shared<InFlightFetch>(std::move(on_response));
+    Send(request, timeout, fetch, /*is_hedge=*/false);
+
+    std::optional<absl::Duration> delay =
+        histogram_.Percentile(options_.latency_percentile);
+    {
+      absl::MutexLock lock(&mu_);
+      budget_ = std::min(budget_ + options_.budget_percent / 100.0, kMaxBudget);
+    }
+    if (!delay.has_value() || *delay >= timeout) {
+      return;
+    }
+    executor_->RunAfter(*delay, [hedger = weak_from_this(), request,
+                                 timeout = timeout - *delay,
+                                 fetch = std::move(fetch)]() mutable {
+      if (std::shared_ptr<Hedger> locked = hedger.lock()) {
+        locked->Hedge(std::move(request), timeout, std::move(fetch));
+      }
+    });
+  }
+
+ private:
+  // A fetch completed by the first response to any of its requests.
+  struct InFlightFetch {
+    explicit InFlightFetch(OnResponse on_response)
+        : on_response(std::move(on_response)) {}
+
+    std::atomic<bool> done = false;
+    OnResponse on_response;
+  };
+
+  void Hedge(HTTPRequest request, absl::Duration timeout,
+             std::shared_ptr<InFlightFetch> fetch) {
+    if (fetch->done.load(std::memory_order_acquire)) {
+      return;
+    }
+    {
+      absl::MutexLock lock(&mu_);
+      if (budget_ < 1) {
+        over_budget_fetches.fetch_add(1, std::memory_order_relaxed);
+        return;
+      }
+      budget_ -= 1;
+    }
+    hedged_fetches.fetch_add(1, std::memory_order_relaxed);
+    request.fresh_connection = true;
+    Send(request, timeout, std::move(fetch), /*is_hedge=*/true);
+  }
+
+  void Send(const HTTPRequest& request, absl::Duration timeout,
+            std::shared_ptr<InFlightFetch> fetch, bool is_hedge) {
+    // The callbacks only outlive this on the destruction of the wrapped
+    // fetcher. It is the last member declared, so it is destroyed first, while
+    // the members the callbacks use are still alive.
+    http_fetcher_async_->FetchUrlsWithMetadata(
+        {request}, timeout,
+        [this, fetch = std::move(fetch), is_hedge, start = absl::Now()](
+            std::vector<absl::StatusOr<HTTPResponse>> responses) {
+          if (responses[0].ok()) {
+            histogram_.Record(absl::Now() - start);
+          }
+          if (fetch->done.exchange(true, std::memory_order_acq_rel)) {
+            return;
+          }
+          if (is_hedge) {
+            won_by_hedge_fetches.fetch_add(1, std::memory_order_relaxed);
+          }
+          std::move(fetch->on_response)(std::move(responses[0]));
+        });
+  }
+
+  server_common::Executor* executor_;
+  const HedgingOptions options_;
+  LatencyHistogram histogram_;
+  absl::Mutex mu_;
+  // Hedges that can be sent, growing by budget_percent of each fetch.
+  double budget_ ABSL_GUARDED_BY(mu_) = 0;
+  // Must stay last, see Send().
+  std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
+};
+
+HedgingHttpFetcherAsync::HedgingHttpFetcherAsync(
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+    server_common::Executor* executor, HedgingOptions options)
+    : hedger_(std::make_shared<Hedger>(std::move(http_fetcher_async), executor,
+                                       options)) {}
+
+void HedgingHttpFetcherAsync::FetchUrl(const HTTPRequest& http_request,
+                                       int timeout_ms,
+                                       OnDoneFetchUrl done_callback) {
+  hedger_->Fetch(http_request, absl::Milliseconds(timeout_ms),
+                 [done_callback = std::move(done_callback)](
+                     absl::StatusOr<HTTPResponse> response) mutable {
+                   if (response.ok()) {
+                     std::move(done_callback)(std::move(response->body));
+                   } else {
+                     std::move(done_callback)(response.status());
+                   }
+                 });
+}
+
+void HedgingHttpFetcherAsync::FetchUrls(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrls done_callback) {
+  if (requests.empty()) {
+    std::move(done_callback)({});
+    return;
+  }
+  auto batch = std::make_shared<
+      FetchBatch<absl::StatusOr<std::string>, OnDoneFetchUrls>>(
+      requests.size(), std::move(done_callback));
+  for (size_t i = 0; i < requests.size(); ++i) {
+    hedger_->Fetch(requests[i], timeout,
+                   [batch, i](absl::StatusOr<HTTPResponse> response) {
+                     if (response.ok()) {
+                       batch->Set(i, std::move(response->body));
+                     } else {
+                       batch->Set(i, response.status());
+                     }
+                   });
+  }
+}
+
+void HedgingHttpFetcherAsync::FetchUrlsWithMetadata(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrlsWithMetadata done_callback) {
+  if (requests.empty()) {
+    std::move(done_callback)({});
+    return;
+  }
+  auto batch = std::make_shared<
+      FetchBatch<absl::StatusOr<HTTPResponse>, OnDoneFetchUrlsWithMetadata>>(
+      requests.size(), std::move(done_callback));
+  for (size_t i = 0; i < requests.size(); ++i) {
+    hedger_->Fetch(requests[i], timeout,
+                   [batch, i](absl::StatusOr<HTTPResponse> response) {
+                     batch->Set(i, std::move(response));
+                   });
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetHedgingStats() {
+  return {
+      {"hedged", hedged_fetches.exchange(0)},
+      {"won_by_hedge", won_by_hedge_fetches.exchange(0)},
+      {"over_budget", over_budget_fetches.exchange(0)},
+  };
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,83 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_HEDGING_HTTP_FETCHER_ASYNC_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_HEDGING_HTTP_FETCHER_ASYNC_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/latency_histogram.h"
+#include "src/cpp/concurrent/event_engine_executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct HedgingOptions {
+  // Percentile of the recent fetch latencies after which a fetch still in
+  // flight is sent again.
+  int latency_percentile = 95;
+  // Max hedged fetches, as a percentage of the fetches.
+  int budget_percent = 5;
+};
+
+// Decorates an HttpFetcherAsync so that a fetch taking longer than a
+// percentile of the recent fetch latencies is sent again over a new
+// connection, likely to another backend, and completes with whichever
+// response comes first. Hedging stays within a budget of extra fetches, and
+// is off until enough latencies are recorded.
+class HedgingHttpFetcherAsync final : public HttpFetcherAsync {
+ public:
+  HedgingHttpFetcherAsync(std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+                          server_common::Executor* executor,
+                          HedgingOptions options = {});
+
+  void FetchUrl(const HTTPRequest& http_request, int timeout_ms,
+                OnDoneFetchUrl done_callback) override;
+
+  void FetchUrls(const std::vector<HTTPRequest>& requests,
+                 absl::Duration timeout,
+                 OnDoneFetchUrls done_callback) override;
+
+  void FetchUrlsWithMetadata(
+      const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+      OnDoneFetchUrlsWithMetadata done_callback) override;
+
+ private:
+  // Shared with the pending hedge timers, which outlive the fetcher.
+  class Hedger;
+
+  std::shared_ptr<Hedger> hedger_;
+};
+
+// Returns the number of fetches "hedged", of hedged fetches "won_by_hedge"
+// and of fetches not hedged as "over_budget" by all the
+// HedgingHttpFetcherAsync instances since the previous call.
+absl::flat_hash_map<std::string, double> GetHedgingStats();
+
+template <typename T>
+inline void AddHedgingMetric(T* context_map) {
+  context_map->AddObserverable(metric::kKVHedgingEventCount, GetHedgingStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_HEDGING_HTTP_FETCHER_ASYNC_H_
@@ -0,0 +1,149 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/hedging_http_fetcher_async.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+class HedgingHttpFetcherAsyncTest : public testing::Test {
+ protected:
+  HedgingHttpFetcherAsyncTest() {
+    GetHedgingStats();
+    auto mock_http_fetcher_async =
+        std::make_unique<testing::NiceMock<MockHttpFetcherAsync>>();
+    ON_CALL(*mock_http_fetcher_async, FetchUrls)
+        .WillByDefault([this](const std::vector<HTTPRequest>& requests,
+                              absl::Duration timeout,
+                              OnDoneFetchUrls done_callback) {
+          fresh_connections_.push_back(requests[0].fresh_connection);
+          pending_.push_back(std::move(done_callback));
+        });
+    ON_CALL(executor_, RunAfter)
+        .WillByDefault([this](absl::Duration delay,
+                              absl::AnyInvocable<void()> closure) {
+          timers_.push_back(std::move(closure));
+          return server_common::TaskId{};
+        });
+    fetcher_ = std::make_unique<HedgingHttpFetcherAsync>(
+        std::move(mock_http_fetcher_async), &executor_);
+  }
+
+  // Completes the fetch sent at index to the wrapped fetcher.
+  void Complete(size_t index, std::string body) {
+    std::move(pending_[index])({std::move(body)});
+  }
+
+  // Records enough latencies for fetches to be hedged, which also adds to
+  // the hedging budget.
+  void WarmUp() {
+    for (int i = 0; i < LatencyHistogram::kMinSamples; ++i) {
+      fetcher_->FetchUrl({"kv"}, 100, [](absl::StatusOr<std::string>) {});
+      Complete(pending_.size() - 1, "");
+    }
+    pending_.clear();
+    fresh_connections_.clear();
+    timers_.clear();
+  }
+
+  testing::NiceMock<MockExecutor> executor_;
+  std::vector<bool> fresh_connections_;
+  std::vector<OnDoneFetchUrls> pending_;
+  std::vector<absl::AnyInvocable<void()>> timers_;
+  std::unique_ptr<HedgingHttpFetcherAsync> fetcher_;
+};
+
+TEST_F(HedgingHttpFetcherAsyncTest, DoesNotHedgeWithoutLatencies) {
+  fetcher_->FetchUrl({"kv"}, 100, [](absl::StatusOr<std::string>) {});
+
+  EXPECT_EQ(pending_.size(), 1);
+  EXPECT_TRUE(timers_.empty());
+}
+
+TEST_F(HedgingHttpFetcherAsyncTest, HedgesSlowFetchOverNewConnection) {
+  WarmUp();
+  std::vector<std::string> results;
+  fetcher_->FetchUrl({"kv"}, 100,
+                     [&results](absl::StatusOr<std::string> result) {
+                       results.push_back(*result);
+                     });
+  ASSERT_EQ(timers_.size(), 1);
+  std::move(timers_[0])();
+  EXPECT_THAT(fresh_connections_, ElementsAre(false, true));
+
+  Complete(1, "hedge");
+  Complete(0, "primary");
+  EXPECT_THAT(results, ElementsAre("hedge"));
+  EXPECT_THAT(GetHedgingStats(),
+              UnorderedElementsAre(Pair("hedged", 1), Pair("won_by_hedge", 1),
+                                   Pair("over_budget", 0)));
+}
+
+TEST_F(HedgingHttpFetcherAsyncTest, DoesNotHedgeCompletedFetch) {
+  WarmUp();
+  std::vector<std::string> results;
+  fetcher_->FetchUrl({"kv"}, 100,
+                     [&results](absl::StatusOr<std::string> result) {
+                       results.push_back(*result);
+                     });
+  Complete(0, "primary");
+  ASSERT_EQ(timers_.size(), 1);
+  std::move(timers_[0])();
+
+  EXPECT_EQ(pending_.size(), 1);
+  EXPECT_THAT(results, ElementsAre("primary"));
+}
+
+TEST_F(HedgingHttpFetcherAsyncTest, HedgesWithinBudget) {
+  WarmUp();
+  // The warm up fetches add 5 hedges to the budget, and the 10 fetches below
+  // half a hedge.
+  for (int i = 0; i < 10; ++i) {
+    fetcher_->FetchUrl({"kv"}, 100, [](absl::StatusOr<std::string>) {});
+  }
+  ASSERT_EQ(timers_.size(), 10);
+  for (auto& timer : timers_) {
+    std::move(timer)();
+  }
+
+  EXPECT_EQ(pending_.size(), 15);
+  EXPECT_THAT(GetHedgingStats(),
+              UnorderedElementsAre(Pair("hedged", 5), Pair("won_by_hedge", 0),
+                                   Pair("over_budget", 5)));
+}
+
+TEST_F(HedgingHttpFetcherAsyncTest, IgnoresTimersFiringAfterDestruction) {
+  WarmUp();
+  fetcher_->FetchUrl({"kv"}, 100, [](absl::StatusOr<std::string>) {});
+  fetcher_.reset();
+  ASSERT_EQ(timers_.size(), 1);
+  std::move(timers_[0])();
+
+  EXPECT_EQ(pending_.size(), 1);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,245 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/key_value_batcher.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "glog/logging.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Serialized values of the keys of a namespace of a response.
+using NamespaceValues =
+    absl::flat_hash_map<std::string, std::shared_ptr<const std::string>>;
+
+// Returns the values of the keys of a lookup found in the values of each
+// namespace.
+std::vector<CachedNamespace> ValuesOf(
+    const KeyValueLookupKeys& keys, absl::Span<const std::string> namespaces,
+    const std::vector<NamespaceValues>& values) {
+  std::vector<CachedNamespace> found(namespaces.size());
+  for (size_t i = 0; i < namespaces.size(); ++i) {
+    found[i].name = namespaces[i];
+    if (i >= keys.size()) {
+      continue;
+    }
+    for (const std::string& key : keys[i]) {
+      if (auto it = values[i].find(key); it != values[i].end()) {
+        found[i].values.emplace_back(key, it->second);
+      }
+    }
+  }
+  return found;
+}
+
+// The body of each lookup, or nullopt if the response cannot be split.
+std::optional<std::vector<std::string>> SplitTable(
+    absl::string_view body, absl::Span<const std::string> namespaces,
+    absl::Span<const KeyValueLookupKeys> lookup_keys) {
+  absl::StatusOr<KeyValueTable> table = ParseKeyValueTable(body);
+  if (!table.ok()) {
+    return std::nullopt;
+  }
+  std::vector<NamespaceValues> values(namespaces.size());
+  for (size_t i = 0; i < namespaces.size(); ++i) {
+    if (auto it = table->find(namespaces[i]); it != table->end()) {
+      for (const auto& [key, value] : it->second) {
+        values[i].emplace(key, std::make_shared<const std::string>(value));
+      }
+    }
+  }
+  std::vector<std::string> bodies(lookup_keys.size());
+  for (size_t i = 0; i < lookup_keys.size(); ++i) {
+    AppendCachedValuesToTable(ValuesOf(lookup_keys[i], namespaces, values),
+                              &bodies[i]);
+  }
+  return bodies;
+}
+
+std::optional<std::vector<std::string>> SplitJson(
+    absl::string_view body, absl::Span<const std::string> namespaces,
+    absl::Span<const KeyValueLookupKeys> lookup_keys) {
+  absl::StatusOr<rapidjson::Document> document = ParseJsonString(body);
+  if (!document.ok() || !document->IsObject()) {
+    return std::nullopt;
+  }
+  std::vector<NamespaceValues> values(namespaces.size());
+  for (size_t i = 0; i < namespaces.size(); ++i) {
+    auto it = document->FindMember(rapidjson::Value(
+        rapidjson::StringRef(namespaces[i].data(), namespaces[i].size())));
+    if (it == document->MemberEnd()) {
+      continue;
+    }
+    if (it->value.IsObject()) {
+      for (const auto& member : it->value.GetObject()) {
+        if (absl::StatusOr<std::string> value = SerializeJsonDoc(member.value);
+            value.ok()) {
+          values[i].emplace(
+              std::string(member.name.GetString(),
+                          member.name.GetStringLength()),
+              std::make_shared<const std::string>(*std::move(value)));
+        }
+      }
+    }
+    // Added back by each lookup with its own keys only.
+    document->EraseMember(it);
+  }
+  std::vector<std::string> bodies(lookup_keys.size());
+  for (size_t i = 0; i < lookup_keys.size(); ++i) {
+    bodies[i] = MergeCachedValues(
+        &*document, ValuesOf(lookup_keys[i], namespaces, values));
+  }
+  return bodies;
+}
+
+}  // namespace
+
+KeyValueBatcher::KeyValueBatcher(std::vector<std::string> namespaces,
+                                 int max_keys, absl::Duration max_delay,
+                                 server_common::Executor* executor)
+    : namespaces_(std::move(namespaces)),
+      max_keys_(std::max(max_keys, 1)),
+      max_delay_(max_delay),
+      executor_(executor) {}
+
+void KeyValueBatcher::LookUp(std::string batch_key, KeyValueLookupKeys keys,
+                             absl::Duration timeout, Fetch fetch,
+                             OnDone on_done) {
+  keys.resize(namespaces_.size());
+  size_t num_keys = 0;
+  for (const std::vector<std::string>& namespace_keys : keys) {
+    num_keys += namespace_keys.size();
+  }
+  std::shared_ptr<Batch> full_batch;
+  std::shared_ptr<Batch> batch;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = open_batches_.find(batch_key);
+    if (it != open_batches_.end() &&
+        it->second->num_keys + num_keys > max_keys_) {
+      // Sent as is rather than past max_keys.
+      full_batch = std::move(it->second);
+      open_batches_.erase(it);
+      it = open_batches_.end();
+    }
+    if (it == open_batches_.end()) {
+      batch = std::make_shared<Batch>(namespaces_.size());
+      batch->fetch = std::move(fetch);
+      it = open_batches_.emplace(batch_key, batch).first;
+      batch->timer = executor_->RunAfter(
+          max_delay_, [self = shared_from_this(), batch_key, batch]() {
+            self->OnTimer(batch_key, batch);
+          });
+    } else {
+      batch = it->second;
+    }
+    batch->deadline = std::min(batch->deadline, absl::Now() + timeout);
+    for (size_t i = 0; i < keys.size(); ++i) {
+      for (const std::string& key : keys[i]) {
+        if (batch->seen[i].insert(key).second) {
+          batch->keys[i].push_back(key);
+          ++batch->num_keys;
+        }
+      }
+    }
+    batch->lookups.push_back({std::move(keys), std::move(on_done)});
+    if (batch->num_keys < max_keys_) {
+      batch.reset();
+    } else {
+      open_batches_.erase(it);
+    }
+  }
+  for (std::shared_ptr<Batch>* closed : {&full_batch, &batch}) {
+    if (*closed != nullptr) {
+      // The timer finds the batch closed if it fires anyway.
+      executor_->Cancel((*closed)->timer);
+      Send(std::move(*closed));
+    }
+  }
+}
+
+void KeyValueBatcher::OnTimer(const std::string& batch_key,
+                              const std::shared_ptr<Batch>& batch) {
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = open_batches_.find(batch_key);
+    if (it == open_batches_.end() || it->second != batch) {
+      return;
+    }
+    open_batches_.erase(it);
+  }
+  Send(batch);
+}
+
+void KeyValueBatcher::Send(std::shared_ptr<Batch> batch) {
+  const absl::Duration timeout =
+      std::max(batch->deadline - absl::Now(), absl::ZeroDuration());
+  Fetch fetch = std::move(batch->fetch);
+  if (batch->lookups.size() == 1) {
+    std::move(fetch)(std::move(batch->keys), timeout,
+                     std::move(batch->lookups[0].on_done));
+    return;
+  }
+  VLOG(3) << "Sending a batch of " << batch->lookups.size()
+          << " Key-Value lookups of " << batch->num_keys << " keys";
+  std::move(fetch)(
+      std::move(batch->keys), timeout,
+      [self = shared_from_this(),
+       batch](absl::StatusOr<HTTPResponse> response) mutable {
+        std::vector<KeyValueLookupKeys> lookup_keys;
+        lookup_keys.reserve(batch->lookups.size());
+        for (Lookup& lookup : batch->lookups) {
+          lookup_keys.push_back(std::move(lookup.keys));
+        }
+        std::vector<absl::StatusOr<HTTPResponse>> responses =
+            SplitKeyValueResponse(response, self->namespaces_, lookup_keys);
+        for (size_t i = 0; i < responses.size(); ++i) {
+          std::move(batch->lookups[i].on_done)(std::move(responses[i]));
+        }
+      });
+}
+
+std::vector<absl::StatusOr<HTTPResponse>> SplitKeyValueResponse(
+    const absl::StatusOr<HTTPResponse>& response,
+    absl::Span<const std::string> namespaces,
+    absl::Span<const KeyValueLookupKeys> lookup_keys) {
+  std::optional<std::vector<std::string>> bodies;
+  if (response.ok() && response->status_code == 200) {
+    bodies = IsKeyValueTable(response->body)
+                 ? SplitTable(response->body, namespaces, lookup_keys)
+                 : SplitJson(response->body, namespaces, lookup_keys);
+  }
+  if (!bodies.has_value()) {
+    return std::vector<absl::StatusOr<HTTPResponse>>(lookup_keys.size(),
+                                                     response);
+  }
+  std::vector<absl::StatusOr<HTTPResponse>> responses;
+  responses.reserve(lookup_keys.size());
+  for (std::string& body : *bodies) {
+    responses.push_back(HTTPResponse{std::move(body), response->status_code,
+                                     response->etag, response->last_modified,
+                                     response->cache_control});
+  }
+  return responses;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
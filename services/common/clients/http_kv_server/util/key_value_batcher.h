@@ -0,0 +1,121 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_BATCHER_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_BATCHER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+#include "src/cpp/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Keys of a lookup, one list per namespace of the KeyValueBatcher, e.g.
+// {render_urls, ad_component_render_urls}.
+using KeyValueLookupKeys = std::vector<std::vector<std::string>>;
+
+// Merges the keys of the concurrent lookups of a Key-Value client into a
+// single lookup, and hands each of them the values of its own keys, so that
+// a burst of requests needing overlapping keys costs the Key-Value server one
+// request rather than one each. A batch is sent max_delay after its first
+// lookup, or as soon as it has max_keys distinct keys. Only the lookups with
+// the same batch key, which callers derive from everything but the keys that
+// goes into a request (e.g. the hostname and the headers), are merged.
+//
+// Made with std::make_shared, as the pending timers keep it alive.
+class KeyValueBatcher : public std::enable_shared_from_this<KeyValueBatcher> {
+ public:
+  using OnDone = absl::AnyInvocable<void(absl::StatusOr<HTTPResponse>) &&>;
+  // Sends the lookup of the keys of a batch, timing out after timeout.
+  using Fetch = absl::AnyInvocable<void(KeyValueLookupKeys keys,
+                                        absl::Duration timeout,
+                                        OnDone on_done) &&>;
+
+  // namespaces: names of the namespaces of the lookups in the responses,
+  // e.g. {"renderUrls", "adComponentRenderUrls"}.
+  KeyValueBatcher(std::vector<std::string> namespaces, int max_keys,
+                  absl::Duration max_delay, server_common::Executor* executor);
+
+  // Not copyable or movable.
+  KeyValueBatcher(const KeyValueBatcher&) = delete;
+  KeyValueBatcher& operator=(const KeyValueBatcher&) = delete;
+
+  // Adds the keys to the batch open for batch_key, opening one for them if
+  // there is none or they would take it past max_keys. fetch sends the batch
+  // if it is the first of it. on_done is called with the response of the
+  // batch cut down to the keys of this lookup. The batch times out with its
+  // earliest lookup.
+  void LookUp(std::string batch_key, KeyValueLookupKeys keys,
+              absl::Duration timeout, Fetch fetch, OnDone on_done)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Lookup {
+    KeyValueLookupKeys keys;
+    OnDone on_done;
+  };
+
+  struct Batch {
+    explicit Batch(size_t num_namespaces)
+        : keys(num_namespaces), seen(num_namespaces) {}
+
+    KeyValueLookupKeys keys;
+    std::vector<absl::flat_hash_set<std::string>> seen;
+    size_t num_keys = 0;
+    absl::Time deadline = absl::InfiniteFuture();
+    Fetch fetch;
+    std::vector<Lookup> lookups;
+    server_common::TaskId timer;
+  };
+
+  // Sends the batch closed by the caller, and splits its response among its
+  // lookups.
+  void Send(std::shared_ptr<Batch> batch);
+  // Closes the batch of batch_key when its timer fires, unless it was sent.
+  void OnTimer(const std::string& batch_key,
+               const std::shared_ptr<Batch>& batch) ABSL_LOCKS_EXCLUDED(mu_);
+
+  const std::vector<std::string> namespaces_;
+  const size_t max_keys_;
+  const absl::Duration max_delay_;
+  server_common::Executor* executor_;
+  absl::Mutex mu_;
+  absl::flat_hash_map<std::string, std::shared_ptr<Batch>> open_batches_
+      ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the response of each of the lookups of a batch from the response of
+// the batch: the same response holding, under each namespace, only the
+// values of the keys of the lookup. The other members of the response are
+// kept. Errors, non-200 responses and bodies that are neither JSON objects
+// nor key-value tables are returned as is to each lookup.
+std::vector<absl::StatusOr<HTTPResponse>> SplitKeyValueResponse(
+    const absl::StatusOr<HTTPResponse>& response,
+    absl::Span<const std::string> namespaces,
+    absl::Span<const KeyValueLookupKeys> lookup_keys);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_BATCHER_H_
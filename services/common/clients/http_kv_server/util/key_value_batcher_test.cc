@@ -0,0 +1,196 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/key_value_batcher.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Holds the timers until the test fires them.
+class FakeTimerExecutor : public server_common::Executor {
+ public:
+  void Run(absl::AnyInvocable<void()> closure) override { closure(); }
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override {
+    closures.push_back(std::move(closure));
+    return {};
+  }
+  bool Cancel(server_common::TaskId task_id) override { return true; }
+
+  void FireAll() {
+    std::vector<absl::AnyInvocable<void()>> fired = std::move(closures);
+    closures.clear();
+    for (auto& closure : fired) {
+      closure();
+    }
+  }
+
+  std::vector<absl::AnyInvocable<void()>> closures;
+};
+
+class KeyValueBatcherTest : public testing::Test {
+ protected:
+  // Returns a fetch recording the keys of the batch it sends.
+  KeyValueBatcher::Fetch RecordingFetch() {
+    return [this](KeyValueLookupKeys keys, absl::Duration timeout,
+                  KeyValueBatcher::OnDone on_done) {
+      fetched_keys_.push_back(std::move(keys));
+      pending_.push_back(std::move(on_done));
+    };
+  }
+
+  // Looks up the keys in the batch of batch_key, recording the body of the
+  // response of the lookup.
+  void LookUp(std::string batch_key, KeyValueLookupKeys keys,
+              std::string* body) {
+    batcher_->LookUp(std::move(batch_key), std::move(keys), absl::Seconds(1),
+                     RecordingFetch(),
+                     [body](absl::StatusOr<HTTPResponse> response) {
+                       *body = response.ok() ? response->body
+                                             : response.status().ToString();
+                     });
+  }
+
+  FakeTimerExecutor executor_;
+  std::shared_ptr<KeyValueBatcher> batcher_ = std::make_shared<KeyValueBatcher>(
+      std::vector<std::string>{"renderUrls", "adComponentRenderUrls"},
+      /*max_keys=*/4, absl::Microseconds(500), &executor_);
+  std::vector<KeyValueLookupKeys> fetched_keys_;
+  std::vector<KeyValueBatcher::OnDone> pending_;
+};
+
+TEST_F(KeyValueBatcherTest, MergesTheKeysOfConcurrentLookups) {
+  std::string first;
+  std::string second;
+  LookUp("", {{"a", "b"}}, &first);
+  LookUp("", {{"b"}, {"c"}}, &second);
+  EXPECT_THAT(fetched_keys_, IsEmpty());
+
+  executor_.FireAll();
+  ASSERT_EQ(fetched_keys_.size(), 1);
+  EXPECT_THAT(fetched_keys_[0],
+              ElementsAre(ElementsAre("a", "b"), ElementsAre("c")));
+
+  std::move(pending_[0])(HTTPResponse{
+      R"JSON({"renderUrls":{"a":1,"b":[2]},"adComponentRenderUrls":{"c":3},)JSON"
+      R"JSON("other":true})JSON",
+      200});
+  EXPECT_EQ(first, R"JSON({"renderUrls":{"a":1,"b":[2]},"other":true})JSON");
+  EXPECT_EQ(second,
+            R"JSON({"renderUrls":{"b":[2]},"adComponentRenderUrls":{"c":3},)JSON"
+            R"JSON("other":true})JSON");
+}
+
+TEST_F(KeyValueBatcherTest, SendsTheBatchOnceItHasMaxKeys) {
+  std::string first;
+  std::string second;
+  std::string third;
+  LookUp("", {{"a", "b"}}, &first);
+  LookUp("", {{"c", "d"}}, &second);
+  ASSERT_EQ(fetched_keys_.size(), 1);
+  EXPECT_THAT(fetched_keys_[0],
+              ElementsAre(ElementsAre("a", "b", "c", "d"), IsEmpty()));
+
+  // Would take the next batch past max_keys, which is then sent as is.
+  LookUp("", {{"e", "f", "g"}}, &third);
+  LookUp("", {{"h", "i"}}, &third);
+  ASSERT_EQ(fetched_keys_.size(), 2);
+  EXPECT_THAT(fetched_keys_[1],
+              ElementsAre(ElementsAre("e", "f", "g"), IsEmpty()));
+
+  // The timers of the batches sent find them closed.
+  executor_.FireAll();
+  EXPECT_EQ(fetched_keys_.size(), 3);
+}
+
+TEST_F(KeyValueBatcherTest, DoesNotMergeLookupsOfOtherBatchKeys) {
+  std::string first;
+  std::string second;
+  LookUp("hostname=a", {{"a"}}, &first);
+  LookUp("hostname=b", {{"a"}}, &second);
+  executor_.FireAll();
+  ASSERT_EQ(fetched_keys_.size(), 2);
+
+  // A lookup alone in its batch gets the response as is.
+  std::move(pending_[0])(HTTPResponse{R"JSON({"renderUrls":{"a":1}})JSON", 200});
+  EXPECT_EQ(first, R"JSON({"renderUrls":{"a":1}})JSON");
+}
+
+TEST_F(KeyValueBatcherTest, HandsErrorsToEachLookup) {
+  std::string first;
+  std::string second;
+  LookUp("", {{"a"}}, &first);
+  LookUp("", {{"b"}}, &second);
+  executor_.FireAll();
+  ASSERT_EQ(pending_.size(), 1);
+
+  std::move(pending_[0])(absl::UnavailableError("down"));
+  EXPECT_EQ(first, "UNAVAILABLE: down");
+  EXPECT_EQ(second, "UNAVAILABLE: down");
+}
+
+TEST(SplitKeyValueResponseTest, SplitsKeyValueTables) {
+  std::string table;
+  AppendKeyValueTableSection("keys", 2, &table);
+  AppendKeyValueTableEntry("a", "1", &table);
+  AppendKeyValueTableEntry("b", "2", &table);
+  const std::vector<std::string> namespaces = {"keys"};
+  const std::vector<KeyValueLookupKeys> lookup_keys = {{{"a"}}, {{"b", "c"}}};
+
+  std::vector<absl::StatusOr<HTTPResponse>> responses =
+      SplitKeyValueResponse(HTTPResponse{table, 200, "", "", "max-age=10"},
+                            namespaces, lookup_keys);
+
+  ASSERT_EQ(responses.size(), 2);
+  std::string first;
+  AppendKeyValueTableSection("keys", 1, &first);
+  AppendKeyValueTableEntry("a", "1", &first);
+  std::string second;
+  AppendKeyValueTableSection("keys", 1, &second);
+  AppendKeyValueTableEntry("b", "2", &second);
+  ASSERT_TRUE(responses[0].ok());
+  EXPECT_EQ(responses[0]->body, first);
+  EXPECT_EQ(responses[0]->cache_control, "max-age=10");
+  ASSERT_TRUE(responses[1].ok());
+  EXPECT_EQ(responses[1]->body, second);
+}
+
+TEST(SplitKeyValueResponseTest, ReturnsNon200ResponsesAsIs) {
+  const std::vector<std::string> namespaces = {"keys"};
+  const std::vector<KeyValueLookupKeys> lookup_keys = {{{"a"}}, {{"b"}}};
+  std::vector<absl::StatusOr<HTTPResponse>> responses = SplitKeyValueResponse(
+      HTTPResponse{R"JSON({"keys":{"a":1,"b":2}})JSON", 500}, namespaces,
+      lookup_keys);
+  ASSERT_EQ(responses.size(), 2);
+  for (const auto& response : responses) {
+    ASSERT_TRUE(response.ok());
+    EXPECT_EQ(response->body, R"JSON({"keys":{"a":1,"b":2}})JSON");
+    EXPECT_EQ(response->status_code, 500);
+  }
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,276 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Counts of all the caches, read and reset by GetKeyValueCacheStats.
+CacheStats cache_stats;
+
+absl::string_view MemberName(const rapidjson::Value& name) {
+  return absl::string_view(name.GetString(), name.GetStringLength());
+}
+
+// Returns the object under name in response, or nullptr if there is none.
+const rapidjson::Value* FindObject(const rapidjson::Value* response,
+                                   absl::string_view name) {
+  if (response == nullptr || !response->IsObject()) {
+    return nullptr;
+  }
+  auto it = response->FindMember(
+      rapidjson::Value(rapidjson::StringRef(name.data(), name.size())));
+  if (it == response->MemberEnd() || !it->value.IsObject()) {
+    return nullptr;
+  }
+  return &it->value;
+}
+
+// Returns ttl, or the hint of the key if shorter. Hints that are not
+// non-negative numbers are ignored.
+absl::Duration HintedTtl(const rapidjson::Value* hints, absl::string_view key,
+                         absl::Duration ttl) {
+  if (hints == nullptr) {
+    return ttl;
+  }
+  auto it = hints->FindMember(
+      rapidjson::Value(rapidjson::StringRef(key.data(), key.size())));
+  if (it == hints->MemberEnd() || !it->value.IsNumber() ||
+      it->value.GetDouble() < 0) {
+    return ttl;
+  }
+  return std::min(ttl, absl::Seconds(it->value.GetDouble()));
+}
+
+absl::Duration HintedTtl(const KeyValueTableNamespace* hints,
+                         absl::string_view key, absl::Duration ttl) {
+  if (hints == nullptr) {
+    return ttl;
+  }
+  auto it = hints->find(key);
+  double seconds;
+  if (it == hints->end() || !absl::SimpleAtod(it->second, &seconds) ||
+      seconds < 0) {
+    return ttl;
+  }
+  return std::min(ttl, absl::Seconds(seconds));
+}
+
+}  // namespace
+
+absl::Duration CacheableFor(absl::string_view cache_control,
+                            absl::Duration max_ttl) {
+  absl::Duration ttl = max_ttl;
+  for (absl::string_view directive : absl::StrSplit(cache_control, ',')) {
+    directive = absl::StripAsciiWhitespace(directive);
+    if (absl::EqualsIgnoreCase(directive, "no-store") ||
+        absl::EqualsIgnoreCase(directive, "no-cache")) {
+      return absl::ZeroDuration();
+    }
+    for (absl::string_view prefix : {"max-age=", "s-maxage="}) {
+      int64_t seconds;
+      if (absl::StartsWithIgnoreCase(directive, prefix) &&
+          absl::SimpleAtoi(directive.substr(prefix.size()), &seconds)) {
+        ttl = std::min(ttl, absl::Seconds(std::max<int64_t>(seconds, 0)));
+      }
+    }
+  }
+  return ttl;
+}
+
+KeyValueCache::KeyValueCache(absl::Duration ttl, size_t max_bytes,
+                             size_t num_shards, absl::Duration miss_ttl)
+    : cache_({.ttl = ttl,
+              .miss_ttl = miss_ttl,
+              .max_bytes = max_bytes,
+              .num_shards = num_shards,
+              .stats = &cache_stats}) {}
+
+std::shared_ptr<const std::string> KeyValueCache::LookUp(
+    absl::string_view key) {
+  std::optional<std::shared_ptr<const std::string>> value = cache_.Find(key);
+  if (!value.has_value()) {
+    return nullptr;
+  }
+  if (*value == nullptr) {
+    static const auto* kNoValue =
+        new std::shared_ptr<const std::string>(std::make_shared<std::string>());
+    return *kNoValue;
+  }
+  return *std::move(value);
+}
+
+void KeyValueCache::InsertMiss(absl::string_view key, absl::Duration ttl) {
+  cache_.InsertMiss(std::string(key), ttl);
+}
+
+void KeyValueCache::Insert(absl::string_view key, std::string value,
+                           absl::Duration ttl) {
+  cache_.Insert(std::string(key),
+                std::make_shared<const std::string>(std::move(value)), ttl);
+}
+
+void CacheNamespace(const rapidjson::Value& response, absl::string_view name,
+                    absl::string_view key_prefix, absl::Duration ttl,
+                    KeyValueCache& cache,
+                    absl::Span<const std::string> requested) {
+  if (ttl <= absl::ZeroDuration()) {
+    return;
+  }
+  const rapidjson::Value* values = FindObject(&response, name);
+  const rapidjson::Value* hints =
+      FindObject(&response, absl::StrCat(name, kTtlHintsSuffix));
+  if (values != nullptr) {
+    for (const auto& member : values->GetObject()) {
+      if (member.value.IsNull()) {
+        continue;
+      }
+      const absl::string_view key = MemberName(member.name);
+      if (absl::StatusOr<std::string> value = SerializeJsonDoc(member.value);
+          value.ok()) {
+        cache.Insert(absl::StrCat(key_prefix, key), *std::move(value),
+                     HintedTtl(hints, key, ttl));
+      }
+    }
+  }
+  if (cache.miss_ttl() <= absl::ZeroDuration()) {
+    return;
+  }
+  for (const std::string& key : requested) {
+    const rapidjson::Value* value = nullptr;
+    if (values != nullptr) {
+      auto it = values->FindMember(
+          rapidjson::Value(rapidjson::StringRef(key.data(), key.size())));
+      if (it != values->MemberEnd()) {
+        value = &it->value;
+      }
+    }
+    if (value == nullptr || value->IsNull()) {
+      cache.InsertMiss(absl::StrCat(key_prefix, key),
+                       HintedTtl(hints, key, ttl));
+    }
+  }
+}
+
+std::string MergeCachedValues(const rapidjson::Value* response,
+                              const std::vector<CachedNamespace>& cached) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  for (const CachedNamespace& ns : cached) {
+    const rapidjson::Value* fresh = FindObject(response, ns.name);
+    if (ns.values.empty() && (fresh == nullptr || fresh->ObjectEmpty())) {
+      continue;
+    }
+    writer.Key(ns.name.data(), ns.name.size());
+    writer.StartObject();
+    if (fresh != nullptr) {
+      for (const auto& member : fresh->GetObject()) {
+        member.name.Accept(writer);
+        member.value.Accept(writer);
+      }
+    }
+    for (const auto& [key, value] : ns.values) {
+      writer.Key(key.data(), key.size());
+      writer.RawValue(value->data(), value->size(), rapidjson::kObjectType);
+    }
+    writer.EndObject();
+  }
+  if (response != nullptr && response->IsObject()) {
+    for (const auto& member : response->GetObject()) {
+      const bool is_cached_namespace = std::any_of(
+          cached.begin(), cached.end(), [&member](const CachedNamespace& ns) {
+            return ns.name == MemberName(member.name);
+          });
+      if (!is_cached_namespace) {
+        member.name.Accept(writer);
+        member.value.Accept(writer);
+      }
+    }
+  }
+  writer.EndObject();
+  return std::string(buffer.GetString(), buffer.GetSize());
+}
+
+void CacheTableNamespace(const KeyValueTable& table, absl::string_view name,
+                         absl::string_view key_prefix, absl::Duration ttl,
+                         KeyValueCache& cache,
+                         absl::Span<const std::string> requested) {
+  if (ttl <= absl::ZeroDuration()) {
+    return;
+  }
+  auto it = table.find(name);
+  const KeyValueTableNamespace* values =
+      it == table.end() ? nullptr : &it->second;
+  auto hints_it = table.find(absl::StrCat(name, kTtlHintsSuffix));
+  const KeyValueTableNamespace* hints =
+      hints_it == table.end() ? nullptr : &hints_it->second;
+  if (values != nullptr) {
+    for (const auto& [key, value] : *values) {
+      if (value != "null") {
+        cache.Insert(absl::StrCat(key_prefix, key), std::string(value),
+                     HintedTtl(hints, key, ttl));
+      }
+    }
+  }
+  if (cache.miss_ttl() <= absl::ZeroDuration()) {
+    return;
+  }
+  for (const std::string& key : requested) {
+    const absl::string_view* value = nullptr;
+    if (values != nullptr) {
+      if (auto it = values->find(key); it != values->end()) {
+        value = &it->second;
+      }
+    }
+    if (value == nullptr || *value == "null") {
+      cache.InsertMiss(absl::StrCat(key_prefix, key),
+                       HintedTtl(hints, key, ttl));
+    }
+  }
+}
+
+void AppendCachedValuesToTable(const std::vector<CachedNamespace>& cached,
+                               std::string* table) {
+  for (const CachedNamespace& ns : cached) {
+    if (ns.values.empty()) {
+      continue;
+    }
+    AppendKeyValueTableSection(ns.name, ns.values.size(), table);
+    for (const auto& [key, value] : ns.values) {
+      AppendKeyValueTableEntry(key, *value, table);
+    }
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetKeyValueCacheStats() {
+  return cache_stats.Snapshot();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
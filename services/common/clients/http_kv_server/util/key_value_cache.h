@@ -0,0 +1,139 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_CACHE_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "rapidjson/document.h"
+#include "services/common/concurrent/ttl_lru_cache.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Returns how long a Key-Value server response with the given Cache-Control
+// header may be cached, at most max_ttl. Responses marked no-store or
+// no-cache are not cached, and max-age (or s-maxage) shortens the TTL.
+absl::Duration CacheableFor(absl::string_view cache_control,
+                            absl::Duration max_ttl);
+
+// Suffix of the name of the namespace of a Key-Value server response holding
+// the per-key TTL hints of another, e.g. "keysTtlSeconds" for "keys". Its
+// values are the seconds each key may be cached for.
+inline constexpr absl::string_view kTtlHintsSuffix = "TtlSeconds";
+
+// Thread-safe cache of the JSON values of individual Key-Value server keys,
+// and of the keys the Key-Value server has no value for. Entries expire after
+// their TTL, and each of the shards evicts its least recently used entries
+// once the bytes of its keys and values exceed its share of max_bytes.
+class KeyValueCache {
+ public:
+  // ttl: the longest time a value is cached.
+  // max_bytes: bound on the bytes of the keys and values held by the cache.
+  // num_shards: number of independently locked partitions of the cache.
+  // miss_ttl: the longest time a key without a value is cached, usually much
+  // shorter than ttl. Such keys are not cached when 0.
+  KeyValueCache(absl::Duration ttl, size_t max_bytes, size_t num_shards = 16,
+                absl::Duration miss_ttl = absl::ZeroDuration());
+
+  // KeyValueCache is neither copyable nor movable.
+  KeyValueCache(const KeyValueCache&) = delete;
+  KeyValueCache& operator=(const KeyValueCache&) = delete;
+
+  absl::Duration ttl() const { return cache_.ttl(); }
+  absl::Duration miss_ttl() const { return cache_.miss_ttl(); }
+
+  // Returns the cached JSON value of the key, or nullptr if it is not cached
+  // or has expired. The value is empty if the key is cached as a miss.
+  std::shared_ptr<const std::string> LookUp(absl::string_view key);
+
+  // Caches the JSON value of the key for ttl, at most the ttl of the cache.
+  // Values larger than the share of a shard are not cached.
+  void Insert(absl::string_view key, std::string value, absl::Duration ttl);
+
+  // Caches the key as having no value for ttl, at most the miss_ttl of the
+  // cache.
+  void InsertMiss(absl::string_view key, absl::Duration ttl);
+
+  // Bytes of the keys and values currently cached across all shards.
+  size_t bytes() const { return cache_.bytes(); }
+
+  // Shrinks, or grows back, the bound on the bytes of the cache to
+  // max_bytes times scale, in [0, 1], evicting the least recently used
+  // entries past it. Used to give memory back under memory pressure.
+  void SetCapacityScale(double scale) { cache_.SetCapacityScale(scale); }
+
+ private:
+  // Keys without a value are cached with a null one.
+  TtlLruCache<std::string, const std::string> cache_;
+};
+
+// Values of a namespace of a Key-Value server response (e.g. "keys" or
+// "renderUrls") found in a KeyValueCache, in the order of the request.
+struct CachedNamespace {
+  absl::string_view name;
+  std::vector<std::pair<std::string, std::shared_ptr<const std::string>>>
+      values;
+};
+
+// Caches the values of the namespace of the response, each under key_prefix
+// followed by its key, for ttl or the TTL hint of the key if shorter. The
+// requested keys without a value, or with a null one, are cached as misses.
+void CacheNamespace(const rapidjson::Value& response, absl::string_view name,
+                    absl::string_view key_prefix, absl::Duration ttl,
+                    KeyValueCache& cache,
+                    absl::Span<const std::string> requested = {});
+
+// Returns a Key-Value server response holding, under each of the cached
+// namespaces, the values of that namespace in response (if any) followed by
+// the cached values, then the other members of response. Namespaces without
+// any value are left out.
+std::string MergeCachedValues(const rapidjson::Value* response,
+                              const std::vector<CachedNamespace>& cached);
+
+// Caches the values of the namespace of the key-value table as
+// CacheNamespace does those of a JSON response.
+void CacheTableNamespace(const KeyValueTable& table, absl::string_view name,
+                         absl::string_view key_prefix, absl::Duration ttl,
+                         KeyValueCache& cache,
+                         absl::Span<const std::string> requested = {});
+
+// Appends the cached values to the key-value table, starting it if it is
+// empty, in a section for each namespace with any value.
+void AppendCachedValuesToTable(const std::vector<CachedNamespace>& cached,
+                               std::string* table);
+
+// Returns the number of hits, hits of cached misses, misses and evictions of
+// all the KeyValueCache instances since the previous call.
+absl::flat_hash_map<std::string, double> GetKeyValueCacheStats();
+
+template <typename T>
+inline void AddKeyValueCacheMetric(T* context_map) {
+  context_map->AddObserverable(metric::kKVCacheEventCount,
+                               GetKeyValueCacheStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_CACHE_H_
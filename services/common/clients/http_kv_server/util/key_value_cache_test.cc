@@ -0,0 +1,238 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::Pointee;
+using ::testing::UnorderedElementsAre;
+
+TEST(CacheableForTest, UsesMaxTtlWithoutDirectives) {
+  EXPECT_EQ(CacheableFor("", absl::Minutes(1)), absl::Minutes(1));
+  EXPECT_EQ(CacheableFor("public", absl::Minutes(1)), absl::Minutes(1));
+}
+
+TEST(CacheableForTest, HonorsMaxAge) {
+  EXPECT_EQ(CacheableFor("public, max-age=10", absl::Minutes(1)),
+            absl::Seconds(10));
+  EXPECT_EQ(CacheableFor("s-maxage=5,max-age=10", absl::Minutes(1)),
+            absl::Seconds(5));
+  EXPECT_EQ(CacheableFor("max-age=3600", absl::Minutes(1)), absl::Minutes(1));
+}
+
+TEST(CacheableForTest, DoesNotCacheNoStoreOrNoCache) {
+  EXPECT_EQ(CacheableFor("max-age=10, no-store", absl::Minutes(1)),
+            absl::ZeroDuration());
+  EXPECT_EQ(CacheableFor("No-Cache", absl::Minutes(1)), absl::ZeroDuration());
+}
+
+TEST(KeyValueCacheTest, ReturnsInsertedValues) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024);
+  EXPECT_EQ(cache.LookUp("key"), nullptr);
+
+  cache.Insert("key", R"JSON({"a":1})JSON", absl::Minutes(1));
+  cache.Insert("key", "[1]", absl::Minutes(1));
+
+  EXPECT_THAT(cache.LookUp("key"), Pointee(std::string("[1]")));
+  EXPECT_EQ(cache.bytes(), 6);
+}
+
+TEST(KeyValueCacheTest, ExpiresValues) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024);
+  cache.Insert("short", "1", absl::Milliseconds(1));
+  cache.Insert("long", "2", absl::Minutes(1));
+  cache.Insert("not_cached", "3", absl::ZeroDuration());
+  absl::SleepFor(absl::Milliseconds(10));
+
+  EXPECT_EQ(cache.LookUp("short"), nullptr);
+  EXPECT_THAT(cache.LookUp("long"), Pointee(std::string("2")));
+  EXPECT_EQ(cache.LookUp("not_cached"), nullptr);
+  EXPECT_EQ(cache.bytes(), 5);
+}
+
+TEST(KeyValueCacheTest, EvictsLeastRecentlyUsedValuesOverBudget) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/30, /*num_shards=*/1);
+  for (int i = 0; i < 3; ++i) {
+    cache.Insert(absl::StrCat("key", i), "value", absl::Minutes(1));
+  }
+  cache.LookUp("key0");
+  cache.Insert("key3", "value", absl::Minutes(1));
+
+  EXPECT_NE(cache.LookUp("key0"), nullptr);
+  EXPECT_EQ(cache.LookUp("key1"), nullptr);
+  EXPECT_NE(cache.LookUp("key2"), nullptr);
+  EXPECT_NE(cache.LookUp("key3"), nullptr);
+  EXPECT_LE(cache.bytes(), 30);
+}
+
+TEST(KeyValueCacheTest, EvictsLeastRecentlyUsedValuesPastCapacityScale) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/40, /*num_shards=*/1);
+  for (int i = 0; i < 4; ++i) {
+    cache.Insert(absl::StrCat("key", i), "value", absl::Minutes(1));
+  }
+  cache.LookUp("key0");
+
+  cache.SetCapacityScale(0.5);
+  EXPECT_NE(cache.LookUp("key0"), nullptr);
+  EXPECT_NE(cache.LookUp("key3"), nullptr);
+  EXPECT_EQ(cache.LookUp("key1"), nullptr);
+  EXPECT_EQ(cache.LookUp("key2"), nullptr);
+  cache.Insert("key4", "value", absl::Minutes(1));
+  EXPECT_LE(cache.bytes(), 20);
+
+  cache.SetCapacityScale(1);
+  cache.Insert("key5", "value", absl::Minutes(1));
+  EXPECT_EQ(cache.bytes(), 27);
+}
+
+TEST(KeyValueCacheTest, DoesNotCacheValuesLargerThanShard) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/8, /*num_shards=*/1);
+  cache.Insert("key", "too large", absl::Minutes(1));
+  EXPECT_EQ(cache.LookUp("key"), nullptr);
+  EXPECT_EQ(cache.bytes(), 0);
+}
+
+TEST(KeyValueCacheTest, CountsHitsMissesAndEvictions) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/4, /*num_shards=*/1);
+  GetKeyValueCacheStats();
+  cache.Insert("a", "1", absl::Minutes(1));
+  cache.Insert("b", "2", absl::Minutes(1));
+  cache.Insert("c", "3", absl::Minutes(1));
+  cache.LookUp("b");
+  cache.LookUp("c");
+  cache.LookUp("a");
+
+  EXPECT_THAT(GetKeyValueCacheStats(),
+              UnorderedElementsAre(Pair("hit", 2), Pair("negative_hit", 0),
+                                   Pair("miss", 1), Pair("eviction", 1)));
+}
+
+TEST(KeyValueCacheTest, CachesMissesForTheMissTtl) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024, /*num_shards=*/1,
+                      /*miss_ttl=*/absl::Milliseconds(1));
+  GetKeyValueCacheStats();
+  cache.InsertMiss("short", absl::Minutes(1));
+  cache.InsertMiss("not_cached", absl::ZeroDuration());
+
+  EXPECT_THAT(cache.LookUp("short"), Pointee(std::string()));
+  EXPECT_EQ(cache.LookUp("not_cached"), nullptr);
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(cache.LookUp("short"), nullptr);
+  EXPECT_THAT(GetKeyValueCacheStats(),
+              UnorderedElementsAre(Pair("hit", 0), Pair("negative_hit", 1),
+                                   Pair("miss", 2), Pair("eviction", 0)));
+}
+
+TEST(KeyValueCacheTest, CachesValuesOfNamespace) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024);
+  absl::StatusOr<rapidjson::Document> response = ParseJsonString(
+      R"JSON({"keys":{"a":{"x":[1,2]},"b":"2"},"other":{"c":3}})JSON");
+  ASSERT_TRUE(response.ok());
+
+  CacheNamespace(*response, "keys", "host;", absl::Minutes(1), cache);
+
+  EXPECT_THAT(cache.LookUp("host;a"), Pointee(std::string(R"({"x":[1,2]})")));
+  EXPECT_THAT(cache.LookUp("host;b"), Pointee(std::string(R"("2")")));
+  EXPECT_EQ(cache.LookUp("host;c"), nullptr);
+}
+
+TEST(KeyValueCacheTest, CachesRequestedKeysWithoutValueAsMisses) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024, /*num_shards=*/1,
+                      /*miss_ttl=*/absl::Minutes(1));
+  absl::StatusOr<rapidjson::Document> response =
+      ParseJsonString(R"JSON({"keys":{"a":1,"b":null}})JSON");
+  ASSERT_TRUE(response.ok());
+  const std::vector<std::string> requested = {"a", "b", "c"};
+
+  CacheNamespace(*response, "keys", "host;", absl::Minutes(1), cache,
+                 requested);
+
+  EXPECT_THAT(cache.LookUp("host;a"), Pointee(std::string("1")));
+  EXPECT_THAT(cache.LookUp("host;b"), Pointee(std::string()));
+  EXPECT_THAT(cache.LookUp("host;c"), Pointee(std::string()));
+}
+
+TEST(KeyValueCacheTest, HonorsTtlHintsOfKeys) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024, /*num_shards=*/1,
+                      /*miss_ttl=*/absl::Minutes(1));
+  absl::StatusOr<rapidjson::Document> response = ParseJsonString(
+      R"JSON({"keys":{"a":1,"b":2},"keysTtlSeconds":{"a":0,"c":0}})JSON");
+  ASSERT_TRUE(response.ok());
+  const std::vector<std::string> requested = {"a", "b", "c"};
+  CacheNamespace(*response, "keys", "host;", absl::Minutes(1), cache,
+                 requested);
+  absl::StatusOr<KeyValueTable> table =
+      ParseKeyValueTable("KVT14:keys1:1:d1:414:keysTtlSeconds1:1:d1:0");
+  ASSERT_TRUE(table.ok());
+  CacheTableNamespace(*table, "keys", "host;", absl::Minutes(1), cache);
+
+  EXPECT_EQ(cache.LookUp("host;a"), nullptr);
+  EXPECT_THAT(cache.LookUp("host;b"), Pointee(std::string("2")));
+  EXPECT_EQ(cache.LookUp("host;c"), nullptr);
+  EXPECT_EQ(cache.LookUp("host;d"), nullptr);
+}
+
+TEST(KeyValueCacheTest, MergesCachedValuesWithResponse) {
+  absl::StatusOr<rapidjson::Document> response = ParseJsonString(
+      R"JSON({"renderUrls":{"a":1},"adComponentRenderUrls":{},"x":2})JSON");
+  ASSERT_TRUE(response.ok());
+  std::vector<CachedNamespace> cached = {
+      {"renderUrls", {{"b", std::make_shared<const std::string>("[2]")}}},
+      {"adComponentRenderUrls"}};
+
+  EXPECT_EQ(MergeCachedValues(&*response, cached),
+            R"JSON({"renderUrls":{"a":1,"b":[2]},"x":2})JSON");
+  EXPECT_EQ(MergeCachedValues(nullptr, cached),
+            R"JSON({"renderUrls":{"b":[2]}})JSON");
+}
+
+TEST(KeyValueCacheTest, CachesValuesOfTableNamespace) {
+  KeyValueCache cache(absl::Minutes(1), /*max_bytes=*/1024);
+  const std::string table = R"(KVT14:keys2:1:a11:{"x":[1,2]}1:b3:"2")";
+  absl::StatusOr<KeyValueTable> parsed = ParseKeyValueTable(table);
+  ASSERT_TRUE(parsed.ok());
+
+  CacheTableNamespace(*parsed, "keys", "host;", absl::Minutes(1), cache);
+  CacheTableNamespace(*parsed, "other", "host;", absl::Minutes(1), cache);
+
+  EXPECT_THAT(cache.LookUp("host;a"), Pointee(std::string(R"({"x":[1,2]})")));
+  EXPECT_THAT(cache.LookUp("host;b"), Pointee(std::string(R"("2")")));
+}
+
+TEST(KeyValueCacheTest, AppendsCachedValuesToTable) {
+  std::vector<CachedNamespace> cached = {
+      {"renderUrls", {{"b", std::make_shared<const std::string>("[2]")}}},
+      {"adComponentRenderUrls"}};
+
+  std::string table = "KVT110:renderUrls1:1:a1:1";
+  AppendCachedValuesToTable(cached, &table);
+  EXPECT_EQ(table, "KVT110:renderUrls1:1:a1:110:renderUrls1:1:b3:[2]");
+  std::string cached_only;
+  AppendCachedValuesToTable(cached, &cached_only);
+  EXPECT_EQ(cached_only, "KVT110:renderUrls1:1:b3:[2]");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
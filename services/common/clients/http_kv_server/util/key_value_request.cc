@@ -0,0 +1,181 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "glog/logging.h"
+#include "rapidjson/document.h"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
+#include "services/common/compression/gzip.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::vector<std::vector<std::vector<std::string>>> SplitKeys(
+    std::vector<std::vector<std::string>> lists, int max_keys) {
+  std::vector<std::vector<std::vector<std::string>>> chunks;
+  if (max_keys <= 0) {
+    chunks.push_back(std::move(lists));
+    return chunks;
+  }
+  chunks.emplace_back(lists.size());
+  int chunk_keys = 0;
+  for (size_t i = 0; i < lists.size(); ++i) {
+    for (std::string& key : lists[i]) {
+      if (chunk_keys == max_keys) {
+        chunks.emplace_back(lists.size());
+        chunk_keys = 0;
+      }
+      chunks.back()[i].push_back(std::move(key));
+      ++chunk_keys;
+    }
+  }
+  return chunks;
+}
+
+HTTPRequest BuildKeyValuePostRequest(
+    absl::string_view url, std::vector<std::string> headers,
+    const std::vector<std::pair<absl::string_view, absl::string_view>>& params,
+    const std::vector<std::pair<absl::string_view,
+                                const std::vector<std::string>*>>& lists,
+    bool compress) {
+  rapidjson::StringBuffer buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+  writer.StartObject();
+  for (const auto& [name, value] : params) {
+    if (!value.empty()) {
+      writer.Key(name.data(), name.size());
+      writer.String(value.data(), value.size());
+    }
+  }
+  for (const auto& [name, values] : lists) {
+    if (!values->empty()) {
+      writer.Key(name.data(), name.size());
+      writer.StartArray();
+      for (const std::string& value : *values) {
+        writer.String(value.data(), value.size());
+      }
+      writer.EndArray();
+    }
+  }
+  writer.EndObject();
+
+  HTTPRequest request = {.url = std::string(url),
+                         .headers = std::move(headers)};
+  request.headers.push_back("Content-Type: application/json");
+  absl::string_view body(buffer.GetString(), buffer.GetSize());
+  if (compress) {
+    if (absl::StatusOr<std::string> compressed = GzipCompress(body);
+        compressed.ok()) {
+      request.headers.push_back("Content-Encoding: gzip");
+      request.body = *std::move(compressed);
+      return request;
+    } else {
+      LOG(ERROR) << "Sending uncompressed Key-Value request: "
+                 << compressed.status();
+    }
+  }
+  request.body = std::string(body);
+  return request;
+}
+
+void AddKeyValueRequestHeaders(const KeyValueRequestOptions& options,
+                               HTTPRequest& request) {
+  if (options.accept_table) {
+    request.headers.push_back(
+        absl::StrCat("Accept: ", kKeyValueTableContentType));
+  }
+}
+
+absl::StatusOr<HTTPResponse> MergeKeyValueResponses(
+    std::vector<absl::StatusOr<HTTPResponse>> responses) {
+  if (responses.empty()) {
+    return absl::InternalError("No Key-Value server response");
+  }
+  for (absl::StatusOr<HTTPResponse>& response : responses) {
+    if (!response.ok() || response->status_code != 200) {
+      return std::move(response);
+    }
+  }
+  if (responses.size() == 1) {
+    return std::move(responses[0]);
+  }
+
+  std::vector<std::string> cache_controls;
+  for (const absl::StatusOr<HTTPResponse>& response : responses) {
+    if (!response->cache_control.empty()) {
+      cache_controls.push_back(response->cache_control);
+    }
+  }
+  if (IsKeyValueTable(responses[0]->body)) {
+    std::string merged = std::move(responses[0]->body);
+    for (size_t i = 1; i < responses.size(); ++i) {
+      absl::string_view table = responses[i]->body;
+      if (!IsKeyValueTable(table)) {
+        return absl::InternalError(
+            "Malformed Key-Value server response: tables mixed with JSON");
+      }
+      absl::StrAppend(&merged, table.substr(kKeyValueTableMagic.size()));
+    }
+    return HTTPResponse{.body = std::move(merged),
+                        .status_code = 200,
+                        .cache_control = absl::StrJoin(cache_controls, ", ")};
+  }
+
+  rapidjson::Document merged(rapidjson::kObjectType);
+  auto& allocator = merged.GetAllocator();
+  for (const absl::StatusOr<HTTPResponse>& response : responses) {
+    absl::StatusOr<rapidjson::Document> document =
+        ParseJsonString(response->body);
+    if (!document.ok() || !document->IsObject()) {
+      return absl::InternalError(
+          absl::StrCat("Malformed Key-Value server response: ",
+                       document.ok() ? "not an object"
+                                     : document.status().message()));
+    }
+    for (auto& member : document->GetObject()) {
+      auto it = merged.FindMember(member.name);
+      if (it == merged.MemberEnd()) {
+        merged.AddMember(rapidjson::Value(member.name, allocator),
+                         rapidjson::Value(member.value, allocator), allocator);
+        continue;
+      }
+      if (!it->value.IsObject() || !member.value.IsObject()) {
+        continue;
+      }
+      for (auto& value : member.value.GetObject()) {
+        if (!it->value.HasMember(value.name)) {
+          it->value.AddMember(rapidjson::Value(value.name, allocator),
+                              rapidjson::Value(value.value, allocator),
+                              allocator);
+        }
+      }
+    }
+  }
+  absl::StatusOr<std::string> body = SerializeJsonDoc(merged);
+  if (!body.ok()) {
+    return body.status();
+  }
+  return HTTPResponse{.body = *std::move(body),
+                      .status_code = 200,
+                      .cache_control = absl::StrJoin(cache_controls, ", ")};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
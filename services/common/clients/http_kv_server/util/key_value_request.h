@@ -0,0 +1,94 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_REQUEST_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_REQUEST_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+#include "src/cpp/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// How the Key-Value clients send their lookups.
+struct KeyValueRequestOptions {
+  // Sends the lookup as a JSON object in the body of a POST to the server
+  // address instead of in the query string of a GET.
+  bool use_post = false;
+  // Gzips the body of the POST requests.
+  bool compress_body = false;
+  // Splits lookups of more keys into parallel requests of at most this many
+  // keys. Lookups are not split if 0.
+  int max_keys_per_request = 0;
+  // Asks the server for a key-value table (see
+  // services/common/util/key_value_table.h) instead of JSON, with an Accept
+  // header. Responses that are not tables are still handled as JSON.
+  bool accept_table = false;
+  // Merges the keys of the lookups sent within batch_max_delay of each other,
+  // with the same headers, into a single lookup of up to batch_max_keys keys
+  // (see KeyValueBatcher). Lookups are not batched if batch_max_keys is 0 or
+  // batch_executor, which runs the batch timers, is not set.
+  int batch_max_keys = 0;
+  absl::Duration batch_max_delay = absl::Microseconds(500);
+  server_common::Executor* batch_executor = nullptr;
+
+  bool IsBatched() const {
+    return batch_max_keys > 0 && batch_executor != nullptr;
+  }
+
+  // Whether a lookup is sent as a single GET.
+  bool IsDefault() const {
+    return !use_post && max_keys_per_request <= 0 && !IsBatched();
+  }
+};
+
+// Splits the keys of the lists into consecutive chunks of at most max_keys
+// keys in total. Each chunk has as many lists as there are lists, in the same
+// order. Returns the lists as the only chunk if max_keys is not positive.
+std::vector<std::vector<std::vector<std::string>>> SplitKeys(
+    std::vector<std::vector<std::string>> lists, int max_keys);
+
+// Returns a POST to url of a JSON object with the non-empty string params and
+// the non-empty lists as arrays of strings, e.g.
+// {"hostname":"example.com","keys":["a","b"]}. The body is gzipped if
+// compress is true.
+HTTPRequest BuildKeyValuePostRequest(
+    absl::string_view url, std::vector<std::string> headers,
+    const std::vector<std::pair<absl::string_view, absl::string_view>>& params,
+    const std::vector<std::pair<absl::string_view,
+                                const std::vector<std::string>*>>& lists,
+    bool compress);
+
+// Adds the headers the options call for to a request of a lookup.
+void AddKeyValueRequestHeaders(const KeyValueRequestOptions& options,
+                               HTTPRequest& request);
+
+// Returns the response of a lookup split into several requests from their
+// responses: the first error or non-200 response if any, otherwise a response
+// whose top-level objects hold the members of the same objects across all the
+// responses. Key-value tables are merged by concatenation instead, and may
+// not be mixed with JSON responses. The Cache-Control of the responses are
+// concatenated, so that the most restrictive directives apply.
+absl::StatusOr<HTTPResponse> MergeKeyValueResponses(
+    std::vector<absl::StatusOr<HTTPResponse>> responses);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_KEY_VALUE_REQUEST_H_
@@ -0,0 +1,158 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/key_value_request.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/compression/gzip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(SplitKeysTest, DoesNotSplitWithoutLimit) {
+  auto chunks = SplitKeys({{"a", "b"}, {"c"}}, 0);
+  ASSERT_EQ(chunks.size(), 1);
+  EXPECT_THAT(chunks[0][0], ElementsAre("a", "b"));
+  EXPECT_THAT(chunks[0][1], ElementsAre("c"));
+}
+
+TEST(SplitKeysTest, SplitsKeysAcrossLists) {
+  auto chunks = SplitKeys({{"a", "b", "c"}, {"d", "e"}}, 2);
+  ASSERT_EQ(chunks.size(), 3);
+  EXPECT_THAT(chunks[0][0], ElementsAre("a", "b"));
+  EXPECT_THAT(chunks[0][1], IsEmpty());
+  EXPECT_THAT(chunks[1][0], ElementsAre("c"));
+  EXPECT_THAT(chunks[1][1], ElementsAre("d"));
+  EXPECT_THAT(chunks[2][0], IsEmpty());
+  EXPECT_THAT(chunks[2][1], ElementsAre("e"));
+}
+
+TEST(SplitKeysTest, KeepsEmptyLookupsInOneChunk) {
+  auto chunks = SplitKeys({{}}, 2);
+  ASSERT_EQ(chunks.size(), 1);
+  EXPECT_THAT(chunks[0][0], IsEmpty());
+}
+
+TEST(BuildKeyValuePostRequestTest, SendsParamsAndListsAsJson) {
+  std::vector<std::string> keys = {"a", "b\"c"};
+  std::vector<std::string> no_keys;
+  HTTPRequest request = BuildKeyValuePostRequest(
+      "kv.com/v1", {"X-Header: 1"}, {{"hostname", "pub.com"}, {"empty", ""}},
+      {{"keys", &keys}, {"other", &no_keys}}, /*compress=*/false);
+
+  EXPECT_EQ(request.url, "kv.com/v1");
+  EXPECT_THAT(request.headers,
+              ElementsAre("X-Header: 1", "Content-Type: application/json"));
+  EXPECT_EQ(request.body,
+            R"JSON({"hostname":"pub.com","keys":["a","b\"c"]})JSON");
+}
+
+TEST(BuildKeyValuePostRequestTest, CompressesBody) {
+  std::vector<std::string> keys = {"a"};
+  HTTPRequest request = BuildKeyValuePostRequest(
+      "kv.com/v1", {}, {}, {{"keys", &keys}}, /*compress=*/true);
+
+  EXPECT_THAT(request.headers, ElementsAre("Content-Type: application/json",
+                                           "Content-Encoding: gzip"));
+  absl::StatusOr<std::string> body = GzipDecompress(request.body);
+  ASSERT_TRUE(body.ok());
+  EXPECT_EQ(*body, R"JSON({"keys":["a"]})JSON");
+}
+
+TEST(AddKeyValueRequestHeadersTest, AcceptsTablesOnlyIfAsked) {
+  HTTPRequest request;
+  AddKeyValueRequestHeaders({}, request);
+  EXPECT_TRUE(request.headers.empty());
+  AddKeyValueRequestHeaders({.accept_table = true}, request);
+  EXPECT_THAT(request.headers,
+              ElementsAre("Accept: application/vnd.bidding-auction.kv-table"));
+}
+
+TEST(MergeKeyValueResponsesTest, ReturnsSingleResponseAsIs) {
+  std::vector<absl::StatusOr<HTTPResponse>> responses;
+  responses.push_back(HTTPResponse{.body = "not json", .status_code = 200});
+
+  absl::StatusOr<HTTPResponse> response =
+      MergeKeyValueResponses(std::move(responses));
+  ASSERT_TRUE(response.ok());
+  EXPECT_EQ(response->body, "not json");
+}
+
+TEST(MergeKeyValueResponsesTest, MergesObjectsOfResponses) {
+  std::vector<absl::StatusOr<HTTPResponse>> responses;
+  responses.push_back(HTTPResponse{
+      .body = R"JSON({"keys":{"a":1},"version":1})JSON",
+      .status_code = 200,
+      .cache_control = "max-age=10"});
+  responses.push_back(
+      HTTPResponse{.body = R"JSON({"keys":{"b":[2]},"version":2})JSON",
+                   .status_code = 200,
+                   .cache_control = "no-store"});
+
+  absl::StatusOr<HTTPResponse> response =
+      MergeKeyValueResponses(std::move(responses));
+  ASSERT_TRUE(response.ok());
+  EXPECT_EQ(response->body, R"JSON({"keys":{"a":1,"b":[2]},"version":1})JSON");
+  EXPECT_EQ(response->cache_control, "max-age=10, no-store");
+}
+
+TEST(MergeKeyValueResponsesTest, ConcatenatesTables) {
+  std::vector<absl::StatusOr<HTTPResponse>> responses;
+  responses.push_back(HTTPResponse{.body = "KVT14:keys1:1:a1:1",
+                                   .status_code = 200,
+                                   .cache_control = "max-age=10"});
+  responses.push_back(
+      HTTPResponse{.body = "KVT14:keys1:1:b3:[2]", .status_code = 200});
+
+  absl::StatusOr<HTTPResponse> response =
+      MergeKeyValueResponses(std::move(responses));
+  ASSERT_TRUE(response.ok());
+  EXPECT_EQ(response->body, "KVT14:keys1:1:a1:14:keys1:1:b3:[2]");
+  EXPECT_EQ(response->cache_control, "max-age=10");
+
+  responses.clear();
+  responses.push_back(
+      HTTPResponse{.body = "KVT14:keys1:1:a1:1", .status_code = 200});
+  responses.push_back(
+      HTTPResponse{.body = R"JSON({"keys":{"b":2}})JSON", .status_code = 200});
+  EXPECT_FALSE(MergeKeyValueResponses(std::move(responses)).ok());
+}
+
+TEST(MergeKeyValueResponsesTest, ReturnsFirstFailure) {
+  std::vector<absl::StatusOr<HTTPResponse>> responses;
+  responses.push_back(HTTPResponse{.body = "{}", .status_code = 200});
+  responses.push_back(HTTPResponse{.body = "busy", .status_code = 503});
+  responses.push_back(absl::UnavailableError("unavailable"));
+
+  absl::StatusOr<HTTPResponse> response =
+      MergeKeyValueResponses(std::move(responses));
+  ASSERT_TRUE(response.ok());
+  EXPECT_EQ(response->status_code, 503);
+
+  responses.clear();
+  responses.push_back(HTTPResponse{.body = "{}", .status_code = 200});
+  responses.push_back(HTTPResponse{.body = "[]", .status_code = 200});
+  EXPECT_FALSE(MergeKeyValueResponses(std::move(responses)).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
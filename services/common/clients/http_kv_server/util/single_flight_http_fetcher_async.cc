@@ -0,0 +1,125 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/single_flight_http_fetcher_async.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "services/common/clients/http_kv_server/util/fetch_batch.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string RequestKey(const HTTPRequest& request) {
+  return absl::StrCat(request.url, "\n", absl::StrJoin(request.headers, "\n"),
+                      "\n\n", request.body);
+}
+
+}  // namespace
+
+SingleFlightHttpFetcherAsync::SingleFlightHttpFetcherAsync(
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async)
+    : http_fetcher_async_(std::move(http_fetcher_async)) {}
+
+void SingleFlightHttpFetcherAsync::FetchUrl(const HTTPRequest& http_request,
+                                            int timeout_ms,
+                                            OnDoneFetchUrl done_callback) {
+  Fetch(http_request, absl::Milliseconds(timeout_ms),
+        [done_callback = std::move(done_callback)](
+            const absl::StatusOr<HTTPResponse>& response) mutable {
+          if (response.ok()) {
+            std::move(done_callback)(response->body);
+          } else {
+            std::move(done_callback)(response.status());
+          }
+        });
+}
+
+void SingleFlightHttpFetcherAsync::FetchUrls(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrls done_callback) {
+  if (requests.empty()) {
+    std::move(done_callback)({});
+    return;
+  }
+  auto batch = std::make_shared<
+      FetchBatch<absl::StatusOr<std::string>, OnDoneFetchUrls>>(
+      requests.size(), std::move(done_callback));
+  for (size_t i = 0; i < requests.size(); ++i) {
+    Fetch(requests[i], timeout,
+          [batch, i](const absl::StatusOr<HTTPResponse>& response) {
+            if (response.ok()) {
+              batch->Set(i, response->body);
+            } else {
+              batch->Set(i, response.status());
+            }
+          });
+  }
+}
+
+void SingleFlightHttpFetcherAsync::FetchUrlsWithMetadata(
+    const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+    OnDoneFetchUrlsWithMetadata done_callback) {
+  if (requests.empty()) {
+    std::move(done_callback)({});
+    return;
+  }
+  auto batch = std::make_shared<
+      FetchBatch<absl::StatusOr<HTTPResponse>, OnDoneFetchUrlsWithMetadata>>(
+      requests.size(), std::move(done_callback));
+  for (size_t i = 0; i < requests.size(); ++i) {
+    Fetch(requests[i], timeout,
+          [batch, i](const absl::StatusOr<HTTPResponse>& response) {
+            batch->Set(i, response);
+          });
+  }
+}
+
+void SingleFlightHttpFetcherAsync::Fetch(const HTTPRequest& request,
+                                         absl::Duration timeout,
+                                         OnResponse on_response) {
+  std::string key = RequestKey(request);
+  {
+    absl::MutexLock lock(&mu_);
+    auto [it, inserted] = in_flight_.try_emplace(key);
+    it->second.push_back(std::move(on_response));
+    if (!inserted) {
+      return;
+    }
+  }
+  http_fetcher_async_->FetchUrlsWithMetadata(
+      {request}, timeout,
+      [this, key = std::move(key)](
+          std::vector<absl::StatusOr<HTTPResponse>> responses) {
+        OnFetched(key, responses[0]);
+      });
+}
+
+void SingleFlightHttpFetcherAsync::OnFetched(
+    const std::string& key, const absl::StatusOr<HTTPResponse>& response) {
+  std::vector<OnResponse> callbacks;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = in_flight_.find(key);
+    callbacks = std::move(it->second);
+    in_flight_.erase(it);
+  }
+  for (OnResponse& callback : callbacks) {
+    std::move(callback)(response);
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,75 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_SINGLE_FLIGHT_HTTP_FETCHER_ASYNC_H_
+#define SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_SINGLE_FLIGHT_HTTP_FETCHER_ASYNC_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/clients/http/http_fetcher_async.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Decorates an HttpFetcherAsync so that concurrent fetches of the same URL
+// with the same headers and body share a single fetch: requests made while an
+// identical one is in flight wait for its response instead of being sent
+// again. The timeout of the request in flight applies to the requests
+// waiting for it.
+class SingleFlightHttpFetcherAsync final : public HttpFetcherAsync {
+ public:
+  explicit SingleFlightHttpFetcherAsync(
+      std::unique_ptr<HttpFetcherAsync> http_fetcher_async);
+
+  void FetchUrl(const HTTPRequest& http_request, int timeout_ms,
+                OnDoneFetchUrl done_callback) override;
+
+  void FetchUrls(const std::vector<HTTPRequest>& requests,
+                 absl::Duration timeout,
+                 OnDoneFetchUrls done_callback) override;
+
+  void FetchUrlsWithMetadata(
+      const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+      OnDoneFetchUrlsWithMetadata done_callback) override;
+
+ private:
+  using OnResponse =
+      absl::AnyInvocable<void(const absl::StatusOr<HTTPResponse>&) &&>;
+
+  // Fetches the request, unless an identical one is in flight, and calls
+  // on_response with its response.
+  void Fetch(const HTTPRequest& request, absl::Duration timeout,
+             OnResponse on_response);
+
+  // Calls every callback waiting for the request with its response.
+  void OnFetched(const std::string& key,
+                 const absl::StatusOr<HTTPResponse>& response);
+
+  absl::Mutex mu_;
+  // Callbacks waiting for the requests in flight, by URL, headers and body.
+  absl::flat_hash_map<std::string, std::vector<OnResponse>> in_flight_
+      ABSL_GUARDED_BY(mu_);
+  // Destroyed first, so that the fetches it completes on destruction find the
+  // members above.
+  std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_HTTP_KV_SERVER_UTIL_SINGLE_FLIGHT_HTTP_FETCHER_ASYNC_H_
@@ -0,0 +1,138 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/http_kv_server/util/single_flight_http_fetcher_async.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+
+class SingleFlightHttpFetcherAsyncTest : public testing::Test {
+ protected:
+  SingleFlightHttpFetcherAsyncTest() {
+    auto mock_http_fetcher_async =
+        std::make_unique<testing::NiceMock<MockHttpFetcherAsync>>();
+    ON_CALL(*mock_http_fetcher_async, FetchUrls)
+        .WillByDefault([this](const std::vector<HTTPRequest>& requests,
+                              absl::Duration timeout,
+                              OnDoneFetchUrls done_callback) {
+          for (const HTTPRequest& request : requests) {
+            fetched_urls_.push_back(request.url);
+          }
+          pending_.push_back(std::move(done_callback));
+        });
+    fetcher_ = std::make_unique<SingleFlightHttpFetcherAsync>(
+        std::move(mock_http_fetcher_async));
+  }
+
+  // Completes the oldest fetch sent to the wrapped fetcher.
+  void Complete(absl::StatusOr<std::string> result) {
+    OnDoneFetchUrls done_callback = std::move(pending_.front());
+    pending_.erase(pending_.begin());
+    std::move(done_callback)({std::move(result)});
+  }
+
+  std::vector<std::string> fetched_urls_;
+  std::vector<OnDoneFetchUrls> pending_;
+  std::unique_ptr<SingleFlightHttpFetcherAsync> fetcher_;
+};
+
+TEST_F(SingleFlightHttpFetcherAsyncTest, CoalescesIdenticalRequestsInFlight) {
+  std::vector<std::string> results;
+  for (int i = 0; i < 3; ++i) {
+    fetcher_->FetchUrl({"kv?keys=a"}, 100,
+                       [&results](absl::StatusOr<std::string> result) {
+                         results.push_back(*result);
+                       });
+  }
+  EXPECT_THAT(fetched_urls_, ElementsAre("kv?keys=a"));
+
+  Complete("a");
+  EXPECT_THAT(results, ElementsAre("a", "a", "a"));
+
+  // The request is sent again once the previous one is done.
+  fetcher_->FetchUrl({"kv?keys=a"}, 100,
+                     [](absl::StatusOr<std::string> result) {});
+  EXPECT_THAT(fetched_urls_, ElementsAre("kv?keys=a", "kv?keys=a"));
+}
+
+TEST_F(SingleFlightHttpFetcherAsyncTest, DoesNotCoalesceDifferentRequests) {
+  fetcher_->FetchUrl({"kv?keys=a"}, 100,
+                     [](absl::StatusOr<std::string> result) {});
+  fetcher_->FetchUrl({"kv?keys=b"}, 100,
+                     [](absl::StatusOr<std::string> result) {});
+  fetcher_->FetchUrl({"kv?keys=a", {"X-Header: 1"}}, 100,
+                     [](absl::StatusOr<std::string> result) {});
+
+  EXPECT_THAT(fetched_urls_,
+              ElementsAre("kv?keys=a", "kv?keys=b", "kv?keys=a"));
+}
+
+TEST_F(SingleFlightHttpFetcherAsyncTest, SharesErrorsWithWaitingRequests) {
+  std::vector<absl::StatusCode> codes;
+  for (int i = 0; i < 2; ++i) {
+    fetcher_->FetchUrl({"kv?keys=a"}, 100,
+                       [&codes](absl::StatusOr<std::string> result) {
+                         codes.push_back(result.status().code());
+                       });
+  }
+  Complete(absl::DeadlineExceededError("timeout"));
+
+  EXPECT_THAT(codes, ElementsAre(absl::StatusCode::kDeadlineExceeded,
+                                 absl::StatusCode::kDeadlineExceeded));
+}
+
+TEST_F(SingleFlightHttpFetcherAsyncTest, KeepsOrderOfBatchedRequests) {
+  std::vector<absl::StatusOr<std::string>> results;
+  fetcher_->FetchUrls(
+      {{"kv?keys=a"}, {"kv?keys=b"}, {"kv?keys=a"}}, absl::Milliseconds(100),
+      [&results](std::vector<absl::StatusOr<std::string>> batch_results) {
+        results = std::move(batch_results);
+      });
+  EXPECT_THAT(fetched_urls_, ElementsAre("kv?keys=a", "kv?keys=b"));
+
+  Complete("a");
+  EXPECT_TRUE(results.empty());
+  Complete("b");
+
+  ASSERT_EQ(results.size(), 3);
+  EXPECT_EQ(*results[0], "a");
+  EXPECT_EQ(*results[1], "b");
+  EXPECT_EQ(*results[2], "a");
+}
+
+TEST_F(SingleFlightHttpFetcherAsyncTest, CompletesEmptyBatches) {
+  bool done = false;
+  fetcher_->FetchUrlsWithMetadata(
+      {}, absl::Milliseconds(100),
+      [&done](std::vector<absl::StatusOr<HTTPResponse>> responses) {
+        EXPECT_TRUE(responses.empty());
+        done = true;
+      });
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(fetched_urls_.empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,73 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/mirroring_async_client.h"
+
+#include <atomic>
+#include <cstdint>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Mirrored calls of a backend since the start of the process. The getters
+// only read them, so concurrent readers do not steal each other's counts.
+struct MirroredCallStats {
+  std::atomic<int64_t> succeeded = 0;
+  std::atomic<int64_t> failed = 0;
+  std::atomic<int64_t> timed = 0;
+  std::atomic<int64_t> latency_us = 0;
+};
+
+MirroredCallStats& StatsOf(MirroredCall call) {
+  static MirroredCallStats primary;
+  static MirroredCallStats shadow;
+  return call == MirroredCall::kPrimary ? primary : shadow;
+}
+
+double MeanLatencyMs(const MirroredCallStats& stats) {
+  const int64_t timed = stats.timed.load(std::memory_order_relaxed);
+  const int64_t latency_us = stats.latency_us.load(std::memory_order_relaxed);
+  return timed > 0 ? latency_us / 1000.0 / timed : 0;
+}
+
+}  // namespace
+
+void RecordMirroredCall(MirroredCall call, bool success,
+                        absl::Duration latency) {
+  MirroredCallStats& stats = StatsOf(call);
+  if (!success) {
+    stats.failed.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  stats.succeeded.fetch_add(1, std::memory_order_relaxed);
+  stats.timed.fetch_add(1, std::memory_order_relaxed);
+  stats.latency_us.fetch_add(absl::ToInt64Microseconds(latency),
+                             std::memory_order_relaxed);
+}
+
+absl::flat_hash_map<std::string, double> GetMirroredCallCounts() {
+  const MirroredCallStats& primary = StatsOf(MirroredCall::kPrimary);
+  const MirroredCallStats& shadow = StatsOf(MirroredCall::kShadow);
+  return {{"primary_succeeded", primary.succeeded.load()},
+          {"primary_failed", primary.failed.load()},
+          {"shadow_succeeded", shadow.succeeded.load()},
+          {"shadow_failed", shadow.failed.load()}};
+}
+
+absl::flat_hash_map<std::string, double> GetMirroredCallLatencies() {
+  return {{"primary", MeanLatencyMs(StatsOf(MirroredCall::kPrimary))},
+          {"shadow", MeanLatencyMs(StatsOf(MirroredCall::kShadow))}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,200 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_CLIENTS_MIRRORING_ASYNC_CLIENT_H_
+#define SERVICES_COMMON_CLIENTS_MIRRORING_ASYNC_CLIENT_H_
+
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "services/common/clients/async_client.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Backend a mirrored call was made to.
+enum class MirroredCall {
+  kPrimary,
+  kShadow,
+};
+
+// Records whether a mirrored call succeeded, and its latency if it did.
+void RecordMirroredCall(MirroredCall call, bool success,
+                        absl::Duration latency);
+
+// Returns the number of mirrored calls that succeeded and failed, on the
+// primary and the shadow backends, since the start of the process. Reading
+// does not reset the counts, so any number of readers see the same snapshot.
+absl::flat_hash_map<std::string, double> GetMirroredCallCounts();
+
+// Returns the mean latency in milliseconds of the mirrored calls that
+// succeeded, on the primary and the shadow backends, since the start of the
+// process.
+absl::flat_hash_map<std::string, double> GetMirroredCallLatencies();
+
+namespace internal {
+
+template <typename T, typename = void>
+struct HasDebugReporting : std::false_type {};
+
+template <typename T>
+struct HasDebugReporting<
+    T, std::void_t<decltype(std::declval<T&>().clear_enable_debug_reporting()),
+                   decltype(std::declval<T&>().clear_consented_debug_config())>>
+    : std::true_type {};
+
+}  // namespace internal
+
+// Strips from a mirrored request everything that makes its backend egress
+// data, so that the shadow never sends debug pings or consented debug logs
+// on behalf of the primary's traffic.
+template <typename RawRequest>
+void StripMirroredRequest(RawRequest& request) {
+  if constexpr (internal::HasDebugReporting<RawRequest>::value) {
+    request.clear_enable_debug_reporting();
+    request.clear_consented_debug_config();
+  }
+}
+
+template <typename T>
+inline void AddShadowTrafficMetric(T* context_map) {
+  context_map->AddObserverable(metric::kShadowTrafficCallCount,
+                               GetMirroredCallCounts);
+  context_map->AddObserverable(metric::kShadowTrafficLatencyMs,
+                               GetMirroredCallLatencies);
+}
+
+// Mirrors a sample of the decrypted calls of the client to a shadow backend,
+// such as a canary running a new build or Roma config, so that its latency
+// can be compared with the primary's on live traffic. The response of the
+// shadow is discarded, and its calls are never cancelled with the primary's,
+// so that the two see the same work. Encrypted calls are not mirrored, and the
+// mirrored copies have debug reporting and consented debugging stripped so
+// that the shadow does not egress anything for them.
+template <typename Request, typename Response, typename RawRequest,
+          typename RawResponse>
+class MirroringAsyncClient
+    : public AsyncClient<Request, Response, RawRequest, RawResponse> {
+ public:
+  using Client = AsyncClient<Request, Response, RawRequest, RawResponse>;
+
+  // shadow_percent: percentage of the calls mirrored to shadow, picked at
+  // random.
+  MirroringAsyncClient(std::shared_ptr<const Client> client,
+                       std::shared_ptr<const Client> shadow,
+                       int shadow_percent)
+      : client_(std::move(client)),
+        shadow_(std::move(shadow)),
+        shadow_percent_(shadow_percent) {}
+
+  absl::Status Execute(
+      std::unique_ptr<Request> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<Response>>) &&>
+          on_done,
+      absl::Duration timeout) const override {
+    return client_->Execute(std::move(request), metadata, std::move(on_done),
+                            timeout);
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout) const override {
+    return ExecuteInternal(std::move(request), metadata, std::move(on_done),
+                           timeout, /*crypto_metrics=*/nullptr,
+                           /*cancellation=*/nullptr);
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics) const override {
+    return ExecuteInternal(std::move(request), metadata, std::move(on_done),
+                           timeout, crypto_metrics, /*cancellation=*/nullptr);
+  }
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<RawRequest> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<RawResponse>>) &&>
+          on_done,
+      absl::Duration timeout, CryptoMetrics* crypto_metrics,
+      CancellationToken* cancellation) const override {
+    if (!ShouldMirror()) {
+      return client_->ExecuteInternal(std::move(request), metadata,
+                                      std::move(on_done), timeout,
+                                      crypto_metrics, cancellation);
+    }
+    Mirror(*request, metadata, timeout);
+    absl::Status status = client_->ExecuteInternal(
+        std::move(request), metadata,
+        [on_done = std::move(on_done), start = absl::Now()](
+            absl::StatusOr<std::unique_ptr<RawResponse>> response) mutable {
+          RecordMirroredCall(MirroredCall::kPrimary, response.ok(),
+                             absl::Now() - start);
+          std::move(on_done)(std::move(response));
+        },
+        timeout, crypto_metrics, cancellation);
+    if (!status.ok()) {
+      RecordMirroredCall(MirroredCall::kPrimary, /*success=*/false,
+                         absl::ZeroDuration());
+    }
+    return status;
+  }
+
+ private:
+  bool ShouldMirror() const {
+    if (shadow_percent_ <= 0) {
+      return false;
+    }
+    thread_local absl::BitGen bitgen;
+    return absl::Uniform(bitgen, 0, 100) < shadow_percent_;
+  }
+
+  void Mirror(const RawRequest& request, const RequestMetadata& metadata,
+              absl::Duration timeout) const {
+    auto mirrored = std::make_unique<RawRequest>(request);
+    StripMirroredRequest(*mirrored);
+    absl::Status status = shadow_->ExecuteInternal(
+        std::move(mirrored), metadata,
+        [start = absl::Now()](
+            absl::StatusOr<std::unique_ptr<RawResponse>> response) {
+          RecordMirroredCall(MirroredCall::kShadow, response.ok(),
+                             absl::Now() - start);
+        },
+        timeout);
+    if (!status.ok()) {
+      RecordMirroredCall(MirroredCall::kShadow, /*success=*/false,
+                         absl::ZeroDuration());
+    }
+  }
+
+  std::shared_ptr<const Client> client_;
+  std::shared_ptr<const Client> shadow_;
+  const int shadow_percent_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CLIENTS_MIRRORING_ASYNC_CLIENT_H_
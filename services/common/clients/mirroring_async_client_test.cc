@@ -0,0 +1,125 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/clients/mirroring_async_client.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+using IntClient = AsyncClient<int, int, int, int>;
+
+// Answers each call with its request plus the offset, or fails them all.
+class FakeClient : public IntClient {
+ public:
+  explicit FakeClient(int offset) : offset(offset) {}
+
+  absl::Status ExecuteInternal(
+      std::unique_ptr<int> request, const RequestMetadata& metadata,
+      absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<int>>) &&> on_done,
+      absl::Duration timeout) const override {
+    requests.push_back(*request);
+    if (fail) {
+      std::move(on_done)(absl::UnavailableError("Unavailable"));
+    } else {
+      std::move(on_done)(std::make_unique<int>(*request + offset));
+    }
+    return absl::OkStatus();
+  }
+
+  const int offset;
+  bool fail = false;
+  mutable std::vector<int> requests;
+};
+
+int Call(const IntClient& client, int request) {
+  int response = -1;
+  absl::Status status = client.ExecuteInternal(
+      std::make_unique<int>(request), {},
+      [&response](absl::StatusOr<std::unique_ptr<int>> result) {
+        response = result.ok() ? **result : 0;
+      },
+      absl::Seconds(1), /*crypto_metrics=*/nullptr, /*cancellation=*/nullptr);
+  EXPECT_TRUE(status.ok()) << status;
+  return response;
+}
+
+TEST(MirroringAsyncClientTest, MirrorsTheSampledCallsAndDiscardsTheShadow) {
+  auto primary = std::make_shared<FakeClient>(/*offset=*/1);
+  auto shadow = std::make_shared<FakeClient>(/*offset=*/100);
+  shadow->fail = true;
+  MirroringAsyncClient<int, int, int, int> client(primary, shadow,
+                                                  /*shadow_percent=*/100);
+  EXPECT_EQ(Call(client, 1), 2);
+  EXPECT_EQ(Call(client, 2), 3);
+
+  EXPECT_THAT(primary->requests, ElementsAre(1, 2));
+  EXPECT_THAT(shadow->requests, ElementsAre(1, 2));
+  EXPECT_THAT(GetMirroredCallCounts(),
+              UnorderedElementsAre(Pair("primary_succeeded", 2),
+                                   Pair("primary_failed", 0),
+                                   Pair("shadow_succeeded", 0),
+                                   Pair("shadow_failed", 2)));
+  EXPECT_THAT(GetMirroredCallLatencies(),
+              UnorderedElementsAre(Pair("primary", testing::Ge(0)),
+                                   Pair("shadow", 0)));
+  // Reading does not reset the counts.
+  EXPECT_EQ(GetMirroredCallCounts()["primary_succeeded"], 2);
+}
+
+// Stands in for a raw request proto with debug reporting.
+struct FakeDebugRequest {
+  void clear_enable_debug_reporting() { enable_debug_reporting = false; }
+  void clear_consented_debug_config() { consented = false; }
+
+  bool enable_debug_reporting = true;
+  bool consented = true;
+  int payload = 7;
+};
+
+TEST(MirroringAsyncClientTest, StripsDebugReportingFromMirroredRequests) {
+  FakeDebugRequest request;
+  StripMirroredRequest(request);
+  EXPECT_FALSE(request.enable_debug_reporting);
+  EXPECT_FALSE(request.consented);
+  EXPECT_EQ(request.payload, 7);
+
+  int plain = 3;
+  StripMirroredRequest(plain);
+  EXPECT_EQ(plain, 3);
+}
+
+TEST(MirroringAsyncClientTest, DoesNotMirrorWithoutSample) {
+  auto primary = std::make_shared<FakeClient>(/*offset=*/1);
+  auto shadow = std::make_shared<FakeClient>(/*offset=*/100);
+  MirroringAsyncClient<int, int, int, int> client(primary, shadow,
+                                                  /*shadow_percent=*/0);
+  EXPECT_EQ(Call(client, 1), 2);
+  EXPECT_THAT(primary->requests, ElementsAre(1));
+  EXPECT_THAT(shadow->requests, IsEmpty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
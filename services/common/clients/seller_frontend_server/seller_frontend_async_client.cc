@@ -17,27 +17,16 @@
 #include <algorithm>
 
 #include "glog/logging.h"
+#include "services/common/clients/async_grpc/default_async_grpc_client.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
 SellerFrontEndGrpcClient::SellerFrontEndGrpcClient(
     const SellerFrontEndServiceClientConfig& client_config)
     : AsyncClient() {
-  std::shared_ptr<grpc::Channel> channel;
-  std::shared_ptr<grpc::ChannelCredentials> creds =
-      client_config.secure_client
-          ? grpc::SslCredentials(grpc::SslCredentialsOptions())
-          : grpc::InsecureChannelCredentials();
-  if (client_config.compression) {
-    grpc::ChannelArguments args;
-    // Set the default compression algorithm for the channel.
-    args.SetCompressionAlgorithm(GRPC_COMPRESS_GZIP);
-    channel = grpc::CreateCustomChannel(absl::StrCat(client_config.server_addr),
-                                        std::move(creds), args);
-  } else {
-    channel = grpc::CreateChannel(absl::StrCat(client_config.server_addr),
-                                  std::move(creds));
-  }
+  std::shared_ptr<grpc::Channel> channel =
+      CreateChannel(client_config.server_addr, client_config.compression,
+                    client_config.secure_client);
   stub_ = SellerFrontEnd::NewStub(channel);
 }
 
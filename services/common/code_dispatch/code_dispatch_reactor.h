@@ -15,6 +15,7 @@
 #ifndef SERVICES_COMMON_CODE_DISPATCH_CODE_DISPATCH_REACTOR_H_
 #define SERVICES_COMMON_CODE_DISPATCH_CODE_DISPATCH_REACTOR_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -23,15 +24,79 @@
 #include <grpcpp/grpcpp.h>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
+#include "google/protobuf/arena.h"
 #include "services/common/clients/code_dispatcher/code_dispatch_client.h"
 #include "services/common/constants/user_error_strings.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "services/common/encryption/crypto_metrics.h"
+#include "services/common/encryption/crypto_worker_pool.h"
+#include "services/common/telemetry/request_tracer.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/huge_pages.h"
+#include "services/common/util/object_pool.h"
+#include "services/common/util/request_class.h"
+#include "services/common/util/request_cpu_time.h"
+#include "services/common/util/request_memory_budget.h"
+#include "services/common/util/request_timeline.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Bounds of the size of the first block of the arena of a request, which is
+// sized for the parsed request to fit in it.
+inline constexpr size_t kMinRequestArenaBlockSize = 4 * 1024;
+inline constexpr size_t kMaxRequestArenaBlockSize = 4 * 1024 * 1024;
+static_assert(kMaxRequestArenaBlockSize <= kLargeBufferBytes,
+              "The largest arena blocks must fit in a large buffer");
+// Arenas whose blocks are at least this large take them from the large
+// buffer pool, if it is set up, rather than from malloc.
+inline constexpr size_t kMinPooledRequestArenaBlockSize = 1024 * 1024;
+
+// Returns the options of the arena of a request whose ciphertext is
+// payload_size bytes. A parsed message takes about twice the memory of its
+// encoding, mostly for the headers of its strings and repeated fields.
+inline google::protobuf::ArenaOptions RequestArenaOptions(size_t payload_size) {
+  google::protobuf::ArenaOptions options;
+  options.start_block_size =
+      std::clamp(2 * payload_size, kMinRequestArenaBlockSize,
+                 kMaxRequestArenaBlockSize);
+  options.max_block_size = options.start_block_size;
+  if (options.start_block_size >= kMinPooledRequestArenaBlockSize &&
+      GetLargeBufferPool() != nullptr) {
+    options.block_alloc = &AllocateLargeBuffer;
+    options.block_dealloc = &DeallocateLargeBuffer;
+  }
+  return options;
+}
+
+// Most idle states kept by each pool of reactor states, about the most
+// requests a server has in flight.
+inline constexpr int kReactorStatePoolMaxIdle = 256;
+
+// Pooled containers of reactor states holding more elements than this are
+// dropped rather than pooled, so that a few very large requests do not pin
+// their memory.
+inline constexpr size_t kMaxPooledContainerSize = 1024;
+
+// Returns the pool of the dispatch requests of the reactors of the process.
+inline ObjectPool<std::vector<DispatchRequest>>& DispatchRequestsPool() {
+  static auto* pool = new ObjectPool<std::vector<DispatchRequest>>(
+      kReactorStatePoolMaxIdle, [](std::vector<DispatchRequest>& requests) {
+        if (requests.capacity() > kMaxPooledContainerSize) {
+          requests = std::vector<DispatchRequest>();
+        } else {
+          requests.clear();
+        }
+      });
+  return *pool;
+}
+
 // This is a gRPC reactor that serves a single Request.
 // It stores state relevant to the request and after the
 // response is finished being served, CodeDispatchReactor cleans up all
@@ -40,20 +105,31 @@ template <typename Request, typename RawRequest, typename Response,
           typename RawResponse>
 class CodeDispatchReactor : public grpc::ServerUnaryReactor {
  public:
+  // crypto_worker_pool: if set, the request is decrypted and the response
+  // encrypted on it, rather than right away and on the calling thread.
   explicit CodeDispatchReactor(
       const CodeDispatchClient& dispatcher, const Request* request,
       Response* response,
       server_common::KeyFetcherManagerInterface* key_fetcher_manager,
-      CryptoClientWrapperInterface* crypto_client, bool encryption_enabled)
+      CryptoClientWrapperInterface* crypto_client, bool encryption_enabled,
+      CryptoWorkerPool* crypto_worker_pool = nullptr)
       : dispatcher_(dispatcher),
         request_(request),
+        arena_(RequestArenaOptions(request->request_ciphertext().size())),
+        raw_request_(
+            *google::protobuf::Arena::CreateMessage<RawRequest>(&arena_)),
         response_(response),
+        raw_response_(
+            *google::protobuf::Arena::CreateMessage<RawResponse>(&arena_)),
         key_fetcher_manager_(key_fetcher_manager),
         crypto_client_(crypto_client),
-        encryption_enabled_(encryption_enabled) {
+        encryption_enabled_(encryption_enabled),
+        crypto_worker_pool_(crypto_worker_pool) {
     DCHECK(encryption_enabled);
-    VLOG(5) << "Encryption is enabled, decrypting request now";
-    DecryptRequest();
+    if (crypto_worker_pool_ == nullptr) {
+      VLOG(5) << "Encryption is enabled, decrypting request now";
+      DecryptRequest();
+    }
   }
 
   // Polymorphic class => virtual destructor
@@ -65,15 +141,70 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
   // call Finish(grpc::Status).
   virtual void Execute() = 0;
 
+  // Traces the request as `name` if the caller did, per its `traceparent`.
+  // Must be called before Start().
+  void StartTrace(absl::string_view name, absl::string_view traceparent) {
+    tracer_ = RequestTracer::FromTraceParent(name, traceparent, start_);
+    // Without a crypto worker pool, the request was decrypted at construction.
+    if (decrypt_end_ != absl::InfinitePast()) {
+      tracer_.AddSpan("DecryptRequest", decrypt_start_, decrypt_end_);
+    }
+  }
+
+  // Executes the request. With a crypto worker pool, the request is decrypted
+  // first, and both run on a thread of the pool if the request is large.
+  // The request fails if its decrypted payload is over its memory budget.
+  void Start() {
+    if (crypto_worker_pool_ == nullptr) {
+      if (ChargeDecryptedRequest()) {
+        Execute();
+      }
+      return;
+    }
+    crypto_worker_pool_->Run(request_->request_ciphertext().size(), [this]() {
+      DecryptRequest();
+      if (ChargeDecryptedRequest()) {
+        Execute();
+      }
+    });
+  }
+
+  // Keeps the request counted in flight by the concurrency limiter of the
+  // server until the reactor is done.
+  void SetConcurrencyPermit(ConcurrencyLimiter::Permit permit) {
+    concurrency_permit_ = std::move(permit);
+  }
+
+  // Sets the memory budget of the request, charged with its decrypted
+  // payload and the arguments of its dispatches. Must be called before
+  // Start(). No budget when not positive.
+  void SetMemoryBudget(int64_t budget_bytes) {
+    memory_budget_.SetBudget(budget_bytes);
+  }
+
+  // Sets the class the caller sent with the request, by which its dispatch
+  // requests are scheduled. Must be called before Start().
+  void SetRequestClass(RequestClass request_class) {
+    request_class_ = request_class;
+  }
+
  protected:
+  // Tags the dispatch request with the class of the request, unless it is
+  // standard, as the scheduler defaults to it.
+  void AddRequestClassTag(DispatchRequest& dispatch_request) const {
+    if (request_class_ != RequestClass::kStandard) {
+      dispatch_request.tags[kRequestClassTag] =
+          std::string(RequestClassName(request_class_));
+    }
+  }
+
   // Cleans up all state associated with the CodeDispatchReactor.
   // Called only after the grpc request is finalized and finished.
   void OnDone() override { delete this; };
 
-  // Handles early-cancellation by the client.
-  void OnCancel() override{
-      // TODO(b/245982466): error handling design
-  };
+  // Handles early-cancellation by the client, dropping the requests still
+  // waiting to be dispatched to Roma.
+  void OnCancel() override { cancellation_.Cancel(); };
 
   // Decrypts the request ciphertext in and returns whether decryption was
   // successful. If successful, the result is written into 'raw_request_'.
@@ -99,6 +230,8 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
       return false;
     }
 
+    decrypt_start_ = absl::Now();
+    const absl::Duration decrypt_cpu_start = ThreadCpuTime();
     absl::StatusOr<google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>
         decrypt_response = crypto_client_->HpkeDecrypt(
             *private_key, request_->request_ciphertext());
@@ -109,45 +242,123 @@ class CodeDispatchReactor : public grpc::ServerUnaryReactor {
                           kMalformedCiphertext));
       return false;
     }
+    decrypt_end_ = absl::Now();
+    crypto_metrics_.Add(CryptoOperation::kHpkeDecrypt,
+                        decrypt_end_ - decrypt_start_,
+                        request_->request_ciphertext().size());
+    tracer_.AddSpan("DecryptRequest", decrypt_start_, decrypt_end_);
+    timeline_.Record(RequestStage::kDecrypt, decrypt_start_, decrypt_end_);
 
     hpke_secret_ = std::move(decrypt_response->secret());
-    return raw_request_.ParseFromString(decrypt_response->payload());
+    decrypted_request_bytes_ = decrypt_response->payload().size();
+    const bool parsed =
+        raw_request_.ParseFromString(decrypt_response->payload());
+    cpu_time_.AddSince(CpuStage::kDecrypt, decrypt_cpu_start);
+    return parsed;
+  }
+
+  // Charges the decrypted payload of the request to its memory budget, and
+  // fails the request if it is over.
+  bool ChargeDecryptedRequest() {
+    if (memory_budget_.Charge(decrypted_request_bytes_)) {
+      return true;
+    }
+    VLOG(1) << "Decrypted request of " << decrypted_request_bytes_
+            << " bytes over the memory budget";
+    RecordMemoryBudgetExceeded(MemoryBudgetAction::kRejected);
+    Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                        kRequestMemoryBudgetExceeded));
+    return false;
   }
 
   // Encrypts `raw_response` and sets the result on the 'response_ciphertext'
   // field in the response. Returns whether encryption was successful.
   bool EncryptResponse() {
-    std::string payload = raw_response_.SerializeAsString();
-    absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
-        aead_encrypt = crypto_client_->AeadEncrypt(payload, hpke_secret_);
-    if (!aead_encrypt.ok()) {
-      VLOG(1) << "AEAD encrypt failed: " << aead_encrypt.status();
-      Finish(grpc::Status(grpc::StatusCode::INTERNAL,
-                          aead_encrypt.status().ToString()));
+    const absl::Time encrypt_start = absl::Now();
+    const absl::Duration encrypt_cpu_start = ThreadCpuTime();
+    // The raw response is serialized straight into the ciphertext field.
+    std::string& ciphertext = *response_->mutable_response_ciphertext();
+    if (absl::Status status = crypto_client_->AeadEncryptMessage(
+            raw_response_, hpke_secret_, ciphertext);
+        !status.ok()) {
+      VLOG(1) << "AEAD encrypt failed: " << status;
+      Finish(grpc::Status(grpc::StatusCode::INTERNAL, status.ToString()));
       return false;
     }
-
-    response_->set_response_ciphertext(
-        aead_encrypt->encrypted_data().ciphertext());
+    crypto_metrics_.Add(CryptoOperation::kAeadEncrypt,
+                        absl::Now() - encrypt_start, ciphertext.size());
+    const absl::Time encrypt_end = absl::Now();
+    tracer_.AddSpan("EncryptResponse", encrypt_start, encrypt_end);
+    timeline_.Record(RequestStage::kEncrypt, encrypt_start, encrypt_end);
+    cpu_time_.AddSince(CpuStage::kEncrypt, encrypt_cpu_start);
     return true;
   }
 
+  // Reports the timeline of the request done, with the number of its
+  // interest groups or ads, to keep it if the request was slow.
+  void ReportTimeline(int num_items) {
+    ReportRequestTimeline(
+        timeline_,
+        {.request_bytes = request_->request_ciphertext().size(),
+         .response_bytes = response_->response_ciphertext().size(),
+         .num_items = num_items});
+  }
+
+  // Runs the operation that encrypts the response and finishes the RPC, on
+  // the crypto worker pool if any and the response is large.
+  void RunEncryption(absl::AnyInvocable<void() &&> encrypt_and_finish) {
+    if (crypto_worker_pool_ == nullptr) {
+      std::move(encrypt_and_finish)();
+      return;
+    }
+    crypto_worker_pool_->Run(raw_response_.ByteSizeLong(),
+                             std::move(encrypt_and_finish));
+  }
+
   // Dispatches execution requests to a library that runs V8 workers in
   // separate processes.
   const CodeDispatchClient& dispatcher_;
-  std::vector<DispatchRequest> dispatch_requests_;
+  // Taken from DispatchRequestsPool, so that the vector keeps its capacity
+  // across requests.
+  ObjectPool<std::vector<DispatchRequest>>::Ptr pooled_dispatch_requests_ =
+      DispatchRequestsPool().Acquire();
+  std::vector<DispatchRequest>& dispatch_requests_ =
+      *pooled_dispatch_requests_;
 
   // The client request, lifecycle managed by gRPC.
   const Request* request_;
-  RawRequest raw_request_;
+  // Holds raw_request_ and raw_response_, and frees them at once with the
+  // reactor in OnDone.
+  google::protobuf::Arena arena_;
+  RawRequest& raw_request_;
   // The client response, lifecycle managed by gRPC.
   Response* response_;
-  RawResponse raw_response_;
+  RawResponse& raw_response_;
 
   server_common::KeyFetcherManagerInterface* key_fetcher_manager_;
   CryptoClientWrapperInterface* crypto_client_;
   std::string hpke_secret_;
   bool encryption_enabled_;
+  CryptoWorkerPool* crypto_worker_pool_;
+  // The decryption of the request and the encryption of the response, to be
+  // logged in the metric context of the request.
+  CryptoMetrics crypto_metrics_;
+  // CPU time of the request by stage, to be logged in its metric context.
+  RequestCpuTime cpu_time_;
+
+  // Traces the request if the caller did, from when it was received.
+  const absl::Time start_ = absl::Now();
+  absl::Time decrypt_start_ = absl::InfinitePast();
+  absl::Time decrypt_end_ = absl::InfinitePast();
+  RequestTracer tracer_;
+  // Stages of the request, traced or not, kept by the process if it is slow.
+  RequestTimeline timeline_{start_};
+  // Cancelled once the client gives up on the request.
+  CancellationToken cancellation_;
+  ConcurrencyLimiter::Permit concurrency_permit_;
+  RequestClass request_class_ = RequestClass::kStandard;
+  RequestMemoryBudget memory_budget_;
+  int64_t decrypted_request_bytes_ = 0;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -18,9 +18,17 @@
 #define SERVICES_COMMON_CODE_FETCH_CODE_FETCHER_INTERFACE_H_
 
 #include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Wraps the fetched code blobs into the code loaded into Roma.
+using WrapCodeForDispatch =
+    absl::AnyInvocable<std::string(const std::vector<std::string>&)>;
+
 // Interface for different versions of code fetchers.
 class CodeFetcherInterface {
  public:
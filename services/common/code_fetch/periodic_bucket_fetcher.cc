@@ -16,12 +16,17 @@
 
 #include "services/common/code_fetch/periodic_bucket_fetcher.h"
 
+#include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "cc/core/interface/async_context.h"
 #include "cc/core/interface/errors.h"
@@ -33,7 +38,6 @@
 using ::google::cmrt::sdk::blob_storage_service::v1::GetBlobRequest;
 using ::google::cmrt::sdk::blob_storage_service::v1::GetBlobResponse;
 using ::google::scp::core::AsyncContext;
-using ::google::scp::core::ExecutionResult;
 using ::google::scp::core::errors::GetErrorMessage;
 using ::google::scp::cpio::BlobStorageClientFactory;
 using ::google::scp::cpio::BlobStorageClientInterface;
@@ -41,19 +45,27 @@ using ::google::scp::cpio::BlobStorageClientInterface;
 namespace privacy_sandbox::bidding_auction_servers {
 
 PeriodicBucketFetcher::PeriodicBucketFetcher(
-    absl::string_view bucket_name, absl::string_view blob_name,
+    absl::string_view bucket_name, std::vector<std::string> blob_names,
     absl::Duration fetch_period_ms, const V8Dispatcher& dispatcher,
     server_common::Executor* executor,
     std::unique_ptr<BlobStorageClientInterface> blob_storage_client =
-        BlobStorageClientFactory::Create())
+        BlobStorageClientFactory::Create(),
+    std::vector<DispatchRequest> warm_up_requests,
+    absl::Duration warm_up_timeout, WrapCodeForDispatch wrap_code,
+    std::string code_experiment_id)
     : bucket_name_(bucket_name),
-      blob_name_(blob_name),
+      blob_names_(std::move(blob_names)),
       fetch_period_ms_(fetch_period_ms),
       dispatcher_(dispatcher),
       executor_(std::move(executor)),
-      blob_storage_client_(std::move(blob_storage_client)) {}
+      blob_storage_client_(std::move(blob_storage_client)),
+      warm_up_requests_(std::move(warm_up_requests)),
+      warm_up_timeout_(warm_up_timeout),
+      wrap_code_(std::move(wrap_code)),
+      code_experiment_id_(std::move(code_experiment_id)) {}
 
 void PeriodicBucketFetcher::Start() {
+  CHECK(!blob_names_.empty()) << "No blob to fetch from the bucket.";
   InitAndRunConfigClient();
   executor_->Run([this]() { PeriodicBucketFetch(); });
 }
@@ -79,45 +91,108 @@ void PeriodicBucketFetcher::InitAndRunConfigClient() {
 }
 
 void PeriodicBucketFetcher::PeriodicBucketFetch() {
-  ExecutionResult result;
-
-  auto get_blob_request = std::make_shared<GetBlobRequest>();
-  get_blob_request->mutable_blob_metadata()->set_bucket_name(bucket_name_);
-  get_blob_request->mutable_blob_metadata()->set_blob_name(blob_name_);
-
-  AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
-      move(get_blob_request), [&result, this](auto& context) {
-        result = context.result;
-
-        if (result.Successful()) {
+  // Shared by the fetches of the blobs, the last of which to finish loads
+  // them.
+  struct BucketFetch {
+    absl::Mutex mu;
+    std::vector<absl::StatusOr<std::string>> blobs ABSL_GUARDED_BY(mu);
+    int pending ABSL_GUARDED_BY(mu) = 0;
+  };
+  auto fetch = std::make_shared<BucketFetch>();
+  {
+    absl::MutexLock lock(&fetch->mu);
+    fetch->blobs.resize(blob_names_.size());
+    fetch->pending = blob_names_.size();
+  }
+  auto on_blob_fetched = [this, fetch](int index,
+                                       absl::StatusOr<std::string> blob) {
+    std::vector<absl::StatusOr<std::string>> blobs;
+    {
+      absl::MutexLock lock(&fetch->mu);
+      fetch->blobs[index] = std::move(blob);
+      if (--fetch->pending > 0) {
+        return;
+      }
+      blobs = std::move(fetch->blobs);
+    }
+    OnBlobsFetched(std::move(blobs));
+  };
+
+  for (int i = 0; i < blob_names_.size(); ++i) {
+    auto get_blob_request = std::make_shared<GetBlobRequest>();
+    get_blob_request->mutable_blob_metadata()->set_bucket_name(bucket_name_);
+    get_blob_request->mutable_blob_metadata()->set_blob_name(blob_names_[i]);
+
+    AsyncContext<GetBlobRequest, GetBlobResponse> get_blob_context(
+        std::move(get_blob_request), [i, on_blob_fetched](auto& context) {
+          if (!context.result.Successful()) {
+            const std::string error = absl::StrCat(
+                "Failed to Blob Fetch: ",
+                GetErrorMessage(context.result.status_code));
+            on_blob_fetched(i, absl::UnavailableError(error));
+            return;
+          }
           VLOG(2) << "BlobStorageClient GetBlob() Response: "
                   << context.response;
+          on_blob_fetched(
+              i, std::move(*context.response->mutable_blob()->mutable_data()));
+        });
+
+    auto get_blob_result = blob_storage_client_->GetBlob(get_blob_context);
+    if (!get_blob_result.Successful()) {
+      // The callback is not called for the requests that failed to start.
+      on_blob_fetched(i, absl::UnavailableError(absl::StrCat(
+                             "BlobStorageClient -> GetBlob() failed: ",
+                             GetErrorMessage(get_blob_result.status_code))));
+    }
+  }
+}
 
-          auto result_value = context.response->blob().data();
-          if (cb_result_value_ != result_value) {
-            cb_result_value_ = result_value;
+void PeriodicBucketFetcher::OnBlobsFetched(
+    std::vector<absl::StatusOr<std::string>> blobs) {
+  bool all_status_ok = true;
+  for (const absl::StatusOr<std::string>& blob : blobs) {
+    if (!blob.ok()) {
+      VLOG(0) << blob.status();
+      all_status_ok = false;
+      break;
+    }
+  }
 
-            absl::Status roma_result = dispatcher_.LoadSync(1, result_value);
-            VLOG(1) << "Roma Client Response: " << roma_result;
-            if (roma_result.ok()) {
-              VLOG(2) << "Current code loaded into Roma:\n" << result_value;
-            }
-          }
-        } else {
-          VLOG(0) << "Failed to Blob Fetch: "
-                  << GetErrorMessage(result.status_code);
-        }
-
-        // Schedules the next code blob fetch and saves that task into task_id_.
-        task_id_ = executor_->RunAfter(fetch_period_ms_,
-                                       [this]() { PeriodicBucketFetch(); });
-      });
-
-  auto get_blob_result = blob_storage_client_->GetBlob(get_blob_context);
-  if (!get_blob_result.Successful()) {
-    VLOG(0) << "BlobStorageClient -> GetBlob() failed: "
-            << GetErrorMessage(get_blob_result.status_code);
+  if (all_status_ok) {
+    // Cached blobs can only be reused if there is one per blob name.
+    const bool has_cached_blobs = cb_results_value_.size() == blobs.size();
+    cb_results_value_.resize(blobs.size());
+    bool any_changed = false;
+    for (size_t i = 0; i < blobs.size(); ++i) {
+      if (!has_cached_blobs || *blobs[i] != cb_results_value_[i]) {
+        cb_results_value_[i] = *std::move(blobs[i]);
+        any_changed = true;
+      }
+    }
+
+    // Only loads a new version into Roma if any of the blobs changed.
+    if (any_changed) {
+      std::string code = wrap_code_ != nullptr
+                             ? wrap_code_(cb_results_value_)
+                             : absl::StrJoin(cb_results_value_, "\n");
+      absl::Status roma_result =
+          code_experiment_id_.empty()
+              ? dispatcher_.LoadNextVersionSync(code, warm_up_requests_,
+                                                warm_up_timeout_)
+              : dispatcher_.LoadExperimentVersionSync(
+                    code_experiment_id_, code, warm_up_requests_,
+                    warm_up_timeout_);
+      VLOG(1) << "Roma Client Response: " << roma_result;
+      if (roma_result.ok()) {
+        VLOG(2) << "Current code loaded into Roma:\n" << code;
+      }
+    }
   }
+
+  // Schedules the next code blob fetch and saves that task into task_id_.
+  task_id_ = executor_->RunAfter(fetch_period_ms_,
+                                 [this]() { PeriodicBucketFetch(); });
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
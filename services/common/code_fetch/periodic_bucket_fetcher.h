@@ -20,7 +20,9 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/time/time.h"
 #include "cc/public/cpio/interface/blob_storage_client/blob_storage_client_interface.h"
@@ -34,28 +36,34 @@ namespace privacy_sandbox::bidding_auction_servers {
  * ScoreAd()) by performing GetBlob() from a BlobStorageClient.
  * Periodic fetching starts when Start() is called, and each fetch is done after
  * a certain period of time (not after the last request is executed). End the
- * process by calling End(). This current design can only fetch 1 blob out of 1
- * specific bucket (no support for wasm, reportWin/reportResult, multi-version,
- * etc) since GetBlob() can only fetch 1 blob per request. To support fetching
- * multiple files, my design recommendation is to pass a map of bucket and blob
- * names as inputs (ex: {"bucket A": "blob A", "bucket B": "blob B"}) and call
- * GetBlob() per pair in a loop. However, if you are trying to fetch a large
- * number of blobs or a whole bucket, my recommendation is to create new
- * functions for BlobStorageClient such as GetBucket() that fetches the whole
- * bucket or GetBlobs() that fetch multiple blobs at once. This is so you are
- * making one async call instead of managing multiple and combining the results
- * in this PeriodicBucketFetcher class.
+ * process by calling End(). Each fetch gets all the blobs of the bucket in
+ * parallel, such as the code, its WASM helper and the code of the buyers, and
+ * loads them together as the next version once they have all been fetched and
+ * any of them changed.
  */
 
 class PeriodicBucketFetcher : public CodeFetcherInterface {
  public:
   // Constructs a new PeriodicBucketFether.
+  // blob_names: blobs of the bucket fetched, passed to wrap_code in the same
+  // order.
+  // warm_up_requests: requests executed after each successful code load, so
+  // that the Roma workers compile the new code before it serves traffic.
+  // warm_up_timeout: longest time to wait for the warm up requests.
+  // wrap_code: wraps the fetched blobs before they are loaded. If not set,
+  // the blobs are loaded one after the other.
+  // code_experiment_id: if set, the fetched code is loaded as the version of
+  // this code experiment instead of the current version.
   explicit PeriodicBucketFetcher(
-      absl::string_view bucket_name, absl::string_view blob_name,
+      absl::string_view bucket_name, std::vector<std::string> blob_names,
       absl::Duration fetch_period_ms, const V8Dispatcher& dispatcher,
       server_common::Executor* executor,
       std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
-          blob_storage_client);
+          blob_storage_client,
+      std::vector<DispatchRequest> warm_up_requests = {},
+      absl::Duration warm_up_timeout = absl::Seconds(10),
+      WrapCodeForDispatch wrap_code = nullptr,
+      std::string code_experiment_id = "");
 
   // Not copyable or movable.
   PeriodicBucketFetcher(const PeriodicBucketFetcher&) = delete;
@@ -73,18 +81,25 @@ class PeriodicBucketFetcher : public CodeFetcherInterface {
   // Performs bucket fetching with BlobStorageClient and loads code blob into
   // Roma.
   void PeriodicBucketFetch();
+  // Loads the blobs into Roma if any differs from the one last fetched, and
+  // schedules the next fetch. Called once all the blobs of a fetch are done.
+  void OnBlobsFetched(std::vector<absl::StatusOr<std::string>> blobs);
 
-  absl::string_view bucket_name_;
-  absl::string_view blob_name_;
+  std::string bucket_name_;
+  std::vector<std::string> blob_names_;
   absl::Duration fetch_period_ms_;
   const V8Dispatcher& dispatcher_;
   server_common::Executor* executor_;
   std::unique_ptr<google::scp::cpio::BlobStorageClientInterface>
       blob_storage_client_;
+  std::vector<DispatchRequest> warm_up_requests_;
+  absl::Duration warm_up_timeout_;
+  WrapCodeForDispatch wrap_code_;
+  std::string code_experiment_id_;
 
-  // Keeps track of the last fetched value for comparison. Code is only loaded
-  // into Roma if the fetched result is different from the previous value.
-  std::string cb_result_value_;
+  // Keeps track of the last fetched blobs, one per blob name. Code is only
+  // loaded into Roma if a fetched blob differs from the previous one.
+  std::vector<std::string> cb_results_value_;
   // Keeps track of the next task to be performed on the executor.
   server_common::TaskId task_id_;
 };
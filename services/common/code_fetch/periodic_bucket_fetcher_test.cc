@@ -16,9 +16,12 @@
 
 #include "services/common/code_fetch/periodic_bucket_fetcher.h"
 
+#include <string>
 #include <utility>
 #include <vector>
 
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "absl/synchronization/notification.h"
 #include "absl/time/time.h"
@@ -97,13 +100,166 @@ TEST(PeriodicBucketFetcherTest, LoadsResultIntoV8Dispatcher) {
       });
 
   PeriodicBucketFetcher bucket_fetcher(
-      "BucketName", "BlobName", absl::Milliseconds(3000), dispatcher,
+      "BucketName", {"BlobName"}, absl::Milliseconds(3000), dispatcher,
       executor.get(), std::move(blob_storage_client));
   bucket_fetcher.Start();
   done_load_sync.Wait();
   bucket_fetcher.End();
 }
 
+TEST(PeriodicBucketFetcherTest, WarmsUpV8DispatcherAfterLoad) {
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+  std::vector<DispatchRequest> warm_up_requests = {DispatchRequest{"foo"},
+                                                   DispatchRequest{"bar"}};
+
+  absl::BlockingCounter done_warm_up(1);
+
+  EXPECT_CALL(*blob_storage_client, Init).WillOnce([&]() {
+    return SuccessExecutionResult();
+  });
+
+  EXPECT_CALL(*blob_storage_client, Run).WillOnce([&]() {
+    return SuccessExecutionResult();
+  });
+
+  EXPECT_CALL(*executor, Run).WillOnce([&](absl::AnyInvocable<void()> closure) {
+    closure();
+  });
+
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .WillOnce([](AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+        async_context.response = std::make_shared<GetBlobResponse>();
+        async_context.response->mutable_blob()->set_data("test");
+        async_context.result = SuccessExecutionResult();
+        async_context.Finish();
+
+        return SuccessExecutionResult();
+      });
+
+  testing::InSequence in_sequence;
+  EXPECT_CALL(dispatcher, LoadSync)
+      .WillOnce([](int version, absl::string_view blob_data) {
+        EXPECT_EQ(version, 1);
+        return absl::OkStatus();
+      });
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([&done_warm_up](std::vector<DispatchRequest>& batch,
+                                BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 2);
+        EXPECT_EQ(batch.at(0).id, "foo");
+        EXPECT_EQ(batch.at(0).version_num, 1);
+        batch_callback({});
+        done_warm_up.DecrementCount();
+        return absl::OkStatus();
+      });
+
+  PeriodicBucketFetcher bucket_fetcher(
+      "BucketName", {"BlobName"}, absl::Milliseconds(3000), dispatcher,
+      executor.get(), std::move(blob_storage_client),
+      std::move(warm_up_requests));
+  bucket_fetcher.Start();
+  done_warm_up.Wait();
+  EXPECT_EQ(dispatcher.CurrentVersion(), 1);
+  bucket_fetcher.End();
+}
+
+TEST(PeriodicBucketFetcherTest, LoadsWrappedCodeAsCodeExperimentVersion) {
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+
+  EXPECT_CALL(*blob_storage_client, Init).WillOnce([&]() {
+    return SuccessExecutionResult();
+  });
+
+  EXPECT_CALL(*blob_storage_client, Run).WillOnce([&]() {
+    return SuccessExecutionResult();
+  });
+
+  EXPECT_CALL(*executor, Run).WillOnce([&](absl::AnyInvocable<void()> closure) {
+    closure();
+  });
+
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .WillOnce([](AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+        async_context.response = std::make_shared<GetBlobResponse>();
+        async_context.response->mutable_blob()->set_data("test");
+        async_context.result = SuccessExecutionResult();
+        async_context.Finish();
+
+        return SuccessExecutionResult();
+      });
+
+  EXPECT_CALL(dispatcher, LoadSync)
+      .WillOnce([](int version, absl::string_view blob_data) {
+        EXPECT_EQ(blob_data, "wrapped test");
+        return absl::OkStatus();
+      });
+
+  PeriodicBucketFetcher bucket_fetcher(
+      "BucketName", {"BlobName"}, absl::Milliseconds(3000), dispatcher,
+      executor.get(), std::move(blob_storage_client), /*warm_up_requests=*/{},
+      absl::Seconds(1),
+      [](const std::vector<std::string>& blobs) {
+        return absl::StrCat("wrapped ", blobs.at(0));
+      },
+      "BlobName");
+  bucket_fetcher.Start();
+  EXPECT_EQ(dispatcher.ExperimentVersion("BlobName"), 1);
+  EXPECT_EQ(dispatcher.CurrentVersion(), 0);
+  bucket_fetcher.End();
+}
+
+TEST(PeriodicBucketFetcherTest, LoadsAllTheBlobsTogether) {
+  MockV8Dispatcher dispatcher;
+  auto executor = std::make_unique<MockExecutor>();
+  auto blob_storage_client = std::make_unique<MockBlobStorageClient>();
+
+  EXPECT_CALL(*blob_storage_client, Init).WillOnce([&]() {
+    return SuccessExecutionResult();
+  });
+  EXPECT_CALL(*blob_storage_client, Run).WillOnce([&]() {
+    return SuccessExecutionResult();
+  });
+
+  EXPECT_CALL(*executor, Run).WillOnce([&](absl::AnyInvocable<void()> closure) {
+    closure();
+  });
+
+  // Each blob holds its name.
+  EXPECT_CALL(*blob_storage_client, GetBlob)
+      .Times(2)
+      .WillRepeatedly(
+          [](AsyncContext<GetBlobRequest, GetBlobResponse> async_context) {
+            async_context.response = std::make_shared<GetBlobResponse>();
+            async_context.response->mutable_blob()->set_data(
+                async_context.request->blob_metadata().blob_name());
+            async_context.result = SuccessExecutionResult();
+            async_context.Finish();
+
+            return SuccessExecutionResult();
+          });
+
+  EXPECT_CALL(*executor, RunAfter).Times(1);
+  EXPECT_CALL(dispatcher, LoadSync)
+      .WillOnce([](int version, absl::string_view blob_data) {
+        EXPECT_EQ(blob_data, "Code+Wasm");
+        return absl::OkStatus();
+      });
+
+  PeriodicBucketFetcher bucket_fetcher(
+      "BucketName", {"Code", "Wasm"}, absl::Milliseconds(3000), dispatcher,
+      executor.get(), std::move(blob_storage_client), /*warm_up_requests=*/{},
+      absl::Seconds(1), [](const std::vector<std::string>& blobs) {
+        return absl::StrJoin(blobs, "+");
+      });
+  bucket_fetcher.Start();
+  EXPECT_EQ(dispatcher.CurrentVersion(), 1);
+  bucket_fetcher.End();
+}
+
 TEST(PeriodicBucketFetcherTest, PeriodicallyFetchesBucket) {
   MockV8Dispatcher dispatcher;
   auto executor = std::make_unique<MockExecutor>();
@@ -151,7 +307,7 @@ TEST(PeriodicBucketFetcherTest, PeriodicallyFetchesBucket) {
       });
 
   PeriodicBucketFetcher bucket_fetcher(
-      "BucketName", "BlobName", absl::Milliseconds(3000), dispatcher,
+      "BucketName", {"BlobName"}, absl::Milliseconds(3000), dispatcher,
       executor.get(), std::move(blob_storage_client));
   bucket_fetcher.Start();
   done_get_blob.Wait();
@@ -210,7 +366,7 @@ TEST(PeriodicBucketFetcherTest, LoadsOnlyDifferentFetchedResult) {
       });
 
   PeriodicBucketFetcher bucket_fetcher(
-      "BucketName", "BlobName", absl::Milliseconds(3000), dispatcher,
+      "BucketName", {"BlobName"}, absl::Milliseconds(3000), dispatcher,
       executor.get(), std::move(blob_storage_client));
   bucket_fetcher.Start();
   done_get_blob.Wait();
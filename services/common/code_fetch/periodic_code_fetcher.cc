@@ -22,23 +22,34 @@
 
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/time/time.h"
 #include "glog/logging.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Whether the response carries the code blob, rather than an error page.
+bool IsSuccess(long status_code) {
+  return status_code >= 200 && status_code < 300;
+}
+
+}  // namespace
 
 PeriodicCodeFetcher::PeriodicCodeFetcher(
     std::vector<std::string> url_endpoints, absl::Duration fetch_period_ms,
     std::unique_ptr<HttpFetcherAsync> curl_http_fetcher,
     const V8Dispatcher& dispatcher, server_common::Executor* executor,
-    absl::Duration time_out_ms, WrapCodeForDispatch wrap_code)
+    absl::Duration time_out_ms, WrapCodeForDispatch wrap_code,
+    std::vector<DispatchRequest> warm_up_requests)
     : url_endpoints_(url_endpoints),
       fetch_period_ms_(fetch_period_ms),
       curl_http_fetcher_(std::move(curl_http_fetcher)),
       dispatcher_(dispatcher),
       executor_(std::move(executor)),
       time_out_ms_(time_out_ms),
-      wrap_code_(std::move(wrap_code)) {}
+      wrap_code_(std::move(wrap_code)),
+      warm_up_requests_(std::move(warm_up_requests)) {}
 
 void PeriodicCodeFetcher::Start() {
   CHECK_LT(time_out_ms_, fetch_period_ms_)
@@ -54,32 +65,91 @@ void PeriodicCodeFetcher::End() {
   }
 }
 
+std::vector<HTTPRequest> PeriodicCodeFetcher::MakeRequests() const {
+  std::vector<HTTPRequest> requests;
+  requests.reserve(url_endpoints_.size());
+  for (size_t i = 0; i < url_endpoints_.size(); ++i) {
+    HTTPRequest request;
+    request.url = url_endpoints_[i];
+    if (i < code_blob_versions_.size()) {
+      const CodeBlobVersion& version = code_blob_versions_[i];
+      if (!version.etag.empty()) {
+        request.headers.push_back(
+            absl::StrCat("If-None-Match: ", version.etag));
+      }
+      if (!version.last_modified.empty()) {
+        request.headers.push_back(
+            absl::StrCat("If-Modified-Since: ", version.last_modified));
+      }
+    }
+    requests.push_back(std::move(request));
+  }
+  return requests;
+}
+
 void PeriodicCodeFetcher::PeriodicCodeFetch() {
   auto done_callback =
-      [this](std::vector<absl::StatusOr<std::string>> results) mutable {
+      [this](std::vector<absl::StatusOr<HTTPResponse>> results) mutable {
         bool all_status_ok = true;
-        std::vector<std::string> results_value;
+        // Cached code blobs can only be reused if there is one per url.
+        const bool has_cached_blobs =
+            cb_results_value_.size() == results.size();
+        std::vector<bool> changed(results.size(), false);
 
-        for (const auto& result : results) {
+        for (size_t i = 0; i < results.size(); ++i) {
+          const absl::StatusOr<HTTPResponse>& result = results[i];
           if (!result.ok()) {
             VLOG(1) << "MultiCurlHttpFetcher Failure Response: "
                     << result.status();
             all_status_ok = false;
             break;
-          } else {
-            VLOG(1) << "MultiCurlHttpFetcher Success Response: "
-                    << result.status();
-            results_value.push_back(*result);
           }
+          VLOG(1) << "MultiCurlHttpFetcher Success Response: "
+                  << result->status_code;
+          if (result->status_code == kHttpStatusNotModified) {
+            if (!has_cached_blobs) {
+              VLOG(1) << "Not modified response without a cached code blob";
+              all_status_ok = false;
+              break;
+            }
+            continue;
+          }
+          if (!IsSuccess(result->status_code)) {
+            VLOG(1) << "Code blob fetch failed with status code "
+                    << result->status_code;
+            all_status_ok = false;
+            break;
+          }
+          changed[i] =
+              !has_cached_blobs || result->body != cb_results_value_[i];
         }
 
         if (all_status_ok) {
-          // Vector comparison to only load a new code blob into Roma
-          if (cb_results_value_ != results_value) {
-            cb_results_value_ = results_value;
+          bool any_changed = false;
+          cb_results_value_.resize(results.size());
+          code_blob_versions_.resize(results.size());
+          for (size_t i = 0; i < results.size(); ++i) {
+            CodeBlobVersion& version = code_blob_versions_[i];
+            // A not modified response may omit the validators.
+            if (!results[i]->etag.empty() ||
+                results[i]->status_code != kHttpStatusNotModified) {
+              version.etag = std::move(results[i]->etag);
+            }
+            if (!results[i]->last_modified.empty() ||
+                results[i]->status_code != kHttpStatusNotModified) {
+              version.last_modified = std::move(results[i]->last_modified);
+            }
+            if (changed[i]) {
+              cb_results_value_[i] = std::move(results[i]->body);
+              any_changed = true;
+            }
+          }
 
+          // Only loads a new code blob into Roma if any of the blobs changed.
+          if (any_changed) {
             std::string wrapped_code = wrap_code_(cb_results_value_);
-            absl::Status syncResult = dispatcher_.LoadSync(1, wrapped_code);
+            absl::Status syncResult = dispatcher_.LoadNextVersionSync(
+                wrapped_code, warm_up_requests_, time_out_ms_);
             VLOG(1) << "Roma Client Response: " << syncResult;
             if (syncResult.ok()) {
               VLOG(2) << "Current code loaded into Roma:\n" << wrapped_code;
@@ -92,16 +162,8 @@ void PeriodicCodeFetcher::PeriodicCodeFetch() {
                                        [this]() { PeriodicCodeFetch(); });
       };
 
-  // Create a HTTPRequest object from the url_endpoint_
-  std::vector<HTTPRequest> requests;
-  for (std::string endpoint : url_endpoints_) {
-    HTTPRequest request;
-    request.url = std::string(endpoint);
-    requests.push_back(request);
-  }
-
-  curl_http_fetcher_->FetchUrls(requests, time_out_ms_,
-                                std::move(done_callback));
+  curl_http_fetcher_->FetchUrlsWithMetadata(MakeRequests(), time_out_ms_,
+                                            std::move(done_callback));
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -30,9 +30,6 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
-using WrapCodeForDispatch =
-    absl::AnyInvocable<std::string(const std::vector<std::string>&)>;
-
 // AdTech Code Blob fetching system to update Adtech's GenerateBid(), ScoreAd(),
 // ReportWin() and ReportResult() code through a periodic pull mechanism with an
 // arbitrary endpoint.
@@ -50,11 +47,14 @@ class PeriodicCodeFetcher : public CodeFetcherInterface {
   // executing.
   // FetchUrl. wrap_code: a lambda function that wraps the code blob for
   // scoring / bidding.
+  // warm_up_requests: requests executed after each successful code load, so
+  // that the Roma workers compile the new code before serving traffic.
   explicit PeriodicCodeFetcher(
       std::vector<std::string> url_endpoints, absl::Duration fetch_period_ms,
       std::unique_ptr<HttpFetcherAsync> curl_http_fetcher,
       const V8Dispatcher& dispatcher, server_common::Executor* executor,
-      absl::Duration time_out_ms, WrapCodeForDispatch wrap_code);
+      absl::Duration time_out_ms, WrapCodeForDispatch wrap_code,
+      std::vector<DispatchRequest> warm_up_requests = {});
 
   // Not copyable or movable.
   PeriodicCodeFetcher(const PeriodicCodeFetcher&) = delete;
@@ -80,12 +80,25 @@ class PeriodicCodeFetcher : public CodeFetcherInterface {
   server_common::Executor* executor_;
   absl::Duration time_out_ms_;
   WrapCodeForDispatch wrap_code_;
+  std::vector<DispatchRequest> warm_up_requests_;
+
+  // Validators sent with the next conditional request for a code blob.
+  struct CodeBlobVersion {
+    std::string etag;
+    std::string last_modified;
+  };
+
+  // Returns the HTTP requests for url_endpoints_, conditional on the
+  // validators of the code blobs fetched last.
+  std::vector<HTTPRequest> MakeRequests() const;
 
   // Keeps track of the next task to be performed on the executor.
   server_common::TaskId task_id_;
-  // Keeps track of the last result.value() returned by FetchUrl and callback
-  // function.
+  // Keeps track of the last code blobs returned by FetchUrlsWithMetadata and
+  // callback function, one per url endpoint.
   std::vector<std::string> cb_results_value_;
+  // Same size as cb_results_value_.
+  std::vector<CodeBlobVersion> code_blob_versions_;
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -20,6 +20,7 @@
 #include <vector>
 
 #include "absl/synchronization/blocking_counter.h"
+#include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "services/common/test/mocks.h"
 #include "src/cpp/concurrent/event_engine_executor.h"
@@ -27,6 +28,18 @@
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
 
+using ::testing::ElementsAre;
+
+// Mocks the conditional fetch, which MockHttpFetcherAsync forwards to
+// FetchUrls.
+class MockConditionalHttpFetcherAsync : public MockHttpFetcherAsync {
+ public:
+  MOCK_METHOD(void, FetchUrlsWithMetadata,
+              (const std::vector<HTTPRequest>& requests, absl::Duration timeout,
+               OnDoneFetchUrlsWithMetadata done_callback),
+              (override));
+};
+
 TEST(PeriodicCodeFetcherTest, LoadsHttpFetcherResultIntoV8Dispatcher) {
   auto curl_http_fetcher = std::make_unique<MockHttpFetcherAsync>();
   MockV8Dispatcher dispatcher;
@@ -76,6 +89,56 @@ TEST(PeriodicCodeFetcherTest, LoadsHttpFetcherResultIntoV8Dispatcher) {
   code_fetcher.End();
 }
 
+TEST(PeriodicCodeFetcherTest, WarmsUpV8DispatcherAfterLoad) {
+  auto curl_http_fetcher = std::make_unique<MockHttpFetcherAsync>();
+  MockV8Dispatcher dispatcher;
+  std::vector<absl::StatusOr<std::string>> url_response = {"function test(){}"};
+
+  const std::vector<std::string>& endpoints = {"test.com"};
+  absl::Duration fetch_period = absl::Milliseconds(3000);
+  auto executor = std::make_unique<MockExecutor>();
+  absl::Duration time_out = absl::Milliseconds(1000);
+  auto WrapCode = [](const std::vector<std::string>& adtech_code_blobs) {
+    return "test";
+  };
+  std::vector<DispatchRequest> warm_up_requests = {DispatchRequest{"foo"},
+                                                   DispatchRequest{"bar"}};
+
+  EXPECT_CALL(*curl_http_fetcher, FetchUrls)
+      .WillOnce([&url_response](
+                    const std::vector<HTTPRequest>& requests,
+                    absl::Duration timeout,
+                    absl::AnyInvocable<
+                        void(std::vector<absl::StatusOr<std::string>>) &&>
+                        done_callback) {
+        std::move(done_callback)(url_response);
+      });
+  EXPECT_CALL(*executor, Run)
+      .WillOnce([&](absl::AnyInvocable<void()> closure) { closure(); });
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            return server_common::TaskId();
+          });
+
+  testing::InSequence in_sequence;
+  EXPECT_CALL(dispatcher, LoadSync).WillOnce(testing::Return(absl::OkStatus()));
+  EXPECT_CALL(dispatcher, BatchExecute)
+      .WillOnce([](std::vector<DispatchRequest>& batch,
+                   BatchDispatchDoneCallback batch_callback) {
+        EXPECT_EQ(batch.size(), 2);
+        EXPECT_EQ(batch.at(0).id, "foo");
+        batch_callback({});
+        return absl::OkStatus();
+      });
+
+  PeriodicCodeFetcher code_fetcher(
+      endpoints, fetch_period, std::move(curl_http_fetcher), dispatcher,
+      executor.get(), time_out, WrapCode, std::move(warm_up_requests));
+  code_fetcher.Start();
+  code_fetcher.End();
+}
+
 TEST(PeriodicCodeFetcherTest, PeriodicallyFetchesCode) {
   auto curl_http_fetcher = std::make_unique<MockHttpFetcherAsync>();
   MockV8Dispatcher dispatcher;
@@ -181,5 +244,165 @@ TEST(PeriodicCodeFetcherTest, LoadsOnlyDifferentHttpFetcherResult) {
   code_fetcher.End();
 }
 
+TEST(PeriodicCodeFetcherTest, SendsValidatorsAndReusesNotModifiedCodeBlobs) {
+  auto curl_http_fetcher = std::make_unique<MockConditionalHttpFetcherAsync>();
+  MockV8Dispatcher dispatcher;
+  const std::vector<std::string>& endpoints = {"js.com", "wasm.com"};
+  absl::Duration fetch_period = absl::Milliseconds(3000);
+  auto executor = std::make_unique<MockExecutor>();
+  absl::Duration time_out = absl::Milliseconds(1000);
+  std::vector<std::vector<std::string>> wrapped_blobs;
+  auto WrapCode = [&wrapped_blobs](
+                      const std::vector<std::string>& adtech_code_blobs) {
+    wrapped_blobs.push_back(adtech_code_blobs);
+    return "test";
+  };
+
+  EXPECT_CALL(*curl_http_fetcher, FetchUrlsWithMetadata)
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout,
+                   OnDoneFetchUrlsWithMetadata done_callback) {
+        EXPECT_TRUE(requests.at(0).headers.empty());
+        EXPECT_TRUE(requests.at(1).headers.empty());
+        std::vector<absl::StatusOr<HTTPResponse>> responses;
+        responses.push_back(HTTPResponse{.body = "js_v1",
+                                         .status_code = 200,
+                                         .etag = "\"js_v1\""});
+        responses.push_back(
+            HTTPResponse{.body = "wasm_v1",
+                         .status_code = 200,
+                         .last_modified = "Wed, 21 Oct 2015 07:28:00 GMT"});
+        std::move(done_callback)(std::move(responses));
+      })
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout,
+                   OnDoneFetchUrlsWithMetadata done_callback) {
+        EXPECT_THAT(requests.at(0).headers,
+                    ElementsAre("If-None-Match: \"js_v1\""));
+        EXPECT_THAT(
+            requests.at(1).headers,
+            ElementsAre("If-Modified-Since: Wed, 21 Oct 2015 07:28:00 GMT"));
+        std::vector<absl::StatusOr<HTTPResponse>> responses;
+        responses.push_back(
+            HTTPResponse{.status_code = kHttpStatusNotModified});
+        responses.push_back(HTTPResponse{.body = "wasm_v2",
+                                         .status_code = 200});
+        std::move(done_callback)(std::move(responses));
+      })
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout,
+                   OnDoneFetchUrlsWithMetadata done_callback) {
+        EXPECT_THAT(requests.at(0).headers,
+                    ElementsAre("If-None-Match: \"js_v1\""));
+        EXPECT_TRUE(requests.at(1).headers.empty());
+        std::vector<absl::StatusOr<HTTPResponse>> responses;
+        responses.push_back(
+            HTTPResponse{.status_code = kHttpStatusNotModified});
+        responses.push_back(HTTPResponse{.body = "wasm_v2",
+                                         .status_code = 200});
+        std::move(done_callback)(std::move(responses));
+      });
+
+  EXPECT_CALL(*executor, Run)
+      .WillOnce([&](absl::AnyInvocable<void()> closure) { closure(); });
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            closure();
+            return server_common::TaskId();
+          })
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            closure();
+            return server_common::TaskId();
+          })
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            return server_common::TaskId();
+          });
+  // The third fetch returns the same code blobs as the second one.
+  EXPECT_CALL(dispatcher, LoadSync)
+      .Times(2)
+      .WillRepeatedly(testing::Return(absl::OkStatus()));
+
+  PeriodicCodeFetcher code_fetcher(endpoints, fetch_period,
+                                   std::move(curl_http_fetcher), dispatcher,
+                                   executor.get(), time_out, WrapCode);
+  code_fetcher.Start();
+  code_fetcher.End();
+
+  ASSERT_EQ(wrapped_blobs.size(), 2);
+  EXPECT_THAT(wrapped_blobs[0], ElementsAre("js_v1", "wasm_v1"));
+  EXPECT_THAT(wrapped_blobs[1], ElementsAre("js_v1", "wasm_v2"));
+}
+
+TEST(PeriodicCodeFetcherTest, DoesNotLoadNotModifiedWithoutCachedCodeBlob) {
+  auto curl_http_fetcher = std::make_unique<MockConditionalHttpFetcherAsync>();
+  MockV8Dispatcher dispatcher;
+  const std::vector<std::string>& endpoints = {"test.com"};
+  auto executor = std::make_unique<MockExecutor>();
+  auto WrapCode = [](const std::vector<std::string>& adtech_code_blobs) {
+    return "test";
+  };
+
+  EXPECT_CALL(*curl_http_fetcher, FetchUrlsWithMetadata)
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout,
+                   OnDoneFetchUrlsWithMetadata done_callback) {
+        std::vector<absl::StatusOr<HTTPResponse>> responses;
+        responses.push_back(
+            HTTPResponse{.status_code = kHttpStatusNotModified});
+        std::move(done_callback)(std::move(responses));
+      });
+  EXPECT_CALL(*executor, Run)
+      .WillOnce([&](absl::AnyInvocable<void()> closure) { closure(); });
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            return server_common::TaskId();
+          });
+  EXPECT_CALL(dispatcher, LoadSync).Times(0);
+
+  PeriodicCodeFetcher code_fetcher(
+      endpoints, absl::Milliseconds(3000), std::move(curl_http_fetcher),
+      dispatcher, executor.get(), absl::Milliseconds(1000), WrapCode);
+  code_fetcher.Start();
+  code_fetcher.End();
+}
+
+TEST(PeriodicCodeFetcherTest, DoesNotLoadErrorResponse) {
+  auto curl_http_fetcher = std::make_unique<MockConditionalHttpFetcherAsync>();
+  MockV8Dispatcher dispatcher;
+  const std::vector<std::string>& endpoints = {"test.com"};
+  auto executor = std::make_unique<MockExecutor>();
+  auto WrapCode = [](const std::vector<std::string>& adtech_code_blobs) {
+    return "test";
+  };
+
+  EXPECT_CALL(*curl_http_fetcher, FetchUrlsWithMetadata)
+      .WillOnce([](const std::vector<HTTPRequest>& requests,
+                   absl::Duration timeout,
+                   OnDoneFetchUrlsWithMetadata done_callback) {
+        std::vector<absl::StatusOr<HTTPResponse>> responses;
+        responses.push_back(
+            HTTPResponse{.body = "Service Unavailable", .status_code = 503});
+        std::move(done_callback)(std::move(responses));
+      });
+  EXPECT_CALL(*executor, Run)
+      .WillOnce([&](absl::AnyInvocable<void()> closure) { closure(); });
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce(
+          [](absl::Duration duration, absl::AnyInvocable<void()> closure) {
+            return server_common::TaskId();
+          });
+  EXPECT_CALL(dispatcher, LoadSync).Times(0);
+
+  PeriodicCodeFetcher code_fetcher(
+      endpoints, absl::Milliseconds(3000), std::move(curl_http_fetcher),
+      dispatcher, executor.get(), absl::Milliseconds(1000), WrapCode);
+  code_fetcher.Start();
+  code_fetcher.End();
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
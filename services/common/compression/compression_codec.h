@@ -0,0 +1,45 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_COMPRESSION_COMPRESSION_CODEC_H_
+#define SERVICES_COMMON_COMPRESSION_COMPRESSION_CODEC_H_
+
+#include <cstddef>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// A compression algorithm. Implementations must be thread safe.
+class CompressionCodec {
+ public:
+  virtual ~CompressionCodec() = default;
+
+  // Compresses input.
+  virtual absl::StatusOr<std::string> Compress(
+      absl::string_view input) const = 0;
+
+  // Decompresses input. size_hint is the expected size of the decompressed
+  // data, if known, and is used to size the output up front.
+  virtual absl::StatusOr<std::string> Decompress(
+      absl::string_view input, size_t size_hint = 0) const = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_COMPRESSION_COMPRESSION_CODEC_H_
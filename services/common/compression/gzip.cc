@@ -12,107 +12,201 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+
 #include "services/common/compression/gzip.h"
 
 #include <zlib.h>
 
+#include <algorithm>
+
 #include "absl/strings/str_format.h"
-#include "glog/logging.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// The decompressed string grows by at least this much when it runs out of
+// space.
+inline constexpr size_t kMinDecompressedGrowth = 32 * 1024;  // 32 KiB.
+
+// The gzip header takes at least 10 bytes, and the trailer 8, the last 4 of
+// which are ISIZE: the size of the decompressed data modulo 2^32.
+inline constexpr size_t kMinGzipSize = 18;
+// The interest groups and requests rarely compress more than 64 times, while
+// deflate can reach 1032:1. A larger ISIZE is more likely corrupt, or set to
+// have the whole of it allocated, than right.
+inline constexpr size_t kMaxTrustedGzipRatio = 64;
+
+// A z_stream for compression that lives as long as its thread.
+class DeflateStream {
+ public:
+  DeflateStream() {
+    init_status_ =
+        deflateInit2(&stream_, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                     kGzipWindowBits, kDefaultMemLevel, Z_DEFAULT_STRATEGY);
+  }
+  ~DeflateStream() {
+    if (init_status_ == Z_OK) {
+      deflateEnd(&stream_);
+    }
+  }
 
-absl::StatusOr<std::string> GzipCompress(absl::string_view uncompressed) {
-  z_stream zs;
-  zs.zalloc = Z_NULL;
-  zs.zfree = Z_NULL;
-  zs.opaque = Z_NULL;
-  zs.avail_in = (uInt)uncompressed.size();
-  zs.next_in = (Bytef*)uncompressed.data();
-
-  int deflate_init_status =
-      deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, kGzipWindowBits | 16,
-                   kDefaultMemLevel, Z_DEFAULT_STRATEGY);
-  if (deflate_init_status != Z_OK) {
-    return absl::InternalError(
-        absl::StrFormat("Error initializing data for gzip compression (deflate "
-                        "init status: %d)",
-                        deflate_init_status));
+  // Returns the stream, reset for a new input, or nullptr if it could not be
+  // initialized.
+  z_stream* Reset() {
+    if (init_status_ != Z_OK || deflateReset(&stream_) != Z_OK) {
+      return nullptr;
+    }
+    return &stream_;
   }
 
-  // Determine the upper bound on the size of the compressed data.
-  // TODO(b/279967613): Investigate if deflate() should be done in chunks like
-  //  inflate(). Would help avoid this cpplint warning.
-  const int kPartitionSizeBound = deflateBound(&zs, uncompressed.size());
-  char partition_output_buffer[kPartitionSizeBound];
+  int init_status() const { return init_status_; }
 
-  zs.avail_out = (uInt)kPartitionSizeBound;
-  // We'll manually write the size of the compressed data manually after
-  // compressing the data.
-  zs.next_out = (Bytef*)&partition_output_buffer;
+ private:
+  z_stream stream_ = {};
+  int init_status_;
+};
 
-  const int deflate_status = deflate(&zs, Z_FINISH);
-  if (deflate_status != Z_STREAM_END) {
-    deflateEnd(&zs);
-    return absl::InternalError(absl::StrFormat(
-        "Error compressing data using gzip (deflate status: %d)",
-        deflate_status));
+// A z_stream for decompression that lives as long as its thread.
+class InflateStream {
+ public:
+  InflateStream() { init_status_ = inflateInit2(&stream_, kGzipWindowBits); }
+  ~InflateStream() {
+    if (init_status_ == Z_OK) {
+      inflateEnd(&stream_);
+    }
   }
 
-  // Free all memory held by the z_stream object.
-  const int deflate_end_status = deflateEnd(&zs);
-  if (deflate_end_status != Z_OK) {
-    return absl::InternalError(absl::StrFormat(
-        "Error closing compression data stream (deflate end status: %d)",
-        deflate_end_status));
+  // Returns the stream, reset for a new input, or nullptr if it could not be
+  // initialized.
+  z_stream* Reset() {
+    if (init_status_ != Z_OK || inflateReset(&stream_) != Z_OK) {
+      return nullptr;
+    }
+    return &stream_;
   }
 
-  return std::string{partition_output_buffer, zs.total_out};
-}
+  int init_status() const { return init_status_; }
 
-absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed) {
-  z_stream zs;
-  memset(&zs, 0, sizeof(zs));
-  zs.next_in = (Bytef*)compressed.data();
-  zs.avail_in = compressed.size();
+ private:
+  z_stream stream_ = {};
+  int init_status_;
+};
 
-  const int inflate_init_status = inflateInit2(&zs, kGzipWindowBits | 16);
-  if (inflate_init_status != Z_OK) {
+}  // namespace
+
+absl::StatusOr<std::string> GzipCodec::Compress(
+    absl::string_view input) const {
+  std::string compressed;
+  if (absl::Status status = GzipCompressAppend(input, &compressed);
+      !status.ok()) {
+    return status;
+  }
+  return compressed;
+}
+
+absl::StatusOr<std::string> GzipCodec::Decompress(absl::string_view input,
+                                                  size_t size_hint) const {
+  thread_local InflateStream inflate_stream;
+  z_stream* zs = inflate_stream.Reset();
+  if (zs == nullptr) {
     return absl::InternalError(
         absl::StrFormat("Error during gzip decompression initialization: "
                         "(inflate init status: %d)",
-                        inflate_init_status));
+                        inflate_stream.init_status()));
   }
+  zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  zs->avail_in = input.size();
 
-  char output_buffer[32768];  // 32 KiB chunks.
+  // Inflates straight into the result, growing it geometrically when the
+  // size hint is missing or too small.
+  if (size_hint == 0) {
+    size_hint = GzipDecompressedSizeHint(input);
+  }
   std::string decompressed;
-
+  decompressed.resize(size_hint > 0 ? size_hint
+                                    : std::max(kMinDecompressedGrowth,
+                                               2 * input.size()));
+  // Z_FINISH lets inflate skip copying the output to its window when all of
+  // it fits, as it does with the size from the trailer. When it does not,
+  // inflate runs out of room with Z_BUF_ERROR and goes on once grown.
   int inflate_status;
   do {
-    zs.next_out = reinterpret_cast<Bytef*>(output_buffer);
-    zs.avail_out = sizeof(output_buffer);
-
-    inflate_status = inflate(&zs, Z_NO_FLUSH);
-    // Copy the decompressed output from the buffer to our result string.
-    if (decompressed.size() < zs.total_out) {
-      decompressed.append(output_buffer, zs.total_out - decompressed.size());
+    const size_t written = zs->total_out;
+    if (written == decompressed.size()) {
+      decompressed.resize(written + std::max(kMinDecompressedGrowth, written));
     }
-  } while (inflate_status == Z_OK);
+    zs->next_out = reinterpret_cast<Bytef*>(decompressed.data() + written);
+    zs->avail_out = decompressed.size() - written;
+    inflate_status = inflate(zs, Z_FINISH);
+  } while (inflate_status == Z_OK ||
+           (inflate_status == Z_BUF_ERROR && zs->avail_out == 0));
 
   if (inflate_status != Z_STREAM_END) {
-    inflateEnd(&zs);
     return absl::DataLossError(absl::StrFormat(
         "Exception during gzip decompression: (inflate status: %d)",
         inflate_status));
   }
+  decompressed.resize(zs->total_out);
+  return decompressed;
+}
+
+size_t GzipDecompressedSizeHint(absl::string_view compressed) {
+  if (compressed.size() < kMinGzipSize) {
+    return 0;
+  }
+  const auto* isize = reinterpret_cast<const unsigned char*>(
+      compressed.data() + compressed.size() - 4);
+  const size_t size = size_t{isize[0]} | size_t{isize[1]} << 8 |
+                      size_t{isize[2]} << 16 | size_t{isize[3]} << 24;
+  if (size > kMaxTrustedGzipRatio * compressed.size()) {
+    return 0;
+  }
+  return size;
+}
+
+size_t GzipCompressBound(size_t size) {
+  // compressBound is for the 6 bytes of the zlib wrapper, the gzip one takes
+  // 18.
+  return compressBound(size) + 12;
+}
 
-  const int inflate_end_status = inflateEnd(&zs);
-  if (inflate_end_status != Z_OK) {
+absl::Status GzipCompressAppend(absl::string_view input, std::string* output) {
+  thread_local DeflateStream deflate_stream;
+  z_stream* zs = deflate_stream.Reset();
+  if (zs == nullptr) {
+    return absl::InternalError(
+        absl::StrFormat("Error initializing data for gzip compression (deflate "
+                        "init status: %d)",
+                        deflate_stream.init_status()));
+  }
+  zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+  zs->avail_in = input.size();
+
+  // deflateBound is an upper bound on the size of the compressed data, so the
+  // data is compressed with a single deflate call straight into the output.
+  const size_t offset = output->size();
+  output->resize(offset + deflateBound(zs, input.size()));
+  zs->next_out = reinterpret_cast<Bytef*>(output->data() + offset);
+  zs->avail_out = output->size() - offset;
+
+  const int deflate_status = deflate(zs, Z_FINISH);
+  if (deflate_status != Z_STREAM_END) {
+    output->resize(offset);
     return absl::InternalError(absl::StrFormat(
-        "Error closing compression data stream (inflate end status: %d(",
-        inflate_end_status));
+        "Error compressing data using gzip (deflate status: %d)",
+        deflate_status));
   }
+  output->resize(offset + zs->total_out);
+  return absl::OkStatus();
+}
 
-  return decompressed;
+absl::StatusOr<std::string> GzipCompress(absl::string_view uncompressed) {
+  return GzipCodec().Compress(uncompressed);
+}
+
+absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed,
+                                           size_t size_hint) {
+  return GzipCodec().Decompress(compressed, size_hint);
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
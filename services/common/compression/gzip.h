@@ -17,10 +17,13 @@
 #ifndef SERVICES_COMMON_CLIENTS_COMPRESSION_GZIP_H_
 #define SERVICES_COMMON_CLIENTS_COMPRESSION_GZIP_H_
 
+#include <cstddef>
 #include <string>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "services/common/compression/compression_codec.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -31,11 +34,37 @@ inline constexpr int kGzipWindowBits = 15 | 16;
 // Default to 8 as per zlib.h's documentation.
 inline constexpr int kDefaultMemLevel = 8;
 
+// Compresses to and decompresses from gzip. The z_streams are kept per thread
+// and reset between the calls, instead of being allocated and initialized for
+// each of them.
+class GzipCodec final : public CompressionCodec {
+ public:
+  absl::StatusOr<std::string> Compress(absl::string_view input) const override;
+
+  absl::StatusOr<std::string> Decompress(
+      absl::string_view input, size_t size_hint = 0) const override;
+};
+
 // Compresses a string using gzip.
 absl::StatusOr<std::string> GzipCompress(absl::string_view decompressed);
 
-// Decompresses a gzip compressed string.
-absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed);
+// Upper bound on the size of the gzip compressed data of size bytes.
+size_t GzipCompressBound(size_t size);
+
+// Compresses input using gzip and appends it to output, so that callers can
+// compress straight after a header they wrote. Reserve room for
+// GzipCompressBound(input.size()) more bytes to avoid a reallocation.
+absl::Status GzipCompressAppend(absl::string_view input, std::string* output);
+
+// Returns the size of the decompressed data of a single-member gzip string,
+// read from its ISIZE trailer, or 0 if it is missing or implausible. The
+// output of GzipDecompress is sized to it when there is no size_hint.
+size_t GzipDecompressedSizeHint(absl::string_view compressed);
+
+// Decompresses a gzip compressed string. size_hint is the expected size of
+// the decompressed string, if known, or else the one of the trailer.
+absl::StatusOr<std::string> GzipDecompress(absl::string_view compressed,
+                                           size_t size_hint = 0);
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -91,5 +91,95 @@ TEST(GzipCompressionTests, DecompressWithBoost) {
   ASSERT_EQ(payload, boost_decompress);
 }
 
+TEST(GzipCompressionTests, CompressDecompress_LargePayload) {
+  // Larger than a thread's stack, and than a decompression step.
+  std::string payload;
+  for (int i = 0; payload.size() < 16 * 1024 * 1024; ++i) {
+    payload.append(std::to_string(i));
+  }
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  absl::StatusOr<std::string> decompressed = GzipDecompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(payload, *decompressed);
+  EXPECT_EQ(payload, BoostDecompress(*compressed));
+}
+
+TEST(GzipCompressionTests, DecompressWithSizeHint) {
+  std::string payload(100000, 'a');
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  for (size_t size_hint : {size_t{1}, payload.size(), 3 * payload.size()}) {
+    absl::StatusOr<std::string> decompressed =
+        GzipDecompress(*compressed, size_hint);
+    ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+    EXPECT_EQ(payload, *decompressed);
+  }
+}
+
+TEST(GzipCompressionTests, ReadsTheSizeHintFromTheTrailer) {
+  std::string payload;
+  for (int i = 0; payload.size() < 100000; ++i) {
+    payload.append(std::to_string(i));
+  }
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+  absl::StatusOr<std::string> highly_compressed =
+      GzipCompress(std::string(100000, 'a'));
+  ASSERT_TRUE(highly_compressed.ok()) << highly_compressed.status();
+
+  EXPECT_EQ(GzipDecompressedSizeHint(*compressed), payload.size());
+  // Past the ratio interest groups compress to, the trailer is not trusted.
+  EXPECT_EQ(GzipDecompressedSizeHint(*highly_compressed), 0);
+  EXPECT_EQ(GzipDecompressedSizeHint("short"), 0);
+  absl::StatusOr<std::string> decompressed = GzipDecompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(payload, *decompressed);
+}
+
+TEST(GzipCompressionTests, DecompressWithWrongTrailerSize) {
+  std::string payload;
+  for (int i = 0; payload.size() < 100000; ++i) {
+    payload.append(std::to_string(i));
+  }
+  absl::StatusOr<std::string> compressed = GzipCompress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+  // A trailer claiming 1 byte only sizes the output, and fails the check of
+  // the stream.
+  std::string wrong_size = *compressed;
+  wrong_size.replace(wrong_size.size() - 4, 4, std::string("\x01\0\0\0", 4));
+
+  EXPECT_EQ(GzipDecompressedSizeHint(wrong_size), 1);
+  EXPECT_FALSE(GzipDecompress(wrong_size).ok());
+}
+
+TEST(GzipCompressionTests, CompressAppendKeepsThePrefix) {
+  std::string payload(100000, 'a');
+  std::string output = "header";
+  output.reserve(output.size() + GzipCompressBound(payload.size()));
+  const char* data = output.data();
+  ASSERT_TRUE(GzipCompressAppend(payload, &output).ok());
+
+  EXPECT_EQ(output.data(), data);
+  EXPECT_EQ(output.substr(0, 6), "header");
+  absl::StatusOr<std::string> decompressed = GzipDecompress(output.substr(6));
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(payload, *decompressed);
+}
+
+TEST(GzipCompressionTests, DecompressTruncatedFails) {
+  absl::StatusOr<std::string> compressed = GzipCompress("hello");
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  absl::string_view truncated(compressed->data(), compressed->size() / 2);
+  EXPECT_FALSE(GzipDecompress(truncated).ok());
+  // The stream of the thread is reset after the failure.
+  absl::StatusOr<std::string> decompressed = GzipDecompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, "hello");
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/compression/zstd.h"
+
+#include <zstd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/strings/str_format.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// First bytes of a zstd frame, the magic number 0xFD2FB528 in little endian.
+inline constexpr absl::string_view kZstdFrameMagic = "\x28\xb5\x2f\xfd";
+
+// The decompressed string grows by at least this much when it runs out of
+// space.
+inline constexpr size_t kMinDecompressedGrowth = 32 * 1024;  // 32 KiB.
+
+// The buyer inputs rarely compress more than 64 times, even with a
+// dictionary. A larger content size in the frame header, which the client
+// sets, only sizes the output up to that ratio, as for the gzip ISIZE.
+inline constexpr size_t kMaxTrustedZstdRatio = 64;
+
+// Bound on the window of the frames, and so on the memory of the decoder:
+// 8 MiB, far above the windows of frames of level 3 the size of requests.
+inline constexpr int kZstdMaxWindowLog = 23;
+
+// A compression context that lives as long as its thread.
+class CompressionContext {
+ public:
+  CompressionContext() : cctx_(ZSTD_createCCtx()) {}
+  ~CompressionContext() { ZSTD_freeCCtx(cctx_); }
+
+  ZSTD_CCtx* get() { return cctx_; }
+
+ private:
+  ZSTD_CCtx* cctx_;
+};
+
+// A decompression context that lives as long as its thread.
+class DecompressionContext {
+ public:
+  DecompressionContext() : dctx_(ZSTD_createDCtx()) {}
+  ~DecompressionContext() { ZSTD_freeDCtx(dctx_); }
+
+  // Returns the context, reset for a new frame decompressed with ddict (if
+  // not null) within a window of at most 2^kZstdMaxWindowLog bytes, or
+  // nullptr if it could not be created.
+  ZSTD_DCtx* Reset(const ZSTD_DDict* ddict) {
+    if (dctx_ == nullptr ||
+        ZSTD_isError(
+            ZSTD_DCtx_reset(dctx_, ZSTD_reset_session_and_parameters)) ||
+        ZSTD_isError(ZSTD_DCtx_setParameter(dctx_, ZSTD_d_windowLogMax,
+                                            kZstdMaxWindowLog)) ||
+        ZSTD_isError(ZSTD_DCtx_refDDict(dctx_, ddict))) {
+      return nullptr;
+    }
+    return dctx_;
+  }
+
+ private:
+  ZSTD_DCtx* dctx_;
+};
+
+}  // namespace
+
+// A dictionary, digested once for compression and once for decompression.
+struct ZstdDictionaryCodec::Dictionary {
+  ~Dictionary() {
+    ZSTD_freeCDict(cdict);
+    ZSTD_freeDDict(ddict);
+  }
+
+  uint32_t id = 0;
+  ZSTD_CDict* cdict = nullptr;
+  ZSTD_DDict* ddict = nullptr;
+};
+
+bool IsZstdFrame(absl::string_view data) {
+  return data.substr(0, kZstdFrameMagic.size()) == kZstdFrameMagic;
+}
+
+ZstdDictionaryCodec::ZstdDictionaryCodec(size_t max_decompressed_size)
+    : max_decompressed_size_(max_decompressed_size) {}
+
+ZstdDictionaryCodec::~ZstdDictionaryCodec() = default;
+
+absl::Status ZstdDictionaryCodec::AddDictionary(absl::string_view dictionary) {
+  auto digested = std::make_shared<Dictionary>();
+  digested->id = ZSTD_getDictID_fromDict(dictionary.data(), dictionary.size());
+  if (digested->id == 0) {
+    return absl::InvalidArgumentError(
+        "Not a zstd dictionary (the dictionary has no ID)");
+  }
+  digested->cdict = ZSTD_createCDict(dictionary.data(), dictionary.size(),
+                                     kZstdDictionaryCompressionLevel);
+  digested->ddict = ZSTD_createDDict(dictionary.data(), dictionary.size());
+  if (digested->cdict == nullptr || digested->ddict == nullptr) {
+    return absl::InvalidArgumentError(
+        absl::StrFormat("Malformed zstd dictionary %d", digested->id));
+  }
+  absl::MutexLock lock(&mu_);
+  dictionaries_[digested->id] = digested;
+  latest_ = std::move(digested);
+  return absl::OkStatus();
+}
+
+int ZstdDictionaryCodec::num_dictionaries() const {
+  absl::MutexLock lock(&mu_);
+  return dictionaries_.size();
+}
+
+std::shared_ptr<const ZstdDictionaryCodec::Dictionary>
+ZstdDictionaryCodec::FindDictionary(uint32_t id) const {
+  absl::MutexLock lock(&mu_);
+  auto it = dictionaries_.find(id);
+  return it == dictionaries_.end() ? nullptr : it->second;
+}
+
+absl::StatusOr<std::string> ZstdDictionaryCodec::Compress(
+    absl::string_view input) const {
+  std::shared_ptr<const Dictionary> dictionary;
+  {
+    absl::MutexLock lock(&mu_);
+    dictionary = latest_;
+  }
+  if (dictionary == nullptr) {
+    return absl::FailedPreconditionError(
+        "No zstd dictionary to compress with");
+  }
+  thread_local CompressionContext cctx;
+  if (cctx.get() == nullptr) {
+    return absl::InternalError("Error creating the zstd compression context");
+  }
+  // ZSTD_compressBound is an upper bound on the size of the frame, so the
+  // data is compressed with a single call straight into the result.
+  std::string compressed(ZSTD_compressBound(input.size()), '\0');
+  const size_t size = ZSTD_compress_usingCDict(
+      cctx.get(), compressed.data(), compressed.size(), input.data(),
+      input.size(), dictionary->cdict);
+  if (ZSTD_isError(size)) {
+    return absl::InternalError(absl::StrFormat(
+        "Error compressing data using zstd: %s", ZSTD_getErrorName(size)));
+  }
+  compressed.resize(size);
+  return compressed;
+}
+
+absl::StatusOr<std::string> ZstdDictionaryCodec::Decompress(
+    absl::string_view input, size_t size_hint) const {
+  const uint32_t dictionary_id =
+      ZSTD_getDictID_fromFrame(input.data(), input.size());
+  std::shared_ptr<const Dictionary> dictionary;
+  if (dictionary_id != 0) {
+    dictionary = FindDictionary(dictionary_id);
+    if (dictionary == nullptr) {
+      return absl::NotFoundError(
+          absl::StrFormat("Unknown zstd dictionary %d", dictionary_id));
+    }
+  }
+  thread_local DecompressionContext decompression_context;
+  ZSTD_DCtx* dctx = decompression_context.Reset(
+      dictionary == nullptr ? nullptr : dictionary->ddict);
+  if (dctx == nullptr) {
+    return absl::InternalError(
+        "Error initializing the zstd decompression context");
+  }
+
+  // The frame header usually holds the decompressed size, which is then used
+  // in place of the size hint if plausible. Frames declaring more than the
+  // bound are rejected before decompressing any of them.
+  const unsigned long long content_size =
+      ZSTD_getFrameContentSize(input.data(), input.size());
+  if (content_size != ZSTD_CONTENTSIZE_UNKNOWN &&
+      content_size != ZSTD_CONTENTSIZE_ERROR) {
+    if (content_size > max_decompressed_size_) {
+      return absl::ResourceExhaustedError(absl::StrFormat(
+          "zstd frame of %d bytes is larger than the limit of %d bytes",
+          content_size, max_decompressed_size_));
+    }
+    if (content_size <= kMaxTrustedZstdRatio * input.size()) {
+      size_hint = content_size;
+    }
+  }
+  std::string decompressed;
+  decompressed.resize(std::min(
+      max_decompressed_size_,
+      size_hint > 0 ? size_hint
+                    : std::max(kMinDecompressedGrowth, 2 * input.size())));
+  ZSTD_inBuffer in = {input.data(), input.size(), 0};
+  ZSTD_outBuffer out = {decompressed.data(), decompressed.size(), 0};
+  size_t status;
+  do {
+    if (out.pos == out.size) {
+      // Whatever the header says, the output never grows past the bound.
+      if (out.pos >= max_decompressed_size_) {
+        return absl::ResourceExhaustedError(absl::StrFormat(
+            "zstd frame decompresses past the limit of %d bytes",
+            max_decompressed_size_));
+      }
+      decompressed.resize(
+          std::min(max_decompressed_size_,
+                   out.pos + std::max(kMinDecompressedGrowth, out.pos)));
+      out.dst = decompressed.data();
+      out.size = decompressed.size();
+    }
+    status = ZSTD_decompressStream(dctx, &out, &in);
+  } while (!ZSTD_isError(status) && status != 0 &&
+           (in.pos < in.size || out.pos == out.size));
+
+  if (ZSTD_isError(status)) {
+    return absl::DataLossError(
+        absl::StrFormat("Exception during zstd decompression: %s",
+                        ZSTD_getErrorName(status)));
+  }
+  if (status != 0 || in.pos != in.size) {
+    return absl::DataLossError(
+        "Exception during zstd decompression: truncated frame or trailing "
+        "data");
+  }
+  decompressed.resize(out.pos);
+  return decompressed;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_COMPRESSION_ZSTD_H_
+#define SERVICES_COMMON_COMPRESSION_ZSTD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/compression/compression_codec.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Compression level of the zstd frames compressed with a dictionary.
+inline constexpr int kZstdDictionaryCompressionLevel = 3;
+
+// Default bound on the decompressed size of a zstd frame. The frames come
+// from clients, so frames decompressing past it are rejected.
+inline constexpr size_t kDefaultZstdMaxDecompressedSize = 32 * 1024 * 1024;
+
+// Whether data starts with the magic number of a zstd frame. Gzip data, which
+// starts with 0x1f 0x8b, never does.
+bool IsZstdFrame(absl::string_view data);
+
+// Compresses to and decompresses from zstd frames, using dictionaries trained
+// on the payloads (e.g. with `zstd --train`) so that the structure and keys
+// repeated across them are not sent in each of them.
+// Dictionaries are versioned by the ID they hold, which zstd records in the
+// header of each frame compressed with them. Frames are decompressed with the
+// dictionary of their header, so that clients may move to a new dictionary
+// while the previous ones are still added. Frames without a dictionary ID are
+// decompressed without a dictionary. The compression contexts are kept per
+// thread, and dictionaries may be added while the codec is in use.
+class ZstdDictionaryCodec final : public CompressionCodec {
+ public:
+  // max_decompressed_size: bound on the decompressed size of a frame.
+  explicit ZstdDictionaryCodec(
+      size_t max_decompressed_size = kDefaultZstdMaxDecompressedSize);
+  ~ZstdDictionaryCodec() override;
+
+  // ZstdDictionaryCodec is neither copyable nor movable.
+  ZstdDictionaryCodec(const ZstdDictionaryCodec&) = delete;
+  ZstdDictionaryCodec& operator=(const ZstdDictionaryCodec&) = delete;
+
+  // Adds a dictionary in the zstd dictionary format, replacing any dictionary
+  // with the same ID. Data is compressed with the dictionary added last.
+  // Returns an error if the dictionary is malformed or has no ID.
+  absl::Status AddDictionary(absl::string_view dictionary);
+
+  // Number of dictionaries added, by distinct ID.
+  int num_dictionaries() const;
+
+  // Compresses input with the dictionary added last. Returns an error if no
+  // dictionary was added.
+  absl::StatusOr<std::string> Compress(absl::string_view input) const override;
+
+  // Decompresses a single zstd frame with the dictionary whose ID is in its
+  // header. Returns an error if that dictionary was not added, and
+  // RESOURCE_EXHAUSTED if the frame decompresses past
+  // max_decompressed_size.
+  absl::StatusOr<std::string> Decompress(
+      absl::string_view input, size_t size_hint = 0) const override;
+
+ private:
+  struct Dictionary;
+
+  std::shared_ptr<const Dictionary> FindDictionary(uint32_t id) const;
+
+  const size_t max_decompressed_size_;
+  mutable absl::Mutex mu_;
+  absl::flat_hash_map<uint32_t, std::shared_ptr<const Dictionary>> dictionaries_
+      ABSL_GUARDED_BY(mu_);
+  std::shared_ptr<const Dictionary> latest_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_COMPRESSION_ZSTD_H_
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/compression/zstd.h"
+
+#include <zdict.h>
+#include <zstd.h>
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+#include "services/common/compression/gzip.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns an interest group like payload, whose keys repeat across i.
+std::string MakePayload(int i) {
+  return absl::StrCat(R"({"name":"interest_group_)", i,
+                      R"(","biddingSignalsKeys":["key_)", i % 7,
+                      R"(","key_)", i % 11, R"("],"adRenderIds":["ad_)", i,
+                      R"("],"browserSignals":{"joinCount":)", i % 13,
+                      R"(,"bidCount":)", i % 17, R"(,"recency":)", i * 31,
+                      R"(,"prevWins":"[]"}})");
+}
+
+// Trains a dictionary on payloads, as `zstd --train` does. Dictionaries of
+// different seeds have different IDs.
+std::string TrainDictionary(int seed) {
+  std::string samples;
+  std::vector<size_t> sample_sizes;
+  for (int i = 0; i < 1000; i++) {
+    std::string payload = MakePayload(i * seed);
+    sample_sizes.push_back(payload.size());
+    samples.append(payload);
+  }
+  std::string dictionary(4096, '\0');
+  const size_t size =
+      ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(),
+                            samples.data(), sample_sizes.data(),
+                            sample_sizes.size());
+  EXPECT_FALSE(ZDICT_isError(size)) << ZDICT_getErrorName(size);
+  dictionary.resize(ZDICT_isError(size) ? 0 : size);
+  return dictionary;
+}
+
+TEST(ZstdDictionaryCodecTest, CompressesWithTheDictionary) {
+  ZstdDictionaryCodec codec;
+  ASSERT_TRUE(codec.AddDictionary(TrainDictionary(1)).ok());
+  const std::string payload = MakePayload(12345);
+  absl::StatusOr<std::string> compressed = codec.Compress(payload);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+  EXPECT_TRUE(IsZstdFrame(*compressed));
+  // The dictionary holds what the payload shares with the others.
+  absl::StatusOr<std::string> gzipped = GzipCompress(payload);
+  ASSERT_TRUE(gzipped.ok());
+  EXPECT_FALSE(IsZstdFrame(*gzipped));
+  EXPECT_LT(compressed->size(), gzipped->size());
+
+  absl::StatusOr<std::string> decompressed = codec.Decompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, payload);
+}
+
+TEST(ZstdDictionaryCodecTest, DecompressesWithTheDictionaryOfTheFrame) {
+  ZstdDictionaryCodec old_codec;
+  ASSERT_TRUE(old_codec.AddDictionary(TrainDictionary(1)).ok());
+  ZstdDictionaryCodec codec;
+  ASSERT_TRUE(codec.AddDictionary(TrainDictionary(1)).ok());
+  ASSERT_TRUE(codec.AddDictionary(TrainDictionary(2)).ok());
+  EXPECT_EQ(codec.num_dictionaries(), 2);
+
+  // Frames compressed with the previous dictionary are still decompressed.
+  const std::string payload = MakePayload(7);
+  absl::StatusOr<std::string> compressed = old_codec.Compress(payload);
+  ASSERT_TRUE(compressed.ok());
+  absl::StatusOr<std::string> decompressed = codec.Decompress(*compressed);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, payload);
+
+  // Whereas frames of unknown dictionaries are not.
+  compressed = codec.Compress(payload);
+  ASSERT_TRUE(compressed.ok());
+  EXPECT_FALSE(old_codec.Decompress(*compressed).ok());
+}
+
+TEST(ZstdDictionaryCodecTest, RejectsFramesPastTheLimit) {
+  ZstdDictionaryCodec writer;
+  ASSERT_TRUE(writer.AddDictionary(TrainDictionary(1)).ok());
+  ZstdDictionaryCodec codec(/*max_decompressed_size=*/64 * 1024);
+  ASSERT_TRUE(codec.AddDictionary(TrainDictionary(1)).ok());
+  std::string payload;
+  for (int i = 0; payload.size() < 128 * 1024; ++i) {
+    payload.append(MakePayload(i));
+  }
+  absl::StatusOr<std::string> compressed = writer.Compress(payload);
+  ASSERT_TRUE(compressed.ok());
+
+  EXPECT_EQ(codec.Decompress(*compressed).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  // Nor are frames hiding their size, decompressed past the limit.
+  ZSTD_CCtx* cctx = ZSTD_createCCtx();
+  ASSERT_EQ(ZSTD_CCtx_setParameter(cctx, ZSTD_c_contentSizeFlag, 0), 0);
+  std::string unsized(ZSTD_compressBound(payload.size()), '\0');
+  const size_t size = ZSTD_compress2(cctx, unsized.data(), unsized.size(),
+                                     payload.data(), payload.size());
+  ZSTD_freeCCtx(cctx);
+  ASSERT_FALSE(ZSTD_isError(size));
+  unsized.resize(size);
+  EXPECT_EQ(codec.Decompress(unsized).status().code(),
+            absl::StatusCode::kResourceExhausted);
+  EXPECT_TRUE(writer.Decompress(unsized).ok());
+}
+
+TEST(ZstdDictionaryCodecTest, RejectsMalformedInputs) {
+  ZstdDictionaryCodec codec;
+  EXPECT_FALSE(codec.Compress("payload").ok());
+  EXPECT_FALSE(codec.AddDictionary("not a dictionary").ok());
+  ASSERT_TRUE(codec.AddDictionary(TrainDictionary(1)).ok());
+
+  absl::StatusOr<std::string> compressed = codec.Compress(MakePayload(3));
+  ASSERT_TRUE(compressed.ok());
+  EXPECT_FALSE(
+      codec.Decompress(absl::string_view(*compressed).substr(
+                           0, compressed->size() - 1))
+          .ok());
+  EXPECT_FALSE(codec.Decompress(absl::StrCat(*compressed, "trailing")).ok());
+  EXPECT_FALSE(codec.Decompress("\x28\xb5\x2f\xfd garbage").ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
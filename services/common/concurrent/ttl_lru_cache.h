@@ -0,0 +1,370 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_CONCURRENT_TTL_LRU_CACHE_H_
+#define SERVICES_COMMON_CONCURRENT_TTL_LRU_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/hash/hash.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Counts of the events of one or more TtlLruCache instances, e.g. all the
+// caches of a kind, for an observable gauge.
+struct CacheStats {
+  std::atomic<int64_t> hits = 0;
+  std::atomic<int64_t> negative_hits = 0;
+  std::atomic<int64_t> misses = 0;
+  std::atomic<int64_t> evictions = 0;
+
+  // Returns the number of hits, hits of cached misses, misses and evictions
+  // since the previous call.
+  absl::flat_hash_map<std::string, double> Snapshot() {
+    return {{"hit", hits.exchange(0)},
+            {"negative_hit", negative_hits.exchange(0)},
+            {"miss", misses.exchange(0)},
+            {"eviction", evictions.exchange(0)}};
+  }
+};
+
+struct TtlLruCacheOptions {
+  // The longest time a value is cached.
+  absl::Duration ttl = absl::InfiniteDuration();
+  // The longest time a key without a value is cached, usually much shorter
+  // than ttl. Such keys are not cached when 0.
+  absl::Duration miss_ttl = absl::ZeroDuration();
+  // Bounds on the bytes, as counted by the sizer of the cache, and on the
+  // number of the entries held across all shards.
+  size_t max_bytes = std::numeric_limits<size_t>::max();
+  size_t max_entries = std::numeric_limits<size_t>::max();
+  // Number of independently locked partitions of the cache. It is capped at
+  // max_entries so that every shard can hold at least one entry.
+  size_t num_shards = 16;
+  // Where the events of the cache are counted, if anywhere. Must outlive the
+  // cache.
+  CacheStats* stats = nullptr;
+};
+
+// Bytes of a cache entry: the size of strings, or else that of the type.
+struct CacheEntryBytes {
+  template <class Key, class Value>
+  size_t operator()(const Key& key, const Value* value) const {
+    return BytesOf(key) + (value == nullptr ? 0 : BytesOf(*value));
+  }
+
+  template <class T>
+  static size_t BytesOf(const T& t) {
+    if constexpr (std::is_convertible_v<const T&, absl::string_view>) {
+      return absl::string_view(t).size();
+    } else {
+      return sizeof(T);
+    }
+  }
+};
+
+// This class provides a local (in-memory), thread-safe cache bounded by both
+// bytes and entries. Keys are spread over a fixed number of shards, each
+// guarded by its own mutex, and each shard evicts its least recently used
+// entries once past its share of the bounds. Entries expire after their TTL.
+//
+// A key may also be cached as having no value (a null one), so that repeated
+// look-ups of keys known to be absent skip their backend too.
+//
+// Look-ups are heterogeneous when Hash and Eq are, as the defaults are for
+// strings, e.g. a TtlLruCache<std::string, ...> is looked up by string_view.
+template <class Key, class Value,
+          class Hash = typename absl::node_hash_map<Key, int>::hasher,
+          class Eq = typename absl::node_hash_map<Key, int>::key_equal,
+          class Sizer = CacheEntryBytes>
+class TtlLruCache {
+ public:
+  explicit TtlLruCache(const TtlLruCacheOptions& options)
+      : ttl_(options.ttl),
+        miss_ttl_(options.miss_ttl),
+        stats_(options.stats),
+        shards_(std::clamp<size_t>(options.num_shards, 1,
+                                   std::max<size_t>(options.max_entries, 1))),
+        shard_max_bytes_(options.max_bytes / shards_.size()),
+        shard_capacity_bytes_(shard_max_bytes_) {
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      shards_[i].max_entries =
+          options.max_entries / shards_.size() +
+          (i < options.max_entries % shards_.size() ? 1 : 0);
+      shards_[i].capacity_entries = shards_[i].max_entries;
+    }
+  }
+
+  // TtlLruCache is neither copyable nor movable.
+  TtlLruCache(const TtlLruCache&) = delete;
+  TtlLruCache& operator=(const TtlLruCache&) = delete;
+
+  absl::Duration ttl() const { return ttl_; }
+  absl::Duration miss_ttl() const { return miss_ttl_; }
+
+  // Returns the cached value of the key, which is null if the key is cached
+  // as having no value, or nullopt if the key is not cached or has expired.
+  // A hit marks the entry as the most recently used one of its shard.
+  template <class K>
+  std::optional<std::shared_ptr<Value>> Find(const K& key) {
+    Shard& shard = ShardFor(key);
+    absl::MutexLock lock(&shard.mu);
+    return FindLocked(shard, key);
+  }
+
+  // Returns the cached value of the key, or nullptr if there is none.
+  template <class K>
+  std::shared_ptr<Value> LookUp(const K& key) {
+    std::optional<std::shared_ptr<Value>> value = Find(key);
+    return value.has_value() ? *std::move(value) : nullptr;
+  }
+
+  // Inserts or replaces the value cached for the key, for ttl at most the
+  // ttl of the cache, or the miss_ttl if the value is null. The least
+  // recently used entries of the shard are evicted to make room, and entries
+  // larger than the share of a shard are not cached.
+  void Insert(Key key, std::shared_ptr<Value> value,
+              absl::Duration ttl = absl::InfiniteDuration()) {
+    ttl = std::min(ttl, value == nullptr ? miss_ttl_ : ttl_);
+    const size_t entry_bytes = Sizer{}(key, value.get());
+    const size_t capacity_bytes =
+        shard_capacity_bytes_.load(std::memory_order_relaxed);
+    if (ttl <= absl::ZeroDuration() || entry_bytes > capacity_bytes) {
+      return;
+    }
+    Shard& shard = ShardFor(key);
+    absl::MutexLock lock(&shard.mu);
+    if (auto it = shard.index.find(key); it != shard.index.end()) {
+      Erase(shard, it);
+    }
+    if (shard.capacity_entries == 0) {
+      return;
+    }
+    while (!shard.lru.empty() &&
+           (shard.bytes + entry_bytes > capacity_bytes ||
+            shard.index.size() >= shard.capacity_entries)) {
+      Erase(shard, shard.index.find(*shard.lru.back()));
+      Count(&CacheStats::evictions);
+    }
+    // Infinite TTLs skip reading the clock on every look-up.
+    const absl::Time expiry = ttl == absl::InfiniteDuration()
+                                  ? absl::InfiniteFuture()
+                                  : absl::Now() + ttl;
+    auto [it, inserted] = shard.index.try_emplace(
+        std::move(key), Entry{std::move(value), expiry, entry_bytes, {}});
+    shard.lru.push_front(&it->first);
+    it->second.lru = shard.lru.begin();
+    shard.bytes += entry_bytes;
+  }
+
+  // Caches the key as having no value for ttl, at most the miss_ttl of the
+  // cache.
+  void InsertMiss(Key key, absl::Duration ttl = absl::InfiniteDuration()) {
+    Insert(std::move(key), nullptr, ttl);
+  }
+
+  // Returns the cached value of the key, or else calls loader, which returns
+  // an absl::StatusOr<std::shared_ptr<Value>>, and caches its value (a null
+  // one as a miss). Concurrent calls for a key that is not cached share a
+  // single call of loader: the others wait for it, and count as misses. Its
+  // errors are returned to all of them, and are not cached.
+  //
+  // The waiting callers block, so loader should not wait on them in turn,
+  // e.g. on a thread of a pool they may be holding.
+  template <class Loader>
+  absl::StatusOr<std::shared_ptr<Value>> GetOrLoad(const Key& key,
+                                                   Loader&& loader) {
+    Shard& shard = ShardFor(key);
+    std::shared_ptr<Flight> flight;
+    bool loads = false;
+    {
+      absl::MutexLock lock(&shard.mu);
+      if (std::optional<std::shared_ptr<Value>> value =
+              FindLocked(shard, key)) {
+        return *std::move(value);
+      }
+      std::shared_ptr<Flight>& in_flight = shard.flights[key];
+      if (in_flight == nullptr) {
+        in_flight = std::make_shared<Flight>();
+        loads = true;
+      }
+      flight = in_flight;
+    }
+    if (!loads) {
+      flight->done.WaitForNotification();
+      return flight->result;
+    }
+    flight->result = std::forward<Loader>(loader)();
+    if (flight->result.ok()) {
+      Insert(key, *flight->result);
+    }
+    {
+      absl::MutexLock lock(&shard.mu);
+      shard.flights.erase(key);
+    }
+    flight->done.Notify();
+    return flight->result;
+  }
+
+  // Bytes of the entries currently cached across all shards.
+  size_t bytes() const {
+    size_t bytes = 0;
+    for (const auto& shard : shards_) {
+      absl::MutexLock lock(&shard.mu);
+      bytes += shard.bytes;
+    }
+    return bytes;
+  }
+
+  // Number of entries currently cached across all shards.
+  size_t size() const {
+    size_t size = 0;
+    for (const auto& shard : shards_) {
+      absl::MutexLock lock(&shard.mu);
+      size += shard.index.size();
+    }
+    return size;
+  }
+
+  // Shrinks, or grows back, the bounds on the bytes and the entries of the
+  // cache to max_bytes and max_entries times scale, in [0, 1], evicting the
+  // least recently used entries past them. Used to give memory back under
+  // memory pressure.
+  void SetCapacityScale(double scale) {
+    scale = std::clamp(scale, 0.0, 1.0);
+    const size_t capacity_bytes = Scaled(shard_max_bytes_, scale);
+    shard_capacity_bytes_.store(capacity_bytes, std::memory_order_relaxed);
+    for (auto& shard : shards_) {
+      absl::MutexLock lock(&shard.mu);
+      shard.capacity_entries = Scaled(shard.max_entries, scale);
+      while (!shard.lru.empty() &&
+             (shard.bytes > capacity_bytes ||
+              shard.index.size() > shard.capacity_entries)) {
+        Erase(shard, shard.index.find(*shard.lru.back()));
+        Count(&CacheStats::evictions);
+      }
+    }
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<Value> value;
+    absl::Time expiry;
+    size_t bytes;
+    // Position of the key in the recency list of the shard.
+    typename std::list<const Key*>::iterator lru;
+  };
+
+  // A call of the loader of GetOrLoad, shared by the concurrent callers.
+  struct Flight {
+    absl::Notification done;
+    absl::StatusOr<std::shared_ptr<Value>> result;
+  };
+
+  using Index = absl::node_hash_map<Key, Entry, Hash, Eq>;
+
+  struct Shard {
+    mutable absl::Mutex mu;
+    size_t max_entries = 0;
+    // max_entries under the capacity scale.
+    size_t capacity_entries ABSL_GUARDED_BY(mu) = 0;
+    size_t bytes ABSL_GUARDED_BY(mu) = 0;
+    // The keys owned by the index, most recently used first.
+    std::list<const Key*> lru ABSL_GUARDED_BY(mu);
+    Index index ABSL_GUARDED_BY(mu);
+    absl::flat_hash_map<Key, std::shared_ptr<Flight>, Hash, Eq> flights
+        ABSL_GUARDED_BY(mu);
+  };
+
+  template <class K>
+  Shard& ShardFor(const K& key) {
+    // Rehashed, as the index of the shard hashes the key the same way.
+    return shards_[absl::HashOf(Hash{}(key)) % shards_.size()];
+  }
+
+  template <class K>
+  std::optional<std::shared_ptr<Value>> FindLocked(Shard& shard,
+                                                   const K& key)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    auto it = shard.index.find(key);
+    if (it == shard.index.end()) {
+      Count(&CacheStats::misses);
+      return std::nullopt;
+    }
+    if (it->second.expiry != absl::InfiniteFuture() &&
+        it->second.expiry <= absl::Now()) {
+      Erase(shard, it);
+      Count(&CacheStats::misses);
+      return std::nullopt;
+    }
+    Count(it->second.value == nullptr ? &CacheStats::negative_hits
+                                      : &CacheStats::hits);
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+    return it->second.value;
+  }
+
+  static void Erase(Shard& shard, typename Index::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mu) {
+    shard.bytes -= it->second.bytes;
+    shard.lru.erase(it->second.lru);
+    shard.index.erase(it);
+  }
+
+  static size_t Scaled(size_t bound, double scale) {
+    // The unbounded stay unbounded, as the product may not fit a size_t.
+    return bound >= std::numeric_limits<size_t>::max() / 2
+               ? bound
+               : static_cast<size_t>(static_cast<double>(bound) * scale);
+  }
+
+  void Count(std::atomic<int64_t> CacheStats::*counter) {
+    if (stats_ != nullptr) {
+      (stats_->*counter).fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+
+  const absl::Duration ttl_;
+  const absl::Duration miss_ttl_;
+  CacheStats* const stats_;
+  std::vector<Shard> shards_;
+  const size_t shard_max_bytes_;
+  // Share of a shard under the capacity scale, at most shard_max_bytes_.
+  std::atomic<size_t> shard_capacity_bytes_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_CONCURRENT_TTL_LRU_CACHE_H_
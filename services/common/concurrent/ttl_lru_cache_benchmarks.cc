@@ -0,0 +1,93 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Contention benchmark of TtlLruCache.
+//
+// BM_LookUp has each thread look up keys of a cache holding all of them, and
+// BM_LookUpOrInsert keys of which only half fit, inserting the missing ones,
+// as the Key-Value caches do under load, for 1 to 64 threads at once.
+// items_per_second is the number of look-ups by all the threads, so it grows
+// with them as long as they do not contend on the locks of the shards.
+//
+// Run with:
+//   bazel run -c opt //services/common/concurrent:ttl_lru_cache_benchmarks
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "benchmark/benchmark.h"
+#include "services/common/concurrent/ttl_lru_cache.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using BenchmarkCache = TtlLruCache<std::string, const std::string>;
+
+constexpr int kNumKeys = 1 << 14;
+
+const std::vector<std::string>& Keys() {
+  static const auto* keys = []() {
+    auto* keys = new std::vector<std::string>();
+    for (int i = 0; i < kNumKeys; ++i) {
+      keys->push_back(absl::StrCat("renderUrls:https://ad.example/", i));
+    }
+    return keys;
+  }();
+  return *keys;
+}
+
+// Returns a cache of the keys, sized to hold the given share of them.
+BenchmarkCache* GetBenchmarkCache(size_t num_keys_held) {
+  auto* cache = new BenchmarkCache({.ttl = absl::Hours(1),
+                                    .max_entries = num_keys_held,
+                                    .num_shards = 16});
+  for (const std::string& key : Keys()) {
+    cache->Insert(key, std::make_shared<const std::string>("[1,2,3]"));
+  }
+  return cache;
+}
+
+void BM_LookUp(benchmark::State& state) {
+  static BenchmarkCache* cache = GetBenchmarkCache(kNumKeys);
+  // Threads start at different keys, so that they spread over the shards.
+  int next = state.thread_index() * 7919;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cache->LookUp(Keys()[next % kNumKeys]));
+    ++next;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookUp)->ThreadRange(1, 64)->UseRealTime();
+
+void BM_LookUpOrInsert(benchmark::State& state) {
+  static BenchmarkCache* cache = GetBenchmarkCache(kNumKeys / 2);
+  int next = state.thread_index() * 7919;
+  for (auto _ : state) {
+    const std::string& key = Keys()[next % kNumKeys];
+    if (cache->LookUp(key) == nullptr) {
+      cache->Insert(key, std::make_shared<const std::string>("[1,2,3]"));
+    }
+    ++next;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LookUpOrInsert)->ThreadRange(1, 64)->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -0,0 +1,214 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/concurrent/ttl_lru_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::Pointee;
+using ::testing::UnorderedElementsAre;
+
+using StringCache = TtlLruCache<std::string, const std::string>;
+
+std::shared_ptr<const std::string> Value(std::string value) {
+  return std::make_shared<const std::string>(std::move(value));
+}
+
+TEST(TtlLruCacheTest, ReturnsInsertedValues) {
+  StringCache cache({});
+  EXPECT_EQ(cache.Find("key"), std::nullopt);
+
+  cache.Insert("key", Value("value"));
+
+  EXPECT_THAT(cache.LookUp(absl::string_view("key")),
+              Pointee(std::string("value")));
+  EXPECT_EQ(cache.size(), 1);
+  EXPECT_EQ(cache.bytes(), 8);
+}
+
+TEST(TtlLruCacheTest, ExpiresEntries) {
+  StringCache cache({.ttl = absl::Minutes(1)});
+
+  cache.Insert("short", Value("1"), absl::Milliseconds(1));
+  cache.Insert("long", Value("2"), absl::Hours(1));
+  cache.Insert("not_cached", Value("3"), absl::ZeroDuration());
+  absl::SleepFor(absl::Milliseconds(10));
+
+  EXPECT_EQ(cache.LookUp("short"), nullptr);
+  EXPECT_THAT(cache.LookUp("long"), Pointee(std::string("2")));
+  EXPECT_EQ(cache.LookUp("not_cached"), nullptr);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(TtlLruCacheTest, CachesMissesForTheMissTtl) {
+  StringCache cache({.miss_ttl = absl::Milliseconds(1)});
+  StringCache no_misses({});
+
+  cache.InsertMiss("key");
+  no_misses.InsertMiss("key");
+
+  EXPECT_THAT(cache.Find("key"), testing::Optional(nullptr));
+  EXPECT_EQ(no_misses.Find("key"), std::nullopt);
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(cache.Find("key"), std::nullopt);
+}
+
+TEST(TtlLruCacheTest, EvictsLeastRecentlyUsedEntriesOverTheBytes) {
+  StringCache cache({.max_bytes = 30, .num_shards = 1});
+  cache.Insert("key0", Value("value"));
+  cache.Insert("key1", Value("value"));
+  cache.Insert("key2", Value("value"));
+  // Touching key0 leaves key1 as the least recently used entry.
+  cache.LookUp("key0");
+  cache.Insert("key3", Value("value"));
+
+  EXPECT_NE(cache.LookUp("key0"), nullptr);
+  EXPECT_EQ(cache.LookUp("key1"), nullptr);
+  EXPECT_NE(cache.LookUp("key3"), nullptr);
+  EXPECT_EQ(cache.bytes(), 27);
+}
+
+TEST(TtlLruCacheTest, EvictsLeastRecentlyUsedEntriesOverTheCount) {
+  TtlLruCache<int, int> cache({.max_entries = 16, .num_shards = 4});
+
+  for (int i = 0; i < 1000; ++i) {
+    cache.Insert(i, std::make_shared<int>(i));
+  }
+
+  EXPECT_LE(cache.size(), 16);
+  EXPECT_THAT(cache.LookUp(999), Pointee(999));
+}
+
+TEST(TtlLruCacheTest, ShrinksToTheCapacityScale) {
+  StringCache cache({.max_bytes = 40, .num_shards = 1});
+  for (const char* key : {"key0", "key1", "key2", "key3"}) {
+    cache.Insert(key, Value("value"));
+  }
+
+  cache.SetCapacityScale(0.5);
+
+  EXPECT_EQ(cache.bytes(), 18);
+  EXPECT_NE(cache.LookUp("key3"), nullptr);
+  EXPECT_EQ(cache.LookUp("key0"), nullptr);
+  cache.Insert("large", Value("larger than the scaled shard"));
+  EXPECT_EQ(cache.LookUp("large"), nullptr);
+}
+
+TEST(TtlLruCacheTest, ScalesTheEntryBoundToo) {
+  StringCache cache({.max_entries = 4, .num_shards = 1});
+  for (const char* key : {"key0", "key1", "key2", "key3"}) {
+    cache.Insert(key, Value("value"));
+  }
+
+  cache.SetCapacityScale(0.5);
+  EXPECT_EQ(cache.size(), 2);
+  cache.Insert("key4", Value("value"));
+  EXPECT_EQ(cache.size(), 2);
+
+  cache.SetCapacityScale(0);
+  EXPECT_EQ(cache.size(), 0);
+  cache.Insert("key5", Value("value"));
+  EXPECT_EQ(cache.LookUp("key5"), nullptr);
+
+  cache.SetCapacityScale(1);
+  cache.Insert("key5", Value("value"));
+  EXPECT_NE(cache.LookUp("key5"), nullptr);
+}
+
+TEST(TtlLruCacheTest, CountsHitsMissesAndEvictions) {
+  CacheStats stats;
+  StringCache cache({.miss_ttl = absl::Minutes(1),
+                     .max_entries = 2,
+                     .num_shards = 1,
+                     .stats = &stats});
+  cache.Insert("a", Value("1"));
+  cache.Insert("b", Value("2"));
+  cache.InsertMiss("c");
+  cache.LookUp("b");
+  cache.LookUp("c");
+  cache.LookUp("a");
+
+  EXPECT_THAT(stats.Snapshot(),
+              UnorderedElementsAre(Pair("hit", 1), Pair("negative_hit", 1),
+                                   Pair("miss", 1), Pair("eviction", 1)));
+  EXPECT_THAT(stats.Snapshot(),
+              UnorderedElementsAre(Pair("hit", 0), Pair("negative_hit", 0),
+                                   Pair("miss", 0), Pair("eviction", 0)));
+}
+
+TEST(TtlLruCacheTest, LoadsMissingEntriesOnce) {
+  StringCache cache({});
+  absl::Notification loading;
+  absl::Notification release;
+  std::atomic<int> loads = 0;
+  auto loader = [&]() -> absl::StatusOr<std::shared_ptr<const std::string>> {
+    ++loads;
+    loading.Notify();
+    release.WaitForNotification();
+    return Value("loaded");
+  };
+
+  std::vector<std::thread> threads;
+  std::vector<std::shared_ptr<const std::string>> values(8);
+  threads.emplace_back([&]() { values[0] = *cache.GetOrLoad("key", loader); });
+  loading.WaitForNotification();
+  for (int i = 1; i < 8; ++i) {
+    threads.emplace_back(
+        [&, i]() { values[i] = *cache.GetOrLoad("key", loader); });
+  }
+  absl::SleepFor(absl::Milliseconds(10));
+  release.Notify();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(loads, 1);
+  for (const auto& value : values) {
+    EXPECT_THAT(value, Pointee(std::string("loaded")));
+  }
+  EXPECT_THAT(cache.LookUp("key"), Pointee(std::string("loaded")));
+}
+
+TEST(TtlLruCacheTest, DoesNotCacheLoadErrors) {
+  StringCache cache({});
+
+  EXPECT_EQ(cache
+                .GetOrLoad("key",
+                           []() -> absl::StatusOr<
+                                    std::shared_ptr<const std::string>> {
+                             return absl::UnavailableError("down");
+                           })
+                .status()
+                .code(),
+            absl::StatusCode::kUnavailable);
+  EXPECT_EQ(cache.Find("key"), std::nullopt);
+  EXPECT_THAT(*cache.GetOrLoad("key", []() { return Value("up"); }),
+              Pointee(std::string("up")));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
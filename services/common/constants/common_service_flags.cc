@@ -83,3 +83,44 @@ ABSL_FLAG(std::optional<bool>, enable_otel_based_logging, false,
           "debugging.");
 ABSL_FLAG(std::optional<bool>, enable_protected_app_signals, false,
           "Enables the protected app signals support.");
+ABSL_FLAG(std::optional<bool>, enable_boringssl_crypto, false,
+          "Whether the requests and responses between the servers are "
+          "encrypted and decrypted with BoringSSL directly rather than through "
+          "the CPIO crypto client.");
+ABSL_FLAG(std::optional<int>, malloc_arena_max, 0,
+          "Max number of malloc arenas, which the threads allocate in. Fewer "
+          "arenas leave less memory free in each. 0 keeps the default of 8 "
+          "per core.");
+ABSL_FLAG(std::optional<int>, heap_release_interval_ms, 0,
+          "How often the free heap memory is released to the OS while the "
+          "server is quiet. 0 never releases it.");
+ABSL_FLAG(std::optional<int>, grpc_server_max_threads, 0,
+          "Max threads of the resource quota of the gRPC server. 0 defaults "
+          "to 4 per CPU.");
+ABSL_FLAG(std::optional<int>, grpc_server_memory_quota_mb, 0,
+          "Memory of the resource quota of the gRPC server, in MB. 0 leaves "
+          "it unlimited.");
+ABSL_FLAG(std::optional<int>, grpc_server_num_cqs, 0,
+          "Completion queues polled by the synchronous services of the gRPC "
+          "server, e.g. health checks. 0 defaults to one per CPU.");
+ABSL_FLAG(std::optional<int>, grpc_max_concurrent_streams, 0,
+          "Max concurrent streams of each connection to the gRPC server. 0 "
+          "keeps the gRPC default.");
+ABSL_FLAG(std::optional<bool>, enable_concurrency_limiter, false,
+          "Shed the requests past a concurrency limit that adapts to their "
+          "latency, failing them with RESOURCE_EXHAUSTED.");
+ABSL_FLAG(std::optional<int>, concurrency_limit_max, 1000,
+          "Max concurrency limit of the requests, if the concurrency limiter "
+          "is enabled.");
+ABSL_FLAG(std::optional<std::string>, memory_pressure_watermarks, "",
+          "Percentages of the memory limit past which the server shrinks its "
+          "caches, lowers its concurrency, then sheds the new requests, e.g. "
+          "\"80,88,95\". Empty never degrades the server.");
+ABSL_FLAG(std::optional<int>, request_memory_budget_mb, 0,
+          "Memory a single request may take for its decrypted payload and the "
+          "data fetched or built for it, in MB. Requests over it are rejected "
+          "or trimmed, failing with RESOURCE_EXHAUSTED if nothing is left. 0 "
+          "leaves them unlimited.");
+ABSL_FLAG(std::optional<int>, profiling_port, 0,
+          "Port of the profiling service, apart from the serving port. "
+          "Required if the telemetry config enables profiling.");
@@ -54,6 +54,18 @@ ABSL_DECLARE_FLAG(std::optional<std::string>, collector_endpoint);
 ABSL_DECLARE_FLAG(std::optional<std::string>, consented_debug_token);
 ABSL_DECLARE_FLAG(std::optional<bool>, enable_otel_based_logging);
 ABSL_DECLARE_FLAG(std::optional<bool>, enable_protected_app_signals);
+ABSL_DECLARE_FLAG(std::optional<bool>, enable_boringssl_crypto);
+ABSL_DECLARE_FLAG(std::optional<int>, malloc_arena_max);
+ABSL_DECLARE_FLAG(std::optional<int>, heap_release_interval_ms);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_server_max_threads);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_server_memory_quota_mb);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_server_num_cqs);
+ABSL_DECLARE_FLAG(std::optional<int>, grpc_max_concurrent_streams);
+ABSL_DECLARE_FLAG(std::optional<bool>, enable_concurrency_limiter);
+ABSL_DECLARE_FLAG(std::optional<int>, concurrency_limit_max);
+ABSL_DECLARE_FLAG(std::optional<std::string>, memory_pressure_watermarks);
+ABSL_DECLARE_FLAG(std::optional<int>, request_memory_budget_mb);
+ABSL_DECLARE_FLAG(std::optional<int>, profiling_port);
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -91,6 +103,22 @@ inline constexpr char CONSENTED_DEBUG_TOKEN[] = "CONSENTED_DEBUG_TOKEN";
 inline constexpr char ENABLE_OTEL_BASED_LOGGING[] = "ENABLE_OTEL_BASED_LOGGING";
 inline constexpr char ENABLE_PROTECTED_APP_SIGNALS[] =
     "ENABLE_PROTECTED_APP_SIGNALS";
+inline constexpr char ENABLE_BORINGSSL_CRYPTO[] = "ENABLE_BORINGSSL_CRYPTO";
+inline constexpr char MALLOC_ARENA_MAX[] = "MALLOC_ARENA_MAX";
+inline constexpr char HEAP_RELEASE_INTERVAL_MS[] = "HEAP_RELEASE_INTERVAL_MS";
+inline constexpr char GRPC_SERVER_MAX_THREADS[] = "GRPC_SERVER_MAX_THREADS";
+inline constexpr char GRPC_SERVER_MEMORY_QUOTA_MB[] =
+    "GRPC_SERVER_MEMORY_QUOTA_MB";
+inline constexpr char GRPC_SERVER_NUM_CQS[] = "GRPC_SERVER_NUM_CQS";
+inline constexpr char GRPC_MAX_CONCURRENT_STREAMS[] =
+    "GRPC_MAX_CONCURRENT_STREAMS";
+inline constexpr char ENABLE_CONCURRENCY_LIMITER[] =
+    "ENABLE_CONCURRENCY_LIMITER";
+inline constexpr char CONCURRENCY_LIMIT_MAX[] = "CONCURRENCY_LIMIT_MAX";
+inline constexpr char MEMORY_PRESSURE_WATERMARKS[] =
+    "MEMORY_PRESSURE_WATERMARKS";
+inline constexpr char REQUEST_MEMORY_BUDGET_MB[] = "REQUEST_MEMORY_BUDGET_MB";
+inline constexpr char PROFILING_PORT[] = "PROFILING_PORT";
 
 inline constexpr absl::string_view kCommonServiceFlags[] = {
     ENABLE_ENCRYPTION,
@@ -113,7 +141,19 @@ inline constexpr absl::string_view kCommonServiceFlags[] = {
     COLLECTOR_ENDPOINT,
     CONSENTED_DEBUG_TOKEN,
     ENABLE_OTEL_BASED_LOGGING,
-    ENABLE_PROTECTED_APP_SIGNALS};
+    ENABLE_PROTECTED_APP_SIGNALS,
+    ENABLE_BORINGSSL_CRYPTO,
+    MALLOC_ARENA_MAX,
+    HEAP_RELEASE_INTERVAL_MS,
+    GRPC_SERVER_MAX_THREADS,
+    GRPC_SERVER_MEMORY_QUOTA_MB,
+    GRPC_SERVER_NUM_CQS,
+    GRPC_MAX_CONCURRENT_STREAMS,
+    ENABLE_CONCURRENCY_LIMITER,
+    CONCURRENCY_LIMIT_MAX,
+    MEMORY_PRESSURE_WATERMARKS,
+    REQUEST_MEMORY_BUDGET_MB,
+    PROFILING_PORT};
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 
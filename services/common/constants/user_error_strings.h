@@ -25,6 +25,8 @@ inline constexpr char kEmptyCiphertextError[] =
     "request_ciphertext must be non-null.";
 inline constexpr char kInvalidKeyIdError[] = "Invalid key_id.";
 inline constexpr char kMalformedCiphertext[] = "Malformed request ciphertext.";
+inline constexpr char kMalformedCompressedBuyerInput[] =
+    "Malformed compressed buyer input.";
 
 inline constexpr char kInternalServerError[] = "Internal server error.";
 
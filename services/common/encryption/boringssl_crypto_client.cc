@@ -0,0 +1,335 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/encryption/boringssl_crypto_client.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_format.h"
+#include "glog/logging.h"
+#include "openssl/aead.h"
+#include "openssl/curve25519.h"
+#include "openssl/rand.h"
+#include "services/common/encryption/crypto_client_wrapper.h"
+#include "services/common/util/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+using ::google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+
+namespace {
+
+// Length of the secret exported from the HPKE context, as
+// SECRET_LENGTH_32_BYTES with the CPIO crypto client.
+inline constexpr size_t kSecretLength = 32;
+
+const EVP_HPKE_KEM* Kem() { return EVP_hpke_x25519_hkdf_sha256(); }
+const EVP_HPKE_KDF* Kdf() { return EVP_hpke_hkdf_sha256(); }
+const EVP_HPKE_AEAD* HpkeAead() { return EVP_hpke_aes_256_gcm(); }
+const EVP_AEAD* Aead() { return EVP_aead_aes_256_gcm(); }
+
+const uint8_t* ToBytes(absl::string_view data) {
+  return reinterpret_cast<const uint8_t*>(data.data());
+}
+
+uint8_t* ToBytes(std::string& data) {
+  return reinterpret_cast<uint8_t*>(data.data());
+}
+
+absl::Status OperationError(absl::string_view operation) {
+  LOG(ERROR) << absl::StrFormat(kCryptoOperationFailureError, operation,
+                                "BoringSSL");
+  return absl::InternalError(absl::StrFormat("%s failed", operation));
+}
+
+absl::Status ExportSecret(const EVP_HPKE_CTX* context, std::string& secret) {
+  secret.resize(kSecretLength);
+  constexpr absl::string_view exporter_context = kHpkeExporterContext;
+  if (!EVP_HPKE_CTX_export(context, ToBytes(secret), secret.size(),
+                           ToBytes(exporter_context),
+                           exporter_context.size())) {
+    return absl::InternalError("Failed to export the HPKE secret");
+  }
+  return absl::OkStatus();
+}
+
+// The public keys of the key fetcher are base64 encoded.
+absl::StatusOr<std::string> DecodePublicKey(const PublicKey& key) {
+  std::string public_key;
+  if (!absl::Base64Unescape(key.public_key(), &public_key)) {
+    return absl::InvalidArgumentError("Invalid HPKE public key encoding");
+  }
+  return public_key;
+}
+
+}  // namespace
+
+absl::StatusOr<std::shared_ptr<const BoringSslCryptoClient::HpkeKey>>
+BoringSslCryptoClient::GetHpkeKey(
+    const server_common::PrivateKey& private_key) {
+  absl::MutexLock lock(&mu_);
+  std::shared_ptr<const HpkeKey>& key = keys_[private_key.key_id];
+  if (key == nullptr || key->private_key != private_key.private_key) {
+    auto new_key = std::make_shared<HpkeKey>();
+    if (!EVP_HPKE_KEY_init(new_key->key.get(), Kem(),
+                           ToBytes(private_key.private_key),
+                           private_key.private_key.size())) {
+      keys_.erase(private_key.key_id);
+      return absl::InvalidArgumentError("Invalid HPKE private key");
+    }
+    new_key->private_key = private_key.private_key;
+    key = std::move(new_key);
+  }
+  return key;
+}
+
+absl::Status BoringSslCryptoClient::HpkeDecrypt(
+    const server_common::PrivateKey& private_key, absl::string_view ciphertext,
+    std::string& payload, std::string& secret) {
+  PS_ASSIGN_OR_RETURN(std::shared_ptr<const HpkeKey> key,
+                      GetHpkeKey(private_key));
+  // The ciphertext is the encapsulated key followed by the sealed payload.
+  if (ciphertext.size() < X25519_PUBLIC_VALUE_LEN) {
+    return absl::InvalidArgumentError("HPKE ciphertext too short");
+  }
+  const absl::string_view encapsulated_key =
+      ciphertext.substr(0, X25519_PUBLIC_VALUE_LEN);
+  const absl::string_view sealed = ciphertext.substr(X25519_PUBLIC_VALUE_LEN);
+  constexpr absl::string_view info = kSharedInfo;
+
+  bssl::ScopedEVP_HPKE_CTX context;
+  if (!EVP_HPKE_CTX_setup_recipient(
+          context.get(), key->key.get(), Kdf(), HpkeAead(),
+          ToBytes(encapsulated_key), encapsulated_key.size(), ToBytes(info),
+          info.size())) {
+    return OperationError(kHpkeDecrypt);
+  }
+  payload.resize(sealed.size());
+  size_t payload_length;
+  if (!EVP_HPKE_CTX_open(context.get(), ToBytes(payload), &payload_length,
+                         payload.size(), ToBytes(sealed), sealed.size(),
+                         /*ad=*/nullptr, /*ad_len=*/0)) {
+    return OperationError(kHpkeDecrypt);
+  }
+  payload.resize(payload_length);
+  return ExportSecret(context.get(), secret);
+}
+
+absl::Status BoringSslCryptoClient::SealHpke(absl::string_view public_key,
+                                             size_t length, std::string& buffer,
+                                             std::string& secret) {
+  DCHECK_GE(buffer.size(), X25519_PUBLIC_VALUE_LEN + length +
+                               EVP_AEAD_max_overhead(
+                                   EVP_HPKE_AEAD_aead(HpkeAead())));
+  constexpr absl::string_view info = kSharedInfo;
+  bssl::ScopedEVP_HPKE_CTX context;
+  size_t encapsulated_key_length;
+  if (!EVP_HPKE_CTX_setup_sender(context.get(), ToBytes(buffer),
+                                 &encapsulated_key_length,
+                                 X25519_PUBLIC_VALUE_LEN, Kem(), Kdf(),
+                                 HpkeAead(), ToBytes(public_key),
+                                 public_key.size(), ToBytes(info),
+                                 info.size())) {
+    return OperationError(kHpkeEncrypt);
+  }
+  DCHECK_EQ(encapsulated_key_length, X25519_PUBLIC_VALUE_LEN);
+  // BoringSSL seals in place when the input and the output are the same.
+  uint8_t* plaintext = ToBytes(buffer) + X25519_PUBLIC_VALUE_LEN;
+  size_t sealed_length;
+  if (!EVP_HPKE_CTX_seal(context.get(), plaintext, &sealed_length,
+                         buffer.size() - X25519_PUBLIC_VALUE_LEN, plaintext,
+                         length, /*ad=*/nullptr, /*ad_len=*/0)) {
+    return OperationError(kHpkeEncrypt);
+  }
+  buffer.resize(X25519_PUBLIC_VALUE_LEN + sealed_length);
+  return ExportSecret(context.get(), secret);
+}
+
+absl::Status BoringSslCryptoClient::HpkeEncrypt(
+    absl::string_view public_key, absl::string_view plaintext_payload,
+    std::string& ciphertext, std::string& secret) {
+  ciphertext.resize(X25519_PUBLIC_VALUE_LEN + plaintext_payload.size() +
+                    EVP_AEAD_max_overhead(EVP_HPKE_AEAD_aead(HpkeAead())));
+  plaintext_payload.copy(ciphertext.data() + X25519_PUBLIC_VALUE_LEN,
+                         plaintext_payload.size());
+  return SealHpke(public_key, plaintext_payload.size(), ciphertext, secret);
+}
+
+absl::Status BoringSslCryptoClient::AeadEncrypt(
+    absl::string_view plaintext_payload, absl::string_view secret,
+    std::string& ciphertext) {
+  bssl::ScopedEVP_AEAD_CTX context;
+  if (!EVP_AEAD_CTX_init(context.get(), Aead(), ToBytes(secret), secret.size(),
+                         EVP_AEAD_DEFAULT_TAG_LENGTH, /*impl=*/nullptr)) {
+    return absl::InvalidArgumentError("Invalid AEAD secret");
+  }
+  // The ciphertext is the nonce followed by the sealed payload and its tag.
+  const size_t nonce_length = EVP_AEAD_nonce_length(Aead());
+  ciphertext.resize(nonce_length + plaintext_payload.size() +
+                    EVP_AEAD_max_overhead(Aead()));
+  RAND_bytes(ToBytes(ciphertext), nonce_length);
+  constexpr absl::string_view associated_data = kSharedInfo;
+  size_t sealed_length;
+  if (!EVP_AEAD_CTX_seal(context.get(), ToBytes(ciphertext) + nonce_length,
+                         &sealed_length, ciphertext.size() - nonce_length,
+                         ToBytes(ciphertext), nonce_length,
+                         ToBytes(plaintext_payload), plaintext_payload.size(),
+                         ToBytes(associated_data), associated_data.size())) {
+    return OperationError(kAeadEncrypt);
+  }
+  ciphertext.resize(nonce_length + sealed_length);
+  return absl::OkStatus();
+}
+
+absl::Status BoringSslCryptoClient::AeadDecrypt(absl::string_view ciphertext,
+                                                absl::string_view secret,
+                                                std::string& payload) {
+  bssl::ScopedEVP_AEAD_CTX context;
+  if (!EVP_AEAD_CTX_init(context.get(), Aead(), ToBytes(secret), secret.size(),
+                         EVP_AEAD_DEFAULT_TAG_LENGTH, /*impl=*/nullptr)) {
+    return absl::InvalidArgumentError("Invalid AEAD secret");
+  }
+  const size_t nonce_length = EVP_AEAD_nonce_length(Aead());
+  if (ciphertext.size() < nonce_length) {
+    return absl::InvalidArgumentError("AEAD ciphertext too short");
+  }
+  const absl::string_view sealed = ciphertext.substr(nonce_length);
+  constexpr absl::string_view associated_data = kSharedInfo;
+  payload.resize(sealed.size());
+  size_t payload_length;
+  if (!EVP_AEAD_CTX_open(context.get(), ToBytes(payload), &payload_length,
+                         payload.size(), ToBytes(ciphertext), nonce_length,
+                         ToBytes(sealed), sealed.size(),
+                         ToBytes(associated_data), associated_data.size())) {
+    return OperationError(kAeadDecrypt);
+  }
+  payload.resize(payload_length);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> BoringSslCryptoClient::HpkeEncryptMessage(
+    const PublicKey& key, const google::protobuf::MessageLite& message,
+    std::string& ciphertext) noexcept {
+  PS_ASSIGN_OR_RETURN(std::string public_key, DecodePublicKey(key));
+  const size_t length = message.ByteSizeLong();
+  ciphertext.resize(X25519_PUBLIC_VALUE_LEN + length +
+                    EVP_AEAD_max_overhead(EVP_HPKE_AEAD_aead(HpkeAead())));
+  message.SerializeWithCachedSizesToArray(ToBytes(ciphertext) +
+                                          X25519_PUBLIC_VALUE_LEN);
+  std::string secret;
+  PS_RETURN_IF_ERROR(SealHpke(public_key, length, ciphertext, secret));
+  return secret;
+}
+
+absl::Status BoringSslCryptoClient::AeadEncryptMessage(
+    const google::protobuf::MessageLite& message, const std::string& secret,
+    std::string& ciphertext) noexcept {
+  bssl::ScopedEVP_AEAD_CTX context;
+  if (!EVP_AEAD_CTX_init(context.get(), Aead(), ToBytes(secret), secret.size(),
+                         EVP_AEAD_DEFAULT_TAG_LENGTH, /*impl=*/nullptr)) {
+    return absl::InvalidArgumentError("Invalid AEAD secret");
+  }
+  const size_t nonce_length = EVP_AEAD_nonce_length(Aead());
+  const size_t length = message.ByteSizeLong();
+  ciphertext.resize(nonce_length + length + EVP_AEAD_max_overhead(Aead()));
+  RAND_bytes(ToBytes(ciphertext), nonce_length);
+  uint8_t* payload = ToBytes(ciphertext) + nonce_length;
+  message.SerializeWithCachedSizesToArray(payload);
+  constexpr absl::string_view associated_data = kSharedInfo;
+  // BoringSSL seals in place when the input and the output are the same.
+  size_t sealed_length;
+  if (!EVP_AEAD_CTX_seal(context.get(), payload, &sealed_length,
+                         ciphertext.size() - nonce_length, ToBytes(ciphertext),
+                         nonce_length, payload, length,
+                         ToBytes(associated_data), associated_data.size())) {
+    return OperationError(kAeadEncrypt);
+  }
+  ciphertext.resize(nonce_length + sealed_length);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<absl::string_view> BoringSslCryptoClient::AeadDecryptInPlace(
+    std::string& ciphertext, const std::string& secret) noexcept {
+  bssl::ScopedEVP_AEAD_CTX context;
+  if (!EVP_AEAD_CTX_init(context.get(), Aead(), ToBytes(secret), secret.size(),
+                         EVP_AEAD_DEFAULT_TAG_LENGTH, /*impl=*/nullptr)) {
+    return absl::InvalidArgumentError("Invalid AEAD secret");
+  }
+  const size_t nonce_length = EVP_AEAD_nonce_length(Aead());
+  if (ciphertext.size() < nonce_length) {
+    return absl::InvalidArgumentError("AEAD ciphertext too short");
+  }
+  constexpr absl::string_view associated_data = kSharedInfo;
+  // BoringSSL opens in place when the input and the output are the same.
+  uint8_t* sealed = ToBytes(ciphertext) + nonce_length;
+  size_t payload_length;
+  if (!EVP_AEAD_CTX_open(context.get(), sealed, &payload_length,
+                         ciphertext.size() - nonce_length, ToBytes(ciphertext),
+                         nonce_length, sealed, ciphertext.size() - nonce_length,
+                         ToBytes(associated_data), associated_data.size())) {
+    return OperationError(kAeadDecrypt);
+  }
+  return absl::string_view(ciphertext).substr(nonce_length, payload_length);
+}
+
+absl::StatusOr<HpkeDecryptResponse> BoringSslCryptoClient::HpkeDecrypt(
+    const server_common::PrivateKey& private_key,
+    const std::string& ciphertext) noexcept {
+  HpkeDecryptResponse response;
+  PS_RETURN_IF_ERROR(HpkeDecrypt(private_key, ciphertext,
+                                 *response.mutable_payload(),
+                                 *response.mutable_secret()));
+  return response;
+}
+
+absl::StatusOr<HpkeEncryptResponse> BoringSslCryptoClient::HpkeEncrypt(
+    const PublicKey& key, const std::string& plaintext_payload) noexcept {
+  PS_ASSIGN_OR_RETURN(std::string public_key, DecodePublicKey(key));
+  HpkeEncryptResponse response;
+  response.mutable_encrypted_data()->set_key_id(key.key_id());
+  PS_RETURN_IF_ERROR(
+      HpkeEncrypt(public_key, plaintext_payload,
+                  *response.mutable_encrypted_data()->mutable_ciphertext(),
+                  *response.mutable_secret()));
+  return response;
+}
+
+absl::StatusOr<AeadEncryptResponse> BoringSslCryptoClient::AeadEncrypt(
+    const std::string& plaintext_payload, const std::string& secret) noexcept {
+  AeadEncryptResponse response;
+  PS_RETURN_IF_ERROR(AeadEncrypt(
+      plaintext_payload, secret,
+      *response.mutable_encrypted_data()->mutable_ciphertext()));
+  return response;
+}
+
+absl::StatusOr<AeadDecryptResponse> BoringSslCryptoClient::AeadDecrypt(
+    const std::string& ciphertext, const std::string& secret) noexcept {
+  AeadDecryptResponse response;
+  PS_RETURN_IF_ERROR(
+      AeadDecrypt(ciphertext, secret, *response.mutable_payload()));
+  return response;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,127 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_BORINGSSL_CRYPTO_CLIENT_H_
+#define SERVICES_COMMON_ENCRYPTION_BORINGSSL_CRYPTO_CLIENT_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/hpke.h"
+#include "services/common/encryption/crypto_client_wrapper_interface.h"
+#include "src/cpp/encryption/key_fetcher/interface/private_key_fetcher_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Context the HPKE secret is exported with, as by the CPIO crypto client.
+inline constexpr char kHpkeExporterContext[] = "aead key";
+
+// Crypto client calling BoringSSL directly rather than through the CPIO
+// crypto client, so that the payloads are not copied into and out of the
+// CPIO request and response protos, and the private keys are not wrapped in
+// a Tink keyset and parsed again for each request. The messages are
+// compatible with the ones of CryptoClientWrapper: HPKE with
+// DHKEM_X25519_HKDF_SHA256, HKDF_SHA256 and AES_256_GCM, and AES_256_GCM for
+// the AEAD, with kSharedInfo as the HPKE info and the AEAD associated data.
+// Thread safe.
+class BoringSslCryptoClient final : public CryptoClientWrapperInterface {
+ public:
+  BoringSslCryptoClient() = default;
+
+  // Not copyable or movable.
+  BoringSslCryptoClient(const BoringSslCryptoClient&) = delete;
+  BoringSslCryptoClient& operator=(const BoringSslCryptoClient&) = delete;
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>
+  HpkeDecrypt(const server_common::PrivateKey& private_key,
+              const std::string& ciphertext) noexcept override;
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse>
+  HpkeEncrypt(const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+              const std::string& plaintext_payload) noexcept override;
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
+  AeadEncrypt(const std::string& plaintext_payload,
+              const std::string& secret) noexcept override;
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse>
+  AeadDecrypt(const std::string& ciphertext,
+              const std::string& secret) noexcept override;
+
+  // Serializes the message straight into the ciphertext and seals it there.
+  absl::StatusOr<std::string> HpkeEncryptMessage(
+      const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+      const google::protobuf::MessageLite& message,
+      std::string& ciphertext) noexcept override;
+
+  // Serializes the message straight into the ciphertext and seals it there.
+  absl::Status AeadEncryptMessage(const google::protobuf::MessageLite& message,
+                                  const std::string& secret,
+                                  std::string& ciphertext) noexcept override;
+
+  // Opens the ciphertext in place.
+  absl::StatusOr<absl::string_view> AeadDecryptInPlace(
+      std::string& ciphertext, const std::string& secret) noexcept override;
+
+  // Same as the above, but write the output into the given strings, so that
+  // it can go straight into a proto field, rather than into responses.
+  // public_key is the raw, not base64 encoded, X25519 public key.
+  absl::Status HpkeDecrypt(const server_common::PrivateKey& private_key,
+                           absl::string_view ciphertext, std::string& payload,
+                           std::string& secret) ABSL_LOCKS_EXCLUDED(mu_);
+  static absl::Status HpkeEncrypt(absl::string_view public_key,
+                                  absl::string_view plaintext_payload,
+                                  std::string& ciphertext, std::string& secret);
+  static absl::Status AeadEncrypt(absl::string_view plaintext_payload,
+                                  absl::string_view secret,
+                                  std::string& ciphertext);
+  static absl::Status AeadDecrypt(absl::string_view ciphertext,
+                                  absl::string_view secret,
+                                  std::string& payload);
+
+ private:
+  struct HpkeKey {
+    std::string private_key;
+    bssl::ScopedEVP_HPKE_KEY key;
+  };
+
+  // Seals the plaintext of the given length, which follows the room for the
+  // encapsulated key in the buffer, in place, and writes the encapsulated key
+  // before it.
+  static absl::Status SealHpke(absl::string_view public_key, size_t length,
+                               std::string& buffer, std::string& secret);
+
+  // Returns the HPKE key of the private key, setting it up if it is not
+  // cached yet or the private key of its ID changed.
+  absl::StatusOr<std::shared_ptr<const HpkeKey>> GetHpkeKey(
+      const server_common::PrivateKey& private_key) ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Mutex mu_;
+  // The HPKE key of each private key ID. Shared so that a key replaced by a
+  // rotation lives as long as a request still uses it.
+  absl::flat_hash_map<std::string, std::shared_ptr<const HpkeKey>> keys_
+      ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_BORINGSSL_CRYPTO_CLIENT_H_
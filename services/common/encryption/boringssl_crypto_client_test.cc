@@ -0,0 +1,160 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/encryption/boringssl_crypto_client.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/escaping.h"
+#include "gtest/gtest.h"
+#include "services/common/encryption/crypto_client_factory.h"
+#include "services/common/test/utils/ohttp_utils.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+
+constexpr char kKeyId[] = "key_id";
+constexpr char kRequest[] = "request";
+constexpr char kResponse[] = "response";
+
+PublicKey GetTestPublicKey() {
+  PublicKey public_key;
+  public_key.set_key_id(kKeyId);
+  public_key.set_public_key(absl::Base64Escape(GetHpkePublicKey()));
+  return public_key;
+}
+
+server_common::PrivateKey GetTestPrivateKey() {
+  server_common::PrivateKey private_key;
+  private_key.key_id = kKeyId;
+  private_key.private_key = GetHpkePrivateKey();
+  return private_key;
+}
+
+// Sends a request from the client to the server, and a response back, as
+// over an internal hop, and checks that they both get through.
+void ExpectRoundTrip(CryptoClientWrapperInterface& client,
+                     CryptoClientWrapperInterface& server) {
+  absl::StatusOr<HpkeEncryptResponse> encrypted_request =
+      client.HpkeEncrypt(GetTestPublicKey(), kRequest);
+  ASSERT_TRUE(encrypted_request.ok()) << encrypted_request.status();
+  EXPECT_EQ(encrypted_request->encrypted_data().key_id(), kKeyId);
+  absl::StatusOr<HpkeDecryptResponse> decrypted_request = server.HpkeDecrypt(
+      GetTestPrivateKey(), encrypted_request->encrypted_data().ciphertext());
+  ASSERT_TRUE(decrypted_request.ok()) << decrypted_request.status();
+  EXPECT_EQ(decrypted_request->payload(), kRequest);
+  EXPECT_EQ(decrypted_request->secret(), encrypted_request->secret());
+
+  absl::StatusOr<AeadEncryptResponse> encrypted_response =
+      server.AeadEncrypt(kResponse, decrypted_request->secret());
+  ASSERT_TRUE(encrypted_response.ok()) << encrypted_response.status();
+  absl::StatusOr<AeadDecryptResponse> decrypted_response =
+      client.AeadDecrypt(encrypted_response->encrypted_data().ciphertext(),
+                         encrypted_request->secret());
+  ASSERT_TRUE(decrypted_response.ok()) << decrypted_response.status();
+  EXPECT_EQ(decrypted_response->payload(), kResponse);
+}
+
+TEST(BoringSslCryptoClientTest, RoundTrips) {
+  BoringSslCryptoClient crypto_client;
+  ExpectRoundTrip(crypto_client, crypto_client);
+}
+
+TEST(BoringSslCryptoClientTest, RoundTripsWithCpioCryptoClient) {
+  BoringSslCryptoClient crypto_client;
+  std::unique_ptr<CryptoClientWrapperInterface> cpio_crypto_client =
+      CreateCryptoClient();
+  ExpectRoundTrip(crypto_client, *cpio_crypto_client);
+  ExpectRoundTrip(*cpio_crypto_client, crypto_client);
+}
+
+TEST(BoringSslCryptoClientTest, RoundTripsMessagesInPlace) {
+  BoringSslCryptoClient crypto_client;
+  std::unique_ptr<CryptoClientWrapperInterface> cpio_crypto_client =
+      CreateCryptoClient();
+  PublicKey message = GetTestPublicKey();
+  for (CryptoClientWrapperInterface* server :
+       {static_cast<CryptoClientWrapperInterface*>(&crypto_client),
+        cpio_crypto_client.get()}) {
+    std::string ciphertext;
+    absl::StatusOr<std::string> secret = crypto_client.HpkeEncryptMessage(
+        GetTestPublicKey(), message, ciphertext);
+    ASSERT_TRUE(secret.ok()) << secret.status();
+    absl::StatusOr<HpkeDecryptResponse> decrypted_request =
+        server->HpkeDecrypt(GetTestPrivateKey(), ciphertext);
+    ASSERT_TRUE(decrypted_request.ok()) << decrypted_request.status();
+    EXPECT_EQ(decrypted_request->payload(), message.SerializeAsString());
+    EXPECT_EQ(decrypted_request->secret(), *secret);
+
+    absl::StatusOr<AeadEncryptResponse> encrypted_response =
+        server->AeadEncrypt(kResponse, *secret);
+    ASSERT_TRUE(encrypted_response.ok()) << encrypted_response.status();
+    ciphertext = encrypted_response->encrypted_data().ciphertext();
+    absl::StatusOr<absl::string_view> payload =
+        crypto_client.AeadDecryptInPlace(ciphertext, *secret);
+    ASSERT_TRUE(payload.ok()) << payload.status();
+    EXPECT_EQ(*payload, kResponse);
+
+    ASSERT_TRUE(
+        crypto_client.AeadEncryptMessage(message, *secret, ciphertext).ok());
+    absl::StatusOr<AeadDecryptResponse> decrypted_response =
+        server->AeadDecrypt(ciphertext, *secret);
+    ASSERT_TRUE(decrypted_response.ok()) << decrypted_response.status();
+    EXPECT_EQ(decrypted_response->payload(), message.SerializeAsString());
+  }
+}
+
+TEST(BoringSslCryptoClientTest, DecryptsWithRotatedKey) {
+  BoringSslCryptoClient crypto_client;
+  absl::StatusOr<HpkeEncryptResponse> encrypted_request =
+      crypto_client.HpkeEncrypt(GetTestPublicKey(), kRequest);
+  ASSERT_TRUE(encrypted_request.ok()) << encrypted_request.status();
+
+  const std::string& ciphertext =
+      encrypted_request->encrypted_data().ciphertext();
+
+  server_common::PrivateKey rotated_key = GetTestPrivateKey();
+  rotated_key.private_key[0] ^= 1;
+  EXPECT_FALSE(crypto_client.HpkeDecrypt(rotated_key, ciphertext).ok());
+  EXPECT_TRUE(crypto_client.HpkeDecrypt(GetTestPrivateKey(), ciphertext).ok());
+}
+
+TEST(BoringSslCryptoClientTest, FailsForTamperedCiphertext) {
+  BoringSslCryptoClient crypto_client;
+  absl::StatusOr<HpkeEncryptResponse> encrypted_request =
+      crypto_client.HpkeEncrypt(GetTestPublicKey(), kRequest);
+  ASSERT_TRUE(encrypted_request.ok()) << encrypted_request.status();
+  std::string ciphertext = encrypted_request->encrypted_data().ciphertext();
+  ciphertext.back() ^= 1;
+  EXPECT_FALSE(crypto_client.HpkeDecrypt(GetTestPrivateKey(), ciphertext).ok());
+  EXPECT_FALSE(crypto_client.HpkeDecrypt(GetTestPrivateKey(), "short").ok());
+
+  absl::StatusOr<AeadEncryptResponse> encrypted_response =
+      crypto_client.AeadEncrypt(kResponse, encrypted_request->secret());
+  ASSERT_TRUE(encrypted_response.ok()) << encrypted_response.status();
+  ciphertext = encrypted_response->encrypted_data().ciphertext();
+  ciphertext.back() ^= 1;
+  EXPECT_FALSE(
+      crypto_client.AeadDecrypt(ciphertext, encrypted_request->secret()).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -18,6 +18,7 @@
 #include <utility>
 
 #include "cc/public/cpio/interface/crypto_client/crypto_client_interface.h"
+#include "services/common/encryption/boringssl_crypto_client.h"
 #include "services/common/encryption/crypto_client_wrapper.h"
 #include "services/common/encryption/crypto_client_wrapper_interface.h"
 
@@ -28,7 +29,11 @@ using ::google::cmrt::sdk::crypto_service::v1::HpkeKdf;
 using ::google::cmrt::sdk::crypto_service::v1::HpkeKem;
 using ::google::cmrt::sdk::crypto_service::v1::HpkeParams;
 
-std::unique_ptr<CryptoClientWrapperInterface> CreateCryptoClient() {
+std::unique_ptr<CryptoClientWrapperInterface> CreateCryptoClient(
+    bool use_boringssl) {
+  if (use_boringssl) {
+    return std::make_unique<BoringSslCryptoClient>();
+  }
   HpkeParams hpke_params;
   hpke_params.set_kem(HpkeKem::DHKEM_X25519_HKDF_SHA256);
   hpke_params.set_kdf(HpkeKdf::HKDF_SHA256);
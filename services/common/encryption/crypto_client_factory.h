@@ -23,8 +23,10 @@
 
 namespace privacy_sandbox::bidding_auction_servers {
 
-// Constructs a CryptoClientWrapper instance.
-std::unique_ptr<CryptoClientWrapperInterface> CreateCryptoClient();
+// Constructs a CryptoClientWrapper instance, or a BoringSslCryptoClient one
+// if use_boringssl is set.
+std::unique_ptr<CryptoClientWrapperInterface> CreateCryptoClient(
+    bool use_boringssl = false);
 
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -24,6 +24,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "cc/public/cpio/interface/crypto_client/crypto_client_interface.h"
+#include "google/protobuf/message_lite.h"
 #include "src/cpp/encryption/key_fetcher/interface/private_key_fetcher_interface.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -59,6 +60,56 @@ class CryptoClientWrapperInterface {
       google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse>
   AeadDecrypt(const std::string& ciphertext,
               const std::string& secret) noexcept = 0;
+
+  // Encrypts a proto message using HPKE and the provided public key into the
+  // given ciphertext, and returns the secret derived from the operation.
+  // Implementations may serialize the message straight into the ciphertext
+  // and encrypt it in place, rather than into a plaintext payload first.
+  virtual absl::StatusOr<std::string> HpkeEncryptMessage(
+      const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+      const google::protobuf::MessageLite& message,
+      std::string& ciphertext) noexcept {
+    absl::StatusOr<google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse>
+        response = HpkeEncrypt(key, message.SerializeAsString());
+    if (!response.ok()) {
+      return response.status();
+    }
+    ciphertext =
+        std::move(*response->mutable_encrypted_data()->mutable_ciphertext());
+    return std::move(*response->mutable_secret());
+  }
+
+  // Encrypts a proto message using AEAD and a secret derived from the HPKE
+  // decrypt operation into the given ciphertext. Implementations may
+  // serialize the message straight into the ciphertext and encrypt it in
+  // place, rather than into a plaintext payload first.
+  virtual absl::Status AeadEncryptMessage(
+      const google::protobuf::MessageLite& message, const std::string& secret,
+      std::string& ciphertext) noexcept {
+    absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
+        response = AeadEncrypt(message.SerializeAsString(), secret);
+    if (!response.ok()) {
+      return response.status();
+    }
+    ciphertext =
+        std::move(*response->mutable_encrypted_data()->mutable_ciphertext());
+    return absl::OkStatus();
+  }
+
+  // Decrypts a ciphertext using AEAD and a secret derived from the HPKE
+  // encrypt operation, and returns the payload, which lives in the given
+  // ciphertext string. Implementations may decrypt the ciphertext in place,
+  // rather than into a payload of its own.
+  virtual absl::StatusOr<absl::string_view> AeadDecryptInPlace(
+      std::string& ciphertext, const std::string& secret) noexcept {
+    absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse>
+        response = AeadDecrypt(ciphertext, secret);
+    if (!response.ok()) {
+      return response.status();
+    }
+    ciphertext = std::move(*response->mutable_payload());
+    return ciphertext;
+  }
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,35 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/encryption/crypto_metrics.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+void CryptoMetrics::Add(CryptoOperation operation, absl::Duration duration,
+                        int64_t size_bytes) {
+  absl::MutexLock lock(&mu_);
+  Totals& totals = totals_[static_cast<int>(operation)];
+  ++totals.count;
+  totals.duration += duration;
+  totals.size_bytes += size_bytes;
+}
+
+CryptoMetrics::Totals CryptoMetrics::Get(CryptoOperation operation) const {
+  absl::MutexLock lock(&mu_);
+  return totals_[static_cast<int>(operation)];
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
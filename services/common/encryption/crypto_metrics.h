@@ -0,0 +1,107 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_CRYPTO_METRICS_H_
+#define SERVICES_COMMON_ENCRYPTION_CRYPTO_METRICS_H_
+
+#include <array>
+#include <cstdint>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+enum class CryptoOperation {
+  kHpkeEncrypt,
+  kHpkeDecrypt,
+  kAeadEncrypt,
+  kAeadDecrypt,
+};
+
+// Durations and ciphertext sizes of the crypto operations of a request on a
+// hop, summed over its calls, until they are logged in the metric context of
+// the request. Thread safe.
+class CryptoMetrics final {
+ public:
+  struct Totals {
+    int count = 0;
+    absl::Duration duration;
+    int64_t size_bytes = 0;
+  };
+
+  CryptoMetrics() = default;
+
+  // Not copyable or movable.
+  CryptoMetrics(const CryptoMetrics&) = delete;
+  CryptoMetrics& operator=(const CryptoMetrics&) = delete;
+
+  // Adds an operation that took the given time on a ciphertext of the given
+  // size.
+  void Add(CryptoOperation operation, absl::Duration duration,
+           int64_t size_bytes) ABSL_LOCKS_EXCLUDED(mu_);
+
+  Totals Get(CryptoOperation operation) const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable absl::Mutex mu_;
+  std::array<Totals, 4> totals_ ABSL_GUARDED_BY(mu_);
+};
+
+// Logs the totals of the operation, if it ran, in the metric context.
+template <const auto& DurationMetric, const auto& SizeMetric,
+          typename ContextT>
+void LogCryptoOperation(const CryptoMetrics& crypto_metrics,
+                        CryptoOperation operation, ContextT& context) {
+  const CryptoMetrics::Totals totals = crypto_metrics.Get(operation);
+  if (totals.count == 0) {
+    return;
+  }
+  LogIfError(context.template LogHistogram<DurationMetric>(
+      totals.duration / absl::Microseconds(1)));
+  LogIfError(context.template LogHistogram<SizeMetric>(
+      static_cast<int>(totals.size_bytes)));
+}
+
+// Logs the decryption of the request and the encryption of the response on
+// the hop the request was received on.
+template <typename ContextT>
+void LogServerCryptoMetrics(const CryptoMetrics& crypto_metrics,
+                            ContextT& context) {
+  LogCryptoOperation<metric::kHpkeDecryptDuration, metric::kHpkeDecryptSize>(
+      crypto_metrics, CryptoOperation::kHpkeDecrypt, context);
+  LogCryptoOperation<metric::kAeadEncryptDuration, metric::kAeadEncryptSize>(
+      crypto_metrics, CryptoOperation::kAeadEncrypt, context);
+}
+
+// Logs the encryption of the requests and the decryption of the responses on
+// the hop to another server, with its metrics.
+template <const auto& EncryptDuration, const auto& EncryptSize,
+          const auto& DecryptDuration, const auto& DecryptSize,
+          typename ContextT>
+void LogInitiatedRequestCryptoMetrics(const CryptoMetrics& crypto_metrics,
+                                      ContextT& context) {
+  LogCryptoOperation<EncryptDuration, EncryptSize>(
+      crypto_metrics, CryptoOperation::kHpkeEncrypt, context);
+  LogCryptoOperation<DecryptDuration, DecryptSize>(
+      crypto_metrics, CryptoOperation::kAeadDecrypt, context);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_CRYPTO_METRICS_H_
@@ -0,0 +1,50 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/encryption/crypto_metrics.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(CryptoMetricsTest, SumsTheOperations) {
+  CryptoMetrics crypto_metrics;
+  crypto_metrics.Add(CryptoOperation::kHpkeEncrypt, absl::Microseconds(10),
+                     100);
+  crypto_metrics.Add(CryptoOperation::kHpkeEncrypt, absl::Microseconds(20),
+                     200);
+  crypto_metrics.Add(CryptoOperation::kAeadDecrypt, absl::Microseconds(5), 50);
+
+  CryptoMetrics::Totals encrypt =
+      crypto_metrics.Get(CryptoOperation::kHpkeEncrypt);
+  EXPECT_EQ(encrypt.count, 2);
+  EXPECT_EQ(encrypt.duration, absl::Microseconds(30));
+  EXPECT_EQ(encrypt.size_bytes, 300);
+
+  CryptoMetrics::Totals decrypt =
+      crypto_metrics.Get(CryptoOperation::kAeadDecrypt);
+  EXPECT_EQ(decrypt.count, 1);
+  EXPECT_EQ(decrypt.duration, absl::Microseconds(5));
+  EXPECT_EQ(decrypt.size_bytes, 50);
+
+  CryptoMetrics::Totals unused =
+      crypto_metrics.Get(CryptoOperation::kHpkeDecrypt);
+  EXPECT_EQ(unused.count, 0);
+  EXPECT_EQ(unused.duration, absl::ZeroDuration());
+  EXPECT_EQ(unused.size_bytes, 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
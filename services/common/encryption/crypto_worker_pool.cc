@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/encryption/crypto_worker_pool.h"
+
+#include <atomic>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Operations queued on all the pools, read by GetCryptoWorkerPoolQueueDepth.
+std::atomic<int64_t> queue_depth = 0;
+
+}  // namespace
+
+CryptoWorkerPool::CryptoWorkerPool(int num_workers, int64_t threshold_bytes)
+    : threshold_bytes_(threshold_bytes) {
+  CHECK_GT(num_workers, 0) << "The crypto worker pool needs a worker";
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.emplace_back([this]() { Work(); });
+  }
+}
+
+CryptoWorkerPool::~CryptoWorkerPool() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  for (std::thread& worker : workers_) {
+    worker.join();
+  }
+}
+
+void CryptoWorkerPool::Run(int64_t payload_size,
+                           absl::AnyInvocable<void() &&> operation) {
+  if (payload_size < threshold_bytes_) {
+    std::move(operation)();
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  queue_.push_back(std::move(operation));
+  queue_depth.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool CryptoWorkerPool::HasWork() const {
+  return stopping_ || !queue_.empty();
+}
+
+void CryptoWorkerPool::Work() {
+  while (true) {
+    absl::AnyInvocable<void() &&> operation;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &CryptoWorkerPool::HasWork));
+      if (queue_.empty()) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+      queue_depth.fetch_sub(1, std::memory_order_relaxed);
+    }
+    std::move(operation)();
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetCryptoWorkerPoolQueueDepth() {
+  return {{"queued", queue_depth.load(std::memory_order_relaxed)}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
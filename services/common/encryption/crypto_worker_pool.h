@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_CRYPTO_WORKER_POOL_H_
+#define SERVICES_COMMON_ENCRYPTION_CRYPTO_WORKER_POOL_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Threads of their own that the encryption and decryption of large payloads
+// run on, so that they do not hold the gRPC callback threads, which then keep
+// serving the other reactors. Thread safe.
+class CryptoWorkerPool final {
+ public:
+  // num_workers: number of threads, positive.
+  // threshold_bytes: size of the payloads from which the operations run on
+  // the pool rather than on the calling thread.
+  CryptoWorkerPool(int num_workers, int64_t threshold_bytes);
+
+  // Not copyable or movable.
+  CryptoWorkerPool(const CryptoWorkerPool&) = delete;
+  CryptoWorkerPool& operator=(const CryptoWorkerPool&) = delete;
+
+  // Runs the operations queued, and joins the threads.
+  ~CryptoWorkerPool() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Runs the operation on a payload of the given size, on the pool if the
+  // payload is of at least the threshold size, or on the calling thread.
+  void Run(int64_t payload_size, absl::AnyInvocable<void() &&> operation)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Whether an operation is queued or the pool stops.
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Runs the queued operations until the pool stops.
+  void Work() ABSL_LOCKS_EXCLUDED(mu_);
+
+  const int64_t threshold_bytes_;
+  absl::Mutex mu_;
+  std::deque<absl::AnyInvocable<void() &&>> queue_ ABSL_GUARDED_BY(mu_);
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::thread> workers_;
+};
+
+// Returns the number of operations queued on all the CryptoWorkerPool
+// instances, not counting the ones running.
+absl::flat_hash_map<std::string, double> GetCryptoWorkerPoolQueueDepth();
+
+template <typename T>
+inline void AddCryptoWorkerPoolMetric(T* context_map) {
+  context_map->AddObserverable(metric::kCryptoWorkerPoolQueueDepth,
+                               GetCryptoWorkerPoolQueueDepth);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_CRYPTO_WORKER_POOL_H_
@@ -0,0 +1,62 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/encryption/crypto_worker_pool.h"
+
+#include <thread>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int kThresholdBytes = 1024;
+
+TEST(CryptoWorkerPoolTest, RunsSmallPayloadsInline) {
+  CryptoWorkerPool pool(/*num_workers=*/1, kThresholdBytes);
+  std::thread::id thread_id;
+  pool.Run(kThresholdBytes - 1,
+           [&thread_id]() { thread_id = std::this_thread::get_id(); });
+  EXPECT_EQ(thread_id, std::this_thread::get_id());
+}
+
+TEST(CryptoWorkerPoolTest, RunsLargePayloadsOnThePool) {
+  CryptoWorkerPool pool(/*num_workers=*/2, kThresholdBytes);
+  std::thread::id thread_id;
+  absl::Notification done;
+  pool.Run(kThresholdBytes, [&thread_id, &done]() {
+    thread_id = std::this_thread::get_id();
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_NE(thread_id, std::this_thread::get_id());
+}
+
+TEST(CryptoWorkerPoolTest, RunsTheQueuedOperationsBeforeStopping) {
+  constexpr int kNumOperations = 16;
+  absl::BlockingCounter done(kNumOperations);
+  {
+    CryptoWorkerPool pool(/*num_workers=*/1, kThresholdBytes);
+    for (int i = 0; i < kNumOperations; ++i) {
+      pool.Run(kThresholdBytes, [&done]() { done.DecrementCount(); });
+    }
+  }
+  done.Wait();
+  EXPECT_EQ(GetCryptoWorkerPoolQueueDepth()["queued"], 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
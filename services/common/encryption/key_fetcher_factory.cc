@@ -22,6 +22,7 @@
 #include "glog/logging.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/constants/common_service_flags.h"
+#include "services/common/encryption/private_key_cache.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/cpp/concurrent/event_engine_executor.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
@@ -91,10 +92,15 @@ std::unique_ptr<KeyFetcherManagerInterface> CreateKeyFetcherManager(
       config_client.GetIntParameter(KEY_REFRESH_FLOW_RUN_FREQUENCY_SECONDS));
   auto event_engine = std::make_unique<server_common::EventEngineExecutor>(
       grpc_event_engine::experimental::GetDefaultEventEngine());
-  std::unique_ptr<server_common::KeyFetcherManagerInterface> manager =
+  // The private keys are looked up for every request, so the lookups go
+  // through a cache rather than the lock of the manager.
+  auto manager = std::make_unique<PrivateKeyCache>(
       KeyFetcherManagerFactory::Create(
           key_refresh_flow_run_freq, std::move(public_key_fetcher),
-          std::move(private_key_fetcher), std::move(event_engine));
+          std::move(private_key_fetcher), std::move(event_engine)),
+      key_refresh_flow_run_freq,
+      std::make_unique<server_common::EventEngineExecutor>(
+          grpc_event_engine::experimental::GetDefaultEventEngine()));
   manager->Start();
 
   return manager;
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/encryption/ohttp_gateway_cache.h"
+
+#include <utility>
+
+#include "services/common/util/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Counts of all the caches, read and reset by GetOhttpGatewayCacheStats.
+std::atomic<int64_t> cache_hits = 0;
+std::atomic<int64_t> cache_misses = 0;
+
+}  // namespace
+
+absl::StatusOr<const quiche::ObliviousHttpGateway*> OhttpGatewayCache::Get(
+    uint8_t key_id, const server_common::PrivateKey& private_key) {
+  std::atomic<const Entry*>& gateway = gateways_[key_id];
+  const Entry* entry = gateway.load(std::memory_order_acquire);
+  if (entry != nullptr && entry->private_key == private_key.private_key) {
+    cache_hits.fetch_add(1, std::memory_order_relaxed);
+    return &entry->gateway;
+  }
+
+  absl::MutexLock lock(&mu_);
+  // Another request may have set up the gateway meanwhile.
+  entry = gateway.load(std::memory_order_acquire);
+  if (entry != nullptr && entry->private_key == private_key.private_key) {
+    cache_hits.fetch_add(1, std::memory_order_relaxed);
+    return &entry->gateway;
+  }
+  cache_misses.fetch_add(1, std::memory_order_relaxed);
+  PS_ASSIGN_OR_RETURN(auto key_config,
+                      quiche::ObliviousHttpHeaderKeyConfig::Create(
+                          key_id, EVP_HPKE_DHKEM_X25519_HKDF_SHA256,
+                          EVP_HPKE_HKDF_SHA256, EVP_HPKE_AES_256_GCM));
+  PS_ASSIGN_OR_RETURN(auto new_gateway,
+                      quiche::ObliviousHttpGateway::Create(
+                          private_key.private_key, key_config));
+  entries_.push_back(std::make_unique<const Entry>(
+      Entry{private_key.private_key, std::move(new_gateway)}));
+  entry = entries_.back().get();
+  gateway.store(entry, std::memory_order_release);
+  return &entry->gateway;
+}
+
+absl::flat_hash_map<std::string, double> GetOhttpGatewayCacheStats() {
+  return {{"hit", cache_hits.exchange(0)}, {"miss", cache_misses.exchange(0)}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
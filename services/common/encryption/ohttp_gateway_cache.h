@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_OHTTP_GATEWAY_CACHE_H_
+#define SERVICES_COMMON_ENCRYPTION_OHTTP_GATEWAY_CACHE_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "quiche/oblivious_http/oblivious_http_gateway.h"
+#include "services/common/metric/server_definition.h"
+#include "src/cpp/encryption/key_fetcher/interface/private_key_fetcher_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Caches the OHTTP gateway of each key ID, so that the HPKE key of a private
+// key is set up once rather than for every request and response. A gateway is
+// set up again when the private key of its key ID changes, as when the key
+// fetcher rotates the keys. Looking up a cached gateway takes no lock.
+// Thread safe.
+class OhttpGatewayCache final {
+ public:
+  OhttpGatewayCache() = default;
+
+  // Not copyable or movable.
+  OhttpGatewayCache(const OhttpGatewayCache&) = delete;
+  OhttpGatewayCache& operator=(const OhttpGatewayCache&) = delete;
+
+  // Returns the gateway of the OHTTP key ID for the private key. The gateway
+  // lives as long as the cache.
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> Get(
+      uint8_t key_id, const server_common::PrivateKey& private_key)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  struct Entry {
+    std::string private_key;
+    quiche::ObliviousHttpGateway gateway;
+  };
+
+  // The gateway of each key ID, if any.
+  std::array<std::atomic<const Entry*>, 256> gateways_ = {};
+  absl::Mutex mu_;
+  // Owns the entries. The entries replaced by a key rotation are kept, since
+  // a request may still use them, and keys rotate rarely.
+  std::vector<std::unique_ptr<const Entry>> entries_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the number of hits and misses of all the OhttpGatewayCache
+// instances since the previous call.
+absl::flat_hash_map<std::string, double> GetOhttpGatewayCacheStats();
+
+template <typename T>
+inline void AddOhttpGatewayCacheMetric(T* context_map) {
+  context_map->AddObserverable(metric::kOhttpGatewayCacheEventCount,
+                               GetOhttpGatewayCacheStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_OHTTP_GATEWAY_CACHE_H_
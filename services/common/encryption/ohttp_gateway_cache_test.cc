@@ -0,0 +1,84 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/encryption/ohttp_gateway_cache.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/utils/ohttp_utils.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Pair;
+
+constexpr char kPlaintext[] = "plaintext";
+
+server_common::PrivateKey GetTestPrivateKey() {
+  server_common::PrivateKey private_key;
+  private_key.key_id = std::to_string(kTestKeyId);
+  private_key.private_key = GetHpkePrivateKey();
+  return private_key;
+}
+
+TEST(OhttpGatewayCacheTest, DecryptsWithCachedGateway) {
+  GetOhttpGatewayCacheStats();
+  OhttpGatewayCache cache;
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> gateway =
+      cache.Get(kTestKeyId, GetTestPrivateKey());
+  ASSERT_TRUE(gateway.ok()) << gateway.status();
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> cached_gateway =
+      cache.Get(kTestKeyId, GetTestPrivateKey());
+  ASSERT_TRUE(cached_gateway.ok()) << cached_gateway.status();
+  EXPECT_EQ(*gateway, *cached_gateway);
+  absl::flat_hash_map<std::string, double> stats = GetOhttpGatewayCacheStats();
+  EXPECT_THAT(stats, Contains(Pair("hit", 1)));
+  EXPECT_THAT(stats, Contains(Pair("miss", 1)));
+
+  absl::StatusOr<quiche::ObliviousHttpRequest> request =
+      CreateValidEncryptedRequest(kPlaintext);
+  ASSERT_TRUE(request.ok()) << request.status();
+  absl::StatusOr<quiche::ObliviousHttpRequest> decrypted_request =
+      (*cached_gateway)
+          ->DecryptObliviousHttpRequest(request->EncapsulateAndSerialize());
+  ASSERT_TRUE(decrypted_request.ok()) << decrypted_request.status();
+  EXPECT_EQ(decrypted_request->GetPlaintextData(), kPlaintext);
+}
+
+TEST(OhttpGatewayCacheTest, SetsUpGatewayAgainForRotatedKey) {
+  OhttpGatewayCache cache;
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> gateway =
+      cache.Get(kTestKeyId, GetTestPrivateKey());
+  ASSERT_TRUE(gateway.ok()) << gateway.status();
+
+  server_common::PrivateKey rotated_key = GetTestPrivateKey();
+  rotated_key.private_key[0] ^= 1;
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> rotated_gateway =
+      cache.Get(kTestKeyId, rotated_key);
+  ASSERT_TRUE(rotated_gateway.ok()) << rotated_gateway.status();
+  EXPECT_NE(*gateway, *rotated_gateway);
+}
+
+TEST(OhttpGatewayCacheTest, FailsForInvalidKey) {
+  OhttpGatewayCache cache;
+  server_common::PrivateKey invalid_key = GetTestPrivateKey();
+  invalid_key.private_key = "short";
+  EXPECT_FALSE(cache.Get(kTestKeyId, invalid_key).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
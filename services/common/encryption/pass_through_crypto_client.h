@@ -0,0 +1,71 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_PASS_THROUGH_CRYPTO_CLIENT_H_
+#define SERVICES_COMMON_ENCRYPTION_PASS_THROUGH_CRYPTO_CLIENT_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "services/common/encryption/crypto_client_wrapper_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Treats ciphertexts as plaintexts, so that benchmarks of the reactors do not
+// measure HPKE.
+class PassThroughCryptoClient : public CryptoClientWrapperInterface {
+ public:
+  // Secret of every HPKE response.
+  static constexpr char kSecret[] = "secret";
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse>
+  HpkeDecrypt(const server_common::PrivateKey& private_key,
+              const std::string& ciphertext) noexcept override {
+    google::cmrt::sdk::crypto_service::v1::HpkeDecryptResponse response;
+    response.set_payload(ciphertext);
+    response.set_secret(kSecret);
+    return response;
+  }
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse>
+  HpkeEncrypt(const google::cmrt::sdk::public_key_service::v1::PublicKey& key,
+              const std::string& plaintext_payload) noexcept override {
+    google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse response;
+    response.set_secret(kSecret);
+    response.mutable_encrypted_data()->set_ciphertext(plaintext_payload);
+    return response;
+  }
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse>
+  AeadEncrypt(const std::string& plaintext_payload,
+              const std::string& secret) noexcept override {
+    google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse response;
+    response.mutable_encrypted_data()->set_ciphertext(plaintext_payload);
+    return response;
+  }
+
+  absl::StatusOr<google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse>
+  AeadDecrypt(const std::string& ciphertext,
+              const std::string& secret) noexcept override {
+    google::cmrt::sdk::crypto_service::v1::AeadDecryptResponse response;
+    response.set_payload(ciphertext);
+    return response;
+  }
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_PASS_THROUGH_CRYPTO_CLIENT_H_
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/encryption/private_key_cache.h"
+
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+using ::privacy_sandbox::server_common::KeyFetcherManagerInterface;
+using ::privacy_sandbox::server_common::PrivateKey;
+
+PrivateKeyCache::PrivateKeyCache(
+    std::unique_ptr<KeyFetcherManagerInterface> key_fetcher_manager,
+    absl::Duration refresh_period,
+    std::unique_ptr<server_common::Executor> executor)
+    : key_fetcher_manager_(std::move(key_fetcher_manager)),
+      refresh_period_(refresh_period),
+      executor_(std::move(executor)),
+      snapshot_(std::make_shared<const Snapshot>()) {}
+
+PrivateKeyCache::~PrivateKeyCache() {
+  absl::MutexLock lock(&mu_);
+  stopped_ = true;
+  if (!task_id_.has_value() || executor_->Cancel(*task_id_)) {
+    return;
+  }
+  // The refresh has started, and clears task_id_ once it sees stopped_.
+  mu_.Await(absl::Condition(
+      +[](std::optional<server_common::TaskId>* task_id) {
+        return !task_id->has_value();
+      },
+      &task_id_));
+}
+
+absl::StatusOr<PublicKey> PrivateKeyCache::GetPublicKey() noexcept {
+  return key_fetcher_manager_->GetPublicKey();
+}
+
+std::optional<PrivateKey> PrivateKeyCache::GetPrivateKey(
+    const std::string& key_id) noexcept {
+  const std::shared_ptr<const Snapshot> snapshot = std::atomic_load_explicit(
+      &snapshot_, std::memory_order_acquire);
+  if (auto it = snapshot->find(key_id); it != snapshot->end()) {
+    return it->second;
+  }
+
+  std::optional<PrivateKey> private_key =
+      key_fetcher_manager_->GetPrivateKey(key_id);
+  if (!private_key.has_value()) {
+    return std::nullopt;
+  }
+  absl::MutexLock lock(&mu_);
+  // Another lookup may have added the key meanwhile.
+  if (!snapshot_->contains(key_id)) {
+    auto new_snapshot = std::make_shared<Snapshot>(*snapshot_);
+    new_snapshot->insert_or_assign(key_id, *private_key);
+    Publish(std::move(new_snapshot));
+  }
+  return private_key;
+}
+
+void PrivateKeyCache::Start() noexcept {
+  key_fetcher_manager_->Start();
+  absl::MutexLock lock(&mu_);
+  task_id_ = executor_->RunAfter(refresh_period_, [this]() { Refresh(); });
+}
+
+void PrivateKeyCache::Refresh() {
+  absl::MutexLock lock(&mu_);
+  if (stopped_) {
+    task_id_.reset();
+    return;
+  }
+  auto new_snapshot = std::make_shared<Snapshot>();
+  for (const auto& [key_id, unused] : *snapshot_) {
+    std::optional<PrivateKey> private_key =
+        key_fetcher_manager_->GetPrivateKey(key_id);
+    if (private_key.has_value()) {
+      new_snapshot->insert_or_assign(key_id, *std::move(private_key));
+    }
+  }
+  VLOG(3) << "Refreshed private key cache, keys: " << snapshot_->size()
+          << " -> " << new_snapshot->size();
+  Publish(std::move(new_snapshot));
+  task_id_ = executor_->RunAfter(refresh_period_, [this]() { Refresh(); });
+}
+
+void PrivateKeyCache::Publish(std::shared_ptr<const Snapshot> snapshot) {
+  // Lookups holding the previous snapshot keep it alive until they are done.
+  std::atomic_store_explicit(&snapshot_, std::move(snapshot),
+                             std::memory_order_release);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_ENCRYPTION_PRIVATE_KEY_CACHE_H_
+#define SERVICES_COMMON_ENCRYPTION_PRIVATE_KEY_CACHE_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "src/cpp/concurrent/executor.h"
+#include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Key fetcher manager keeping a snapshot of the private keys of the key
+// fetcher manager it wraps, so that looking up a private key takes an atomic
+// load of a shared pointer and a hash lookup rather than the lock of the
+// wrapped manager.
+//
+// A key ID missing from the snapshot is looked up in the wrapped manager, and
+// added to a copy of the snapshot that replaces it, if found. At every
+// refresh period, the keys of the snapshot are looked up again, so that the
+// keys the wrapped manager dropped are dropped too, in at most one more
+// period. Replaced snapshots are freed by the last lookup still reading them,
+// however slow it is. Thread safe.
+class PrivateKeyCache final : public server_common::KeyFetcherManagerInterface {
+ public:
+  // refresh_period: time in between each refresh of the snapshot, as the
+  // refresh period of the wrapped manager.
+  // executor: runs the refreshes.
+  PrivateKeyCache(
+      std::unique_ptr<server_common::KeyFetcherManagerInterface>
+          key_fetcher_manager,
+      absl::Duration refresh_period,
+      std::unique_ptr<server_common::Executor> executor);
+
+  // Not copyable or movable.
+  PrivateKeyCache(const PrivateKeyCache&) = delete;
+  PrivateKeyCache& operator=(const PrivateKeyCache&) = delete;
+
+  // Cancels the next refresh, or waits for the one running to finish.
+  ~PrivateKeyCache() override ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::StatusOr<google::cmrt::sdk::public_key_service::v1::PublicKey>
+  GetPublicKey() noexcept override;
+
+  std::optional<server_common::PrivateKey> GetPrivateKey(
+      const std::string& key_id) noexcept override ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Starts the wrapped manager and the refreshes of the snapshot.
+  void Start() noexcept override ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  using Snapshot = absl::flat_hash_map<std::string, server_common::PrivateKey>;
+
+  // Looks up the keys of the snapshot again, and schedules the next refresh.
+  void Refresh() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Replaces the snapshot with the given one.
+  void Publish(std::shared_ptr<const Snapshot> snapshot)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      key_fetcher_manager_;
+  absl::Duration refresh_period_;
+  std::unique_ptr<server_common::Executor> executor_;
+
+  // Read with std::atomic_load, and replaced with std::atomic_store under mu_.
+  std::shared_ptr<const Snapshot> snapshot_;
+  absl::Mutex mu_;
+  // The next refresh, if scheduled.
+  std::optional<server_common::TaskId> task_id_ ABSL_GUARDED_BY(mu_);
+  // Set by the destructor, after which no refresh is scheduled.
+  bool stopped_ ABSL_GUARDED_BY(mu_) = false;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_ENCRYPTION_PRIVATE_KEY_CACHE_H_
@@ -0,0 +1,142 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/encryption/private_key_cache.h"
+
+#include <memory>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+#include "services/common/test/mocks.h"
+#include "src/cpp/encryption/key_fetcher/mock/mock_key_fetcher_manager.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Return;
+
+constexpr char kKeyId[] = "key_id";
+constexpr absl::Duration kRefreshPeriod = absl::Hours(1);
+
+server_common::PrivateKey GetTestPrivateKey() {
+  server_common::PrivateKey private_key;
+  private_key.key_id = kKeyId;
+  private_key.private_key = "private_key";
+  return private_key;
+}
+
+class PrivateKeyCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    auto key_fetcher_manager =
+        std::make_unique<server_common::MockKeyFetcherManager>();
+    key_fetcher_manager_ = key_fetcher_manager.get();
+    auto executor = std::make_unique<MockExecutor>();
+    EXPECT_CALL(*executor, RunAfter)
+        .WillRepeatedly([this](absl::Duration duration,
+                               absl::AnyInvocable<void()> closure) {
+          EXPECT_EQ(duration, kRefreshPeriod);
+          refresh_ = std::move(closure);
+          return server_common::TaskId();
+        });
+    EXPECT_CALL(*executor, Cancel).WillOnce(Return(true));
+    EXPECT_CALL(*key_fetcher_manager_, Start);
+    cache_ = std::make_unique<PrivateKeyCache>(
+        std::move(key_fetcher_manager), kRefreshPeriod, std::move(executor));
+    cache_->Start();
+  }
+
+  // Runs the scheduled refresh, which schedules the next one.
+  void Refresh() {
+    absl::AnyInvocable<void()> refresh = std::move(refresh_);
+    refresh();
+  }
+
+  server_common::MockKeyFetcherManager* key_fetcher_manager_;
+  absl::AnyInvocable<void()> refresh_;
+  std::unique_ptr<PrivateKeyCache> cache_;
+};
+
+TEST_F(PrivateKeyCacheTest, LooksUpAKeyOnce) {
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey(kKeyId))
+      .WillOnce(Return(GetTestPrivateKey()));
+  for (int i = 0; i < 3; ++i) {
+    std::optional<server_common::PrivateKey> private_key =
+        cache_->GetPrivateKey(kKeyId);
+    ASSERT_TRUE(private_key.has_value());
+    EXPECT_EQ(private_key->private_key, GetTestPrivateKey().private_key);
+  }
+}
+
+TEST_F(PrivateKeyCacheTest, DoesNotCacheMissingKeys) {
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey(kKeyId))
+      .Times(2)
+      .WillRepeatedly(Return(std::nullopt));
+  EXPECT_FALSE(cache_->GetPrivateKey(kKeyId).has_value());
+  EXPECT_FALSE(cache_->GetPrivateKey(kKeyId).has_value());
+}
+
+TEST_F(PrivateKeyCacheTest, RefreshesTheKeys) {
+  server_common::PrivateKey rotated_key = GetTestPrivateKey();
+  rotated_key.private_key = "rotated_private_key";
+  EXPECT_CALL(*key_fetcher_manager_, GetPrivateKey(kKeyId))
+      .WillOnce(Return(GetTestPrivateKey()))
+      .WillOnce(Return(rotated_key))
+      .WillOnce(Return(std::nullopt))
+      .WillOnce(Return(std::nullopt));
+  ASSERT_TRUE(cache_->GetPrivateKey(kKeyId).has_value());
+
+  // The refresh picks up the rotated key.
+  Refresh();
+  std::optional<server_common::PrivateKey> private_key =
+      cache_->GetPrivateKey(kKeyId);
+  ASSERT_TRUE(private_key.has_value());
+  EXPECT_EQ(private_key->private_key, rotated_key.private_key);
+
+  // The next one drops the key the manager dropped.
+  Refresh();
+  EXPECT_FALSE(cache_->GetPrivateKey(kKeyId).has_value());
+}
+
+TEST(PrivateKeyCacheDestructorTest, WaitsForTheRunningRefresh) {
+  auto key_fetcher_manager =
+      std::make_unique<server_common::MockKeyFetcherManager>();
+  EXPECT_CALL(*key_fetcher_manager, Start);
+  absl::AnyInvocable<void()> refresh;
+  auto executor = std::make_unique<MockExecutor>();
+  EXPECT_CALL(*executor, RunAfter)
+      .WillOnce([&refresh](absl::Duration duration,
+                           absl::AnyInvocable<void()> closure) {
+        refresh = std::move(closure);
+        return server_common::TaskId();
+      });
+  // The refresh has already been started by the executor.
+  EXPECT_CALL(*executor, Cancel).WillOnce(Return(false));
+  auto cache = std::make_unique<PrivateKeyCache>(
+      std::move(key_fetcher_manager), kRefreshPeriod, std::move(executor));
+  cache->Start();
+
+  std::thread refresher([&refresh]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    refresh();
+  });
+  cache.reset();
+  refresher.join();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
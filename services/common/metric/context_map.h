@@ -17,10 +17,12 @@
 #ifndef SERVICES_COMMON_METRIC_CONTEXT_MAP_H_
 #define SERVICES_COMMON_METRIC_CONTEXT_MAP_H_
 
+#include <array>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/hash/hash.h"
 #include "absl/log/check.h"
 #include "absl/synchronization/mutex.h"
 #include "services/common/metric/context.h"
@@ -32,12 +34,17 @@ namespace privacy_sandbox::server_common::metric {
 // ContextMap provide a thread-safe map between T* and `Context`.
 // T should be a request received by server, i.e. `GenerateBidsRequest`.
 // See detail docs about `L` and `U` at `Context`.
+// The map is sharded by the hash of T*, each shard with its own lock, so that
+// the requests served at once do not all contend on a single lock.
 template <typename T, const absl::Span<const DefinitionName* const>& L,
           typename U>
 class ContextMap {
  public:
   using ContextT = Context<L, U>;
 
+  // Number of independently locked partitions of the map.
+  static constexpr size_t kNumShards = 32;
+
   ContextMap(std::unique_ptr<U> metric_router, BuildDependentConfig config)
       : metric_router_(std::move(metric_router)),
         metric_config_(std::move(config)) {
@@ -51,11 +58,12 @@ class ContextMap {
 
   // Get the `Context` tied to a T*, create new if not exist, `ContextMap` owns
   // the `Context`.
-  ContextT& Get(T* t) ABSL_LOCKS_EXCLUDED(mutex_) {
-    absl::MutexLock mutex_lock(&mutex_);
-    auto it = context_.find(t);
-    if (it == context_.end()) {
-      it = context_
+  ContextT& Get(T* t) {
+    Shard& shard = ShardFor(t);
+    absl::MutexLock mutex_lock(&shard.mutex);
+    auto it = shard.context.find(t);
+    if (it == shard.context.end()) {
+      it = shard.context
                .emplace(t, ContextT::GetContext(metric_router_.get(),
                                                 metric_config_))
                .first;
@@ -64,15 +72,15 @@ class ContextMap {
   }
 
   // Release the ownership of the `Context` tied to a T* and return it.
-  absl::StatusOr<std::unique_ptr<ContextT>> Remove(T* t)
-      ABSL_LOCKS_EXCLUDED(mutex_) {
-    absl::MutexLock mutex_lock(&mutex_);
-    auto it = context_.find(t);
-    if (it == context_.end()) {
+  absl::StatusOr<std::unique_ptr<ContextT>> Remove(T* t) {
+    Shard& shard = ShardFor(t);
+    absl::MutexLock mutex_lock(&shard.mutex);
+    auto it = shard.context.find(t);
+    if (it == shard.context.end()) {
       return absl::NotFoundError("Metric context not found");
     }
     std::unique_ptr<ContextT> c = std::move(it->second);
-    context_.erase(it);
+    shard.context.erase(it);
     return c;
   }
 
@@ -103,11 +111,17 @@ class ContextMap {
   }
 
  private:
+  struct Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<T*, std::unique_ptr<ContextT>> context
+        ABSL_GUARDED_BY(mutex);
+  };
+
+  Shard& ShardFor(T* t) { return shards_[absl::HashOf(t) % kNumShards]; }
+
   std::unique_ptr<U> metric_router_;
   const BuildDependentConfig metric_config_;
-  absl::Mutex mutex_;
-  absl::flat_hash_map<T*, std::unique_ptr<ContextT>> context_
-      ABSL_GUARDED_BY(mutex_);
+  std::array<Shard, kNumShards> shards_;
 };
 
 // Get singleton `ContextMap` for T. First call will initialize.
@@ -134,7 +148,8 @@ inline auto* GetContextMap(
     return new ContextMap<T, L, MetricRouter>(
         std::make_unique<MetricRouter>(
             std::move(provider), service, version, budget,
-            absl::Milliseconds(config->dp_export_interval_ms())),
+            absl::Milliseconds(config->dp_export_interval_ms()),
+            absl::Milliseconds(config->metric_export_interval_ms()) / 2),
         *config);
   }();
   CHECK(config == std::nullopt ||
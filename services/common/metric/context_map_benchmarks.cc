@@ -0,0 +1,100 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Contention benchmark of ContextMap.
+//
+// BM_GetAndRemove has each thread remove the context of a request and get the
+// context of a new one, as every RPC does once its reactor is created and
+// once it is received, for 1 to 64 threads at once. items_per_second is the
+// number of requests served by all the threads, so it grows with them as long
+// as they do not contend on the locks of the map.
+//
+// Run with:
+//   bazel run -c opt //services/common/metric:context_map_benchmarks
+
+#include <memory>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "benchmark/benchmark.h"
+#include "services/common/metric/context_map.h"
+
+namespace privacy_sandbox::server_common::metric {
+namespace {
+
+constexpr Definition<int, Privacy::kNonImpacting, Instrument::kUpDownCounter>
+    kCounter("counter", "description");
+constexpr const DefinitionName* kMetricList[] = {&kCounter};
+constexpr absl::Span<const DefinitionName* const> kMetricSpan = kMetricList;
+
+class NoOpMetricRouter {
+ public:
+  template <typename T, Privacy privacy, Instrument instrument>
+  absl::Status LogSafe(T value,
+                       const Definition<T, privacy, instrument>& definition,
+                       absl::string_view partition) {
+    return absl::OkStatus();
+  }
+
+  template <typename T, Privacy privacy, Instrument instrument>
+  absl::Status LogUnSafe(T value,
+                         const Definition<T, privacy, instrument>& definition,
+                         absl::string_view partition) {
+    return absl::OkStatus();
+  }
+};
+
+struct Request {};
+
+using BenchmarkContextMap = ContextMap<Request, kMetricSpan, NoOpMetricRouter>;
+
+BenchmarkContextMap* GetBenchmarkContextMap() {
+  static BenchmarkContextMap* context_map = []() {
+    TelemetryConfig config_proto;
+    config_proto.set_mode(TelemetryConfig::PROD);
+    return new BenchmarkContextMap(std::make_unique<NoOpMetricRouter>(),
+                                   BuildDependentConfig(config_proto));
+  }();
+  return context_map;
+}
+
+// Number of requests each thread has in flight, so that the map holds some
+// contexts of every thread, as under load.
+constexpr int kRequestsPerThread = 64;
+
+void BM_GetAndRemove(benchmark::State& state) {
+  BenchmarkContextMap* context_map = GetBenchmarkContextMap();
+  std::vector<Request> requests(kRequestsPerThread);
+  for (Request& request : requests) {
+    context_map->Get(&request);
+  }
+  int next = 0;
+  for (auto _ : state) {
+    // The oldest request of the thread is done, and a new one comes in.
+    Request* request = &requests[next];
+    next = (next + 1) % kRequestsPerThread;
+    CHECK_OK(context_map->Remove(request));
+    benchmark::DoNotOptimize(context_map->Get(request));
+  }
+  for (Request& request : requests) {
+    CHECK_OK(context_map->Remove(&request));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetAndRemove)->ThreadRange(1, 64)->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::server_common::metric
+
+BENCHMARK_MAIN();
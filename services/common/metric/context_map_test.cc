@@ -14,6 +14,10 @@
 
 #include "services/common/metric/context_map.h"
 
+#include <memory>
+#include <thread>
+#include <vector>
+
 #include "absl/log/check.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -72,6 +76,33 @@ TEST_F(ContextMapTest, GetContext) {
   EXPECT_FALSE(context_map.Get(&foo).is_decrypted());
 }
 
+TEST_F(ContextMapTest, GetsAndRemovesFromManyThreads) {
+  using TestContextMap = ContextMap<Foo, metric_list_span, TestMetricRouter>;
+  TestContextMap context_map(std::make_unique<TestMetricRouter>(),
+                             *metric_config_);
+  constexpr int kNumThreads = 8;
+  constexpr int kRequestsPerThread = 100;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&context_map]() {
+      std::vector<Foo> requests(kRequestsPerThread);
+      for (Foo& request : requests) {
+        context_map.Get(&request).SetDecrypted();
+      }
+      for (Foo& request : requests) {
+        absl::StatusOr<std::unique_ptr<TestContextMap::ContextT>> context =
+            context_map.Remove(&request);
+        ASSERT_TRUE(context.ok()) << context.status();
+        EXPECT_TRUE((*context)->is_decrypted());
+        EXPECT_FALSE(context_map.Remove(&request).ok());
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
 constexpr absl::string_view pv[] = {"buyer_2", "buyer_1"};
 constexpr Definition<int, Privacy::kNonImpacting,
                      Instrument::kPartitionedCounter>
@@ -32,6 +32,7 @@
 #include "absl/synchronization/notification.h"
 #include "algorithms/bounded-sum.h"
 #include "services/common/metric/definition.h"
+#include "services/common/metric/per_thread.h"
 #include "services/common/util/status_macros.h"
 
 namespace privacy_sandbox::server_common::metric {
@@ -47,6 +48,11 @@ class DpAggregatorBase {
   // Output aggregated results with DP noise added.
   virtual absl::StatusOr<std::vector<differential_privacy::Output>>
   OutputNoised() = 0;
+  // Returns a new aggregator of the same metric, with nothing aggregated.
+  virtual std::unique_ptr<DpAggregatorBase> NewEmpty() const = 0;
+  // Moves what `other` aggregated into this one, before any noise is added.
+  // `other` must aggregate the same metric, it is reset.
+  virtual absl::Status MergeFrom(DpAggregatorBase& other) = 0;
   virtual ~DpAggregatorBase() = default;
 };
 
@@ -72,6 +78,54 @@ class DpAggregator : public DpAggregatorBase {
   absl::Status Aggregate(TValue value, absl::string_view partition)
       ABSL_LOCKS_EXCLUDED(mutex_) {
     absl::MutexLock mutex_lock(&mutex_);
+    PS_ASSIGN_OR_RETURN(differential_privacy::BoundedSum<TValue> * bounded_sum,
+                        GetBoundedSum(partition));
+    bounded_sum->AddEntry(value);
+    return absl::OkStatus();
+  }
+
+  std::unique_ptr<DpAggregatorBase> NewEmpty() const override {
+    return std::make_unique<DpAggregator>(metric_router_, &definition_,
+                                          privacy_budget_per_weight_);
+  }
+
+  absl::Status MergeFrom(DpAggregatorBase& other) override
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    auto& from = static_cast<DpAggregator&>(other);
+    absl::MutexLock mutex_lock(&mutex_);
+    absl::MutexLock from_mutex_lock(&from.mutex_);
+    for (auto& [partition, from_bounded_sum] : from.bounded_sums_) {
+      PS_ASSIGN_OR_RETURN(
+          differential_privacy::BoundedSum<TValue> * bounded_sum,
+          GetBoundedSum(partition));
+      PS_RETURN_IF_ERROR(bounded_sum->Merge(from_bounded_sum->Serialize()));
+      from_bounded_sum->Reset();
+    }
+    return absl::OkStatus();
+  }
+
+  // After each `OutputNoised`, all aggregated value will be reset.
+  absl::StatusOr<std::vector<differential_privacy::Output>> OutputNoised()
+      override ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock mutex_lock(&mutex_);
+    std::vector<differential_privacy::Output> ret(bounded_sums_.size());
+    auto it = ret.begin();
+    for (auto& [partition, bounded_sum] : bounded_sums_) {
+      PS_ASSIGN_OR_RETURN(*it, bounded_sum->PartialResult());
+      PS_RETURN_IF_ERROR((metric_router_->LogSafe(
+          definition_, differential_privacy::GetValue<TValue>(*it),
+          partition)));
+      ++it;
+      bounded_sum->Reset();
+    }
+    return ret;
+  }
+
+ private:
+  // Returns the bounded sum of `partition`, building it on first use. For a
+  // partitioned metric with public partitions, all of them are built at once.
+  absl::StatusOr<differential_privacy::BoundedSum<TValue>*> GetBoundedSum(
+      absl::string_view partition) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
     auto it = bounded_sums_.find(partition);
     if (it == bounded_sums_.end()) {
       int max_partitions_contributed;
@@ -105,28 +159,9 @@ class DpAggregator : public DpAggregatorBase {
         it = bounded_sums_.find(partition);
       }
     }
-    it->second->AddEntry(value);
-    return absl::OkStatus();
-  }
-
-  // After each `OutputNoised`, all aggregated value will be reset.
-  absl::StatusOr<std::vector<differential_privacy::Output>> OutputNoised()
-      override ABSL_LOCKS_EXCLUDED(mutex_) {
-    absl::MutexLock mutex_lock(&mutex_);
-    std::vector<differential_privacy::Output> ret(bounded_sums_.size());
-    auto it = ret.begin();
-    for (auto& [partition, bounded_sum] : bounded_sums_) {
-      PS_ASSIGN_OR_RETURN(*it, bounded_sum->PartialResult());
-      PS_RETURN_IF_ERROR((metric_router_->LogSafe(
-          definition_, differential_privacy::GetValue<TValue>(*it),
-          partition)));
-      ++it;
-      bounded_sum->Reset();
-    }
-    return ret;
+    return it->second.get();
   }
 
- private:
   TMetricRouter* metric_router_;
   const Definition<TValue, privacy, instrument>& definition_;
   PrivacyBudget privacy_budget_per_weight_;
@@ -191,6 +226,24 @@ class DpAggregator<TMetricRouter, TValue, privacy, Instrument::kHistogram>
     return absl::OkStatus();
   }
 
+  std::unique_ptr<DpAggregatorBase> NewEmpty() const override {
+    return std::make_unique<DpAggregator>(metric_router_, &definition_,
+                                          privacy_budget_per_weight_);
+  }
+
+  absl::Status MergeFrom(DpAggregatorBase& other) override
+      ABSL_LOCKS_EXCLUDED(mutex_) {
+    auto& from = static_cast<DpAggregator&>(other);
+    absl::MutexLock mutex_lock(&mutex_);
+    absl::MutexLock from_mutex_lock(&from.mutex_);
+    for (int i = 0; i < bounded_sums_.size(); ++i) {
+      PS_RETURN_IF_ERROR(
+          bounded_sums_[i]->Merge(from.bounded_sums_[i]->Serialize()));
+      from.bounded_sums_[i]->Reset();
+    }
+    return absl::OkStatus();
+  }
+
   // Get noised histogram counts in buckets, output them to OTel with an
   // arbitrary bucket value. The bucket value has no impact on the result, as
   // long as it falls into the bucket range. `BucketMean` is used for the value.
@@ -229,6 +282,8 @@ class DpAggregator<TMetricRouter, TValue, privacy, Instrument::kHistogram>
 /*
 `DifferentiallyPrivate` is the thread safe class to aggregate
 `Privacy::kImpacting` metrics and output the noised result periodically.
+Each thread aggregates into its own `DpAggregator`s, which are merged before
+the noise is added to their sum, so that threads do not contend for a lock.
 
 `TMetricRouter` is thread-safe metric_router implementing following method:
   template <typename TValue, Privacy privacy, Instrument instrument>
@@ -258,25 +313,23 @@ class DifferentiallyPrivate {
   template <typename TValue, Privacy privacy, Instrument instrument>
   absl::Status Aggregate(
       const Definition<TValue, privacy, instrument>* definition, TValue value,
-      absl::string_view partition) ABSL_LOCKS_EXCLUDED(mutex_) {
+      absl::string_view partition) {
     absl::string_view metric_name = definition->name_;
     using CounterT =
         internal::DpAggregator<TMetricRouter, TValue, privacy, instrument>;
-    CounterT* counter;
-    {
-      absl::MutexLock mutex_lock(&mutex_);
-      has_data = true;
-      auto it = counter_.find(metric_name);
-      if (it == counter_.end()) {
-        it = counter_
-                 .emplace(metric_name, std::make_unique<CounterT>(
-                                           metric_router_, definition,
-                                           privacy_budget_per_weight_))
-                 .first;
-      }
-      counter = static_cast<CounterT*>(it->second.get());
+    Shard& shard = shards_.Get();
+    absl::MutexLock shard_lock(&shard.mutex);
+    shard.has_data = true;
+    auto it = shard.counter.find(metric_name);
+    if (it == shard.counter.end()) {
+      it = shard.counter
+               .emplace(metric_name, std::make_unique<CounterT>(
+                                         metric_router_, definition,
+                                         privacy_budget_per_weight_))
+               .first;
     }
-    return counter->Aggregate(value, partition);
+    return static_cast<CounterT*>(it->second.get())
+        ->Aggregate(value, partition);
   }
 
   PrivacyBudget privacy_budget_per_weight() const {
@@ -290,6 +343,38 @@ class DifferentiallyPrivate {
 
  private:
   friend class NoNoiseTest_DifferentiallyPrivate_Test;
+  friend class ThreadTest_DifferentiallyPrivateMergesThreads_Test;
+
+  // `DpAggregator`s of one thread, by metric name.
+  struct Shard {
+    absl::Mutex mutex;
+    absl::flat_hash_map<absl::string_view,
+                        std::unique_ptr<internal::DpAggregatorBase>>
+        counter ABSL_GUARDED_BY(mutex);
+    // Same as `has_data` of `DifferentiallyPrivate`, for this shard only.
+    bool has_data ABSL_GUARDED_BY(mutex) = false;
+  };
+
+  // Merge what all threads aggregated into `counter_`.
+  absl::Status MergeShards() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    for (const std::shared_ptr<Shard>& shard : shards_.GetAll()) {
+      absl::MutexLock shard_lock(&shard->mutex);
+      if (!shard->has_data) {
+        continue;
+      }
+      has_data = true;
+      shard->has_data = false;
+      for (auto& [name, shard_counter] : shard->counter) {
+        auto it = counter_.find(name);
+        if (it == counter_.end()) {
+          it = counter_.emplace(name, shard_counter->NewEmpty()).first;
+        }
+        PS_RETURN_IF_ERROR(it->second->MergeFrom(*shard_counter));
+      }
+    }
+    shards_.RemoveExited();
+    return absl::OkStatus();
+  }
 
   // Output aggregated results with DP noise added for all defintions with
   // logged metric.
@@ -301,6 +386,7 @@ class DifferentiallyPrivate {
     absl::flat_hash_map<absl::string_view,
                         std::vector<differential_privacy::Output>>
         ret;
+    PS_RETURN_IF_ERROR(MergeShards());
     if (!has_data) {
       return ret;
     }
@@ -329,10 +415,13 @@ class DifferentiallyPrivate {
   PrivacyBudget privacy_budget_per_weight_;
   absl::Duration output_period_;
 
+  // Guards the merged `DpAggregator`s, which are the only ones noised and
+  // output, so that the privacy budget is only spent once per output.
   absl::Mutex mutex_;
   absl::flat_hash_map<absl::string_view,
                       std::unique_ptr<internal::DpAggregatorBase>>
       counter_ ABSL_GUARDED_BY(mutex_);
+  internal::PerThread<Shard> shards_;
 
   absl::Notification stop_signal;
   std::thread run_output_;
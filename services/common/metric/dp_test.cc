@@ -15,6 +15,8 @@
 #include "services/common/metric/dp.h"
 
 #include <future>
+#include <thread>
+#include <vector>
 
 #include "absl/log/absl_log.h"
 #include "absl/log/check.h"
@@ -296,6 +298,58 @@ TEST_F(NoNoiseTest, DifferentiallyPrivate) {
       .WillRepeatedly(Return(absl::OkStatus()));
 }
 
+TEST_F(NoNoiseTest, DPCounterMerge) {
+  internal::DpAggregator d(&mock_metric_router_, &kIntUnSafeCounter,
+                           fraction());
+  internal::DpAggregator other(&mock_metric_router_, &kIntUnSafeCounter,
+                               fraction());
+  CHECK_OK(d.Aggregate(1, ""));
+  CHECK_OK(other.Aggregate(2, ""));
+  CHECK_OK(other.Aggregate(5, ""));  // bounded to [1:2]
+  CHECK_OK(d.MergeFrom(other));
+
+  EXPECT_CALL(mock_metric_router_,
+              LogSafe(Matcher<const DefinitionUnSafe&>(Ref(kIntUnSafeCounter)),
+                      Eq(5), _))
+      .WillOnce(Return(absl::OkStatus()));
+  PS_ASSERT_OK_AND_ASSIGN(auto output, d.OutputNoised());
+
+  // `other` has been reset by the merge.
+  EXPECT_CALL(mock_metric_router_,
+              LogSafe(Matcher<const DefinitionUnSafe&>(Ref(kIntUnSafeCounter)),
+                      Eq(0), _))
+      .WillOnce(Return(absl::OkStatus()));
+  PS_ASSERT_OK_AND_ASSIGN(output, other.OutputNoised());
+}
+
+TEST_F(NoNoiseTest, PartitionedCounterMerge) {
+  internal::DpAggregator d(&mock_metric_router_, &kUnitPartionCounter,
+                           fraction());
+  internal::DpAggregator other(&mock_metric_router_, &kUnitPartionCounter,
+                               fraction());
+  CHECK_OK(d.Aggregate(1, "buyer_1"));
+  CHECK_OK(other.Aggregate(1, "buyer_1"));
+  CHECK_OK(other.Aggregate(1, "buyer_2"));
+  CHECK_OK(d.MergeFrom(other));
+
+  EXPECT_CALL(mock_metric_router_,
+              LogSafe(Matcher<const DefinitionPartition&>(
+                          Ref(kUnitPartionCounter)),
+                      Eq(2), Eq("buyer_1")))
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metric_router_,
+              LogSafe(Matcher<const DefinitionPartition&>(
+                          Ref(kUnitPartionCounter)),
+                      Eq(1), Eq("buyer_2")))
+      .WillOnce(Return(absl::OkStatus()));
+  EXPECT_CALL(mock_metric_router_,
+              LogSafe(Matcher<const DefinitionPartition&>(
+                          Ref(kUnitPartionCounter)),
+                      Eq(0), Eq("buyer_no_data")))
+      .WillOnce(Return(absl::OkStatus()));
+  PS_ASSERT_OK_AND_ASSIGN(auto output, d.OutputNoised());
+}
+
 class ThreadTest : public NoNoiseTest {};
 
 // multi thread log to same `DpAggregator`
@@ -346,6 +400,34 @@ TEST_F(ThreadTest, DpAggregator) {
   EXPECT_EQ(f_read.get(), kThread * kRepeat);
 }
 
+// values logged by many threads are merged before output
+TEST_F(ThreadTest, DifferentiallyPrivateMergesThreads) {
+  DifferentiallyPrivate dp(&mock_metric_router_, fraction(), absl::Seconds(60));
+  constexpr int kThread = 4, kRepeat = 5;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThread; ++t) {
+    threads.emplace_back([&dp]() {
+      for (int i = 0; i < kRepeat; ++i) {
+        CHECK_OK(dp.Aggregate(&kUnitCounter, 1, ""));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_CALL(
+      mock_metric_router_,
+      LogSafe(Matcher<const DefinitionUnSafe&>(Ref(kUnitCounter)),
+              Eq(kThread * kRepeat), _))
+      .WillOnce(Return(absl::OkStatus()));
+
+  PS_ASSERT_OK_AND_ASSIGN(auto s, dp.OutputNoised());
+
+  EXPECT_CALL(mock_metric_router_,
+              LogSafe(A<const DefinitionUnSafe&>(), Eq(0), _))
+      .WillRepeatedly(Return(absl::OkStatus()));
+}
+
 // multi thread log through `DifferentiallyPrivate`
 TEST_F(ThreadTest, DifferentiallyPrivate) {
   constexpr DefinitionUnSafe kUnitCounter2("kUnitCounter2", "", 0, 1);
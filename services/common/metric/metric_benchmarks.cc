@@ -0,0 +1,136 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Per call latency and contention benchmarks of the metric hot path, for 1 to
+// 64 threads at once.
+//
+// BM_SfeRequest logs the metrics of a whole SelectAd request through the SFE
+// context map. A request spends milliseconds in the auction, so this should
+// stay well below 1% of it, i.e. under 50us, even with many threads.
+// BM_AccumulateMetric and BM_MakeInitiatedRequest measure the calls of
+// `Context` a reactor makes many times per request. BM_MetricRouterLogSafe
+// and BM_DpAggregate measure `MetricRouter` logging a safe value, and
+// `DifferentiallyPrivate` aggregating an unsafe one. items_per_second is the
+// number of calls by all the threads, so it grows with them as long as they do
+// not contend.
+//
+// Run with:
+//   bazel run -c opt //services/common/metric:metric_benchmarks
+
+#include "absl/log/check.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "services/common/metric/metric_router.h"
+#include "services/common/metric/request_metrics_for_testing.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers::metric {
+namespace {
+
+using ::privacy_sandbox::server_common::metric::Definition;
+using ::privacy_sandbox::server_common::metric::Instrument;
+using ::privacy_sandbox::server_common::metric::MetricRouter;
+using ::privacy_sandbox::server_common::metric::Privacy;
+using ::privacy_sandbox::server_common::metric::PrivacyBudget;
+
+constexpr Definition<int, Privacy::kNonImpacting, Instrument::kUpDownCounter>
+    kSafeCounter("safe_counter", "description");
+constexpr Definition<int, Privacy::kImpacting, Instrument::kUpDownCounter>
+    kUnsafeCounter("unsafe_counter", "description", /*upper_bound*/ 1,
+                   /*lower_bound*/ 0);
+
+void InitSfeContextMap() {
+  static bool initialized = []() {
+    InitSfeContextMapForTesting();
+    return true;
+  }();
+  benchmark::DoNotOptimize(initialized);
+}
+
+MetricRouter* GetMetricRouter() {
+  static MetricRouter* metric_router =
+      new MetricRouter(nullptr, "benchmark", "0.0.1", PrivacyBudget{1},
+                       /*dp_output_period*/ absl::Minutes(5));
+  return metric_router;
+}
+
+void BM_SfeRequest(benchmark::State& state) {
+  InitSfeContextMap();
+  SelectAdRequest request;
+  SelectAdResponse response;
+  for (auto _ : state) {
+    LogSfeRequestMetrics(request, response);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SfeRequest)->ThreadRange(1, 64)->UseRealTime();
+
+void BM_AccumulateMetric(benchmark::State& state) {
+  InitSfeContextMap();
+  SelectAdRequest request;
+  SfeContext& context = SfeContextMap()->Get(&request);
+  for (auto _ : state) {
+    LogIfError(
+        context.AccumulateMetric<kInitiatedRequestCountByServer>(1, kBfe));
+  }
+  CHECK_OK(SfeContextMap()->Remove(&request));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AccumulateMetric)->ThreadRange(1, 64)->UseRealTime();
+
+// Number of BFEs a SelectAd request calls, each logging an initiated request
+// into the context of the request.
+constexpr int kInitiatedRequestsPerRequest = 8;
+
+void BM_MakeInitiatedRequest(benchmark::State& state) {
+  InitSfeContextMap();
+  SelectAdRequest request;
+  SfeContext* context = &SfeContextMap()->Get(&request);
+  int initiated = 0;
+  for (auto _ : state) {
+    MakeInitiatedRequest(kBfe, context, 0);
+    if (++initiated == kInitiatedRequestsPerRequest) {
+      initiated = 0;
+      CHECK_OK(SfeContextMap()->Remove(&request));
+      context = &SfeContextMap()->Get(&request);
+    }
+  }
+  CHECK_OK(SfeContextMap()->Remove(&request));
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MakeInitiatedRequest)->ThreadRange(1, 64)->UseRealTime();
+
+void BM_MetricRouterLogSafe(benchmark::State& state) {
+  MetricRouter* metric_router = GetMetricRouter();
+  for (auto _ : state) {
+    CHECK_OK(metric_router->LogSafe(kSafeCounter, 1, ""));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_MetricRouterLogSafe)->ThreadRange(1, 64)->UseRealTime();
+
+void BM_DpAggregate(benchmark::State& state) {
+  MetricRouter* metric_router = GetMetricRouter();
+  for (auto _ : state) {
+    CHECK_OK(metric_router->LogUnSafe(kUnsafeCounter, 1, ""));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_DpAggregate)->ThreadRange(1, 64)->UseRealTime();
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers::metric
+
+BENCHMARK_MAIN();
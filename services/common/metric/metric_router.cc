@@ -30,8 +30,11 @@ namespace sdk = ::opentelemetry::sdk::metrics;
 MetricRouter::MetricRouter(std::unique_ptr<MeterProvider> provider,
                            absl::string_view service, absl::string_view version,
                            PrivacyBudget fraction,
-                           absl::Duration dp_output_period)
-    : provider_(std::move(provider)), dp_(this, fraction, dp_output_period) {
+                           absl::Duration dp_output_period,
+                           absl::Duration flush_period)
+    : provider_(std::move(provider)),
+      buffer_(this, flush_period),
+      dp_(this, fraction, dp_output_period) {
   if (!provider_) {
     ABSL_LOG(WARNING)
         << "MeterProvider is null at initializing, init with default";
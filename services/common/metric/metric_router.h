@@ -15,6 +15,7 @@
 #ifndef SERVICES_COMMON_METRIC_METRIC_ROUTER_H_
 #define SERVICES_COMMON_METRIC_METRIC_ROUTER_H_
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <utility>
@@ -24,6 +25,7 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "opentelemetry/common/key_value_iterable_view.h"
 #include "opentelemetry/metrics/meter.h"
 #include "opentelemetry/metrics/observer_result.h"
@@ -32,12 +34,16 @@
 #include "opentelemetry/nostd/shared_ptr.h"
 #include "services/common/metric/definition.h"
 #include "services/common/metric/dp.h"
+#include "services/common/metric/thread_local_buffer.h"
 
 namespace privacy_sandbox::server_common::metric {
 
+inline constexpr absl::Duration kDefaultMetricFlushPeriod = absl::Seconds(1);
+
 // `MetricRouter` should only be used by `Context`. It provides the api to
 // process metric values categorized as safe/unsafe. It handles metric data flow
-// into OTel, and DP aggregation.
+// into OTel, and DP aggregation. Safe metric values are buffered per thread
+// and flushed into OTel every `flush_period`.
 class MetricRouter {
  public:
   using Meter = ::opentelemetry::metrics::Meter;
@@ -45,7 +51,8 @@ class MetricRouter {
 
   MetricRouter(std::unique_ptr<MeterProvider> provider,
                absl::string_view service, absl::string_view version,
-               PrivacyBudget fraction, absl::Duration dp_output_period);
+               PrivacyBudget fraction, absl::Duration dp_output_period,
+               absl::Duration flush_period = kDefaultMetricFlushPeriod);
 
   ~MetricRouter() = default;
 
@@ -99,6 +106,14 @@ class MetricRouter {
   T* GetInstrument(absl::string_view metric_name,
                    absl::AnyInvocable<std::unique_ptr<T>() &&> create_new);
 
+  // Exports a value buffered by `buffer_` into the instrument of
+  // `definition_name`, which must be a `Definition<T, privacy, instrument>`.
+  template <typename T, Privacy privacy, Instrument instrument>
+  static void ExportBuffered(MetricRouter& metric_router,
+                             const DefinitionName& definition_name,
+                             double value,
+                             const internal::Attribute& attribute);
+
   absl::Mutex mutex_;
   absl::flat_hash_map<
       std::string,
@@ -110,6 +125,8 @@ class MetricRouter {
       observerable_;
   std::unique_ptr<MeterProvider> provider_;
   Meter* meter_;
+  // Destructed after `dp_`, to flush what `dp_` outputs at destruction.
+  ThreadLocalBuffer<MetricRouter> buffer_;
   DifferentiallyPrivate<MetricRouter> dp_;
 };
 
@@ -180,16 +197,18 @@ absl::Status MetricRouter::LogSafe(
     const Definition<T, privacy, instrument>& definition, T value,
     absl::string_view partition,
     absl::flat_hash_map<std::string, std::string> attribute) {
-  absl::string_view metric_name = definition.name_;
-  if constexpr (instrument == Instrument::kHistogram) {
-    GetHistogramInstrument(metric_name, value, definition)
-        ->Record(value, opentelemetry::common::KeyValueIterableView(attribute),
-                 opentelemetry::context::Context());
-  } else if constexpr (instrument == Instrument::kUpDownCounter) {
-    GetCounterInstrument(metric_name, value)->Add(value, attribute);
-  } else if constexpr (instrument == Instrument::kPartitionedCounter) {
+  if constexpr (instrument == Instrument::kPartitionedCounter) {
     attribute.emplace(definition.partition_type_, partition);
-    GetCounterInstrument(metric_name, value)->Add(value, attribute);
+  }
+  internal::Attribute sorted_attribute(attribute.begin(), attribute.end());
+  std::sort(sorted_attribute.begin(), sorted_attribute.end());
+  if constexpr (instrument == Instrument::kHistogram) {
+    buffer_.AddHistogram(&definition, value, std::move(sorted_attribute),
+                         &ExportBuffered<T, privacy, instrument>);
+  } else if constexpr (instrument == Instrument::kUpDownCounter ||
+                       instrument == Instrument::kPartitionedCounter) {
+    buffer_.AddCounter(&definition, value, std::move(sorted_attribute),
+                       &ExportBuffered<T, privacy, instrument>);
   } else if constexpr (instrument == Instrument::kGauge) {
     return absl::UnimplementedError("gauge not done");
   } else {
@@ -198,6 +217,27 @@ absl::Status MetricRouter::LogSafe(
   return absl::OkStatus();
 }
 
+template <typename T, Privacy privacy, Instrument instrument>
+void MetricRouter::ExportBuffered(MetricRouter& metric_router,
+                                  const DefinitionName& definition_name,
+                                  double value,
+                                  const internal::Attribute& attribute) {
+  const auto& definition =
+      static_cast<const Definition<T, privacy, instrument>&>(definition_name);
+  absl::string_view metric_name = definition.name_;
+  if constexpr (instrument == Instrument::kHistogram) {
+    metric_router
+        .GetHistogramInstrument(metric_name, static_cast<T>(value), definition)
+        ->Record(static_cast<T>(value),
+                 opentelemetry::common::KeyValueIterableView(attribute),
+                 opentelemetry::context::Context());
+  } else {
+    metric_router.GetCounterInstrument(metric_name, static_cast<T>(value))
+        ->Add(static_cast<T>(value),
+              opentelemetry::common::KeyValueIterableView(attribute));
+  }
+}
+
 template <typename T, Privacy privacy, Instrument instrument>
 absl::Status MetricRouter::LogUnSafe(
     const Definition<T, privacy, instrument>& definition, T value,
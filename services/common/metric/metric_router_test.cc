@@ -17,6 +17,7 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "absl/container/flat_hash_set.h"
@@ -118,6 +119,24 @@ TEST_F(MetricRouterTest, LogSafeIntTwice) {
   EXPECT_THAT(output, ContainsRegex("value[ \t]+:[ \t]+246"));
 }
 
+TEST_F(MetricRouterTest, LogSafeIntFromManyThreads) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([this]() {
+      for (int j = 0; j < 25; ++j) {
+        CHECK_OK(test_instance_->LogSafe(kSafeCounter, 1, ""));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  std::string output = ReadSs();
+  EXPECT_THAT(output,
+              ContainsRegex("instrument name[ \t]+:[ \t]+safe_counter"));
+  EXPECT_THAT(output, ContainsRegex("value[ \t]+:[ \t]+100"));
+}
+
 TEST_F(MetricRouterTest, LogSafeDouble) {
   CHECK_OK(test_instance_->LogSafe(kSafeCounterDouble, 4.56, ""));
   std::string output = ReadSs();
@@ -0,0 +1,91 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_METRIC_PER_THREAD_H_
+#define SERVICES_COMMON_METRIC_PER_THREAD_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::server_common::metric::internal {
+
+// `PerThread` holds one default constructed `T` for each thread calling
+// `Get()`, and lets another thread visit all of them to drain what they hold.
+// `T` is shared with the threads using it, so it must be thread-safe itself.
+template <typename T>
+class PerThread {
+ public:
+  PerThread() : id_(next_id_.fetch_add(1, std::memory_order_relaxed)) {}
+
+  // PerThread is neither copyable nor movable
+  PerThread(const PerThread&) = delete;
+  PerThread& operator=(const PerThread&) = delete;
+
+  // Returns the `T` of the calling thread, creating it on first use. Only
+  // takes a lock the first time a thread calls it.
+  T& Get() ABSL_LOCKS_EXCLUDED(mutex_) {
+    // Keyed by `id_` rather than `this`, so that a new `PerThread` at the
+    // address of a destructed one does not reuse its `T`.
+    thread_local absl::flat_hash_map<uint64_t, std::shared_ptr<T>> per_thread;
+    thread_local uint64_t last_id = 0;
+    thread_local T* last = nullptr;
+    if (last_id == id_) {
+      return *last;
+    }
+    std::shared_ptr<T>& each = per_thread[id_];
+    if (each == nullptr) {
+      each = std::make_shared<T>();
+      absl::MutexLock mutex_lock(&mutex_);
+      all_.push_back(each);
+    }
+    last_id = id_;
+    last = each.get();
+    return *last;
+  }
+
+  // Returns the `T` of all threads that called `Get()`.
+  std::vector<std::shared_ptr<T>> GetAll() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock mutex_lock(&mutex_);
+    return all_;
+  }
+
+  // Drops the `T` of threads that have exited. Must be called once their
+  // content has been drained and no result of `GetAll()` is held anymore.
+  void RemoveExited() ABSL_LOCKS_EXCLUDED(mutex_) {
+    absl::MutexLock mutex_lock(&mutex_);
+    all_.erase(std::remove_if(all_.begin(), all_.end(),
+                              [](const std::shared_ptr<T>& each) {
+                                return each.use_count() == 1;
+                              }),
+               all_.end());
+  }
+
+ private:
+  // Ids start from 1, since 0 marks no `T` cached yet.
+  static inline std::atomic<uint64_t> next_id_{1};
+
+  const uint64_t id_;
+  absl::Mutex mutex_;
+  std::vector<std::shared_ptr<T>> all_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace privacy_sandbox::server_common::metric::internal
+
+#endif  // SERVICES_COMMON_METRIC_PER_THREAD_H_
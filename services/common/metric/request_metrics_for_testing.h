@@ -0,0 +1,61 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_METRIC_REQUEST_METRICS_FOR_TESTING_H_
+#define SERVICES_COMMON_METRIC_REQUEST_METRICS_FOR_TESTING_H_
+
+#include "absl/log/check.h"
+#include "absl/time/clock.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers::metric {
+
+// Initializes the SFE context map, with metrics logged into a MeterProvider
+// that does not export them.
+inline void InitSfeContextMapForTesting() {
+  server_common::TelemetryConfig config_proto;
+  config_proto.set_mode(server_common::TelemetryConfig::PROD);
+  SfeContextMap(server_common::BuildDependentConfig(config_proto));
+}
+
+// Logs the metrics of one SelectAd request as the SFE does, from the request
+// being received to its context being removed once it is done: the request
+// metrics of the service and those of a request to a BFE.
+inline void LogSfeRequestMetrics(const SelectAdRequest& request,
+                                 const SelectAdResponse& response) {
+  SfeContext& context = SfeContextMap()->Get(&request);
+  LogIfError(
+      context.LogUpDownCounter<server_common::metric::kTotalRequestCount>(1));
+  LogIfError(context.LogHistogramDeferred<
+             server_common::metric::kServerTotalTimeMs>(
+      [start = absl::Now()]() -> int {
+        return (absl::Now() - start) / absl::Milliseconds(1);
+      }));
+  LogIfError(context.LogHistogram<server_common::metric::kRequestByte>(
+      (int)request.ByteSizeLong()));
+  LogIfError(
+      context.LogHistogramDeferred<server_common::metric::kResponseByte>(
+          [&response]() -> int { return response.ByteSizeLong(); }));
+  LogIfError(context.LogUpDownCounterDeferred<
+             server_common::metric::kTotalRequestFailedCount>(
+      [&context]() -> int { return context.is_request_successful() ? 0 : 1; }));
+  MakeInitiatedRequest(kBfe, &context, 0);
+  context.SetRequestSuccessful();
+  CHECK_OK(SfeContextMap()->Remove(&request));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers::metric
+
+#endif  // SERVICES_COMMON_METRIC_REQUEST_METRICS_FOR_TESTING_H_
@@ -20,6 +20,8 @@
 #include <utility>
 
 #include "services/common/metric/context_map.h"
+#include "services/common/util/heap_stats.h"
+#include "services/common/util/huge_pages.h"
 #include "services/common/util/read_system.h"
 #include "services/common/util/reporting_util.h"
 
@@ -31,6 +33,13 @@ inline constexpr server_common::metric::PrivacyBudget server_total_budget{
     /*epsilon*/ 5};
 
 inline constexpr double kPercentHistogram[] = {0.06, 0.12, 0.25, 0.5, 1};
+// Buckets, in microseconds, of the durations of the phases serving a request.
+inline constexpr double kPhaseTimeHistogram[] = {
+    100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000, 100'000,
+    250'000, 500'000, 1'000'000};
+// Buckets, in microseconds, of the durations of the crypto operations.
+inline constexpr double kCryptoTimeHistogram[] = {
+    10, 25, 50, 100, 250, 500, 1'000, 2'500, 5'000, 10'000, 25'000, 50'000};
 
 inline constexpr absl::string_view kAs = "AS";
 inline constexpr absl::string_view kBs = "BS";
@@ -58,6 +67,384 @@ inline constexpr server_common::metric::Definition<
     kJSExecutionErrorCount("js_execution.error.count",
                            "No. of times js execution returned status != OK");
 
+// Observable gauges of the JS dispatcher, read from DispatchStats.
+//
+// They are the inputs to scale the bidding and auction fleets on, as CPU does
+// not tell V8 workers blocked or collecting garbage from idle ones: scale out
+// when the "busy ratio" of js_execution.worker_utilization nears 1, when
+// js_execution.queue_fill_ratio grows, as requests then wait for a worker,
+// and when js_execution.rejected_count is not zero, as requests are then
+// failing.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kJSExecutionQueueDepth("js_execution.queue_depth",
+                           "No. of requests pending in the JS dispatcher");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kJSExecutionQueueFill(
+        "js_execution.queue_fill_ratio",
+        "Fraction of the JS worker queues (js_worker_queue_len) taken");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kJSExecutionRejectedCount(
+        "js_execution.rejected_count",
+        "No. of requests the JS dispatcher rejected or failed to schedule");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kJSExecutionWorkerUtilization(
+        "js_execution.worker_utilization",
+        "Estimated busy time of the JS dispatcher workers");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kJSExecutionRecentDuration(
+        "js_execution.recent_duration_ms",
+        "Percentiles of the time taken by recent JS dispatcher batches");
+
+// Observable gauge of the heap of the process, read from GetHeapUsage.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kHeapUsage("system.heap.usage",
+               "Bytes allocated, free and mapped by the allocator, and the "
+               "fraction of the bytes held that are free");
+
+// Observable gauge of the huge pages of the process and of the pool of its
+// large buffers, read from GetHugePageUsage.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kHugePageUsage("system.huge_pages.usage",
+                   "Bytes of huge pages of the process, and bytes mapped, "
+                   "idle and backed by huge pages in the large buffer pool");
+
+// Observable gauges of the CPU-bound executors, read from
+// GetWorkStealingExecutorTaskCounts and GetWorkStealingExecutorQueueDepth. A
+// growing queue depth asks for more threads, and a steal count close to the
+// run count for work that is spread over the threads unevenly.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kCpuExecutorTaskCount(
+        "cpu_executor.task_count",
+        "No. of closures run and stolen by the CPU-bound executors");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kCpuExecutorQueueDepth(
+        "cpu_executor.queue_depth",
+        "No. of closures queued on the CPU-bound executors");
+
+// Observable gauge of the work dropped for the requests their caller
+// cancelled, read from GetCancelledWorkCounts.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kCancelledWorkCount(
+        "cancelled_work.count",
+        "No. of HTTP fetches, RPCs and Roma requests of cancelled requests "
+        "that were aborted or dropped");
+
+// Observable gauge of the HTTP fetchers, read from GetHttpConnectionReuse.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kInitiatedRequestConnectionCount(
+        "initiated_request.connection_count",
+        "No. of HTTP requests sent over a reused or a new connection");
+
+// Observable gauge of the Key-Value caches, read from GetKeyValueCacheStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kKVCacheEventCount("kv_cache.event_count",
+                       "No. of Key-Value cache hits, misses and evictions");
+
+// Observable gauge of the signal blob caches, read from
+// GetSignalBlobCacheStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kSignalBlobCacheEventCount(
+        "signal_blob_cache.event_count",
+        "No. of signal blob cache hits, misses and evictions");
+
+// Observable gauge of the hedging Key-Value fetchers, read from
+// GetHedgingStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kKVHedgingEventCount(
+        "kv_hedging.event_count",
+        "No. of Key-Value fetches hedged, won by the hedge and not hedged "
+        "for lack of budget");
+
+// Observable gauge of the sharded Key-Value lookups, read from
+// GetKeyValueShardErrorCounts.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kKVShardErrorCount("kv_shard.error_count",
+                       "No. of failed Key-Value lookups, per shard");
+
+// Observable gauge of the buyers whose GetBids call missed its budget, read
+// from GetLateBuyerCounts.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kSfeLateBuyerCount("sfe.late_buyer.count",
+                       "No. of GetBids calls that timed out, per buyer");
+
+// Observable gauges of the circuit breakers of the backends, read from
+// GetCircuitBreakerStates and GetCircuitBreakerRejectedCounts.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kCircuitBreakerState(
+        "circuit_breaker.state",
+        "State of the circuit of each backend: 0 closed, 1 open, 2 half open");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kCircuitBreakerRejectedCount(
+        "circuit_breaker.rejected_count",
+        "No. of calls rejected while the circuit of the backend was open");
+
+// Observable gauges of the calls mirrored to shadow backends, read from
+// GetMirroredCallCounts and GetMirroredCallLatencies.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kShadowTrafficCallCount(
+        "shadow_traffic.call_count",
+        "No. of mirrored calls that succeeded and failed, on the primary and "
+        "the shadow backends");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kShadowTrafficLatencyMs(
+        "shadow_traffic.latency_ms",
+        "Mean latency of the successful mirrored calls, on the primary and "
+        "the shadow backends");
+
+// Observable gauge of the OHTTP gateway caches, read from
+// GetOhttpGatewayCacheStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kOhttpGatewayCacheEventCount("ohttp_gateway_cache.event_count",
+                                 "No. of OHTTP gateway cache hits and misses");
+
+// Observable gauge of the crypto worker pools, read from
+// GetCryptoWorkerPoolQueueDepth.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kCryptoWorkerPoolQueueDepth(
+        "crypto_worker_pool.queue_depth",
+        "No. of crypto operations pending in the crypto worker pool");
+
+// Observable gauges of the reporting pipelines, read from
+// GetReportingQueueSize and GetReportingEvents.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kReportingQueueSize("reporting.queue_size",
+                        "No. of debug and win reports queued and in flight");
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kReportingEventCount(
+        "reporting.event_count",
+        "No. of debug and win reports dropped, retried and failed");
+
+// Observable gauge of the debug report limiters, read from
+// GetDebugLossReportCounts.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kDebugLossReportCount(
+        "debug_reporting.loss_report_count",
+        "No. of debug loss reports emitted and suppressed by the limits");
+
+// Observable gauge of the requests sent to other servers, read from
+// GetMessageCompressionStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kGrpcMessageCompression(
+        "initiated_request.message_compression",
+        "No. of requests sent compressed and uncompressed by hop, with the "
+        "compression ratio and time of a sample");
+
+// Observable gauge of the gRPC server configuration in use, read from
+// GetGrpcServerOptionValues.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kGrpcServerOptions(
+        "grpc_server.options",
+        "Max threads, memory quota, completion queues and max concurrent "
+        "streams of the gRPC server");
+
+// Observable gauge of the adaptive concurrency limit of the server, read from
+// GetConcurrencyLimiterStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kConcurrencyLimiterState(
+        "concurrency_limiter.state",
+        "Concurrency limit, requests in flight and requests shed");
+
+// Observable gauge of the memory pressure stage of the server, read from
+// GetMemoryGovernorStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kMemoryGovernorState(
+        "memory_governor.state",
+        "Memory pressure stage and fraction used of the memory limit");
+
+// Observable gauge of the requests over their memory budget, rejected or
+// trimmed, read from GetRequestMemoryBudgetStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kRequestMemoryBudgetState(
+        "request_memory_budget.state",
+        "Requests rejected or trimmed for exceeding their memory budget");
+
+// Observable gauge of the stages of the slowest request past the p99.9
+// latency since the last export, read from GetSlowRequestStats.
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kGauge>
+    kSlowRequestStages(
+        "slow_request.stage_ms",
+        "Latency of each stage of the slowest request past the p99.9 latency");
+
+// Crypto operations of the hop a request is received on, by the server
+// decrypting the request and encrypting the response.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kHpkeDecryptDuration(
+        "crypto.hpke_decrypt.duration_us",
+        "Time taken to decrypt the request",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kHpkeDecryptSize(
+        "crypto.hpke_decrypt.size_bytes",
+        "Size of the ciphertext of the request",
+        server_common::metric::kSizeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAeadEncryptDuration(
+        "crypto.aead_encrypt.duration_us",
+        "Time taken to encrypt the response",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAeadEncryptSize(
+        "crypto.aead_encrypt.size_bytes",
+        "Size of the ciphertext of the response",
+        server_common::metric::kSizeHistogram);
+
+// Crypto operations of the hops of the requests initiated to other servers,
+// summed over the calls to a server for a request.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBfeHpkeEncryptDuration(
+        "initiated_request.bfe.hpke_encrypt.duration_us",
+        "Time taken to encrypt the requests to BFE",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBfeHpkeEncryptSize(
+        "initiated_request.bfe.hpke_encrypt.size_bytes",
+        "Size of the ciphertexts of the requests to BFE",
+        server_common::metric::kSizeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBfeAeadDecryptDuration(
+        "initiated_request.bfe.aead_decrypt.duration_us",
+        "Time taken to decrypt the responses from BFE",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBfeAeadDecryptSize(
+        "initiated_request.bfe.aead_decrypt.size_bytes",
+        "Size of the ciphertexts of the responses from BFE",
+        server_common::metric::kSizeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBiddingHpkeEncryptDuration(
+        "initiated_request.bidding.hpke_encrypt.duration_us",
+        "Time taken to encrypt the requests to Bidding server",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBiddingHpkeEncryptSize(
+        "initiated_request.bidding.hpke_encrypt.size_bytes",
+        "Size of the ciphertexts of the requests to Bidding server",
+        server_common::metric::kSizeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBiddingAeadDecryptDuration(
+        "initiated_request.bidding.aead_decrypt.duration_us",
+        "Time taken to decrypt the responses from Bidding server",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestBiddingAeadDecryptSize(
+        "initiated_request.bidding.aead_decrypt.size_bytes",
+        "Size of the ciphertexts of the responses from Bidding server",
+        server_common::metric::kSizeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestAuctionHpkeEncryptDuration(
+        "initiated_request.auction.hpke_encrypt.duration_us",
+        "Time taken to encrypt the requests to Auction server",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestAuctionHpkeEncryptSize(
+        "initiated_request.auction.hpke_encrypt.size_bytes",
+        "Size of the ciphertexts of the requests to Auction server",
+        server_common::metric::kSizeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestAuctionAeadDecryptDuration(
+        "initiated_request.auction.aead_decrypt.duration_us",
+        "Time taken to decrypt the responses from Auction server",
+        kCryptoTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kInitiatedRequestAuctionAeadDecryptSize(
+        "initiated_request.auction.aead_decrypt.size_bytes",
+        "Size of the ciphertexts of the responses from Auction server",
+        server_common::metric::kSizeHistogram);
+
 inline constexpr server_common::metric::Definition<
     int, server_common::metric::Privacy::kNonImpacting,
     server_common::metric::Instrument::kHistogram>
@@ -80,6 +467,31 @@ inline constexpr server_common::metric::Definition<
         "Total duration request takes to get response back from Auction server",
         server_common::metric::kTimeHistogram);
 
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kBfeProtectedAudienceDuration(
+        "bfe.protected_audience.duration_ms",
+        "Time from the start of a GetBids request until its Protected "
+        "Audience bids are generated",
+        server_common::metric::kTimeHistogram);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kBfeProtectedAppSignalsDuration(
+        "bfe.protected_app_signals.duration_ms",
+        "Time from the start of a GetBids request until its Protected App "
+        "Signals bids are generated",
+        server_common::metric::kTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kUpDownCounter>
+    kBfeChaffRequestCount(
+        "bfe.chaff_request.count",
+        "Total number of chaff GetBids requests answered with an empty "
+        "response, without fetching bidding signals or generating bids");
+
 inline constexpr server_common::metric::Definition<
     int, server_common::metric::Privacy::kNonImpacting,
     server_common::metric::Instrument::kHistogram>
@@ -113,6 +525,47 @@ inline constexpr server_common::metric::Definition<
         /*partition_type*/ "server name",
         /* public_partitions*/ kServerName);
 
+// Metrics of the GetBids calls of the SFE partitioned by buyer, to attribute
+// the tail latency of the auctions to the buyers. Only the buyers the SFE has
+// a client for are partitions, which bounds their number by the config.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kPartitionedCounter>
+    kSfeBuyerGetBidsLatencyCount(
+        /*name*/ "sfe.buyer.get_bids_latency.count",
+        /*description*/
+        "No. of GetBids calls partitioned by buyer and latency bucket, as "
+        "<buyer>|<upper bound of the bucket in ms>",
+        /*partition_type*/ "buyer|latency_ms",
+        /*public_partitions*/ server_common::metric::kEmptyPublicPartition);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kPartitionedCounter>
+    kSfeBuyerBidCount(
+        /*name*/ "sfe.buyer.bid.count",
+        /*description*/ "No. of bids received partitioned by buyer",
+        /*partition_type*/ "buyer",
+        /*public_partitions*/ server_common::metric::kEmptyPublicPartition);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kPartitionedCounter>
+    kSfeBuyerResponseSize(
+        /*name*/ "sfe.buyer.response.size_bytes",
+        /*description*/
+        "Size of the GetBids responses in Bytes partitioned by buyer",
+        /*partition_type*/ "buyer",
+        /*public_partitions*/ server_common::metric::kEmptyPublicPartition);
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kPartitionedCounter>
+    kSfeBuyerCriticalPathCount(
+        /*name*/ "sfe.buyer.critical_path.count",
+        /*description*/
+        "No. of auctions partitioned by the buyer whose GetBids call ended "
+        "last, holding up the scoring",
+        /*partition_type*/ "buyer",
+        /*public_partitions*/ server_common::metric::kEmptyPublicPartition);
+
 inline constexpr server_common::metric::Definition<
     int, server_common::metric::Privacy::kNonImpacting,
     server_common::metric::Instrument::kUpDownCounter>
@@ -120,6 +573,32 @@ inline constexpr server_common::metric::Definition<
         "business_logic.bidding.zero_bid.count",
         "Total number of times bidding service returns a zero bid");
 
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kUpDownCounter>
+    kBiddingShedInterestGroupCount(
+        "business_logic.bidding.shed_interest_group.count",
+        "Total number of interest groups not dispatched because the code "
+        "dispatcher queue was full");
+
+// What the per interest group limits of the bidding service truncated.
+inline constexpr absl::string_view kBiddingTruncations[] = {
+    "ad_components",
+    "ads",
+    "interest_groups",
+};
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kPartitionedCounter>
+    kBiddingTruncatedCount(
+        /*name*/ "business_logic.bidding.truncated.count",
+        /*description*/
+        "Total number of ads, ad components and interest groups left out of "
+        "the generateBid() arguments by the configured limits",
+        /*partition_type*/ "truncation",
+        /*public_partitions*/ kBiddingTruncations);
+
 inline constexpr server_common::metric::Definition<
     double, server_common::metric::Privacy::kNonImpacting,
     server_common::metric::Instrument::kHistogram>
@@ -173,6 +652,164 @@ inline constexpr server_common::metric::Definition<
         /*description*/
         "Total number of bids used to score in auction service");
 
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kUpDownCounter>
+    kAuctionAdMetadataCacheHitCount(
+        /*name*/ "business_logic.auction.ad_metadata_cache.hit.count",
+        /*description*/
+        "Total number of ads whose metadata JSON was served from the cache");
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kUpDownCounter>
+    kAuctionAdMetadataCacheMissCount(
+        /*name*/ "business_logic.auction.ad_metadata_cache.miss.count",
+        /*description*/
+        "Total number of ads whose metadata had to be converted to JSON");
+
+inline constexpr server_common::metric::Definition<
+    double, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAuctionAdMetadataCacheHitPercent(
+        /*name*/ "business_logic.auction.ad_metadata_cache.hit.percent",
+        /*description*/
+        "Percentage of ads in a request served from the ad metadata cache",
+        kPercentHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kUpDownCounter>
+    kAuctionScoreAdResultCacheHitCount(
+        /*name*/ "business_logic.auction.score_ad_result_cache.hit.count",
+        /*description*/
+        "Total number of ads whose scoreAd() output was served from the cache");
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kUpDownCounter>
+    kAuctionScoreAdResultCacheMissCount(
+        /*name*/ "business_logic.auction.score_ad_result_cache.miss.count",
+        /*description*/
+        "Total number of ads dispatched to scoreAd() with the cache enabled");
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kBiddingBuildInputDuration(
+        /*name*/ "business_logic.bidding.build_input.duration_us",
+        /*description*/
+        "Time taken to build the generateBid dispatch requests",
+        kPhaseTimeHistogram);
+
+// Privacy impacting, as the time a generateBid() call takes depends on the
+// interest group of the user. Logged once per request.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kBiddingGenerateBidMaxDuration(
+        /*name*/ "bidding.generate_bid.max_duration_ms",
+        /*description*/
+        "Time the slowest generateBid() call of a request took, as the buyer "
+        "code wrapper measured it",
+        server_common::metric::kTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kBiddingDispatchDuration(
+        /*name*/ "business_logic.bidding.dispatch.duration_us",
+        /*description*/
+        "Time from dispatching the generateBid requests until they all return",
+        kPhaseTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kBiddingHandleResponseDuration(
+        /*name*/ "business_logic.bidding.handle_response.duration_us",
+        /*description*/
+        "Time taken to handle the generateBid dispatch responses",
+        kPhaseTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAuctionBuildInputDuration(
+        /*name*/ "business_logic.auction.build_input.duration_us",
+        /*description*/
+        "Time taken to build the scoreAd dispatch requests",
+        kPhaseTimeHistogram);
+
+// Privacy impacting, as the time a scoreAd() call takes depends on the bids
+// of the user. Logged once per request.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAuctionScoreAdMaxDuration(
+        /*name*/ "auction.score_ad.max_duration_ms",
+        /*description*/
+        "Time the slowest scoreAd() call of a request took, as the seller code "
+        "wrapper measured it",
+        server_common::metric::kTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAuctionDispatchDuration(
+        /*name*/ "business_logic.auction.dispatch.duration_us",
+        /*description*/
+        "Time from dispatching the scoreAd requests until they all return",
+        kPhaseTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kAuctionHandleResponseDuration(
+        /*name*/ "business_logic.auction.handle_response.duration_us",
+        /*description*/
+        "Time taken to handle the scoreAd dispatch responses",
+        kPhaseTimeHistogram);
+
+// Stages of a request its CPU time is accounted to, see
+// services/common/util/request_cpu_time.h.
+inline constexpr absl::string_view kCpuStages[] = {
+    "decrypt", "encrypt", "handle_response", "prepare",
+};
+
+// CPU time of a request, summed over the threads and callbacks serving it. The
+// JS executions it dispatched to Roma are not included, see
+// kRequestDispatchWallTime.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kRequestCpuTime(
+        /*name*/ "request.cpu_time_us",
+        /*description*/
+        "CPU time used to serve a request, excluding its JS executions",
+        kPhaseTimeHistogram);
+
+// Wall time the JS executions of a request took in Roma, whose CPU time Roma
+// does not report, summed over its dispatches.
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kHistogram>
+    kRequestDispatchWallTime(
+        /*name*/ "request.dispatch_wall_time_us",
+        /*description*/
+        "Wall time the JS executions of a request took in Roma",
+        kPhaseTimeHistogram);
+
+inline constexpr server_common::metric::Definition<
+    int, server_common::metric::Privacy::kNonImpacting,
+    server_common::metric::Instrument::kPartitionedCounter>
+    kRequestCpuTimeByStage(
+        /*name*/ "request.cpu_time_by_stage_us",
+        /*description*/
+        "Total CPU time used to serve the requests partitioned by stage",
+        /*partition_type*/ "stage",
+        /*public_partitions*/ kCpuStages);
+
 // API to get `Context` for bidding server to log metric
 inline constexpr const server_common::metric::DefinitionName*
     kBiddingMetricList[] = {
@@ -184,8 +821,21 @@ inline constexpr const server_common::metric::DefinitionName*
         &kBiddingTotalBidsCount,
         &kBiddingZeroBidCount,
         &kBiddingZeroBidPercent,
+        &kBiddingShedInterestGroupCount,
+        &kBiddingTruncatedCount,
+        &kBiddingBuildInputDuration,
+        &kBiddingGenerateBidMaxDuration,
+        &kBiddingDispatchDuration,
+        &kBiddingHandleResponseDuration,
         &kJSExecutionDuration,
         &kJSExecutionErrorCount,
+        &kHpkeDecryptDuration,
+        &kHpkeDecryptSize,
+        &kAeadEncryptDuration,
+        &kAeadEncryptSize,
+        &kRequestCpuTime,
+        &kRequestCpuTimeByStage,
+        &kRequestDispatchWallTime,
 };
 inline constexpr absl::Span<const server_common::metric::DefinitionName* const>
     kBiddingMetricSpan = kBiddingMetricList;
@@ -217,6 +867,19 @@ inline constexpr const server_common::metric::DefinitionName* kBfeMetricList[] =
         &kInitiatedRequestBiddingDuration,
         &kInitiatedRequestKVSize,
         &kInitiatedRequestBiddingSize,
+        &kBfeProtectedAudienceDuration,
+        &kBfeProtectedAppSignalsDuration,
+        &kBfeChaffRequestCount,
+        &kHpkeDecryptDuration,
+        &kHpkeDecryptSize,
+        &kAeadEncryptDuration,
+        &kAeadEncryptSize,
+        &kInitiatedRequestBiddingHpkeEncryptDuration,
+        &kInitiatedRequestBiddingHpkeEncryptSize,
+        &kInitiatedRequestBiddingAeadDecryptDuration,
+        &kInitiatedRequestBiddingAeadDecryptSize,
+        &kRequestCpuTime,
+        &kRequestCpuTimeByStage,
 };
 inline constexpr absl::Span<const server_common::metric::DefinitionName* const>
     kBfeMetricSpan = kBfeMetricList;
@@ -245,9 +908,23 @@ inline constexpr const server_common::metric::DefinitionName* kSfeMetricList[] =
         &server_common::metric::kInitiatedRequestByte,
         &kInitiatedRequestKVDuration,
         &kInitiatedRequestCountByServer,
+        &kSfeBuyerGetBidsLatencyCount,
+        &kSfeBuyerBidCount,
+        &kSfeBuyerResponseSize,
+        &kSfeBuyerCriticalPathCount,
         &kInitiatedRequestAuctionDuration,
         &kInitiatedRequestKVSize,
         &kInitiatedRequestAuctionSize,
+        &kInitiatedRequestBfeHpkeEncryptDuration,
+        &kInitiatedRequestBfeHpkeEncryptSize,
+        &kInitiatedRequestBfeAeadDecryptDuration,
+        &kInitiatedRequestBfeAeadDecryptSize,
+        &kInitiatedRequestAuctionHpkeEncryptDuration,
+        &kInitiatedRequestAuctionHpkeEncryptSize,
+        &kInitiatedRequestAuctionAeadDecryptDuration,
+        &kInitiatedRequestAuctionAeadDecryptSize,
+        &kRequestCpuTime,
+        &kRequestCpuTimeByStage,
 };
 inline constexpr absl::Span<const server_common::metric::DefinitionName* const>
     kSfeMetricSpan = kSfeMetricList;
@@ -273,8 +950,24 @@ inline constexpr const server_common::metric::DefinitionName*
         &kAuctionTotalBidsCount,
         &kAuctionBidRejectedCount,
         &kAuctionBidRejectedPercent,
+        &kAuctionAdMetadataCacheHitCount,
+        &kAuctionAdMetadataCacheMissCount,
+        &kAuctionAdMetadataCacheHitPercent,
+        &kAuctionScoreAdResultCacheHitCount,
+        &kAuctionScoreAdResultCacheMissCount,
+        &kAuctionBuildInputDuration,
+        &kAuctionScoreAdMaxDuration,
+        &kAuctionDispatchDuration,
+        &kAuctionHandleResponseDuration,
         &kJSExecutionDuration,
         &kJSExecutionErrorCount,
+        &kHpkeDecryptDuration,
+        &kHpkeDecryptSize,
+        &kAeadEncryptDuration,
+        &kAeadEncryptSize,
+        &kRequestCpuTime,
+        &kRequestCpuTimeByStage,
+        &kRequestDispatchWallTime,
 };
 inline constexpr absl::Span<const server_common::metric::DefinitionName* const>
     kAuctionMetricSpan = kAuctionMetricList;
@@ -390,6 +1083,8 @@ inline void AddSystemMetric(T* context_map) {
                                server_common::GetCpu);
   context_map->AddObserverable(server_common::metric::kMemoryKB,
                                server_common::GetMemory);
+  context_map->AddObserverable(metric::kHeapUsage, GetHeapUsage);
+  context_map->AddObserverable(metric::kHugePageUsage, GetHugePageUsage);
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,207 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_METRIC_THREAD_LOCAL_BUFFER_H_
+#define SERVICES_COMMON_METRIC_THREAD_LOCAL_BUFFER_H_
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "services/common/metric/definition.h"
+#include "services/common/metric/per_thread.h"
+
+namespace privacy_sandbox::server_common::metric {
+
+namespace internal {
+// Attributes of a buffered value, sorted by key so that equal attribute sets
+// are buffered together.
+using Attribute = std::vector<std::pair<std::string, std::string>>;
+}  // namespace internal
+
+/*
+`ThreadLocalBuffer` buffers the safe metric values logged by each thread, so
+that logging a value only takes the uncontended lock of the thread's own
+buffer instead of the lock of the instruments shared by all threads. The
+buffers are flushed into the OTel instruments of `TMetricRouter` every
+`flush_period`, and once more when `ThreadLocalBuffer` is destructed.
+
+Counter values are summed per definition and attributes. Histogram values are
+kept one by one, since an OTel histogram can only record single values. A
+thread that buffers `max_buffered_values` histogram values or counter sums
+flushes its own buffer, so that a buffer never grows past that between two
+periodic flushes.
+*/
+template <typename TMetricRouter>
+class ThreadLocalBuffer {
+ public:
+  // Exports a buffered value of `definition` into its instrument. Each
+  // `Definition` type gets its own function, so the instrument type is known
+  // at compile time.
+  using ExportFn = void (*)(TMetricRouter& metric_router,
+                            const DefinitionName& definition, double value,
+                            const internal::Attribute& attribute);
+
+  static constexpr int kDefaultMaxBufferedValues = 1024;
+
+  ThreadLocalBuffer(TMetricRouter* metric_router, absl::Duration flush_period,
+                    int max_buffered_values = kDefaultMaxBufferedValues)
+      : metric_router_(metric_router),
+        flush_period_(flush_period),
+        max_buffered_values_(max_buffered_values),
+        run_flush_(std::thread([this]() { RunFlush(); })) {}
+
+  ~ThreadLocalBuffer() {
+    stop_signal_.Notify();
+    run_flush_.join();
+  }
+
+  // ThreadLocalBuffer is neither copyable nor movable
+  ThreadLocalBuffer(const ThreadLocalBuffer&) = delete;
+  ThreadLocalBuffer& operator=(const ThreadLocalBuffer&) = delete;
+
+  // Adds `value` to the sum of counter `definition` with `attribute`.
+  // `definition` not owned, must out live `ThreadLocalBuffer`.
+  void AddCounter(const DefinitionName* definition, double value,
+                  internal::Attribute attribute, ExportFn export_fn)
+      ABSL_LOCKS_EXCLUDED(flush_mutex_) {
+    Buffer& buffer = buffers_.Get();
+    bool full;
+    {
+      absl::MutexLock mutex_lock(&buffer.mutex);
+      auto [it, inserted] = buffer.counter.try_emplace(
+          CounterKey{definition, std::move(attribute)},
+          CounterSum{0, export_fn});
+      it->second.sum += value;
+      full = buffer.counter.size() >= max_buffered_values_;
+    }
+    if (full) {
+      absl::MutexLock flush_lock(&flush_mutex_);
+      FlushBuffer(buffer);
+    }
+  }
+
+  // Adds `value` to be recorded in histogram `definition` with `attribute`.
+  // `definition` not owned, must out live `ThreadLocalBuffer`.
+  void AddHistogram(const DefinitionName* definition, double value,
+                    internal::Attribute attribute, ExportFn export_fn)
+      ABSL_LOCKS_EXCLUDED(flush_mutex_) {
+    Buffer& buffer = buffers_.Get();
+    bool full;
+    {
+      absl::MutexLock mutex_lock(&buffer.mutex);
+      buffer.histogram.push_back(
+          HistogramValue{definition, value, std::move(attribute), export_fn});
+      full = buffer.histogram.size() >= max_buffered_values_;
+    }
+    if (full) {
+      absl::MutexLock flush_lock(&flush_mutex_);
+      FlushBuffer(buffer);
+    }
+  }
+
+  // Exports the values buffered by all threads into the instruments.
+  void Flush() ABSL_LOCKS_EXCLUDED(flush_mutex_) {
+    absl::MutexLock flush_lock(&flush_mutex_);
+    std::vector<std::shared_ptr<Buffer>> buffers = buffers_.GetAll();
+    for (const std::shared_ptr<Buffer>& buffer : buffers) {
+      FlushBuffer(*buffer);
+    }
+    buffers.clear();
+    buffers_.RemoveExited();
+  }
+
+ private:
+  struct CounterKey {
+    const DefinitionName* definition;
+    internal::Attribute attribute;
+
+    template <typename H>
+    friend H AbslHashValue(H h, const CounterKey& key) {
+      return H::combine(std::move(h), key.definition, key.attribute);
+    }
+    friend bool operator==(const CounterKey& a, const CounterKey& b) {
+      return a.definition == b.definition && a.attribute == b.attribute;
+    }
+  };
+
+  struct CounterSum {
+    double sum;
+    ExportFn export_fn;
+  };
+
+  struct HistogramValue {
+    const DefinitionName* definition;
+    double value;
+    internal::Attribute attribute;
+    ExportFn export_fn;
+  };
+
+  // Values logged by one thread since the last flush.
+  struct Buffer {
+    absl::Mutex mutex;
+    absl::flat_hash_map<CounterKey, CounterSum> counter ABSL_GUARDED_BY(mutex);
+    std::vector<HistogramValue> histogram ABSL_GUARDED_BY(mutex);
+  };
+
+  // Exports the values buffered by one thread into the instruments.
+  void FlushBuffer(Buffer& buffer) ABSL_EXCLUSIVE_LOCKS_REQUIRED(flush_mutex_) {
+    absl::flat_hash_map<CounterKey, CounterSum> counter;
+    std::vector<HistogramValue> histogram;
+    {
+      absl::MutexLock mutex_lock(&buffer.mutex);
+      counter.swap(buffer.counter);
+      histogram.swap(buffer.histogram);
+    }
+    for (const auto& [key, sum] : counter) {
+      sum.export_fn(*metric_router_, *key.definition, sum.sum, key.attribute);
+    }
+    for (const HistogramValue& value : histogram) {
+      value.export_fn(*metric_router_, *value.definition, value.value,
+                      value.attribute);
+    }
+  }
+
+  // Periodically flush the buffered values
+  void RunFlush() {
+    while (true) {
+      stop_signal_.WaitForNotificationWithTimeout(flush_period_);
+      Flush();
+      if (stop_signal_.HasBeenNotified()) {
+        break;
+      }
+    }
+  }
+
+  TMetricRouter* metric_router_;
+  absl::Duration flush_period_;
+  size_t max_buffered_values_;
+
+  // Serializes flushes, so that values are exported in order.
+  absl::Mutex flush_mutex_;
+  internal::PerThread<Buffer> buffers_;
+
+  absl::Notification stop_signal_;
+  std::thread run_flush_;
+};
+
+}  // namespace privacy_sandbox::server_common::metric
+
+#endif  // SERVICES_COMMON_METRIC_THREAD_LOCAL_BUFFER_H_
@@ -0,0 +1,170 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/metric/thread_local_buffer.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::server_common::metric {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::UnorderedElementsAre;
+
+constexpr Definition<int, Privacy::kNonImpacting, Instrument::kUpDownCounter>
+    kCounter("counter", "description");
+constexpr double kBoundaries[] = {1, 10};
+constexpr Definition<double, Privacy::kNonImpacting, Instrument::kHistogram>
+    kHistogram("histogram", "description", kBoundaries);
+
+struct Exported {
+  std::string name;
+  double value;
+  internal::Attribute attribute;
+
+  friend bool operator==(const Exported& a, const Exported& b) {
+    return a.name == b.name && a.value == b.value && a.attribute == b.attribute;
+  }
+};
+
+class TestMetricRouter {
+ public:
+  static void Export(TestMetricRouter& metric_router,
+                     const DefinitionName& definition, double value,
+                     const internal::Attribute& attribute) {
+    absl::MutexLock mutex_lock(&metric_router.mutex_);
+    metric_router.exported_.push_back(
+        {std::string(definition.name_), value, attribute});
+  }
+
+  std::vector<Exported> exported() {
+    absl::MutexLock mutex_lock(&mutex_);
+    return exported_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<Exported> exported_ ABSL_GUARDED_BY(mutex_);
+};
+
+constexpr absl::Duration kNoPeriodicFlush = absl::Hours(1);
+
+TEST(ThreadLocalBufferTest, SumsCounterPerAttribute) {
+  TestMetricRouter metric_router;
+  ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router, kNoPeriodicFlush);
+  buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+  buffer.AddCounter(&kCounter, 2, {}, &TestMetricRouter::Export);
+  buffer.AddCounter(&kCounter, 5, {{"buyer", "b1"}},
+                    &TestMetricRouter::Export);
+  buffer.Flush();
+  EXPECT_THAT(metric_router.exported(),
+              UnorderedElementsAre(Exported{"counter", 3, {}},
+                                   Exported{"counter", 5, {{"buyer", "b1"}}}));
+}
+
+TEST(ThreadLocalBufferTest, KeepsEachHistogramValue) {
+  TestMetricRouter metric_router;
+  ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router, kNoPeriodicFlush);
+  buffer.AddHistogram(&kHistogram, 1.5, {}, &TestMetricRouter::Export);
+  buffer.AddHistogram(&kHistogram, 20, {}, &TestMetricRouter::Export);
+  buffer.Flush();
+  EXPECT_THAT(metric_router.exported(),
+              ElementsAre(Exported{"histogram", 1.5, {}},
+                          Exported{"histogram", 20, {}}));
+}
+
+TEST(ThreadLocalBufferTest, DoesNotExportTwice) {
+  TestMetricRouter metric_router;
+  ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router, kNoPeriodicFlush);
+  buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+  buffer.Flush();
+  buffer.Flush();
+  EXPECT_THAT(metric_router.exported(),
+              ElementsAre(Exported{"counter", 1, {}}));
+}
+
+TEST(ThreadLocalBufferTest, FlushesAllThreads) {
+  constexpr int kThreads = 8;
+  constexpr int kValuesPerThread = 100;
+  TestMetricRouter metric_router;
+  ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router, kNoPeriodicFlush);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&buffer]() {
+      for (int j = 0; j < kValuesPerThread; ++j) {
+        buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  buffer.Flush();
+  double sum = 0;
+  for (const Exported& exported : metric_router.exported()) {
+    sum += exported.value;
+  }
+  EXPECT_EQ(sum, kThreads * kValuesPerThread);
+}
+
+TEST(ThreadLocalBufferTest, FlushesFullBuffer) {
+  TestMetricRouter metric_router;
+  ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router, kNoPeriodicFlush,
+                                             /*max_buffered_values=*/2);
+  buffer.AddHistogram(&kHistogram, 1.5, {}, &TestMetricRouter::Export);
+  EXPECT_THAT(metric_router.exported(), ElementsAre());
+  buffer.AddHistogram(&kHistogram, 20, {}, &TestMetricRouter::Export);
+  EXPECT_THAT(metric_router.exported(),
+              ElementsAre(Exported{"histogram", 1.5, {}},
+                          Exported{"histogram", 20, {}}));
+  buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+  buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+  EXPECT_EQ(metric_router.exported().size(), 2);
+  buffer.AddCounter(&kCounter, 5, {{"buyer", "b1"}},
+                    &TestMetricRouter::Export);
+  EXPECT_EQ(metric_router.exported().size(), 4);
+}
+
+TEST(ThreadLocalBufferTest, FlushesAtDestruction) {
+  TestMetricRouter metric_router;
+  {
+    ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router,
+                                               kNoPeriodicFlush);
+    buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+  }
+  EXPECT_THAT(metric_router.exported(),
+              ElementsAre(Exported{"counter", 1, {}}));
+}
+
+TEST(ThreadLocalBufferTest, FlushesPeriodically) {
+  TestMetricRouter metric_router;
+  ThreadLocalBuffer<TestMetricRouter> buffer(&metric_router,
+                                             absl::Milliseconds(10));
+  buffer.AddCounter(&kCounter, 1, {}, &TestMetricRouter::Export);
+  while (metric_router.exported().empty()) {
+    absl::SleepFor(absl::Milliseconds(10));
+  }
+  EXPECT_THAT(metric_router.exported(),
+              ElementsAre(Exported{"counter", 1, {}}));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::server_common::metric
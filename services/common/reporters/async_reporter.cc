@@ -14,15 +14,243 @@
 
 #include "services/common/reporters/async_reporter.h"
 
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::atomic<int64_t> queued_reports{0};
+std::atomic<int64_t> in_flight_reports{0};
+std::atomic<int64_t> dropped_reports{0};
+std::atomic<int64_t> retried_reports{0};
+std::atomic<int64_t> failed_reports{0};
+
+// Returns the host of `url`, with its port, if any.
+absl::string_view GetHost(absl::string_view url) {
+  if (size_t scheme_end = url.find("://"); scheme_end != url.npos) {
+    url.remove_prefix(scheme_end + 3);
+  }
+  return url.substr(0, url.find_first_of("/?#"));
+}
+
+// Errors a report may not fail with the next time.
+bool IsTransient(const absl::Status& status) {
+  return absl::IsDeadlineExceeded(status) || absl::IsUnavailable(status) ||
+         absl::IsInternal(status);
+}
 
-constexpr int kNormalTimeoutMs = 5000;
+}  // namespace
+
+AsyncReporter::AsyncReporter(
+    std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+    AsyncReporterOptions options, server_common::Executor* executor)
+    : http_fetcher_async_(std::move(http_fetcher_async)),
+      options_(options),
+      executor_(executor) {}
+
+AsyncReporter::~AsyncReporter() {
+  std::deque<Report> queued;
+  std::vector<Report> cancelled;
+  {
+    absl::MutexLock lock(&mu_);
+    shutdown_ = true;
+    queued.swap(queued_);
+    for (auto it = retries_.begin(); it != retries_.end();) {
+      if (executor_->Cancel(it->second.task_id)) {
+        cancelled.push_back(std::move(it->second.report));
+        retries_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    // The timers that could not be cancelled already fired, and fail their
+    // report now that the reporter is shutting down.
+    mu_.Await(absl::Condition(
+        +[](AsyncReporter* reporter) ABSL_EXCLUSIVE_LOCKS_REQUIRED(
+             reporter->mu_) {
+          return reporter->retries_.empty() &&
+                 reporter->running_retries_ == 0;
+        },
+        this));
+  }
+  queued_reports -= queued.size();
+  for (Report& report : queued) {
+    std::move(report.done_callback)(
+        absl::CancelledError("Reporter is shutting down."));
+  }
+  in_flight_reports -= cancelled.size();
+  for (Report& report : cancelled) {
+    std::move(report.done_callback)(
+        absl::CancelledError("Reporter is shutting down."));
+  }
+  // Fails the reports in flight while the state they complete against is
+  // still alive.
+  http_fetcher_async_.reset();
+}
+
+bool AsyncReporter::pipelined() const {
+  return options_.max_queued_reports > 0 ||
+         options_.max_in_flight_per_host > 0 || options_.max_in_flight > 0 ||
+         options_.max_attempts > 1;
+}
+
+bool AsyncReporter::HasSlot(int host_in_flight) const {
+  return (options_.max_in_flight <= 0 || in_flight_ < options_.max_in_flight) &&
+         (options_.max_in_flight_per_host <= 0 ||
+          host_in_flight < options_.max_in_flight_per_host);
+}
 
 void AsyncReporter::DoReport(
     const HTTPRequest& reporting_request,
     absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>
         done_callback) {
-  http_fetcher_async_->FetchUrl(reporting_request, kNormalTimeoutMs,
-                                std::move(done_callback));
+  if (!pipelined()) {
+    http_fetcher_async_->FetchUrl(reporting_request,
+                                  absl::ToInt64Milliseconds(options_.timeout),
+                                  std::move(done_callback));
+    return;
+  }
+  Report report = {.request = reporting_request,
+                   .host = std::string(GetHost(reporting_request.url)),
+                   .done_callback = std::move(done_callback)};
+  bool send = false;
+  std::optional<Report> dropped;
+  {
+    absl::MutexLock lock(&mu_);
+    auto it = in_flight_by_host_.find(report.host);
+    if (HasSlot(it == in_flight_by_host_.end() ? 0 : it->second)) {
+      ++in_flight_by_host_[report.host];
+      ++in_flight_;
+      send = true;
+    } else if (options_.max_queued_reports <= 0) {
+      dropped = std::move(report);
+    } else {
+      if (queued_.size() >=
+          static_cast<size_t>(options_.max_queued_reports)) {
+        dropped = std::move(queued_.front());
+        queued_.pop_front();
+        --queued_reports;
+      }
+      queued_.push_back(std::move(report));
+      ++queued_reports;
+    }
+  }
+  if (dropped) {
+    ++dropped_reports;
+    std::move(dropped->done_callback)(
+        absl::ResourceExhaustedError("Reporting queue is full."));
+  }
+  if (send) {
+    ++in_flight_reports;
+    Send(std::move(report));
+  }
 }
+
+void AsyncReporter::Send(Report report) {
+  const HTTPRequest request = report.request;
+  http_fetcher_async_->FetchUrl(
+      request, absl::ToInt64Milliseconds(options_.timeout),
+      [this, report = std::move(report)](
+          absl::StatusOr<std::string> result) mutable {
+        OnAttemptDone(std::move(report), std::move(result));
+      });
+}
+
+void AsyncReporter::OnAttemptDone(Report report,
+                                  absl::StatusOr<std::string> result) {
+  ++report.attempts;
+  if (!result.ok() && IsTransient(result.status()) &&
+      report.attempts < options_.max_attempts && executor_ != nullptr) {
+    absl::MutexLock lock(&mu_);
+    if (!shutdown_) {
+      thread_local absl::BitGen bitgen;
+      const absl::Duration backoff = options_.initial_backoff *
+                                     (1 << (report.attempts - 1)) *
+                                     absl::Uniform(bitgen, 0.5, 1.5);
+      ++retried_reports;
+      // The timer finds its report under the lock, once its task id is set.
+      const int64_t retry_id = next_retry_id_++;
+      PendingRetry& retry = retries_[retry_id];
+      retry.report = std::move(report);
+      retry.task_id = executor_->RunAfter(
+          backoff, [this, retry_id]() { Retry(retry_id); });
+      return;
+    }
+  }
+  if (!result.ok()) {
+    ++failed_reports;
+  }
+  const std::string host = std::move(report.host);
+  std::move(report.done_callback)(result);
+  --in_flight_reports;
+  ReleaseSlot(host);
+}
+
+void AsyncReporter::Retry(int64_t retry_id) {
+  std::optional<Report> report;
+  bool shutdown;
+  {
+    absl::MutexLock lock(&mu_);
+    auto node = retries_.extract(retry_id);
+    if (node.empty()) {
+      return;
+    }
+    report = std::move(node.mapped().report);
+    shutdown = shutdown_;
+    ++running_retries_;
+  }
+  if (shutdown) {
+    --in_flight_reports;
+    std::move(report->done_callback)(
+        absl::CancelledError("Reporter is shutting down."));
+  } else {
+    Send(*std::move(report));
+  }
+  absl::MutexLock lock(&mu_);
+  --running_retries_;
+}
+
+void AsyncReporter::ReleaseSlot(absl::string_view host) {
+  std::optional<Report> next;
+  {
+    absl::MutexLock lock(&mu_);
+    --in_flight_;
+    if (auto it = in_flight_by_host_.find(host); --it->second == 0) {
+      in_flight_by_host_.erase(it);
+    }
+    for (auto it = queued_.begin(); it != queued_.end(); ++it) {
+      auto host_it = in_flight_by_host_.find(it->host);
+      if (HasSlot(host_it == in_flight_by_host_.end() ? 0 : host_it->second)) {
+        ++in_flight_by_host_[it->host];
+        ++in_flight_;
+        next = std::move(*it);
+        queued_.erase(it);
+        break;
+      }
+    }
+  }
+  if (next) {
+    --queued_reports;
+    ++in_flight_reports;
+    Send(*std::move(next));
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetReportingQueueSize() {
+  return {{"queued", queued_reports.load()},
+          {"in flight", in_flight_reports.load()}};
+}
+
+absl::flat_hash_map<std::string, double> GetReportingEvents() {
+  return {{"dropped", dropped_reports.exchange(0)},
+          {"retried", retried_reports.exchange(0)},
+          {"failed", failed_reports.exchange(0)}};
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
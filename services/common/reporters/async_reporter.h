@@ -15,36 +15,162 @@
 #ifndef SERVICES_COMMON_ASYNC_REPORTER_H_
 #define SERVICES_COMMON_ASYNC_REPORTER_H_
 
+#include <cstdint>
+#include <deque>
 #include <memory>
 #include <string>
 #include <utility>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
 #include "services/common/clients/http/http_fetcher_async.h"
+#include "services/common/metric/server_definition.h"
+#include "src/cpp/concurrent/executor.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Options of the reporting pipeline of an AsyncReporter. The defaults send
+// every report right away, once.
+struct AsyncReporterOptions {
+  // Most reports waiting for a report less in flight, to their host or to
+  // all the hosts.
+  // The oldest waiting report is dropped to make room for a new one past it.
+  // Reports finding their host busy are dropped if 0.
+  int max_queued_reports = 0;
+  // Most reports in flight to one host, including those waiting to be
+  // retried, so that a burst to one host does not take all the connections.
+  // Unlimited if 0.
+  int max_in_flight_per_host = 0;
+  // Most reports in flight to all the hosts, including those waiting to be
+  // retried. Unlimited if 0.
+  int max_in_flight = 0;
+  // Attempts of a report failing with a transient error, including the
+  // first. Retries need the executor of the reporter.
+  int max_attempts = 1;
+  // Wait before the first retry, doubled for each next one, randomized by
+  // +/-50% so that the retries of a burst do not come back at once.
+  absl::Duration initial_backoff = absl::Milliseconds(200);
+  // Timeout of each attempt.
+  absl::Duration timeout = absl::Milliseconds(5000);
+};
+
+// Pipeline of the debug and win reports of a server, whose reporter lives as
+// long as the server: bounded, limited per host and retrying transient
+// errors.
+inline constexpr AsyncReporterOptions kServerReportingOptions = {
+    .max_queued_reports = 10000,
+    .max_in_flight_per_host = 32,
+    .max_attempts = 3,
+};
+
+// Nice value of the threads dedicated to reporting, if any.
+inline constexpr int kReportingThreadNice = 10;
+
 // Provides functionality to perform asynchronous reporting.
 class AsyncReporter {
  public:
   // Default constructor.
-  explicit AsyncReporter(std::unique_ptr<HttpFetcherAsync> http_fetcher_async) {
-    http_fetcher_async_ = std::move(http_fetcher_async);
-  }
+  // executor: runs the retries, if any. Queued or retried reports must not
+  // outlive the reporter, so reporters with a queue or retries are meant to
+  // live as long as the server.
+  explicit AsyncReporter(std::unique_ptr<HttpFetcherAsync> http_fetcher_async,
+                         AsyncReporterOptions options = {},
+                         server_common::Executor* executor = nullptr);
+
+  // Fails the queued reports and the reports waiting to be retried, then the
+  // reports in flight.
+  virtual ~AsyncReporter();
 
   // Performs reporting by doing a get call on the URL.
   //
   // reporting_request: the request for reporting.
   // done_callback: Output param. Invoked either on error or after finished
-  // receiving a response.
+  // receiving a response. Invoked with RESOURCE_EXHAUSTED if the report was
+  // dropped from a full queue.
   virtual void DoReport(
       const HTTPRequest& reporting_request,
       absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>
           done_callback);
 
  private:
+  using DoneCallback =
+      absl::AnyInvocable<void(absl::StatusOr<absl::string_view>) &&>;
+
+  struct Report {
+    HTTPRequest request;
+    std::string host;
+    DoneCallback done_callback;
+    int attempts = 0;
+  };
+
+  struct PendingRetry {
+    server_common::TaskId task_id;
+    Report report;
+  };
+
+  // Whether reports go through the queue, per host limits and retries.
+  bool pipelined() const;
+
+  // Sends an attempt of a report holding a slot of its host.
+  void Send(Report report);
+
+  // Retries the report if it failed transiently, or else completes it.
+  void OnAttemptDone(Report report, absl::StatusOr<std::string> result)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Sends the report waiting for the retry `retry_id`, or fails it if the
+  // reporter is shutting down.
+  void Retry(int64_t retry_id) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Whether a report to a host with `host_in_flight` reports in flight can
+  // be sent.
+  bool HasSlot(int host_in_flight) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Hands the slot of a completed report to the oldest queued report that
+  // can be sent, if any.
+  void ReleaseSlot(absl::string_view host) ABSL_LOCKS_EXCLUDED(mu_);
+
   std::unique_ptr<HttpFetcherAsync> http_fetcher_async_;
+  const AsyncReporterOptions options_;
+  server_common::Executor* const executor_;
+
+  absl::Mutex mu_;
+  // Reports in flight, or waiting to be retried, by host.
+  absl::flat_hash_map<std::string, int> in_flight_by_host_
+      ABSL_GUARDED_BY(mu_);
+  int in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  // Reports waiting for a slot of their host, oldest first.
+  std::deque<Report> queued_ ABSL_GUARDED_BY(mu_);
+  // Reports waiting for their retry timer, by retry id.
+  absl::flat_hash_map<int64_t, PendingRetry> retries_ ABSL_GUARDED_BY(mu_);
+  int64_t next_retry_id_ ABSL_GUARDED_BY(mu_) = 0;
+  // Retries whose timer fired, still sending or failing their report.
+  int running_retries_ ABSL_GUARDED_BY(mu_) = 0;
+  bool shutdown_ ABSL_GUARDED_BY(mu_) = false;
 };
+
+// Returns the number of reports of all the AsyncReporter instances queued and
+// in flight.
+absl::flat_hash_map<std::string, double> GetReportingQueueSize();
+
+// Returns the number of reports of all the AsyncReporter instances dropped
+// from full queues, retried, and failed after their last attempt, since the
+// previous call.
+absl::flat_hash_map<std::string, double> GetReportingEvents();
+
+template <typename T>
+inline void AddAsyncReporterMetric(T* context_map) {
+  context_map->AddObserverable(metric::kReportingQueueSize,
+                               GetReportingQueueSize);
+  context_map->AddObserverable(metric::kReportingEventCount,
+                               GetReportingEvents);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_COMMON_ASYNC_REPORTER_H_
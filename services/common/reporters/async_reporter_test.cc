@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/strings/string_view.h"
@@ -78,5 +79,185 @@ TEST_F(AsyncReporterTest, DoReportMalformedUrl) {
                       done_cb);
   done.Wait();
 }
+
+// Holds the fetches until the test completes them.
+class FakeHttpFetcherAsync : public HttpFetcherAsync {
+ public:
+  struct Fetch {
+    std::string url;
+    OnDoneFetchUrl done_callback;
+  };
+
+  explicit FakeHttpFetcherAsync(std::vector<Fetch>* fetches)
+      : fetches_(fetches) {}
+
+  void FetchUrl(const HTTPRequest& http_request, int timeout_ms,
+                OnDoneFetchUrl done_callback) override {
+    fetches_->push_back({http_request.url, std::move(done_callback)});
+  }
+  void FetchUrls(const std::vector<HTTPRequest>& requests,
+                 absl::Duration timeout,
+                 OnDoneFetchUrls done_callback) override {}
+
+ private:
+  std::vector<Fetch>* fetches_;
+};
+
+// Holds the delayed closures until the test runs them.
+class FakeExecutor : public server_common::Executor {
+ public:
+  void Run(absl::AnyInvocable<void()> closure) override { closure(); }
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override {
+    delays.push_back(duration);
+    closures.push_back(std::move(closure));
+    return {};
+  }
+  bool Cancel(server_common::TaskId task_id) override { return cancellable; }
+
+  // Whether the delayed closures can still be cancelled.
+  bool cancellable = false;
+  std::vector<absl::Duration> delays;
+  std::vector<absl::AnyInvocable<void()>> closures;
+};
+
+class AsyncReporterPipelineTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<AsyncReporter> CreateReporter(AsyncReporterOptions options) {
+    return std::make_unique<AsyncReporter>(
+        std::make_unique<FakeHttpFetcherAsync>(&fetches_), options,
+        &executor_);
+  }
+
+  // Completes the `index`th fetch sent so far.
+  void Complete(int index, absl::StatusOr<std::string> result) {
+    std::move(fetches_[index].done_callback)(std::move(result));
+  }
+
+  std::vector<FakeHttpFetcherAsync::Fetch> fetches_;
+  FakeExecutor executor_;
+  std::vector<absl::StatusCode> results_;
+};
+
+TEST_F(AsyncReporterPipelineTest, QueuesReportsPastTheLimitOfTheirHost) {
+  auto reporter = CreateReporter(
+      {.max_queued_reports = 10, .max_in_flight_per_host = 1});
+  auto done_cb = [this](absl::StatusOr<absl::string_view> result) {
+    results_.push_back(result.status().code());
+  };
+  reporter->DoReport({"https://a.com/win?x=1", {}}, done_cb);
+  reporter->DoReport({"https://a.com/loss", {}}, done_cb);
+  reporter->DoReport({"https://b.com:8080/win", {}}, done_cb);
+  ASSERT_EQ(fetches_.size(), 2);
+  EXPECT_EQ(fetches_[0].url, "https://a.com/win?x=1");
+  EXPECT_EQ(fetches_[1].url, "https://b.com:8080/win");
+
+  Complete(0, "");
+  ASSERT_EQ(fetches_.size(), 3);
+  EXPECT_EQ(fetches_[2].url, "https://a.com/loss");
+  Complete(1, "");
+  Complete(2, "");
+  EXPECT_THAT(results_, testing::Each(absl::StatusCode::kOk));
+  EXPECT_EQ(results_.size(), 3);
+}
+
+TEST_F(AsyncReporterPipelineTest, QueuesReportsPastTheLimitOfAllHosts) {
+  auto reporter =
+      CreateReporter({.max_queued_reports = 10, .max_in_flight = 1});
+  auto done_cb = [](absl::StatusOr<absl::string_view> result) {};
+  reporter->DoReport({"https://a.com/win", {}}, done_cb);
+  reporter->DoReport({"https://b.com/win", {}}, done_cb);
+  ASSERT_EQ(fetches_.size(), 1);
+
+  Complete(0, "");
+  ASSERT_EQ(fetches_.size(), 2);
+  EXPECT_EQ(fetches_[1].url, "https://b.com/win");
+  Complete(1, "");
+}
+
+TEST_F(AsyncReporterPipelineTest, DropsTheOldestQueuedReportWhenFull) {
+  auto reporter =
+      CreateReporter({.max_queued_reports = 1, .max_in_flight_per_host = 1});
+  std::vector<std::string> dropped;
+  reporter->DoReport({"https://a.com/1", {}},
+                     [](absl::StatusOr<absl::string_view> result) {});
+  for (absl::string_view url : {"https://a.com/2", "https://a.com/3"}) {
+    auto done_cb = [&dropped, url](absl::StatusOr<absl::string_view> result) {
+      if (absl::IsResourceExhausted(result.status())) {
+        dropped.emplace_back(url);
+      }
+    };
+    reporter->DoReport({std::string(url), {}}, done_cb);
+  }
+  EXPECT_THAT(dropped, testing::ElementsAre("https://a.com/2"));
+
+  Complete(0, "");
+  ASSERT_EQ(fetches_.size(), 2);
+  EXPECT_EQ(fetches_[1].url, "https://a.com/3");
+  Complete(1, "");
+}
+
+TEST_F(AsyncReporterPipelineTest, RetriesTransientErrorsWithBackoff) {
+  auto reporter =
+      CreateReporter({.max_attempts = 3,
+                      .initial_backoff = absl::Milliseconds(100)});
+  reporter->DoReport({"https://a.com/win", {}},
+                     [this](absl::StatusOr<absl::string_view> result) {
+                       results_.push_back(result.status().code());
+                     });
+  for (int attempt = 0; attempt < 3; ++attempt) {
+    ASSERT_EQ(fetches_.size(), attempt + 1);
+    Complete(attempt, absl::UnavailableError("unavailable"));
+    if (attempt < 2) {
+      ASSERT_EQ(executor_.closures.size(), attempt + 1);
+      executor_.closures[attempt]();
+    }
+  }
+  ASSERT_EQ(executor_.delays.size(), 2);
+  EXPECT_GE(executor_.delays[0], absl::Milliseconds(50));
+  EXPECT_LT(executor_.delays[0], absl::Milliseconds(150));
+  EXPECT_GE(executor_.delays[1], absl::Milliseconds(100));
+  EXPECT_LT(executor_.delays[1], absl::Milliseconds(300));
+  EXPECT_THAT(results_, testing::ElementsAre(absl::StatusCode::kUnavailable));
+}
+
+TEST_F(AsyncReporterPipelineTest, DoesNotRetryPermanentErrors) {
+  auto reporter = CreateReporter({.max_attempts = 3});
+  reporter->DoReport({"https://a.com/win", {}},
+                     [this](absl::StatusOr<absl::string_view> result) {
+                       results_.push_back(result.status().code());
+                     });
+  Complete(0, absl::InvalidArgumentError("bad url"));
+  EXPECT_TRUE(executor_.closures.empty());
+  EXPECT_THAT(results_,
+              testing::ElementsAre(absl::StatusCode::kInvalidArgument));
+}
+
+TEST_F(AsyncReporterPipelineTest, CancelsQueuedReportsOnDestruction) {
+  auto reporter =
+      CreateReporter({.max_queued_reports = 10, .max_in_flight_per_host = 1});
+  auto done_cb = [this](absl::StatusOr<absl::string_view> result) {
+    results_.push_back(result.status().code());
+  };
+  reporter->DoReport({"https://a.com/1", {}}, done_cb);
+  reporter->DoReport({"https://a.com/2", {}}, done_cb);
+  reporter.reset();
+  EXPECT_THAT(results_, testing::ElementsAre(absl::StatusCode::kCancelled));
+}
+
+TEST_F(AsyncReporterPipelineTest, CancelsPendingRetriesOnDestruction) {
+  auto reporter = CreateReporter({.max_attempts = 3});
+  reporter->DoReport({"https://a.com/win", {}},
+                     [this](absl::StatusOr<absl::string_view> result) {
+                       results_.push_back(result.status().code());
+                     });
+  Complete(0, absl::UnavailableError("unavailable"));
+  ASSERT_EQ(executor_.closures.size(), 1);
+  EXPECT_TRUE(results_.empty());
+
+  executor_.cancellable = true;
+  reporter.reset();
+  EXPECT_THAT(results_, testing::ElementsAre(absl::StatusCode::kCancelled));
+}
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,95 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/reporters/debug_report_limiter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "absl/random/random.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::atomic<int64_t> emitted_loss_reports{0};
+std::atomic<int64_t> suppressed_loss_reports{0};
+
+}  // namespace
+
+void DebugReportLimiter::SetLimits(DebugReportLimits limits) {
+  max_loss_reports_per_request_ = limits.max_loss_reports_per_request;
+  max_loss_reports_per_second_ = limits.max_loss_reports_per_second;
+  loss_report_sample_percent_ = limits.loss_report_sample_percent;
+}
+
+std::vector<bool> DebugReportLimiter::PickLossReports(int num_loss_reports,
+                                                       absl::Time now) {
+  std::vector<bool> picked(num_loss_reports, false);
+  const int max_per_request = max_loss_reports_per_request_;
+  const int num_kept = max_per_request <= 0
+                           ? num_loss_reports
+                           : std::min(num_loss_reports, max_per_request);
+  // Reservoir samples the reports kept within the limit per request.
+  std::vector<int> kept(num_kept);
+  for (int i = 0; i < num_kept; ++i) {
+    kept[i] = i;
+  }
+  if (num_kept < num_loss_reports) {
+    thread_local absl::BitGen bitgen;
+    for (int i = num_kept; i < num_loss_reports; ++i) {
+      if (const int slot = absl::Uniform(bitgen, 0, i + 1); slot < num_kept) {
+        kept[slot] = i;
+      }
+    }
+  }
+  for (int index : kept) {
+    picked[index] = AllowLossReport(now);
+  }
+  suppressed_loss_reports.fetch_add(num_loss_reports - num_kept,
+                                    std::memory_order_relaxed);
+  return picked;
+}
+
+bool DebugReportLimiter::AllowLossReport(absl::Time now) {
+  bool allowed = true;
+  if (const int sample_percent = loss_report_sample_percent_;
+      sample_percent < 100) {
+    thread_local absl::BitGen bitgen;
+    allowed = absl::Uniform(bitgen, 0, 100) < sample_percent;
+  }
+  if (const int max_per_second = max_loss_reports_per_second_;
+      allowed && max_per_second > 0) {
+    const int64_t second = absl::ToUnixSeconds(now);
+    absl::MutexLock lock(&mu_);
+    if (second != second_) {
+      second_ = second;
+      sent_in_second_ = 0;
+    }
+    allowed = sent_in_second_ < max_per_second;
+    if (allowed) {
+      ++sent_in_second_;
+    }
+  }
+  (allowed ? emitted_loss_reports : suppressed_loss_reports)
+      .fetch_add(1, std::memory_order_relaxed);
+  return allowed;
+}
+
+absl::flat_hash_map<std::string, double> GetDebugLossReportCounts() {
+  return {{"emitted", emitted_loss_reports.exchange(0)},
+          {"suppressed", suppressed_loss_reports.exchange(0)}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,88 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_REPORTERS_DEBUG_REPORT_LIMITER_H_
+#define SERVICES_COMMON_REPORTERS_DEBUG_REPORT_LIMITER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Limits of the debug loss reports of a server. Debug win reports are never
+// limited, as there is one per auction at most.
+struct DebugReportLimits {
+  // Most debug loss reports sent for one request. Unlimited if 0.
+  int max_loss_reports_per_request = 0;
+  // Most debug loss reports sent by the server in a second. Unlimited if 0.
+  int max_loss_reports_per_second = 0;
+  // Percentage of the debug loss reports sent, picked at random.
+  int loss_report_sample_percent = 100;
+};
+
+// Decides which debug loss reports a server sends, so that auctions with
+// many losing bids do not flood the reporting endpoints of the ad techs.
+// Thread safe.
+class DebugReportLimiter {
+ public:
+  explicit DebugReportLimiter(DebugReportLimits limits) { SetLimits(limits); }
+
+  // Changes the limits of the reports sent from now on.
+  void SetLimits(DebugReportLimits limits);
+
+  // Returns which of the `num_loss_reports` debug loss reports of a request
+  // are sent, and counts those against the limit per second. The reports kept
+  // within the limit per request are picked uniformly at random, so that the
+  // losers listed first are not favored.
+  std::vector<bool> PickLossReports(int num_loss_reports,
+                                    absl::Time now = absl::Now())
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Returns whether a report kept within the limit per request is sent, and
+  // counts it against the limit per second if so.
+  bool AllowLossReport(absl::Time now) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Read on every report, so kept apart rather than behind the lock.
+  std::atomic<int> max_loss_reports_per_request_ = 0;
+  std::atomic<int> max_loss_reports_per_second_ = 0;
+  std::atomic<int> loss_report_sample_percent_ = 100;
+  absl::Mutex mu_;
+  // Second of the reports counted by sent_in_second_, since the epoch.
+  int64_t second_ ABSL_GUARDED_BY(mu_) = 0;
+  int sent_in_second_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Returns the number of debug loss reports of all the DebugReportLimiter
+// instances "emitted" and "suppressed" since the previous call.
+absl::flat_hash_map<std::string, double> GetDebugLossReportCounts();
+
+template <typename T>
+inline void AddDebugReportLimiterMetric(T* context_map) {
+  context_map->AddObserverable(metric::kDebugLossReportCount,
+                               GetDebugLossReportCounts);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_REPORTERS_DEBUG_REPORT_LIMITER_H_
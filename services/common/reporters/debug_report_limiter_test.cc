@@ -0,0 +1,99 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/reporters/debug_report_limiter.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+int CountPicked(const std::vector<bool>& picked) {
+  return std::count(picked.begin(), picked.end(), true);
+}
+
+TEST(DebugReportLimiterTest, AllowsEveryReportByDefault) {
+  DebugReportLimiter limiter({});
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(1000)), 1000);
+}
+
+TEST(DebugReportLimiterTest, CapsTheReportsOfARequest) {
+  DebugReportLimiter limiter({.max_loss_reports_per_request = 2});
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(1)), 1);
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(5)), 2);
+}
+
+TEST(DebugReportLimiterTest, PicksTheReportsOfARequestUniformly) {
+  DebugReportLimiter limiter({.max_loss_reports_per_request = 1});
+  std::vector<int> picks(4, 0);
+  for (int i = 0; i < 4000; ++i) {
+    std::vector<bool> picked = limiter.PickLossReports(4);
+    ASSERT_EQ(CountPicked(picked), 1);
+    for (int j = 0; j < 4; ++j) {
+      picks[j] += picked[j];
+    }
+  }
+  for (int count : picks) {
+    EXPECT_GT(count, 800);
+    EXPECT_LT(count, 1200);
+  }
+}
+
+TEST(DebugReportLimiterTest, CapsTheReportsOfASecond) {
+  DebugReportLimiter limiter({.max_loss_reports_per_second = 2});
+  absl::Time now = absl::FromUnixSeconds(100);
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(1, now)), 1);
+  EXPECT_EQ(
+      CountPicked(limiter.PickLossReports(2, now + absl::Milliseconds(500))),
+      1);
+  EXPECT_EQ(
+      CountPicked(limiter.PickLossReports(1, now + absl::Milliseconds(900))),
+      0);
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(1, now + absl::Seconds(1))),
+            1);
+}
+
+TEST(DebugReportLimiterTest, SamplesTheReports) {
+  DebugReportLimiter none({.loss_report_sample_percent = 0});
+  DebugReportLimiter some({.loss_report_sample_percent = 50});
+  EXPECT_EQ(CountPicked(none.PickLossReports(1000)), 0);
+  const int sampled = CountPicked(some.PickLossReports(1000));
+  EXPECT_GT(sampled, 300);
+  EXPECT_LT(sampled, 700);
+}
+
+TEST(DebugReportLimiterTest, AppliesTheLimitsSet) {
+  DebugReportLimiter limiter({.max_loss_reports_per_request = 1});
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(2)), 1);
+  limiter.SetLimits({.max_loss_reports_per_request = 2});
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(2)), 2);
+  limiter.SetLimits({.loss_report_sample_percent = 0});
+  EXPECT_EQ(CountPicked(limiter.PickLossReports(1)), 0);
+}
+
+TEST(DebugReportLimiterTest, CountsTheEmittedAndSuppressedReports) {
+  GetDebugLossReportCounts();
+  DebugReportLimiter limiter({.max_loss_reports_per_request = 1});
+  limiter.PickLossReports(3);
+  EXPECT_EQ(GetDebugLossReportCounts(),
+            (absl::flat_hash_map<std::string, double>{{"emitted", 1},
+                                                      {"suppressed", 2}}));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -19,6 +19,7 @@
 
 #include "opentelemetry/sdk/resource/resource.h"
 #include "opentelemetry/sdk/resource/semantic_conventions.h"
+#include "services/common/util/worker_processes.h"
 
 using ::opentelemetry::sdk::resource::Resource;
 using ::opentelemetry::sdk::resource::ResourceAttributes;
@@ -32,7 +33,8 @@ Resource CreateSharedAttributes(TrustedServerConfigUtil* config_util) {
       {semantic_conventions::kServiceName, config_util->GetService()},
       {semantic_conventions::kDeploymentEnvironment,
        config_util->GetEnvironment()},
-      {semantic_conventions::kServiceInstanceId, config_util->GetInstanceId()}};
+      {semantic_conventions::kServiceInstanceId,
+       WorkerInstanceId(config_util->GetInstanceId())}};
   return Resource::Create(attributes);
 }
 
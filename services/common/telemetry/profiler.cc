@@ -0,0 +1,276 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/profiler.h"
+
+#include <errno.h>
+#include <malloc.h>
+#include <signal.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <ucontext.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/debugging/stacktrace.h"
+#include "absl/debugging/symbolize.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Enough for a minute of 100 samples per second on 10 busy cores.
+constexpr int kCpuSampleCapacity = 1 << 16;
+constexpr int kContentionSampleCapacity = 1 << 16;
+
+// Returns the name of the function at `pc`.
+std::string Symbolize(void* pc) {
+  char name[1024];
+  if (absl::Symbolize(pc, name, sizeof(name))) {
+    return name;
+  }
+  return absl::StrCat("0x", absl::Hex(reinterpret_cast<uintptr_t>(pc)));
+}
+
+// Returns the program counter of the code interrupted by a signal, or null
+// if unknown on this architecture.
+void* InterruptedPc(const void* ucontext) {
+  const mcontext_t& context =
+      static_cast<const ucontext_t*>(ucontext)->uc_mcontext;
+#if defined(__x86_64__)
+  return reinterpret_cast<void*>(context.gregs[REG_RIP]);
+#elif defined(__aarch64__)
+  return reinterpret_cast<void*>(context.pc);
+#else
+  return nullptr;
+#endif
+}
+
+// Serializes the starts and stops of the profilers.
+ABSL_CONST_INIT absl::Mutex profilers_mutex(absl::kConstInit);
+
+// The samples of each profiler, allocated on first use and never freed, so
+// that a late signal handler or mutex hook never writes to freed memory.
+internal::StackSamples* cpu_samples ABSL_GUARDED_BY(profilers_mutex) = nullptr;
+internal::StackSamples* contention_samples ABSL_GUARDED_BY(profilers_mutex) =
+    nullptr;
+
+// Set while a session runs, read by the handler and the hook.
+std::atomic<internal::StackSamples*> active_cpu_samples{nullptr};
+std::atomic<internal::StackSamples*> active_contention_samples{nullptr};
+
+void HandleSigProf(int signal, siginfo_t* info, void* ucontext) {
+  // Keeps errno of the interrupted code.
+  const int saved_errno = errno;
+  if (internal::StackSamples* samples =
+          active_cpu_samples.load(std::memory_order_acquire)) {
+    samples->Record(1, 1, ucontext);
+  }
+  errno = saved_errno;
+}
+
+void OnMutexContention(int64_t wait_cycles) {
+  if (internal::StackSamples* samples =
+          active_contention_samples.load(std::memory_order_acquire)) {
+    samples->Record(wait_cycles, 1);
+  }
+}
+
+absl::Status SetProfilingTimer(absl::Duration period) {
+  itimerval timer = {};
+  timer.it_interval = absl::ToTimeval(period);
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    return absl::InternalError("Unable to set the profiling timer");
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+namespace internal {
+
+StackSamples::StackSamples(int capacity)
+    : capacity_(capacity), samples_(std::make_unique<Sample[]>(capacity)) {}
+
+void StackSamples::Record(int64_t weight, int skip_count,
+                          const void* ucontext) {
+  const int index = next_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= capacity_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  Sample& sample = samples_[index];
+  if (ucontext == nullptr) {
+    // `+ 1` skips this frame.
+    sample.depth = absl::GetStackTrace(sample.pcs, kMaxDepth, skip_count + 1);
+  } else {
+    // Unwinding finds the return addresses of the interrupted stack, so the
+    // interrupted function itself is taken from the signal context.
+    void* interrupted = InterruptedPc(ucontext);
+    int first = 0;
+    if (interrupted != nullptr) {
+      sample.pcs[first++] = interrupted;
+    }
+    sample.depth = first + absl::GetStackTraceWithContext(
+                               sample.pcs + first, kMaxDepth - first,
+                               skip_count + 1, ucontext, nullptr);
+  }
+  sample.weight = weight;
+  sample.ready.store(true, std::memory_order_release);
+}
+
+void StackSamples::Clear() {
+  const int recorded = std::min(next_.load(), capacity_);
+  for (int i = 0; i < recorded; ++i) {
+    samples_[i].ready.store(false, std::memory_order_relaxed);
+  }
+  next_ = 0;
+  dropped_ = 0;
+}
+
+std::string StackSamples::Folded() const {
+  // Samples are summed per symbolized stack rather than per stack of program
+  // counters, so that the calls from different lines of a function are one.
+  absl::flat_hash_map<std::vector<void*>, int64_t> weights_by_pcs;
+  const int recorded = std::min(next_.load(), capacity_);
+  for (int i = 0; i < recorded; ++i) {
+    const Sample& sample = samples_[i];
+    if (!sample.ready.load(std::memory_order_acquire)) {
+      continue;
+    }
+    weights_by_pcs[std::vector<void*>(sample.pcs,
+                                      sample.pcs + sample.depth)] +=
+        sample.weight;
+  }
+  absl::flat_hash_map<void*, std::string> names;
+  absl::flat_hash_map<std::string, int64_t> weights;
+  for (const auto& [pcs, weight] : weights_by_pcs) {
+    std::vector<absl::string_view> frames;
+    frames.reserve(pcs.size());
+    for (int i = pcs.size() - 1; i >= 0; --i) {
+      // Other than the innermost, frames hold return addresses, which may
+      // belong to the next function, so look up the call instead.
+      void* pc = i == 0 ? pcs[i] : static_cast<char*>(pcs[i]) - 1;
+      auto [it, inserted] = names.try_emplace(pc);
+      if (inserted) {
+        it->second = Symbolize(pc);
+      }
+      frames.push_back(it->second);
+    }
+    weights[absl::StrJoin(frames, ";")] += weight;
+  }
+  std::vector<std::pair<std::string, int64_t>> stacks(weights.begin(),
+                                                      weights.end());
+  std::sort(stacks.begin(), stacks.end(),
+            [](const auto& a, const auto& b) { return a.second > b.second; });
+  std::string folded;
+  for (const auto& [stack, weight] : stacks) {
+    absl::StrAppend(&folded, stack, " ", weight, "\n");
+  }
+  return folded;
+}
+
+}  // namespace internal
+
+absl::Status CpuProfiler::Start(absl::Duration period) {
+  absl::MutexLock lock(&profilers_mutex);
+  if (active_cpu_samples.load() != nullptr) {
+    return absl::FailedPreconditionError("CPU profiler already running");
+  }
+  if (cpu_samples == nullptr) {
+    cpu_samples = new internal::StackSamples(kCpuSampleCapacity);
+  }
+  cpu_samples->Clear();
+  struct sigaction action = {};
+  action.sa_sigaction = HandleSigProf;
+  action.sa_flags = SA_SIGINFO | SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  if (sigaction(SIGPROF, &action, nullptr) != 0) {
+    return absl::InternalError("Unable to handle SIGPROF");
+  }
+  active_cpu_samples.store(cpu_samples, std::memory_order_release);
+  if (absl::Status status = SetProfilingTimer(period); !status.ok()) {
+    active_cpu_samples.store(nullptr);
+    return status;
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> CpuProfiler::Stop() {
+  absl::MutexLock lock(&profilers_mutex);
+  if (active_cpu_samples.load() == nullptr) {
+    return absl::FailedPreconditionError("CPU profiler not running");
+  }
+  // The signal stays handled, so that a SIGPROF still pending is ignored
+  // rather than killing the process.
+  absl::Status status = SetProfilingTimer(absl::ZeroDuration());
+  active_cpu_samples.store(nullptr, std::memory_order_release);
+  if (!status.ok()) {
+    return status;
+  }
+  return absl::StrCat("# dropped samples: ", cpu_samples->dropped(), "\n",
+                      cpu_samples->Folded());
+}
+
+absl::Status ContentionProfiler::Start() {
+  absl::MutexLock lock(&profilers_mutex);
+  if (active_contention_samples.load() != nullptr) {
+    return absl::FailedPreconditionError("Contention profiler already running");
+  }
+  if (contention_samples == nullptr) {
+    contention_samples = new internal::StackSamples(kContentionSampleCapacity);
+    absl::RegisterMutexProfiler(OnMutexContention);
+  }
+  contention_samples->Clear();
+  active_contention_samples.store(contention_samples,
+                                  std::memory_order_release);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> ContentionProfiler::Stop() {
+  absl::MutexLock lock(&profilers_mutex);
+  if (active_contention_samples.load() == nullptr) {
+    return absl::FailedPreconditionError("Contention profiler not running");
+  }
+  active_contention_samples.store(nullptr, std::memory_order_release);
+  return absl::StrCat("# dropped samples: ", contention_samples->dropped(),
+                      "\n", contention_samples->Folded());
+}
+
+absl::StatusOr<std::string> GetHeapStats() {
+  char* buffer = nullptr;
+  size_t size = 0;
+  FILE* stream = open_memstream(&buffer, &size);
+  if (stream == nullptr) {
+    return absl::InternalError("Unable to open a memory stream");
+  }
+  const int result = malloc_info(0, stream);
+  fclose(stream);
+  std::string stats(buffer, size);
+  free(buffer);
+  if (result != 0) {
+    return absl::InternalError("Unable to get the allocator statistics");
+  }
+  return stats;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TELEMETRY_PROFILER_H_
+#define SERVICES_COMMON_TELEMETRY_PROFILER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Profiles of the whole process, symbolized in the process itself and written
+// as folded stacks: one line per distinct stack, its frames from the outermost
+// to the innermost separated by ';', then the total weight of its samples, as
+// read by flame graph tools. Profiles only hold code locations, never data of
+// the requests served.
+//
+// Each profiler is process-wide, so only one session of each can run at a
+// time.
+
+// Samples the stack of the thread running on CPU every `period` of CPU time
+// used by the process, with SIGPROF. The weight of a sample is 1.
+class CpuProfiler {
+ public:
+  static absl::Status Start(absl::Duration period = absl::Milliseconds(10));
+  static absl::StatusOr<std::string> Stop();
+};
+
+// Samples the stack of every thread that waited on a contended `absl::Mutex`.
+// The weight of a sample is the time waited, in cycles.
+class ContentionProfiler {
+ public:
+  static absl::Status Start();
+  static absl::StatusOr<std::string> Stop();
+};
+
+// Returns the statistics of the allocator (glibc `malloc_info`), per arena.
+// Heap profiles by allocation site need an allocator that samples them, such
+// as tcmalloc.
+absl::StatusOr<std::string> GetHeapStats();
+
+namespace internal {
+
+// Fixed-size store of sampled stacks. `Record` is async-signal-safe and lock
+// free, so it can run in a signal handler or in a mutex hook.
+class StackSamples {
+ public:
+  static constexpr int kMaxDepth = 32;
+
+  explicit StackSamples(int capacity);
+
+  // Records the stack of the caller, with its `skip_count` innermost frames
+  // skipped, or the interrupted stack of signal context `ucontext` if not null.
+  void Record(int64_t weight, int skip_count, const void* ucontext = nullptr);
+
+  // Drops all samples. Must not run concurrently with `Record`.
+  void Clear();
+
+  // Returns the samples as symbolized folded stacks, heaviest first.
+  std::string Folded() const;
+
+  // Number of samples not recorded because the store was full.
+  int64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  struct Sample {
+    std::atomic<bool> ready{false};
+    int depth = 0;
+    int64_t weight = 0;
+    void* pcs[kMaxDepth];
+  };
+
+  const int capacity_;
+  std::unique_ptr<Sample[]> samples_;
+  std::atomic<int> next_{0};
+  std::atomic<int64_t> dropped_{0};
+};
+
+}  // namespace internal
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TELEMETRY_PROFILER_H_
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/profiler.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/debugging/symbolize.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ContainsRegex;
+using ::testing::HasSubstr;
+
+ABSL_ATTRIBUTE_NOINLINE void RecordHere(internal::StackSamples& samples,
+                                        int64_t weight) {
+  samples.Record(weight, 0);
+}
+
+TEST(StackSamplesTest, FoldsSameStacks) {
+  internal::StackSamples samples(10);
+  for (int i = 0; i < 3; ++i) {
+    RecordHere(samples, 2);
+  }
+  std::string folded = samples.Folded();
+  // The 3 samples share their stack, so are summed on one line.
+  EXPECT_THAT(folded, ContainsRegex("^[^\n]* 6\n$"));
+  EXPECT_EQ(samples.dropped(), 0);
+}
+
+TEST(StackSamplesTest, DropsBeyondCapacity) {
+  internal::StackSamples samples(2);
+  for (int i = 0; i < 5; ++i) {
+    RecordHere(samples, 1);
+  }
+  EXPECT_EQ(samples.dropped(), 3);
+  EXPECT_THAT(samples.Folded(), HasSubstr(" 2\n"));
+}
+
+TEST(StackSamplesTest, Clear) {
+  internal::StackSamples samples(2);
+  RecordHere(samples, 1);
+  RecordHere(samples, 1);
+  RecordHere(samples, 1);
+  samples.Clear();
+  EXPECT_EQ(samples.Folded(), "");
+  EXPECT_EQ(samples.dropped(), 0);
+}
+
+ABSL_ATTRIBUTE_NOINLINE int BusyLoop(absl::Duration duration) {
+  const absl::Time end = absl::Now() + duration;
+  volatile int sum = 0;
+  while (absl::Now() < end) {
+    for (int i = 0; i < 1000000; ++i) {
+      sum = sum + i;
+    }
+  }
+  return sum;
+}
+
+TEST(CpuProfilerTest, SamplesBusyThread) {
+  ASSERT_TRUE(CpuProfiler::Start(absl::Milliseconds(1)).ok());
+  EXPECT_FALSE(CpuProfiler::Start().ok());
+  BusyLoop(absl::Milliseconds(200));
+  absl::StatusOr<std::string> profile = CpuProfiler::Stop();
+  ASSERT_TRUE(profile.ok()) << profile.status();
+  EXPECT_THAT(*profile, HasSubstr("BusyLoop"));
+  EXPECT_FALSE(CpuProfiler::Stop().ok());
+}
+
+TEST(ContentionProfilerTest, SamplesContendedMutex) {
+  ASSERT_TRUE(ContentionProfiler::Start().ok());
+  EXPECT_FALSE(ContentionProfiler::Start().ok());
+  absl::Mutex mutex;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.emplace_back([&mutex]() {
+      for (int j = 0; j < 100; ++j) {
+        absl::MutexLock lock(&mutex);
+        absl::SleepFor(absl::Microseconds(100));
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  absl::StatusOr<std::string> profile = ContentionProfiler::Stop();
+  ASSERT_TRUE(profile.ok()) << profile.status();
+  EXPECT_THAT(*profile, ContainsRegex(" [0-9]+\n"));
+  EXPECT_FALSE(ContentionProfiler::Stop().ok());
+}
+
+TEST(HeapStatsTest, ReportsArenas) {
+  absl::StatusOr<std::string> stats = GetHeapStats();
+  ASSERT_TRUE(stats.ok()) << stats.status();
+  EXPECT_THAT(*stats, HasSubstr("<malloc"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+int main(int argc, char** argv) {
+  absl::InitializeSymbolizer(argv[0]);
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/profiling_service.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "services/common/telemetry/profiler.h"
+#include "services/common/util/status_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+ProfilingService::~ProfilingService() {
+  stop_signal_.Notify();
+  std::thread session;
+  {
+    absl::MutexLock lock(&mutex_);
+    session = std::move(session_);
+  }
+  if (session.joinable()) {
+    session.join();
+  }
+}
+
+grpc::ServerUnaryReactor* ProfilingService::CpuProfile(
+    grpc::CallbackServerContext* context, const ProfileRequest* request,
+    ProfileResponse* response) {
+  return Profile(
+      context, request, response, []() { return CpuProfiler::Start(); },
+      &CpuProfiler::Stop);
+}
+
+grpc::ServerUnaryReactor* ProfilingService::ContentionProfile(
+    grpc::CallbackServerContext* context, const ProfileRequest* request,
+    ProfileResponse* response) {
+  return Profile(context, request, response, &ContentionProfiler::Start,
+                 &ContentionProfiler::Stop);
+}
+
+grpc::ServerUnaryReactor* ProfilingService::HeapStats(
+    grpc::CallbackServerContext* context, const ProfileRequest* request,
+    ProfileResponse* response) {
+  grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+  absl::StatusOr<std::string> stats = GetHeapStats();
+  if (!stats.ok()) {
+    reactor->Finish(FromAbslStatus(stats.status()));
+    return reactor;
+  }
+  response->set_profile(*std::move(stats));
+  reactor->Finish(grpc::Status::OK);
+  return reactor;
+}
+
+grpc::ServerUnaryReactor* ProfilingService::Profile(
+    grpc::CallbackServerContext* context, const ProfileRequest* request,
+    ProfileResponse* response, absl::AnyInvocable<absl::Status()> start,
+    absl::AnyInvocable<absl::StatusOr<std::string>()> stop) {
+  grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+  absl::Duration duration = absl::Seconds(request->duration_seconds());
+  if (duration <= absl::ZeroDuration()) {
+    duration = kDefaultProfileDuration;
+  }
+  if (duration > kMaxProfileDuration) {
+    reactor->Finish(grpc::Status(
+        grpc::StatusCode::INVALID_ARGUMENT,
+        absl::StrCat("Profile duration must be at most ",
+                     absl::FormatDuration(kMaxProfileDuration))));
+    return reactor;
+  }
+
+  absl::MutexLock lock(&mutex_);
+  if (profiling_ || stop_signal_.HasBeenNotified()) {
+    reactor->Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                 "A profile is already being collected"));
+    return reactor;
+  }
+  if (absl::Status status = start(); !status.ok()) {
+    reactor->Finish(FromAbslStatus(status));
+    return reactor;
+  }
+  profiling_ = true;
+  // The previous session has already released the lock, and is done.
+  if (session_.joinable()) {
+    session_.join();
+  }
+  session_ = std::thread([this, reactor, response, duration,
+                          stop = std::move(stop)]() mutable {
+    stop_signal_.WaitForNotificationWithTimeout(duration);
+    absl::StatusOr<std::string> profile = stop();
+    if (profile.ok()) {
+      response->set_profile(*std::move(profile));
+      reactor->Finish(grpc::Status::OK);
+    } else {
+      reactor->Finish(FromAbslStatus(profile.status()));
+    }
+    absl::MutexLock lock(&mutex_);
+    profiling_ = false;
+  });
+  return reactor;
+}
+
+absl::StatusOr<std::unique_ptr<grpc::Server>> StartProfilingServer(
+    ProfilingService& service, int port) {
+  if (port <= 0) {
+    return absl::InvalidArgumentError(
+        "Profiling is enabled without a PROFILING_PORT to serve it on.");
+  }
+  grpc::ServerBuilder builder;
+  builder.AddListeningPort(absl::StrCat("0.0.0.0:", port),
+                           grpc::InsecureServerCredentials());
+  builder.RegisterService(&service);
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+  if (server == nullptr) {
+    return absl::UnavailableError(
+        absl::StrCat("Error starting the profiling server on port ", port));
+  }
+  return server;
+}
+}  // namespace privacy_sandbox::bidding_auction_servers
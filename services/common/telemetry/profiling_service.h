@@ -0,0 +1,88 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TELEMETRY_PROFILING_SERVICE_H_
+#define SERVICES_COMMON_TELEMETRY_PROFILING_SERVICE_H_
+
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "services/common/telemetry/profiling.grpc.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr absl::Duration kDefaultProfileDuration = absl::Seconds(10);
+inline constexpr absl::Duration kMaxProfileDuration = absl::Seconds(60);
+
+// Serves the profiles of the process. A profile is collected for the duration
+// requested on a thread of the service, and only one at a time, so profiling
+// never holds more than one gRPC thread and one session's samples.
+class ProfilingService final : public Profiling::CallbackService {
+ public:
+  ProfilingService() = default;
+
+  // Ends a running session early, and waits for it.
+  ~ProfilingService() override;
+
+  // ProfilingService is neither copyable nor movable.
+  ProfilingService(const ProfilingService&) = delete;
+  ProfilingService& operator=(const ProfilingService&) = delete;
+
+  grpc::ServerUnaryReactor* CpuProfile(grpc::CallbackServerContext* context,
+                                       const ProfileRequest* request,
+                                       ProfileResponse* response) override;
+
+  grpc::ServerUnaryReactor* ContentionProfile(
+      grpc::CallbackServerContext* context, const ProfileRequest* request,
+      ProfileResponse* response) override;
+
+  grpc::ServerUnaryReactor* HeapStats(grpc::CallbackServerContext* context,
+                                      const ProfileRequest* request,
+                                      ProfileResponse* response) override;
+
+ private:
+  // Starts a profiling session with `start`, and finishes the RPC with the
+  // profile returned by `stop` once the requested duration has elapsed.
+  grpc::ServerUnaryReactor* Profile(
+      grpc::CallbackServerContext* context, const ProfileRequest* request,
+      ProfileResponse* response, absl::AnyInvocable<absl::Status()> start,
+      absl::AnyInvocable<absl::StatusOr<std::string>()> stop);
+
+  absl::Mutex mutex_;
+  bool profiling_ ABSL_GUARDED_BY(mutex_) = false;
+  std::thread session_ ABSL_GUARDED_BY(mutex_);
+  absl::Notification stop_signal_;
+};
+
+// Starts a gRPC server serving only `service` on `port`, so that profiles
+// stay off the serving port and are reachable only where the operator
+// exposes it, never through the load balancer. The server must be shut down
+// before `service` is destroyed.
+absl::StatusOr<std::unique_ptr<grpc::Server>> StartProfilingServer(
+    ProfilingService& service, int port);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TELEMETRY_PROFILING_SERVICE_H_
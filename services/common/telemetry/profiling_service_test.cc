@@ -0,0 +1,108 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/profiling_service.h"
+
+#include <memory>
+#include <thread>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::HasSubstr;
+
+class ProfilingServiceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    grpc::ServerBuilder builder;
+    builder.RegisterService(&service_);
+    server_ = builder.BuildAndStart();
+    stub_ = Profiling::NewStub(server_->InProcessChannel({}));
+  }
+
+  void TearDown() override { server_->Shutdown(); }
+
+  ProfilingService service_;
+  std::unique_ptr<grpc::Server> server_;
+  std::unique_ptr<Profiling::Stub> stub_;
+};
+
+TEST_F(ProfilingServiceTest, CpuProfile) {
+  grpc::ClientContext context;
+  ProfileRequest request;
+  request.set_duration_seconds(1);
+  ProfileResponse response;
+  grpc::Status status = stub_->CpuProfile(&context, request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  EXPECT_THAT(response.profile(), HasSubstr("# dropped samples: 0"));
+}
+
+TEST_F(ProfilingServiceTest, ContentionProfile) {
+  grpc::ClientContext context;
+  ProfileRequest request;
+  request.set_duration_seconds(1);
+  ProfileResponse response;
+  grpc::Status status = stub_->ContentionProfile(&context, request, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  EXPECT_THAT(response.profile(), HasSubstr("# dropped samples: 0"));
+}
+
+TEST_F(ProfilingServiceTest, HeapStats) {
+  grpc::ClientContext context;
+  ProfileResponse response;
+  grpc::Status status = stub_->HeapStats(&context, {}, &response);
+  ASSERT_TRUE(status.ok()) << status.error_message();
+  EXPECT_THAT(response.profile(), HasSubstr("<malloc"));
+}
+
+TEST_F(ProfilingServiceTest, RejectsTooLongDuration) {
+  grpc::ClientContext context;
+  ProfileRequest request;
+  request.set_duration_seconds(absl::ToInt64Seconds(kMaxProfileDuration) + 1);
+  ProfileResponse response;
+  EXPECT_EQ(stub_->CpuProfile(&context, request, &response).error_code(),
+            grpc::StatusCode::INVALID_ARGUMENT);
+}
+
+TEST_F(ProfilingServiceTest, RejectsConcurrentSession) {
+  std::thread first([this]() {
+    grpc::ClientContext context;
+    ProfileRequest request;
+    request.set_duration_seconds(2);
+    ProfileResponse response;
+    EXPECT_TRUE(stub_->CpuProfile(&context, request, &response).ok());
+  });
+  // Waits for the first session to start.
+  absl::SleepFor(absl::Milliseconds(500));
+  grpc::ClientContext context;
+  ProfileRequest request;
+  request.set_duration_seconds(1);
+  ProfileResponse response;
+  EXPECT_EQ(
+      stub_->ContentionProfile(&context, request, &response).error_code(),
+      grpc::StatusCode::RESOURCE_EXHAUSTED);
+  first.join();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/telemetry/request_tracer.h"
+
+#include <chrono>
+#include <utility>
+
+#include "absl/random/random.h"
+#include "opentelemetry/context/propagation/text_map_propagator.h"
+#include "opentelemetry/trace/context.h"
+#include "opentelemetry/trace/propagation/http_trace_context.h"
+#include "opentelemetry/trace/span_startoptions.h"
+#include "src/cpp/telemetry/telemetry.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+namespace nostd = ::opentelemetry::nostd;
+namespace trace = ::opentelemetry::trace;
+
+// Carries the `traceparent` between the propagator and gRPC metadata.
+class TraceParentCarrier
+    : public opentelemetry::context::propagation::TextMapCarrier {
+ public:
+  explicit TraceParentCarrier(absl::string_view traceparent = "")
+      : traceparent_(traceparent) {}
+
+  nostd::string_view Get(nostd::string_view key) const noexcept override {
+    if (absl::string_view(key.data(), key.size()) != kTraceParentMetadataKey) {
+      return "";
+    }
+    return traceparent_;
+  }
+
+  void Set(nostd::string_view key, nostd::string_view value) noexcept override {
+    if (absl::string_view(key.data(), key.size()) == kTraceParentMetadataKey) {
+      traceparent_ = std::string(value.data(), value.size());
+    }
+  }
+
+  const std::string& traceparent() const { return traceparent_; }
+
+ private:
+  std::string traceparent_;
+};
+
+// Start options of a span that started at `start`, possibly in the past.
+trace::StartSpanOptions StartOptionsAt(absl::Time start) {
+  trace::StartSpanOptions options;
+  options.start_system_time =
+      opentelemetry::common::SystemTimestamp(absl::ToChronoTime(start));
+  options.start_steady_time = opentelemetry::common::SteadyTimestamp(
+      std::chrono::steady_clock::now() -
+      absl::ToChronoNanoseconds(absl::Now() - start));
+  return options;
+}
+
+}  // namespace
+
+absl::string_view GetTraceParent(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& client_metadata) {
+  auto it = client_metadata.find(grpc::string_ref(
+      kTraceParentMetadataKey.data(), kTraceParentMetadataKey.size()));
+  if (it == client_metadata.end()) {
+    return "";
+  }
+  return absl::string_view(it->second.data(), it->second.size());
+}
+
+RequestTracer RequestTracer::ForHead(absl::string_view name,
+                                     double sample_rate, bool force,
+                                     absl::Time start) {
+  thread_local absl::BitGen bitgen;
+  if (!force && (sample_rate <= 0 || !absl::Bernoulli(bitgen, sample_rate))) {
+    return RequestTracer();
+  }
+  return RequestTracer(server_common::GetTracer()->StartSpan(
+      nostd::string_view(name.data(), name.size()), StartOptionsAt(start)));
+}
+
+RequestTracer RequestTracer::FromTraceParent(absl::string_view name,
+                                             absl::string_view traceparent,
+                                             absl::Time start) {
+  if (traceparent.empty()) {
+    return RequestTracer();
+  }
+  const TraceParentCarrier carrier(traceparent);
+  opentelemetry::context::Context context;
+  trace::SpanContext parent =
+      trace::GetSpan(trace::propagation::HttpTraceContext().Extract(carrier,
+                                                                    context))
+          ->GetContext();
+  if (!parent.IsValid() || !parent.IsSampled()) {
+    return RequestTracer();
+  }
+  trace::StartSpanOptions options = StartOptionsAt(start);
+  options.parent = parent;
+  options.kind = trace::SpanKind::kServer;
+  return RequestTracer(server_common::GetTracer()->StartSpan(
+      nostd::string_view(name.data(), name.size()), options));
+}
+
+RequestTracer& RequestTracer::operator=(RequestTracer&& other) {
+  EndSpan(root_);
+  root_ = std::move(other.root_);
+  return *this;
+}
+
+RequestTracer::~RequestTracer() { EndSpan(root_); }
+
+RequestTracer::SpanPtr RequestTracer::StartSpan(absl::string_view name) const {
+  if (!sampled()) {
+    return SpanPtr();
+  }
+  trace::StartSpanOptions options;
+  options.parent = root_->GetContext();
+  return server_common::GetTracer()->StartSpan(
+      nostd::string_view(name.data(), name.size()), options);
+}
+
+void RequestTracer::AddSpan(absl::string_view name, absl::Time start,
+                            absl::Time end) const {
+  if (!sampled()) {
+    return;
+  }
+  trace::StartSpanOptions options = StartOptionsAt(start);
+  options.parent = root_->GetContext();
+  SpanPtr span = server_common::GetTracer()->StartSpan(
+      nostd::string_view(name.data(), name.size()), options);
+  trace::EndSpanOptions end_options;
+  end_options.end_steady_time = opentelemetry::common::SteadyTimestamp(
+      std::chrono::steady_clock::now() -
+      absl::ToChronoNanoseconds(absl::Now() - end));
+  span->End(end_options);
+}
+
+std::string RequestTracer::TraceParent(const SpanPtr& span) const {
+  if (!sampled()) {
+    return "";
+  }
+  opentelemetry::context::Context context;
+  context = trace::SetSpan(context, span ? span : root_);
+  TraceParentCarrier carrier;
+  trace::propagation::HttpTraceContext().Inject(carrier, context);
+  return carrier.traceparent();
+}
+
+void RequestTracer::AddTraceParent(
+    const SpanPtr& span,
+    absl::flat_hash_map<std::string, std::string>& metadata) const {
+  if (sampled()) {
+    metadata[kTraceParentMetadataKey] = TraceParent(span);
+  }
+}
+
+void RequestTracer::EndSpan(SpanPtr& span) {
+  if (span) {
+    span->End();
+    span = SpanPtr();
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
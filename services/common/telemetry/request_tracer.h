@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TELEMETRY_REQUEST_TRACER_H_
+#define SERVICES_COMMON_TELEMETRY_REQUEST_TRACER_H_
+
+#include <map>
+#include <string>
+
+#include <grpcpp/grpcpp.h>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "opentelemetry/nostd/shared_ptr.h"
+#include "opentelemetry/trace/span.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// gRPC metadata key carrying the W3C trace context of a sampled request to
+// the servers it calls.
+inline constexpr absl::string_view kTraceParentMetadataKey = "traceparent";
+
+// Returns the `traceparent` the caller sent with a request, if any.
+absl::string_view GetTraceParent(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& client_metadata);
+
+// Traces a request, with head-based sampling: the server receiving the request
+// from the client decides whether it is traced, and the servers it calls
+// trace it only if their caller did. Spans of a request that is not sampled
+// are never started, so that it does not pay for tracing at all.
+class RequestTracer {
+ public:
+  using SpanPtr = opentelemetry::nostd::shared_ptr<opentelemetry::trace::Span>;
+
+  // A request that is not traced.
+  RequestTracer() = default;
+
+  // Traces the request at the head of the pipeline with probability
+  // `sample_rate`, or always if `force`, as for consented debug traffic. The
+  // root span `name` starts at `start`.
+  static RequestTracer ForHead(absl::string_view name, double sample_rate,
+                               bool force, absl::Time start = absl::Now());
+
+  // Traces the request only if the caller did, per its `traceparent`, with
+  // the root span `name` as a child of the caller's span.
+  static RequestTracer FromTraceParent(absl::string_view name,
+                                       absl::string_view traceparent,
+                                       absl::Time start = absl::Now());
+
+  RequestTracer(RequestTracer&& other) = default;
+  RequestTracer& operator=(RequestTracer&& other);
+  RequestTracer(const RequestTracer&) = delete;
+  RequestTracer& operator=(const RequestTracer&) = delete;
+
+  // Ends the root span.
+  ~RequestTracer();
+
+  bool sampled() const { return static_cast<bool>(root_); }
+
+  // Starts a child span of the root span, to be ended with `EndSpan`. Returns
+  // a null span if the request is not sampled.
+  SpanPtr StartSpan(absl::string_view name) const;
+
+  // Records a child span of the root span that ran from `start` to `end`, for
+  // phases that ran before the sampling decision or are only timed.
+  void AddSpan(absl::string_view name, absl::Time start, absl::Time end) const;
+
+  // Returns the `traceparent` to send to a server called within `span`, or
+  // within the root span if `span` is null. Empty if not sampled.
+  std::string TraceParent(const SpanPtr& span = SpanPtr()) const;
+
+  // Adds the `traceparent` of `span` to the metadata of a call to another
+  // server, if sampled.
+  void AddTraceParent(
+      const SpanPtr& span,
+      absl::flat_hash_map<std::string, std::string>& metadata) const;
+
+  // Ends `span` if it was started, and resets it.
+  static void EndSpan(SpanPtr& span);
+
+ private:
+  explicit RequestTracer(SpanPtr root) : root_(std::move(root)) {}
+
+  SpanPtr root_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TELEMETRY_REQUEST_TRACER_H_
@@ -0,0 +1,68 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/telemetry/request_tracer.h"
+
+#include <map>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::string_view kSampledTraceParent =
+    "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01";
+constexpr absl::string_view kNotSampledTraceParent =
+    "00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-00";
+
+TEST(RequestTracerTest, DefaultIsNotSampled) {
+  RequestTracer tracer;
+  EXPECT_FALSE(tracer.sampled());
+  EXPECT_FALSE(tracer.StartSpan("span"));
+  EXPECT_EQ(tracer.TraceParent(), "");
+}
+
+TEST(RequestTracerTest, HeadSamplesWithRate) {
+  EXPECT_FALSE(RequestTracer::ForHead("root", 0, /*force=*/false).sampled());
+  EXPECT_TRUE(RequestTracer::ForHead("root", 1, /*force=*/false).sampled());
+}
+
+TEST(RequestTracerTest, HeadAlwaysSamplesForced) {
+  EXPECT_TRUE(RequestTracer::ForHead("root", 0, /*force=*/true).sampled());
+}
+
+TEST(RequestTracerTest, FollowsTheCaller) {
+  EXPECT_TRUE(
+      RequestTracer::FromTraceParent("root", kSampledTraceParent).sampled());
+  EXPECT_FALSE(
+      RequestTracer::FromTraceParent("root", kNotSampledTraceParent).sampled());
+  EXPECT_FALSE(RequestTracer::FromTraceParent("root", "").sampled());
+  EXPECT_FALSE(RequestTracer::FromTraceParent("root", "invalid").sampled());
+}
+
+TEST(RequestTracerTest, MoveEndsTheAssignedTracer) {
+  RequestTracer tracer = RequestTracer::ForHead("root", 1, /*force=*/false);
+  tracer = RequestTracer();
+  EXPECT_FALSE(tracer.sampled());
+}
+
+TEST(RequestTracerTest, GetsTheTraceParentFromMetadata) {
+  std::multimap<grpc::string_ref, grpc::string_ref> metadata;
+  EXPECT_EQ(GetTraceParent(metadata), "");
+  metadata.emplace("traceparent", kSampledTraceParent.data());
+  EXPECT_EQ(GetTraceParent(metadata), kSampledTraceParent);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -14,6 +14,8 @@
 
 #include "services/common/telemetry/telemetry_flag.h"
 
+#include <algorithm>
+
 #include "absl/strings/str_cat.h"
 #include "google/protobuf/text_format.h"
 
@@ -63,6 +65,11 @@ BuildDependentConfig::BuildDependentConfig(TelemetryConfig config)
     server_config_.set_dp_export_interval_ms(
         server_config_.metric_export_interval_ms());
   }
+  if (!server_config_.has_trace_sample_rate()) {
+    server_config_.set_trace_sample_rate(1);
+  }
+  server_config_.set_trace_sample_rate(
+      std::clamp(server_config_.trace_sample_rate(), 0.0, 1.0));
   for (const MetricConfig& m : server_config_.metric()) {
     metric_config_.emplace(m.name(), m);
   }
@@ -65,6 +65,11 @@ class BuildDependentConfig {
     return server_config_.mode() != TelemetryConfig::OFF;
   }
 
+  // Should the profiling service be served
+  bool ProfilingAllowed() const {
+    return server_config_.enable_profiling() && IsDebug();
+  }
+
   // Should metric collection run as debug mode(without nosie)
   bool IsDebug() const;
 
@@ -76,6 +81,11 @@ class BuildDependentConfig {
     return server_config_.dp_export_interval_ms();
   }
 
+  // Fraction of requests to trace when `TraceAllowed()`.
+  double trace_sample_rate() const {
+    return server_config_.trace_sample_rate();
+  }
+
   // If server_config_ has defined MetricConfig list, if found return the
   // MetricConfig for `metric_name`, otherwise return error; if server_config_
   // has empty MetricConfig list, always return default MetricConfig.
@@ -76,9 +76,32 @@ TEST(BuildDependentConfig, Prod) {
   EXPECT_FALSE(config.TraceAllowed());
   EXPECT_EQ(config.metric_export_interval_ms(), 60000);
   EXPECT_EQ(config.dp_export_interval_ms(), 300000);
+  EXPECT_EQ(config.trace_sample_rate(), 1);
   EXPECT_TRUE(config.LogsAllowed());
 }
 
+TEST(BuildDependentConfig, TraceSampleRate) {
+  TelemetryConfig config_proto;
+  config_proto.set_trace_sample_rate(0.25);
+  EXPECT_EQ(BuildDependentConfig(config_proto).trace_sample_rate(), 0.25);
+  config_proto.set_trace_sample_rate(0);
+  EXPECT_EQ(BuildDependentConfig(config_proto).trace_sample_rate(), 0);
+  config_proto.set_trace_sample_rate(2);
+  EXPECT_EQ(BuildDependentConfig(config_proto).trace_sample_rate(), 1);
+}
+
+TEST(BuildDependentConfig, ProfilingOnlyInDebug) {
+  TelemetryConfig config_proto;
+  config_proto.set_mode(TelemetryConfig::PROD);
+  config_proto.set_enable_profiling(true);
+  EXPECT_FALSE(BuildDependentConfig(config_proto).ProfilingAllowed());
+  config_proto.set_mode(TelemetryConfig::EXPERIMENT);
+  BuildDependentConfig config(config_proto);
+  EXPECT_EQ(config.ProfilingAllowed(), config.IsDebug());
+  config_proto.set_enable_profiling(false);
+  EXPECT_FALSE(BuildDependentConfig(config_proto).ProfilingAllowed());
+}
+
 TEST(BuildDependentConfig, EmptyMetricConfigAlwaysOK) {
   TelemetryConfig config_proto;
   BuildDependentConfig config(config_proto);
@@ -147,6 +147,13 @@ using BiddingAsyncClientMock =
     AsyncClientMock<GenerateBidsRequest, GenerateBidsResponse,
                     GenerateBidsRequest::GenerateBidsRawRequest,
                     GenerateBidsResponse::GenerateBidsRawResponse>;
+using ProtectedAppSignalsBiddingAsyncClientMock =
+    AsyncClientMock<GenerateProtectedAppSignalsBidsRequest,
+                    GenerateProtectedAppSignalsBidsResponse,
+                    GenerateProtectedAppSignalsBidsRequest::
+                        GenerateProtectedAppSignalsBidsRawRequest,
+                    GenerateProtectedAppSignalsBidsResponse::
+                        GenerateProtectedAppSignalsBidsRawResponse>;
 
 // Utility class to be used by anything that relies on an HttpFetcherAsync.
 class MockHttpFetcherAsync : public HttpFetcherAsync {
@@ -308,11 +315,13 @@ class MockV8Dispatcher : public V8Dispatcher {
 
 class MockCodeDispatchClient : public CodeDispatchClient {
  public:
-  MockCodeDispatchClient() : CodeDispatchClient(MockV8Dispatcher()) {}
+  explicit MockCodeDispatchClient(DispatchStats* stats = &DispatchStats::Get())
+      : CodeDispatchClient(MockV8Dispatcher(), stats) {}
   MOCK_METHOD(absl::Status, BatchExecute,
               (std::vector<DispatchRequest> & batch,
                BatchDispatchDoneCallback batch_callback),
               (const));
+  MOCK_METHOD(int, CodeVersion, (absl::string_view experiment_id), (const));
 };
 
 template <class Key, class Value>
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/test/utils/benchmark_requests.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "services/common/clients/config/trusted_server_config_client.h"
+#include "services/common/constants/common_service_flags.h"
+#include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/test/random.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+GetBidsRequest::GetBidsRawRequest MakeBenchmarkGetBidsRawRequest(
+    const BenchmarkRequestOptions& options) {
+  GetBidsRequest::GetBidsRawRequest raw_request;
+  raw_request.set_auction_signals(*MakeARandomStructJsonString(5));
+  raw_request.set_buyer_signals(*MakeARandomStructJsonString(5));
+  raw_request.set_seller(MakeARandomUrl());
+  raw_request.set_publisher_name(MakeARandomString());
+  raw_request.mutable_log_context()->set_generation_id(
+      options.generation_id.value_or(MakeARandomString()));
+  for (int i = 0; i < options.num_igs; i++) {
+    auto* ig = raw_request.mutable_buyer_input()->add_interest_groups();
+    *ig = *MakeARandomInterestGroupFromBrowser();
+    ig->set_name(absl::StrCat("ig_", i));
+    if (options.user_bidding_signals_workload.has_value()) {
+      ig->set_user_bidding_signals(MakeJsWorkloadUserBiddingSignals(
+          *options.user_bidding_signals_workload, i));
+    }
+    ig->clear_ad_render_ids();
+    for (int j = 0; j < options.num_ads; j++) {
+      ig->add_ad_render_ids(absl::StrCat("ad_", i, "_", j));
+    }
+    ig->clear_bidding_signals_keys();
+    ig->add_bidding_signals_keys(absl::StrCat("key_", i));
+  }
+  return raw_request;
+}
+
+GenerateBidsRequest::GenerateBidsRawRequest
+MakeBenchmarkGenerateBidsRawRequest(const BenchmarkRequestOptions& options,
+                                    int signal_bytes,
+                                    JsWorkload signal_workload) {
+  GenerateBidsRequest::GenerateBidsRawRequest raw_request;
+  raw_request.set_auction_signals(*MakeARandomStructJsonString(5));
+  raw_request.set_buyer_signals(*MakeARandomStructJsonString(5));
+  raw_request.set_seller(MakeARandomUrl());
+  raw_request.set_publisher_name(MakeARandomString());
+  if (options.generation_id.has_value()) {
+    raw_request.mutable_log_context()->set_generation_id(
+        *options.generation_id);
+  }
+  const std::string signal =
+      MakeJsWorkloadTrustedSignal(signal_workload, signal_bytes);
+  std::string bidding_signals;
+  for (int i = 0; i < options.num_igs; i++) {
+    auto* ig = raw_request.add_interest_group_for_bidding();
+    *ig = MakeARandomInterestGroupForBiddingFromBrowser();
+    ig->set_name(absl::StrCat("ig_", i));
+    if (options.user_bidding_signals_workload.has_value()) {
+      ig->set_user_bidding_signals(MakeJsWorkloadUserBiddingSignals(
+          *options.user_bidding_signals_workload, i));
+    }
+    ig->clear_ad_render_ids();
+    for (int j = 0; j < options.num_ads; j++) {
+      ig->add_ad_render_ids(absl::StrCat("ad_", i, "_", j));
+    }
+    const std::string key = absl::StrCat("key_", i);
+    ig->clear_trusted_bidding_signals_keys();
+    ig->add_trusted_bidding_signals_keys(key);
+    absl::StrAppend(&bidding_signals, i == 0 ? "" : ",", "\"", key,
+                    "\":", signal);
+  }
+  raw_request.set_bidding_signals(
+      absl::StrCat(R"({"keys":{)", bidding_signals, "}}"));
+  return raw_request;
+}
+
+std::unique_ptr<server_common::KeyFetcherManagerInterface>
+CreateTestKeyFetcherManager() {
+  TrustedServersConfigClient config_client({});
+  config_client.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
+  config_client.SetFlagForTest(kTrue, TEST_MODE);
+  return CreateKeyFetcherManager(config_client);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
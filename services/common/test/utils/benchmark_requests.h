@@ -0,0 +1,64 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TEST_UTILS_BENCHMARK_REQUESTS_H_
+#define SERVICES_COMMON_TEST_UTILS_BENCHMARK_REQUESTS_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+
+#include "api/bidding_auction_servers.pb.h"
+#include "services/common/test/utils/js_workloads.h"
+#include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Shape of the requests the benchmarks run. Interest group i is named ig_i,
+// has ads ad_i_0 to ad_i_<num_ads - 1> and a trusted bidding signals key
+// key_i of its own.
+struct BenchmarkRequestOptions {
+  int num_igs = 1;
+  int num_ads = 10;
+  // Workload the user bidding signals of the interest groups are shaped for,
+  // or random signals if unset.
+  std::optional<JsWorkload> user_bidding_signals_workload;
+  // Generation id of the log context. If unset, GetBids requests get a random
+  // one and GenerateBids requests none.
+  std::optional<std::string> generation_id;
+};
+
+// Builds a GetBidsRawRequest of random signals with the interest groups of
+// options.
+GetBidsRequest::GetBidsRawRequest MakeBenchmarkGetBidsRawRequest(
+    const BenchmarkRequestOptions& options);
+
+// Builds a GenerateBidsRawRequest of random signals with the interest groups
+// of options. The trusted bidding signals key of each interest group holds
+// `signal_bytes` bytes of signals shaped for `signal_workload`.
+GenerateBidsRequest::GenerateBidsRawRequest
+MakeBenchmarkGenerateBidsRawRequest(const BenchmarkRequestOptions& options,
+                                    int signal_bytes,
+                                    JsWorkload signal_workload);
+
+// Returns a key fetcher manager in test mode, whose keys the
+// PassThroughCryptoClient accepts.
+std::unique_ptr<server_common::KeyFetcherManagerInterface>
+CreateTestKeyFetcherManager();
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TEST_UTILS_BENCHMARK_REQUESTS_H_
@@ -0,0 +1,164 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/test/utils/heap_counter.h"
+
+#include <errno.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// The allocator of glibc, which the replacements below forward to.
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Constant initialized, so counting works from the first allocation of the
+// process, before any static constructor runs.
+std::atomic<int64_t> allocated_bytes{0};
+std::atomic<int64_t> allocations{0};
+std::atomic<int64_t> live_bytes{0};
+std::atomic<int64_t> peak_live_bytes{0};
+// live_bytes at the last Reset.
+std::atomic<int64_t> base_live_bytes{0};
+
+void RaisePeak(int64_t live) {
+  int64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+  while (live > peak && !peak_live_bytes.compare_exchange_weak(
+                            peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+void* CountAllocation(void* ptr) {
+  if (ptr != nullptr) {
+    const int64_t size = malloc_usable_size(ptr);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    RaisePeak(live_bytes.fetch_add(size, std::memory_order_relaxed) + size);
+  }
+  return ptr;
+}
+
+void CountFree(int64_t size) {
+  live_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+void HeapCounter::Reset() {
+  allocated_bytes.store(0, std::memory_order_relaxed);
+  allocations.store(0, std::memory_order_relaxed);
+  const int64_t live = live_bytes.load(std::memory_order_relaxed);
+  base_live_bytes.store(live, std::memory_order_relaxed);
+  peak_live_bytes.store(live, std::memory_order_relaxed);
+}
+
+void HeapCounter::ResetPeak() {
+  peak_live_bytes.store(live_bytes.load(std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+}
+
+HeapUsage HeapCounter::Get() {
+  const int64_t base = base_live_bytes.load(std::memory_order_relaxed);
+  return {
+      .allocated_bytes = allocated_bytes.load(std::memory_order_relaxed),
+      .allocations = allocations.load(std::memory_order_relaxed),
+      .live_bytes = live_bytes.load(std::memory_order_relaxed) - base,
+      .peak_live_bytes = peak_live_bytes.load(std::memory_order_relaxed) - base,
+  };
+}
+
+void HeapPhase::Begin() {
+  HeapCounter::ResetPeak();
+  begin_ = HeapCounter::Get();
+}
+
+HeapUsage HeapPhase::End() {
+  const HeapUsage end = HeapCounter::Get();
+  allocated_bytes_ += end.allocated_bytes - begin_.allocated_bytes;
+  peak_live_bytes_ =
+      std::max(peak_live_bytes_, end.peak_live_bytes - begin_.live_bytes);
+  return end;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+using ::privacy_sandbox::bidding_auction_servers::CountAllocation;
+using ::privacy_sandbox::bidding_auction_servers::CountFree;
+
+extern "C" {
+
+void* malloc(size_t size) { return CountAllocation(__libc_malloc(size)); }
+
+void* calloc(size_t count, size_t size) {
+  return CountAllocation(__libc_calloc(count, size));
+}
+
+void* realloc(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return malloc(size);
+  }
+  if (size == 0) {
+    free(ptr);
+    return nullptr;
+  }
+  const int64_t old_size = malloc_usable_size(ptr);
+  void* result = __libc_realloc(ptr, size);
+  if (result != nullptr) {
+    // Counted as a free of the old block and an allocation of the new one,
+    // even if the block was resized in place.
+    CountFree(old_size);
+    CountAllocation(result);
+  }
+  return result;
+}
+
+void* memalign(size_t alignment, size_t size) {
+  return CountAllocation(__libc_memalign(alignment, size));
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+    return EINVAL;
+  }
+  void* result = memalign(alignment, size);
+  if (result == nullptr) {
+    return ENOMEM;
+  }
+  *ptr = result;
+  return 0;
+}
+
+void free(void* ptr) {
+  if (ptr != nullptr) {
+    CountFree(malloc_usable_size(ptr));
+  }
+  __libc_free(ptr);
+}
+
+}  // extern "C"
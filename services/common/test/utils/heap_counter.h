@@ -0,0 +1,78 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TEST_UTILS_HEAP_COUNTER_H_
+#define SERVICES_COMMON_TEST_UTILS_HEAP_COUNTER_H_
+
+#include <cstdint>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Heap usage of the process since the last HeapCounter::Reset, in usable
+// bytes of the blocks.
+struct HeapUsage {
+  // Bytes allocated, whether freed since or not.
+  int64_t allocated_bytes = 0;
+  int64_t allocations = 0;
+  // Bytes live now, over those live at the Reset. Negative if more were freed
+  // than allocated.
+  int64_t live_bytes = 0;
+  // Highest live_bytes since the Reset or the last ResetPeak.
+  int64_t peak_live_bytes = 0;
+};
+
+// Counts the heap allocations of the process, by replacing malloc and the
+// functions of its family, which operator new goes through, in the binaries
+// linking it. Meant for benchmarks only: it needs glibc, and counts the
+// allocations of every thread.
+class HeapCounter {
+ public:
+  // Starts counting from zero.
+  static void Reset();
+
+  // Restarts peak_live_bytes from live_bytes, e.g. to measure the peak of a
+  // phase, without resetting the other counts.
+  static void ResetPeak();
+
+  static HeapUsage Get();
+};
+
+// Accumulates the heap usage of a phase of a benchmark over its runs, each
+// from a Begin to an End.
+class HeapPhase {
+ public:
+  // Restarts the peak of HeapCounter, so that phases must not overlap.
+  void Begin();
+
+  // Returns the usage of HeapCounter at the end of the run, whose
+  // peak_live_bytes is that of the run over the bytes live at the Reset.
+  HeapUsage End();
+
+  // Bytes allocated by all the runs.
+  int64_t allocated_bytes() const { return allocated_bytes_; }
+
+  // Highest peak of a run, over the bytes live at its Begin.
+  int64_t peak_live_bytes() const { return peak_live_bytes_; }
+
+ private:
+  HeapUsage begin_;
+  int64_t allocated_bytes_ = 0;
+  int64_t peak_live_bytes_ = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TEST_UTILS_HEAP_COUNTER_H_
@@ -0,0 +1,87 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/test/utils/heap_counter.h"
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr int64_t kBytes = 1 << 20;
+
+TEST(HeapCounterTest, CountsAllocationsAndFrees) {
+  HeapCounter::Reset();
+  auto block = std::make_unique<char[]>(kBytes);
+  benchmark::DoNotOptimize(block.get());
+  HeapUsage usage = HeapCounter::Get();
+  EXPECT_GE(usage.allocated_bytes, kBytes);
+  EXPECT_GE(usage.allocations, 1);
+  EXPECT_GE(usage.live_bytes, kBytes);
+
+  block.reset();
+  usage = HeapCounter::Get();
+  EXPECT_GE(usage.allocated_bytes, kBytes);
+  EXPECT_LT(usage.live_bytes, kBytes);
+  EXPECT_GE(usage.peak_live_bytes, kBytes);
+}
+
+TEST(HeapCounterTest, CountsReallocatedBlocksOnce) {
+  HeapCounter::Reset();
+  void* block = malloc(16);
+  block = realloc(block, kBytes);
+  ASSERT_NE(block, nullptr);
+  const HeapUsage usage = HeapCounter::Get();
+  EXPECT_GE(usage.live_bytes, kBytes);
+  EXPECT_LT(usage.live_bytes, 2 * kBytes);
+  free(block);
+  EXPECT_LT(HeapCounter::Get().live_bytes, kBytes);
+}
+
+TEST(HeapCounterTest, RestartsThePeakFromTheLiveBytes) {
+  HeapCounter::Reset();
+  {
+    auto block = std::make_unique<char[]>(kBytes);
+    benchmark::DoNotOptimize(block.get());
+  }
+  EXPECT_GE(HeapCounter::Get().peak_live_bytes, kBytes);
+  HeapCounter::ResetPeak();
+  EXPECT_LT(HeapCounter::Get().peak_live_bytes, kBytes);
+  EXPECT_GE(HeapCounter::Get().allocated_bytes, kBytes);
+}
+
+TEST(HeapCounterTest, AccumulatesTheUsageOfAPhase) {
+  HeapCounter::Reset();
+  auto live = std::make_unique<char[]>(kBytes);
+  benchmark::DoNotOptimize(live.get());
+  HeapPhase phase;
+  for (int i = 0; i < 2; i++) {
+    phase.Begin();
+    auto block = std::make_unique<char[]>(kBytes);
+    benchmark::DoNotOptimize(block.get());
+    block.reset();
+    EXPECT_GE(phase.End().peak_live_bytes, 2 * kBytes);
+  }
+  EXPECT_GE(phase.allocated_bytes(), 2 * kBytes);
+  EXPECT_GE(phase.peak_live_bytes(), kBytes);
+  EXPECT_LT(phase.peak_live_bytes(), 2 * kBytes);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,415 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/test/utils/js_workloads.h"
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "services/auction_service/code_wrapper/seller_code_wrapper.h"
+#include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Bids on the first ad, by how many trusted bidding signals it has and how
+// often the interest group was joined.
+constexpr absl::string_view kLightGenerateBidJs = R"JS_CODE(
+    function generateBid(interestGroup, auctionSignals, perBuyerSignals,
+                         trustedBiddingSignals, browserSignals) {
+      let bid = browserSignals.joinCount + 1;
+      for (const key of interestGroup.trustedBiddingSignalsKeys || []) {
+        bid += JSON.stringify(trustedBiddingSignals[key]).length % 7;
+      }
+      return {render: interestGroup.adRenderIds[0], bid: bid,
+              allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Scores an ad by its bid and the size of its trusted scoring signals.
+constexpr absl::string_view kLightScoreAdJs = R"JS_CODE(
+    function scoreAd(adMetadata, bid, auctionConfig, trustedScoringSignals,
+                     browserSignals, directFromSellerSignals) {
+      const signals = JSON.stringify(trustedScoringSignals || {});
+      return {desirability: bid + signals.length % 5,
+              allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Deep copies the signals, as code merging them into a model input does, and
+// bids the best active campaign with all the campaigns as the ad metadata.
+constexpr absl::string_view kJsonHeavyGenerateBidJs = R"JS_CODE(
+    function generateBid(interestGroup, auctionSignals, perBuyerSignals,
+                         trustedBiddingSignals, browserSignals) {
+      const signals = JSON.parse(JSON.stringify(trustedBiddingSignals || {}));
+      const user = JSON.parse(
+          JSON.stringify(interestGroup.userBiddingSignals || {}));
+      let cpm = 0;
+      const campaigns = [];
+      for (const key of Object.keys(signals)) {
+        const value = signals[key];
+        for (const campaign of (value && value.campaigns) || []) {
+          if (campaign.active) {
+            cpm = Math.max(cpm, campaign.cpm);
+            campaigns.push({id: campaign.id, tags: campaign.tags});
+          }
+        }
+      }
+      const ad = {campaigns: campaigns, interests: user.interests || [],
+                  recency: user.recency || {}};
+      return {render: interestGroup.adRenderIds[0], ad: ad,
+              bid: cpm + JSON.stringify(ad).length % 7,
+              allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Deep copies the signals and ad metadata, and adds the active campaigns of
+// the render URL signals to the bid.
+constexpr absl::string_view kJsonHeavyScoreAdJs = R"JS_CODE(
+    function scoreAd(adMetadata, bid, auctionConfig, trustedScoringSignals,
+                     browserSignals, directFromSellerSignals) {
+      const signals = JSON.parse(JSON.stringify(trustedScoringSignals || {}));
+      const metadata = JSON.parse(JSON.stringify(adMetadata || {}));
+      let desirability = bid;
+      for (const value of Object.values(signals.renderUrl || {})) {
+        for (const campaign of (value && value.campaigns) || []) {
+          if (campaign.active) {
+            desirability += campaign.cpm / 100;
+          }
+        }
+      }
+      desirability += JSON.stringify(metadata).length % 5;
+      return {desirability: desirability, allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Runs a logistic model over 256 features of every ad, weighted by the
+// trusted bidding signals, and bids on the best ad.
+constexpr absl::string_view kMathHeavyGenerateBidJs = R"JS_CODE(
+    function generateBid(interestGroup, auctionSignals, perBuyerSignals,
+                         trustedBiddingSignals, browserSignals) {
+      const weights = [];
+      for (const key of interestGroup.trustedBiddingSignalsKeys || []) {
+        const value = trustedBiddingSignals[key];
+        if (value && Array.isArray(value.weights)) {
+          weights.push(...value.weights);
+        }
+      }
+      if (weights.length === 0) {
+        weights.push(1);
+      }
+      const user = Array.isArray(interestGroup.userBiddingSignals)
+          ? interestGroup.userBiddingSignals : [1];
+      let best = {render: interestGroup.adRenderIds[0], bid: 0};
+      for (const render of interestGroup.adRenderIds) {
+        let logit = 0;
+        for (let i = 0; i < 256; i++) {
+          const feature = Math.sin(i + render.charCodeAt(i % render.length)) *
+              (user[i % user.length] || 1);
+          logit += feature * weights[i % weights.length];
+        }
+        const bid = 10 / (1 + Math.exp(-logit)) +
+            Math.sqrt(browserSignals.bidCount || 0);
+        if (bid > best.bid) {
+          best = {render: render, bid: bid};
+        }
+      }
+      best.allowComponentAuction = false;
+      return best;
+    }
+)JS_CODE";
+
+// Runs a model over 1024 features of the bid and render URL, weighted by the
+// trusted scoring signals.
+constexpr absl::string_view kMathHeavyScoreAdJs = R"JS_CODE(
+    function scoreAd(adMetadata, bid, auctionConfig, trustedScoringSignals,
+                     browserSignals, directFromSellerSignals) {
+      const weights = [];
+      const signals = (trustedScoringSignals || {}).renderUrl || {};
+      for (const value of Object.values(signals)) {
+        if (value && Array.isArray(value.weights)) {
+          weights.push(...value.weights);
+        }
+      }
+      if (weights.length === 0) {
+        weights.push(1);
+      }
+      const render = browserSignals.renderUrl || "render";
+      let score = 0;
+      for (let i = 0; i < 1024; i++) {
+        score += Math.cos(i * bid) * weights[i % weights.length] +
+            Math.log1p(render.charCodeAt(i % render.length));
+      }
+      return {desirability: bid * (1 + 1 / (1 + Math.exp(-score / 1024))),
+              allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Builds a table of 20000 segments, and 64 bidders closing over it, at load
+// time. Every ad is bid by one of the bidders, on the segments of the trusted
+// bidding signals.
+constexpr absl::string_view kLargeClosureGenerateBidJs = R"JS_CODE(
+    const workloadSegments = (() => {
+      const segments = new Map();
+      for (let i = 0; i < 20000; i++) {
+        segments.set("segment_" + i,
+                     {id: i, cpm: (i % 97) / 10,
+                      tags: ["t" + (i % 13), "t" + (i % 17)]});
+      }
+      return segments;
+    })();
+    const workloadBidders = [];
+    for (let i = 0; i < 64; i++) {
+      workloadBidders.push((segmentIds, joinCount) => {
+        let bid = i / 64;
+        for (const id of segmentIds) {
+          const segment = workloadSegments.get(id);
+          if (segment) {
+            bid = Math.max(bid, segment.cpm * (1 + i / 64) + joinCount);
+          }
+        }
+        return bid;
+      });
+    }
+
+    function generateBid(interestGroup, auctionSignals, perBuyerSignals,
+                         trustedBiddingSignals, browserSignals) {
+      const segmentIds = [];
+      for (const key of interestGroup.trustedBiddingSignalsKeys || []) {
+        const value = trustedBiddingSignals[key];
+        if (value && Array.isArray(value.segments)) {
+          segmentIds.push(...value.segments);
+        }
+      }
+      let best = {render: interestGroup.adRenderIds[0], bid: 0};
+      interestGroup.adRenderIds.forEach((render, index) => {
+        const bid = workloadBidders[index % workloadBidders.length](
+            segmentIds, browserSignals.joinCount || 0);
+        if (bid > best.bid) {
+          best = {render: render, bid: bid};
+        }
+      });
+      best.allowComponentAuction = false;
+      return best;
+    }
+)JS_CODE";
+
+// Same table as the generateBid script, scoring the bid by the best segment
+// of the render URL signals.
+constexpr absl::string_view kLargeClosureScoreAdJs = R"JS_CODE(
+    const workloadSegments = (() => {
+      const segments = new Map();
+      for (let i = 0; i < 20000; i++) {
+        segments.set("segment_" + i,
+                     {id: i, cpm: (i % 97) / 10,
+                      tags: ["t" + (i % 13), "t" + (i % 17)]});
+      }
+      return segments;
+    })();
+    const workloadScorer = (segmentIds) => segmentIds.reduce((best, id) => {
+      const segment = workloadSegments.get(id);
+      return segment ? Math.max(best, segment.cpm) : best;
+    }, 0);
+
+    function scoreAd(adMetadata, bid, auctionConfig, trustedScoringSignals,
+                     browserSignals, directFromSellerSignals) {
+      const segmentIds = [];
+      const signals = (trustedScoringSignals || {}).renderUrl || {};
+      for (const value of Object.values(signals)) {
+        if (value && Array.isArray(value.segments)) {
+          segmentIds.push(...value.segments);
+        }
+      }
+      return {desirability: bid + workloadScorer(segmentIds),
+              allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Instantiates the module on every call, as the wasmHelper examples do, and
+// hashes every render URL through its plusOne export.
+constexpr absl::string_view kWasmGenerateBidJs = R"JS_CODE(
+    function generateBid(interestGroup, auctionSignals, perBuyerSignals,
+                         trustedBiddingSignals, browserSignals) {
+      const plusOne =
+          new WebAssembly.Instance(browserSignals.wasmHelper).exports.plusOne;
+      let best = {render: interestGroup.adRenderIds[0], bid: 0};
+      for (const render of interestGroup.adRenderIds) {
+        let hash = 0;
+        for (let i = 0; i < 16 * render.length; i++) {
+          hash = plusOne(hash ^ render.charCodeAt(i % render.length));
+        }
+        const bid = (hash % 100) / 10 + 1;
+        if (bid > best.bid) {
+          best = {render: render, bid: bid};
+        }
+      }
+      best.allowComponentAuction = false;
+      return best;
+    }
+)JS_CODE";
+
+constexpr absl::string_view kWasmScoreAdJs = R"JS_CODE(
+    function scoreAd(adMetadata, bid, auctionConfig, trustedScoringSignals,
+                     browserSignals, directFromSellerSignals) {
+      const plusOne =
+          new WebAssembly.Instance(browserSignals.wasmHelper).exports.plusOne;
+      const render = browserSignals.renderUrl || "render";
+      let hash = 0;
+      for (let i = 0; i < 16 * render.length; i++) {
+        hash = plusOne(hash ^ render.charCodeAt(i % render.length));
+      }
+      return {desirability: bid + (hash % 100) / 100,
+              allowComponentAuction: false};
+    }
+)JS_CODE";
+
+// Base64 of a WASM module exporting int plusOne(int x).
+constexpr absl::string_view kPlusOneWasmBase64 =
+    "AGFzbQEAAAABhoCAgAABYAF/"
+    "AX8DgoCAgAABAASEgICAAAFwAAAFg4CAgAABAAEGgYCAgAAAB5SAgIAAAgZtZW1vcnkCAAdwbH"
+    "VzT25lAAAKjYCAgAABh4CAgAAAIABBAWoL";
+
+// Appends `element(i)` for i = 0, 1, ... to a JSON array until `out` holds at
+// least `bytes` bytes, not counting the closing bracket and `suffix`.
+template <typename Element>
+std::string MakeJsonArray(absl::string_view prefix, int bytes,
+                          absl::string_view suffix, Element element) {
+  std::string out = absl::StrCat(prefix, "[");
+  for (int i = 0; i == 0 || out.size() < bytes; i++) {
+    absl::StrAppend(&out, i == 0 ? "" : ",", element(i));
+  }
+  absl::StrAppend(&out, "]", suffix);
+  return out;
+}
+
+// Returns a deterministic weight in [-1, 1).
+double Weight(int i) { return ((i * 37) % 200 - 100) / 100.0; }
+
+}  // namespace
+
+absl::string_view JsWorkloadName(JsWorkload workload) {
+  switch (workload) {
+    case JsWorkload::kLight:
+      return "light";
+    case JsWorkload::kJsonHeavy:
+      return "json_heavy";
+    case JsWorkload::kMathHeavy:
+      return "math_heavy";
+    case JsWorkload::kLargeClosure:
+      return "large_closure";
+    case JsWorkload::kWasm:
+      return "wasm";
+  }
+  return "";
+}
+
+absl::StatusOr<JsWorkload> ParseJsWorkload(absl::string_view name) {
+  for (JsWorkload workload : kJsWorkloads) {
+    if (JsWorkloadName(workload) == name) {
+      return workload;
+    }
+  }
+  return absl::InvalidArgumentError(
+      absl::StrCat("Unknown JS workload: ", name));
+}
+
+JsWorkloadCode GetJsWorkloadCode(JsWorkload workload) {
+  switch (workload) {
+    case JsWorkload::kLight:
+      return {kLightGenerateBidJs, kLightScoreAdJs};
+    case JsWorkload::kJsonHeavy:
+      return {kJsonHeavyGenerateBidJs, kJsonHeavyScoreAdJs};
+    case JsWorkload::kMathHeavy:
+      return {kMathHeavyGenerateBidJs, kMathHeavyScoreAdJs};
+    case JsWorkload::kLargeClosure:
+      return {kLargeClosureGenerateBidJs, kLargeClosureScoreAdJs};
+    case JsWorkload::kWasm: {
+      JsWorkloadCode code = {kWasmGenerateBidJs, kWasmScoreAdJs};
+      absl::Base64Unescape(kPlusOneWasmBase64, &code.wasm);
+      return code;
+    }
+  }
+  return {kLightGenerateBidJs, kLightScoreAdJs};
+}
+
+std::string GetJsWorkloadBuyerWrappedCode(
+    JsWorkload workload, bool enable_generate_bids_batch_entry_function) {
+  const JsWorkloadCode code = GetJsWorkloadCode(workload);
+  return GetBuyerWrappedCode(code.generate_bid_js, code.wasm,
+                             enable_generate_bids_batch_entry_function);
+}
+
+std::string GetJsWorkloadSellerWrappedCode(
+    JsWorkload workload, bool enable_score_ads_batch_entry_function) {
+  const JsWorkloadCode code = GetJsWorkloadCode(workload);
+  return GetSellerWrappedCode(code.score_ad_js,
+                              /*enable_report_result_url_generation=*/false,
+                              /*enable_report_win_url_generation=*/false,
+                              /*buyer_origin_code_map=*/{},
+                              enable_score_ads_batch_entry_function, code.wasm);
+}
+
+std::string MakeJsWorkloadTrustedSignal(JsWorkload workload, int bytes) {
+  switch (workload) {
+    case JsWorkload::kJsonHeavy:
+      // {"campaigns":[{"id":0,"cpm":0.5,"active":true,"tags":["t0","t1"]}]}
+      return MakeJsonArray(R"({"campaigns":)", bytes, "}", [](int i) {
+        return absl::StrCat(R"({"id":)", i, R"(,"cpm":)", (i % 40) / 4.0,
+                            R"(,"active":)", i % 3 ? "true" : "false",
+                            R"(,"tags":["t)", i % 13, R"(","t)", (i * 5) % 17,
+                            R"("]})");
+      });
+    case JsWorkload::kMathHeavy:
+      return MakeJsonArray(R"({"weights":)", bytes, "}",
+                           [](int i) { return absl::StrCat(Weight(i)); });
+    case JsWorkload::kLargeClosure:
+      return MakeJsonArray(R"({"segments":)", bytes, "}", [](int i) {
+        return absl::StrCat("\"segment_", (i * 7919) % 20000, "\"");
+      });
+    case JsWorkload::kLight:
+    case JsWorkload::kWasm:
+      break;
+  }
+  return absl::StrCat("[\"", std::string(bytes, 's'), "\"]");
+}
+
+std::string MakeJsWorkloadUserBiddingSignals(JsWorkload workload, int index) {
+  switch (workload) {
+    case JsWorkload::kJsonHeavy: {
+      std::string signals = R"({"interests":[)";
+      for (int i = 0; i < 8; i++) {
+        absl::StrAppend(&signals, i == 0 ? "" : ",", "\"interest_", index + i,
+                        "\"");
+      }
+      return absl::StrCat(signals, R"(],"recency":{"views":)", index % 50,
+                          R"(,"clicks":)", index % 7, "}}");
+    }
+    case JsWorkload::kMathHeavy: {
+      std::string signals = "[";
+      for (int i = 0; i < 32; i++) {
+        absl::StrAppend(&signals, i == 0 ? "" : ",", Weight(index + i));
+      }
+      return absl::StrCat(signals, "]");
+    }
+    case JsWorkload::kLight:
+    case JsWorkload::kLargeClosure:
+    case JsWorkload::kWasm:
+      break;
+  }
+  return absl::StrCat("[", index, "]");
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
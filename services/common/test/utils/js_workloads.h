@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_TEST_UTILS_JS_WORKLOADS_H_
+#define SERVICES_COMMON_TEST_UTILS_JS_WORKLOADS_H_
+
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Version of the corpus below. Bump it whenever a script or a signal
+// generator changes, since results are only comparable within a version.
+inline constexpr int kJsWorkloadsVersion = 1;
+
+// Synthetic adtech code of representative cost, each with a generateBid and a
+// scoreAd script and the signals they expect, for the benchmarks to run in
+// place of trivial inline scripts.
+enum class JsWorkload {
+  // Reads a few fields and bids or scores by simple arithmetic.
+  kLight,
+  // Deep copies and walks nested signals, and returns large ad metadata.
+  kJsonHeavy,
+  // Runs a dense model of a few hundred floating point operations per ad.
+  kMathHeavy,
+  // Builds a large lookup table, and closures over it, when the script is
+  // loaded, and reads them on every call.
+  kLargeClosure,
+  // Instantiates the WASM module shipped with the scripts, and calls into it
+  // for every ad.
+  kWasm,
+};
+
+inline constexpr JsWorkload kJsWorkloads[] = {
+    JsWorkload::kLight, JsWorkload::kJsonHeavy, JsWorkload::kMathHeavy,
+    JsWorkload::kLargeClosure, JsWorkload::kWasm};
+
+// Returns the name of the workload, e.g. "json_heavy".
+absl::string_view JsWorkloadName(JsWorkload workload);
+
+// Returns the workload of the given name.
+absl::StatusOr<JsWorkload> ParseJsWorkload(absl::string_view name);
+
+struct JsWorkloadCode {
+  absl::string_view generate_bid_js;
+  absl::string_view score_ad_js;
+  // Module handed to both scripts as wasmHelper, or empty if they need none.
+  std::string wasm;
+};
+
+JsWorkloadCode GetJsWorkloadCode(JsWorkload workload);
+
+// Return the code of the workload wrapped as the Bidding and Auction servers
+// wrap the code they fetch, ready to be loaded into Roma.
+std::string GetJsWorkloadBuyerWrappedCode(
+    JsWorkload workload,
+    bool enable_generate_bids_batch_entry_function = false);
+std::string GetJsWorkloadSellerWrappedCode(
+    JsWorkload workload, bool enable_score_ads_batch_entry_function = false);
+
+// Returns the value of a trusted bidding or scoring signals key of at least
+// `bytes` bytes, shaped as the scripts of the workload read it.
+std::string MakeJsWorkloadTrustedSignal(JsWorkload workload, int bytes);
+
+// Returns the user bidding signals of the interest group of the given index,
+// shaped as the generateBid of the workload reads them.
+std::string MakeJsWorkloadUserBiddingSignals(JsWorkload workload, int index);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_TEST_UTILS_JS_WORKLOADS_H_
@@ -0,0 +1,87 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/test/utils/js_workloads.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "rapidjson/document.h"
+#include "services/common/util/json_util.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(JsWorkloadsTest, ParsesTheNameOfEveryWorkload) {
+  for (JsWorkload workload : kJsWorkloads) {
+    absl::StatusOr<JsWorkload> parsed =
+        ParseJsWorkload(JsWorkloadName(workload));
+    ASSERT_TRUE(parsed.ok()) << parsed.status();
+    EXPECT_EQ(*parsed, workload);
+  }
+  EXPECT_FALSE(ParseJsWorkload("unknown").ok());
+}
+
+TEST(JsWorkloadsTest, WrapsTheScriptsOfEveryWorkload) {
+  for (JsWorkload workload : kJsWorkloads) {
+    const JsWorkloadCode code = GetJsWorkloadCode(workload);
+    EXPECT_THAT(code.generate_bid_js, HasSubstr("function generateBid("));
+    EXPECT_THAT(code.score_ad_js, HasSubstr("function scoreAd("));
+    EXPECT_THAT(GetJsWorkloadBuyerWrappedCode(workload),
+                HasSubstr(code.generate_bid_js));
+    EXPECT_THAT(GetJsWorkloadSellerWrappedCode(workload),
+                HasSubstr(code.score_ad_js));
+  }
+}
+
+TEST(JsWorkloadsTest, ShipsAWasmModuleOnlyWithTheWasmWorkload) {
+  for (JsWorkload workload : kJsWorkloads) {
+    const std::string wasm = GetJsWorkloadCode(workload).wasm;
+    if (workload == JsWorkload::kWasm) {
+      // The WASM magic number.
+      EXPECT_EQ(wasm.substr(0, 4), std::string("\0asm", 4));
+    } else {
+      EXPECT_TRUE(wasm.empty()) << JsWorkloadName(workload);
+    }
+  }
+}
+
+TEST(JsWorkloadsTest, GeneratesValidSignalsOfAtLeastTheSizeAsked) {
+  for (JsWorkload workload : kJsWorkloads) {
+    for (int bytes : {1, 64, 1024}) {
+      const std::string signal = MakeJsWorkloadTrustedSignal(workload, bytes);
+      EXPECT_GE(signal.size(), bytes) << JsWorkloadName(workload);
+      EXPECT_TRUE(ParseJsonString(signal).ok()) << signal;
+    }
+    EXPECT_TRUE(
+        ParseJsonString(MakeJsWorkloadUserBiddingSignals(workload, 3)).ok())
+        << JsWorkloadName(workload);
+  }
+}
+
+TEST(JsWorkloadsTest, GeneratesTheSignalsTheScriptsRead) {
+  EXPECT_THAT(MakeJsWorkloadTrustedSignal(JsWorkload::kJsonHeavy, 64),
+              HasSubstr(R"({"campaigns":[)"));
+  EXPECT_THAT(MakeJsWorkloadTrustedSignal(JsWorkload::kMathHeavy, 64),
+              HasSubstr(R"({"weights":[)"));
+  EXPECT_THAT(MakeJsWorkloadTrustedSignal(JsWorkload::kLargeClosure, 64),
+              HasSubstr(R"({"segments":["segment_)"));
+  EXPECT_EQ(MakeJsWorkloadTrustedSignal(JsWorkload::kLight, 2), R"(["ss"])");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
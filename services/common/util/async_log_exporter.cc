@@ -0,0 +1,75 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/async_log_exporter.h"
+
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+int64_t RecordBytes(const LogRecord& record) {
+  return record.text.size() + record.binary.size();
+}
+
+}  // namespace
+
+AsyncLogExporter::AsyncLogExporter(int64_t max_queued_bytes,
+                                   absl::AnyInvocable<void(LogRecord)> emit)
+    : max_queued_bytes_(max_queued_bytes),
+      emit_(std::move(emit)),
+      thread_([this]() { Run(); }) {}
+
+AsyncLogExporter::~AsyncLogExporter() {
+  {
+    absl::MutexLock lock(&mu_);
+    stopping_ = true;
+  }
+  thread_.join();
+}
+
+bool AsyncLogExporter::Export(LogRecord record) {
+  const int64_t bytes = RecordBytes(record);
+  absl::MutexLock lock(&mu_);
+  if (queued_bytes_ + bytes > max_queued_bytes_) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  queued_bytes_ += bytes;
+  records_.push_back(std::move(record));
+  return true;
+}
+
+void AsyncLogExporter::Run() {
+  auto ready = [this]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return stopping_ || !records_.empty();
+  };
+  absl::MutexLock lock(&mu_);
+  while (true) {
+    mu_.Await(absl::Condition(&ready));
+    if (records_.empty()) {
+      return;
+    }
+    LogRecord record = std::move(records_.front());
+    records_.pop_front();
+    queued_bytes_ -= RecordBytes(record);
+    mu_.Unlock();
+    emit_(std::move(record));
+    mu_.Lock();
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_ASYNC_LOG_EXPORTER_H_
+#define SERVICES_COMMON_UTIL_ASYNC_LOG_EXPORTER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Log record queued for export, with the text formatted on the request path
+// and a binary payload, such as a serialized proto, encoded by the exporter.
+struct LogRecord {
+  std::string text;
+  std::string binary;
+  // When the record was logged.
+  absl::Time time;
+};
+
+// Exports log records on a background thread, so that the requests logging
+// them do not wait for the records to be encoded and emitted. The queue is
+// bounded by the bytes of the records it holds, past which records are dropped
+// rather than slowing the requests down. Thread safe.
+class AsyncLogExporter {
+ public:
+  // max_queued_bytes: most bytes of the records waiting to be exported.
+  // emit: exports a record, only called on the background thread.
+  AsyncLogExporter(int64_t max_queued_bytes,
+                   absl::AnyInvocable<void(LogRecord)> emit);
+
+  // Exports the records queued, then stops the background thread.
+  ~AsyncLogExporter();
+
+  // Not copyable or movable.
+  AsyncLogExporter(const AsyncLogExporter&) = delete;
+  AsyncLogExporter& operator=(const AsyncLogExporter&) = delete;
+
+  // Queues record for export. Returns false, dropping it, if the queue is
+  // full.
+  bool Export(LogRecord record) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the records dropped so far.
+  int64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  // Emits the records queued until the exporter is destroyed.
+  void Run() ABSL_LOCKS_EXCLUDED(mu_);
+
+  const int64_t max_queued_bytes_;
+  absl::AnyInvocable<void(LogRecord)> emit_;
+  absl::Mutex mu_;
+  std::deque<LogRecord> records_ ABSL_GUARDED_BY(mu_);
+  int64_t queued_bytes_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  std::atomic<int64_t> dropped_ = 0;
+  std::thread thread_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_ASYNC_LOG_EXPORTER_H_
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/async_log_exporter.h"
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/synchronization/notification.h"
+#include "include/gmock/gmock.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(AsyncLogExporterTest, EmitsTheRecordsInOrderOnAnotherThread) {
+  std::vector<std::string> emitted;
+  std::thread::id emit_thread;
+  {
+    AsyncLogExporter exporter(
+        /*max_queued_bytes=*/1000, [&](LogRecord record) {
+          emit_thread = std::this_thread::get_id();
+          emitted.push_back(record.text + record.binary);
+        });
+    EXPECT_TRUE(exporter.Export({.text = "a"}));
+    EXPECT_TRUE(exporter.Export({.text = "b", .binary = "c"}));
+  }
+  EXPECT_THAT(emitted, ElementsAre("a", "bc"));
+  EXPECT_NE(emit_thread, std::this_thread::get_id());
+}
+
+TEST(AsyncLogExporterTest, DropsTheRecordsPastTheQueuedBytes) {
+  absl::Notification emitting;
+  absl::Notification release;
+  std::vector<std::string> emitted;
+  {
+    AsyncLogExporter exporter(
+        /*max_queued_bytes=*/4, [&](LogRecord record) {
+          if (!emitting.HasBeenNotified()) {
+            emitting.Notify();
+          }
+          release.WaitForNotification();
+          emitted.push_back(record.text);
+        });
+    // The first record is taken off the queue while it is emitted.
+    EXPECT_TRUE(exporter.Export({.text = "x"}));
+    emitting.WaitForNotification();
+    EXPECT_TRUE(exporter.Export({.text = "abc"}));
+    EXPECT_FALSE(exporter.Export({.text = "de"}));
+    EXPECT_TRUE(exporter.Export({.text = "f"}));
+    EXPECT_EQ(exporter.dropped(), 1);
+    release.Notify();
+  }
+  EXPECT_THAT(emitted, ElementsAre("x", "abc", "f"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
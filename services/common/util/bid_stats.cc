@@ -25,10 +25,6 @@ BidStats::BidStats(int initial_bids_count_input, const ContextLogger& logger,
                    absl::AnyInvocable<void(bool) &&> on_all_bids_done)
     : initial_bids_count_(initial_bids_count_input),
       pending_bids_count_(initial_bids_count_input),
-      successful_bids_count_(0),
-      empty_bids_count_(0),
-      skipped_bids_count_(0),
-      error_bids_count_(0),
       on_all_bids_done_(std::move(on_all_bids_done)),
       logger_(logger) {}
 
@@ -39,67 +35,67 @@ void BidStats::BidCompleted(CompletedBidState completed_bid_state) {
 void BidStats::BidCompleted(
     CompletedBidState completed_bid_state,
     std::optional<absl::AnyInvocable<void()>> on_single_bid_done) {
-  bool is_last_response = false;
-  bool any_successful_bids = false;
-
-  {
+  if (on_single_bid_done.has_value()) {
     absl::MutexLock lock(&mu_);
-    DCHECK(pending_bids_count_ > 0)
-        << "Unexpected call (indicates either a bug in the initialization or "
-           "the usage)";
-
-    if (on_single_bid_done.has_value()) {
-      (*on_single_bid_done)();
-    }
+    (*on_single_bid_done)();
+  }
 
-    pending_bids_count_--;
-    switch (completed_bid_state) {
-      case CompletedBidState::ERROR:
-        error_bids_count_++;
-        break;
-      case CompletedBidState::EMPTY_RESPONSE:
-        empty_bids_count_++;
-        break;
-      case CompletedBidState::SKIPPED:
-        skipped_bids_count_++;
-        break;
-      case CompletedBidState::SUCCESS:
-        successful_bids_count_++;
-        break;
-      default:
-        // This indicates a bug in our logic.
-        break;
-    }
-    logger_.vlog(5, "Updated pending bids state: ", ToString());
-    if (pending_bids_count_ == 0) {
-      is_last_response = true;
-      // Accounts for chaffs.
-      any_successful_bids = HasAnySuccessfulBids();
-    }
+  switch (completed_bid_state) {
+    case CompletedBidState::ERROR:
+      error_bids_count_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case CompletedBidState::EMPTY_RESPONSE:
+      empty_bids_count_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case CompletedBidState::SKIPPED:
+      skipped_bids_count_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    case CompletedBidState::SUCCESS:
+      successful_bids_count_.fetch_add(1, std::memory_order_relaxed);
+      break;
+    default:
+      // This indicates a bug in our logic.
+      break;
   }
+  // Logged before the bid is marked done, as the instance may be destroyed as
+  // soon as the last bid is, so the pending count still includes this bid.
+  PS_CONTEXT_VLOG(logger_, 5, "Completing bid, pending bids state: ",
+                  ToString());
 
-  // Must be called without holding lock.
-  if (is_last_response) {
-    std::move(on_all_bids_done_)(any_successful_bids);
+  // Releases the state and the `on_single_bid_done` effects of this bid, and
+  // acquires those of the bids completed before, for the last bid to see them
+  // all.
+  const int pending_bids_count =
+      pending_bids_count_.fetch_sub(1, std::memory_order_acq_rel) - 1;
+  DCHECK_GE(pending_bids_count, 0)
+      << "Unexpected call (indicates either a bug in the initialization or "
+         "the usage)";
+  if (pending_bids_count == 0) {
+    // Accounts for chaffs.
+    std::move(on_all_bids_done_)(HasAnySuccessfulBids());
   }
 }
 
-bool BidStats::HasAnySuccessfulBids() {
-  const int sum_bids_count = skipped_bids_count_ + successful_bids_count_ +
-                             error_bids_count_ + empty_bids_count_ +
-                             pending_bids_count_;
-  DCHECK_EQ(initial_bids_count_, sum_bids_count);
+bool BidStats::HasAnySuccessfulBids() const {
+  const int successful_bids_count = successful_bids_count_.load();
+  const int error_bids_count = error_bids_count_.load();
+  const int empty_bids_count = empty_bids_count_.load();
+  const int skipped_bids_count = skipped_bids_count_.load();
+  DCHECK_EQ(initial_bids_count_, skipped_bids_count + successful_bids_count +
+                                     error_bids_count + empty_bids_count +
+                                     pending_bids_count_.load());
 
-  const bool possible_chaff = empty_bids_count_ > 0 || skipped_bids_count_ > 0;
-  return successful_bids_count_ > 0 || possible_chaff || error_bids_count_ == 0;
+  const bool possible_chaff = empty_bids_count > 0 || skipped_bids_count > 0;
+  return successful_bids_count > 0 || possible_chaff || error_bids_count == 0;
 }
 
-std::string BidStats::ToString() {
-  return absl::StrCat("Bidding Stats: succeeded=", successful_bids_count_,
-                      ", errored=", error_bids_count_,
-                      ", skipped=", skipped_bids_count_,
-                      ", returned empty=", empty_bids_count_,
-                      ", pending=", pending_bids_count_);
+std::string BidStats::ToString() const {
+  return absl::StrCat(
+      "Bidding Stats: succeeded=", successful_bids_count_.load(),
+      ", errored=", error_bids_count_.load(),
+      ", skipped=", skipped_bids_count_.load(),
+      ", returned empty=", empty_bids_count_.load(),
+      ", pending=", pending_bids_count_.load());
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -17,6 +17,7 @@
 #ifndef SERVICES_SELLER_FRONTEND_SERVICE_BID_STATS_H_
 #define SERVICES_SELLER_FRONTEND_SERVICE_BID_STATS_H_
 
+#include <atomic>
 #include <optional>
 #include <string>
 
@@ -38,6 +39,8 @@ enum class CompletedBidState {
 // Helper class that facilitates the clients to wait for all bids to be
 // completed before executing the registered callback. Clients need to ensure
 // that the provided logger outlives instance of `BidStats` class.
+// Completions are counted without locking, and the completion that brings the
+// pending bids to zero calls the registered callback.
 class BidStats {
  public:
   explicit BidStats(int initial_bids_count_input, const ContextLogger& logger,
@@ -45,12 +48,11 @@ class BidStats {
 
   // Updates the stats. If all bids have been completed, then the registered
   // callback is called.
-  void BidCompleted(CompletedBidState completed_bid_state)
-      ABSL_LOCKS_EXCLUDED(mu_);
+  void BidCompleted(CompletedBidState completed_bid_state);
 
   // Updates the stats. If all bids have been completed, then the registered
   // callback is called. `on_single_bid_done`, if provided, will be called with
-  // a lock.
+  // a lock, and before the registered callback.
   void BidCompleted(
       CompletedBidState completed_bid_state,
       std::optional<absl::AnyInvocable<void()>> on_single_bid_done)
@@ -60,18 +62,19 @@ class BidStats {
   // Indicates whether any bid was successful or if no buyer returned an empty
   // bid so that we should send a chaff back. This should be called after all
   // the get bid calls to buyer frontend have returned.
-  bool HasAnySuccessfulBids() ABSL_GUARDED_BY(mu_);
+  bool HasAnySuccessfulBids() const;
 
-  std::string ToString() ABSL_GUARDED_BY(mu_);
+  std::string ToString() const;
 
   const int initial_bids_count_;
+  // Serializes the `on_single_bid_done` callbacks.
   absl::Mutex mu_;
-  int pending_bids_count_ ABSL_GUARDED_BY(mu_);
-  int successful_bids_count_ ABSL_GUARDED_BY(mu_);
-  int empty_bids_count_ ABSL_GUARDED_BY(mu_);
-  int skipped_bids_count_ ABSL_GUARDED_BY(mu_);
-  int error_bids_count_ ABSL_GUARDED_BY(mu_);
-  absl::AnyInvocable<void(bool) &&> on_all_bids_done_ ABSL_LOCKS_EXCLUDED(mu_);
+  std::atomic<int> pending_bids_count_;
+  std::atomic<int> successful_bids_count_ = 0;
+  std::atomic<int> empty_bids_count_ = 0;
+  std::atomic<int> skipped_bids_count_ = 0;
+  std::atomic<int> error_bids_count_ = 0;
+  absl::AnyInvocable<void(bool) &&> on_all_bids_done_;
   const ContextLogger& logger_;
 };
 
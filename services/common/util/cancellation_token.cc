@@ -0,0 +1,98 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/cancellation_token.h"
+
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Work cancelled in the process, read and reset by GetCancelledWorkCounts.
+std::atomic<int64_t> cancelled_http_fetches = 0;
+std::atomic<int64_t> cancelled_rpcs = 0;
+std::atomic<int64_t> cancelled_dispatches = 0;
+
+}  // namespace
+
+void CancellationToken::Cancel() {
+  absl::MutexLock lock(&mu_);
+  if (cancelled_.exchange(true)) {
+    return;
+  }
+  // Each callback runs without the lock, so that it may deregister others or
+  // end the work that deregisters it.
+  while (!callbacks_.empty()) {
+    auto it = callbacks_.begin();
+    running_id_ = it->first;
+    running_thread_ = std::this_thread::get_id();
+    absl::AnyInvocable<void() &&> callback = std::move(it->second);
+    callbacks_.erase(it);
+    mu_.Unlock();
+    std::move(callback)();
+    mu_.Lock();
+  }
+  running_id_ = 0;
+  running_thread_ = std::thread::id();
+}
+
+CancellationToken::CallbackId CancellationToken::Register(
+    absl::AnyInvocable<void() &&> callback) {
+  absl::MutexLock lock(&mu_);
+  if (cancelled_.load()) {
+    return 0;
+  }
+  const CallbackId id = next_id_++;
+  callbacks_.emplace(id, std::move(callback));
+  return id;
+}
+
+void CancellationToken::Deregister(CallbackId id) {
+  if (id == 0) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  if (callbacks_.erase(id) > 0 ||
+      running_thread_ == std::this_thread::get_id()) {
+    return;
+  }
+  auto done = [this, id]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    return running_id_ != id;
+  };
+  mu_.Await(absl::Condition(&done));
+}
+
+void RecordCancelledWork(CancelledWork work, int64_t count) {
+  switch (work) {
+    case CancelledWork::kHttpFetch:
+      cancelled_http_fetches.fetch_add(count, std::memory_order_relaxed);
+      break;
+    case CancelledWork::kRpc:
+      cancelled_rpcs.fetch_add(count, std::memory_order_relaxed);
+      break;
+    case CancelledWork::kDispatch:
+      cancelled_dispatches.fetch_add(count, std::memory_order_relaxed);
+      break;
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetCancelledWorkCounts() {
+  return {{"http_fetch", cancelled_http_fetches.exchange(0)},
+          {"rpc", cancelled_rpcs.exchange(0)},
+          {"dispatch", cancelled_dispatches.exchange(0)}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_CANCELLATION_TOKEN_H_
+#define SERVICES_COMMON_UTIL_CANCELLATION_TOKEN_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Cancels the work started on behalf of a request once its caller gave up,
+// such as the fetches and the RPCs it is waiting for and the Roma requests it
+// queued. The work registers a callback aborting it for as long as it is in
+// flight, or checks IsCancelled before it starts. Thread safe.
+class CancellationToken {
+ public:
+  using CallbackId = int64_t;
+
+  CancellationToken() = default;
+
+  // Not copyable or movable, as the work points to it.
+  CancellationToken(const CancellationToken&) = delete;
+  CancellationToken& operator=(const CancellationToken&) = delete;
+
+  // Runs the callbacks registered, on the calling thread. Only the first call
+  // does anything.
+  void Cancel() ABSL_LOCKS_EXCLUDED(mu_);
+
+  bool IsCancelled() const { return cancelled_.load(); }
+
+  // Registers callback to run on Cancel. Returns 0 without registering it if
+  // the token is already cancelled, which callers registering before their
+  // work starts must check for once it has.
+  CallbackId Register(absl::AnyInvocable<void() &&> callback)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Removes the callback of id, if any. If Cancel is running it on another
+  // thread, waits for it to return, so that the work it aborts may be freed
+  // right after.
+  void Deregister(CallbackId id) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  std::atomic<bool> cancelled_ = false;
+  absl::Mutex mu_;
+  absl::flat_hash_map<CallbackId, absl::AnyInvocable<void() &&>> callbacks_
+      ABSL_GUARDED_BY(mu_);
+  CallbackId next_id_ ABSL_GUARDED_BY(mu_) = 1;
+  // Callback Cancel is running, 0 if none, and the thread running it.
+  CallbackId running_id_ ABSL_GUARDED_BY(mu_) = 0;
+  std::thread::id running_thread_ ABSL_GUARDED_BY(mu_);
+};
+
+// Work dropped because its request was cancelled.
+enum class CancelledWork {
+  kHttpFetch,
+  kRpc,
+  kDispatch,
+};
+
+// Counts `count` units of cancelled work of the kind, such as fetches aborted
+// or Roma requests dropped.
+void RecordCancelledWork(CancelledWork work, int64_t count = 1);
+
+// Returns the work cancelled by kind since the previous call.
+absl::flat_hash_map<std::string, double> GetCancelledWorkCounts();
+
+template <typename T>
+inline void AddCancelledWorkMetric(T* context_map) {
+  context_map->AddObserverable(metric::kCancelledWorkCount,
+                               GetCancelledWorkCounts);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_CANCELLATION_TOKEN_H_
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/cancellation_token.h"
+
+#include <atomic>
+#include <thread>
+
+#include "absl/synchronization/notification.h"
+#include "absl/time/clock.h"
+#include "include/gmock/gmock.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(CancellationTokenTest, RunsTheRegisteredCallbacksOnce) {
+  CancellationToken token;
+  int first = 0;
+  int second = 0;
+  int deregistered = 0;
+  token.Register([&first]() { ++first; });
+  token.Register([&second]() { ++second; });
+  token.Deregister(token.Register([&deregistered]() { ++deregistered; }));
+  EXPECT_FALSE(token.IsCancelled());
+
+  token.Cancel();
+  token.Cancel();
+  EXPECT_TRUE(token.IsCancelled());
+  EXPECT_EQ(first, 1);
+  EXPECT_EQ(second, 1);
+  EXPECT_EQ(deregistered, 0);
+}
+
+TEST(CancellationTokenTest, DoesNotRegisterOnceCancelled) {
+  CancellationToken token;
+  token.Cancel();
+  bool ran = false;
+  EXPECT_EQ(token.Register([&ran]() { ran = true; }), 0);
+  token.Deregister(0);
+  EXPECT_FALSE(ran);
+}
+
+TEST(CancellationTokenTest, CallbackMayDeregisterItself) {
+  CancellationToken token;
+  CancellationToken::CallbackId id = 0;
+  bool ran = false;
+  id = token.Register([&]() {
+    token.Deregister(id);
+    ran = true;
+  });
+  token.Cancel();
+  EXPECT_TRUE(ran);
+}
+
+TEST(CancellationTokenTest, DeregisterWaitsForTheRunningCallback) {
+  CancellationToken token;
+  absl::Notification started;
+  std::atomic<bool> returned = false;
+  const CancellationToken::CallbackId id = token.Register([&]() {
+    started.Notify();
+    absl::SleepFor(absl::Milliseconds(50));
+    returned = true;
+  });
+  std::thread cancelling([&token]() { token.Cancel(); });
+  started.WaitForNotification();
+
+  token.Deregister(id);
+  EXPECT_TRUE(returned);
+  cancelling.join();
+}
+
+TEST(CancellationTokenTest, CountsTheCancelledWorkByKind) {
+  GetCancelledWorkCounts();
+  RecordCancelledWork(CancelledWork::kHttpFetch);
+  RecordCancelledWork(CancelledWork::kDispatch, 3);
+  EXPECT_THAT(GetCancelledWorkCounts(),
+              UnorderedElementsAre(Pair("http_fetch", 1), Pair("rpc", 0),
+                                   Pair("dispatch", 3)));
+  EXPECT_THAT(GetCancelledWorkCounts(),
+              UnorderedElementsAre(Pair("http_fetch", 0), Pair("rpc", 0),
+                                   Pair("dispatch", 0)));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/concurrency_limiter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Weights of each latency in the moving averages, as of averages over about
+// the last 10 and the last 600 requests.
+constexpr double kRecentLatencyWeight = 2.0 / (10 + 1);
+constexpr double kLongTermLatencyWeight = 2.0 / (600 + 1);
+// Shortest latency averaged, so that the ratios of the averages are defined.
+constexpr double kMinLatencyMs = 0.001;
+
+std::atomic<int> last_limit{0};
+std::atomic<int> last_in_flight{0};
+std::atomic<int> shed_count{0};
+
+ConcurrencyLimiterOptions Sanitized(ConcurrencyLimiterOptions options) {
+  options.min_limit = std::max(options.min_limit, 1);
+  options.max_limit = std::max(options.max_limit, options.min_limit);
+  return options;
+}
+
+}  // namespace
+
+ConcurrencyLimiter::Permit::~Permit() {
+  if (limiter_ != nullptr) {
+    limiter_->OnDone(absl::Now() - start_);
+  }
+}
+
+ConcurrencyLimiter::Permit::Permit(Permit&& other)
+    : limiter_(std::exchange(other.limiter_, nullptr)), start_(other.start_) {}
+
+ConcurrencyLimiter::Permit& ConcurrencyLimiter::Permit::operator=(
+    Permit&& other) {
+  if (this != &other) {
+    Permit released(std::move(*this));
+    limiter_ = std::exchange(other.limiter_, nullptr);
+    start_ = other.start_;
+  }
+  return *this;
+}
+
+ConcurrencyLimiter::ConcurrencyLimiter(ConcurrencyLimiterOptions options)
+    : options_(Sanitized(options)),
+      limit_(std::clamp(options_.initial_limit, options_.min_limit,
+                        options_.max_limit)) {
+  last_limit = static_cast<int>(limit_);
+}
+
+ConcurrencyLimiter::~ConcurrencyLimiter() {
+  last_limit = 0;
+  last_in_flight = 0;
+}
+
+ConcurrencyLimiter::Permit ConcurrencyLimiter::TryAcquire(absl::Time now) {
+  return TryAcquire(RequestClass::kPremium, now);
+}
+
+ConcurrencyLimiter::Permit ConcurrencyLimiter::TryAcquire(
+    RequestClass request_class, absl::Time now) {
+  const double share = AdmissionShareOf(request_class);
+  absl::MutexLock lock(&mu_);
+  const int admitted =
+      limit_scale_ > 0
+          ? std::max(static_cast<int>(limit_ * limit_scale_ * share), 1)
+          : 0;
+  if (in_flight_ >= admitted) {
+    shed_count.fetch_add(1, std::memory_order_relaxed);
+    return Permit();
+  }
+  last_in_flight = ++in_flight_;
+  return Permit(this, now);
+}
+
+void ConcurrencyLimiter::OnDone(absl::Duration latency) {
+  const double latency_ms =
+      std::max(absl::ToDoubleMilliseconds(latency), kMinLatencyMs);
+  absl::MutexLock lock(&mu_);
+  // Counts the request done among those in flight as it completed.
+  const int in_flight = in_flight_--;
+  last_in_flight = in_flight_;
+  if (long_term_latency_ms_ == 0) {
+    recent_latency_ms_ = latency_ms;
+    long_term_latency_ms_ = latency_ms;
+  } else {
+    recent_latency_ms_ +=
+        kRecentLatencyWeight * (latency_ms - recent_latency_ms_);
+    long_term_latency_ms_ +=
+        kLongTermLatencyWeight * (latency_ms - long_term_latency_ms_);
+  }
+  // Once a spike of latency is over, the long term average catches up with
+  // the recent one faster, or the limit would grow past the spike.
+  if (long_term_latency_ms_ > 2 * recent_latency_ms_) {
+    long_term_latency_ms_ *= 0.95;
+  }
+  // The limit only adapts while the requests use it, or it would grow
+  // unbounded on a server that is not loaded.
+  if (in_flight < limit_ / 2) {
+    return;
+  }
+  const double gradient = std::clamp(options_.latency_tolerance *
+                                         long_term_latency_ms_ /
+                                         recent_latency_ms_,
+                                     0.5, 1.0);
+  const double new_limit = limit_ * gradient + std::sqrt(limit_);
+  limit_ = std::clamp(
+      limit_ * (1 - options_.smoothing) + new_limit * options_.smoothing,
+      static_cast<double>(options_.min_limit),
+      static_cast<double>(options_.max_limit));
+  last_limit = static_cast<int>(limit_);
+}
+
+void ConcurrencyLimiter::SetMaxLimit(int max_limit) {
+  absl::MutexLock lock(&mu_);
+  options_.max_limit = max_limit;
+  options_ = Sanitized(options_);
+  limit_ = std::min(limit_, static_cast<double>(options_.max_limit));
+  last_limit = static_cast<int>(limit_);
+}
+
+void ConcurrencyLimiter::SetLimitScale(double scale) {
+  absl::MutexLock lock(&mu_);
+  limit_scale_ = std::clamp(scale, 0.0, 1.0);
+}
+
+int ConcurrencyLimiter::limit() const {
+  absl::MutexLock lock(&mu_);
+  return static_cast<int>(limit_);
+}
+
+int ConcurrencyLimiter::in_flight() const {
+  absl::MutexLock lock(&mu_);
+  return in_flight_;
+}
+
+grpc::ServerUnaryReactor* FinishShedRequest(
+    grpc::CallbackServerContext* context) {
+  grpc::ServerUnaryReactor* reactor = context->DefaultReactor();
+  reactor->Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                               kServerOverloadedError));
+  return reactor;
+}
+
+absl::flat_hash_map<std::string, double> GetConcurrencyLimiterStats() {
+  return {
+      {"limit", last_limit.load()},
+      {"in_flight", last_in_flight.load()},
+      {"shed", shed_count.exchange(0)},
+  };
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
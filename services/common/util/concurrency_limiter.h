@@ -0,0 +1,162 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_CONCURRENCY_LIMITER_H_
+#define SERVICES_COMMON_UTIL_CONCURRENCY_LIMITER_H_
+
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/grpcpp.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/request_class.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kServerOverloadedError[] =
+    "Server overloaded, try again later.";
+
+struct ConcurrencyLimiterOptions {
+  // Limit before any request completed.
+  int initial_limit = 20;
+  int min_limit = 4;
+  int max_limit = 1000;
+  // Ratio of the recent latency to the long term latency tolerated before
+  // the limit is lowered.
+  double latency_tolerance = 1.5;
+  // Weight of each new limit computed in the limit.
+  double smoothing = 0.2;
+};
+
+// Options of a limit fixed at `limit`, e.g. of a limiter that only sheds
+// requests under memory pressure.
+inline ConcurrencyLimiterOptions FixedConcurrencyLimit(int limit) {
+  return {.initial_limit = limit, .min_limit = limit, .max_limit = limit};
+}
+
+// Limits the requests a server handles at once, shedding the requests past
+// the limit so that they fail right away instead of queuing in gRPC, Roma
+// and curl until they time out.
+//
+// The limit adapts to the latency of the requests, as the gradient limiter
+// of Netflix's concurrency-limits: it follows the ratio of the long term to
+// the recent latency, lowering the limit as the recent latency grows, i.e.
+// as the requests queue, and otherwise growing it by about the square root
+// of the limit. Thread safe.
+class ConcurrencyLimiter final {
+ public:
+  // Admission of a request, which counts it in flight until destroyed.
+  // Empty, and false, when the request is shed.
+  class Permit {
+   public:
+    Permit() = default;
+    ~Permit();
+    Permit(Permit&& other);
+    Permit& operator=(Permit&& other);
+    Permit(const Permit&) = delete;
+    Permit& operator=(const Permit&) = delete;
+
+    explicit operator bool() const { return limiter_ != nullptr; }
+
+   private:
+    friend class ConcurrencyLimiter;
+    Permit(ConcurrencyLimiter* limiter, absl::Time start)
+        : limiter_(limiter), start_(start) {}
+
+    ConcurrencyLimiter* limiter_ = nullptr;
+    absl::Time start_;
+  };
+
+  explicit ConcurrencyLimiter(ConcurrencyLimiterOptions options = {});
+  ~ConcurrencyLimiter();
+
+  // Not copyable or movable.
+  ConcurrencyLimiter(const ConcurrencyLimiter&) = delete;
+  ConcurrencyLimiter& operator=(const ConcurrencyLimiter&) = delete;
+
+  // Admits a request if fewer than the limit are in flight. The latency of
+  // the request is measured from `now`. The limiter must outlive the permit.
+  Permit TryAcquire(absl::Time now = absl::Now()) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Same as TryAcquire, but against the share of the limit of the class of
+  // the request, so that the requests of the classes above are still
+  // admitted once those below are shed.
+  Permit TryAcquire(RequestClass request_class, absl::Time now = absl::Now())
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Changes the max limit, lowering the limit to it if above.
+  void SetMaxLimit(int max_limit) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Admits only the requests under the limit times scale, in [0, 1], but at
+  // least one, or none when scale is 0. The limit itself keeps adapting.
+  // Used to lower the load under memory pressure.
+  void SetLimitScale(double scale) ABSL_LOCKS_EXCLUDED(mu_);
+
+  int limit() const ABSL_LOCKS_EXCLUDED(mu_);
+  int in_flight() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Records the latency of a request admitted, and counts it out of flight.
+  void OnDone(absl::Duration latency) ABSL_LOCKS_EXCLUDED(mu_);
+
+  mutable absl::Mutex mu_;
+  ConcurrencyLimiterOptions options_ ABSL_GUARDED_BY(mu_);
+  double limit_ ABSL_GUARDED_BY(mu_);
+  double limit_scale_ ABSL_GUARDED_BY(mu_) = 1;
+  int in_flight_ ABSL_GUARDED_BY(mu_) = 0;
+  // Exponential moving averages of the latencies, in ms, over the recent
+  // requests and over the long term. 0 until a request completed.
+  double recent_latency_ms_ ABSL_GUARDED_BY(mu_) = 0;
+  double long_term_latency_ms_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Finishes the call right away with a RESOURCE_EXHAUSTED status, for a
+// request shed by a ConcurrencyLimiter.
+grpc::ServerUnaryReactor* FinishShedRequest(
+    grpc::CallbackServerContext* context);
+
+// Same as FinishShedRequest, for a server-streaming call.
+template <typename Response>
+grpc::ServerWriteReactor<Response>* FinishShedStream() {
+  class ShedReactor : public grpc::ServerWriteReactor<Response> {
+   public:
+    ShedReactor() {
+      this->Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                                kServerOverloadedError));
+    }
+    void OnDone() override { delete this; }
+  };
+  return new ShedReactor();
+}
+
+// Returns the "limit" and the requests "in_flight" of the last
+// ConcurrencyLimiter updated, and the requests "shed" by all since the
+// previous call.
+absl::flat_hash_map<std::string, double> GetConcurrencyLimiterStats();
+
+template <typename T>
+inline void AddConcurrencyLimiterMetric(T* context_map) {
+  context_map->AddObserverable(metric::kConcurrencyLimiterState,
+                               GetConcurrencyLimiterStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_CONCURRENCY_LIMITER_H_
@@ -0,0 +1,142 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/concurrency_limiter.h"
+
+#include <deque>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ConcurrencyLimiterTest, ShedsRequestsPastLimit) {
+  ConcurrencyLimiter limiter({.initial_limit = 2, .min_limit = 1});
+  ConcurrencyLimiter::Permit first = limiter.TryAcquire();
+  ConcurrencyLimiter::Permit second = limiter.TryAcquire();
+  EXPECT_TRUE(first);
+  EXPECT_TRUE(second);
+  EXPECT_FALSE(limiter.TryAcquire());
+  EXPECT_EQ(limiter.in_flight(), 2);
+}
+
+TEST(ConcurrencyLimiterTest, KeepsTheLimitLeftForTheClassesAbove) {
+  ConcurrencyLimiter limiter(FixedConcurrencyLimit(10));
+  std::deque<ConcurrencyLimiter::Permit> in_flight;
+  while (ConcurrencyLimiter::Permit permit =
+             limiter.TryAcquire(RequestClass::kLow)) {
+    in_flight.push_back(std::move(permit));
+  }
+  EXPECT_EQ(in_flight.size(), 7);
+  while (ConcurrencyLimiter::Permit permit =
+             limiter.TryAcquire(RequestClass::kStandard)) {
+    in_flight.push_back(std::move(permit));
+  }
+  EXPECT_EQ(in_flight.size(), 9);
+  EXPECT_TRUE(limiter.TryAcquire(RequestClass::kPremium));
+}
+
+TEST(ConcurrencyLimiterTest, PermitCountsRequestUntilDestroyed) {
+  ConcurrencyLimiter limiter({.initial_limit = 1, .min_limit = 1});
+  {
+    ConcurrencyLimiter::Permit permit = limiter.TryAcquire();
+    ConcurrencyLimiter::Permit moved = std::move(permit);
+    EXPECT_FALSE(permit);
+    EXPECT_TRUE(moved);
+    EXPECT_EQ(limiter.in_flight(), 1);
+  }
+  EXPECT_EQ(limiter.in_flight(), 0);
+  EXPECT_TRUE(limiter.TryAcquire());
+}
+
+// Completes the oldest request in flight, then admits requests with
+// `latency` until the limit is reached, so that the limit stays in use.
+void CompleteAndRefill(ConcurrencyLimiter& limiter,
+                       std::deque<ConcurrencyLimiter::Permit>& in_flight,
+                       absl::Duration latency) {
+  if (!in_flight.empty()) {
+    in_flight.pop_front();
+  }
+  while (ConcurrencyLimiter::Permit permit =
+             limiter.TryAcquire(absl::Now() - latency)) {
+    in_flight.push_back(std::move(permit));
+  }
+}
+
+TEST(ConcurrencyLimiterTest, GrowsLimitWhileLatencyIsSteady) {
+  ConcurrencyLimiter limiter({.initial_limit = 10, .max_limit = 100});
+  std::deque<ConcurrencyLimiter::Permit> in_flight;
+  for (int i = 0; i < 100; ++i) {
+    CompleteAndRefill(limiter, in_flight, absl::Milliseconds(10));
+  }
+  EXPECT_GT(limiter.limit(), 10);
+  EXPECT_LE(limiter.limit(), 100);
+}
+
+TEST(ConcurrencyLimiterTest, LowersLimitAsLatencyGrows) {
+  ConcurrencyLimiter limiter({.initial_limit = 50, .min_limit = 4});
+  std::deque<ConcurrencyLimiter::Permit> in_flight;
+  for (int i = 0; i < 100; ++i) {
+    CompleteAndRefill(limiter, in_flight, absl::Milliseconds(10));
+  }
+  const int steady_limit = limiter.limit();
+  for (int i = 0; i < 300; ++i) {
+    CompleteAndRefill(limiter, in_flight, absl::Milliseconds(500));
+  }
+  EXPECT_LT(limiter.limit(), steady_limit);
+  EXPECT_GE(limiter.limit(), 4);
+}
+
+TEST(ConcurrencyLimiterTest, LowersLimitToMaxLimitSet) {
+  ConcurrencyLimiter limiter({.initial_limit = 50, .min_limit = 4});
+  limiter.SetMaxLimit(10);
+  EXPECT_EQ(limiter.limit(), 10);
+  limiter.SetMaxLimit(1);
+  EXPECT_EQ(limiter.limit(), 4);
+}
+
+TEST(ConcurrencyLimiterTest, AdmitsRequestsUnderScaledLimit) {
+  ConcurrencyLimiter limiter({.initial_limit = 4, .min_limit = 1});
+  limiter.SetLimitScale(0.5);
+  ConcurrencyLimiter::Permit first = limiter.TryAcquire();
+  ConcurrencyLimiter::Permit second = limiter.TryAcquire();
+  EXPECT_TRUE(first);
+  EXPECT_TRUE(second);
+  EXPECT_FALSE(limiter.TryAcquire());
+  EXPECT_EQ(limiter.limit(), 4);
+
+  limiter.SetLimitScale(0);
+  first = ConcurrencyLimiter::Permit();
+  EXPECT_FALSE(limiter.TryAcquire());
+
+  limiter.SetLimitScale(1);
+  EXPECT_TRUE(limiter.TryAcquire());
+}
+
+TEST(ConcurrencyLimiterTest, ReportsShedRequests) {
+  ConcurrencyLimiter limiter({.initial_limit = 1, .min_limit = 1});
+  GetConcurrencyLimiterStats();
+  ConcurrencyLimiter::Permit permit = limiter.TryAcquire();
+  limiter.TryAcquire();
+  limiter.TryAcquire();
+  auto stats = GetConcurrencyLimiterStats();
+  EXPECT_EQ(stats["limit"], 1);
+  EXPECT_EQ(stats["in_flight"], 1);
+  EXPECT_EQ(stats["shed"], 2);
+  EXPECT_EQ(GetConcurrencyLimiterStats()["shed"], 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -15,12 +15,16 @@
 #include "services/common/util/consented_debugging_logger.h"
 
 #include <optional>
+#include <utility>
 
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "absl/strings/string_view.h"
 #include "opentelemetry/logs/logger_provider.h"
 #include "opentelemetry/logs/provider.h"
 #include "opentelemetry/logs/severity.h"
+#include "services/common/util/async_log_exporter.h"
 #include "services/common/util/context_logger.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/common/util/source_location.h"
@@ -31,6 +35,28 @@ namespace {
 
 const int kTokenMinLength = 1;
 
+// Most bytes of the consented logs waiting to be exported, past which they
+// are dropped rather than slowing the requests down.
+constexpr int64_t kMaxQueuedBytes = 64 << 20;
+
+// Exports the consented logs of the process to OpenTelemetry.
+AsyncLogExporter& ConsentedLogExporter() {
+  static auto* exporter = new AsyncLogExporter(
+      kMaxQueuedBytes, [](LogRecord record) {
+        if (!record.binary.empty()) {
+          absl::StrAppend(&record.text, absl::Base64Escape(record.binary));
+        }
+        opentelemetry::logs::Provider::GetLoggerProvider()
+            ->GetLogger("default")
+            ->EmitLogRecord(
+                // TODO(b/279955398): Support more than one severities.
+                opentelemetry::logs::Severity::kInfo, record.text,
+                opentelemetry::common::SystemTimestamp(
+                    absl::ToChronoTime(record.time)));
+      });
+  return *exporter;
+}
+
 std::string LogHeader(
     const ParamWithSourceLoc<int>& verbosity_with_source_loc) {
   // Example: 0 foo.cc:100]
@@ -53,9 +79,7 @@ bool MaybeAddConsentedDebugConfig(const ConsentedDebugConfiguration& config,
 
 ConsentedDebuggingLogger::ConsentedDebuggingLogger(
     const ContextMap& context_map, absl::string_view server_debug_token)
-    : context_(FormatContext(context_map)),
-      logger_(opentelemetry::logs::Provider::GetLoggerProvider()->GetLogger(
-          "default")) {
+    : context_(FormatContext(context_map)) {
   if (auto iter = context_map.find(kToken);
       iter != context_map.end() && iter->second.length() >= kTokenMinLength) {
     client_debug_token_ = std::string(iter->second);
@@ -67,16 +91,32 @@ ConsentedDebuggingLogger::ConsentedDebuggingLogger(
                    client_debug_token_ == server_debug_token_);
 }
 
-void ConsentedDebuggingLogger::vlog(
-    ParamWithSourceLoc<int> verbosity_with_source_loc,
-    absl::string_view msg) const {
-  // Only logs when the token in the Context matches the server token.
+void ConsentedDebuggingLogger::LogMessage(
+    ParamWithSourceLoc<int> verbosity_with_source_loc, absl::string_view msg,
+    const google::protobuf::Message& message) const {
   if (!IsConsented()) return;
-  logger_->EmitLogRecord(
-      // TODO(b/279955398): Support more than one severities.
-      opentelemetry::logs::Severity::kInfo,
-      absl::StrCat(LogHeader(verbosity_with_source_loc), msg),
-      opentelemetry::common::SystemTimestamp(std::chrono::system_clock::now()));
+  const int64_t size = message.ByteSizeLong();
+  if (size > kMaxConsentedDebugMessageBytes) {
+    Emit(verbosity_with_source_loc,
+         absl::StrCat(msg, message.GetTypeName(), " of ", size,
+                      " bytes, over the limit of ",
+                      kMaxConsentedDebugMessageBytes));
+    return;
+  }
+  std::string binary;
+  message.SerializeToString(&binary);
+  Emit(verbosity_with_source_loc,
+       absl::StrCat(msg, message.GetTypeName(), " in base64: "),
+       std::move(binary));
+}
+
+void ConsentedDebuggingLogger::Emit(
+    const ParamWithSourceLoc<int>& verbosity_with_source_loc,
+    absl::string_view msg, std::string binary) const {
+  ConsentedLogExporter().Export(
+      {.text = absl::StrCat(LogHeader(verbosity_with_source_loc), msg),
+       .binary = std::move(binary),
+       .time = absl::Now()});
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
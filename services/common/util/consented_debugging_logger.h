@@ -17,20 +17,25 @@
 #ifndef SERVICES_COMMON_UTIL_CONSENTED_DEBUGGING_LOGGER_H_
 #define SERVICES_COMMON_UTIL_CONSENTED_DEBUGGING_LOGGER_H_
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <utility>
 
 #include "absl/strings/string_view.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
-#include "opentelemetry/logs/logger.h"
+#include "google/protobuf/message.h"
 #include "services/common/util/context_logger.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
+// Largest message logged by ConsentedDebuggingLogger::LogMessage.
+inline constexpr int64_t kMaxConsentedDebugMessageBytes = 4 << 20;
+
 // Helper function to update ContextMap.
 bool MaybeAddConsentedDebugConfig(const ConsentedDebugConfiguration& config,
                                   ContextLogger::ContextMap& context_map);
@@ -50,12 +55,32 @@ class ConsentedDebuggingLogger {
 
   bool IsConsented() const { return is_consented_; }
 
+  // Logs the concatenation of msg if consented. msg is only formatted then,
+  // so that LazyFormat and DebugStringOf arguments cost nothing otherwise.
+  template <class... T>
   void vlog(ParamWithSourceLoc<int> verbosity_with_source_loc,
-            absl::string_view msg) const;
+            T&&... msg) const {
+    // Only logs when the token in the Context matches the server token.
+    if (!IsConsented()) return;
+    std::ostringstream stream;
+    (stream << ... << std::forward<T>(msg));
+    Emit(verbosity_with_source_loc, stream.str());
+  }
+
+  // Logs message, after msg, if consented. The message is serialized in
+  // binary, which costs the request far less than DebugString, and encoded
+  // off the request path. Messages over kMaxConsentedDebugMessageBytes are
+  // only logged by size.
+  void LogMessage(ParamWithSourceLoc<int> verbosity_with_source_loc,
+                  absl::string_view msg,
+                  const google::protobuf::Message& message) const;
 
  private:
+  // Queues the record for the background exporter of the consented logs.
+  void Emit(const ParamWithSourceLoc<int>& verbosity_with_source_loc,
+            absl::string_view msg, std::string binary = "") const;
+
   std::string context_;
-  opentelemetry::nostd::shared_ptr<opentelemetry::logs::Logger> logger_;
   // Debug token given by a consented client request.
   // A request with no consent should have no token.
   std::optional<std::string> client_debug_token_ = std::nullopt;
@@ -69,6 +69,25 @@ TEST(ConsentedDebuggingLoggerTest, SimpleLog) {
   EXPECT_TRUE(logger.IsConsented());
 }
 
+TEST(ConsentedDebuggingLoggerTest, LogsMessages) {
+  auto logger = ConsentedDebuggingLogger({{kToken, kTestToken}}, kTestToken);
+  ConsentedDebugConfiguration config;
+  config.set_token(kTestToken);
+  logger.LogMessage(0, "config: ", config);
+  EXPECT_TRUE(logger.IsConsented());
+}
+
+TEST(ConsentedDebuggingLoggerTest, NotConsented_ArgumentsNotFormatted) {
+  auto logger =
+      ConsentedDebuggingLogger({{kToken, kTestToken}}, kMismatchedToken);
+  bool formatted = false;
+  logger.vlog(0, "hello ", LazyFormat([&formatted]() {
+                formatted = true;
+                return "world";
+              }));
+  EXPECT_FALSE(formatted);
+}
+
 TEST(ConsentedDebuggingLoggerTest, DoNotAddConsentedDebugConfigToContext) {
   ContextLogger::ContextMap map = {};
   ConsentedDebugConfiguration config;
@@ -39,6 +39,30 @@ struct ParamWithSourceLoc {
       : mandatory_param(std::forward<U>(param)), location(loc_in) {}
 };
 
+// Argument of the loggers that is only formatted when the message is logged,
+// for arguments that are costly to build, e.g.
+//   logger.vlog(2, "Bids: ", LazyFormat([&] { return absl::StrJoin(...); }));
+// format: callable taking no arguments and returning a streamable value.
+template <class F>
+class LazyFormat {
+ public:
+  explicit LazyFormat(F format) : format_(std::move(format)) {}
+
+  friend std::ostream& operator<<(std::ostream& os, const LazyFormat& lazy) {
+    return os << lazy.format_();
+  }
+
+ private:
+  F format_;
+};
+
+// Logger argument formatting message with DebugString() only when logged.
+// message must outlive the call to the logger.
+template <class T>
+auto DebugStringOf(const T& message) {
+  return LazyFormat([&message]() { return message.DebugString(); });
+}
+
 // Utility class that caches the passed in context as a string upon construction
 // and logs the cached context with the provided log message when needed.
 class ContextLogger {
@@ -108,6 +132,16 @@ class ContextLogger {
   std::string context_;
 };
 
+// Logs with ContextLogger::vlog(verbosity, ...) without evaluating the
+// arguments at all unless verbosity is on, e.g.
+//   PS_CONTEXT_VLOG(logger_, 2, "Took ", absl::Now() - start);
+#define PS_CONTEXT_VLOG(logger, verbosity, ...)        \
+  do {                                                 \
+    if (VLOG_IS_ON(verbosity)) {                       \
+      (logger).vlog(PS_LOC, (verbosity), __VA_ARGS__); \
+    }                                                  \
+  } while (0)
+
 // Utility method to format the context provided as key/value pair into a
 // string. Function excludes any empty values from the output string.
 std::string FormatContext(const ContextLogger::ContextMap& context_map);
@@ -16,6 +16,9 @@
 
 #include <gmock/gmock-matchers.h>
 
+#include <sstream>
+#include <string>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -39,5 +42,32 @@ TEST(ContextLoggerTest, OptionalValuesNotInTheFormattedOutput) {
   EXPECT_EQ(FormatContext({{"key1", ""}}), "");
 }
 
+// Counts the calls to DebugString.
+struct FakeMessage {
+  std::string DebugString() const {
+    ++*debug_string_calls;
+    return "message";
+  }
+  int* debug_string_calls;
+};
+
+TEST(ContextLoggerTest, LazyArgumentsFormattedWhenStreamed) {
+  int calls = 0;
+  FakeMessage message{&calls};
+  std::ostringstream stream;
+  stream << DebugStringOf(message) << LazyFormat([]() { return 1; });
+  EXPECT_EQ(stream.str(), "message1");
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(ContextLoggerTest, LazyArgumentsNotFormattedWhenVerbosityOff) {
+  int calls = 0;
+  FakeMessage message{&calls};
+  ContextLogger logger;
+  logger.vlog(100, "Message: ", DebugStringOf(message));
+  PS_CONTEXT_VLOG(logger, 100, "Message: ", message.DebugString());
+  EXPECT_EQ(calls, 0);
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
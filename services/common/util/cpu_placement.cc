@@ -0,0 +1,174 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/cpu_placement.h"
+
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "services/common/util/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Nodes of the mask passed to set_mempolicy.
+constexpr int kMaxNumaNodes = 8 * sizeof(unsigned long);
+
+absl::StatusOr<int> ParseCpu(absl::string_view cpu) {
+  int parsed;
+  if (!absl::SimpleAtoi(cpu, &parsed) || parsed < 0 || parsed >= CPU_SETSIZE) {
+    return absl::InvalidArgumentError(absl::StrCat("Invalid CPU: '", cpu, "'"));
+  }
+  return parsed;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<int>> ParseCpuList(absl::string_view cpu_list) {
+  cpu_list = absl::StripAsciiWhitespace(cpu_list);
+  std::vector<int> cpus;
+  if (cpu_list.empty()) {
+    return cpus;
+  }
+  for (absl::string_view range : absl::StrSplit(cpu_list, ',')) {
+    std::pair<absl::string_view, absl::string_view> bounds =
+        absl::StrSplit(range, absl::MaxSplits('-', 1));
+    PS_ASSIGN_OR_RETURN(int first, ParseCpu(bounds.first));
+    int last = first;
+    if (!bounds.second.empty()) {
+      PS_ASSIGN_OR_RETURN(last, ParseCpu(bounds.second));
+    }
+    if (last < first) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid CPU range: '", range, "'"));
+    }
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus.push_back(cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+}
+
+absl::StatusOr<std::vector<int>> GetNumaNodeCpus(int node,
+                                                 absl::string_view sysfs_dir) {
+  const std::string path = absl::StrCat(sysfs_dir, "/node", node, "/cpulist");
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return absl::NotFoundError(absl::StrCat("No NUMA node ", node, " at ",
+                                            path));
+  }
+  const std::string cpu_list((std::istreambuf_iterator<char>(file)),
+                             std::istreambuf_iterator<char>());
+  return ParseCpuList(cpu_list);
+}
+
+absl::StatusOr<std::vector<int>> GetThreadCpuAffinity() {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+    return absl::InternalError("Unable to get the CPU affinity");
+  }
+  std::vector<int> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus.push_back(cpu);
+    }
+  }
+  return cpus;
+}
+
+absl::Status SetThreadCpuAffinity(const std::vector<int>& cpus) {
+  if (cpus.empty()) {
+    return absl::OkStatus();
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    CPU_SET(cpu, &set);
+  }
+  // With a pid of 0, only the calling thread is pinned.
+  if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unable to pin the thread to CPUs ", cpus.front(),
+                     " to ", cpus.back()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status SetThreadPreferredNumaNode(int node) {
+  if (node >= kMaxNumaNodes) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid NUMA node: ", node));
+  }
+  long result;
+  if (node < 0) {
+    result = syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0);
+  } else {
+    unsigned long mask = 1UL << node;
+    result = syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, kMaxNumaNodes);
+  }
+  if (result != 0) {
+    return absl::InternalError(
+        absl::StrCat("Unable to set the memory policy to NUMA node ", node));
+  }
+  return absl::OkStatus();
+}
+
+absl::StatusOr<DispatchPlacement> GetDispatchPlacement(
+    absl::string_view worker_cpus, int worker_numa_node,
+    absl::string_view server_cpus, absl::string_view sysfs_dir) {
+  DispatchPlacement placement{.worker_numa_node = worker_numa_node};
+  PS_ASSIGN_OR_RETURN(placement.worker_cpus, ParseCpuList(worker_cpus));
+  PS_ASSIGN_OR_RETURN(placement.server_cpus, ParseCpuList(server_cpus));
+  if (placement.worker_cpus.empty() && worker_numa_node >= 0) {
+    PS_ASSIGN_OR_RETURN(placement.worker_cpus,
+                        GetNumaNodeCpus(worker_numa_node, sysfs_dir));
+    if (placement.worker_cpus.empty()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("NUMA node ", worker_numa_node, " has no CPU"));
+    }
+  }
+  return placement;
+}
+
+absl::Status RunWithDispatchPlacement(const DispatchPlacement& placement,
+                                      absl::FunctionRef<absl::Status()> init) {
+  if (placement.worker_cpus.empty() && placement.worker_numa_node < 0 &&
+      placement.server_cpus.empty()) {
+    return init();
+  }
+  PS_ASSIGN_OR_RETURN(std::vector<int> process_cpus, GetThreadCpuAffinity());
+  PS_RETURN_IF_ERROR(SetThreadCpuAffinity(placement.worker_cpus));
+  PS_RETURN_IF_ERROR(SetThreadPreferredNumaNode(placement.worker_numa_node));
+  absl::Status status = init();
+  PS_RETURN_IF_ERROR(SetThreadPreferredNumaNode(-1));
+  PS_RETURN_IF_ERROR(SetThreadCpuAffinity(
+      placement.server_cpus.empty() ? process_cpus : placement.server_cpus));
+  return status;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,82 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_CPU_PLACEMENT_H_
+#define SERVICES_COMMON_UTIL_CPU_PLACEMENT_H_
+
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr absl::string_view kNumaNodeSysfsDir =
+    "/sys/devices/system/node";
+
+// Parses a CPU list in the format of the kernel, such as "0-3,8,10-11", into
+// the sorted CPUs it holds. An empty list holds no CPU.
+absl::StatusOr<std::vector<int>> ParseCpuList(absl::string_view cpu_list);
+
+// Returns the CPUs of the NUMA node, as listed by the kernel under
+// `sysfs_dir`.
+absl::StatusOr<std::vector<int>> GetNumaNodeCpus(
+    int node, absl::string_view sysfs_dir = kNumaNodeSysfsDir);
+
+// Returns the CPUs the calling thread may run on.
+absl::StatusOr<std::vector<int>> GetThreadCpuAffinity();
+
+// Pins the calling thread to the CPUs. The threads and processes it starts
+// from then on inherit them. Not changed if `cpus` is empty.
+absl::Status SetThreadCpuAffinity(const std::vector<int>& cpus);
+
+// Makes the pages the calling thread touches first from then on come from
+// the NUMA node while it has free memory, rather than from the node of the
+// CPU the thread happens to run on. The threads and processes it starts
+// inherit the policy. Restores the default policy if `node` is negative.
+absl::Status SetThreadPreferredNumaNode(int node);
+
+// Where the Roma workers and the threads of the rest of the server run, on
+// instances of several sockets whose memory is local to the CPUs of each.
+struct DispatchPlacement {
+  // CPUs of the Roma workers, anywhere if empty.
+  std::vector<int> worker_cpus;
+  // NUMA node the memory of the Roma workers, including the memory they
+  // share with the server, comes from, any if negative.
+  int worker_numa_node = -1;
+  // CPUs of the gRPC and executor threads, the ones of the process if empty.
+  std::vector<int> server_cpus;
+};
+
+// Returns the placement of the flags, taking the CPUs of the NUMA node for
+// the workers when only the node is set.
+absl::StatusOr<DispatchPlacement> GetDispatchPlacement(
+    absl::string_view worker_cpus, int worker_numa_node,
+    absl::string_view server_cpus,
+    absl::string_view sysfs_dir = kNumaNodeSysfsDir);
+
+// Runs `init`, which starts the Roma workers, on the CPUs and the NUMA node
+// of the workers, so that the worker processes, the threads of Roma and the
+// shared memory Roma maps for them inherit the placement. Then moves the
+// calling thread to the server CPUs, for the threads it starts next. Must be
+// called before the server threads are started. Returns the status of
+// `init` if the placement succeeds.
+absl::Status RunWithDispatchPlacement(const DispatchPlacement& placement,
+                                      absl::FunctionRef<absl::Status()> init);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_CPU_PLACEMENT_H_
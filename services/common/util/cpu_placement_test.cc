@@ -0,0 +1,91 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/cpu_placement.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(CpuPlacementTest, ParsesKernelCpuLists) {
+  EXPECT_THAT(*ParseCpuList("0-3,8,10-11\n"),
+              ElementsAre(0, 1, 2, 3, 8, 10, 11));
+  EXPECT_THAT(*ParseCpuList("5,1-2,2"), ElementsAre(1, 2, 5));
+  EXPECT_THAT(*ParseCpuList(""), IsEmpty());
+  EXPECT_FALSE(ParseCpuList("3-1").ok());
+  EXPECT_FALSE(ParseCpuList("0,,1").ok());
+  EXPECT_FALSE(ParseCpuList("a-b").ok());
+  EXPECT_FALSE(ParseCpuList("-1").ok());
+  EXPECT_FALSE(ParseCpuList("0-100000").ok());
+}
+
+TEST(CpuPlacementTest, TakesTheCpusOfTheNumaNodeForTheWorkers) {
+  const std::filesystem::path sysfs_dir =
+      std::filesystem::path(testing::TempDir()) / "cpu_placement_test";
+  std::filesystem::create_directories(sysfs_dir / "node1");
+  std::ofstream(sysfs_dir / "node1" / "cpulist") << "8-11\n";
+
+  absl::StatusOr<DispatchPlacement> placement =
+      GetDispatchPlacement("", 1, "0-3", sysfs_dir.string());
+  ASSERT_TRUE(placement.ok()) << placement.status();
+  EXPECT_THAT(placement->worker_cpus, ElementsAre(8, 9, 10, 11));
+  EXPECT_EQ(placement->worker_numa_node, 1);
+  EXPECT_THAT(placement->server_cpus, ElementsAre(0, 1, 2, 3));
+
+  placement = GetDispatchPlacement("12", 1, "", sysfs_dir.string());
+  ASSERT_TRUE(placement.ok()) << placement.status();
+  EXPECT_THAT(placement->worker_cpus, ElementsAre(12));
+
+  EXPECT_FALSE(GetDispatchPlacement("", 2, "", sysfs_dir.string()).ok());
+}
+
+TEST(CpuPlacementTest, RunsInitOnTheWorkerCpusAndThenMovesToTheServerCpus) {
+  // On a thread of its own, so that the pinning does not outlive the test.
+  std::thread([]() {
+    absl::StatusOr<std::vector<int>> process_cpus = GetThreadCpuAffinity();
+    ASSERT_TRUE(process_cpus.ok()) << process_cpus.status();
+    ASSERT_THAT(*process_cpus, testing::Not(IsEmpty()));
+    const std::vector<int> worker_cpus = {process_cpus->back()};
+
+    std::vector<int> init_cpus;
+    absl::Status status = RunWithDispatchPlacement(
+        {.worker_cpus = worker_cpus}, [&init_cpus]() {
+          init_cpus = *GetThreadCpuAffinity();
+          return absl::OkStatus();
+        });
+    ASSERT_TRUE(status.ok()) << status;
+    EXPECT_EQ(init_cpus, worker_cpus);
+    EXPECT_EQ(*GetThreadCpuAffinity(), *process_cpus);
+
+    status = RunWithDispatchPlacement(
+        {.server_cpus = worker_cpus},
+        []() { return absl::InternalError("init"); });
+    EXPECT_EQ(status, absl::InternalError("init"));
+    EXPECT_EQ(*GetThreadCpuAffinity(), worker_cpus);
+  }).join();
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -31,7 +31,16 @@ void ErrorAccumulator::ReportError(const SourceLocation& location,
                                    ErrorVisibility error_visibility,
                                    absl::string_view msg,
                                    ErrorCode error_code) {
-  dst_error_map_[error_visibility][error_code].emplace(msg);
+  auto& errors = dst_error_map_[error_visibility][error_code];
+  // Looked up first, so that a duplicate is not copied.
+  if (errors.find(msg) != errors.end()) {
+    return;
+  }
+  if (errors.size() >= kMaxErrorsPerCode) {
+    ++num_dropped_errors_;
+    return;
+  }
+  errors.emplace(msg);
   if (logger_) {
     logger_->vlog(location, 2, msg);
   }
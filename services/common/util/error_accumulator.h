@@ -17,6 +17,8 @@
 #ifndef SERVICES_COMMON_UTIL_ERROR_ACCUMULATOR_H_
 #define SERVICES_COMMON_UTIL_ERROR_ACCUMULATOR_H_
 
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
@@ -35,9 +37,15 @@ namespace privacy_sandbox::bidding_auction_servers {
 // This utility class provides a way for services to report errors and
 // categorize them and makes it easier to extract these errors and filter them
 // so that these errors can be propagated to the right destination.
+//
+// At most kMaxErrorsPerCode distinct errors are kept per visibility and code,
+// the others being only counted, so that rejecting malformed or abusive
+// traffic with many errors costs little.
 class ErrorAccumulator : public ErrorReporter {
  public:
-  using ErrorMap = std::map<ErrorCode, std::set<std::string>>;
+  using ErrorMap = std::map<ErrorCode, std::set<std::string, std::less<>>>;
+
+  static constexpr size_t kMaxErrorsPerCode = 16;
 
   ErrorAccumulator() = default;
   explicit ErrorAccumulator(ContextLogger* logger);
@@ -62,10 +70,14 @@ class ErrorAccumulator : public ErrorReporter {
   // Gets the list of errors known to this object.
   const ErrorMap& GetErrors(ErrorVisibility error_visibility) const;
 
+  // Number of errors reported past kMaxErrorsPerCode, and not kept.
+  int num_dropped_errors() const { return num_dropped_errors_; }
+
  private:
   // Mapping from error visibility => { Error Code => List of Errors }.
   absl::flat_hash_map<ErrorVisibility, ErrorMap> dst_error_map_;
   const ErrorMap empty_error_map_ = {};
+  int num_dropped_errors_ = 0;
 
   // Optional logger to be used for error reporting.
   ContextLogger* logger_ = nullptr;
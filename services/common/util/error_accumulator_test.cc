@@ -19,6 +19,7 @@
 #include <gmock/gmock-matchers.h>
 
 #include "gmock/gmock.h"
+#include "absl/strings/str_cat.h"
 #include "gtest/gtest.h"
 #include "services/common/util/error_categories.h"
 
@@ -67,4 +68,28 @@ TEST(ErrorAccumulatorTest, DeduplicatesErrors) {
   EXPECT_TRUE(error_accumulator.HasErrors());
 }
 
+TEST(ErrorAccumulatorTest, KeepsAtMostMaxErrorsPerCode) {
+  ErrorAccumulator error_accumulator;
+  for (size_t i = 0; i < ErrorAccumulator::kMaxErrorsPerCode + 2; ++i) {
+    error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE,
+                                  absl::StrCat("Bad buyer ", i),
+                                  ErrorCode::CLIENT_SIDE);
+  }
+  error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE, "Bad buyer 0",
+                                ErrorCode::CLIENT_SIDE);
+  error_accumulator.ReportError(ErrorVisibility::AD_SERVER_VISIBLE,
+                                "Bad configuration", ErrorCode::CLIENT_SIDE);
+
+  EXPECT_EQ(error_accumulator.GetErrors(ErrorVisibility::CLIENT_VISIBLE)
+                .at(ErrorCode::CLIENT_SIDE)
+                .size(),
+            ErrorAccumulator::kMaxErrorsPerCode);
+  EXPECT_EQ(error_accumulator.num_dropped_errors(), 2);
+  // The limit is per visibility.
+  EXPECT_EQ(error_accumulator.GetErrors(ErrorVisibility::AD_SERVER_VISIBLE)
+                .at(ErrorCode::CLIENT_SIDE)
+                .size(),
+            1u);
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,98 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_FAN_IN_H_
+#define SERVICES_COMMON_UTIL_FAN_IN_H_
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Joins the results of a fixed number of concurrent stages of a request
+// pipeline, such as the responses to the requests it fans out. Each stage
+// hands its result to the slot of its index with Set, from any thread, and
+// the continuation is run once with the results of all the stages, in the
+// order of their indices, by the last stage to finish. This replaces the
+// pending counters and result members of hand-written callback chains:
+//
+//   auto responses = FanIn<absl::StatusOr<Response>>::Create(
+//       requests.size(), [](std::vector<absl::StatusOr<Response>> responses) {
+//         ...
+//       });
+//   for (int i = 0; i < requests.size(); ++i) {
+//     client.Execute(requests[i], [responses, i](absl::StatusOr<Response> r) {
+//       responses->Set(i, std::move(r));
+//     });
+//   }
+//
+// The stages that are handed a shared_ptr to the FanIn keep it alive until
+// the continuation is run, so that the callbacks own the state they join.
+// A FanIn may also be a member of the object the continuation runs on. The
+// FanIn is not touched once the continuation is called, so the continuation
+// may destroy it, e.g. by finishing a reactor. A stage must call Set exactly
+// once, or the continuation is never run.
+template <typename T>
+class FanIn {
+ public:
+  using Continuation = absl::AnyInvocable<void(std::vector<T>) &&>;
+
+  // Returns a FanIn of `size` stages, to be shared by their callbacks. The
+  // continuation is run by Create if size is 0.
+  static std::shared_ptr<FanIn> Create(int size, Continuation on_done) {
+    return std::make_shared<FanIn>(size, std::move(on_done));
+  }
+
+  FanIn(int size, Continuation on_done)
+      : results_(size), pending_(size), on_done_(std::move(on_done)) {
+    if (size == 0) {
+      Run();
+    }
+  }
+
+  // Not copyable or movable, as the stages refer to it.
+  FanIn(const FanIn&) = delete;
+  FanIn& operator=(const FanIn&) = delete;
+
+  // Records the result of the stage at `index`, and runs the continuation if
+  // it is the last stage to finish.
+  void Set(int index, T result) {
+    // Each stage writes its own slot, and the last one reads all of them
+    // once the counter tells it the other writes are done.
+    results_[index] = std::move(result);
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) > 1) {
+      return;
+    }
+    Run();
+  }
+
+ private:
+  void Run() {
+    // Moved out first, so that the continuation may destroy the FanIn.
+    Continuation on_done = std::move(on_done_);
+    std::move(on_done)(std::move(results_));
+  }
+
+  std::vector<T> results_;
+  std::atomic<int> pending_;
+  Continuation on_done_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_FAN_IN_H_
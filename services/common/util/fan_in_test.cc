@@ -0,0 +1,89 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/fan_in.h"
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(FanInTest, RunsContinuationOnceAllStagesAreDoneInIndexOrder) {
+  std::vector<std::string> joined;
+  int runs = 0;
+  FanIn<std::string> fan_in(3, [&](std::vector<std::string> results) {
+    joined = std::move(results);
+    ++runs;
+  });
+  fan_in.Set(2, "c");
+  fan_in.Set(0, "a");
+  EXPECT_EQ(runs, 0);
+  fan_in.Set(1, "b");
+  EXPECT_EQ(runs, 1);
+  EXPECT_THAT(joined, ElementsAre("a", "b", "c"));
+}
+
+TEST(FanInTest, RunsContinuationOnCreationWithoutStages) {
+  std::vector<int> joined = {1};
+  auto fan_in = FanIn<int>::Create(
+      0, [&joined](std::vector<int> results) { joined = std::move(results); });
+  EXPECT_THAT(joined, IsEmpty());
+}
+
+TEST(FanInTest, StagesOwnTheFanInUntilTheContinuationRuns) {
+  std::vector<int> joined;
+  std::weak_ptr<FanIn<int>> weak_fan_in;
+  std::vector<std::thread> stages;
+  {
+    auto fan_in = FanIn<int>::Create(8, [&joined](std::vector<int> results) {
+      joined = std::move(results);
+    });
+    weak_fan_in = fan_in;
+    for (int i = 0; i < 8; ++i) {
+      stages.emplace_back([fan_in, i]() { fan_in->Set(i, i * i); });
+    }
+  }
+  for (std::thread& stage : stages) {
+    stage.join();
+  }
+  EXPECT_THAT(joined, ElementsAre(0, 1, 4, 9, 16, 25, 36, 49));
+  EXPECT_TRUE(weak_fan_in.expired());
+}
+
+TEST(FanInTest, ContinuationMayDestroyTheFanIn) {
+  std::unique_ptr<FanIn<int>> fan_in;
+  int sum = 0;
+  fan_in = std::make_unique<FanIn<int>>(
+      2, [&fan_in, &sum](std::vector<int> results) {
+        fan_in.reset();
+        sum = results[0] + results[1];
+      });
+  fan_in->Set(0, 1);
+  fan_in->Set(1, 2);
+  EXPECT_EQ(fan_in, nullptr);
+  EXPECT_EQ(sum, 3);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,78 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_FEATURE_SET_H_
+#define SERVICES_COMMON_UTIL_FEATURE_SET_H_
+
+#include <type_traits>
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Returns `feature` if `enabled`, to be or-ed into a feature set.
+constexpr int FeatureIf(bool enabled, int feature) {
+  return enabled ? feature : 0;
+}
+
+namespace internal {
+
+template <int kFeatures, typename Fn>
+void CallWithFeatureSet(Fn& fn) {
+  fn(std::integral_constant<int, kFeatures>());
+}
+
+template <typename Fn, int... kFeatures>
+void DispatchFeatureSet(int features, Fn& fn,
+                        std::integer_sequence<int, kFeatures...>) {
+  using Call = void (*)(Fn&);
+  static constexpr Call kCalls[] = {&CallWithFeatureSet<kFeatures, Fn>...};
+  kCalls[features](fn);
+}
+
+}  // namespace internal
+
+// Calls `fn(std::integral_constant<int, features>())` through a table of the
+// instantiations of `fn` for each set of `kNumFeatures` features, given as
+// bits. The bits of `features` past the first `kNumFeatures` are ignored.
+//
+// This is for the hot loops of a request that test the same features for
+// each of their items, e.g. logging or limits. The set is fixed for the
+// request, so the loop, written as a generic callable of the set, is
+// compiled once per set with `if constexpr` on its features. The common set,
+// with none enabled, then runs without their branches:
+//
+//   enum : int { kLogInputs = 1 << 0, kLimitBytes = 1 << 1 };
+//   WithFeatureSet<2>(features, [&](auto feature_set) {
+//     constexpr int kFeatures = decltype(feature_set)::value;
+//     for (const Item& item : items) {
+//       if constexpr ((kFeatures & kLimitBytes) != 0) {
+//         ...
+//       }
+//     }
+//   });
+//
+// Each feature doubles the instantiations of the loop, so only the features
+// tested for every item are worth a bit.
+template <int kNumFeatures, typename Fn>
+void WithFeatureSet(int features, Fn&& fn) {
+  static_assert(kNumFeatures >= 0 && kNumFeatures <= 5,
+                "Each feature doubles the instantiations of the loop");
+  constexpr int kCount = 1 << kNumFeatures;
+  internal::DispatchFeatureSet(features & (kCount - 1), fn,
+                               std::make_integer_sequence<int, kCount>());
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_FEATURE_SET_H_
@@ -0,0 +1,57 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/feature_set.h"
+
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+
+enum : int { kFirst = 1 << 0, kSecond = 1 << 1 };
+
+TEST(FeatureSetTest, CallsTheInstantiationOfTheSet) {
+  std::vector<int> called;
+  for (int features : {0, kFirst | kSecond, int{kSecond}, int{kFirst}}) {
+    WithFeatureSet<2>(features, [&called](auto feature_set) {
+      constexpr int kFeatures = decltype(feature_set)::value;
+      static_assert(kFeatures >= 0 && kFeatures < 4);
+      called.push_back(kFeatures);
+    });
+  }
+
+  EXPECT_THAT(called, ElementsAre(0, 3, 2, 1));
+}
+
+TEST(FeatureSetTest, IgnoresTheBitsPastTheFeatures) {
+  int called = -1;
+  WithFeatureSet<1>(kFirst | kSecond, [&called](auto feature_set) {
+    called = decltype(feature_set)::value;
+  });
+
+  EXPECT_EQ(called, kFirst);
+}
+
+TEST(FeatureSetTest, BuildsSetsOfTheEnabledFeatures) {
+  EXPECT_EQ(FeatureIf(true, kFirst) | FeatureIf(false, kSecond), kFirst);
+  EXPECT_EQ(FeatureIf(true, kFirst) | FeatureIf(true, kSecond), 3);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
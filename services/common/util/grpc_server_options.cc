@@ -0,0 +1,82 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/grpc_server_options.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "grpcpp/resource_quota.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::atomic<int> applied_max_threads{0};
+std::atomic<int> applied_memory_quota_mb{0};
+std::atomic<int> applied_num_cqs{0};
+std::atomic<int> applied_max_concurrent_streams{0};
+
+}  // namespace
+
+GrpcServerOptions ResolveGrpcServerOptions(GrpcServerOptions options,
+                                           int num_cpus) {
+  num_cpus = std::max(num_cpus, 1);
+  if (options.max_threads <= 0) {
+    options.max_threads = kGrpcServerThreadsPerCpu * num_cpus;
+  }
+  if (options.num_cqs <= 0) {
+    options.num_cqs = num_cpus;
+  }
+  options.memory_quota_mb = std::max(options.memory_quota_mb, 0);
+  options.max_concurrent_streams = std::max(options.max_concurrent_streams, 0);
+  return options;
+}
+
+void ApplyGrpcServerOptions(const GrpcServerOptions& options,
+                            grpc::ServerBuilder& builder) {
+  const GrpcServerOptions resolved = ResolveGrpcServerOptions(
+      options, static_cast<int>(std::thread::hardware_concurrency()));
+  grpc::ResourceQuota quota("grpc_server");
+  quota.SetMaxThreads(resolved.max_threads);
+  if (resolved.memory_quota_mb > 0) {
+    quota.Resize(static_cast<size_t>(resolved.memory_quota_mb) * 1024 * 1024);
+  }
+  builder.SetResourceQuota(quota);
+  builder.SetSyncServerOption(grpc::ServerBuilder::SyncServerOption::NUM_CQS,
+                              resolved.num_cqs);
+  if (resolved.max_concurrent_streams > 0) {
+    builder.AddChannelArgument(GRPC_ARG_MAX_CONCURRENT_STREAMS,
+                               resolved.max_concurrent_streams);
+  }
+  applied_max_threads = resolved.max_threads;
+  applied_memory_quota_mb = resolved.memory_quota_mb;
+  applied_num_cqs = resolved.num_cqs;
+  applied_max_concurrent_streams = resolved.max_concurrent_streams;
+}
+
+absl::flat_hash_map<std::string, double> GetGrpcServerOptionValues() {
+  return {
+      {"max_threads", applied_max_threads.load()},
+      {"memory_quota_mb", applied_memory_quota_mb.load()},
+      {"num_cqs", applied_num_cqs.load()},
+      {"max_concurrent_streams", applied_max_concurrent_streams.load()},
+  };
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_GRPC_SERVER_OPTIONS_H_
+#define SERVICES_COMMON_UTIL_GRPC_SERVER_OPTIONS_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "grpcpp/server_builder.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Threads of the resource quota of the server per CPU of the host.
+inline constexpr int kGrpcServerThreadsPerCpu = 4;
+
+// Thread and poller configuration of a gRPC server. Values left 0 are
+// defaulted by ResolveGrpcServerOptions.
+struct GrpcServerOptions {
+  // Max threads of the resource quota of the server. Defaults to
+  // kGrpcServerThreadsPerCpu per CPU.
+  int max_threads = 0;
+  // Memory of the resource quota of the server. Left unlimited when 0.
+  int memory_quota_mb = 0;
+  // Completion queues polled by the synchronous services, e.g. health
+  // checks. Defaults to one per CPU.
+  int num_cqs = 0;
+  // Max concurrent streams of each connection. Left to the gRPC default
+  // when 0.
+  int max_concurrent_streams = 0;
+};
+
+// Returns `options` with the values not set defaulted from `num_cpus`.
+GrpcServerOptions ResolveGrpcServerOptions(GrpcServerOptions options,
+                                           int num_cpus);
+
+// Resolves `options` from the CPU count of the host, applies them to
+// `builder` and records them for GetGrpcServerOptionValues.
+void ApplyGrpcServerOptions(const GrpcServerOptions& options,
+                            grpc::ServerBuilder& builder);
+
+// Returns the options last applied by ApplyGrpcServerOptions, by name.
+absl::flat_hash_map<std::string, double> GetGrpcServerOptionValues();
+
+template <typename T>
+inline void AddGrpcServerMetric(T* context_map) {
+  context_map->AddObserverable(metric::kGrpcServerOptions,
+                               GetGrpcServerOptionValues);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_GRPC_SERVER_OPTIONS_H_
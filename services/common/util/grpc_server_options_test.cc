@@ -0,0 +1,69 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/grpc_server_options.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(GrpcServerOptionsTest, DefaultsFromCpuCount) {
+  GrpcServerOptions options = ResolveGrpcServerOptions({}, 8);
+  EXPECT_EQ(options.max_threads, kGrpcServerThreadsPerCpu * 8);
+  EXPECT_EQ(options.num_cqs, 8);
+  EXPECT_EQ(options.memory_quota_mb, 0);
+  EXPECT_EQ(options.max_concurrent_streams, 0);
+}
+
+TEST(GrpcServerOptionsTest, KeepsValuesSet) {
+  GrpcServerOptions options =
+      ResolveGrpcServerOptions({.max_threads = 10,
+                                .memory_quota_mb = 512,
+                                .num_cqs = 2,
+                                .max_concurrent_streams = 100},
+                               8);
+  EXPECT_EQ(options.max_threads, 10);
+  EXPECT_EQ(options.memory_quota_mb, 512);
+  EXPECT_EQ(options.num_cqs, 2);
+  EXPECT_EQ(options.max_concurrent_streams, 100);
+}
+
+TEST(GrpcServerOptionsTest, DefaultsFromOneCpuIfUnknown) {
+  // std::thread::hardware_concurrency is 0 when not known.
+  GrpcServerOptions options = ResolveGrpcServerOptions({}, 0);
+  EXPECT_EQ(options.max_threads, kGrpcServerThreadsPerCpu);
+  EXPECT_EQ(options.num_cqs, 1);
+}
+
+TEST(GrpcServerOptionsTest, RecordsAppliedValues) {
+  grpc::ServerBuilder builder;
+  ApplyGrpcServerOptions({.max_threads = 10,
+                          .memory_quota_mb = 512,
+                          .num_cqs = 2,
+                          .max_concurrent_streams = 100},
+                         builder);
+  EXPECT_THAT(GetGrpcServerOptionValues(),
+              UnorderedElementsAre(Pair("max_threads", 10),
+                                   Pair("memory_quota_mb", 512),
+                                   Pair("num_cqs", 2),
+                                   Pair("max_concurrent_streams", 100)));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
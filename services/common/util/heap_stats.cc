@@ -0,0 +1,97 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/heap_stats.h"
+
+#include <malloc.h>
+
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+HeapStats ReadHeapStats() {
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+  struct mallinfo2 info = mallinfo2();
+#else
+  // Counts wrap past 2 GB.
+  struct mallinfo info = mallinfo();
+#endif
+  return {
+      .allocated_bytes = static_cast<int64_t>(info.uordblks) +
+                         static_cast<int64_t>(info.hblkhd),
+      .free_bytes = static_cast<int64_t>(info.fordblks),
+      .mapped_bytes = static_cast<int64_t>(info.hblkhd),
+  };
+}
+
+absl::flat_hash_map<std::string, double> GetHeapUsage() {
+  const HeapStats stats = ReadHeapStats();
+  absl::flat_hash_map<std::string, double> usage = {
+      {"allocated bytes", stats.allocated_bytes},
+      {"free bytes", stats.free_bytes},
+      {"mapped bytes", stats.mapped_bytes},
+  };
+  const int64_t held_bytes = stats.allocated_bytes + stats.free_bytes;
+  if (held_bytes > 0) {
+    usage["fragmentation ratio"] =
+        static_cast<double>(stats.free_bytes) / held_bytes;
+  }
+  return usage;
+}
+
+absl::Status SetMallocArenaMax(int arena_max) {
+  if (arena_max < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Invalid malloc arena max: ", arena_max));
+  }
+  if (arena_max > 0 && mallopt(M_ARENA_MAX, arena_max) != 1) {
+    return absl::InternalError("Unable to set the malloc arena max");
+  }
+  return absl::OkStatus();
+}
+
+void ReleaseFreeHeapMemory() { malloc_trim(0); }
+
+HeapReleaser::HeapReleaser(absl::Duration period, int64_t min_free_bytes)
+    : period_(period), min_free_bytes_(min_free_bytes) {
+  if (period_ > absl::ZeroDuration()) {
+    run_release_ = std::thread([this]() { Run(); });
+  }
+}
+
+HeapReleaser::~HeapReleaser() {
+  stop_signal_.Notify();
+  if (run_release_.joinable()) {
+    run_release_.join();
+  }
+}
+
+bool HeapReleaser::ShouldRelease(const HeapStats& last, const HeapStats& now,
+                                 int64_t min_free_bytes) {
+  return now.allocated_bytes <= last.allocated_bytes &&
+         now.free_bytes >= min_free_bytes;
+}
+
+void HeapReleaser::Run() {
+  HeapStats last = ReadHeapStats();
+  while (!stop_signal_.WaitForNotificationWithTimeout(period_)) {
+    const HeapStats now = ReadHeapStats();
+    if (ShouldRelease(last, now, min_free_bytes_)) {
+      ReleaseFreeHeapMemory();
+    }
+    last = now;
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_HEAP_STATS_H_
+#define SERVICES_COMMON_UTIL_HEAP_STATS_H_
+
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Heap of the process, as accounted by the allocator, summed over its arenas.
+struct HeapStats {
+  // Bytes of the blocks in use, including those mapped apart from the heap.
+  int64_t allocated_bytes = 0;
+  // Bytes the allocator holds but has not handed out: the cost of
+  // fragmentation, until released to the OS.
+  int64_t free_bytes = 0;
+  // Bytes of the large blocks mapped apart from the heap.
+  int64_t mapped_bytes = 0;
+};
+
+HeapStats ReadHeapStats();
+
+// Returns the heap stats in bytes, and the "fragmentation ratio" of the free
+// bytes to the bytes held. Read by the gauges registered with
+// AddSystemMetric.
+absl::flat_hash_map<std::string, double> GetHeapUsage();
+
+// Caps the number of allocator arenas. Threads allocate in arenas of their
+// own, up to 8 per core by default, which keeps the allocations of many
+// threads apart at the cost of memory left free in each arena. Not changed
+// if arena_max is 0.
+absl::Status SetMallocArenaMax(int arena_max);
+
+// Returns the free memory of the heap to the OS.
+void ReleaseFreeHeapMemory();
+
+// Releases the free memory of the heap to the OS every `period`, but only
+// while the server is quiet, as the allocated bytes did not grow since the
+// last period, and at least `min_free_bytes` are free. Releasing under a
+// growing load only makes the allocator map the same memory again.
+class HeapReleaser {
+ public:
+  static constexpr int64_t kDefaultMinFreeBytes = 64 << 20;
+
+  // Does nothing if period is not positive.
+  explicit HeapReleaser(absl::Duration period,
+                        int64_t min_free_bytes = kDefaultMinFreeBytes);
+
+  // Not copyable or movable, as its thread points to it.
+  HeapReleaser(const HeapReleaser&) = delete;
+  HeapReleaser& operator=(const HeapReleaser&) = delete;
+
+  ~HeapReleaser();
+
+  // Whether the heap should be released, given its stats at the end of the
+  // last period and now.
+  static bool ShouldRelease(const HeapStats& last, const HeapStats& now,
+                            int64_t min_free_bytes);
+
+ private:
+  void Run();
+
+  const absl::Duration period_;
+  const int64_t min_free_bytes_;
+  absl::Notification stop_signal_;
+  std::thread run_release_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_HEAP_STATS_H_
@@ -0,0 +1,68 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/heap_stats.h"
+
+#include <memory>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(HeapStatsTest, CountsAllocatedBytes) {
+  const HeapStats before = ReadHeapStats();
+  // Large enough to be mapped apart from the heap.
+  constexpr int kSize = 16 << 20;
+  auto block = std::make_unique<char[]>(kSize);
+  const HeapStats after = ReadHeapStats();
+
+  EXPECT_GE(after.allocated_bytes - before.allocated_bytes, kSize);
+  EXPECT_GE(after.mapped_bytes - before.mapped_bytes, kSize);
+}
+
+TEST(HeapStatsTest, ReportsFragmentationRatio) {
+  absl::flat_hash_map<std::string, double> usage = GetHeapUsage();
+  ASSERT_TRUE(usage.contains("fragmentation ratio"));
+  EXPECT_GE(usage["fragmentation ratio"], 0);
+  EXPECT_LE(usage["fragmentation ratio"], 1);
+  EXPECT_GT(usage["allocated bytes"], 0);
+}
+
+TEST(HeapStatsTest, RejectsNegativeArenaMax) {
+  EXPECT_FALSE(SetMallocArenaMax(-1).ok());
+  EXPECT_TRUE(SetMallocArenaMax(0).ok());
+}
+
+TEST(HeapReleaserTest, ReleasesOnlyWhileQuiet) {
+  const HeapStats last = {.allocated_bytes = 100, .free_bytes = 50};
+  EXPECT_TRUE(HeapReleaser::ShouldRelease(
+      last, {.allocated_bytes = 100, .free_bytes = 50}, 50));
+  EXPECT_TRUE(HeapReleaser::ShouldRelease(
+      last, {.allocated_bytes = 80, .free_bytes = 70}, 50));
+  // Allocations grew.
+  EXPECT_FALSE(HeapReleaser::ShouldRelease(
+      last, {.allocated_bytes = 101, .free_bytes = 50}, 50));
+  // Too little to release.
+  EXPECT_FALSE(HeapReleaser::ShouldRelease(
+      last, {.allocated_bytes = 100, .free_bytes = 49}, 50));
+}
+
+TEST(HeapReleaserTest, StopsOnDestruction) {
+  HeapReleaser releaser(absl::Milliseconds(1), /*min_free_bytes=*/0);
+  HeapReleaser disabled(absl::ZeroDuration());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,324 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/huge_pages.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <optional>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Returns the content of the file, or an empty string if it cannot be read.
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return "";
+  }
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+// Returns the value in kB of the field of a /proc file, e.g. 2048 for
+// "Hugepagesize:       2048 kB", or nullopt if there is none.
+std::optional<int64_t> FindProcField(absl::string_view content,
+                                     absl::string_view field) {
+  for (absl::string_view line : absl::StrSplit(content, '\n')) {
+    if (!absl::ConsumePrefix(&line, field) ||
+        !absl::ConsumePrefix(&line, ":")) {
+      continue;
+    }
+    absl::ConsumeSuffix(&line, "kB");
+    int64_t value;
+    if (absl::SimpleAtoi(line, &value)) {
+      return value;
+    }
+  }
+  return std::nullopt;
+}
+
+absl::string_view HugePageModeName(HugePageMode mode) {
+  switch (mode) {
+    case HugePageMode::kNone:
+      return "none";
+    case HugePageMode::kTransparent:
+      return "transparent";
+    case HugePageMode::kExplicit:
+      return "explicit";
+  }
+  return "";
+}
+
+// Returns the mode the pool can have on this host, as close to mode as it
+// gets.
+HugePageMode SupportedMode(HugePageMode mode, const HugePageSupport& support) {
+  if (mode == HugePageMode::kExplicit && !support.HasExplicit()) {
+    LOG(WARNING) << "No free explicit huge pages, falling back to "
+                    "transparent huge pages";
+    mode = HugePageMode::kTransparent;
+  }
+  if (mode == HugePageMode::kTransparent && !support.HasTransparent()) {
+    LOG(WARNING) << "Transparent huge pages are " << support.transparent
+                 << ", falling back to regular pages";
+    mode = HugePageMode::kNone;
+  }
+  return mode;
+}
+
+size_t RoundUp(size_t bytes, size_t multiple) {
+  return (bytes + multiple - 1) / multiple * multiple;
+}
+
+LargeBufferPool*& LargeBufferPoolInstance() {
+  static LargeBufferPool* pool = nullptr;
+  return pool;
+}
+
+}  // namespace
+
+absl::StatusOr<HugePageMode> ParseHugePageMode(absl::string_view mode) {
+  for (HugePageMode parsed : {HugePageMode::kNone, HugePageMode::kTransparent,
+                              HugePageMode::kExplicit}) {
+    if (mode == HugePageModeName(parsed)) {
+      return parsed;
+    }
+  }
+  return absl::InvalidArgumentError(absl::StrCat(
+      "Invalid huge page mode: ", mode,
+      ", expected none, transparent or explicit"));
+}
+
+std::string ParseSysfsSelection(absl::string_view content) {
+  const size_t start = content.find('[');
+  const size_t end = content.find(']', start);
+  if (start == absl::string_view::npos || end == absl::string_view::npos) {
+    return "";
+  }
+  return std::string(content.substr(start + 1, end - start - 1));
+}
+
+void ParseMeminfoHugePages(absl::string_view meminfo,
+                           HugePageSupport& support) {
+  if (std::optional<int64_t> page_kb = FindProcField(meminfo, "Hugepagesize");
+      page_kb.has_value() && *page_kb > 0) {
+    support.explicit_page_bytes = *page_kb * 1024;
+  }
+  support.explicit_free_pages =
+      FindProcField(meminfo, "HugePages_Free").value_or(0);
+}
+
+HugePageSupport DetectHugePageSupport(absl::string_view sysfs_dir) {
+  HugePageSupport support;
+  support.transparent =
+      ParseSysfsSelection(ReadFile(absl::StrCat(sysfs_dir, "/enabled")));
+  support.transparent_shmem =
+      ParseSysfsSelection(ReadFile(absl::StrCat(sysfs_dir, "/shmem_enabled")));
+  ParseMeminfoHugePages(ReadFile("/proc/meminfo"), support);
+  return support;
+}
+
+LargeBufferPool::LargeBufferPool(HugePageMode mode,
+                                 const HugePageSupport& support,
+                                 size_t buffer_bytes, int max_idle)
+    : mode_(SupportedMode(mode, support)),
+      page_bytes_(mode_ == HugePageMode::kExplicit ? support.explicit_page_bytes
+                                                   : kDefaultHugePageBytes),
+      buffer_bytes_(RoundUp(std::max<size_t>(buffer_bytes, 1), page_bytes_)),
+      max_idle_(max_idle) {}
+
+LargeBufferPool::~LargeBufferPool() {
+  absl::MutexLock lock(&mu_);
+  for (void* buffer : idle_) {
+    munmap(buffer, buffer_bytes_);
+  }
+}
+
+void* LargeBufferPool::Map(HugePageMode mode) const {
+  if (mode == HugePageMode::kExplicit) {
+    void* buffer = mmap(nullptr, buffer_bytes_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    return buffer == MAP_FAILED ? nullptr : buffer;
+  }
+  if (mode == HugePageMode::kNone) {
+    void* buffer = mmap(nullptr, buffer_bytes_, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return buffer == MAP_FAILED ? nullptr : buffer;
+  }
+  // Aligned on a huge page, as only whole aligned huge pages can back it.
+  const size_t mapped_bytes = buffer_bytes_ + kDefaultHugePageBytes;
+  void* mapped = mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapped == MAP_FAILED) {
+    return nullptr;
+  }
+  const uintptr_t start = reinterpret_cast<uintptr_t>(mapped);
+  const uintptr_t aligned = RoundUp(start, kDefaultHugePageBytes);
+  if (aligned > start) {
+    munmap(mapped, aligned - start);
+  }
+  const uintptr_t end = start + mapped_bytes;
+  if (end > aligned + buffer_bytes_) {
+    munmap(reinterpret_cast<void*>(aligned + buffer_bytes_),
+           end - aligned - buffer_bytes_);
+  }
+  void* buffer = reinterpret_cast<void*>(aligned);
+  if (madvise(buffer, buffer_bytes_, MADV_HUGEPAGE) != 0) {
+    PLOG(WARNING) << "madvise(MADV_HUGEPAGE) failed";
+  }
+  return buffer;
+}
+
+void* LargeBufferPool::Acquire() {
+  {
+    absl::MutexLock lock(&mu_);
+    if (!idle_.empty()) {
+      void* buffer = idle_.back();
+      idle_.pop_back();
+      return buffer;
+    }
+  }
+  HugePageMode mode = mode_;
+  void* buffer = Map(mode);
+  if (buffer == nullptr && mode == HugePageMode::kExplicit) {
+    mode = HugePageMode::kTransparent;
+    buffer = Map(mode);
+  }
+  CHECK(buffer != nullptr) << "Unable to map a buffer of " << buffer_bytes_
+                           << " bytes";
+  absl::MutexLock lock(&mu_);
+  ++num_mapped_;
+  ++num_misses_;
+  if (mode == HugePageMode::kExplicit) {
+    ++num_explicit_;
+  } else if (mode == HugePageMode::kTransparent) {
+    ++num_transparent_;
+  }
+  modes_.emplace(buffer, mode);
+  return buffer;
+}
+
+void LargeBufferPool::Release(void* buffer) {
+  {
+    absl::MutexLock lock(&mu_);
+    if (static_cast<int>(idle_.size()) < max_idle_) {
+      idle_.push_back(buffer);
+      return;
+    }
+    --num_mapped_;
+    auto it = modes_.find(buffer);
+    if (it->second == HugePageMode::kExplicit) {
+      --num_explicit_;
+    } else if (it->second == HugePageMode::kTransparent) {
+      --num_transparent_;
+    }
+    modes_.erase(it);
+  }
+  munmap(buffer, buffer_bytes_);
+}
+
+absl::flat_hash_map<std::string, double> LargeBufferPool::GetUsage() const {
+  absl::MutexLock lock(&mu_);
+  return {
+      {"pool mapped bytes", static_cast<double>(num_mapped_ * buffer_bytes_)},
+      {"pool idle bytes", static_cast<double>(idle_.size() * buffer_bytes_)},
+      {"pool explicit huge page bytes",
+       static_cast<double>(num_explicit_ * buffer_bytes_)},
+      {"pool transparent huge page bytes",
+       static_cast<double>(num_transparent_ * buffer_bytes_)},
+      {"pool misses", static_cast<double>(num_misses_)},
+  };
+}
+
+absl::Status InitLargeBufferPool(absl::string_view mode,
+                                 size_t buffer_bytes) {
+  const HugePageSupport support = DetectHugePageSupport();
+  LOG(INFO) << "Transparent huge pages: " << support.transparent
+            << ", of shared memory: " << support.transparent_shmem
+            << ", free explicit huge pages: " << support.explicit_free_pages;
+  if (!support.HasTransparentShmem()) {
+    // Roma maps the memory it shares with its workers itself, without
+    // advising huge pages, so only the host setting can back it with them.
+    LOG(INFO) << "The shared memory of the Roma workers is not backed by "
+                 "huge pages, as shmem_enabled is "
+              << support.transparent_shmem;
+  }
+  if (mode.empty()) {
+    return absl::OkStatus();
+  }
+  if (LargeBufferPoolInstance() != nullptr) {
+    return absl::FailedPreconditionError(
+        "The large buffer pool is already set up");
+  }
+  absl::StatusOr<HugePageMode> parsed = ParseHugePageMode(mode);
+  if (!parsed.ok()) {
+    return parsed.status();
+  }
+  // Never destroyed, as the arenas of the requests may outlive main.
+  LargeBufferPoolInstance() = new LargeBufferPool(
+      *parsed, support, buffer_bytes, kLargeBufferPoolMaxIdle);
+  LOG(INFO) << "Large buffers of " << LargeBufferPoolInstance()->buffer_bytes()
+            << " bytes are backed by "
+            << HugePageModeName(LargeBufferPoolInstance()->mode()) << " pages";
+  return absl::OkStatus();
+}
+
+LargeBufferPool* GetLargeBufferPool() { return LargeBufferPoolInstance(); }
+
+void* AllocateLargeBuffer(size_t size) {
+  LargeBufferPool* pool = LargeBufferPoolInstance();
+  if (size > pool->buffer_bytes()) {
+    return std::malloc(size);
+  }
+  return pool->Acquire();
+}
+
+void DeallocateLargeBuffer(void* buffer, size_t size) {
+  LargeBufferPool* pool = LargeBufferPoolInstance();
+  if (size > pool->buffer_bytes()) {
+    std::free(buffer);
+    return;
+  }
+  pool->Release(buffer);
+}
+
+absl::flat_hash_map<std::string, double> GetHugePageUsage() {
+  absl::flat_hash_map<std::string, double> usage;
+  if (LargeBufferPool* pool = LargeBufferPoolInstance(); pool != nullptr) {
+    usage = pool->GetUsage();
+  }
+  const std::string smaps = ReadFile("/proc/self/smaps_rollup");
+  if (std::optional<int64_t> kb = FindProcField(smaps, "AnonHugePages");
+      kb.has_value()) {
+    usage["process anon huge page bytes"] = *kb * 1024;
+  }
+  if (std::optional<int64_t> kb = FindProcField(smaps, "ShmemPmdMapped");
+      kb.has_value()) {
+    usage["process shmem huge page bytes"] = *kb * 1024;
+  }
+  return usage;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
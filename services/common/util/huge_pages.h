@@ -0,0 +1,173 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_HUGE_PAGES_H_
+#define SERVICES_COMMON_UTIL_HUGE_PAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr absl::string_view kTransparentHugePageSysfsDir =
+    "/sys/kernel/mm/transparent_hugepage";
+inline constexpr size_t kDefaultHugePageBytes = 2 * 1024 * 1024;
+
+// How the large buffers are backed.
+enum class HugePageMode {
+  // Regular pages.
+  kNone,
+  // Transparent huge pages, asked for with madvise(MADV_HUGEPAGE), which the
+  // kernel backs the buffers with when it has free huge pages.
+  kTransparent,
+  // Huge pages reserved by the host (HugePages_Total in /proc/meminfo),
+  // mapped with MAP_HUGETLB.
+  kExplicit,
+};
+
+// Parses "none", "transparent" or "explicit".
+absl::StatusOr<HugePageMode> ParseHugePageMode(absl::string_view mode);
+
+// Huge pages the host offers, as found at startup.
+struct HugePageSupport {
+  // Settings of the transparent huge pages of private and shared memory, as
+  // selected in sysfs, e.g. "madvise" and "never". Empty if unknown.
+  std::string transparent;
+  std::string transparent_shmem;
+  // Size and free count of the explicit huge pages.
+  size_t explicit_page_bytes = kDefaultHugePageBytes;
+  int64_t explicit_free_pages = 0;
+
+  // Whether madvise(MADV_HUGEPAGE) gets private memory huge pages.
+  bool HasTransparent() const {
+    return transparent == "always" || transparent == "madvise";
+  }
+  // Whether shared memory, such as the one Roma shares with its workers,
+  // gets huge pages without being advised to.
+  bool HasTransparentShmem() const {
+    return transparent_shmem == "always" ||
+           transparent_shmem == "within_size" || transparent_shmem == "force";
+  }
+  bool HasExplicit() const { return explicit_free_pages > 0; }
+};
+
+// Returns the setting selected in the content of a sysfs file listing the
+// choices, e.g. "madvise" for "always [madvise] never".
+std::string ParseSysfsSelection(absl::string_view content);
+
+// Sets the explicit huge pages of support from the content of
+// /proc/meminfo.
+void ParseMeminfoHugePages(absl::string_view meminfo,
+                           HugePageSupport& support);
+
+// Reads the huge pages of the host from sysfs_dir and /proc/meminfo.
+HugePageSupport DetectHugePageSupport(
+    absl::string_view sysfs_dir = kTransparentHugePageSysfsDir);
+
+// Pool of the large buffers of the requests, such as the blocks of the arenas
+// of the largest requests, which are kept mapped once released, so that the
+// next request neither maps them again nor faults their pages in. Backed
+// with huge pages if asked, so that a few TLB entries cover a buffer of
+// several megabytes. Thread safe.
+class LargeBufferPool {
+ public:
+  // buffer_bytes: size of every buffer, rounded up to whole huge pages.
+  // max_idle: most buffers kept once released. Falls back from explicit to
+  // transparent, and from transparent to regular pages, if support does not
+  // have them.
+  LargeBufferPool(HugePageMode mode, const HugePageSupport& support,
+                  size_t buffer_bytes, int max_idle);
+
+  // Not copyable or movable, as the buffers handed out return to it.
+  LargeBufferPool(const LargeBufferPool&) = delete;
+  LargeBufferPool& operator=(const LargeBufferPool&) = delete;
+
+  // Unmaps the idle buffers, which all buffers handed out must be.
+  ~LargeBufferPool();
+
+  // Returns an idle buffer of buffer_bytes(), or maps a new one. An explicit
+  // huge page buffer that cannot be mapped, as the free huge pages ran out,
+  // is mapped with transparent huge pages instead.
+  void* Acquire() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns a buffer from Acquire to the pool, or unmaps it if the pool
+  // already has max_idle idle buffers.
+  void Release(void* buffer) ABSL_LOCKS_EXCLUDED(mu_);
+
+  size_t buffer_bytes() const { return buffer_bytes_; }
+  HugePageMode mode() const { return mode_; }
+
+  // Returns the bytes mapped, idle, and backed by each kind of huge pages,
+  // and the number of buffers mapped because none was idle.
+  absl::flat_hash_map<std::string, double> GetUsage() const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Maps a buffer in mode, or returns nullptr.
+  void* Map(HugePageMode mode) const;
+
+  const HugePageMode mode_;
+  const size_t page_bytes_;
+  const size_t buffer_bytes_;
+  const int max_idle_;
+  mutable absl::Mutex mu_;
+  std::vector<void*> idle_ ABSL_GUARDED_BY(mu_);
+  // Buffers mapped and not unmapped yet, by the pages they were mapped with.
+  int64_t num_mapped_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_explicit_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_transparent_ ABSL_GUARDED_BY(mu_) = 0;
+  int64_t num_misses_ ABSL_GUARDED_BY(mu_) = 0;
+  absl::flat_hash_map<void*, HugePageMode> modes_ ABSL_GUARDED_BY(mu_);
+};
+
+// Size of the buffers of the process-wide pool, the largest block of the
+// arena of a request.
+inline constexpr size_t kLargeBufferBytes = 4 * 1024 * 1024;
+// Most buffers of the process-wide pool kept once released.
+inline constexpr int kLargeBufferPoolMaxIdle = 16;
+
+// Sets up the process-wide pool of buffers of buffer_bytes, backed as mode
+// says ("none", "transparent" or "explicit"), and logs the huge pages of the
+// host. Leaves the pool unset if mode is empty. Must be called once, before
+// the server starts.
+absl::Status InitLargeBufferPool(absl::string_view mode, size_t buffer_bytes);
+
+// Returns the process-wide pool, or nullptr if it is not set up.
+LargeBufferPool* GetLargeBufferPool();
+
+// Allocation functions of the blocks of a google::protobuf::Arena, see
+// ArenaOptions::block_alloc: blocks that fit in a buffer of the process-wide
+// pool are taken from it, the others from malloc. The pool must be set up.
+void* AllocateLargeBuffer(size_t size);
+void DeallocateLargeBuffer(void* buffer, size_t size);
+
+// Returns the usage of the process-wide pool, if set up, and the huge page
+// bytes of the process, including the shared memory of the Roma workers.
+// Read by the gauges registered with AddSystemMetric.
+absl::flat_hash_map<std::string, double> GetHugePageUsage();
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_HUGE_PAGES_H_
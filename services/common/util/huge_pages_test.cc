@@ -0,0 +1,94 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/huge_pages.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(HugePagesTest, ParsesHugePageModes) {
+  EXPECT_EQ(*ParseHugePageMode("none"), HugePageMode::kNone);
+  EXPECT_EQ(*ParseHugePageMode("transparent"), HugePageMode::kTransparent);
+  EXPECT_EQ(*ParseHugePageMode("explicit"), HugePageMode::kExplicit);
+  EXPECT_FALSE(ParseHugePageMode("always").ok());
+}
+
+TEST(HugePagesTest, ParsesTheSysfsSelection) {
+  EXPECT_EQ(ParseSysfsSelection("always [madvise] never\n"), "madvise");
+  EXPECT_EQ(
+      ParseSysfsSelection("always within_size advise [never] deny force\n"),
+      "never");
+  EXPECT_EQ(ParseSysfsSelection(""), "");
+}
+
+TEST(HugePagesTest, ParsesTheExplicitHugePagesOfMeminfo) {
+  HugePageSupport support;
+  ParseMeminfoHugePages(
+      "MemTotal:       16384000 kB\n"
+      "HugePages_Total:     512\n"
+      "HugePages_Free:      100\n"
+      "Hugepagesize:       1048576 kB\n",
+      support);
+  EXPECT_EQ(support.explicit_free_pages, 100);
+  EXPECT_EQ(support.explicit_page_bytes, 1024u * 1024 * 1024);
+  EXPECT_TRUE(support.HasExplicit());
+}
+
+TEST(LargeBufferPoolTest, ReusesTheReleasedBuffers) {
+  LargeBufferPool pool(HugePageMode::kNone, HugePageSupport(),
+                       /*buffer_bytes=*/3 * 1024 * 1024, /*max_idle=*/1);
+  // Rounded up to whole huge pages.
+  EXPECT_EQ(pool.buffer_bytes(), 4u * 1024 * 1024);
+
+  void* first = pool.Acquire();
+  void* second = pool.Acquire();
+  std::memset(first, 1, pool.buffer_bytes());
+  pool.Release(first);
+  // Unmapped, as the pool has max_idle idle buffers.
+  pool.Release(second);
+  EXPECT_EQ(pool.GetUsage()["pool mapped bytes"], pool.buffer_bytes());
+  EXPECT_EQ(pool.GetUsage()["pool idle bytes"], pool.buffer_bytes());
+
+  EXPECT_EQ(pool.Acquire(), first);
+  EXPECT_EQ(pool.GetUsage()["pool misses"], 2);
+  pool.Release(first);
+}
+
+TEST(LargeBufferPoolTest, FallsBackToThePagesTheHostHas) {
+  HugePageSupport support;
+  support.transparent = "madvise";
+  LargeBufferPool pool(HugePageMode::kExplicit, support,
+                       /*buffer_bytes=*/2 * 1024 * 1024, /*max_idle=*/1);
+  EXPECT_EQ(pool.mode(), HugePageMode::kTransparent);
+
+  void* buffer = pool.Acquire();
+  // Aligned on a huge page, so that one can back it.
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) % kDefaultHugePageBytes, 0u);
+  EXPECT_EQ(pool.GetUsage()["pool transparent huge page bytes"],
+            pool.buffer_bytes());
+  pool.Release(buffer);
+
+  support.transparent = "never";
+  EXPECT_EQ(LargeBufferPool(HugePageMode::kTransparent, support,
+                            /*buffer_bytes=*/1, /*max_idle=*/1)
+                .mode(),
+            HugePageMode::kNone);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
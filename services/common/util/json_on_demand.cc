@@ -0,0 +1,105 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/json_on_demand.h"
+
+#include <utility>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+
+#ifdef BIDDING_AUCTION_SIMDJSON
+#include "simdjson.h"
+#endif
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+#ifdef BIDDING_AUCTION_SIMDJSON
+
+namespace {
+
+absl::Status ToStatus(simdjson::error_code error) {
+  return absl::InvalidArgumentError(
+      absl::StrCat("JSON Parse Error: ", simdjson::error_message(error)));
+}
+
+absl::string_view ToStringView(std::string_view view) {
+  return absl::string_view(view.data(), view.size());
+}
+
+// Parsers keep their buffers across the strings they parse, so each thread
+// reuses its own.
+simdjson::ondemand::parser& ThreadParser() {
+  thread_local simdjson::ondemand::parser parser;
+  return parser;
+}
+
+}  // namespace
+
+bool IsOnDemandJsonParserBuiltIn() { return true; }
+
+absl::Status ForEachJsonObjectMember(
+    absl::string_view json, absl::string_view object_name,
+    absl::FunctionRef<void(absl::string_view key, absl::string_view value)>
+        on_member) {
+  // simdjson reads up to SIMDJSON_PADDING bytes past the end of its input.
+  const simdjson::padded_string padded(json.data(), json.size());
+  simdjson::ondemand::document document;
+  if (auto error = ThreadParser().iterate(padded).get(document); error) {
+    return ToStatus(error);
+  }
+  simdjson::ondemand::object object;
+  if (auto error = document
+                       .find_field_unordered(std::string_view(
+                           object_name.data(), object_name.size()))
+                       .get_object()
+                       .get(object);
+      error) {
+    return ToStatus(error);
+  }
+  for (auto member : object) {
+    simdjson::ondemand::field field;
+    std::string_view key;
+    std::string_view value;
+    if (auto error = std::move(member).get(field); error) {
+      return ToStatus(error);
+    }
+    if (auto error = field.unescaped_key().get(key); error) {
+      return ToStatus(error);
+    }
+    // The raw JSON of scalars runs up to the next token.
+    if (auto error = field.value().raw_json().get(value); error) {
+      return ToStatus(error);
+    }
+    on_member(ToStringView(key),
+              absl::StripTrailingAsciiWhitespace(ToStringView(value)));
+  }
+  return absl::OkStatus();
+}
+
+#else
+
+bool IsOnDemandJsonParserBuiltIn() { return false; }
+
+absl::Status ForEachJsonObjectMember(
+    absl::string_view json, absl::string_view object_name,
+    absl::FunctionRef<void(absl::string_view key, absl::string_view value)>
+        on_member) {
+  return absl::UnimplementedError(
+      "Not built with the on-demand JSON parser (--//:json_parser=simdjson)");
+}
+
+#endif  // BIDDING_AUCTION_SIMDJSON
+
+}  // namespace privacy_sandbox::bidding_auction_servers
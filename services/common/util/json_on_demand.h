@@ -0,0 +1,49 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_JSON_ON_DEMAND_H_
+#define SERVICES_COMMON_UTIL_JSON_ON_DEMAND_H_
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// On-demand alternative to ParseJsonString (see json_util.h) for the paths
+// that only extract a few values of large JSON strings, such as the trusted
+// bidding signals of each key. simdjson walks the JSON without building a
+// document, and hands out the serialized values as they are in the input
+// instead of serializing them again.
+//
+// The alternative is only built in with --//:json_parser=simdjson (or
+// --config=simdjson), and is then used by the servers that enable it in their
+// config. The functions below return an Unimplemented error otherwise.
+
+// Whether the server was built with the on-demand JSON parser.
+bool IsOnDemandJsonParserBuiltIn();
+
+// Calls on_member with the unescaped key and the serialized value of each
+// member of the object `object_name` of the top level JSON object `json`, in
+// order. Duplicate keys are passed as many times as they appear. The views
+// are only valid during the call. Returns an error if `json` is not an object
+// holding the object `object_name`, or if it is malformed.
+absl::Status ForEachJsonObjectMember(
+    absl::string_view json, absl::string_view object_name,
+    absl::FunctionRef<void(absl::string_view key, absl::string_view value)>
+        on_member);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_JSON_ON_DEMAND_H_
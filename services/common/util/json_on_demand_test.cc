@@ -0,0 +1,77 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/json_on_demand.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+using Members = std::vector<std::pair<std::string, std::string>>;
+
+absl::Status CollectMembers(absl::string_view json,
+                            absl::string_view object_name, Members& members) {
+  return ForEachJsonObjectMember(
+      json, object_name, [&members](absl::string_view key,
+                                    absl::string_view value) {
+        members.emplace_back(std::string(key), std::string(value));
+      });
+}
+
+TEST(ForEachJsonObjectMember, IsUnimplementedWhenNotBuiltIn) {
+  if (IsOnDemandJsonParserBuiltIn()) {
+    GTEST_SKIP() << "Built with the on-demand JSON parser";
+  }
+  Members members;
+  EXPECT_EQ(CollectMembers(R"({"keys":{}})", "keys", members).code(),
+            absl::StatusCode::kUnimplemented);
+}
+
+TEST(ForEachJsonObjectMember, PassesTheSerializedValuesInOrder) {
+  if (!IsOnDemandJsonParserBuiltIn()) {
+    GTEST_SKIP() << "Not built with the on-demand JSON parser";
+  }
+  Members members;
+  ASSERT_TRUE(CollectMembers(
+                  R"({"other":[1,{"keys":2}],"keys":{"a": [1, 2] ,)"
+                  R"("b\"c":{"x":"y"},"d":1.50 ,"a":null}})",
+                  "keys", members)
+                  .ok());
+  EXPECT_THAT(members, ElementsAre(Pair("a", "[1, 2]"),
+                                   Pair("b\"c", R"({"x":"y"})"),
+                                   Pair("d", "1.50"), Pair("a", "null")));
+}
+
+TEST(ForEachJsonObjectMember, RejectsMissingAndMalformedObjects) {
+  if (!IsOnDemandJsonParserBuiltIn()) {
+    GTEST_SKIP() << "Not built with the on-demand JSON parser";
+  }
+  Members members;
+  EXPECT_FALSE(CollectMembers(R"({"other":{}})", "keys", members).ok());
+  EXPECT_FALSE(CollectMembers(R"({"keys":[]})", "keys", members).ok());
+  EXPECT_FALSE(CollectMembers(R"([{"keys":{}}])", "keys", members).ok());
+  EXPECT_FALSE(CollectMembers(R"({"keys":{"a":1,)", "keys", members).ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
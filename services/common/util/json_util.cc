@@ -0,0 +1,167 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/json_util.h"
+
+#include <cmath>
+
+#include "absl/strings/str_cat.h"
+#include "rapidjson/internal/dtoa.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kHexDigits[] = "0123456789ABCDEF";
+
+// Size of the buffer rapidjson::Writer formats doubles in.
+constexpr int kDoubleBufferSize = 25;
+
+bool NeedsEscaping(unsigned char c) {
+  return c < 0x20 || c == '"' || c == '\\';
+}
+
+}  // namespace
+
+void AppendJsonString(absl::string_view value, std::string* out) {
+  size_t i = 0;
+  while (i < value.size() && !NeedsEscaping(value[i])) {
+    ++i;
+  }
+  if (i == value.size()) {
+    out->reserve(out->size() + value.size() + 2);
+    out->push_back('"');
+    out->append(value.data(), value.size());
+    out->push_back('"');
+    return;
+  }
+
+  out->push_back('"');
+  size_t unescaped_begin = 0;
+  for (; i < value.size(); ++i) {
+    const unsigned char c = value[i];
+    if (!NeedsEscaping(c)) {
+      continue;
+    }
+    out->append(value.data() + unescaped_begin, i - unescaped_begin);
+    unescaped_begin = i + 1;
+    out->push_back('\\');
+    switch (c) {
+      case '"':
+      case '\\':
+        out->push_back(c);
+        break;
+      case '\b':
+        out->push_back('b');
+        break;
+      case '\f':
+        out->push_back('f');
+        break;
+      case '\n':
+        out->push_back('n');
+        break;
+      case '\r':
+        out->push_back('r');
+        break;
+      case '\t':
+        out->push_back('t');
+        break;
+      default:
+        out->append("u00");
+        out->push_back(kHexDigits[c >> 4]);
+        out->push_back(kHexDigits[c & 0xF]);
+    }
+  }
+  out->append(value.data() + unescaped_begin, value.size() - unescaped_begin);
+  out->push_back('"');
+}
+
+JsonWriter& JsonWriter::StartObject() {
+  BeginValue();
+  out_->push_back('{');
+  needs_separator_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+  out_->push_back('}');
+  needs_separator_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::StartArray() {
+  BeginValue();
+  out_->push_back('[');
+  needs_separator_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+  out_->push_back(']');
+  needs_separator_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::Key(absl::string_view key) {
+  BeginValue();
+  AppendJsonString(key, out_);
+  out_->push_back(':');
+  needs_separator_ = false;
+  return *this;
+}
+
+JsonWriter& JsonWriter::String(absl::string_view value) {
+  BeginValue();
+  AppendJsonString(value, out_);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+  BeginValue();
+  // Formats the digits on the stack, appending them with a single copy.
+  absl::StrAppend(out_, value);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+  if (!std::isfinite(value)) {
+    return Null();
+  }
+  BeginValue();
+  char buffer[kDoubleBufferSize];
+  const char* end = rapidjson::internal::dtoa(value, buffer);
+  out_->append(buffer, end - buffer);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+  BeginValue();
+  out_->append(value ? "true" : "false");
+  return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+  BeginValue();
+  out_->append("null");
+  return *this;
+}
+
+JsonWriter& JsonWriter::RawValue(absl::string_view json) {
+  BeginValue();
+  out_->append(json.data(), json.size());
+  return *this;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
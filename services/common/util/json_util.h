@@ -17,10 +17,12 @@
 #ifndef SERVICES_COMMON_UTIL_JSON_UTIL_H_
 #define SERVICES_COMMON_UTIL_JSON_UTIL_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include "rapidjson/pointer.h"
@@ -58,7 +60,73 @@ class SharedStringHolder {
   std::shared_ptr<std::string> shared_string_;
 };
 
+// Appends value to out as a quoted JSON string, escaped the same way
+// rapidjson::Writer escapes strings. Strings without characters to escape are
+// appended with a single copy.
+void AppendJsonString(absl::string_view value, std::string* out);
+
+// Writes JSON directly to a string, without building a rapidjson::Document.
+// Used to build the arguments of the UDFs from request fields. Separators are
+// written as needed, but the calls are not validated: keys and values must be
+// written in an order that makes valid JSON.
+//
+//   std::string json;
+//   JsonWriter writer(&json, /*size_hint=*/64);
+//   writer.StartObject().Key("renderUrl").String(render_url).EndObject();
+class JsonWriter {
+ public:
+  // Appends to out, which is not cleared, so that a buffer can be reused or
+  // the writer can continue a JSON prefix ending with a key. size_hint is the
+  // expected number of bytes to be written, reserved up front.
+  explicit JsonWriter(std::string* out, size_t size_hint = 0) : out_(out) {
+    out_->reserve(out_->size() + size_hint);
+  }
+
+  JsonWriter& StartObject();
+  JsonWriter& EndObject();
+  JsonWriter& StartArray();
+  JsonWriter& EndArray();
+
+  // Writes the escaped key of the next member of an object.
+  JsonWriter& Key(absl::string_view key);
+
+  JsonWriter& String(absl::string_view value);
+  JsonWriter& Int(int64_t value);
+  // Writes the shortest representation that parses back to value, or null if
+  // value is not finite, as JSON has no NaN or infinity.
+  JsonWriter& Double(double value);
+  JsonWriter& Bool(bool value);
+  JsonWriter& Null();
+
+  // Writes json, an already serialized JSON value, as is.
+  JsonWriter& RawValue(absl::string_view json);
+
+  // Writes values as an array of strings.
+  template <typename Strings>
+  JsonWriter& StringArray(const Strings& values) {
+    StartArray();
+    for (const auto& value : values) {
+      String(value);
+    }
+    return EndArray();
+  }
+
+ private:
+  // Writes the separator preceding a value, if any.
+  void BeginValue() {
+    if (needs_separator_) {
+      out_->push_back(',');
+    }
+    needs_separator_ = true;
+  }
+
+  std::string* out_;
+  // Whether a value was written since the last key or start of a container.
+  bool needs_separator_ = false;
+};
+
 // Parse string into a rapidjson::Document. Returns error status or document.
+// See json_on_demand.h for the paths that only extract values from the JSON.
 inline absl::StatusOr<rapidjson::Document> ParseJsonString(
     absl::string_view str) {
   rapidjson::Document doc;
@@ -73,6 +141,22 @@ inline absl::StatusOr<rapidjson::Document> ParseJsonString(
   return doc;
 }
 
+// Same as above, but the document allocates its values from `allocator` (e.g.
+// a request scoped arena) instead of owning its own allocator. `allocator`
+// must outlive the returned document.
+inline absl::StatusOr<rapidjson::Document> ParseJsonString(
+    absl::string_view str, rapidjson::Document::AllocatorType& allocator) {
+  rapidjson::Document doc(&allocator);
+  rapidjson::ParseResult parse_result =
+      doc.Parse<rapidjson::kParseFullPrecisionFlag>(str.data());
+  if (parse_result.IsError()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("JSON Parse Error: ",
+                     rapidjson::GetParseError_En(parse_result.Code())));
+  }
+  return doc;
+}
+
 // Converts rapidjson::Document to a shared string. This provides a
 // shared string to prevent copying large string parameters required
 // by the ROMA engine interface. The reserve_string_len argument helps
@@ -16,6 +16,10 @@
 
 #include "services/common/util/json_util.h"
 
+#include <cstdint>
+#include <limits>
+#include <vector>
+
 #include "include/gtest/gtest.h"
 #include "services/common/test/random.h"
 
@@ -73,5 +77,75 @@ TEST(SerializeJsonDoc, WorksForValidDoc) {
   EXPECT_STREQ(output.value().c_str(), expected_output.c_str());
 }
 
+TEST(AppendJsonString, EscapesLikeRapidJson) {
+  const std::string value =
+      "quote\" backslash\\ slash/ \b\f\n\r\t\x01\x1f \x7f";
+  std::string out;
+  AppendJsonString(value, &out);
+
+  rapidjson::StringBuffer string_buffer;
+  rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
+  writer.String(value.data(), value.size());
+  EXPECT_EQ(out, string_buffer.GetString());
+}
+
+TEST(AppendJsonString, CopiesCleanStringsAsIs) {
+  std::string out = "[";
+  AppendJsonString("https://ad.com/render?id=1", &out);
+  EXPECT_EQ(out, R"(["https://ad.com/render?id=1")");
+}
+
+TEST(JsonWriter, WritesSeparatorsBetweenMembersAndElements) {
+  std::string out;
+  JsonWriter writer(&out, /*size_hint=*/64);
+  writer.StartObject()
+      .Key("a")
+      .Int(std::numeric_limits<int64_t>::min())
+      .Key("b")
+      .StringArray(std::vector<std::string>{"x", "y\"z"})
+      .Key("c")
+      .StartArray()
+      .EndArray()
+      .Key("d")
+      .StartObject()
+      .Key("e")
+      .Bool(true)
+      .Key("f")
+      .Null()
+      .EndObject()
+      .Key("g")
+      .RawValue(R"({"h":[1,2]})")
+      .EndObject();
+  EXPECT_EQ(out,
+            R"({"a":-9223372036854775808,"b":["x","y\"z"],"c":[],)"
+            R"("d":{"e":true,"f":null},"g":{"h":[1,2]}})");
+  EXPECT_TRUE(ParseJsonString(out).ok());
+}
+
+TEST(JsonWriter, EscapesKeys) {
+  std::string out;
+  JsonWriter(&out).StartObject().Key("a\"b").String("c").EndObject();
+  EXPECT_EQ(out, R"({"a\"b":"c"})");
+}
+
+TEST(JsonWriter, ContinuesPrefixEndingWithKey) {
+  std::string out = R"({"a":)";
+  JsonWriter(&out).Int(1).Key("b").Int(2).EndObject();
+  EXPECT_EQ(out, R"({"a":1,"b":2})");
+}
+
+TEST(JsonWriter, WritesDoublesThatRoundTrip) {
+  std::string out;
+  JsonWriter writer(&out);
+  writer.StartArray()
+      .Double(1.5)
+      .Double(0.1)
+      .Double(-2e-7)
+      .Double(std::numeric_limits<double>::infinity())
+      .Double(std::numeric_limits<double>::quiet_NaN())
+      .EndArray();
+  EXPECT_EQ(out, "[1.5,0.1,-2e-7,null,null]");
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
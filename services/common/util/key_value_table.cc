@@ -0,0 +1,111 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/key_value_table.h"
+
+#include <algorithm>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Lengths and counts have at most this many digits, bounding them to less
+// than 1 GB.
+constexpr size_t kMaxDigits = 9;
+
+// Reads the decimal number ending with ':' at the start of input, and
+// removes both from it.
+absl::StatusOr<int64_t> ConsumeNumber(absl::string_view& input) {
+  int64_t number = 0;
+  size_t digits = 0;
+  while (digits < input.size() && input[digits] >= '0' &&
+         input[digits] <= '9' && digits < kMaxDigits) {
+    number = number * 10 + (input[digits] - '0');
+    ++digits;
+  }
+  if (digits == 0 || digits == input.size() || input[digits] != ':') {
+    return absl::InvalidArgumentError(
+        "Malformed key-value table (expected a number)");
+  }
+  input.remove_prefix(digits + 1);
+  return number;
+}
+
+// Reads the length-prefixed bytes at the start of input, and removes them
+// from it.
+absl::StatusOr<absl::string_view> ConsumeBytes(absl::string_view& input) {
+  absl::StatusOr<int64_t> length = ConsumeNumber(input);
+  if (!length.ok()) {
+    return length.status();
+  }
+  if (static_cast<size_t>(*length) > input.size()) {
+    return absl::InvalidArgumentError("Truncated key-value table");
+  }
+  absl::string_view bytes = input.substr(0, *length);
+  input.remove_prefix(*length);
+  return bytes;
+}
+
+}  // namespace
+
+void AppendKeyValueTableSection(absl::string_view name, int count,
+                                std::string* table) {
+  if (table->empty()) {
+    absl::StrAppend(table, kKeyValueTableMagic);
+  }
+  absl::StrAppend(table, name.size(), ":", name, count, ":");
+}
+
+void AppendKeyValueTableEntry(absl::string_view key, absl::string_view value,
+                              std::string* table) {
+  absl::StrAppend(table, key.size(), ":", key, value.size(), ":", value);
+}
+
+absl::StatusOr<KeyValueTable> ParseKeyValueTable(absl::string_view table) {
+  if (!IsKeyValueTable(table)) {
+    return absl::InvalidArgumentError("Not a key-value table");
+  }
+  table.remove_prefix(kKeyValueTableMagic.size());
+  KeyValueTable namespaces;
+  while (!table.empty()) {
+    absl::StatusOr<absl::string_view> name = ConsumeBytes(table);
+    if (!name.ok()) {
+      return name.status();
+    }
+    absl::StatusOr<int64_t> count = ConsumeNumber(table);
+    if (!count.ok()) {
+      return count.status();
+    }
+    KeyValueTableNamespace& values = namespaces[*name];
+    // Each entry takes at least 4 bytes, which bounds the reservation.
+    values.reserve(values.size() + std::min<int64_t>(*count, table.size() / 4));
+    for (int64_t i = 0; i < *count; ++i) {
+      absl::StatusOr<absl::string_view> key = ConsumeBytes(table);
+      if (!key.ok()) {
+        return key.status();
+      }
+      absl::StatusOr<absl::string_view> value = ConsumeBytes(table);
+      if (!value.ok()) {
+        return value.status();
+      }
+      values.try_emplace(*key, *value);
+    }
+  }
+  return namespaces;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,80 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_KEY_VALUE_TABLE_H_
+#define SERVICES_COMMON_UTIL_KEY_VALUE_TABLE_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// A key-value table is a Key-Value server response that can be sliced into
+// the values of its keys without parsing any JSON. It holds the same
+// namespaces (e.g. "keys" or "renderUrls") as the JSON response, with the
+// serialized JSON value of each of their keys:
+//
+//   table   := "KVT1" section*
+//   section := length ":" name count ":" entry{count}
+//   entry   := length ":" key length ":" value
+//
+// where the lengths (in bytes) and counts are decimal numbers, e.g.
+// KVT1 4:keys2: 1:a1:1 1:b7:{"x":1}, without the spaces. The framing is
+// ASCII, so a table of UTF-8 keys and values is valid UTF-8 and is sent to
+// the bidding and auction services in the same string fields as the JSON.
+// A namespace may span several sections, so the tables of the responses of a
+// lookup split into several requests are merged by concatenation.
+inline constexpr absl::string_view kKeyValueTableMagic = "KVT1";
+
+// Media type under which the Key-Value server is asked for a table.
+inline constexpr char kKeyValueTableContentType[] =
+    "application/vnd.bidding-auction.kv-table";
+
+// Values of a namespace of a key-value table, by key. The views point into
+// the table.
+using KeyValueTableNamespace =
+    absl::flat_hash_map<absl::string_view, absl::string_view>;
+
+// Namespaces of a key-value table, by name.
+using KeyValueTable =
+    absl::flat_hash_map<absl::string_view, KeyValueTableNamespace>;
+
+// Whether the Key-Value server response is a key-value table rather than
+// JSON, which never starts with the magic.
+inline bool IsKeyValueTable(absl::string_view response) {
+  return response.substr(0, kKeyValueTableMagic.size()) == kKeyValueTableMagic;
+}
+
+// Appends the header of a section of count entries of the namespace to the
+// table, starting the table if it is empty. The entries are then appended
+// with AppendKeyValueTableEntry.
+void AppendKeyValueTableSection(absl::string_view name, int count,
+                                std::string* table);
+
+// Appends an entry with the serialized JSON value of the key to the table.
+void AppendKeyValueTableEntry(absl::string_view key, absl::string_view value,
+                              std::string* table);
+
+// Slices the table into its namespaces in a single pass over the framing.
+// The values of a namespace spread over several sections are merged, keeping
+// the first value of duplicate keys. Returns an error if the table is
+// truncated or its framing is malformed. The values are not validated.
+absl::StatusOr<KeyValueTable> ParseKeyValueTable(absl::string_view table);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_KEY_VALUE_TABLE_H_
@@ -0,0 +1,97 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/key_value_table.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(KeyValueTableTest, WritesTheDocumentedFraming) {
+  std::string table;
+  AppendKeyValueTableSection("keys", 2, &table);
+  AppendKeyValueTableEntry("a", "1", &table);
+  AppendKeyValueTableEntry("b", R"({"x":1})", &table);
+  EXPECT_EQ(table, R"(KVT14:keys2:1:a1:11:b7:{"x":1})");
+  EXPECT_TRUE(IsKeyValueTable(table));
+  EXPECT_FALSE(IsKeyValueTable(R"({"keys":{}})"));
+  EXPECT_FALSE(IsKeyValueTable(""));
+}
+
+TEST(KeyValueTableTest, SlicesTheValuesOfEachNamespace) {
+  std::string table;
+  AppendKeyValueTableSection("renderUrls", 2, &table);
+  AppendKeyValueTableEntry("https://a.com", "[1,2]", &table);
+  AppendKeyValueTableEntry("https://b.com", "", &table);
+  AppendKeyValueTableSection("adComponentRenderUrls", 1, &table);
+  AppendKeyValueTableEntry("https://c.com", R"("1:2")", &table);
+
+  absl::StatusOr<KeyValueTable> parsed = ParseKeyValueTable(table);
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_THAT((*parsed)["renderUrls"],
+              UnorderedElementsAre(Pair("https://a.com", "[1,2]"),
+                                   Pair("https://b.com", "")));
+  EXPECT_THAT((*parsed)["adComponentRenderUrls"],
+              UnorderedElementsAre(Pair("https://c.com", R"("1:2")")));
+}
+
+TEST(KeyValueTableTest, MergesConcatenatedTablesKeepingTheFirstValues) {
+  std::string first;
+  AppendKeyValueTableSection("keys", 2, &first);
+  AppendKeyValueTableEntry("a", "1", &first);
+  AppendKeyValueTableEntry("b", "2", &first);
+  std::string second;
+  AppendKeyValueTableSection("keys", 2, &second);
+  AppendKeyValueTableEntry("b", "3", &second);
+  AppendKeyValueTableEntry("c", "4", &second);
+  AppendKeyValueTableSection("empty", 0, &second);
+
+  const std::string merged = absl::StrCat(
+      first, absl::string_view(second).substr(kKeyValueTableMagic.size()));
+  absl::StatusOr<KeyValueTable> parsed = ParseKeyValueTable(merged);
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_THAT((*parsed)["keys"],
+              UnorderedElementsAre(Pair("a", "1"), Pair("b", "2"),
+                                   Pair("c", "4")));
+  EXPECT_THAT((*parsed)["empty"], IsEmpty());
+}
+
+TEST(KeyValueTableTest, RejectsMalformedTables) {
+  std::string table;
+  AppendKeyValueTableSection("keys", 1, &table);
+  AppendKeyValueTableEntry("a", R"({"x":1})", &table);
+  ASSERT_TRUE(ParseKeyValueTable(table).ok());
+
+  EXPECT_FALSE(ParseKeyValueTable(R"({"keys":{}})").ok());
+  // Every truncation of the table but the magic alone.
+  for (size_t size = kKeyValueTableMagic.size() + 1; size < table.size();
+       ++size) {
+    EXPECT_FALSE(ParseKeyValueTable(table.substr(0, size)).ok()) << size;
+  }
+  EXPECT_FALSE(ParseKeyValueTable("KVT14:keys1:x:a").ok());
+  EXPECT_FALSE(ParseKeyValueTable("KVT14:keys1:1:a9999999999:1").ok());
+  EXPECT_FALSE(ParseKeyValueTable("KVT14:keys2:1:a1:1").ok());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
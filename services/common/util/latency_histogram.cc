@@ -0,0 +1,76 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::Duration kMinBucketLatency = absl::Microseconds(100);
+// Buckets per doubling of the latency, i.e. each bucket is ~19% wider than
+// the previous one.
+constexpr int kBucketsPerDoubling = 4;
+// Counts are halved once this many latencies are recorded, so that the
+// histogram follows the latest ones.
+constexpr int64_t kDecayWindow = 2048;
+
+absl::Duration BucketUpperBound(int bucket) {
+  return kMinBucketLatency *
+         std::exp2(static_cast<double>(bucket + 1) / kBucketsPerDoubling);
+}
+
+}  // namespace
+
+void LatencyHistogram::Record(absl::Duration latency) {
+  int bucket = 0;
+  if (latency > kMinBucketLatency) {
+    bucket = static_cast<int>(
+        std::log2(absl::FDivDuration(latency, kMinBucketLatency)) *
+        kBucketsPerDoubling);
+    bucket = std::min(bucket, kBuckets - 1);
+  }
+  absl::MutexLock lock(&mu_);
+  ++counts_[bucket];
+  if (++total_ < kDecayWindow) {
+    return;
+  }
+  total_ = 0;
+  for (int64_t& count : counts_) {
+    count /= 2;
+    total_ += count;
+  }
+}
+
+std::optional<absl::Duration> LatencyHistogram::Percentile(
+    double percentile) const {
+  absl::MutexLock lock(&mu_);
+  if (total_ < kMinSamples) {
+    return std::nullopt;
+  }
+  const int64_t rank = std::max<int64_t>(
+      static_cast<int64_t>(std::ceil(total_ * percentile / 100)), 1);
+  int64_t seen = 0;
+  for (int bucket = 0; bucket < kBuckets; ++bucket) {
+    seen += counts_[bucket];
+    if (seen >= rank) {
+      return BucketUpperBound(bucket);
+    }
+  }
+  return BucketUpperBound(kBuckets - 1);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
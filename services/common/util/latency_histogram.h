@@ -0,0 +1,54 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_LATENCY_HISTOGRAM_H_
+#define SERVICES_COMMON_UTIL_LATENCY_HISTOGRAM_H_
+
+#include <array>
+#include <cstdint>
+#include <optional>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Distribution of the recent latencies of a backend, in buckets growing
+// exponentially from 100us to ~6.5s. Older latencies are decayed as new ones
+// are recorded.
+class LatencyHistogram {
+ public:
+  // Latencies recorded before a percentile is reported.
+  static constexpr int64_t kMinSamples = 100;
+
+  void Record(absl::Duration latency) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the upper bound of the bucket holding the given percentile of the
+  // recent latencies, e.g. 99.9, or nullopt if too few latencies were
+  // recorded.
+  std::optional<absl::Duration> Percentile(double percentile) const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  static constexpr int kBuckets = 64;
+
+  mutable absl::Mutex mu_;
+  std::array<int64_t, kBuckets> counts_ ABSL_GUARDED_BY(mu_) = {};
+  int64_t total_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_LATENCY_HISTOGRAM_H_
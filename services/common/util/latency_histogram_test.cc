@@ -0,0 +1,61 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/latency_histogram.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(LatencyHistogramTest, ReportsNothingUntilEnoughLatencies) {
+  LatencyHistogram histogram;
+  for (int i = 1; i < LatencyHistogram::kMinSamples; ++i) {
+    histogram.Record(absl::Milliseconds(1));
+  }
+  EXPECT_EQ(histogram.Percentile(95), std::nullopt);
+
+  histogram.Record(absl::Milliseconds(1));
+  ASSERT_TRUE(histogram.Percentile(95).has_value());
+  EXPECT_GE(*histogram.Percentile(95), absl::Milliseconds(1));
+  EXPECT_LT(*histogram.Percentile(95), absl::Microseconds(1200));
+}
+
+TEST(LatencyHistogramTest, ReportsPercentilesOfLatencies) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 90; ++i) {
+    histogram.Record(absl::Milliseconds(1));
+  }
+  for (int i = 0; i < 10; ++i) {
+    histogram.Record(absl::Milliseconds(100));
+  }
+
+  EXPECT_LT(*histogram.Percentile(90), absl::Microseconds(1200));
+  EXPECT_GE(*histogram.Percentile(95), absl::Milliseconds(100));
+  EXPECT_LT(*histogram.Percentile(95), absl::Milliseconds(120));
+}
+
+TEST(LatencyHistogramTest, ReportsFractionalPercentiles) {
+  LatencyHistogram histogram;
+  for (int i = 0; i < 999; ++i) {
+    histogram.Record(absl::Milliseconds(1));
+  }
+  histogram.Record(absl::Milliseconds(100));
+
+  EXPECT_LT(*histogram.Percentile(99.9), absl::Microseconds(1200));
+  EXPECT_GE(*histogram.Percentile(99.95), absl::Milliseconds(100));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
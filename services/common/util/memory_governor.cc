@@ -0,0 +1,246 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/memory_governor.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "glog/logging.h"
+#include "services/common/util/heap_stats.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::atomic<int> last_pressure{0};
+std::atomic<double> last_used_ratio{0};
+
+// Returns the content of the file, or an empty string if it cannot be read.
+std::string ReadFile(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    return "";
+  }
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+// Returns the value of the field of a file of "<field> <value>" lines, such
+// as memory.stat, or of "<field>: <value> kB" lines, such as /proc/meminfo,
+// in bytes. 0 if there is none.
+int64_t FindField(absl::string_view content, absl::string_view field) {
+  for (absl::string_view line : absl::StrSplit(content, '\n')) {
+    if (!absl::ConsumePrefix(&line, field)) {
+      continue;
+    }
+    if (absl::ConsumePrefix(&line, ":")) {
+      if (int64_t kb; absl::ConsumeSuffix(&line, "kB") &&
+                      absl::SimpleAtoi(line, &kb)) {
+        return kb * 1024;
+      }
+    } else if (int64_t bytes;
+               absl::ConsumePrefix(&line, " ") &&
+               absl::SimpleAtoi(line, &bytes)) {
+      return bytes;
+    }
+  }
+  return 0;
+}
+
+absl::string_view PressureName(MemoryPressure pressure) {
+  switch (pressure) {
+    case MemoryPressure::kNone:
+      return "none";
+    case MemoryPressure::kShrinkCaches:
+      return "shrinking caches";
+    case MemoryPressure::kReduceConcurrency:
+      return "reducing concurrency";
+    case MemoryPressure::kShedRequests:
+      return "shedding requests";
+  }
+  return "";
+}
+
+}  // namespace
+
+std::optional<int64_t> ParseCgroupBytes(absl::string_view content) {
+  int64_t bytes;
+  if (!absl::SimpleAtoi(absl::StripAsciiWhitespace(content), &bytes)) {
+    return std::nullopt;
+  }
+  return bytes;
+}
+
+MemoryUsage ReadMemoryUsage(absl::string_view cgroup_dir) {
+  const int64_t host_bytes =
+      FindField(ReadFile("/proc/meminfo"), "MemTotal");
+  std::optional<int64_t> limit;
+  std::optional<int64_t> used =
+      ParseCgroupBytes(ReadFile(absl::StrCat(cgroup_dir, "/memory.current")));
+  if (used.has_value()) {
+    limit = ParseCgroupBytes(ReadFile(absl::StrCat(cgroup_dir, "/memory.max")));
+    *used -= FindField(ReadFile(absl::StrCat(cgroup_dir, "/memory.stat")),
+                       "inactive_file");
+  } else {
+    // cgroup v1, with the memory controller in a directory of its own.
+    const std::string memory_dir = absl::StrCat(cgroup_dir, "/memory");
+    used = ParseCgroupBytes(
+        ReadFile(absl::StrCat(memory_dir, "/memory.usage_in_bytes")));
+    if (used.has_value()) {
+      limit = ParseCgroupBytes(
+          ReadFile(absl::StrCat(memory_dir, "/memory.limit_in_bytes")));
+      *used -= FindField(ReadFile(absl::StrCat(memory_dir, "/memory.stat")),
+                         "total_inactive_file");
+    } else {
+      used = FindField(ReadFile("/proc/self/status"), "VmRSS");
+    }
+  }
+  MemoryUsage usage;
+  usage.used_bytes = std::max<int64_t>(*used, 0);
+  // A cgroup v1 without a limit has one past the memory of the host.
+  usage.limit_bytes = limit.has_value() && *limit > 0 &&
+                              (host_bytes == 0 || *limit < host_bytes)
+                          ? *limit
+                          : host_bytes;
+  return usage;
+}
+
+absl::StatusOr<std::optional<MemoryWatermarks>> ParseMemoryWatermarks(
+    absl::string_view watermarks) {
+  if (watermarks.empty()) {
+    return std::nullopt;
+  }
+  std::vector<absl::string_view> percents = absl::StrSplit(watermarks, ',');
+  std::vector<double> fractions;
+  for (absl::string_view percent : percents) {
+    double fraction;
+    if (!absl::SimpleAtod(percent, &fraction) || fraction <= 0 ||
+        fraction > 100 ||
+        (!fractions.empty() && fraction / 100 < fractions.back())) {
+      fractions.clear();
+      break;
+    }
+    fractions.push_back(fraction / 100);
+  }
+  if (fractions.size() != 3) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid memory pressure watermarks: ", watermarks,
+        ", expected three increasing percentages, e.g. 80,88,95"));
+  }
+  return MemoryWatermarks{.shrink_caches = fractions[0],
+                          .reduce_concurrency = fractions[1],
+                          .shed_requests = fractions[2]};
+}
+
+MemoryPressure PressureOf(double used, MemoryPressure current,
+                          const MemoryWatermarks& watermarks,
+                          double hysteresis) {
+  const double stage_watermarks[] = {watermarks.shrink_caches,
+                                     watermarks.reduce_concurrency,
+                                     watermarks.shed_requests};
+  int pressure = 0;
+  for (int stage = 1; stage <= 3; ++stage) {
+    // A stage already reached only ends well below its watermark.
+    const double watermark =
+        stage <= static_cast<int>(current)
+            ? stage_watermarks[stage - 1] - hysteresis
+            : stage_watermarks[stage - 1];
+    if (used >= watermark) {
+      pressure = stage;
+    }
+  }
+  return static_cast<MemoryPressure>(pressure);
+}
+
+double CacheScaleOf(MemoryPressure pressure) {
+  return pressure >= MemoryPressure::kShrinkCaches ? 0.5 : 1;
+}
+
+double ConcurrencyScaleOf(MemoryPressure pressure) {
+  if (pressure >= MemoryPressure::kShedRequests) {
+    return 0;
+  }
+  return pressure >= MemoryPressure::kReduceConcurrency ? 0.5 : 1;
+}
+
+MemoryGovernor::MemoryGovernor(MemoryWatermarks watermarks,
+                               absl::Duration period,
+                               std::vector<Listener> listeners,
+                               Reader read_usage)
+    : watermarks_(watermarks),
+      period_(period),
+      listeners_(std::move(listeners)),
+      read_usage_(std::move(read_usage)) {
+  if (period_ > absl::ZeroDuration()) {
+    run_update_ = std::thread([this]() { Run(); });
+  }
+}
+
+MemoryGovernor::~MemoryGovernor() {
+  stop_signal_.Notify();
+  if (run_update_.joinable()) {
+    run_update_.join();
+  }
+  last_pressure = 0;
+}
+
+void MemoryGovernor::Update() {
+  const MemoryUsage usage = read_usage_();
+  if (usage.limit_bytes <= 0) {
+    return;
+  }
+  const double used =
+      static_cast<double>(usage.used_bytes) / usage.limit_bytes;
+  const MemoryPressure current = pressure_.load();
+  const MemoryPressure pressure =
+      PressureOf(used, current, watermarks_, kHysteresis);
+  last_used_ratio = used;
+  last_pressure = static_cast<int>(pressure);
+  if (pressure != current) {
+    LOG(WARNING) << "Memory pressure changed to " << PressureName(pressure)
+                 << ", " << usage.used_bytes << " of " << usage.limit_bytes
+                 << " bytes used";
+    pressure_ = pressure;
+    for (Listener& listener : listeners_) {
+      listener(pressure);
+    }
+  }
+  // Gives back the memory the listeners just freed, and that the allocator
+  // would otherwise keep.
+  if (pressure != MemoryPressure::kNone &&
+      ReadHeapStats().free_bytes >= HeapReleaser::kDefaultMinFreeBytes) {
+    ReleaseFreeHeapMemory();
+  }
+}
+
+void MemoryGovernor::Run() {
+  do {
+    Update();
+  } while (!stop_signal_.WaitForNotificationWithTimeout(period_));
+}
+
+absl::flat_hash_map<std::string, double> GetMemoryGovernorStats() {
+  return {
+      {"pressure", last_pressure.load()},
+      {"used ratio", last_used_ratio.load()},
+  };
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,144 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_MEMORY_GOVERNOR_H_
+#define SERVICES_COMMON_UTIL_MEMORY_GOVERNOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr absl::string_view kCgroupDir = "/sys/fs/cgroup";
+inline constexpr absl::Duration kMemoryGovernorPeriod = absl::Seconds(1);
+
+// Memory the process is charged for, against the most it may use. 0 if
+// unknown.
+struct MemoryUsage {
+  int64_t used_bytes = 0;
+  int64_t limit_bytes = 0;
+};
+
+// Returns the bytes in the content of a cgroup file, e.g. memory.current,
+// or nullopt if it has none, as "max" for an unlimited memory.max.
+std::optional<int64_t> ParseCgroupBytes(absl::string_view content);
+
+// Reads the memory of the cgroup of cgroup_dir, v2 or else v1: the working
+// set, i.e. the charged bytes less the inactive file cache the kernel
+// reclaims first, against the limit of the cgroup. Falls back to the RSS of
+// the process, and to the memory of the host for a cgroup without a limit.
+MemoryUsage ReadMemoryUsage(absl::string_view cgroup_dir = kCgroupDir);
+
+// Stages of the degradation of a server running out of memory, each
+// including the previous ones.
+enum class MemoryPressure {
+  kNone = 0,
+  kShrinkCaches = 1,
+  kReduceConcurrency = 2,
+  kShedRequests = 3,
+};
+
+// Fractions of the limit used past which each stage starts.
+struct MemoryWatermarks {
+  double shrink_caches = 0.80;
+  double reduce_concurrency = 0.88;
+  double shed_requests = 0.95;
+};
+
+// Parses the watermarks as the percentages of the three stages, in order,
+// e.g. "80,88,95". Empty disables the governor, as nullopt.
+absl::StatusOr<std::optional<MemoryWatermarks>> ParseMemoryWatermarks(
+    absl::string_view watermarks);
+
+// Returns the pressure of the fraction used of the limit, given the current
+// pressure: a stage starts past its watermark, and ends once used falls
+// `hysteresis` below it, so that the stage does not flap around it.
+MemoryPressure PressureOf(double used, MemoryPressure current,
+                          const MemoryWatermarks& watermarks,
+                          double hysteresis);
+
+// Scales of the cache capacities and concurrency limits under the pressure,
+// see KeyValueCache::SetCapacityScale and ConcurrencyLimiter::SetLimitScale.
+double CacheScaleOf(MemoryPressure pressure);
+double ConcurrencyScaleOf(MemoryPressure pressure);
+
+// Watches the memory of the server every `period`, and degrades it in
+// stages as the memory nears its limit, rather than letting the OOM killer
+// take every request in flight down: the listeners shrink the caches first,
+// then lower the concurrency, then shed the new requests, and the free heap
+// memory is released to the OS. Undone in reverse as the memory falls.
+class MemoryGovernor {
+ public:
+  using Listener = absl::AnyInvocable<void(MemoryPressure)>;
+  using Reader = absl::AnyInvocable<MemoryUsage()>;
+
+  static constexpr double kHysteresis = 0.05;
+
+  // Calls the listeners on each change of the pressure. Does nothing if
+  // period is not positive.
+  MemoryGovernor(
+      MemoryWatermarks watermarks, absl::Duration period,
+      std::vector<Listener> listeners,
+      Reader read_usage = []() { return ReadMemoryUsage(); });
+
+  // Not copyable or movable, as its thread points to it.
+  MemoryGovernor(const MemoryGovernor&) = delete;
+  MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+  ~MemoryGovernor();
+
+  // Reads the memory now, and updates the pressure. Called every period.
+  void Update();
+
+  MemoryPressure pressure() const { return pressure_.load(); }
+
+ private:
+  void Run();
+
+  const MemoryWatermarks watermarks_;
+  const absl::Duration period_;
+  std::vector<Listener> listeners_;
+  Reader read_usage_;
+  std::atomic<MemoryPressure> pressure_ = MemoryPressure::kNone;
+  absl::Notification stop_signal_;
+  std::thread run_update_;
+};
+
+// Returns the "pressure" stage of the last MemoryGovernor updated, and the
+// "used ratio" of its memory limit.
+absl::flat_hash_map<std::string, double> GetMemoryGovernorStats();
+
+template <typename T>
+inline void AddMemoryGovernorMetric(T* context_map) {
+  context_map->AddObserverable(metric::kMemoryGovernorState,
+                               GetMemoryGovernorStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_MEMORY_GOVERNOR_H_
@@ -0,0 +1,129 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/memory_governor.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+
+constexpr MemoryWatermarks kWatermarks = {.shrink_caches = 0.8,
+                                          .reduce_concurrency = 0.9,
+                                          .shed_requests = 0.95};
+
+void WriteFile(const std::filesystem::path& path, const std::string& content) {
+  std::ofstream(path) << content;
+}
+
+TEST(MemoryGovernorTest, ParsesCgroupBytes) {
+  EXPECT_EQ(ParseCgroupBytes("1073741824\n"), 1073741824);
+  EXPECT_EQ(ParseCgroupBytes("max\n"), std::nullopt);
+  EXPECT_EQ(ParseCgroupBytes(""), std::nullopt);
+}
+
+TEST(MemoryGovernorTest, ReadsTheWorkingSetOfTheCgroup) {
+  const std::filesystem::path dir =
+      std::filesystem::path(testing::TempDir()) / "cgroup";
+  std::filesystem::create_directories(dir);
+  WriteFile(dir / "memory.current", "1000\n");
+  WriteFile(dir / "memory.max", "4000\n");
+  WriteFile(dir / "memory.stat", "active_file 300\ninactive_file 200\n");
+
+  const MemoryUsage usage = ReadMemoryUsage(dir.string());
+  EXPECT_EQ(usage.used_bytes, 800);
+  EXPECT_EQ(usage.limit_bytes, 4000);
+}
+
+TEST(MemoryGovernorTest, ParsesWatermarks) {
+  absl::StatusOr<std::optional<MemoryWatermarks>> parsed =
+      ParseMemoryWatermarks("70,85,92.5");
+  ASSERT_TRUE(parsed.ok());
+  ASSERT_TRUE(parsed->has_value());
+  EXPECT_DOUBLE_EQ((*parsed)->shrink_caches, 0.7);
+  EXPECT_DOUBLE_EQ((*parsed)->reduce_concurrency, 0.85);
+  EXPECT_DOUBLE_EQ((*parsed)->shed_requests, 0.925);
+
+  EXPECT_EQ(*ParseMemoryWatermarks(""), std::nullopt);
+  EXPECT_FALSE(ParseMemoryWatermarks("80,90").ok());
+  EXPECT_FALSE(ParseMemoryWatermarks("90,80,95").ok());
+  EXPECT_FALSE(ParseMemoryWatermarks("80,90,120").ok());
+}
+
+TEST(MemoryGovernorTest, EndsStagesBelowTheirWatermarks) {
+  EXPECT_EQ(PressureOf(0.5, MemoryPressure::kNone, kWatermarks, 0.05),
+            MemoryPressure::kNone);
+  EXPECT_EQ(PressureOf(0.82, MemoryPressure::kNone, kWatermarks, 0.05),
+            MemoryPressure::kShrinkCaches);
+  EXPECT_EQ(PressureOf(0.97, MemoryPressure::kNone, kWatermarks, 0.05),
+            MemoryPressure::kShedRequests);
+  // Within the hysteresis of the stages reached.
+  EXPECT_EQ(PressureOf(0.92, MemoryPressure::kShedRequests, kWatermarks, 0.05),
+            MemoryPressure::kShedRequests);
+  EXPECT_EQ(PressureOf(0.77, MemoryPressure::kShrinkCaches, kWatermarks, 0.05),
+            MemoryPressure::kShrinkCaches);
+  EXPECT_EQ(PressureOf(0.84, MemoryPressure::kShedRequests, kWatermarks, 0.05),
+            MemoryPressure::kShrinkCaches);
+  EXPECT_EQ(PressureOf(0.7, MemoryPressure::kShedRequests, kWatermarks, 0.05),
+            MemoryPressure::kNone);
+}
+
+TEST(MemoryGovernorTest, ScalesDownWithThePressure) {
+  EXPECT_EQ(CacheScaleOf(MemoryPressure::kNone), 1);
+  EXPECT_LT(CacheScaleOf(MemoryPressure::kShrinkCaches), 1);
+  EXPECT_EQ(ConcurrencyScaleOf(MemoryPressure::kShrinkCaches), 1);
+  EXPECT_LT(ConcurrencyScaleOf(MemoryPressure::kReduceConcurrency), 1);
+  EXPECT_EQ(ConcurrencyScaleOf(MemoryPressure::kShedRequests), 0);
+}
+
+TEST(MemoryGovernorTest, CallsTheListenersOnEachChange) {
+  int64_t used_bytes = 0;
+  std::vector<MemoryPressure> changes;
+  std::vector<MemoryGovernor::Listener> listeners;
+  listeners.push_back(
+      [&changes](MemoryPressure pressure) { changes.push_back(pressure); });
+  MemoryGovernor governor(
+      kWatermarks, absl::ZeroDuration(), std::move(listeners),
+      [&used_bytes]() { return MemoryUsage{used_bytes, 100}; });
+
+  for (int64_t used : {50, 85, 86, 96, 50}) {
+    used_bytes = used;
+    governor.Update();
+  }
+  EXPECT_THAT(changes,
+              ElementsAre(MemoryPressure::kShrinkCaches,
+                          MemoryPressure::kShedRequests, MemoryPressure::kNone));
+  EXPECT_EQ(governor.pressure(), MemoryPressure::kNone);
+}
+
+TEST(MemoryGovernorTest, ReportsThePressure) {
+  MemoryGovernor governor(kWatermarks, absl::ZeroDuration(), {},
+                          []() { return MemoryUsage{91, 100}; });
+  governor.Update();
+  auto stats = GetMemoryGovernorStats();
+  EXPECT_EQ(stats["pressure"],
+            static_cast<double>(MemoryPressure::kReduceConcurrency));
+  EXPECT_DOUBLE_EQ(stats["used ratio"], 0.91);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
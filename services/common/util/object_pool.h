@@ -0,0 +1,100 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_OBJECT_POOL_H_
+#define SERVICES_COMMON_UTIL_OBJECT_POOL_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Pool of objects reused across requests, such as the containers of the
+// state of a reactor, so that they keep their capacity instead of being
+// allocated and grown again by every request. Released objects are reset
+// and kept for the next Acquire, up to max_idle of them.
+// Thread safe. The pool must outlive the objects it hands out, so pools are
+// usually process-wide and never destroyed.
+template <typename T>
+class ObjectPool {
+ public:
+  // Returns the object to its pool instead of deleting it.
+  class Deleter {
+   public:
+    explicit Deleter(ObjectPool* pool = nullptr) : pool_(pool) {}
+
+    void operator()(T* object) const { pool_->Release(object); }
+
+   private:
+    ObjectPool* pool_;
+  };
+  using Ptr = std::unique_ptr<T, Deleter>;
+
+  // reset: clears a released object for its next use, without freeing what
+  // is worth keeping, such as the capacity of its containers.
+  ObjectPool(int max_idle, absl::AnyInvocable<void(T&) const> reset)
+      : max_idle_(std::max(max_idle, 0)), reset_(std::move(reset)) {}
+
+  // Not copyable or movable, as the objects handed out point to it.
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+
+  // Returns an idle object, or a new one if there is none.
+  Ptr Acquire() ABSL_LOCKS_EXCLUDED(mu_) {
+    {
+      absl::MutexLock lock(&mu_);
+      if (!idle_.empty()) {
+        T* object = idle_.back().release();
+        idle_.pop_back();
+        return Ptr(object, Deleter(this));
+      }
+    }
+    return Ptr(new T(), Deleter(this));
+  }
+
+  // Number of objects waiting for an Acquire.
+  int idle() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return idle_.size();
+  }
+
+ private:
+  void Release(T* object) ABSL_LOCKS_EXCLUDED(mu_) {
+    std::unique_ptr<T> released(object);
+    // Reset outside of the lock, as it may free much of the object.
+    reset_(*released);
+    absl::MutexLock lock(&mu_);
+    if (idle_.size() < max_idle_) {
+      idle_.push_back(std::move(released));
+    }
+  }
+
+  const size_t max_idle_;
+  const absl::AnyInvocable<void(T&) const> reset_;
+  mutable absl::Mutex mu_;
+  std::vector<std::unique_ptr<T>> idle_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_OBJECT_POOL_H_
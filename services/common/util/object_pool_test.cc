@@ -0,0 +1,75 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/object_pool.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(ObjectPoolTest, ReusesReleasedObjectsWithTheirCapacity) {
+  ObjectPool<std::vector<int>> pool(
+      2, [](std::vector<int>& vector) { vector.clear(); });
+  const std::vector<int>* first;
+  {
+    ObjectPool<std::vector<int>>::Ptr vector = pool.Acquire();
+    vector->resize(100);
+    first = vector.get();
+  }
+  EXPECT_EQ(pool.idle(), 1);
+
+  ObjectPool<std::vector<int>>::Ptr vector = pool.Acquire();
+  EXPECT_EQ(vector.get(), first);
+  EXPECT_TRUE(vector->empty());
+  EXPECT_GE(vector->capacity(), 100);
+  EXPECT_EQ(pool.idle(), 0);
+}
+
+TEST(ObjectPoolTest, KeepsAtMostMaxIdleObjects) {
+  ObjectPool<std::vector<int>> pool(
+      2, [](std::vector<int>& vector) { vector.clear(); });
+  {
+    std::vector<ObjectPool<std::vector<int>>::Ptr> vectors;
+    for (int i = 0; i < 5; ++i) {
+      vectors.push_back(pool.Acquire());
+    }
+  }
+  EXPECT_EQ(pool.idle(), 2);
+}
+
+TEST(ObjectPoolTest, AcquiresAndReleasesConcurrently) {
+  ObjectPool<std::vector<int>> pool(
+      8, [](std::vector<int>& vector) { vector.clear(); });
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&pool]() {
+      for (int j = 0; j < 1000; ++j) {
+        ObjectPool<std::vector<int>>::Ptr vector = pool.Acquire();
+        EXPECT_TRUE(vector->empty());
+        vector->push_back(j);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(pool.idle(), 8);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -18,9 +18,17 @@
 #include <memory>
 #include <string>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "api/bidding_auction_servers.pb.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+
+// Rejection reasons provided by seller, by interest group owner, then by
+// interest group name.
+using RejectionReasonMap = absl::flat_hash_map<
+    std::string, absl::flat_hash_map<std::string, SellerRejectionReason>>;
+
 // Captures the signals from the auction winner.
 struct PostAuctionSignals {
   // Name of the interest group which won the auction.
@@ -44,9 +52,7 @@ struct PostAuctionSignals {
   // Map of rejection reasons provided by seller for interest group
   // Key for outer map --> Interest group owner.
   // Key for inner map --> Interest group name.
-  absl::flat_hash_map<std::string,
-                      absl::flat_hash_map<std::string, SellerRejectionReason>>
-      rejection_reason_map;
+  RejectionReasonMap rejection_reason_map;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
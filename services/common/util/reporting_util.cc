@@ -18,18 +18,123 @@
 #include <string>
 #include <utility>
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
-#include "absl/strings/str_replace.h"
+#include "services/common/concurrent/ttl_lru_cache.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Distinct debug URLs whose templates are kept.
+constexpr size_t kDebugUrlTemplateCacheCapacity = 4096;
+
+constexpr absl::string_view kPlaceholderPrefix = "${";
+
+}  // namespace
+
+DebugUrlTemplate::DebugUrlTemplate(absl::string_view url) {
+  static constexpr std::pair<absl::string_view, Placeholder> kPlaceholders[] =
+      {{kWinningBidPlaceholder, Placeholder::kWinningBid},
+       {kMadeWinningBidPlaceholder, Placeholder::kMadeWinningBid},
+       {kHighestScoringOtherBidPlaceholder,
+        Placeholder::kHighestScoringOtherBid},
+       {kMadeHighestScoringOtherBidPlaceholder,
+        Placeholder::kMadeHighestScoringOtherBid},
+       {kRejectReasonPlaceholder, Placeholder::kRejectReason}};
+  literals_.reserve(url.size());
+  size_t literal_begin = 0;
+  size_t pos = url.find(kPlaceholderPrefix);
+  while (pos != url.npos) {
+    size_t placeholder_size = 0;
+    for (const auto& [name, placeholder] : kPlaceholders) {
+      if (absl::StartsWith(url.substr(pos), name)) {
+        absl::StrAppend(&literals_,
+                        url.substr(literal_begin, pos - literal_begin));
+        segments_.push_back({literals_.size(), placeholder});
+        placeholder_size = name.size();
+        break;
+      }
+    }
+    if (placeholder_size > 0) {
+      literal_begin = pos + placeholder_size;
+      pos = url.find(kPlaceholderPrefix, literal_begin);
+    } else {
+      pos = url.find(kPlaceholderPrefix, pos + 1);
+    }
+  }
+  absl::StrAppend(&literals_, url.substr(literal_begin));
+}
+
+std::string DebugUrlTemplate::Render(
+    const DebugReportingPlaceholder& placeholder_data) const {
+  if (segments_.empty()) {
+    return literals_;
+  }
+  std::string url;
+  url.reserve(literals_.size() + segments_.size() * 16);
+  size_t literal_begin = 0;
+  for (const Segment& segment : segments_) {
+    url.append(literals_, literal_begin, segment.literal_end - literal_begin);
+    literal_begin = segment.literal_end;
+    switch (segment.placeholder) {
+      case Placeholder::kWinningBid:
+        absl::StrAppend(&url, placeholder_data.winning_bid);
+        break;
+      case Placeholder::kMadeWinningBid:
+        url.append(placeholder_data.made_winning_bid ? "true" : "false");
+        break;
+      case Placeholder::kHighestScoringOtherBid:
+        absl::StrAppend(&url, placeholder_data.highest_scoring_other_bid);
+        break;
+      case Placeholder::kMadeHighestScoringOtherBid:
+        url.append(placeholder_data.made_highest_scoring_other_bid ? "true"
+                                                                   : "false");
+        break;
+      case Placeholder::kRejectReason:
+        absl::StrAppend(&url, ToSellerRejectionReasonString(
+                                  placeholder_data.rejection_reason));
+        break;
+    }
+  }
+  url.append(literals_, literal_begin);
+  return url;
+}
+
+std::shared_ptr<const DebugUrlTemplate> GetDebugUrlTemplate(
+    absl::string_view url) {
+  static auto* cache = new TtlLruCache<std::string, const DebugUrlTemplate>(
+      {.max_entries = kDebugUrlTemplateCacheCapacity});
+  if (std::shared_ptr<const DebugUrlTemplate> url_template =
+          cache->LookUp(url)) {
+    return url_template;
+  }
+  auto url_template = std::make_shared<const DebugUrlTemplate>(url);
+  cache->Insert(std::string(url), url_template);
+  return url_template;
+}
 
 PostAuctionSignals GeneratePostAuctionSignals(
     const std::optional<ScoreAdsResponse::AdScore>& winning_ad_score) {
+  // group rejection reasons by buyer and interest group owner.
+  RejectionReasonMap rejection_reason_map;
+  if (winning_ad_score.has_value()) {
+    for (const auto& ad_rejection_reason :
+         winning_ad_score->ad_rejection_reasons()) {
+      rejection_reason_map[ad_rejection_reason.interest_group_owner()]
+          .try_emplace(ad_rejection_reason.interest_group_name(),
+                       ad_rejection_reason.rejection_reason());
+    }
+  }
+  return GeneratePostAuctionSignals(
+      winning_ad_score.has_value() ? &*winning_ad_score : nullptr,
+      std::move(rejection_reason_map));
+}
+
+PostAuctionSignals GeneratePostAuctionSignals(
+    const ScoreAdsResponse::AdScore* winning_ad_score,
+    RejectionReasonMap rejection_reason_map) {
   // If there is no winning ad, return with default signals values.
-  if (!winning_ad_score.has_value()) {
-    absl::flat_hash_map<std::string,
-                        absl::flat_hash_map<std::string, SellerRejectionReason>>
-        rejection_reason_map;
+  if (winning_ad_score == nullptr) {
     return {kDefaultWinningInterestGroupName,
             kDefaultWinningInterestGroupOwner,
             kDefaultWinningBid,
@@ -38,7 +143,7 @@ PostAuctionSignals GeneratePostAuctionSignals(
             kDefaultHasHighestScoringOtherBid,
             kDefaultWinningScore,
             kDefaultWinningAdRenderUrl,
-            std::move(rejection_reason_map)};
+            RejectionReasonMap()};
   }
   float winning_bid = winning_ad_score->buyer_bid();
   float winning_score = winning_ad_score->desirability();
@@ -46,7 +151,7 @@ PostAuctionSignals GeneratePostAuctionSignals(
   std::string highest_scoring_other_bid_ig_owner =
       kDefaultHighestScoringOtherBidInterestGroupOwner;
   float highest_scoring_other_bid = kDefaultHighestScoringOtherBid;
-  bool has_highest_scoring_other_bid;
+  bool has_highest_scoring_other_bid = kDefaultHasHighestScoringOtherBid;
   if (winning_ad_score->ig_owner_highest_scoring_other_bids_map().size() > 0) {
     auto iterator =
         winning_ad_score->ig_owner_highest_scoring_other_bids_map().begin();
@@ -58,27 +163,6 @@ PostAuctionSignals GeneratePostAuctionSignals(
     }
   }
 
-  // group rejection reasons by buyer and interest group owner.
-  absl::flat_hash_map<std::string,
-                      absl::flat_hash_map<std::string, SellerRejectionReason>>
-      rejection_reason_map;
-  for (const auto& ad_rejection_reason :
-       winning_ad_score->ad_rejection_reasons()) {
-    SellerRejectionReason interest_group_rejection_reason =
-        ad_rejection_reason.rejection_reason();
-    if (rejection_reason_map.contains(
-            ad_rejection_reason.interest_group_owner())) {
-      rejection_reason_map.find(ad_rejection_reason.interest_group_owner())
-          ->second.try_emplace(ad_rejection_reason.interest_group_name(),
-                               interest_group_rejection_reason);
-    } else {
-      absl::flat_hash_map<std::string, SellerRejectionReason> ig_rejection_map;
-      ig_rejection_map.emplace(ad_rejection_reason.interest_group_name(),
-                               interest_group_rejection_reason);
-      rejection_reason_map.emplace(ad_rejection_reason.interest_group_owner(),
-                                   ig_rejection_map);
-    }
-  }
   return {winning_ad_score->interest_group_name(),
           winning_ad_score->interest_group_owner(),
           winning_bid,
@@ -93,20 +177,8 @@ PostAuctionSignals GeneratePostAuctionSignals(
 HTTPRequest CreateDebugReportingHttpRequest(
     absl::string_view url,
     std::unique_ptr<DebugReportingPlaceholder> placeholder_data) {
-  std::string formatted_url = absl::StrReplaceAll(
-      url,
-      {{kWinningBidPlaceholder, absl::StrCat(placeholder_data->winning_bid)},
-       {kMadeWinningBidPlaceholder,
-        placeholder_data->made_winning_bid ? "true" : "false"},
-       {kHighestScoringOtherBidPlaceholder,
-        absl::StrCat(placeholder_data->highest_scoring_other_bid)},
-       {kMadeHighestScoringOtherBidPlaceholder,
-        placeholder_data->made_highest_scoring_other_bid ? "true" : "false"},
-       {kRejectReasonPlaceholder,
-        ToSellerRejectionReasonString(placeholder_data->rejection_reason)}});
   HTTPRequest http_request;
-  http_request.url = formatted_url;
-  http_request.headers = {};
+  http_request.url = GetDebugUrlTemplate(url)->Render(*placeholder_data);
   return http_request;
 }
 
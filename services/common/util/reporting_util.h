@@ -16,6 +16,9 @@
 #define SERVICES_COMMON_UTIL_REPORTING_UTIL_H
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <vector>
 
 #include "absl/strings/string_view.h"
 #include "api/bidding_auction_servers.pb.h"
@@ -85,11 +88,54 @@ struct DebugReportingPlaceholder {
   }
 };
 
+// Debug reporting URL split once into the text around its placeholders, so
+// that it is rendered for many interest groups by appending each segment and
+// placeholder value once, without a search of the placeholders per render.
+class DebugUrlTemplate {
+ public:
+  explicit DebugUrlTemplate(absl::string_view url);
+
+  // Returns the URL with its placeholders replaced by `placeholder_data`.
+  // Only the values of the placeholders found in the URL are formatted.
+  std::string Render(const DebugReportingPlaceholder& placeholder_data) const;
+
+ private:
+  enum class Placeholder {
+    kWinningBid,
+    kMadeWinningBid,
+    kHighestScoringOtherBid,
+    kMadeHighestScoringOtherBid,
+    kRejectReason,
+  };
+
+  // Text of the URL up to `literal_end`, followed by `placeholder`.
+  struct Segment {
+    size_t literal_end;
+    Placeholder placeholder;
+  };
+
+  // The URL without its placeholders.
+  std::string literals_;
+  std::vector<Segment> segments_;
+};
+
+// Returns the template of `url`, parsed on its first use and cached for the
+// next requests, as the debug URLs of an interest group rarely change.
+std::shared_ptr<const DebugUrlTemplate> GetDebugUrlTemplate(
+    absl::string_view url);
+
 // Returns post auction signals from winning ad score.
 // If there is no winning ad, default values are returned.
 PostAuctionSignals GeneratePostAuctionSignals(
     const std::optional<ScoreAdsResponse::AdScore>& winning_ad_score);
 
+// Same as above, with the rejection reasons of the winning ad score already
+// grouped by its caller, such as while the ads were scored. winning_ad_score
+// is null if there is no winning ad.
+PostAuctionSignals GeneratePostAuctionSignals(
+    const ScoreAdsResponse::AdScore* winning_ad_score,
+    RejectionReasonMap rejection_reason_map);
+
 // Returns a http request object for debug reporting after replacing placeholder
 // data in the url.
 HTTPRequest CreateDebugReportingHttpRequest(
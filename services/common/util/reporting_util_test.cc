@@ -198,6 +198,33 @@ TEST(CreateDebugReportingHttpRequestTest, GetWithNoPlaceholder) {
   EXPECT_EQ(request.url, expected_url);
 }
 
+TEST(DebugUrlTemplateTest, RendersEveryPlaceholderAndKeepsUnknownOnes) {
+  DebugUrlTemplate url_template(
+      "https://wikipedia.org?${unknown}&wb=${winningBid}&mwb=${madeWinningBid}"
+      "&hob=${highestScoringOtherBid}&mhob=${madeHighestScoringOtherBid}"
+      "&rr=${rejectReason}&wb2=${winningBid}$${winningBid");
+  DebugReportingPlaceholder placeholder(1.9, true, 2.18, false,
+                                        SellerRejectionReason::INVALID_BID);
+  EXPECT_EQ(url_template.Render(placeholder),
+            "https://wikipedia.org?${unknown}&wb=1.9&mwb=true&hob=2.18"
+            "&mhob=false&rr=invalid-bid&wb2=1.9$${winningBid");
+}
+
+TEST(DebugUrlTemplateTest, RendersUrlStartingAndEndingWithPlaceholder) {
+  DebugUrlTemplate url_template("${winningBid}${madeWinningBid}");
+  DebugReportingPlaceholder placeholder(
+      0.0, false, 0.0, false,
+      SellerRejectionReason::SELLER_REJECTION_REASON_NOT_AVAILABLE);
+  EXPECT_EQ(url_template.Render(placeholder), "0false");
+}
+
+TEST(DebugUrlTemplateTest, CachesTheTemplateOfAUrl) {
+  absl::string_view url = "https://wikipedia.org?wb=${winningBid}";
+  EXPECT_EQ(GetDebugUrlTemplate(url), GetDebugUrlTemplate(url));
+  EXPECT_NE(GetDebugUrlTemplate(url),
+            GetDebugUrlTemplate("https://wikipedia.org"));
+}
+
 TEST(GetPlaceholderDataForInterestGroupOwnerTest, IgOwnerIsNone) {
   absl::flat_hash_map<std::string,
                       absl::flat_hash_map<std::string, SellerRejectionReason>>
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_class.h"
+
+#include <string>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::string_view RequestClassName(RequestClass request_class) {
+  switch (request_class) {
+    case RequestClass::kPremium:
+      return "premium";
+    case RequestClass::kStandard:
+      return "standard";
+    case RequestClass::kLow:
+      return "low";
+  }
+  return "";
+}
+
+RequestClass ParseRequestClass(absl::string_view name) {
+  if (name == RequestClassName(RequestClass::kPremium)) {
+    return RequestClass::kPremium;
+  }
+  if (name == RequestClassName(RequestClass::kLow)) {
+    return RequestClass::kLow;
+  }
+  return RequestClass::kStandard;
+}
+
+RequestClass RequestClassOf(int32_t seller_priority, bool known_client) {
+  if (seller_priority > 0) {
+    return RequestClass::kPremium;
+  }
+  if (seller_priority < 0 || !known_client) {
+    return RequestClass::kLow;
+  }
+  return RequestClass::kStandard;
+}
+
+RequestClass GetRequestClass(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& client_metadata) {
+  auto it = client_metadata.find(
+      grpc::string_ref(kRequestClassMetadataKey.data(),
+                       kRequestClassMetadataKey.size()));
+  if (it == client_metadata.end()) {
+    return RequestClass::kStandard;
+  }
+  return ParseRequestClass(
+      absl::string_view(it->second.data(), it->second.size()));
+}
+
+void AddRequestClass(RequestClass request_class,
+                     absl::flat_hash_map<std::string, std::string>& metadata) {
+  if (request_class != RequestClass::kStandard) {
+    metadata.insert_or_assign(std::string(kRequestClassMetadataKey),
+                              std::string(RequestClassName(request_class)));
+  }
+}
+
+double AdmissionShareOf(RequestClass request_class) {
+  switch (request_class) {
+    case RequestClass::kPremium:
+      return 1.0;
+    case RequestClass::kStandard:
+      return 0.9;
+    case RequestClass::kLow:
+      return 0.7;
+  }
+  return 1.0;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_CLASS_H_
+#define SERVICES_COMMON_UTIL_REQUEST_CLASS_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "grpcpp/grpcpp.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// gRPC metadata key carrying the class of a request to the servers it calls,
+// so that every hop prioritizes it the same way.
+inline constexpr absl::string_view kRequestClassMetadataKey =
+    "x-bna-request-class";
+
+// Tag of the dispatch requests carrying the class of their request, by which
+// the scheduler of CodeDispatchClient orders them.
+inline constexpr char kRequestClassTag[] = "RequestClass";
+
+// Classes of the requests, protected from overload in this order.
+enum class RequestClass {
+  kPremium = 0,
+  kStandard = 1,
+  // E.g. long-tail inventory, or clients of an unknown type.
+  kLow = 2,
+};
+
+absl::string_view RequestClassName(RequestClass request_class);
+
+// Returns the class named as by RequestClassName, or kStandard.
+RequestClass ParseRequestClass(absl::string_view name);
+
+// Returns the class of a request from the priority the seller gave it, or
+// else from its client: premium for a positive priority, low for a negative
+// one or for a client of an unknown type, and standard otherwise.
+RequestClass RequestClassOf(int32_t seller_priority, bool known_client);
+
+// Returns the class the caller sent with a request, or kStandard.
+RequestClass GetRequestClass(
+    const std::multimap<grpc::string_ref, grpc::string_ref>& client_metadata);
+
+// Adds the class to the metadata of a call to another server. Standard is
+// left out, as the servers default to it.
+void AddRequestClass(RequestClass request_class,
+                     absl::flat_hash_map<std::string, std::string>& metadata);
+
+// Share of the concurrency limit of a server its requests of the class may
+// take, so that the rest is kept for the classes above when overloaded.
+double AdmissionShareOf(RequestClass request_class);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_CLASS_H_
@@ -0,0 +1,56 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/request_class.h"
+
+#include <map>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(RequestClassTest, DerivesTheClassOfTheSellerPriority) {
+  EXPECT_EQ(RequestClassOf(5, /*known_client=*/false), RequestClass::kPremium);
+  EXPECT_EQ(RequestClassOf(-1, /*known_client=*/true), RequestClass::kLow);
+  EXPECT_EQ(RequestClassOf(0, /*known_client=*/false), RequestClass::kLow);
+  EXPECT_EQ(RequestClassOf(0, /*known_client=*/true), RequestClass::kStandard);
+}
+
+TEST(RequestClassTest, PropagatesTheClassInTheMetadata) {
+  absl::flat_hash_map<std::string, std::string> metadata;
+  AddRequestClass(RequestClass::kStandard, metadata);
+  EXPECT_TRUE(metadata.empty());
+  AddRequestClass(RequestClass::kPremium, metadata);
+  ASSERT_EQ(metadata.size(), 1);
+
+  std::multimap<grpc::string_ref, grpc::string_ref> client_metadata;
+  EXPECT_EQ(GetRequestClass(client_metadata), RequestClass::kStandard);
+  const auto& [key, value] = *metadata.begin();
+  client_metadata.emplace(key, value);
+  EXPECT_EQ(GetRequestClass(client_metadata), RequestClass::kPremium);
+}
+
+TEST(RequestClassTest, ParsesTheNames) {
+  for (RequestClass request_class :
+       {RequestClass::kPremium, RequestClass::kStandard, RequestClass::kLow}) {
+    EXPECT_EQ(ParseRequestClass(RequestClassName(request_class)),
+              request_class);
+  }
+  EXPECT_EQ(ParseRequestClass("gold"), RequestClass::kStandard);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_cpu_time.h"
+
+#include <time.h>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::string_view CpuStageName(CpuStage stage) {
+  switch (stage) {
+    case CpuStage::kDecrypt:
+      return "decrypt";
+    case CpuStage::kPrepare:
+      return "prepare";
+    case CpuStage::kHandleResponse:
+      return "handle_response";
+    case CpuStage::kEncrypt:
+      return "encrypt";
+  }
+  return "";
+}
+
+absl::Duration ThreadCpuTime() {
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+    return absl::ZeroDuration();
+  }
+  return absl::DurationFromTimespec(ts);
+}
+
+void RequestCpuTime::Add(CpuStage stage, absl::Duration cpu_time) {
+  if (cpu_time <= absl::ZeroDuration()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  stages_[static_cast<int>(stage)] += cpu_time;
+}
+
+absl::Duration RequestCpuTime::Get(CpuStage stage) const {
+  absl::MutexLock lock(&mu_);
+  return stages_[static_cast<int>(stage)];
+}
+
+absl::Duration RequestCpuTime::Total() const {
+  absl::MutexLock lock(&mu_);
+  absl::Duration total;
+  for (absl::Duration stage_cpu_time : stages_) {
+    total += stage_cpu_time;
+  }
+  return total;
+}
+
+void RequestCpuTime::AddDispatchWallTime(absl::Duration wall_time) {
+  if (wall_time <= absl::ZeroDuration()) {
+    return;
+  }
+  absl::MutexLock lock(&mu_);
+  dispatch_wall_time_ += wall_time;
+}
+
+absl::Duration RequestCpuTime::DispatchWallTime() const {
+  absl::MutexLock lock(&mu_);
+  return dispatch_wall_time_;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
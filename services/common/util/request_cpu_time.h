@@ -0,0 +1,116 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_CPU_TIME_H_
+#define SERVICES_COMMON_UTIL_REQUEST_CPU_TIME_H_
+
+#include <array>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Stages of a request its CPU time is accounted to. Named in
+// metric::kCpuStages. The JS executions of the request run in the worker
+// processes of Roma, whose CPU time is not known, and are not a stage.
+enum class CpuStage {
+  kDecrypt,
+  // Building the requests to the other servers or the dispatch requests.
+  kPrepare,
+  // Handling the responses of the other servers or of the dispatch.
+  kHandleResponse,
+  kEncrypt,
+};
+
+// Returns the name of the stage in metric::kCpuStages.
+absl::string_view CpuStageName(CpuStage stage);
+
+// Returns the CPU time the calling thread has used so far, from its thread
+// CPU clock.
+absl::Duration ThreadCpuTime();
+
+// CPU time of a request by stage, summed over the callbacks and threads
+// serving it, until it is logged in the metric context of the request. The
+// reactors sample ThreadCpuTime at the boundaries of a stage on the thread
+// running it and add the difference. Thread safe.
+class RequestCpuTime final {
+ public:
+  RequestCpuTime() = default;
+
+  // Not copyable or movable.
+  RequestCpuTime(const RequestCpuTime&) = delete;
+  RequestCpuTime& operator=(const RequestCpuTime&) = delete;
+
+  void Add(CpuStage stage, absl::Duration cpu_time) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Adds the CPU time the calling thread used since thread_cpu_start, a
+  // ThreadCpuTime sampled on it at the start of the stage.
+  void AddSince(CpuStage stage, absl::Duration thread_cpu_start)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    Add(stage, ThreadCpuTime() - thread_cpu_start);
+  }
+
+  absl::Duration Get(CpuStage stage) const ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Duration Total() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Adds the wall time a dispatch of the request took in Roma, kept apart
+  // from its CPU time.
+  void AddDispatchWallTime(absl::Duration wall_time) ABSL_LOCKS_EXCLUDED(mu_);
+
+  absl::Duration DispatchWallTime() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable absl::Mutex mu_;
+  std::array<absl::Duration, 4> stages_ ABSL_GUARDED_BY(mu_);
+  absl::Duration dispatch_wall_time_ ABSL_GUARDED_BY(mu_);
+};
+
+// Logs the CPU time of the request and of the stages it went through, and the
+// wall time of its dispatches, in the metric context of the request.
+template <typename ContextT>
+void LogRequestCpuTime(const RequestCpuTime& cpu_time, ContextT& context) {
+  if (const absl::Duration dispatch_wall_time = cpu_time.DispatchWallTime();
+      dispatch_wall_time > absl::ZeroDuration()) {
+    LogIfError(context.template LogHistogram<metric::kRequestDispatchWallTime>(
+        static_cast<int>(dispatch_wall_time / absl::Microseconds(1))));
+  }
+  const absl::Duration total = cpu_time.Total();
+  if (total <= absl::ZeroDuration()) {
+    return;
+  }
+  LogIfError(context.template LogHistogram<metric::kRequestCpuTime>(
+      static_cast<int>(total / absl::Microseconds(1))));
+  for (CpuStage stage : {CpuStage::kDecrypt, CpuStage::kPrepare,
+                         CpuStage::kHandleResponse, CpuStage::kEncrypt}) {
+    const absl::Duration stage_cpu_time = cpu_time.Get(stage);
+    if (stage_cpu_time <= absl::ZeroDuration()) {
+      continue;
+    }
+    LogIfError(
+        context.template AccumulateMetric<metric::kRequestCpuTimeByStage>(
+            static_cast<int>(stage_cpu_time / absl::Microseconds(1)),
+            CpuStageName(stage)));
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_CPU_TIME_H_
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_cpu_time.h"
+
+#include <thread>
+
+#include "absl/algorithm/container.h"
+#include "absl/time/clock.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(RequestCpuTimeTest, SumsTheStages) {
+  RequestCpuTime cpu_time;
+  cpu_time.Add(CpuStage::kPrepare, absl::Microseconds(10));
+  cpu_time.Add(CpuStage::kPrepare, absl::Microseconds(20));
+  cpu_time.Add(CpuStage::kDecrypt, absl::Microseconds(5));
+  cpu_time.Add(CpuStage::kEncrypt, -absl::Microseconds(5));
+
+  EXPECT_EQ(cpu_time.Get(CpuStage::kPrepare), absl::Microseconds(30));
+  EXPECT_EQ(cpu_time.Get(CpuStage::kDecrypt), absl::Microseconds(5));
+  EXPECT_EQ(cpu_time.Get(CpuStage::kEncrypt), absl::ZeroDuration());
+  EXPECT_EQ(cpu_time.Total(), absl::Microseconds(35));
+}
+
+TEST(RequestCpuTimeTest, KeepsTheDispatchWallTimeApart) {
+  RequestCpuTime cpu_time;
+  cpu_time.Add(CpuStage::kPrepare, absl::Microseconds(10));
+  cpu_time.AddDispatchWallTime(absl::Milliseconds(3));
+  cpu_time.AddDispatchWallTime(absl::Milliseconds(2));
+
+  EXPECT_EQ(cpu_time.DispatchWallTime(), absl::Milliseconds(5));
+  EXPECT_EQ(cpu_time.Total(), absl::Microseconds(10));
+}
+
+TEST(RequestCpuTimeTest, AccountsTheCpuOfTheThreadsOnly) {
+  RequestCpuTime cpu_time;
+  auto spin_and_sleep = [&cpu_time]() {
+    const absl::Duration start = ThreadCpuTime();
+    while (ThreadCpuTime() - start < absl::Milliseconds(20)) {
+    }
+    absl::SleepFor(absl::Milliseconds(50));
+    cpu_time.AddSince(CpuStage::kHandleResponse, start);
+  };
+  std::thread other(spin_and_sleep);
+  spin_and_sleep();
+  other.join();
+
+  const absl::Duration total = cpu_time.Get(CpuStage::kHandleResponse);
+  // The time asleep is not accounted.
+  EXPECT_GE(total, absl::Milliseconds(40));
+  EXPECT_LT(total, absl::Milliseconds(90));
+}
+
+TEST(RequestCpuTimeTest, NamesTheStagesAsTheMetricPartitions) {
+  for (CpuStage stage : {CpuStage::kDecrypt, CpuStage::kPrepare,
+                         CpuStage::kHandleResponse, CpuStage::kEncrypt}) {
+    EXPECT_NE(absl::c_find(metric::kCpuStages, CpuStageName(stage)),
+              std::end(metric::kCpuStages));
+  }
+  EXPECT_TRUE(absl::c_is_sorted(metric::kCpuStages));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
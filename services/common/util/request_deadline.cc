@@ -0,0 +1,40 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_deadline.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+absl::Time GetRequestDeadline(const grpc::ServerContextBase& context) {
+  if (context.deadline() == std::chrono::system_clock::time_point::max()) {
+    return absl::InfiniteFuture();
+  }
+  return absl::FromChrono(context.deadline());
+}
+
+absl::Duration TimeoutWithinDeadline(absl::Duration timeout,
+                                     absl::Time deadline,
+                                     absl::Duration margin, absl::Time now) {
+  if (deadline == absl::InfiniteFuture()) {
+    return timeout;
+  }
+  return std::min(timeout, deadline - now - margin);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
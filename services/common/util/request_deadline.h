@@ -0,0 +1,49 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_DEADLINE_H_
+#define SERVICES_COMMON_UTIL_REQUEST_DEADLINE_H_
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "grpcpp/grpcpp.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kDeadlineExceededBeforeCall[] =
+    "Request deadline reached before calling the downstream server.";
+
+// Time kept between the deadline of a request and the deadline of the calls
+// it makes to the servers downstream, to handle their responses and respond.
+inline constexpr absl::Duration kDownstreamDeadlineMargin =
+    absl::Milliseconds(5);
+
+// Returns the deadline of the request served with `context`, or
+// absl::InfiniteFuture() when the client did not set one.
+absl::Time GetRequestDeadline(const grpc::ServerContextBase& context);
+
+// Returns `timeout` cut to the time left before `deadline`, minus `margin`,
+// so that the calls made downstream of a request end before it does. Not
+// positive once the time left is used up, in which case the call is not
+// worth making.
+absl::Duration TimeoutWithinDeadline(
+    absl::Duration timeout, absl::Time deadline,
+    absl::Duration margin = kDownstreamDeadlineMargin,
+    absl::Time now = absl::Now());
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_DEADLINE_H_
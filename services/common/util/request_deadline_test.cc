@@ -0,0 +1,53 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/request_deadline.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(RequestDeadlineTest, ReturnsInfiniteFutureWithoutDeadline) {
+  grpc::CallbackServerContext context;
+  EXPECT_EQ(GetRequestDeadline(context), absl::InfiniteFuture());
+}
+
+TEST(RequestDeadlineTest, KeepsTimeoutWithoutDeadline) {
+  EXPECT_EQ(TimeoutWithinDeadline(absl::Seconds(1), absl::InfiniteFuture()),
+            absl::Seconds(1));
+}
+
+TEST(RequestDeadlineTest, CutsTimeoutToTimeLeft) {
+  const absl::Time now = absl::FromUnixSeconds(100);
+  EXPECT_EQ(TimeoutWithinDeadline(absl::Seconds(1),
+                                  now + absl::Milliseconds(300),
+                                  absl::Milliseconds(20), now),
+            absl::Milliseconds(280));
+  EXPECT_EQ(TimeoutWithinDeadline(absl::Milliseconds(100),
+                                  now + absl::Milliseconds(300),
+                                  absl::Milliseconds(20), now),
+            absl::Milliseconds(100));
+}
+
+TEST(RequestDeadlineTest, ReturnsNonPositiveTimeoutPastDeadline) {
+  const absl::Time now = absl::FromUnixSeconds(100);
+  EXPECT_LE(TimeoutWithinDeadline(absl::Seconds(1),
+                                  now + absl::Milliseconds(10),
+                                  absl::Milliseconds(20), now),
+            absl::ZeroDuration());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
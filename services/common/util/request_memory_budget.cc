@@ -0,0 +1,70 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_memory_budget.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::atomic<int64_t> rejected_count{0};
+std::atomic<int64_t> trimmed_count{0};
+
+}  // namespace
+
+bool RequestMemoryBudget::TryCharge(int64_t bytes) {
+  if (!enabled()) {
+    used_.fetch_add(bytes, std::memory_order_relaxed);
+    return true;
+  }
+  int64_t used = used_.load(std::memory_order_relaxed);
+  do {
+    if (used + bytes > budget_bytes_) {
+      return false;
+    }
+  } while (!used_.compare_exchange_weak(used, used + bytes,
+                                        std::memory_order_relaxed));
+  return true;
+}
+
+bool RequestMemoryBudget::Charge(int64_t bytes) {
+  const int64_t used =
+      used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  return !enabled() || used <= budget_bytes_;
+}
+
+int64_t RequestMemoryBudget::remaining() const {
+  if (!enabled()) {
+    return INT64_MAX;
+  }
+  return std::max<int64_t>(0, budget_bytes_ - used());
+}
+
+void RecordMemoryBudgetExceeded(MemoryBudgetAction action) {
+  (action == MemoryBudgetAction::kRejected ? rejected_count : trimmed_count)
+      .fetch_add(1, std::memory_order_relaxed);
+}
+
+absl::flat_hash_map<std::string, double> GetRequestMemoryBudgetStats() {
+  return {
+      {"rejected", rejected_count.exchange(0)},
+      {"trimmed", trimmed_count.exchange(0)},
+  };
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
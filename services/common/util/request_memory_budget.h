@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_MEMORY_BUDGET_H_
+#define SERVICES_COMMON_UTIL_REQUEST_MEMORY_BUDGET_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kRequestMemoryBudgetExceeded[] =
+    "Request exceeds the memory budget of the server.";
+
+// What was done with a request over its memory budget.
+enum class MemoryBudgetAction {
+  // The request failed.
+  kRejected,
+  // Some of its work, e.g. interest groups, ads or bids, was left out.
+  kTrimmed,
+};
+
+// Bytes a request holds in memory, i.e. its decoded payload, the signals
+// fetched for it and the arguments of its dispatches, against the budget of
+// the server for a single request, so that one abusive or unusually large
+// request is trimmed or rejected rather than costing as much memory as
+// hundreds of others. The bytes are those of the data, not of its in-memory
+// representation. Thread safe, once the budget is set.
+class RequestMemoryBudget {
+ public:
+  // Sets the budget. Must be called before any bytes are charged. No budget
+  // when not positive.
+  void SetBudget(int64_t budget_bytes) { budget_bytes_ = budget_bytes; }
+
+  bool enabled() const { return budget_bytes_ > 0; }
+
+  // Charges bytes about to be held if they fit in the budget, and returns
+  // whether they did. Nothing is charged otherwise.
+  bool TryCharge(int64_t bytes);
+
+  // Charges bytes already held, and returns whether the budget holds them.
+  bool Charge(int64_t bytes);
+
+  int64_t used() const { return used_.load(std::memory_order_relaxed); }
+
+  // INT64_MAX without a budget.
+  int64_t remaining() const;
+
+ private:
+  int64_t budget_bytes_ = 0;
+  std::atomic<int64_t> used_ = 0;
+};
+
+// Counts a request over its memory budget.
+void RecordMemoryBudgetExceeded(MemoryBudgetAction action);
+
+// Returns the requests "rejected" and "trimmed" since the previous call.
+absl::flat_hash_map<std::string, double> GetRequestMemoryBudgetStats();
+
+template <typename T>
+inline void AddRequestMemoryBudgetMetric(T* context_map) {
+  context_map->AddObserverable(metric::kRequestMemoryBudgetState,
+                               GetRequestMemoryBudgetStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_MEMORY_BUDGET_H_
@@ -0,0 +1,52 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/request_memory_budget.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(RequestMemoryBudgetTest, ChargesOnlyWhatFits) {
+  RequestMemoryBudget budget;
+  budget.SetBudget(100);
+  EXPECT_TRUE(budget.Charge(60));
+  EXPECT_FALSE(budget.TryCharge(50));
+  EXPECT_EQ(budget.used(), 60);
+  EXPECT_TRUE(budget.TryCharge(40));
+  EXPECT_EQ(budget.remaining(), 0);
+  EXPECT_FALSE(budget.Charge(1));
+}
+
+TEST(RequestMemoryBudgetTest, ChargesEverythingWithoutABudget) {
+  RequestMemoryBudget budget;
+  EXPECT_TRUE(budget.Charge(1 << 30));
+  EXPECT_TRUE(budget.TryCharge(1 << 30));
+  EXPECT_EQ(budget.remaining(), INT64_MAX);
+}
+
+TEST(RequestMemoryBudgetTest, CountsTheRequestsOverTheirBudget) {
+  GetRequestMemoryBudgetStats();
+  RecordMemoryBudgetExceeded(MemoryBudgetAction::kRejected);
+  RecordMemoryBudgetExceeded(MemoryBudgetAction::kTrimmed);
+  RecordMemoryBudgetExceeded(MemoryBudgetAction::kTrimmed);
+  auto stats = GetRequestMemoryBudgetStats();
+  EXPECT_EQ(stats["rejected"], 1);
+  EXPECT_EQ(stats["trimmed"], 2);
+  EXPECT_EQ(GetRequestMemoryBudgetStats()["trimmed"], 0);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_summary.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr absl::string_view kTruncated = "...";
+
+// Appends the first kMaxSummarizedIds ids of `items`, taken by `id`.
+template <typename Items, typename Id>
+void AppendIds(std::string& summary, const Items& items, Id id) {
+  summary.append(" [");
+  const int count = std::min<int>(items.size(), kMaxSummarizedIds);
+  for (int i = 0; i < count; i++) {
+    absl::StrAppend(&summary, i == 0 ? "" : ", ", id(items[i]));
+  }
+  if (items.size() > count) {
+    absl::StrAppend(&summary, ", ", kTruncated);
+  }
+  summary.append("]");
+}
+
+std::string Truncate(std::string summary,
+                     size_t max_bytes = kMaxRequestSummaryBytes) {
+  if (summary.size() > max_bytes) {
+    summary.resize(max_bytes - kTruncated.size());
+    absl::StrAppend(&summary, kTruncated);
+  }
+  return summary;
+}
+
+}  // namespace
+
+std::string SummarizeRequest(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request) {
+  std::string summary = absl::StrCat(
+      "ScoreAdsRawRequest{bytes: ", raw_request.ByteSizeLong(),
+      ", generation_id: ", raw_request.log_context().generation_id(),
+      ", ad_bids: ", raw_request.ad_bids_size());
+  AppendIds(summary, raw_request.ad_bids(),
+            [](const auto& ad_bid) { return ad_bid.render(); });
+  absl::StrAppend(
+      &summary,
+      ", protected_app_signals_ad_bids: ",
+      raw_request.protected_app_signals_ad_bids_size(),
+      ", scoring_signals bytes: ", raw_request.scoring_signals().size(),
+      ", seller_signals bytes: ", raw_request.seller_signals().size(),
+      ", auction_signals bytes: ", raw_request.auction_signals().size(),
+      ", per_buyer_signals: ", raw_request.per_buyer_signals_size(), "}");
+  return Truncate(std::move(summary));
+}
+
+std::string SummarizeRequest(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request) {
+  std::string summary = absl::StrCat(
+      "GenerateBidsRawRequest{bytes: ", raw_request.ByteSizeLong(),
+      ", generation_id: ", raw_request.log_context().generation_id(),
+      ", interest_group_for_bidding: ",
+      raw_request.interest_group_for_bidding_size());
+  AppendIds(summary, raw_request.interest_group_for_bidding(),
+            [](const auto& interest_group) { return interest_group.name(); });
+  absl::StrAppend(
+      &summary, ", bidding_signals bytes: ",
+      raw_request.bidding_signals().size(),
+      ", buyer_signals bytes: ", raw_request.buyer_signals().size(),
+      ", auction_signals bytes: ", raw_request.auction_signals().size(), "}");
+  return Truncate(std::move(summary));
+}
+
+bool AllowRequestErrorLog(absl::Time now) {
+  // Fixed windows of a second. A race at the start of a window may let a few
+  // more logs through, which is fine for logs.
+  static std::atomic<int64_t> window_second{0};
+  static std::atomic<int> window_count{0};
+  const int64_t second = absl::ToUnixSeconds(now);
+  int64_t current = window_second.load(std::memory_order_relaxed);
+  if (current != second && window_second.compare_exchange_strong(
+                               current, second, std::memory_order_relaxed)) {
+    window_count.store(0, std::memory_order_relaxed);
+  }
+  return window_count.fetch_add(1, std::memory_order_relaxed) <
+         kMaxRequestErrorLogsPerSecond;
+}
+
+bool IsConsentedWithToken(const ConsentedDebugConfiguration& config,
+                          absl::string_view server_debug_token) {
+  return config.is_consented() && !server_debug_token.empty() &&
+         config.token() == server_debug_token;
+}
+
+std::string DumpRequest(const google::protobuf::Message& raw_request) {
+  return Truncate(raw_request.DebugString(), kMaxRequestDumpBytes);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_SUMMARY_H_
+#define SERVICES_COMMON_UTIL_REQUEST_SUMMARY_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Ids of the ads or interest groups listed by a request summary.
+inline constexpr int kMaxSummarizedIds = 5;
+// Longest request summary, past which it is truncated.
+inline constexpr int kMaxRequestSummaryBytes = 1024;
+// Longest dump of a consented request, past which it is truncated.
+inline constexpr int kMaxRequestDumpBytes = 64 << 10;
+// Most requests described per second by the error logs of the process.
+inline constexpr int kMaxRequestErrorLogsPerSecond = 10;
+
+// Returns the size of the request, the number of its ads or interest groups
+// with the first kMaxSummarizedIds of them, and the sizes of its signals,
+// within kMaxRequestSummaryBytes.
+std::string SummarizeRequest(
+    const ScoreAdsRequest::ScoreAdsRawRequest& raw_request);
+std::string SummarizeRequest(
+    const GenerateBidsRequest::GenerateBidsRawRequest& raw_request);
+
+// Whether a request can be described by an error log at `now`, within
+// kMaxRequestErrorLogsPerSecond across the process.
+bool AllowRequestErrorLog(absl::Time now = absl::Now());
+
+// Whether the client consented to debugging with the debug token of the
+// server, as the consented debugging logger checks it. A request claiming
+// consent without the token is not consented.
+bool IsConsentedWithToken(const ConsentedDebugConfiguration& config,
+                          absl::string_view server_debug_token);
+
+// Returns the request, truncated to kMaxRequestDumpBytes.
+std::string DumpRequest(const google::protobuf::Message& raw_request);
+
+// Returns the description of `raw_request` for the log of an error: the
+// request, within kMaxRequestDumpBytes, if consented for debugging with the
+// server_debug_token, or else its summary. Descriptions past
+// kMaxRequestErrorLogsPerSecond are left out, so that a burst of failures, as
+// in an overload, does not format every request failing. Meant to be wrapped
+// in a LazyFormat, so that it only runs if logged.
+template <typename RawRequest>
+std::string DescribeRequestForErrorLog(const RawRequest& raw_request,
+                                       absl::string_view server_debug_token) {
+  if (!AllowRequestErrorLog()) {
+    return "<request description rate limited>";
+  }
+  if (IsConsentedWithToken(raw_request.consented_debug_config(),
+                           server_debug_token)) {
+    return DumpRequest(raw_request);
+  }
+  return SummarizeRequest(raw_request);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_SUMMARY_H_
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/request_summary.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::EndsWith;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+ScoreAdsRequest::ScoreAdsRawRequest MakeScoreAdsRawRequest(int num_ads) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.mutable_log_context()->set_generation_id("generation");
+  raw_request.set_scoring_signals(std::string(1000, 'a'));
+  for (int i = 0; i < num_ads; i++) {
+    raw_request.add_ad_bids()->set_render(absl::StrCat("render", i));
+  }
+  return raw_request;
+}
+
+TEST(SummarizeRequestTest, ListsFirstIdsAndSizes) {
+  const std::string summary = SummarizeRequest(MakeScoreAdsRawRequest(8));
+  EXPECT_THAT(summary, HasSubstr("generation_id: generation"));
+  EXPECT_THAT(summary, HasSubstr("ad_bids: 8 [render0, render1, render2, "
+                                 "render3, render4, ...]"));
+  EXPECT_THAT(summary, HasSubstr("scoring_signals bytes: 1000"));
+  EXPECT_THAT(summary, Not(HasSubstr("aaaa")));
+}
+
+TEST(SummarizeRequestTest, ListsInterestGroupsOfGenerateBidsRequest) {
+  GenerateBidsRequest::GenerateBidsRawRequest raw_request;
+  raw_request.add_interest_group_for_bidding()->set_name("ig0");
+  raw_request.add_interest_group_for_bidding()->set_name("ig1");
+  EXPECT_THAT(SummarizeRequest(raw_request),
+              HasSubstr("interest_group_for_bidding: 2 [ig0, ig1]"));
+}
+
+TEST(SummarizeRequestTest, CapsSummarySize) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.add_ad_bids()->set_render(std::string(5000, 'r'));
+  const std::string summary = SummarizeRequest(raw_request);
+  EXPECT_EQ(summary.size(), kMaxRequestSummaryBytes);
+  EXPECT_THAT(summary, EndsWith("..."));
+}
+
+TEST(AllowRequestErrorLogTest, LimitsLogsPerSecond) {
+  const absl::Time now = absl::FromUnixSeconds(1000);
+  int allowed = 0;
+  for (int i = 0; i < 2 * kMaxRequestErrorLogsPerSecond; i++) {
+    allowed += AllowRequestErrorLog(now);
+  }
+  EXPECT_EQ(allowed, kMaxRequestErrorLogsPerSecond);
+  EXPECT_TRUE(AllowRequestErrorLog(now + absl::Seconds(1)));
+}
+
+TEST(DescribeRequestForErrorLogTest, DumpsConsentedRequest) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request = MakeScoreAdsRawRequest(8);
+  raw_request.mutable_consented_debug_config()->set_is_consented(true);
+  raw_request.mutable_consented_debug_config()->set_token("token");
+  EXPECT_THAT(DescribeRequestForErrorLog(raw_request, "token"),
+              HasSubstr("aaaa"));
+}
+
+TEST(DescribeRequestForErrorLogTest, SummarizesRequestWithoutServerToken) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request = MakeScoreAdsRawRequest(8);
+  raw_request.mutable_consented_debug_config()->set_is_consented(true);
+  raw_request.mutable_consented_debug_config()->set_token("token");
+  EXPECT_THAT(DescribeRequestForErrorLog(raw_request, "other"),
+              Not(HasSubstr("aaaa")));
+  EXPECT_THAT(DescribeRequestForErrorLog(raw_request, ""),
+              Not(HasSubstr("aaaa")));
+}
+
+TEST(DumpRequestTest, CapsDumpSize) {
+  ScoreAdsRequest::ScoreAdsRawRequest raw_request;
+  raw_request.set_scoring_signals(std::string(2 * kMaxRequestDumpBytes, 'a'));
+  const std::string dump = DumpRequest(raw_request);
+  EXPECT_EQ(dump.size(), kMaxRequestDumpBytes);
+  EXPECT_THAT(dump, EndsWith("..."));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,152 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/request_timeline.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+int64_t ToMilliseconds(absl::Duration duration) {
+  return absl::ToInt64Milliseconds(duration);
+}
+
+SlowRequestTracker& ProcessSlowRequestTracker() {
+  static SlowRequestTracker* tracker = new SlowRequestTracker();
+  return *tracker;
+}
+
+}  // namespace
+
+absl::string_view RequestStageName(RequestStage stage) {
+  switch (stage) {
+    case RequestStage::kDecrypt:
+      return "decrypt";
+    case RequestStage::kKeyValue:
+      return "key_value";
+    case RequestStage::kFanOut:
+      return "fan_out";
+    case RequestStage::kDispatch:
+      return "dispatch";
+    case RequestStage::kParse:
+      return "parse";
+    case RequestStage::kEncrypt:
+      return "encrypt";
+  }
+  return "";
+}
+
+void RequestTimeline::Record(RequestStage stage, absl::Time start,
+                             absl::Time end) {
+  absl::MutexLock lock(&mu_);
+  if (num_spans_ == kMaxSpans) {
+    return;
+  }
+  spans_[num_spans_++] = {
+      .stage = stage, .start = start - start_, .duration = end - start};
+}
+
+std::vector<RequestTimeline::Span> RequestTimeline::Spans() const {
+  absl::MutexLock lock(&mu_);
+  return std::vector<Span>(spans_.begin(), spans_.begin() + num_spans_);
+}
+
+std::string SlowRequestExemplar::ToString() const {
+  std::string description = absl::StrCat(
+      "latency ", ToMilliseconds(latency), "ms, request ", sizes.request_bytes,
+      " bytes, response ", sizes.response_bytes, " bytes, ", sizes.num_items,
+      " items:");
+  for (const RequestTimeline::Span& span : spans) {
+    absl::StrAppend(&description, " ", RequestStageName(span.stage), " +",
+                    ToMilliseconds(span.start), "ms ",
+                    ToMilliseconds(span.duration), "ms");
+  }
+  return description;
+}
+
+bool SlowRequestTracker::Report(const RequestTimeline& timeline,
+                                const RequestSizes& sizes, absl::Time now) {
+  const absl::Duration latency = now - timeline.start();
+  latencies_.Record(latency);
+  if (num_reported_.fetch_add(1, std::memory_order_relaxed) %
+          kThresholdUpdatePeriod ==
+      0) {
+    if (std::optional<absl::Duration> threshold =
+            latencies_.Percentile(kPercentile);
+        threshold.has_value()) {
+      threshold_us_.store(absl::ToInt64Microseconds(*threshold),
+                          std::memory_order_relaxed);
+    }
+  }
+  if (absl::ToInt64Microseconds(latency) <
+      threshold_us_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  SlowRequestExemplar exemplar = {
+      .latency = latency, .sizes = sizes, .spans = timeline.Spans()};
+  absl::MutexLock lock(&mu_);
+  if (now - last_log_ >= absl::Seconds(1)) {
+    last_log_ = now;
+    LOG(INFO) << "Slow request, past the p" << kPercentile
+              << " latency: " << exemplar.ToString();
+  }
+  if (!slowest_.has_value() || slowest_->latency < latency) {
+    slowest_ = exemplar;
+  }
+  if (exemplars_.size() == kMaxExemplars) {
+    exemplars_.pop_front();
+  }
+  exemplars_.push_back(std::move(exemplar));
+  return true;
+}
+
+std::vector<SlowRequestExemplar> SlowRequestTracker::Exemplars() const {
+  absl::MutexLock lock(&mu_);
+  return std::vector<SlowRequestExemplar>(exemplars_.begin(),
+                                          exemplars_.end());
+}
+
+absl::flat_hash_map<std::string, double>
+SlowRequestTracker::TakeSlowestStages() {
+  std::optional<SlowRequestExemplar> slowest;
+  {
+    absl::MutexLock lock(&mu_);
+    slowest = std::exchange(slowest_, std::nullopt);
+  }
+  absl::flat_hash_map<std::string, double> stages;
+  if (!slowest.has_value()) {
+    return stages;
+  }
+  stages["total"] = absl::ToDoubleMilliseconds(slowest->latency);
+  for (const RequestTimeline::Span& span : slowest->spans) {
+    stages[RequestStageName(span.stage)] +=
+        absl::ToDoubleMilliseconds(span.duration);
+  }
+  return stages;
+}
+
+void ReportRequestTimeline(const RequestTimeline& timeline,
+                           const RequestSizes& sizes) {
+  ProcessSlowRequestTracker().Report(timeline, sizes);
+}
+
+absl::flat_hash_map<std::string, double> GetSlowRequestStats() {
+  return ProcessSlowRequestTracker().TakeSlowestStages();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,164 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_REQUEST_TIMELINE_H_
+#define SERVICES_COMMON_UTIL_REQUEST_TIMELINE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/latency_histogram.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Stages of the timeline of a request.
+enum class RequestStage {
+  kDecrypt,
+  // Fetching signals from the Key-Value server.
+  kKeyValue,
+  // Calls to the other servers, e.g. GetBids, GenerateBids or ScoreAds.
+  kFanOut,
+  // The JS executions of the request in Roma.
+  kDispatch,
+  // Handling the responses of the other servers or of the dispatch.
+  kParse,
+  kEncrypt,
+};
+
+absl::string_view RequestStageName(RequestStage stage);
+
+// Sizes of a request and its response, without any of their data.
+struct RequestSizes {
+  size_t request_bytes = 0;
+  size_t response_bytes = 0;
+  // Interest groups, ads or buyers of the request.
+  int num_items = 0;
+};
+
+// Wall time spans of the stages of a request, recorded by its reactor as
+// each ends, whether the request is traced or not. Kept in a fixed array of
+// the reactor, so that recording a span costs no allocation. Thread safe.
+class RequestTimeline final {
+ public:
+  // Spans past this many, as of a request calling many buyers, are dropped.
+  static constexpr int kMaxSpans = 16;
+
+  struct Span {
+    RequestStage stage;
+    // From the start of the request.
+    absl::Duration start;
+    absl::Duration duration;
+  };
+
+  explicit RequestTimeline(absl::Time start = absl::Now()) : start_(start) {}
+
+  // Not copyable or movable.
+  RequestTimeline(const RequestTimeline&) = delete;
+  RequestTimeline& operator=(const RequestTimeline&) = delete;
+
+  absl::Time start() const { return start_; }
+
+  void Record(RequestStage stage, absl::Time start, absl::Time end)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the spans recorded, in the order they ended.
+  std::vector<Span> Spans() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const absl::Time start_;
+  mutable absl::Mutex mu_;
+  std::array<Span, kMaxSpans> spans_ ABSL_GUARDED_BY(mu_);
+  int num_spans_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+// Timeline of a request slower than the threshold of a SlowRequestTracker.
+struct SlowRequestExemplar {
+  absl::Duration latency;
+  RequestSizes sizes;
+  std::vector<RequestTimeline::Span> spans;
+
+  // Returns e.g. "latency 850ms, request 2048 bytes, ...: decrypt +0ms 1ms,
+  // fan_out +1ms 820ms, ...".
+  std::string ToString() const;
+};
+
+// Keeps the timelines of the requests slower than the p99.9 of the recent
+// latencies, which head-based sampling rarely traces, so that the stage
+// making each slow is known. The threshold follows the latencies reported.
+// Thread safe.
+class SlowRequestTracker {
+ public:
+  static constexpr double kPercentile = 99.9;
+  // Most recent exemplars kept.
+  static constexpr int kMaxExemplars = 16;
+  // Requests reported between two updates of the threshold.
+  static constexpr int64_t kThresholdUpdatePeriod = 128;
+
+  // Records the latency of a request done, and keeps its timeline if the
+  // latency is past the threshold. Logs the timeline at most once a second.
+  // Returns whether it was kept.
+  bool Report(const RequestTimeline& timeline, const RequestSizes& sizes,
+              absl::Time now = absl::Now()) ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the exemplars kept, oldest first.
+  std::vector<SlowRequestExemplar> Exemplars() const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the milliseconds of each stage of the slowest request kept since
+  // the previous call, and its "total" latency.
+  absl::flat_hash_map<std::string, double> TakeSlowestStages()
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  LatencyHistogram latencies_;
+  std::atomic<int64_t> num_reported_ = 0;
+  // Infinite until enough latencies were recorded.
+  std::atomic<int64_t> threshold_us_ = INT64_MAX;
+  mutable absl::Mutex mu_;
+  std::deque<SlowRequestExemplar> exemplars_ ABSL_GUARDED_BY(mu_);
+  std::optional<SlowRequestExemplar> slowest_ ABSL_GUARDED_BY(mu_);
+  absl::Time last_log_ ABSL_GUARDED_BY(mu_) = absl::InfinitePast();
+};
+
+// Reports the timeline of a request done to the tracker of the process.
+void ReportRequestTimeline(const RequestTimeline& timeline,
+                           const RequestSizes& sizes);
+
+// Returns the stages of the slowest request of the process since the
+// previous call, see SlowRequestTracker::TakeSlowestStages.
+absl::flat_hash_map<std::string, double> GetSlowRequestStats();
+
+template <typename T>
+inline void AddSlowRequestMetric(T* context_map) {
+  context_map->AddObserverable(metric::kSlowRequestStages,
+                               GetSlowRequestStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_REQUEST_TIMELINE_H_
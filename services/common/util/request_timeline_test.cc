@@ -0,0 +1,80 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/request_timeline.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+const absl::Time kStart = absl::FromUnixSeconds(1000);
+
+TEST(RequestTimelineTest, RecordsSpansFromTheStartOfTheRequest) {
+  RequestTimeline timeline(kStart);
+  timeline.Record(RequestStage::kDecrypt, kStart,
+                  kStart + absl::Milliseconds(2));
+  timeline.Record(RequestStage::kFanOut, kStart + absl::Milliseconds(2),
+                  kStart + absl::Milliseconds(50));
+
+  std::vector<RequestTimeline::Span> spans = timeline.Spans();
+  ASSERT_EQ(spans.size(), 2);
+  EXPECT_EQ(spans[1].stage, RequestStage::kFanOut);
+  EXPECT_EQ(spans[1].start, absl::Milliseconds(2));
+  EXPECT_EQ(spans[1].duration, absl::Milliseconds(48));
+}
+
+TEST(RequestTimelineTest, DropsSpansPastTheMax) {
+  RequestTimeline timeline(kStart);
+  for (int i = 0; i < RequestTimeline::kMaxSpans + 3; ++i) {
+    timeline.Record(RequestStage::kFanOut, kStart, kStart);
+  }
+  EXPECT_EQ(timeline.Spans().size(), RequestTimeline::kMaxSpans);
+}
+
+TEST(SlowRequestTrackerTest, KeepsOnlyTheRequestsPastTheThreshold) {
+  SlowRequestTracker tracker;
+  RequestTimeline timeline(kStart);
+  timeline.Record(RequestStage::kKeyValue, kStart,
+                  kStart + absl::Milliseconds(1));
+  // Nothing is slow until the threshold is known.
+  for (int i = 0; i <= SlowRequestTracker::kThresholdUpdatePeriod; ++i) {
+    EXPECT_FALSE(
+        tracker.Report(timeline, {}, kStart + absl::Milliseconds(1)));
+  }
+
+  RequestTimeline slow(kStart);
+  slow.Record(RequestStage::kKeyValue, kStart,
+              kStart + absl::Milliseconds(1));
+  slow.Record(RequestStage::kDispatch, kStart + absl::Milliseconds(1),
+              kStart + absl::Milliseconds(300));
+  EXPECT_TRUE(tracker.Report(slow, {.request_bytes = 10, .num_items = 2},
+                             kStart + absl::Milliseconds(301)));
+  EXPECT_FALSE(tracker.Report(timeline, {}, kStart + absl::Milliseconds(1)));
+
+  std::vector<SlowRequestExemplar> exemplars = tracker.Exemplars();
+  ASSERT_EQ(exemplars.size(), 1);
+  EXPECT_EQ(exemplars[0].latency, absl::Milliseconds(301));
+  EXPECT_EQ(exemplars[0].ToString(),
+            "latency 301ms, request 10 bytes, response 0 bytes, 2 items: "
+            "key_value +0ms 1ms dispatch +1ms 299ms");
+
+  auto stages = tracker.TakeSlowestStages();
+  EXPECT_DOUBLE_EQ(stages["total"], 301);
+  EXPECT_DOUBLE_EQ(stages["dispatch"], 299);
+  EXPECT_TRUE(tracker.TakeSlowestStages().empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/server_readiness.h"
+
+#include <utility>
+
+#include "absl/time/clock.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+ServerReadiness::ServerReadiness(
+    grpc::HealthCheckServiceInterface* health_check_service,
+    absl::AnyInvocable<bool()> is_ready, absl::Duration poll_interval)
+    : health_check_service_(health_check_service),
+      is_ready_(std::move(is_ready)) {
+  if (health_check_service_ != nullptr) {
+    health_check_service_->SetServingStatus(false);
+  }
+  poller_ = std::thread([this, poll_interval]() { Poll(poll_interval); });
+}
+
+ServerReadiness::~ServerReadiness() {
+  stop_.Notify();
+  poller_.join();
+}
+
+void ServerReadiness::Poll(absl::Duration poll_interval) {
+  const absl::Time start = absl::Now();
+  do {
+    if (is_ready_()) {
+      if (health_check_service_ != nullptr) {
+        health_check_service_->SetServingStatus(true);
+      }
+      serving_ = true;
+      VLOG(1) << "Server ready to serve after " << absl::Now() - start;
+      return;
+    }
+  } while (!stop_.WaitForNotificationWithTimeout(poll_interval));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_SERVER_READINESS_H_
+#define SERVICES_COMMON_UTIL_SERVER_READINESS_H_
+
+#include <atomic>
+#include <thread>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/notification.h"
+#include "absl/time/time.h"
+#include "grpcpp/health_check_service_interface.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Gates the health service of a server on its readiness, so that a server
+// can start listening while it is still loading and warming up its code,
+// the load balancer only routing requests to it once it can serve them.
+//
+// Reports NOT_SERVING for all the services of `health_check_service` until
+// `is_ready` returns true, polling it every `poll_interval` on a thread of
+// its own, and then reports SERVING. Stops polling when destroyed.
+class ServerReadiness final {
+ public:
+  ServerReadiness(grpc::HealthCheckServiceInterface* health_check_service,
+                  absl::AnyInvocable<bool()> is_ready,
+                  absl::Duration poll_interval = absl::Milliseconds(100));
+  ~ServerReadiness();
+
+  // Not copyable or movable.
+  ServerReadiness(const ServerReadiness&) = delete;
+  ServerReadiness& operator=(const ServerReadiness&) = delete;
+
+  // Returns whether SERVING was reported.
+  bool IsServing() const { return serving_; }
+
+ private:
+  void Poll(absl::Duration poll_interval);
+
+  grpc::HealthCheckServiceInterface* const health_check_service_;
+  absl::AnyInvocable<bool()> is_ready_;
+  std::atomic<bool> serving_ = false;
+  absl::Notification stop_;
+  std::thread poller_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_SERVER_READINESS_H_
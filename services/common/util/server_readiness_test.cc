@@ -0,0 +1,92 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/server_readiness.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/clock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+class FakeHealthCheckService : public grpc::HealthCheckServiceInterface {
+ public:
+  void SetServingStatus(const std::string& service_name,
+                        bool serving) override {}
+
+  void SetServingStatus(bool serving) override {
+    absl::MutexLock lock(&mu_);
+    statuses_.push_back(serving);
+  }
+
+  std::vector<bool> statuses() {
+    absl::MutexLock lock(&mu_);
+    return statuses_;
+  }
+
+ private:
+  absl::Mutex mu_;
+  std::vector<bool> statuses_ ABSL_GUARDED_BY(mu_);
+};
+
+TEST(ServerReadinessTest, ReportsNotServingUntilReady) {
+  FakeHealthCheckService health_check_service;
+  std::atomic<bool> ready = false;
+  ServerReadiness readiness(
+      &health_check_service, [&ready]() { return ready.load(); },
+      absl::Milliseconds(1));
+  absl::SleepFor(absl::Milliseconds(20));
+  EXPECT_FALSE(readiness.IsServing());
+  EXPECT_EQ(health_check_service.statuses(), std::vector<bool>{false});
+
+  ready = true;
+  while (!readiness.IsServing()) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+  EXPECT_EQ(health_check_service.statuses(), (std::vector<bool>{false, true}));
+}
+
+TEST(ServerReadinessTest, StopsPollingWhenDestroyed) {
+  FakeHealthCheckService health_check_service;
+  std::atomic<int> polls = 0;
+  {
+    ServerReadiness readiness(
+        &health_check_service,
+        [&polls]() {
+          ++polls;
+          return false;
+        },
+        absl::Milliseconds(1));
+  }
+  const int polls_when_destroyed = polls;
+  absl::SleepFor(absl::Milliseconds(10));
+  EXPECT_EQ(polls, polls_when_destroyed);
+  EXPECT_EQ(health_check_service.statuses(), std::vector<bool>{false});
+}
+
+TEST(ServerReadinessTest, PollsWithoutHealthCheckService) {
+  ServerReadiness readiness(
+      nullptr, []() { return true; }, absl::Milliseconds(1));
+  while (!readiness.IsServing()) {
+    absl::SleepFor(absl::Milliseconds(1));
+  }
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
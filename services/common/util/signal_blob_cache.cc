@@ -0,0 +1,65 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/signal_blob_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/hash/hash.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Counts of all the caches, read and reset by GetSignalBlobCacheStats.
+CacheStats cache_stats;
+
+}  // namespace
+
+SignalBlobCache::SignalBlobCache(size_t capacity)
+    : cache_({.max_entries = capacity, .stats = &cache_stats}) {}
+
+std::shared_ptr<std::string> SignalBlobCache::GetOrAssemble(
+    absl::Span<const absl::string_view> signals,
+    absl::FunctionRef<std::string()> assemble) {
+  size_t hash = absl::HashOf(signals.size());
+  for (absl::string_view signal : signals) {
+    hash = absl::HashOf(hash, signal);
+  }
+  if (std::shared_ptr<const Entry> cached = cache_.LookUp(hash);
+      cached != nullptr &&
+      std::equal(cached->signals.begin(), cached->signals.end(),
+                 signals.begin(), signals.end())) {
+    return cached->blob;
+  }
+  // A colliding entry is replaced, so that the latest signals are cached.
+  auto entry = std::make_shared<Entry>();
+  entry->signals.reserve(signals.size());
+  for (absl::string_view signal : signals) {
+    entry->signals.emplace_back(signal);
+  }
+  entry->blob = std::make_shared<std::string>(assemble());
+  std::shared_ptr<std::string> blob = entry->blob;
+  cache_.Insert(hash, std::move(entry));
+  return blob;
+}
+
+absl::flat_hash_map<std::string, double> GetSignalBlobCacheStats() {
+  absl::flat_hash_map<std::string, double> stats = cache_stats.Snapshot();
+  // Signal blobs are never cached as missing.
+  stats.erase("negative_hit");
+  return stats;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
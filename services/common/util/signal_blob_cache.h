@@ -0,0 +1,80 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_SIGNAL_BLOB_CACHE_H_
+#define SERVICES_COMMON_UTIL_SIGNAL_BLOB_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "services/common/concurrent/ttl_lru_cache.h"
+#include "services/common/metric/server_definition.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Process wide, thread-safe cache of the Roma argument blobs assembled from
+// request signals, such as the auction config passed to scoreAd. Signals are
+// often byte-identical across the requests of a seller or buyer, in which
+// case their requests share one blob instead of each allocating and copying
+// its own.
+// Blobs are keyed by a hash of the signals they are assembled from, which are
+// kept to tell apart the signals of colliding hashes. All the blobs of a cache
+// must be assembled the same way from their signals.
+class SignalBlobCache {
+ public:
+  // capacity: maximum number of blobs held, least recently used evicted first.
+  explicit SignalBlobCache(size_t capacity);
+
+  // Returns the blob assembled from the signals, calling assemble only if no
+  // blob of the same signals is cached. The blob is shared with the other
+  // requests, and must not be modified; it is not const as Roma takes its
+  // inputs as std::shared_ptr<std::string>.
+  std::shared_ptr<std::string> GetOrAssemble(
+      absl::Span<const absl::string_view> signals,
+      absl::FunctionRef<std::string()> assemble);
+
+  // Number of blobs currently cached.
+  size_t size() const { return cache_.size(); }
+
+  // See TtlLruCache::SetCapacityScale.
+  void SetCapacityScale(double scale) { cache_.SetCapacityScale(scale); }
+
+ private:
+  struct Entry {
+    std::vector<std::string> signals;
+    std::shared_ptr<std::string> blob;
+  };
+
+  TtlLruCache<size_t, const Entry> cache_;
+};
+
+// Returns the number of hits, misses and evictions of all the SignalBlobCache
+// instances since the previous call.
+absl::flat_hash_map<std::string, double> GetSignalBlobCacheStats();
+
+template <typename T>
+inline void AddSignalBlobCacheMetric(T* context_map) {
+  context_map->AddObserverable(metric::kSignalBlobCacheEventCount,
+                               GetSignalBlobCacheStats);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_SIGNAL_BLOB_CACHE_H_
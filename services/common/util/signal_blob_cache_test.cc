@@ -0,0 +1,104 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/signal_blob_cache.h"
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(SignalBlobCacheTest, SharesTheBlobOfIdenticalSignals) {
+  SignalBlobCache cache(/*capacity=*/4);
+  int assembled = 0;
+  const auto assemble = [&assembled]() {
+    ++assembled;
+    return std::string(R"({"a":1,"b":2})");
+  };
+  const std::string first_signal = R"({"a":1})";
+  std::shared_ptr<std::string> first =
+      cache.GetOrAssemble({first_signal, R"({"b":2})"}, assemble);
+  // Equal signals in other buffers, as they are in other requests.
+  const std::string second_signal = R"({"a":1})";
+  std::shared_ptr<std::string> second =
+      cache.GetOrAssemble({second_signal, R"({"b":2})"}, assemble);
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(*first, R"({"a":1,"b":2})");
+  EXPECT_EQ(assembled, 1);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(SignalBlobCacheTest, AssemblesTheBlobsOfDifferentSignals) {
+  SignalBlobCache cache(/*capacity=*/4);
+  const auto concat = [](absl::string_view a, absl::string_view b) {
+    return [a, b]() { return absl::StrCat(a, b); };
+  };
+  // The signals are not merely concatenated into the key.
+  std::shared_ptr<std::string> first =
+      cache.GetOrAssemble({"ab", "c"}, concat("ab", "c"));
+  std::shared_ptr<std::string> second =
+      cache.GetOrAssemble({"a", "bc"}, concat("a", "bc"));
+  EXPECT_NE(first, second);
+  EXPECT_EQ(*first, "abc");
+  EXPECT_EQ(*second, "abc");
+  EXPECT_EQ(cache.size(), 2);
+}
+
+TEST(SignalBlobCacheTest, EvictsTheLeastRecentlyUsedBlobs) {
+  SignalBlobCache cache(/*capacity=*/1);
+  int assembled = 0;
+  const auto assemble = [&assembled]() {
+    ++assembled;
+    return std::string("blob");
+  };
+  cache.GetOrAssemble({"a"}, assemble);
+  cache.GetOrAssemble({"b"}, assemble);
+  cache.GetOrAssemble({"a"}, assemble);
+  EXPECT_EQ(assembled, 3);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(SignalBlobCacheTest, ShrinksToTheCapacityScale) {
+  SignalBlobCache cache(/*capacity=*/1);
+  const auto assemble = []() { return std::string("blob"); };
+  cache.GetOrAssemble({"a"}, assemble);
+  cache.SetCapacityScale(0);
+  EXPECT_EQ(cache.size(), 0);
+  cache.GetOrAssemble({"a"}, assemble);
+  EXPECT_EQ(cache.size(), 0);
+  cache.SetCapacityScale(1);
+  cache.GetOrAssemble({"a"}, assemble);
+  EXPECT_EQ(cache.size(), 1);
+}
+
+TEST(SignalBlobCacheTest, CountsHitsMissesAndEvictions) {
+  GetSignalBlobCacheStats();
+  SignalBlobCache cache(/*capacity=*/1);
+  const auto assemble = []() { return std::string("blob"); };
+  cache.GetOrAssemble({"a"}, assemble);
+  cache.GetOrAssemble({"a"}, assemble);
+  cache.GetOrAssemble({"b"}, assemble);
+  EXPECT_THAT(GetSignalBlobCacheStats(),
+              testing::UnorderedElementsAre(testing::Pair("hit", 1),
+                                            testing::Pair("miss", 2),
+                                            testing::Pair("eviction", 1)));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
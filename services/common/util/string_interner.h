@@ -0,0 +1,73 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_STRING_INTERNER_H_
+#define SERVICES_COMMON_UTIL_STRING_INTERNER_H_
+
+#include <deque>
+#include <optional>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Maps the distinct strings of a request, such as interest group owners, to
+// small dense ids, so that the strings repeated across many ads are hashed
+// and copied once, then grouped and compared as ints.
+// Ids start at 0 in the order the strings were first interned. Not thread
+// safe; meant to live for a single request.
+class StringInterner {
+ public:
+  using Id = int;
+
+  // Returns the id of `value`, copying it the first time it is seen.
+  Id Intern(absl::string_view value) {
+    auto it = ids_.find(value);
+    if (it != ids_.end()) {
+      return it->second;
+    }
+    const Id id = strings_.size();
+    // The deque never moves its strings, so the views in ids_ stay valid.
+    ids_.emplace(strings_.emplace_back(value), id);
+    return id;
+  }
+
+  // Returns the id of `value` if it was interned.
+  std::optional<Id> Find(absl::string_view value) const {
+    auto it = ids_.find(value);
+    if (it == ids_.end()) {
+      return std::nullopt;
+    }
+    return it->second;
+  }
+
+  // Returns the string of an id returned by `Intern`. Valid as long as the
+  // interner.
+  absl::string_view Get(Id id) const { return strings_[id]; }
+
+  // Number of distinct strings interned.
+  int size() const { return strings_.size(); }
+
+ private:
+  std::deque<std::string> strings_;
+  absl::flat_hash_map<absl::string_view, Id> ids_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_STRING_INTERNER_H_
@@ -0,0 +1,57 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/string_interner.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(StringInternerTest, ReturnsTheSameIdForEqualStrings) {
+  StringInterner interner;
+  const StringInterner::Id first = interner.Intern("https://first.com");
+  const StringInterner::Id second = interner.Intern("https://second.com");
+  std::string copy = "https://first.com";
+
+  EXPECT_EQ(first, 0);
+  EXPECT_EQ(second, 1);
+  EXPECT_EQ(interner.Intern(copy), first);
+  EXPECT_EQ(interner.size(), 2);
+  EXPECT_EQ(interner.Get(first), "https://first.com");
+  EXPECT_EQ(interner.Get(second), "https://second.com");
+}
+
+TEST(StringInternerTest, KeepsStringsValidAsMoreAreInterned) {
+  StringInterner interner;
+  const absl::string_view first = interner.Get(interner.Intern("first"));
+  for (int i = 0; i < 1000; ++i) {
+    interner.Intern(std::to_string(i));
+  }
+  EXPECT_EQ(first, "first");
+  EXPECT_EQ(interner.Find("first"), 0);
+}
+
+TEST(StringInternerTest, FindsOnlyInternedStrings) {
+  StringInterner interner;
+  interner.Intern("owner");
+  EXPECT_EQ(interner.Find("owner"), 0);
+  EXPECT_EQ(interner.Find("other"), std::nullopt);
+  EXPECT_EQ(interner.size(), 1);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/thread_pool_executor.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+ThreadPoolExecutor::ThreadPoolExecutor(int num_threads,
+                                       server_common::Executor* timer_executor,
+                                       int nice)
+    : timer_executor_(timer_executor) {
+  CHECK_GT(num_threads, 0) << "The thread pool needs a thread";
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, nice]() { Work(nice); });
+  }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+  {
+    absl::MutexLock lock(&mu_);
+    for (auto it = timers_.begin(); it != timers_.end();) {
+      if (timer_executor_->Cancel(it->second)) {
+        timers_.erase(it++);
+      } else {
+        ++it;
+      }
+    }
+    // The timers that could not be cancelled already fired, and queue their
+    // closure.
+    mu_.Await(absl::Condition(
+        +[](absl::flat_hash_map<int64_t, server_common::TaskId>* timers) {
+          return timers->empty();
+        },
+        &timers_));
+    stopping_ = true;
+  }
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ThreadPoolExecutor::Run(absl::AnyInvocable<void()> closure) {
+  absl::MutexLock lock(&mu_);
+  queue_.push_back(std::move(closure));
+}
+
+server_common::TaskId ThreadPoolExecutor::RunAfter(
+    absl::Duration duration, absl::AnyInvocable<void()> closure) {
+  // The timer finds its id under the lock, once its task id is set.
+  absl::MutexLock lock(&mu_);
+  const int64_t timer_id = next_timer_id_++;
+  server_common::TaskId task_id = timer_executor_->RunAfter(
+      duration, [this, timer_id, closure = std::move(closure)]() mutable {
+        absl::MutexLock lock(&mu_);
+        timers_.erase(timer_id);
+        queue_.push_back(std::move(closure));
+      });
+  timers_[timer_id] = task_id;
+  return task_id;
+}
+
+bool ThreadPoolExecutor::Cancel(server_common::TaskId task_id) {
+  if (!timer_executor_->Cancel(task_id)) {
+    return false;
+  }
+  // Few timers are pending at once, such as the retries of the reports.
+  absl::MutexLock lock(&mu_);
+  for (auto it = timers_.begin(); it != timers_.end(); ++it) {
+    if (it->second == task_id) {
+      timers_.erase(it);
+      break;
+    }
+  }
+  return true;
+}
+
+bool ThreadPoolExecutor::HasWork() const {
+  return stopping_ || !queue_.empty();
+}
+
+void ThreadPoolExecutor::Work(int nice) {
+  // On Linux, the nice value is per thread.
+  if (nice != 0 &&
+      setpriority(PRIO_PROCESS, syscall(SYS_gettid), nice) != 0) {
+    LOG(WARNING) << "Unable to set the nice value of a pool thread";
+  }
+  while (true) {
+    absl::AnyInvocable<void()> closure;
+    {
+      absl::MutexLock lock(&mu_);
+      mu_.Await(absl::Condition(this, &ThreadPoolExecutor::HasWork));
+      if (queue_.empty()) {
+        return;
+      }
+      closure = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    closure();
+  }
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_THREAD_POOL_EXECUTOR_H_
+#define SERVICES_COMMON_UTIL_THREAD_POOL_EXECUTOR_H_
+
+#include <cstdint>
+#include <deque>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "src/cpp/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Executor on threads of its own, for background work such as reporting that
+// must not take the threads of the latency critical fetches and RPCs. Its
+// threads may run at a lower priority than the rest of the process.
+// Thread safe.
+class ThreadPoolExecutor final : public server_common::Executor {
+ public:
+  // num_threads: number of threads, positive.
+  // timer_executor: runs the timers of RunAfter, which then run their closure
+  // on the pool. Must outlive the pool.
+  // nice: nice value of the threads, such as 10 for the scheduler to favor
+  // the other threads of the process when the CPUs are busy. The threads
+  // keep the nice value of the process if 0.
+  ThreadPoolExecutor(int num_threads, server_common::Executor* timer_executor,
+                     int nice = 0);
+
+  // Not copyable or movable.
+  ThreadPoolExecutor(const ThreadPoolExecutor&) = delete;
+  ThreadPoolExecutor& operator=(const ThreadPoolExecutor&) = delete;
+
+  // Cancels the closures of RunAfter still pending, runs the closures queued,
+  // and joins the threads.
+  ~ThreadPoolExecutor() override ABSL_LOCKS_EXCLUDED(mu_);
+
+  void Run(absl::AnyInvocable<void()> closure) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  bool Cancel(server_common::TaskId task_id) override ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  // Whether a closure is queued or the pool stops.
+  bool HasWork() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Runs the queued closures until the pool stops.
+  void Work(int nice) ABSL_LOCKS_EXCLUDED(mu_);
+
+  server_common::Executor* const timer_executor_;
+  absl::Mutex mu_;
+  std::deque<absl::AnyInvocable<void()>> queue_ ABSL_GUARDED_BY(mu_);
+  // Timers of RunAfter not fired or cancelled yet, by timer id.
+  absl::flat_hash_map<int64_t, server_common::TaskId> timers_
+      ABSL_GUARDED_BY(mu_);
+  int64_t next_timer_id_ ABSL_GUARDED_BY(mu_) = 0;
+  bool stopping_ ABSL_GUARDED_BY(mu_) = false;
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_THREAD_POOL_EXECUTOR_H_
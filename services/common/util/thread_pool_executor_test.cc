@@ -0,0 +1,136 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/thread_pool_executor.h"
+
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "include/gmock/gmock.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Holds the timers until the test fires them.
+class FakeTimerExecutor : public server_common::Executor {
+ public:
+  void Run(absl::AnyInvocable<void()> closure) override { closure(); }
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override {
+    delays.push_back(duration);
+    closures.push_back(std::move(closure));
+    return {};
+  }
+  bool Cancel(server_common::TaskId task_id) override {
+    ++cancelled;
+    return true;
+  }
+
+  std::vector<absl::Duration> delays;
+  std::vector<absl::AnyInvocable<void()>> closures;
+  int cancelled = 0;
+};
+
+TEST(ThreadPoolExecutorTest, RunsClosuresOnThePoolThreads) {
+  FakeTimerExecutor timer_executor;
+  ThreadPoolExecutor pool(/*num_threads=*/2, &timer_executor);
+  absl::BlockingCounter done(10);
+  absl::Mutex mu;
+  std::vector<std::thread::id> thread_ids;
+  for (int i = 0; i < 10; ++i) {
+    pool.Run([&]() {
+      {
+        absl::MutexLock lock(&mu);
+        thread_ids.push_back(std::this_thread::get_id());
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  EXPECT_THAT(thread_ids,
+              testing::Each(testing::Ne(std::this_thread::get_id())));
+}
+
+TEST(ThreadPoolExecutorTest, RunsDelayedClosuresOnThePoolWhenTheTimerFires) {
+  FakeTimerExecutor timer_executor;
+  ThreadPoolExecutor pool(/*num_threads=*/1, &timer_executor);
+  absl::BlockingCounter done(1);
+  std::thread::id thread_id;
+  pool.RunAfter(absl::Seconds(1), [&]() {
+    thread_id = std::this_thread::get_id();
+    done.DecrementCount();
+  });
+  ASSERT_EQ(timer_executor.closures.size(), 1);
+  EXPECT_EQ(timer_executor.delays[0], absl::Seconds(1));
+
+  timer_executor.closures[0]();
+  done.Wait();
+  EXPECT_NE(thread_id, std::this_thread::get_id());
+  EXPECT_TRUE(pool.Cancel({}));
+  EXPECT_EQ(timer_executor.cancelled, 1);
+}
+
+TEST(ThreadPoolExecutorTest, RunsTheQueuedClosuresBeforeStopping) {
+  FakeTimerExecutor timer_executor;
+  int ran = 0;
+  {
+    ThreadPoolExecutor pool(/*num_threads=*/1, &timer_executor);
+    absl::Notification release;
+    pool.Run([&release]() { release.WaitForNotification(); });
+    for (int i = 0; i < 5; ++i) {
+      pool.Run([&ran]() { ++ran; });
+    }
+    release.Notify();
+  }
+  EXPECT_EQ(ran, 5);
+}
+
+TEST(ThreadPoolExecutorTest, CancelsThePendingDelayedClosuresWhenStopping) {
+  FakeTimerExecutor timer_executor;
+  int ran = 0;
+  {
+    ThreadPoolExecutor pool(/*num_threads=*/1, &timer_executor);
+    pool.RunAfter(absl::Seconds(1), [&ran]() { ++ran; });
+    pool.RunAfter(absl::Seconds(2), [&ran]() { ++ran; });
+  }
+  EXPECT_EQ(timer_executor.cancelled, 2);
+  EXPECT_EQ(ran, 0);
+}
+
+TEST(ThreadPoolExecutorTest, SetsTheNiceValueOfItsThreads) {
+  FakeTimerExecutor timer_executor;
+  ThreadPoolExecutor pool(/*num_threads=*/1, &timer_executor, /*nice=*/19);
+  absl::BlockingCounter done(1);
+  int nice = 0;
+  pool.Run([&]() {
+    nice = getpriority(PRIO_PROCESS, syscall(SYS_gettid));
+    done.DecrementCount();
+  });
+  done.Wait();
+  EXPECT_EQ(nice, 19);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
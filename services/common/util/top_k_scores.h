@@ -0,0 +1,85 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_TOP_K_SCORES_H_
+#define SERVICES_COMMON_UTIL_TOP_K_SCORES_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/log/check.h"
+#include "absl/types/span.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Tracks the K highest distinct scores offered to it in a single pass.
+// Scores are kept in a fixed-size buffer sorted in descending order that is
+// allocated once at construction (inline for small K), so the tracker does no
+// per-score allocation. Each Add() is O(K), i.e. O(n) over n scores for the
+// small K used to pick auction winners and runners-up.
+//
+// Equal scores occupy a single slot, so callers that need every bid tied at
+// one of the top scores can query Contains() afterwards.
+class TopKScores {
+ public:
+  explicit TopKScores(int k) : k_(k) {
+    CHECK_GT(k_, 0) << "TopKScores needs to track at least one score";
+    scores_.reserve(k_);
+  }
+
+  // Offers a score to the tracker. NaN scores are ignored.
+  void Add(float score) {
+    if (std::isnan(score)) {
+      return;
+    }
+    // First position with a score not greater than the offered one.
+    auto it = std::find_if(scores_.begin(), scores_.end(),
+                           [score](float tracked) { return tracked <= score; });
+    if (it != scores_.end() && *it == score) {
+      return;
+    }
+    if (scores_.size() < k_) {
+      scores_.insert(it, score);
+      return;
+    }
+    if (it == scores_.end()) {
+      return;
+    }
+    // Drop the lowest tracked score to make room for the new one.
+    const auto position = it - scores_.begin();
+    scores_.pop_back();
+    scores_.insert(scores_.begin() + position, score);
+  }
+
+  // Returns whether `score` is one of the tracked top scores.
+  bool Contains(float score) const {
+    return std::find(scores_.begin(), scores_.end(), score) != scores_.end();
+  }
+
+  // The tracked scores, highest first. At most K entries.
+  absl::Span<const float> scores() const { return scores_; }
+
+  bool empty() const { return scores_.empty(); }
+
+ private:
+  const int k_;
+  absl::InlinedVector<float, 4> scores_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_TOP_K_SCORES_H_
@@ -0,0 +1,77 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/common/util/top_k_scores.h"
+
+#include <limits>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+TEST(TopKScoresTest, StartsEmpty) {
+  TopKScores top_scores(2);
+  EXPECT_TRUE(top_scores.empty());
+  EXPECT_THAT(top_scores.scores(), IsEmpty());
+}
+
+TEST(TopKScoresTest, KeepsHighestScoresInDescendingOrder) {
+  TopKScores top_scores(2);
+  for (float score : {3.0f, 1.0f, 7.0f, 5.0f, 2.0f}) {
+    top_scores.Add(score);
+  }
+  EXPECT_THAT(top_scores.scores(), ElementsAre(7.0f, 5.0f));
+}
+
+TEST(TopKScoresTest, TiesOccupyOneSlot) {
+  TopKScores top_scores(2);
+  for (float score : {4.0f, 4.0f, 1.0f, 4.0f, 3.0f}) {
+    top_scores.Add(score);
+  }
+  EXPECT_THAT(top_scores.scores(), ElementsAre(4.0f, 3.0f));
+  EXPECT_TRUE(top_scores.Contains(4.0f));
+  EXPECT_FALSE(top_scores.Contains(1.0f));
+}
+
+TEST(TopKScoresTest, DoesNotTruncateFractionalScores) {
+  TopKScores top_scores(2);
+  for (float score : {1.25f, 1.5f, 1.75f}) {
+    top_scores.Add(score);
+  }
+  EXPECT_THAT(top_scores.scores(), ElementsAre(1.75f, 1.5f));
+}
+
+TEST(TopKScoresTest, IgnoresNan) {
+  TopKScores top_scores(3);
+  top_scores.Add(std::numeric_limits<float>::quiet_NaN());
+  top_scores.Add(1.0f);
+  EXPECT_THAT(top_scores.scores(), ElementsAre(1.0f));
+}
+
+TEST(TopKScoresTest, TracksMoreThanInlineCapacity) {
+  TopKScores top_scores(6);
+  for (int i = 0; i < 100; i++) {
+    top_scores.Add(static_cast<float>(i % 50));
+  }
+  EXPECT_THAT(top_scores.scores(),
+              ElementsAre(49.0f, 48.0f, 47.0f, 46.0f, 45.0f, 44.0f));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
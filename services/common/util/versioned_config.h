@@ -0,0 +1,77 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_VERSIONED_CONFIG_H_
+#define SERVICES_COMMON_UTIL_VERSIONED_CONFIG_H_
+
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Holds the current snapshot of a config that can change while the server
+// runs. Each request reads the snapshot current when it starts and keeps it
+// until it is done, so that an update never changes the config a request
+// already started with, nor applies half its changes to a request.
+// Thread safe.
+template <typename T>
+class VersionedConfig {
+ public:
+  explicit VersionedConfig(T config)
+      : snapshot_(std::make_shared<const T>(std::move(config))) {}
+
+  // Not copyable or movable.
+  VersionedConfig(const VersionedConfig&) = delete;
+  VersionedConfig& operator=(const VersionedConfig&) = delete;
+
+  // Returns the current snapshot, which stays valid for as long as it is
+  // held, even once replaced by an update.
+  std::shared_ptr<const T> Get() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return snapshot_;
+  }
+
+  // Makes current a copy of the current snapshot changed by `update`, as the
+  // next version.
+  void Update(absl::AnyInvocable<void(T&) &&> update)
+      ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    T config = *snapshot_;
+    std::move(update)(config);
+    snapshot_ = std::make_shared<const T>(std::move(config));
+    ++version_;
+  }
+
+  // Returns the number of updates made, 0 for the initial snapshot.
+  int64_t version() const ABSL_LOCKS_EXCLUDED(mu_) {
+    absl::MutexLock lock(&mu_);
+    return version_;
+  }
+
+ private:
+  mutable absl::Mutex mu_;
+  std::shared_ptr<const T> snapshot_ ABSL_GUARDED_BY(mu_);
+  int64_t version_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_VERSIONED_CONFIG_H_
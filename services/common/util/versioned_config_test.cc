@@ -0,0 +1,56 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/versioned_config.h"
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+struct TestConfig {
+  std::string timeout_ms = "100";
+  int sample_percent = 100;
+};
+
+TEST(VersionedConfigTest, ReturnsInitialSnapshot) {
+  VersionedConfig<TestConfig> config({.timeout_ms = "50"});
+  EXPECT_EQ(config.Get()->timeout_ms, "50");
+  EXPECT_EQ(config.Get()->sample_percent, 100);
+  EXPECT_EQ(config.version(), 0);
+}
+
+TEST(VersionedConfigTest, UpdatesCopyOfCurrentSnapshot) {
+  VersionedConfig<TestConfig> config({});
+  config.Update([](TestConfig& next) { next.timeout_ms = "200"; });
+  config.Update([](TestConfig& next) { next.sample_percent = 10; });
+  std::shared_ptr<const TestConfig> snapshot = config.Get();
+  EXPECT_EQ(snapshot->timeout_ms, "200");
+  EXPECT_EQ(snapshot->sample_percent, 10);
+  EXPECT_EQ(config.version(), 2);
+}
+
+TEST(VersionedConfigTest, KeepsSnapshotHeldAcrossUpdates) {
+  VersionedConfig<TestConfig> config({});
+  std::shared_ptr<const TestConfig> held = config.Get();
+  config.Update([](TestConfig& next) { next.timeout_ms = "200"; });
+  EXPECT_EQ(held->timeout_ms, "100");
+  EXPECT_EQ(config.Get()->timeout_ms, "200");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,43 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/wasm_util.h"
+
+#include <string>
+
+#include "absl/strings/str_format.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::string WasmBytesToJsString(absl::string_view wasm_bytes) {
+  constexpr char kHexDigits[] = "0123456789abcdef";
+  std::string js_string;
+  js_string.reserve(wasm_bytes.size() * 2);
+  for (const char c : wasm_bytes) {
+    const unsigned char byte = static_cast<unsigned char>(c);
+    if (byte >= 0x20 && byte < 0x7f && byte != '"' && byte != '\\') {
+      js_string.push_back(c);
+    } else {
+      js_string.append(
+          {'\\', 'x', kHexDigits[byte >> 4], kHexDigits[byte & 0xf]});
+    }
+  }
+  return js_string;
+}
+
+std::string GetWasmHelperJavascript(absl::string_view wasm_bytes) {
+  return absl::StrFormat(kWasmModuleTemplate, WasmBytesToJsString(wasm_bytes));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,44 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#ifndef SERVICES_COMMON_UTIL_WASM_UTIL_H_
+#define SERVICES_COMMON_UTIL_WASM_UTIL_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Defines globalWasmHelper, a WebAssembly.Module compiled from the wasm bytes
+// when the code is loaded, or null if there are no wasm bytes. The bytes are
+// embedded as a JS string literal holding one character per byte, which is
+// smaller and much cheaper for V8 to parse than an array literal.
+inline constexpr absl::string_view kWasmModuleTemplate = R"JS_CODE(
+  const globalWasmBytes = "%s";
+  const globalWasmHelper = globalWasmBytes.length ? new WebAssembly.Module(Uint8Array.from(globalWasmBytes, (c) => c.charCodeAt(0))) : null;
+)JS_CODE";
+
+// Returns the contents of a JS string literal whose characters have the char
+// codes of the bytes. Printable ASCII is kept as is, other bytes are \x
+// escaped.
+std::string WasmBytesToJsString(absl::string_view wasm_bytes);
+
+// Returns the JS code defining globalWasmHelper for the wasm bytes, which may
+// be empty.
+std::string GetWasmHelperJavascript(absl::string_view wasm_bytes);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_WASM_UTIL_H_
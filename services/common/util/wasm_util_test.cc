@@ -0,0 +1,42 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/wasm_util.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(WasmBytesToJsString, KeepsPrintableAscii) {
+  EXPECT_EQ(WasmBytesToJsString("test wasm"), "test wasm");
+}
+
+TEST(WasmBytesToJsString, EscapesOtherBytes) {
+  const std::string wasm_bytes("\0asm\x01\x7f\x80\xff\"\\\n", 11);
+  EXPECT_EQ(WasmBytesToJsString(wasm_bytes),
+            R"(\x00asm\x01\x7f\x80\xff\x22\x5c\x0a)");
+}
+
+TEST(GetWasmHelperJavascript, DefinesNullHelperWithoutWasm) {
+  EXPECT_EQ(GetWasmHelperJavascript(""), R"JS_CODE(
+  const globalWasmBytes = "";
+  const globalWasmHelper = globalWasmBytes.length ? new WebAssembly.Module(Uint8Array.from(globalWasmBytes, (c) => c.charCodeAt(0))) : null;
+)JS_CODE");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
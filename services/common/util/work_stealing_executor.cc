@@ -0,0 +1,170 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/work_stealing_executor.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Counts of all the pools, read by the GetWorkStealingExecutor functions.
+std::atomic<int64_t> closures_run = 0;
+std::atomic<int64_t> closures_stolen = 0;
+std::atomic<int64_t> closures_queued = 0;
+
+// Pool and deque of the worker running on this thread, if any.
+thread_local const void* current_pool = nullptr;
+thread_local int current_worker = 0;
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(
+    int num_threads, server_common::Executor* timer_executor)
+    : timer_executor_(timer_executor) {
+  CHECK_GT(num_threads, 0) << "The thread pool needs a thread";
+  workers_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  threads_.reserve(num_threads);
+  for (int i = 0; i < num_threads; ++i) {
+    threads_.emplace_back([this, i]() { Work(i); });
+  }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+  {
+    absl::MutexLock lock(&idle_mu_);
+    stopping_ = true;
+    idle_.SignalAll();
+  }
+  for (std::thread& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingExecutor::Run(absl::AnyInvocable<void()> closure) {
+  if (current_pool == this) {
+    Push(current_worker, std::move(closure));
+  } else {
+    Push(next_worker_.fetch_add(1, std::memory_order_relaxed) %
+             workers_.size(),
+         std::move(closure));
+  }
+}
+
+server_common::TaskId WorkStealingExecutor::RunAfter(
+    absl::Duration duration, absl::AnyInvocable<void()> closure) {
+  return timer_executor_->RunAfter(
+      duration, [this, closure = std::move(closure)]() mutable {
+        Run(std::move(closure));
+      });
+}
+
+bool WorkStealingExecutor::Cancel(server_common::TaskId task_id) {
+  return timer_executor_->Cancel(task_id);
+}
+
+void WorkStealingExecutor::Push(int index,
+                                absl::AnyInvocable<void()> closure) {
+  {
+    Worker& worker = *workers_[index];
+    absl::MutexLock lock(&worker.mu);
+    worker.closures.push_back(std::move(closure));
+    queued_.fetch_add(1);
+  }
+  closures_queued.fetch_add(1, std::memory_order_relaxed);
+  // A thread going to sleep counts itself before it checks queued_, so
+  // either it sees the closure or it is seen here.
+  if (sleeping_.load() > 0) {
+    absl::MutexLock lock(&idle_mu_);
+    idle_.Signal();
+  }
+}
+
+bool WorkStealingExecutor::Pop(int index, absl::AnyInvocable<void()>& closure) {
+  Worker& worker = *workers_[index];
+  absl::MutexLock lock(&worker.mu);
+  if (worker.closures.empty()) {
+    return false;
+  }
+  closure = std::move(worker.closures.back());
+  worker.closures.pop_back();
+  queued_.fetch_sub(1);
+  closures_queued.fetch_sub(1, std::memory_order_relaxed);
+  return true;
+}
+
+bool WorkStealingExecutor::Steal(int index,
+                                 absl::AnyInvocable<void()>& closure) {
+  const int num_workers = workers_.size();
+  for (int i = 1; i < num_workers; ++i) {
+    Worker& victim = *workers_[(index + i) % num_workers];
+    absl::MutexLock lock(&victim.mu);
+    if (victim.closures.empty()) {
+      continue;
+    }
+    closure = std::move(victim.closures.front());
+    victim.closures.pop_front();
+    queued_.fetch_sub(1);
+    closures_queued.fetch_sub(1, std::memory_order_relaxed);
+    closures_stolen.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  return false;
+}
+
+bool WorkStealingExecutor::HasWork() const {
+  return stopping_.load() || queued_.load() > 0;
+}
+
+void WorkStealingExecutor::Work(int index) {
+  current_pool = this;
+  current_worker = index;
+  while (true) {
+    absl::AnyInvocable<void()> closure;
+    if (Pop(index, closure) || Steal(index, closure)) {
+      closure();
+      closures_run.fetch_add(1, std::memory_order_relaxed);
+      continue;
+    }
+    absl::MutexLock lock(&idle_mu_);
+    sleeping_.fetch_add(1);
+    while (!HasWork()) {
+      idle_.Wait(&idle_mu_);
+    }
+    sleeping_.fetch_sub(1);
+    // The closures queued are run before stopping.
+    if (stopping_.load() && queued_.load() == 0) {
+      return;
+    }
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetWorkStealingExecutorTaskCounts() {
+  return {{"run", closures_run.exchange(0)},
+          {"stolen", closures_stolen.exchange(0)}};
+}
+
+absl::flat_hash_map<std::string, double> GetWorkStealingExecutorQueueDepth() {
+  return {{"queued", closures_queued.load()}};
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
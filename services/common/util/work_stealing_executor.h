@@ -0,0 +1,126 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_WORK_STEALING_EXECUTOR_H_
+#define SERVICES_COMMON_UTIL_WORK_STEALING_EXECUTOR_H_
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+#include "src/cpp/concurrent/executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Executor of CPU-bound work, such as decoding, parsing and encrypting the
+// payloads of a request, on a thread per core, so that it does not queue
+// behind the I/O callbacks of the EventEngine threads.
+//
+// Each thread has a deque of its own. The closures run from a thread of the
+// pool are queued on its deque and run last in, first out, so that the
+// continuations of a stage run on the core whose cache holds its data. The
+// other closures are spread over the deques in turn. A thread whose deque is
+// empty steals the oldest closure of the other deques before it sleeps.
+// Thread safe.
+class WorkStealingExecutor final : public server_common::Executor {
+ public:
+  // num_threads: number of threads, positive, usually the number of cores.
+  // timer_executor: runs the timers of RunAfter, which then run their closure
+  // on the pool. Must outlive the pool.
+  WorkStealingExecutor(int num_threads,
+                       server_common::Executor* timer_executor);
+
+  // Not copyable or movable.
+  WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+  WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+  // Runs the closures queued, and joins the threads. Closures of RunAfter
+  // still pending must have been cancelled.
+  ~WorkStealingExecutor() override ABSL_LOCKS_EXCLUDED(idle_mu_);
+
+  void Run(absl::AnyInvocable<void()> closure) override;
+
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override;
+
+  bool Cancel(server_common::TaskId task_id) override;
+
+ private:
+  // Deque of a thread, on a cache line of its own so that the threads taking
+  // their own closures do not contend.
+  struct alignas(64) Worker {
+    absl::Mutex mu;
+    std::deque<absl::AnyInvocable<void()>> closures ABSL_GUARDED_BY(mu);
+  };
+
+  // Queues the closure on the deque of the worker.
+  void Push(int index, absl::AnyInvocable<void()> closure);
+
+  // Takes the newest closure of the deque of the worker, if any.
+  bool Pop(int index, absl::AnyInvocable<void()>& closure);
+
+  // Takes the oldest closure of the deque of another worker, if any.
+  bool Steal(int index, absl::AnyInvocable<void()>& closure);
+
+  // Whether a closure is queued or the pool stops.
+  bool HasWork() const;
+
+  // Runs the queued closures until the pool stops.
+  void Work(int index) ABSL_LOCKS_EXCLUDED(idle_mu_);
+
+  server_common::Executor* const timer_executor_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Deque the next closure run from outside the pool is queued on.
+  std::atomic<unsigned int> next_worker_ = 0;
+  // Closures queued on all the deques.
+  std::atomic<int> queued_ = 0;
+  // Threads waiting for a closure on idle_. The threads queueing a closure
+  // take idle_mu_ to wake one of them only if there are any.
+  std::atomic<int> sleeping_ = 0;
+  std::atomic<bool> stopping_ = false;
+  absl::Mutex idle_mu_;
+  absl::CondVar idle_;
+  std::vector<std::thread> threads_;
+};
+
+// Returns the number of closures run and stolen by all the
+// WorkStealingExecutor instances since the previous call.
+absl::flat_hash_map<std::string, double> GetWorkStealingExecutorTaskCounts();
+
+// Returns the number of closures queued on all the WorkStealingExecutor
+// instances.
+absl::flat_hash_map<std::string, double> GetWorkStealingExecutorQueueDepth();
+
+template <typename T>
+inline void AddWorkStealingExecutorMetric(T* context_map) {
+  context_map->AddObserverable(metric::kCpuExecutorTaskCount,
+                               GetWorkStealingExecutorTaskCounts);
+  context_map->AddObserverable(metric::kCpuExecutorQueueDepth,
+                               GetWorkStealingExecutorQueueDepth);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_WORK_STEALING_EXECUTOR_H_
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/work_stealing_executor.h"
+
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "include/gmock/gmock.h"
+#include "include/gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+// Holds the timers until the test fires them.
+class FakeTimerExecutor : public server_common::Executor {
+ public:
+  void Run(absl::AnyInvocable<void()> closure) override { closure(); }
+  server_common::TaskId RunAfter(absl::Duration duration,
+                                 absl::AnyInvocable<void()> closure) override {
+    delays.push_back(duration);
+    closures.push_back(std::move(closure));
+    return {};
+  }
+  bool Cancel(server_common::TaskId task_id) override {
+    ++cancelled;
+    return true;
+  }
+
+  std::vector<absl::Duration> delays;
+  std::vector<absl::AnyInvocable<void()>> closures;
+  int cancelled = 0;
+};
+
+TEST(WorkStealingExecutorTest, RunsClosuresOnThePoolThreads) {
+  FakeTimerExecutor timer_executor;
+  WorkStealingExecutor pool(/*num_threads=*/4, &timer_executor);
+  absl::BlockingCounter done(100);
+  absl::Mutex mu;
+  std::vector<std::thread::id> thread_ids;
+  for (int i = 0; i < 100; ++i) {
+    pool.Run([&]() {
+      {
+        absl::MutexLock lock(&mu);
+        thread_ids.push_back(std::this_thread::get_id());
+      }
+      done.DecrementCount();
+    });
+  }
+  done.Wait();
+  EXPECT_THAT(thread_ids,
+              testing::Each(testing::Ne(std::this_thread::get_id())));
+}
+
+TEST(WorkStealingExecutorTest, RunsTheNewestContinuationOfAThreadFirst) {
+  FakeTimerExecutor timer_executor;
+  WorkStealingExecutor pool(/*num_threads=*/1, &timer_executor);
+  absl::BlockingCounter done(3);
+  std::vector<int> order;
+  std::thread::id thread_id;
+  std::vector<std::thread::id> continuation_thread_ids;
+  pool.Run([&]() {
+    thread_id = std::this_thread::get_id();
+    for (int i = 0; i < 3; ++i) {
+      pool.Run([&, i]() {
+        order.push_back(i);
+        continuation_thread_ids.push_back(std::this_thread::get_id());
+        done.DecrementCount();
+      });
+    }
+  });
+  done.Wait();
+  EXPECT_THAT(order, ElementsAre(2, 1, 0));
+  EXPECT_THAT(continuation_thread_ids, testing::Each(thread_id));
+}
+
+TEST(WorkStealingExecutorTest, IdleThreadsStealTheClosuresOfBusyThreads) {
+  FakeTimerExecutor timer_executor;
+  GetWorkStealingExecutorTaskCounts();
+  {
+    WorkStealingExecutor pool(/*num_threads=*/2, &timer_executor);
+    absl::Notification continuation_done;
+    absl::Notification done;
+    // The continuation is queued on the thread of the closure, which waits
+    // for it, so only the other thread can run it.
+    pool.Run([&]() {
+      pool.Run([&]() { continuation_done.Notify(); });
+      continuation_done.WaitForNotification();
+      done.Notify();
+    });
+    done.WaitForNotification();
+  }
+  EXPECT_THAT(GetWorkStealingExecutorTaskCounts(),
+              UnorderedElementsAre(Pair("run", 2),
+                                   Pair("stolen", testing::Ge(1))));
+  EXPECT_THAT(GetWorkStealingExecutorQueueDepth(),
+              ElementsAre(Pair("queued", 0)));
+}
+
+TEST(WorkStealingExecutorTest, RunsDelayedClosuresOnThePoolWhenTheTimerFires) {
+  FakeTimerExecutor timer_executor;
+  WorkStealingExecutor pool(/*num_threads=*/1, &timer_executor);
+  absl::BlockingCounter done(1);
+  std::thread::id thread_id;
+  pool.RunAfter(absl::Seconds(1), [&]() {
+    thread_id = std::this_thread::get_id();
+    done.DecrementCount();
+  });
+  ASSERT_EQ(timer_executor.closures.size(), 1);
+  EXPECT_EQ(timer_executor.delays[0], absl::Seconds(1));
+
+  timer_executor.closures[0]();
+  done.Wait();
+  EXPECT_NE(thread_id, std::this_thread::get_id());
+  EXPECT_TRUE(pool.Cancel({}));
+  EXPECT_EQ(timer_executor.cancelled, 1);
+}
+
+TEST(WorkStealingExecutorTest, RunsTheQueuedClosuresBeforeStopping) {
+  FakeTimerExecutor timer_executor;
+  std::atomic<int> ran = 0;
+  {
+    WorkStealingExecutor pool(/*num_threads=*/2, &timer_executor);
+    absl::Notification release;
+    pool.Run([&release]() { release.WaitForNotification(); });
+    pool.Run([&release]() { release.WaitForNotification(); });
+    for (int i = 0; i < 5; ++i) {
+      pool.Run([&ran]() { ++ran; });
+    }
+    release.Notify();
+  }
+  EXPECT_EQ(ran, 5);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/common/util/worker_processes.h"
+
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+int worker_count = 1;
+int worker_index = 0;
+
+// Read by the signal handler of the supervisor, which only runs once the
+// workers are forked, and never resized after.
+std::vector<pid_t>* worker_pids = nullptr;
+volatile sig_atomic_t shutting_down = 0;
+
+void ForwardSignal(int sig) {
+  shutting_down = 1;
+  for (pid_t pid : *worker_pids) {
+    if (pid > 0) {
+      kill(pid, sig);
+    }
+  }
+}
+
+// Forks the worker at `index`. Returns its pid in the supervisor, and does
+// not return in the worker in failure.
+pid_t ForkWorker(int index) {
+  pid_t pid = fork();
+  if (pid == 0) {
+    signal(SIGTERM, SIG_DFL);
+    signal(SIGINT, SIG_DFL);
+    // Workers do not outlive the supervisor.
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    if (getppid() == 1) {
+      _exit(EXIT_FAILURE);
+    }
+    worker_index = index;
+  } else if (pid < 0) {
+    PLOG(ERROR) << "Failed to fork worker process " << index;
+  }
+  return pid;
+}
+
+}  // namespace
+
+void RunWorkerProcesses(int num_workers, absl::Duration restart_delay) {
+  if (num_workers <= 1) {
+    return;
+  }
+  worker_count = num_workers;
+  worker_pids = new std::vector<pid_t>(num_workers, 0);
+  for (int i = 0; i < num_workers; ++i) {
+    pid_t pid = ForkWorker(i);
+    if (pid == 0) {
+      return;
+    }
+    (*worker_pids)[i] = pid;
+  }
+  signal(SIGTERM, ForwardSignal);
+  signal(SIGINT, ForwardSignal);
+  LOG(INFO) << "Supervising " << num_workers << " worker processes";
+
+  int exit_code = EXIT_SUCCESS;
+  int live_workers = num_workers;
+  while (live_workers > 0) {
+    int status;
+    pid_t pid = waitpid(-1, &status, 0);
+    if (pid < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      PLOG(ERROR) << "Failed to wait for the worker processes";
+      exit_code = EXIT_FAILURE;
+      break;
+    }
+    int index = 0;
+    while (index < num_workers && (*worker_pids)[index] != pid) {
+      ++index;
+    }
+    if (index == num_workers) {
+      continue;
+    }
+    (*worker_pids)[index] = 0;
+    --live_workers;
+    if (WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS) {
+      LOG(INFO) << "Worker process " << index << " exited";
+      continue;
+    }
+    exit_code = EXIT_FAILURE;
+    LOG(ERROR) << "Worker process " << index << " failed with status "
+               << status;
+    if (shutting_down) {
+      continue;
+    }
+    absl::SleepFor(restart_delay);
+    if (shutting_down) {
+      continue;
+    }
+    pid = ForkWorker(index);
+    if (pid == 0) {
+      return;
+    }
+    if (pid > 0) {
+      (*worker_pids)[index] = pid;
+      ++live_workers;
+    }
+  }
+  std::exit(exit_code);
+}
+
+int WorkerProcessCount() { return worker_count; }
+
+int WorkerProcessIndex() { return worker_index; }
+
+std::string WorkerInstanceId(std::string instance_id) {
+  if (worker_count <= 1) {
+    return instance_id;
+  }
+  return absl::StrCat(instance_id, "-worker-", worker_index);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
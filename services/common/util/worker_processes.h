@@ -0,0 +1,54 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_COMMON_UTIL_WORKER_PROCESSES_H_
+#define SERVICES_COMMON_UTIL_WORKER_PROCESSES_H_
+
+#include <string>
+
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Forks `num_workers` worker processes and supervises them, so that a server
+// can be sharded across processes listening on the same port with
+// SO_REUSEPORT, the kernel spreading the connections across them.
+//
+// Returns in each worker, which goes on to run the server. The supervisor
+// never returns: it forwards SIGTERM and SIGINT to the workers, forks again
+// any worker exiting in failure, after `restart_delay`, and exits once all
+// the workers exited. Returns right away, forking nothing, when
+// `num_workers` <= 1.
+//
+// Must be called before any thread is started, since only the calling thread
+// is copied into the workers.
+void RunWorkerProcesses(int num_workers,
+                        absl::Duration restart_delay = absl::Seconds(1));
+
+// Number of worker processes the server is sharded across, 1 if not.
+int WorkerProcessCount();
+
+// Index of this worker process among WorkerProcessCount(), 0 if not sharded.
+int WorkerProcessIndex();
+
+// Returns `instance_id` suffixed by the index of this worker process when the
+// server is sharded, so that each worker exports its metrics under an
+// instance of its own, summed up across the workers by the collector.
+std::string WorkerInstanceId(std::string instance_id);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_COMMON_UTIL_WORKER_PROCESSES_H_
@@ -0,0 +1,61 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+#include "services/common/util/worker_processes.h"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstdlib>
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(WorkerProcessesTest, DoesNotForkSingleWorker) {
+  RunWorkerProcesses(1);
+  EXPECT_EQ(WorkerProcessCount(), 1);
+  EXPECT_EQ(WorkerProcessIndex(), 0);
+  EXPECT_EQ(WorkerInstanceId("instance"), "instance");
+}
+
+TEST(WorkerProcessesDeathTest, SupervisorExitsOnceWorkersExit) {
+  EXPECT_EXIT(
+      {
+        RunWorkerProcesses(3);
+        // Only the workers get here.
+        const bool sharded =
+            WorkerProcessCount() == 3 && WorkerProcessIndex() >= 0 &&
+            WorkerProcessIndex() < 3 &&
+            WorkerInstanceId("instance") ==
+                absl::StrCat("instance-worker-", WorkerProcessIndex());
+        std::_Exit(sharded ? EXIT_SUCCESS : 2);
+      },
+      ::testing::ExitedWithCode(EXIT_SUCCESS), "");
+}
+
+TEST(WorkerProcessesDeathTest, SupervisorDoesNotRestartWorkersOnShutdown) {
+  EXPECT_EXIT(
+      {
+        RunWorkerProcesses(2, absl::ZeroDuration());
+        kill(getppid(), SIGTERM);
+        std::_Exit(EXIT_FAILURE);
+      },
+      ::testing::ExitedWithCode(EXIT_FAILURE), "");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
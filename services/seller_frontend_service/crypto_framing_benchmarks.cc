@@ -0,0 +1,452 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Microbenchmarks for the crypto, framing and compression of the payloads.
+//
+// The payload size benchmarks run over random payloads of 1 KB to 4 MB:
+// - BM_HpkeEncrypt/BM_HpkeDecrypt and BM_AeadEncrypt/BM_AeadDecrypt, with the
+//   CPIO crypto client (CryptoClientWrapper) and BoringSslCryptoClient, as on
+//   the internal hops.
+// - BM_OhttpDecapsulateRequest, setting the gateway up per request or with
+//   the OhttpGatewayCache, and BM_OhttpEncapsulateResponse, as for the
+//   SelectAd requests and responses.
+// - BM_EncodeResponsePayload/BM_DecodeRequestPayload, the framing.
+// - BM_GzipCompress/BM_GzipDecompress.
+//
+// BM_DecodeSelectAdRequest runs the SFE request path on ProtectedAuctionInputs
+// of a given number of interest groups: OHTTP decapsulation, unframing and
+// parsing. BM_EncodeAuctionResult runs the response path on AuctionResults of
+// a given number of bidding groups: serialization, compression, framing and
+// OHTTP encapsulation.
+//
+// Each benchmark reports the bytes processed per second, and the allocations
+// per iteration as allocs_per_op.
+//
+// Run with:
+//   bazel run -c opt //services/seller_frontend_service:crypto_framing_benchmarks
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "quiche/oblivious_http/oblivious_http_gateway.h"
+#include "services/common/compression/gzip.h"
+#include "services/common/encryption/crypto_client_factory.h"
+#include "services/common/encryption/ohttp_gateway_cache.h"
+#include "services/common/test/random.h"
+#include "services/common/test/utils/ohttp_utils.h"
+#include "services/seller_frontend_service/util/framing_utils.h"
+#include "src/cpp/communication/encoding_utils.h"
+#include "src/cpp/communication/ohttp_utils.h"
+
+namespace {
+
+// Allocations of the process, counted by the replaced operator new.
+std::atomic<int64_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    std::abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::google::cmrt::sdk::crypto_service::v1::AeadEncryptResponse;
+using ::google::cmrt::sdk::crypto_service::v1::HpkeEncryptResponse;
+using ::google::cmrt::sdk::public_key_service::v1::PublicKey;
+
+constexpr char kKeyId[] = "key_id";
+
+// Counts the allocations from its construction, and reports them and the
+// bytes processed when it goes out of scope after the benchmark loop.
+class Counters {
+ public:
+  Counters(benchmark::State& state, int64_t bytes_per_iteration)
+      : state_(state),
+        bytes_per_iteration_(bytes_per_iteration),
+        allocations_(allocations.load(std::memory_order_relaxed)) {}
+
+  ~Counters() {
+    state_.counters["allocs_per_op"] = benchmark::Counter(
+        allocations.load(std::memory_order_relaxed) - allocations_,
+        benchmark::Counter::kAvgIterations);
+    state_.SetBytesProcessed(state_.iterations() * bytes_per_iteration_);
+  }
+
+ private:
+  benchmark::State& state_;
+  int64_t bytes_per_iteration_;
+  int64_t allocations_;
+};
+
+// A random payload, which does not compress.
+std::string MakePayload(int64_t size) {
+  std::mt19937 engine;
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::string payload(size, '\0');
+  for (char& c : payload) {
+    c = static_cast<char>(distribution(engine));
+  }
+  return payload;
+}
+
+// A JSON-like payload, which compresses about as well as the real ones.
+std::string MakeCompressiblePayload(int64_t size) {
+  std::string payload;
+  while (payload.size() < size) {
+    absl::StrAppend(&payload, "{\"renderUrl\": \"", MakeARandomUrl(),
+                    "\", \"metadata\": [", MakeARandomInt(0, 1000), "]}, ");
+  }
+  payload.resize(size);
+  return payload;
+}
+
+PublicKey GetTestPublicKey() {
+  PublicKey public_key;
+  public_key.set_key_id(kKeyId);
+  public_key.set_public_key(absl::Base64Escape(GetHpkePublicKey()));
+  return public_key;
+}
+
+server_common::PrivateKey GetTestPrivateKey() {
+  server_common::PrivateKey private_key;
+  private_key.key_id = kKeyId;
+  private_key.private_key = GetHpkePrivateKey();
+  return private_key;
+}
+
+// The private key of the OHTTP key ID of the test requests.
+server_common::PrivateKey GetTestOhttpPrivateKey() {
+  server_common::PrivateKey private_key;
+  private_key.key_id = std::to_string(kTestKeyId);
+  private_key.private_key = GetHpkePrivateKey();
+  return private_key;
+}
+
+// state.range(1) selects the crypto client: 0 for the CPIO one, 1 for
+// BoringSslCryptoClient.
+std::unique_ptr<CryptoClientWrapperInterface> CreateBenchmarkedCryptoClient(
+    const benchmark::State& state) {
+  return CreateCryptoClient(/*use_boringssl=*/state.range(1) == 1);
+}
+
+void BM_HpkeEncrypt(benchmark::State& state) {
+  std::unique_ptr<CryptoClientWrapperInterface> crypto_client =
+      CreateBenchmarkedCryptoClient(state);
+  const std::string payload = MakePayload(state.range(0));
+  const PublicKey public_key = GetTestPublicKey();
+  Counters counters(state, payload.size());
+  for (auto _ : state) {
+    auto response = crypto_client->HpkeEncrypt(public_key, payload);
+    CHECK(response.ok()) << response.status();
+    benchmark::DoNotOptimize(response);
+  }
+}
+
+void BM_HpkeDecrypt(benchmark::State& state) {
+  std::unique_ptr<CryptoClientWrapperInterface> crypto_client =
+      CreateBenchmarkedCryptoClient(state);
+  absl::StatusOr<HpkeEncryptResponse> encrypted = crypto_client->HpkeEncrypt(
+      GetTestPublicKey(), MakePayload(state.range(0)));
+  CHECK(encrypted.ok()) << encrypted.status();
+  const server_common::PrivateKey private_key = GetTestPrivateKey();
+  Counters counters(state, state.range(0));
+  for (auto _ : state) {
+    auto response = crypto_client->HpkeDecrypt(
+        private_key, encrypted->encrypted_data().ciphertext());
+    CHECK(response.ok()) << response.status();
+    benchmark::DoNotOptimize(response);
+  }
+}
+
+void BM_AeadEncrypt(benchmark::State& state) {
+  std::unique_ptr<CryptoClientWrapperInterface> crypto_client =
+      CreateBenchmarkedCryptoClient(state);
+  absl::StatusOr<HpkeEncryptResponse> encrypted =
+      crypto_client->HpkeEncrypt(GetTestPublicKey(), "");
+  CHECK(encrypted.ok()) << encrypted.status();
+  const std::string payload = MakePayload(state.range(0));
+  Counters counters(state, payload.size());
+  for (auto _ : state) {
+    auto response = crypto_client->AeadEncrypt(payload, encrypted->secret());
+    CHECK(response.ok()) << response.status();
+    benchmark::DoNotOptimize(response);
+  }
+}
+
+void BM_AeadDecrypt(benchmark::State& state) {
+  std::unique_ptr<CryptoClientWrapperInterface> crypto_client =
+      CreateBenchmarkedCryptoClient(state);
+  absl::StatusOr<HpkeEncryptResponse> encrypted_request =
+      crypto_client->HpkeEncrypt(GetTestPublicKey(), "");
+  CHECK(encrypted_request.ok()) << encrypted_request.status();
+  const std::string& secret = encrypted_request->secret();
+  absl::StatusOr<AeadEncryptResponse> encrypted =
+      crypto_client->AeadEncrypt(MakePayload(state.range(0)), secret);
+  CHECK(encrypted.ok()) << encrypted.status();
+  Counters counters(state, state.range(0));
+  for (auto _ : state) {
+    auto response = crypto_client->AeadDecrypt(
+        encrypted->encrypted_data().ciphertext(), secret);
+    CHECK(response.ok()) << response.status();
+    benchmark::DoNotOptimize(response);
+  }
+}
+
+// state.range(1) is 1 to decapsulate with the gateway of an OhttpGatewayCache
+// rather than one set up for each request.
+void BM_OhttpDecapsulateRequest(benchmark::State& state) {
+  absl::StatusOr<quiche::ObliviousHttpRequest> request =
+      CreateValidEncryptedRequest(MakePayload(state.range(0)));
+  CHECK(request.ok()) << request.status();
+  const std::string encapsulated_request = request->EncapsulateAndSerialize();
+  const server_common::PrivateKey private_key = GetTestOhttpPrivateKey();
+  OhttpGatewayCache gateway_cache;
+  Counters counters(state, state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<quiche::ObliviousHttpRequest> decapsulated;
+    if (state.range(1) == 1) {
+      absl::StatusOr<const quiche::ObliviousHttpGateway*> gateway =
+          gateway_cache.Get(kTestKeyId, private_key);
+      CHECK(gateway.ok()) << gateway.status();
+      decapsulated = (*gateway)->DecryptObliviousHttpRequest(
+          encapsulated_request);
+    } else {
+      decapsulated = server_common::DecryptEncapsulatedRequest(
+          private_key, encapsulated_request);
+    }
+    CHECK(decapsulated.ok()) << decapsulated.status();
+    benchmark::DoNotOptimize(decapsulated);
+  }
+}
+
+void BM_OhttpEncapsulateResponse(benchmark::State& state) {
+  absl::StatusOr<quiche::ObliviousHttpRequest> request =
+      CreateValidEncryptedRequest(MakePayload(1024));
+  CHECK(request.ok()) << request.status();
+  const server_common::PrivateKey private_key = GetTestOhttpPrivateKey();
+  OhttpGatewayCache gateway_cache;
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> gateway =
+      gateway_cache.Get(kTestKeyId, private_key);
+  CHECK(gateway.ok()) << gateway.status();
+  absl::StatusOr<quiche::ObliviousHttpRequest> decapsulated =
+      (*gateway)->DecryptObliviousHttpRequest(
+          request->EncapsulateAndSerialize());
+  CHECK(decapsulated.ok()) << decapsulated.status();
+  quiche::ObliviousHttpRequest::Context context =
+      std::move(*decapsulated).ReleaseContext();
+  const std::string payload = MakePayload(state.range(0));
+  Counters counters(state, payload.size());
+  for (auto _ : state) {
+    absl::StatusOr<quiche::ObliviousHttpResponse> response =
+        (*gateway)->CreateObliviousHttpResponse(payload, context);
+    CHECK(response.ok()) << response.status();
+    benchmark::DoNotOptimize(response->EncapsulateAndSerialize());
+  }
+}
+
+void BM_EncodeResponsePayload(benchmark::State& state) {
+  const std::string payload = MakePayload(state.range(0));
+  Counters counters(state, payload.size());
+  for (auto _ : state) {
+    absl::StatusOr<std::string> encoded = server_common::EncodeResponsePayload(
+        server_common::CompressionType::kGzip, payload,
+        GetEncodedDataSize(payload.size()));
+    CHECK(encoded.ok()) << encoded.status();
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+
+void BM_DecodeRequestPayload(benchmark::State& state) {
+  absl::StatusOr<std::string> encoded = server_common::EncodeResponsePayload(
+      server_common::CompressionType::kGzip, MakePayload(state.range(0)),
+      GetEncodedDataSize(state.range(0)));
+  CHECK(encoded.ok()) << encoded.status();
+  Counters counters(state, state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<server_common::DecodedRequest> decoded =
+        server_common::DecodeRequestPayload(*encoded);
+    CHECK(decoded.ok()) << decoded.status();
+    benchmark::DoNotOptimize(decoded);
+  }
+}
+
+void BM_GzipCompress(benchmark::State& state) {
+  const std::string payload = MakeCompressiblePayload(state.range(0));
+  Counters counters(state, payload.size());
+  for (auto _ : state) {
+    absl::StatusOr<std::string> compressed = GzipCompress(payload);
+    CHECK(compressed.ok()) << compressed.status();
+    benchmark::DoNotOptimize(compressed);
+  }
+}
+
+void BM_GzipDecompress(benchmark::State& state) {
+  absl::StatusOr<std::string> compressed =
+      GzipCompress(MakeCompressiblePayload(state.range(0)));
+  CHECK(compressed.ok()) << compressed.status();
+  Counters counters(state, state.range(0));
+  for (auto _ : state) {
+    absl::StatusOr<std::string> decompressed =
+        GzipDecompress(*compressed, state.range(0));
+    CHECK(decompressed.ok()) << decompressed.status();
+    benchmark::DoNotOptimize(decompressed);
+  }
+}
+
+// Returns a ProtectedAuctionInput from an app, with the given number of
+// interest groups spread over a few buyers.
+ProtectedAuctionInput MakeProtectedAuctionInput(int num_interest_groups) {
+  constexpr int kNumBuyers = 4;
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  for (int i = 0; i < num_interest_groups; ++i) {
+    buyer_inputs[absl::StrCat("buyer_", i % kNumBuyers, ".com")]
+        .mutable_interest_groups()
+        ->AddAllocated(
+            MakeARandomInterestGroup(/*build_android_signals=*/true).release());
+  }
+  ProtectedAuctionInput input;
+  input.set_publisher_name(MakeARandomString());
+  input.set_generation_id(MakeARandomString());
+  *input.mutable_buyer_input() = GetProtoEncodedBuyerInputs(buyer_inputs);
+  return input;
+}
+
+void BM_DecodeSelectAdRequest(benchmark::State& state) {
+  const std::string serialized_input =
+      MakeProtectedAuctionInput(state.range(0)).SerializeAsString();
+  absl::StatusOr<std::string> encoded = server_common::EncodeResponsePayload(
+      server_common::CompressionType::kGzip, serialized_input,
+      GetEncodedDataSize(serialized_input.size()));
+  CHECK(encoded.ok()) << encoded.status();
+  absl::StatusOr<quiche::ObliviousHttpRequest> request =
+      CreateValidEncryptedRequest(*std::move(encoded));
+  CHECK(request.ok()) << request.status();
+  const std::string encapsulated_request = request->EncapsulateAndSerialize();
+  const server_common::PrivateKey private_key = GetTestOhttpPrivateKey();
+  OhttpGatewayCache gateway_cache;
+  Counters counters(state, encapsulated_request.size());
+  for (auto _ : state) {
+    absl::StatusOr<const quiche::ObliviousHttpGateway*> gateway =
+        gateway_cache.Get(kTestKeyId, private_key);
+    CHECK(gateway.ok()) << gateway.status();
+    absl::StatusOr<quiche::ObliviousHttpRequest> decapsulated =
+        (*gateway)->DecryptObliviousHttpRequest(encapsulated_request);
+    CHECK(decapsulated.ok()) << decapsulated.status();
+    absl::StatusOr<server_common::DecodedRequest> decoded =
+        server_common::DecodeRequestPayload(decapsulated->GetPlaintextData());
+    CHECK(decoded.ok()) << decoded.status();
+    ProtectedAuctionInput input;
+    CHECK(input.ParseFromString(decoded->compressed_data));
+    benchmark::DoNotOptimize(input);
+  }
+  state.counters["request_bytes"] = encapsulated_request.size();
+}
+
+void BM_EncodeAuctionResult(benchmark::State& state) {
+  AuctionResult auction_result = MakeARandomAuctionResult();
+  for (int i = 0; i < state.range(0); ++i) {
+    AuctionResult::InterestGroupIndex indices;
+    indices.add_index(i);
+    auction_result.mutable_bidding_groups()->try_emplace(
+        absl::StrCat("buyer_", i, ".com"), std::move(indices));
+  }
+  absl::StatusOr<quiche::ObliviousHttpRequest> request =
+      CreateValidEncryptedRequest(MakePayload(1024));
+  CHECK(request.ok()) << request.status();
+  const server_common::PrivateKey private_key = GetTestOhttpPrivateKey();
+  OhttpGatewayCache gateway_cache;
+  absl::StatusOr<const quiche::ObliviousHttpGateway*> gateway =
+      gateway_cache.Get(kTestKeyId, private_key);
+  CHECK(gateway.ok()) << gateway.status();
+  absl::StatusOr<quiche::ObliviousHttpRequest> decapsulated =
+      (*gateway)->DecryptObliviousHttpRequest(
+          request->EncapsulateAndSerialize());
+  CHECK(decapsulated.ok()) << decapsulated.status();
+  quiche::ObliviousHttpRequest::Context context =
+      std::move(*decapsulated).ReleaseContext();
+  Counters counters(state, auction_result.ByteSizeLong());
+  for (auto _ : state) {
+    absl::StatusOr<std::string> encoded = GzipCompressAndEncodeResponsePayload(
+        auction_result.SerializeAsString());
+    CHECK(encoded.ok()) << encoded.status();
+    absl::StatusOr<quiche::ObliviousHttpResponse> response =
+        (*gateway)->CreateObliviousHttpResponse(*std::move(encoded), context);
+    CHECK(response.ok()) << response.status();
+    benchmark::DoNotOptimize(response->EncapsulateAndSerialize());
+  }
+}
+
+// Args: payload bytes, from 1 KB to 4 MB.
+void PayloadSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("bytes")->RangeMultiplier(4)->Range(1 << 10, 4 << 20);
+}
+
+// Args: payload bytes, and the crypto client: 0 for the CPIO one, 1 for
+// BoringSslCryptoClient.
+void CryptoClientPayloadSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"bytes", "boringssl"})
+      ->ArgsProduct({benchmark::CreateRange(1 << 10, 4 << 20, 4), {0, 1}});
+}
+
+// Args: payload bytes, and whether the gateway is cached.
+void OhttpPayloadSizes(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"bytes", "cached_gateway"})
+      ->ArgsProduct({benchmark::CreateRange(1 << 10, 4 << 20, 4), {0, 1}});
+}
+
+BENCHMARK(BM_HpkeEncrypt)->Apply(CryptoClientPayloadSizes);
+BENCHMARK(BM_HpkeDecrypt)->Apply(CryptoClientPayloadSizes);
+BENCHMARK(BM_AeadEncrypt)->Apply(CryptoClientPayloadSizes);
+BENCHMARK(BM_AeadDecrypt)->Apply(CryptoClientPayloadSizes);
+BENCHMARK(BM_OhttpDecapsulateRequest)->Apply(OhttpPayloadSizes);
+BENCHMARK(BM_OhttpEncapsulateResponse)->Apply(PayloadSizes);
+BENCHMARK(BM_EncodeResponsePayload)->Apply(PayloadSizes);
+BENCHMARK(BM_DecodeRequestPayload)->Apply(PayloadSizes);
+BENCHMARK(BM_GzipCompress)->Apply(PayloadSizes);
+BENCHMARK(BM_GzipDecompress)->Apply(PayloadSizes);
+BENCHMARK(BM_DecodeSelectAdRequest)
+    ->ArgName("interest_groups")
+    ->RangeMultiplier(10)
+    ->Range(1, 1000);
+BENCHMARK(BM_EncodeAuctionResult)
+    ->ArgName("bidding_groups")
+    ->RangeMultiplier(10)
+    ->Range(1, 1000);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
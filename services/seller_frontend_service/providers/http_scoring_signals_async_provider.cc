@@ -16,15 +16,86 @@
 
 #include <string>
 #include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/key_value_table.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kRenderUrls[] = "renderUrls";
+constexpr char kAdComponentRenderUrls[] = "adComponentRenderUrls";
+// Prefixes of the cache keys of the render URLs and ad component render URLs.
+constexpr char kRenderUrlKeyPrefix[] = "render;";
+constexpr char kAdComponentRenderUrlKeyPrefix[] = "component;";
+
+// Adds the URL to the cached values of the namespace if it is in the cache,
+// otherwise to the URLs to look up. URLs already seen are skipped.
+void LookUpUrl(const std::string& url, absl::string_view key_prefix,
+               KeyValueCache& cache, absl::flat_hash_set<std::string>& seen,
+               CachedNamespace& cached, std::vector<std::string>& missing) {
+  std::string key = absl::StrCat(key_prefix, url);
+  if (!seen.insert(key).second) {
+    return;
+  }
+  if (auto value = cache.LookUp(key)) {
+    // URLs cached as misses are left out rather than looked up again.
+    if (!value->empty()) {
+      cached.values.emplace_back(url, std::move(value));
+    }
+  } else {
+    missing.push_back(url);
+  }
+}
+
+// Caches the scoring signals of the Key-Value server response, and the
+// requested URLs it has none for as misses, and returns them merged with the
+// cached ones. Responses that are neither key-value tables nor JSON objects
+// are returned as is.
+std::string CacheAndMerge(std::string response,
+                          const std::vector<CachedNamespace>& cached,
+                          const GetSellerValuesInput& requested,
+                          KeyValueCache& cache) {
+  if (IsKeyValueTable(response)) {
+    if (absl::StatusOr<KeyValueTable> table = ParseKeyValueTable(response);
+        table.ok()) {
+      CacheTableNamespace(*table, kRenderUrls, kRenderUrlKeyPrefix,
+                          cache.ttl(), cache, requested.render_urls);
+      CacheTableNamespace(*table, kAdComponentRenderUrls,
+                          kAdComponentRenderUrlKeyPrefix, cache.ttl(), cache,
+                          requested.ad_component_render_urls);
+    }
+    AppendCachedValuesToTable(cached, &response);
+    return response;
+  }
+  absl::StatusOr<rapidjson::Document> document = ParseJsonString(response);
+  if (!document.ok() || !document->IsObject()) {
+    return response;
+  }
+  CacheNamespace(*document, kRenderUrls, kRenderUrlKeyPrefix, cache.ttl(),
+                 cache, requested.render_urls);
+  CacheNamespace(*document, kAdComponentRenderUrls,
+                 kAdComponentRenderUrlKeyPrefix, cache.ttl(), cache,
+                 requested.ad_component_render_urls);
+  if (cached[0].values.empty() && cached[1].values.empty()) {
+    return response;
+  }
+  return MergeCachedValues(&*document, cached);
+}
+
+}  // namespace
 
 HttpScoringSignalsAsyncProvider::HttpScoringSignalsAsyncProvider(
     std::unique_ptr<
         AsyncClient<GetSellerValuesInput, GetSellerValuesOutput,
                     GetSellerValuesRawInput, GetSellerValuesRawOutput>>
-        http_seller_kv_async_client)
-    : http_seller_kv_async_client_(std::move(http_seller_kv_async_client)) {}
+        http_seller_kv_async_client,
+    std::shared_ptr<KeyValueCache> cache)
+    : http_seller_kv_async_client_(std::move(http_seller_kv_async_client)),
+      cache_(std::move(cache)) {}
 
 void HttpScoringSignalsAsyncProvider::Get(
     const ScoringSignalsRequest& scoring_signals_request,
@@ -32,25 +103,64 @@ void HttpScoringSignalsAsyncProvider::Get(
         on_done,
     absl::Duration timeout) const {
   auto request = std::make_unique<GetSellerValuesInput>();
+  // Scoring signals found in cache_, by namespace of the response.
+  std::vector<CachedNamespace> cached = {{kRenderUrls},
+                                         {kAdComponentRenderUrls}};
+  absl::flat_hash_set<std::string> seen;
+  // The same creatives and components are often bid with by several interest
+  // groups or buyers, and are only looked up once.
+  absl::flat_hash_set<absl::string_view> seen_render_urls;
+  absl::flat_hash_set<absl::string_view> seen_ad_component_render_urls;
   for (const auto& buyer_get_bid_response_pair :
        scoring_signals_request.buyer_bids_map_) {
     for (const auto& ad : buyer_get_bid_response_pair.second->bids()) {
-      request->render_urls.emplace_back(ad.render());
-      request->ad_component_render_urls.insert(
-          request->ad_component_render_urls.end(), ad.ad_components().begin(),
-          ad.ad_components().end());
+      if (cache_ == nullptr) {
+        if (seen_render_urls.insert(ad.render()).second) {
+          request->render_urls.emplace_back(ad.render());
+        }
+        for (const std::string& ad_component : ad.ad_components()) {
+          if (seen_ad_component_render_urls.insert(ad_component).second) {
+            request->ad_component_render_urls.emplace_back(ad_component);
+          }
+        }
+        continue;
+      }
+      LookUpUrl(ad.render(), kRenderUrlKeyPrefix, *cache_, seen, cached[0],
+                request->render_urls);
+      for (const std::string& ad_component : ad.ad_components()) {
+        LookUpUrl(ad_component, kAdComponentRenderUrlKeyPrefix, *cache_, seen,
+                  cached[1], request->ad_component_render_urls);
+      }
     }
   }
+  if (request->render_urls.empty() &&
+      request->ad_component_render_urls.empty() && !seen.empty()) {
+    // Every scoring signal is cached.
+    auto signals = std::make_unique<ScoringSignals>();
+    signals->scoring_signals =
+        std::make_unique<std::string>(MergeCachedValues(nullptr, cached));
+    std::move(on_done)(std::move(signals));
+    return;
+  }
+  // The URLs the response has no scoring signals for are cached as misses.
+  GetSellerValuesInput requested;
+  if (cache_ != nullptr && cache_->miss_ttl() > absl::ZeroDuration()) {
+    requested = *request;
+  }
   http_seller_kv_async_client_->Execute(
       std::move(request), scoring_signals_request.filtering_metadata_,
-      [on_done = std::move(on_done)](
+      [on_done = std::move(on_done), cache = cache_,
+       cached = std::move(cached), requested = std::move(requested)](
           absl::StatusOr<std::unique_ptr<GetSellerValuesOutput>>
               kv_output) mutable {
         absl::StatusOr<std::unique_ptr<ScoringSignals>> res;
         if (kv_output.ok()) {
           res = std::make_unique<ScoringSignals>();
-          res.value()->scoring_signals =
-              std::make_unique<std::string>(kv_output.value()->result);
+          res.value()->scoring_signals = std::make_unique<std::string>(
+              cache == nullptr
+                  ? std::move(kv_output.value()->result)
+                  : CacheAndMerge(std::move(kv_output.value()->result),
+                                  cached, requested, *cache));
         } else {
           res = kv_output.status();
         }
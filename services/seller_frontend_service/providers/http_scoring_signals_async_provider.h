@@ -19,6 +19,7 @@
 
 #include "services/common/clients/async_client.h"
 #include "services/common/clients/http_kv_server/seller/seller_key_value_async_http_client.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
 #include "services/seller_frontend_service/providers/scoring_signals_async_provider.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
@@ -26,10 +27,14 @@ namespace privacy_sandbox::bidding_auction_servers {
 class HttpScoringSignalsAsyncProvider final
     : public ScoringSignalsAsyncProvider {
  public:
+  // If cache is not null, the scoring signals of the render URLs and ad
+  // component render URLs are cached, and only the URLs missing from the cache
+  // are looked up.
   explicit HttpScoringSignalsAsyncProvider(
       std::unique_ptr<
           AsyncClient<GetSellerValuesInput, GetSellerValuesOutput,
-                      GetSellerValuesRawInput, GetSellerValuesRawOutput>>);
+                      GetSellerValuesRawInput, GetSellerValuesRawOutput>>,
+      std::shared_ptr<KeyValueCache> cache = nullptr);
 
   // HttpScoringSignalsAsyncProvider is neither copyable nor movable.
   HttpScoringSignalsAsyncProvider(const HttpScoringSignalsAsyncProvider&) =
@@ -52,6 +57,7 @@ class HttpScoringSignalsAsyncProvider final
       AsyncClient<GetSellerValuesInput, GetSellerValuesOutput,
                   GetSellerValuesRawInput, GetSellerValuesRawOutput>>
       http_seller_kv_async_client_;
+  std::shared_ptr<KeyValueCache> cache_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -189,5 +189,124 @@ TEST(HttpScoringSignalsAsyncProviderTest, MapsResponseToScoringSignals) {
   notification.WaitForNotification();
 }
 
+TEST(HttpScoringSignalsAsyncProviderTest, LooksUpOnlyUrlsMissingFromCache) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetSellerValuesInput, GetSellerValuesOutput,
+                      GetSellerValuesRawInput, GetSellerValuesRawOutput>>();
+  EXPECT_CALL(
+      *mock_client,
+      Execute(An<std::unique_ptr<GetSellerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetSellerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .WillOnce([](std::unique_ptr<GetSellerValuesInput> input,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                               GetSellerValuesOutput>>) &&>
+                       callback,
+                   absl::Duration timeout) {
+        EXPECT_EQ(input->render_urls, std::vector<std::string>{"ad"});
+        EXPECT_EQ(input->ad_component_render_urls,
+                  std::vector<std::string>{"component"});
+        auto output = std::make_unique<GetSellerValuesOutput>();
+        output->result =
+            R"JSON({"renderUrls":{"ad":1},)JSON"
+            R"JSON("adComponentRenderUrls":{"component":2}})JSON";
+        (std::move(callback))(std::move(output));
+        return absl::OkStatus();
+      })
+      .WillOnce([](std::unique_ptr<GetSellerValuesInput> input,
+                   const RequestMetadata& metadata,
+                   absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                               GetSellerValuesOutput>>) &&>
+                       callback,
+                   absl::Duration timeout) {
+        EXPECT_EQ(input->render_urls, std::vector<std::string>{"other_ad"});
+        EXPECT_TRUE(input->ad_component_render_urls.empty());
+        auto output = std::make_unique<GetSellerValuesOutput>();
+        output->result = R"JSON({"renderUrls":{"other_ad":3}})JSON";
+        (std::move(callback))(std::move(output));
+        return absl::OkStatus();
+      });
+  HttpScoringSignalsAsyncProvider class_under_test(
+      std::move(mock_client),
+      std::make_shared<KeyValueCache>(absl::Minutes(1), /*max_bytes=*/1024));
+
+  std::vector<std::string> scoring_signals;
+  for (const std::string& render_url : {"ad", "other_ad"}) {
+    BuyerBidsResponseMap buyer_bids_map;
+    auto get_bid_res = std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+    for (const std::string& url : {std::string("ad"), render_url}) {
+      AdWithBid* ad_with_bid = get_bid_res->mutable_bids()->Add();
+      ad_with_bid->set_render(url);
+      ad_with_bid->add_ad_components("component");
+    }
+    buyer_bids_map.try_emplace("buyer", std::move(get_bid_res));
+    class_under_test.Get(
+        ScoringSignalsRequest(buyer_bids_map, {}),
+        [&scoring_signals](
+            absl::StatusOr<std::unique_ptr<ScoringSignals>> signals) {
+          ASSERT_TRUE(signals.ok());
+          scoring_signals.push_back(*signals.value()->scoring_signals);
+        },
+        absl::Milliseconds(100));
+  }
+
+  ASSERT_EQ(scoring_signals.size(), 2);
+  EXPECT_EQ(scoring_signals[1],
+            R"JSON({"renderUrls":{"other_ad":3,"ad":1},)JSON"
+            R"JSON("adComponentRenderUrls":{"component":2}})JSON");
+}
+
+TEST(HttpScoringSignalsAsyncProviderTest, LooksUpDuplicateUrlsOnce) {
+  auto mock_client = std::make_unique<
+      AsyncClientMock<GetSellerValuesInput, GetSellerValuesOutput,
+                      GetSellerValuesRawInput, GetSellerValuesRawOutput>>();
+  absl::Notification notification;
+  EXPECT_CALL(
+      *mock_client,
+      Execute(An<std::unique_ptr<GetSellerValuesInput>>(),
+              An<const RequestMetadata&>(),
+              An<absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                             GetSellerValuesOutput>>) &&>>(),
+              An<absl::Duration>()))
+      .WillOnce([&notification](
+                    std::unique_ptr<GetSellerValuesInput> input,
+                    const RequestMetadata& metadata,
+                    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<
+                                                GetSellerValuesOutput>>) &&>
+                        callback,
+                    absl::Duration timeout) {
+        std::sort(input->render_urls.begin(), input->render_urls.end());
+        EXPECT_EQ(input->render_urls, (std::vector<std::string>{"ad", "ad_2"}));
+        std::sort(input->ad_component_render_urls.begin(),
+                  input->ad_component_render_urls.end());
+        EXPECT_EQ(input->ad_component_render_urls,
+                  (std::vector<std::string>{"component", "component_2"}));
+        notification.Notify();
+        return absl::OkStatus();
+      });
+  HttpScoringSignalsAsyncProvider class_under_test(std::move(mock_client));
+
+  // Both buyers bid with the same creative and share a component.
+  BuyerBidsResponseMap buyer_bids_map;
+  for (const std::string& buyer : {"buyer_1", "buyer_2"}) {
+    auto get_bid_res = std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+    for (const std::string& url : {"ad", "ad_2"}) {
+      AdWithBid* ad_with_bid = get_bid_res->mutable_bids()->Add();
+      ad_with_bid->set_render(url);
+      ad_with_bid->add_ad_components("component");
+    }
+    get_bid_res->mutable_bids(1)->add_ad_components("component_2");
+    buyer_bids_map.try_emplace(buyer, std::move(get_bid_res));
+  }
+  class_under_test.Get(
+      ScoringSignalsRequest(buyer_bids_map, {}),
+      [](absl::StatusOr<std::unique_ptr<ScoringSignals>> signals) {},
+      absl::Milliseconds(100));
+  notification.WaitForNotification();
+}
+
 }  // namespace
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -35,14 +35,85 @@ inline constexpr char BUYER_SERVER_HOSTS[] = "BUYER_SERVER_HOSTS";
 inline constexpr char ENABLE_BUYER_COMPRESSION[] = "ENABLE_BUYER_COMPRESSION";
 inline constexpr char ENABLE_AUCTION_COMPRESSION[] =
     "ENABLE_AUCTION_COMPRESSION";
+inline constexpr char GRPC_COMPRESSION_ALGORITHM[] =
+    "GRPC_COMPRESSION_ALGORITHM";
+inline constexpr char GRPC_COMPRESSION_MIN_MESSAGE_BYTES[] =
+    "GRPC_COMPRESSION_MIN_MESSAGE_BYTES";
 inline constexpr char ENABLE_SELLER_FRONTEND_BENCHMARKING[] =
     "ENABLE_SELLER_FRONTEND_BENCHMARKING";
 inline constexpr char CREATE_NEW_EVENT_ENGINE[] = "CREATE_NEW_EVENT_ENGINE";
+inline constexpr char ENABLE_CURL_EVENT_LOOP[] = "ENABLE_CURL_EVENT_LOOP";
+inline constexpr char ENABLE_KV_HTTP2_MULTIPLEXING[] =
+    "ENABLE_KV_HTTP2_MULTIPLEXING";
+inline constexpr char ENABLE_KV_REQUEST_COALESCING[] =
+    "ENABLE_KV_REQUEST_COALESCING";
+inline constexpr char ENABLE_KV_POST_REQUESTS[] = "ENABLE_KV_POST_REQUESTS";
+inline constexpr char ENABLE_KV_REQUEST_COMPRESSION[] =
+    "ENABLE_KV_REQUEST_COMPRESSION";
+inline constexpr char KV_MAX_KEYS_PER_REQUEST[] = "KV_MAX_KEYS_PER_REQUEST";
+inline constexpr char KV_BATCH_MAX_KEYS[] = "KV_BATCH_MAX_KEYS";
+inline constexpr char KV_BATCH_MAX_DELAY_US[] = "KV_BATCH_MAX_DELAY_US";
+inline constexpr char ENABLE_KV_TABLE_RESPONSES[] = "ENABLE_KV_TABLE_RESPONSES";
+inline constexpr char ENABLE_KV_REQUEST_HEDGING[] = "ENABLE_KV_REQUEST_HEDGING";
+inline constexpr char KV_HEDGING_LATENCY_PERCENTILE[] =
+    "KV_HEDGING_LATENCY_PERCENTILE";
+inline constexpr char KV_HEDGING_BUDGET_PERCENT[] = "KV_HEDGING_BUDGET_PERCENT";
+inline constexpr char SCORING_SIGNALS_CACHE_TTL_MS[] =
+    "SCORING_SIGNALS_CACHE_TTL_MS";
+inline constexpr char SCORING_SIGNALS_CACHE_MAX_BYTES[] =
+    "SCORING_SIGNALS_CACHE_MAX_BYTES";
+inline constexpr char SCORING_SIGNALS_CACHE_MISS_TTL_MS[] =
+    "SCORING_SIGNALS_CACHE_MISS_TTL_MS";
+inline constexpr char ENABLE_STREAMING_SCORING[] = "ENABLE_STREAMING_SCORING";
+inline constexpr char ENABLE_STREAMED_GET_BIDS[] = "ENABLE_STREAMED_GET_BIDS";
+inline constexpr char SPECULATIVE_SCORING_BUYER_PERCENT[] =
+    "SPECULATIVE_SCORING_BUYER_PERCENT";
+inline constexpr char ENABLE_BUYER_LATENCY_BUDGET[] =
+    "ENABLE_BUYER_LATENCY_BUDGET";
+inline constexpr char BUYER_LATENCY_BUDGET_PERCENTILE[] =
+    "BUYER_LATENCY_BUDGET_PERCENTILE";
+inline constexpr char BUYER_LATENCY_BUDGET_SCORING_RESERVE_MS[] =
+    "BUYER_LATENCY_BUDGET_SCORING_RESERVE_MS";
+inline constexpr char ENABLE_BUYER_CIRCUIT_BREAKER[] =
+    "ENABLE_BUYER_CIRCUIT_BREAKER";
+inline constexpr char BUYER_CIRCUIT_BREAKER_FAILURE_PERCENT[] =
+    "BUYER_CIRCUIT_BREAKER_FAILURE_PERCENT";
+inline constexpr char BUYER_CIRCUIT_BREAKER_OPEN_MS[] =
+    "BUYER_CIRCUIT_BREAKER_OPEN_MS";
 inline constexpr char SFE_INGRESS_TLS[] = "SFE_INGRESS_TLS";
 inline constexpr char SFE_TLS_KEY[] = "SFE_TLS_KEY";
 inline constexpr char SFE_TLS_CERT[] = "SFE_TLS_CERT";
 inline constexpr char AUCTION_EGRESS_TLS[] = "AUCTION_EGRESS_TLS";
 inline constexpr char BUYER_EGRESS_TLS[] = "BUYER_EGRESS_TLS";
+inline constexpr char AUCTION_CHANNEL_POOL_SIZE[] = "AUCTION_CHANNEL_POOL_SIZE";
+inline constexpr char AUCTION_FLOW_CONTROL_WINDOW_BYTES[] =
+    "AUCTION_FLOW_CONTROL_WINDOW_BYTES";
+inline constexpr char AUCTION_LEAST_LOADED_ROUTING[] =
+    "AUCTION_LEAST_LOADED_ROUTING";
+inline constexpr char SHADOW_AUCTION_SERVER_HOST[] =
+    "SHADOW_AUCTION_SERVER_HOST";
+inline constexpr char SHADOW_TRAFFIC_PERCENT[] = "SHADOW_TRAFFIC_PERCENT";
+inline constexpr char BUYER_CHANNEL_POOL_SIZE[] = "BUYER_CHANNEL_POOL_SIZE";
+inline constexpr char BUYER_FLOW_CONTROL_WINDOW_BYTES[] =
+    "BUYER_FLOW_CONTROL_WINDOW_BYTES";
+inline constexpr char REPORTING_THREADS[] = "REPORTING_THREADS";
+inline constexpr char REPORTING_MAX_IN_FLIGHT[] = "REPORTING_MAX_IN_FLIGHT";
+inline constexpr char CPU_EXECUTOR_THREADS[] = "CPU_EXECUTOR_THREADS";
+inline constexpr char DEBUG_LOSS_REPORTS_PER_REQUEST[] =
+    "DEBUG_LOSS_REPORTS_PER_REQUEST";
+inline constexpr char DEBUG_LOSS_REPORTS_PER_SECOND[] =
+    "DEBUG_LOSS_REPORTS_PER_SECOND";
+inline constexpr char DEBUG_LOSS_REPORT_PERCENT[] = "DEBUG_LOSS_REPORT_PERCENT";
+inline constexpr char REQUEST_SHAPE_CAPTURE_PATH[] =
+    "REQUEST_SHAPE_CAPTURE_PATH";
+inline constexpr char BUYER_INPUT_ZSTD_DICTIONARY_PATHS[] =
+    "BUYER_INPUT_ZSTD_DICTIONARY_PATHS";
+inline constexpr char ENABLE_CHANNEL_PRE_WARMING[] =
+    "ENABLE_CHANNEL_PRE_WARMING";
+inline constexpr char CHANNEL_PRE_WARMING_TIMEOUT_MS[] =
+    "CHANNEL_PRE_WARMING_TIMEOUT_MS";
+inline constexpr char FORWARD_COMPRESSED_BUYER_INPUTS[] =
+    "FORWARD_COMPRESSED_BUYER_INPUTS";
 
 inline constexpr absl::string_view kFlags[] = {
     PORT,
@@ -55,13 +126,57 @@ inline constexpr absl::string_view kFlags[] = {
     BUYER_SERVER_HOSTS,
     ENABLE_BUYER_COMPRESSION,
     ENABLE_AUCTION_COMPRESSION,
+    GRPC_COMPRESSION_ALGORITHM,
+    GRPC_COMPRESSION_MIN_MESSAGE_BYTES,
     ENABLE_SELLER_FRONTEND_BENCHMARKING,
     CREATE_NEW_EVENT_ENGINE,
+    ENABLE_CURL_EVENT_LOOP,
+    ENABLE_KV_HTTP2_MULTIPLEXING,
+    ENABLE_KV_REQUEST_COALESCING,
+    ENABLE_KV_POST_REQUESTS,
+    ENABLE_KV_REQUEST_COMPRESSION,
+    KV_MAX_KEYS_PER_REQUEST,
+    KV_BATCH_MAX_KEYS,
+    KV_BATCH_MAX_DELAY_US,
+    ENABLE_KV_TABLE_RESPONSES,
+    ENABLE_KV_REQUEST_HEDGING,
+    KV_HEDGING_LATENCY_PERCENTILE,
+    KV_HEDGING_BUDGET_PERCENT,
+    SCORING_SIGNALS_CACHE_TTL_MS,
+    SCORING_SIGNALS_CACHE_MAX_BYTES,
+    SCORING_SIGNALS_CACHE_MISS_TTL_MS,
+    ENABLE_STREAMING_SCORING,
+    ENABLE_STREAMED_GET_BIDS,
+    SPECULATIVE_SCORING_BUYER_PERCENT,
+    ENABLE_BUYER_LATENCY_BUDGET,
+    BUYER_LATENCY_BUDGET_PERCENTILE,
+    BUYER_LATENCY_BUDGET_SCORING_RESERVE_MS,
+    ENABLE_BUYER_CIRCUIT_BREAKER,
+    BUYER_CIRCUIT_BREAKER_FAILURE_PERCENT,
+    BUYER_CIRCUIT_BREAKER_OPEN_MS,
     SFE_INGRESS_TLS,
     SFE_TLS_KEY,
     SFE_TLS_CERT,
     AUCTION_EGRESS_TLS,
     BUYER_EGRESS_TLS,
+    AUCTION_CHANNEL_POOL_SIZE,
+    AUCTION_FLOW_CONTROL_WINDOW_BYTES,
+    AUCTION_LEAST_LOADED_ROUTING,
+    SHADOW_AUCTION_SERVER_HOST,
+    SHADOW_TRAFFIC_PERCENT,
+    BUYER_CHANNEL_POOL_SIZE,
+    BUYER_FLOW_CONTROL_WINDOW_BYTES,
+    REPORTING_THREADS,
+    REPORTING_MAX_IN_FLIGHT,
+    CPU_EXECUTOR_THREADS,
+    DEBUG_LOSS_REPORTS_PER_REQUEST,
+    DEBUG_LOSS_REPORTS_PER_SECOND,
+    DEBUG_LOSS_REPORT_PERCENT,
+    REQUEST_SHAPE_CAPTURE_PATH,
+    BUYER_INPUT_ZSTD_DICTIONARY_PATHS,
+    ENABLE_CHANNEL_PRE_WARMING,
+    CHANNEL_PRE_WARMING_TIMEOUT_MS,
+    FORWARD_COMPRESSED_BUYER_INPUTS,
 };
 
 inline std::vector<absl::string_view> GetServiceFlags() {
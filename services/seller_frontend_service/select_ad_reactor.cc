@@ -18,12 +18,16 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/flags/flag.h"
+#include "absl/functional/any_invocable.h"
 #include "absl/numeric/bits.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
@@ -33,11 +37,13 @@
 #include "services/common/reporters/async_reporter.h"
 #include "services/common/util/consented_debugging_logger.h"
 #include "services/common/util/reporting_util.h"
+#include "services/common/util/request_deadline.h"
 #include "services/common/util/request_response_constants.h"
+#include "services/seller_frontend_service/util/buyer_metrics.h"
+#include "services/seller_frontend_service/util/request_shape.h"
 #include "services/seller_frontend_service/util/web_utils.h"
 #include "src/cpp/communication/ohttp_utils.h"
 #include "src/cpp/encryption/key_fetcher/src/key_fetcher_manager.h"
-#include "src/cpp/telemetry/telemetry.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 namespace {
@@ -54,6 +60,11 @@ using ErrorVisibility::CLIENT_VISIBLE;
 
 }  // namespace
 
+RequestClass RequestClassOf(const SelectAdRequest& request) {
+  return RequestClassOf(request.auction_config().request_priority(),
+                        request.client_type() != SelectAdRequest::UNKNOWN);
+}
+
 SelectAdReactor::SelectAdReactor(
     grpc::CallbackServerContext* context, const SelectAdRequest* request,
     SelectAdResponse* response, const ClientRegistry& clients,
@@ -66,13 +77,33 @@ SelectAdReactor::SelectAdReactor(
       // TODO(b/278039901): Add integration test for metadata forwarding.
       buyer_metadata_(GrpcMetadataToRequestMetadata(context->client_metadata(),
                                                     kBuyerMetadataKeysMap)),
+      request_class_(RequestClassOf(*request)),
       error_accumulator_(&logger_),
       fail_fast_(fail_fast),
       bid_stats_(request->auction_config().buyer_list_size(), logger_,
                  [this](bool successful) { OnAllBidsDone(successful); }),
       is_protected_auction_request_(false),
       is_pas_enabled_(
-          config_client_.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS)) {
+          config_client_.GetBooleanParameter(ENABLE_PROTECTED_APP_SIGNALS)),
+      is_streaming_scoring_enabled_(
+          config_client_.GetBooleanParameter(ENABLE_STREAMING_SCORING) &&
+          request->auction_config().buyer_list_size() > 1),
+      is_streamed_get_bids_enabled_(
+          is_streaming_scoring_enabled_ &&
+          config_client_.GetBooleanParameter(ENABLE_STREAMED_GET_BIDS)),
+      speculative_scoring_buyer_percent_(
+          is_streaming_scoring_enabled_ ||
+                  request->auction_config().buyer_list_size() <= 1
+              ? 0
+              : std::clamp(config_client_.GetIntParameter(
+                               SPECULATIVE_SCORING_BUYER_PERCENT),
+                           0, 100)),
+      forward_compressed_buyer_inputs_(
+          config_client_.GetBooleanParameter(FORWARD_COMPRESSED_BUYER_INPUTS) &&
+          clients.request_shape_recorder == nullptr) {
+  AddRequestClass(request_class_, buyer_metadata_);
+  memory_budget_.SetBudget(
+      int64_t{config_client_.GetIntParameter(REQUEST_MEMORY_BUDGET_MB)} << 20);
   if (config_client_.GetBooleanParameter(ENABLE_SELLER_FRONTEND_BENCHMARKING)) {
     benchmarking_logger_ =
         std::make_unique<BuildInputProcessResponseBenchmarkingLogger>(
@@ -88,27 +119,28 @@ SelectAdReactor::SelectAdReactor(
 }
 
 AdWithBidMetadata SelectAdReactor::BuildAdWithBidMetadata(
-    const AdWithBid& input, absl::string_view interest_group_owner) {
+    AdWithBid& input, absl::string_view interest_group_owner) {
   AdWithBidMetadata result;
   if (input.has_ad()) {
-    *result.mutable_ad() = input.ad();
+    result.mutable_ad()->Swap(input.mutable_ad());
   }
+  result.set_ad_metadata_json(std::move(*input.mutable_ad_metadata_json()));
   result.set_bid(input.bid());
-  result.set_render(input.render());
+  result.set_render(std::move(*input.mutable_render()));
   result.set_allow_component_auction(input.allow_component_auction());
-  result.mutable_ad_components()->CopyFrom(input.ad_components());
+  result.mutable_ad_components()->Swap(input.mutable_ad_components());
   result.set_interest_group_name(input.interest_group_name());
   result.set_interest_group_owner(interest_group_owner);
   result.set_ad_cost(input.ad_cost());
   result.set_modeling_signals(input.modeling_signals());
-  const BuyerInput& buyer_input =
-      buyer_inputs_->find(interest_group_owner)->second;
-  for (const auto& interest_group : buyer_input.interest_groups()) {
-    if (std::strcmp(interest_group.name().c_str(),
+  const std::vector<InterestGroupSummary>& interest_groups =
+      interest_group_summaries_.find(interest_group_owner)->second;
+  for (const InterestGroupSummary& interest_group : interest_groups) {
+    if (std::strcmp(interest_group.name.c_str(),
                     result.interest_group_name().c_str())) {
       if (request_->client_type() == SelectAdRequest::BROWSER) {
-        result.set_join_count(interest_group.browser_signals().join_count());
-        result.set_recency(interest_group.browser_signals().recency());
+        result.set_join_count(interest_group.join_count);
+        result.set_recency(interest_group.recency);
       }
       break;
     }
@@ -136,6 +168,7 @@ void SelectAdReactor::MayPopulateClientVisibleErrors() {
 }
 
 bool SelectAdReactor::DecryptRequest() {
+  const absl::Duration decrypt_cpu_start = ThreadCpuTime();
   if (request_->protected_auction_ciphertext().empty() &&
       request_->protected_audience_ciphertext().empty()) {
     Finish(grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
@@ -180,9 +213,22 @@ bool SelectAdReactor::DecryptRequest() {
 
   logger_.vlog(3, "Private Key Id: ", private_key->key_id,
                ", Key Hex: ", absl::BytesToHexString(private_key->private_key));
-  // Decrypt the ciphertext.
-  absl::StatusOr<quiche::ObliviousHttpRequest> ohttp_request =
-      server_common::DecryptEncapsulatedRequest(*private_key, encapsulated_req);
+  // Decrypt the ciphertext, with the cached gateway of the key if any.
+  const quiche::ObliviousHttpGateway* gateway = nullptr;
+  absl::StatusOr<quiche::ObliviousHttpRequest> ohttp_request;
+  if (clients_.ohttp_gateway_cache != nullptr) {
+    absl::StatusOr<const quiche::ObliviousHttpGateway*> cached_gateway =
+        clients_.ohttp_gateway_cache->Get(*key_id, *private_key);
+    if (cached_gateway.ok()) {
+      gateway = *cached_gateway;
+      ohttp_request = gateway->DecryptObliviousHttpRequest(encapsulated_req);
+    } else {
+      ohttp_request = cached_gateway.status();
+    }
+  } else {
+    ohttp_request = server_common::DecryptEncapsulatedRequest(
+        *private_key, encapsulated_req);
+  }
   if (!ohttp_request.ok()) {
     logger_.vlog(2, "Unable to decrypt the ciphertext. Reason: ",
                  ohttp_request.status().message());
@@ -201,7 +247,7 @@ bool SelectAdReactor::DecryptRequest() {
       str_key_id,
       std::make_unique<quiche::ObliviousHttpRequest::Context>(
           std::move(ohttp_context)),
-      *private_key};
+      *private_key, gateway};
   request_context_ = std::move(request);
   if (is_protected_auction_request_) {
     protected_auction_input_ =
@@ -216,9 +262,44 @@ bool SelectAdReactor::DecryptRequest() {
             GetDecodedBuyerinputs(protected_auction_input.buyer_input());
       },
       protected_auction_input_);
+  if (memory_budget_.enabled()) {
+    int64_t decoded_bytes = ohttp_request->GetPlaintextData().size();
+    if (buyer_inputs_.ok()) {
+      for (const auto& [buyer, buyer_input] : *buyer_inputs_) {
+        decoded_bytes += buyer_input.ByteSizeLong();
+      }
+    }
+    if (!memory_budget_.Charge(decoded_bytes)) {
+      logger_.vlog(1, kRequestMemoryBudgetExceeded);
+      RecordMemoryBudgetExceeded(MemoryBudgetAction::kRejected);
+      Finish(grpc::Status(grpc::StatusCode::RESOURCE_EXHAUSTED,
+                          kRequestMemoryBudgetExceeded));
+      return false;
+    }
+  }
+  cpu_time_.AddSince(CpuStage::kDecrypt, decrypt_cpu_start);
   return true;
 }
 
+void SelectAdReactor::StartTrace(absl::Time start, absl::Time decrypt_end) {
+  const server_common::BuildDependentConfig& telemetry_config =
+      metric::SfeContextMap()->metric_config();
+  if (!telemetry_config.TraceAllowed()) {
+    return;
+  }
+  bool is_consented = false;
+  std::visit(
+      [&is_consented](const auto& protected_auction_input) {
+        is_consented =
+            protected_auction_input.has_consented_debug_config() &&
+            protected_auction_input.consented_debug_config().is_consented();
+      },
+      protected_auction_input_);
+  tracer_ = RequestTracer::ForHead(
+      "SelectAd", telemetry_config.trace_sample_rate(), is_consented, start);
+  tracer_.AddSpan("DecryptRequest", start, decrypt_end);
+}
+
 ContextLogger::ContextMap SelectAdReactor::GetLoggingContext() {
   ContextLogger::ContextMap context_map;
   std::visit(
@@ -291,7 +372,7 @@ void SelectAdReactor::MayLogBuyerInput() {
   } else if (VLOG_IS_ON(6)) {
     for (const auto& [buyer, buyer_input] : *buyer_inputs_) {
       logger_.vlog(6, "Decoded buyer input for buyer: ", buyer,
-                   " is: ", buyer_input.DebugString());
+                   " is: ", DebugStringOf(buyer_input));
     }
   }
 }
@@ -300,10 +381,15 @@ void SelectAdReactor::Execute() {
   if (!config_client_.GetBooleanParameter(ENABLE_ENCRYPTION)) {
     LOG(DFATAL) << "Expected encryption to be enabled";
   }
+  const absl::Time start = absl::Now();
   if (!DecryptRequest()) {
     VLOG(1) << "SelectAdRequest decryption failed";
     return;
   }
+  const absl::Time decrypt_end = absl::Now();
+  timeline_.Record(RequestStage::kDecrypt, start, decrypt_end);
+  StartTrace(start, decrypt_end);
+  const absl::Duration prepare_cpu_start = ThreadCpuTime();
   logger_.Configure(GetLoggingContext());
   MayLogBuyerInput();
   MayPopulateAdServerVisibleErrors();
@@ -337,9 +423,11 @@ void SelectAdReactor::Execute() {
     return;
   }
   logger_.vlog(1, "No client / Adtech server errors found");
+  if (clients_.request_shape_recorder != nullptr) {
+    clients_.request_shape_recorder->Record(
+        GetRequestShape(request_->auction_config(), *buyer_inputs_));
+  }
 
-  auto span = server_common::GetTracer()->StartSpan("SelectAdReactor_Execute");
-  auto scope = opentelemetry::trace::Scope(span);
   // Logger for consented debugging.
   // TODO(b/279955398): Move the object to a member variable.
   if (config_client_.GetBooleanParameter(ENABLE_OTEL_BASED_LOGGING)) {
@@ -349,21 +437,19 @@ void SelectAdReactor::Execute() {
       ConsentedDebuggingLogger debug_logger(GetLoggingContext(), token);
       std::visit(
           [&debug_logger](const auto& protected_auction_input) {
-            debug_logger.vlog(
-                0, absl::StrCat("ProtectedAudienceInput: ",
-                                protected_auction_input.DebugString()));
+            debug_logger.LogMessage(0, "ProtectedAudienceInput: ",
+                                    protected_auction_input);
           },
           protected_auction_input_);
       if (!buyer_inputs_.ok()) {
-        debug_logger.vlog(
-            0, absl::StrCat("Failed to decode buyer inputs. Reason: ",
-                            buyer_inputs_.status().ToString()));
+        debug_logger.vlog(0, "Failed to decode buyer inputs. Reason: ",
+                          buyer_inputs_.status());
       } else if (buyer_inputs_->empty()) {
         debug_logger.vlog(0, "buyer inputs are missing.");
       } else {
         for (const auto& [buyer, buyer_input] : *buyer_inputs_) {
-          debug_logger.vlog(0, absl::StrCat("buyer_input[", buyer,
-                                            "]: ", buyer_input.DebugString()));
+          debug_logger.LogMessage(
+              0, absl::StrCat("buyer_input[", buyer, "]: "), buyer_input);
         }
       }
     }
@@ -373,28 +459,65 @@ void SelectAdReactor::Execute() {
 
   logger_.vlog(
       6, "Buyer list size: ", request_->auction_config().buyer_list().size());
+  std::vector<std::pair<const std::string*, BuyerInput*>> buyers;
   for (const std::string& buyer_ig_owner :
        request_->auction_config().buyer_list()) {
     const auto& buyer_input_iterator = buyer_inputs_->find(buyer_ig_owner);
-    if (buyer_input_iterator != buyer_inputs_->end()) {
-      FetchBid(buyer_ig_owner, buyer_input_iterator->second,
-               request_->auction_config().seller());
-    } else {
+    if (buyer_input_iterator == buyer_inputs_->end()) {
       logger_.vlog(2, "No buyer input found for buyer: ", buyer_ig_owner);
 
       // Pending bids count is set on reactor construction to buyer_list_size().
       // If no BuyerInput is found for a buyer in buyer_list, must decrement
       // pending bids count.
       bid_stats_.BidCompleted(CompletedBidState::SKIPPED);
+      continue;
     }
+    // The inputs are summarized here, before the fetches move them away in
+    // parallel. The input of a buyer listed twice is only sent once.
+    auto [summaries_itr, inserted] =
+        interest_group_summaries_.try_emplace(buyer_input_iterator->first);
+    if (!inserted) {
+      logger_.vlog(2, "Duplicate buyer in buyer list: ", buyer_ig_owner);
+      bid_stats_.BidCompleted(CompletedBidState::SKIPPED);
+      continue;
+    }
+    const BuyerInput& buyer_input = buyer_input_iterator->second;
+    summaries_itr->second.reserve(buyer_input.interest_groups_size());
+    for (const auto& interest_group : buyer_input.interest_groups()) {
+      summaries_itr->second.push_back(
+          {.name = interest_group.name(),
+           .join_count = interest_group.browser_signals().join_count(),
+           .recency = interest_group.browser_signals().recency()});
+    }
+    buyers.emplace_back(&buyer_ig_owner, &buyer_input_iterator->second);
   }
   logger_.vlog(5, "Finishing execute call, response may be available later");
+  cpu_time_.AddSince(CpuStage::kPrepare, prepare_cpu_start);
+
+  // The executor fetches the bids of all the buyers but the first one, which
+  // is fetched on this thread meanwhile, so that the GetBids requests are
+  // serialized and encrypted in parallel and each one is sent as soon as its
+  // ciphertext is ready.
+  const absl::string_view seller = request_->auction_config().seller();
+  for (int i = 1; i < buyers.size(); ++i) {
+    const auto& [buyer_ig_owner, buyer_input] = buyers[i];
+    if (clients_.executor != nullptr) {
+      clients_.executor->Run(
+          [this, buyer_ig_owner = buyer_ig_owner, buyer_input = buyer_input,
+           seller]() { FetchBid(*buyer_ig_owner, *buyer_input, seller); });
+    } else {
+      FetchBid(*buyer_ig_owner, *buyer_input, seller);
+    }
+  }
+  if (!buyers.empty()) {
+    FetchBid(*buyers[0].first, *buyers[0].second, seller);
+  }
 }
 
 std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
 SelectAdReactor::CreateGetBidsRequest(absl::string_view seller,
                                       const std::string& buyer_ig_owner,
-                                      const BuyerInput& buyer_input) {
+                                      BuyerInput buyer_input) {
   auto get_bids_request = std::make_unique<GetBidsRequest::GetBidsRawRequest>();
   get_bids_request->set_is_chaff(false);
   get_bids_request->set_seller(seller);
@@ -411,7 +534,7 @@ SelectAdReactor::CreateGetBidsRequest(absl::string_view seller,
           per_buyer_config_itr->second.buyer_signals());
     }
   }
-  *get_bids_request->mutable_buyer_input() = buyer_input;
+  *get_bids_request->mutable_buyer_input() = std::move(buyer_input);
   std::visit(
       [&get_bids_request,
        &buyer_debug_id](const auto& protected_auction_input) {
@@ -432,15 +555,21 @@ SelectAdReactor::CreateGetBidsRequest(absl::string_view seller,
 }
 
 void SelectAdReactor::FetchBid(const std::string& buyer_ig_owner,
-                               const BuyerInput& buyer_input,
+                               BuyerInput& buyer_input,
                                absl::string_view seller) {
-  auto scope = opentelemetry::trace::Scope(
-      server_common::GetTracer()->StartSpan("FetchBid"));
+  const absl::Duration prepare_cpu_start = ThreadCpuTime();
   auto buyer_client = clients_.buyer_factory.Get(buyer_ig_owner);
   if (buyer_client == nullptr) {
     logger_.vlog(2, "No buyer client found for buyer: ", buyer_ig_owner);
     bid_stats_.BidCompleted(CompletedBidState::SKIPPED);
   } else {
+    RequestTracer::SpanPtr span = tracer_.StartSpan("FetchBid");
+    // The metadata is only copied for a sampled request.
+    RequestMetadata traced_metadata;
+    if (tracer_.sampled()) {
+      traced_metadata = buyer_metadata_;
+      tracer_.AddTraceParent(span, traced_metadata);
+    }
     VLOG(6) << "Getting bid from a BFE";
     absl::Duration timeout = absl::Milliseconds(
         config_client_.GetIntParameter(GET_BID_RPC_TIMEOUT_MS));
@@ -448,22 +577,75 @@ void SelectAdReactor::FetchBid(const std::string& buyer_ig_owner,
       timeout =
           absl::Milliseconds(request_->auction_config().buyer_timeout_ms());
     }
+    const absl::Time deadline = GetRequestDeadline(*context_);
+    if (clients_.buyer_latency_budget != nullptr) {
+      // A late buyer fails its call, and the auction goes on with the bids of
+      // the other buyers.
+      timeout = clients_.buyer_latency_budget->GetTimeout(buyer_ig_owner,
+                                                          timeout, deadline);
+    }
+    timeout = TimeoutWithinDeadline(timeout, deadline);
+    if (timeout <= absl::ZeroDuration()) {
+      logger_.vlog(1, "No time left to get bids from buyer: ", buyer_ig_owner);
+      RequestTracer::EndSpan(span);
+      bid_stats_.BidCompleted(CompletedBidState::SKIPPED);
+      return;
+    }
     auto get_bids_request =
-        CreateGetBidsRequest(seller, buyer_ig_owner, buyer_input);
+        CreateGetBidsRequest(seller, buyer_ig_owner, std::move(buyer_input));
+    // The call may finish the request before it returns.
+    cpu_time_.AddSince(CpuStage::kPrepare, prepare_cpu_start);
     auto bfe_request =
         metric::MakeInitiatedRequest(metric::kBfe, metric_context_.get(), 0);
-    absl::Status execute_result = buyer_client->ExecuteInternal(
-        std::move(get_bids_request), buyer_metadata_,
-        [buyer_ig_owner, this, bfe_request = std::move(bfe_request)](
-            absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>
-                response) mutable {
-          {  // destruct bfe_request, destructor measures request time
-            auto not_used = std::move(bfe_request);
-          }
-          VLOG(6) << "Received a bid response from a BFE";
-          OnFetchBidsDone(std::move(response), buyer_ig_owner);
-        },
-        timeout);
+    const RequestMetadata& metadata =
+        tracer_.sampled() ? traced_metadata : buyer_metadata_;
+    absl::Status execute_result;
+    if (is_streamed_get_bids_enabled_) {
+      // Shared by the callbacks of the call, which run one at a time.
+      auto streamed_bids = std::make_shared<StreamedBids>();
+      execute_result = buyer_client->ExecuteStreamingInternal(
+          std::move(get_bids_request), metadata,
+          [buyer_ig_owner, this, streamed_bids](
+              std::unique_ptr<GetBidsResponse::GetBidsRawResponse> chunk) {
+            OnFetchBidsChunk(buyer_ig_owner, std::move(chunk), *streamed_bids);
+          },
+          [buyer_ig_owner, this, streamed_bids,
+           bfe_request = std::move(bfe_request), span = std::move(span),
+           start = absl::Now()](absl::Status status) mutable {
+            {  // destruct bfe_request, destructor measures request time
+              auto not_used = std::move(bfe_request);
+            }
+            RequestTracer::EndSpan(span);
+            timeline_.Record(RequestStage::kFanOut, start, absl::Now());
+            RecordBuyerMetrics(buyer_ig_owner, absl::Now() - start, status,
+                               streamed_bids->num_bids,
+                               streamed_bids->response_size);
+            OnStreamedBidsDone(buyer_ig_owner, status, *streamed_bids);
+          },
+          timeout, &buyer_crypto_metrics_, &cancellation_);
+    } else {
+      execute_result = buyer_client->ExecuteInternal(
+          std::move(get_bids_request), metadata,
+          [buyer_ig_owner, this, bfe_request = std::move(bfe_request),
+           span = std::move(span), start = absl::Now()](
+              absl::StatusOr<
+                  std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>
+                  response) mutable {
+            {  // destruct bfe_request, destructor measures request time
+              auto not_used = std::move(bfe_request);
+            }
+            RequestTracer::EndSpan(span);
+            timeline_.Record(RequestStage::kFanOut, start, absl::Now());
+            VLOG(6) << "Received a bid response from a BFE";
+            RecordBuyerMetrics(
+                buyer_ig_owner, absl::Now() - start, response.status(),
+                response.ok() ? (*response)->bids_size() : 0,
+                response.ok() ? static_cast<int>((*response)->ByteSizeLong())
+                              : 0);
+            OnFetchBidsDone(std::move(response), buyer_ig_owner);
+          },
+          timeout, &buyer_crypto_metrics_, &cancellation_);
+    }
     if (!execute_result.ok()) {
       logger_.error(
           absl::StrFormat("Failed to make async GetBids call: (buyer: %s, "
@@ -475,6 +657,34 @@ void SelectAdReactor::FetchBid(const std::string& buyer_ig_owner,
   }
 }
 
+void SelectAdReactor::RecordBuyerMetrics(const std::string& buyer_ig_owner,
+                                         absl::Duration latency,
+                                         const absl::Status& status,
+                                         int num_bids, int response_size) {
+  LogIfError(
+      metric_context_->AccumulateMetric<metric::kSfeBuyerGetBidsLatencyCount>(
+          1, BuyerLatencyPartition(buyer_ig_owner, latency)));
+  if (status.ok()) {
+    LogIfError(metric_context_->AccumulateMetric<metric::kSfeBuyerBidCount>(
+        num_bids, buyer_ig_owner));
+    LogIfError(
+        metric_context_->AccumulateMetric<metric::kSfeBuyerResponseSize>(
+            response_size, buyer_ig_owner));
+  }
+  if (clients_.buyer_latency_budget != nullptr) {
+    const bool timed_out =
+        status.code() == absl::StatusCode::kDeadlineExceeded;
+    clients_.buyer_latency_budget->RecordGetBids(buyer_ig_owner, latency,
+                                                 timed_out);
+    if (timed_out) {
+      logger_.vlog(1, "Scoring without the bids of late buyer ",
+                   buyer_ig_owner);
+    }
+  }
+  absl::MutexLock lock(&critical_path_mu_);
+  critical_path_buyer_ = buyer_ig_owner;
+}
+
 void SelectAdReactor::OnFetchBidsDone(
     absl::StatusOr<std::unique_ptr<GetBidsResponse::GetBidsRawResponse>>
         response,
@@ -482,13 +692,30 @@ void SelectAdReactor::OnFetchBidsDone(
   VLOG(5) << "Received response from a BFE ... ";
   if (response.ok()) {
     auto& found_response = *response;
-    logger_.vlog(2, "\nGetBidsResponse:\n", found_response->DebugString());
-    if (found_response->bids().empty() &&
+    logger_.vlog(2, "\nGetBidsResponse:\n", DebugStringOf(*found_response));
+    const bool empty =
+        found_response->bids().empty() &&
         (!is_pas_enabled_ ||
-         found_response->protected_app_signals_bids().empty())) {
-      logger_.vlog(2, "Skipping buyer ", buyer_ig_owner,
-                   " due to empty GetBidsResponse.");
+         found_response->protected_app_signals_bids().empty());
+    if (empty || !ChargeBids(buyer_ig_owner, *found_response)) {
+      if (empty) {
+        logger_.vlog(2, "Skipping buyer ", buyer_ig_owner,
+                     " due to empty GetBidsResponse.");
+      }
+      if (speculative_scoring_buyer_percent_ > 0) {
+        OnSpeculativeBuyerDone(buyer_ig_owner, nullptr);
+      }
       bid_stats_.BidCompleted(CompletedBidState::EMPTY_RESPONSE);
+    } else if (is_streaming_scoring_enabled_) {
+      // The wave is counted before the bid completes, so that the scoring
+      // waits for it.
+      StartScoringWave(buyer_ig_owner, *std::move(response));
+      bid_stats_.BidCompleted(CompletedBidState::SUCCESS);
+    } else if (speculative_scoring_buyer_percent_ > 0) {
+      // The bids are held before the bid completes, so that the last wave
+      // takes them.
+      OnSpeculativeBuyerDone(buyer_ig_owner, *std::move(response));
+      bid_stats_.BidCompleted(CompletedBidState::SUCCESS);
     } else {
       bid_stats_.BidCompleted(
           CompletedBidState::SUCCESS,
@@ -502,15 +729,111 @@ void SelectAdReactor::OnFetchBidsDone(
                server_common::metric::kInitiatedRequestErrorCount>(1));
     logger_.vlog(1, "GetBidsRequest failed for buyer ", buyer_ig_owner,
                  "\nresponse status: ", response.status());
+    if (speculative_scoring_buyer_percent_ > 0) {
+      OnSpeculativeBuyerDone(buyer_ig_owner, nullptr);
+    }
+    bid_stats_.BidCompleted(CompletedBidState::ERROR);
+  }
+}
+
+void SelectAdReactor::OnFetchBidsChunk(
+    const std::string& buyer_ig_owner,
+    std::unique_ptr<GetBidsResponse::GetBidsRawResponse> chunk,
+    StreamedBids& streamed_bids) {
+  logger_.vlog(2, "\nGetBidsResponse chunk:\n", DebugStringOf(*chunk));
+  streamed_bids.num_bids += chunk->bids_size();
+  streamed_bids.response_size += static_cast<int>(chunk->ByteSizeLong());
+  if ((chunk->bids().empty() &&
+       (!is_pas_enabled_ || chunk->protected_app_signals_bids().empty())) ||
+      !ChargeBids(buyer_ig_owner, *chunk)) {
+    return;
+  }
+  streamed_bids.scored = true;
+  // The wave is counted before the bid completes, so that the scoring waits
+  // for it.
+  StartScoringWave(buyer_ig_owner, std::move(chunk));
+}
+
+bool SelectAdReactor::ChargeBids(
+    const std::string& buyer_ig_owner,
+    const GetBidsResponse::GetBidsRawResponse& bids) {
+  if (!memory_budget_.enabled() ||
+      memory_budget_.TryCharge(bids.ByteSizeLong())) {
+    return true;
+  }
+  logger_.vlog(1, "Bids of buyer ", buyer_ig_owner,
+               " over the memory budget of the request, skipping them");
+  RecordMemoryBudgetExceeded(MemoryBudgetAction::kTrimmed);
+  return false;
+}
+
+void SelectAdReactor::OnStreamedBidsDone(const std::string& buyer_ig_owner,
+                                         const absl::Status& status,
+                                         const StreamedBids& streamed_bids) {
+  if (!status.ok()) {
+    LogIfError(metric_context_->AccumulateMetric<
+               server_common::metric::kInitiatedRequestErrorCount>(1));
+    logger_.vlog(1, "GetBidsStream failed for buyer ", buyer_ig_owner,
+                 "\nresponse status: ", status);
+  }
+  if (streamed_bids.scored) {
+    // The bids that arrived before a failure are scored all the same.
+    bid_stats_.BidCompleted(CompletedBidState::SUCCESS);
+  } else if (status.ok()) {
+    logger_.vlog(2, "Skipping buyer ", buyer_ig_owner,
+                 " due to empty GetBidsResponse.");
+    bid_stats_.BidCompleted(CompletedBidState::EMPTY_RESPONSE);
+  } else {
     bid_stats_.BidCompleted(CompletedBidState::ERROR);
   }
 }
 
 void SelectAdReactor::OnAllBidsDone(bool any_successful_bids) {
+  {
+    absl::MutexLock lock(&critical_path_mu_);
+    if (!critical_path_buyer_.empty()) {
+      LogIfError(
+          metric_context_->AccumulateMetric<metric::kSfeBuyerCriticalPathCount>(
+              1, critical_path_buyer_));
+    }
+  }
+  if (is_streaming_scoring_enabled_ || speculative_scoring_buyer_percent_ > 0) {
+    std::unique_ptr<BuyerBidsResponseMap> last_wave_bids;
+    bool all_scoring_waves_done;
+    {
+      absl::MutexLock lock(&scoring_waves_mu_);
+      any_successful_bids_ = any_successful_bids;
+      if (!unscored_bids_.empty()) {
+        last_wave_bids =
+            std::make_unique<BuyerBidsResponseMap>(std::move(unscored_bids_));
+        unscored_bids_.clear();
+        ++pending_scoring_waves_;
+      }
+      all_scoring_waves_done = pending_scoring_waves_ == 0;
+    }
+    if (last_wave_bids != nullptr) {
+      ScoreWave(std::move(last_wave_bids));
+    } else if (all_scoring_waves_done) {
+      OnAllScoringWavesDone();
+    }
+    return;
+  }
+
+  if (MayFinishWithoutScoring(any_successful_bids)) {
+    return;
+  }
+  FetchScoringSignals(
+      shared_buyer_bids_map_,
+      [this](absl::StatusOr<std::unique_ptr<ScoringSignals>> result) {
+        OnFetchScoringSignalsDone(std::move(result));
+      });
+}
+
+bool SelectAdReactor::MayFinishWithoutScoring(bool any_successful_bids) {
   if (this->context_->IsCancelled()) {
     // Early return if request is cancelled. DO NOT move to next step.
     FinishWithAborted();
-    return;
+    return true;
   }
 
   // No successful bids received.
@@ -519,29 +842,35 @@ void SelectAdReactor::OnAllBidsDone(bool any_successful_bids) {
     if (!any_successful_bids) {
       logger_.vlog(3, "Finishing the SelectAdRequest RPC with an error");
       FinishWithInternalError(kInternalError);
-      return;
+      return true;
     }
     // Since no buyers have returned bids, we would still finish the call RPC
     // call here and send a chaff back.
     OnScoreAdsDone(std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>());
-    return;
+    return true;
   }
-  FetchScoringSignals();
+  return false;
 }
 
-void SelectAdReactor::FetchScoringSignals() {
-  ScoringSignalsRequest scoring_signals_request(shared_buyer_bids_map_,
-                                                buyer_metadata_);
+void SelectAdReactor::FetchScoringSignals(
+    const BuyerBidsResponseMap& buyer_bids,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<ScoringSignals>>) &&>
+        on_done) {
+  ScoringSignalsRequest scoring_signals_request(buyer_bids, buyer_metadata_);
   auto kv_request =
       metric::MakeInitiatedRequest(metric::kKv, metric_context_.get(), 0);
   clients_.scoring_signals_async_provider.Get(
       scoring_signals_request,
-      [this, kv_request = std::move(kv_request)](
+      [this, kv_request = std::move(kv_request),
+       span = tracer_.StartSpan("FetchScoringSignals"),
+       on_done = std::move(on_done), kv_start = absl::Now()](
           absl::StatusOr<std::unique_ptr<ScoringSignals>> result) mutable {
         {  // destruct kv_request, destructor measures request time
           auto not_used = std::move(kv_request);
         }
-        OnFetchScoringSignalsDone(std::move(result));
+        RequestTracer::EndSpan(span);
+        timeline_.Record(RequestStage::kKeyValue, kv_start, absl::Now());
+        std::move(on_done)(std::move(result));
       },
       absl::Milliseconds(config_client_.GetIntParameter(
           KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS)));
@@ -562,23 +891,27 @@ void SelectAdReactor::OnFetchScoringSignalsDone(
 }
 
 std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
-SelectAdReactor::CreateScoreAdsRequest() {
+SelectAdReactor::CreateScoreAdsRequest(
+    BuyerBidsResponseMap& buyer_bids,
+    std::unique_ptr<ScoringSignals> scoring_signals) {
   auto raw_request = std::make_unique<ScoreAdsRequest::ScoreAdsRawRequest>();
-  for (const auto& [buyer, get_bid_response] : shared_buyer_bids_map_) {
-    for (int i = 0; i < get_bid_response->bids_size(); i++) {
-      AdWithBidMetadata ad_with_bid_metadata =
-          BuildAdWithBidMetadata(get_bid_response->bids().at(i), buyer);
-      raw_request->mutable_ad_bids()->Add(std::move(ad_with_bid_metadata));
+  int bids_size = 0;
+  for (const auto& [buyer, get_bid_response] : buyer_bids) {
+    bids_size += get_bid_response->bids_size();
+  }
+  raw_request->mutable_ad_bids()->Reserve(bids_size);
+  for (auto& [buyer, get_bid_response] : buyer_bids) {
+    for (AdWithBid& ad_with_bid : *get_bid_response->mutable_bids()) {
+      *raw_request->add_ad_bids() = BuildAdWithBidMetadata(ad_with_bid, buyer);
     }
   }
   *raw_request->mutable_auction_signals() =
       request_->auction_config().auction_signals();
   *raw_request->mutable_seller_signals() =
       request_->auction_config().seller_signals();
-  if (scoring_signals_ != nullptr) {
-    // Ad scoring signals cannot be used after this.
+  if (scoring_signals != nullptr) {
     raw_request->set_allocated_scoring_signals(
-        scoring_signals_->scoring_signals.release());
+        scoring_signals->scoring_signals.release());
   }
   std::visit(
       [&raw_request, this](const auto& protected_auction_input) {
@@ -602,33 +935,230 @@ SelectAdReactor::CreateScoreAdsRequest() {
     raw_request->mutable_per_buyer_signals()->try_emplace(
         buyer, per_buyer_config.buyer_signals());
   }
+  raw_request->set_score_ad_version(
+      request_->auction_config().code_experiment_spec().score_ad_version());
   return raw_request;
 }
 
 void SelectAdReactor::ScoreAds() {
-  auto raw_request = CreateScoreAdsRequest();
-  logger_.vlog(2, "\nScoreAdsRawRequest:\n", raw_request->DebugString());
+  // Ad scoring signals cannot be used after this.
+  absl::Status execute_result = ScoreAds(
+      shared_buyer_bids_map_, std::move(scoring_signals_),
+      [this](absl::StatusOr<
+             std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
+                 result) { OnScoreAdsDone(std::move(result)); });
+  if (absl::IsDeadlineExceeded(execute_result)) {
+    Finish(grpc::Status(grpc::DEADLINE_EXCEEDED,
+                        std::string(execute_result.message())));
+  } else if (!execute_result.ok()) {
+    Finish(grpc::Status(grpc::INTERNAL, kInternalServerError));
+  }
+}
+
+absl::Status SelectAdReactor::ScoreAds(
+    BuyerBidsResponseMap& buyer_bids,
+    std::unique_ptr<ScoringSignals> scoring_signals,
+    absl::AnyInvocable<
+        void(absl::StatusOr<
+             std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>) &&>
+        on_done) {
+  // The call is not worth making when its response would come after the
+  // client stopped waiting for this one.
+  const absl::Duration timeout = TimeoutWithinDeadline(
+      absl::Milliseconds(
+          config_client_.GetIntParameter(SCORE_ADS_RPC_TIMEOUT_MS)),
+      GetRequestDeadline(*context_));
+  if (timeout <= absl::ZeroDuration()) {
+    return absl::DeadlineExceededError(kDeadlineExceededBeforeCall);
+  }
+  const absl::Duration prepare_cpu_start = ThreadCpuTime();
+  auto raw_request =
+      CreateScoreAdsRequest(buyer_bids, std::move(scoring_signals));
+  logger_.vlog(2, "\nScoreAdsRawRequest:\n", DebugStringOf(*raw_request));
+  cpu_time_.AddSince(CpuStage::kPrepare, prepare_cpu_start);
   auto auction_request = metric::MakeInitiatedRequest(
       metric::kAs, metric_context_.get(), raw_request->ByteSizeLong());
+  RequestTracer::SpanPtr span = tracer_.StartSpan("ScoreAds");
+  RequestMetadata metadata;
+  tracer_.AddTraceParent(span, metadata);
+  AddRequestClass(request_class_, metadata);
   auto on_scoring_done =
-      [this, auction_request = std::move(auction_request)](
+      [this, auction_request = std::move(auction_request),
+       span = std::move(span), on_done = std::move(on_done),
+       scoring_start = absl::Now()](
           absl::StatusOr<std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
               result) mutable {
         {  // destruct auction_request, destructor measures request time
           auto not_used = std::move(auction_request);
         }
-        OnScoreAdsDone(std::move(result));
+        RequestTracer::EndSpan(span);
+        timeline_.Record(RequestStage::kFanOut, scoring_start, absl::Now());
+        std::move(on_done)(std::move(result));
       };
   absl::Status execute_result = clients_.scoring.ExecuteInternal(
-      std::move(raw_request), {}, std::move(on_scoring_done),
-      absl::Milliseconds(
-          config_client_.GetIntParameter(SCORE_ADS_RPC_TIMEOUT_MS)));
+      std::move(raw_request), metadata, std::move(on_scoring_done), timeout,
+      &auction_crypto_metrics_, &cancellation_);
   if (!execute_result.ok()) {
     logger_.error(
         absl::StrFormat("Failed to make async ScoreAds call: (error: %s)",
                         execute_result.ToString()));
-    Finish(grpc::Status(grpc::INTERNAL, kInternalServerError));
   }
+  return execute_result;
+}
+
+void SelectAdReactor::StartScoringWave(
+    const std::string& buyer_ig_owner,
+    std::unique_ptr<GetBidsResponse::GetBidsRawResponse> get_bids_response) {
+  {
+    absl::MutexLock lock(&scoring_waves_mu_);
+    ++pending_scoring_waves_;
+  }
+  auto buyer_bids = std::make_unique<BuyerBidsResponseMap>();
+  buyer_bids->try_emplace(buyer_ig_owner, std::move(get_bids_response));
+  ScoreWave(std::move(buyer_bids));
+}
+
+void SelectAdReactor::OnSpeculativeBuyerDone(
+    const std::string& buyer_ig_owner,
+    std::unique_ptr<GetBidsResponse::GetBidsRawResponse> get_bids_response) {
+  std::unique_ptr<BuyerBidsResponseMap> speculative_wave_bids;
+  {
+    absl::MutexLock lock(&scoring_waves_mu_);
+    if (get_bids_response != nullptr) {
+      unscored_bids_.try_emplace(buyer_ig_owner, std::move(get_bids_response));
+    }
+    ++responded_buyers_;
+    const int buyers = request_->auction_config().buyer_list_size();
+    // Once all the buyers responded, the last wave scores the bids instead.
+    if (speculative_wave_started_ || unscored_bids_.empty() ||
+        responded_buyers_ >= buyers ||
+        responded_buyers_ * 100 < speculative_scoring_buyer_percent_ * buyers) {
+      return;
+    }
+    speculative_wave_started_ = true;
+    speculative_wave_bids =
+        std::make_unique<BuyerBidsResponseMap>(std::move(unscored_bids_));
+    unscored_bids_.clear();
+    ++pending_scoring_waves_;
+  }
+  logger_.vlog(2, "Scoring the bids of ", speculative_wave_bids->size(),
+               " buyers speculatively");
+  ScoreWave(std::move(speculative_wave_bids));
+}
+
+void SelectAdReactor::ScoreWave(
+    std::unique_ptr<BuyerBidsResponseMap> buyer_bids) {
+  // Owned by the callbacks of the wave until it is scored.
+  const BuyerBidsResponseMap& wave_bids = *buyer_bids;
+  FetchScoringSignals(
+      wave_bids,
+      [this, buyer_bids = std::move(buyer_bids)](
+          absl::StatusOr<std::unique_ptr<ScoringSignals>> result) mutable {
+        std::unique_ptr<ScoringSignals> scoring_signals;
+        if (result.ok()) {
+          scoring_signals = *std::move(result);
+        } else {
+          LogIfError(metric_context_->AccumulateMetric<
+                     server_common::metric::kInitiatedRequestErrorCount>(1));
+          logger_.vlog(1,
+                       "Scoring signals fetch from key-value server failed: ",
+                       result.status());
+        }
+        // The bids live in on_done until the wave is scored.
+        BuyerBidsResponseMap* wave_bids = buyer_bids.get();
+        auto on_done = [this, buyer_bids = std::move(buyer_bids)](
+                           absl::StatusOr<std::unique_ptr<
+                               ScoreAdsResponse::ScoreAdsRawResponse>>
+                               response) mutable {
+          OnScoringWaveDone(std::move(*buyer_bids), std::move(response));
+        };
+        absl::Status execute_result = ScoreAds(
+            *wave_bids, std::move(scoring_signals), std::move(on_done));
+        if (absl::IsDeadlineExceeded(execute_result)) {
+          OnScoringWaveDone({}, std::move(execute_result));
+        } else if (!execute_result.ok()) {
+          // The bids of the wave were dropped with on_done, but the request
+          // fails anyway.
+          OnScoringWaveDone({}, absl::InternalError(kInternalServerError));
+        }
+      });
+}
+
+void SelectAdReactor::OnScoringWaveDone(
+    BuyerBidsResponseMap buyer_bids,
+    absl::StatusOr<std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
+        response) {
+  bool all_scoring_waves_done;
+  {
+    absl::MutexLock lock(&scoring_waves_mu_);
+    for (auto& [buyer, get_bids_response] : buyer_bids) {
+      auto [it, inserted] = shared_buyer_bids_map_.try_emplace(
+          buyer, std::move(get_bids_response));
+      if (!inserted) {
+        // The parts of the bids of a streamed buyer are scored by waves of
+        // their own, and joined once scored.
+        for (AdWithBid& bid : *get_bids_response->mutable_bids()) {
+          *it->second->add_bids() = std::move(bid);
+        }
+        for (ProtectedAppSignalsAdWithBid& bid :
+             *get_bids_response->mutable_protected_app_signals_bids()) {
+          *it->second->add_protected_app_signals_bids() = std::move(bid);
+        }
+      }
+    }
+    if (!response.ok()) {
+      if (streamed_scoring_status_.ok()) {
+        streamed_scoring_status_ = std::move(response).status();
+      }
+    } else {
+      // The waves scored disjoint bids, so the highest scored ad of all of
+      // them wins, and the ads rejected by any of them are rejected.
+      AdScore* high_score = streamed_score_ads_response_.mutable_ad_score();
+      AdScore* wave_score = (*response)->mutable_ad_score();
+      google::protobuf::RepeatedPtrField<AdScore::AdRejectionReason>
+          ad_rejection_reasons;
+      ad_rejection_reasons.Swap(high_score->mutable_ad_rejection_reasons());
+      ad_rejection_reasons.MergeFrom(wave_score->ad_rejection_reasons());
+      if (wave_score->buyer_bid() > 0 &&
+          (high_score->buyer_bid() <= 0 ||
+           wave_score->desirability() > high_score->desirability())) {
+        *high_score = std::move(*wave_score);
+      }
+      high_score->mutable_ad_rejection_reasons()->Swap(&ad_rejection_reasons);
+    }
+    --pending_scoring_waves_;
+    all_scoring_waves_done =
+        any_successful_bids_.has_value() && pending_scoring_waves_ == 0;
+  }
+  if (all_scoring_waves_done) {
+    OnAllScoringWavesDone();
+  }
+}
+
+void SelectAdReactor::OnAllScoringWavesDone() {
+  bool any_successful_bids;
+  absl::StatusOr<std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
+      response;
+  {
+    absl::MutexLock lock(&scoring_waves_mu_);
+    any_successful_bids = *any_successful_bids_;
+    if (streamed_scoring_status_.ok()) {
+      response = std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>(
+          std::move(streamed_score_ads_response_));
+    } else {
+      response = streamed_scoring_status_;
+    }
+  }
+  // A failed wave fails the request, as a failed ScoreAds call does without
+  // streaming.
+  if (!response.ok() && !context_->IsCancelled()) {
+    OnScoreAdsDone(std::move(response));
+    return;
+  }
+  if (MayFinishWithoutScoring(any_successful_bids)) {
+    return;
+  }
+  OnScoreAdsDone(std::move(response));
 }
 
 BiddingGroupMap SelectAdReactor::GetBiddingGroups() {
@@ -642,13 +1172,13 @@ BiddingGroupMap SelectAdReactor::GetBiddingGroups() {
         buyer_interest_groups.insert(ad_with_bid.interest_group_name());
       }
     }
-    const auto& buyer_input = buyer_inputs_->at(buyer);
     AuctionResult::InterestGroupIndex ar_interest_group_index;
     int ig_index = 0;
-    for (const auto& interest_group : buyer_input.interest_groups()) {
+    for (const InterestGroupSummary& interest_group :
+         interest_group_summaries_.at(buyer)) {
       // If the interest group name is one of the groups returned by the bidding
       // service then record its index.
-      if (buyer_interest_groups.contains(interest_group.name())) {
+      if (buyer_interest_groups.contains(interest_group.name)) {
         ar_interest_group_index.add_index(ig_index);
       }
       ig_index++;
@@ -710,6 +1240,8 @@ void SelectAdReactor::OnScoreAdsDone(
     return;
   }
 
+  const absl::Time handle_response_start = absl::Now();
+  const absl::Duration handle_response_cpu_start = ThreadCpuTime();
   std::optional<AdScore> high_score;
   const auto& found_response = *response;
   if (found_response->has_ad_score() &&
@@ -730,21 +1262,93 @@ void SelectAdReactor::OnScoreAdsDone(
   }
 
   std::string plaintext_response = std::move(*non_encrypted_response);
+  cpu_time_.AddSince(CpuStage::kHandleResponse, handle_response_cpu_start);
+  const absl::Time encrypt_start = absl::Now();
+  timeline_.Record(RequestStage::kParse, handle_response_start, encrypt_start);
   if (!EncryptResponse(std::move(plaintext_response))) {
     return;
   }
+  const absl::Time encrypt_end = absl::Now();
+  tracer_.AddSpan("EncryptResponse", encrypt_start, encrypt_end);
+  timeline_.Record(RequestStage::kEncrypt, encrypt_start, encrypt_end);
 
-  logger_.vlog(2, "\nSelectAdResponse:\n", response_->DebugString());
+  logger_.vlog(2, "\nSelectAdResponse:\n", DebugStringOf(*response_));
   FinishWithOkStatus();
 }
 
 DecodedBuyerInputs SelectAdReactor::GetDecodedBuyerinputs(
     const EncodedBuyerInputs& encoded_buyer_inputs) {
-  return DecodeBuyerInputs(encoded_buyer_inputs, error_accumulator_,
-                           fail_fast_);
+  return DecodeBuyerInputsInParallel(
+      encoded_buyer_inputs,
+      [this](absl::string_view owner, absl::string_view encoded_buyer_input,
+             ErrorAccumulator& error_accumulator) {
+        return DecodeBuyerInput(owner, encoded_buyer_input, error_accumulator,
+                                fail_fast_, clients_.buyer_input_codec);
+      });
+}
+
+DecodedBuyerInputs SelectAdReactor::DecodeBuyerInputsInParallel(
+    const EncodedBuyerInputs& encoded_buyer_inputs,
+    absl::FunctionRef<BuyerInput(absl::string_view owner,
+                                 absl::string_view encoded_buyer_input,
+                                 ErrorAccumulator& error_accumulator)>
+        decode_buyer_input) {
+  struct DecodedBuyerInput {
+    absl::string_view owner;
+    BuyerInput buyer_input;
+    ErrorAccumulator error_accumulator;
+  };
+  std::vector<DecodedBuyerInput> decoded(encoded_buyer_inputs.size());
+  absl::BlockingCounter pending(decoded.size());
+  std::vector<absl::AnyInvocable<void()>> decodes;
+  decodes.reserve(decoded.size());
+  int index = 0;
+  for (const auto& [owner, encoded_buyer_input] : encoded_buyer_inputs) {
+    DecodedBuyerInput& buyer = decoded[index++];
+    buyer.owner = owner;
+    decodes.push_back([&buyer, encoded_buyer_input = absl::string_view(
+                                   encoded_buyer_input),
+                       &decode_buyer_input, &pending]() {
+      buyer.buyer_input = decode_buyer_input(buyer.owner, encoded_buyer_input,
+                                             buyer.error_accumulator);
+      pending.DecrementCount();
+    });
+  }
+  // The executor decodes all the buyer inputs but the first one, which is
+  // decoded on this thread meanwhile.
+  for (int i = 1; i < decodes.size(); ++i) {
+    if (clients_.executor != nullptr) {
+      clients_.executor->Run(std::move(decodes[i]));
+    } else {
+      decodes[i]();
+    }
+  }
+  if (!decodes.empty()) {
+    decodes[0]();
+  }
+  pending.Wait();
+
+  DecodedBuyerInputs decoded_buyer_inputs;
+  for (DecodedBuyerInput& buyer : decoded) {
+    if (!buyer.error_accumulator.HasErrors()) {
+      decoded_buyer_inputs.insert({buyer.owner, std::move(buyer.buyer_input)});
+      continue;
+    }
+    for (ErrorVisibility error_visibility :
+         {CLIENT_VISIBLE, ErrorVisibility::AD_SERVER_VISIBLE}) {
+      for (const auto& [error_code, errors] :
+           buyer.error_accumulator.GetErrors(error_visibility)) {
+        for (const std::string& error : errors) {
+          error_accumulator_.ReportError(error_visibility, error, error_code);
+        }
+      }
+    }
+  }
+  return decoded_buyer_inputs;
 }
 
 bool SelectAdReactor::EncryptResponse(std::string plaintext_response) {
+  const absl::Duration encrypt_cpu_start = ThreadCpuTime();
   std::optional<server_common::PrivateKey> private_key =
       clients_.key_fetcher_manager_.GetPrivateKey(request_context_.key_id);
   if (!private_key.has_value()) {
@@ -757,10 +1361,21 @@ bool SelectAdReactor::EncryptResponse(std::string plaintext_response) {
     return false;
   }
 
-  absl::StatusOr<std::string> encapsulated_response =
-      server_common::EncryptAndEncapsulateResponse(
-          std::move(plaintext_response), request_context_.private_key,
-          *request_context_.context);
+  absl::StatusOr<std::string> encapsulated_response;
+  if (request_context_.gateway != nullptr) {
+    absl::StatusOr<quiche::ObliviousHttpResponse> ohttp_response =
+        request_context_.gateway->CreateObliviousHttpResponse(
+            std::move(plaintext_response), *request_context_.context);
+    if (ohttp_response.ok()) {
+      encapsulated_response = ohttp_response->EncapsulateAndSerialize();
+    } else {
+      encapsulated_response = ohttp_response.status();
+    }
+  } else {
+    encapsulated_response = server_common::EncryptAndEncapsulateResponse(
+        std::move(plaintext_response), request_context_.private_key,
+        *request_context_.context);
+  }
   if (!encapsulated_response.ok()) {
     logger_.vlog(
         4, absl::StrFormat("Error during response encryption/encapsulation: %s",
@@ -771,6 +1386,7 @@ bool SelectAdReactor::EncryptResponse(std::string plaintext_response) {
 
   response_->mutable_auction_result_ciphertext()->assign(
       std::move(*encapsulated_response));
+  cpu_time_.AddSince(CpuStage::kEncrypt, encrypt_cpu_start);
   return true;
 }
 
@@ -778,12 +1394,36 @@ void SelectAdReactor::PerformDebugReporting(
     const std::optional<AdScore>& high_score) {
   PostAuctionSignals post_auction_signals =
       GeneratePostAuctionSignals(high_score);
+  auto is_winner = [&post_auction_signals](absl::string_view buyer,
+                                           const AdWithBid& ad_with_bid) {
+    return post_auction_signals.winning_ig_owner == buyer &&
+           ad_with_bid.interest_group_name() ==
+               post_auction_signals.winning_ig_name;
+  };
+  int num_loss_reports = 0;
+  for (const auto& [buyer, get_bid_response] : shared_buyer_bids_map_) {
+    for (const AdWithBid& ad_with_bid : get_bid_response->bids()) {
+      if (ad_with_bid.has_debug_report_urls() &&
+          !is_winner(buyer, ad_with_bid)) {
+        ++num_loss_reports;
+      }
+    }
+  }
+  const std::vector<bool> send_loss_reports =
+      clients_.debug_report_limiter != nullptr
+          ? clients_.debug_report_limiter->PickLossReports(num_loss_reports)
+          : std::vector<bool>(num_loss_reports, true);
+  int loss_report = 0;
   for (const auto& [buyer, get_bid_response] : shared_buyer_bids_map_) {
     std::string ig_owner = buyer;
     for (int i = 0; i < get_bid_response->bids_size(); i++) {
-      AdWithBid adWithBid = get_bid_response->bids().at(i);
+      const AdWithBid& adWithBid = get_bid_response->bids().at(i);
       std::string ig_name = adWithBid.interest_group_name();
       if (adWithBid.has_debug_report_urls()) {
+        const bool is_winner_bid = is_winner(buyer, adWithBid);
+        if (!is_winner_bid && !send_loss_reports[loss_report++]) {
+          continue;
+        }
         auto done_cb = [&logger_ = logger_, ig_owner,
                         ig_name](absl::StatusOr<absl::string_view> result) {
           if (result.ok()) {
@@ -795,14 +1435,10 @@ void SelectAdReactor::PerformDebugReporting(
                 ",  interest_group: ", ig_name, " ,status:", result.status());
           }
         };
-        std::string debug_url;
-        if (post_auction_signals.winning_ig_owner == buyer &&
-            adWithBid.interest_group_name() ==
-                post_auction_signals.winning_ig_name) {
-          debug_url = adWithBid.debug_report_urls().auction_debug_win_url();
-        } else {
-          debug_url = adWithBid.debug_report_urls().auction_debug_loss_url();
-        }
+        const std::string& debug_url =
+            is_winner_bid
+                ? adWithBid.debug_report_urls().auction_debug_win_url()
+                : adWithBid.debug_report_urls().auction_debug_loss_url();
         HTTPRequest http_request = CreateDebugReportingHttpRequest(
             debug_url, GetPlaceholderDataForInterestGroup(
                            ig_owner, ig_name, post_auction_signals));
@@ -812,10 +1448,33 @@ void SelectAdReactor::PerformDebugReporting(
   }
 }
 
-void SelectAdReactor::OnDone() { delete this; }
+void SelectAdReactor::OnDone() {
+  LogInitiatedRequestCryptoMetrics<
+      metric::kInitiatedRequestBfeHpkeEncryptDuration,
+      metric::kInitiatedRequestBfeHpkeEncryptSize,
+      metric::kInitiatedRequestBfeAeadDecryptDuration,
+      metric::kInitiatedRequestBfeAeadDecryptSize>(buyer_crypto_metrics_,
+                                                   *metric_context_);
+  LogInitiatedRequestCryptoMetrics<
+      metric::kInitiatedRequestAuctionHpkeEncryptDuration,
+      metric::kInitiatedRequestAuctionHpkeEncryptSize,
+      metric::kInitiatedRequestAuctionAeadDecryptDuration,
+      metric::kInitiatedRequestAuctionAeadDecryptSize>(auction_crypto_metrics_,
+                                                       *metric_context_);
+  LogRequestCpuTime(cpu_time_, *metric_context_);
+  ReportRequestTimeline(
+      timeline_,
+      {.request_bytes = request_->protected_auction_ciphertext().size() +
+                        request_->protected_audience_ciphertext().size(),
+       .response_bytes = response_->auction_result_ciphertext().size(),
+       .num_items = request_->auction_config().buyer_list_size()});
+  delete this;
+}
 
 void SelectAdReactor::OnCancel() {
-  // TODO(b/245982466): Handle early abort and errors.
+  // Aborts the GetBids and ScoreAds RPCs in flight, which then fail the
+  // request with their cancelled status.
+  cancellation_.Cancel();
 }
 
 void SelectAdReactor::ReportError(
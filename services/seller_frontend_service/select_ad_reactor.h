@@ -16,29 +16,44 @@
 #define SERVICES_SELLER_FRONTEND_SERVICE_SELECT_AD_REACTOR_H_
 
 #include <array>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <set>
 #include <string>
 #include <string_view>
 #include <utility>
+#include <vector>
 
 #include <grpcpp/grpcpp.h>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/flags/flag.h"
+#include "absl/functional/any_invocable.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "include/grpcpp/impl/codegen/server_callback.h"
 #include "quiche/oblivious_http/oblivious_http_gateway.h"
+#include "services/common/encryption/crypto_metrics.h"
 #include "services/common/loggers/build_input_process_response_benchmarking_logger.h"
 #include "services/common/loggers/no_ops_logger.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/telemetry/request_tracer.h"
 #include "services/common/util/bid_stats.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/concurrency_limiter.h"
 #include "services/common/util/context_logger.h"
 #include "services/common/util/error_accumulator.h"
 #include "services/common/util/error_reporter.h"
+#include "services/common/util/request_class.h"
+#include "services/common/util/request_cpu_time.h"
+#include "services/common/util/request_memory_budget.h"
+#include "services/common/util/request_timeline.h"
 #include "services/common/util/request_metadata.h"
 #include "services/seller_frontend_service/data/scoring_signals.h"
 #include "services/seller_frontend_service/seller_frontend_service.h"
@@ -82,6 +97,10 @@ inline constexpr char kEmptyBuyerInPerBuyerConfig[] =
 
 inline constexpr char kNoBidsReceived[] = "No bids received.";
 
+// Returns the class of the request, from the request_priority of its auction
+// config and its client type. See RequestClassOf.
+RequestClass RequestClassOf(const SelectAdRequest& request);
+
 // Struct for any objects needed throughout the lifecycle of the request.
 struct RequestContext {
   // Key ID used to encrypt the request.
@@ -91,6 +110,10 @@ struct RequestContext {
   std::unique_ptr<quiche::ObliviousHttpRequest::Context> context;
 
   server_common::PrivateKey private_key;
+
+  // Cached gateway that decrypted the request, if any, to encrypt the
+  // response with.
+  const quiche::ObliviousHttpGateway* gateway = nullptr;
 };
 
 // This is a gRPC reactor that serves a single GenerateBidsRequest.
@@ -109,6 +132,12 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Initiate the asynchronous execution of the SelectingWinningAdRequest.
   virtual void Execute();
 
+  // Keeps the request counted in flight by the concurrency limiter of the
+  // server until the reactor is done.
+  void SetConcurrencyPermit(ConcurrencyLimiter::Permit permit) {
+    concurrency_permit_ = std::move(permit);
+  }
+
  protected:
   using ErrorHandlerSignature = const std::function<void(absl::string_view)>&;
 
@@ -136,13 +165,32 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   GetDecodedBuyerinputs(const google::protobuf::Map<std::string, std::string>&
                             encoded_buyer_inputs) = 0;
 
+  // Decodes each of the encoded buyer inputs with decode_buyer_input, which
+  // reports its errors to the given accumulator. The inputs are decoded in
+  // parallel on clients_.executor if it is set, so that the decoding takes
+  // as long as the slowest buyer input rather than all of them. Any errors
+  // are reported to error accumulator object.
+  absl::flat_hash_map<absl::string_view, BuyerInput>
+  DecodeBuyerInputsInParallel(
+      const google::protobuf::Map<std::string, std::string>&
+          encoded_buyer_inputs,
+      absl::FunctionRef<BuyerInput(absl::string_view owner,
+                                   absl::string_view encoded_buyer_input,
+                                   ErrorAccumulator& error_accumulator)>
+          decode_buyer_input);
+
+  // Creates the GetBids request of a buyer, moving buyer_input into it.
   virtual std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
   CreateGetBidsRequest(absl::string_view seller,
                        const std::string& buyer_ig_owner,
-                       const BuyerInput& buyer_input);
+                       BuyerInput buyer_input);
 
+  // Creates the request to score the bids of buyer_bids. The scoring signals
+  // and the ads of the bids are moved into the request, leaving in buyer_bids
+  // only the fields needed after scoring, e.g. for the debug reporting.
   virtual std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
-  CreateScoreAdsRequest();
+  CreateScoreAdsRequest(BuyerBidsResponseMap& buyer_bids,
+                        std::unique_ptr<ScoringSignals> scoring_signals);
 
   // Checks if any client visible errors have been observed.
   bool HaveClientVisibleErrors();
@@ -176,16 +224,22 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
                   ErrorCode::CLIENT_SIDE);
     } else {
       bool is_any_buyer_input_valid = false;
-      std::set<std::string> observed_errors;
+      bool has_empty_owner = false;
+      // Owners of the buyer inputs without interest groups, up to as many as
+      // the error accumulator keeps, which are only formatted into errors once
+      // all the buyer inputs are checked.
+      std::vector<absl::string_view> owners_without_interest_groups;
       for (const auto& [buyer, buyer_input] : *buyer_inputs_) {
         bool any_error = false;
         if (buyer.empty()) {
-          observed_errors.insert(kEmptyInterestGroupOwner);
+          has_empty_owner = true;
           any_error = true;
         }
         if (buyer_input.interest_groups().empty()) {
-          observed_errors.insert(
-              absl::StrFormat(kMissingInterestGroups, buyer));
+          if (owners_without_interest_groups.size() <
+              ErrorAccumulator::kMaxErrorsPerCode) {
+            owners_without_interest_groups.push_back(buyer);
+          }
           any_error = true;
         }
         if (any_error) {
@@ -193,6 +247,13 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
         }
         is_any_buyer_input_valid = true;
       }
+      std::set<std::string> observed_errors;
+      if (has_empty_owner) {
+        observed_errors.insert(kEmptyInterestGroupOwner);
+      }
+      for (absl::string_view owner : owners_without_interest_groups) {
+        observed_errors.insert(absl::StrFormat(kMissingInterestGroups, owner));
+      }
       // Buyer inputs have keys but none of the key/value pairs are usable to
       // get bids from buyers.
       if (!is_any_buyer_input_valid) {
@@ -228,13 +289,18 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // whether decryption was successful.
   bool DecryptRequest();
 
+  // Decides whether the request is traced, once it is decrypted, and records
+  // the decryption that ran from `start` to `decrypt_end` if so.
+  void StartTrace(absl::Time start, absl::Time decrypt_end);
+
   // Fetches the bids from a single buyer by initiating an asynchronous GetBids
-  // rpc.
+  // rpc. Safe to call for several buyers in parallel.
   //
   // buyer: a string representing the buyer, identified as an IG owner.
-  // buyer_input: input for bidding.
-  void FetchBid(const std::string& buyer_ig_owner,
-                const BuyerInput& buyer_input, absl::string_view seller);
+  // buyer_input: input for bidding, moved into the GetBids request. Only
+  // interest_group_summaries_ are left of it for after bidding.
+  void FetchBid(const std::string& buyer_ig_owner, BuyerInput& buyer_input,
+                absl::string_view seller);
   // Handles recording the fetched bid to state.
   // This is called by the grpc buyer client when the request is finished,
   // and will subsequently call update pending bids state which will update how
@@ -248,6 +314,39 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
           response,
       const std::string& buyer_hostname);
 
+  // Bids of a buyer received so far with GetBidsStream.
+  struct StreamedBids {
+    int num_bids = 0;
+    int response_size = 0;
+    // Whether any of the bids are scored.
+    bool scored = false;
+  };
+
+  // With streamed GetBids, starts a scoring wave for a part of the bids of a
+  // buyer as soon as it arrives.
+  void OnFetchBidsChunk(
+      const std::string& buyer_ig_owner,
+      std::unique_ptr<GetBidsResponse::GetBidsRawResponse> chunk,
+      StreamedBids& streamed_bids) ABSL_LOCKS_EXCLUDED(scoring_waves_mu_);
+
+  // Charges the bids of the buyer to the memory budget of the request, and
+  // returns whether they fit. The bids that do not are dropped.
+  bool ChargeBids(const std::string& buyer_ig_owner,
+                  const GetBidsResponse::GetBidsRawResponse& bids);
+
+  // With streamed GetBids, records the bid of the buyer as done once its
+  // call is, as a success if any of its bids are scored.
+  void OnStreamedBidsDone(const std::string& buyer_ig_owner,
+                          const absl::Status& status,
+                          const StreamedBids& streamed_bids);
+
+  // Accounts the GetBids call of the buyer to the per buyer metrics and to
+  // the latency budget of the buyer, with the number of bids and the size of
+  // the response of a successful call.
+  void RecordBuyerMetrics(const std::string& buyer_ig_owner,
+                          absl::Duration latency, const absl::Status& status,
+                          int num_bids, int response_size);
+
   // Calls FetchScoringSignals or calls Finish on the reactor depending on
   // if there were any successful bids or if the request was cancelled by the
   // client.
@@ -256,7 +355,11 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // Initiates the asynchronous grpc request to fetch scoring signals
   // from the key value server. The ad_render_url in the GetBid response from
   // each Buyer is used as a key for the Seller Key-Value lookup.
-  void FetchScoringSignals();
+  void FetchScoringSignals(
+      const BuyerBidsResponseMap& buyer_bids,
+      absl::AnyInvocable<
+          void(absl::StatusOr<std::unique_ptr<ScoringSignals>>) &&>
+          on_done);
 
   // Handles recording the fetched scoring signals to state.
   // If the code blob is already fetched, this function initiates scoring the
@@ -271,6 +374,54 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // all signals and bids.
   void ScoreAds();
 
+  // Initiates an asynchronous rpc to the auction service to score the bids of
+  // buyer_bids with the given scoring signals. The ads of the bids are moved
+  // into the request. Returns an error, without calling on_done, if the rpc
+  // could not be started.
+  absl::Status ScoreAds(
+      BuyerBidsResponseMap& buyer_bids,
+      std::unique_ptr<ScoringSignals> scoring_signals,
+      absl::AnyInvocable<
+          void(absl::StatusOr<
+               std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>) &&>
+          on_done);
+
+  // Finishes the request without scoring if the client cancelled it or no
+  // buyer returned bids. Returns whether the request was finished.
+  bool MayFinishWithoutScoring(bool any_successful_bids);
+
+  // With streaming scoring, starts a scoring wave for the bids of a single
+  // buyer as soon as they arrive: fetches the scoring signals for its bids
+  // and scores them, while the bids of the other buyers are still pending.
+  void StartScoringWave(
+      const std::string& buyer_ig_owner,
+      std::unique_ptr<GetBidsResponse::GetBidsRawResponse> get_bids_response)
+      ABSL_LOCKS_EXCLUDED(scoring_waves_mu_);
+
+  // With speculative scoring, holds the bids of a buyer that responded, if
+  // any, and starts a single scoring wave for the bids held so far once
+  // enough buyers responded while others are still pending. The bids that
+  // arrive later are scored by a last wave once all the bids are done.
+  void OnSpeculativeBuyerDone(
+      const std::string& buyer_ig_owner,
+      std::unique_ptr<GetBidsResponse::GetBidsRawResponse> get_bids_response)
+      ABSL_LOCKS_EXCLUDED(scoring_waves_mu_);
+
+  // Fetches the scoring signals for the bids of a wave, already counted in
+  // pending_scoring_waves_, and scores them.
+  void ScoreWave(std::unique_ptr<BuyerBidsResponseMap> buyer_bids)
+      ABSL_LOCKS_EXCLUDED(scoring_waves_mu_);
+
+  // Records the result of a scoring wave, and picks the winner once all the
+  // bids and scoring waves are done.
+  void OnScoringWaveDone(
+      BuyerBidsResponseMap buyer_bids,
+      absl::StatusOr<std::unique_ptr<ScoreAdsResponse::ScoreAdsRawResponse>>
+          response) ABSL_LOCKS_EXCLUDED(scoring_waves_mu_);
+
+  // Picks the winner of the scoring waves and finishes the request.
+  void OnAllScoringWavesDone();
+
   // Handles the auction result and writes the winning ad to
   // the SelectAdResponse, thus finishing the SelectAdRequest.
   // This function is called by the auction service client as a done callback.
@@ -314,8 +465,10 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
       ParamWithSourceLoc<ErrorVisibility> error_visibility_with_loc,
       const std::string& msg, ErrorCode error_code);
 
+  // Moves the ad, the render URL and the ad components of input into the
+  // result.
   ScoreAdsRequest::ScoreAdsRawRequest::AdWithBidMetadata BuildAdWithBidMetadata(
-      const AdWithBid& input, absl::string_view interest_group_owner);
+      AdWithBid& input, absl::string_view interest_group_owner);
 
   // Initialization
   grpc::CallbackServerContext* context_;
@@ -332,10 +485,12 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
 
   // Metadata to be sent to buyers.
   RequestMetadata buyer_metadata_;
+  // Passed on to the buyers and to the auction.
+  const RequestClass request_class_;
 
   // Get Bid Results
   // Multiple threads can be writing buyer bid responses so this map
-  // gets locked when bid_stats_ updates the state of pending bids.
+  // gets locked when bid_stats_ runs the callback of a completed bid.
   // The map can be freely used without a lock after all the bids have
   // completed.
   BuyerBidsResponseMap shared_buyer_bids_map_;
@@ -349,12 +504,41 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // through B&A services.
   ContextLogger logger_;
 
-  // Decompressed and decoded buyer inputs.
+  // Decompressed and decoded buyer inputs. The inputs of the buyers whose
+  // bids are fetched are moved into their GetBids requests.
   absl::StatusOr<absl::flat_hash_map<absl::string_view, BuyerInput>>
       buyer_inputs_;
 
+  // What is used of an interest group once bids are fetched.
+  struct InterestGroupSummary {
+    std::string name;
+    int64_t join_count = 0;
+    int64_t recency = 0;
+  };
+
+  // Summaries of the interest groups of each buyer whose bids are fetched, in
+  // the order of its buyer input. Built before the buyer inputs are moved into
+  // the GetBids requests.
+  absl::flat_hash_map<absl::string_view, std::vector<InterestGroupSummary>>
+      interest_group_summaries_;
+
   // Used to log metric, same life time as reactor.
   std::unique_ptr<metric::SfeContext> metric_context_;
+  // Crypto operations of the requests to the BFEs and to the Auction server,
+  // logged in OnDone.
+  CryptoMetrics buyer_crypto_metrics_;
+  CryptoMetrics auction_crypto_metrics_;
+  // CPU time of the request by stage, logged in OnDone.
+  RequestCpuTime cpu_time_;
+  // Stages of the request, traced or not, reported in OnDone.
+  RequestTimeline timeline_;
+  // Bytes of the decoded request and of the bids of the buyers.
+  RequestMemoryBudget memory_budget_;
+  // Trace of the request, followed by the BFEs and the Auction server. Not
+  // sampled until `StartTrace`.
+  RequestTracer tracer_;
+  // Cancelled once the client gives up on the request.
+  CancellationToken cancellation_;
 
   // Object that accumulates all the errors and aggregates them based on their
   // intended visibility.
@@ -373,11 +557,54 @@ class SelectAdReactor : public grpc::ServerUnaryReactor {
   // not.
   const bool is_pas_enabled_;
 
+  // Indicates whether the bids of each buyer are scored as soon as they
+  // arrive instead of once all the buyers returned their bids. Not used for a
+  // single buyer, whose bids are scored in one call either way.
+  const bool is_streaming_scoring_enabled_;
+
+  // Indicates whether the bids of the buyers are streamed by GetBidsStream,
+  // each part scored as soon as it arrives. Only used with streaming scoring.
+  const bool is_streamed_get_bids_enabled_;
+
+  // Percentage of the buyers that must have responded before the bids
+  // received so far are scored speculatively, or 0 if disabled. Not used
+  // with streaming scoring, component auction orchestration or a single
+  // buyer.
+  const int speculative_scoring_buyer_percent_;
+
+  // Indicates whether the compressed buyer inputs are forwarded as is to the
+  // buyers, which decode them, rather than decoded here. Not with request
+  // shape capture, which needs all their fields.
+  const bool forward_compressed_buyer_inputs_;
+
  private:
   // Keeps track of how many buyer bids were expected initially and how many
   // were erroneous. If all bids ended up in an error state then that should be
   // flagged as an error eventually.
   BidStats bid_stats_;
+
+  ConcurrencyLimiter::Permit concurrency_permit_;
+
+  // Buyer whose GetBids call ended last so far.
+  absl::Mutex critical_path_mu_;
+  std::string critical_path_buyer_ ABSL_GUARDED_BY(critical_path_mu_);
+
+  // State of the scoring waves, with streaming or speculative scoring. The
+  // bids of a wave are moved to shared_buyer_bids_map_ once it is scored.
+  absl::Mutex scoring_waves_mu_;
+  int pending_scoring_waves_ ABSL_GUARDED_BY(scoring_waves_mu_) = 0;
+  // With speculative scoring, the buyers that responded, whether the
+  // speculative wave started, and the bids not in a wave yet.
+  int responded_buyers_ ABSL_GUARDED_BY(scoring_waves_mu_) = 0;
+  bool speculative_wave_started_ ABSL_GUARDED_BY(scoring_waves_mu_) = false;
+  BuyerBidsResponseMap unscored_bids_ ABSL_GUARDED_BY(scoring_waves_mu_);
+  std::optional<bool> any_successful_bids_ ABSL_GUARDED_BY(scoring_waves_mu_);
+  // The highest scored ad of the waves so far, with the rejected ads of all
+  // of them.
+  ScoreAdsResponse::ScoreAdsRawResponse streamed_score_ads_response_
+      ABSL_GUARDED_BY(scoring_waves_mu_);
+  // The first error of a wave, if any.
+  absl::Status streamed_scoring_status_ ABSL_GUARDED_BY(scoring_waves_mu_);
 };
 }  // namespace privacy_sandbox::bidding_auction_servers
 
@@ -18,7 +18,6 @@
 
 #include "absl/strings/str_format.h"
 #include "glog/logging.h"
-#include "services/common/compression/gzip.h"
 #include "services/common/util/status_macros.h"
 #include "services/seller_frontend_service/util/framing_utils.h"
 #include "src/cpp/communication/encoding_utils.h"
@@ -122,17 +121,16 @@ absl::StatusOr<std::string> SelectAdReactorForApp::GetNonEncryptedResponse(
   // Serialized the data to bytes array.
   std::string serialized_result = auction_result.SerializeAsString();
 
-  // Compress the bytes array before framing it with pre-amble and padding.
-  absl::StatusOr<std::string> compressed_data = GzipCompress(serialized_result);
-  if (!compressed_data.ok()) {
+  // Compress the bytes array straight into its frame, with pre-amble and
+  // padding.
+  absl::StatusOr<std::string> framed_data =
+      GzipCompressAndEncodeResponsePayload(serialized_result);
+  if (!framed_data.ok()) {
     std::string error = "Failed to compress the serialized response data\n";
     FinishWithInternalError(error);
     return absl::InternalError("");
   }
-
-  return server_common::EncodeResponsePayload(
-      server_common::CompressionType::kGzip, *compressed_data,
-      GetEncodedDataSize(compressed_data->size()));
+  return framed_data;
 }
 
 ProtectedAudienceInput SelectAdReactorForApp::GetDecodedProtectedAudienceInput(
@@ -157,30 +155,31 @@ ProtectedAuctionInput SelectAdReactorForApp::GetDecodedProtectedAuctionInput(
 
 DecodedBuyerInputs SelectAdReactorForApp::GetDecodedBuyerinputs(
     const EncodedBuyerInputs& encoded_buyer_inputs) {
-  DecodedBuyerInputs decoded_buyer_inputs;
-  for (const auto& [owner, compressed_buyer_input] : encoded_buyer_inputs) {
-    absl::StatusOr<std::string> decompressed_buyer_input =
-        GzipDecompress(compressed_buyer_input);
-    if (!decompressed_buyer_input.ok()) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE,
-                  absl::StrFormat(kBadCompressedBuyerInput, owner),
-                  ErrorCode::CLIENT_SIDE);
-      continue;
-    }
-
-    BuyerInput buyer_input;
-    if (!buyer_input.ParseFromArray(decompressed_buyer_input->data(),
-                                    decompressed_buyer_input->size())) {
-      ReportError(ErrorVisibility::CLIENT_VISIBLE,
-                  absl::StrFormat(kBadBuyerInputProto, owner),
-                  ErrorCode::CLIENT_SIDE);
-      continue;
-    }
-
-    decoded_buyer_inputs.insert({std::move(owner), std::move(buyer_input)});
-  }
+  return DecodeBuyerInputsInParallel(
+      encoded_buyer_inputs,
+      [this](absl::string_view owner, absl::string_view compressed_buyer_input,
+             ErrorAccumulator& error_accumulator) {
+        BuyerInput buyer_input;
+        absl::StatusOr<std::string> decompressed_buyer_input =
+            DecompressBuyerInput(compressed_buyer_input,
+                                 clients_.buyer_input_codec);
+        if (!decompressed_buyer_input.ok()) {
+          error_accumulator.ReportError(
+              ErrorVisibility::CLIENT_VISIBLE,
+              absl::StrFormat(kBadCompressedBuyerInput, owner),
+              ErrorCode::CLIENT_SIDE);
+          return buyer_input;
+        }
 
-  return decoded_buyer_inputs;
+        if (!buyer_input.ParseFromArray(decompressed_buyer_input->data(),
+                                        decompressed_buyer_input->size())) {
+          error_accumulator.ReportError(
+              ErrorVisibility::CLIENT_VISIBLE,
+              absl::StrFormat(kBadBuyerInputProto, owner),
+              ErrorCode::CLIENT_SIDE);
+        }
+        return buyer_input;
+      });
 }
 
 void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBuyerInput(
@@ -211,37 +210,41 @@ void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBuyerInput(
 std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
 SelectAdReactorForApp::CreateGetBidsRequest(absl::string_view seller,
                                             const std::string& buyer_ig_owner,
-                                            const BuyerInput& buyer_input) {
+                                            BuyerInput buyer_input) {
   auto request = SelectAdReactor::CreateGetBidsRequest(seller, buyer_ig_owner,
-                                                       buyer_input);
+                                                       std::move(buyer_input));
   MayPopulateProtectedAppSignalsBuyerInput(request.get());
   return request;
 }
 
 std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest>
-SelectAdReactorForApp::CreateScoreAdsRequest() {
-  auto request = SelectAdReactor::CreateScoreAdsRequest();
-  MayPopulateProtectedAppSignalsBids(request.get());
+SelectAdReactorForApp::CreateScoreAdsRequest(
+    BuyerBidsResponseMap& buyer_bids,
+    std::unique_ptr<ScoringSignals> scoring_signals) {
+  auto request = SelectAdReactor::CreateScoreAdsRequest(
+      buyer_bids, std::move(scoring_signals));
+  MayPopulateProtectedAppSignalsBids(buyer_bids, request.get());
   return request;
 }
 
 ProtectedAppSignalsAdWithBidMetadata
 SelectAdReactorForApp::BuildProtectedAppSignalsAdWithBidMetadata(
-    absl::string_view buyer, const ProtectedAppSignalsAdWithBid& input) {
+    absl::string_view buyer, ProtectedAppSignalsAdWithBid& input) {
   ProtectedAppSignalsAdWithBidMetadata result;
   if (input.has_ad()) {
-    *result.mutable_ad() = input.ad();
+    result.mutable_ad()->Swap(input.mutable_ad());
   }
   result.set_bid(input.bid());
-  result.set_render(input.render());
+  result.set_render(std::move(*input.mutable_render()));
   result.set_modeling_signals(input.modeling_signals());
   result.set_ad_cost(input.ad_cost());
-  result.set_egress_features(input.egress_features());
+  result.set_egress_features(std::move(*input.mutable_egress_features()));
   result.set_owner(buyer);
   return result;
 }
 
 void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBids(
+    BuyerBidsResponseMap& buyer_bids,
     ScoreAdsRequest::ScoreAdsRawRequest* score_ads_raw_request) {
   if (!is_pas_enabled_) {
     VLOG(8) << "Protected app signals is not enabled and hence not populating "
@@ -251,13 +254,11 @@ void SelectAdReactorForApp::MayPopulateProtectedAppSignalsBids(
 
   VLOG(3) << "Protected App signals, may add protected app signals bids to "
              "score ads request";
-  for (const auto& [buyer, get_bid_response] : shared_buyer_bids_map_) {
-    for (int i = 0; i < get_bid_response->protected_app_signals_bids_size();
-         i++) {
-      auto ad_with_bid_metadata = BuildProtectedAppSignalsAdWithBidMetadata(
-          buyer, get_bid_response->protected_app_signals_bids().at(i));
-      score_ads_raw_request->mutable_protected_app_signals_ad_bids()->Add(
-          std::move(ad_with_bid_metadata));
+  for (auto& [buyer, get_bid_response] : buyer_bids) {
+    for (ProtectedAppSignalsAdWithBid& ad_with_bid :
+         *get_bid_response->mutable_protected_app_signals_bids()) {
+      *score_ads_raw_request->add_protected_app_signals_ad_bids() =
+          BuildProtectedAppSignalsAdWithBidMetadata(buyer, ad_with_bid);
     }
   }
 }
@@ -72,18 +72,21 @@ class SelectAdReactorForApp : public SelectAdReactor {
   // PAS buyer inputs populated properly.
   std::unique_ptr<GetBidsRequest::GetBidsRawRequest> CreateGetBidsRequest(
       absl::string_view seller, const std::string& buyer_ig_owner,
-      const BuyerInput& buyer_input) override;
+      BuyerInput buyer_input) override;
 
   // Populates PAS bids in the scoring request to be sent to auction service.
+  // The ads of the bids are moved into the request.
   void MayPopulateProtectedAppSignalsBids(
+      BuyerBidsResponseMap& buyer_bids,
       ScoreAdsRequest::ScoreAdsRawRequest* score_ads_raw_request);
 
   ScoreAdsRequest::ScoreAdsRawRequest::ProtectedAppSignalsAdWithBidMetadata
   BuildProtectedAppSignalsAdWithBidMetadata(
-      absl::string_view buyer, const ProtectedAppSignalsAdWithBid& input);
+      absl::string_view buyer, ProtectedAppSignalsAdWithBid& input);
 
-  std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> CreateScoreAdsRequest()
-      override;
+  std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> CreateScoreAdsRequest(
+      BuyerBidsResponseMap& buyer_bids,
+      std::unique_ptr<ScoringSignals> scoring_signals) override;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
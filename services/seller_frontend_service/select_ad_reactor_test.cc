@@ -35,6 +35,7 @@
 #include "absl/strings/match.h"
 #include "absl/strings/str_format.h"
 #include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/mutex.h"
 #include "absl/time/time.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "gmock/gmock.h"
@@ -230,6 +231,100 @@ TYPED_TEST(SellerFrontEndServiceTest, FetchesBidsFromAllBuyers) {
       RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
 }
 
+TYPED_TEST(SellerFrontEndServiceTest, DecodesBuyerInputsOnExecutor) {
+  this->SetupRequestWithTwoBuyers();
+  ScoringAsyncClientMock scoring_client;
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals> scoring_provider;
+
+  // All the buyer inputs but the one decoded on the request thread are
+  // decoded on the executor, and all the bids but the one fetched on the
+  // request thread are fetched on it.
+  MockExecutor executor;
+  EXPECT_CALL(executor, Run)
+      .Times(2 * (this->protected_auction_input_.buyer_input_size() - 1))
+      .WillRepeatedly(
+          [](absl::AnyInvocable<void()> closure) { std::move(closure)(); });
+
+  // Every buyer still gets its decoded buyer input.
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  ErrorAccumulator error_accumulator;
+  for (const auto& buyer_ig_owner :
+       this->request_.auction_config().buyer_list()) {
+    BuyerInput buyer_input = DecodeBuyerInput(
+        buyer_ig_owner,
+        this->protected_auction_input_.buyer_input().at(buyer_ig_owner),
+        error_accumulator);
+    EXPECT_CALL(buyer_clients, Get(buyer_ig_owner))
+        .WillOnce([buyer_input](absl::string_view hostname) {
+          auto buyer = std::make_unique<BuyerFrontEndAsyncClientMock>();
+          EXPECT_CALL(*buyer, ExecuteInternal)
+              .WillOnce([buyer_input](
+                            std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
+                                get_bids_request,
+                            const RequestMetadata& metadata,
+                            GetBidDoneCallback on_done,
+                            absl::Duration timeout) {
+                EXPECT_TRUE(google::protobuf::util::MessageDifferencer::Equals(
+                    buyer_input, get_bids_request->buyer_input()));
+                return absl::OkStatus();
+              });
+          return buyer;
+        });
+  }
+  EXPECT_FALSE(error_accumulator.HasErrors());
+
+  ClientRegistry clients{scoring_provider,
+                         scoring_client,
+                         buyer_clients,
+                         this->key_fetcher_manager_,
+                         std::make_unique<MockAsyncReporter>(
+                             std::make_unique<MockHttpFetcherAsync>()),
+                         &executor};
+
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+}
+
+TYPED_TEST(SellerFrontEndServiceTest, ForwardsCompressedBuyerInputs) {
+  this->config_.SetFlagForTest(kTrue, FORWARD_COMPRESSED_BUYER_INPUTS);
+  this->SetupRequestWithTwoBuyers();
+  ScoringAsyncClientMock scoring_client;
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals> scoring_provider;
+
+  // Every buyer gets its buyer input as the client compressed it.
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  for (const auto& buyer_ig_owner :
+       this->request_.auction_config().buyer_list()) {
+    const std::string compressed_buyer_input =
+        this->protected_auction_input_.buyer_input().at(buyer_ig_owner);
+    EXPECT_CALL(buyer_clients, Get(buyer_ig_owner))
+        .WillOnce([compressed_buyer_input](absl::string_view hostname) {
+          auto buyer = std::make_unique<BuyerFrontEndAsyncClientMock>();
+          EXPECT_CALL(*buyer, ExecuteInternal)
+              .WillOnce([compressed_buyer_input](
+                            std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
+                                get_bids_request,
+                            const RequestMetadata& metadata,
+                            GetBidDoneCallback on_done,
+                            absl::Duration timeout) {
+                EXPECT_EQ(get_bids_request->compressed_buyer_input(),
+                          compressed_buyer_input);
+                EXPECT_FALSE(get_bids_request->has_buyer_input());
+                return absl::OkStatus();
+              });
+          return buyer;
+        });
+  }
+
+  ClientRegistry clients{scoring_provider, scoring_client, buyer_clients,
+                         this->key_fetcher_manager_,
+                         std::make_unique<MockAsyncReporter>(
+                             std::make_unique<MockHttpFetcherAsync>())};
+
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+}
+
 TYPED_TEST(SellerFrontEndServiceTest,
            FetchesBidsFromAllBuyersWithDebugReportingEnabled) {
   this->SetupRequestWithTwoBuyers();
@@ -537,6 +632,146 @@ TYPED_TEST(SellerFrontEndServiceTest, ReturnsWinningAdAfterScoring) {
             winner.interest_group_owner());
 }
 
+TYPED_TEST(SellerFrontEndServiceTest, ScoresBidsOfEachBuyerAsTheyArrive) {
+  this->config_.SetFlagForTest(kTrue, ENABLE_STREAMING_SCORING);
+  this->SetupRequestWithTwoBuyers();
+  absl::flat_hash_map<BuyerHostname, AdUrl> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  const std::string winning_buyer =
+      this->request_.auction_config().buyer_list(0);
+
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    SetupBuyerClientMock(buyer, buyer_clients,
+                         BuildGetBidsResponseWithSingleAd(
+                             buyer_to_ad_url.at(buyer), "testIg", 1.0));
+  }
+
+  // The scoring signals are fetched for the bids of each buyer on its own.
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  EXPECT_CALL(scoring_signals_provider, Get)
+      .Times(2)
+      .WillRepeatedly([](const ScoringSignalsRequest& scoring_signals_request,
+                         ScoringSignalsDoneCallback on_done,
+                         absl::Duration timeout) {
+        EXPECT_EQ(scoring_signals_request.buyer_bids_map_.size(), 1);
+        auto scoring_signals = std::make_unique<ScoringSignals>();
+        scoring_signals->scoring_signals =
+            std::make_unique<std::string>("test scoring signals");
+        std::move(on_done)(std::move(scoring_signals));
+      });
+
+  // The bids of each buyer are scored on their own, and the highest scored ad
+  // of all of them wins.
+  ScoringAsyncClientMock scoring_client;
+  EXPECT_CALL(scoring_client, ExecuteInternal)
+      .Times(2)
+      .WillRepeatedly(
+          [&winning_buyer](
+              std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> request,
+              const RequestMetadata& metadata, ScoreAdsDoneCallback on_done,
+              absl::Duration timeout) {
+            EXPECT_EQ(request->ad_bids_size(), 1);
+            EXPECT_EQ(request->scoring_signals(), "test scoring signals");
+            const AdWithBidMetadata& bid = request->ad_bids(0);
+            auto response =
+                std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>();
+            AdScore* score = response->mutable_ad_score();
+            score->set_render(bid.render());
+            score->set_interest_group_name(bid.interest_group_name());
+            score->set_interest_group_owner(bid.interest_group_owner());
+            score->set_buyer_bid(bid.bid());
+            score->set_desirability(
+                bid.interest_group_owner() == winning_buyer ? 10 : 1);
+            std::move(on_done)(std::move(response));
+            return absl::OkStatus();
+          });
+
+  ClientRegistry clients{scoring_signals_provider, scoring_client,
+                         buyer_clients, this->key_fetcher_manager_,
+                         std::make_unique<MockAsyncReporter>(
+                             std::make_unique<MockHttpFetcherAsync>())};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+
+  AuctionResult auction_result = DecryptBrowserAuctionResult(
+      response.auction_result_ciphertext(), *this->context_);
+  EXPECT_EQ(auction_result.interest_group_owner(), winning_buyer);
+  EXPECT_EQ(auction_result.ad_render_url(), buyer_to_ad_url.at(winning_buyer));
+  EXPECT_EQ(auction_result.score(), 10);
+}
+
+TYPED_TEST(SellerFrontEndServiceTest, ScoresBidsOfTheFirstBuyersSpeculatively) {
+  this->config_.SetFlagForTest("50", SPECULATIVE_SCORING_BUYER_PERCENT);
+  this->SetupRequestWithTwoBuyers();
+  absl::flat_hash_map<BuyerHostname, AdUrl> buyer_to_ad_url =
+      BuildBuyerWinningAdUrlMap(this->request_);
+  const std::string winning_buyer =
+      this->request_.auction_config().buyer_list(1);
+
+  BuyerFrontEndAsyncClientFactoryMock buyer_clients;
+  for (const auto& [buyer, unused] :
+       this->protected_auction_input_.buyer_input()) {
+    SetupBuyerClientMock(buyer, buyer_clients,
+                         BuildGetBidsResponseWithSingleAd(
+                             buyer_to_ad_url.at(buyer), "testIg", 1.0));
+  }
+
+  // Half of the buyers responded once the first one did, so its bids are
+  // scored speculatively, and the bids of the second one on their own.
+  MockAsyncProvider<ScoringSignalsRequest, ScoringSignals>
+      scoring_signals_provider;
+  EXPECT_CALL(scoring_signals_provider, Get)
+      .Times(2)
+      .WillRepeatedly([](const ScoringSignalsRequest& scoring_signals_request,
+                         ScoringSignalsDoneCallback on_done,
+                         absl::Duration timeout) {
+        EXPECT_EQ(scoring_signals_request.buyer_bids_map_.size(), 1);
+        auto scoring_signals = std::make_unique<ScoringSignals>();
+        scoring_signals->scoring_signals =
+            std::make_unique<std::string>("test scoring signals");
+        std::move(on_done)(std::move(scoring_signals));
+      });
+
+  ScoringAsyncClientMock scoring_client;
+  EXPECT_CALL(scoring_client, ExecuteInternal)
+      .Times(2)
+      .WillRepeatedly(
+          [&winning_buyer](
+              std::unique_ptr<ScoreAdsRequest::ScoreAdsRawRequest> request,
+              const RequestMetadata& metadata, ScoreAdsDoneCallback on_done,
+              absl::Duration timeout) {
+            EXPECT_EQ(request->ad_bids_size(), 1);
+            const AdWithBidMetadata& bid = request->ad_bids(0);
+            auto response =
+                std::make_unique<ScoreAdsResponse::ScoreAdsRawResponse>();
+            AdScore* score = response->mutable_ad_score();
+            score->set_render(bid.render());
+            score->set_interest_group_name(bid.interest_group_name());
+            score->set_interest_group_owner(bid.interest_group_owner());
+            score->set_buyer_bid(bid.bid());
+            score->set_desirability(
+                bid.interest_group_owner() == winning_buyer ? 10 : 1);
+            std::move(on_done)(std::move(response));
+            return absl::OkStatus();
+          });
+
+  ClientRegistry clients{scoring_signals_provider, scoring_client,
+                         buyer_clients, this->key_fetcher_manager_,
+                         std::make_unique<MockAsyncReporter>(
+                             std::make_unique<MockHttpFetcherAsync>())};
+  Response response =
+      RunRequest<SelectAdReactorForWeb>(this->config_, clients, this->request_);
+
+  AuctionResult auction_result = DecryptBrowserAuctionResult(
+      response.auction_result_ciphertext(), *this->context_);
+  EXPECT_EQ(auction_result.interest_group_owner(), winning_buyer);
+  EXPECT_EQ(auction_result.ad_render_url(), buyer_to_ad_url.at(winning_buyer));
+  EXPECT_EQ(auction_result.score(), 10);
+}
+
 TYPED_TEST(SellerFrontEndServiceTest, ReturnsBiddingGroups) {
   // Setup a buyer input with two interest groups that will have non-zero bids
   // from the bidding service, another interest group with 0 bid and the last
@@ -21,7 +21,7 @@
 #include "absl/functional/bind_front.h"
 #include "absl/strings/str_format.h"
 #include "glog/logging.h"
-#include "services/common/compression/gzip.h"
+#include "services/common/compression/zstd.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/common/util/status_macros.h"
 #include "services/seller_frontend_service/util/framing_utils.h"
@@ -78,17 +78,15 @@ absl::StatusOr<std::string> SelectAdReactorForWeb::GetNonEncryptedResponse(
   absl::string_view data_to_compress = absl::string_view(
       reinterpret_cast<char*>(encoded_data.data()), encoded_data.size());
 
-  absl::StatusOr<std::string> compressed_data = GzipCompress(data_to_compress);
-  if (!compressed_data.ok()) {
+  absl::StatusOr<std::string> framed_data =
+      GzipCompressAndEncodeResponsePayload(data_to_compress);
+  if (!framed_data.ok()) {
     LOG(ERROR) << "Failed to compress the CBOR serialized data: "
-               << compressed_data.status().message();
+               << framed_data.status().message();
     FinishWithInternalError("Failed to compress CBOR data");
     return absl::InternalError("");
   }
-
-  return server_common::EncodeResponsePayload(
-      server_common::CompressionType::kGzip, *compressed_data,
-      GetEncodedDataSize(compressed_data->size()));
+  return framed_data;
 }
 
 ProtectedAudienceInput SelectAdReactorForWeb::GetDecodedProtectedAudienceInput(
@@ -113,8 +111,42 @@ ProtectedAuctionInput SelectAdReactorForWeb::GetDecodedProtectedAuctionInput(
 
 DecodedBuyerInputs SelectAdReactorForWeb::GetDecodedBuyerinputs(
     const EncodedBuyerInputs& encoded_buyer_inputs) {
-  return DecodeBuyerInputs(encoded_buyer_inputs, error_accumulator_,
-                           fail_fast_);
+  if (forward_compressed_buyer_inputs_) {
+    // Filled before the parallel decoding, which only reads it.
+    for (const auto& [owner, encoded_buyer_input] : encoded_buyer_inputs) {
+      if (!IsZstdFrame(encoded_buyer_input)) {
+        forwarded_buyer_inputs_.emplace(owner, encoded_buyer_input);
+      }
+    }
+  }
+  return DecodeBuyerInputsInParallel(
+      encoded_buyer_inputs,
+      [this](absl::string_view owner, absl::string_view encoded_buyer_input,
+             ErrorAccumulator& error_accumulator) {
+        if (forwarded_buyer_inputs_.contains(owner)) {
+          return SummarizeBuyerInput(owner, encoded_buyer_input,
+                                     error_accumulator, fail_fast_);
+        }
+        return DecodeBuyerInput(owner, encoded_buyer_input, error_accumulator,
+                                fail_fast_, clients_.buyer_input_codec);
+      });
+}
+
+std::unique_ptr<GetBidsRequest::GetBidsRawRequest>
+SelectAdReactorForWeb::CreateGetBidsRequest(absl::string_view seller,
+                                            const std::string& buyer_ig_owner,
+                                            BuyerInput buyer_input) {
+  auto forwarded_buyer_input = forwarded_buyer_inputs_.find(buyer_ig_owner);
+  if (forwarded_buyer_input == forwarded_buyer_inputs_.end()) {
+    return SelectAdReactor::CreateGetBidsRequest(seller, buyer_ig_owner,
+                                                 std::move(buyer_input));
+  }
+  auto get_bids_request = SelectAdReactor::CreateGetBidsRequest(
+      seller, buyer_ig_owner, BuyerInput());
+  get_bids_request->clear_buyer_input();
+  get_bids_request->set_compressed_buyer_input(
+      std::string(forwarded_buyer_input->second));
+  return get_bids_request;
 }
 
 }  // namespace privacy_sandbox::bidding_auction_servers
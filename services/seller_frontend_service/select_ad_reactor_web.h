@@ -17,11 +17,13 @@
 #ifndef SERVICES_SELLER_FRONTEND_SERVICE_SELECT_AD_REACTOR_WEB_H_
 #define SERVICES_SELLER_FRONTEND_SERVICE_SELECT_AD_REACTOR_WEB_H_
 
+#include <memory>
 #include <optional>
 #include <string>
 
 #include <grpcpp/grpcpp.h>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "include/grpcpp/impl/codegen/server_callback.h"
 #include "services/seller_frontend_service/select_ad_reactor.h"
@@ -53,9 +55,22 @@ class SelectAdReactorForWeb : public SelectAdReactor {
   ProtectedAuctionInput GetDecodedProtectedAuctionInput(
       absl::string_view encoded_data) override;
 
+  // Only summarizes the gzip compressed buyer inputs if they are forwarded,
+  // as the BFEs do not have the zstd dictionaries to decompress the others.
   absl::flat_hash_map<absl::string_view, BuyerInput> GetDecodedBuyerinputs(
       const google::protobuf::Map<std::string, std::string>&
           encoded_buyer_inputs) override;
+
+  // Forwards the compressed buyer input of the buyer instead of buyer_input,
+  // if it is forwarded.
+  std::unique_ptr<GetBidsRequest::GetBidsRawRequest> CreateGetBidsRequest(
+      absl::string_view seller, const std::string& buyer_ig_owner,
+      BuyerInput buyer_input) override;
+
+ private:
+  // Compressed buyer inputs forwarded as is to the buyers, by owner.
+  absl::flat_hash_map<absl::string_view, absl::string_view>
+      forwarded_buyer_inputs_;
 };
 
 }  // namespace privacy_sandbox::bidding_auction_servers
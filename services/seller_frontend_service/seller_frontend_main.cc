@@ -14,9 +14,11 @@
 
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/debugging/symbolize.h"
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/log/check.h"
@@ -31,16 +33,38 @@
 #include "grpcpp/health_check_service_interface.h"
 #include "opentelemetry/metrics/provider.h"
 #include "public/cpio/interface/cpio.h"
+#include "services/common/clients/async_grpc/channel_warmer.h"
+#include "services/common/clients/async_grpc/message_compression.h"
+#include "services/common/clients/circuit_breaker.h"
+#include "services/common/clients/mirroring_async_client.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/config/trusted_server_config_client_util.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/hedging_http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/key_value_cache.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/encryption/ohttp_gateway_cache.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/reporters/async_reporter.h"
+#include "services/common/reporters/debug_report_limiter.h"
 #include "services/common/telemetry/configure_telemetry.h"
+#include "services/common/telemetry/profiling_service.h"
+#include "services/common/util/cancellation_token.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/grpc_server_options.h"
+#include "services/common/util/heap_stats.h"
+#include "services/common/util/memory_governor.h"
+#include "services/common/util/request_memory_budget.h"
+#include "services/common/util/request_timeline.h"
+#include "services/common/util/server_readiness.h"
 #include "services/common/util/signal_handler.h"
 #include "services/common/util/status_macros.h"
+#include "services/common/util/work_stealing_executor.h"
+#include "services/common/util/worker_processes.h"
 #include "services/seller_frontend_service/runtime_flags.h"
 #include "services/seller_frontend_service/seller_frontend_service.h"
+#include "services/seller_frontend_service/util/buyer_latency_budget.h"
 #include "services/seller_frontend_service/util/config_param_parser.h"
 #include "src/cpp/encryption/key_fetcher/src/key_fetcher_manager.h"
 
@@ -65,15 +89,108 @@ ABSL_FLAG(std::optional<bool>, enable_buyer_compression, true,
           "Flag to enable buyer client compression. True by default.");
 ABSL_FLAG(std::optional<bool>, enable_auction_compression, true,
           "Flag to enable auction client compression. True by default.");
+ABSL_FLAG(std::optional<std::string>, grpc_compression_algorithm, "gzip",
+          "Algorithm of the requests compressed to the buyers and the "
+          "Auction server: gzip or deflate.");
+ABSL_FLAG(std::optional<int>, grpc_compression_min_message_bytes, 1024,
+          "Requests to the buyers and the Auction server smaller than this "
+          "are sent uncompressed.");
 ABSL_FLAG(std::optional<bool>, enable_seller_frontend_benchmarking,
           std::nullopt, "Flag to enable benchmarking.");
 ABSL_FLAG(
     std::optional<bool>, create_new_event_engine, std::nullopt,
     "Share the event engine with gprc when false , otherwise create new one");
+ABSL_FLAG(std::optional<bool>, enable_curl_event_loop, false,
+          "Drive HTTP fetches with an epoll based curl event loop on a "
+          "dedicated thread instead of polling curl on the executor.");
+ABSL_FLAG(std::optional<bool>, enable_kv_http2_multiplexing, false,
+          "Multiplex the Key-Value server fetches over HTTP/2 connections "
+          "instead of opening a connection per concurrent fetch.");
+ABSL_FLAG(std::optional<bool>, enable_kv_request_coalescing, false,
+          "Share a single Key-Value server fetch between the concurrent "
+          "requests for the same keys.");
+ABSL_FLAG(std::optional<bool>, enable_kv_post_requests, false,
+          "Send the Key-Value server lookups as JSON in the body of POST "
+          "requests instead of in the query string of GET requests.");
+ABSL_FLAG(std::optional<bool>, enable_kv_request_compression, false,
+          "Gzip the body of the Key-Value server POST requests.");
+ABSL_FLAG(std::optional<int>, kv_max_keys_per_request, 0,
+          "Split Key-Value server lookups of more keys into parallel requests "
+          "of at most this many keys. Lookups are not split when 0.");
+ABSL_FLAG(std::optional<int>, kv_batch_max_keys, 0,
+          "Merge the Key-Value server lookups of concurrent requests with the "
+          "same headers into a single lookup of up to this many keys. "
+          "Lookups are not batched when 0.");
+ABSL_FLAG(std::optional<int>, kv_batch_max_delay_us, 500,
+          "Time in microseconds a batch of Key-Value server lookups waits for "
+          "other lookups before it is sent.");
+ABSL_FLAG(std::optional<bool>, enable_kv_table_responses, false,
+          "Ask the Key-Value server for key-value tables instead of JSON, so "
+          "that the bidding and auction services slice the values of each "
+          "key without parsing JSON.");
+ABSL_FLAG(std::optional<bool>, enable_kv_request_hedging, false,
+          "Send a Key-Value server fetch again over a new connection when it "
+          "takes longer than a percentile of the recent fetch latencies.");
+ABSL_FLAG(std::optional<int>, kv_hedging_latency_percentile, 95,
+          "Percentile of the recent Key-Value server fetch latencies after "
+          "which a fetch is hedged.");
+ABSL_FLAG(std::optional<int>, kv_hedging_budget_percent, 5,
+          "Max hedged Key-Value server fetches, as a percentage of the "
+          "fetches.");
+ABSL_FLAG(std::optional<int>, scoring_signals_cache_ttl_ms, 0,
+          "Max time to cache the scoring signals of the render URLs and ad "
+          "component render URLs. The cache is disabled when 0.");
+ABSL_FLAG(std::optional<int>, scoring_signals_cache_max_bytes,
+          64 * 1024 * 1024,
+          "Max bytes of the URLs and scoring signals held by the scoring "
+          "signals cache.");
+ABSL_FLAG(std::optional<int>, scoring_signals_cache_miss_ttl_ms, 0,
+          "Max time to cache the render URLs and ad component render URLs "
+          "without scoring signals, so that they are not looked up again. Not "
+          "cached when 0.");
+ABSL_FLAG(std::optional<bool>, enable_streaming_scoring, false,
+          "Score the bids of each buyer as soon as they arrive, and pick the "
+          "highest scored ad of all the buyers. The reporting signals then "
+          "only account for the bids of the winning buyer.");
+ABSL_FLAG(std::optional<bool>, enable_streamed_get_bids, false,
+          "With streaming scoring, get the bids of the buyers with "
+          "GetBidsStream, and score each part of the bids of a buyer as soon "
+          "as it arrives rather than once the buyer is done.");
+ABSL_FLAG(std::optional<int>, speculative_scoring_buyer_percent, 0,
+          "Once this percentage of the buyers responded while others are "
+          "still pending, score the bids received so far, and only score the "
+          "later bids once all the buyers are done, picking the highest "
+          "scored ad of both. The reporting signals then only account for "
+          "the bids scored with the winner. Disabled when 0, and with "
+          "streaming scoring.");
+ABSL_FLAG(std::optional<bool>, enable_buyer_latency_budget, false,
+          "Cut the GetBids timeout of each buyer to the time left before the "
+          "SelectAd deadline and to a percentile of the recent latencies of "
+          "the buyer. The auction is scored without the late buyers.");
+ABSL_FLAG(std::optional<int>, buyer_latency_budget_percentile, 99,
+          "Percentile of the recent GetBids latencies of a buyer after which "
+          "its call is given up on.");
+ABSL_FLAG(std::optional<int>, buyer_latency_budget_scoring_reserve_ms, 50,
+          "Time kept before the SelectAd deadline for scoring the bids.");
+ABSL_FLAG(std::optional<bool>, enable_buyer_circuit_breaker, false,
+          "Stop calling a buyer for a while when too many of its recent "
+          "GetBids calls failed or timed out, and then probe it with a "
+          "single call.");
+ABSL_FLAG(std::optional<int>, buyer_circuit_breaker_failure_percent, 50,
+          "Percentage of failed recent GetBids calls to a buyer that stops "
+          "the calls to the buyer.");
+ABSL_FLAG(std::optional<int>, buyer_circuit_breaker_open_ms, 5000,
+          "Time the calls to a failing buyer are stopped for before a probe "
+          "call.");
 ABSL_FLAG(
     bool, init_config_client, false,
     "Initialize config client to fetch any runtime flags not supplied from"
     " command line from cloud metadata store. False by default.");
+ABSL_FLAG(int, worker_processes, 1,
+          "Number of processes the server is sharded across, each with an "
+          "executor and HTTP fetchers of its own, listening on the same port "
+          "with SO_REUSEPORT. Only read from the command line, since the "
+          "workers are forked before the config client starts any thread.");
 ABSL_FLAG(std::optional<bool>, sfe_ingress_tls, std::nullopt,
           "If true, frontend gRPC service terminates TLS");
 ABSL_FLAG(std::optional<std::string>, sfe_tls_key, std::nullopt,
@@ -84,6 +201,70 @@ ABSL_FLAG(std::optional<bool>, auction_egress_tls, std::nullopt,
           "If true, auction service gRPC client uses TLS.");
 ABSL_FLAG(std::optional<bool>, buyer_egress_tls, std::nullopt,
           "If true, buyer frontend service gRPC clients uses TLS.");
+ABSL_FLAG(std::optional<int>, auction_channel_pool_size, 1,
+          "Number of gRPC channels, each with a connection of its own, the "
+          "calls to the auction service are spread across.");
+ABSL_FLAG(std::optional<int>, auction_flow_control_window_bytes, 0,
+          "Initial HTTP/2 flow-control window of the auction service gRPC "
+          "client, or 0 for the gRPC default.");
+ABSL_FLAG(std::optional<bool>, auction_least_loaded_routing, false,
+          "If true, each call to the auction service goes to the less loaded "
+          "of two channels of the pool drawn at random, by the calls "
+          "outstanding on them and the load the servers report, rather than "
+          "round robin.");
+ABSL_FLAG(std::optional<std::string>, shadow_auction_server_host, "",
+          "Auction service, such as a canary of a new build or Roma config, "
+          "that a sample of the decrypted ScoreAds calls is mirrored to. Its "
+          "responses are discarded, and only its latency is exported next to "
+          "the primary's. Disabled if empty.");
+ABSL_FLAG(std::optional<int>, shadow_traffic_percent, 0,
+          "Percentage of the ScoreAds calls mirrored to the shadow auction "
+          "service, picked at random.");
+ABSL_FLAG(std::optional<int>, buyer_channel_pool_size, 1,
+          "Number of gRPC channels, each with a connection of its own, the "
+          "calls to each buyer frontend service are spread across.");
+ABSL_FLAG(std::optional<int>, buyer_flow_control_window_bytes, 0,
+          "Initial HTTP/2 flow-control window of the buyer frontend service "
+          "gRPC clients, or 0 for the gRPC default.");
+ABSL_FLAG(std::optional<int>, reporting_threads, 0,
+          "The number of low priority threads the debug and win reports run "
+          "on, with a fetcher of their own. 0 keeps them on the threads and "
+          "the fetcher of the other HTTP fetches.");
+ABSL_FLAG(std::optional<int>, reporting_max_in_flight, 0,
+          "Max debug and win reports in flight. 0 for no limit.");
+ABSL_FLAG(std::optional<int>, cpu_executor_threads, 0,
+          "The number of threads, usually one per core, the buyer inputs are "
+          "decoded and the GetBids requests encrypted on. 0 keeps them on the "
+          "threads of the HTTP fetches and the RPC callbacks.");
+ABSL_FLAG(std::optional<int>, debug_loss_reports_per_request, 0,
+          "Max debug loss reports sent for a request. 0 for no limit.");
+ABSL_FLAG(std::optional<int>, debug_loss_reports_per_second, 0,
+          "Max debug loss reports sent by the server in a second. 0 for no "
+          "limit.");
+ABSL_FLAG(std::optional<int>, debug_loss_report_percent, 100,
+          "Percentage of the debug loss reports sent, picked at random.");
+ABSL_FLAG(std::optional<std::string>, request_shape_capture_path, "",
+          "File the shapes of the requests received are appended to, with no "
+          "user data, for secure_invoke to replay. Only honoured in test "
+          "mode. Disabled if empty.");
+ABSL_FLAG(std::optional<std::string>, buyer_input_zstd_dictionary_paths, "",
+          "Comma separated files of the zstd dictionaries that clients may "
+          "compress the buyer inputs with instead of gzip. Only gzip is "
+          "accepted if empty.");
+ABSL_FLAG(std::optional<bool>, enable_channel_pre_warming, false,
+          "Connect the channels to the buyers and the auction service at "
+          "startup and keep them connected, reporting the server ready only "
+          "once they answered a health check or the pre-warming timeout "
+          "passed.");
+ABSL_FLAG(std::optional<int>, channel_pre_warming_timeout_ms, 10000,
+          "Time after which the server is reported ready even if some "
+          "channels are not warm yet.");
+ABSL_FLAG(std::optional<bool>, forward_compressed_buyer_inputs, false,
+          "Forward the gzip compressed buyer inputs of browsers to the buyers "
+          "as the clients sent them, decoding only the names and browser "
+          "signals of their interest groups, and leave the full decoding to "
+          "the BFEs. Ignored with request shape capture, which needs the "
+          "full buyer inputs.");
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -107,14 +288,95 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         ENABLE_BUYER_COMPRESSION);
   config_client.SetFlag(FLAGS_enable_auction_compression,
                         ENABLE_AUCTION_COMPRESSION);
+  config_client.SetFlag(FLAGS_grpc_compression_algorithm,
+                        GRPC_COMPRESSION_ALGORITHM);
+  config_client.SetFlag(FLAGS_grpc_compression_min_message_bytes,
+                        GRPC_COMPRESSION_MIN_MESSAGE_BYTES);
   config_client.SetFlag(FLAGS_enable_seller_frontend_benchmarking,
                         ENABLE_SELLER_FRONTEND_BENCHMARKING);
   config_client.SetFlag(FLAGS_create_new_event_engine, CREATE_NEW_EVENT_ENGINE);
+  config_client.SetFlag(FLAGS_enable_curl_event_loop, ENABLE_CURL_EVENT_LOOP);
+  config_client.SetFlag(FLAGS_enable_kv_http2_multiplexing,
+                        ENABLE_KV_HTTP2_MULTIPLEXING);
+  config_client.SetFlag(FLAGS_enable_kv_request_coalescing,
+                        ENABLE_KV_REQUEST_COALESCING);
+  config_client.SetFlag(FLAGS_enable_kv_post_requests, ENABLE_KV_POST_REQUESTS);
+  config_client.SetFlag(FLAGS_enable_kv_request_compression,
+                        ENABLE_KV_REQUEST_COMPRESSION);
+  config_client.SetFlag(FLAGS_kv_max_keys_per_request,
+                        KV_MAX_KEYS_PER_REQUEST);
+  config_client.SetFlag(FLAGS_kv_batch_max_keys, KV_BATCH_MAX_KEYS);
+  config_client.SetFlag(FLAGS_kv_batch_max_delay_us, KV_BATCH_MAX_DELAY_US);
+  config_client.SetFlag(FLAGS_enable_kv_table_responses,
+                        ENABLE_KV_TABLE_RESPONSES);
+  config_client.SetFlag(FLAGS_enable_kv_request_hedging,
+                        ENABLE_KV_REQUEST_HEDGING);
+  config_client.SetFlag(FLAGS_kv_hedging_latency_percentile,
+                        KV_HEDGING_LATENCY_PERCENTILE);
+  config_client.SetFlag(FLAGS_kv_hedging_budget_percent,
+                        KV_HEDGING_BUDGET_PERCENT);
+  config_client.SetFlag(FLAGS_scoring_signals_cache_ttl_ms,
+                        SCORING_SIGNALS_CACHE_TTL_MS);
+  config_client.SetFlag(FLAGS_scoring_signals_cache_max_bytes,
+                        SCORING_SIGNALS_CACHE_MAX_BYTES);
+  config_client.SetFlag(FLAGS_scoring_signals_cache_miss_ttl_ms,
+                        SCORING_SIGNALS_CACHE_MISS_TTL_MS);
+  config_client.SetFlag(FLAGS_enable_streaming_scoring,
+                        ENABLE_STREAMING_SCORING);
+  config_client.SetFlag(FLAGS_enable_streamed_get_bids,
+                        ENABLE_STREAMED_GET_BIDS);
+  config_client.SetFlag(FLAGS_speculative_scoring_buyer_percent,
+                        SPECULATIVE_SCORING_BUYER_PERCENT);
+  config_client.SetFlag(FLAGS_enable_buyer_latency_budget,
+                        ENABLE_BUYER_LATENCY_BUDGET);
+  config_client.SetFlag(FLAGS_buyer_latency_budget_percentile,
+                        BUYER_LATENCY_BUDGET_PERCENTILE);
+  config_client.SetFlag(FLAGS_buyer_latency_budget_scoring_reserve_ms,
+                        BUYER_LATENCY_BUDGET_SCORING_RESERVE_MS);
+  config_client.SetFlag(FLAGS_enable_buyer_circuit_breaker,
+                        ENABLE_BUYER_CIRCUIT_BREAKER);
+  config_client.SetFlag(FLAGS_buyer_circuit_breaker_failure_percent,
+                        BUYER_CIRCUIT_BREAKER_FAILURE_PERCENT);
+  config_client.SetFlag(FLAGS_buyer_circuit_breaker_open_ms,
+                        BUYER_CIRCUIT_BREAKER_OPEN_MS);
   config_client.SetFlag(FLAGS_sfe_ingress_tls, SFE_INGRESS_TLS);
   config_client.SetFlag(FLAGS_sfe_tls_key, SFE_TLS_KEY);
   config_client.SetFlag(FLAGS_sfe_tls_cert, SFE_TLS_CERT);
   config_client.SetFlag(FLAGS_auction_egress_tls, AUCTION_EGRESS_TLS);
   config_client.SetFlag(FLAGS_buyer_egress_tls, BUYER_EGRESS_TLS);
+  config_client.SetFlag(FLAGS_auction_channel_pool_size,
+                        AUCTION_CHANNEL_POOL_SIZE);
+  config_client.SetFlag(FLAGS_auction_flow_control_window_bytes,
+                        AUCTION_FLOW_CONTROL_WINDOW_BYTES);
+  config_client.SetFlag(FLAGS_auction_least_loaded_routing,
+                        AUCTION_LEAST_LOADED_ROUTING);
+  config_client.SetFlag(FLAGS_shadow_auction_server_host,
+                        SHADOW_AUCTION_SERVER_HOST);
+  config_client.SetFlag(FLAGS_shadow_traffic_percent, SHADOW_TRAFFIC_PERCENT);
+  config_client.SetFlag(FLAGS_buyer_channel_pool_size,
+                        BUYER_CHANNEL_POOL_SIZE);
+  config_client.SetFlag(FLAGS_buyer_flow_control_window_bytes,
+                        BUYER_FLOW_CONTROL_WINDOW_BYTES);
+  config_client.SetFlag(FLAGS_reporting_threads, REPORTING_THREADS);
+  config_client.SetFlag(FLAGS_reporting_max_in_flight,
+                        REPORTING_MAX_IN_FLIGHT);
+  config_client.SetFlag(FLAGS_cpu_executor_threads, CPU_EXECUTOR_THREADS);
+  config_client.SetFlag(FLAGS_debug_loss_reports_per_request,
+                        DEBUG_LOSS_REPORTS_PER_REQUEST);
+  config_client.SetFlag(FLAGS_debug_loss_reports_per_second,
+                        DEBUG_LOSS_REPORTS_PER_SECOND);
+  config_client.SetFlag(FLAGS_debug_loss_report_percent,
+                        DEBUG_LOSS_REPORT_PERCENT);
+  config_client.SetFlag(FLAGS_request_shape_capture_path,
+                        REQUEST_SHAPE_CAPTURE_PATH);
+  config_client.SetFlag(FLAGS_buyer_input_zstd_dictionary_paths,
+                        BUYER_INPUT_ZSTD_DICTIONARY_PATHS);
+  config_client.SetFlag(FLAGS_enable_channel_pre_warming,
+                        ENABLE_CHANNEL_PRE_WARMING);
+  config_client.SetFlag(FLAGS_channel_pre_warming_timeout_ms,
+                        CHANNEL_PRE_WARMING_TIMEOUT_MS);
+  config_client.SetFlag(FLAGS_forward_compressed_buyer_inputs,
+                        FORWARD_COMPRESSED_BUYER_INPUTS);
 
   config_client.SetFlag(FLAGS_enable_encryption, ENABLE_ENCRYPTION);
   config_client.SetFlag(FLAGS_test_mode, TEST_MODE);
@@ -149,6 +411,26 @@ absl::StatusOr<TrustedServersConfigClient> GetConfigClient(
                         ENABLE_OTEL_BASED_LOGGING);
   config_client.SetFlag(FLAGS_enable_protected_app_signals,
                         ENABLE_PROTECTED_APP_SIGNALS);
+  config_client.SetFlag(FLAGS_enable_boringssl_crypto,
+                        ENABLE_BORINGSSL_CRYPTO);
+  config_client.SetFlag(FLAGS_malloc_arena_max, MALLOC_ARENA_MAX);
+  config_client.SetFlag(FLAGS_heap_release_interval_ms,
+                        HEAP_RELEASE_INTERVAL_MS);
+  config_client.SetFlag(FLAGS_grpc_server_max_threads,
+                        GRPC_SERVER_MAX_THREADS);
+  config_client.SetFlag(FLAGS_grpc_server_memory_quota_mb,
+                        GRPC_SERVER_MEMORY_QUOTA_MB);
+  config_client.SetFlag(FLAGS_grpc_server_num_cqs, GRPC_SERVER_NUM_CQS);
+  config_client.SetFlag(FLAGS_grpc_max_concurrent_streams,
+                        GRPC_MAX_CONCURRENT_STREAMS);
+  config_client.SetFlag(FLAGS_enable_concurrency_limiter,
+                        ENABLE_CONCURRENCY_LIMITER);
+  config_client.SetFlag(FLAGS_concurrency_limit_max, CONCURRENCY_LIMIT_MAX);
+  config_client.SetFlag(FLAGS_memory_pressure_watermarks,
+                        MEMORY_PRESSURE_WATERMARKS);
+  config_client.SetFlag(FLAGS_request_memory_budget_mb,
+                        REQUEST_MEMORY_BUDGET_MB);
+  config_client.SetFlag(FLAGS_profiling_port, PROFILING_PORT);
 
   if (absl::GetFlag(FLAGS_init_config_client)) {
     PS_RETURN_IF_ERROR(config_client.Init(config_param_prefix)).LogError()
@@ -166,11 +448,20 @@ absl::Status RunServer() {
   TrustedServerConfigUtil config_util(absl::GetFlag(FLAGS_init_config_client));
   PS_ASSIGN_OR_RETURN(TrustedServersConfigClient config_client,
                       GetConfigClient(config_util.GetConfigParameterPrefix()));
+  PS_RETURN_IF_ERROR(
+      SetMallocArenaMax(config_client.GetIntParameter(MALLOC_ARENA_MAX)));
+  HeapReleaser heap_releaser(absl::Milliseconds(
+      config_client.GetIntParameter(HEAP_RELEASE_INTERVAL_MS)));
+  PS_ASSIGN_OR_RETURN(
+      const std::optional<MemoryWatermarks> memory_watermarks,
+      ParseMemoryWatermarks(
+          config_client.GetStringParameter(MEMORY_PRESSURE_WATERMARKS)));
 
   server_common::BuildDependentConfig telemetry_config(
       config_client
           .GetCustomParameter<server_common::TelemetryFlag>(TELEMETRY_CONFIG)
           .server_config);
+  const bool profiling_allowed = telemetry_config.ProfilingAllowed();
 
   std::string collector_endpoint =
       config_client.GetStringParameter(COLLECTOR_ENDPOINT).data();
@@ -183,24 +474,73 @@ absl::Status RunServer() {
                                  collector_endpoint);
   server_common::ConfigureLogger(CreateSharedAttributes(&config_util),
                                  collector_endpoint);
-  AddSystemMetric(metric::SfeContextMap(
+  auto* context_map = metric::SfeContextMap(
       std::move(telemetry_config),
       server_common::ConfigurePrivateMetrics(
           CreateSharedAttributes(&config_util),
           CreateMetricsOptions(telemetry_config.metric_export_interval_ms()),
           collector_endpoint),
-      config_util.GetService(), kOpenTelemetryVersion.data()));
+      config_util.GetService(), kOpenTelemetryVersion.data());
+  AddSystemMetric(context_map);
+  AddGrpcServerMetric(context_map);
+  AddConcurrencyLimiterMetric(context_map);
+  AddMemoryGovernorMetric(context_map);
+  AddSlowRequestMetric(context_map);
+  AddRequestMemoryBudgetMetric(context_map);
+  AddHttpConnectionMetric(context_map);
+  AddAsyncReporterMetric(context_map);
+  AddMessageCompressionMetric(context_map);
+  AddDebugReportLimiterMetric(context_map);
+  AddKeyValueCacheMetric(context_map);
+  AddHedgingMetric(context_map);
+  AddLateBuyerMetric(context_map);
+  AddCircuitBreakerMetric(context_map);
+  AddShadowTrafficMetric(context_map);
+  AddOhttpGatewayCacheMetric(context_map);
+  AddWorkStealingExecutorMetric(context_map);
+  AddCancelledWorkMetric(context_map);
 
   std::string server_address =
       absl::StrCat("0.0.0.0:", config_client.GetStringParameter(PORT));
   server_common::GrpcInit gprc_init;
 
+  // Connects the channels to the buyers and the auction service ahead of the
+  // first requests, the server being reported ready once they are warm, if
+  // enabled.
+  std::unique_ptr<ChannelWarmer> channel_warmer;
+  if (config_client.GetBooleanParameter(ENABLE_CHANNEL_PRE_WARMING)) {
+    channel_warmer = std::make_unique<ChannelWarmer>(absl::Milliseconds(
+        config_client.GetIntParameter(CHANNEL_PRE_WARMING_TIMEOUT_MS)));
+  }
   SellerFrontEndService seller_frontend_service(
       &config_client, CreateKeyFetcherManager(config_client),
-      CreateCryptoClient());
+      CreateCryptoClient(
+          config_client.GetBooleanParameter(ENABLE_BORINGSSL_CRYPTO)),
+      channel_warmer.get());
+  std::unique_ptr<MemoryGovernor> memory_governor;
+  if (memory_watermarks.has_value()) {
+    std::vector<MemoryGovernor::Listener> listeners;
+    listeners.push_back([&seller_frontend_service](MemoryPressure pressure) {
+      seller_frontend_service.OnMemoryPressure(pressure);
+    });
+    memory_governor = std::make_unique<MemoryGovernor>(
+        *memory_watermarks, kMemoryGovernorPeriod, std::move(listeners));
+  }
   grpc::EnableDefaultHealthCheckService(true);
   grpc::reflection::InitProtoReflectionServerBuilderPlugin();
   ServerBuilder builder;
+  ApplyGrpcServerOptions(
+      {.max_threads = config_client.GetIntParameter(GRPC_SERVER_MAX_THREADS),
+       .memory_quota_mb =
+           config_client.GetIntParameter(GRPC_SERVER_MEMORY_QUOTA_MB),
+       .num_cqs = config_client.GetIntParameter(GRPC_SERVER_NUM_CQS),
+       .max_concurrent_streams =
+           config_client.GetIntParameter(GRPC_MAX_CONCURRENT_STREAMS)},
+      builder);
+  if (WorkerProcessCount() > 1) {
+    // The workers all listen on the port.
+    builder.AddChannelArgument(GRPC_ARG_ALLOW_REUSEPORT, 1);
+  }
 
   if (config_client.GetBooleanParameter(SFE_INGRESS_TLS)) {
     std::vector<grpc::experimental::IdentityKeyCertPair> key_cert_pairs{{
@@ -226,16 +566,35 @@ absl::Status RunServer() {
   }
 
   builder.RegisterService(&seller_frontend_service);
+  // Served on its own port, only if allowed by the telemetry config.
+  ProfilingService profiling_service;
+  std::unique_ptr<Server> profiling_server;
+  if (profiling_allowed) {
+    PS_ASSIGN_OR_RETURN(
+        profiling_server,
+        StartProfilingServer(profiling_service,
+                             config_client.GetIntParameter(PROFILING_PORT)));
+  }
 
   std::unique_ptr<Server> server(builder.BuildAndStart());
   if (server == nullptr) {
     return absl::UnavailableError("Error starting Server.");
   }
+  std::optional<ServerReadiness> readiness;
+  if (channel_warmer != nullptr) {
+    readiness.emplace(server->GetHealthCheckService(), [&channel_warmer]() {
+      return channel_warmer->IsWarm();
+    });
+  }
 
-  VLOG(1) << "Server listening on " << server_address;
+  VLOG(1) << "Server listening on " << server_address
+          << " in worker process " << WorkerProcessIndex();
   // Wait for the server to shutdown. Note that some other thread must be
   // responsible for shutting down the server for this call to ever return.
   server->Wait();
+  if (profiling_server) {
+    profiling_server->Shutdown();
+  }
   return absl::OkStatus();
 }
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -243,7 +602,11 @@ absl::Status RunServer() {
 int main(int argc, char** argv) {
   signal(SIGSEGV, privacy_sandbox::bidding_auction_servers::SignalHandler);
   absl::ParseCommandLine(argc, argv);
+  absl::InitializeSymbolizer(argv[0]);
   google::InitGoogleLogging(argv[0]);
+  // Forked before the CPIO library and the config client start threads.
+  privacy_sandbox::bidding_auction_servers::RunWorkerProcesses(
+      absl::GetFlag(FLAGS_worker_processes));
 
   bool init_config_client = absl::GetFlag(FLAGS_init_config_client);
   google::scp::cpio::CpioOptions cpio_options;
@@ -14,19 +14,29 @@
 
 #include "services/seller_frontend_service/seller_frontend_service.h"
 
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
 #include <utility>
 
 #include <grpcpp/grpcpp.h>
 
+#include "absl/strings/str_split.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
 #include "include/grpcpp/impl/codegen/server_callback.h"
+#include "services/common/clients/async_grpc/message_compression.h"
+#include "services/common/clients/mirroring_async_client.h"
+#include "services/common/clients/http_kv_server/util/hedging_http_fetcher_async.h"
+#include "services/common/clients/http_kv_server/util/single_flight_http_fetcher_async.h"
 #include "services/common/metric/server_definition.h"
+#include "services/common/util/thread_pool_executor.h"
+#include "services/common/util/work_stealing_executor.h"
 #include "services/seller_frontend_service/select_ad_reactor.h"
 #include "services/seller_frontend_service/select_ad_reactor_app.h"
 #include "services/seller_frontend_service/select_ad_reactor_invalid_client.h"
 #include "services/seller_frontend_service/select_ad_reactor_web.h"
-#include "src/cpp/telemetry/telemetry.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -75,11 +85,272 @@ std::unique_ptr<SelectAdReactor> GetReactorForRequest(
 
 }  // namespace
 
+std::unique_ptr<HttpFetcherAsync> SellerFrontEndService::CreateKeyValueFetcher(
+    const TrustedServersConfigClient& config_client,
+    server_common::Executor* executor) {
+  std::unique_ptr<HttpFetcherAsync> fetcher =
+      std::make_unique<MultiCurlHttpFetcherAsync>(
+          executor, /*keepalive_interval_sec=*/2,
+          /*keepalive_idle_sec=*/2,
+          config_client.GetBooleanParameter(ENABLE_CURL_EVENT_LOOP),
+          config_client.GetBooleanParameter(ENABLE_KV_HTTP2_MULTIPLEXING));
+  if (config_client.GetBooleanParameter(ENABLE_KV_REQUEST_HEDGING)) {
+    fetcher = std::make_unique<HedgingHttpFetcherAsync>(
+        std::move(fetcher), executor,
+        HedgingOptions{
+            .latency_percentile =
+                config_client.GetIntParameter(KV_HEDGING_LATENCY_PERCENTILE),
+            .budget_percent =
+                config_client.GetIntParameter(KV_HEDGING_BUDGET_PERCENT)});
+  }
+  if (config_client.GetBooleanParameter(ENABLE_KV_REQUEST_COALESCING)) {
+    fetcher =
+        std::make_unique<SingleFlightHttpFetcherAsync>(std::move(fetcher));
+  }
+  return fetcher;
+}
+
+std::unique_ptr<server_common::Executor>
+SellerFrontEndService::CreateReportingExecutor(
+    const TrustedServersConfigClient& config_client,
+    server_common::Executor* executor) {
+  const int reporting_threads =
+      config_client.GetIntParameter(REPORTING_THREADS);
+  if (reporting_threads <= 0) {
+    return nullptr;
+  }
+  return std::make_unique<ThreadPoolExecutor>(reporting_threads, executor,
+                                              kReportingThreadNice);
+}
+
+std::unique_ptr<server_common::Executor>
+SellerFrontEndService::CreateCpuExecutor(
+    const TrustedServersConfigClient& config_client,
+    server_common::Executor* executor) {
+  const int cpu_executor_threads =
+      config_client.GetIntParameter(CPU_EXECUTOR_THREADS);
+  if (cpu_executor_threads <= 0) {
+    return nullptr;
+  }
+  return std::make_unique<WorkStealingExecutor>(cpu_executor_threads,
+                                                executor);
+}
+
+std::unique_ptr<DebugReportLimiter>
+SellerFrontEndService::CreateDebugReportLimiter(
+    const TrustedServersConfigClient& config_client) {
+  return std::make_unique<DebugReportLimiter>(DebugReportLimits{
+      .max_loss_reports_per_request =
+          config_client.GetIntParameter(DEBUG_LOSS_REPORTS_PER_REQUEST),
+      .max_loss_reports_per_second =
+          config_client.GetIntParameter(DEBUG_LOSS_REPORTS_PER_SECOND),
+      .loss_report_sample_percent =
+          config_client.GetIntParameter(DEBUG_LOSS_REPORT_PERCENT)});
+}
+
+std::unique_ptr<ConcurrencyLimiter>
+SellerFrontEndService::CreateConcurrencyLimiter(
+    const TrustedServersConfigClient& config_client) {
+  if (config_client.GetBooleanParameter(ENABLE_CONCURRENCY_LIMITER)) {
+    return std::make_unique<ConcurrencyLimiter>(ConcurrencyLimiterOptions{
+        .max_limit = config_client.GetIntParameter(CONCURRENCY_LIMIT_MAX)});
+  }
+  if (!config_client.GetStringParameter(MEMORY_PRESSURE_WATERMARKS).empty()) {
+    // Only sheds requests under memory pressure.
+    return std::make_unique<ConcurrencyLimiter>(FixedConcurrencyLimit(
+        config_client.GetIntParameter(CONCURRENCY_LIMIT_MAX)));
+  }
+  return nullptr;
+}
+
+std::unique_ptr<RequestShapeRecorder>
+SellerFrontEndService::CreateRequestShapeRecorder(
+    const TrustedServersConfigClient& config_client) {
+  absl::string_view path =
+      config_client.GetStringParameter(REQUEST_SHAPE_CAPTURE_PATH);
+  if (path.empty()) {
+    return nullptr;
+  }
+  // The shapes hold no user data, but are only meant to be captured off
+  // production.
+  if (!config_client.GetBooleanParameter(TEST_MODE)) {
+    LOG(WARNING) << "Ignoring " << REQUEST_SHAPE_CAPTURE_PATH
+                 << " outside of test mode";
+    return nullptr;
+  }
+  absl::StatusOr<std::unique_ptr<RequestShapeRecorder>> recorder =
+      RequestShapeRecorder::Create(path);
+  if (!recorder.ok()) {
+    LOG(ERROR) << "Not capturing the request shapes: " << recorder.status();
+    return nullptr;
+  }
+  return *std::move(recorder);
+}
+
+std::unique_ptr<ZstdDictionaryCodec>
+SellerFrontEndService::CreateBuyerInputCodec(
+    const TrustedServersConfigClient& config_client) {
+  absl::string_view paths =
+      config_client.GetStringParameter(BUYER_INPUT_ZSTD_DICTIONARY_PATHS);
+  if (paths.empty()) {
+    return nullptr;
+  }
+  auto codec = std::make_unique<ZstdDictionaryCodec>();
+  // The server should not start without the dictionaries the clients
+  // compress with.
+  for (absl::string_view path : absl::StrSplit(paths, ',', absl::SkipEmpty())) {
+    std::ifstream file{std::string(path), std::ios::binary};
+    CHECK(file) << "Unable to read the zstd dictionary " << path;
+    const std::string dictionary{std::istreambuf_iterator<char>(file),
+                                 std::istreambuf_iterator<char>()};
+    CHECK_OK(codec->AddDictionary(dictionary)) << path;
+  }
+  return codec;
+}
+
+std::unique_ptr<AsyncReporter> SellerFrontEndService::CreateReporter(
+    const TrustedServersConfigClient& config_client,
+    server_common::Executor* executor,
+    server_common::Executor* reporting_executor) {
+  AsyncReporterOptions options = kServerReportingOptions;
+  options.max_in_flight =
+      config_client.GetIntParameter(REPORTING_MAX_IN_FLIGHT);
+  if (reporting_executor == nullptr) {
+    return std::make_unique<AsyncReporter>(
+        std::make_unique<MultiCurlHttpFetcherAsync>(
+            executor, /*keepalive_interval_sec=*/2,
+            /*keepalive_idle_sec=*/2,
+            config_client.GetBooleanParameter(ENABLE_CURL_EVENT_LOOP),
+            /*enable_http2_multiplexing=*/true),
+        options, executor);
+  }
+  // The fetcher polls on its own thread rather than holding a thread of the
+  // pool.
+  return std::make_unique<AsyncReporter>(
+      std::make_unique<MultiCurlHttpFetcherAsync>(
+          reporting_executor, /*keepalive_interval_sec=*/2,
+          /*keepalive_idle_sec=*/2, /*use_event_loop=*/true,
+          /*enable_http2_multiplexing=*/true),
+      options, reporting_executor);
+}
+
+grpc_compression_algorithm SellerFrontEndService::GetCompressionAlgorithm(
+    const TrustedServersConfigClient& config_client) {
+  absl::StatusOr<grpc_compression_algorithm> algorithm =
+      ParseCompressionAlgorithm(
+          config_client.GetStringParameter(GRPC_COMPRESSION_ALGORITHM));
+  // The server should not start with an algorithm it cannot use.
+  CHECK_OK(algorithm);
+  return *algorithm;
+}
+
+std::unique_ptr<ScoringAsyncClient> SellerFrontEndService::CreateScoringClient(
+    const TrustedServersConfigClient& config_client,
+    server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+    CryptoClientWrapperInterface* crypto_client,
+    ChannelWarmer* channel_warmer) {
+  AuctionServiceClientConfig client_config = {
+      .server_addr = std::string(
+          config_client.GetStringParameter(AUCTION_SERVER_HOST)),
+      .compression =
+          config_client.GetBooleanParameter(ENABLE_AUCTION_COMPRESSION),
+      .secure_client = config_client.GetBooleanParameter(AUCTION_EGRESS_TLS),
+      .encryption_enabled =
+          config_client.GetBooleanParameter(ENABLE_ENCRYPTION),
+      .num_channels = config_client.GetIntParameter(AUCTION_CHANNEL_POOL_SIZE),
+      .flow_control_window_bytes =
+          config_client.GetIntParameter(AUCTION_FLOW_CONTROL_WINDOW_BYTES),
+      .compression_algorithm = GetCompressionAlgorithm(config_client),
+      .compression_min_message_bytes =
+          config_client.GetIntParameter(GRPC_COMPRESSION_MIN_MESSAGE_BYTES),
+      .channel_warmer = channel_warmer,
+      .least_loaded_routing =
+          config_client.GetBooleanParameter(AUCTION_LEAST_LOADED_ROUTING)};
+  auto client = std::make_unique<ScoringAsyncGrpcClient>(
+      key_fetcher_manager, crypto_client, client_config);
+  const std::string shadow_server_addr(
+      config_client.GetStringParameter(SHADOW_AUCTION_SERVER_HOST));
+  if (shadow_server_addr.empty()) {
+    return client;
+  }
+  client_config.server_addr = shadow_server_addr;
+  return std::make_unique<MirroringAsyncClient<
+      ScoreAdsRequest, ScoreAdsResponse, ScoreAdsRequest::ScoreAdsRawRequest,
+      ScoreAdsResponse::ScoreAdsRawResponse>>(
+      std::move(client),
+      std::make_shared<ScoringAsyncGrpcClient>(key_fetcher_manager,
+                                               crypto_client, client_config),
+      config_client.GetIntParameter(SHADOW_TRAFFIC_PERCENT));
+}
+
+KeyValueRequestOptions SellerFrontEndService::GetKeyValueRequestOptions(
+    const TrustedServersConfigClient& config_client,
+    server_common::Executor* executor) {
+  return {
+      .use_post = config_client.GetBooleanParameter(ENABLE_KV_POST_REQUESTS),
+      .compress_body =
+          config_client.GetBooleanParameter(ENABLE_KV_REQUEST_COMPRESSION),
+      .max_keys_per_request =
+          config_client.GetIntParameter(KV_MAX_KEYS_PER_REQUEST),
+      .accept_table =
+          config_client.GetBooleanParameter(ENABLE_KV_TABLE_RESPONSES),
+      .batch_max_keys = config_client.GetIntParameter(KV_BATCH_MAX_KEYS),
+      .batch_max_delay = absl::Microseconds(
+          config_client.GetIntParameter(KV_BATCH_MAX_DELAY_US)),
+      .batch_executor = executor};
+}
+
+std::shared_ptr<KeyValueCache> SellerFrontEndService::CreateScoringSignalsCache(
+    const TrustedServersConfigClient& config_client) {
+  const int ttl_ms =
+      config_client.GetIntParameter(SCORING_SIGNALS_CACHE_TTL_MS);
+  if (ttl_ms <= 0) {
+    return nullptr;
+  }
+  return std::make_shared<KeyValueCache>(
+      absl::Milliseconds(ttl_ms),
+      config_client.GetIntParameter(SCORING_SIGNALS_CACHE_MAX_BYTES),
+      /*num_shards=*/16,
+      absl::Milliseconds(
+          config_client.GetIntParameter(SCORING_SIGNALS_CACHE_MISS_TTL_MS)));
+}
+
+std::optional<CircuitBreakerOptions>
+SellerFrontEndService::GetBuyerCircuitBreakerOptions(
+    const TrustedServersConfigClient& config_client) {
+  if (!config_client.GetBooleanParameter(ENABLE_BUYER_CIRCUIT_BREAKER)) {
+    return std::nullopt;
+  }
+  return CircuitBreakerOptions{
+      .failure_percent =
+          config_client.GetIntParameter(BUYER_CIRCUIT_BREAKER_FAILURE_PERCENT),
+      .open_duration = absl::Milliseconds(
+          config_client.GetIntParameter(BUYER_CIRCUIT_BREAKER_OPEN_MS))};
+}
+
+std::unique_ptr<BuyerLatencyBudget>
+SellerFrontEndService::CreateBuyerLatencyBudget(
+    const TrustedServersConfigClient& config_client) {
+  if (!config_client.GetBooleanParameter(ENABLE_BUYER_LATENCY_BUDGET)) {
+    return nullptr;
+  }
+  return std::make_unique<BuyerLatencyBudget>(BuyerLatencyBudgetOptions{
+      .latency_percentile =
+          config_client.GetIntParameter(BUYER_LATENCY_BUDGET_PERCENTILE),
+      .scoring_reserve = absl::Milliseconds(config_client.GetIntParameter(
+          BUYER_LATENCY_BUDGET_SCORING_RESERVE_MS))});
+}
+
 grpc::ServerUnaryReactor* SellerFrontEndService::SelectAd(
     grpc::CallbackServerContext* context, const SelectAdRequest* request,
     SelectAdResponse* response) {
-  auto scope = opentelemetry::trace::Scope(
-      server_common::GetTracer()->StartSpan("SelectAd"));
+  ConcurrencyLimiter::Permit permit;
+  if (concurrency_limiter_ != nullptr) {
+    permit = concurrency_limiter_->TryAcquire(RequestClassOf(*request));
+    if (!permit) {
+      return FinishShedRequest(context);
+    }
+  }
   LogMetrics(request, response);
 
   VLOG(2) << "\nSelectAdRequest:\n" << request->DebugString();
@@ -92,8 +363,18 @@ grpc::ServerUnaryReactor* SellerFrontEndService::SelectAd(
 
   auto reactor = GetReactorForRequest(context, request, response, clients_,
                                       config_client_);
+  reactor->SetConcurrencyPermit(std::move(permit));
   reactor->Execute();
   return reactor.release();
 }
 
+void SellerFrontEndService::OnMemoryPressure(MemoryPressure pressure) {
+  if (scoring_signals_cache_ != nullptr) {
+    scoring_signals_cache_->SetCapacityScale(CacheScaleOf(pressure));
+  }
+  if (concurrency_limiter_ != nullptr) {
+    concurrency_limiter_->SetLimitScale(ConcurrencyScaleOf(pressure));
+  }
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -16,6 +16,7 @@
 #define SERVICES_SELLER_FRONTEND_SERVICE_SELLER_FRONTEND_SERVICE_H_
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -28,11 +29,18 @@
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client_factory.h"
 #include "services/common/clients/config/trusted_server_config_client.h"
 #include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/compression/zstd.h"
+#include "services/common/encryption/ohttp_gateway_cache.h"
 #include "services/common/reporters/async_reporter.h"
+#include "services/common/reporters/debug_report_limiter.h"
+#include "services/common/util/concurrency_limiter.h"
+#include "services/common/util/memory_governor.h"
 #include "services/seller_frontend_service/providers/http_scoring_signals_async_provider.h"
 #include "services/seller_frontend_service/providers/scoring_signals_async_provider.h"
 #include "services/seller_frontend_service/runtime_flags.h"
+#include "services/seller_frontend_service/util/buyer_latency_budget.h"
 #include "services/seller_frontend_service/util/config_param_parser.h"
+#include "services/seller_frontend_service/util/request_shape.h"
 #include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/cpp/concurrent/event_engine_executor.h"
 #include "src/cpp/encryption/key_fetcher/interface/key_fetcher_manager_interface.h"
@@ -48,6 +56,20 @@ struct ClientRegistry {
       buyer_factory;
   server_common::KeyFetcherManagerInterface& key_fetcher_manager_;
   std::unique_ptr<AsyncReporter> reporting;
+  // Decodes the buyer inputs of a request, and fetches the bids of the
+  // buyers, in parallel, if set.
+  server_common::Executor* executor = nullptr;
+  // Budgets the GetBids calls by the SelectAd deadline and the latencies of
+  // the buyers, if set.
+  BuyerLatencyBudget* buyer_latency_budget = nullptr;
+  // Caches the OHTTP gateways of the keys, if set.
+  OhttpGatewayCache* ohttp_gateway_cache = nullptr;
+  // Limits the debug loss reports sent, if set.
+  DebugReportLimiter* debug_report_limiter = nullptr;
+  // Records the shapes of the requests received, if set.
+  RequestShapeRecorder* request_shape_recorder = nullptr;
+  // Decompresses the buyer inputs compressed with zstd dictionaries, if set.
+  const ZstdDictionaryCodec* buyer_input_codec = nullptr;
 };
 
 // SellerFrontEndService implements business logic to orchestrate requests
@@ -57,11 +79,14 @@ struct ClientRegistry {
 // code in a secure privacy sandbox inside a secure Virtual Machine.
 class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
  public:
+  // channel_warmer: connects the channels to the buyers and the auction
+  // service ahead of their first calls, if set. Must outlive the service.
   SellerFrontEndService(
       const TrustedServersConfigClient* config_client,
       std::unique_ptr<server_common::KeyFetcherManagerInterface>
           key_fetcher_manager,
-      std::unique_ptr<CryptoClientWrapperInterface> crypto_client)
+      std::unique_ptr<CryptoClientWrapperInterface> crypto_client,
+      ChannelWarmer* channel_warmer = nullptr)
       : config_client_(*config_client),
         key_fetcher_manager_(std::move(key_fetcher_manager)),
         crypto_client_(std::move(crypto_client)),
@@ -69,26 +94,18 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
             config_client_.GetBooleanParameter(CREATE_NEW_EVENT_ENGINE)
                 ? grpc_event_engine::experimental::CreateEventEngine()
                 : grpc_event_engine::experimental::GetDefaultEventEngine())),
+        scoring_signals_cache_(CreateScoringSignalsCache(config_client_)),
         scoring_signals_async_provider_(
             std::make_unique<HttpScoringSignalsAsyncProvider>(
                 std::make_unique<SellerKeyValueAsyncHttpClient>(
                     config_client_.GetStringParameter(KEY_VALUE_SIGNALS_HOST),
-                    std::make_unique<MultiCurlHttpFetcherAsync>(
-                        executor_.get()),
-                    true))),
-        scoring_(std::make_unique<ScoringAsyncGrpcClient>(
-            key_fetcher_manager_.get(), crypto_client_.get(),
-            AuctionServiceClientConfig{
-                .server_addr =
-                    config_client_.GetStringParameter(AUCTION_SERVER_HOST)
-                        .data(),
-                .compression = config_client_.GetBooleanParameter(
-                    ENABLE_AUCTION_COMPRESSION),
-                .secure_client =
-                    config_client_.GetBooleanParameter(AUCTION_EGRESS_TLS),
-                .encryption_enabled =
-                    config_client_.GetBooleanParameter(ENABLE_ENCRYPTION)})),
-        buyer_factory_([this]() {
+                    CreateKeyValueFetcher(config_client_, executor_.get()),
+                    true,
+                    GetKeyValueRequestOptions(config_client_, executor_.get())),
+                scoring_signals_cache_)),
+        scoring_(CreateScoringClient(config_client_, key_fetcher_manager_.get(),
+                                     crypto_client_.get(), channel_warmer)),
+        buyer_factory_([this, channel_warmer]() {
           absl::StatusOr<absl::flat_hash_map<std::string, std::string>>
               ig_owner_to_bfe_domain_map = ParseIgOwnerToBfeDomainMap(
                   config_client_.GetStringParameter(BUYER_SERVER_HOSTS));
@@ -102,13 +119,37 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
                   .secure_client =
                       config_client_.GetBooleanParameter(BUYER_EGRESS_TLS),
                   .encryption_enabled =
-                      config_client_.GetBooleanParameter(ENABLE_ENCRYPTION)});
+                      config_client_.GetBooleanParameter(ENABLE_ENCRYPTION),
+                  .num_channels =
+                      config_client_.GetIntParameter(BUYER_CHANNEL_POOL_SIZE),
+                  .flow_control_window_bytes = config_client_.GetIntParameter(
+                      BUYER_FLOW_CONTROL_WINDOW_BYTES),
+                  .compression_algorithm =
+                      GetCompressionAlgorithm(config_client_),
+                  .compression_min_message_bytes =
+                      config_client_.GetIntParameter(
+                          GRPC_COMPRESSION_MIN_MESSAGE_BYTES),
+                  .channel_warmer = channel_warmer},
+              GetBuyerCircuitBreakerOptions(config_client_));
         }()),
+        buyer_latency_budget_(CreateBuyerLatencyBudget(config_client_)),
+        ohttp_gateway_cache_(std::make_unique<OhttpGatewayCache>()),
+        reporting_executor_(
+            CreateReportingExecutor(config_client_, executor_.get())),
+        cpu_executor_(CreateCpuExecutor(config_client_, executor_.get())),
+        debug_report_limiter_(CreateDebugReportLimiter(config_client_)),
+        concurrency_limiter_(CreateConcurrencyLimiter(config_client_)),
+        request_shape_recorder_(CreateRequestShapeRecorder(config_client_)),
+        buyer_input_codec_(CreateBuyerInputCodec(config_client_)),
         clients_{
             *scoring_signals_async_provider_, *scoring_, *buyer_factory_,
             *key_fetcher_manager_,
-            std::make_unique<AsyncReporter>(
-                std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get()))} {
+            CreateReporter(config_client_, executor_.get(),
+                           reporting_executor_.get()),
+            cpu_executor_ ? cpu_executor_.get() : executor_.get(),
+            buyer_latency_budget_.get(),
+            ohttp_gateway_cache_.get(), debug_report_limiter_.get(),
+            request_shape_recorder_.get(), buyer_input_codec_.get()} {
   }
 
   SellerFrontEndService(const TrustedServersConfigClient* config_client,
@@ -131,16 +172,104 @@ class SellerFrontEndService final : public SellerFrontEnd::CallbackService {
       const bidding_auction_servers::SelectAdRequest* request,
       bidding_auction_servers::SelectAdResponse* response) override;
 
+  // Shrinks the scoring signals cache, and lowers the concurrency of the
+  // SelectAd requests, as the pressure of a MemoryGovernor rises.
+  void OnMemoryPressure(MemoryPressure pressure);
+
  private:
+  // Returns the algorithm of the requests compressed to the other servers.
+  static grpc_compression_algorithm GetCompressionAlgorithm(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the client of the auction service, mirroring a sample of the
+  // calls to the shadow auction service if one is set.
+  static std::unique_ptr<ScoringAsyncClient> CreateScoringClient(
+      const TrustedServersConfigClient& config_client,
+      server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+      CryptoClientWrapperInterface* crypto_client,
+      ChannelWarmer* channel_warmer);
+
+  // Returns the fetcher of the scoring signals from the Key-Value server.
+  static std::unique_ptr<HttpFetcherAsync> CreateKeyValueFetcher(
+      const TrustedServersConfigClient& config_client,
+      server_common::Executor* executor);
+
+  // Returns how the scoring signals are requested from the Key-Value server.
+  // executor runs the timers of the batches of lookups.
+  static KeyValueRequestOptions GetKeyValueRequestOptions(
+      const TrustedServersConfigClient& config_client,
+      server_common::Executor* executor);
+
+  // Returns the cache of the scoring signals, or nullptr if it is disabled.
+  static std::shared_ptr<KeyValueCache> CreateScoringSignalsCache(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the options of the circuit breakers of the buyers, or nullopt if
+  // they are disabled.
+  static std::optional<CircuitBreakerOptions> GetBuyerCircuitBreakerOptions(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the budget of the GetBids calls, or nullptr if it is disabled.
+  static std::unique_ptr<BuyerLatencyBudget> CreateBuyerLatencyBudget(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the low priority threads of the reports, with the timers of
+  // `executor`, or nullptr if the reports share the threads of `executor`.
+  static std::unique_ptr<server_common::Executor> CreateReportingExecutor(
+      const TrustedServersConfigClient& config_client,
+      server_common::Executor* executor);
+
+  // Returns the threads the buyer inputs are decoded and the GetBids
+  // requests encrypted on, with the timers of `executor`, or nullptr if they
+  // share the threads of `executor`.
+  static std::unique_ptr<server_common::Executor> CreateCpuExecutor(
+      const TrustedServersConfigClient& config_client,
+      server_common::Executor* executor);
+
+  // Returns the limiter of the debug loss reports.
+  static std::unique_ptr<DebugReportLimiter> CreateDebugReportLimiter(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the limiter of the SelectAd requests in flight, or nullptr if it
+  // is disabled.
+  static std::unique_ptr<ConcurrencyLimiter> CreateConcurrencyLimiter(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the recorder of the request shapes, or nullptr if the capture is
+  // disabled or the server is not in test mode.
+  static std::unique_ptr<RequestShapeRecorder> CreateRequestShapeRecorder(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the codec of the zstd dictionaries the buyer inputs may be
+  // compressed with, or nullptr if there are none.
+  static std::unique_ptr<ZstdDictionaryCodec> CreateBuyerInputCodec(
+      const TrustedServersConfigClient& config_client);
+
+  // Returns the reporter of the debug and win reports, on `reporting_executor`
+  // with a fetcher of its own if set, or else on `executor`.
+  static std::unique_ptr<AsyncReporter> CreateReporter(
+      const TrustedServersConfigClient& config_client,
+      server_common::Executor* executor,
+      server_common::Executor* reporting_executor);
+
   const TrustedServersConfigClient& config_client_;
   std::unique_ptr<server_common::KeyFetcherManagerInterface>
       key_fetcher_manager_;
   std::unique_ptr<CryptoClientWrapperInterface> crypto_client_;
   std::unique_ptr<server_common::Executor> executor_;
+  std::shared_ptr<KeyValueCache> scoring_signals_cache_;
   std::unique_ptr<ScoringSignalsAsyncProvider> scoring_signals_async_provider_;
   std::unique_ptr<ScoringAsyncClient> scoring_;
   std::unique_ptr<ClientFactory<BuyerFrontEndAsyncClient, absl::string_view>>
       buyer_factory_;
+  std::unique_ptr<BuyerLatencyBudget> buyer_latency_budget_;
+  std::unique_ptr<OhttpGatewayCache> ohttp_gateway_cache_;
+  std::unique_ptr<server_common::Executor> reporting_executor_;
+  std::unique_ptr<server_common::Executor> cpu_executor_;
+  std::unique_ptr<DebugReportLimiter> debug_report_limiter_;
+  std::unique_ptr<ConcurrencyLimiter> concurrency_limiter_;
+  std::unique_ptr<RequestShapeRecorder> request_shape_recorder_;
+  std::unique_ptr<ZstdDictionaryCodec> buyer_input_codec_;
   const ClientRegistry clients_;
 };
 
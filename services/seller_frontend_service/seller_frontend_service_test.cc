@@ -81,6 +81,9 @@ class SellerFrontEndServiceTest : public ::testing::Test {
     config_.SetFlagForTest("0", SCORE_ADS_RPC_TIMEOUT_MS);
     config_.SetFlagForTest(kFalse, ENABLE_OTEL_BASED_LOGGING);
     config_.SetFlagForTest(kFalse, ENABLE_PROTECTED_APP_SIGNALS);
+    config_.SetFlagForTest(kFalse, ENABLE_STREAMING_SCORING);
+    config_.SetFlagForTest("0", SPECULATIVE_SCORING_BUYER_PERCENT);
+    config_.SetFlagForTest("0", REQUEST_MEMORY_BUDGET_MB);
   }
 
   TrustedServersConfigClient config_ = TrustedServersConfigClient({});
@@ -0,0 +1,80 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/buyer_latency_budget.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+ABSL_CONST_INIT absl::Mutex late_buyers_mu(absl::kConstInit);
+absl::flat_hash_map<std::string, double>& LateBuyerCounts()
+    ABSL_EXCLUSIVE_LOCKS_REQUIRED(late_buyers_mu) {
+  static auto* counts = new absl::flat_hash_map<std::string, double>();
+  return *counts;
+}
+
+}  // namespace
+
+absl::Duration BuyerLatencyBudget::GetTimeout(absl::string_view buyer,
+                                              absl::Duration timeout,
+                                              absl::Time deadline) const {
+  timeout = std::min(timeout, std::max(deadline - absl::Now() -
+                                           options_.scoring_reserve,
+                                       absl::ZeroDuration()));
+  const LatencyHistogram* histogram = nullptr;
+  {
+    absl::MutexLock lock(&mu_);
+    if (auto it = histograms_.find(buyer); it != histograms_.end()) {
+      histogram = it->second.get();
+    }
+  }
+  if (histogram == nullptr) {
+    return timeout;
+  }
+  std::optional<absl::Duration> latency =
+      histogram->Percentile(options_.latency_percentile);
+  return latency.has_value() ? std::min(timeout, *latency) : timeout;
+}
+
+void BuyerLatencyBudget::RecordGetBids(absl::string_view buyer,
+                                       absl::Duration latency,
+                                       bool timed_out) {
+  LatencyHistogram* histogram;
+  {
+    absl::MutexLock lock(&mu_);
+    std::unique_ptr<LatencyHistogram>& found = histograms_[buyer];
+    if (found == nullptr) {
+      found = std::make_unique<LatencyHistogram>();
+    }
+    histogram = found.get();
+  }
+  // A timed out call was cut at its budget, so it is recorded at twice the
+  // budget for the budget of a buyer that slowed down to grow back.
+  histogram->Record(timed_out ? 2 * latency : latency);
+  if (timed_out) {
+    absl::MutexLock lock(&late_buyers_mu);
+    LateBuyerCounts()[buyer] += 1;
+  }
+}
+
+absl::flat_hash_map<std::string, double> GetLateBuyerCounts() {
+  absl::MutexLock lock(&late_buyers_mu);
+  return std::exchange(LateBuyerCounts(), {});
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
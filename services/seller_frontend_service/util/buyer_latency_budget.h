@@ -0,0 +1,86 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_BUYER_LATENCY_BUDGET_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_BUYER_LATENCY_BUDGET_H_
+
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/latency_histogram.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct BuyerLatencyBudgetOptions {
+  // Percentile of the recent GetBids latencies of a buyer after which its
+  // call is given up on.
+  int latency_percentile = 99;
+  // Time kept before the SelectAd deadline for scoring the bids.
+  absl::Duration scoring_reserve = absl::Milliseconds(50);
+};
+
+// Budgets the GetBids calls to each buyer, so that the slow buyers do not
+// hold the auction past the SelectAd deadline. A buyer that misses its budget
+// is late, and the auction is scored with the bids of the other buyers.
+// Thread safe.
+class BuyerLatencyBudget final {
+ public:
+  explicit BuyerLatencyBudget(BuyerLatencyBudgetOptions options = {})
+      : options_(options) {}
+
+  // Not copyable or movable.
+  BuyerLatencyBudget(const BuyerLatencyBudget&) = delete;
+  BuyerLatencyBudget& operator=(const BuyerLatencyBudget&) = delete;
+
+  // Returns the timeout of a GetBids call to the buyer: the configured
+  // timeout, cut to the time left before the deadline minus the scoring
+  // reserve, and to the percentile of the recent latencies of the buyer once
+  // enough of them were recorded. The deadline is absl::InfiniteFuture() if
+  // the SelectAd call has none.
+  absl::Duration GetTimeout(absl::string_view buyer, absl::Duration timeout,
+                            absl::Time deadline) const ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Records the latency of a GetBids call to the buyer, and counts the buyer
+  // as late if the call timed out.
+  void RecordGetBids(absl::string_view buyer, absl::Duration latency,
+                     bool timed_out) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  const BuyerLatencyBudgetOptions options_;
+  mutable absl::Mutex mu_;
+  // Never erased, so that the histograms can be used outside of the lock.
+  absl::flat_hash_map<std::string, std::unique_ptr<LatencyHistogram>>
+      histograms_ ABSL_GUARDED_BY(mu_);
+};
+
+// Returns the number of GetBids calls that timed out per buyer, by all the
+// BuyerLatencyBudget instances since the previous call.
+absl::flat_hash_map<std::string, double> GetLateBuyerCounts();
+
+template <typename T>
+inline void AddLateBuyerMetric(T* context_map) {
+  context_map->AddObserverable(metric::kSfeLateBuyerCount, GetLateBuyerCounts);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_BUYER_LATENCY_BUDGET_H_
@@ -0,0 +1,80 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/buyer_latency_budget.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+constexpr char kBuyer[] = "https://buyer.com";
+constexpr char kOtherBuyer[] = "https://other-buyer.com";
+
+TEST(BuyerLatencyBudgetTest, KeepsTimeoutWithoutDeadlineOrLatencies) {
+  BuyerLatencyBudget budget;
+  EXPECT_EQ(budget.GetTimeout(kBuyer, absl::Seconds(1),
+                              absl::InfiniteFuture()),
+            absl::Seconds(1));
+}
+
+TEST(BuyerLatencyBudgetTest, CutsTimeoutToDeadlineMinusScoringReserve) {
+  BuyerLatencyBudget budget({.scoring_reserve = absl::Milliseconds(50)});
+  absl::Duration timeout = budget.GetTimeout(
+      kBuyer, absl::Seconds(1), absl::Now() + absl::Milliseconds(200));
+  EXPECT_LE(timeout, absl::Milliseconds(150));
+  EXPECT_GT(timeout, absl::Milliseconds(100));
+
+  EXPECT_EQ(budget.GetTimeout(kBuyer, absl::Seconds(1),
+                              absl::Now() + absl::Milliseconds(10)),
+            absl::ZeroDuration());
+}
+
+TEST(BuyerLatencyBudgetTest, CutsTimeoutToPercentileOfBuyerLatencies) {
+  BuyerLatencyBudget budget({.latency_percentile = 90});
+  for (int i = 0; i < LatencyHistogram::kMinSamples; ++i) {
+    budget.RecordGetBids(kBuyer, absl::Milliseconds(10), /*timed_out=*/false);
+  }
+
+  absl::Duration timeout =
+      budget.GetTimeout(kBuyer, absl::Seconds(1), absl::InfiniteFuture());
+  EXPECT_GE(timeout, absl::Milliseconds(10));
+  EXPECT_LT(timeout, absl::Milliseconds(12));
+  // The latencies of a buyer do not budget the others.
+  EXPECT_EQ(budget.GetTimeout(kOtherBuyer, absl::Seconds(1),
+                              absl::InfiniteFuture()),
+            absl::Seconds(1));
+}
+
+TEST(BuyerLatencyBudgetTest, CountsLateBuyersUntilRead) {
+  GetLateBuyerCounts();
+  BuyerLatencyBudget budget;
+  budget.RecordGetBids(kBuyer, absl::Milliseconds(10), /*timed_out=*/true);
+  budget.RecordGetBids(kBuyer, absl::Milliseconds(10), /*timed_out=*/true);
+  budget.RecordGetBids(kOtherBuyer, absl::Milliseconds(10),
+                       /*timed_out=*/true);
+  budget.RecordGetBids(kOtherBuyer, absl::Milliseconds(10),
+                       /*timed_out=*/false);
+
+  EXPECT_THAT(GetLateBuyerCounts(),
+              UnorderedElementsAre(Pair(kBuyer, 2), Pair(kOtherBuyer, 1)));
+  EXPECT_TRUE(GetLateBuyerCounts().empty());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,33 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/buyer_metrics.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+std::string BuyerLatencyPartition(absl::string_view buyer,
+                                  absl::Duration latency) {
+  for (int bound_ms : kBuyerLatencyBucketsMs) {
+    if (latency <= absl::Milliseconds(bound_ms)) {
+      return absl::StrCat(buyer, "|", bound_ms);
+    }
+  }
+  return absl::StrCat(buyer, "|inf");
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,41 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_BUYER_METRICS_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_BUYER_METRICS_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Upper bounds, in milliseconds, of the latency buckets of the GetBids calls
+// counted per buyer. The last bucket holds the slower calls.
+inline constexpr int kBuyerLatencyBucketsMs[] = {25,  50,  100,  200,
+                                                 400, 800, 1600, 3200};
+
+// Returns the partition of metric::kSfeBuyerGetBidsLatencyCount counting a
+// GetBids call of the buyer that took latency, "<buyer>|<bucket bound in ms>"
+// or "<buyer>|inf" past the last bucket. As the partitions are built from the
+// buyers the SFE has a client for, their number is bounded by the config.
+std::string BuyerLatencyPartition(absl::string_view buyer,
+                                  absl::Duration latency);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_BUYER_METRICS_H_
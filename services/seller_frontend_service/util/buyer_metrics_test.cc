@@ -0,0 +1,40 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/buyer_metrics.h"
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kBuyer[] = "https://buyer.com";
+
+TEST(BuyerMetricsTest, PartitionsTheLatenciesByBuyerAndBucket) {
+  EXPECT_EQ(BuyerLatencyPartition(kBuyer, absl::ZeroDuration()),
+            "https://buyer.com|25");
+  EXPECT_EQ(BuyerLatencyPartition(kBuyer, absl::Milliseconds(25)),
+            "https://buyer.com|25");
+  EXPECT_EQ(BuyerLatencyPartition(kBuyer, absl::Milliseconds(26)),
+            "https://buyer.com|50");
+  EXPECT_EQ(BuyerLatencyPartition(kBuyer, absl::Milliseconds(3200)),
+            "https://buyer.com|3200");
+  EXPECT_EQ(BuyerLatencyPartition(kBuyer, absl::Seconds(4)),
+            "https://buyer.com|inf");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,206 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/cbor_reader.h"
+
+#include <cstddef>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Additional information values of the initial byte, see
+// https://www.rfc-editor.org/rfc/rfc8949.html#section-3.
+inline constexpr uint8_t kOneByteArgument = 24;
+inline constexpr uint8_t kIndefiniteLength = 31;
+inline constexpr uint8_t kFalse = 20;
+inline constexpr uint8_t kTrue = 21;
+inline constexpr char kBreak = '\xff';
+
+// Max nesting of the items, so that a malicious payload cannot overflow the
+// stack while being validated.
+inline constexpr int kMaxDepth = 256;
+
+// The initial byte and the argument of an item.
+struct Head {
+  CborType type;
+  uint8_t additional;
+  uint64_t argument;
+  size_t size;
+};
+
+std::optional<Head> ParseHead(absl::string_view data) {
+  if (data.empty()) {
+    return std::nullopt;
+  }
+  const auto initial = static_cast<uint8_t>(data[0]);
+  Head head = {.type = static_cast<CborType>(initial >> 5),
+               .additional = static_cast<uint8_t>(initial & 0x1f),
+               .argument = static_cast<uint64_t>(initial & 0x1f),
+               .size = 1};
+  if (head.additional < kOneByteArgument ||
+      head.additional == kIndefiniteLength) {
+    return head;
+  }
+  if (head.additional > kOneByteArgument + 3) {
+    // Reserved values.
+    return std::nullopt;
+  }
+  const size_t argument_size = size_t{1}
+                               << (head.additional - kOneByteArgument);
+  if (data.size() < 1 + argument_size) {
+    return std::nullopt;
+  }
+  head.argument = 0;
+  for (size_t i = 1; i <= argument_size; ++i) {
+    head.argument = (head.argument << 8) | static_cast<uint8_t>(data[i]);
+  }
+  head.size += argument_size;
+  return head;
+}
+
+// Returns the size of the encoding of the item at the start of data, or
+// nullopt if the item is not well-formed.
+std::optional<size_t> ItemSize(absl::string_view data, int depth) {
+  std::optional<Head> head = ParseHead(data);
+  if (!head.has_value() || depth > kMaxDepth) {
+    return std::nullopt;
+  }
+  const bool indefinite = head->additional == kIndefiniteLength;
+  switch (head->type) {
+    case CborType::kUint:
+    case CborType::kNegint:
+    case CborType::kFloatCtrl:
+      // A break outside of an indefinite-length container is malformed.
+      if (indefinite) {
+        return std::nullopt;
+      }
+      return head->size;
+    case CborType::kByteString:
+    case CborType::kString:
+      if (indefinite || head->argument > data.size() - head->size) {
+        return std::nullopt;
+      }
+      return head->size + head->argument;
+    case CborType::kTag: {
+      if (indefinite) {
+        return std::nullopt;
+      }
+      std::optional<size_t> tagged =
+          ItemSize(data.substr(head->size), depth + 1);
+      if (!tagged.has_value()) {
+        return std::nullopt;
+      }
+      return head->size + *tagged;
+    }
+    case CborType::kArray:
+    case CborType::kMap:
+      break;
+  }
+
+  const uint64_t items_per_entry = head->type == CborType::kMap ? 2 : 1;
+  size_t size = head->size;
+  // Every item takes at least a byte, which bounds the loop by the size of
+  // the data rather than by the declared size of the container.
+  if (!indefinite && head->argument > (data.size() - size) / items_per_entry) {
+    return std::nullopt;
+  }
+  for (uint64_t items = 0;; ++items) {
+    if (indefinite) {
+      if (size == data.size()) {
+        return std::nullopt;
+      }
+      if (data[size] == kBreak) {
+        if (items % items_per_entry != 0) {
+          return std::nullopt;
+        }
+        return size + 1;
+      }
+    } else if (items == head->argument * items_per_entry) {
+      return size;
+    }
+    std::optional<size_t> item = ItemSize(data.substr(size), depth + 1);
+    if (!item.has_value()) {
+      return std::nullopt;
+    }
+    size += *item;
+  }
+}
+
+}  // namespace
+
+CborItem::CborItem(absl::string_view encoded) : encoded_(encoded) {
+  const Head head = *ParseHead(encoded);
+  type_ = head.type;
+  argument_ = head.argument;
+  indefinite_ = head.additional == kIndefiniteLength;
+  head_size_ = head.size;
+}
+
+bool CborItem::IsBool() const {
+  return type_ == CborType::kFloatCtrl && head_size_ == 1 &&
+         (argument_ == kFalse || argument_ == kTrue);
+}
+
+bool CborItem::GetBool() const { return argument_ == kTrue; }
+
+absl::string_view CborItem::GetString() const {
+  return encoded_.substr(head_size_);
+}
+
+uint64_t CborItem::size() const {
+  if (!indefinite_) {
+    return argument_;
+  }
+  uint64_t items = 0;
+  for (CborReader reader = Contents(); !reader.Done(); reader.Next()) {
+    ++items;
+  }
+  return type_ == CborType::kMap ? items / 2 : items;
+}
+
+CborReader CborItem::Contents() const {
+  if (indefinite_) {
+    return CborReader(encoded_.substr(head_size_), std::nullopt);
+  }
+  return CborReader(encoded_.substr(head_size_),
+                    type_ == CborType::kMap ? argument_ * 2 : argument_);
+}
+
+bool CborReader::Done() const {
+  if (remaining_.has_value()) {
+    return *remaining_ == 0;
+  }
+  return data_.empty() || data_[0] == kBreak;
+}
+
+CborItem CborReader::Next() {
+  // The container was validated as a whole, so its items are well-formed.
+  const size_t size = *ItemSize(data_, /*depth=*/0);
+  CborItem item(data_.substr(0, size));
+  data_.remove_prefix(size);
+  if (remaining_.has_value()) {
+    --*remaining_;
+  }
+  return item;
+}
+
+std::optional<CborItem> ParseCbor(absl::string_view data) {
+  std::optional<size_t> size = ItemSize(data, /*depth=*/0);
+  if (!size.has_value()) {
+    return std::nullopt;
+  }
+  return CborItem(data.substr(0, *size));
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
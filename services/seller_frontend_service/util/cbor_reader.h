@@ -0,0 +1,124 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_READER_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_READER_H_
+
+#include <cstdint>
+#include <optional>
+
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Major types of CBOR items, numbered as in RFC 8949 and as libcbor's
+// cbor_type.
+enum class CborType : uint8_t {
+  kUint = 0,
+  kNegint = 1,
+  kByteString = 2,
+  kString = 3,
+  kArray = 4,
+  kMap = 5,
+  kTag = 6,
+  kFloatCtrl = 7,
+};
+
+class CborReader;
+
+// A view of one well-formed CBOR item in a buffer, decoded on access instead
+// of into a tree of heap-allocated items like libcbor's cbor_load does. The
+// buffer must outlive the item.
+class CborItem {
+ public:
+  CborType type() const { return type_; }
+
+  bool IsInt() const {
+    return type_ == CborType::kUint || type_ == CborType::kNegint;
+  }
+  bool IsByteString() const { return type_ == CborType::kByteString; }
+  bool IsString() const { return type_ == CborType::kString; }
+  bool IsArray() const { return type_ == CborType::kArray; }
+  bool IsMap() const { return type_ == CborType::kMap; }
+  bool IsBool() const;
+
+  // Returns the value of an int, encoded like cbor_get_int does, i.e. -1 - n
+  // for a negative int n.
+  uint64_t GetInt() const { return argument_; }
+
+  bool GetBool() const;
+
+  // Returns the content of a string or a byte string, pointing into the
+  // buffer.
+  absl::string_view GetString() const;
+
+  // Returns the number of elements of an array, or of entries of a map.
+  uint64_t size() const;
+
+  // Returns a reader of the elements of an array, or of the keys and values
+  // of a map in turn.
+  CborReader Contents() const;
+
+ private:
+  friend class CborReader;
+  friend std::optional<CborItem> ParseCbor(absl::string_view data);
+
+  // Views the item at the start of the well-formed encoded.
+  explicit CborItem(absl::string_view encoded);
+
+  // The encoding of the whole item.
+  absl::string_view encoded_;
+  CborType type_;
+  // The length of a string, the size of a container, or the value of an int
+  // or a simple value.
+  uint64_t argument_ = 0;
+  // Whether a container is of indefinite length, ended by a break.
+  bool indefinite_ = false;
+  // The size of the initial byte and the argument.
+  size_t head_size_ = 0;
+};
+
+// Pulls the items of an array or a map one by one.
+class CborReader {
+ public:
+  // Whether all the items were read.
+  bool Done() const;
+
+  // Returns the next item. Must not be called once Done.
+  CborItem Next();
+
+ private:
+  friend class CborItem;
+
+  // Reads remaining items from data, or items up to a break if remaining is
+  // nullopt.
+  CborReader(absl::string_view data, std::optional<uint64_t> remaining)
+      : data_(data), remaining_(remaining) {}
+
+  absl::string_view data_;
+  std::optional<uint64_t> remaining_;
+};
+
+// Returns the item at the start of data, or nullopt if it is not well-formed
+// CBOR. Bytes after the item are ignored, as cbor_load does. Items are
+// accessed without further checks, so the whole item is validated here.
+// Indefinite-length strings are rejected since they cannot be viewed as one
+// piece.
+std::optional<CborItem> ParseCbor(absl::string_view data);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_READER_H_
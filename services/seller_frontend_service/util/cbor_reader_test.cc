@@ -0,0 +1,139 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/cbor_reader.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using namespace std::string_literals;  // NOLINT
+
+TEST(CborReaderTest, ReadsScalars) {
+  const std::string uint = "\x19\x01\x00"s;
+  std::optional<CborItem> item = ParseCbor(uint);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_TRUE(item->IsInt());
+  EXPECT_EQ(item->GetInt(), 256);
+
+  const std::string negint = "\x20";
+  item = ParseCbor(negint);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_EQ(item->type(), CborType::kNegint);
+  EXPECT_TRUE(item->IsInt());
+
+  const std::string true_value = "\xf5";
+  item = ParseCbor(true_value);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_TRUE(item->IsBool());
+  EXPECT_TRUE(item->GetBool());
+
+  // null is a simple value, but not a bool.
+  const std::string null = "\xf6";
+  item = ParseCbor(null);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_EQ(item->type(), CborType::kFloatCtrl);
+  EXPECT_FALSE(item->IsBool());
+}
+
+TEST(CborReaderTest, ViewsStringsInPlace) {
+  const std::string data = "\x63" "abc";
+  std::optional<CborItem> item = ParseCbor(data);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_TRUE(item->IsString());
+  EXPECT_EQ(item->GetString(), "abc");
+  EXPECT_EQ(item->GetString().data(), data.data() + 1);
+
+  const std::string bytes = "\x42\x00\x01"s;
+  item = ParseCbor(bytes);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_TRUE(item->IsByteString());
+  EXPECT_EQ(item->GetString(), "\x00\x01"s);
+}
+
+TEST(CborReaderTest, ReadsNestedContainers) {
+  // {"a": [1, "b"], "c": {}}
+  const std::string data = "\xa2\x61" "a" "\x82\x01\x61" "b" "\x61" "c" "\xa0";
+  std::optional<CborItem> item = ParseCbor(data);
+  ASSERT_TRUE(item.has_value());
+  ASSERT_TRUE(item->IsMap());
+  EXPECT_EQ(item->size(), 2);
+
+  CborReader entries = item->Contents();
+  ASSERT_FALSE(entries.Done());
+  EXPECT_EQ(entries.Next().GetString(), "a");
+  const CborItem array = entries.Next();
+  ASSERT_TRUE(array.IsArray());
+  EXPECT_EQ(array.size(), 2);
+  CborReader elements = array.Contents();
+  EXPECT_EQ(elements.Next().GetInt(), 1);
+  EXPECT_EQ(elements.Next().GetString(), "b");
+  EXPECT_TRUE(elements.Done());
+
+  EXPECT_EQ(entries.Next().GetString(), "c");
+  const CborItem map = entries.Next();
+  ASSERT_TRUE(map.IsMap());
+  EXPECT_EQ(map.size(), 0);
+  EXPECT_TRUE(map.Contents().Done());
+  EXPECT_TRUE(entries.Done());
+}
+
+TEST(CborReaderTest, ReadsIndefiniteLengthContainers) {
+  // [_ 1, [2]]
+  const std::string data = "\x9f\x01\x81\x02\xff";
+  std::optional<CborItem> item = ParseCbor(data);
+  ASSERT_TRUE(item.has_value());
+  ASSERT_TRUE(item->IsArray());
+  EXPECT_EQ(item->size(), 2);
+
+  CborReader elements = item->Contents();
+  EXPECT_EQ(elements.Next().GetInt(), 1);
+  EXPECT_EQ(elements.Next().size(), 1);
+  EXPECT_TRUE(elements.Done());
+}
+
+TEST(CborReaderTest, IgnoresBytesAfterItem) {
+  const std::string data = "\x81\x01\x02";
+  std::optional<CborItem> item = ParseCbor(data);
+  ASSERT_TRUE(item.has_value());
+  EXPECT_EQ(item->size(), 1);
+}
+
+TEST(CborReaderTest, RejectsMalformedData) {
+  EXPECT_FALSE(ParseCbor("").has_value());
+  // Truncated argument, string, array and map.
+  EXPECT_FALSE(ParseCbor("\x19\x01"s).has_value());
+  EXPECT_FALSE(ParseCbor("\x63" "ab"s).has_value());
+  EXPECT_FALSE(ParseCbor("\x82\x01"s).has_value());
+  EXPECT_FALSE(ParseCbor("\xa1\x01"s).has_value());
+  // A huge declared size.
+  EXPECT_FALSE(ParseCbor("\x9b\xff\xff\xff\xff\xff\xff\xff\xff"s).has_value());
+  // Reserved additional information.
+  EXPECT_FALSE(ParseCbor("\x1c"s).has_value());
+  // Unterminated indefinite-length array, and a stray break.
+  EXPECT_FALSE(ParseCbor("\x9f\x01"s).has_value());
+  EXPECT_FALSE(ParseCbor("\xff"s).has_value());
+  // Indefinite-length map with a key but no value.
+  EXPECT_FALSE(ParseCbor("\xbf\x01\xff"s).has_value());
+  // Indefinite-length strings cannot be viewed in place.
+  EXPECT_FALSE(ParseCbor("\x7f\x61" "a" "\xff"s).has_value());
+  // Nesting deeper than the reader supports.
+  EXPECT_FALSE(ParseCbor(std::string(1000, '\x81') + "\x01").has_value());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,156 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/cbor_writer.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Major types, see https://www.rfc-editor.org/rfc/rfc8949.html#section-3.1.
+inline constexpr uint8_t kUintType = 0;
+inline constexpr uint8_t kStringType = 3;
+inline constexpr uint8_t kArrayType = 4;
+inline constexpr uint8_t kMapType = 5;
+
+inline constexpr char kFalse = '\xf4';
+inline constexpr char kTrue = '\xf5';
+inline constexpr char kHalfFloat = '\xf9';
+inline constexpr char kSingleFloat = '\xfa';
+inline constexpr char kDoubleFloat = '\xfb';
+
+// Compares the floats as AreFloatsEqual of web_utils does.
+template <typename T>
+bool AreFloatsEqual(T a, T b) {
+  return std::fabs(a - b) < std::numeric_limits<double>::epsilon();
+}
+
+// The half precision encoding of the value by libcbor's cbor_encode_half,
+// which rounds the value off rather than to nearest.
+uint16_t EncodeHalf(float value) {
+  uint32_t val;
+  std::memcpy(&val, &value, sizeof(val));
+  const uint32_t sign = (val & 0x80000000u) >> 16u;
+  const uint32_t exp = (val & 0x7F800000u) >> 23u;
+  const uint32_t mant = val & 0x7FFFFFu;
+  if (exp == 0xFF) {
+    // NaNs, and infinities.
+    return value != value ? 0x7e00 : static_cast<uint16_t>(sign | 0x7C00u);
+  }
+  if (exp == 0) {
+    // Zeroes, and subnormals.
+    return static_cast<uint16_t>(sign | mant >> 13u);
+  }
+  const int logical_exp = static_cast<int>(exp) - 127;
+  if (logical_exp < -24) {
+    return 0;
+  }
+  if (logical_exp < -14) {
+    const uint32_t rounded_mant = ((mant >> (-logical_exp - 2)) + 1) >> 1;
+    return static_cast<uint16_t>(
+        sign | (static_cast<uint16_t>(1u << (24 + logical_exp)) +
+                static_cast<uint16_t>(rounded_mant)));
+  }
+  return static_cast<uint16_t>(
+      sign | ((static_cast<uint32_t>(logical_exp) + 15u) << 10u) |
+      (mant >> 13u));
+}
+
+// The value of a half precision float as decoded by libcbor.
+float DecodeHalf(uint16_t half) {
+  const int exp = (half >> 10) & 0x1f;
+  const int mant = half & 0x3ff;
+  double value;
+  if (exp == 0) {
+    value = std::ldexp(mant, -24);
+  } else if (exp != 31) {
+    value = std::ldexp(mant + 1024, exp - 25);
+  } else {
+    value = mant == 0 ? std::numeric_limits<double>::infinity()
+                      : std::numeric_limits<double>::quiet_NaN();
+  }
+  return static_cast<float>((half & 0x8000) ? -value : value);
+}
+
+}  // namespace
+
+void CborWriter::WriteHead(uint8_t type, uint64_t argument) {
+  const uint8_t initial = type << 5;
+  int argument_size;
+  if (argument < 24) {
+    buffer_.push_back(static_cast<char>(initial | argument));
+    return;
+  } else if (argument <= std::numeric_limits<uint8_t>::max()) {
+    buffer_.push_back(static_cast<char>(initial | 24));
+    argument_size = 1;
+  } else if (argument <= std::numeric_limits<uint16_t>::max()) {
+    buffer_.push_back(static_cast<char>(initial | 25));
+    argument_size = 2;
+  } else if (argument <= std::numeric_limits<uint32_t>::max()) {
+    buffer_.push_back(static_cast<char>(initial | 26));
+    argument_size = 4;
+  } else {
+    buffer_.push_back(static_cast<char>(initial | 27));
+    argument_size = 8;
+  }
+  for (int i = argument_size - 1; i >= 0; --i) {
+    buffer_.push_back(static_cast<char>(argument >> (8 * i)));
+  }
+}
+
+void CborWriter::WriteUint(uint64_t value) { WriteHead(kUintType, value); }
+
+void CborWriter::WriteString(absl::string_view value) {
+  WriteHead(kStringType, value.size());
+  buffer_.append(value.data(), value.size());
+}
+
+void CborWriter::WriteBool(bool value) {
+  buffer_.push_back(value ? kTrue : kFalse);
+}
+
+void CborWriter::WriteFloat(double value) {
+  const float single = static_cast<float>(value);
+  if (!AreFloatsEqual(value, static_cast<double>(single))) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    buffer_.push_back(kDoubleFloat);
+    for (int i = 7; i >= 0; --i) {
+      buffer_.push_back(static_cast<char>(bits >> (8 * i)));
+    }
+    return;
+  }
+  const uint16_t half = EncodeHalf(single);
+  if (AreFloatsEqual(single, DecodeHalf(half))) {
+    buffer_.push_back(kHalfFloat);
+    buffer_.push_back(static_cast<char>(half >> 8));
+    buffer_.push_back(static_cast<char>(half));
+    return;
+  }
+  uint32_t bits;
+  std::memcpy(&bits, &single, sizeof(bits));
+  buffer_.push_back(kSingleFloat);
+  for (int i = 3; i >= 0; --i) {
+    buffer_.push_back(static_cast<char>(bits >> (8 * i)));
+  }
+}
+
+void CborWriter::StartArray(uint64_t size) { WriteHead(kArrayType, size); }
+
+void CborWriter::StartMap(uint64_t size) { WriteHead(kMapType, size); }
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_WRITER_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_WRITER_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Writes CBOR items one after the other into a buffer, instead of building a
+// tree of heap-allocated items with libcbor and serializing it. The items are
+// encoded as libcbor serializes the items built by cbor_build_stringn,
+// cbor_build_bool, cbor_build_uint and cbor_build_float. Maps and arrays are
+// of definite length: their size is written first, and then their items, or
+// their keys and values in turn.
+class CborWriter {
+ public:
+  // Reserves size_hint bytes of the buffer.
+  explicit CborWriter(size_t size_hint = 0) { buffer_.reserve(size_hint); }
+
+  void WriteUint(uint64_t value);
+  void WriteString(absl::string_view value);
+  void WriteBool(bool value);
+
+  // Writes the value as a half, single or double precision float, whichever
+  // is the shortest to decode to the value, as cbor_build_float does.
+  void WriteFloat(double value);
+
+  void StartArray(uint64_t size);
+  void StartMap(uint64_t size);
+
+  // Returns the items written.
+  std::string Finish() && { return std::move(buffer_); }
+
+ private:
+  // Writes the initial byte of an item of the major type and its argument.
+  void WriteHead(uint8_t type, uint64_t argument);
+
+  std::string buffer_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_CBOR_WRITER_H_
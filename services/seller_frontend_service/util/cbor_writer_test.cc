@@ -0,0 +1,76 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/cbor_writer.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using namespace std::string_literals;  // NOLINT
+
+std::string WriteUint(uint64_t value) {
+  CborWriter writer;
+  writer.WriteUint(value);
+  return std::move(writer).Finish();
+}
+
+std::string WriteFloat(double value) {
+  CborWriter writer;
+  writer.WriteFloat(value);
+  return std::move(writer).Finish();
+}
+
+TEST(CborWriterTest, WritesShortestUintHeads) {
+  EXPECT_EQ(WriteUint(0), "\x00"s);
+  EXPECT_EQ(WriteUint(23), "\x17");
+  EXPECT_EQ(WriteUint(24), "\x18\x18");
+  EXPECT_EQ(WriteUint(255), "\x18\xff");
+  EXPECT_EQ(WriteUint(256), "\x19\x01\x00"s);
+  EXPECT_EQ(WriteUint(65536), "\x1a\x00\x01\x00\x00"s);
+  EXPECT_EQ(WriteUint(1ull << 32), "\x1b\x00\x00\x00\x01\x00\x00\x00\x00"s);
+}
+
+TEST(CborWriterTest, WritesStringsAndBools) {
+  CborWriter writer;
+  writer.WriteString("abc");
+  writer.WriteString(std::string(24, 'a'));
+  writer.WriteBool(true);
+  writer.WriteBool(false);
+  EXPECT_EQ(std::move(writer).Finish(),
+            "\x63" "abc" "\x78\x18" + std::string(24, 'a') + "\xf5\xf4");
+}
+
+TEST(CborWriterTest, WritesShortestExactFloats) {
+  EXPECT_EQ(WriteFloat(1.0), "\xf9\x3c\x00"s);
+  EXPECT_EQ(WriteFloat(-2.5), "\xf9\xc1\x00"s);
+  EXPECT_EQ(WriteFloat(100000.0), "\xfa\x47\xc3\x50\x00"s);
+  EXPECT_EQ(WriteFloat(1.1), "\xfb\x3f\xf1\x99\x99\x99\x99\x99\x9a"s);
+}
+
+TEST(CborWriterTest, WritesContainerHeads) {
+  CborWriter writer;
+  writer.StartMap(1);
+  writer.WriteString("a");
+  writer.StartArray(2);
+  writer.WriteUint(1);
+  writer.WriteUint(2);
+  EXPECT_EQ(std::move(writer).Finish(), "\xa1\x61" "a" "\x82\x01\x02");
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -16,7 +16,10 @@
 #include <algorithm>
 
 #include "absl/numeric/bits.h"
+#include "glog/logging.h"
+#include "services/common/compression/gzip.h"
 #include "services/common/util/request_response_constants.h"
+#include "src/cpp/communication/encoding_utils.h"
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -26,6 +29,24 @@ constexpr int kVersionCompressionSize = 1;
 // 4-bytes specifying the size of the actual payload.
 constexpr int kPayloadLength = 4;
 
+constexpr int kPreambleSize = kVersionCompressionSize + kPayloadLength;
+
+namespace {
+
+// Returns the version and compression byte of gzip compressed payloads,
+// taken from the common framing so that both stay in sync.
+char GzipVersionCompressionByte() {
+  static const char byte = []() {
+    absl::StatusOr<std::string> preamble = server_common::EncodeResponsePayload(
+        server_common::CompressionType::kGzip, "", kPreambleSize);
+    CHECK(preamble.ok()) << preamble.status();
+    return (*preamble)[0];
+  }();
+  return byte;
+}
+
+}  // namespace
+
 // Gets size of the complete payload including the preamble expected by
 // android, which is: 1 byte (containing version, compression details), 4 bytes
 // indicating the length of the actual encoded response and any other padding
@@ -37,4 +58,25 @@ size_t GetEncodedDataSize(size_t encapsulated_payload_size) {
   return std::max(absl::bit_ceil(total_payload_size), kMinAuctionResultBytes);
 }
 
+absl::StatusOr<std::string> GzipCompressAndEncodeResponsePayload(
+    absl::string_view payload) {
+  std::string framed;
+  framed.reserve(GetEncodedDataSize(GzipCompressBound(payload.size())));
+  framed.resize(kPreambleSize);
+  if (absl::Status status = GzipCompressAppend(payload, &framed);
+      !status.ok()) {
+    return status;
+  }
+  const size_t compressed_size = framed.size() - kPreambleSize;
+  framed[0] = GzipVersionCompressionByte();
+  // The payload length is big-endian.
+  for (int i = 0; i < kPayloadLength; ++i) {
+    framed[kVersionCompressionSize + i] = static_cast<char>(
+        (compressed_size >> (8 * (kPayloadLength - 1 - i))) & 0xff);
+  }
+  // Within the reserved capacity, so the padding is written in place.
+  framed.resize(GetEncodedDataSize(compressed_size), '\0');
+  return framed;
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
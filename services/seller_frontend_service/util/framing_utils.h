@@ -19,6 +19,11 @@
 
 #include <stddef.h>
 
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
 namespace privacy_sandbox::bidding_auction_servers {
 
 // Gets size of the complete payload including the preamble expected by
@@ -27,6 +32,14 @@ namespace privacy_sandbox::bidding_auction_servers {
 // required to make the complete payload a power of 2.
 size_t GetEncodedDataSize(size_t encapsulated_payload_size);
 
+// Compresses payload with gzip and frames it as
+// server_common::EncodeResponsePayload does, padded to GetEncodedDataSize of
+// the compressed size. The framed size is reserved upfront, and the payload
+// is compressed straight after the preamble and padded in place, instead of
+// going through a buffer per step.
+absl::StatusOr<std::string> GzipCompressAndEncodeResponsePayload(
+    absl::string_view payload);
+
 }  // namespace privacy_sandbox::bidding_auction_servers
 
 #endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_FRAMING_UTILS_H_
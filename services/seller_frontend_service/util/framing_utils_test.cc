@@ -0,0 +1,64 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/framing_utils.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "services/common/compression/gzip.h"
+#include "src/cpp/communication/encoding_utils.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+TEST(GzipCompressAndEncodeResponsePayloadTest, MatchesTheCommonFraming) {
+  for (size_t size : {0, 100, 5000, 100000}) {
+    std::string payload;
+    for (size_t i = 0; i < size; ++i) {
+      payload.push_back(static_cast<char>('a' + i * 7 % 26));
+    }
+    absl::StatusOr<std::string> framed =
+        GzipCompressAndEncodeResponsePayload(payload);
+    ASSERT_TRUE(framed.ok()) << framed.status();
+
+    absl::StatusOr<std::string> compressed = GzipCompress(payload);
+    ASSERT_TRUE(compressed.ok()) << compressed.status();
+    absl::StatusOr<std::string> expected = server_common::EncodeResponsePayload(
+        server_common::CompressionType::kGzip, *compressed,
+        GetEncodedDataSize(compressed->size()));
+    ASSERT_TRUE(expected.ok()) << expected.status();
+    EXPECT_EQ(*framed, *expected);
+  }
+}
+
+TEST(GzipCompressAndEncodeResponsePayloadTest, RoundTrips) {
+  const std::string payload(10000, 'x');
+  absl::StatusOr<std::string> framed =
+      GzipCompressAndEncodeResponsePayload(payload);
+  ASSERT_TRUE(framed.ok()) << framed.status();
+
+  absl::StatusOr<server_common::DecodedRequest> decoded =
+      server_common::DecodeRequestPayload(*framed);
+  ASSERT_TRUE(decoded.ok()) << decoded.status();
+  absl::StatusOr<std::string> decompressed =
+      GzipDecompress(decoded->compressed_data);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, payload);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,210 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "services/seller_frontend_service/util/request_shape.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/substitute.h"
+#include "rapidjson/document.h"
+#include "services/common/util/json_util.h"
+#include "services/common/util/status_macros.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+std::string InterestGroupShapeToJson(const InterestGroupShape& shape) {
+  return absl::Substitute(
+      R"({"bidding_signals_keys":$0,"bidding_signals_key_bytes":$1,)"
+      R"("ads":$2,"component_ads":$3,"user_bidding_signals_bytes":$4})",
+      shape.bidding_signals_keys, shape.bidding_signals_key_bytes, shape.ads,
+      shape.component_ads, shape.user_bidding_signals_bytes);
+}
+
+std::string BuyerShapeToJson(const BuyerShape& shape) {
+  std::vector<std::string> interest_groups;
+  interest_groups.reserve(shape.interest_groups.size());
+  for (const InterestGroupShape& interest_group : shape.interest_groups) {
+    interest_groups.push_back(InterestGroupShapeToJson(interest_group));
+  }
+  return absl::Substitute(
+      R"({"buyer_signals_bytes":$0,"interest_groups":[$1]})",
+      shape.buyer_signals_bytes, absl::StrJoin(interest_groups, ","));
+}
+
+// Returns the non-negative integer member of the object, or 0 if it has none.
+absl::StatusOr<int64_t> GetCount(const rapidjson::Value& object,
+                                 const char* name) {
+  auto it = object.FindMember(name);
+  if (it == object.MemberEnd()) {
+    return 0;
+  }
+  if (!it->value.IsInt64() || it->value.GetInt64() < 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat(name, " must be a non-negative integer"));
+  }
+  return it->value.GetInt64();
+}
+
+// Returns the array member of the object, or nullptr if it has none.
+absl::StatusOr<const rapidjson::Value*> GetArray(const rapidjson::Value& object,
+                                                 const char* name) {
+  auto it = object.FindMember(name);
+  if (it == object.MemberEnd()) {
+    return nullptr;
+  }
+  if (!it->value.IsArray()) {
+    return absl::InvalidArgumentError(absl::StrCat(name, " must be an array"));
+  }
+  return &it->value;
+}
+
+absl::StatusOr<InterestGroupShape> ParseInterestGroupShape(
+    const rapidjson::Value& object) {
+  if (!object.IsObject()) {
+    return absl::InvalidArgumentError("Interest group must be an object");
+  }
+  InterestGroupShape shape;
+  PS_ASSIGN_OR_RETURN(shape.bidding_signals_keys,
+                      GetCount(object, "bidding_signals_keys"));
+  PS_ASSIGN_OR_RETURN(shape.bidding_signals_key_bytes,
+                      GetCount(object, "bidding_signals_key_bytes"));
+  PS_ASSIGN_OR_RETURN(shape.ads, GetCount(object, "ads"));
+  PS_ASSIGN_OR_RETURN(shape.component_ads, GetCount(object, "component_ads"));
+  PS_ASSIGN_OR_RETURN(shape.user_bidding_signals_bytes,
+                      GetCount(object, "user_bidding_signals_bytes"));
+  return shape;
+}
+
+absl::StatusOr<BuyerShape> ParseBuyerShape(const rapidjson::Value& object) {
+  if (!object.IsObject()) {
+    return absl::InvalidArgumentError("Buyer must be an object");
+  }
+  BuyerShape shape;
+  PS_ASSIGN_OR_RETURN(shape.buyer_signals_bytes,
+                      GetCount(object, "buyer_signals_bytes"));
+  PS_ASSIGN_OR_RETURN(const rapidjson::Value* interest_groups,
+                      GetArray(object, "interest_groups"));
+  if (interest_groups != nullptr) {
+    for (const rapidjson::Value& interest_group : interest_groups->GetArray()) {
+      PS_ASSIGN_OR_RETURN(shape.interest_groups.emplace_back(),
+                          ParseInterestGroupShape(interest_group));
+    }
+  }
+  return shape;
+}
+
+}  // namespace
+
+RequestShape GetRequestShape(
+    const SelectAdRequest::AuctionConfig& auction_config,
+    const absl::flat_hash_map<absl::string_view, BuyerInput>& buyer_inputs) {
+  RequestShape shape;
+  shape.seller_signals_bytes = auction_config.seller_signals().size();
+  shape.auction_signals_bytes = auction_config.auction_signals().size();
+  for (const std::string& buyer : auction_config.buyer_list()) {
+    auto buyer_input = buyer_inputs.find(buyer);
+    if (buyer_input == buyer_inputs.end()) {
+      continue;
+    }
+    BuyerShape& buyer_shape = shape.buyers.emplace_back();
+    if (auto per_buyer_config = auction_config.per_buyer_config().find(buyer);
+        per_buyer_config != auction_config.per_buyer_config().end()) {
+      buyer_shape.buyer_signals_bytes =
+          per_buyer_config->second.buyer_signals().size();
+    }
+    for (const auto& interest_group : buyer_input->second.interest_groups()) {
+      InterestGroupShape& interest_group_shape =
+          buyer_shape.interest_groups.emplace_back();
+      interest_group_shape.bidding_signals_keys =
+          interest_group.bidding_signals_keys_size();
+      for (const std::string& key : interest_group.bidding_signals_keys()) {
+        interest_group_shape.bidding_signals_key_bytes += key.size();
+      }
+      interest_group_shape.ads = interest_group.ad_render_ids_size();
+      interest_group_shape.component_ads = interest_group.component_ads_size();
+      interest_group_shape.user_bidding_signals_bytes =
+          interest_group.user_bidding_signals().size();
+    }
+  }
+  return shape;
+}
+
+std::string RequestShapeToJson(const RequestShape& shape) {
+  std::vector<std::string> buyers;
+  buyers.reserve(shape.buyers.size());
+  for (const BuyerShape& buyer : shape.buyers) {
+    buyers.push_back(BuyerShapeToJson(buyer));
+  }
+  return absl::Substitute(
+      R"({"offset_ms":$0,"seller_signals_bytes":$1,)"
+      R"("auction_signals_bytes":$2,"buyers":[$3]})",
+      absl::ToInt64Milliseconds(shape.offset), shape.seller_signals_bytes,
+      shape.auction_signals_bytes, absl::StrJoin(buyers, ","));
+}
+
+absl::StatusOr<RequestShape> ParseRequestShape(absl::string_view json) {
+  // The parser needs a null terminated string.
+  const std::string line(json);
+  PS_ASSIGN_OR_RETURN(rapidjson::Document document, ParseJsonString(line));
+  if (!document.IsObject()) {
+    return absl::InvalidArgumentError("Request shape must be an object");
+  }
+  RequestShape shape;
+  PS_ASSIGN_OR_RETURN(int64_t offset_ms, GetCount(document, "offset_ms"));
+  shape.offset = absl::Milliseconds(offset_ms);
+  PS_ASSIGN_OR_RETURN(shape.seller_signals_bytes,
+                      GetCount(document, "seller_signals_bytes"));
+  PS_ASSIGN_OR_RETURN(shape.auction_signals_bytes,
+                      GetCount(document, "auction_signals_bytes"));
+  PS_ASSIGN_OR_RETURN(const rapidjson::Value* buyers,
+                      GetArray(document, "buyers"));
+  if (buyers != nullptr) {
+    for (const rapidjson::Value& buyer : buyers->GetArray()) {
+      PS_ASSIGN_OR_RETURN(shape.buyers.emplace_back(), ParseBuyerShape(buyer));
+    }
+  }
+  return shape;
+}
+
+absl::StatusOr<std::unique_ptr<RequestShapeRecorder>>
+RequestShapeRecorder::Create(absl::string_view path) {
+  std::ofstream out(std::string(path), std::ios::app);
+  if (!out.is_open()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Cannot open the request shapes file: ", path));
+  }
+  return std::unique_ptr<RequestShapeRecorder>(
+      new RequestShapeRecorder(std::move(out)));
+}
+
+RequestShapeRecorder::RequestShapeRecorder(std::ofstream out)
+    : start_(absl::Now()), out_(std::move(out)) {}
+
+void RequestShapeRecorder::Record(RequestShape shape) {
+  shape.offset = absl::Now() - start_;
+  const std::string line = RequestShapeToJson(shape);
+  absl::MutexLock lock(&mu_);
+  // Flushed line by line, so that a capture cut short stays readable.
+  out_ << line << std::endl;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
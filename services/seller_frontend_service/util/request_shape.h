@@ -0,0 +1,110 @@
+/*
+ * Copyright 2023 Google LLC
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SERVICES_SELLER_FRONTEND_SERVICE_UTIL_REQUEST_SHAPE_H_
+#define SERVICES_SELLER_FRONTEND_SERVICE_UTIL_REQUEST_SHAPE_H_
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.pb.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// The shape of a request is what load depends on: the counts and sizes of its
+// parts. It holds no names, keys, origins or signals, so that it can be
+// captured without capturing user data, and replayed with synthetic values.
+struct InterestGroupShape {
+  int bidding_signals_keys = 0;
+  // Total size of the bidding signals keys.
+  int bidding_signals_key_bytes = 0;
+  int ads = 0;
+  int component_ads = 0;
+  int user_bidding_signals_bytes = 0;
+
+  bool operator==(const InterestGroupShape&) const = default;
+};
+
+// The GetBids request of a buyer is shaped by its buyer input and signals.
+struct BuyerShape {
+  int buyer_signals_bytes = 0;
+  std::vector<InterestGroupShape> interest_groups;
+
+  bool operator==(const BuyerShape&) const = default;
+};
+
+struct RequestShape {
+  // Time the request was received at, since the capture started.
+  absl::Duration offset;
+  int seller_signals_bytes = 0;
+  int auction_signals_bytes = 0;
+  // The buyers with an input, in the order of the buyer list.
+  std::vector<BuyerShape> buyers;
+
+  bool operator==(const RequestShape&) const = default;
+};
+
+// Returns the shape of a SelectAd request from its auction config and its
+// decoded buyer inputs.
+RequestShape GetRequestShape(
+    const SelectAdRequest::AuctionConfig& auction_config,
+    const absl::flat_hash_map<absl::string_view, BuyerInput>& buyer_inputs);
+
+// Returns the shape as a single line JSON object, e.g.:
+// {"offset_ms":12,"seller_signals_bytes":2,"auction_signals_bytes":2,
+//  "buyers":[{"buyer_signals_bytes":3,"interest_groups":[
+//  {"bidding_signals_keys":1,"bidding_signals_key_bytes":4,"ads":2,
+//   "component_ads":0,"user_bidding_signals_bytes":0}]}]}
+std::string RequestShapeToJson(const RequestShape& shape);
+
+// Parses a shape from a line written by RequestShapeToJson.
+absl::StatusOr<RequestShape> ParseRequestShape(absl::string_view json);
+
+// Appends the shapes of the requests received to a file, one per line, with
+// their offsets from the creation of the recorder. Thread safe.
+class RequestShapeRecorder {
+ public:
+  // Creates a recorder appending to the file at `path`.
+  static absl::StatusOr<std::unique_ptr<RequestShapeRecorder>> Create(
+      absl::string_view path);
+
+  // Not copyable or movable.
+  RequestShapeRecorder(const RequestShapeRecorder&) = delete;
+  RequestShapeRecorder& operator=(const RequestShapeRecorder&) = delete;
+
+  // Records the shape of a request received now, ignoring its offset.
+  void Record(RequestShape shape) ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  explicit RequestShapeRecorder(std::ofstream out);
+
+  const absl::Time start_;
+  absl::Mutex mu_;
+  std::ofstream out_ ABSL_GUARDED_BY(mu_);
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // SERVICES_SELLER_FRONTEND_SERVICE_UTIL_REQUEST_SHAPE_H_
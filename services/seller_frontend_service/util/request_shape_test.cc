@@ -0,0 +1,119 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "services/seller_frontend_service/util/request_shape.h"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr char kBuyer[] = "https://buyer.com";
+constexpr char kOtherBuyer[] = "https://other-buyer.com";
+
+TEST(RequestShapeTest, CountsAndSizesWithoutValues) {
+  SelectAdRequest::AuctionConfig auction_config;
+  auction_config.set_seller_signals("[1,2]");
+  auction_config.set_auction_signals("{}");
+  auction_config.add_buyer_list(kOtherBuyer);
+  auction_config.add_buyer_list(kBuyer);
+  (*auction_config.mutable_per_buyer_config())[kBuyer].set_buyer_signals(
+      "[3]");
+  BuyerInput buyer_input;
+  auto* interest_group = buyer_input.add_interest_groups();
+  interest_group->set_name("secret-name");
+  interest_group->add_bidding_signals_keys("key");
+  interest_group->add_bidding_signals_keys("other");
+  interest_group->add_ad_render_ids("ad");
+  interest_group->set_user_bidding_signals("[4,5]");
+  absl::flat_hash_map<absl::string_view, BuyerInput> buyer_inputs = {
+      {kBuyer, buyer_input}};
+
+  RequestShape shape = GetRequestShape(auction_config, buyer_inputs);
+
+  RequestShape expected = {.seller_signals_bytes = 5,
+                           .auction_signals_bytes = 2,
+                           .buyers = {{.buyer_signals_bytes = 3,
+                                       .interest_groups = {{
+                                           .bidding_signals_keys = 2,
+                                           .bidding_signals_key_bytes = 8,
+                                           .ads = 1,
+                                           .user_bidding_signals_bytes = 5,
+                                       }}}}};
+  EXPECT_EQ(shape, expected);
+  EXPECT_THAT(RequestShapeToJson(shape), Not(HasSubstr("secret-name")));
+  EXPECT_THAT(RequestShapeToJson(shape), Not(HasSubstr(kBuyer)));
+}
+
+TEST(RequestShapeTest, ParsesWhatItWrites) {
+  RequestShape shape = {
+      .offset = absl::Milliseconds(1500),
+      .seller_signals_bytes = 10,
+      .buyers = {{.buyer_signals_bytes = 3,
+                  .interest_groups = {{.bidding_signals_keys = 1, .ads = 4},
+                                      {.component_ads = 2}}},
+                 {}}};
+
+  absl::StatusOr<RequestShape> parsed =
+      ParseRequestShape(RequestShapeToJson(shape));
+
+  ASSERT_TRUE(parsed.ok()) << parsed.status();
+  EXPECT_EQ(*parsed, shape);
+}
+
+TEST(RequestShapeTest, RejectsMalformedShapes) {
+  EXPECT_FALSE(ParseRequestShape("not json").ok());
+  EXPECT_FALSE(ParseRequestShape("[]").ok());
+  EXPECT_FALSE(ParseRequestShape(R"({"offset_ms":-1})").ok());
+  EXPECT_FALSE(ParseRequestShape(R"({"buyers":{}})").ok());
+}
+
+TEST(RequestShapeRecorderTest, AppendsOneLinePerRequest) {
+  const std::string path =
+      absl::StrCat(testing::TempDir(), "/request_shapes.jsonl");
+  std::remove(path.c_str());
+  {
+    absl::StatusOr<std::unique_ptr<RequestShapeRecorder>> recorder =
+        RequestShapeRecorder::Create(path);
+    ASSERT_TRUE(recorder.ok()) << recorder.status();
+    (*recorder)->Record({.seller_signals_bytes = 1});
+    (*recorder)->Record({.seller_signals_bytes = 2});
+  }
+
+  std::ifstream in(path);
+  std::string line;
+  std::vector<RequestShape> shapes;
+  while (std::getline(in, line)) {
+    absl::StatusOr<RequestShape> shape = ParseRequestShape(line);
+    ASSERT_TRUE(shape.ok()) << shape.status();
+    shapes.push_back(*shape);
+  }
+  ASSERT_EQ(shapes.size(), 2);
+  EXPECT_EQ(shapes[0].seller_signals_bytes, 1);
+  EXPECT_EQ(shapes[1].seller_signals_bytes, 2);
+  EXPECT_LE(shapes[0].offset, shapes[1].offset);
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -197,6 +197,9 @@ TrustedServersConfigClient CreateConfig() {
   config.SetFlagForTest(kTrue, ENABLE_SELLER_FRONTEND_BENCHMARKING);
   config.SetFlagForTest(kSellerOriginDomain, SELLER_ORIGIN_DOMAIN);
   config.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
+  config.SetFlagForTest(kFalse, ENABLE_STREAMING_SCORING);
+  config.SetFlagForTest("0", SPECULATIVE_SCORING_BUYER_PERCENT);
+  config.SetFlagForTest("0", REQUEST_MEMORY_BUDGET_MB);
   return config;
 }
 
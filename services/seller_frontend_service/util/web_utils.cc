@@ -14,21 +14,22 @@
 
 #include "services/seller_frontend_service/util/web_utils.h"
 
+#include <algorithm>
 #include <optional>
 #include <set>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/numeric/bits.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/ascii.h"
 #include "api/bidding_auction_servers.pb.h"
 #include "glog/logging.h"
-#include "rapidjson/document.h"
-#include "rapidjson/stringbuffer.h"
-#include "rapidjson/writer.h"
 #include "services/common/compression/gzip.h"
+#include "services/common/util/json_util.h"
 #include "services/common/util/status_macros.h"
+#include "services/seller_frontend_service/util/cbor_writer.h"
 
 #include "cbor.h"
 
@@ -77,61 +78,72 @@ absl::Status AddKVToMap(absl::string_view key, absl::string_view value,
   return absl::OkStatus();
 }
 
-// Decodes a Span of cbor* string objects and adds them to the provided list.
-RepeatedStringProto DecodeStringArray(absl::Span<cbor_item_t*> span,
+// Decodes an array of CBOR strings into a list.
+RepeatedStringProto DecodeStringArray(const CborItem& array,
                                       absl::string_view field_name,
                                       ErrorAccumulator& error_accumulator,
                                       bool fail_fast) {
   RepeatedStringProto repeated_field;
-  for (const cbor_item_t* ad : span) {
-    bool is_valid = IsTypeValid(&cbor_isa_string, ad, field_name, kString,
+  repeated_field.Reserve(array.size());
+  for (CborReader ads = array.Contents(); !ads.Done();) {
+    const CborItem ad = ads.Next();
+    bool is_valid = IsTypeValid(&CborItem::IsString, ad, field_name, kString,
                                 error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, repeated_field);
     if (is_valid) {
-      repeated_field.Add(DecodeCborString(ad));
+      repeated_field.Add(std::string(ad.GetString()));
     }
   }
 
   return repeated_field;
 }
 
-// Collects the prevWins arrays into a JSON array and stringifies the result.
-absl::StatusOr<std::string> GetStringifiedPrevWins(
-    absl::Span<cbor_item_t*> prev_wins_entries, absl::string_view owner,
-    ErrorAccumulator& error_accumulator, bool fail_fast) {
-  rapidjson::Document document;
-  document.SetArray();
-  rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+// Expected bytes of the JSON of a prevWins entry, e.g. [-1234,"ad_1234"],
+// which is written straight into a buffer reserved for all of them.
+inline constexpr size_t kPrevWinJsonSizeHint = 24;
+
+// Replaces out with the prevWins arrays as a JSON array. Returns false if
+// decoding stopped at an error because of fail_fast.
+bool DecodePrevWins(const CborItem& prev_wins_entries, absl::string_view owner,
+                    ErrorAccumulator& error_accumulator, bool fail_fast,
+                    std::string* out) {
+  out->clear();
+  JsonWriter writer(out, /*size_hint=*/2 + prev_wins_entries.size() *
+                                               kPrevWinJsonSizeHint);
+  writer.StartArray();
 
   // Previous win entries should be in the form [relative_time, ad_render_id]
   // where relative_time is an int and ad_render_id is a string.
-  for (const cbor_item_t* prev_win : prev_wins_entries) {
-    bool is_valid = IsTypeValid(&cbor_isa_array, prev_win, kPrevWinsEntry,
+  for (CborReader prev_wins = prev_wins_entries.Contents();
+       !prev_wins.Done();) {
+    const CborItem prev_win = prev_wins.Next();
+    bool is_valid = IsTypeValid(&CborItem::IsArray, prev_win, kPrevWinsEntry,
                                 kArray, error_accumulator);
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
+    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
     if (!is_valid) {
       continue;
     }
 
-    if (cbor_array_size(prev_win) != 2) {
+    if (prev_win.size() != 2) {
       const std::string error =
           absl::StrFormat(kPrevWinsNotCorrectLengthError, owner);
       error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE, error,
                                     ErrorCode::CLIENT_SIDE);
-      RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
+      RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
+      // There is no point in validating the entries of a malformed pair.
+      continue;
     }
 
-    // cbor_array_get calls cbor_incref() on the returned object, so call
-    // cbor_move().
-    ScopedCbor relative_time(cbor_array_get(prev_win, kRelativeTimeIndex));
-    IsTypeValid(&cbor_is_int, *relative_time, kPrevWinsTimeEntry, kInt,
+    CborReader pair = prev_win.Contents();
+    const CborItem relative_time = pair.Next();
+    IsTypeValid(&CborItem::IsInt, relative_time, kPrevWinsTimeEntry, kInt,
                 error_accumulator);
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
+    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
 
-    ScopedCbor maybe_ad_render_id(cbor_array_get(prev_win, kAdRenderIdIndex));
-    IsTypeValid(&cbor_isa_string, *maybe_ad_render_id, kPrevWinsAdRenderIdEntry,
-                kString, error_accumulator);
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, "");
+    const CborItem maybe_ad_render_id = pair.Next();
+    IsTypeValid(&CborItem::IsString, maybe_ad_render_id,
+                kPrevWinsAdRenderIdEntry, kString, error_accumulator);
+    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
 
     if (error_accumulator.HasErrors()) {
       // No point in processing invalid data but we may continue to validate the
@@ -139,335 +151,304 @@ absl::StatusOr<std::string> GetStringifiedPrevWins(
       continue;
     }
 
-    const int time = cbor_get_int(*relative_time);
-    const std::string ad_render_id = DecodeCborString(*maybe_ad_render_id);
-
-    // Convert to JSON array and add to the running JSON document.
-    rapidjson::Value array(rapidjson::kArrayType);
-    array.PushBack(time, allocator);
-    rapidjson::Value ad_render_id_value(rapidjson::kStringType);
-    ad_render_id_value.SetString(ad_render_id.c_str(), ad_render_id.length(),
-                                 allocator);
-    array.PushBack(ad_render_id_value, allocator);
-    document.PushBack(array, allocator);
+    const int time = relative_time.GetInt();
+    writer.StartArray()
+        .Int(time)
+        .String(maybe_ad_render_id.GetString())
+        .EndArray();
   }
 
-  rapidjson::StringBuffer string_buffer;
-  rapidjson::Writer<rapidjson::StringBuffer> writer(string_buffer);
-  document.Accept(writer);
-  return string_buffer.GetString();
+  writer.EndArray();
+  return true;
 }
 
-// Decodes browser signals object and sets it in the 'buyer_interest_group'.
-BrowserSignals DecodeBrowserSignals(const cbor_item_t* root,
-                                    absl::string_view owner,
-                                    ErrorAccumulator& error_accumulator,
-                                    bool fail_fast) {
-  BrowserSignals signals;
-  bool is_signals_valid_type = IsTypeValid(&cbor_isa_map, root, kBrowserSignals,
-                                           kMap, error_accumulator);
+// Decodes browser signals object into signals. Returns false if decoding
+// stopped at an error because of fail_fast. The previous wins are skipped if
+// summary_only.
+bool DecodeBrowserSignals(const CborItem& root, absl::string_view owner,
+                          ErrorAccumulator& error_accumulator, bool fail_fast,
+                          bool summary_only, BrowserSignals* signals) {
+  bool is_signals_valid_type = IsTypeValid(&CborItem::IsMap, root,
+                                           kBrowserSignals, kMap,
+                                           error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator, /*fail_fast=*/!is_signals_valid_type,
-                        signals);
-
-  absl::Span<cbor_pair> browser_signal_entries(cbor_map_handle(root),
-                                               cbor_map_size(root));
-  for (const cbor_pair& signal : browser_signal_entries) {
-    bool is_valid_key_type =
-        IsTypeValid(&cbor_isa_string, signal.key, kBrowserSignalsKey, kString,
-                    error_accumulator);
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
+                        false);
+
+  for (CborReader browser_signal_entries = root.Contents();
+       !browser_signal_entries.Done();) {
+    const CborItem key = browser_signal_entries.Next();
+    const CborItem value = browser_signal_entries.Next();
+    bool is_valid_key_type = IsTypeValid(&CborItem::IsString, key,
+                                         kBrowserSignalsKey, kString,
+                                         error_accumulator);
+    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
     if (!is_valid_key_type) {
       continue;
     }
 
-    const int index =
-        FindItemIndex(kBrowserSignalKeys, DecodeCborString(signal.key));
+    const int index = FindItemIndex(kBrowserSignalKeys, key.GetString());
     switch (index) {
       case 0: {  // Bid count.
         bool is_count_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsBidCount,
-                        kInt, error_accumulator);
-        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
+            IsTypeValid(&CborItem::IsInt, value, kBrowserSignalsBidCount, kInt,
+                        error_accumulator);
+        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
         if (is_count_valid_type) {
-          signals.set_bid_count(cbor_get_int(signal.value));
+          signals->set_bid_count(value.GetInt());
         }
         break;
       }
       case 1: {  // Join count.
         bool is_count_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsJoinCount,
+            IsTypeValid(&CborItem::IsInt, value, kBrowserSignalsJoinCount,
                         kInt, error_accumulator);
-        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
+        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
         if (is_count_valid_type) {
-          signals.set_join_count(cbor_get_int(signal.value));
+          signals->set_join_count(value.GetInt());
         }
         break;
       }
       case 2: {  // Recency.
         bool is_recency_valid_type =
-            IsTypeValid(&cbor_is_int, signal.value, kBrowserSignalsRecency,
-                        kInt, error_accumulator);
-        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
+            IsTypeValid(&CborItem::IsInt, value, kBrowserSignalsRecency, kInt,
+                        error_accumulator);
+        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
         if (is_recency_valid_type) {
-          signals.set_recency(cbor_get_int(signal.value));
+          signals->set_recency(value.GetInt());
         }
         break;
       }
       case 3: {  // Previous wins.
+        if (summary_only) {
+          break;
+        }
         bool is_win_valid_type =
-            IsTypeValid(&cbor_isa_array, signal.value, kBrowserSignalsPrevWins,
+            IsTypeValid(&CborItem::IsArray, value, kBrowserSignalsPrevWins,
                         kArray, error_accumulator);
-        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, signals);
-        if (is_win_valid_type) {
-          absl::Span<cbor_item_t*> prev_wins_entries(
-              cbor_array_handle(signal.value), cbor_array_size(signal.value));
-          absl::StatusOr<std::string> prev_wins = GetStringifiedPrevWins(
-              prev_wins_entries, owner, error_accumulator, fail_fast);
-          *signals.mutable_prev_wins() = std::move(*prev_wins);
+        RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, false);
+        if (is_win_valid_type &&
+            !DecodePrevWins(value, owner, error_accumulator, fail_fast,
+                            signals->mutable_prev_wins())) {
+          // Not a partial JSON array.
+          signals->clear_prev_wins();
+          return false;
         }
         break;
       }
     }
   }
 
-  return signals;
+  return true;
 }
 
-google::protobuf::Map<std::string, BuyerInput> DecodeInterestGroupEntries(
-    absl::Span<cbor_pair> interest_group_data_entries,
-    ErrorAccumulator& error_accumulator, bool fail_fast) {
-  google::protobuf::Map<std::string, BuyerInput> result;
-  for (const cbor_pair& interest_group : interest_group_data_entries) {
-    bool is_valid_key_type = IsTypeValid(&cbor_isa_string, interest_group.key,
-                                         kIgKey, kString, error_accumulator);
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, result);
-
-    if (!is_valid_key_type) {
-      continue;
-    }
-
-    const std::string owner = DecodeCborString(interest_group.key);
-    // The value is a gzip compressed bytestring.
-    bool is_owner_valid_type =
-        IsTypeValid(&cbor_isa_bytestring, interest_group.value, kIgValue,
-                    kByteString, error_accumulator);
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, result);
+// Returns the keys in the order of kComparator, which is the order keys must
+// have in a canonical CBOR map.
+template <typename T>
+std::vector<absl::string_view> OrderedKeys(
+    const ::google::protobuf::Map<std::string, T>& map) {
+  std::vector<absl::string_view> keys;
+  keys.reserve(map.size());
+  for (const auto& [key, unused] : map) {
+    keys.push_back(key);
+  }
+  std::sort(keys.begin(), keys.end(), kComparator);
+  return keys;
+}
 
-    if (!is_owner_valid_type) {
-      continue;
-    }
+int ReportingUrlsKeyCount(
+    const WinReportingUrls::ReportingUrls& reporting_urls) {
+  return static_cast<int>(!reporting_urls.reporting_url().empty()) +
+         static_cast<int>(!reporting_urls.interaction_reporting_urls().empty());
+}
 
-    const std::string compressed_igs(
-        reinterpret_cast<char*>(cbor_bytestring_handle(interest_group.value)),
-        cbor_bytestring_length(interest_group.value));
-    const absl::StatusOr<std::string> decompressed_buyer_input =
-        GzipDecompress(compressed_igs);
-    if (!decompressed_buyer_input.ok()) {
-      error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE,
-                                    kMalformedCompressedBytestring,
-                                    ErrorCode::CLIENT_SIDE);
+void WriteReportingUrls(absl::string_view key,
+                        const WinReportingUrls::ReportingUrls& reporting_urls,
+                        CborWriter& writer) {
+  const int key_count = ReportingUrlsKeyCount(reporting_urls);
+  if (key_count == 0) {
+    return;
+  }
+  writer.WriteString(key);
+  writer.StartMap(key_count);
+  if (!reporting_urls.reporting_url().empty()) {
+    writer.WriteString(kReportingUrl);
+    writer.WriteString(reporting_urls.reporting_url());
+  }
+  const InteractionUrlMap& interaction_url_map =
+      reporting_urls.interaction_reporting_urls();
+  if (!interaction_url_map.empty()) {
+    writer.WriteString(kInteractionReportingUrls);
+    writer.StartMap(interaction_url_map.size());
+    for (absl::string_view event : OrderedKeys(interaction_url_map)) {
+      writer.WriteString(event);
+      writer.WriteString(interaction_url_map.at(event));
     }
-    RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, result);
-
-    BuyerInput buyer_input = DecodeBuyerInput(owner, *decompressed_buyer_input,
-                                              error_accumulator, fail_fast);
-
-    result.insert({std::move(owner), std::move(buyer_input)});
   }
-
-  return result;
 }
 
-absl::Status CborSerializeString(absl::string_view key, absl::string_view value,
-                                 ErrorHandler error_handler,
-                                 cbor_item_t& root) {
-  struct cbor_pair kv = {
-      .key = cbor_move(cbor_build_stringn(key.data(), key.size())),
-      .value = cbor_move(cbor_build_stringn(value.data(), value.size()))};
-  if (!cbor_map_add(&root, std::move(kv))) {
-    error_handler(absl::StrCat("Failed to serialize ", key, " to CBOR"));
-    return absl::InternalError("");
+// Writes the win reporting URLs as CborSerializeWinReportingUrls does.
+void WriteWinReportingUrls(const WinReportingUrls& win_reporting_urls,
+                           CborWriter& writer) {
+  int key_count = 0;
+  if (win_reporting_urls.has_buyer_reporting_urls() &&
+      ReportingUrlsKeyCount(win_reporting_urls.buyer_reporting_urls()) > 0) {
+    ++key_count;
   }
-
-  return absl::OkStatus();
-}
-
-absl::Status CborSerializeFloat(absl::string_view key, double value,
-                                ErrorHandler error_handler, cbor_item_t& root) {
-  PS_ASSIGN_OR_RETURN(cbor_item_t * float_val, cbor_build_float(value));
-  struct cbor_pair kv = {
-      .key = cbor_move(cbor_build_stringn(key.data(), key.size())),
-      .value = cbor_move(float_val)};
-  if (!cbor_map_add(&root, std::move(kv))) {
-    error_handler(absl::StrCat("Failed to serialize ", key, " to CBOR"));
-    return absl::InternalError("");
+  if (win_reporting_urls.has_top_level_seller_reporting_urls() &&
+      ReportingUrlsKeyCount(
+          win_reporting_urls.top_level_seller_reporting_urls()) > 0) {
+    ++key_count;
   }
-
-  return absl::OkStatus();
-}
-
-absl::Status CborSerializeBool(absl::string_view key, bool value,
-                               ErrorHandler error_handler, cbor_item_t& root) {
-  struct cbor_pair kv = {
-      .key = cbor_move(cbor_build_stringn(key.data(), key.size())),
-      .value = cbor_move(cbor_build_bool(value))};
-  if (!cbor_map_add(&root, std::move(kv))) {
-    error_handler(absl::StrCat("Failed to serialize ", key, " to CBOR"));
-    return absl::InternalError("");
+  writer.WriteString(kWinReportingUrls);
+  writer.StartMap(key_count);
+  if (win_reporting_urls.has_buyer_reporting_urls()) {
+    WriteReportingUrls(kBuyerReportingUrls,
+                       win_reporting_urls.buyer_reporting_urls(), writer);
+  }
+  if (win_reporting_urls.has_top_level_seller_reporting_urls()) {
+    WriteReportingUrls(kTopLevelSellerReportingUrls,
+                       win_reporting_urls.top_level_seller_reporting_urls(),
+                       writer);
   }
-
-  return absl::OkStatus();
 }
 
-absl::Status CborSerializeAdComponentUrls(
-    absl::string_view key, const RepeatedStringProto& component_renders,
-    ErrorHandler error_handler, cbor_item_t& root) {
-  ScopedCbor serialized_component_renders(
-      cbor_new_definite_array(component_renders.size()));
-  for (const auto& component_render : component_renders) {
-    if (!cbor_array_push(
-            *serialized_component_renders,
-            cbor_move(cbor_build_stringn(component_render.data(),
-                                         component_render.size())))) {
-      error_handler(absl::StrCat("Failed to serialize ", key, " to CBOR"));
-      return absl::InternalError("");
+void WriteBiddingGroups(const BiddingGroupMap& bidding_groups,
+                        CborWriter& writer) {
+  writer.WriteString(kBiddingGroups);
+  writer.StartMap(bidding_groups.size());
+  for (absl::string_view origin : OrderedKeys(bidding_groups)) {
+    const auto& group_indices = bidding_groups.at(origin);
+    writer.WriteString(origin);
+    writer.StartArray(group_indices.index_size());
+    for (int32_t index : group_indices.index()) {
+      // Same as cbor_build_uint.
+      writer.WriteUint(static_cast<uint32_t>(index));
     }
   }
-
-  struct cbor_pair kv = {
-      .key = cbor_move(cbor_build_stringn(key.data(), key.size())),
-      .value = *serialized_component_renders};
-  if (!cbor_map_add(&root, std::move(kv))) {
-    error_handler(absl::StrCat("Failed to serialize ", key, " to CBOR"));
-    return absl::InternalError("");
-  }
-
-  return absl::OkStatus();
 }
 
-absl::Status CborSerializeScoreAdResponse(
-    const ScoreAdsResponse::AdScore& ad_score,
-    const BiddingGroupMap& bidding_group_map, ErrorHandler error_handler,
-    cbor_item_t& root) {
-  PS_RETURN_IF_ERROR(
-      CborSerializeFloat(kBid, ad_score.buyer_bid(), error_handler, root));
-  PS_RETURN_IF_ERROR(
-      CborSerializeFloat(kScore, ad_score.desirability(), error_handler, root));
-  PS_RETURN_IF_ERROR(CborSerializeBool(kChaff, false, error_handler, root));
-  PS_RETURN_IF_ERROR(CborSerializeAdComponentUrls(
-      kAdComponents, ad_score.component_renders(), error_handler, root));
-  PS_RETURN_IF_ERROR(CborSerializeString(kAdRenderUrl, ad_score.render(),
-                                         error_handler, root));
-  PS_RETURN_IF_ERROR(
-      CborSerializeBiddingGroups(bidding_group_map, error_handler, root));
-  PS_RETURN_IF_ERROR(CborSerializeWinReportingUrls(
-      ad_score.win_reporting_urls(), error_handler, root));
-  PS_RETURN_IF_ERROR(CborSerializeString(
-      kInterestGroupName, ad_score.interest_group_name(), error_handler, root));
-  PS_RETURN_IF_ERROR(CborSerializeString(kInterestGroupOwner,
-                                         ad_score.interest_group_owner(),
-                                         error_handler, root));
-  return absl::OkStatus();
+// Writes the keys of the AuctionResult in the order of kComparator.
+void WriteScoreAdResponse(const ScoreAdsResponse::AdScore& ad_score,
+                          const BiddingGroupMap& bidding_group_map,
+                          CborWriter& writer) {
+  const WinReportingUrls& win_reporting_urls = ad_score.win_reporting_urls();
+  const bool has_win_reporting_urls =
+      win_reporting_urls.has_buyer_reporting_urls() ||
+      win_reporting_urls.has_top_level_seller_reporting_urls();
+  writer.StartMap(has_win_reporting_urls ? 9 : 8);
+  writer.WriteString(kBid);
+  writer.WriteFloat(ad_score.buyer_bid());
+  writer.WriteString(kScore);
+  writer.WriteFloat(ad_score.desirability());
+  writer.WriteString(kChaff);
+  writer.WriteBool(false);
+  writer.WriteString(kAdComponents);
+  writer.StartArray(ad_score.component_renders_size());
+  for (const auto& component_render : ad_score.component_renders()) {
+    writer.WriteString(component_render);
+  }
+  writer.WriteString(kAdRenderUrl);
+  writer.WriteString(ad_score.render());
+  WriteBiddingGroups(bidding_group_map, writer);
+  if (has_win_reporting_urls) {
+    WriteWinReportingUrls(win_reporting_urls, writer);
+  }
+  writer.WriteString(kInterestGroupName);
+  writer.WriteString(ad_score.interest_group_name());
+  writer.WriteString(kInterestGroupOwner);
+  writer.WriteString(ad_score.interest_group_owner());
 }
 
-absl::StatusOr<std::string> GetCborSerializedAuctionResult(
-    ErrorHandler error_handler, cbor_item_t& cbor_data_root) {
-  // Serialize the payload to CBOR.
-  const size_t cbor_serialized_data_size =
-      cbor_serialized_size(&cbor_data_root);
-  if (!cbor_serialized_data_size) {
-    error_handler(
-        "Failed to serialize the AuctionResult to CBOR (data is too large!)");
-    return absl::InternalError("");
-  }
-
-  std::string byte_string;
-  byte_string.resize(cbor_serialized_data_size);
-  if (cbor_serialize(&cbor_data_root,
-                     reinterpret_cast<unsigned char*>(byte_string.data()),
-                     cbor_serialized_data_size) == 0) {
-    error_handler("Failed to serialize the AuctionResult to CBOR");
-    return absl::InternalError("");
-  }
-  return byte_string;
+void WriteError(const AuctionResult::Error& error, CborWriter& writer) {
+  writer.StartMap(1);
+  writer.WriteString(kError);
+  writer.StartMap(kNumErrorKeys);
+  writer.WriteString(kCode);
+  // Same as cbor_build_uint.
+  writer.WriteUint(static_cast<uint32_t>(error.code()));
+  writer.WriteString(kMessage);
+  writer.WriteString(error.message());
 }
 
-absl::Status CborSerializeError(const AuctionResult::Error& error,
-                                ErrorHandler error_handler, cbor_item_t& root) {
-  ScopedCbor serialized_error_map(cbor_new_definite_map(kNumErrorKeys));
-  const std::string& message = error.message();
-  struct cbor_pair message_kv = {
-      .key = cbor_move(cbor_build_stringn(kMessage, sizeof(kMessage) - 1)),
-      .value = cbor_move(cbor_build_stringn(message.data(), message.size()))};
-  if (!cbor_map_add(*serialized_error_map, std::move(message_kv))) {
-    error_handler(
-        absl::StrCat("Failed to serialize error ", kMessage, " to CBOR"));
-    return absl::InternalError("");
-  }
-
-  struct cbor_pair code_kv = {
-      .key = cbor_move(cbor_build_stringn(kCode, sizeof(kCode) - 1)),
-      .value = cbor_move(cbor_build_uint(error.code()))};
-  if (!cbor_map_add(*serialized_error_map, std::move(code_kv))) {
-    error_handler(
-        absl::StrCat("Failed to serialize error ", kCode, " to CBOR"));
-    return absl::InternalError("");
-  }
-
-  struct cbor_pair kv = {
-      .key = cbor_move(cbor_build_stringn(kError, sizeof(kError) - 1)),
-      .value = *serialized_error_map};
-  if (!cbor_map_add(&root, std::move(kv))) {
-    error_handler(absl::StrCat("Failed to serialize ", kError, " to CBOR"));
-    return absl::InternalError("");
+// Returns a size for the CBOR buffer that fits most AuctionResults, so that
+// the buffer is allocated once.
+size_t EstimateSerializedSize(
+    const std::optional<ScoreAdsResponse::AdScore>& high_score,
+    const BiddingGroupMap& bidding_group_map,
+    const std::optional<AuctionResult::Error>& error) {
+  // Keys, heads, and numbers.
+  size_t size = 256;
+  if (error.has_value()) {
+    return size + error->message().size();
+  }
+  if (!high_score.has_value()) {
+    return size;
+  }
+  size += high_score->render().size() +
+          high_score->interest_group_name().size() +
+          high_score->interest_group_owner().size();
+  for (const auto& component_render : high_score->component_renders()) {
+    size += component_render.size() + 2;
+  }
+  for (const auto& [origin, group_indices] : bidding_group_map) {
+    size += origin.size() + 4 + group_indices.index_size() * 5;
+  }
+  const WinReportingUrls& win_reporting_urls =
+      high_score->win_reporting_urls();
+  for (const auto* reporting_urls :
+       {&win_reporting_urls.buyer_reporting_urls(),
+        &win_reporting_urls.top_level_seller_reporting_urls()}) {
+    size += reporting_urls->reporting_url().size();
+    for (const auto& [event, url] :
+         reporting_urls->interaction_reporting_urls()) {
+      size += event.size() + url.size() + 4;
+    }
   }
-
-  return absl::OkStatus();
+  return size;
 }
 
 }  // namespace
 
 ConsentedDebugConfiguration DecodeConsentedDebugConfig(
-    const cbor_item_t* root, ErrorAccumulator& error_accumulator,
-    bool fail_fast) {
+    const CborItem& root, ErrorAccumulator& error_accumulator, bool fail_fast) {
   ConsentedDebugConfiguration consented_debug_config;
   bool is_config_valid_type = IsTypeValid(
-      &cbor_isa_map, root, kConsentedDebugConfig, kMap, error_accumulator);
+      &CborItem::IsMap, root, kConsentedDebugConfig, kMap, error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator, /*fail_fast=*/!is_config_valid_type,
                         consented_debug_config);
 
-  absl::Span<cbor_pair> entries(cbor_map_handle(root), cbor_map_size(root));
-  for (const cbor_pair& entry : entries) {
+  for (CborReader entries = root.Contents(); !entries.Done();) {
+    const CborItem key = entries.Next();
+    const CborItem value = entries.Next();
     bool is_valid_key_type =
-        IsTypeValid(&cbor_isa_string, entry.key, kConsentedDebugConfigKey,
+        IsTypeValid(&CborItem::IsString, key, kConsentedDebugConfigKey,
                     kString, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, consented_debug_config);
     if (!is_valid_key_type) {
       continue;
     }
 
-    const int index =
-        FindItemIndex(kConsentedDebugConfigKeys, DecodeCborString(entry.key));
+    const int index = FindItemIndex(kConsentedDebugConfigKeys, key.GetString());
     switch (index) {
       case 0: {  // IsConsented.
-        bool is_valid_type = IsTypeValid(&cbor_is_bool, entry.value,
+        bool is_valid_type = IsTypeValid(&CborItem::IsBool, value,
                                          kConsentedDebugConfigIsConsented,
                                          kString, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast,
                               consented_debug_config);
         if (is_valid_type) {
-          consented_debug_config.set_is_consented(cbor_get_bool(entry.value));
+          consented_debug_config.set_is_consented(value.GetBool());
         }
         break;
       }
       case 1: {  // Token.
         bool is_valid_type =
-            IsTypeValid(&cbor_isa_string, entry.value,
-                        kConsentedDebugConfigToken, kString, error_accumulator);
+            IsTypeValid(&CborItem::IsString, value, kConsentedDebugConfigToken,
+                        kString, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast,
                               consented_debug_config);
         if (is_valid_type) {
-          consented_debug_config.set_token(DecodeCborString(entry.value));
+          consented_debug_config.set_token(std::string(value.GetString()));
         }
         break;
       }
@@ -477,56 +458,53 @@ ConsentedDebugConfiguration DecodeConsentedDebugConfig(
 }
 
 EncodedBuyerInputs DecodeBuyerInputKeys(
-    cbor_item_t& compressed_encoded_buyer_inputs,
+    const CborItem& compressed_encoded_buyer_inputs,
     ErrorAccumulator& error_accumulator, bool fail_fast) {
   EncodedBuyerInputs encoded_buyer_inputs;
   bool is_buyer_inputs_valid_type =
-      IsTypeValid(&cbor_isa_map, &compressed_encoded_buyer_inputs,
+      IsTypeValid(&CborItem::IsMap, compressed_encoded_buyer_inputs,
                   kInterestGroups, kMap, error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator,
                         /*fail_fast=*/!is_buyer_inputs_valid_type,
                         encoded_buyer_inputs);
 
-  absl::Span<cbor_pair> interest_group_data_entries(
-      cbor_map_handle(&compressed_encoded_buyer_inputs),
-      cbor_map_size(&compressed_encoded_buyer_inputs));
-  for (const cbor_pair& interest_group : interest_group_data_entries) {
-    bool is_ig_key_valid_type =
-        IsTypeValid(&cbor_isa_string, interest_group.key, kIgKey, kString,
-                    error_accumulator);
+  for (CborReader interest_group_data_entries =
+           compressed_encoded_buyer_inputs.Contents();
+       !interest_group_data_entries.Done();) {
+    const CborItem key = interest_group_data_entries.Next();
+    const CborItem value = interest_group_data_entries.Next();
+    bool is_ig_key_valid_type = IsTypeValid(&CborItem::IsString, key, kIgKey,
+                                            kString, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, encoded_buyer_inputs);
 
     if (!is_ig_key_valid_type) {
       continue;
     }
 
-    const std::string owner = DecodeCborString(interest_group.key);
     // The value is a gzip compressed bytestring.
     bool is_ig_val_valid_type =
-        IsTypeValid(&cbor_isa_bytestring, interest_group.value, kIgValue,
-                    kByteString, error_accumulator);
+        IsTypeValid(&CborItem::IsByteString, value, kIgValue, kByteString,
+                    error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, encoded_buyer_inputs);
 
     if (!is_ig_val_valid_type) {
       continue;
     }
-    const std::string compressed_igs(
-        reinterpret_cast<char*>(cbor_bytestring_handle(interest_group.value)),
-        cbor_bytestring_length(interest_group.value));
-    encoded_buyer_inputs.insert({std::move(owner), std::move(compressed_igs)});
+    encoded_buyer_inputs.insert(
+        {std::string(key.GetString()), std::string(value.GetString())});
   }
 
   return encoded_buyer_inputs;
 }
 
-bool IsTypeValid(absl::AnyInvocable<bool(const cbor_item_t*)> is_valid_type,
-                 const cbor_item_t* item, absl::string_view field_name,
-                 absl::string_view expected_type,
+bool IsTypeValid(bool (CborItem::*is_valid_type)() const, const CborItem& item,
+                 absl::string_view field_name, absl::string_view expected_type,
                  ErrorAccumulator& error_accumulator, SourceLocation location) {
-  if (!is_valid_type(item)) {
+  if (!(item.*is_valid_type)()) {
     absl::string_view actual_type = kUnknownDataType;
-    if (item->type < kCborDataTypesLookup.size()) {
-      actual_type = kCborDataTypesLookup[item->type];
+    if (const auto type = static_cast<size_t>(item.type());
+        type < kCborDataTypesLookup.size()) {
+      actual_type = kCborDataTypesLookup[type];
     }
 
     std::string error = absl::StrFormat(kInvalidTypeError, field_name,
@@ -541,11 +519,6 @@ bool IsTypeValid(absl::AnyInvocable<bool(const cbor_item_t*)> is_valid_type,
   return true;
 }
 
-std::string DecodeCborString(const cbor_item_t* item) {
-  return std::string(reinterpret_cast<char*>(cbor_string_handle(item)),
-                     cbor_string_length(item));
-}
-
 cbor_item_t* cbor_build_uint(uint32_t input) {
   if (input <= 255) {
     return cbor_build_uint8(input);
@@ -696,23 +669,20 @@ absl::StatusOr<std::string> Encode(
     const std::optional<ScoreAdsResponse::AdScore>& high_score,
     const BiddingGroupMap& bidding_group_map,
     std::optional<AuctionResult::Error> error, ErrorHandler error_handler) {
-  // CBOR data's root handle. When serializing the auction result to CBOR, we
-  // use this handle to keep the temporary data.
-  ScopedCbor cbor_data_root(cbor_new_definite_map(kNumAuctionResultKeys));
-  auto* cbor_internal = cbor_data_root.get();
-
+  // The AuctionResult is written straight into a single buffer, instead of
+  // building it as libcbor items and serializing them.
+  CborWriter writer(
+      EstimateSerializedSize(high_score, bidding_group_map, error));
   if (error.has_value()) {
-    PS_RETURN_IF_ERROR(
-        CborSerializeError(*error, error_handler, *cbor_internal));
+    WriteError(*error, writer);
   } else if (high_score.has_value()) {
-    PS_RETURN_IF_ERROR(CborSerializeScoreAdResponse(
-        *high_score, bidding_group_map, error_handler, *cbor_internal));
+    WriteScoreAdResponse(*high_score, bidding_group_map, writer);
   } else {
-    PS_RETURN_IF_ERROR(
-        CborSerializeBool(kChaff, true, error_handler, *cbor_internal));
+    writer.StartMap(1);
+    writer.WriteString(kChaff);
+    writer.WriteBool(true);
   }
-
-  return GetCborSerializedAuctionResult(error_handler, *cbor_internal);
+  return std::move(writer).Finish();
 }
 
 DecodedBuyerInputs DecodeBuyerInputs(
@@ -730,13 +700,33 @@ DecodedBuyerInputs DecodeBuyerInputs(
   return decoded_buyer_inputs;
 }
 
-BuyerInput DecodeBuyerInput(absl::string_view owner,
-                            absl::string_view compressed_buyer_input,
-                            ErrorAccumulator& error_accumulator,
-                            bool fail_fast) {
+absl::StatusOr<std::string> DecompressBuyerInput(
+    absl::string_view compressed_buyer_input,
+    const ZstdDictionaryCodec* zstd_codec) {
+  if (!IsZstdFrame(compressed_buyer_input)) {
+    return GzipDecompress(compressed_buyer_input);
+  }
+  if (zstd_codec == nullptr) {
+    return absl::InvalidArgumentError(
+        "No zstd dictionaries to decompress the buyer input with");
+  }
+  return zstd_codec->Decompress(compressed_buyer_input);
+}
+
+namespace {
+
+// Decodes the CBOR encoded and compressed BuyerInput, or only the names and
+// browser signals but the previous wins of its interest groups if
+// summary_only.
+BuyerInput DecodeBuyerInputFields(absl::string_view owner,
+                                  absl::string_view compressed_buyer_input,
+                                  ErrorAccumulator& error_accumulator,
+                                  bool fail_fast,
+                                  const ZstdDictionaryCodec* zstd_codec,
+                                  bool summary_only) {
   BuyerInput buyer_input;
   const absl::StatusOr<std::string> decompressed_buyer_input =
-      GzipDecompress(compressed_buyer_input);
+      DecompressBuyerInput(compressed_buyer_input, zstd_codec);
   if (!decompressed_buyer_input.ok()) {
     error_accumulator.ReportError(
         ErrorVisibility::CLIENT_VISIBLE,
@@ -745,12 +735,8 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
     return buyer_input;
   }
 
-  cbor_load_result result;
-  ScopedCbor root(cbor_load(
-      reinterpret_cast<const unsigned char*>(decompressed_buyer_input->data()),
-      decompressed_buyer_input->size(), &result));
-
-  if (result.error.code != CBOR_ERR_NONE) {
+  std::optional<CborItem> root = ParseCbor(*decompressed_buyer_input);
+  if (!root.has_value()) {
     error_accumulator.ReportError(
         ErrorVisibility::CLIENT_VISIBLE,
         absl::StrFormat(kInvalidBuyerInputCborError, owner),
@@ -759,17 +745,18 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
   }
 
   bool is_buyer_input_valid_type = IsTypeValid(
-      &cbor_isa_array, *root, kBuyerInput, kArray, error_accumulator);
+      &CborItem::IsArray, *root, kBuyerInput, kArray, error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator,
                         /*fail_fast=*/!is_buyer_input_valid_type, buyer_input);
 
-  absl::Span<cbor_item_t*> interest_groups(cbor_array_handle(*root),
-                                           cbor_array_size(*root));
-  for (const cbor_item_t* interest_group : interest_groups) {
+  buyer_input.mutable_interest_groups()->Reserve(root->size());
+  for (CborReader interest_groups = root->Contents();
+       !interest_groups.Done();) {
+    const CborItem interest_group = interest_groups.Next();
     auto* buyer_interest_group = buyer_input.add_interest_groups();
 
     bool is_igs_valid_type =
-        IsTypeValid(&cbor_isa_map, interest_group, kBuyerInputEntry, kMap,
+        IsTypeValid(&CborItem::IsMap, interest_group, kBuyerInputEntry, kMap,
                     error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
@@ -777,92 +764,86 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
       continue;
     }
 
-    absl::Span<cbor_pair> ig_entries(cbor_map_handle(interest_group),
-                                     cbor_map_size(interest_group));
-    for (const cbor_pair& ig_entry : ig_entries) {
-      bool is_key_valid_type =
-          IsTypeValid(&cbor_isa_string, ig_entry.key, kBuyerInputKey, kString,
-                      error_accumulator);
+    for (CborReader ig_entries = interest_group.Contents();
+         !ig_entries.Done();) {
+      const CborItem key = ig_entries.Next();
+      const CborItem value = ig_entries.Next();
+      bool is_key_valid_type = IsTypeValid(&CborItem::IsString, key,
+                                           kBuyerInputKey, kString,
+                                           error_accumulator);
       RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
       if (!is_key_valid_type) {
         continue;
       }
 
-      const int index =
-          FindItemIndex(kInterestGroupKeys, DecodeCborString(ig_entry.key));
+      const int index = FindItemIndex(kInterestGroupKeys, key.GetString());
+      if (summary_only && index != 0 && index != 5) {
+        // Left to the full decode.
+        continue;
+      }
       switch (index) {
         case 0: {  // Name.
-          bool is_name_valid_type =
-              IsTypeValid(&cbor_isa_string, ig_entry.value, kIgName, kString,
-                          error_accumulator);
+          bool is_name_valid_type = IsTypeValid(
+              &CborItem::IsString, value, kIgName, kString, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
           if (is_name_valid_type) {
-            buyer_interest_group->set_name(DecodeCborString(ig_entry.value));
+            buyer_interest_group->set_name(std::string(value.GetString()));
           }
           break;
         }
         case 1: {  // Bidding signal keys.
           bool is_bs_valid_type =
-              IsTypeValid(&cbor_isa_array, ig_entry.value, kIgBiddingSignalKeys,
+              IsTypeValid(&CborItem::IsArray, value, kIgBiddingSignalKeys,
                           kArray, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_bs_valid_type) {
-            absl::Span<cbor_item_t*> bidding_signals_list(
-                cbor_array_handle(ig_entry.value),
-                cbor_array_size(ig_entry.value));
             *buyer_interest_group->mutable_bidding_signals_keys() =
-                DecodeStringArray(bidding_signals_list,
-                                  kIgBiddingSignalKeysEntry, error_accumulator,
-                                  fail_fast);
+                DecodeStringArray(value, kIgBiddingSignalKeysEntry,
+                                  error_accumulator, fail_fast);
           }
           break;
         }
         case 2: {  // User bidding signals.
           bool is_bs_valid_type =
-              IsTypeValid(&cbor_isa_string, ig_entry.value, kUserBiddingSignals,
+              IsTypeValid(&CborItem::IsString, value, kUserBiddingSignals,
                           kString, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_bs_valid_type) {
             *buyer_interest_group->mutable_user_bidding_signals() =
-                DecodeCborString(ig_entry.value);
+                value.GetString();
           }
           break;
         }
         case 3: {  // Ad render IDs.
           bool is_ad_render_valid_type = IsTypeValid(
-              &cbor_isa_array, ig_entry.value, kAds, kArray, error_accumulator);
+              &CborItem::IsArray, value, kAds, kArray, error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_ad_render_valid_type) {
-            absl::Span<cbor_item_t*> ads(cbor_array_handle(ig_entry.value),
-                                         cbor_array_size(ig_entry.value));
             *buyer_interest_group->mutable_ad_render_ids() = DecodeStringArray(
-                ads, kAdRenderId, error_accumulator, fail_fast);
+                value, kAdRenderId, error_accumulator, fail_fast);
           }
           break;
         }
         case 4: {  // Component ads.
           bool is_component_valid_type =
-              IsTypeValid(&cbor_isa_array, ig_entry.value, kAdComponent, kArray,
+              IsTypeValid(&CborItem::IsArray, value, kAdComponent, kArray,
                           error_accumulator);
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
 
           if (is_component_valid_type) {
-            absl::Span<cbor_item_t*> component_ads(
-                cbor_array_handle(ig_entry.value),
-                cbor_array_size(ig_entry.value));
             *buyer_interest_group->mutable_component_ads() = DecodeStringArray(
-                component_ads, kAdComponentEntry, error_accumulator, fail_fast);
+                value, kAdComponentEntry, error_accumulator, fail_fast);
           }
           break;
         }
         case 5: {  // Browser signals.
-          *buyer_interest_group->mutable_browser_signals() =
-              DecodeBrowserSignals(ig_entry.value, kIgBiddingSignalKeysEntry,
-                                   error_accumulator, fail_fast);
+          DecodeBrowserSignals(value, kIgBiddingSignalKeysEntry,
+                               error_accumulator, fail_fast, summary_only,
+                               buyer_interest_group->mutable_browser_signals());
           RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, buyer_input);
         }
       }
@@ -872,6 +853,27 @@ BuyerInput DecodeBuyerInput(absl::string_view owner,
   return buyer_input;
 }
 
+}  // namespace
+
+BuyerInput DecodeBuyerInput(absl::string_view owner,
+                            absl::string_view compressed_buyer_input,
+                            ErrorAccumulator& error_accumulator,
+                            bool fail_fast,
+                            const ZstdDictionaryCodec* zstd_codec) {
+  return DecodeBuyerInputFields(owner, compressed_buyer_input,
+                                error_accumulator, fail_fast, zstd_codec,
+                                /*summary_only=*/false);
+}
+
+BuyerInput SummarizeBuyerInput(absl::string_view owner,
+                               absl::string_view compressed_buyer_input,
+                               ErrorAccumulator& error_accumulator,
+                               bool fail_fast) {
+  return DecodeBuyerInputFields(owner, compressed_buyer_input,
+                                error_accumulator, fail_fast,
+                                /*zstd_codec=*/nullptr, /*summary_only=*/true);
+}
+
 absl::Status CborSerializeReportingUrls(
     absl::string_view key,
     const WinReportingUrls::ReportingUrls& reporting_urls,
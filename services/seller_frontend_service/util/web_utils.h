@@ -27,9 +27,11 @@
 #include "absl/strings/str_format.h"
 #include "api/bidding_auction_servers.grpc.pb.h"
 #include "api/bidding_auction_servers.pb.h"
+#include "services/common/compression/zstd.h"
 #include "services/common/util/error_accumulator.h"
 #include "services/common/util/request_response_constants.h"
 #include "services/common/util/scoped_cbor.h"
+#include "services/seller_frontend_service/util/cbor_reader.h"
 
 #include "cbor.h"
 
@@ -146,105 +148,98 @@ int FindItemIndex(const std::array<absl::string_view, Size>& haystack,
 }
 
 // Helper to validate the type of a CBOR object.
-bool IsTypeValid(absl::AnyInvocable<bool(const cbor_item_t*)> is_valid_type,
-                 const cbor_item_t* item, absl::string_view field_name,
-                 absl::string_view expected_type,
+bool IsTypeValid(bool (CborItem::*is_valid_type)() const, const CborItem& item,
+                 absl::string_view field_name, absl::string_view expected_type,
                  ErrorAccumulator& error_accumulator,
                  SourceLocation location PS_LOC_CURRENT_DEFAULT_ARG);
 
-// Reads a cbor item into a string. Caller must verify that the item is a string
-// before calling this method.
-std::string DecodeCborString(const cbor_item_t* item);
-
 // Decodes the key (i.e. owner) in the BuyerInputs in ProtectedAudienceInput
 // and copies the corresponding value (i.e. BuyerInput) as-is. Note: this method
 // doesn't decode the value.
 ::google::protobuf::Map<std::string, std::string> DecodeBuyerInputKeys(
-    cbor_item_t& compressed_encoded_buyer_inputs,
+    const CborItem& compressed_encoded_buyer_inputs,
     ErrorAccumulator& error_accumulator, bool fail_fast = true);
 
 // Decodes consented debug config object.
 ConsentedDebugConfiguration DecodeConsentedDebugConfig(
-    const cbor_item_t* root, ErrorAccumulator& error_accumulator,
-    bool fail_fast);
+    const CborItem& root, ErrorAccumulator& error_accumulator, bool fail_fast);
 
 template <typename T>
-T DecodeProtectedAuctionInput(cbor_item_t* root,
+T DecodeProtectedAuctionInput(const CborItem& root,
                               ErrorAccumulator& error_accumulator,
                               bool fail_fast) {
   T output;
 
-  IsTypeValid(&cbor_isa_map, root, kProtectedAuctionInput, kMap,
+  IsTypeValid(&CborItem::IsMap, root, kProtectedAuctionInput, kMap,
               error_accumulator);
   RETURN_IF_PREV_ERRORS(error_accumulator, /*fail_fast=*/true, output);
 
-  absl::Span<cbor_pair> entries(cbor_map_handle(root), cbor_map_size(root));
-  for (const cbor_pair& entry : entries) {
-    bool is_valid_key_type = IsTypeValid(
-        &cbor_isa_string, entry.key, kRootCborKey, kString, error_accumulator);
+  for (CborReader entries = root.Contents(); !entries.Done();) {
+    const CborItem key = entries.Next();
+    const CborItem value = entries.Next();
+    bool is_valid_key_type = IsTypeValid(&CborItem::IsString, key, kRootCborKey,
+                                         kString, error_accumulator);
     RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, output);
     if (!is_valid_key_type) {
       continue;
     }
 
-    const int index =
-        FindItemIndex(kRequestRootKeys, DecodeCborString(entry.key));
+    const int index = FindItemIndex(kRequestRootKeys, key.GetString());
     switch (index) {
       case 0: {  // Schema version.
         bool is_valid_schema_type = IsTypeValid(
-            &cbor_is_int, entry.value, kVersion, kInt, error_accumulator);
+            &CborItem::IsInt, value, kVersion, kInt, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, output);
 
         // Only support version 0 schemas for now.
-        if (is_valid_schema_type && cbor_get_int(entry.value) != 0) {
-          const std::string error = absl::StrFormat(
-              kUnsupportedSchemaVersionError, cbor_get_int(entry.value));
+        if (is_valid_schema_type && value.GetInt() != 0) {
+          const std::string error =
+              absl::StrFormat(kUnsupportedSchemaVersionError, value.GetInt());
           error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE, error,
                                         ErrorCode::CLIENT_SIDE);
         }
         break;
       }
       case 1: {  // Publisher.
-        bool is_valid_publisher_type =
-            IsTypeValid(&cbor_isa_string, entry.value, kPublisher, kString,
-                        error_accumulator);
+        bool is_valid_publisher_type = IsTypeValid(
+            &CborItem::IsString, value, kPublisher, kString, error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, output);
 
         if (is_valid_publisher_type) {
-          output.set_publisher_name(DecodeCborString(entry.value));
+          output.set_publisher_name(std::string(value.GetString()));
         }
         break;
       }
       case 2: {  // Interest groups.
         *output.mutable_buyer_input() =
-            DecodeBuyerInputKeys(*entry.value, error_accumulator, fail_fast);
+            DecodeBuyerInputKeys(value, error_accumulator, fail_fast);
         break;
       }
       case 3: {  // Generation Id.
         bool is_valid_gen_type =
-            IsTypeValid(&cbor_isa_string, entry.value, kGenerationId, kString,
+            IsTypeValid(&CborItem::IsString, value, kGenerationId, kString,
                         error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, output);
 
         if (is_valid_gen_type) {
-          output.set_generation_id(DecodeCborString(entry.value));
+          output.set_generation_id(std::string(value.GetString()));
         }
         break;
       }
       case 4: {  // Enable Debug Reporting.
         bool is_valid_debug_type =
-            IsTypeValid(&cbor_is_bool, entry.value, kDebugReporting, kString,
+            IsTypeValid(&CborItem::IsBool, value, kDebugReporting, kString,
                         error_accumulator);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, output);
 
         if (is_valid_debug_type) {
-          output.set_enable_debug_reporting(cbor_get_bool(entry.value));
+          output.set_enable_debug_reporting(value.GetBool());
         }
         break;
       }
       case 5: {  // Consented Debug Config.
-        *output.mutable_consented_debug_config() = DecodeConsentedDebugConfig(
-            entry.value, error_accumulator, fail_fast);
+        *output.mutable_consented_debug_config() =
+            DecodeConsentedDebugConfig(value, error_accumulator, fail_fast);
         RETURN_IF_PREV_ERRORS(error_accumulator, fail_fast, output);
         break;
       }
@@ -258,16 +253,14 @@ T DecodeProtectedAuctionInput(cbor_item_t* root,
 
 // Decodes CBOR-encoded ProtectedAudienceInput. Note that this method doesn't
 // decompress and decodes the BuyerInput values in the buyer input map. Any
-// errors are reported to `error_accumulator`.
+// errors are reported to `error_accumulator`. The payload is read in place,
+// without building a tree of CBOR items.
 template <typename T>
 T Decode(absl::string_view cbor_payload, ErrorAccumulator& error_accumulator,
          bool fail_fast = true) {
   T protected_auction_input;
-  cbor_load_result result;
-  ScopedCbor root(
-      cbor_load(reinterpret_cast<const unsigned char*>(cbor_payload.data()),
-                cbor_payload.size(), &result));
-  if (result.error.code != CBOR_ERR_NONE) {
+  std::optional<CborItem> root = ParseCbor(cbor_payload);
+  if (!root.has_value()) {
     error_accumulator.ReportError(ErrorVisibility::CLIENT_VISIBLE,
                                   kInvalidCborError, ErrorCode::CLIENT_SIDE);
     return protected_auction_input;
@@ -291,12 +284,31 @@ absl::flat_hash_map<absl::string_view, BuyerInput> DecodeBuyerInputs(
     const google::protobuf::Map<std::string, std::string>& encoded_buyer_inputs,
     ErrorAccumulator& error_accumulator, bool fail_fast = true);
 
+// Decompresses a BuyerInput compressed with gzip, or with one of the zstd
+// dictionaries of `zstd_codec` if it is a zstd frame. Returns an error for
+// zstd frames if `zstd_codec` is null.
+absl::StatusOr<std::string> DecompressBuyerInput(
+    absl::string_view compressed_buyer_input,
+    const ZstdDictionaryCodec* zstd_codec);
+
 // Decompresses and the decodes the CBOR encoded and compressed BuyerInput.
-// Errors are reported to `error_accumulator`.
+// Errors are reported to `error_accumulator`. See DecompressBuyerInput for
+// `zstd_codec`.
 BuyerInput DecodeBuyerInput(absl::string_view owner,
                             absl::string_view compressed_buyer_input,
                             ErrorAccumulator& error_accumulator,
-                            bool fail_fast = true);
+                            bool fail_fast = true,
+                            const ZstdDictionaryCodec* zstd_codec = nullptr);
+
+// Decodes only what the SFE needs of a gzip compressed BuyerInput that it
+// forwards as is to the buyer: the names, join counts, bid counts and
+// recencies of the interest groups. The other fields are neither decoded nor
+// validated, which is left to the BFE that decodes the BuyerInput with
+// DecodeBuyerInput. Errors are reported to `error_accumulator`.
+BuyerInput SummarizeBuyerInput(absl::string_view owner,
+                               absl::string_view compressed_buyer_input,
+                               ErrorAccumulator& error_accumulator,
+                               bool fail_fast = true);
 
 // Minimally encodes an unsigned int into CBOR. Caller is responsible for
 // decrementing the reference once done with the returned int.
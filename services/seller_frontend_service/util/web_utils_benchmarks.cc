@@ -0,0 +1,290 @@
+//  Copyright 2023 Google LLC
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//       http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+
+// Microbenchmarks for the CBOR decoding of the requests from browsers and the
+// CBOR encoding of the responses to them, in web_utils:
+// - BM_DecodeProtectedAuctionInput decodes the root of ProtectedAuctionInputs
+//   of 1 to 50 buyers, which leaves the buyer inputs compressed.
+// - BM_GzipDecompressBuyerInput decompresses buyer inputs of 10 to 500
+//   interest groups, and BM_DecodeBuyerInput both decompresses and decodes
+//   them, browser signals included, with prevWins arrays of 0 to 50 entries.
+// - BM_DecodeBuyerInputs decodes all the buyer inputs of 1 to 50 buyers.
+// - BM_EncodeAuctionResult encodes AuctionResults with bidding groups of 1
+//   to 50 buyers, of 10 to 500 interest groups each.
+//
+// The inputs are built up front, the same for every run, so that the
+// results can be compared across changes. Each benchmark reports the bytes
+// processed per second, and the allocations per iteration as allocs_per_op.
+//
+// Run with:
+//   bazel run -c opt //services/seller_frontend_service/util:web_utils_benchmarks
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "benchmark/benchmark.h"
+#include "services/common/compression/gzip.h"
+#include "services/common/test/utils/cbor_test_utils.h"
+#include "services/common/util/error_accumulator.h"
+#include "services/seller_frontend_service/util/web_utils.h"
+
+namespace {
+
+// Allocations of the process, counted by the replaced operator new.
+std::atomic<int64_t> allocations = 0;
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    std::abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// Shape of the interest groups of the benchmarks, about the size of the ones
+// browsers send.
+constexpr int kBiddingSignalsKeys = 2;
+constexpr int kAdRenderIds = 5;
+constexpr int kComponentAds = 2;
+// Interest groups of each buyer when the number of buyers varies.
+constexpr int kInterestGroupsPerBuyer = 20;
+
+// Counts the allocations from its construction, and reports them and the
+// bytes processed when it goes out of scope after the benchmark loop.
+class Counters {
+ public:
+  Counters(benchmark::State& state, int64_t bytes_per_iteration)
+      : state_(state),
+        bytes_per_iteration_(bytes_per_iteration),
+        allocations_(allocations.load(std::memory_order_relaxed)) {}
+
+  ~Counters() {
+    state_.counters["allocs_per_op"] = benchmark::Counter(
+        allocations.load(std::memory_order_relaxed) - allocations_,
+        benchmark::Counter::kAvgIterations);
+    state_.SetBytesProcessed(state_.iterations() * bytes_per_iteration_);
+  }
+
+ private:
+  benchmark::State& state_;
+  int64_t bytes_per_iteration_;
+  int64_t allocations_;
+};
+
+std::string Buyer(int index) {
+  return absl::StrCat("https://buyer-", index, ".example.com");
+}
+
+// Returns a prevWins JSON array of the given number of wins, as the CBOR test
+// encoder expects it.
+std::string MakePrevWins(int num_prev_wins) {
+  std::vector<std::string> prev_wins;
+  prev_wins.reserve(num_prev_wins);
+  for (int i = 0; i < num_prev_wins; ++i) {
+    prev_wins.push_back(
+        absl::StrCat("[", 60 * (i + 1), ",\"ad_render_id_", i, "\"]"));
+  }
+  return absl::StrCat("[", absl::StrJoin(prev_wins, ","), "]");
+}
+
+BuyerInput MakeBuyerInput(int num_interest_groups, int num_prev_wins) {
+  const std::string prev_wins = MakePrevWins(num_prev_wins);
+  BuyerInput buyer_input;
+  for (int i = 0; i < num_interest_groups; ++i) {
+    BuyerInput::InterestGroup* interest_group =
+        buyer_input.add_interest_groups();
+    interest_group->set_name(absl::StrCat("interest_group_", i));
+    for (int j = 0; j < kBiddingSignalsKeys; ++j) {
+      interest_group->add_bidding_signals_keys(
+          absl::StrCat("bidding_signals_key_", i, "_", j));
+    }
+    for (int j = 0; j < kAdRenderIds; ++j) {
+      interest_group->add_ad_render_ids(
+          absl::StrCat("ad_render_id_", i, "_", j));
+    }
+    for (int j = 0; j < kComponentAds; ++j) {
+      interest_group->add_component_ads(
+          absl::StrCat("component_ad_", i, "_", j));
+    }
+    interest_group->set_user_bidding_signals(
+        absl::StrCat("{\"segment\":", i, "}"));
+    BrowserSignals* browser_signals = interest_group->mutable_browser_signals();
+    browser_signals->set_join_count(i % 10);
+    browser_signals->set_bid_count(i % 50);
+    browser_signals->set_recency(3600);
+    browser_signals->set_prev_wins(prev_wins);
+  }
+  return buyer_input;
+}
+
+// Returns the compressed CBOR encoded buyer inputs of the given number of
+// buyers, by buyer.
+google::protobuf::Map<std::string, std::string> MakeEncodedBuyerInputs(
+    int num_buyers, int num_interest_groups, int num_prev_wins) {
+  google::protobuf::Map<std::string, BuyerInput> buyer_inputs;
+  const BuyerInput buyer_input =
+      MakeBuyerInput(num_interest_groups, num_prev_wins);
+  for (int i = 0; i < num_buyers; ++i) {
+    buyer_inputs[Buyer(i)] = buyer_input;
+  }
+  absl::StatusOr<google::protobuf::Map<std::string, std::string>> encoded =
+      GetEncodedBuyerInputMap(buyer_inputs);
+  CHECK(encoded.ok()) << encoded.status();
+  return *std::move(encoded);
+}
+
+int64_t TotalSize(
+    const google::protobuf::Map<std::string, std::string>& buyer_inputs) {
+  int64_t size = 0;
+  for (const auto& [buyer, buyer_input] : buyer_inputs) {
+    size += buyer_input.size();
+  }
+  return size;
+}
+
+void BM_DecodeProtectedAuctionInput(benchmark::State& state) {
+  ProtectedAuctionInput input;
+  input.set_publisher_name("publisher.example.com");
+  input.set_generation_id("6fa459ea-ee8a-3ca4-894e-db77e160355e");
+  *input.mutable_buyer_input() = MakeEncodedBuyerInputs(
+      state.range(0), kInterestGroupsPerBuyer, /*num_prev_wins=*/10);
+  absl::StatusOr<std::string> encoded = CborEncodeProtectedAuctionProto(input);
+  CHECK(encoded.ok()) << encoded.status();
+  Counters counters(state, encoded->size());
+  for (auto _ : state) {
+    ErrorAccumulator error_accumulator;
+    ProtectedAuctionInput decoded =
+        Decode<ProtectedAuctionInput>(*encoded, error_accumulator);
+    CHECK(!error_accumulator.HasErrors());
+    benchmark::DoNotOptimize(decoded);
+  }
+}
+
+void BM_GzipDecompressBuyerInput(benchmark::State& state) {
+  const google::protobuf::Map<std::string, std::string> buyer_inputs =
+      MakeEncodedBuyerInputs(/*num_buyers=*/1, state.range(0), state.range(1));
+  const std::string& compressed = buyer_inputs.begin()->second;
+  absl::StatusOr<std::string> decompressed = GzipDecompress(compressed);
+  CHECK(decompressed.ok()) << decompressed.status();
+  Counters counters(state, decompressed->size());
+  for (auto _ : state) {
+    decompressed = GzipDecompress(compressed);
+    CHECK(decompressed.ok()) << decompressed.status();
+    benchmark::DoNotOptimize(decompressed);
+  }
+  state.counters["compressed_bytes"] = compressed.size();
+}
+
+void BM_DecodeBuyerInput(benchmark::State& state) {
+  const google::protobuf::Map<std::string, std::string> buyer_inputs =
+      MakeEncodedBuyerInputs(/*num_buyers=*/1, state.range(0), state.range(1));
+  const auto& [buyer, compressed] = *buyer_inputs.begin();
+  Counters counters(state, compressed.size());
+  for (auto _ : state) {
+    ErrorAccumulator error_accumulator;
+    BuyerInput buyer_input =
+        DecodeBuyerInput(buyer, compressed, error_accumulator);
+    CHECK(!error_accumulator.HasErrors());
+    benchmark::DoNotOptimize(buyer_input);
+  }
+}
+
+void BM_DecodeBuyerInputs(benchmark::State& state) {
+  const google::protobuf::Map<std::string, std::string> buyer_inputs =
+      MakeEncodedBuyerInputs(state.range(0), kInterestGroupsPerBuyer,
+                             /*num_prev_wins=*/10);
+  Counters counters(state, TotalSize(buyer_inputs));
+  for (auto _ : state) {
+    ErrorAccumulator error_accumulator;
+    auto decoded = DecodeBuyerInputs(buyer_inputs, error_accumulator);
+    CHECK(!error_accumulator.HasErrors());
+    benchmark::DoNotOptimize(decoded);
+  }
+}
+
+void BM_EncodeAuctionResult(benchmark::State& state) {
+  ScoreAdsResponse::AdScore high_score;
+  high_score.set_desirability(1.5);
+  high_score.set_render("https://ads.example.com/render?id=1");
+  high_score.set_interest_group_name("interest_group_0");
+  high_score.set_interest_group_owner(Buyer(0));
+  high_score.set_buyer_bid(2.5);
+  google::protobuf::Map<std::string, AuctionResult::InterestGroupIndex>
+      bidding_groups;
+  for (int i = 0; i < state.range(0); ++i) {
+    AuctionResult::InterestGroupIndex& indices = bidding_groups[Buyer(i)];
+    for (int j = 0; j < state.range(1); ++j) {
+      indices.add_index(j);
+    }
+  }
+  const auto error_handler = [](absl::string_view error) {
+    CHECK(false) << error;
+  };
+  absl::StatusOr<std::string> encoded =
+      Encode(high_score, bidding_groups, std::nullopt, error_handler);
+  CHECK(encoded.ok()) << encoded.status();
+  Counters counters(state, encoded->size());
+  for (auto _ : state) {
+    encoded = Encode(high_score, bidding_groups, std::nullopt, error_handler);
+    CHECK(encoded.ok()) << encoded.status();
+    benchmark::DoNotOptimize(encoded);
+  }
+}
+
+// Args: buyers, from 1 to 50.
+void Buyers(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgName("buyers")->Arg(1)->Arg(5)->Arg(20)->Arg(50);
+}
+
+// Args: interest groups, from 10 to 500, and prevWins entries of each.
+void InterestGroupsAndPrevWins(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"interest_groups", "prev_wins"})
+      ->ArgsProduct({{10, 50, 100, 500}, {0, 10, 50}});
+}
+
+// Args: buyers, and interest groups in the bidding group of each.
+void BuyersAndInterestGroups(benchmark::internal::Benchmark* benchmark) {
+  benchmark->ArgNames({"buyers", "interest_groups"})
+      ->ArgsProduct({{1, 5, 20, 50}, {10, 100, 500}});
+}
+
+BENCHMARK(BM_DecodeProtectedAuctionInput)->Apply(Buyers);
+BENCHMARK(BM_GzipDecompressBuyerInput)->Apply(InterestGroupsAndPrevWins);
+BENCHMARK(BM_DecodeBuyerInput)->Apply(InterestGroupsAndPrevWins);
+BENCHMARK(BM_DecodeBuyerInputs)->Apply(Buyers);
+BENCHMARK(BM_EncodeAuctionResult)->Apply(BuyersAndInterestGroups);
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+BENCHMARK_MAIN();
@@ -376,6 +376,53 @@ TEST(ChromeRequestUtils, Decode_FailOnMalformedCompresedBytestring) {
                                   kMalformedCompressedBytestring));
 }
 
+TEST(ChromeRequestUtils, SummarizeBuyerInput_DecodesOnlyNamesAndCounts) {
+  ScopedCbor ig_array(cbor_new_definite_array(1));
+  EXPECT_TRUE(cbor_array_push(*ig_array, BuildSampleCborInterestGroup()));
+  absl::StatusOr<std::string> compressed =
+      GzipCompress(SerializeCbor(*ig_array));
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  ErrorAccumulator error_accumulator;
+  BuyerInput summary =
+      SummarizeBuyerInput(kSampleIgOwner, *compressed, error_accumulator);
+  ASSERT_FALSE(error_accumulator.HasErrors());
+
+  ASSERT_EQ(summary.interest_groups_size(), 1);
+  const BuyerInput::InterestGroup& interest_group = summary.interest_groups(0);
+  EXPECT_EQ(interest_group.name(), kSampleIgName);
+  EXPECT_EQ(interest_group.browser_signals().join_count(), kSampleJoinCount);
+  EXPECT_EQ(interest_group.browser_signals().bid_count(), kSampleBidCount);
+  EXPECT_EQ(interest_group.browser_signals().recency(), kSampleRecency);
+  // Left to the BFE, which decodes the whole buyer input.
+  EXPECT_TRUE(interest_group.browser_signals().prev_wins().empty());
+  EXPECT_TRUE(interest_group.bidding_signals_keys().empty());
+  EXPECT_TRUE(interest_group.ad_render_ids().empty());
+  EXPECT_TRUE(interest_group.component_ads().empty());
+  EXPECT_TRUE(interest_group.user_bidding_signals().empty());
+}
+
+TEST(ChromeRequestUtils, DecompressBuyerInput_GzipWithoutZstdCodec) {
+  const std::string buyer_input = "buyer_input";
+  absl::StatusOr<std::string> compressed = GzipCompress(buyer_input);
+  ASSERT_TRUE(compressed.ok()) << compressed.status();
+
+  absl::StatusOr<std::string> decompressed =
+      DecompressBuyerInput(*compressed, /*zstd_codec=*/nullptr);
+  ASSERT_TRUE(decompressed.ok()) << decompressed.status();
+  EXPECT_EQ(*decompressed, buyer_input);
+}
+
+TEST(ChromeRequestUtils, DecompressBuyerInput_FailsOnZstdWithoutDictionaries) {
+  // Magic number of a zstd frame, followed by a truncated header.
+  const std::string zstd_frame("\x28\xb5\x2f\xfd\x23", 5);
+  ASSERT_TRUE(IsZstdFrame(zstd_frame));
+
+  EXPECT_FALSE(DecompressBuyerInput(zstd_frame, /*zstd_codec=*/nullptr).ok());
+  ZstdDictionaryCodec codec;
+  EXPECT_FALSE(DecompressBuyerInput(zstd_frame, &codec).ok());
+}
+
 TEST(ChromeResponseUtils, VerifyBiddingGroupBuyerOriginOrdering) {
   const std::string interest_group_owner_1 = "ig1";
   const std::string interest_group_owner_2 = "zi";
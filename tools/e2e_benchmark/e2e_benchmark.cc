@@ -0,0 +1,222 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Starts SFE, BFE, Bidding and Auction in this process and drives synthetic
+// SelectAd load through them, reporting the end to end and per hop
+// latencies, the CPU time per request and the memory of the process.
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/log/check.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.grpc.pb.h"
+#include "glog/logging.h"
+#include "grpcpp/grpcpp.h"
+#include "services/common/test/utils/js_workloads.h"
+#include "services/common/util/read_system.h"
+#include "services/common/util/status_util.h"
+#include "tools/e2e_benchmark/hop_latency.h"
+#include "tools/e2e_benchmark/in_process_servers.h"
+#include "tools/e2e_benchmark/synthetic_auction.h"
+#include "tools/secure_invoke/load_generator.h"
+#include "tools/secure_invoke/payload_generator/payload_packaging.h"
+
+ABSL_FLAG(int, qps, 0,
+          "Requests sent per second, or 0 to send the next request as soon "
+          "as one completes");
+ABSL_FLAG(int, concurrency, 16, "Requests in flight at most");
+ABSL_FLAG(int, duration_s, 30, "Duration of the measured load");
+ABSL_FLAG(int, warm_up_s, 5,
+          "Duration of the load sent before the measured one, which is not "
+          "reported");
+ABSL_FLAG(int, corpus_size, 100, "Distinct SelectAd requests sent in turn");
+ABSL_FLAG(int, buyers, 2, "Buyers in every auction");
+ABSL_FLAG(int, interest_groups, 10, "Interest groups of every buyer");
+ABSL_FLAG(int, ads_per_interest_group, 5, "Ads of every interest group");
+ABSL_FLAG(int, signal_bytes, 256,
+          "Bytes of every signal served by the stub Key-Value servers");
+ABSL_FLAG(std::string, roma_stage, "bidding",
+          "Stage whose adtech code runs on Roma, bidding or auction. The "
+          "other stage answers with canned outputs");
+ABSL_FLAG(int, js_num_workers, 0,
+          "Roma workers, or 0 to let Roma pick their number");
+ABSL_FLAG(int, js_worker_queue_len, 0,
+          "Requests queued per Roma worker, or 0 to let Roma pick it");
+ABSL_FLAG(std::string, js_workload, "light",
+          "Workload of the adtech code run and of the trusted signals served: "
+          "light, json_heavy, math_heavy, large_closure or wasm");
+ABSL_FLAG(std::string, generate_bid_js_path, "",
+          "File of the generateBid code run, instead of the workload one");
+ABSL_FLAG(std::string, score_ad_js_path, "",
+          "File of the scoreAd code run, instead of the workload one");
+ABSL_FLAG(int, timeout_ms, 60000,
+          "Timeout of SelectAd, of the calls between the servers and of the "
+          "code runs");
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+// A SelectAd call in flight, which owns what the call must outlive.
+struct SelectAdCall {
+  grpc::ClientContext context;
+  SelectAdResponse response;
+  absl::AnyInvocable<void(absl::Status) &&> on_done;
+};
+
+std::string ReadFile(const std::string& path) {
+  std::ifstream ifs(path);
+  CHECK(ifs.good()) << "Could not read " << path;
+  return std::string((std::istreambuf_iterator<char>(ifs)),
+                     (std::istreambuf_iterator<char>()));
+}
+
+absl::Duration ProcessCpuTime() {
+  rusage usage;
+  CHECK_EQ(getrusage(RUSAGE_SELF, &usage), 0);
+  return absl::DurationFromTimeval(usage.ru_utime) +
+         absl::DurationFromTimeval(usage.ru_stime);
+}
+
+// Returns the resident memory of the process in MiB.
+double ResidentMiB() {
+  auto memory = server_common::GetMemory();
+  auto it = memory.find("main process");
+  return it == memory.end() ? 0 : it->second / 1024;
+}
+
+LoadReport SendLoad(SellerFrontEnd::Stub& stub,
+                    const std::vector<std::unique_ptr<SelectAdRequest>>& corpus,
+                    absl::Duration duration) {
+  const absl::Duration timeout =
+      absl::Milliseconds(absl::GetFlag(FLAGS_timeout_ms));
+  return RunLoad(
+      {.qps = absl::GetFlag(FLAGS_qps),
+       .concurrency = absl::GetFlag(FLAGS_concurrency),
+       .duration = duration},
+      static_cast<int>(corpus.size()),
+      [&](int index, absl::AnyInvocable<void(absl::Status) &&> on_done) {
+        auto* call = new SelectAdCall{.on_done = std::move(on_done)};
+        call->context.set_deadline(absl::ToChronoTime(absl::Now() + timeout));
+        stub.async()->SelectAd(&call->context, corpus[index].get(),
+                               &call->response,
+                               [call](const grpc::Status& status) {
+                                 std::unique_ptr<SelectAdCall> owned(call);
+                                 std::move(owned->on_done)(
+                                     ToAbslStatus(status));
+                               });
+        return absl::OkStatus();
+      });
+}
+
+void Run() {
+  absl::StatusOr<JsWorkload> js_workload =
+      ParseJsWorkload(absl::GetFlag(FLAGS_js_workload));
+  CHECK_OK(js_workload.status());
+  const SyntheticAuctionOptions auction_options = {
+      .buyers = absl::GetFlag(FLAGS_buyers),
+      .interest_groups_per_buyer = absl::GetFlag(FLAGS_interest_groups),
+      .ads_per_interest_group = absl::GetFlag(FLAGS_ads_per_interest_group),
+      .signal_bytes = absl::GetFlag(FLAGS_signal_bytes),
+      .js_workload = *js_workload};
+  const std::string roma_stage = absl::GetFlag(FLAGS_roma_stage);
+  CHECK(roma_stage == "bidding" || roma_stage == "auction")
+      << "Unknown --roma_stage: " << roma_stage;
+
+  InProcessServersOptions options = {
+      .roma_stage = roma_stage == "bidding" ? RomaStage::kBidding
+                                            : RomaStage::kAuction,
+      .js_workload = *js_workload,
+      .signal_bytes = auction_options.signal_bytes,
+      .timeout = absl::Milliseconds(absl::GetFlag(FLAGS_timeout_ms))};
+  options.dispatch_config.number_of_workers =
+      absl::GetFlag(FLAGS_js_num_workers);
+  options.dispatch_config.worker_queue_max_items =
+      absl::GetFlag(FLAGS_js_worker_queue_len);
+  if (std::string path = absl::GetFlag(FLAGS_generate_bid_js_path);
+      !path.empty()) {
+    options.generate_bid_js = ReadFile(path);
+  }
+  if (std::string path = absl::GetFlag(FLAGS_score_ad_js_path);
+      !path.empty()) {
+    options.score_ad_js = ReadFile(path);
+  }
+  for (int i = 0; i < auction_options.buyers; ++i) {
+    options.buyers.push_back(SyntheticBuyer(i));
+  }
+  HopLatencies hop_latencies;
+  options.hop_latencies = &hop_latencies;
+
+  const double idle_mib = ResidentMiB();
+  absl::StatusOr<std::unique_ptr<InProcessServers>> servers =
+      InProcessServers::Start(options);
+  CHECK_OK(servers.status()) << "Could not start the servers";
+
+  std::vector<std::unique_ptr<SelectAdRequest>> corpus;
+  for (int i = 0; i < std::max(absl::GetFlag(FLAGS_corpus_size), 1); ++i) {
+    corpus.push_back(PackagePlainTextSelectAdRequest(
+                         MakeSelectAdRequestJson(auction_options, i))
+                         .first);
+  }
+  std::unique_ptr<SellerFrontEnd::Stub> stub =
+      SellerFrontEnd::NewStub(grpc::CreateChannel(
+          (*servers)->sfe_address(), grpc::InsecureChannelCredentials()));
+
+  if (int warm_up_s = absl::GetFlag(FLAGS_warm_up_s); warm_up_s > 0) {
+    SendLoad(*stub, corpus, absl::Seconds(warm_up_s));
+    hop_latencies.Clear();
+  }
+  const double warm_mib = ResidentMiB();
+  const absl::Duration cpu_before = ProcessCpuTime();
+  LoadReport report = SendLoad(*stub, corpus,
+                               absl::Seconds(absl::GetFlag(FLAGS_duration_s)));
+  const absl::Duration cpu = ProcessCpuTime() - cpu_before;
+
+  // LOG causes clipping of the report.
+  std::cout << absl::StrFormat("JS workload: %s (corpus v%d)\n",
+                               JsWorkloadName(*js_workload),
+                               kJsWorkloadsVersion)
+            << report.ToString() << "\nPer hop latencies:\n"
+            << hop_latencies.ToString()
+            << absl::StrFormat(
+                   "\nCPU per request: %.3fms (%.2f cores)\n",
+                   report.requests > 0
+                       ? absl::ToDoubleMilliseconds(cpu) / report.requests
+                       : 0,
+                   absl::FDivDuration(cpu, report.elapsed))
+            << absl::StrFormat(
+                   "Resident memory: %.1fMiB idle, %.1fMiB warmed up, "
+                   "%.1fMiB after the load\n",
+                   idle_mib, warm_mib, ResidentMiB());
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+int main(int argc, char** argv) {
+  absl::ParseCommandLine(argc, argv);
+  google::InitGoogleLogging(argv[0]);
+  privacy_sandbox::bidding_auction_servers::Run();
+  return 0;
+}
@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/e2e_benchmark/hop_latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::grpc::experimental::InterceptionHookPoints;
+
+constexpr double kReportedPercentiles[] = {50, 90, 99};
+
+class HopLatencyInterceptor : public grpc::experimental::Interceptor {
+ public:
+  HopLatencyInterceptor(absl::string_view method, HopLatencies* latencies)
+      : method_(method), latencies_(latencies) {}
+
+  void Intercept(
+      grpc::experimental::InterceptorBatchMethods* methods) override {
+    if (methods->QueryInterceptionHookPoint(
+            InterceptionHookPoints::POST_RECV_INITIAL_METADATA)) {
+      start_ = absl::Now();
+    }
+    if (methods->QueryInterceptionHookPoint(
+            InterceptionHookPoints::PRE_SEND_STATUS)) {
+      latencies_->Record(method_, absl::Now() - start_);
+    }
+    methods->Proceed();
+  }
+
+ private:
+  const std::string method_;
+  HopLatencies* latencies_;
+  absl::Time start_ = absl::Now();
+};
+
+absl::Duration Percentile(const std::vector<absl::Duration>& latencies,
+                          double percentile) {
+  const int index = static_cast<int>(
+      std::ceil(percentile / 100 * latencies.size()) - 1);
+  return latencies[std::clamp<int>(index, 0, latencies.size() - 1)];
+}
+
+}  // namespace
+
+void HopLatencies::Record(absl::string_view method, absl::Duration latency) {
+  if (size_t slash = method.rfind('/'); slash != absl::string_view::npos) {
+    method.remove_prefix(slash + 1);
+  }
+  absl::MutexLock lock(&mu_);
+  latencies_[method].push_back(latency);
+}
+
+void HopLatencies::Clear() {
+  absl::MutexLock lock(&mu_);
+  latencies_.clear();
+}
+
+absl::btree_map<std::string, std::vector<absl::Duration>> HopLatencies::Get()
+    const {
+  absl::btree_map<std::string, std::vector<absl::Duration>> latencies;
+  {
+    absl::MutexLock lock(&mu_);
+    latencies = latencies_;
+  }
+  for (auto& [hop, hop_latencies] : latencies) {
+    std::sort(hop_latencies.begin(), hop_latencies.end());
+  }
+  return latencies;
+}
+
+std::string HopLatencies::ToString() const {
+  std::string out;
+  for (const auto& [hop, latencies] : Get()) {
+    absl::StrAppendFormat(&out, "%-32s calls: %d", hop, latencies.size());
+    for (double percentile : kReportedPercentiles) {
+      absl::StrAppendFormat(
+          &out, "  p%g: %.2fms", percentile,
+          absl::ToDoubleMilliseconds(Percentile(latencies, percentile)));
+    }
+    absl::StrAppend(&out, "\n");
+  }
+  return out;
+}
+
+grpc::experimental::Interceptor*
+HopLatencyInterceptorFactory::CreateServerInterceptor(
+    grpc::experimental::ServerRpcInfo* info) {
+  return new HopLatencyInterceptor(info->method(), latencies_);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
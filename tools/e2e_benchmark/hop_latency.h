@@ -0,0 +1,74 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_E2E_BENCHMARK_HOP_LATENCY_H_
+#define TOOLS_E2E_BENCHMARK_HOP_LATENCY_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/btree_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "grpcpp/support/server_interceptor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Latencies of the calls served by the in-process servers, by the method
+// they called, which tells the hops of a request apart.
+// Thread safe.
+class HopLatencies {
+ public:
+  // Records that a call to method, e.g. /package.SellerFrontEnd/SelectAd,
+  // took latency to serve.
+  void Record(absl::string_view method, absl::Duration latency)
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Forgets the latencies recorded so far, e.g. during a warm up.
+  void Clear() ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns the latencies recorded, in increasing order, keyed by the name of
+  // the method without its service, e.g. SelectAd.
+  absl::btree_map<std::string, std::vector<absl::Duration>> Get() const
+      ABSL_LOCKS_EXCLUDED(mu_);
+
+  // Returns a line per hop with the number of calls and latency percentiles.
+  std::string ToString() const ABSL_LOCKS_EXCLUDED(mu_);
+
+ private:
+  mutable absl::Mutex mu_;
+  absl::btree_map<std::string, std::vector<absl::Duration>> latencies_
+      ABSL_GUARDED_BY(mu_);
+};
+
+// Creates the interceptors recording the time between receiving a call and
+// sending its status into latencies, which must outlive the server.
+class HopLatencyInterceptorFactory
+    : public grpc::experimental::ServerInterceptorFactoryInterface {
+ public:
+  explicit HopLatencyInterceptorFactory(HopLatencies* latencies)
+      : latencies_(latencies) {}
+
+  grpc::experimental::Interceptor* CreateServerInterceptor(
+      grpc::experimental::ServerRpcInfo* info) override;
+
+ private:
+  HopLatencies* latencies_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_E2E_BENCHMARK_HOP_LATENCY_H_
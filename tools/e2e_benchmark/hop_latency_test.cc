@@ -0,0 +1,61 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/e2e_benchmark/hop_latency.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+using ::testing::Key;
+using ::testing::Pair;
+
+TEST(HopLatenciesTest, GroupsSortedLatenciesByMethodName) {
+  HopLatencies latencies;
+  latencies.Record("/pkg.SellerFrontEnd/SelectAd", absl::Milliseconds(3));
+  latencies.Record("/pkg.BuyerFrontEnd/GetBids", absl::Milliseconds(2));
+  latencies.Record("/pkg.SellerFrontEnd/SelectAd", absl::Milliseconds(1));
+  EXPECT_THAT(
+      latencies.Get(),
+      ElementsAre(Pair("GetBids", ElementsAre(absl::Milliseconds(2))),
+                  Pair("SelectAd", ElementsAre(absl::Milliseconds(1),
+                                               absl::Milliseconds(3)))));
+}
+
+TEST(HopLatenciesTest, ForgetsLatenciesOnClear) {
+  HopLatencies latencies;
+  latencies.Record("/pkg.SellerFrontEnd/SelectAd", absl::Milliseconds(3));
+  latencies.Clear();
+  EXPECT_THAT(latencies.Get(), IsEmpty());
+}
+
+TEST(HopLatenciesTest, ReportsPercentilesPerHop) {
+  HopLatencies latencies;
+  for (int i = 1; i <= 100; ++i) {
+    latencies.Record("/pkg.Bidding/GenerateBids", absl::Milliseconds(i));
+  }
+  std::string report = latencies.ToString();
+  EXPECT_THAT(report, HasSubstr("GenerateBids"));
+  EXPECT_THAT(report, HasSubstr("calls: 100"));
+  EXPECT_THAT(report, HasSubstr("p50: 50.00ms"));
+  EXPECT_THAT(report, HasSubstr("p99: 99.00ms"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,246 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/e2e_benchmark/in_process_servers.h"
+
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "services/auction_service/benchmarking/score_ads_no_op_logger.h"
+#include "services/auction_service/code_wrapper/seller_code_wrapper.h"
+#include "services/bidding_service/benchmarking/bidding_no_op_logger.h"
+#include "services/bidding_service/code_wrapper/buyer_code_wrapper.h"
+#include "services/common/clients/auction_server/scoring_async_client.h"
+#include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client_factory.h"
+#include "services/common/clients/code_dispatcher/dispatch_stats.h"
+#include "services/common/clients/http/multi_curl_http_fetcher_async.h"
+#include "services/common/encryption/crypto_client_factory.h"
+#include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/metric/server_definition.h"
+#include "services/common/util/status_macros.h"
+#include "services/seller_frontend_service/runtime_flags.h"
+#include "src/cpp/concurrent/event_engine_executor.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::grpc::experimental::ServerInterceptorFactoryInterface;
+
+// Initializes the metric context maps of the reactors of every server.
+void InitContextMaps() {
+  server_common::TelemetryConfig config_proto;
+  config_proto.set_mode(server_common::TelemetryConfig::PROD);
+  metric::SfeContextMap(server_common::BuildDependentConfig(config_proto));
+  metric::BfeContextMap(server_common::BuildDependentConfig(config_proto));
+  metric::BiddingContextMap(server_common::BuildDependentConfig(config_proto));
+  metric::AuctionContextMap(server_common::BuildDependentConfig(config_proto));
+}
+
+}  // namespace
+
+absl::StatusOr<std::unique_ptr<InProcessServers>> InProcessServers::Start(
+    const InProcessServersOptions& options) {
+  // Not make_unique, as the constructor is private.
+  std::unique_ptr<InProcessServers> servers(new InProcessServers());
+  PS_RETURN_IF_ERROR(servers->StartBackends(options));
+  PS_RETURN_IF_ERROR(servers->StartFrontends(options));
+  return servers;
+}
+
+InProcessServers::~InProcessServers() {
+  for (auto it = servers_.rbegin(); it != servers_.rend(); ++it) {
+    (*it)->Shutdown();
+  }
+  servers_.clear();
+  if (dispatcher_initialized_) {
+    dispatcher_.Stop().IgnoreError();
+  }
+}
+
+absl::Status InProcessServers::StartBackends(
+    const InProcessServersOptions& options) {
+  InitContextMaps();
+  // Encrypts with the test keys, as PackagePlainTextSelectAdRequest does.
+  config_client_.SetFlagForTest(kTrue, TEST_MODE);
+  config_client_.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
+  executor_ = std::make_unique<server_common::EventEngineExecutor>(
+      grpc_event_engine::experimental::CreateEventEngine());
+
+  PS_RETURN_IF_ERROR(dispatcher_.Init(options.dispatch_config))
+      << "Could not start code dispatcher.";
+  dispatcher_initialized_ = true;
+  DispatchStats::Get().SetNumWorkers(
+      options.dispatch_config.number_of_workers);
+  const bool roma_bidding = options.roma_stage == RomaStage::kBidding;
+  const JsWorkloadCode code = GetJsWorkloadCode(options.js_workload);
+  PS_RETURN_IF_ERROR(dispatcher_.LoadNextVersionSync(
+      roma_bidding
+          ? GetBuyerWrappedCode(options.generate_bid_js.empty()
+                                    ? code.generate_bid_js
+                                    : options.generate_bid_js,
+                                code.wasm)
+          : GetSellerWrappedCode(
+                options.score_ad_js.empty() ? code.score_ad_js
+                                            : options.score_ad_js,
+                /*enable_report_result_url_generation=*/false,
+                /*enable_report_win_url_generation=*/false,
+                /*buyer_origin_code_map=*/{},
+                /*enable_score_ads_batch_entry_function=*/false, code.wasm),
+      /*warm_up_requests=*/{}, options.timeout))
+      << "Could not load the adtech code.";
+  roma_client_ = std::make_unique<CodeDispatchClient>(dispatcher_);
+  canned_client_ = std::make_unique<CannedDispatchClient>(
+      dispatcher_, roma_bidding ? CannedDispatchClient::Stage::kScoreAd
+                                : CannedDispatchClient::Stage::kGenerateBid);
+  const CodeDispatchClient& bidding_client =
+      roma_bidding ? *roma_client_ : *canned_client_;
+  const CodeDispatchClient& scoring_client =
+      roma_bidding ? *canned_client_ : *roma_client_;
+  const std::string roma_timeout_ms =
+      absl::StrCat(absl::ToInt64Milliseconds(options.timeout));
+
+  auction_reporter_ = std::make_shared<AsyncReporter>(
+      std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get()),
+      kServerReportingOptions, executor_.get());
+  auction_service_ = std::make_unique<AuctionService>(
+      [&scoring_client, reporter = auction_reporter_](
+          const ScoreAdsRequest* request, ScoreAdsResponse* response,
+          server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+          CryptoClientWrapperInterface* crypto_client,
+          const AuctionServiceRuntimeConfig& runtime_config) {
+        return std::make_unique<ScoreAdsReactor>(
+            scoring_client, request, response,
+            std::make_unique<ScoreAdsNoOpLogger>(), key_fetcher_manager,
+            crypto_client, reporter, runtime_config);
+      },
+      CreateKeyFetcherManager(config_client_),
+      CreateCryptoClient(/*use_boringssl=*/true),
+      AuctionServiceRuntimeConfig{.encryption_enabled = true,
+                                  .roma_timeout_ms = roma_timeout_ms});
+  PS_ASSIGN_OR_RETURN(auction_address_,
+                      StartServer(*auction_service_, options.hop_latencies));
+
+  bidding_service_ = std::make_unique<BiddingService>(
+      [&bidding_client](
+          const GenerateBidsRequest* request, GenerateBidsResponse* response,
+          server_common::KeyFetcherManagerInterface* key_fetcher_manager,
+          CryptoClientWrapperInterface* crypto_client,
+          const BiddingServiceRuntimeConfig& runtime_config) {
+        return new GenerateBidsReactor(
+            bidding_client, request, response,
+            std::make_unique<BiddingNoOpLogger>(), key_fetcher_manager,
+            crypto_client, runtime_config);
+      },
+      CreateKeyFetcherManager(config_client_),
+      CreateCryptoClient(/*use_boringssl=*/true),
+      BiddingServiceRuntimeConfig{.encryption_enabled = true,
+                                  .roma_timeout_ms = roma_timeout_ms});
+  PS_ASSIGN_OR_RETURN(bidding_address_,
+                      StartServer(*bidding_service_, options.hop_latencies));
+  return absl::OkStatus();
+}
+
+absl::Status InProcessServers::StartFrontends(
+    const InProcessServersOptions& options) {
+  const int timeout_ms = absl::ToInt64Milliseconds(options.timeout);
+  buyer_frontend_service_ = std::make_unique<BuyerFrontEndService>(
+      std::make_unique<StubBiddingSignalsProvider>(MakeJsWorkloadTrustedSignal(
+          options.js_workload, options.signal_bytes)),
+      BiddingServiceClientConfig{
+          .server_addr = bidding_address_,
+          .secure_client = false,
+          .encryption_enabled = true},
+      CreateKeyFetcherManager(config_client_),
+      CreateCryptoClient(/*use_boringssl=*/true),
+      GetBidsConfig{
+          .generate_bid_timeout_ms = timeout_ms,
+          .bidding_signals_load_timeout_ms = timeout_ms,
+          .encryption_enabled = true,
+          .protected_app_signals_generate_bid_timeout_ms = timeout_ms,
+          .is_protected_app_signals_enabled = false,
+          .enable_otel_based_logging = false,
+      });
+  PS_ASSIGN_OR_RETURN(
+      std::string buyer_frontend_address,
+      StartServer(*buyer_frontend_service_, options.hop_latencies));
+
+  // The flags of the SelectAd reactor, as set by tools/debug/start_sfe.
+  config_client_.SetFlagForTest(kSyntheticSeller, SELLER_ORIGIN_DOMAIN);
+  config_client_.SetFlagForTest(kFalse, ENABLE_OTEL_BASED_LOGGING);
+  config_client_.SetFlagForTest("", CONSENTED_DEBUG_TOKEN);
+  config_client_.SetFlagForTest(kFalse, ENABLE_PROTECTED_APP_SIGNALS);
+  config_client_.SetFlagForTest(kFalse, ENABLE_STREAMING_SCORING);
+  config_client_.SetFlagForTest("0", SPECULATIVE_SCORING_BUYER_PERCENT);
+  config_client_.SetFlagForTest("0", REQUEST_MEMORY_BUDGET_MB);
+  config_client_.SetFlagForTest(kFalse, ENABLE_SELLER_FRONTEND_BENCHMARKING);
+  for (absl::string_view timeout_flag :
+       {GET_BID_RPC_TIMEOUT_MS, KEY_VALUE_SIGNALS_FETCH_RPC_TIMEOUT_MS,
+        SCORE_ADS_RPC_TIMEOUT_MS}) {
+    config_client_.SetFlagForTest(absl::StrCat(timeout_ms), timeout_flag);
+  }
+  sfe_key_fetcher_manager_ = CreateKeyFetcherManager(config_client_);
+  sfe_crypto_client_ = CreateCryptoClient(/*use_boringssl=*/true);
+  scoring_signals_provider_ = std::make_unique<StubScoringSignalsProvider>(
+      MakeJsWorkloadTrustedSignal(options.js_workload, options.signal_bytes));
+  scoring_client_ = std::make_unique<ScoringAsyncGrpcClient>(
+      sfe_key_fetcher_manager_.get(), sfe_crypto_client_.get(),
+      AuctionServiceClientConfig{
+          .server_addr = auction_address_,
+          .secure_client = false,
+          .encryption_enabled = true});
+  absl::flat_hash_map<std::string, std::string> buyer_frontend_addresses;
+  for (const std::string& buyer : options.buyers) {
+    buyer_frontend_addresses.try_emplace(buyer, buyer_frontend_address);
+  }
+  buyer_factory_ = std::make_unique<BuyerFrontEndAsyncClientFactory>(
+      buyer_frontend_addresses, sfe_key_fetcher_manager_.get(),
+      sfe_crypto_client_.get(),
+      BuyerServiceClientConfig{.secure_client = false,
+                               .encryption_enabled = true});
+  seller_frontend_service_ = std::make_unique<SellerFrontEndService>(
+      &config_client_,
+      ClientRegistry{
+          *scoring_signals_provider_, *scoring_client_, *buyer_factory_,
+          *sfe_key_fetcher_manager_,
+          std::make_unique<AsyncReporter>(
+              std::make_unique<MultiCurlHttpFetcherAsync>(executor_.get())),
+          executor_.get()});
+  PS_ASSIGN_OR_RETURN(
+      sfe_address_,
+      StartServer(*seller_frontend_service_, options.hop_latencies));
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> InProcessServers::StartServer(
+    grpc::Service& service, HopLatencies* hop_latencies) {
+  grpc::ServerBuilder builder;
+  int port = 0;
+  builder.AddListeningPort("localhost:0", grpc::InsecureServerCredentials(),
+                           &port);
+  builder.RegisterService(&service);
+  if (hop_latencies != nullptr) {
+    std::vector<std::unique_ptr<ServerInterceptorFactoryInterface>> creators;
+    creators.push_back(
+        std::make_unique<HopLatencyInterceptorFactory>(hop_latencies));
+    builder.experimental().SetInterceptorCreators(std::move(creators));
+  }
+  std::unique_ptr<grpc::Server> server = builder.BuildAndStart();
+  if (server == nullptr || port == 0) {
+    return absl::UnavailableError("Error starting Server.");
+  }
+  servers_.push_back(std::move(server));
+  return absl::StrCat("localhost:", port);
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,124 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_E2E_BENCHMARK_IN_PROCESS_SERVERS_H_
+#define TOOLS_E2E_BENCHMARK_IN_PROCESS_SERVERS_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "grpcpp/grpcpp.h"
+#include "services/auction_service/auction_service.h"
+#include "services/bidding_service/bidding_service.h"
+#include "services/buyer_frontend_service/buyer_frontend_service.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "services/common/clients/config/trusted_server_config_client.h"
+#include "services/common/reporters/async_reporter.h"
+#include "services/common/test/utils/js_workloads.h"
+#include "services/seller_frontend_service/seller_frontend_service.h"
+#include "src/cpp/concurrent/executor.h"
+#include "tools/e2e_benchmark/hop_latency.h"
+#include "tools/e2e_benchmark/synthetic_auction.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// Stage of the auction whose adtech code runs on Roma. Roma is initialized
+// once per process, and the buyer and seller wrappers cannot share a code
+// blob, so the other stage answers with canned outputs.
+enum class RomaStage { kBidding, kAuction };
+
+struct InProcessServersOptions {
+  RomaStage roma_stage = RomaStage::kBidding;
+  DispatchConfig dispatch_config;
+  // Workload of services/common/test/utils/js_workloads.h whose code runs on
+  // Roma, and whose signals the stub Key-Value servers serve.
+  JsWorkload js_workload = JsWorkload::kLight;
+  // Code run instead of the code of the workload, if not empty.
+  std::string generate_bid_js;
+  std::string score_ad_js;
+  // Buyer origins, all served by the one BFE.
+  std::vector<std::string> buyers;
+  // Bytes of every signal served by the stub Key-Value servers.
+  int signal_bytes = 256;
+  // Timeout of the calls between the servers and of the code runs.
+  absl::Duration timeout = absl::Seconds(60);
+  // Records the latency of the calls served by each server, if set. Must
+  // outlive the servers.
+  HopLatencies* hop_latencies = nullptr;
+};
+
+// SFE, BFE, Bidding and Auction servers running in this process, on local
+// ports with insecure credentials, set up as the tools/debug/start_* scripts
+// set up their binaries. The Key-Value servers are stubbed out.
+class InProcessServers {
+ public:
+  // Starts the servers, Auction and Bidding first, so that the frontends
+  // know where to reach them.
+  static absl::StatusOr<std::unique_ptr<InProcessServers>> Start(
+      const InProcessServersOptions& options);
+
+  // Not copyable or movable.
+  InProcessServers(const InProcessServers&) = delete;
+  InProcessServers& operator=(const InProcessServers&) = delete;
+
+  // Shuts the servers down, frontends first, then stops Roma.
+  ~InProcessServers();
+
+  // Returns the address SelectAd requests are sent to.
+  const std::string& sfe_address() const { return sfe_address_; }
+
+ private:
+  InProcessServers() = default;
+
+  absl::Status StartBackends(const InProcessServersOptions& options);
+  absl::Status StartFrontends(const InProcessServersOptions& options);
+
+  // Starts a server of service on an unused local port, whose address it
+  // returns.
+  absl::StatusOr<std::string> StartServer(grpc::Service& service,
+                                          HopLatencies* hop_latencies);
+
+  V8Dispatcher dispatcher_;
+  bool dispatcher_initialized_ = false;
+  std::unique_ptr<CodeDispatchClient> roma_client_;
+  std::unique_ptr<CannedDispatchClient> canned_client_;
+  // Holds the parameters the servers read, as the flags of their binaries.
+  TrustedServersConfigClient config_client_{/*all_flags=*/{}};
+  std::unique_ptr<server_common::Executor> executor_;
+  std::shared_ptr<AsyncReporter> auction_reporter_;
+  std::unique_ptr<BiddingService> bidding_service_;
+  std::unique_ptr<AuctionService> auction_service_;
+  std::unique_ptr<BuyerFrontEndService> buyer_frontend_service_;
+  std::unique_ptr<server_common::KeyFetcherManagerInterface>
+      sfe_key_fetcher_manager_;
+  std::unique_ptr<CryptoClientWrapperInterface> sfe_crypto_client_;
+  std::unique_ptr<StubScoringSignalsProvider> scoring_signals_provider_;
+  std::unique_ptr<ScoringAsyncClient> scoring_client_;
+  std::unique_ptr<ClientFactory<BuyerFrontEndAsyncClient, absl::string_view>>
+      buyer_factory_;
+  std::unique_ptr<SellerFrontEndService> seller_frontend_service_;
+  // In the order they started.
+  std::vector<std::unique_ptr<grpc::Server>> servers_;
+  std::string auction_address_;
+  std::string bidding_address_;
+  std::string sfe_address_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_E2E_BENCHMARK_IN_PROCESS_SERVERS_H_
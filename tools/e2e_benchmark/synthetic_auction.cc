@@ -0,0 +1,155 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/e2e_benchmark/synthetic_auction.h"
+
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_replace.h"
+#include "absl/strings/substitute.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kCannedBid[] =
+    R"({"response":{"render":"https://ads.example.com/render?id=$0","bid":$1},"logs":[],"errors":[],"warnings":[]})";
+constexpr char kCannedScore[] =
+    R"({"response":{"desirability":$0,"allowComponentAuction":false},"logs":[],"errors":[],"warnings":[]})";
+
+// Appends the interest groups of the buyer of the given index to a request.
+void AppendInterestGroups(const SyntheticAuctionOptions& options,
+                          int request_index, int buyer_index,
+                          std::string& json) {
+  for (int i = 0; i < options.interest_groups_per_buyer; ++i) {
+    std::vector<std::string> ad_render_ids;
+    for (int j = 0; j < options.ads_per_interest_group; ++j) {
+      ad_render_ids.push_back(absl::Substitute(
+          R"("https://ads.example.com/$0/ad?id=$1_$2_$3")", buyer_index,
+          request_index, i, j));
+    }
+    // The request holds the user bidding signals as a JSON string.
+    const std::string user_bidding_signals = absl::StrReplaceAll(
+        MakeJsWorkloadUserBiddingSignals(options.js_workload, request_index),
+        {{"\"", "\\\""}});
+    absl::StrAppend(
+        &json, i == 0 ? "" : ",",
+        absl::Substitute(
+            R"({"name":"ig_$0","bidding_signals_keys":["key_$0","key_$1"],)"
+            R"("ad_render_ids":[$2],"user_bidding_signals":"$3",)"
+            R"("browser_signals":{"join_count":$4,"bid_count":$5,)"
+            R"("recency":60,"prev_wins":"[]"}})",
+            i, (request_index + i) % options.interest_groups_per_buyer,
+            absl::StrJoin(ad_render_ids, ","), user_bidding_signals, i % 10,
+            request_index % 10));
+  }
+}
+
+}  // namespace
+
+std::string SyntheticBuyer(int index) {
+  return absl::StrCat("https://buyer-", index, ".example.com");
+}
+
+std::string MakeSelectAdRequestJson(const SyntheticAuctionOptions& options,
+                                    int index) {
+  std::vector<std::string> buyer_list;
+  std::vector<std::string> per_buyer_config;
+  std::vector<std::string> raw_buyer_input;
+  for (int i = 0; i < options.buyers; ++i) {
+    const std::string buyer = SyntheticBuyer(i);
+    buyer_list.push_back(absl::StrCat("\"", buyer, "\""));
+    per_buyer_config.push_back(
+        absl::Substitute(R"("$0":{"buyer_signals":"[$1]"})", buyer, i));
+    std::string interest_groups;
+    AppendInterestGroups(options, index, i, interest_groups);
+    raw_buyer_input.push_back(absl::Substitute(
+        R"("$0":{"interest_groups":[$1]})", buyer, interest_groups));
+  }
+  return absl::Substitute(
+      R"({"auction_config":{"seller_signals":"[1]","auction_signals":"[2]",)"
+      R"("buyer_list":[$0],"seller":"$1","per_buyer_config":{$2}},)"
+      R"("raw_protected_audience_input":{"raw_buyer_input":{$3},)"
+      R"("publisher_name":"publisher.example.com",)"
+      R"("generation_id":"generation-$4"}})",
+      absl::StrJoin(buyer_list, ","), kSyntheticSeller,
+      absl::StrJoin(per_buyer_config, ","), absl::StrJoin(raw_buyer_input, ","),
+      index);
+}
+
+void StubBiddingSignalsProvider::Get(
+    const BiddingSignalsRequest& params,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+        on_done,
+    absl::Duration timeout) const {
+  absl::flat_hash_set<absl::string_view> keys;
+  std::string signals = R"({"keys":{)";
+  for (const auto& interest_group :
+       params.get_bids_raw_request_.buyer_input().interest_groups()) {
+    for (const std::string& key : interest_group.bidding_signals_keys()) {
+      if (keys.insert(key).second) {
+        absl::StrAppend(&signals, keys.size() == 1 ? "" : ",", "\"", key,
+                        "\":", signal_);
+      }
+    }
+  }
+  absl::StrAppend(&signals, "}}");
+  auto bidding_signals = std::make_unique<BiddingSignals>();
+  bidding_signals->trusted_signals =
+      std::make_unique<std::string>(std::move(signals));
+  std::move(on_done)(std::move(bidding_signals));
+}
+
+void StubScoringSignalsProvider::Get(
+    const ScoringSignalsRequest& params,
+    absl::AnyInvocable<void(absl::StatusOr<std::unique_ptr<ScoringSignals>>) &&>
+        on_done,
+    absl::Duration timeout) const {
+  absl::flat_hash_set<absl::string_view> renders;
+  std::string signals = R"({"renderUrls":{)";
+  for (const auto& [buyer, get_bids_response] : params.buyer_bids_map_) {
+    for (const auto& bid : get_bids_response->bids()) {
+      if (renders.insert(bid.render()).second) {
+        absl::StrAppend(&signals, renders.size() == 1 ? "" : ",", "\"",
+                        bid.render(), "\":", signal_);
+      }
+    }
+  }
+  absl::StrAppend(&signals, "}}");
+  auto scoring_signals = std::make_unique<ScoringSignals>();
+  scoring_signals->scoring_signals =
+      std::make_unique<std::string>(std::move(signals));
+  std::move(on_done)(std::move(scoring_signals));
+}
+
+absl::Status CannedDispatchClient::BatchExecute(
+    std::vector<DispatchRequest>& batch,
+    BatchDispatchDoneCallback batch_callback) const {
+  std::vector<absl::StatusOr<DispatchResponse>> responses;
+  responses.reserve(batch.size());
+  for (int i = 0; i < batch.size(); i++) {
+    DispatchResponse response;
+    response.id = batch[i].id;
+    response.resp = stage_ == Stage::kGenerateBid
+                        ? absl::Substitute(kCannedBid, i, i + 1)
+                        : absl::Substitute(kCannedScore, i + 1);
+    responses.push_back(std::move(response));
+  }
+  batch_callback(responses);
+  return absl::OkStatus();
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
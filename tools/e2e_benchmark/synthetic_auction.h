@@ -0,0 +1,111 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_E2E_BENCHMARK_SYNTHETIC_AUCTION_H_
+#define TOOLS_E2E_BENCHMARK_SYNTHETIC_AUCTION_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/time/time.h"
+#include "services/buyer_frontend_service/providers/bidding_signals_async_provider.h"
+#include "services/common/clients/code_dispatcher/code_dispatch_client.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+#include "services/common/test/utils/js_workloads.h"
+#include "services/seller_frontend_service/providers/scoring_signals_async_provider.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+inline constexpr char kSyntheticSeller[] = "https://seller.example.com";
+
+// Shape of the synthetic SelectAd requests.
+struct SyntheticAuctionOptions {
+  int buyers = 2;
+  int interest_groups_per_buyer = 10;
+  int ads_per_interest_group = 5;
+  // Bytes of the synthetic value of every trusted signal.
+  int signal_bytes = 256;
+  // Workload the user bidding signals are shaped for.
+  JsWorkload js_workload = JsWorkload::kLight;
+};
+
+// Returns the origin of the buyer of the given index.
+std::string SyntheticBuyer(int index);
+
+// Returns the plaintext SelectAd request of the given index of the corpus, in
+// the JSON form that PackagePlainTextSelectAdRequest takes. The requests of
+// different indexes differ in their interest groups and ads.
+std::string MakeSelectAdRequestJson(const SyntheticAuctionOptions& options,
+                                    int index);
+
+// Stands in for the buyer Key-Value server, answering in place with `signal`
+// for every trusted bidding signals key requested.
+class StubBiddingSignalsProvider : public BiddingSignalsAsyncProvider {
+ public:
+  explicit StubBiddingSignalsProvider(std::string signal)
+      : signal_(std::move(signal)) {}
+
+  void Get(const BiddingSignalsRequest& params,
+           absl::AnyInvocable<void(
+               absl::StatusOr<std::unique_ptr<BiddingSignals>>) &&>
+               on_done,
+           absl::Duration timeout) const override;
+
+ private:
+  const std::string signal_;
+};
+
+// Stands in for the seller Key-Value server, answering in place with `signal`
+// for the render URL of every bid.
+class StubScoringSignalsProvider : public ScoringSignalsAsyncProvider {
+ public:
+  explicit StubScoringSignalsProvider(std::string signal)
+      : signal_(std::move(signal)) {}
+
+  void Get(const ScoringSignalsRequest& params,
+           absl::AnyInvocable<void(
+               absl::StatusOr<std::unique_ptr<ScoringSignals>>) &&>
+               on_done,
+           absl::Duration timeout) const override;
+
+ private:
+  const std::string signal_;
+};
+
+// Answers dispatches in place with a canned generateBid or scoreAd output,
+// for the stage of the auction that does not run on Roma.
+class CannedDispatchClient : public CodeDispatchClient {
+ public:
+  enum class Stage { kGenerateBid, kScoreAd };
+
+  // dispatcher is never dispatched to, and must outlive the client.
+  CannedDispatchClient(const V8Dispatcher& dispatcher, Stage stage)
+      : CodeDispatchClient(dispatcher), stage_(stage) {}
+
+  absl::Status BatchExecute(
+      std::vector<DispatchRequest>& batch,
+      BatchDispatchDoneCallback batch_callback) const override;
+
+ private:
+  const Stage stage_;
+};
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_E2E_BENCHMARK_SYNTHETIC_AUCTION_H_
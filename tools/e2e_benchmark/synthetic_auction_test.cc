@@ -0,0 +1,115 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/e2e_benchmark/synthetic_auction.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "services/common/clients/code_dispatcher/v8_dispatcher.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+TEST(MakeSelectAdRequestJsonTest, HasAnInterestGroupPerBuyerAsConfigured) {
+  std::string json = MakeSelectAdRequestJson(
+      {.buyers = 2, .interest_groups_per_buyer = 3}, /*index=*/7);
+  EXPECT_THAT(json, HasSubstr(absl::StrCat("\"seller\":\"", kSyntheticSeller,
+                                           "\"")));
+  EXPECT_THAT(json, HasSubstr(absl::StrCat("\"", SyntheticBuyer(0),
+                                           "\":{\"interest_groups\"")));
+  EXPECT_THAT(json, HasSubstr(absl::StrCat("\"", SyntheticBuyer(1),
+                                           "\":{\"interest_groups\"")));
+  EXPECT_THAT(json, Not(HasSubstr(SyntheticBuyer(2))));
+  EXPECT_THAT(json, HasSubstr("\"name\":\"ig_2\""));
+  EXPECT_THAT(json, Not(HasSubstr("\"name\":\"ig_3\"")));
+  EXPECT_THAT(json, HasSubstr("\"generation_id\":\"generation-7\""));
+}
+
+TEST(MakeSelectAdRequestJsonTest, DiffersByIndex) {
+  EXPECT_NE(MakeSelectAdRequestJson({}, 0), MakeSelectAdRequestJson({}, 1));
+}
+
+TEST(StubBiddingSignalsProviderTest, ServesEveryKeyOnce) {
+  GetBidsRequest::GetBidsRawRequest get_bids_raw_request;
+  for (int i = 0; i < 2; ++i) {
+    auto* interest_group =
+        get_bids_raw_request.mutable_buyer_input()->add_interest_groups();
+    interest_group->add_bidding_signals_keys("shared");
+    interest_group->add_bidding_signals_keys(absl::StrCat("key_", i));
+  }
+  absl::flat_hash_map<std::string, std::string> filtering_metadata;
+  std::string signals;
+  StubBiddingSignalsProvider(/*signal=*/R"(["ss"])")
+      .Get(BiddingSignalsRequest(get_bids_raw_request, filtering_metadata),
+           [&signals](absl::StatusOr<std::unique_ptr<BiddingSignals>> result) {
+             ASSERT_TRUE(result.ok());
+             signals = *(*result)->trusted_signals;
+           },
+           absl::Seconds(1));
+  EXPECT_EQ(signals,
+            R"({"keys":{"shared":["ss"],"key_0":["ss"],"key_1":["ss"]}})");
+}
+
+TEST(StubScoringSignalsProviderTest, ServesEveryRenderUrlOnce) {
+  BuyerBidsResponseMap buyer_bids;
+  for (const std::string& buyer : {"buyer_0", "buyer_1"}) {
+    auto response = std::make_unique<GetBidsResponse::GetBidsRawResponse>();
+    response->add_bids()->set_render("https://ads.example.com/shared");
+    buyer_bids.try_emplace(buyer, std::move(response));
+  }
+  absl::flat_hash_map<std::string, std::string> filtering_metadata;
+  std::string signals;
+  StubScoringSignalsProvider(/*signal=*/R"(["ss"])")
+      .Get(ScoringSignalsRequest(buyer_bids, filtering_metadata),
+           [&signals](absl::StatusOr<std::unique_ptr<ScoringSignals>> result) {
+             ASSERT_TRUE(result.ok());
+             signals = *(*result)->scoring_signals;
+           },
+           absl::Seconds(1));
+  EXPECT_EQ(signals,
+            R"({"renderUrls":{"https://ads.example.com/shared":["ss"]}})");
+}
+
+TEST(CannedDispatchClientTest, AnswersEveryRequestOfTheBatch) {
+  V8Dispatcher dispatcher;
+  CannedDispatchClient client(dispatcher,
+                              CannedDispatchClient::Stage::kScoreAd);
+  std::vector<DispatchRequest> batch(2);
+  batch[0].id = "first";
+  batch[1].id = "second";
+  std::vector<absl::StatusOr<DispatchResponse>> responses;
+  ASSERT_TRUE(client
+                  .BatchExecute(batch,
+                                [&responses](const std::vector<absl::StatusOr<
+                                                 DispatchResponse>>& result) {
+                                  responses = result;
+                                })
+                  .ok());
+  ASSERT_EQ(responses.size(), 2);
+  ASSERT_TRUE(responses[1].ok());
+  EXPECT_EQ(responses[1]->id, "second");
+  EXPECT_THAT(responses[1]->resp, HasSubstr("\"desirability\":2"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
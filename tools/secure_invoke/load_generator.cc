@@ -0,0 +1,141 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/secure_invoke/load_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/synchronization/mutex.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr double kReportedPercentiles[] = {50, 90, 99, 99.9};
+
+// Requests in flight and the outcome of the completed ones.
+struct LoadState {
+  absl::Mutex mu;
+  int in_flight ABSL_GUARDED_BY(mu) = 0;
+  LoadReport report ABSL_GUARDED_BY(mu);
+
+  void Complete(absl::Time due, const absl::Status& status)
+      ABSL_LOCKS_EXCLUDED(mu) {
+    const absl::Duration latency = absl::Now() - due;
+    absl::MutexLock lock(&mu);
+    --in_flight;
+    ++report.requests;
+    report.latencies.push_back(latency);
+    if (!status.ok()) {
+      ++report.errors[status.code()];
+    }
+  }
+};
+
+}  // namespace
+
+double LoadReport::Qps() const {
+  if (elapsed <= absl::ZeroDuration()) {
+    return 0;
+  }
+  return requests / absl::ToDoubleSeconds(elapsed);
+}
+
+absl::Duration LoadReport::Percentile(double percentile) const {
+  if (latencies.empty()) {
+    return absl::ZeroDuration();
+  }
+  const auto rank = static_cast<size_t>(
+      std::ceil(latencies.size() * std::clamp(percentile, 0.0, 100.0) / 100));
+  return latencies[std::clamp<size_t>(rank, 1, latencies.size()) - 1];
+}
+
+std::string LoadReport::ToString() const {
+  std::string report =
+      absl::StrFormat("Requests: %d in %s (%.1f QPS)\n", requests,
+                      absl::FormatDuration(elapsed), Qps());
+  for (double percentile : kReportedPercentiles) {
+    absl::StrAppend(&report, "p", percentile, ": ",
+                    absl::FormatDuration(Percentile(percentile)), "\n");
+  }
+  for (const auto& [code, count] : errors) {
+    absl::StrAppend(&report, absl::StatusCodeToString(code), ": ", count,
+                    "\n");
+  }
+  return report;
+}
+
+LoadReport RunLoad(const LoadOptions& load_options, int corpus_size,
+                   SendRequest send_request) {
+  LoadState state;
+  const absl::Duration interval = load_options.qps > 0
+                                      ? absl::Seconds(1) / load_options.qps
+                                      : absl::ZeroDuration();
+  const bool scheduled = !load_options.schedule.empty();
+  const bool paced = scheduled || interval > absl::ZeroDuration();
+  const int concurrency = std::max(load_options.concurrency, 1);
+  const absl::Time start = absl::Now();
+  const absl::Time end = start + load_options.duration;
+  absl::Time due = start;
+  for (int64_t sent = 0;; ++sent) {
+    if (scheduled) {
+      if (sent == static_cast<int64_t>(load_options.schedule.size())) {
+        break;
+      }
+      due = start + load_options.schedule[sent];
+    }
+    if (paced) {
+      absl::SleepFor(due - absl::Now());
+    }
+    {
+      absl::MutexLock lock(&state.mu);
+      auto has_capacity = [&state, concurrency]()
+                              ABSL_EXCLUSIVE_LOCKS_REQUIRED(state.mu) {
+                                return state.in_flight < concurrency;
+                              };
+      state.mu.AwaitWithDeadline(absl::Condition(&has_capacity), end);
+      if (absl::Now() >= end) {
+        break;
+      }
+      ++state.in_flight;
+    }
+    if (!paced) {
+      due = absl::Now();
+    }
+    absl::Status status =
+        send_request(static_cast<int>(sent % corpus_size),
+                     [&state, due](absl::Status response_status) {
+                       state.Complete(due, response_status);
+                     });
+    if (!status.ok()) {
+      state.Complete(due, status);
+    }
+    due += interval;
+  }
+
+  absl::MutexLock lock(&state.mu);
+  auto all_completed = [&state]() ABSL_EXCLUSIVE_LOCKS_REQUIRED(state.mu) {
+    return state.in_flight == 0;
+  };
+  state.mu.Await(absl::Condition(&all_completed));
+  LoadReport report = std::move(state.report);
+  report.elapsed = absl::Now() - start;
+  std::sort(report.latencies.begin(), report.latencies.end());
+  return report;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,80 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_INVOKE_LOAD_GENERATOR_H_
+#define TOOLS_INVOKE_LOAD_GENERATOR_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/functional/any_invocable.h"
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+struct LoadOptions {
+  // Requests sent per second, or 0 to send the next request as soon as one
+  // completes.
+  int qps = 0;
+  // Requests in flight at most.
+  int concurrency = 1;
+  absl::Duration duration = absl::Seconds(10);
+  // Offsets from the start at which the requests are due, in order, if set,
+  // in place of qps. The load then ends after the last of them, unless the
+  // duration ends first.
+  std::vector<absl::Duration> schedule;
+};
+
+// Sends the request of the given index of the corpus, and calls on_done with
+// the status of the response. Returns the error if the request could not be
+// sent, in which case on_done is not called.
+using SendRequest = absl::AnyInvocable<absl::Status(
+    int index, absl::AnyInvocable<void(absl::Status) &&> on_done)>;
+
+// Outcome of a load run.
+struct LoadReport {
+  int64_t requests = 0;
+  absl::Duration elapsed;
+  // Latencies of the requests, successful or not, in increasing order.
+  std::vector<absl::Duration> latencies;
+  // Failed requests by status code.
+  std::map<absl::StatusCode, int64_t> errors;
+
+  // Returns the completed requests per second.
+  double Qps() const;
+
+  // Returns the latency under which the given percentile of the requests
+  // completed.
+  absl::Duration Percentile(double percentile) const;
+
+  // Returns the report in a human readable form.
+  std::string ToString() const;
+};
+
+// Sends the requests of a corpus of the given, positive, size in turn, as
+// load_options dictate, and returns the outcome once all the requests sent
+// completed.
+//
+// At a target QPS or on a schedule, the latency of a request is measured from
+// the time it was due rather than sent, so that a backlog of requests stuck
+// behind the concurrency limit shows up in the latencies.
+LoadReport RunLoad(const LoadOptions& load_options, int corpus_size,
+                   SendRequest send_request);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_INVOKE_LOAD_GENERATOR_H_
@@ -0,0 +1,142 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/secure_invoke/load_generator.h"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::Ge;
+using ::testing::HasSubstr;
+using ::testing::Pair;
+
+TEST(LoadReportTest, ReportsPercentilesAndErrors) {
+  LoadReport report;
+  for (int i = 1; i <= 100; ++i) {
+    report.latencies.push_back(absl::Milliseconds(i));
+  }
+  report.requests = 100;
+  report.elapsed = absl::Seconds(4);
+  report.errors[absl::StatusCode::kUnavailable] = 3;
+
+  EXPECT_EQ(report.Percentile(50), absl::Milliseconds(50));
+  EXPECT_EQ(report.Percentile(99), absl::Milliseconds(99));
+  EXPECT_EQ(report.Percentile(100), absl::Milliseconds(100));
+  EXPECT_EQ(report.Qps(), 25);
+  EXPECT_THAT(report.ToString(), HasSubstr("UNAVAILABLE: 3"));
+}
+
+TEST(RunLoadTest, KeepsConcurrencyAndCyclesThroughCorpus) {
+  absl::Mutex mu;
+  int in_flight = 0;
+  int max_in_flight = 0;
+  std::vector<int> indices;
+  std::vector<std::thread> threads;
+  LoadReport report = RunLoad(
+      {.concurrency = 2, .duration = absl::Milliseconds(100)},
+      /*corpus_size=*/3,
+      [&](int index, absl::AnyInvocable<void(absl::Status) &&> on_done) {
+        {
+          absl::MutexLock lock(&mu);
+          max_in_flight = std::max(max_in_flight, ++in_flight);
+          indices.push_back(index);
+        }
+        threads.emplace_back(
+            [&mu, &in_flight, index, on_done = std::move(on_done)]() mutable {
+              absl::SleepFor(absl::Milliseconds(5));
+              {
+                absl::MutexLock lock(&mu);
+                --in_flight;
+              }
+              std::move(on_done)(index == 0 ? absl::UnavailableError("")
+                                            : absl::OkStatus());
+            });
+        return absl::OkStatus();
+      });
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(max_in_flight, 2);
+  ASSERT_GE(indices.size(), 3);
+  EXPECT_THAT(std::vector<int>(indices.begin(), indices.begin() + 3),
+              ElementsAre(0, 1, 2));
+  EXPECT_EQ(report.requests, indices.size());
+  EXPECT_EQ(report.latencies.size(), indices.size());
+  EXPECT_THAT(report.errors,
+              ElementsAre(Pair(absl::StatusCode::kUnavailable,
+                               (indices.size() + 2) / 3)));
+}
+
+TEST(RunLoadTest, PacesRequestsAtTargetQps) {
+  LoadReport report = RunLoad(
+      {.qps = 100, .concurrency = 10, .duration = absl::Milliseconds(200)},
+      /*corpus_size=*/1,
+      [](int index, absl::AnyInvocable<void(absl::Status) &&> on_done) {
+        std::move(on_done)(absl::OkStatus());
+        return absl::OkStatus();
+      });
+  // 20 requests are due in 200ms.
+  EXPECT_GE(report.requests, 18);
+  EXPECT_LE(report.requests, 21);
+}
+
+TEST(RunLoadTest, SendsRequestsOnScheduleAndStopsAfterLast) {
+  const absl::Time start = absl::Now();
+  std::vector<std::pair<int, absl::Duration>> sent;
+  LoadReport report = RunLoad(
+      {.concurrency = 10,
+       .duration = absl::Seconds(10),
+       .schedule = {absl::ZeroDuration(), absl::Milliseconds(30),
+                    absl::Milliseconds(30), absl::Milliseconds(60)}},
+      /*corpus_size=*/2,
+      [&](int index, absl::AnyInvocable<void(absl::Status) &&> on_done) {
+        sent.emplace_back(index, absl::Now() - start);
+        std::move(on_done)(absl::OkStatus());
+        return absl::OkStatus();
+      });
+
+  EXPECT_EQ(report.requests, 4);
+  EXPECT_LT(report.elapsed, absl::Seconds(1));
+  ASSERT_EQ(sent.size(), 4);
+  EXPECT_THAT(sent, ElementsAre(Pair(0, _), Pair(1, Ge(absl::Milliseconds(30))),
+                                Pair(0, Ge(absl::Milliseconds(30))),
+                                Pair(1, Ge(absl::Milliseconds(60)))));
+}
+
+TEST(RunLoadTest, CountsRequestsThatFailToSend) {
+  LoadReport report = RunLoad(
+      {.concurrency = 1, .duration = absl::Milliseconds(10)},
+      /*corpus_size=*/1,
+      [](int index, absl::AnyInvocable<void(absl::Status) &&> on_done) {
+        return absl::InternalError("");
+      });
+  EXPECT_GT(report.requests, 0);
+  EXPECT_THAT(report.errors,
+              ElementsAre(Pair(absl::StatusCode::kInternal, report.requests)));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
@@ -0,0 +1,185 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/secure_invoke/request_replay.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/substitute.h"
+#include "glog/logging.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+constexpr char kReplayPublisher[] = "publisher.example.com";
+
+// Returns a JSON array of the given size, or an empty string for size 0.
+std::string MakeSignal(int bytes) {
+  if (bytes <= 0) {
+    return "";
+  }
+  if (bytes == 1) {
+    return "0";
+  }
+  std::string signal = "[";
+  for (int i = 0; i < bytes - 2; ++i) {
+    signal.push_back(i % 2 == 0 ? '0' : ',');
+  }
+  // Keeps the array valid without a trailing comma.
+  if (signal.back() == ',') {
+    signal.back() = ' ';
+  }
+  signal.push_back(']');
+  return signal;
+}
+
+// Returns a name of at least the given size, padded after the prefix.
+std::string MakeName(std::string name, int bytes) {
+  if (name.size() < bytes) {
+    name.append(bytes - name.size(), 'x');
+  }
+  return name;
+}
+
+BuyerInput MakeBuyerInput(const BuyerShape& shape, int buyer, int index) {
+  BuyerInput buyer_input;
+  for (int i = 0; i < shape.interest_groups.size(); ++i) {
+    const InterestGroupShape& interest_group_shape = shape.interest_groups[i];
+    auto* interest_group = buyer_input.add_interest_groups();
+    interest_group->set_name(absl::StrCat("ig_", buyer, "_", i));
+    const int key_bytes =
+        interest_group_shape.bidding_signals_keys > 0
+            ? interest_group_shape.bidding_signals_key_bytes /
+                  interest_group_shape.bidding_signals_keys
+            : 0;
+    for (int k = 0; k < interest_group_shape.bidding_signals_keys; ++k) {
+      interest_group->add_bidding_signals_keys(MakeName(
+          absl::StrCat("key_", index, "_", buyer, "_", i, "_", k), key_bytes));
+    }
+    for (int a = 0; a < interest_group_shape.ads; ++a) {
+      interest_group->add_ad_render_ids(
+          absl::StrCat("ad_", index, "_", buyer, "_", i, "_", a));
+    }
+    for (int a = 0; a < interest_group_shape.component_ads; ++a) {
+      interest_group->add_component_ads(
+          absl::StrCat("component_", index, "_", buyer, "_", i, "_", a));
+    }
+    interest_group->set_user_bidding_signals(
+        MakeSignal(interest_group_shape.user_bidding_signals_bytes));
+    auto* browser_signals = interest_group->mutable_browser_signals();
+    browser_signals->set_join_count(i % 10);
+    browser_signals->set_bid_count(index % 10);
+    browser_signals->set_recency(60);
+    browser_signals->set_prev_wins("[]");
+  }
+  return buyer_input;
+}
+
+std::string ToJson(const google::protobuf::Message& message) {
+  google::protobuf::util::JsonPrintOptions print_options;
+  print_options.preserve_proto_field_names = true;
+  std::string json;
+  auto status = google::protobuf::util::MessageToJsonString(message, &json,
+                                                            print_options);
+  CHECK(status.ok()) << status;
+  return json;
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<RequestShape>> ParseRequestShapes(
+    absl::string_view jsonl) {
+  std::vector<RequestShape> shapes;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(jsonl, '\n')) {
+    ++line_number;
+    if (line.empty()) {
+      continue;
+    }
+    absl::StatusOr<RequestShape> shape = ParseRequestShape(line);
+    if (!shape.ok()) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Line ", line_number, ": ", shape.status().message()));
+    }
+    shapes.push_back(*std::move(shape));
+  }
+  return shapes;
+}
+
+std::vector<absl::Duration> GetReplaySchedule(
+    const std::vector<RequestShape>& shapes, double rate_scale) {
+  std::vector<absl::Duration> schedule;
+  if (shapes.empty()) {
+    return schedule;
+  }
+  schedule.reserve(shapes.size());
+  const absl::Duration first = shapes.front().offset;
+  for (const RequestShape& shape : shapes) {
+    // The shapes are recorded in order, but offsets may tie or, with a
+    // capture appended to, go back; such requests are due at once.
+    schedule.push_back(std::max(shape.offset - first, absl::ZeroDuration()) /
+                       std::max(rate_scale, 1e-3));
+  }
+  return schedule;
+}
+
+std::string MakeSelectAdRequestJson(const RequestShape& shape,
+                                    const ReplayOptions& options, int index) {
+  SelectAdRequest::AuctionConfig auction_config;
+  auction_config.set_seller(options.seller);
+  auction_config.set_seller_signals(MakeSignal(shape.seller_signals_bytes));
+  auction_config.set_auction_signals(MakeSignal(shape.auction_signals_bytes));
+  std::vector<std::string> raw_buyer_input;
+  const int buyers = std::min(shape.buyers.size(), options.buyers.size());
+  for (int i = 0; i < buyers; ++i) {
+    const std::string& buyer = options.buyers[i];
+    auction_config.add_buyer_list(buyer);
+    (*auction_config.mutable_per_buyer_config())[buyer].set_buyer_signals(
+        MakeSignal(shape.buyers[i].buyer_signals_bytes));
+    raw_buyer_input.push_back(
+        absl::Substitute(R"("$0":$1)", buyer,
+                         ToJson(MakeBuyerInput(shape.buyers[i], i, index))));
+  }
+  return absl::Substitute(
+      R"({"auction_config":$0,)"
+      R"("raw_protected_audience_input":{"raw_buyer_input":{$1},)"
+      R"("publisher_name":"$2","generation_id":"replay-$3"}})",
+      ToJson(auction_config), absl::StrJoin(raw_buyer_input, ","),
+      kReplayPublisher, index);
+}
+
+GetBidsRequest::GetBidsRawRequest MakeGetBidsRawRequest(
+    const RequestShape& shape, int buyer, const ReplayOptions& options,
+    int index) {
+  GetBidsRequest::GetBidsRawRequest get_bids_raw_request;
+  *get_bids_raw_request.mutable_buyer_input() =
+      MakeBuyerInput(shape.buyers[buyer], buyer, index);
+  get_bids_raw_request.set_auction_signals(
+      MakeSignal(shape.auction_signals_bytes));
+  get_bids_raw_request.set_buyer_signals(
+      MakeSignal(shape.buyers[buyer].buyer_signals_bytes));
+  get_bids_raw_request.set_seller(options.seller);
+  get_bids_raw_request.set_publisher_name(kReplayPublisher);
+  return get_bids_raw_request;
+}
+
+}  // namespace privacy_sandbox::bidding_auction_servers
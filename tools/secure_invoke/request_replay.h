@@ -0,0 +1,62 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef TOOLS_INVOKE_REQUEST_REPLAY_H_
+#define TOOLS_INVOKE_REQUEST_REPLAY_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "api/bidding_auction_servers.pb.h"
+#include "services/seller_frontend_service/util/request_shape.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+
+// How the captured request shapes are re-synthesized into requests.
+struct ReplayOptions {
+  // Seller of the SelectAd requests, as configured in SFE.
+  std::string seller;
+  // Origins the buyers of a shape map onto, in order, as configured in SFE.
+  // The buyers of a shape beyond them are left out of its SelectAd request.
+  std::vector<std::string> buyers;
+};
+
+// Parses the request shapes of a file captured by SFE, one per line, skipping
+// empty lines.
+absl::StatusOr<std::vector<RequestShape>> ParseRequestShapes(
+    absl::string_view jsonl);
+
+// Returns the offsets from the start of the replay at which the shapes are
+// due: their recorded offsets from the first one, divided by rate_scale.
+std::vector<absl::Duration> GetReplaySchedule(
+    const std::vector<RequestShape>& shapes, double rate_scale);
+
+// Returns a plaintext SelectAd request, in the JSON format secure_invoke
+// packages, of the given shape, with synthetic names, keys and signals of the
+// recorded sizes. The index makes the keys and ads of each request distinct.
+std::string MakeSelectAdRequestJson(const RequestShape& shape,
+                                    const ReplayOptions& options, int index);
+
+// Returns a plaintext GetBids request of the shape of the given buyer of a
+// SelectAd request, as SFE would send it.
+GetBidsRequest::GetBidsRawRequest MakeGetBidsRawRequest(
+    const RequestShape& shape, int buyer, const ReplayOptions& options,
+    int index);
+
+}  // namespace privacy_sandbox::bidding_auction_servers
+
+#endif  // TOOLS_INVOKE_REQUEST_REPLAY_H_
@@ -0,0 +1,138 @@
+// Copyright 2023 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "tools/secure_invoke/request_replay.h"
+
+#include <string>
+#include <vector>
+
+#include <google/protobuf/struct.pb.h>
+#include <google/protobuf/util/json_util.h>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace privacy_sandbox::bidding_auction_servers {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Not;
+
+constexpr char kSeller[] = "https://seller.com";
+constexpr char kBuyer[] = "https://buyer.com";
+constexpr char kOtherBuyer[] = "https://other-buyer.com";
+
+RequestShape TestShape() {
+  return {.seller_signals_bytes = 10,
+          .auction_signals_bytes = 7,
+          .buyers = {{.buyer_signals_bytes = 1,
+                      .interest_groups = {{.bidding_signals_keys = 2,
+                                           .bidding_signals_key_bytes = 40,
+                                           .ads = 3,
+                                           .component_ads = 1,
+                                           .user_bidding_signals_bytes = 20},
+                                          {}}},
+                     {.buyer_signals_bytes = 100}}};
+}
+
+template <typename Message>
+Message FromStructValue(const google::protobuf::Value& value) {
+  std::string json;
+  EXPECT_TRUE(google::protobuf::util::MessageToJsonString(value, &json).ok());
+  Message message;
+  EXPECT_TRUE(google::protobuf::util::JsonStringToMessage(json, &message).ok())
+      << json;
+  return message;
+}
+
+TEST(RequestReplayTest, SynthesizesSelectAdRequestOfTheShape) {
+  const RequestShape shape = TestShape();
+  const std::string json = MakeSelectAdRequestJson(
+      shape, {.seller = kSeller, .buyers = {kBuyer, kOtherBuyer}},
+      /*index=*/3);
+
+  google::protobuf::Struct request;
+  ASSERT_TRUE(google::protobuf::util::JsonStringToMessage(json, &request).ok())
+      << json;
+  auto auction_config = FromStructValue<SelectAdRequest::AuctionConfig>(
+      request.fields().at("auction_config"));
+  EXPECT_EQ(auction_config.seller(), kSeller);
+  EXPECT_THAT(auction_config.buyer_list(), ElementsAre(kBuyer, kOtherBuyer));
+  const auto& raw_buyer_input = request.fields()
+                                    .at("raw_protected_audience_input")
+                                    .struct_value()
+                                    .fields()
+                                    .at("raw_buyer_input")
+                                    .struct_value()
+                                    .fields();
+  absl::flat_hash_map<absl::string_view, BuyerInput> buyer_inputs;
+  for (const auto& [buyer, buyer_input] : raw_buyer_input) {
+    buyer_inputs.try_emplace(buyer, FromStructValue<BuyerInput>(buyer_input));
+  }
+
+  EXPECT_EQ(GetRequestShape(auction_config, buyer_inputs), shape);
+}
+
+TEST(RequestReplayTest, LeavesOutBuyersBeyondTheOrigins) {
+  const std::string json = MakeSelectAdRequestJson(
+      TestShape(), {.seller = kSeller, .buyers = {kBuyer}}, /*index=*/0);
+  EXPECT_THAT(json, HasSubstr(kBuyer));
+  EXPECT_THAT(json, Not(HasSubstr(kOtherBuyer)));
+}
+
+TEST(RequestReplayTest, SynthesizesGetBidsRequestOfTheBuyerShape) {
+  GetBidsRequest::GetBidsRawRequest get_bids_raw_request =
+      MakeGetBidsRawRequest(TestShape(), /*buyer=*/0, {.seller = kSeller},
+                            /*index=*/0);
+  EXPECT_EQ(get_bids_raw_request.seller(), kSeller);
+  EXPECT_EQ(get_bids_raw_request.auction_signals().size(), 7);
+  EXPECT_EQ(get_bids_raw_request.buyer_signals().size(), 1);
+  ASSERT_EQ(get_bids_raw_request.buyer_input().interest_groups_size(), 2);
+  const auto& interest_group =
+      get_bids_raw_request.buyer_input().interest_groups(0);
+  EXPECT_EQ(interest_group.bidding_signals_keys_size(), 2);
+  EXPECT_EQ(interest_group.ad_render_ids_size(), 3);
+  EXPECT_EQ(interest_group.component_ads_size(), 1);
+  EXPECT_EQ(interest_group.user_bidding_signals().size(), 20);
+}
+
+TEST(RequestReplayTest, ScalesRecordedOffsetsFromTheFirst) {
+  std::vector<RequestShape> shapes = {{.offset = absl::Seconds(10)},
+                                      {.offset = absl::Seconds(11)},
+                                      {.offset = absl::Seconds(14)}};
+  EXPECT_THAT(GetReplaySchedule(shapes, /*rate_scale=*/1),
+              ElementsAre(absl::ZeroDuration(), absl::Seconds(1),
+                          absl::Seconds(4)));
+  EXPECT_THAT(GetReplaySchedule(shapes, /*rate_scale=*/2),
+              ElementsAre(absl::ZeroDuration(), absl::Milliseconds(500),
+                          absl::Seconds(2)));
+}
+
+TEST(RequestReplayTest, ParsesShapesLineByLine) {
+  absl::StatusOr<std::vector<RequestShape>> shapes = ParseRequestShapes(
+      absl::StrCat(RequestShapeToJson({.offset = absl::Seconds(1)}), "\n\n",
+                   RequestShapeToJson({.offset = absl::Seconds(2)}), "\n"));
+  ASSERT_TRUE(shapes.ok()) << shapes.status();
+  ASSERT_EQ(shapes->size(), 2);
+  EXPECT_EQ((*shapes)[1].offset, absl::Seconds(2));
+
+  absl::StatusOr<std::vector<RequestShape>> malformed =
+      ParseRequestShapes("{}\nnot json\n");
+  EXPECT_THAT(malformed.status().message(), HasSubstr("Line 2"));
+}
+
+}  // namespace
+}  // namespace privacy_sandbox::bidding_auction_servers
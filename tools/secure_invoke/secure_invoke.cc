@@ -11,6 +11,9 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <string>
+#include <vector>
+
 #include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
 #include "absl/strings/ascii.h"
@@ -30,7 +33,8 @@ using ::privacy_sandbox::bidding_auction_servers::SelectAdRequest;
 ABSL_FLAG(
     std::string, input_file, "",
     "Complete path to the file containing unencrypted request"
-    "The file may contain JSON or protobuf based GetBidsRequest payload.");
+    "The file may contain JSON or protobuf based GetBidsRequest payload. "
+    "With --op=replay, the request shapes captured by SFE.");
 
 ABSL_FLAG(std::string, input_format, kJsonFormat,
           "Format of request in the input file. Valid values: JSON, PROTO "
@@ -41,7 +45,7 @@ ABSL_FLAG(std::string, json_input_str, "",
           "used to send request rather than loading it from an input file");
 
 ABSL_FLAG(std::string, op, "",
-          "The operation to be performed - invoke/encrypt.");
+          "The operation to be performed - invoke/encrypt/load/replay.");
 
 ABSL_FLAG(std::string, host_addr, "",
           "The Address for the SellerFrontEnd server to be invoked.");
@@ -70,6 +74,35 @@ ABSL_FLAG(bool, insecure, false,
 ABSL_FLAG(std::string, target_service, kSfe,
           "Service name to which the request must be sent to.");
 
+ABSL_FLAG(int, load_qps, 0,
+          "With --op=load, requests sent per second, or 0 to send the next "
+          "request as soon as one completes");
+
+ABSL_FLAG(int, load_concurrency, 1,
+          "With --op=load or replay, requests in flight at most");
+
+ABSL_FLAG(int, load_duration_s, 10,
+          "With --op=load, seconds during which requests are sent");
+
+ABSL_FLAG(int, load_channels, 1,
+          "With --op=load or replay, gRPC channels the requests are spread "
+          "over, each with its own connection");
+
+ABSL_FLAG(int, load_corpus_size, 100,
+          "With --op=load, requests encrypted up front and sent in turn");
+
+ABSL_FLAG(double, replay_rate_scale, 1,
+          "With --op=replay, how many times faster than recorded the request "
+          "shapes of the input file are replayed");
+
+ABSL_FLAG(std::string, replay_seller, "https://securepubads.g.doubleclick.net",
+          "With --op=replay, seller of the replayed requests");
+
+ABSL_FLAG(std::vector<std::string>, replay_buyers,
+          std::vector<std::string>({"https://td.doubleclick.net"}),
+          "With --op=replay, comma separated origins the buyers of each "
+          "request shape map onto, in order");
+
 namespace {}  // namespace
 
 int main(int argc, char** argv) {
@@ -103,8 +136,10 @@ int main(int argc, char** argv) {
         << kJsonFormat;
   }
   CHECK(!op.empty())
-      << "Please specify the operation to be performed - encrypt/invoke. This "
-         "tool can only be used to call B&A servers running in test mode.";
+      << "Please specify the operation to be performed - "
+         "encrypt/invoke/load/replay. "
+         "This tool can only be used to call B&A servers running in test "
+         "mode.";
   if (op == "encrypt") {
     if (target_service == kSfe) {
       json_input_str =
@@ -130,6 +165,19 @@ int main(int argc, char** argv) {
     } else {
       LOG(FATAL) << "Unsupported target service: " << target_service;
     }
+  } else if (op == "load") {
+    const auto status =
+        target_service == kSfe
+            ? privacy_sandbox::bidding_auction_servers::SendLoadToSfe(
+                  client_type)
+            : privacy_sandbox::bidding_auction_servers::SendLoadToBfe();
+    CHECK(status.ok()) << status;
+  } else if (op == "replay") {
+    const auto status =
+        target_service == kSfe
+            ? privacy_sandbox::bidding_auction_servers::ReplayToSfe(client_type)
+            : privacy_sandbox::bidding_auction_servers::ReplayToBfe();
+    CHECK(status.ok()) << status;
   } else {
     LOG(FATAL) << "Unsupported operation.";
   }
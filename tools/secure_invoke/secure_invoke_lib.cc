@@ -14,15 +14,21 @@
 
 #include "tools/secure_invoke/secure_invoke_lib.h"
 
+#include <algorithm>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <google/protobuf/text_format.h>
 #include <google/protobuf/util/json_util.h>
+#include <grpcpp/grpcpp.h>
 
 #include "absl/flags/flag.h"
+#include "absl/strings/str_cat.h"
 #include "quiche/oblivious_http/oblivious_http_client.h"
 #include "services/common/clients/async_grpc/grpc_client_utils.h"
 #include "services/common/clients/buyer_frontend_server/buyer_frontend_async_client.h"
@@ -31,8 +37,12 @@
 #include "services/common/constants/common_service_flags.h"
 #include "services/common/encryption/crypto_client_factory.h"
 #include "services/common/encryption/key_fetcher_factory.h"
+#include "services/common/util/status_macros.h"
+#include "services/common/util/status_util.h"
+#include "tools/secure_invoke/load_generator.h"
 #include "tools/secure_invoke/payload_generator/payload_packaging.h"
 #include "tools/secure_invoke/payload_generator/payload_packaging_utils.h"
+#include "tools/secure_invoke/request_replay.h"
 
 ABSL_DECLARE_FLAG(std::string, input_file);
 ABSL_DECLARE_FLAG(std::string, input_format);
@@ -45,6 +55,14 @@ ABSL_DECLARE_FLAG(std::string, client_user_agent);
 ABSL_DECLARE_FLAG(std::string, client_type);
 ABSL_DECLARE_FLAG(bool, insecure);
 ABSL_DECLARE_FLAG(std::string, target_service);
+ABSL_DECLARE_FLAG(int, load_qps);
+ABSL_DECLARE_FLAG(int, load_concurrency);
+ABSL_DECLARE_FLAG(int, load_duration_s);
+ABSL_DECLARE_FLAG(int, load_channels);
+ABSL_DECLARE_FLAG(int, load_corpus_size);
+ABSL_DECLARE_FLAG(double, replay_rate_scale);
+ABSL_DECLARE_FLAG(std::string, replay_seller);
+ABSL_DECLARE_FLAG(std::vector<std::string>, replay_buyers);
 
 namespace privacy_sandbox::bidding_auction_servers {
 
@@ -70,16 +88,11 @@ absl::StatusOr<std::string> ParseSelectAdResponse(
   return auction_result_json;
 }
 
-}  // namespace
-
-absl::Status InvokeSellerFrontEndWithRawRequest(
-    absl::string_view raw_select_ad_request_json,
-    const RequestOptions& request_options,
-    SelectAdRequest::ClientType client_type,
-    absl::AnyInvocable<void(absl::StatusOr<std::string>) &&> on_done) {
-  // Validate input
+absl::Status ValidateRequestOptions(const RequestOptions& request_options,
+                                    absl::string_view service) {
   if (request_options.host_addr.empty()) {
-    return absl::InvalidArgumentError("SFE host address must be specified");
+    return absl::InvalidArgumentError(
+        absl::StrCat(service, " host address must be specified"));
   }
 
   if (request_options.client_ip.empty()) {
@@ -93,6 +106,117 @@ absl::Status InvokeSellerFrontEndWithRawRequest(
   if (request_options.accept_language.empty()) {
     return absl::InvalidArgumentError("Accept Language must be specified");
   }
+  return absl::OkStatus();
+}
+
+RequestMetadata GetRequestMetadata(const RequestOptions& request_options) {
+  RequestMetadata request_metadata;
+  request_metadata.emplace("x-bna-client-ip", request_options.client_ip);
+  request_metadata.emplace("x-user-agent", request_options.user_agent);
+  request_metadata.emplace("x-accept-language",
+                           request_options.accept_language);
+  return request_metadata;
+}
+
+RequestOptions GetRequestOptionsFromFlags() {
+  RequestOptions request_options;
+  request_options.host_addr = absl::GetFlag(FLAGS_host_addr);
+  request_options.client_ip = absl::GetFlag(FLAGS_client_ip);
+  request_options.user_agent = absl::GetFlag(FLAGS_client_user_agent);
+  request_options.accept_language = absl::GetFlag(FLAGS_client_accept_language);
+  request_options.insecure = absl::GetFlag(FLAGS_insecure);
+  return request_options;
+}
+
+// A call in flight, which owns what the call must outlive.
+template <typename Response>
+struct LoadCall {
+  grpc::ClientContext context;
+  Response response;
+  absl::AnyInvocable<void(absl::Status) &&> on_done;
+};
+
+LoadOptions GetLoadOptionsFromFlags() {
+  return {.qps = absl::GetFlag(FLAGS_load_qps),
+          .concurrency = absl::GetFlag(FLAGS_load_concurrency),
+          .duration = absl::Seconds(absl::GetFlag(FLAGS_load_duration_s))};
+}
+
+// Returns the request shapes of the input file, and the options to replay
+// them with, as the replay flags dictate.
+absl::StatusOr<std::pair<std::vector<RequestShape>, LoadOptions>>
+GetReplayFromFlags() {
+  PS_ASSIGN_OR_RETURN(
+      std::vector<RequestShape> shapes,
+      ParseRequestShapes(LoadFile(absl::GetFlag(FLAGS_input_file))));
+  if (shapes.empty()) {
+    return absl::InvalidArgumentError("No request shapes to replay");
+  }
+  LoadOptions load_options = {
+      .concurrency = absl::GetFlag(FLAGS_load_concurrency),
+      .duration = absl::InfiniteDuration(),
+      .schedule =
+          GetReplaySchedule(shapes, absl::GetFlag(FLAGS_replay_rate_scale))};
+  return std::make_pair(std::move(shapes), std::move(load_options));
+}
+
+ReplayOptions GetReplayOptionsFromFlags() {
+  return {.seller = absl::GetFlag(FLAGS_replay_seller),
+          .buyers = absl::GetFlag(FLAGS_replay_buyers)};
+}
+
+// Sends the pre-encrypted corpus of requests to the service, as load_options
+// dictate, and prints the report. The requests are spread over
+// several channels, each with its own connection. The responses are not
+// decrypted, since only their status is reported.
+template <typename Service, typename Request, typename Response, typename Rpc>
+absl::Status SendLoad(const std::vector<std::unique_ptr<Request>>& corpus,
+                      const RequestOptions& request_options,
+                      const LoadOptions& load_options, Rpc rpc) {
+  std::shared_ptr<grpc::ChannelCredentials> creds =
+      request_options.insecure
+          ? grpc::InsecureChannelCredentials()
+          : grpc::SslCredentials(grpc::SslCredentialsOptions());
+  grpc::ChannelArguments args;
+  // Otherwise the channels share their connection.
+  args.SetInt(GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL, 1);
+  std::vector<std::unique_ptr<typename Service::Stub>> stubs;
+  for (int i = 0; i < std::max(absl::GetFlag(FLAGS_load_channels), 1); ++i) {
+    stubs.push_back(Service::NewStub(grpc::CreateCustomChannel(
+        request_options.host_addr, creds, args)));
+  }
+
+  const RequestMetadata request_metadata = GetRequestMetadata(request_options);
+  int64_t calls = 0;
+  LoadReport report = RunLoad(
+      load_options, static_cast<int>(corpus.size()),
+      [&](int index, absl::AnyInvocable<void(absl::Status) &&> on_done) {
+        auto* call = new LoadCall<Response>{.on_done = std::move(on_done)};
+        call->context.set_deadline(absl::ToChronoTime(absl::Now() + timeout));
+        for (const auto& [key, value] : request_metadata) {
+          call->context.AddMetadata(key, value);
+        }
+        rpc(*stubs[calls++ % stubs.size()], &call->context, corpus[index].get(),
+            &call->response, [call](const grpc::Status& status) {
+              std::unique_ptr<LoadCall<Response>> owned_call(call);
+              std::move(owned_call->on_done)(ToAbslStatus(status));
+            });
+        return absl::OkStatus();
+      });
+  // LOG causes clipping of response.
+  std::cout << report.ToString();
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+absl::Status InvokeSellerFrontEndWithRawRequest(
+    absl::string_view raw_select_ad_request_json,
+    const RequestOptions& request_options,
+    SelectAdRequest::ClientType client_type,
+    absl::AnyInvocable<void(absl::StatusOr<std::string>) &&> on_done) {
+  // Validate input
+  PS_RETURN_IF_ERROR(ValidateRequestOptions(request_options, "SFE"));
 
   // Package request.
   std::pair<std::unique_ptr<SelectAdRequest>,
@@ -101,11 +225,7 @@ absl::Status InvokeSellerFrontEndWithRawRequest(
           raw_select_ad_request_json, client_type);
 
   // Add request headers.
-  RequestMetadata request_metadata;
-  request_metadata.emplace("x-bna-client-ip", request_options.client_ip);
-  request_metadata.emplace("x-user-agent", request_options.user_agent);
-  request_metadata.emplace("x-accept-language",
-                           request_options.accept_language);
+  RequestMetadata request_metadata = GetRequestMetadata(request_options);
 
   // Create client.
   SellerFrontEndServiceClientConfig service_client_config;
@@ -134,28 +254,10 @@ absl::Status InvokeBuyerFrontEndWithRawRequest(
     absl::AnyInvocable<void(absl::StatusOr<std::string>) &&> on_done,
     std::unique_ptr<BuyerFrontEnd::StubInterface> stub = nullptr) {
   // Validate input
-  if (request_options.host_addr.empty()) {
-    return absl::InvalidArgumentError("BFE host address must be specified");
-  }
-
-  if (request_options.client_ip.empty()) {
-    return absl::InvalidArgumentError("Client IP must be specified");
-  }
-
-  if (request_options.user_agent.empty()) {
-    return absl::InvalidArgumentError("User Agent must be specified");
-  }
-
-  if (request_options.accept_language.empty()) {
-    return absl::InvalidArgumentError("Accept Language must be specified");
-  }
+  PS_RETURN_IF_ERROR(ValidateRequestOptions(request_options, "BFE"));
 
   // Add request headers.
-  RequestMetadata request_metadata;
-  request_metadata.emplace("x-bna-client-ip", request_options.client_ip);
-  request_metadata.emplace("x-user-agent", request_options.user_agent);
-  request_metadata.emplace("x-accept-language",
-                           request_options.accept_language);
+  RequestMetadata request_metadata = GetRequestMetadata(request_options);
 
   // Create service client.
   BuyerServiceClientConfig service_client_config = {
@@ -212,12 +314,7 @@ absl::Status SendRequestToSfe(SelectAdRequest::ClientType client_type) {
   if (raw_select_ad_request_json.empty()) {
     raw_select_ad_request_json = LoadFile(absl::GetFlag(FLAGS_input_file));
   }
-  privacy_sandbox::bidding_auction_servers::RequestOptions options;
-  options.host_addr = absl::GetFlag(FLAGS_host_addr);
-  options.client_ip = absl::GetFlag(FLAGS_client_ip);
-  options.user_agent = absl::GetFlag(FLAGS_client_user_agent);
-  options.accept_language = absl::GetFlag(FLAGS_client_accept_language);
-  options.insecure = absl::GetFlag(FLAGS_insecure);
+  RequestOptions options = GetRequestOptionsFromFlags();
   absl::Notification notification;
   absl::Status status = privacy_sandbox::bidding_auction_servers::
       InvokeSellerFrontEndWithRawRequest(
@@ -259,23 +356,44 @@ GetBidsRequest::GetBidsRawRequest GetBidsRawRequestFromInput() {
   return get_bids_raw_request;
 }
 
-std::string PackagePlainTextGetBidsRequestToJson() {
-  GetBidsRequest::GetBidsRawRequest get_bids_raw_request =
-      GetBidsRawRequestFromInput();
+// Returns the encryptions of the given GetBidsRawRequests, each on its own.
+std::vector<std::unique_ptr<GetBidsRequest>> EncryptGetBidsRequests(
+    const std::vector<GetBidsRequest::GetBidsRawRequest>&
+        get_bids_raw_requests) {
   TrustedServersConfigClient config_client({});
   config_client.SetFlagForTest(kTrue, TEST_MODE);
   config_client.SetFlagForTest(kTrue, ENABLE_ENCRYPTION);
   auto key_fetcher_manager = CreateKeyFetcherManager(config_client);
   auto crypto_client = CreateCryptoClient();
-  auto secret_request =
-      EncryptRequestWithHpke<GetBidsRequest::GetBidsRawRequest, GetBidsRequest>(
-          std::make_unique<GetBidsRequest::GetBidsRawRequest>(
-              get_bids_raw_request),
-          *crypto_client, *key_fetcher_manager);
-  CHECK(secret_request.ok()) << secret_request.status();
+  std::vector<std::unique_ptr<GetBidsRequest>> requests;
+  requests.reserve(get_bids_raw_requests.size());
+  for (const auto& get_bids_raw_request : get_bids_raw_requests) {
+    auto secret_request =
+        EncryptRequestWithHpke<GetBidsRequest::GetBidsRawRequest,
+                               GetBidsRequest>(
+            std::make_unique<GetBidsRequest::GetBidsRawRequest>(
+                get_bids_raw_request),
+            *crypto_client, *key_fetcher_manager);
+    CHECK(secret_request.ok()) << secret_request.status();
+    requests.push_back(std::move(secret_request->second));
+  }
+  return requests;
+}
+
+// Returns the given number of encryptions of the input GetBidsRawRequest.
+std::vector<std::unique_ptr<GetBidsRequest>> PackagePlainTextGetBidsRequests(
+    int count) {
+  return EncryptGetBidsRequests(
+      std::vector<GetBidsRequest::GetBidsRawRequest>(
+          count, GetBidsRawRequestFromInput()));
+}
+
+std::string PackagePlainTextGetBidsRequestToJson() {
+  std::vector<std::unique_ptr<GetBidsRequest>> requests =
+      PackagePlainTextGetBidsRequests(/*count=*/1);
   std::string get_bids_request_json;
   auto get_bids_request_json_status =
-      google::protobuf::util::MessageToJsonString(*secret_request->second,
+      google::protobuf::util::MessageToJsonString(*requests[0],
                                                   &get_bids_request_json);
   CHECK(get_bids_request_json_status.ok()) << get_bids_request_json_status;
   return get_bids_request_json;
@@ -285,12 +403,7 @@ absl::Status SendRequestToBfe(
     std::unique_ptr<BuyerFrontEnd::StubInterface> stub) {
   GetBidsRequest::GetBidsRawRequest get_bids_raw_request =
       GetBidsRawRequestFromInput();
-  privacy_sandbox::bidding_auction_servers::RequestOptions request_options;
-  request_options.host_addr = absl::GetFlag(FLAGS_host_addr);
-  request_options.client_ip = absl::GetFlag(FLAGS_client_ip);
-  request_options.user_agent = absl::GetFlag(FLAGS_client_user_agent);
-  request_options.accept_language = absl::GetFlag(FLAGS_client_accept_language);
-  request_options.insecure = absl::GetFlag(FLAGS_insecure);
+  RequestOptions request_options = GetRequestOptionsFromFlags();
   absl::Status status = absl::OkStatus();
   auto call_status = privacy_sandbox::bidding_auction_servers::
       InvokeBuyerFrontEndWithRawRequest(
@@ -308,4 +421,98 @@ absl::Status SendRequestToBfe(
   return status;
 }
 
+absl::Status SendLoadToSfe(SelectAdRequest::ClientType client_type) {
+  std::string raw_select_ad_request_json = absl::GetFlag(FLAGS_json_input_str);
+  if (raw_select_ad_request_json.empty()) {
+    raw_select_ad_request_json = LoadFile(absl::GetFlag(FLAGS_input_file));
+  }
+  RequestOptions request_options = GetRequestOptionsFromFlags();
+  PS_RETURN_IF_ERROR(ValidateRequestOptions(request_options, "SFE"));
+
+  // Each request is encrypted on its own, as a client would.
+  std::vector<std::unique_ptr<SelectAdRequest>> corpus;
+  for (int i = 0; i < std::max(absl::GetFlag(FLAGS_load_corpus_size), 1);
+       ++i) {
+    corpus.push_back(
+        PackagePlainTextSelectAdRequest(raw_select_ad_request_json, client_type)
+            .first);
+  }
+  return SendLoad<SellerFrontEnd, SelectAdRequest, SelectAdResponse>(
+      corpus, request_options, GetLoadOptionsFromFlags(),
+      [](SellerFrontEnd::Stub& stub, grpc::ClientContext* context,
+         const SelectAdRequest* request, SelectAdResponse* response,
+         std::function<void(grpc::Status)> on_done) {
+        stub.async()->SelectAd(context, request, response, std::move(on_done));
+      });
+}
+
+absl::Status SendLoadToBfe() {
+  RequestOptions request_options = GetRequestOptionsFromFlags();
+  PS_RETURN_IF_ERROR(ValidateRequestOptions(request_options, "BFE"));
+  std::vector<std::unique_ptr<GetBidsRequest>> corpus =
+      PackagePlainTextGetBidsRequests(
+          std::max(absl::GetFlag(FLAGS_load_corpus_size), 1));
+  return SendLoad<BuyerFrontEnd, GetBidsRequest, GetBidsResponse>(
+      corpus, request_options, GetLoadOptionsFromFlags(),
+      [](BuyerFrontEnd::Stub& stub, grpc::ClientContext* context,
+         const GetBidsRequest* request, GetBidsResponse* response,
+         std::function<void(grpc::Status)> on_done) {
+        stub.async()->GetBids(context, request, response, std::move(on_done));
+      });
+}
+
+absl::Status ReplayToSfe(SelectAdRequest::ClientType client_type) {
+  RequestOptions request_options = GetRequestOptionsFromFlags();
+  PS_RETURN_IF_ERROR(ValidateRequestOptions(request_options, "SFE"));
+  PS_ASSIGN_OR_RETURN(auto replay, GetReplayFromFlags());
+  auto& [shapes, load_options] = replay;
+  const ReplayOptions replay_options = GetReplayOptionsFromFlags();
+  std::vector<std::unique_ptr<SelectAdRequest>> corpus;
+  corpus.reserve(shapes.size());
+  for (int i = 0; i < shapes.size(); ++i) {
+    corpus.push_back(
+        PackagePlainTextSelectAdRequest(
+            MakeSelectAdRequestJson(shapes[i], replay_options, i), client_type)
+            .first);
+  }
+  return SendLoad<SellerFrontEnd, SelectAdRequest, SelectAdResponse>(
+      corpus, request_options, load_options,
+      [](SellerFrontEnd::Stub& stub, grpc::ClientContext* context,
+         const SelectAdRequest* request, SelectAdResponse* response,
+         std::function<void(grpc::Status)> on_done) {
+        stub.async()->SelectAd(context, request, response, std::move(on_done));
+      });
+}
+
+absl::Status ReplayToBfe() {
+  RequestOptions request_options = GetRequestOptionsFromFlags();
+  PS_RETURN_IF_ERROR(ValidateRequestOptions(request_options, "BFE"));
+  PS_ASSIGN_OR_RETURN(auto replay, GetReplayFromFlags());
+  auto& [shapes, load_options] = replay;
+  const ReplayOptions replay_options = GetReplayOptionsFromFlags();
+  // SFE sends the GetBids requests of all the buyers of a SelectAd request at
+  // once.
+  std::vector<GetBidsRequest::GetBidsRawRequest> get_bids_raw_requests;
+  std::vector<absl::Duration> schedule;
+  for (int i = 0; i < shapes.size(); ++i) {
+    for (int buyer = 0; buyer < shapes[i].buyers.size(); ++buyer) {
+      get_bids_raw_requests.push_back(
+          MakeGetBidsRawRequest(shapes[i], buyer, replay_options, i));
+      schedule.push_back(load_options.schedule[i]);
+    }
+  }
+  if (get_bids_raw_requests.empty()) {
+    return absl::InvalidArgumentError("No buyers in the request shapes");
+  }
+  load_options.schedule = std::move(schedule);
+  return SendLoad<BuyerFrontEnd, GetBidsRequest, GetBidsResponse>(
+      EncryptGetBidsRequests(get_bids_raw_requests), request_options,
+      load_options,
+      [](BuyerFrontEnd::Stub& stub, grpc::ClientContext* context,
+         const GetBidsRequest* request, GetBidsResponse* response,
+         std::function<void(grpc::Status)> on_done) {
+        stub.async()->GetBids(context, request, response, std::move(on_done));
+      });
+}
+
 }  // namespace privacy_sandbox::bidding_auction_servers
@@ -44,6 +44,26 @@ absl::Status SendRequestToSfe(SelectAdRequest::ClientType client_type);
 absl::Status SendRequestToBfe(
     std::unique_ptr<BuyerFrontEnd::StubInterface> stub = nullptr);
 
+// Sends load to SFE with a corpus of requests encrypted up front, and prints
+// the latencies, errors and throughput. The parameters used for the requests
+// and the load are retrieved from absl flags that are used to run the script.
+absl::Status SendLoadToSfe(SelectAdRequest::ClientType client_type);
+
+// Sends load to BFE with a corpus of requests encrypted up front, and prints
+// the latencies, errors and throughput. The parameters used for the requests
+// and the load are retrieved from absl flags that are used to run the script.
+absl::Status SendLoadToBfe();
+
+// Replays the request shapes captured by SFE in the input file to SFE, at
+// their recorded rate times the replay rate scale. Each shape is synthesized
+// into a SelectAd request, and all of them are encrypted up front. Prints the
+// latencies, errors and throughput.
+absl::Status ReplayToSfe(SelectAdRequest::ClientType client_type);
+
+// Same as above, but replays to BFE the GetBids requests SFE would send for
+// the buyers of each shape.
+absl::Status ReplayToBfe();
+
 // Gets contents of the provided file path.
 std::string LoadFile(absl::string_view file_path);
 